@@ -93,6 +93,28 @@ static double Deg(double ang)
 	return ang / M_PI * 180.0;
 }
 
+namespace {
+//converts the shapes while the file is read, so no copies of all shapes are kept
+class JwwCreator : public JWWShapeHandler
+{
+public:
+	JwwCreator(DL_Jww& jww, DL_CreationInterface* creationInterface):
+		m_jww(jww)
+		,m_creationInterface(creationInterface)
+	{}
+	void OnSen(CDataSen& D) override {m_jww.CreateSen(m_creationInterface, D);}
+	void OnEnko(CDataEnko& D) override {m_jww.CreateEnko(m_creationInterface, D);}
+	void OnTen(CDataTen& D) override {m_jww.CreateTen(m_creationInterface, D);}
+	void OnMoji(CDataMoji& D) override {m_jww.CreateMoji(m_creationInterface, D);}
+	void OnSolid(CDataSolid& D) override {m_jww.CreateSolid(m_creationInterface, D);}
+	void OnSunpou(CDataSunpou& D) override {m_jww.CreateSunpou(m_creationInterface, D);}
+	void OnBlock(CDataBlock& D) override {m_jww.CreateBlock(m_creationInterface, D);}
+private:
+	DL_Jww& m_jww;
+	DL_CreationInterface* m_creationInterface;
+};
+}
+
 /**
  * Default constructor.
  */
@@ -670,36 +692,13 @@ void DL_Jww::CreateBlock(DL_CreationInterface* /*creationInterface*/, CDataBlock
 bool DL_Jww::in(const string& file, DL_CreationInterface* creationInterface) {
 	//JWWファイル読み取り
 	string ofile("");
-	JWWDocument* jwdoc = new JWWDocument((std::string&)file, ofile);
-	if(!jwdoc->Read())
-		return false;
+	JWWDocument jwdoc((std::string&)file, ofile);
 	//DXF変数設定
 	creationInterface->setVariableString("$DWGCODEPAGE", "SJIS", 7);
 	creationInterface->setVariableString("$TEXTSTYLE", "japanese", 7);
-	//線分データ
-	for( unsigned int i = 0; i < jwdoc->vSen.size(); i++ )
-		CreateSen(creationInterface, jwdoc->vSen[i]);
-	//円弧データ
-	for( unsigned int i = 0; i < jwdoc->vEnko.size(); i++ )
-		CreateEnko(creationInterface, jwdoc->vEnko[i]);
-	//点データ
-	for( unsigned int i = 0; i < jwdoc->vTen.size(); i++ )
-		CreateTen(creationInterface, jwdoc->vTen[i]);
-	//文字データ
-	for( unsigned int i = 0; i < jwdoc->vMoji.size(); i++ )
-		CreateMoji(creationInterface, jwdoc->vMoji[i]);
-	//寸法
-    for(unsigned int i=0 ; i < jwdoc->vSunpou.size(); i++ )
-		CreateSunpou(creationInterface, jwdoc->vSunpou[i]);
-	//ソリッド
-    for(unsigned int i=0 ; i < jwdoc->vSolid.size(); i++ )
-		CreateSolid(creationInterface, jwdoc->vSolid[i]);
-	//部品
-    for(unsigned int i=0 ; i < jwdoc->vBlock.size(); i++)
-		CreateBlock(creationInterface, jwdoc->vBlock[i]);
-	delete jwdoc;
-
-	return true;
+	//図形は読み込みながら変換する
+	JwwCreator creator(*this, creationInterface);
+	return jwdoc.Read(&creator);
 }
 
 /**
@@ -943,6 +943,11 @@ jwBOOL JWWDocument::WriteHeader()
 
 //データファイル読み込み
 jwBOOL JWWDocument::Read()
+{
+    return Read(NULL);
+}
+
+jwBOOL JWWDocument::Read(JWWShapeHandler* handler)
 {
     if(!ifs)
         return false;
@@ -1064,7 +1069,10 @@ cout << DSen;
                 ListCount++;
             } else
             {
-                vSen.push_back(DSen);
+                if( handler )
+                    handler->OnSen(DSen);
+                else
+                    vSen.push_back(DSen);
                 SenCount++;
             }
         }
@@ -1081,7 +1089,10 @@ cout << DEnko;
             }
             else
             {
-                vEnko.push_back(DEnko);
+                if( handler )
+                    handler->OnEnko(DEnko);
+                else
+                    vEnko.push_back(DEnko);
                 EnkoCount++;
             }
         }
@@ -1097,7 +1108,10 @@ cout << DTen;
                 ListCount++;
             } else
             {
-                vTen.push_back(DTen);
+                if( handler )
+                    handler->OnTen(DTen);
+                else
+                    vTen.push_back(DTen);
                 TenCount++;
             }
         }
@@ -1113,7 +1127,10 @@ cout << DMoji;
                 ListCount++;
             } else
             {
-                vMoji.push_back(DMoji);
+                if( handler )
+                    handler->OnMoji(DMoji);
+                else
+                    vMoji.push_back(DMoji);
                 MojiCount++;
             }
         }
@@ -1129,7 +1146,10 @@ cout << DSolid;
                 ListCount++;
             } else
             {
-                vSolid.push_back(DSolid);
+                if( handler )
+                    handler->OnSolid(DSolid);
+                else
+                    vSolid.push_back(DSolid);
                 SolidCount++;
             }
         }
@@ -1145,7 +1165,10 @@ cout << DBlock;
                 ListCount++;
             } else
             {
-                vBlock.push_back(DBlock);
+                if( handler )
+                    handler->OnBlock(DBlock);
+                else
+                    vBlock.push_back(DBlock);
                 BlockCount++;
             }
         }
@@ -1161,7 +1184,10 @@ cout << DSunpou;
                 ListCount++;
             } else
             {
-                vSunpou.push_back(DSunpou);
+                if( handler )
+                    handler->OnSunpou(DSunpou);
+                else
+                    vSunpou.push_back(DSunpou);
                 SunpouCount++;
             }
         }
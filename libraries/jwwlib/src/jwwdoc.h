@@ -918,6 +918,21 @@ public:
 	void AddItem(int No,string& str);
 };
 
+//Receives the shapes outside of block definitions while they are read,
+//instead of collecting them in the vectors of JWWDocument
+class	JWWShapeHandler
+{
+public:
+	virtual ~JWWShapeHandler(){}
+	virtual void OnSen(CDataSen& D) = 0;
+	virtual void OnEnko(CDataEnko& D) = 0;
+	virtual void OnTen(CDataTen& D) = 0;
+	virtual void OnMoji(CDataMoji& D) = 0;
+	virtual void OnSolid(CDataSolid& D) = 0;
+	virtual void OnSunpou(CDataSunpou& D) = 0;
+	virtual void OnBlock(CDataBlock& D) = 0;
+};
+
 //JWWファイル入出力クラス
 class	JWWDocument
 {
@@ -998,6 +1013,8 @@ public:
 	jwBOOL ReadHeader();
 	jwBOOL WriteHeader();
 	jwBOOL Read();
+	//reads the file and passes the shapes to the handler, the vectors stay empty
+	jwBOOL Read(JWWShapeHandler* handler);
 	jwBOOL Save();
 	jwBOOL SaveBich16(jwDWORD id);
 	jwBOOL SaveSen(CDataSen const& DSen);
@@ -39,6 +39,7 @@ SOURCES += \
     src/intern/dwgreader.cpp \
     src/intern/dwgbuffer.cpp \
     src/intern/drw_dbg.cpp \
+    src/intern/drw_gzstream.cpp \
     src/intern/dwgreader21.cpp \
     src/intern/dwgreader18.cpp \
     src/intern/dwgreader15.cpp \
@@ -67,6 +68,8 @@ HEADERS += \
     src/intern/drw_cptable936.h \
     src/intern/drw_cptable932.h \
     src/intern/drw_dbg.h \
+    src/intern/drw_gzstream.h \
+    src/intern/drw_entityrecorder.h \
     src/intern/dwgreader21.h \
     src/intern/dwgreader18.h \
     src/intern/dwgreader15.h \
@@ -476,6 +476,7 @@ protected:
 public:
     UTF8STRING name;             /*!< block name, code 2 */
     int flags;                   /*!< block type, code 70 */
+    UTF8STRING xrefPath;         /*!< path of an external reference, code 1 */
 private:
     bool isEnd; //for dwg parsing
 };
@@ -0,0 +1,147 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2011-2015 José F. Soriano, rallazz@gmail.com               **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+#ifndef DRW_ENTITYRECORDER_H
+#define DRW_ENTITYRECORDER_H
+
+#include <functional>
+#include <vector>
+#include "../drw_interface.h"
+
+/**
+ * Records the entities decoded by a worker thread, to call the reading
+ * interface later in the reading thread. Only the entity callbacks are
+ * used by dxfRW::processEntities() and dwgReader::readDwgEntities().
+ */
+class DRW_EntityRecorder : public DRW_Interface {
+public:
+    using Call = std::function<void(DRW_Interface &)>;
+
+    void replay(DRW_Interface &iface) const {
+        for (const Call &call : calls)
+            call(iface);
+    }
+
+    void addHeader(const DRW_Header *) override {}
+    void addLType(const DRW_LType &) override {}
+    void addLayer(const DRW_Layer &) override {}
+    void addDimStyle(const DRW_Dimstyle &) override {}
+    void addVport(const DRW_Vport &) override {}
+    void addTextStyle(const DRW_Textstyle &) override {}
+    void addAppId(const DRW_AppId &) override {}
+    void addBlock(const DRW_Block &) override {}
+    void setBlock(const int) override {}
+    void endBlock() override {}
+    void addPoint(const DRW_Point &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addPoint(data);});
+    }
+    void addLine(const DRW_Line &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addLine(data);});
+    }
+    void addRay(const DRW_Ray &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addRay(data);});
+    }
+    void addXline(const DRW_Xline &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addXline(data);});
+    }
+    void addArc(const DRW_Arc &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addArc(data);});
+    }
+    void addCircle(const DRW_Circle &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addCircle(data);});
+    }
+    void addEllipse(const DRW_Ellipse &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addEllipse(data);});
+    }
+    void addLWPolyline(const DRW_LWPolyline &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addLWPolyline(data);});
+    }
+    void addPolyline(const DRW_Polyline &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addPolyline(data);});
+    }
+    void addSpline(const DRW_Spline *data) override {
+        calls.emplace_back([data = *data](DRW_Interface &i) {i.addSpline(&data);});
+    }
+    //not called for entities
+    void addKnot(const DRW_Entity &) override {}
+    void addInsert(const DRW_Insert &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addInsert(data);});
+    }
+    void addTrace(const DRW_Trace &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addTrace(data);});
+    }
+    void add3dFace(const DRW_3Dface &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.add3dFace(data);});
+    }
+    void addSolid(const DRW_Solid &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addSolid(data);});
+    }
+    void addMText(const DRW_MText &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addMText(data);});
+    }
+    void addText(const DRW_Text &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addText(data);});
+    }
+    void addDimAlign(const DRW_DimAligned *data) override {
+        calls.emplace_back([data = *data](DRW_Interface &i) {i.addDimAlign(&data);});
+    }
+    void addDimLinear(const DRW_DimLinear *data) override {
+        calls.emplace_back([data = *data](DRW_Interface &i) {i.addDimLinear(&data);});
+    }
+    void addDimRadial(const DRW_DimRadial *data) override {
+        calls.emplace_back([data = *data](DRW_Interface &i) {i.addDimRadial(&data);});
+    }
+    void addDimDiametric(const DRW_DimDiametric *data) override {
+        calls.emplace_back([data = *data](DRW_Interface &i) {i.addDimDiametric(&data);});
+    }
+    void addDimAngular(const DRW_DimAngular *data) override {
+        calls.emplace_back([data = *data](DRW_Interface &i) {i.addDimAngular(&data);});
+    }
+    void addDimAngular3P(const DRW_DimAngular3p *data) override {
+        calls.emplace_back([data = *data](DRW_Interface &i) {i.addDimAngular3P(&data);});
+    }
+    void addDimOrdinate(const DRW_DimOrdinate *data) override {
+        calls.emplace_back([data = *data](DRW_Interface &i) {i.addDimOrdinate(&data);});
+    }
+    void addLeader(const DRW_Leader *data) override {
+        calls.emplace_back([data = *data](DRW_Interface &i) {i.addLeader(&data);});
+    }
+    void addHatch(const DRW_Hatch *data) override {
+        calls.emplace_back([data = *data](DRW_Interface &i) {i.addHatch(&data);});
+    }
+    void addViewport(const DRW_Viewport &data) override {
+        calls.emplace_back([data](DRW_Interface &i) {i.addViewport(data);});
+    }
+    void addImage(const DRW_Image *data) override {
+        calls.emplace_back([data = *data](DRW_Interface &i) {i.addImage(&data);});
+    }
+    void linkImage(const DRW_ImageDef *) override {}
+    void addComment(const char *) override {}
+    void addPlotSettings(const DRW_PlotSettings *) override {}
+
+    void writeHeader(DRW_Header &) override {}
+    void writeBlocks() override {}
+    void writeBlockRecords() override {}
+    void writeEntities() override {}
+    void writeLTypes() override {}
+    void writeLayers() override {}
+    void writeTextstyles() override {}
+    void writeVports() override {}
+    void writeDimstyles() override {}
+    void writeObjects() override {}
+    void writeAppId() override {}
+
+private:
+    std::vector<Call> calls;
+};
+
+#endif // DRW_ENTITYRECORDER_H
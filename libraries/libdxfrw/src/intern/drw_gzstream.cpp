@@ -0,0 +1,278 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2011-2015 José F. Soriano, rallazz@gmail.com               **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <vector>
+#include <zlib.h>
+#include "drw_gzstream.h"
+#include "drw_dbg.h"
+
+namespace {
+//size of the compressed and decompressed blocks
+constexpr std::size_t gzipBlockSize = 1 << 18;
+//bytes kept before the read position, for the short backward seeks of the binary reader
+constexpr std::size_t gzipPutback = 64;
+//window bits of zlib for gzip streams
+constexpr int gzipWindowBits = 15 + 16;
+}
+
+/**
+ * Stream buffer decompressing a gzip stream read from another buffer.
+ * Concatenated gzip members are read as one stream.
+ */
+class DRW_GzInBuf : public std::streambuf {
+public:
+    explicit DRW_GzInBuf(std::streambuf *source):
+        m_source{source}
+        ,m_in(gzipBlockSize)
+        ,m_out(gzipPutback + gzipBlockSize)
+    {
+        m_good = inflateInit2(&m_stream, gzipWindowBits) == Z_OK;
+        setg(m_out.data(), m_out.data(), m_out.data());
+    }
+    ~DRW_GzInBuf() override {
+        if (m_good)
+            inflateEnd(&m_stream);
+    }
+
+protected:
+    int_type underflow() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+
+private:
+    std::streambuf *m_source;
+    z_stream m_stream {};
+    std::vector<char> m_in;
+    std::vector<char> m_out;
+    //decompressed offset of eback()
+    std::streamoff m_offset {0};
+    bool m_good {false};
+    bool m_end {false};
+};
+
+DRW_GzInBuf::int_type DRW_GzInBuf::underflow() {
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+    if (!m_good || m_end)
+        return traits_type::eof();
+
+    //keep the last bytes read before the new block
+    const auto read = static_cast<std::size_t>(gptr() - eback());
+    const std::size_t keep = std::min(read, gzipPutback);
+    std::memmove(m_out.data(), gptr() - keep, keep);
+    m_offset += static_cast<std::streamoff>(read - keep);
+
+    char *begin = m_out.data() + keep;
+    m_stream.next_out = reinterpret_cast<Bytef *>(begin);
+    m_stream.avail_out = static_cast<uInt>(m_out.size() - keep);
+    while (m_stream.avail_out == m_out.size() - keep) {
+        if (m_stream.avail_in == 0) {
+            const std::streamsize count = m_source->sgetn(m_in.data(), static_cast<std::streamsize>(m_in.size()));
+            if (count <= 0) {
+                m_end = true;
+                break;
+            }
+            m_stream.next_in = reinterpret_cast<Bytef *>(m_in.data());
+            m_stream.avail_in = static_cast<uInt>(count);
+        }
+        const int result = inflate(&m_stream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END) {
+            //next member, if any
+            if (inflateReset(&m_stream) != Z_OK)
+                m_end = true;
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            DRW_DBG("DRW_GzInBuf::underflow(): corrupted gzip stream\n");
+            m_end = true;
+            break;
+        }
+    }
+    char *end = m_out.data() + m_out.size() - m_stream.avail_out;
+    setg(m_out.data(), begin, end);
+    return begin < end ? traits_type::to_int_type(*gptr()) : traits_type::eof();
+}
+
+DRW_GzInBuf::pos_type DRW_GzInBuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                           std::ios_base::openmode which) {
+    const pos_type failed {off_type(-1)};
+    if ((which & std::ios_base::in) == 0 || dir == std::ios_base::end)
+        return failed;
+    const std::streamoff current = m_offset + (gptr() - eback());
+    const std::streamoff target = dir == std::ios_base::cur ? current + off : off;
+    if (target < m_offset)
+        return failed;
+    //decompress up to the target, skipped bytes are not kept
+    while (target > m_offset + (egptr() - eback())) {
+        setg(eback(), egptr(), egptr());
+        if (traits_type::eq_int_type(underflow(), traits_type::eof()))
+            return failed;
+    }
+    setg(eback(), eback() + (target - m_offset), egptr());
+    return pos_type(target);
+}
+
+/**
+ * Stream buffer compressing to a gzip stream written to another buffer.
+ */
+class DRW_GzOutBuf : public std::streambuf {
+public:
+    explicit DRW_GzOutBuf(std::streambuf *sink):
+        m_sink{sink}
+        ,m_in(gzipBlockSize)
+        ,m_out(gzipBlockSize)
+    {
+        m_good = deflateInit2(&m_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, gzipWindowBits,
+                              8, Z_DEFAULT_STRATEGY) == Z_OK;
+        setp(m_in.data(), m_in.data() + m_in.size());
+    }
+    ~DRW_GzOutBuf() override {
+        finish();
+        if (m_good)
+            deflateEnd(&m_stream);
+    }
+
+    //! compresses the pending data and writes the gzip trailer
+    bool finish() {
+        if (m_finished)
+            return m_good;
+        m_finished = true;
+        return deflateBuffer(Z_FINISH);
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!deflateBuffer(Z_NO_FLUSH))
+            return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+    int sync() override {
+        return deflateBuffer(Z_NO_FLUSH) ? 0 : -1;
+    }
+
+private:
+    bool deflateBuffer(int flush);
+
+    std::streambuf *m_sink;
+    z_stream m_stream {};
+    std::vector<char> m_in;
+    std::vector<char> m_out;
+    bool m_good {false};
+    bool m_finished {false};
+};
+
+bool DRW_GzOutBuf::deflateBuffer(int flush) {
+    if (!m_good || (m_finished && flush != Z_FINISH))
+        return false;
+    m_stream.next_in = reinterpret_cast<Bytef *>(pbase());
+    m_stream.avail_in = static_cast<uInt>(pptr() - pbase());
+    do {
+        m_stream.next_out = reinterpret_cast<Bytef *>(m_out.data());
+        m_stream.avail_out = static_cast<uInt>(m_out.size());
+        if (deflate(&m_stream, flush) == Z_STREAM_ERROR) {
+            m_good = false;
+            break;
+        }
+        const auto count = static_cast<std::streamsize>(m_out.size() - m_stream.avail_out);
+        if (m_sink->sputn(m_out.data(), count) != count) {
+            m_good = false;
+            break;
+        }
+    } while (m_stream.avail_out == 0);
+    setp(m_in.data(), m_in.data() + m_in.size());
+    return m_good;
+}
+
+bool DRW::isGzipName(const std::string &fileName) {
+    constexpr char suffix[] = ".gz";
+    constexpr std::size_t length = sizeof(suffix) - 1;
+    if (fileName.size() < length)
+        return false;
+    return std::equal(suffix, suffix + length, fileName.end() - length,
+                      [](char a, char b) {return a == std::tolower(static_cast<unsigned char>(b));});
+}
+
+DRW_FileIStream::DRW_FileIStream(const std::string &fileName):
+    std::istream(nullptr)
+{
+    if (nullptr == m_file.open(fileName, std::ios_base::in | std::ios_base::binary)) {
+        setstate(std::ios_base::failbit);
+        return;
+    }
+    unsigned char magic[2] {0, 0};
+    const bool isGzip = m_file.sgetn(reinterpret_cast<char *>(magic), 2) == 2
+        && magic[0] == 0x1f && magic[1] == 0x8b;
+    if (isGzip) {
+        //the trailer stores the decompressed size modulo 2^32
+        unsigned char trailer[4] {0, 0, 0, 0};
+        if (m_file.pubseekoff(-4, std::ios_base::end, std::ios_base::in) != std::streampos(-1)
+            && m_file.sgetn(reinterpret_cast<char *>(trailer), 4) == 4) {
+            m_size = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16)
+                | (static_cast<unsigned long long>(trailer[3]) << 24);
+        }
+    } else {
+        const std::streampos end = m_file.pubseekoff(0, std::ios_base::end, std::ios_base::in);
+        if (end != std::streampos(-1))
+            m_size = static_cast<unsigned long long>(end);
+    }
+    m_file.pubseekpos(0, std::ios_base::in);
+    if (isGzip) {
+        DRW_DBG("DRW_FileIStream: gzip compressed file\n");
+        m_gzip = std::make_unique<DRW_GzInBuf>(&m_file);
+        rdbuf(m_gzip.get());
+    } else {
+        rdbuf(&m_file);
+    }
+}
+
+DRW_FileIStream::~DRW_FileIStream() = default;
+
+DRW_FileOStream::DRW_FileOStream(const std::string &fileName, std::ios_base::openmode mode, bool compress):
+    std::ostream(nullptr)
+{
+    if (compress)
+        mode |= std::ios_base::binary;
+    if (nullptr == m_file.open(fileName, mode | std::ios_base::out)) {
+        setstate(std::ios_base::failbit);
+        return;
+    }
+    if (compress) {
+        m_gzip = std::make_unique<DRW_GzOutBuf>(&m_file);
+        rdbuf(m_gzip.get());
+    } else {
+        rdbuf(&m_file);
+    }
+}
+
+DRW_FileOStream::~DRW_FileOStream() {
+    close();
+}
+
+bool DRW_FileOStream::close() {
+    if (!m_file.is_open())
+        return false;
+    flush();
+    bool isOk = good();
+    if (m_gzip)
+        isOk = m_gzip->finish() && isOk;
+    isOk = m_file.close() != nullptr && isOk;
+    if (!isOk)
+        setstate(std::ios_base::badbit);
+    return isOk;
+}
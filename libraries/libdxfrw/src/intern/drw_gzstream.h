@@ -0,0 +1,70 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2011-2015 José F. Soriano, rallazz@gmail.com               **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+#ifndef DRW_GZSTREAM_H
+#define DRW_GZSTREAM_H
+
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+class DRW_GzInBuf;
+class DRW_GzOutBuf;
+
+namespace DRW {
+    //! true if the file name has the suffix of gzip compressed files, as drawing.dxf.gz
+    bool isGzipName(const std::string &fileName);
+}
+
+/**
+ * Input stream of a file, gzip compressed files are detected by their
+ * header and decompressed while reading.
+ * Seeking is limited to the recently read bytes and forward skips
+ * for compressed files.
+ */
+class DRW_FileIStream : public std::istream {
+public:
+    explicit DRW_FileIStream(const std::string &fileName);
+    ~DRW_FileIStream() override;
+
+    bool is_open() const {return m_file.is_open();}
+    bool isCompressed() const {return nullptr != m_gzip;}
+    //! size of the decompressed content, as stored by the gzip trailer
+    unsigned long long size() const {return m_size;}
+
+private:
+    std::filebuf m_file;
+    std::unique_ptr<DRW_GzInBuf> m_gzip;
+    unsigned long long m_size {0};
+};
+
+/**
+ * Output stream of a file, optionally compressed with gzip.
+ * Compressed files are always written in binary mode.
+ */
+class DRW_FileOStream : public std::ostream {
+public:
+    DRW_FileOStream(const std::string &fileName, std::ios_base::openmode mode, bool compress);
+    ~DRW_FileOStream() override;
+
+    bool is_open() const {return m_file.is_open();}
+    //! writes the pending data and the gzip trailer, returns false on write errors
+    bool close();
+
+private:
+    std::filebuf m_file;
+    std::unique_ptr<DRW_GzOutBuf> m_gzip;
+};
+
+#endif // DRW_GZSTREAM_H
@@ -3,6 +3,8 @@
 #include <iomanip>
 #include <algorithm>
 #include <cstring>
+#include <map>
+#include <mutex>
 #include "../drw_base.h"
 #include "drw_cptables.h"
 #include "drw_cptable932.h"
@@ -10,6 +12,82 @@
 #include "drw_cptable949.h"
 #include "drw_cptable950.h"
 
+namespace {
+//true if no byte of 's' has the high bit set, tested a word at a time
+bool isAscii(const std::string &s) {
+    const char *p = s.data();
+    const std::size_t n = s.size();
+    std::size_t i = 0;
+    for (; i + 4 * sizeof(duint64) <= n; i += 4 * sizeof(duint64)) {
+        duint64 w[4];
+        std::memcpy(w, p + i, sizeof(w));
+        if ((w[0] | w[1] | w[2] | w[3]) & 0x8080808080808080ULL)
+            return false;
+    }
+    for (; i < n; ++i) {
+        if (static_cast<unsigned char>(p[i]) & 0x80)
+            return false;
+    }
+    return true;
+}
+
+//true if 's' has no \U+ encoded text to translate
+bool hasNoEscape(const std::string &s) {
+    return s.find("\\U+") == std::string::npos;
+}
+
+typedef std::vector<std::pair<int, int>> ReverseTable;
+
+//unicode to double byte lookup for 'dt', built once and shared by all converters.
+//Pairs with the same unicode keep the table order, the first one is used as before
+const ReverseTable *reverseTable(const int dt[][2], int l) {
+    static std::mutex mutex;
+    static std::map<const int (*)[2], ReverseTable> tables;
+    std::lock_guard<std::mutex> lock(mutex);
+    ReverseTable &rt = tables[dt];
+    if (rt.empty()) {
+        rt.reserve(l);
+        for (int k = 0; k < l; k++)
+            rt.emplace_back(dt[k][1], dt[k][0]);
+        std::stable_sort(rt.begin(), rt.end(),
+                         [](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+            return a.first < b.first;
+        });
+    }
+    return &rt;
+}
+
+//returns the double byte code of unicode 'code' or -1 if not found
+int findDouble(const ReverseTable &rt, int code) {
+    auto it = std::lower_bound(rt.begin(), rt.end(), code,
+                               [](const std::pair<int, int> &a, int c) {
+        return a.first < c;
+    });
+    return (it != rt.end() && it->first == code) ? it->second : -1;
+}
+
+//returns the unicode of double byte 'code' searched in dt[sta,end) or -1 if not found,
+//the double byte codes are sorted in the tables
+int findUnicode(const int dt[][2], int sta, int end, int code) {
+    if (end <= sta)
+        return -1;
+    const int (*first)[2] = dt + sta;
+    const int (*last)[2] = dt + end;
+    auto it = std::lower_bound(first, last, code, [](const int (&a)[2], int c) {
+        return a[0] < c;
+    });
+    return (it != last && (*it)[0] == code) ? (*it)[1] : -1;
+}
+
+void appendDouble(std::string &result, int data) {
+    char d[3];
+    d[0] = data >> 8;
+    d[1] = data & 0xFF;
+    d[2]= '\0';
+    result += d; //translate from table
+}
+}
+
 DRW_TextCodec::DRW_TextCodec()
     : version{DRW::AC1021}
     , conv( new DRW_Converter(nullptr, 0) )
@@ -138,6 +216,8 @@ std::string DRW_TextCodec::fromUtf8(const std::string &s) {
 }
 
 std::string DRW_Converter::toUtf8(const std::string &s) {
+    if (hasNoEscape(s))
+        return s;
     std::string result;
     int j = 0;
     unsigned int i= 0;
@@ -164,6 +244,8 @@ std::string DRW_Converter::toUtf8(const std::string &s) {
 }
 
 std::string DRW_ConvTable::fromUtf8(const std::string &s) {
+    if (isAscii(s))
+        return s;
     std::string result;
     bool notFound;
     int code;
@@ -196,6 +278,8 @@ std::string DRW_ConvTable::fromUtf8(const std::string &s) {
 }
 
 std::string DRW_ConvTable::toUtf8(const std::string &s) {
+    if (isAscii(s) && hasNoEscape(s))
+        return s;
     std::string res;
     for ( auto it=s.begin() ; it < s.end(); ++it ) {
         unsigned char c = *it;
@@ -298,9 +382,18 @@ int DRW_Converter::decodeNum(const std::string &s, int *b){
 }
 
 
+DRW_ConvDBCSTable::DRW_ConvDBCSTable(const int *t,  const int *lt, const int dt[][2], int l)
+    :DRW_Converter(t, l)
+    ,leadTable{lt}
+    ,doubleTable{dt}
+    ,reverseTable{::reverseTable(dt, l)}
+{
+}
+
 std::string DRW_ConvDBCSTable::fromUtf8(const std::string &s) {
+    if (isAscii(s))
+        return s;
     std::string result;
-    bool notFound;
     int code;
 
     int j = 0;
@@ -313,20 +406,10 @@ std::string DRW_ConvDBCSTable::fromUtf8(const std::string &s) {
             code = decodeNum(part1, &l);
             j = i+l;
             i = j - 1;
-            notFound = true;
-                for (int k=0; k<cpLength; k++){
-                    if(doubleTable[k][1] == code) {
-                        int data = doubleTable[k][0];
-                        char d[3];
-                        d[0] = data >> 8;
-                        d[1] = data & 0xFF;
-                        d[2]= '\0';
-                        result += d; //translate from table
-                        notFound = false;
-                        break;
-                    }
-                }
-            if (notFound)
+            int data = findDouble(*reverseTable, code);
+            if (data >= 0)
+                appendDouble(result, data);
+            else
                 result += decodeText(code);
         } //direct conversion
     }
@@ -336,6 +419,8 @@ std::string DRW_ConvDBCSTable::fromUtf8(const std::string &s) {
 }
 
 std::string DRW_ConvDBCSTable::toUtf8(const std::string &s) {
+    if (isAscii(s) && hasNoEscape(s))
+        return s;
     std::string res;
     for (auto it=s.begin() ; it < s.end(); ++it ) {
         bool notFound = true;
@@ -358,14 +443,16 @@ std::string DRW_ConvDBCSTable::toUtf8(const std::string &s) {
         } else {//2 bytes
             ++it;
             int code = (c << 8) | static_cast<unsigned char >(*it);
-            int sta = leadTable[c-0x81];
-            int end = leadTable[c-0x80];
-            for (int k=sta; k<end; k++){
-                if(doubleTable[k][0] == code) {
-                    res += encodeNum(doubleTable[k][1]); //translate from table
-                    notFound = false;
-                    break;
-                }
+            int sta = 0;
+            int end = 0;
+            if (c < 0xFF) { //no lead byte 0xFF in tables
+                sta = leadTable[c-0x81];
+                end = leadTable[c-0x80];
+            }
+            int uni = findUnicode(doubleTable, sta, end, code);
+            if (uni >= 0) {
+                res += encodeNum(uni); //translate from table
+                notFound = false;
             }
         }
         //not found
@@ -376,10 +463,14 @@ std::string DRW_ConvDBCSTable::toUtf8(const std::string &s) {
 }
 
 DRW_Conv932Table::DRW_Conv932Table()
-    :DRW_Converter(DRW_Table932, CPLENGTH932) {
+    :DRW_Converter(DRW_Table932, CPLENGTH932)
+    ,reverseTable{::reverseTable(DRW_DoubleTable932, CPLENGTH932)}
+{
 }
 
 std::string DRW_Conv932Table::fromUtf8(const std::string &s) {
+    if (isAscii(s))
+        return s;
     std::string result;
     bool notFound;
     int code;
@@ -402,17 +493,10 @@ std::string DRW_Conv932Table::fromUtf8(const std::string &s) {
             }
             if (notFound && ( code<0xF8 || (code>0x390 && code<0x542) ||
                     (code>0x200F && code<0x9FA1) || code>0xF928 )) {
-                for (int k=0; k<cpLength; k++){
-                    if(DRW_DoubleTable932[k][1] == code) {
-                        int data = DRW_DoubleTable932[k][0];
-                        char d[3];
-                        d[0] = data >> 8;
-                        d[1] = data & 0xFF;
-                        d[2]= '\0';
-                        result += d; //translate from table
-                        notFound = false;
-                        break;
-                    }
+                int data = findDouble(*reverseTable, code);
+                if (data >= 0) {
+                    appendDouble(result, data);
+                    notFound = false;
                 }
             }
             if (notFound)
@@ -425,6 +509,8 @@ std::string DRW_Conv932Table::fromUtf8(const std::string &s) {
 }
 
 std::string DRW_Conv932Table::toUtf8(const std::string &s) {
+    if (isAscii(s) && hasNoEscape(s))
+        return s;
     std::string res;
     for (auto it=s.begin() ; it < s.end(); ++it ) {
         bool notFound = true;
@@ -457,12 +543,10 @@ std::string DRW_Conv932Table::toUtf8(const std::string &s) {
                 end = DRW_LeadTable932[c-0xC0];
             }
             if (end > 0) {
-                for (int k=sta; k<end; k++){
-                    if(DRW_DoubleTable932[k][0] == code) {
-                        res += encodeNum(DRW_DoubleTable932[k][1]); //translate from table
-                        notFound = false;
-                        break;
-                    }
+                int uni = findUnicode(DRW_DoubleTable932, sta, end, code);
+                if (uni >= 0) {
+                    res += encodeNum(uni); //translate from table
+                    notFound = false;
                 }
             }
         }
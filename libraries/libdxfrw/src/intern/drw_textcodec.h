@@ -3,6 +3,8 @@
 
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
 #include "../drw_base.h"
 
 class DRW_Converter;
@@ -11,6 +13,8 @@ class DRW_TextCodec
 {
 public:
     DRW_TextCodec();
+    DRW_TextCodec(const DRW_TextCodec &) = default;
+    DRW_TextCodec &operator=(const DRW_TextCodec &) = default;
     ~DRW_TextCodec();
     std::string fromUtf8(const std::string& s);
     std::string toUtf8(const std::string &s);
@@ -26,7 +30,8 @@ private:
 private:
     DRW::Version version{DRW::UNKNOWNV};
     std::string cp;
-    std::unique_ptr< DRW_Converter> conv;
+    //converters are stateless, copies of the codec share them
+    std::shared_ptr< DRW_Converter> conv;
 };
 
 class DRW_Converter
@@ -63,18 +68,15 @@ public:
 
 class DRW_ConvDBCSTable : public DRW_Converter {
 public:
-    DRW_ConvDBCSTable(const int *t,  const int *lt, const int dt[][2], int l)
-        :DRW_Converter(t, l)
-        ,leadTable{lt}
-        ,doubleTable{dt}
-    {}
+    DRW_ConvDBCSTable(const int *t,  const int *lt, const int dt[][2], int l);
 
     std::string fromUtf8(const std::string &s) override;
     std::string toUtf8(const std::string &s) override;
 private:
     const int *leadTable{nullptr};
     const int (*doubleTable)[2];
-
+    //pairs of unicode/double byte code sorted by unicode, shared by all converters
+    const std::vector<std::pair<int, int>> *reverseTable{nullptr};
 };
 
 class DRW_Conv932Table : public DRW_Converter {
@@ -82,7 +84,8 @@ public:
     DRW_Conv932Table();
     std::string fromUtf8(const std::string &s) override;
     std::string toUtf8(const std::string &s) override;
-
+private:
+    const std::vector<std::pair<int, int>> *reverseTable{nullptr};
 };
 
 #endif // DRW_TEXTCODEC_H
@@ -11,6 +11,18 @@
 ******************************************************************************/
 
 
+#include <cstring>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "dwgbuffer.h"
 #include "../libdwgr.h"
 #include "drw_textcodec.h"
@@ -144,6 +156,100 @@ bool dwgCharStream::read(duint8* s, duint64 n){
     return true;
 }
 
+const duint8* dwgCharStream::readInPlace(duint64 n){
+    if (n > (sz - pos))
+        return nullptr;
+    const duint8 *data = stream + pos;
+    pos += n;
+    return data;
+}
+
+#ifdef _WIN32
+dwgMappedFile::dwgMappedFile(const std::string &name){
+    fileHandle = CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (INVALID_HANDLE_VALUE == fileHandle) {
+        fileHandle = nullptr;
+        return;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0)
+        return;
+    mapHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (nullptr == mapHandle)
+        return;
+    void *view = MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+    if (nullptr == view)
+        return;
+    mapData = static_cast<const duint8*>(view);
+    sz = static_cast<duint64>(fileSize.QuadPart);
+}
+
+dwgMappedFile::~dwgMappedFile(){
+    if (nullptr != mapData)
+        UnmapViewOfFile(mapData);
+    if (nullptr != mapHandle)
+        CloseHandle(mapHandle);
+    if (nullptr != fileHandle)
+        CloseHandle(fileHandle);
+}
+#else
+dwgMappedFile::dwgMappedFile(const std::string &name){
+    int fd = open(name.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (0 == fstat(fd, &st) && st.st_size > 0) {
+        void *view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED != view) {
+            mapData = static_cast<const duint8*>(view);
+            sz = static_cast<duint64>(st.st_size);
+        }
+    }
+    //the mapping stays valid after closing the descriptor
+    close(fd);
+}
+
+dwgMappedFile::~dwgMappedFile(){
+    if (nullptr != mapData)
+        munmap(const_cast<duint8*>(mapData), static_cast<size_t>(sz));
+}
+#endif
+
+bool dwgMappedStream::setPos(duint64 p){
+    if (p >= sz)
+        return false;
+
+    pos = p;
+    return isOk;
+}
+
+bool dwgMappedStream::read(duint8* s, duint64 n){
+    if (n > (sz - pos)) {
+        memcpy(s, stream + pos, sz - pos);
+        pos = sz;
+        isOk = false;
+        return false;
+    }
+    memcpy(s, stream + pos, n);
+    pos += n;
+    return isOk;
+}
+
+const duint8* dwgMappedStream::readInPlace(duint64 n){
+    if (n > (sz - pos))
+        return nullptr;
+    const duint8 *data = stream + pos;
+    pos += n;
+    return data;
+}
+
+dwgBuffer::dwgBuffer(std::shared_ptr<const dwgMappedFile> file, DRW_TextCodec *dc)
+    :decoder{dc}
+    ,filestr{new dwgMappedStream(std::move(file))}
+    ,maxSize{filestr->size()}
+{}
+
 dwgBuffer::dwgBuffer(duint8 *buf, duint64 size, DRW_TextCodec *dc)
     :decoder{dc}
     ,filestr{new dwgCharStream(buf, size)}
@@ -846,6 +952,12 @@ bool dwgBuffer::getBytes(unsigned char *buf, duint64 size){
     return true;
 }
 
+const duint8* dwgBuffer::getBytesInPlace(duint64 size){
+    if (bitPos != 0 || !filestr->good())
+        return nullptr;
+    return filestr->readInPlace(size);
+}
+
 duint16 dwgBuffer::crc8(duint16 dx,dint32 start,dint32 end){
     duint64 pos = filestr->getPos();
     filestr->setPos(start);
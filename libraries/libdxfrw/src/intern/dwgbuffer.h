@@ -16,6 +16,7 @@
 #include <fstream>
 #include <sstream>
 #include <memory>
+#include <string>
 #include "../drw_base.h"
 
 class DRW_Coord;
@@ -32,6 +33,11 @@ public:
     virtual bool setPos(duint64 p) = 0;
     virtual bool good() const = 0;
     virtual dwgBasicStream* clone() const = 0;
+    /** returns the next n bytes and moves after them, only for streams in
+     * memory, nullptr (nothing read) by default */
+    virtual const duint8* readInPlace(duint64 /*n*/){return nullptr;}
+    /// true if clones can be read by several threads
+    virtual bool isInMemory() const {return false;}
 };
 
 class dwgFileStream: public dwgBasicStream{
@@ -66,6 +72,8 @@ public:
     bool setPos(duint64 p) override;
     bool good() const override {return isOk;}
     dwgBasicStream* clone() const override {return new dwgCharStream(stream, sz);}
+    const duint8* readInPlace(duint64 n) override;
+    bool isInMemory() const override {return true;}
 private:
     duint8 *stream{nullptr};
     duint64 sz{0};
@@ -73,10 +81,55 @@ private:
     bool isOk{true};
 };
 
+/** Read only memory mapping of a whole file, shared by the streams reading it. */
+class dwgMappedFile {
+public:
+    explicit dwgMappedFile(const std::string &name);
+    ~dwgMappedFile();
+    dwgMappedFile(const dwgMappedFile&) = delete;
+    dwgMappedFile& operator=(const dwgMappedFile&) = delete;
+    /// false if the file can't be mapped (or is empty), the stream fallback should be used
+    bool isMapped() const {return nullptr != mapData;}
+    const duint8* data() const {return mapData;}
+    duint64 size() const {return sz;}
+private:
+    const duint8 *mapData{nullptr};
+    duint64 sz{0};
+#ifdef _WIN32
+    void *fileHandle{nullptr};
+    void *mapHandle{nullptr};
+#endif
+};
+
+/** Reads a mapped file in place, without seeks and copies from the file stream. */
+class dwgMappedStream: public dwgBasicStream{
+public:
+    explicit dwgMappedStream(std::shared_ptr<const dwgMappedFile> f)
+        :file{std::move(f)}
+        ,stream{file->data()}
+        ,sz{file->size()}
+    {}
+    bool read(duint8* s, duint64 n) override;
+    duint64 size() const override {return sz;}
+    duint64 getPos() const override {return pos;}
+    bool setPos(duint64 p) override;
+    bool good() const override {return isOk;}
+    dwgBasicStream* clone() const override {return new dwgMappedStream(file);}
+    const duint8* readInPlace(duint64 n) override;
+    bool isInMemory() const override {return true;}
+private:
+    std::shared_ptr<const dwgMappedFile> file;
+    const duint8 *stream{nullptr};
+    duint64 sz{0};
+    duint64 pos{0};
+    bool isOk{true};
+};
+
 class dwgBuffer {
 public:
     dwgBuffer(std::ifstream *stream, DRW_TextCodec *decoder = nullptr);
     dwgBuffer(duint8 *buf, duint64 size, DRW_TextCodec *decoder= nullptr);
+    explicit dwgBuffer(std::shared_ptr<const dwgMappedFile> file, DRW_TextCodec *decoder= nullptr);
     dwgBuffer( const dwgBuffer& org );
     dwgBuffer& operator=( const dwgBuffer& org );
     virtual ~dwgBuffer() = default;
@@ -131,7 +184,12 @@ public:
     duint16 getBERawShort16();  //RS big-endian order
 
     bool isGood() const {return filestr->good();}
+    /// true if copies of the buffer can be read by several threads
+    bool isInMemory() const {return filestr->isInMemory();}
     bool getBytes(duint8 *buf, duint64 size);
+    /** gets size bytes without copy when the buffer is in memory and byte
+     * aligned, nullptr (nothing read) otherwise, getBytes() should be used then */
+    const duint8* getBytesInPlace(duint64 size);
     int numRemainingBytes() const {return (maxSize- filestr->getPos());}
 
     duint16 crc8(duint16 dx,dint32 start,dint32 end);
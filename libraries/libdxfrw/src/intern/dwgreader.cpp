@@ -11,15 +11,22 @@
 ******************************************************************************/
 
 #include <cstdlib>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <future>
 #include <string>
 #include <sstream>
+#include <unordered_set>
 #include "dwgreader.h"
+#include "drw_entityrecorder.h"
 #include "drw_textcodec.h"
 #include "drw_dbg.h"
 
 namespace {
+    //entities decoded at once by each thread
+    constexpr std::size_t dwgEntityBatchSize = 4096;
+
     //helper function to cleanup pointers in Look Up Tables
     template<typename T>
     void mapCleanUp(std::unordered_map<duint32, T*>& table)
@@ -828,7 +835,7 @@ bool dwgReader::readDwgBlocks(DRW_Interface& intfa, dwgBuffer *dbuf){
     return ret;
 }
 
-bool dwgReader::readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf){
+bool dwgReader::readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf, EntityContext &ctx){
     bool ret = true;
     bool ret2 = true;
     objHandle oc;
@@ -845,7 +852,10 @@ bool dwgReader::readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf){
                 continue;
             } else {//foud entity reads it
                 oc = mit->second;
-                ObjectMap.erase(mit);
+                if (ctx.keepMap)
+                    ctx.vertices.push_back(nextH);
+                else
+                    ObjectMap.erase(mit);
                 DRW_Vertex vt;
                 dbuf->setPosition(oc.loc);
                 //RLZ: verify if pos is ok
@@ -861,14 +871,14 @@ bool dwgReader::readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf){
                 DRW_DBG(" object type= "); DRW_DBG(oType); DRW_DBG("\n");
                 ret2 = vt.parseDwg(version, &buff, bs, pline.basePoint.z);
                 pline.addVertex(vt);
-                nextEntLink = vt.nextEntLink; \
-                prevEntLink = vt.prevEntLink;
+                ctx.nextEntLink = vt.nextEntLink;
+                ctx.prevEntLink = vt.prevEntLink;
                 ret = ret && ret2;
             }
             if (nextH == pline.lastEH)
                 nextH = 0; //redundant, but prevent read errors
             else
-                nextH = nextEntLink;
+                nextH = ctx.nextEntLink;
         }
     } else {//2004+
         for (std::list<duint32>::iterator it = pline.hadlesList.begin() ; it != pline.hadlesList.end(); ++it){
@@ -880,7 +890,10 @@ bool dwgReader::readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf){
                 continue;
             } else {//foud entity reads it
                 oc = mit->second;
-                ObjectMap.erase(mit);
+                if (ctx.keepMap)
+                    ctx.vertices.push_back(nextH);
+                else
+                    ObjectMap.erase(mit);
                 DRW_DBG("\nPline vertex, parsing entity: "); DRW_DBGH(oc.handle); DRW_DBG(", pos: "); DRW_DBG(oc.loc); DRW_DBG("\n");
                 DRW_Vertex vt;
                 dbuf->setPosition(oc.loc);
@@ -897,31 +910,107 @@ bool dwgReader::readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf){
                 DRW_DBG(" object type= "); DRW_DBG(oType); DRW_DBG("\n");
                 ret2 = vt.parseDwg(version, &buff, bs, pline.basePoint.z);
                 pline.addVertex(vt);
-                nextEntLink = vt.nextEntLink; \
-                prevEntLink = vt.prevEntLink;
+                ctx.nextEntLink = vt.nextEntLink;
+                ctx.prevEntLink = vt.prevEntLink;
                 ret = ret && ret2;
             }
         }
     }//end 2004+
     DRW_DBG("\nRemoved SEQEND entity: "); DRW_DBGH(pline.seqEndH.ref);DRW_DBG("\n");
-    ObjectMap.erase(pline.seqEndH.ref);
+    if (ctx.keepMap)
+        ctx.vertices.push_back(pline.seqEndH.ref);
+    else
+        ObjectMap.erase(pline.seqEndH.ref);
 
     return ret;
 }
 
+std::vector<duint32> dwgReader::sortedHandles(const std::unordered_map<duint32, objHandle> &map){
+    std::vector<duint32> handles;
+    handles.reserve(map.size());
+    for (const auto &it : map)
+        handles.push_back(it.first);
+    std::sort(handles.begin(), handles.end());
+    return handles;
+}
+
+/**
+ * Reads the entities in handle order. When the data is in memory, the
+ * entities are decoded by several threads and delivered in the same order.
+ */
 bool dwgReader::readDwgEntities(DRW_Interface& intfa, dwgBuffer *dbuf){
     bool ret = true;
 
     DRW_DBG("\nobject map total size= "); DRW_DBG(ObjectMap.size());
-    auto itB=ObjectMap.begin();
-    auto itE=ObjectMap.end();
-    while (itB != itE) {
+    const std::vector<duint32> handles = sortedHandles(ObjectMap);
+    if (readThreads > 1 && dbuf->isInMemory() && DRW_DBGGL != DRW_dbg::Level::Debug) {
+        ret = readDwgEntitiesParallel(intfa, dbuf, handles);
+        ObjectMap.clear();
+        return ret;
+    }
+
+    for (duint32 handle : handles) {
+        auto it = ObjectMap.find(handle);
+        if (it == ObjectMap.end())
+            continue; //vertex read with its polyline
         if (ret) {
             // once readDwgEntity() failed, just clear the ObjectMap
-            ret = readDwgEntity( dbuf, itB->second, intfa);
+            ret = readDwgEntity( dbuf, it->second, intfa);
+        }
+        ObjectMap.erase(handle);
+    }
+    return ret;
+}
+
+bool dwgReader::readDwgEntitiesParallel(DRW_Interface& intfa, dwgBuffer *dbuf, const std::vector<duint32> &handles){
+    DRW_DBG("\nreadDwgEntitiesParallel\n");
+    struct Decoded {
+        objHandle obj;
+        DRW_EntityRecorder recorder;
+        EntityContext ctx;
+        bool ret{false};
+    };
+    //ObjectMap is only read while decoding
+    auto decode = [this, dbuf](Decoded *first, Decoded *last) {
+        dwgBuffer buf(*dbuf);
+        for (Decoded *d = first; d != last; ++d) {
+            d->ctx.keepMap = true;
+            d->ret = decodeDwgEntity(&buf, d->obj, d->recorder, d->ctx);
+        }
+    };
+
+    bool ret = true;
+    std::unordered_set<duint32> vertices;
+    const std::size_t batchSize = dwgEntityBatchSize * static_cast<std::size_t>(readThreads);
+    for (std::size_t batchFirst = 0; ret && batchFirst < handles.size(); batchFirst += batchSize) {
+        const std::size_t count = std::min(batchSize, handles.size() - batchFirst);
+        std::vector<Decoded> decoded(count);
+        for (std::size_t i = 0; i < count; ++i)
+            decoded[i].obj = ObjectMap[handles[batchFirst + i]];
+
+        const std::size_t perThread = (count + readThreads - 1) / readThreads;
+        std::vector<std::future<void>> done;
+        for (std::size_t first = perThread; first < count; first += perThread) {
+            const std::size_t last = std::min(count, first + perThread);
+            done.push_back(std::async(std::launch::async, decode, decoded.data() + first, decoded.data() + last));
+        }
+        decode(decoded.data(), decoded.data() + std::min(count, perThread));
+        for (auto &d : done)
+            d.get();
+
+        //deliver in handle order, as read sequentially
+        for (Decoded &d : decoded) {
+            if (vertices.count(d.obj.handle) > 0)
+                continue; //vertex read with its polyline
+            d.recorder.replay(intfa);
+            if (!d.ret) {
+                ret = false;
+                break;
+            }
+            if (d.ctx.notEntity)
+                objObjectMap[d.obj.handle] = d.obj;
+            vertices.insert(d.ctx.vertices.begin(), d.ctx.vertices.end());
         }
-        ObjectMap.erase( itB);
-        itB = ObjectMap.begin();
     }
     return ret;
 }
@@ -930,10 +1019,24 @@ bool dwgReader::readDwgEntities(DRW_Interface& intfa, dwgBuffer *dbuf){
  * Reads a dwg drawing entity (dwg object entity) given its offset in the file
  */
 bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa){
+    EntityContext ctx;
+    bool ret = decodeDwgEntity(dbuf, obj, intfa, ctx);
+    nextEntLink = ctx.nextEntLink;
+    prevEntLink = ctx.prevEntLink;
+    if (ctx.notEntity)
+        objObjectMap[obj.handle]= obj;
+    return ret;
+}
+
+/**
+ * Decodes an entity, only reading the reader state, so entities can be
+ * decoded in parallel with own buffers and contexts.
+ */
+bool dwgReader::decodeDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa, EntityContext &ctx){
     bool ret = true;
     duint32 bs = 0;
 
-    nextEntLink = prevEntLink = 0;// set to 0 to skip unimplemented entities
+    ctx.nextEntLink = ctx.prevEntLink = 0;// set to 0 to skip unimplemented entities
     dbuf->setPosition(obj.loc);
     //verify if position is ok:
     if (!dbuf->isGood()){
@@ -971,38 +1074,38 @@ bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
     switch (oType) {
         case 17: {
             DRW_Arc e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addArc(e);
             }
             break; }
         case 18: {
             DRW_Circle e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addCircle(e);
             }
             break; }
         case 19:{
             DRW_Line e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addLine(e);
             }
             break;}
         case 27: {
             DRW_Point e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addPoint(e);
             }
             break; }
         case 35: {
             DRW_Ellipse e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addEllipse(e);
             }
             break; }
         case 7:
         case 8: {//minsert = 8
             DRW_Insert e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 e.name = findTableName(DRW::BLOCK_RECORD,
                                        e.blockRecH.ref);//RLZ: find as block or blockrecord (ps & ps0)
                 intfa.addInsert(e);
@@ -1010,119 +1113,119 @@ bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
             break; }
         case 77: {
             DRW_LWPolyline e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addLWPolyline(e);
             }
             break; }
         case 1: {
             DRW_Text e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 e.style = findTableName(DRW::STYLE, e.styleH.ref);
                 intfa.addText(e);
             }
             break; }
         case 44: {
             DRW_MText e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 e.style = findTableName(DRW::STYLE, e.styleH.ref);
                 intfa.addMText(e);
             }
             break; }
         case 28: {
             DRW_3Dface e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.add3dFace(e);
             }
             break; }
         case 20: {
             DRW_DimOrdinate e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
                 intfa.addDimOrdinate(&e);
             }
             break; }
         case 21: {
             DRW_DimLinear e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
                 intfa.addDimLinear(&e);
             }
             break; }
         case 22: {
             DRW_DimAligned e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
                 intfa.addDimAlign(&e);
             }
             break; }
         case 23: {
             DRW_DimAngular3p e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
                 intfa.addDimAngular3P(&e);
             }
             break; }
         case 24: {
             DRW_DimAngular e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
                 intfa.addDimAngular(&e);
             }
             break; }
         case 25: {
             DRW_DimRadial e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
                 intfa.addDimRadial(&e);
             }
             break; }
         case 26: {
             DRW_DimDiametric e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
                 intfa.addDimDiametric(&e);
             }
             break; }
         case 45: {
             DRW_Leader e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
                 intfa.addLeader(&e);
             }
             break; }
         case 31: {
             DRW_Solid e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addSolid(e);
             }
             break; }
         case 78: {
             DRW_Hatch e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addHatch(&e);
             }
             break; }
         case 32: {
             DRW_Trace e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addTrace(e);
             }
             break; }
         case 34: {
             DRW_Viewport e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addViewport(e);
             }
             break; }
         case 36: {
             DRW_Spline e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addSpline(&e);
             }
             break; }
         case 40: {
             DRW_Ray e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addRay(e);
             }
             break; }
@@ -1130,8 +1233,8 @@ bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
         case 16:    // pline 3D
         case 29: {  // pline PFACE
             DRW_Polyline e;
-            if (entryParse( e, buff, bs, ret)) {
-                readPlineVertex(e, dbuf);
+            if (entryParse( e, buff, bs, ret, ctx)) {
+                readPlineVertex(e, dbuf, ctx);
                 intfa.addPolyline(e);
             }
             break; }
@@ -1142,20 +1245,20 @@ bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
 //            break; }
         case 41: {
             DRW_Xline e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addXline(e);
             }
             break; }
         case 101: {
             DRW_Image e;
-            if (entryParse( e, buff, bs, ret)) {
+            if (entryParse( e, buff, bs, ret, ctx)) {
                 intfa.addImage(&e);
             }
             break; }
 
         default:
             //not supported or are object add to remaining map
-            objObjectMap[obj.handle]= obj;
+            ctx.notEntity = true;
             break;
     }
     if (!ret){
@@ -1171,16 +1274,14 @@ bool dwgReader::readDwgObjects(DRW_Interface& intfa, dwgBuffer *dbuf){
     duint32 i=0;
     DRW_DBG("\nentities map total size= "); DRW_DBG(ObjectMap.size());
     DRW_DBG("\nobjects map total size= "); DRW_DBG(objObjectMap.size());
-    auto itB=objObjectMap.begin();
-    auto itE=objObjectMap.end();
-    while (itB != itE){
+    //only image definitions are decoded, not worth decoding in parallel
+    for (duint32 handle : sortedHandles(objObjectMap)) {
         if (ret) {
             // once readDwgObject() failed, just clear the ObjectMap
-            ret = readDwgObject(dbuf, itB->second, intfa);
+            ret = readDwgObject(dbuf, objObjectMap[handle], intfa);
         }
-        objObjectMap.erase(itB);
-        itB=objObjectMap.begin();
     }
+    objObjectMap.clear();
     if (DRW_DBGGL == DRW_dbg::Level::Debug) {
         for (auto it=remainingMap.begin(); it != remainingMap.end(); ++it){
             DRW_DBG("\nnum.# "); DRW_DBG(i++); DRW_DBG(" Remaining object Handle, loc, type= "); DRW_DBG(it->first);
@@ -16,6 +16,7 @@
 #include <unordered_map>
 #include <list>
 #include <memory>
+#include <vector>
 #include "drw_textcodec.h"
 #include "dwgutil.h"
 #include "dwgbuffer.h"
@@ -139,7 +140,17 @@ protected:
     virtual bool readDwgEntities(DRW_Interface& intfa) = 0;
     virtual bool readDwgObjects(DRW_Interface& intfa) = 0;
 
+    /// state of reading one entity, separate for the entities decoded in parallel
+    struct EntityContext {
+        duint32 nextEntLink{0};
+        duint32 prevEntLink{0};
+        bool notEntity{false};  //!< not a supported entity, to be read as object
+        bool keepMap{false};    //!< ObjectMap is read only, polyline vertices are listed
+        std::vector<duint32> vertices; //!< handles of the polyline vertices and seqend read
+    };
+
     virtual bool readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa);
+    bool decodeDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa, EntityContext &ctx);
     bool readDwgObject(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa);
     void parseAttribs(DRW_Entity* e);
     std::string findTableName(DRW::TTYPE table, dint32 handle);
@@ -153,8 +164,11 @@ protected:
 
     bool readDwgBlocks(DRW_Interface& intfa, dwgBuffer *dbuf);
     bool readDwgEntities(DRW_Interface& intfa, dwgBuffer *dbuf);
+    bool readDwgEntitiesParallel(DRW_Interface& intfa, dwgBuffer *dbuf, const std::vector<duint32> &handles);
     bool readDwgObjects(DRW_Interface& intfa, dwgBuffer *dbuf);
-    bool readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf);
+    bool readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf, EntityContext &ctx);
+    /// sorted handles of the objects in map
+    static std::vector<duint32> sortedHandles(const std::unordered_map<duint32, objHandle> &map);
 
 public:
     std::unordered_map<duint32, objHandle>ObjectMap;
@@ -175,6 +189,7 @@ protected:
     std::unique_ptr<dwgBuffer> fileBuf;
     dwgR *parent{nullptr};
     DRW::Version version{DRW::UNKNOWNV};
+    int readThreads{1}; //!< threads decoding entities, when the data is in memory
 
 //seeker (position) for the beginning sentinel of the image data (R13 to R15)
     duint32 previewImagePos;
@@ -193,12 +208,12 @@ protected:
 
 private:
     template <class T>
-    bool entryParse(T &e, dwgBuffer &buff, duint32 bs, bool &ret) {
+    bool entryParse(T &e, dwgBuffer &buff, duint32 bs, bool &ret, EntityContext &ctx) {
         ret = e.parseDwg( version, &buff, bs);
         if (ret) {
             parseAttribs(&e);
-            nextEntLink = e.nextEntLink;
-            prevEntLink = e.prevEntLink;
+            ctx.nextEntLink = e.nextEntLink;
+            ctx.prevEntLink = e.prevEntLink;
         }
 
         return ret;
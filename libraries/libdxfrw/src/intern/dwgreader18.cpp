@@ -46,7 +46,7 @@ void dwgReader18::genMagicNumber(){
     }
 }
 
-duint32 dwgReader18::checksum(duint32 seed, duint8* data, duint64 sz){
+duint32 dwgReader18::checksum(duint32 seed, const duint8* data, duint64 sz){
     duint64 size = sz;
     duint32 sum1 = seed & 0xffff;
     duint32 sum2 = seed >> 0x10;
@@ -79,9 +79,15 @@ bool dwgReader18::parseSysPage(duint8 *decompSec, duint32 decompSize){
         hdrData[i]=0;
     duint32 calcsH = checksum(0, hdrData, 20);
     DRW_DBG("Calc hdr checksum= "); DRW_DBGH(calcsH);
-    std::vector<duint8> tmpCompSec(compSize);
-    fileBuf->getBytes(tmpCompSec.data(), compSize);
-    duint32 calcsD = checksum(calcsH, tmpCompSec.data(), compSize);
+    //compressed data is used in place from mapped files
+    std::vector<duint8> tmpCompSec;
+    const duint8 *compSec = fileBuf->getBytesInPlace(compSize);
+    if (nullptr == compSec) {
+        tmpCompSec.resize(compSize);
+        fileBuf->getBytes(tmpCompSec.data(), compSize);
+        compSec = tmpCompSec.data();
+    }
+    duint32 calcsD = checksum(calcsH, compSec, compSize);
     DRW_DBG("\nCalc data checksum= "); DRW_DBGH(calcsD); DRW_DBG("\n");
 
 #ifdef DRW_DBG_DUMP
@@ -93,7 +99,7 @@ bool dwgReader18::parseSysPage(duint8 *decompSec, duint32 decompSize){
 #endif
     DRW_DBG("decompressing "); DRW_DBG(compSize); DRW_DBG(" bytes in "); DRW_DBG(decompSize); DRW_DBG(" bytes\n");
     dwgCompressor comp;
-    if (!comp.decompress18(tmpCompSec.data(), decompSec, compSize, decompSize)) {
+    if (!comp.decompress18(compSec, decompSec, compSize, decompSize)) {
         return false;
     }
 
@@ -151,14 +157,19 @@ bool dwgReader18::parseDataPage(const dwgSectionInfo &si/*, duint8 *dData*/){
         DRW_DBG("\n      data checksum= "); DRW_DBGH(bufHdr.getRawLong32()); DRW_DBG("\n");
 
         //get compressed data
-        std::vector<duint8> cData(pi.cSize);
         if (!fileBuf->setPosition(pi.address + 32)) {
             return false;
         }
-        fileBuf->getBytes(cData.data(), pi.cSize);
+        std::vector<duint8> tmpCData;
+        const duint8 *cData = fileBuf->getBytesInPlace(pi.cSize);
+        if (nullptr == cData) {
+            tmpCData.resize(pi.cSize);
+            fileBuf->getBytes(tmpCData.data(), pi.cSize);
+            cData = tmpCData.data();
+        }
 
         //calculate checksum
-        duint32 calcsD = checksum(0, cData.data(), pi.cSize);
+        duint32 calcsD = checksum(0, cData, pi.cSize);
         for (duint8 i= 24; i<28; ++i)
             hdrData[i]=0;
         duint32 calcsH = checksum(calcsD, hdrData, 32);
@@ -169,7 +180,7 @@ bool dwgReader18::parseDataPage(const dwgSectionInfo &si/*, duint8 *dData*/){
         pi.uSize = si.maxSize;
         DRW_DBG("decompressing "); DRW_DBG(pi.cSize); DRW_DBG(" bytes in "); DRW_DBG(pi.uSize); DRW_DBG(" bytes\n");
         dwgCompressor comp;
-        if (!comp.decompress18(cData.data(), oData, pi.cSize, pi.uSize)) {
+        if (!comp.decompress18(cData, oData, pi.cSize, pi.uSize)) {
             return false;
         }
     }
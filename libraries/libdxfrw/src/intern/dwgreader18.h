@@ -83,7 +83,7 @@ private:
 //    dwgBuffer* bufObj;
     bool parseSysPage(duint8 *decompSec, duint32 decompSize); //called: Section page map: 0x41630e3b
     bool parseDataPage(const dwgSectionInfo &si/*, duint8 *dData*/); //called ???: Section map: 0x4163003b
-    duint32 checksum(duint32 seed, duint8* data, duint64 sz);
+    duint32 checksum(duint32 seed, const duint8* data, duint64 sz);
 
 private:
     duint32 securityFlags;
@@ -65,10 +65,15 @@ bool dwgReader21::parseSysPage(duint64 sizeCompressed, duint64 sizeUncompressed,
 
     if (! fileBuf->setPosition(offset))
         return false;
-    std::vector<duint8> tmpDataRaw(fpsize);
-    fileBuf->getBytes(&tmpDataRaw.front(), fpsize);
+    std::vector<duint8> tmpDataRaw;
+    const duint8 *dataRaw = fileBuf->getBytesInPlace(fpsize);
+    if (nullptr == dataRaw) {
+        tmpDataRaw.resize(fpsize);
+        fileBuf->getBytes(&tmpDataRaw.front(), fpsize);
+        dataRaw = tmpDataRaw.data();
+    }
     std::vector<duint8> tmpDataRS(fpsize);
-    dwgRSCodec::decode239I(&tmpDataRaw.front(), &tmpDataRS.front(), fpsize/255);
+    dwgRSCodec::decode239I(dataRaw, &tmpDataRS.front(), fpsize/255);
 
     return dwgCompressor::decompress21(&tmpDataRS.front(), decompData, sizeCompressed, sizeUncompressed);
 }
@@ -80,12 +85,18 @@ bool dwgReader21::parseDataPage(const dwgSectionInfo &si, duint8 *dData){
         if (!fileBuf->setPosition(pi.address))
             return false;
 
-        std::vector<duint8> tmpPageRaw(pi.size);
-        fileBuf->getBytes(&tmpPageRaw.front(), pi.size);
+        //raw pages are decoded in place from mapped files
+        std::vector<duint8> tmpPageRaw;
+        const duint8 *pageRaw = fileBuf->getBytesInPlace(pi.size);
+        if (nullptr == pageRaw) {
+            tmpPageRaw.resize(pi.size);
+            fileBuf->getBytes(&tmpPageRaw.front(), pi.size);
+            pageRaw = tmpPageRaw.data();
+        }
     #ifdef DRW_DBG_DUMP
         DRW_DBG("\nSection OBJECTS raw data=\n");
         for (unsigned int i=0, j=0; i< pi.size;i++) {
-            DRW_DBGH( (unsigned char)tmpPageRaw[i]);
+            DRW_DBGH( (unsigned char)pageRaw[i]);
             if (j == 7) { DRW_DBG("\n"); j = 0;
             } else { DRW_DBG(", "); j++; }
         } DRW_DBG("\n");
@@ -94,7 +105,7 @@ bool dwgReader21::parseDataPage(const dwgSectionInfo &si, duint8 *dData){
         std::vector<duint8> tmpPageRS(pi.size);
 
         duint8 chunks =pi.size / 255;
-        dwgRSCodec::decode251I(&tmpPageRaw.front(), &tmpPageRS.front(), chunks);
+        dwgRSCodec::decode251I(pageRaw, &tmpPageRS.front(), chunks);
     #ifdef DRW_DBG_DUMP
         DRW_DBG("\nSection OBJECTS RS data=\n");
         for (unsigned int i=0, j=0; i< pi.size;i++) {
@@ -10,6 +10,8 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
 ******************************************************************************/
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include "drw_dbg.h"
 #include "dwgutil.h"
@@ -39,7 +41,7 @@ std::string toHexStr(int n){
  * @param out : output data (at least 239*blk bytes)
  * @param blk number of codewords ( 1 cw == 255 bytes)
  */
-void dwgRSCodec::decode239I(unsigned char *in, unsigned char *out, duint32 blk){
+void dwgRSCodec::decode239I(const unsigned char *in, unsigned char *out, duint32 blk){
     int k=0;
     unsigned char data[255];
     RScodec rsc(0x96, 8, 8); //(255, 239)
@@ -65,7 +67,7 @@ void dwgRSCodec::decode239I(unsigned char *in, unsigned char *out, duint32 blk){
  * @param out : output data (at least 251*blk bytes)
  * @param blk number of codewords ( 1 cw == 255 bytes)
  */
-void dwgRSCodec::decode251I(unsigned char *in, unsigned char *out, duint32 blk){
+void dwgRSCodec::decode251I(const unsigned char *in, unsigned char *out, duint32 blk){
     int k=0;
     unsigned char data[255];
     RScodec rsc(0xB8, 8, 2); //(255, 251)
@@ -85,7 +87,7 @@ void dwgRSCodec::decode251I(unsigned char *in, unsigned char *out, duint32 blk){
     }
 }
 
-duint8 *dwgCompressor::compressedBuffer {nullptr};
+const duint8 *dwgCompressor::compressedBuffer {nullptr};
 duint32 dwgCompressor::compressedSize {0};
 duint32 dwgCompressor::compressedPos {0};
 bool    dwgCompressor::compressedGood {true};
@@ -146,7 +148,7 @@ duint32 dwgCompressor::litLength18(){
     return cont + ll + 3;
 }
 
-bool dwgCompressor::decompress18(duint8 *cbuf, duint8 *dbuf, duint64 csize, duint64 dsize){
+bool dwgCompressor::decompress18(const duint8 *cbuf, duint8 *dbuf, duint64 csize, duint64 dsize){
     compressedBuffer = cbuf;
     decompBuffer = dbuf;
     compressedSize = csize;
@@ -164,9 +166,7 @@ bool dwgCompressor::decompress18(duint8 *cbuf, duint8 *dbuf, duint64 csize, duin
     duint32 litCount {litLength18()};
 
     //copy first literal length
-    for (duint32 i = 0; i < litCount && buffersGood(); ++i) {
-        decompSet( compressedByte());
-    }
+    copyLiterals( litCount);
 
     while (buffersGood()) {
         duint8 oc = compressedByte(); //next opcode
@@ -215,9 +215,8 @@ bool dwgCompressor::decompress18(duint8 *cbuf, duint8 *dbuf, duint64 csize, duin
             // only copy what we can fit
             compBytes = decompSize - decompPos;
         }
-        duint32 j {decompPos - compOffset - 1};
-        for (duint32 i = 0; i < compBytes && buffersGood(); i++) {
-            decompSet( decompByte( j++));
+        if (buffersGood()) {
+            copyMatch( decompPos - compOffset - 1, compBytes);
         }
 
         //copy "uncompressed data", if size allows
@@ -227,9 +226,7 @@ bool dwgCompressor::decompress18(duint8 *cbuf, duint8 *dbuf, duint64 csize, duin
             // only copy what we can fit
             litCount = decompSize - decompPos;
         }
-        for (duint32 i=0; i < litCount && buffersGood(); i++) {
-            decompSet( compressedByte());
-        }
+        copyLiterals( litCount);
     }
 
     DRW_DBG("WARNING dwgCompressor::decompress, bad out, Cpos: ");DRW_DBG(compressedPos);DRW_DBG(", Dpos: ");DRW_DBG(decompPos);DRW_DBG("\n");
@@ -294,6 +291,58 @@ bool dwgCompressor::buffersGood(void)
     return compressedGood && decompGood;
 }
 
+/**
+ * Copies count literal bytes from the compressed buffer, as many
+ * compressedByte() and decompSet() calls, but in one block.
+ */
+void dwgCompressor::copyLiterals(duint32 count)
+{
+    if (!buffersGood()) {
+        return;
+    }
+
+    const duint32 n {std::min({count, compressedSize - compressedPos, decompSize - decompPos})};
+    memcpy( decompBuffer + decompPos, compressedBuffer + compressedPos, n);
+    compressedPos += n;
+    decompPos += n;
+    if (n < count) {
+        //one of the buffers ends, sets the flags as byte wise copy
+        decompSet( compressedByte());
+    }
+}
+
+/**
+ * Copies count bytes from srcIndex in the decompressed buffer, as many
+ * decompSet( decompByte()) calls. The caller ensures count fits. Back
+ * references are copied in blocks, repeating the pattern if they overlap.
+ */
+void dwgCompressor::copyMatch(duint32 srcIndex, duint32 count)
+{
+    if (srcIndex < decompPos) {
+        duint8 *dst {decompBuffer + decompPos};
+        const duint32 distance {decompPos - srcIndex};
+        if (distance >= count) {
+            memcpy( dst, dst - distance, count);
+        } else if (1 == distance) {
+            memset( dst, dst[-1], count);
+        } else {
+            for (duint32 done = 0; done < count; done += distance) {
+                memcpy( dst + done, dst + done - distance, std::min( distance, count - done));
+            }
+        }
+        decompPos += count;
+        if (count > 0) {
+            decompGood = true;
+        }
+        return;
+    }
+
+    //corrupted reference
+    for (duint32 i = 0; i < count; ++i) {
+        decompSet( decompByte( srcIndex + i));
+    }
+}
+
 void dwgCompressor::decrypt18Hdr(duint8 *buf, duint64 size, duint64 offset){
     duint8 max = size / 4;
     duint32 secMask = 0x4164536b ^ offset;
@@ -329,7 +378,7 @@ duint32 dwgCompressor::litLength21(duint8 opCode)
     return length;
 }
 
-bool dwgCompressor::decompress21(duint8 *cbuf, duint8 *dbuf, duint64 csize, duint64 dsize){
+bool dwgCompressor::decompress21(const duint8 *cbuf, duint8 *dbuf, duint64 csize, duint64 dsize){
     compressedBuffer = cbuf;
     decompBuffer = dbuf;
     compressedSize = csize;
@@ -378,8 +427,7 @@ bool dwgCompressor::decompress21(duint8 *cbuf, duint8 *dbuf, duint64 csize, duin
                 compressedGood = false;
             }
             sourceOffset = decompPos - sourceOffset;
-            for (duint32 i=0; i< length; i++)
-                decompSet( decompByte( sourceOffset + i));
+            copyMatch( sourceOffset, length);
 
             length = opCode & 7;
             if ((length != 0) || (compressedPos >= compressedSize)) {
@@ -499,6 +547,27 @@ void dwgCompressor::copyBlock21(const duint32 length)
         return;
     }
 
+    if (buffersGood()
+            && length <= compressedSize - compressedPos
+            && length <= decompSize - decompPos) {
+        const duint8 *src {compressedBuffer + compressedPos};
+        duint8 *dst {decompBuffer + decompPos};
+        if (MaxBlock21Length == length) {
+            //full blocks are 4 swapped groups of 8 bytes
+            memcpy( dst, src + 24, 8);
+            memcpy( dst + 8, src + 16, 8);
+            memcpy( dst + 16, src + 8, 8);
+            memcpy( dst + 24, src, 8);
+        } else {
+            for (duint32 index = 0; length > index; ++index) {
+                dst[index] = src[order[index]];
+            }
+        }
+        decompPos += length;
+        compressedInc( length);
+        return;
+    }
+
     for (duint32 index = 0; (length > index) && buffersGood(); ++index) {
         decompSet( compressedByte( compressedPos + order[index]));
     }
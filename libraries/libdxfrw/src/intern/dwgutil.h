@@ -20,8 +20,8 @@ namespace DRW {
 }
 
 namespace dwgRSCodec {
-    void decode239I(duint8 *in, duint8 *out, duint32 blk);
-    void decode251I(duint8 *in, duint8 *out, duint32 blk);
+    void decode239I(const duint8 *in, duint8 *out, duint32 blk);
+    void decode251I(const duint8 *in, duint8 *out, duint32 blk);
 }
 
 class dwgCompressor {
@@ -33,10 +33,10 @@ class dwgCompressor {
 public:
     dwgCompressor()=default;
 
-    bool decompress18(duint8 *cbuf, duint8 *dbuf, duint64 csize, duint64 dsize);
+    bool decompress18(const duint8 *cbuf, duint8 *dbuf, duint64 csize, duint64 dsize);
     static void decrypt18Hdr(duint8 *buf, duint64 size, duint64 offset);
 //    static void decrypt18Data(duint8 *buf, duint32 size, duint32 offset);
-    static bool decompress21(duint8 *cbuf, duint8 *dbuf, duint64 csize, duint64 dsize);
+    static bool decompress21(const duint8 *cbuf, duint8 *dbuf, duint64 csize, duint64 dsize);
 
 private:
     duint32 litLength18();
@@ -54,10 +54,12 @@ private:
     static bool compressedInc(const dint32 inc = 1);
     static duint8 decompByte(const duint32 index);
     static void decompSet(const duint8 value);
+    static void copyLiterals(duint32 count);
+    static void copyMatch(duint32 srcIndex, duint32 count);
     static bool buffersGood(void);
     static void copyBlock21(const duint32 length);
 
-    static duint8 *compressedBuffer;
+    static const duint8 *compressedBuffer;
     static duint32 compressedSize;
     static duint32 compressedPos;
     static bool    compressedGood;
@@ -10,10 +10,15 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
 ******************************************************************************/
 
+#include <algorithm>
+#include <charconv>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <string>
+#include <locale>
 #include <sstream>
+#include <string_view>
 #include "dxfreader.h"
 #include "drw_textcodec.h"
 #include "drw_dbg.h"
@@ -95,137 +100,321 @@ bool dxfReader::readRec(int *codeData) {
         //break in binary files because the conduct is unpredictable
         return false;
 
-    return (filestr->good());
+    return isGood();
 }
+
+bool dxfReader::isGood() const {
+    return filestr->good();
+}
+
 int dxfReader::getHandleString(){
-    int res;
-#if defined(__APPLE__)
-    int Succeeded = sscanf ( strData.c_str(), "%x", &res );
-    if ( !Succeeded || Succeeded == EOF )
+    std::string_view text = strData;
+    const std::size_t first = text.find_first_not_of(" \t");
+    if (first == std::string_view::npos)
+        return 0;
+    text.remove_prefix(first);
+    int res = 0;
+    if (std::from_chars(text.data(), text.data() + text.size(), res, 16).ec != std::errc())
         res = 0;
-#else
-    std::istringstream Convert(strData);
-    if ( !(Convert >> std::hex >>res) )
-        res = 0;
-#endif
     return res;
 }
 
+namespace {
+//block size of binary dxf reads, the buffer grows for longer strings
+constexpr std::size_t binaryBlockSize = 1 << 20;
+//bytes kept before the read position, readCode() can step back 4 bytes
+constexpr std::size_t binaryHistory = 8;
+}
+
+dxfReaderBinary::dxfReaderBinary(std::istream *stream):
+    dxfReader(stream)
+    ,m_buffer(binaryBlockSize)
+{
+    skip = false;
+}
+
+bool dxfReaderBinary::fillBuffer() {
+    if (m_eof)
+        return false;
+    //keep the unread bytes and a few read ones at the start of the buffer
+    const std::size_t from = m_begin - std::min(m_begin, binaryHistory);
+    if (from > 0) {
+        std::memmove(m_buffer.data(), m_buffer.data() + from, m_end - from);
+        m_end -= from;
+        m_begin -= from;
+    }
+    if (m_end == m_buffer.size())
+        m_buffer.resize(2 * m_buffer.size());
+    filestr->read(m_buffer.data() + m_end, static_cast<std::streamsize>(m_buffer.size() - m_end));
+    const std::streamsize count = filestr->gcount();
+    m_end += static_cast<std::size_t>(count);
+    if (count <= 0 || !filestr->good())
+        m_eof = true;
+    return count > 0;
+}
+
+bool dxfReaderBinary::readBytes(void *data, std::size_t count) {
+    while (m_end - m_begin < count) {
+        if (!fillBuffer()) {
+            m_begin = m_end;
+            m_good = false;
+            return false;
+        }
+    }
+    std::memcpy(data, m_buffer.data() + m_begin, count);
+    m_begin += count;
+    return true;
+}
+
 bool dxfReaderBinary::readCode(int *code) {
-    unsigned short *int16p;
-    char buffer[2];
-    filestr->read(buffer,2);
-    int16p = (unsigned short *) buffer;
+    unsigned char buffer[2] {0, 0};
+    readBytes(buffer, 2);
+    unsigned short value = buffer[0] | (buffer[1] << 8);
 //exist a 32bits int (code 90) with 2 bytes???
-    if ((*code == 90) && (*int16p>2000)){
+    if ((*code == 90) && (value>2000) && m_begin >= 4){
         DRW_DBG(*code); DRW_DBG(" de 16bits\n");
-        filestr->seekg(-4, std::ios_base::cur);
-        filestr->read(buffer,2);
-        int16p = (unsigned short *) buffer;
+        m_begin -= 4;
+        readBytes(buffer, 2);
+        value = buffer[0] | (buffer[1] << 8);
     }
-    *code = *int16p;
+    *code = value;
     DRW_DBG(*code); DRW_DBG("\n");
 
-    return (filestr->good());
+    return m_good;
 }
 
 bool dxfReaderBinary::readString() {
-    type = STRING;
-    std::getline(*filestr, strData, '\0');
-    DRW_DBG(strData); DRW_DBG("\n");
-    return (filestr->good());
+    return readString(&strData);
 }
 
 bool dxfReaderBinary::readString(std::string *text) {
     type = STRING;
-    std::getline(*filestr, *text, '\0');
+    std::size_t searchFrom = m_begin;
+    for (;;) {
+        const void *found = std::memchr(m_buffer.data() + searchFrom, '\0', m_end - searchFrom);
+        if (nullptr != found) {
+            const auto end = static_cast<std::size_t>(static_cast<const char *>(found) - m_buffer.data());
+            text->assign(m_buffer.data() + m_begin, end - m_begin);
+            m_begin = end + 1;
+            break;
+        }
+        const std::size_t parsed = m_end - m_begin;
+        if (!fillBuffer()) {
+            //end of file without a terminator, as std::getline()
+            text->assign(m_buffer.data() + m_begin, m_end - m_begin);
+            m_begin = m_end;
+            m_good = false;
+            break;
+        }
+        searchFrom = m_begin + parsed;
+    }
     DRW_DBG(*text); DRW_DBG("\n");
-    return (filestr->good());
+    return m_good;
 }
 
 bool dxfReaderBinary::readBinary() {
     unsigned char chunklen {0};
 
-    filestr->read( reinterpret_cast<char *>(&chunklen), 1);
-    filestr->seekg( chunklen, std::ios_base::cur);
+    if (readBytes(&chunklen, 1)) {
+        while (m_end - m_begin < chunklen && fillBuffer()) {}
+        if (m_end - m_begin < chunklen)
+            m_good = false;
+        m_begin += std::min<std::size_t>(chunklen, m_end - m_begin);
+    }
     DRW_DBG( chunklen); DRW_DBG( " byte(s) binary data bypassed\n");
 
-    return (filestr->good());
+    return m_good;
 }
 
 bool dxfReaderBinary::readInt16() {
     type = INT32;
-    char buffer[2];
-    filestr->read(buffer,2);
-    intData = (int)((buffer[1] << 8) | buffer[0]);
+    unsigned char buffer[2] {0, 0};
+    readBytes(buffer, 2);
+    intData = static_cast<short>(buffer[0] | (buffer[1] << 8));
     DRW_DBG(intData); DRW_DBG("\n");
-    return (filestr->good());
+    return m_good;
 }
 
 bool dxfReaderBinary::readInt32() {
     type = INT32;
-    unsigned *int32p;
-    char buffer[4];
-    filestr->read(buffer,4);
-    int32p = (unsigned *) buffer;
-    intData = *int32p;
+    unsigned value {0};
+    readBytes(&value, 4);
+    intData = value;
     DRW_DBG(intData); DRW_DBG("\n");
-    return (filestr->good());
+    return m_good;
 }
 
 bool dxfReaderBinary::readInt64() {
     type = INT64;
-    unsigned long long int *int64p; //64 bits integer pointer
-    char buffer[8];
-    filestr->read(buffer,8);
-    int64p = (unsigned long long int *) buffer;
-    int64 = *int64p;
+    unsigned long long int value {0}; //64 bits integer
+    readBytes(&value, 8);
+    int64 = value;
     DRW_DBG(int64); DRW_DBG(" int64\n");
-    return (filestr->good());
+    return m_good;
 }
 
 bool dxfReaderBinary::readDouble() {
     type = DOUBLE;
-    double *result;
-    char buffer[8];
-    filestr->read(buffer,8);
-    result = (double *) buffer;
-    doubleData = *result;
+    double value {0.};
+    readBytes(&value, 8);
+    doubleData = value;
     DRW_DBG(doubleData); DRW_DBG("\n");
-    return (filestr->good());
+    return m_good;
 }
 
 //saved as int or add a bool member??
 bool dxfReaderBinary::readBool() {
-    char buffer[1];
-    filestr->read(buffer,1);
-    intData = (int)(buffer[0]);
+    char value {0};
+    readBytes(&value, 1);
+    intData = (int)(value);
     DRW_DBG(intData); DRW_DBG("\n");
-    return (filestr->good());
+    return m_good;
+}
+
+namespace {
+//block size of ascii dxf reads, the buffer grows for longer lines
+constexpr std::size_t asciiBlockSize = 1 << 20;
+
+std::string_view trimmed(std::string_view text) {
+    const std::size_t first = text.find_first_not_of(" \t");
+    if (first == std::string_view::npos)
+        return {};
+    const std::size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+//same results as atoi(), 0 for invalid input
+int toInt(std::string_view text) {
+    text = trimmed(text);
+    if (!text.empty() && '+' == text.front())
+        text.remove_prefix(1);
+    int value = 0;
+    if (std::from_chars(text.data(), text.data() + text.size(), value).ec != std::errc())
+        return 0;
+    return value;
+}
+
+bool toDouble(std::string_view text, double &value) {
+    text = trimmed(text);
+    if (!text.empty() && '+' == text.front())
+        text.remove_prefix(1);
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    value = 0.0;
+    return std::from_chars(text.data(), text.data() + text.size(), value).ec == std::errc();
+#else
+    //no floating point from_chars, locale independent stream parsing
+    std::istringstream sd{std::string{text}};
+    sd.imbue(std::locale::classic());
+    value = 0.0;
+    return static_cast<bool>(sd >> value);
+#endif
+}
+}
+
+dxfReaderAscii::dxfReaderAscii(std::istream *stream):
+    dxfReader(stream)
+    ,m_buffer(asciiBlockSize)
+    ,m_data{m_buffer.data()}
+{
+    skip = true;
+}
+
+dxfReaderAscii::dxfReaderAscii(std::string_view text):
+    dxfReader(nullptr)
+    ,m_data{text.data()}
+    ,m_end{text.size()}
+    ,m_eof{true}
+{
+    skip = true;
+}
+
+bool dxfReaderAscii::fillBuffer() {
+    if (m_eof)
+        return false;
+    //keep the partial line at the start of the buffer
+    if (m_begin > 0) {
+        std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+        m_end -= m_begin;
+        m_begin = 0;
+    }
+    if (m_end == m_buffer.size()) {
+        m_buffer.resize(2 * m_buffer.size());
+        m_data = m_buffer.data();
+    }
+    filestr->read(m_buffer.data() + m_end, static_cast<std::streamsize>(m_buffer.size() - m_end));
+    const std::streamsize count = filestr->gcount();
+    m_end += static_cast<std::size_t>(count);
+    if (count <= 0 || !filestr->good())
+        m_eof = true;
+    if (count > 0) {
+        m_bytesRead += static_cast<unsigned long long>(count);
+        if (m_progress && !m_progress(m_bytesRead)) {
+            DRW_DBG("dxfReaderAscii::fillBuffer(): reading cancelled\n");
+            m_eof = true;
+            m_end -= static_cast<std::size_t>(count);
+            return false;
+        }
+    }
+    return count > 0;
+}
+
+bool dxfReaderAscii::readLine(std::string_view &line) {
+    std::size_t searchFrom = m_begin;
+    for (;;) {
+        const char *data = m_data;
+        const void *found = std::memchr(data + searchFrom, '\n', m_end - searchFrom);
+        if (nullptr != found) {
+            const std::size_t eol = static_cast<std::size_t>(static_cast<const char *>(found) - data);
+            line = std::string_view(data + m_begin, eol - m_begin);
+            m_begin = eol + 1;
+            m_good = true;
+            return true;
+        }
+        const std::size_t parsed = m_end - m_begin;
+        if (!fillBuffer()) {
+            //end of file without a line terminator, as std::getline()
+            line = std::string_view(m_data + m_begin, m_end - m_begin);
+            m_begin = m_end;
+            m_good = false;
+            return false;
+        }
+        searchFrom = m_begin + parsed;
+    }
+}
+
+bool dxfReaderAscii::readRawRec(int *code, std::string_view *value) {
+    std::string_view text;
+    if (!readLine(text))
+        return false;
+    *code = toInt(text);
+    readLine(*value);
+    if (!value->empty() && value->back() == '\r')
+        value->remove_suffix(1);
+    return m_good;
 }
 
 bool dxfReaderAscii::readCode(int *code) {
-    std::string text;
-    std::getline(*filestr, text);
-    *code = atoi(text.c_str());
+    std::string_view text;
+    readLine(text);
+    *code = toInt(text);
     DRW_DBG(*code); DRW_DBG("\n");
-    return (filestr->good());
+    return m_good;
 }
 bool dxfReaderAscii::readString(std::string *text) {
     type = STRING;
-    std::getline(*filestr, *text);
-    if (!text->empty() && text->at(text->size()-1) == '\r')
-        text->erase(text->size()-1);
-    return (filestr->good());
+    std::string_view line;
+    readLine(line);
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    text->assign(line.data(), line.size());
+    return m_good;
 }
 
 bool dxfReaderAscii::readString() {
     type = STRING;
-    std::getline(*filestr, strData);
-    if (!strData.empty() && strData.at(strData.size()-1) == '\r')
-        strData.erase(strData.size()-1);
+    readString(&strData);
     DRW_DBG(strData); DRW_DBG("\n");
-    return (filestr->good());
+    return m_good;
 }
 
 bool dxfReaderAscii::readBinary() {
@@ -234,9 +423,9 @@ bool dxfReaderAscii::readBinary() {
 
 bool dxfReaderAscii::readInt16() {
     type = INT32;
-    std::string text;
-    if (readString(&text)){
-        intData = atoi(text.c_str());
+    std::string_view text;
+    if (readLine(text)){
+        intData = toInt(text);
         DRW_DBG(intData); DRW_DBG("\n");
         return true;
     } else
@@ -255,20 +444,14 @@ bool dxfReaderAscii::readInt64() {
 
 bool dxfReaderAscii::readDouble() {
     type = DOUBLE;
-    std::string text;
-    if (readString(&text)){
-#if defined(__APPLE__)
-        int succeeded=sscanf( & (text[0]), "%lg", &doubleData);
-        if(succeeded != 1) {
+    std::string_view text;
+    if (readLine(text)){
+        if (!toDouble(text, doubleData)) {
             DRW_DBG("dxfReaderAscii::readDouble(): reading double error: ");
-            DRW_DBG(text);
+            DRW_DBG(std::string(text));
             DRW_DBG('\n');
         }
-#else
-        std::istringstream sd(text);
-        sd >> doubleData;
         DRW_DBG(doubleData); DRW_DBG('\n');
-#endif
         return true;
     } else
         return false;
@@ -277,9 +460,9 @@ bool dxfReaderAscii::readDouble() {
 //saved as int or add a bool member??
 bool dxfReaderAscii::readBool() {
     type = BOOL;
-    std::string text;
-    if (readString(&text)){
-        intData = atoi(text.c_str());
+    std::string_view text;
+    if (readLine(text)){
+        intData = toInt(text);
         DRW_DBG(intData); DRW_DBG("\n");
         return true;
     } else
@@ -13,6 +13,11 @@
 #ifndef DXFREADER_H
 #define DXFREADER_H
 
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <string_view>
+#include <vector>
 #include "drw_textcodec.h"
 
 class dxfReader {
@@ -27,7 +32,7 @@ public:
     };
     enum TYPE type;
 public:
-    dxfReader(std::ifstream *stream){
+    dxfReader(std::istream *stream){
         filestr = stream;
         type = INVALID;
     }
@@ -47,6 +52,8 @@ public:
     void setCodePage(const std::string &c){decoder.setCodePage(c, true);}
     std::string getCodePage(){ return decoder.getCodePage();}
     void setIgnoreComments(const bool bValue) {m_bIgnoreComments = bValue;}
+    //! use the version and code page of another reader
+    void copyCodec(const dxfReader &other) {decoder = other.decoder;}
 
 protected:
     virtual bool readCode(int *code) = 0; //return true if successful (not EOF)
@@ -58,9 +65,11 @@ protected:
     virtual bool readInt64() = 0;
     virtual bool readDouble() = 0;
     virtual bool readBool() = 0;
+    //! state of the last read, as std::istream::good()
+    virtual bool isGood() const;
 
 protected:
-    std::ifstream *filestr;
+    std::istream *filestr;
     std::string strData;
     double doubleData;
     signed int intData; //32 bits integer
@@ -73,7 +82,7 @@ private:
 
 class dxfReaderBinary : public dxfReader {
 public:
-    dxfReaderBinary(std::ifstream *stream):dxfReader(stream){skip = false; }
+    dxfReaderBinary(std::istream *stream);
     bool readCode(int *code) override;
     bool readString(std::string *text) override;
     bool readString() override;
@@ -83,11 +92,29 @@ public:
     bool readInt64() override;
     bool readDouble() override;
     bool readBool() override;
+    bool isGood() const override {return m_good;}
+
+private:
+    /**
+     * Copies the next count bytes of the block buffer to data.
+     * Returns false, as std::istream::read() would leave the stream,
+     * if the end of the file was reached before.
+     */
+    bool readBytes(void *data, std::size_t count);
+    bool fillBuffer();
+
+    std::vector<char> m_buffer;
+    std::size_t m_begin {0};
+    std::size_t m_end {0};
+    bool m_eof {false};
+    bool m_good {true};
 };
 
 class dxfReaderAscii : public dxfReader {
 public:
-    dxfReaderAscii(std::ifstream *stream):dxfReader(stream){skip = true; }
+    dxfReaderAscii(std::istream *stream);
+    //! reads records from a text in memory, the text must outlive the reader
+    explicit dxfReaderAscii(std::string_view text);
     bool readCode(int *code) override;
     bool readString(std::string *text) override;
     bool readString() override;
@@ -97,6 +124,38 @@ public:
     bool readInt32() override;
     bool readInt64() override;
     bool readBool() override;
+    bool isGood() const override {return m_good;}
+
+    /**
+     * Reads the next record without interpreting its value.
+     * The value is valid until the next read.
+     */
+    bool readRawRec(int *code, std::string_view *value);
+
+    /**
+     * Sets a callback called with the count of bytes read after each block,
+     * reading stops if the callback returns false.
+     */
+    void setProgress(std::function<bool(unsigned long long)> progress) {m_progress = std::move(progress);}
+
+private:
+    /**
+     * Reads the next line from the block buffer, without the line terminator.
+     * The returned view is valid until the next call.
+     * Returns false, as std::getline() would leave the stream, if the end of the
+     * file was reached before a line terminator.
+     */
+    bool readLine(std::string_view &line);
+    bool fillBuffer();
+
+    std::vector<char> m_buffer;
+    const char *m_data {nullptr};
+    std::size_t m_begin {0};
+    std::size_t m_end {0};
+    bool m_eof {false};
+    bool m_good {true};
+    unsigned long long m_bytesRead {0};
+    std::function<bool(unsigned long long)> m_progress;
 };
 
 #endif // DXFREADER_H
@@ -11,11 +11,62 @@
 ******************************************************************************/
 
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <algorithm>
+#include <charconv>
+#include <locale>
+#include <sstream>
+#include <vector>
 #include "dxfwriter.h"
 
+namespace {
+//size of the blocks written to files
+constexpr std::size_t asciiBlockSize = 1 << 20;
+//size of the blocks copied from files written before
+constexpr long long copyBlockSize = 1 << 22;
+
+//appends value right aligned to width, as the stream operator with width()
+template <typename T>
+void appendNumber(std::string &out, T value, int width) {
+    char text[32];
+    const auto result = std::to_chars(text, text + sizeof(text), value);
+    for (auto length = result.ptr - text; length < width; ++length)
+        out.push_back(' ');
+    out.append(text, result.ptr);
+}
+
+//appends value as the stream operator with precision 16
+void appendDouble(std::string &out, double value) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    char text[32];
+    const auto result = std::to_chars(text, text + sizeof(text), value, std::chars_format::general, 16);
+    out.append(text, result.ptr);
+#else
+    //no floating point to_chars, locale independent stream formatting
+    std::ostringstream sd;
+    sd.imbue(std::locale::classic());
+    sd.precision(16);
+    sd << value;
+    out.append(sd.str());
+#endif
+}
+
+//appends the size lowest bytes of value, in little endian order
+void appendBytes(std::string &out, unsigned long long value, int size) {
+    char bytes[8];
+    for (int i = 0; i < size; ++i)
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    out.append(bytes, size);
+}
+
+//appends the group code of a binary record
+void appendCode(std::string &out, int code) {
+    appendBytes(out, static_cast<unsigned long long>(code), 2);
+}
+}
+
 //RLZ TODO change std::endl to x0D x0A (13 10)
 /*bool dxfWriter::readRec(int *codeData, bool skip) {
 //    std::string text;
@@ -91,6 +142,82 @@
     return (filestr->good());
 }*/
 
+dxfWriter::dxfWriter(std::ostream *stream):
+    filestr{stream}
+    ,m_out{&m_buffer}
+{
+    m_buffer.reserve(asciiBlockSize + 4096);
+    //the binary sentinel is written before
+    const std::streampos start = stream->tellp();
+    if (start != std::streampos(-1))
+        m_written = static_cast<long long>(start);
+}
+
+dxfWriter::dxfWriter(std::string *text):
+    m_out{text}
+{}
+
+dxfWriter::~dxfWriter() {
+    flush();
+}
+
+bool dxfWriter::flush() {
+    if (nullptr == filestr)
+        return true;
+    if (!m_buffer.empty()) {
+        filestr->write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_written += static_cast<long long>(m_buffer.size());
+        m_buffer.clear();
+    }
+    return filestr->good();
+}
+
+long long dxfWriter::position() const {
+    if (nullptr == filestr)
+        return static_cast<long long>(m_out->size());
+    return m_written + static_cast<long long>(m_buffer.size());
+}
+
+bool dxfWriter::copyFrom(std::istream &source, long long offset, long long size) {
+    if (nullptr == filestr || !flush())
+        return false;
+    source.clear();
+    if (!source.seekg(offset))
+        return false;
+    std::vector<char> block(static_cast<std::size_t>(std::min<long long>(size, copyBlockSize)));
+    while (size > 0) {
+        const auto count = static_cast<std::streamsize>(std::min<long long>(size, copyBlockSize));
+        if (!source.read(block.data(), count))
+            return false;
+        filestr->write(block.data(), count);
+        m_written += count;
+        size -= count;
+    }
+    return filestr->good();
+}
+
+bool dxfWriter::writeRecords(const std::string &records) {
+    if (nullptr != filestr && m_buffer.size() + records.size() >= asciiBlockSize) {
+        flush();
+        //large blocks are written without copy
+        if (records.size() >= asciiBlockSize) {
+            filestr->write(records.data(), static_cast<std::streamsize>(records.size()));
+            m_written += static_cast<long long>(records.size());
+            return filestr->good();
+        }
+    }
+    m_out->append(records);
+    return nullptr == filestr || filestr->good();
+}
+
+bool dxfWriter::endRecord() {
+    if (nullptr == filestr)
+        return true;
+    if (m_buffer.size() >= asciiBlockSize)
+        return flush();
+    return filestr->good();
+}
+
 bool dxfWriter::writeUtf8String(int code, std::string text) {
     std::string t = encoder.fromUtf8(text);
     return writeString(code, t);
@@ -104,12 +231,10 @@ bool dxfWriter::writeUtf8Caps(int code, std::string text) {
 }
 
 bool dxfWriterBinary::writeString(int code, std::string text) {
-    char bufcode[2];
-    bufcode[0] =code & 0xFF;
-    bufcode[1] =code  >> 8;
-    filestr->write(bufcode, 2);
-    *filestr << text << '\0';
-    return (filestr->good());
+    appendCode(*m_out, code);
+    m_out->append(text);
+    m_out->push_back('\0');
+    return endRecord();
 }
 
 /*bool dxfWriterBinary::readCode(int *code) {
@@ -143,99 +268,73 @@ bool dxfWriterBinary::writeString(int code, std::string text) {
 }*/
 
 bool dxfWriterBinary::writeInt16(int code, int data) {
-    char bufcode[2];
-    char buffer[2];
-    bufcode[0] =code & 0xFF;
-    bufcode[1] =code  >> 8;
-    buffer[0] =data & 0xFF;
-    buffer[1] =data  >> 8;
-    filestr->write(bufcode, 2);
-    filestr->write(buffer, 2);
-    return (filestr->good());
+    return writeInteger(code, data);
 }
-
 bool dxfWriterBinary::writeInt32(int code, int data) {
-    char buffer[4];
-    buffer[0] =code & 0xFF;
-    buffer[1] =code  >> 8;
-    filestr->write(buffer, 2);
-
-    buffer[0] =data & 0xFF;
-    buffer[1] =data  >> 8;
-    buffer[2] =data  >> 16;
-    buffer[3] =data  >> 24;
-    filestr->write(buffer, 4);
-    return (filestr->good());
+    return writeInteger(code, data);
 }
-
 bool dxfWriterBinary::writeInt64(int code, unsigned long long int data) {
-    char buffer[8];
-    buffer[0] =code & 0xFF;
-    buffer[1] =code  >> 8;
-    filestr->write(buffer, 2);
-
-    buffer[0] =data & 0xFF;
-    buffer[1] =data  >> 8;
-    buffer[2] =data  >> 16;
-    buffer[3] =data  >> 24;
-    buffer[4] =data  >> 32;
-    buffer[5] =data  >> 40;
-    buffer[6] =data  >> 48;
-    buffer[7] =data  >> 56;
-    filestr->write(buffer, 8);
-    return (filestr->good());
+    appendCode(*m_out, code);
+    appendBytes(*m_out, data, 8);
+    return endRecord();
 }
 
 bool dxfWriterBinary::writeDouble(int code, double data) {
-    char bufcode[2];
+    //counts written as double, as 76 in leaders
+    if (!((code > 9 && code < 60) || (code > 109 && code < 150) || (code > 209 && code < 240)
+            || (code > 459 && code < 470) || (code > 1009 && code < 1060)))
+        return writeInteger(code, static_cast<long long int>(data));
+    appendCode(*m_out, code);
+    //in the byte order of the host, as read by dxfReaderBinary
     char buffer[8];
-    bufcode[0] =code & 0xFF;
-    bufcode[1] =code  >> 8;
-    filestr->write(bufcode, 2);
-
-    unsigned char *val;
-    val = (unsigned char *) &data;
-    for (int i=0; i<8; i++) {
-        buffer[i] =val[i];
-    }
-    filestr->write(buffer, 8);
-    return (filestr->good());
+    std::memcpy(buffer, &data, 8);
+    m_out->append(buffer, 8);
+    return endRecord();
 }
 
 //saved as int or add a bool member??
 bool dxfWriterBinary::writeBool(int code, bool data) {
-    char buffer[1];
-    char bufcode[2];
-    bufcode[0] =code & 0xFF;
-    bufcode[1] =code  >> 8;
-    filestr->write(bufcode, 2);
-    buffer[0] = data;
-    filestr->write(buffer, 1);
-    return (filestr->good());
+    return writeInteger(code, data);
+}
+/**
+ * The size of integer data is given by the group code, as read by
+ * dxfReader::readRec(), not by the type of the value.
+ */
+bool dxfWriterBinary::writeInteger(int code, long long int data) {
+    int size = 2;
+    if ((code > 89 && code < 100) || (code > 419 && code < 430)
+            || (code > 439 && code < 460) || code == 1071)
+        size = 4;
+    else if (code > 159 && code < 170)
+        size = 8;
+    else if ((code > 179 && code < 210) || (code > 239 && code < 270)
+             || (code > 289 && code < 300))
+        size = 1;
+    appendCode(*m_out, code);
+    appendBytes(*m_out, static_cast<unsigned long long>(data), size);
+    return endRecord();
+}
+
+void dxfWriterAscii::writeCode(int code) {
+    appendNumber(*m_out, code, 3);
+    m_out->push_back('\n');
 }
 
-dxfWriterAscii::dxfWriterAscii(std::ofstream *stream):dxfWriter(stream){
-    filestr->precision(16);
+bool dxfWriterAscii::endLine() {
+    m_out->push_back('\n');
+    return endRecord();
 }
 
 bool dxfWriterAscii::writeString(int code, std::string text) {
-//    *filestr << code << std::endl << text << std::endl ;
-    filestr->width(3);
-    *filestr << std::right << code << '\n';
-    filestr->width(0);
-    *filestr << std::left << text << '\n';
-    /*    std::getline(*filestr, strData, '\0');
-    DBG(strData); DBG("\n");*/
-    return (filestr->good());
+    writeCode(code);
+    m_out->append(text);
+    return endLine();
 }
 
 bool dxfWriterAscii::writeInt16(int code, int data) {
-//    *filestr << std::right << code << std::endl << data << std::endl;
-    filestr->width(3);
-    *filestr << std::right << code << '\n';
-    filestr->width(5);
-    *filestr << data << '\n';
-    return (filestr->good());
+    writeCode(code);
+    appendNumber(*m_out, data, 5);
+    return endLine();
 }
 
 bool dxfWriterAscii::writeInt32(int code, int data) {
@@ -243,28 +342,21 @@ bool dxfWriterAscii::writeInt32(int code, int data) {
 }
 
 bool dxfWriterAscii::writeInt64(int code, unsigned long long int data) {
-//    *filestr << code << std::endl << data << std::endl;
-    filestr->width(3);
-    *filestr << std::right << code << '\n';
-    filestr->width(5);
-    *filestr << data << '\n';
-    return (filestr->good());
+    writeCode(code);
+    appendNumber(*m_out, data, 5);
+    return endLine();
 }
 
 bool dxfWriterAscii::writeDouble(int code, double data) {
-//    std::streamsize prec = filestr->precision();
-//    filestr->precision(12);
-//    *filestr << code << std::endl << data << std::endl;
-    filestr->width(3);
-    *filestr << std::right << code << '\n';
-    *filestr << data << '\n';
-//    filestr->precision(prec);
-    return (filestr->good());
+    writeCode(code);
+    appendDouble(*m_out, data);
+    return endLine();
 }
 
 //saved as int or add a bool member??
 bool dxfWriterAscii::writeBool(int code, bool data) {
-    *filestr << code << '\n' << data << '\n';
-    return (filestr->good());
+    appendNumber(*m_out, code, 0);
+    m_out->push_back('\n');
+    m_out->push_back(data ? '1' : '0');
+    return endLine();
 }
-
@@ -13,12 +13,21 @@
 #ifndef DXFWRITER_H
 #define DXFWRITER_H
 
+#include <istream>
+#include <ostream>
+#include <string>
 #include "drw_textcodec.h"
 
+/**
+ * Formats the records in a buffer, written to the stream in large blocks.
+ * Without a stream, the records are appended to a string.
+ */
 class dxfWriter {
 public:
-    dxfWriter(std::ofstream *stream){filestr = stream; /*count =0;*/}
-    virtual ~dxfWriter() = default;
+    dxfWriter(std::ostream *stream);
+    /// writes to text, used to write entities in worker threads
+    explicit dxfWriter(std::string *text);
+    virtual ~dxfWriter();
     virtual bool writeString(int code, std::string text) = 0;
     bool writeUtf8String(int code, std::string text);
     bool writeUtf8Caps(int code, std::string text);
@@ -31,32 +40,54 @@ public:
     void setVersion(const std::string &v, bool dxfFormat){encoder.setVersion(v, dxfFormat);}
     void setCodePage(const std::string &c){encoder.setCodePage(c, true);}
     std::string getCodePage(){return encoder.getCodePage();}
+    void copyCodec(const dxfWriter &other){encoder = other.encoder;}
+    /// appends records already formatted by another writer of the same type
+    bool writeRecords(const std::string &records);
+    /// writes pending data to the stream
+    bool flush();
+    /// bytes written since the start of the stream, including the pending ones
+    long long position() const;
+    /// appends size bytes of source starting at offset, records of a file written before
+    bool copyFrom(std::istream &source, long long offset, long long size);
 protected:
-    std::ofstream *filestr = nullptr;
+    /// writes the buffer to the stream when a block is full
+    bool endRecord();
+
+    std::ostream *filestr = nullptr;
+    std::string *m_out = nullptr; //!< m_buffer or the external text
 private:
+    std::string m_buffer;
+    long long m_written {0}; //!< bytes in the stream before m_buffer
     DRW_TextCodec encoder;
 };
 
 class dxfWriterBinary : public dxfWriter {
 public:
-    dxfWriterBinary(std::ofstream *stream):dxfWriter(stream){}
+    dxfWriterBinary(std::ostream *stream):dxfWriter(stream){}
+    explicit dxfWriterBinary(std::string *text):dxfWriter(text){}
     bool writeString(int code, std::string text) override;
     bool writeInt16(int code, int data) override;
     bool writeInt32(int code, int data) override;
     bool writeInt64(int code, unsigned long long int data) override;
     bool writeDouble(int code, double data) override;
     bool writeBool(int code, bool data) override;
+private:
+    bool writeInteger(int code, long long int data);
 };
 
 class dxfWriterAscii : public dxfWriter {
 public:
-    dxfWriterAscii(std::ofstream *stream);
+    dxfWriterAscii(std::ostream *stream):dxfWriter(stream){}
+    explicit dxfWriterAscii(std::string *text):dxfWriter(text){}
     bool writeString(int code, std::string text) override;
     bool writeInt16(int code, int data) override;
     bool writeInt32(int code, int data) override;
     bool writeInt64(int code, unsigned long long int data) override;
     bool writeDouble(int code, double data) override;
     bool writeBool(int code, bool data) override;
+private:
+    void writeCode(int code);
+    bool endLine();
 };
 
 #endif // DXFWRITER_H
@@ -14,6 +14,7 @@
 #include "libdwgr.h"
 #include <fstream>
 #include <algorithm>
+#include <memory>
 #include <sstream>
 #include "intern/drw_dbg.h"
 #include "intern/drw_textcodec.h"
@@ -248,8 +249,16 @@ bool dwgR::openFile(std::ifstream *filestr){
     if (!reader) {
         error = DRW::BAD_VERSION;
         filestr->close();
-    } else
+    } else {
+        reader->readThreads = readThreads;
+        //read from a mapping of the file if possible, without seeks and copies
+        auto mappedFile = std::make_shared<const dwgMappedFile>(fileName);
+        if (mappedFile->isMapped()) {
+            DRW_DBG("dwgR::read file mapped\n");
+            reader->fileBuf.reset(new dwgBuffer(mappedFile));
+        }
         isOk = true;
+    }
 
     return isOk;
 }
@@ -13,6 +13,7 @@
 #ifndef LIBDWGR_H
 #define LIBDWGR_H
 
+#include <algorithm>
 #include <string>
 #include <memory>
 #include <unordered_map>
@@ -35,6 +36,12 @@ public:
     DRW::error getError(){return error;}
 bool testReader();
     void setDebug(DRW::DebugLevel lvl);
+    /*!
+     * Sets the number of threads decoding the entities, used when the file or
+     * its sections are in memory. The interface is always called from the
+     * reading thread, in handle order.
+     */
+    void setReadThreads(int threads) {readThreads = std::max(1, threads);}
 
 private:
     bool openFile(std::ifstream *filestr);
@@ -49,6 +56,7 @@ private:
     std::string codePage;
     DRW_Interface *iface { nullptr };
     std::unique_ptr< dwgReader > reader;
+    int readThreads { 1 };
 
 };
 
@@ -15,16 +15,36 @@
 #include "libdxfrw.h"
 #include <fstream>
 #include <algorithm>
+#include <charconv>
+#include <deque>
+#include <functional>
+#include <future>
 #include <sstream>
 #include <cassert>
 #include "intern/drw_textcodec.h"
+#include "intern/drw_entityrecorder.h"
 #include "intern/dxfreader.h"
 #include "intern/dxfwriter.h"
+#include "intern/drw_gzstream.h"
 #include "intern/drw_dbg.h"
 #include "intern/dwgutil.h"
 
 #define FIRSTHANDLE 48
 
+namespace {
+//size of the entity chunks decoded by worker threads
+constexpr std::size_t entityChunkSize = 1 << 20;
+//number of entities written to memory at once by worker threads
+constexpr std::size_t entityRunSize = 4096;
+
+struct DRW_EntityChunk {
+    std::string text;
+    DRW_EntityRecorder recorder;
+    bool processed {false};
+    DRW::error error {DRW::BAD_NONE};
+};
+}
+
 /*enum sections {
     secUnknown,
     secHeader,
@@ -42,6 +62,26 @@ dxfRW::dxfRW(const char* name){
     applyExt = false;
     elParts = 128; //parts number when convert ellipse to polyline
 }
+dxfRW::dxfRW(const dxfRW &parent, dxfReader *chunkReader, dxfWriter *chunkWriter, DRW_Interface *chunkIface){
+    fileName = parent.fileName;
+    version = parent.version;
+    binFile = parent.binFile;
+    reader = chunkReader;
+    writer = chunkWriter;
+    iface = chunkIface;
+    applyExt = parent.applyExt;
+    elParts = parent.elParts;
+    entCount = parent.entCount;
+    wlayer0 = parent.wlayer0;
+    dimstyleStd = parent.dimstyleStd;
+    writingBlock = parent.writingBlock;
+    currHandle = parent.currHandle;
+    if (nullptr != chunkWriter) {
+        blockMap = parent.blockMap;
+        textStyleMap = parent.textStyleMap;
+    }
+}
+
 dxfRW::~dxfRW(){
     if (reader != NULL)
         delete reader;
@@ -66,12 +106,12 @@ void dxfRW::setDebug(DRW::DebugLevel lvl){
 bool dxfRW::read(DRW_Interface *interface_, bool ext){
     drw_assert(fileName.empty() == false);
     applyExt = ext;
-    std::ifstream filestr;
     if (nullptr == interface_) {
         return setError(DRW::BAD_UNKNOWN);
     }
     DRW_DBG("dxfRW::read 1def\n");
-    filestr.open (fileName.c_str(), std::ios_base::in | std::ios::binary);
+    //gzip compressed files are decompressed while reading
+    DRW_FileIStream filestr(fileName);
     if (!filestr.is_open()
         || !filestr.good()) {
         return setError(DRW::BAD_OPEN);
@@ -82,24 +122,29 @@ bool dxfRW::read(DRW_Interface *interface_, bool ext){
     line2[20] = (char)26;
     line2[21] = '\0';
     filestr.read (line, 22);
-    filestr.close();
     iface = interface_;
     DRW_DBG("dxfRW::read 2\n");
     if (strncmp(line, line2, 21) == 0) {
-        filestr.open (fileName.c_str(), std::ios_base::in | std::ios::binary);
         binFile = true;
-        //skip sentinel
-        filestr.seekg (22, std::ios::beg);
+        //the sentinel was skipped by reading it
         reader = new dxfReaderBinary(&filestr);
         DRW_DBG("dxfRW::read binary file\n");
     } else {
         binFile = false;
-        filestr.open (fileName.c_str(), std::ios_base::in);
-        reader = new dxfReaderAscii(&filestr);
+        //line terminators are handled by the reader
+        filestr.clear();
+        filestr.seekg(0, std::ios::beg);
+        auto asciiReader = new dxfReaderAscii(&filestr);
+        if (progressCallback) {
+            const auto fileSize = static_cast<double>(filestr.size());
+            asciiReader->setProgress([this, fileSize](unsigned long long bytesRead) {
+                return progressCallback(fileSize > 0. ? std::min(1., bytesRead / fileSize) : 1.);
+            });
+        }
+        reader = asciiReader;
     }
 
     bool isOk {processDxf()};
-    filestr.close();
     version = (DRW::Version) reader->getVersion();
     delete reader;
     reader = nullptr;
@@ -107,19 +152,21 @@ bool dxfRW::read(DRW_Interface *interface_, bool ext){
 }
 
 bool dxfRW::write(DRW_Interface *interface_, DRW::Version ver, bool bin){
-    bool isOk = false;
-    std::ofstream filestr;
     version = ver;
     binFile = bin;
     iface = interface_;
+    //file names as drawing.dxf.gz are compressed while writing
+    const bool compress {DRW::isGzipName(fileName)};
+    const bool binaryMode {binFile || (rawOutput && !compress)};
+    DRW_FileOStream filestr(fileName, binaryMode ? std::ios::binary | std::ios::trunc : std::ios::trunc, compress);
+    if (!filestr.is_open())
+        return setError(DRW::BAD_OPEN);
     if (binFile) {
-        filestr.open (fileName.c_str(), std::ios_base::out | std::ios::binary | std::ios::trunc);
         //write sentinel
         filestr << "AutoCAD Binary DXF\r\n" << (char)26 << '\0';
         writer = new dxfWriterBinary(&filestr);
         DRW_DBG("dxfRW::read binary file\n");
     } else {
-        filestr.open (fileName.c_str(), std::ios_base::out | std::ios::trunc);
         writer = new dxfWriterAscii(&filestr);
         std::string comm = std::string("dxfrw ") + std::string(DRW_VERSION);
         writer->writeString(999, comm);
@@ -156,14 +203,85 @@ bool dxfRW::write(DRW_Interface *interface_, DRW::Version ver, bool bin){
         writer->writeString(0, "ENDSEC");
     }
     writer->writeString(0, "EOF");
-    filestr.flush();
-    filestr.close();
-    isOk = true;
+    writer->flush();
+    const bool isOk {filestr.close()};
     delete writer;
     writer = NULL;
     return isOk;
 }
 
+long long dxfRW::getWritePosition() const {
+    return nullptr != writer ? writer->position() : 0;
+}
+
+bool dxfRW::copyRecords(std::istream &source, long long offset, long long size) {
+    if (nullptr == writer)
+        return false;
+    return writer->copyFrom(source, offset, size);
+}
+
+bool dxfRW::writeEntities(std::size_t count, const std::function<bool(dxfRW &, std::size_t)> &writeOne) {
+    auto writeRange = [&writeOne](dxfRW &dxf, std::size_t first, std::size_t last) {
+        bool isOk {true};
+        for (std::size_t i = first; i < last; ++i)
+            isOk = writeOne(dxf, i) && isOk;
+        return isOk;
+    };
+    if (writeThreads < 2 || count < 2 * entityRunSize)
+        return writeRange(*this, 0, count);
+
+    DRW_DBG("dxfRW::writeEntities parallel\n");
+    struct Run {
+        Run(std::size_t runFirst, std::size_t runLast, int runStartCount):
+            first{runFirst}, last{runLast}, startCount{runStartCount} {}
+        std::size_t first;
+        std::size_t last;
+        int startCount;
+        std::string text;
+        int endCount {0};
+        bool isOk {false};
+    };
+    auto writeRun = [this, &writeRange](Run *run) {
+        dxfWriter *runWriter = binFile ? static_cast<dxfWriter *>(new dxfWriterBinary(&run->text))
+                                       : new dxfWriterAscii(&run->text);
+        runWriter->copyCodec(*writer);
+        dxfRW worker(*this, nullptr, runWriter, nullptr);
+        worker.entCount = run->startCount;
+        run->isOk = writeRange(worker, run->first, run->last);
+        run->endCount = worker.entCount;
+    };
+
+    bool isOk {true};
+    const std::size_t batchSize = entityRunSize * static_cast<std::size_t>(writeThreads);
+    for (std::size_t batchFirst = 0; batchFirst < count; batchFirst += batchSize) {
+        const std::size_t batchLast = std::min(count, batchFirst + batchSize);
+        //handles are assigned as if each entity uses one handle
+        std::vector<Run> runs;
+        for (std::size_t first = batchFirst; first < batchLast; first += entityRunSize) {
+            const int startCount = entCount + static_cast<int>(first - batchFirst);
+            runs.emplace_back(first, std::min(batchLast, first + entityRunSize), startCount);
+        }
+
+        std::vector<std::future<void>> done;
+        for (Run &run : runs)
+            done.push_back(std::async(std::launch::async, writeRun, &run));
+        for (std::size_t i = 0; i < runs.size(); ++i) {
+            done[i].get();
+            const Run &run = runs[i];
+            if (run.startCount == entCount
+                    && run.endCount == run.startCount + static_cast<int>(run.last - run.first)) {
+                entCount = run.endCount;
+                writer->writeRecords(run.text);
+                isOk = run.isOk && isOk;
+            } else {
+                //other handles used, the following runs of the batch are rewritten too
+                isOk = writeRange(*this, run.first, run.last) && isOk;
+            }
+        }
+    }
+    return isOk;
+}
+
 bool dxfRW::writeEntity(DRW_Entity *ent) {
     ent->handle = ++entCount;
     writer->writeString(5, toHexStr(ent->handle));
@@ -1411,7 +1529,7 @@ bool dxfRW::writeBlock(DRW_Block *bk){
     if(version >= DRW::AC1014) {
         writeAppData(bk->appData);
     }
-    writer->writeString(1, "");
+    writer->writeUtf8String(1, bk->xrefPath);
 
     return true;
 }
@@ -2291,6 +2409,10 @@ bool dxfRW::processEntities(bool isblock) {
         return setError(DRW::BAD_READ_ENTITIES);  //first record in entities is 0
     }
 
+    if (readThreads > 1 && !binFile && DRW_DBGGL != DRW_dbg::Level::Debug) {
+        return processEntityChunks();
+    }
+
     bool processed {false};
     do {
         if (nextentity == "ENDSEC" || nextentity == "ENDBLK") {
@@ -2353,6 +2475,101 @@ bool dxfRW::processEntities(bool isblock) {
     return setError(DRW::BAD_READ_ENTITIES);
 }
 
+/**
+ * Decodes the entities in chunks with worker threads. The chunks are split
+ * from the file in the reading thread, and the decoded entities are passed
+ * to the interface in file order.
+ */
+bool dxfRW::processEntityChunks() {
+    DRW_DBG("dxfRW::processEntityChunks\n");
+    struct Pending {
+        std::unique_ptr<DRW_EntityChunk> chunk;
+        std::future<void> done;
+    };
+    auto decode = [this](DRW_EntityChunk *chunk, dxfReader *chunkReader) {
+        dxfRW worker(*this, chunkReader, nullptr, &chunk->recorder);
+        chunk->processed = worker.processEntities(false);
+        chunk->error = worker.getError();
+    };
+    auto deliver = [this](Pending &pending) {
+        if (pending.done.valid())
+            pending.done.get();
+        pending.chunk->recorder.replay(*iface);
+        if (!pending.chunk->processed)
+            return setError(pending.chunk->error);
+        return true;
+    };
+
+    std::deque<Pending> pendings;
+    bool ended {false};
+    bool isOk {true};
+    while (isOk && !ended) {
+        auto chunk = std::make_unique<DRW_EntityChunk>();
+        if (!scanEntityChunk(chunk->text, ended)) {
+            setError(DRW::BAD_READ_ENTITIES); //end of file without ENDSEC
+            break;
+        }
+        auto chunkReader = new dxfReaderAscii(chunk->text);
+        chunkReader->copyCodec(*reader);
+        chunkReader->setIgnoreComments(true);
+        Pending pending {std::move(chunk), {}};
+        if (ended && pendings.empty()) {
+            //short section, no worker needed
+            decode(pending.chunk.get(), chunkReader);
+        } else {
+            pending.done = std::async(std::launch::async, decode, pending.chunk.get(), chunkReader);
+        }
+        pendings.push_back(std::move(pending));
+
+        if (ended || pendings.size() >= static_cast<std::size_t>(readThreads)) {
+            isOk = deliver(pendings.front());
+            pendings.pop_front();
+        }
+    }
+    while (isOk && !pendings.empty()) {
+        isOk = deliver(pendings.front());
+        pendings.pop_front();
+    }
+
+    return isOk && ended;
+}
+
+/**
+ * Copies the records of the following entities to text, until the chunk
+ * size is reached or the end of the entities. The first record of the
+ * next entity is kept in nextentity.
+ */
+bool dxfRW::scanEntityChunk(std::string &text, bool &ended) {
+    auto asciiReader = static_cast<dxfReaderAscii *>(reader);
+    text.reserve(entityChunkSize + 4096);
+    text.append("0\n").append(nextentity).append("\n");
+    int code;
+    std::string_view value;
+    while (asciiReader->readRawRec(&code, &value)) {
+        if (0 == code) {
+            if ("ENDSEC" == value || "ENDBLK" == value) {
+                nextentity = value;
+                ended = true;
+                //chunks are closed as the entities section
+                text.append("0\nENDSEC\n");
+                return true;
+            }
+            //vertices and attributes belong to the previous entity
+            if (text.size() >= entityChunkSize
+                    && "VERTEX" != value && "SEQEND" != value && "ATTRIB" != value) {
+                nextentity = value;
+                text.append("0\nENDSEC\n");
+                return true;
+            }
+        }
+        char codeText[16];
+        const auto result = std::to_chars(codeText, codeText + sizeof(codeText), code);
+        text.append(codeText, result.ptr).append("\n").append(value).append("\n");
+    }
+
+    return false;
+}
+
 bool dxfRW::processEllipse() {
     DRW_DBG("dxfRW::processEllipse");
     int code;
@@ -14,6 +14,8 @@
 #ifndef LIBDXFRW_H
 #define LIBDXFRW_H
 
+#include <algorithm>
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include "drw_entities.h"
@@ -40,8 +42,53 @@ public:
      */
     bool read(DRW_Interface *interface_, bool ext);
     void setBinary(bool b) {binFile = b;}
+    /*!
+     * Sets the number of threads used to decode the entities of ascii files.
+     * The interface is always called in file order from the reading thread,
+     * 1 (default) decodes the entities in the reading thread.
+     */
+    void setReadThreads(int threads) {readThreads = std::max(1, threads);}
+    /*!
+     * Sets a callback for the progress of reading ascii files, called in the
+     * reading thread with the fraction of the file read. Reading fails if the
+     * callback returns false.
+     */
+    void setProgressCallback(std::function<bool(double)> callback) {progressCallback = std::move(callback);}
 
     bool write(DRW_Interface *interface_, DRW::Version ver, bool bin);
+    /*!
+     * Sets the number of threads used by writeEntities(),
+     * 1 (default) writes all entities in the calling thread.
+     */
+    void setWriteThreads(int threads) {writeThreads = std::max(1, threads);}
+    /*!
+     * Writes count entities, calling writeOne(dxf, index) for each one to
+     * write it with dxf. The entities can be written in
+     * parallel by worker writers, in runs copied to the file in order.
+     * writeOne must be thread safe then, and must not write images. Runs
+     * using other handles than one per entity are written again sequentially,
+     * so the file content doesn't depend on the number of threads.
+     * @return true if all calls of writeOne returned true
+     */
+    bool writeEntities(std::size_t count, const std::function<bool(dxfRW &dxf, std::size_t index)> &writeOne);
+    /*!
+     * Writes ascii files without conversion of line ends, so the positions
+     * of getWritePosition() are the byte offsets in the file.
+     * Used to save a file again, copying the records of unchanged entities.
+     */
+    void setRawOutput(bool raw) {rawOutput = raw;}
+    /// byte offset of the next record, while writing
+    long long getWritePosition() const;
+    /// last handle used, while writing
+    int getHandleCount() const {return entCount;}
+    /// sets the last handle used, the next entity is written with count + 1
+    void setHandleCount(int count) {entCount = count;}
+    /*!
+     * Copies size bytes of source at offset, the records of entities written
+     * before by this library in the same version and format. The handles
+     * of the copied entities are kept.
+     */
+    bool copyRecords(std::istream &source, long long offset, long long size);
     bool writeLineType(DRW_LType *ent);
     bool writeLayer(DRW_Layer *ent);
     bool writeDimstyle(DRW_Dimstyle *ent);
@@ -78,6 +125,9 @@ public:
     DRW::error getError() const;
 
 private:
+    /// reads or writes a chunk of entities for parent, the chunk reader or writer is owned
+    dxfRW(const dxfRW &parent, dxfReader *chunkReader, dxfWriter *chunkWriter, DRW_Interface *chunkIface);
+
     /// used by read() to parse the content of the file
     bool processDxf();
     bool processHeader();
@@ -85,6 +135,8 @@ private:
     bool processBlocks();
     bool processBlock();
     bool processEntities(bool isblock);
+    bool processEntityChunks();
+    bool scanEntityChunk(std::string &text, bool &ended);
     bool processObjects();
 
     bool processLType();
@@ -137,6 +189,7 @@ private:
     std::string fileName;
     std::string codePage;
     bool binFile = false;
+    bool rawOutput = false;
     dxfReader *reader = nullptr;
     dxfWriter *writer = nullptr;
     DRW_Interface *iface = nullptr;
@@ -147,6 +200,9 @@ private:
     bool wlayer0 = false;
     bool dimstyleStd = false;
     bool applyExt =false;
+    int readThreads = 1;
+    int writeThreads = 1;
+    std::function<bool(double)> progressCallback;
     bool writingBlock;
     int elParts;  /*!< parts number when convert ellipse to polyline */
     std::unordered_map<std::string,int> blockMap;
@@ -40,12 +40,12 @@ bool getSetting(QString entry) {
     return RS_SETTINGS->readNumEntry("/" + entry, 0);
 }
 
-// create an SVG generator
-std::unique_ptr<LC_MakerCamSVG> getGenerator()
+// create an SVG generator, streaming the document to the device
+std::unique_ptr<LC_MakerCamSVG> getGenerator(QIODevice* device)
 {
     auto groupGuard = RS_SETTINGS->beginGroupGuard("/ExportMakerCam");
 
-    auto generator = std::make_unique<LC_MakerCamSVG>(std::make_unique<LC_XMLWriterQXmlStreamWriter>(),
+    auto generator = std::make_unique<LC_MakerCamSVG>(std::make_unique<LC_XMLWriterQXmlStreamWriter>(device),
                                             (bool)RS_SETTINGS->readNumEntry("/ExportInvisibleLayers"),
                                             (bool)RS_SETTINGS->readNumEntry("/ExportConstructionLayers"),
                                             (bool)RS_SETTINGS->readNumEntry("/WriteBlocksInline"),
@@ -56,6 +56,8 @@ std::unique_ptr<LC_MakerCamSVG> getGenerator()
                                             RS_SETTINGS->readEntry("/DefaultDashLinePatternLength").toDouble());
     bool exportPoints = getSetting("ExportPoints");
     generator->setExportPoints(exportPoints);
+    generator->setMergePaths(getSetting("MergePaths"));
+    generator->setPrecision(RS_SETTINGS->readNumEntry("/Precision", 8));
     return generator;
 }
 }
@@ -81,18 +83,20 @@ bool LC_ActionFileExportMakerCam::writeSvg(const QString& fileName, RS_Graphic&
         return false;
     }
 
-    auto generator = getGenerator();
-    if (generator->generate(&graphic)) {
-        QFile file{fileName};
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            LC_ERR<<__func__<<"(): failed in creating file "<<fileName<<", no SVG is generated";
-            return false;
-        }
+    QFile file{fileName};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        LC_ERR<<__func__<<"(): failed in creating file "<<fileName<<", no SVG is generated";
+        return false;
+    }
 
-        QTextStream out(&file);
-        out << QString::fromStdString(generator->resultAsString());
+    auto generator = getGenerator(&file);
+    bool ret = generator->generate(&graphic);
+    generator->endDocument();
+    if (file.error() != QFileDevice::NoError) {
+        LC_ERR<<__func__<<"(): failed in writing file "<<fileName<<": "<<file.errorString();
+        return false;
     }
-    return true;
+    return ret;
 }
 
 
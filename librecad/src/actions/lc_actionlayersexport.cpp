@@ -30,12 +30,15 @@
 #include <QFileDialog>
 #include <QHash>
 #include <QStatusBar>
+#include <QThreadPool>
 
 #include "lc_filedialogservice.h"
 #include "qc_applicationwindow.h"
+#include "rs_block.h"
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "rs_graphic.h"
+#include "rs_insert.h"
 #include "rs_layer.h"
 #include "rs_layerlist.h"
 
@@ -133,6 +136,90 @@ private:
     QHash<QString, RS_Layer*> m_lookUp;
 
 };
+
+// adds copies of the blocks inserted by the entity, also by nested inserts, to the document
+void addInsertedBlocks(RS_Graphic& document, RS_Entity* entity)
+{
+    if (entity->rtti() != RS2::EntityInsert)
+        return;
+    RS_Block* block = static_cast<RS_Insert*>(entity)->getBlockForInsert();
+    if (block == nullptr || document.findBlock(block->getName()) != nullptr)
+        return;
+
+    auto duplicateBlock = static_cast<RS_Block*>(block->clone());
+    duplicateBlock->reparent(&document);
+    document.addBlock(duplicateBlock, false);
+    for (RS_Entity* e: *block)
+        addInsertedBlocks(document, e);
+}
+
+// An exported file: a document with copies of the exported layers, their entities and
+// the blocks inserted. The documents don't share entities, so they are saved concurrently
+class LayersFile
+{
+public:
+    LayersFile(RS_Graphic& source, RS_GraphicView* graphicView, QString filePath):
+        m_document{std::make_unique<RS_Graphic>()}
+        , m_layers{std::make_unique<ScopedLayerList>(m_document->getLayerList())}
+        , m_filePath{std::move(filePath)}
+    {
+        m_document->newDoc();
+        m_document->setVariableDictObject(source.getVariableDictObject());
+        m_document->setGraphicView(graphicView);
+    }
+
+    void addLayer(RS_Layer* layer)
+    {
+        if (layer == nullptr)
+            return;
+        /* It does a 'new' internally. */
+        m_layers->add(layer->clone());
+        m_layerNames += (m_layerNames.isEmpty() ? "" : " ") + QString(R"("%1")").arg(layer->getName());
+    }
+
+    // adds a copy of the entity, if it's on an exported layer
+    void addEntity(RS_Entity* entity)
+    {
+        RS_Layer* copiedLayer = m_layers->find(entity->getLayer()->getName());
+        if (copiedLayer == nullptr)
+            return;
+
+        /* It does a 'new' internally. */
+        RS_Entity *duplicateEntity = entity->clone();
+        duplicateEntity->reparent(m_document.get());
+        duplicateEntity->setLayer(copiedLayer);
+        m_document->addEntity(duplicateEntity);
+        addInsertedBlocks(*m_document, entity);
+    }
+
+    void save(RS2::FormatType fileType)
+    {
+        m_saved = m_document->saveAs(m_filePath, fileType, true);
+    }
+
+    bool isSaved() const
+    {
+        return m_saved;
+    }
+
+    const QString& getFilePath() const
+    {
+        return m_filePath;
+    }
+
+    const QString& getLayerNames() const
+    {
+        return m_layerNames;
+    }
+
+private:
+    std::unique_ptr<RS_Graphic> m_document;
+    // RAII style layer to hold duplicated layers: auto clean up at the end of its lifetime
+    std::unique_ptr<ScopedLayerList> m_layers;
+    QString m_filePath;
+    QString m_layerNames;
+    bool m_saved = false;
+};
 }
 
 /*
@@ -203,85 +290,72 @@ void LC_ActionLayersExport::trigger()
         QApplication::restoreOverrideCursor();
     }};
 
-    for (int currentExportLayerIndex = 0; currentExportLayerIndex < layersToExport.size(); currentExportLayerIndex++)
+    // the exported files, each with copies of its layers and entities
+    std::vector<LayersFile> files;
+    if (result.checkState == Qt::Checked)
     {
-        auto documentDeepCopy = std::make_unique<RS_Graphic>();
-        documentDeepCopy->newDoc();
-        documentDeepCopy->setVariableDictObject(document->getGraphic()->getVariableDictObject());
-        // RAII style layer to hold duplicated layers: auto clean up at the end of its lifetime
-        ScopedLayerList duplicateLayersList = documentDeepCopy->getLayerList();
-
-        QString modifiedFilePath;
-        QString copiedLayers;
-
-        bool exportLayer0 = false;
-
         /* Combine all layers. */
-        if (result.checkState == Qt::Checked)
-        {
-            /* This is just to break early out of the loop. */
-            currentExportLayerIndex = layersToExport.size();
+        files.emplace_back(*document->getGraphic(), graphicView, result.filePath);
+        LayersFile& file = files.back();
+        for (QString& layerName: layersToExport)
+            file.addLayer(originalLayersList->find(layerName));
 
-            modifiedFilePath = result.filePath;
-
-            for (QString& layerName: layersToExport)
-            {
-                if (layerName.compare("0") == 0) exportLayer0 = true;
-
-                /* It does a 'new' internally. */
-                RS_Layer *duplicateLayer = originalLayersList->find (layerName)->clone();
-
-                duplicateLayersList.add(duplicateLayer);
-                copiedLayers += (copiedLayers.isEmpty() ?"":" ") +  QString(R"("%1")").arg(layerName);
-            }
+        // Shallow traversing, keeping the order of the entities
+        for(RS_Entity* entity: *document)
+        {
+            if (entity != nullptr && entity->getLayer() != nullptr)
+                file.addEntity(entity);
         }
+    }
+    else
+    {
         /* Individualize all layers. */
-        else
+        // Partition the entities by layer in a single pass
+        QHash<QString, std::vector<RS_Entity*>> entitiesByLayer;
+        for(RS_Entity* entity: *document)
         {
-            if (layersToExport.at(currentExportLayerIndex).compare("0") == 0) exportLayer0 = true;
-
-            RS_Layer *duplicateLayer = originalLayersList->find (layersToExport.at (currentExportLayerIndex))->clone();
-
-            duplicateLayersList.add(duplicateLayer);
-            copiedLayers = layersToExport.at(currentExportLayerIndex);
-
-            /* Note that the QString::append() function causes a bug; hence the '+' overload operator. */
-            modifiedFilePath = QDir::toNativeSeparators (
-                                    result.dirPath + "/" 
-                                                   + result.fileName 
-                                                   + paddedIndex(currentExportLayerIndex + 1, layersToExport.size()) 
-                                                   + result.fileExtension);
+            if (entity != nullptr && entity->getLayer() != nullptr)
+                entitiesByLayer[entity->getLayer()->getName()].push_back(entity);
         }
 
-        // Shallow traversing
-        for(RS_Entity* entity: *document)
+        files.reserve(layersToExport.size());
+        for (int currentExportLayerIndex = 0; currentExportLayerIndex < layersToExport.size(); currentExportLayerIndex++)
         {
-            if (entity == nullptr || entity->getLayer() == nullptr)
-                continue;
-            QString entityLayerName = entity->getLayer()->getName();
-            RS_Layer* copiedLayer = duplicateLayersList.find(entityLayerName);
-            if (copiedLayer == nullptr || (entityLayerName.compare("0") == 0 && !exportLayer0))
-                continue;
-
-            /* It does a 'new' internally. */
-            RS_Entity *duplicateEntity = entity->clone();
-            duplicateEntity->reparent(documentDeepCopy.get());
-            duplicateEntity->setLayer(copiedLayer);
-            documentDeepCopy->addEntity(duplicateEntity);
+            const QString& layerName = layersToExport.at(currentExportLayerIndex);
+            /* Note that the QString::append() function causes a bug; hence the '+' overload operator. */
+            files.emplace_back(*document->getGraphic(), graphicView, QDir::toNativeSeparators (
+                                    result.dirPath + "/"
+                                                   + result.fileName
+                                                   + paddedIndex(currentExportLayerIndex + 1, layersToExport.size())
+                                                   + result.fileExtension));
+            LayersFile& file = files.back();
+            file.addLayer(originalLayersList->find(layerName));
+            for (RS_Entity* entity: entitiesByLayer.value(layerName))
+                file.addEntity(entity);
         }
+    }
 
-        /* Saving. */
-        documentDeepCopy->setGraphicView(graphicView);
-
-        bool saveWasSuccessful = documentDeepCopy->saveAs(modifiedFilePath, result.fileType, true);
+    /* Saving. The files are independent documents, serialized by workers. */
+    QThreadPool pool;
+    for (LayersFile& file: files)
+    {
+        if (files.size() > 1)
+            pool.start([&file, &result]() { file.save(result.fileType); });
+        else
+            file.save(result.fileType);
+    }
+    pool.waitForDone();
 
-        if (saveWasSuccessful)
+    for (const LayersFile& file: files)
+    {
+        if (file.isSaved())
         {
             RS_DIALOGFACTORY->commandMessage(
-                tr(R"(Saving layer "%1" as "%2" )").arg(copiedLayers).arg(modifiedFilePath));
+                tr(R"(Saving layer "%1" as "%2" )").arg(file.getLayerNames()).arg(file.getFilePath()));
         } else {
             RS_DEBUG->print(RS_Debug::D_ERROR, "LC_ActionLayersExport::trigger: Error encountered while exporting layers");
-            return;
+            RS_DIALOGFACTORY->commandMessage(
+                tr(R"(Cannot save layer "%1" as "%2" )").arg(file.getLayerNames()).arg(file.getFilePath()));
         }
     }
 
@@ -292,7 +366,7 @@ namespace {
 
 QString paddedIndex(int index, int totalNumber)
 {
-    if (totalNumber <= 1 || totalNumber > 10) return "";
+    if (totalNumber <= 1) return "";
     // the maximum string size needed
     int fieldWidth=QString::number(totalNumber).size();
     auto str = QString("%1").arg(index, fieldWidth, 10, QChar{'0'});
@@ -22,6 +22,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 **********************************************************************/
 #include <cfloat>
 #include <cmath>
+#include <utility>
+#include <vector>
 #include "rs_math.h"
 #include "rs_arc.h"
 #include "rs_circle.h"
@@ -490,53 +492,27 @@ LC_ActionModifyBreakDivide::CircleSegmentData *LC_ActionModifyBreakDivide::calcu
 }
 /**
  * Collects all intersection of given entity with other entities.
+ * The candidates are found by the spatial index of the container, which caches
+ * the intersections per entity; the visible ones are kept here while hovering
+ * the same entity.
  * @param entity entity to check for intersections
  * @return vector of intersection points
  */
-QVector<RS_Vector> LC_ActionModifyBreakDivide::collectAllIntersectionsWithEntity(RS_Entity *entity){
-    QVector<RS_Vector> result;
-    RS_VectorSolutions sol;
-    // iterate over all entities
-    for (auto e: *container) {
+const QVector<RS_Vector>& LC_ActionModifyBreakDivide::collectAllIntersectionsWithEntity(RS_Entity *entity){
+    IntersectionsCache& cache = intersectionsCache;
+    if (cache.entity == entity && cache.revision == container->getRevision())
+        return cache.points;
+
+    cache.entity = entity;
+    cache.revision = container->getRevision();
+    cache.points.clear();
+    for (const auto& [e, point]: container->getIntersections(entity)) {
         // consider only visible entities
-        if (e && e->isVisible()){
-            // select containers / groups:
-            if (e->isContainer()){
-                // additional handling for containers
-                auto *ec = (RS_EntityContainer *) e;
-
-                for (RS_Entity *e2 = ec->firstEntity(RS2::ResolveAll); e2;
-                     e2 = ec->nextEntity(RS2::ResolveAll)) {
-                    sol = RS_Information::getIntersection(entity, e2, true);
-                    addPointsFromSolutionToList(sol, result);
-                }
-            } else {
-                // just find intersections between entities
-                sol = RS_Information::getIntersection(entity, e, true);
-                // and collect them
-                addPointsFromSolutionToList(sol, result);
-            }
-        }
-    }
-    return result;
-}
-/**
- * Utility method that collects all valid intersection points for vector solutions to vector
- * @param sol vector solutions with intersections
- * @param result resulting vector
- */
-void LC_ActionModifyBreakDivide::addPointsFromSolutionToList(RS_VectorSolutions &sol, QVector<RS_Vector> &result) const{
-    if (sol.hasValid()){
-        size_t size = sol.size();
-        for (size_t i = 0; i < size; i++) {
-            const RS_Vector point = sol.at(i);
-            if (point.valid){
-                result.append(point);
-            }
-        }
+        if (e->isVisible())
+            cache.points.append(point);
     }
+    return cache.points;
 }
-
 /**
  * Method finds edges (start and end point) for the segment of line, selected by the user.
  * Segment should contain snap point and it is limited either by intersection points or
@@ -105,13 +105,20 @@ protected:
 
     TriggerData* triggerData = nullptr;
 
+    /**
+     * Intersections of the last entity hovered, kept while the entity and the container are unchanged
+     */
+    struct IntersectionsCache {
+        const RS_Entity* entity = nullptr;
+        unsigned long revision = 0;
+        QVector<RS_Vector> points;
+    } intersectionsCache;
 
 
     bool doCheckMayDrawPreview(QMouseEvent *event, int status) override;
     void doPreparePreviewEntities(QMouseEvent *e, RS_Vector &snap, QList<RS_Entity *> &list, int status) override;
     LineSegmentData *calculateLineSegment(RS_Line *line, RS_Vector &snap);
-    QVector<RS_Vector>  collectAllIntersectionsWithEntity(RS_Entity *entity);
-    void addPointsFromSolutionToList(RS_VectorSolutions &sol, QVector<RS_Vector> &result) const;
+    const QVector<RS_Vector>& collectAllIntersectionsWithEntity(RS_Entity *entity);
     LineSegmentData *findLineSegmentEdges(RS_Line *line, RS_Vector &snap, QVector<RS_Vector> intersections);
     void createOptionsWidget() override;
     void createEntitiesForLine(RS_Line *line, RS_Vector &snap, QList<RS_Entity *> &list, bool preview);
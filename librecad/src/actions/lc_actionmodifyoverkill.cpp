@@ -0,0 +1,54 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <QAction>
+
+#include "lc_actionmodifyoverkill.h"
+#include "rs_dialogfactory.h"
+#include "rs_entitycontainer.h"
+#include "rs_modification.h"
+
+LC_ActionModifyOverkill::LC_ActionModifyOverkill(RS_EntityContainer& container,
+                                                 RS_GraphicView& graphicView)
+    :RS_PreviewActionInterface("Delete Duplicates",
+                               container, graphicView) {
+    actionType=RS2::ActionModifyOverkill;
+}
+
+LC_ActionModifyOverkill::~LC_ActionModifyOverkill() = default;
+
+void LC_ActionModifyOverkill::init(int status) {
+    RS_PreviewActionInterface::init(status);
+
+    trigger();
+    finish(false);
+}
+
+void LC_ActionModifyOverkill::trigger() {
+    RS_Modification m(*container, graphicView);
+    const std::size_t removed = m.overkill(RS_OverkillData{});
+    RS_DIALOGFACTORY->commandMessage(tr("Entities removed: %1").arg(removed));
+    RS_DIALOGFACTORY->updateSelectionWidget(container->countSelected(), container->totalSelectedLength());
+}
@@ -0,0 +1,46 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_ACTIONMODIFYOVERKILL_H
+#define LC_ACTIONMODIFYOVERKILL_H
+
+#include "rs_previewactioninterface.h"
+
+/**
+ * This action removes the duplicate and zero length entities of the selection,
+ * and merges overlapping collinear lines, see RS_Modification::overkill().
+ */
+class LC_ActionModifyOverkill : public RS_PreviewActionInterface {
+    Q_OBJECT
+public:
+    LC_ActionModifyOverkill(RS_EntityContainer& container,
+                            RS_GraphicView& graphicView);
+    ~LC_ActionModifyOverkill() override;
+
+    void init(int status=0) override;
+
+    void trigger() override;
+};
+
+#endif // LC_ACTIONMODIFYOVERKILL_H
@@ -0,0 +1,203 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <QAction>
+#include <QKeyEvent>
+#include <QMouseEvent>
+
+#include "lc_actionmodifytrimtoedges.h"
+#include "rs_dialogfactory.h"
+#include "rs_entitycontainer.h"
+#include "rs_graphicview.h"
+#include "rs_modification.h"
+#include "rs_overlaybox.h"
+#include "rs_preview.h"
+#include "rs_selection.h"
+
+namespace {
+// drags shorter than this, in pixels, are clicks
+constexpr double minWindowSize = 10.;
+}
+
+LC_ActionModifyTrimToEdges::LC_ActionModifyTrimToEdges(RS_EntityContainer& container,
+                                                       RS_GraphicView& graphicView)
+    :RS_PreviewActionInterface("Trim to Edges",
+                               container, graphicView) {
+    actionType=RS2::ActionModifyTrimToEdges;
+}
+
+LC_ActionModifyTrimToEdges::~LC_ActionModifyTrimToEdges() {
+    if (graphicView != nullptr && !graphicView->isCleanUp())
+        releaseEdges(false);
+}
+
+void LC_ActionModifyTrimToEdges::init(int status) {
+    RS_PreviewActionInterface::init(status);
+    snapMode.clear();
+    snapMode.restriction = RS2::RestrictNothing;
+    windowCorner = RS_Vector{false};
+
+    // entities selected before are the edges
+    if (status == SelectEdges && edges.empty() && container->countSelected() > 0 && takeEdges())
+        setStatus(SelectTargets);
+}
+
+void LC_ActionModifyTrimToEdges::finish(bool updateTB) {
+    releaseEdges(false);
+    RS_PreviewActionInterface::finish(updateTB);
+}
+
+void LC_ActionModifyTrimToEdges::trigger() {
+    std::vector<RS_Entity*> targets;
+    for (RS_Entity* e: *container) {
+        if (e->isSelected())
+            targets.push_back(e);
+    }
+    if (targets.empty()) {
+        RS_DIALOGFACTORY->commandMessage(tr("No entity selected!"));
+        return;
+    }
+
+    // the edges may be trimmed too, and replaced
+    const std::vector<RS_Entity*> limitEntities = edges;
+    releaseEdges(false);
+    // extended up to the far end of the drawing
+    container->calculateBorders();
+    const double maxDistance = container->getSize().magnitude();
+
+    RS_Modification m(*container, graphicView);
+    if (!m.trimToEdges(targets, limitEntities, maxDistance))
+        RS_DIALOGFACTORY->commandMessage(tr("No entity trimmed"));
+    RS_DIALOGFACTORY->updateSelectionWidget(container->countSelected(), container->totalSelectedLength());
+    setStatus(SelectEdges);
+}
+
+void LC_ActionModifyTrimToEdges::mouseMoveEvent(QMouseEvent* e) {
+    if (!windowCorner.valid)
+        return;
+    deletePreview();
+    preview->addEntity(new RS_OverlayBox(preview.get(), RS_OverlayBoxData(windowCorner, snapFree(e))));
+    drawPreview();
+}
+
+void LC_ActionModifyTrimToEdges::mousePressEvent(QMouseEvent* e) {
+    if (e->button()==Qt::LeftButton)
+        windowCorner = snapFree(e);
+}
+
+void LC_ActionModifyTrimToEdges::mouseReleaseEvent(QMouseEvent* e) {
+    if (e->button()==Qt::LeftButton) {
+        RS_Selection s(*container, graphicView);
+        const RS_Vector corner = snapFree(e);
+        deletePreview();
+        if (windowCorner.valid && graphicView->toGuiDX(windowCorner.distanceTo(corner)) > minWindowSize) {
+            const bool cross = windowCorner.x > corner.x;
+            s.selectWindow(RS2::EntityUnknown, windowCorner, corner, true, cross);
+        } else {
+            s.selectSingle(catchEntity(e));
+        }
+        windowCorner = RS_Vector{false};
+        RS_DIALOGFACTORY->updateSelectionWidget(container->countSelected(), container->totalSelectedLength());
+    } else if (e->button()==Qt::RightButton) {
+        deletePreview();
+        windowCorner = RS_Vector{false};
+        if (getStatus() == SelectTargets) {
+            // back to choosing the edges, which are selected again
+            releaseEdges(true);
+            setStatus(SelectEdges);
+        } else {
+            init(getStatus()-1);
+        }
+    }
+}
+
+void LC_ActionModifyTrimToEdges::keyPressEvent(QKeyEvent* e) {
+    if (e->key() != Qt::Key_Enter && e->key() != Qt::Key_Return) {
+        RS_PreviewActionInterface::keyPressEvent(e);
+        return;
+    }
+    switch (getStatus()) {
+    case SelectEdges:
+        if (takeEdges())
+            setStatus(SelectTargets);
+        else
+            RS_DIALOGFACTORY->commandMessage(tr("No entity selected!"));
+        break;
+    case SelectTargets:
+        trigger();
+        break;
+    default:
+        break;
+    }
+}
+
+bool LC_ActionModifyTrimToEdges::takeEdges() {
+    edges.clear();
+    for (RS_Entity* e: *container) {
+        if (e->isSelected())
+            edges.push_back(e);
+    }
+    for (RS_Entity* e: edges) {
+        e->setSelected(false);
+        e->setHighlighted(true);
+    }
+    if (!edges.empty())
+        graphicView->redraw(RS2::RedrawDrawing);
+    RS_DIALOGFACTORY->updateSelectionWidget(container->countSelected(), container->totalSelectedLength());
+    return !edges.empty();
+}
+
+void LC_ActionModifyTrimToEdges::releaseEdges(bool select) {
+    if (edges.empty())
+        return;
+    for (RS_Entity* e: edges) {
+        e->setHighlighted(false);
+        if (select)
+            e->setSelected(true);
+    }
+    edges.clear();
+    graphicView->redraw(RS2::RedrawDrawing);
+    RS_DIALOGFACTORY->updateSelectionWidget(container->countSelected(), container->totalSelectedLength());
+}
+
+void LC_ActionModifyTrimToEdges::updateMouseButtonHints() {
+    switch (getStatus()) {
+    case SelectEdges:
+        RS_DIALOGFACTORY->updateMouseWidget(tr("Select limiting edges and press Enter"),
+                                            tr("Cancel"));
+        break;
+    case SelectTargets:
+        RS_DIALOGFACTORY->updateMouseWidget(tr("Select entities to trim and press Enter"),
+                                            tr("Back"));
+        break;
+    default:
+        RS_DIALOGFACTORY->updateMouseWidget();
+        break;
+    }
+}
+
+void LC_ActionModifyTrimToEdges::updateMouseCursor() {
+    graphicView->setMouseCursor(RS2::SelectCursor);
+}
@@ -0,0 +1,74 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_ACTIONMODIFYTRIMTOEDGES_H
+#define LC_ACTIONMODIFYTRIMTOEDGES_H
+
+#include <vector>
+
+#include "rs_previewactioninterface.h"
+
+/**
+ * This action trims or extends many entities to many limiting edges at once, in
+ * one undo cycle, see RS_Modification::trimToEdges(). The edges are selected
+ * first, by clicks or windows, then the entities to trim. Enter confirms each
+ * selection. A selection present when the action starts is taken as the edges.
+ */
+class LC_ActionModifyTrimToEdges : public RS_PreviewActionInterface {
+    Q_OBJECT
+public:
+    /**
+     * Action States.
+     */
+    enum Status {
+        SelectEdges,     /**< Selecting the limiting edges. */
+        SelectTargets    /**< Selecting the entities to trim. */
+    };
+
+    LC_ActionModifyTrimToEdges(RS_EntityContainer& container,
+                               RS_GraphicView& graphicView);
+    ~LC_ActionModifyTrimToEdges() override;
+
+    void init(int status=0) override;
+    void finish(bool updateTB=true) override;
+    void trigger() override;
+    void mouseMoveEvent(QMouseEvent* e) override;
+    void mousePressEvent(QMouseEvent* e) override;
+    void mouseReleaseEvent(QMouseEvent* e) override;
+    void keyPressEvent(QKeyEvent* e) override;
+    void updateMouseButtonHints() override;
+    void updateMouseCursor() override;
+
+private:
+    // takes the selected entities as the edges, they are highlighted instead
+    bool takeEdges();
+    // drops the highlight of the edges, selected again to choose other edges
+    void releaseEdges(bool select);
+
+    std::vector<RS_Entity*> edges;
+    // the first corner of a selection window, while the mouse is dragged
+    RS_Vector windowCorner{false};
+};
+
+#endif // LC_ACTIONMODIFYTRIMTOEDGES_H
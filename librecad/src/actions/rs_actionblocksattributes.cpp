@@ -73,8 +73,6 @@ void RS_ActionBlocksAttributes::trigger() {
 
                 // update the name of all inserts:
                 graphic->renameInserts(oldName, newName);
-
-                graphic->addBlockNotification();
             }
         }
 
@@ -27,6 +27,8 @@
 #include "rs_actionblocksexplode.h"
 
 #include <QAction>
+#include "lc_progressdialog.h"
+#include "rs_graphicview.h"
 #include "rs_modification.h"
 
 /**
@@ -49,8 +51,12 @@ void RS_ActionBlocksExplode::init(int status) {
 
 
 void RS_ActionBlocksExplode::trigger() {
+    LC_ProgressDialog progress(tr("Exploding blocks"), graphicView);
     RS_Modification m(*container, graphicView);
-    m.explode();
+    m.setProgress(progress.getProgress());
+    // a cancelled explode is rolled back
+    if (!m.explode() && progress.wasCanceled())
+        graphicView->redraw();
 }
 
 
@@ -103,7 +103,12 @@ void RS_ActionBlocksRemove::trigger() {
     }
     document->endUndoCycle();
 
-    graphic->addBlockNotification();
+    // the rows of the removed blocks only, long block lists aren't rebuilt
+    for (auto block: blocks) {
+        if (nullptr != block) {
+            bl->editNotification(block);
+        }
+    }
 	graphic->updateInserts();
 	graphicView->redraw(RS2::RedrawDrawing);
     bl->activate(nullptr);
@@ -156,18 +156,18 @@ void RS_ActionDefault::keyReleaseEvent(QKeyEvent* e) {
 */
 void RS_ActionDefault::highlightHoveredEntities(QMouseEvent* event)
 {
-    clearHighLighting();
-
     auto guard = RS_SETTINGS->beginGroupGuard("/Appearance");
     bool showHighlightEntity = RS_SETTINGS->readNumEntry("/VisualizeHovering", 0) != 0;
-    if (!showHighlightEntity)
+    if (!showHighlightEntity) {
+        clearHighLighting();
         return;
+    }
 
     RS_Entity* entity = catchEntity(event);
-    if (entity == nullptr)
-        return;
-    if (!entity->isVisible() || entity->isLocked())
+    if (entity == nullptr || !entity->isVisible() || entity->isLocked()) {
+        clearHighLighting();
         return;
+    }
 
     const double hoverToleranceFactor = (entity->rtti() == RS2::EntityEllipse)
                                         ? hoverToleranceFactor1
@@ -198,8 +198,11 @@ void RS_ActionDefault::highlightHoveredEntities(QMouseEvent* event)
         isPointOnEntity = entity->isPointOnEntity(currentMousePosition, hoverTolerance_adjusted);
     }
 
-    // Glowing effect on mouse hovering
-    if (isPointOnEntity)
+    // Glowing effect on mouse hovering, the overlay is kept while the same entity is hovered
+    if (!isPointOnEntity)
+        clearHighLighting();
+    else if (entity != pPoints->highlightedEntity
+             || graphicView->getOverlayContainer(RS2::OverlayEffects)->count() == 0)
         highlightEntity(entity);
 }
 
@@ -210,8 +213,9 @@ void RS_ActionDefault::mouseMoveEvent(QMouseEvent* e) {
 
     RS_DIALOGFACTORY->updateCoordinateWidget(mouse, relMouse);
 
-    // clear any existing hovering
-    clearHighLighting();
+    // clear any existing hovering, unless hovering goes on
+    if (getStatus() != Neutral)
+        clearHighLighting();
 
     switch (getStatus()) {
     case Neutral:
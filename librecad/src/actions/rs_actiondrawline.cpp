@@ -137,7 +137,7 @@ void RS_ActionDrawLine::trigger()
         document->endUndoCycle();
     }
 
-    graphicView->redraw(RS2::RedrawDrawing);
+    graphicView->redrawArea(graphicView->getRenderedArea(*line));
     graphicView->moveRelativeZero(pPoints->history.at(pPoints->index()).currPt);
     RS_DEBUG->print("RS_ActionDrawLine::trigger(): line added: %lu",
                     line->getId());
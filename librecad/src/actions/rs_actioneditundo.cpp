@@ -27,9 +27,32 @@
 #include "rs_actioneditundo.h"
 
 #include <QAction>
+#include "lc_regenstatistics.h"
 #include "rs_dialogfactory.h"
 #include "rs_graphicview.h"
 #include "rs_graphic.h"
+#include "rs_undocycle.h"
+
+namespace {
+/**
+ * @brief getChangedArea find the area changed by an undo cycle
+ * @return false, if the whole drawing may be changed
+ */
+bool getChangedArea(const RS_UndoCycle& cycle, const RS_GraphicView& view, LC_Rect& area)
+{
+    bool hasArea = false;
+    for (RS_Undoable* undoable: cycle.getUndoables()) {
+        auto* entity = dynamic_cast<RS_Entity*>(undoable);
+        // changes of nested entities, e.g. within blocks, may change inserts anywhere
+        if (entity == nullptr || entity->getParent() != view.getContainer())
+            return false;
+        const LC_Rect entityArea = view.getRenderedArea(*entity);
+        area = hasArea ? area.merge(entityArea) : entityArea;
+        hasArea = true;
+    }
+    return hasArea;
+}
+}
 
 /**
  * Constructor.
@@ -59,7 +82,9 @@ void RS_ActionEditUndo::trigger()
         qWarning("undo: graphic is null");
         return;
     }
+    LC_REGEN_REASON(undo ? "undo" : "redo");
 
+    std::shared_ptr<RS_UndoCycle> cycle = undo ? document->getUndoCycle() : document->getRedoCycle();
 	if (undo) {
 		if(!document->undo())
 			RS_DIALOGFACTORY->commandMessage(tr("Nothing to undo!"));
@@ -71,7 +96,11 @@ void RS_ActionEditUndo::trigger()
     graphic->addBlockNotification();
     graphic->setModified(true);
     document->updateInserts();
-    graphicView->redraw(RS2::RedrawDrawing);
+    LC_Rect area;
+    if (cycle != nullptr && getChangedArea(*cycle, *graphicView, area))
+        graphicView->redrawArea(area);
+    else
+        graphicView->redraw(RS2::RedrawDrawing);
     finish(false);
     RS_DIALOGFACTORY->updateSelectionWidget(container->countSelected(),
                                             container->totalSelectedLength());
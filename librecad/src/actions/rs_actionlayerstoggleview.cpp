@@ -31,6 +31,7 @@
 #include "rs_actionlayerstoggleview.h"
 
 #include <QAction>
+#include "lc_regenstatistics.h"
 #include "rs_graphic.h"
 #include "rs_debug.h"
 #include "rs_layer.h"
@@ -46,22 +47,25 @@ RS_ActionLayersToggleView::RS_ActionLayersToggleView(
 void RS_ActionLayersToggleView::trigger() {
     RS_DEBUG->print("toggle layer");
     if (graphic) {
+        LC_REGEN_REASON("toggle layers");
         RS_LayerList* ll = graphic->getLayerList();
-        unsigned cnt = 0;
+        std::vector<RS_Layer*> toggled;
         // toggle selected layers
         for (auto layer: *ll) {
             if (!layer) continue;
             if (!layer->isVisibleInLayerList()) continue;
             if (!layer->isSelectedInLayerList()) continue;
             graphic->toggleLayer(layer);
-            cnt++;
+            toggled.push_back(layer);
         }
         // if there wasn't selected layers, toggle active layer
-        if (!cnt) {
+        if (toggled.empty()) {
             graphic->toggleLayer(a_layer);
+            if (a_layer != nullptr)
+                toggled.push_back(a_layer);
         }
-        graphic->updateInserts();
-        container->calculateBorders();
+        // only borders depend on the visibility of layers
+        graphic->updateLayersVisibility(toggled);
     }
     finish(false);
 }
@@ -28,6 +28,7 @@
 #include <QMouseEvent>
 
 #include "rs_actionlibraryinsert.h"
+#include "lc_librarycache.h"
 #include "rs_dialogfactory.h"
 #include "rs_commandevent.h"
 #include "rs_coordinateevent.h"
@@ -37,7 +38,8 @@
 #include "rs_units.h"
 
 struct RS_ActionLibraryInsert::Points {
-	RS_Graphic prev;
+	//! the library file, shared with other inserts of the file
+	std::shared_ptr<RS_Graphic> prev;
 	RS_LibraryInsertData data;
 };
 
@@ -74,7 +76,8 @@ void RS_ActionLibraryInsert::init(int status) {
 void RS_ActionLibraryInsert::setFile(const QString& file) {
 	pPoints->data.file = file;
 
-	if (!pPoints->prev.open(file, RS2::FormatUnknown)) {
+	pPoints->prev = LC_LibraryCache::instance().get(file);
+	if (pPoints->prev == nullptr) {
         RS_DIALOGFACTORY->commandMessage(tr("Cannot open file '%1'").arg(file));
     }
 }
@@ -104,16 +107,18 @@ void RS_ActionLibraryInsert::mouseMoveEvent(QMouseEvent* e) {
     switch (getStatus()) {
     case SetTargetPoint:
 		pPoints->data.insertionPoint = snapPoint(e);
+		if (pPoints->prev == nullptr)
+			break;
 
         //if (block) {
         deletePreview();
-		preview->addAllFrom(pPoints->prev);
+		preview->addAllFrom(*pPoints->prev);
 		preview->move(pPoints->data.insertionPoint);
 		preview->scale(pPoints->data.insertionPoint,
 					   RS_Vector(pPoints->data.factor, pPoints->data.factor));
         // unit conversion:
         if (graphic) {
-			double const uf = RS_Units::convert(1.0, pPoints->prev.getUnit(),
+			double const uf = RS_Units::convert(1.0, pPoints->prev->getUnit(),
                                           graphic->getUnit());
 			preview->scale(pPoints->data.insertionPoint,
 			{uf, uf});
@@ -278,6 +283,14 @@ void RS_ActionLibraryInsert::setFactor(double f) {
 	pPoints->data.factor = f;
 }
 
+bool RS_ActionLibraryInsert::isReference() const{
+	return pPoints->data.xref;
+}
+
+void RS_ActionLibraryInsert::setReference(bool reference) {
+	pPoints->data.xref = reference;
+}
+
 void RS_ActionLibraryInsert::updateMouseCursor() {
     graphicView->setMouseCursor(RS2::CadCursor);
 }
@@ -89,6 +89,11 @@ public:
 
 	void setFactor(double f);
 
+	//! reference the file as external reference block instead of copying its entities
+	bool isReference() const;
+
+	void setReference(bool reference);
+
 	/*int getColumns() {
 		return data.cols;
 	}
@@ -88,8 +88,8 @@ void RS_ActionModifyMirror::mouseMoveEvent(QMouseEvent* e) {
                 pPoints->axisPoint2 = mouse;
 
                 deletePreview();
-                preview->addSelectionFrom(*container);
-                preview->mirror(pPoints->axisPoint1, pPoints->axisPoint2);
+                preview->addTransformedSelectionFrom(*container,
+                    RS_Preview::mirrorTransform(pPoints->axisPoint1, pPoints->axisPoint2));
 
                 preview->addEntity(new RS_Line{preview.get(),
                                                pPoints->axisPoint1,
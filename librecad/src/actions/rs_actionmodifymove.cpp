@@ -26,6 +26,7 @@
 
 #include "rs_actionmodifymove.h"
 
+#include "lc_progressdialog.h"
 #include "rs_dialogfactory.h"
 #include "rs_graphicview.h"
 #include "rs_line.h"
@@ -60,8 +61,12 @@ void RS_ActionModifyMove::trigger() {
 
     RS_DEBUG->print("RS_ActionModifyMove::trigger()");
 
+    LC_ProgressDialog progress(tr("Moving entities"), graphicView);
     RS_Modification m(*container, graphicView);
-	m.move(pPoints->data);
+    m.setProgress(progress.getProgress());
+    // a cancelled move is rolled back
+    if (!m.move(pPoints->data) && progress.wasCanceled())
+        graphicView->redraw();
 
     RS_DIALOGFACTORY->updateSelectionWidget(container->countSelected(),container->totalSelectedLength());
     finish(false);
@@ -87,8 +92,8 @@ void RS_ActionModifyMove::mouseMoveEvent(QMouseEvent* e) {
 				pPoints->targetPoint = mouse;
 
                 deletePreview();
-                preview->addSelectionFrom(*container);
-				preview->move(pPoints->targetPoint-pPoints->referencePoint);
+                preview->addTransformedSelectionFrom(*container,
+                    RS_Preview::moveTransform(pPoints->targetPoint-pPoints->referencePoint));
 
                 if (e->modifiers() & Qt::ShiftModifier) {
                     RS_Line *line = new RS_Line(pPoints->referencePoint, mouse);
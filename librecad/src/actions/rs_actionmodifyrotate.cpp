@@ -72,8 +72,8 @@ void RS_ActionModifyRotate::mouseMoveEvent(QMouseEvent* e) {
     case setTargetPoint:
         if( ! mouse.valid ) return;
         deletePreview();
-        preview->addSelectionFrom(*container);
-		preview->rotate(data->center,RS_Math::correctAngle((mouse - data->center).angle() - data->angle));
+        preview->addTransformedSelectionFrom(*container, RS_Preview::rotateTransform(data->center,
+            RS_Math::correctAngle((mouse - data->center).angle() - data->angle)));
         drawPreview();
     }
 
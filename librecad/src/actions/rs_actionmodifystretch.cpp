@@ -101,10 +101,8 @@ void RS_ActionModifyStretch::mouseMoveEvent(QMouseEvent* e) {
 			pPoints->targetPoint = mouse;
 
             deletePreview();
-			preview->addStretchablesFrom(*container, pPoints->firstCorner, pPoints->secondCorner);
-            //preview->move(targetPoint-referencePoint);
-			preview->stretch(pPoints->firstCorner, pPoints->secondCorner,
-							 pPoints->targetPoint-pPoints->referencePoint);
+			preview->addStretchedFrom(*container, pPoints->firstCorner, pPoints->secondCorner,
+									  pPoints->targetPoint-pPoints->referencePoint);
             drawPreview();
         }
         break;
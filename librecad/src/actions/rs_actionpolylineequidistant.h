@@ -79,16 +79,11 @@ public:
 
 	bool makeContour();
 
-private:
-    RS_Entity* calculateOffset(RS_Entity* newEntity,RS_Entity* orgEntity, double dist);
-    RS_Vector calculateIntersection(RS_Entity* first,RS_Entity* last);
-
 private:
     RS_Entity* originalEntity = nullptr;
 	std::unique_ptr<RS_Vector> targetPoint;
     double dist = 0.;
     int number = 0;
-    bool bRightSide = false;
 };
 
 #endif
@@ -29,6 +29,7 @@
 #include <QMouseEvent>
 #include "rs_actionpolylinesegment.h"
 
+#include "lc_endpointgraph.h"
 #include "rs_dialogfactory.h"
 #include "rs_graphicview.h"
 #include "rs_arc.h"
@@ -161,59 +162,30 @@ bool RS_ActionPolylineSegment::convertPolyline(RS_Entity* selectedEntity, bool u
 
     RS_DEBUG->print("RS_ActionPolylineSegment::convertPolyline");
 
-    QList<RS_Entity*> remaining;
     QList<RS_Entity*> completed;
     RS_Vector start = selectedEntity->getStartpoint();
     RS_Vector end = selectedEntity->getEndpoint();
 	if (!useSelected || (selectedEntity && selectedEntity->isSelected()))
 		completed.append(selectedEntity);
-//get list with useful entities
-
-	for (RS_Entity* e1 : *container) {
-		if (useSelected && !e1->isSelected()) continue;
-        if (e1->isLocked() || !e1->isVisible() || e1 == selectedEntity) continue;
-        if (e1->rtti()==RS2::EntityLine || e1->rtti()==RS2::EntityArc
-                || e1->rtti()==RS2::EntityPolyline) {
-            if (targetEntity->rtti()==RS2::EntityPolyline && ((RS_Polyline*)targetEntity)->isClosed())
-                continue;
-            if (e1 == selectedEntity)
-                continue;
-            remaining.append(e1);
-        }
-    }
+//get graph of useful entities
+    const bool closedTarget = targetEntity->rtti()==RS2::EntityPolyline && ((RS_Polyline*)targetEntity)->isClosed();
+    LC_EndpointGraph graph{*container, [&](const RS_Entity* e1) {
+        if (closedTarget || (useSelected && !e1->isSelected())) return false;
+        if (e1->isLocked() || !e1->isVisible() || e1 == selectedEntity) return false;
+        return e1->rtti()==RS2::EntityLine || e1->rtti()==RS2::EntityArc
+                || e1->rtti()==RS2::EntityPolyline;
+    }};
 
     // find all connected entities:
-    bool done = true;
-    do {
-        done = true;
-        for (int i=(remaining.size() -1) ; i>=0; --i) {
-            RS_Entity* e=remaining.at(i);
-            if (e->getEndpoint().distanceTo(start) < 1.0e-4) {
-                completed.prepend( e);
-                start = e->getStartpoint();
-                remaining.removeAt(i);
-                done = false;
-            } else if (e->getStartpoint().distanceTo(start) < 1.0e-4) {
-                completed.prepend( e);
-                start = e->getEndpoint();
-                remaining.removeAt(i);
-                done = false;
-            } else if (e->getEndpoint().distanceTo(end) < 1.0e-4) {
-                completed.append( e);
-                end = e->getStartpoint();
-                remaining.removeAt(i);
-                done = false;
-            } else if (e->getStartpoint().distanceTo(end) < 1.0e-4) {
-                completed.append( e);
-                end = e->getEndpoint();
-                remaining.removeAt(i);
-                done = false;
-            }
-        }
-    } while (!done);
-
-//cleanup for no more needed list
-    remaining.clear();
+    RS_Vector next;
+    while (RS_Entity* e = graph.takeEdge(start, next)) {
+        completed.prepend(e);
+        start = next;
+    }
+    while (RS_Entity* e = graph.takeEdge(end, next)) {
+        completed.append(e);
+        end = next;
+    }
 
     bool closed = false;
     if (document) {
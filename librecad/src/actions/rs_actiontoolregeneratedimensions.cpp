@@ -26,14 +26,166 @@
 
 #include "rs_actiontoolregeneratedimensions.h"
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include <QAction>
+#include <QThreadPool>
+#include "lc_documentsnapshot.h"
+#include "lc_progressdialog.h"
+#include "lc_regenstatistics.h"
+#include "lc_resultqueue.h"
+#include "lc_taskscheduler.h"
 #include "rs_dialogfactory.h"
+#include "rs_graphic.h"
 #include "rs_graphicview.h"
 #include "rs_information.h"
 #include "rs_dimension.h"
 #include "rs_debug.h"
 
+namespace {
+// fewer dimensions are regenerated at once
+constexpr std::size_t backgroundMinimum = 1000;
+// dimensions regenerated by a worker task and swapped in as one batch
+constexpr std::size_t batchSize = 256;
+// the object name of the running regeneration of a view
+const char* const regenerationName = "DimensionRegeneration";
+
+/**
+ * Regenerates the dimensions of a graphic in background: workers regenerate copies of
+ * the dimensions in a snapshot of the graphic, the GUI thread swaps the geometry of
+ * the copies into the dimensions in batches, with one redraw per batch. The view can
+ * be panned and zoomed meanwhile.
+ *
+ * The regeneration is a child of the view, it's stopped by the cancel button of its
+ * progress, by changes of the graphic and by closing the view.
+ */
+class BackgroundRegeneration : public QObject {
+public:
+    using Batch = std::vector<std::pair<RS_Dimension*, std::unique_ptr<RS_Dimension>>>;
+
+    BackgroundRegeneration(RS_Graphic& graphic, std::vector<RS_Dimension*> dimensions,
+                           RS_GraphicView& view);
+    ~BackgroundRegeneration() override;
+
+private:
+    // by a worker thread
+    void run();
+    // by the GUI thread, false if the batch is dropped
+    bool apply(Batch& batch, std::size_t count);
+    void finish(const QString& message);
+
+    RS_Graphic& m_graphic;
+    RS_GraphicView& m_view;
+    const std::vector<RS_Dimension*> m_dimensions;
+    const std::shared_ptr<const LC_DocumentSnapshot> m_snapshot;
+    const std::size_t m_styleKey;
+    std::size_t m_done = 0;
+    bool m_finished = false;
+    std::unique_ptr<LC_ProgressDialog> m_dialog;
+    LC_ResultQueue m_results;
+    // destroyed first, waiting for the worker
+    QThreadPool m_pool;
+};
+
+BackgroundRegeneration::BackgroundRegeneration(RS_Graphic& graphic,
+                                               std::vector<RS_Dimension*> dimensions,
+                                               RS_GraphicView& view):
+    QObject(&view)
+    ,m_graphic(graphic)
+    ,m_view(view)
+    ,m_dimensions(std::move(dimensions))
+    ,m_snapshot(graphic.snapshot())
+    ,m_styleKey(RS_Dimension::getStyleKey(&graphic))
+    ,m_dialog(std::make_unique<LC_ProgressDialog>(
+                  RS_ActionToolRegenerateDimensions::tr("Regenerating dimensions"), &view))
+{
+    setObjectName(regenerationName);
+    // the drawing stays usable, the dialog only shows the progress
+    m_dialog->setWindowModality(Qt::NonModal);
+    LC_Progress* progress = m_dialog->getProgress();
+    connect(m_dialog.get(), &QProgressDialog::canceled, this, [this, progress]() {
+        progress->cancel();
+        finish(RS_ActionToolRegenerateDimensions::tr("Regeneration of dimensions cancelled"));
+    });
+    progress->start(m_dimensions.size());
+
+    m_pool.setMaxThreadCount(1);
+    m_pool.start([this]() { run(); });
+}
+
+BackgroundRegeneration::~BackgroundRegeneration()
+{
+    m_dialog->getProgress()->cancel();
+    m_pool.waitForDone();
+}
+
+void BackgroundRegeneration::run()
+{
+    const LC_CancelToken* cancel = m_dialog->getProgress()->getCancelToken();
+    LC_TaskScheduler::instance().parallelFor(0, m_dimensions.size(), batchSize,
+                                             [this](std::size_t begin, std::size_t end) {
+        LC_REGEN_REASON("regenerate dimensions");
+        auto batch = std::make_shared<Batch>();
+        for (std::size_t i = begin; i < end; ++i) {
+            // the snapshot is only read, the copies are regenerated
+            const RS_Entity* copy = m_snapshot->getCopy(m_dimensions[i]);
+            if (copy == nullptr)
+                continue;
+            std::unique_ptr<RS_Dimension> updated{static_cast<RS_Dimension*>(copy->clone())};
+            if (updated->getLabel() == ";;")
+                updated->setLabel("");
+            updated->updateDim(true);
+            updated->setUpdatedStyleKey(m_styleKey);
+            batch->emplace_back(m_dimensions[i], std::move(updated));
+        }
+        const bool woken = m_results.push([this, batch, count = end - begin]() {
+            return apply(*batch, count);
+        });
+        // one event for the batches done meanwhile
+        if (woken)
+            QMetaObject::invokeMethod(this, [this]() {
+                if (m_results.apply())
+                    m_view.redraw();
+                if (m_done == m_dimensions.size())
+                    finish(RS_ActionToolRegenerateDimensions::tr("Regenerated %1 dimension entities")
+                           .arg(m_dimensions.size()));
+            }, Qt::QueuedConnection);
+    }, cancel);
+}
+
+bool BackgroundRegeneration::apply(Batch& batch, std::size_t count)
+{
+    LC_Progress* progress = m_dialog->getProgress();
+    if (progress->isCancelled())
+        return false;
+    // the dimensions may be deleted or changed
+    if (m_graphic.getSnapshotVersion() != m_snapshot->getVersion()) {
+        progress->cancel();
+        finish(RS_ActionToolRegenerateDimensions::tr(
+                   "Regeneration of dimensions stopped, the drawing was changed"));
+        return false;
+    }
+    for (auto& [dimension, updated]: batch)
+        dimension->takeGeometry(*updated);
+    m_done += count;
+    progress->advance(count);
+    return true;
+}
 
+void BackgroundRegeneration::finish(const QString& message)
+{
+    if (m_finished)
+        return;
+    m_finished = true;
+    // stops the workers, if not done
+    m_dialog->getProgress()->cancel();
+    m_dialog->hide();
+    RS_DIALOGFACTORY->commandMessage(message);
+    deleteLater();
+}
+}
 
 RS_ActionToolRegenerateDimensions::RS_ActionToolRegenerateDimensions(RS_EntityContainer& container,
         RS_GraphicView& graphicView)
@@ -52,26 +204,55 @@ void RS_ActionToolRegenerateDimensions::trigger() {
 
     RS_DEBUG->print("RS_ActionToolRegenerateDimensions::trigger()");
 
-	int num = 0;
+    // a running regeneration is replaced
+    delete graphicView->findChild<QObject*>(regenerationName, Qt::FindDirectChildrenOnly);
+
+	std::vector<RS_Dimension*> dimensions;
 	for(auto e: *container){
+        if (RS_Information::isDimension(e->rtti()) && e->isVisible())
+            dimensions.push_back(static_cast<RS_Dimension*>(e));
+    }
+    if (dimensions.empty()) {
+        RS_DIALOGFACTORY->commandMessage(tr("No dimension entities found"));
+        finish(false);
+        return;
+    }
 
-        if (RS_Information::isDimension(e->rtti()) && e->isVisible()) {
-			num++;
-			if (((RS_Dimension*)e)->getLabel()==";;") {
-				((RS_Dimension*)e)->setLabel("");
-			}
-            ((RS_Dimension*)e)->updateDim(true);
-        }
+    // the missing variables are added and the font loaded before, the updates
+    // then only read them
+    dimensions.front()->addDefaultStyleVariables();
+    const std::size_t styleKey = RS_Dimension::getStyleKey(container->getGraphic());
+
+    // large drawings are regenerated in background, over a snapshot of the graphic
+    if (dimensions.size() >= backgroundMinimum && container->rtti() == RS2::EntityGraphic) {
+        RS_DEBUG->print("RS_ActionToolRegenerateDimensions::trigger(): %zu dimensions in background",
+                        dimensions.size());
+        new BackgroundRegeneration(*static_cast<RS_Graphic*>(container), std::move(dimensions),
+                                   *graphicView);
+        finish(false);
+        return;
     }
 
-    if (num>0) {
-    	graphicView->redraw();
-        RS_DIALOGFACTORY->commandMessage(
-            tr("Regenerated %1 dimension entities").arg(num));
-    } else {
-        RS_DIALOGFACTORY->commandMessage(tr("No dimension entities found"));
+	int num = 0;
+	// the dimensions regenerated before a cancel are kept, there's nothing to undo
+	LC_ProgressDialog dialog(tr("Regenerating dimensions"), graphicView);
+	LC_Progress* progress = dialog.getProgress();
+	progress->start(dimensions.size());
+	for(RS_Dimension* dim: dimensions){
+		if (!progress->advance())
+			break;
+		num++;
+		if (dim->getLabel()==";;") {
+			dim->setLabel("");
+		}
+		dim->updateDim(true);
+		dim->setUpdatedStyleKey(styleKey);
     }
 
+	graphicView->redraw();
+	RS_DIALOGFACTORY->commandMessage(
+		tr("Regenerated %1 dimension entities").arg(num));
+
     finish(false);
 }
 
@@ -719,6 +719,12 @@ RS_Commands::RS_Commands() {
                 {"tm2", QObject::tr("tm2", "modify - multi trim (extend)")}},
             RS2::ActionModifyTrim2
         },
+        // trim to edges
+        {
+            {{"trimedges", QObject::tr("trimedges", "modify - trim (extend) to many edges")}},
+            {{"te", QObject::tr("te", "modify - trim (extend) to many edges")}},
+            RS2::ActionModifyTrimToEdges
+        },
         // lengthen
         {
             {{"modlengthen", QObject::tr("modlengthen", "modify - lengthen")}},
@@ -779,6 +785,12 @@ RS_Commands::RS_Commands() {
             {{"xt", QObject::tr("xt", "explode text strings")}},
             RS2::ActionModifyExplodeText
         },
+        // delete duplicate and overlapping entities
+        {
+            {{"overkill", QObject::tr("overkill", "delete duplicate and overlapping entities")}},
+            {{"ok", QObject::tr("ok", "delete duplicate and overlapping entities")}},
+            RS2::ActionModifyOverkill
+        },
         // explode
         {
             {{"modexplode", QObject::tr("modexplode", "explode block/polyline into entities")}},
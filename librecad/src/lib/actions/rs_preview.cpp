@@ -24,32 +24,73 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+
 #include "rs_preview.h"
 #include "rs_entitycontainer.h"
 #include "rs_line.h"
 #include "rs_graphicview.h"
 #include "rs_information.h"
+#include "rs_painter.h"
 #include "rs_settings.h"
 
+/**
+ * Clones of the selected entities of a container, drawn by a transform
+ */
+struct RS_Preview::TransformedSelection {
+    RS_EntityContainer clones{nullptr, true};
+    // the state of the container, when the selection was cloned
+    const RS_EntityContainer* container = nullptr;
+    unsigned long revision = 0;
+    unsigned selected = 0;
+    QTransform transform;
+    // previewed, until the preview is cleared
+    bool shown = false;
+};
+
+/**
+ * Entities of a container affected by a stretch window: clones of the entities
+ * within the window, moved by the transform, and the entities crossing the window
+ */
+struct RS_Preview::StretchWindow {
+    TransformedSelection moved;
+    int movedCount = 0;
+    std::vector<RS_Entity*> crossing;
+    RS_Vector firstCorner{false};
+    RS_Vector secondCorner{false};
+};
+
 /**
  * Constructor.
  */
 RS_Preview::RS_Preview(RS_EntityContainer* parent)
         : RS_EntityContainer(parent, true)
+        , m_selection{std::make_unique<TransformedSelection>()}
+        , m_stretch{std::make_unique<StretchWindow>()}
 {
     auto groupGuard = RS_SETTINGS->beginGroupGuard("/Appearance");
     maxEntities = RS_SETTINGS->readNumEntry("/MaxPreview", 100);
+    selectionBorder = RS_SETTINGS->readNumEntry("/PreviewSelectionBorder", 0) != 0;
 
     groupGuard = RS_SETTINGS->beginGroupGuard("/Colors");
     RS_Color highLight = QColor(RS_SETTINGS->readEntry("/highlight", RS_Settings::highlight));
     setPen(RS_Pen(highLight, RS2::Width00, RS2::SolidLine));
+    // the clones are drawn with the attributes of the preview
+    m_selection->clones.reparent(this);
+    m_stretch->moved.clones.reparent(this);
 }
 
+RS_Preview::~RS_Preview() = default;
+
 /**
  * Adds an entity to this preview and removes any attributes / layer
  * connections before that.
  */
 void RS_Preview::addEntity(RS_Entity* entity) {
+    addEntityTo(*this, entity);
+}
+
+void RS_Preview::addEntityTo(RS_EntityContainer& target, RS_Entity* entity) {
 	if (!entity || entity->isUndone()) {
         return;
     }
@@ -64,7 +105,7 @@ void RS_Preview::addEntity(RS_Entity* entity) {
         addBorder = true;
     } else {
         if (entity->isContainer() && entity->rtti()!=RS2::EntitySpline) {
-            if (entity->countDeep() > maxEntities-countDeep()) {
+            if (entity->countDeep() > maxEntities-target.countDeep()) {
                 addBorder = true;
             }
         }
@@ -75,26 +116,26 @@ void RS_Preview::addEntity(RS_Entity* entity) {
         RS_Vector max = entity->getMax();
 
         RS_Line* l1 =
-			new RS_Line(this, {min.x, min.y}, {max.x, min.y});
+			new RS_Line(&target, {min.x, min.y}, {max.x, min.y});
         RS_Line* l2 =
-			new RS_Line(this, {max.x, min.y}, {max.x, max.y});
+			new RS_Line(&target, {max.x, min.y}, {max.x, max.y});
         RS_Line* l3 =
-			new RS_Line(this, {max.x, max.y}, {min.x, max.y});
+			new RS_Line(&target, {max.x, max.y}, {min.x, max.y});
         RS_Line* l4 =
-			new RS_Line(this, {min.x, max.y}, {min.x, min.y});
+			new RS_Line(&target, {min.x, max.y}, {min.x, min.y});
 
-        RS_EntityContainer::addEntity(l1);
-        RS_EntityContainer::addEntity(l2);
-        RS_EntityContainer::addEntity(l3);
-        RS_EntityContainer::addEntity(l4);
+        target.RS_EntityContainer::addEntity(l1);
+        target.RS_EntityContainer::addEntity(l2);
+        target.RS_EntityContainer::addEntity(l3);
+        target.RS_EntityContainer::addEntity(l4);
 
         delete entity;
     } else {
         entity->setLayer(nullptr);
         entity->setSelected(false);
-        entity->reparent(this);
+        entity->reparent(&target);
                 // Don't set this pen, let drawing routines decide entity->setPenToActive();
-        RS_EntityContainer::addEntity(entity);
+        target.RS_EntityContainer::addEntity(entity);
     }
 }
 
@@ -149,34 +190,114 @@ void RS_Preview::addSelectionFrom(RS_EntityContainer& container) {
     }
 }
 
-/**
- * Adds all entities in the given range and those which have endpoints
- * in the given range to the preview.
- */
-void RS_Preview::addStretchablesFrom(RS_EntityContainer& container,
-                                     const RS_Vector& v1, const RS_Vector& v2) {
-    int c=0;
+void RS_Preview::addTransformedSelectionFrom(RS_EntityContainer& container, const QTransform& transform) {
+    TransformedSelection& selection = *m_selection;
+    const unsigned selected = container.countSelected();
+    if (selection.container != &container || selection.revision != container.getRevision()
+            || selection.selected != selected) {
+        selection.clones.clear();
+        selection.container = &container;
+        selection.revision = container.getRevision();
+        selection.selected = selected;
 
-	for(auto e: container){
+        int c=0;
+        RS_Vector minV{false};
+        RS_Vector maxV{false};
+        bool exceeded = false;
+        for(auto e: container){
+            if (!e->isSelected() || e->isUndone())
+                continue;
+            minV = minV.valid ? RS_Vector::minimum(minV, e->getMin()) : e->getMin();
+            maxV = maxV.valid ? RS_Vector::maximum(maxV, e->getMax()) : e->getMax();
+            if (c<maxEntities) {
+                RS_Entity* clone = e->clone();
+                clone->setSelected(false);
+                clone->reparent(&selection.clones);
+
+                c+=clone->countDeep();
+                addEntityTo(selection.clones, clone);
+                // clone might be nullptr after this point
+            } else {
+                exceeded = true;
+            }
+        }
 
-        if (e->isVisible() &&
-                e->rtti()!=RS2::EntityHatch &&
-                ((e->isInWindow(v1, v2)) ||
-                 e->hasEndpointsWithinWindow(v1, v2)) &&
+        if (exceeded && selectionBorder) {
+            // the bounding box of the whole selection
+            selection.clones.clear();
+            const RS_Vector corners[] = {minV, {maxV.x, minV.y}, maxV, {minV.x, maxV.y}};
+            for (int i = 0; i < 4; ++i)
+                selection.clones.addEntity(new RS_Line(&selection.clones, corners[i], corners[(i + 1) % 4]));
+        }
+    }
+    selection.transform = transform;
+    selection.shown = true;
+}
 
-                c<maxEntities) {
+void RS_Preview::addStretchedFrom(RS_EntityContainer& container, const RS_Vector& v1, const RS_Vector& v2,
+                                  const RS_Vector& offset) {
+    StretchWindow& window = *m_stretch;
+    TransformedSelection& moved = window.moved;
+    if (moved.container != &container || moved.revision != container.getRevision()
+            || window.firstCorner != v1 || window.secondCorner != v2) {
+        moved.clones.clear();
+        moved.container = &container;
+        moved.revision = container.getRevision();
+        window.firstCorner = v1;
+        window.secondCorner = v2;
 
+        std::vector<RS_Entity*> inside;
+        container.getStretchEntities(v1, v2, inside, window.crossing);
+        auto isHatch = [](const RS_Entity* e) {
+            return e->rtti() == RS2::EntityHatch;
+        };
+        window.crossing.erase(std::remove_if(window.crossing.begin(), window.crossing.end(), isHatch),
+                              window.crossing.end());
+
+        int c=0;
+        for (RS_Entity* e: inside) {
+            if (c >= maxEntities)
+                break;
+            if (isHatch(e))
+                continue;
             RS_Entity* clone = e->clone();
-            //clone->setSelected(false);
-            clone->reparent(this);
+            clone->setSelected(false);
+            clone->reparent(&moved.clones);
 
             c+=clone->countDeep();
-            addEntity(clone);
+            addEntityTo(moved.clones, clone);
             // clone might be nullptr after this point
         }
+        window.movedCount = c;
+    }
+    moved.transform = moveTransform(offset);
+    moved.shown = true;
+
+    // the crossing entities change their shapes, they are stretched by every update
+    int c = window.movedCount;
+    for (RS_Entity* e: window.crossing) {
+        if (c >= maxEntities)
+            break;
+        RS_Entity* clone = e->clone();
+        clone->reparent(this);
+        clone->stretch(v1, v2, offset);
+
+        c+=clone->countDeep();
+        addEntity(clone);
+        // clone might be nullptr after this point
     }
 }
 
+/**
+ * Removes the preview entities, the clones of a transformed selection are kept to be
+ * reused, but not drawn.
+ */
+void RS_Preview::clear() {
+    m_selection->shown = false;
+    m_stretch->moved.shown = false;
+    RS_EntityContainer::clear();
+}
+
 void RS_Preview::draw(RS_Painter* painter, RS_GraphicView* view,
                               double& patternOffset) {
 
@@ -184,8 +305,57 @@ void RS_Preview::draw(RS_Painter* painter, RS_GraphicView* view,
         return;
     }
 
+    if (m_selection->shown)
+        drawTransformed(painter, view, *m_selection, patternOffset);
+    if (m_stretch->moved.shown)
+        drawTransformed(painter, view, m_stretch->moved, patternOffset);
+
     foreach (auto e, entities)
     {
         e->draw(painter, view, patternOffset);
     }
 }
+
+void RS_Preview::drawTransformed(RS_Painter* painter, RS_GraphicView* view,
+                                 const TransformedSelection& selection, double& patternOffset) {
+    // the transform in screen coordinates, by the graph to screen mapping of the view
+    const RS_Vector origin = view->toGui(RS_Vector{0., 0.});
+    const RS_Vector unitX = view->toGui(RS_Vector{1., 0.}) - origin;
+    const RS_Vector unitY = view->toGui(RS_Vector{0., 1.}) - origin;
+    const QTransform toGui{unitX.x, unitX.y, unitY.x, unitY.y, origin.x, origin.y};
+    painter->setScreenTransform(toGui.inverted() * selection.transform * toGui);
+    for (RS_Entity* e: selection.clones)
+        e->draw(painter, view, patternOffset);
+    painter->resetScreenTransform();
+}
+
+QTransform RS_Preview::moveTransform(const RS_Vector& offset) {
+    return QTransform::fromTranslate(offset.x, offset.y);
+}
+
+QTransform RS_Preview::rotateTransform(const RS_Vector& center, double angle) {
+    QTransform transform;
+    transform.translate(center.x, center.y);
+    transform.rotateRadians(angle);
+    transform.translate(- center.x, - center.y);
+    return transform;
+}
+
+QTransform RS_Preview::scaleTransform(const RS_Vector& center, const RS_Vector& factor) {
+    QTransform transform;
+    transform.translate(center.x, center.y);
+    transform.scale(factor.x, factor.y);
+    transform.translate(- center.x, - center.y);
+    return transform;
+}
+
+QTransform RS_Preview::mirrorTransform(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
+    const RS_Vector direction = (axisPoint2 - axisPoint1).normalized();
+    // the reflection about the axis through the origin, then moved to the axis points
+    const double xx = 2. * direction.x * direction.x - 1.;
+    const double xy = 2. * direction.x * direction.y;
+    const double yy = 2. * direction.y * direction.y - 1.;
+    const QTransform reflection{xx, xy, xy, yy, 0., 0.};
+    return QTransform::fromTranslate(- axisPoint1.x, - axisPoint1.y) * reflection
+            * QTransform::fromTranslate(axisPoint1.x, axisPoint1.y);
+}
@@ -28,6 +28,10 @@
 #ifndef RS_PREVIEW_H
 #define RS_PREVIEW_H
 
+#include <memory>
+
+#include <QTransform>
+
 #include "rs_entitycontainer.h"
 
 /**
@@ -40,20 +44,54 @@
 class RS_Preview : public RS_EntityContainer {
 public:
     RS_Preview(RS_EntityContainer* parent=nullptr);
+    ~RS_Preview() override;
     RS2::EntityType rtti() const override{
         return RS2::EntityPreview;
     }
     void addEntity(RS_Entity* entity) override;
     void addCloneOf(RS_Entity* entity);
     virtual void addSelectionFrom(RS_EntityContainer& container);
+    /**
+     * @brief addTransformedSelectionFrom previews the selected entities of the container
+     * transformed, by a painter transform when drawn. The selection is cloned once,
+     * and the clones are reused while the container and its selection are unchanged.
+     * Above the number of preview entities, the selection is previewed by its
+     * bounding box, if set in the preferences.
+     * @param transform - the transform, in graph coordinates
+     */
+    void addTransformedSelectionFrom(RS_EntityContainer& container, const QTransform& transform);
     virtual void addAllFrom(RS_EntityContainer& container);
-    virtual void addStretchablesFrom(RS_EntityContainer& container,
-                                     const RS_Vector& v1, const RS_Vector& v2);
+    /**
+     * @brief addStretchedFrom previews the entities of the container stretched by the
+     * window. The entities are found and classified once per window and container state:
+     * the entities within the window are cloned once and moved by a painter transform,
+     * only the entities crossing the window are cloned and stretched on every update.
+     * @param offset - the offset of the stretch
+     */
+    void addStretchedFrom(RS_EntityContainer& container, const RS_Vector& v1, const RS_Vector& v2,
+                          const RS_Vector& offset);
 
+    void clear() override;
     void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
 
+    //! \{ the transforms of graph coordinates previewed by the modification actions
+    static QTransform moveTransform(const RS_Vector& offset);
+    static QTransform rotateTransform(const RS_Vector& center, double angle);
+    static QTransform scaleTransform(const RS_Vector& center, const RS_Vector& factor);
+    static QTransform mirrorTransform(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2);
+    //! \}
+
 private:
+    void addEntityTo(RS_EntityContainer& target, RS_Entity* entity);
+    struct TransformedSelection;
+    void drawTransformed(RS_Painter* painter, RS_GraphicView* view, const TransformedSelection& selection,
+                         double& patternOffset);
+
     int maxEntities = 0;
+    bool selectionBorder = false;
+    std::unique_ptr<TransformedSelection> m_selection;
+    struct StretchWindow;
+    std::unique_ptr<StretchWindow> m_stretch;
 };
 
 #endif
@@ -118,6 +118,11 @@ void RS_PreviewActionInterface::deletePreview() {
  * Draws / deletes the current preview.
  */
 void RS_PreviewActionInterface::drawPreview() {
+	// nothing is shown while a macro is played back
+	if (graphicView->isRedrawDeferred()) {
+		hasPreview=true;
+		return;
+	}
 	// RVT_PORT How does offset work??        painter->setOffset(offset);
 	RS_EntityContainer *container=graphicView->getOverlayContainer(RS2::ActionPreviewEntity);
 	container->clear();
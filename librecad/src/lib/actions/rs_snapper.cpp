@@ -25,18 +25,26 @@
 **********************************************************************/
 
 
+#include<algorithm>
+#include<atomic>
 #include<cmath>
+#include<memory>
 
+#include<QCoreApplication>
 #include<QMouseEvent>
+#include<QThreadPool>
 
 #include "rs_snapper.h"
 
+#include "lc_documentsnapshot.h"
+#include "lc_trace.h"
 #include "rs_circle.h"
 #include "rs_coordinateevent.h"
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "rs_entitycontainer.h"
 #include "rs_graphicview.h"
+#include "rs_graphic.h"
 #include "rs_grid.h"
 #include "rs_line.h"
 #include "rs_overlayline.h"
@@ -199,8 +207,128 @@ struct RS_Snapper::Indicator
 struct RS_Snapper::ImpData {
 RS_Vector snapCoord;
 RS_Vector snapSpot;
+    /**
+     * The last snap of a mouse event, reused while the cursor stays on the same pixel
+     * and the view, the snap mode and the entities are unchanged
+     */
+    struct SnapCache {
+        bool valid = false;
+        QPoint pixel;
+        RS_Vector origin;
+        double pixelSize = 0.;
+        RS_Vector relativeZero;
+        RS_SnapMode snapMode;
+        double snapModeDistance = 0.;
+        double snapDistance = 0.;
+        int middlePoints = 0;
+        unsigned long revision = 0;
+        RS_Vector snapSpot;
+        RS_Vector snapCoord;
+        RS_Entity* keyEntity = nullptr;
+
+        // whether the other cache is for the same pixel, view, snap mode and entities
+        bool isSameRequest(const SnapCache& other) const
+        {
+            return pixel == other.pixel && origin == other.origin
+                    && pixelSize == other.pixelSize && relativeZero == other.relativeZero
+                    && snapMode == other.snapMode && snapModeDistance == other.snapModeDistance
+                    && snapDistance == other.snapDistance && middlePoints == other.middlePoints
+                    && revision == other.revision;
+        }
+    };
+    SnapCache cache;
+
+    /**
+     * The intersection snap of a mouse move, found by a worker thread in a snapshot of
+     * the graphic. Meanwhile the mouse move snaps without intersections, once the
+     * intersection is found the mouse move is replayed to snap with it.
+     * A request cancels the previous one, its result is dropped.
+     */
+    struct AsyncSnap {
+        AsyncSnap()
+        {
+            pool.setMaxThreadCount(1);
+        }
+        ~AsyncSnap()
+        {
+            // drops the results posted to the view, not applied yet
+            ++*generation;
+        }
+
+        void request(const SnapCache& key, const RS_Vector& coord, const QMouseEvent& e,
+                     RS_Graphic& graphic, RS_GraphicView* view);
+
+        SnapCache key;
+        bool ready = false;
+        RS_Vector intersection;
+        std::shared_ptr<std::atomic<unsigned long>> generation
+            = std::make_shared<std::atomic<unsigned long>>(0);
+        // the snapshot is only replaced while no worker is running
+        std::shared_ptr<const LC_DocumentSnapshot> snapshot;
+        unsigned long snapshotRevision = 0;
+        // destroyed first, waiting for the running worker
+        QThreadPool pool;
+    };
+    bool asyncSnapping = false;
+    std::unique_ptr<AsyncSnap> async;
+
+    // the asynchronous intersection snap of a mouse move in a graphic, if enabled
+    AsyncSnap* getAsyncSnap(const QMouseEvent& e, const RS_EntityContainer& container)
+    {
+        if (!asyncSnapping || e.type() != QEvent::MouseMove
+                || container.rtti() != RS2::EntityGraphic)
+            return nullptr;
+        if (async == nullptr)
+            async = std::make_unique<AsyncSnap>();
+        return async.get();
+    }
 };
 
+void RS_Snapper::ImpData::AsyncSnap::request(const SnapCache& key, const RS_Vector& coord,
+                                             const QMouseEvent& e, RS_Graphic& graphic,
+                                             RS_GraphicView* view)
+{
+    if (!ready && this->key.isSameRequest(key))
+        return;
+    this->key = key;
+    ready = false;
+    const unsigned long current = ++*generation;
+    pool.clear();
+
+    if (snapshot == nullptr || snapshotRevision != key.revision) {
+        // released first, so the new snapshot shares the unchanged copies
+        pool.waitForDone();
+        snapshot.reset();
+        snapshot = graphic.snapshot();
+        snapshotRevision = key.revision;
+    }
+
+    const QPointF position = e.position();
+    const QPointF globalPosition = e.globalPosition();
+    const Qt::MouseButtons buttons = e.buttons();
+    const Qt::KeyboardModifiers modifiers = e.modifiers();
+    pool.start([this, snapshot = snapshot, generation = generation, current, coord,
+               view, position, globalPosition, buttons, modifiers]() {
+        // cancelled by a later mouse move before starting
+        if (*generation != current)
+            return;
+        snapshot->enableSpatialIndex();
+        const RS_Vector found = snapshot->getGraphic().getNearestIntersection(coord, nullptr);
+        view->postResult([this, generation, current, found,
+                         view, position, globalPosition, buttons, modifiers]() {
+            if (*generation != current)
+                return false;
+            ready = true;
+            intersection = found;
+            QCoreApplication::postEvent(view, new QMouseEvent(QEvent::MouseMove, position,
+                                                              globalPosition, Qt::NoButton,
+                                                              buttons, modifiers));
+            // the replayed mouse move redraws
+            return false;
+        });
+    });
+}
+
 /**
  * Constructor.
  */
@@ -222,6 +350,7 @@ void RS_Snapper::init()
 	keyEntity = nullptr;
 	pImpData->snapSpot = RS_Vector{false};
 	pImpData->snapCoord = RS_Vector{false};
+	pImpData->cache.valid = false;
 	m_SnapDistance = 1.0;
 
     RS_SETTINGS->beginGroup("/Appearance");
@@ -229,6 +358,7 @@ void RS_Snapper::init()
     snap_indicator->lines_type = RS_SETTINGS->readEntry("/indicator_lines_type", "Crosshair");
     snap_indicator->shape_state = RS_SETTINGS->readNumEntry("/indicator_shape_state", 1);
     snap_indicator->shape_type = RS_SETTINGS->readEntry("/indicator_shape_type", "Circle");
+    pImpData->asyncSnapping = RS_SETTINGS->readNumEntry("/AsyncSnapping", 0) != 0;
     RS_SETTINGS->endGroup();
 
     RS_SETTINGS->beginGroup("Colors");
@@ -295,8 +425,42 @@ RS_Vector RS_Snapper::snapPoint(QMouseEvent* e)
 		return pImpData->snapSpot;
     }
 
+    if (snapMode.snapMiddle) {
+        //todo: accept value from widget QG_SnapMiddleOptions
+		RS_DIALOGFACTORY->requestSnapMiddleOptions(middlePoints, snapMode.snapMiddle);
+    }
+    if (snapMode.snapDistance) {
+        //todo: accept value from widget QG_SnapDistOptions
+		RS_DIALOGFACTORY->requestSnapDistOptions(m_SnapDistance, snapMode.snapDistance);
+    }
+
+    // a mouse move within the pixel of the previous snap gives the same snap
+    const QPoint pixel = e->position().toPoint();
+    ImpData::SnapCache current;
+    current.pixel = pixel;
+    current.origin = graphicView->toGraph(0, 0);
+    current.pixelSize = graphicView->toGraphDX(1);
+    current.relativeZero = graphicView->getRelativeZero();
+    current.snapMode = snapMode;
+    current.snapModeDistance = snapMode.distance;
+    current.snapDistance = m_SnapDistance;
+    current.middlePoints = middlePoints;
+    current.revision = container->getRevision();
+    ImpData::SnapCache& cache = pImpData->cache;
+    if (cache.valid && cache.isSameRequest(current)) {
+        keyEntity = cache.keyEntity;
+        pImpData->snapCoord = cache.snapCoord;
+        snapPoint(cache.snapSpot, false);
+        return pImpData->snapCoord;
+    }
+
     RS_Vector mouseCoord = graphicView->toGraph(e->position());
     double ds2Min=RS_MAXDOUBLE*RS_MAXDOUBLE;
+    // the expensive snaps are skipped once a point within a pixel is found, as a nearer
+    // point couldn't be told apart on screen
+    const double ds2Settled = current.pixelSize * current.pixelSize;
+    // a snap without the intersection still looked for isn't cached
+    bool provisional = false;
 
     if (snapMode.snapEndpoint) {
         t = snapEndpoint(mouseCoord);
@@ -316,9 +480,6 @@ RS_Vector RS_Snapper::snapPoint(QMouseEvent* e)
         }
     }
     if (snapMode.snapMiddle) {
-        //this is still brutal force
-        //todo: accept value from widget QG_SnapMiddleOptions
-		RS_DIALOGFACTORY->requestSnapMiddleOptions(middlePoints, snapMode.snapMiddle);
         t = snapMiddle(mouseCoord);
 		double ds2=mouseCoord.squaredTo(t);
         if (ds2 < ds2Min){
@@ -326,10 +487,8 @@ RS_Vector RS_Snapper::snapPoint(QMouseEvent* e)
 			pImpData->snapSpot = t;
         }
     }
-    if (snapMode.snapDistance) {
+    if (snapMode.snapDistance && ds2Min > ds2Settled) {
         //this is still brutal force
-        //todo: accept value from widget QG_SnapDistOptions
-		RS_DIALOGFACTORY->requestSnapDistOptions(m_SnapDistance, snapMode.snapDistance);
         t = snapDist(mouseCoord);
 		double ds2=mouseCoord.squaredTo(t);
         if (ds2 < ds2Min){
@@ -337,8 +496,18 @@ RS_Vector RS_Snapper::snapPoint(QMouseEvent* e)
 			pImpData->snapSpot = t;
         }
     }
-    if (snapMode.snapIntersection) {
-        t = snapIntersection(mouseCoord);
+    if (snapMode.snapIntersection && ds2Min > ds2Settled) {
+        ImpData::AsyncSnap* async = pImpData->getAsyncSnap(*e, *container);
+        if (async == nullptr) {
+            t = snapIntersection(mouseCoord);
+        } else if (async->ready && async->key.isSameRequest(current)) {
+            t = async->intersection;
+        } else {
+            async->request(current, mouseCoord, *e, *static_cast<RS_Graphic*>(container),
+                           graphicView);
+            t = RS_Vector{false};
+            provisional = true;
+        }
 		double ds2=mouseCoord.squaredTo(t);
         if (ds2 < ds2Min){
             ds2Min=ds2;
@@ -404,6 +573,12 @@ RS_Vector RS_Snapper::snapPoint(QMouseEvent* e)
     //}
     //else snapCoord = snapSpot;
 
+    current.valid = !provisional;
+    current.snapSpot = pImpData->snapSpot;
+    current.snapCoord = pImpData->snapCoord;
+    current.keyEntity = keyEntity;
+    cache = current;
+
 	snapPoint(pImpData->snapSpot, false);
 
 	return pImpData->snapCoord;
@@ -413,6 +588,7 @@ RS_Vector RS_Snapper::snapPoint(QMouseEvent* e)
 /**manually set snapPoint*/
 RS_Vector RS_Snapper::snapPoint(const RS_Vector& coord, bool setSpot)
 {
+    LC_TRACE_ZONE("RS_Snapper::snapPoint");
     if(coord.valid){
 		pImpData->snapSpot=coord;
 		if(setSpot) pImpData->snapCoord = coord;
@@ -645,14 +821,16 @@ RS_Entity* RS_Snapper::catchEntity(const RS_Vector& pos,
     double dist (0.);
 //    std::cout<<"getSnapRange()="<<getSnapRange()<<"\tsnap distance = "<<dist<<std::endl;
 
-    RS_Entity* entity = container->getNearestEntity(pos, &dist, level);
+    // candidates out of the catch distance are not tested
+    const double catchDistance = getCatchDistance(getSnapRange(), catchEntityGuiRange, graphicView);
+    RS_Entity* entity = container->getNearestEntity(pos, catchDistance, &dist, level);
 
     int idx = -1;
     if (entity != nullptr && entity->getParent()) {
         idx = entity->getParent()->findEntity(entity);
     }
 
-    if (entity != nullptr && dist <= getCatchDistance(getSnapRange(), catchEntityGuiRange, graphicView)) {
+    if (entity != nullptr && dist <= catchDistance) {
         // highlight:
         RS_DEBUG->print("RS_Snapper::catchEntity: found: %d", idx);
         return entity;
@@ -675,56 +853,61 @@ RS_Entity* RS_Snapper::catchEntity(const RS_Vector& pos,
  */
 RS_Entity* RS_Snapper::catchEntity(const RS_Vector& pos, RS2::EntityType enType,
                                    RS2::ResolveLevel level) {
+    return catchEntity(pos, EntityTypeList{enType}, level);
+}
+
+/**
+ * Catches an entity which is close to the given position 'pos'.
+ *
+ * @param pos A graphic coordinate.
+ * @param enTypeList, only search for entities of the listed types
+ * @param level The level of resolving for iterating through the entity
+ *        container
+ * @return Pointer to the entity or nullptr.
+ */
+RS_Entity* RS_Snapper::catchEntity(const RS_Vector& pos, const EntityTypeList& enTypeList,
+                                   RS2::ResolveLevel level) {
 
     RS_DEBUG->print("RS_Snapper::catchEntity");
-//                    std::cout<<"RS_Snapper::catchEntity(): enType= "<<enType<<std::endl;
 
-    // set default distance for points inside solids
-	RS_EntityContainer ec(nullptr,false);
-	//isContainer
-	bool isContainer{false};
-	switch(enType){
-	case RS2::EntityPolyline:
-	case RS2::EntityContainer:
-	case RS2::EntitySpline:
-		isContainer=true;
-		break;
-	default:
-		break;
-	}
-
-	for(RS_Entity* en= container->firstEntity(level);en;en=container->nextEntity(level)){
-        if(en->isVisible()==false) continue;
-		if(en->rtti() != enType && isContainer){
-            //whether this entity is a member of member of the type enType
-            RS_Entity* parent(en->getParent());
-			bool matchFound{false};
-			while(parent ) {
-//                    std::cout<<"RS_Snapper::catchEntity(): parent->rtti()="<<parent->rtti()<<" enType= "<<enType<<std::endl;
-                if(parent->rtti() == enType) {
-                    matchFound=true;
-                    ec.addEntity(en);
-                    break;
-                }
-                parent=parent->getParent();
-            }
-			if(!matchFound) continue;
+    if (enTypeList.empty())
+        return catchEntity(pos, level);
+
+    // whether an entity is of the type, or a member of member of the type, for container types
+    auto isOfType = [](const RS_Entity* en, RS2::EntityType enType) {
+        if (en->rtti() == enType)
+            return true;
+        switch(enType){
+        case RS2::EntityPolyline:
+        case RS2::EntityContainer:
+        case RS2::EntitySpline:
+            break;
+        default:
+            return false;
         }
-        if (en->rtti() == enType){
-            ec.addEntity(en);
+        for (const RS_Entity* parent = en->getParent(); parent != nullptr; parent = parent->getParent()) {
+            if (parent->rtti() == enType)
+                return true;
         }
-    }
-	if (ec.count() == 0 ) return nullptr;
-    double dist(0.);
+        return false;
+    };
+    auto filter = [&enTypeList, &isOfType](const RS_Entity* en) {
+        return std::any_of(enTypeList.cbegin(), enTypeList.cend(), [en, &isOfType](RS2::EntityType enType) {
+            return isOfType(en, enType);
+        });
+    };
 
-    RS_Entity* entity = ec.getNearestEntity(pos, &dist, RS2::ResolveNone);
+    // set default distance for points inside solids
+    double dist(0.);
+    const double catchDistance = getCatchDistance(getSnapRange(), catchEntityGuiRange, graphicView);
+    RS_Entity* entity = container->getNearestEntity(pos, catchDistance, &dist, level, filter);
 
     int idx = -1;
     if (entity != nullptr && entity->getParent()) {
         idx = entity->getParent()->findEntity(entity);
     }
 
-    if (entity != nullptr && dist <= getCatchDistance(getSnapRange(), catchEntityGuiRange, graphicView)) {
+    if (entity != nullptr && dist <= catchDistance) {
         // highlight:
         RS_DEBUG->print("RS_Snapper::catchEntity: found: %d", idx);
         return entity;
@@ -770,31 +953,7 @@ RS_Entity* RS_Snapper::catchEntity(QMouseEvent* e, RS2::EntityType enType,
 
 RS_Entity* RS_Snapper::catchEntity(QMouseEvent* e, const EntityTypeList& enTypeList,
                                    RS2::ResolveLevel level) {
-	RS_Entity* pten = nullptr;
-    RS_Vector coord = graphicView->toGraph(e->position());
-    switch(enTypeList.size()) {
-    case 0:
-        return catchEntity(coord, level);
-    default:
-    {
-
-		RS_EntityContainer ec(nullptr,false);
-		for( auto t0: enTypeList){
-			RS_Entity* en=catchEntity(coord, t0, level);
-			if(en) ec.addEntity(en);
-//			if(en) {
-//            std::cout<<__FILE__<<" : "<<__func__<<" : lines "<<__LINE__<<std::endl;
-//            std::cout<<"caught id= "<<en->getId()<<std::endl;
-//            }
-        }
-        if(ec.count()>0){
-            ec.getDistanceToPoint(coord, &pten, RS2::ResolveNone);
-            return pten;
-        }
-    }
-
-    }
-	return nullptr;
+    return catchEntity(graphicView->toGraph(e->position()), enTypeList, level);
 }
 
 void RS_Snapper::suspend() {
@@ -824,7 +983,7 @@ void RS_Snapper::showOptions() {
 void RS_Snapper::deleteSnapper()
 {
     graphicView->getOverlayContainer(RS2::Snapper)->clear();
-    graphicView->redraw(RS2::RedrawOverlay); // redraw will happen in the mouse movement event
+    graphicView->redraw(RS2::RedrawSnapper); // redraw will happen in the mouse movement event
 }
 
 
@@ -1021,7 +1180,7 @@ void RS_Snapper::drawSnapper()
                 container->addEntity(line);
             }
         }
-        graphicView->redraw(RS2::RedrawOverlay); // redraw will happen in the mouse movement event
+        graphicView->redraw(RS2::RedrawSnapper); // redraw will happen in the mouse movement event
     }
 }
 
@@ -183,6 +183,9 @@ public:
                            RS2::ResolveLevel level=RS2::ResolveNone);
     RS_Entity* catchEntity(QMouseEvent* e, RS2::EntityType enType,
                            RS2::ResolveLevel level=RS2::ResolveNone);
+    // catch Entity closest to pos and of any entity type in enTypeList
+    RS_Entity* catchEntity(const RS_Vector& pos, const EntityTypeList& enTypeList,
+                           RS2::ResolveLevel level=RS2::ResolveNone);
 	RS_Entity* catchEntity(QMouseEvent* e, const EntityTypeList& enTypeList,
                            RS2::ResolveLevel level=RS2::ResolveNone);
 
@@ -30,10 +30,12 @@
 #include <QFileInfo>
 
 #include "lc_hyperbola.h"
+#include "lc_librarycache.h"
 #include "lc_parabola.h"
 #include "lc_quadratic.h"
 #include "lc_splinepoints.h"
 #include "lc_undosection.h"
+#include "lc_xrefcache.h"
 #include "rs_arc.h"
 #include "rs_block.h"
 #include "rs_circle.h"
@@ -926,21 +928,24 @@ RS_Insert* RS_Creation::createLibraryInsert(RS_LibraryInsertData& data) {
 
     RS_DEBUG->print("RS_Creation::createLibraryInsert");
 
-    RS_Graphic g;
-    if (!g.open(data.file, RS2::FormatUnknown)) {
+    if (data.xref)
+        return createXrefInsert(data);
+
+    // parsed once, shared by all inserts of the file
+    std::shared_ptr<RS_Graphic> g = LC_LibraryCache::instance().get(data.file);
+    if (g == nullptr) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Creation::createLibraryInsert: Cannot open file: %s", data.file.toStdString().c_str());
         return nullptr;
     }
 
-    // unit conversion:
+    // unit conversion, by the insert scale: the cached drawing is not modified
+    double factor = data.factor;
     if (graphic) {
-        double uf = RS_Units::convert(1.0, g.getUnit(),
-                                      graphic->getUnit());
-        g.scale(RS_Vector(0.0, 0.0), RS_Vector(uf, uf));
+        factor *= RS_Units::convert(1.0, g->getUnit(),
+                                    graphic->getUnit());
     }
 
-    //g.scale(RS_Vector(data.factor, data.factor));
     //g.rotate(data.angle);
 
     QString s;
@@ -950,15 +955,45 @@ RS_Insert* RS_Creation::createLibraryInsert(RS_LibraryInsertData& data) {
     m.paste(
                 RS_PasteData(
                     data.insertionPoint,
-                    data.factor, data.angle, true,
+                    factor, data.angle, true,
                     s),
-                &g);
+                g.get());
 
     RS_DEBUG->print("RS_Creation::createLibraryInsert: OK");
 
     return nullptr;
 }
 
+/**
+ * Creates an insert of an external reference block of the library file.
+ * The entities are shared with the other references of the file.
+ */
+RS_Insert* RS_Creation::createXrefInsert(const RS_LibraryInsertData& data) {
+    if (graphic == nullptr)
+        return nullptr;
+
+    std::shared_ptr<LC_Xref> xref = LC_XrefCache::instance()->get(data.file);
+    if (xref->getGraphic() == nullptr) {
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "RS_Creation::createXrefInsert: Cannot open file: %s", data.file.toStdString().c_str());
+        return nullptr;
+    }
+
+    QFileInfo fi(data.file);
+    auto* blk = new RS_Block(graphic,
+                             RS_BlockData(graphic->getBlockList()->newName(fi.completeBaseName()),
+                                          RS_Vector(0.0, 0.0), false));
+    blk->setXrefFile(fi.absoluteFilePath());
+    graphic->addBlock(blk);
+
+    // unit conversion:
+    const double factor = data.factor * RS_Units::convert(1.0, xref->getGraphic()->getUnit(),
+                                                          graphic->getUnit());
+    const RS_InsertData d(blk->getName(), data.insertionPoint, RS_Vector(factor, factor),
+                          data.angle, 1, 1, RS_Vector(0.0, 0.0));
+    return createInsert(&d);
+}
+
 void RS_Creation::setEntity(RS_Entity* en) const
 {
     en->setLayerToActive();
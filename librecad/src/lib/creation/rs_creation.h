@@ -57,6 +57,8 @@ struct RS_LibraryInsertData {
     RS_Vector insertionPoint;
     double factor = 0.;
     double angle = 0.;
+    //! insert an external reference of the file instead of copies of its entities
+    bool xref = false;
 };
 
 
@@ -153,6 +155,7 @@ protected:
     RS_GraphicView* graphicView = nullptr;
     bool handleUndo = false;
 private:
+    RS_Insert* createXrefInsert(const RS_LibraryInsertData& data);
     void setEntity(RS_Entity* en) const;
 };
 
@@ -0,0 +1,165 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <mutex>
+#include <vector>
+
+#include "lc_regenstatistics.h"
+#include "rs_debug.h"
+
+namespace {
+struct Statistics {
+    std::mutex mutex;
+    LC_RegenStatistics::Snapshot snapshot;
+    const bool logging = qEnvironmentVariableIsSet("LIBRECAD_LOG_REGEN");
+};
+
+Statistics& getStatistics()
+{
+    static Statistics statistics;
+    return statistics;
+}
+
+// the reasons of the thread, and their key, rebuilt when the reasons change
+struct ThreadReasons {
+    std::vector<const char*> reasons;
+    QString key = "other";
+    std::array<int, LC_RegenStatistics::KindCount> depths{};
+
+    void updateKey()
+    {
+        if (reasons.empty()) {
+            key = "other";
+            return;
+        }
+        // recursive reasons, like updateInserts() of sub-containers, are shown once
+        key = reasons.front();
+        for (size_t i = 1; i < reasons.size(); ++i) {
+            if (reasons[i] != reasons[i - 1])
+                key.append(" > ").append(reasons[i]);
+        }
+    }
+};
+
+ThreadReasons& getThreadReasons()
+{
+    thread_local ThreadReasons reasons;
+    return reasons;
+}
+}
+
+LC_RegenStatistics::Snapshot LC_RegenStatistics::Snapshot::operator - (const Snapshot& earlier) const
+{
+    const auto subtract = [](const Counters& later, const Counters& earlier) {
+        Counters difference;
+        for (size_t i = 0; i < later.size(); ++i)
+            difference[i] = {later[i].count - earlier[i].count, later[i].ms - earlier[i].ms};
+        return difference;
+    };
+    Snapshot difference;
+    difference.kinds = subtract(kinds, earlier.kinds);
+    for (const auto& [reason, counters]: reasons) {
+        const auto it = earlier.reasons.find(reason);
+        const Counters changed = (it == earlier.reasons.cend()) ? counters : subtract(counters, it->second);
+        for (const Counter& counter: changed) {
+            if (counter.count != 0) {
+                difference.reasons[reason] = changed;
+                break;
+            }
+        }
+    }
+    return difference;
+}
+
+bool LC_RegenStatistics::Snapshot::isEmpty() const
+{
+    for (const Counter& counter: kinds) {
+        if (counter.count != 0)
+            return false;
+    }
+    return true;
+}
+
+LC_RegenStatistics::Regen::Regen(Kind kind):
+    m_kind{kind}
+{
+    m_outermost = getThreadReasons().depths[kind]++ == 0;
+    if (m_outermost)
+        m_start = std::chrono::steady_clock::now();
+}
+
+LC_RegenStatistics::Regen::~Regen()
+{
+    ThreadReasons& reasons = getThreadReasons();
+    --reasons.depths[m_kind];
+    const double ms = m_outermost
+            ? std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count()
+            : 0.;
+
+    Statistics& statistics = getStatistics();
+    {
+        std::lock_guard<std::mutex> lock(statistics.mutex);
+        Counter& kind = statistics.snapshot.kinds[m_kind];
+        ++kind.count;
+        kind.ms += ms;
+        Counter& reason = statistics.snapshot.reasons[reasons.key][m_kind];
+        ++reason.count;
+        reason.ms += ms;
+    }
+    if (statistics.logging && m_outermost)
+        RS_Debug::Log(RS_Debug::D_WARNING) << "regenerated" << getKindName(m_kind)
+                                           << "in" << ms << "ms, reason:" << reasons.key;
+}
+
+LC_RegenStatistics::Reason::Reason(const char* reason)
+{
+    ThreadReasons& reasons = getThreadReasons();
+    reasons.reasons.push_back(reason);
+    reasons.updateKey();
+}
+
+LC_RegenStatistics::Reason::~Reason()
+{
+    ThreadReasons& reasons = getThreadReasons();
+    reasons.reasons.pop_back();
+    reasons.updateKey();
+}
+
+LC_RegenStatistics::Snapshot LC_RegenStatistics::getSnapshot()
+{
+    Statistics& statistics = getStatistics();
+    std::lock_guard<std::mutex> lock(statistics.mutex);
+    return statistics.snapshot;
+}
+
+const char* LC_RegenStatistics::getKindName(Kind kind)
+{
+    switch (kind) {
+    case Hatch: return "hatch";
+    case Insert: return "insert";
+    case Text: return "text";
+    case Dimension: return "dimension";
+    default: return "unknown";
+    }
+}
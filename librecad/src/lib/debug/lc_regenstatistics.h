@@ -0,0 +1,111 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_REGENSTATISTICS_H
+#define LC_REGENSTATISTICS_H
+
+#include <array>
+#include <chrono>
+#include <map>
+
+#include <QString>
+
+#define LC_REGEN_CONCAT_(a, b) a##b
+#define LC_REGEN_CONCAT(a, b) LC_REGEN_CONCAT_(a, b)
+
+// the reason of regenerations until the end of the scope
+// Example: LC_REGEN_REASON("undo");
+#define LC_REGEN_REASON(reason) \
+    const LC_RegenStatistics::Reason LC_REGEN_CONCAT(lcRegenReason, __LINE__){reason}
+
+/**
+ * @brief The LC_RegenStatistics class, counters and times of the regenerations of
+ * hatches, inserts, texts and dimensions, by the reasons active when they are
+ * regenerated. Reasons are nested, e.g. "undo > update inserts", regenerations
+ * without a reason are counted as "other".
+ * Nested regenerations of the same kind, like inserts of inserts, are counted, but
+ * only the outermost one is timed.
+ * With the environment variable LIBRECAD_LOG_REGEN set, outermost regenerations are
+ * logged with their reasons.
+ */
+class LC_RegenStatistics {
+public:
+    enum Kind {
+        Hatch,
+        Insert,
+        Text,
+        Dimension,
+        KindCount
+    };
+
+    struct Counter {
+        unsigned long count = 0;
+        double ms = 0.;
+    };
+    using Counters = std::array<Counter, KindCount>;
+
+    struct Snapshot {
+        Counters kinds{};
+        std::map<QString, Counters> reasons;
+
+        //! the regenerations since the earlier snapshot
+        Snapshot operator - (const Snapshot& earlier) const;
+        bool isEmpty() const;
+    };
+
+    /**
+     * @brief The Regen class, a regeneration of an entity, counted and timed at the
+     * end of the scope
+     */
+    class Regen {
+    public:
+        explicit Regen(Kind kind);
+        ~Regen();
+        Regen(const Regen&) = delete;
+        Regen& operator = (const Regen&) = delete;
+
+    private:
+        const Kind m_kind;
+        bool m_outermost = false;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    /**
+     * @brief The Reason class, the reason of regenerations in its scope. Reasons are
+     * string literals, they are not copied
+     */
+    class Reason {
+    public:
+        explicit Reason(const char* reason);
+        ~Reason();
+        Reason(const Reason&) = delete;
+        Reason& operator = (const Reason&) = delete;
+    };
+
+    //! @return the regenerations since the start
+    static Snapshot getSnapshot();
+    static const char* getKindName(Kind kind);
+};
+
+#endif // LC_REGENSTATISTICS_H
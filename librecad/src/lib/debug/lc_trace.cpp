@@ -0,0 +1,178 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "lc_trace.h"
+#include "rs_debug.h"
+
+std::atomic<bool> LC_Trace::s_enabled{false};
+
+namespace {
+struct Event {
+    const char* name = nullptr;
+    const char* argName = nullptr;
+    qint64 number = 0;
+    QString text;
+    qint64 start = 0;
+    qint64 duration = 0;
+};
+
+// the zones traced by a thread. Buffers are kept after their threads end, and
+// locked only by their threads, unless the trace is written
+struct Buffer {
+    // long traces keep the first events, about 100 MB per thread
+    static constexpr size_t maxEvents = 1 << 20;
+
+    std::mutex mutex;
+    std::vector<Event> events;
+    size_t dropped = 0;
+    int tid = 0;
+};
+
+struct Session {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    QString fileName;
+};
+
+Session& getSession()
+{
+    static Session session;
+    return session;
+}
+
+qint64 now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - getSession().startTime).count();
+}
+
+Buffer& getBuffer()
+{
+    thread_local std::shared_ptr<Buffer> buffer = []() {
+        auto created = std::make_shared<Buffer>();
+        Session& session = getSession();
+        std::lock_guard<std::mutex> lock{session.mutex};
+        created->tid = int(session.buffers.size()) + 1;
+        session.buffers.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+}
+
+void LC_Trace::Zone::begin(const char* name, const char* argName)
+{
+    m_name = name;
+    m_argName = argName;
+    m_start = now();
+}
+
+void LC_Trace::Zone::end()
+{
+    const qint64 duration = now() - m_start;
+    Buffer& buffer = getBuffer();
+    std::lock_guard<std::mutex> lock{buffer.mutex};
+    if (buffer.events.size() >= Buffer::maxEvents) {
+        ++buffer.dropped;
+        return;
+    }
+    buffer.events.push_back({m_name, m_argName, m_number, m_text, m_start, duration});
+}
+
+void LC_Trace::start(const QString& fileName)
+{
+    Session& session = getSession();
+    {
+        std::lock_guard<std::mutex> lock{session.mutex};
+        for (const auto& buffer: session.buffers) {
+            std::lock_guard<std::mutex> bufferLock{buffer->mutex};
+            buffer->events.clear();
+            buffer->dropped = 0;
+        }
+        session.fileName = fileName;
+        session.startTime = std::chrono::steady_clock::now();
+    }
+    s_enabled.store(true, std::memory_order_relaxed);
+}
+
+bool LC_Trace::finish()
+{
+    if (!isEnabled())
+        return true;
+    s_enabled.store(false, std::memory_order_relaxed);
+
+    Session& session = getSession();
+    std::lock_guard<std::mutex> lock{session.mutex};
+    QJsonArray events;
+    size_t dropped = 0;
+    for (const auto& buffer: session.buffers) {
+        std::lock_guard<std::mutex> bufferLock{buffer->mutex};
+        dropped += buffer->dropped;
+        for (const Event& event: buffer->events) {
+            QJsonObject object;
+            object["name"] = event.name;
+            object["ph"] = "X";
+            object["ts"] = event.start * 1e-3;
+            object["dur"] = event.duration * 1e-3;
+            object["pid"] = qint64(QCoreApplication::applicationPid());
+            object["tid"] = buffer->tid;
+            if (event.argName != nullptr) {
+                QJsonObject args;
+                if (event.text.isNull())
+                    args[event.argName] = event.number;
+                else
+                    args[event.argName] = event.text;
+                object["args"] = args;
+            }
+            events.append(object);
+        }
+        buffer->events.clear();
+    }
+    if (dropped > 0)
+        LC_ERR << "LC_Trace::finish(): " << qint64(dropped) << " zones dropped, the trace buffers were full";
+
+    QJsonObject trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = "ms";
+    const QByteArray json = QJsonDocument(trace).toJson(QJsonDocument::Compact);
+    QFile file{session.fileName};
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+        LC_ERR << "LC_Trace::finish(): can't write " << session.fileName;
+        return false;
+    }
+    return true;
+}
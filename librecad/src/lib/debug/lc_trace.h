@@ -0,0 +1,116 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_TRACE_H
+#define LC_TRACE_H
+
+#include <atomic>
+
+#include <QString>
+
+#define LC_TRACE_CONCAT_(a, b) a##b
+#define LC_TRACE_CONCAT(a, b) LC_TRACE_CONCAT_(a, b)
+
+// a zone traced until the end of the scope, with an optional argument
+// Example: LC_TRACE_ZONE("undo");
+//          LC_TRACE_ZONE("open", "file", fileName);
+#define LC_TRACE_ZONE(...) \
+    const LC_Trace::Zone LC_TRACE_CONCAT(lcTraceZone, __LINE__){__VA_ARGS__}
+
+/**
+ * @brief The LC_Trace class, traces of named zones of the code, collected while
+ * tracing is started, and written in the Chrome trace format, viewed by
+ * chrome://tracing or ui.perfetto.dev.
+ * Zones are recorded to buffers of their threads. While tracing is stopped, a zone
+ * costs a relaxed atomic load.
+ */
+class LC_Trace {
+public:
+    /**
+     * @brief The Zone class, traces its scope. Names and argument names are string
+     * literals, they are not copied
+     */
+    class Zone {
+    public:
+        explicit Zone(const char* name)
+        {
+            if (isEnabled())
+                begin(name, nullptr);
+        }
+        Zone(const char* name, const char* argName, qint64 arg)
+        {
+            if (isEnabled()) {
+                m_number = arg;
+                begin(name, argName);
+            }
+        }
+        Zone(const char* name, const char* argName, const QString& arg)
+        {
+            if (isEnabled()) {
+                m_text = arg;
+                begin(name, argName);
+            }
+        }
+        ~Zone()
+        {
+            if (m_start >= 0)
+                end();
+        }
+        Zone(const Zone&) = delete;
+        Zone& operator = (const Zone&) = delete;
+
+    private:
+        void begin(const char* name, const char* argName);
+        void end();
+
+        const char* m_name = nullptr;
+        const char* m_argName = nullptr;
+        qint64 m_number = 0;
+        QString m_text;
+        //! ns since tracing started, negative if not traced
+        qint64 m_start = -1;
+    };
+
+    static bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief start starts tracing, zones traced before are discarded
+     * @param fileName the file written by finish()
+     */
+    static void start(const QString& fileName);
+    /**
+     * @brief finish stops tracing, and writes the trace to the file given to start()
+     * @return false, if the trace can't be written
+     */
+    static bool finish();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+#endif // LC_TRACE_H
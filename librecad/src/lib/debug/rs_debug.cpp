@@ -27,6 +27,7 @@
 #include <cstdarg>
 #include <cstdio>
 #include <iostream>
+#include <string>
 
 #include <QDateTime>
 #include <QIODevice>
@@ -34,6 +35,33 @@
 
 #include "rs_debug.h"
 
+namespace {
+/**
+ * Writes the message with its line end at once, so the messages of concurrent
+ * threads don't interleave.
+ */
+void printLine(FILE* stream, const char* format, va_list ap)
+{
+    char buffer[1024];
+    va_list copy;
+    va_copy(copy, ap);
+    const int size = std::vsnprintf(buffer, sizeof(buffer), format, copy);
+    va_end(copy);
+    if (size < 0)
+        return;
+    if (std::size_t(size) + 1 < sizeof(buffer)) {
+        buffer[size] = '\n';
+        std::fwrite(buffer, 1, std::size_t(size) + 1, stream);
+    } else {
+        std::string text(std::size_t(size) + 1, '\0');
+        std::vsnprintf(&text[0], text.size(), format, ap);
+        text.back() = '\n';
+        std::fwrite(text.data(), 1, text.size(), stream);
+    }
+    std::fflush(stream);
+}
+}
+
 void debugHeader(char const* file, char const* func, int line)
 {
 	std::cout<<file<<" : "<<func<<" : line "<<line<<std::endl;
@@ -47,22 +75,12 @@ void debugHeader(char const* file, char const* func, int line)
  * singleton class
  */
 RS_Debug* RS_Debug::instance() {
-    static RS_Debug* uniqueInstance = nullptr;
-    if(uniqueInstance == nullptr) {
-        QDateTime now = QDateTime::currentDateTime();
-        QString nowStr;
-		nowStr = now.toString("yyyyMMdd_hhmmss");
-
-                //QString fName = QString("%1/debug_%2.log")
-		//	.arg(RS_SYSTEM->getHomeDir())
-		//	.arg(nowStr);
-                // QString fName = QString("debug_%1.log")
-            // .arg(nowStr);
-
-        uniqueInstance = new RS_Debug;
-        //uniqueInstance->stream = fopen(fName.latin1(), "wt");
-        uniqueInstance->stream = stderr;
-    }
+    // created once, also when first used by concurrent threads
+    static RS_Debug* uniqueInstance = []() {
+        auto* debug = new RS_Debug;
+        debug->stream = stderr;
+        return debug;
+    }();
     return uniqueInstance;
 }
 
@@ -75,8 +93,9 @@ RS_Debug::RS_Debug() {
 }
 
 RS_Debug::~RS_Debug() {
-    if (stream != nullptr and stream != stderr)
-        fclose(stream);
+    FILE* s = stream;
+    if (s != nullptr and s != stderr)
+        fclose(s);
 }
 
 /**
@@ -110,10 +129,8 @@ void RS_Debug::print(const char* format ...) {
     if(debugLevel==D_DEBUGGING) {
         va_list ap;
         va_start(ap, format);
-        vfprintf(stream, format, ap);
-        fprintf(stream, "\n");
+        printLine(stream, format, ap);
         va_end(ap);
-        fflush(stream);
     }
 
 }
@@ -129,10 +146,8 @@ void RS_Debug::print(RS_DebugLevel level, const char* format ...) {
     if(debugLevel>=level) {
         va_list ap;
         va_start(ap, format);
-        vfprintf(stream, format, ap);
-        fprintf(stream, "\n");
+        printLine(stream, format, ap);
         va_end(ap);
-        fflush(stream);
     }
 
 }
@@ -143,12 +158,11 @@ void RS_Debug::print(RS_DebugLevel level, const char* format ...) {
  */
 void RS_Debug::timestamp() {
     QDateTime now = QDateTime::currentDateTime();
-    QString nowStr;
-
-	nowStr = now.toString("yyyyMMdd_hh:mm:ss:zzz ");
-    fprintf(stream, "%s", nowStr.toLatin1().data());
-    fprintf(stream, "\n");
-    fflush(stream);
+    QByteArray line = now.toString("yyyyMMdd_hh:mm:ss:zzz \n").toLatin1();
+    // at once, as printLine()
+    FILE* s = stream;
+    std::fwrite(line.constData(), 1, std::size_t(line.size()), s);
+    std::fflush(s);
 }
 
 
@@ -156,6 +170,8 @@ void RS_Debug::timestamp() {
  * Prints the unicode for every character in the given string.
  */
 void RS_Debug::printUnicode(const QString& text) {
+    if (debugLevel != D_DEBUGGING)
+        return;
 	for(auto const& v: text){
 		print("[%X] %c", v.unicode(), v.toLatin1());
     }
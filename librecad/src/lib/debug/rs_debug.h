@@ -28,6 +28,9 @@
 #ifndef RS_DEBUG_H
 #define RS_DEBUG_H
 
+#include <atomic>
+#include <cstdio>
+
 #include <QString>
 #include <QTextStream>
 #ifdef __hpux
@@ -49,6 +52,20 @@ void debugHeader(char const* file, char const* func, int line);
 #define LC_LOG RS_Debug::Log()
 #define LC_ERR RS_Debug::Log(RS_Debug::D_ERROR)
 
+// printf style logging, the arguments are evaluated only if the level is enabled
+// Example: RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "font: %s", name.toLatin1().data());
+#define RS_DEBUG_PRINT(level, ...) \
+    do { \
+        if (RS_Debug::isCompiled(level) && RS_DEBUG->isEnabled(level)) \
+            RS_DEBUG->print(level, __VA_ARGS__); \
+    } while (false)
+
+// the most verbose level compiled in: RS_DEBUG_PRINT() calls of more verbose levels
+// are removed by the compiler. Builds may define it, e.g. to RS_Debug::D_WARNING
+#ifndef LC_DEBUG_LEVEL_MAX
+#define LC_DEBUG_LEVEL_MAX RS_Debug::D_DEBUGGING
+#endif
+
 /**
  * Debugging facilities.
  *
@@ -115,6 +132,14 @@ public:
 
     void setLevel(RS_DebugLevel level);
     RS_DebugLevel getLevel();
+    //! whether messages of the level are printed
+    bool isEnabled(RS_DebugLevel level) const {
+        return debugLevel >= level;
+    }
+    //! whether messages of the level are compiled in, see LC_DEBUG_LEVEL_MAX
+    static constexpr bool isCompiled(RS_DebugLevel level) {
+        return level <= LC_DEBUG_LEVEL_MAX;
+    }
     void print(RS_DebugLevel level, const char* format ...);
     void print(const char* format ...);
     void print(const QString& text);
@@ -125,8 +150,9 @@ public:
     }
 
 private:
-    RS_DebugLevel debugLevel = D_INFORMATIONAL;
-    FILE* stream = nullptr;
+    // read by every print, also from worker threads
+    std::atomic<RS_DebugLevel> debugLevel{D_INFORMATIONAL};
+    std::atomic<FILE*> stream{nullptr};
 };
 
 #endif
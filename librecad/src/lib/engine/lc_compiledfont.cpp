@@ -0,0 +1,296 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "lc_compiledfont.h"
+#include "rs_debug.h"
+
+namespace {
+// bumped when the layout of the cache files changes
+constexpr char fileMagic[8] = {'L', 'C', 'F', 'O', 'N', 'T', '0', '1'};
+constexpr quint32 byteOrderMark = 0x01020304;
+constexpr int hashSize = 20;
+
+struct FileHeader {
+    char magic[8];
+    quint32 byteOrder;
+    quint32 glyphCount;
+    char sourceHash[hashSize];
+    quint32 reserved;
+    //! \{ offsets in bytes from the start of the file
+    quint64 metricsOffset;
+    quint64 metricsSize;
+    quint64 tableOffset;
+    quint64 valuesOffset;
+    //! \}
+    quint64 valueCount;
+};
+
+quint64 alignValue(quint64 offset)
+{
+    return (offset + alignof(double) - 1) / alignof(double) * alignof(double);
+}
+
+// the cache file of a font file by its hash; empty, if there is no cache directory
+QString getCacheFile(const QByteArray& sourceHash)
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty())
+        return {};
+    return dir + "/fonts/" + QString::fromLatin1(sourceHash.toHex()) + ".lcf";
+}
+}
+
+//! a glyph in the table sorted by code points
+struct LC_CompiledFont::TableEntry {
+    quint32 code;
+    //! number of values of the glyph records
+    quint32 count;
+    //! index of the first value
+    quint64 offset;
+};
+
+bool LC_CompiledFont::Builder::beginGlyph(char16_t code)
+{
+    // empty glyphs are dropped, so they may be defined again
+    std::vector<double>& records = m_glyphs[code];
+    m_current = records.empty() ? &records : nullptr;
+    return m_current != nullptr;
+}
+
+void LC_CompiledFont::Builder::addRecord(RecordType type, const double* values, size_t count)
+{
+    if (m_current == nullptr)
+        return;
+    m_current->push_back(type);
+    m_current->push_back(double(count));
+    m_current->insert(m_current->end(), values, values + count);
+}
+
+void LC_CompiledFont::Builder::addLine(double x1, double y1, double x2, double y2)
+{
+    const double values[] = {x1, y1, x2, y2};
+    addRecord(Line, values, std::size(values));
+}
+
+void LC_CompiledFont::Builder::addArc(double cx, double cy, double radius,
+                                      double angle1, double angle2, bool reversed)
+{
+    const double values[] = {cx, cy, radius, angle1, angle2, reversed ? 1. : 0.};
+    addRecord(Arc, values, std::size(values));
+}
+
+void LC_CompiledFont::Builder::addPolyline(const std::vector<double>& vertices)
+{
+    addRecord(Polyline, vertices.data(), vertices.size());
+}
+
+void LC_CompiledFont::Builder::addReference(char16_t code)
+{
+    const double value = code;
+    addRecord(Reference, &value, 1);
+}
+
+QByteArray LC_CompiledFont::Builder::compile(const Metrics& metrics,
+                                             const QByteArray& sourceHash) const
+{
+    QByteArray metricsData;
+    {
+        QDataStream stream(&metricsData, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << metrics.letterSpacing << metrics.wordSpacing << metrics.lineSpacingFactor
+               << metrics.encoding << metrics.license << metrics.created
+               << metrics.names << metrics.authors;
+    }
+
+    std::vector<TableEntry> table;
+    std::vector<double> values;
+    for (const auto& [code, records]: m_glyphs) {
+        if (records.empty())
+            continue;
+        table.push_back({code, quint32(records.size()), quint64(values.size())});
+        values.insert(values.end(), records.cbegin(), records.cend());
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.byteOrder = byteOrderMark;
+    header.glyphCount = quint32(table.size());
+    std::memcpy(header.sourceHash, sourceHash.constData(), std::min<size_t>(hashSize, sourceHash.size()));
+    header.metricsOffset = sizeof(FileHeader);
+    header.metricsSize = metricsData.size();
+    header.tableOffset = alignValue(header.metricsOffset + header.metricsSize);
+    header.valuesOffset = alignValue(header.tableOffset + table.size() * sizeof(TableEntry));
+    header.valueCount = values.size();
+
+    QByteArray data(int(header.valuesOffset + values.size() * sizeof(double)), '\0');
+    char* p = data.data();
+    std::memcpy(p, &header, sizeof(header));
+    std::memcpy(p + header.metricsOffset, metricsData.constData(), metricsData.size());
+    std::memcpy(p + header.tableOffset, table.data(), table.size() * sizeof(TableEntry));
+    std::memcpy(p + header.valuesOffset, values.data(), values.size() * sizeof(double));
+    return data;
+}
+
+LC_CompiledFont::LC_CompiledFont() = default;
+
+LC_CompiledFont::~LC_CompiledFont() = default;
+
+bool LC_CompiledFont::loadCache(const QByteArray& sourceHash)
+{
+    const QString path = getCacheFile(sourceHash);
+    if (path.isEmpty())
+        return false;
+
+    m_file = std::make_unique<QFile>(path);
+    if (m_file->open(QIODevice::ReadOnly)) {
+        // the mapping is released with the file
+        const qint64 size = m_file->size();
+        const uchar* data = m_file->map(0, size);
+        if (data != nullptr && setData(data, size, sourceHash))
+            return true;
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_CompiledFont::loadCache: invalid cache file: %s",
+                        path.toLatin1().data());
+    }
+    m_file.reset();
+    return false;
+}
+
+bool LC_CompiledFont::setCompiled(QByteArray compiled, const QByteArray& sourceHash)
+{
+    m_file.reset();
+    m_compiled = std::move(compiled);
+    if (!setData(reinterpret_cast<const uchar*>(m_compiled.constData()), m_compiled.size(), sourceHash))
+        return false;
+
+    // the cache may be shared by instances: replaced on writing only
+    const QString path = getCacheFile(sourceHash);
+    if (path.isEmpty() || !QDir().mkpath(QFileInfo(path).path()))
+        return true;
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(m_compiled) != m_compiled.size() || !file.commit())
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_CompiledFont::setCompiled: cannot write cache file: %s",
+                        path.toLatin1().data());
+    return true;
+}
+
+bool LC_CompiledFont::setData(const uchar* data, qint64 size, const QByteArray& sourceHash)
+{
+    FileHeader header;
+    if (size < qint64(sizeof(header))
+            || reinterpret_cast<quintptr>(data) % alignof(double) != 0)
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+
+    const quint64 fileSize = quint64(size);
+    if (std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0
+            || header.byteOrder != byteOrderMark
+            || sourceHash.size() != hashSize
+            || std::memcmp(header.sourceHash, sourceHash.constData(), hashSize) != 0
+            || header.metricsOffset > fileSize || header.metricsSize > fileSize - header.metricsOffset
+            || header.tableOffset % alignof(TableEntry) != 0 || header.tableOffset > fileSize
+            || header.glyphCount > (fileSize - header.tableOffset) / sizeof(TableEntry)
+            || header.valuesOffset % alignof(double) != 0 || header.valuesOffset > fileSize
+            || header.valueCount > (fileSize - header.valuesOffset) / sizeof(double))
+        return false;
+
+    QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char*>(data) + header.metricsOffset,
+                                               int(header.metricsSize)));
+    stream.setVersion(QDataStream::Qt_5_0);
+    Metrics metrics;
+    stream >> metrics.letterSpacing >> metrics.wordSpacing >> metrics.lineSpacingFactor
+           >> metrics.encoding >> metrics.license >> metrics.created
+           >> metrics.names >> metrics.authors;
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    auto table = reinterpret_cast<const TableEntry*>(data + header.tableOffset);
+    const bool valid = std::all_of(table, table + header.glyphCount, [&header](const TableEntry& entry) {
+        return entry.offset <= header.valueCount && entry.count <= header.valueCount - entry.offset;
+    });
+    if (!valid)
+        return false;
+
+    m_metrics = std::move(metrics);
+    m_table = table;
+    m_glyphCount = header.glyphCount;
+    m_values = reinterpret_cast<const double*>(data + header.valuesOffset);
+    m_valueCount = header.valueCount;
+    return true;
+}
+
+const LC_CompiledFont::TableEntry* LC_CompiledFont::findEntry(char16_t code) const
+{
+    const TableEntry* end = m_table + m_glyphCount;
+    const TableEntry* it = std::lower_bound(m_table, end, code, [](const TableEntry& entry, char16_t c) {
+        return entry.code < c;
+    });
+    return (it != end && it->code == code) ? it : nullptr;
+}
+
+std::vector<char16_t> LC_CompiledFont::getCodes() const
+{
+    std::vector<char16_t> codes;
+    codes.reserve(m_glyphCount);
+    std::transform(m_table, m_table + m_glyphCount, std::back_inserter(codes),
+                   [](const TableEntry& entry) { return char16_t(entry.code); });
+    return codes;
+}
+
+bool LC_CompiledFont::hasGlyph(char16_t code) const
+{
+    return findEntry(code) != nullptr;
+}
+
+std::vector<LC_CompiledFont::Record> LC_CompiledFont::getGlyph(char16_t code) const
+{
+    std::vector<Record> records;
+    const TableEntry* entry = findEntry(code);
+    if (entry == nullptr)
+        return records;
+
+    const double* values = m_values + entry->offset;
+    const double* end = values + entry->count;
+    while (end - values >= 2) {
+        Record record;
+        record.type = RecordType(int(values[0]));
+        record.count = size_t(values[1]);
+        record.values = values + 2;
+        if (record.count > size_t(end - record.values))
+            break;
+        records.push_back(record);
+        values = record.values + record.count;
+    }
+    return records;
+}
@@ -0,0 +1,135 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_COMPILEDFONT_H
+#define LC_COMPILEDFONT_H
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class QFile;
+
+/**
+ * @brief The LC_CompiledFont class, the glyph geometry of a text font file compiled to
+ * flat arrays: for each code point a list of lines, arcs, polylines and references to
+ * other glyphs, and the font metrics.
+ *
+ * Fonts are compiled once and cached in binary files in the user cache directory,
+ * named by the hash of the font file. Cached fonts are memory mapped, so glyphs are
+ * read only for the letters used. Cache files are in the native byte order.
+ */
+class LC_CompiledFont {
+public:
+    enum RecordType {
+        Line,      //!< x1, y1, x2, y2
+        Arc,       //!< center x, y, radius, start and end angles in radians, reversed
+        Polyline,  //!< x, y, bulge of each vertex
+        Reference  //!< the code point of the glyph included
+    };
+
+    /** a primitive of a glyph, values point into the compiled arrays */
+    struct Record {
+        RecordType type = Line;
+        const double* values = nullptr;
+        size_t count = 0;
+    };
+
+    struct Metrics {
+        double letterSpacing = 3.0;
+        double wordSpacing = 6.75;
+        double lineSpacingFactor = 1.0;
+        QString encoding;
+        QString license = "unknown";
+        QString created;
+        QStringList names;
+        QStringList authors;
+    };
+
+    /** collects the glyphs parsed from a font file */
+    class Builder {
+    public:
+        /** @return false, if the font has the glyph already; the later is ignored */
+        bool beginGlyph(char16_t code);
+        void addLine(double x1, double y1, double x2, double y2);
+        void addArc(double cx, double cy, double radius, double angle1, double angle2, bool reversed);
+        /** @param vertices x, y, bulge of each vertex */
+        void addPolyline(const std::vector<double>& vertices);
+        void addReference(char16_t code);
+
+        /** @return the compiled font, as stored in cache files */
+        QByteArray compile(const Metrics& metrics, const QByteArray& sourceHash) const;
+
+    private:
+        void addRecord(RecordType type, const double* values, size_t count);
+
+        // records of each glyph: type, count, values
+        std::map<char16_t, std::vector<double>> m_glyphs;
+        std::vector<double>* m_current = nullptr;
+    };
+
+    LC_CompiledFont();
+    ~LC_CompiledFont();
+
+    /**
+     * @brief loadCache map the cached compilation of a font file
+     * @param sourceHash the SHA-1 of the font file
+     * @return false, if there is no valid cache file
+     */
+    bool loadCache(const QByteArray& sourceHash);
+    /** uses a compiled font, which is saved to the cache directory */
+    bool setCompiled(QByteArray compiled, const QByteArray& sourceHash);
+
+    const Metrics& getMetrics() const {
+        return m_metrics;
+    }
+
+    /** @return the code points of all glyphs */
+    std::vector<char16_t> getCodes() const;
+    bool hasGlyph(char16_t code) const;
+    /** @return the records of a glyph, empty if the font doesn't have the glyph */
+    std::vector<Record> getGlyph(char16_t code) const;
+
+private:
+    struct TableEntry;
+    bool setData(const uchar* data, qint64 size, const QByteArray& sourceHash);
+    const TableEntry* findEntry(char16_t code) const;
+
+    Metrics m_metrics;
+    // compiled in this session
+    QByteArray m_compiled;
+    // or the mapped cache file
+    std::unique_ptr<QFile> m_file;
+
+    const TableEntry* m_table = nullptr;
+    size_t m_glyphCount = 0;
+    const double* m_values = nullptr;
+    size_t m_valueCount = 0;
+};
+
+#endif // LC_COMPILEDFONT_H
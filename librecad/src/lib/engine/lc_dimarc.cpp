@@ -26,6 +26,7 @@
 #include <cmath>
 #include <iostream>
 
+#include "lc_regenstatistics.h"
 #include "rs_arc.h"
 #include "rs_debug.h"
 #include "rs_graphic.h"
@@ -162,6 +163,7 @@ void LC_DimArc::arrow( const RS_Vector& point,
 void LC_DimArc::updateDim(bool autoText /* = false */)
 {
     Q_UNUSED (autoText)
+    const LC_RegenStatistics::Regen regen{LC_RegenStatistics::Dimension};
 
     RS_DEBUG->print("LC_DimArc::update");
 
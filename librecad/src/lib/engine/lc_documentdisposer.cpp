@@ -0,0 +1,103 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "lc_documentdisposer.h"
+#include "rs_debug.h"
+#include "rs_document.h"
+
+namespace {
+struct Disposer {
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this]() { return !documents.empty(); });
+            RS_Document* document = documents.front();
+            documents.pop_front();
+            destroying = true;
+            lock.unlock();
+            delete document;
+            lock.lock();
+            destroying = false;
+            idle.notify_all();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    //! notified when a document is destroyed
+    std::condition_variable idle;
+    std::deque<RS_Document*> documents;
+    //! whether the thread is destroying a document
+    bool destroying = false;
+    bool started = false;
+    bool abandoned = false;
+};
+
+// never destroyed, the thread may run while the application exits
+Disposer& disposer()
+{
+    static Disposer* instance = new Disposer;
+    return *instance;
+}
+}
+
+void LC_DocumentDisposer::dispose(RS_Document* document)
+{
+    if (document == nullptr)
+        return;
+    Disposer& instance = disposer();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    if (instance.abandoned)
+        return;
+    if (!instance.started) {
+        RS_DEBUG->print("LC_DocumentDisposer: starting the thread");
+        std::thread([&instance]() { instance.run(); }).detach();
+        instance.started = true;
+    }
+    instance.documents.push_back(document);
+    instance.wake.notify_one();
+}
+
+bool LC_DocumentDisposer::abandon(std::chrono::milliseconds wait)
+{
+    Disposer& instance = disposer();
+    std::unique_lock<std::mutex> lock(instance.mutex);
+    RS_DEBUG->print("LC_DocumentDisposer: %d document(s) left to the process exit",
+                    static_cast<int>(instance.documents.size()));
+    instance.abandoned = true;
+    instance.documents.clear();
+    // the entity destructors use the pool, fonts and settings, which are destroyed
+    // after main() returns
+    if (instance.idle.wait_for(lock, wait, [&instance]() { return !instance.destroying; }))
+        return true;
+    RS_DEBUG->print(RS_Debug::D_WARNING,
+                    "LC_DocumentDisposer: a document is still being destroyed");
+    return false;
+}
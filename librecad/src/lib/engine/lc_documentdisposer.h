@@ -0,0 +1,61 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_DOCUMENTDISPOSER_H
+#define LC_DOCUMENTDISPOSER_H
+
+#include <chrono>
+
+class RS_Document;
+
+/**
+ * @brief The LC_DocumentDisposer class, destroys closed documents by a background
+ * thread. Large drawings are millions of entities, undo cycles and undone entities,
+ * their destruction would block the GUI thread for seconds after the window is closed.
+ *
+ * Documents are destroyed one by one, in the order they are queued. The thread is
+ * started with the first document. At application exit the documents still queued
+ * are dropped, their memory is released with the process, and the document being
+ * destroyed is waited for. Destructors run for all entities, as they own strings and
+ * vectors besides their pool memory; the pool chunks of the document's arena are
+ * released at once with its last entity.
+ */
+class LC_DocumentDisposer {
+public:
+    /**
+     * @brief dispose queues the document for destruction. The document must be
+     * detached from views, widgets and listeners, nothing may access it afterwards
+     */
+    static void dispose(RS_Document* document);
+    /**
+     * @brief abandon drops the queued documents, called at application exit.
+     * Documents queued afterwards are dropped too
+     * @param wait the longest wait for the document being destroyed
+     * @return false, if the document is still being destroyed after the wait: the
+     * process must end without static destruction, see std::_Exit()
+     */
+    static bool abandon(std::chrono::milliseconds wait);
+};
+
+#endif // LC_DOCUMENTDISPOSER_H
@@ -0,0 +1,185 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include "lc_documentsnapshot.h"
+
+#include "rs_block.h"
+#include "rs_debug.h"
+#include "rs_entitycontainer.h"
+#include "rs_fileio.h"
+#include "rs_graphic.h"
+#include "rs_layer.h"
+
+LC_DocumentSnapshot::Fingerprint::Fingerprint(const RS_Entity& entity):
+    id{entity.getId()}
+    , visible{entity.getFlag(RS2::FlagVisible)}
+    , minV{entity.getMin()}
+    , maxV{entity.getMax()}
+    , pen{entity.getPenHandle()}
+    , layer{entity.getLayer(false)}
+{}
+
+bool LC_DocumentSnapshot::Fingerprint::operator == (const Fingerprint& other) const
+{
+    return id == other.id && visible == other.visible
+            && minV == other.minV && maxV == other.maxV
+            && pen == other.pen && layer == other.layer;
+}
+
+/**
+ * Takes a snapshot of the graphic, sharing the copies of the blocks and entities of
+ * the previous snapshot when they are still up to date.
+ */
+LC_DocumentSnapshot::LC_DocumentSnapshot(RS_Graphic& graphic, const LC_DocumentSnapshot* previous):
+    m_version{graphic.getSnapshotVersion()}
+    , m_graphic{std::make_unique<RS_Graphic>()}
+{
+    // the copies are owned by the snapshots sharing them
+    m_graphic->setOwner(false);
+    m_graphic->setSpatialIndexEnabled(false);
+    m_graphic->setVariableDictObject(graphic.getVariableDictObject());
+    m_graphic->setCrosshairType(graphic.getCrosshairType());
+    m_graphic->setMargins(graphic.getMarginLeft(), graphic.getMarginTop(),
+                          graphic.getMarginRight(), graphic.getMarginBottom());
+    m_graphic->setPagesNum(graphic.getPagesNumHoriz(), graphic.getPagesNumVert());
+
+    if (previous != nullptr)
+        m_layers = previous->m_layers;
+    for (RS_Layer* layer: *graphic.getLayerList())
+        m_graphic->addLayer(copyLayer(*layer).get());
+    if (graphic.getActiveLayer() != nullptr)
+        m_graphic->activateLayer(copyLayer(*graphic.getActiveLayer()).get());
+
+    for (RS_Block* block: *graphic.getBlockList())
+        copyBlock(*block, previous);
+
+    for (RS_Entity* entity: graphic) {
+        if (!entity->getFlag(RS2::FlagUndone))
+            copyEntity(*entity, previous);
+    }
+
+    RS_DEBUG->print("LC_DocumentSnapshot: %u blocks and entities copied, %zu shared",
+                    m_copied, m_blocks.size() + m_entities.size() - m_copied);
+}
+
+LC_DocumentSnapshot::~LC_DocumentSnapshot() = default;
+
+RS_Graphic& LC_DocumentSnapshot::getGraphic() const
+{
+    return *m_graphic;
+}
+
+const RS_Entity* LC_DocumentSnapshot::getCopy(const RS_Entity* entity) const
+{
+    const auto it = m_entities.find(entity);
+    return it != m_entities.end() ? it->second.copy.get() : nullptr;
+}
+
+void LC_DocumentSnapshot::enableSpatialIndex() const
+{
+    std::call_once(m_indexed, [this]() {
+        m_graphic->setSpatialIndexEnabled(true);
+    });
+}
+
+bool LC_DocumentSnapshot::saveAs(const QString& fileName, RS2::FormatType type) const
+{
+    return RS_FileIO::instance()->fileExport(*m_graphic, fileName, type);
+}
+
+/**
+ * @return the copy of the layer, updated to the current layer attributes
+ */
+std::shared_ptr<RS_Layer> LC_DocumentSnapshot::copyLayer(const RS_Layer& layer)
+{
+    std::shared_ptr<RS_Layer>& copy = m_layers[&layer];
+    if (copy == nullptr)
+        copy.reset(layer.clone());
+    else
+        *copy = layer;
+    return copy;
+}
+
+void LC_DocumentSnapshot::copyBlock(RS_Block& block, const LC_DocumentSnapshot* previous)
+{
+    BlockCopy current;
+    current.name = block.getName();
+    current.basePoint = block.getBasePoint();
+    current.frozen = block.isFrozen();
+    current.entities.reserve(block.count());
+    for (RS_Entity* entity: block)
+        current.entities.emplace_back(entity, Fingerprint{*entity});
+
+    if (previous != nullptr) {
+        auto it = previous->m_blocks.find(&block);
+        if (it != previous->m_blocks.end()) {
+            const BlockCopy& old = it->second;
+            if (old.name == current.name && old.basePoint == current.basePoint
+                    && old.frozen == current.frozen && old.entities == current.entities)
+                current.copy = old.copy;
+        }
+    }
+    if (current.copy == nullptr) {
+        current.copy.reset(static_cast<RS_Block*>(block.clone()));
+        relinkLayers(*current.copy);
+        ++m_copied;
+    }
+    current.copy->reparent(m_graphic.get());
+    m_graphic->addBlock(current.copy.get(), false);
+    m_blocks.emplace(&block, std::move(current));
+}
+
+void LC_DocumentSnapshot::copyEntity(RS_Entity& entity, const LC_DocumentSnapshot* previous)
+{
+    EntityCopy current{Fingerprint{entity}, {}};
+    if (previous != nullptr) {
+        auto it = previous->m_entities.find(&entity);
+        if (it != previous->m_entities.end() && it->second.fingerprint == current.fingerprint)
+            current.copy = it->second.copy;
+    }
+    if (current.copy == nullptr) {
+        current.copy.reset(entity.clone());
+        relinkLayers(*current.copy);
+        ++m_copied;
+    }
+    current.copy->reparent(m_graphic.get());
+    m_graphic->appendEntity(current.copy.get());
+    m_entities.emplace(&entity, std::move(current));
+}
+
+/**
+ * Points the copy and its sub-entities to the copies of their layers. Entities
+ * not created yet by flat polylines or instanced inserts are left so, they take
+ * their layers from the relinked container or block when created.
+ */
+void LC_DocumentSnapshot::relinkLayers(RS_Entity& copy) const
+{
+    if (RS_Layer* layer = copy.getLayer(false)) {
+        auto it = m_layers.find(layer);
+        copy.setLayer(it != m_layers.end() ? it->second.get() : nullptr);
+    }
+    if (copy.isContainer()) {
+        for (RS_Entity* entity: static_cast<const RS_EntityContainer&>(copy).getCreatedEntities())
+            relinkLayers(*entity);
+    }
+}
@@ -0,0 +1,138 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_DOCUMENTSNAPSHOT_H
+#define LC_DOCUMENTSNAPSHOT_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <QString>
+
+#include "lc_pentable.h"
+#include "rs.h"
+#include "rs_vector.h"
+
+class RS_Block;
+class RS_Entity;
+class RS_Graphic;
+class RS_Layer;
+
+/**
+ * @brief The LC_DocumentSnapshot class, a copy of the layers, blocks and entities of
+ * a graphic, taken to save the graphic in background while it's edited.
+ *
+ * The snapshot is taken by the thread owning the graphic, it's then independent of
+ * the graphic and can be saved by another thread. Copies of the blocks and entities
+ * which didn't change since the previous snapshot are shared with it, instead of
+ * copied again; as shared copies are relinked to the new snapshot, the previous
+ * snapshot must not be in use anymore.
+ *
+ * Background readers get their snapshots by RS_Graphic::snapshot(), which returns
+ * the same snapshot while the graphic doesn't change, and shares copies with the
+ * previous snapshot only after its readers released it. Snapshots are read only.
+ */
+class LC_DocumentSnapshot {
+public:
+    explicit LC_DocumentSnapshot(RS_Graphic& graphic, const LC_DocumentSnapshot* previous = nullptr);
+    ~LC_DocumentSnapshot();
+
+    /** @return the copy of the graphic */
+    RS_Graphic& getGraphic() const;
+
+    /** @return the version of the graphic the snapshot was taken of, see RS_Graphic::getSnapshotVersion() */
+    unsigned long getVersion() const {
+        return m_version;
+    }
+
+    /** @return true while readers hold the snapshot returned by RS_Graphic::snapshot() */
+    bool isInUse() const {
+        return m_readers.load(std::memory_order_acquire) > 0;
+    }
+
+    /** @return the copy of an entity of the graphic, nullptr if it wasn't copied */
+    const RS_Entity* getCopy(const RS_Entity* entity) const;
+
+    /** enables the spatial index of the copy once, for readers picking entities */
+    void enableSpatialIndex() const;
+
+    /** saves the snapshot, see RS_FileIO::fileExport() */
+    bool saveAs(const QString& fileName, RS2::FormatType type) const;
+
+    /** @return the number of blocks and entities copied, not shared with the previous snapshot */
+    unsigned getCopiedCount() const {
+        return m_copied;
+    }
+
+private:
+    /** the state of an entity compared to tell whether its copy is still up to date */
+    struct Fingerprint {
+        unsigned long id = 0;
+        bool visible = false;
+        RS_Vector minV;
+        RS_Vector maxV;
+        LC_PenTable::Handle pen = LC_PenTable::defaultHandle;
+        const RS_Layer* layer = nullptr;
+
+        explicit Fingerprint(const RS_Entity& entity);
+        bool operator == (const Fingerprint& other) const;
+    };
+
+    struct EntityCopy {
+        Fingerprint fingerprint;
+        std::shared_ptr<RS_Entity> copy;
+    };
+
+    struct BlockCopy {
+        QString name;
+        RS_Vector basePoint;
+        bool frozen = false;
+        std::vector<std::pair<const RS_Entity*, Fingerprint>> entities;
+        std::shared_ptr<RS_Block> copy;
+    };
+
+    friend class RS_Graphic;
+
+    std::shared_ptr<RS_Layer> copyLayer(const RS_Layer& layer);
+    void copyBlock(RS_Block& block, const LC_DocumentSnapshot* previous);
+    void copyEntity(RS_Entity& entity, const LC_DocumentSnapshot* previous);
+    void relinkLayers(RS_Entity& copy) const;
+
+    // copies of all the layers seen, so shared entity copies never refer to a deleted layer
+    std::unordered_map<const RS_Layer*, std::shared_ptr<RS_Layer>> m_layers;
+    std::unordered_map<const RS_Block*, BlockCopy> m_blocks;
+    std::unordered_map<const RS_Entity*, EntityCopy> m_entities;
+    unsigned m_copied = 0;
+    unsigned long m_version = 0;
+    // readers of the snapshots returned by RS_Graphic::snapshot()
+    mutable std::atomic<int> m_readers {0};
+    mutable std::once_flag m_indexed;
+    // doesn't own the copies, so it's destroyed first
+    std::unique_ptr<RS_Graphic> m_graphic;
+};
+
+#endif // LC_DOCUMENTSNAPSHOT_H
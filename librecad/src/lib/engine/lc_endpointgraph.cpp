@@ -0,0 +1,189 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lc_endpointgraph.h"
+#include "rs_entity.h"
+#include "rs_entitycontainer.h"
+#include "rs_vector.h"
+
+namespace {
+struct CellHash {
+    std::size_t operator()(const std::pair<std::int64_t, std::int64_t>& cell) const
+    {
+        return std::hash<std::int64_t>{}(cell.first) * 1000003u ^ std::hash<std::int64_t>{}(cell.second);
+    }
+};
+
+struct Vertex {
+    RS_Vector point;
+    // the incident edges
+    std::vector<std::size_t> edges;
+    // incident edges before the cursor are taken
+    std::size_t cursor = 0;
+};
+
+struct Edge {
+    RS_Entity* entity = nullptr;
+    RS_Vector start;
+    RS_Vector end;
+    std::size_t startVertex = 0;
+    std::size_t endVertex = 0;
+    bool taken = false;
+};
+}
+
+struct LC_EndpointGraph::Data {
+    explicit Data(double tolerance):
+        tolerance{tolerance}
+    {}
+
+    std::int64_t cellOf(double coordinate) const
+    {
+        // far away cells are merged, instead of overflowing
+        constexpr double limit = double(std::int64_t{1} << 62);
+        return std::int64_t(std::clamp(std::floor(coordinate / tolerance), -limit, limit));
+    }
+
+    // the vertex nearest to the point within the tolerance, or vertices.size()
+    std::size_t findVertex(const RS_Vector& point) const
+    {
+        std::size_t found = vertices.size();
+        double dist = tolerance;
+        const std::int64_t cx = cellOf(point.x);
+        const std::int64_t cy = cellOf(point.y);
+        for (std::int64_t x = cx - 1; x <= cx + 1; ++x) {
+            for (std::int64_t y = cy - 1; y <= cy + 1; ++y) {
+                auto it = cells.find({x, y});
+                if (it == cells.end())
+                    continue;
+                for (std::size_t vertex: it->second) {
+                    const double d = vertices[vertex].point.distanceTo(point);
+                    if (d < dist) {
+                        dist = d;
+                        found = vertex;
+                    }
+                }
+            }
+        }
+        return found;
+    }
+
+    std::size_t addVertex(const RS_Vector& point)
+    {
+        std::size_t vertex = findVertex(point);
+        if (vertex == vertices.size()) {
+            vertices.push_back({point, {}, 0});
+            cells[{cellOf(point.x), cellOf(point.y)}].push_back(vertex);
+        }
+        return vertex;
+    }
+
+    const double tolerance;
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+    std::unordered_map<const RS_Entity*, std::size_t> edgeOf;
+    std::unordered_map<std::pair<std::int64_t, std::int64_t>, std::vector<std::size_t>, CellHash> cells;
+};
+
+LC_EndpointGraph::LC_EndpointGraph(double tolerance):
+    m_data{std::make_unique<Data>(tolerance)}
+{}
+
+LC_EndpointGraph::LC_EndpointGraph(const RS_EntityContainer& container, const Filter& filter,
+                                   double tolerance):
+    LC_EndpointGraph{tolerance}
+{
+    for (RS_Entity* entity: container) {
+        if (entity != nullptr && (!filter || filter(entity)))
+            insert(entity);
+    }
+}
+
+LC_EndpointGraph::~LC_EndpointGraph() = default;
+
+void LC_EndpointGraph::insert(RS_Entity* entity)
+{
+    if (entity == nullptr || m_data->edgeOf.count(entity) != 0)
+        return;
+    Edge edge{entity, entity->getStartpoint(), entity->getEndpoint()};
+    if (!edge.start.valid || !edge.end.valid)
+        return;
+    const std::size_t index = m_data->edges.size();
+    edge.startVertex = m_data->addVertex(edge.start);
+    edge.endVertex = m_data->addVertex(edge.end);
+    m_data->vertices[edge.startVertex].edges.push_back(index);
+    if (edge.endVertex != edge.startVertex)
+        m_data->vertices[edge.endVertex].edges.push_back(index);
+    m_data->edges.push_back(edge);
+    m_data->edgeOf.emplace(entity, index);
+}
+
+std::size_t LC_EndpointGraph::size() const
+{
+    return m_data->edges.size();
+}
+
+std::size_t LC_EndpointGraph::countVertices() const
+{
+    return m_data->vertices.size();
+}
+
+RS_Entity* LC_EndpointGraph::takeEdge(const RS_Vector& point, RS_Vector& next)
+{
+    if (!point.valid)
+        return nullptr;
+    const std::size_t vertexIndex = m_data->findVertex(point);
+    if (vertexIndex == m_data->vertices.size())
+        return nullptr;
+    // each incident edge is skipped once, so walking all edges is linear
+    Vertex& vertex = m_data->vertices[vertexIndex];
+    while (vertex.cursor < vertex.edges.size() && m_data->edges[vertex.edges[vertex.cursor]].taken)
+        ++vertex.cursor;
+    if (vertex.cursor == vertex.edges.size())
+        return nullptr;
+    Edge& edge = m_data->edges[vertex.edges[vertex.cursor++]];
+    edge.taken = true;
+    next = edge.startVertex == vertexIndex ? edge.end : edge.start;
+    return edge.entity;
+}
+
+void LC_EndpointGraph::take(const RS_Entity* entity)
+{
+    auto it = m_data->edgeOf.find(entity);
+    if (it != m_data->edgeOf.end())
+        m_data->edges[it->second].taken = true;
+}
+
+bool LC_EndpointGraph::isTaken(const RS_Entity* entity) const
+{
+    auto it = m_data->edgeOf.find(entity);
+    return it != m_data->edgeOf.end() && m_data->edges[it->second].taken;
+}
@@ -0,0 +1,96 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_ENDPOINTGRAPH_H
+#define LC_ENDPOINTGRAPH_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+class RS_Entity;
+class RS_EntityContainer;
+class RS_Vector;
+
+/**
+ * @brief The LC_EndpointGraph class, the connectivity of entities by their end points.
+ *
+ * End points closer than the tolerance are merged into vertices, hashed by grid cells
+ * of the tolerance, and each vertex links to the entities (edges) ending at it.
+ * The graph is built on demand by chain walking tools, such as contour selection and
+ * polyline joining, so following a chain visits the edges at the chain ends only, and
+ * walking a chain of n edges takes linear time, instead of a container scan per edge.
+ *
+ * A walk takes each edge once: takeEdge() doesn't return edges taken before.
+ */
+class LC_EndpointGraph {
+public:
+    /**
+     * @brief Filter whether an entity of the container is an edge of the graph
+     */
+    using Filter = std::function<bool(const RS_Entity* entity)>;
+
+    //! the gap tolerance of the chain walking tools
+    static constexpr double defaultTolerance = 1.0e-4;
+
+    explicit LC_EndpointGraph(double tolerance = defaultTolerance);
+    /**
+     * @brief LC_EndpointGraph build the graph of the entities of a container, not recursive
+     * @param container - the container
+     * @param filter - entities accepted by the filter are added as edges
+     * @param tolerance - end points within the tolerance are connected
+     */
+    LC_EndpointGraph(const RS_EntityContainer& container, const Filter& filter,
+                     double tolerance = defaultTolerance);
+    ~LC_EndpointGraph();
+
+    /**
+     * @brief insert add an edge between the start and end points of the entity.
+     * Entities without valid end points are ignored.
+     */
+    void insert(RS_Entity* entity);
+
+    //! the number of edges
+    std::size_t size() const;
+    //! the number of vertices, end points merged by the tolerance
+    std::size_t countVertices() const;
+
+    /**
+     * @brief takeEdge take an edge connected to the point, not taken before
+     * @param point - the end of the chain
+     * @param next - set to the other end point of the edge taken
+     * @return RS_Entity* - the edge, or nullptr, if all edges at the point are taken
+     */
+    RS_Entity* takeEdge(const RS_Vector& point, RS_Vector& next);
+
+    //! mark the edge of an entity taken, as the first edge of a chain
+    void take(const RS_Entity* entity);
+    bool isTaken(const RS_Entity* entity) const;
+
+private:
+    struct Data;
+    std::unique_ptr<Data> m_data;
+};
+
+#endif // LC_ENDPOINTGRAPH_H
@@ -0,0 +1,256 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "lc_entitypool.h"
+
+namespace {
+
+constexpr std::size_t granularity = alignof(std::max_align_t);
+constexpr std::size_t maxPooledSize = 1024;
+constexpr std::size_t sizeClasses = maxPooledSize / granularity;
+// chunks are aligned to their size, so the arena of an object is found from its address
+constexpr std::size_t chunkSize = 1 << 20;
+// shards of the free lists of an arena, the threads are spread over them
+constexpr std::size_t shardCount = 16;
+
+std::size_t sizeClass(std::size_t size)
+{
+    return (std::max<std::size_t>(size, 1) - 1) / granularity;
+}
+
+struct FreeNode {
+    FreeNode* next;
+};
+
+// the chunks of all arenas
+std::atomic<std::size_t> reservedChunks{0};
+// the arena of the calling thread, nullptr for the shared arena
+thread_local LC_EntityPool::Arena* currentArena = nullptr;
+
+std::size_t threadShard()
+{
+    static std::atomic<std::size_t> nextShard{0};
+    thread_local const std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % shardCount;
+    return shard;
+}
+}
+
+class LC_EntityPool::Arena {
+public:
+    ~Arena()
+    {
+        for (char* chunk: chunks)
+            ::operator delete(chunk, std::align_val_t{chunkSize});
+        reservedChunks.fetch_sub(chunks.size(), std::memory_order_relaxed);
+    }
+
+    void* allocate(std::size_t size)
+    {
+        const std::size_t index = sizeClass(size);
+        Shard& shard = shards[threadShard()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.released)
+            holds.fetch_add(1, std::memory_order_relaxed);
+        else
+            ++shard.live;
+        if (FreeNode* node = shard.freeLists[index]) {
+            shard.freeLists[index] = node->next;
+            return node;
+        }
+        const std::size_t bytes = (index + 1) * granularity;
+        if (shard.chunk == nullptr || shard.used + bytes > chunkSize) {
+            shard.chunk = newChunk();
+            shard.used = headerSize;
+        }
+        void* p = shard.chunk + shard.used;
+        shard.used += bytes;
+        return p;
+    }
+
+    void deallocate(void* p, std::size_t size)
+    {
+        const std::size_t index = sizeClass(size);
+        Shard& shard = shards[threadShard()];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (!shard.released) {
+                --shard.live;
+                shard.freeLists[index] = new(p) FreeNode{shard.freeLists[index]};
+                return;
+            }
+        }
+        // the document is closed, the chunks are released together with the last object
+        drop();
+    }
+
+    //! called by the owner, the objects hold the arena from now on
+    void release()
+    {
+        std::ptrdiff_t live = 0;
+        for (Shard& shard: shards)
+            shard.mutex.lock();
+        for (Shard& shard: shards) {
+            live += shard.live;
+            shard.freeLists.fill(nullptr);
+            shard.released = true;
+        }
+        holds.fetch_add(static_cast<std::size_t>(live), std::memory_order_relaxed);
+        for (Shard& shard: shards)
+            shard.mutex.unlock();
+        drop();
+    }
+
+    void hold()
+    {
+        holds.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void drop()
+    {
+        if (holds.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    //! the arena of an object
+    static Arena* of(void* p)
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(p) & ~std::uintptr_t(chunkSize - 1);
+        return reinterpret_cast<ChunkHeader*>(address)->arena;
+    }
+
+private:
+    struct ChunkHeader {
+        Arena* arena;
+    };
+    static constexpr std::size_t headerSize = granularity;
+    static_assert(sizeof(ChunkHeader) <= headerSize, "the objects must not overlap the chunk header");
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::array<FreeNode*, sizeClasses> freeLists{};
+        // the chunk objects are carved from
+        char* chunk = nullptr;
+        std::size_t used = 0;
+        // objects allocated minus objects freed by the threads of this shard
+        std::ptrdiff_t live = 0;
+        // set by release(), the objects hold the arena from then on
+        bool released = false;
+    };
+
+    char* newChunk()
+    {
+        char* chunk = static_cast<char*>(::operator new(chunkSize, std::align_val_t{chunkSize}));
+        new(chunk) ChunkHeader{this};
+        std::lock_guard<std::mutex> lock(chunksMutex);
+        chunks.push_back(chunk);
+        reservedChunks.fetch_add(1, std::memory_order_relaxed);
+        return chunk;
+    }
+
+    std::array<Shard, shardCount> shards;
+    std::mutex chunksMutex;
+    std::vector<char*> chunks;
+    // the owner and the threads using the arena; once released, the live objects too
+    std::atomic<std::size_t> holds{1};
+};
+
+namespace {
+// never destroyed, entities may outlive static destruction
+LC_EntityPool::Arena& sharedArena()
+{
+    static auto* instance = new LC_EntityPool::Arena;
+    return *instance;
+}
+}
+
+LC_EntityPool::Arena* LC_EntityPool::createArena()
+{
+    return new Arena;
+}
+
+void LC_EntityPool::releaseArena(Arena* arena)
+{
+    if (arena != nullptr)
+        arena->release();
+}
+
+LC_EntityPool::Arena* LC_EntityPool::threadArena()
+{
+    return currentArena;
+}
+
+void LC_EntityPool::setThreadArena(Arena* arena)
+{
+    if (arena != nullptr)
+        arena->hold();
+    Arena* previous = currentArena;
+    currentArena = arena;
+    if (previous != nullptr)
+        previous->drop();
+}
+
+LC_EntityPool::Scope::Scope(Arena* arena):
+    m_previous{currentArena}
+{
+    if (m_previous != nullptr)
+        m_previous->hold();
+    setThreadArena(arena);
+}
+
+LC_EntityPool::Scope::~Scope()
+{
+    setThreadArena(m_previous);
+    if (m_previous != nullptr)
+        m_previous->drop();
+}
+
+void* LC_EntityPool::allocate(std::size_t size)
+{
+    if (size > maxPooledSize)
+        return ::operator new(size);
+    Arena* arena = currentArena != nullptr ? currentArena : &sharedArena();
+    return arena->allocate(size);
+}
+
+void LC_EntityPool::deallocate(void* p, std::size_t size)
+{
+    if (p == nullptr)
+        return;
+    if (size > maxPooledSize)
+        ::operator delete(p);
+    else
+        Arena::of(p)->deallocate(p, size);
+}
+
+std::size_t LC_EntityPool::reservedBytes()
+{
+    return reservedChunks.load(std::memory_order_relaxed) * chunkSize;
+}
@@ -0,0 +1,90 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_ENTITYPOOL_H
+#define LC_ENTITYPOOL_H
+
+#include <cstddef>
+
+/**
+ * @brief The LC_EntityPool class, a size-class pool allocator for entities.
+ *
+ * Drawings are made of millions of small entity objects of a few sizes, created in
+ * bursts by the import filters and by RS_Insert::update(). RS_Entity allocates its
+ * subclasses from this pool: objects are carved from large chunks, and freed objects
+ * are kept in per size free lists for reuse, so neither allocations nor deletions go
+ * through malloc.
+ *
+ * The chunks belong to arenas. Each RS_Graphic owns an arena, and the entities a
+ * thread creates come from the arena of the thread, see setThreadArena() and Scope;
+ * entities created outside of any document, e.g. font glyphs, come from a shared
+ * arena. Each arena has free lists per thread shard, so threads creating entities
+ * of the same drawing rarely contend. When the document is closed and its last
+ * entity is freed, the chunks of its arena are released at once, other documents
+ * and the fonts don't keep them.
+ *
+ * Objects larger than the largest size class are allocated by the global operator new.
+ */
+class LC_EntityPool {
+public:
+    class Arena;
+
+    //! creates an arena, owned by the caller until releaseArena()
+    static Arena* createArena();
+    /**
+     * @brief releaseArena drops the ownership of an arena. Its chunks are released
+     * when the last entity allocated from it is freed, which may be now
+     */
+    static void releaseArena(Arena* arena);
+
+    //! the arena of the entities created by the calling thread, nullptr for the shared arena
+    static Arena* threadArena();
+    //! sets the arena of the calling thread, the arena is kept until another one is set
+    static void setThreadArena(Arena* arena);
+
+    /**
+     * @brief The Scope class sets the arena of the calling thread for its lifetime
+     */
+    class Scope {
+    public:
+        explicit Scope(Arena* arena);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator = (const Scope&) = delete;
+
+    private:
+        Arena* m_previous;
+    };
+
+    static void* allocate(std::size_t size);
+    /**
+     * @brief deallocate return an object to the pool
+     * @param size - the size requested for the object by allocate()
+     */
+    static void deallocate(void* p, std::size_t size);
+
+    //! total size of the pool chunks of all arenas in bytes
+    static std::size_t reservedBytes();
+};
+
+#endif // LC_ENTITYPOOL_H
@@ -0,0 +1,447 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <algorithm>
+#include <charconv>
+#include <QIODevice>
+
+#include "lc_fontfile.h"
+#include "rs_debug.h"
+#include "rs_math.h"
+
+namespace {
+//size of the blocks written to the device
+constexpr qsizetype writeBlockSize = 1 << 16;
+
+//! lines of a font file, without line ends
+class LineReader {
+public:
+    explicit LineReader(const QByteArray& content):
+        m_text{content.constData(), static_cast<size_t>(content.size())}
+    {
+        // the byte order mark of UTF-8 files
+        if (m_text.substr(0, 3) == "\xEF\xBB\xBF")
+            m_pos = 3;
+    }
+
+    bool atEnd() const {
+        return m_pos >= m_text.size();
+    }
+
+    //! @return the next line, empty at the end of the content
+    std::string_view next() {
+        if (atEnd())
+            return {};
+        size_t end = m_text.find('\n', m_pos);
+        if (end == std::string_view::npos)
+            end = m_text.size();
+        std::string_view line = m_text.substr(m_pos, end - m_pos);
+        m_pos = end + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        return line;
+    }
+
+private:
+    std::string_view m_text;
+    size_t m_pos = 0;
+};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+std::string_view trimmed(std::string_view text) {
+    while (!text.empty() && isSpace(text.front()))
+        text.remove_prefix(1);
+    while (!text.empty() && isSpace(text.back()))
+        text.remove_suffix(1);
+    return text;
+}
+
+bool isHexDigit(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+bool equalsNoCase(std::string_view text, std::string_view lower) {
+    if (text.size() != lower.size())
+        return false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = (text[i] >= 'A' && text[i] <= 'Z') ? char(text[i] - 'A' + 'a') : text[i];
+        if (c != lower[i])
+            return false;
+    }
+    return true;
+}
+
+//same results as QString::toDouble(), 0 for invalid input
+double toDouble(std::string_view text) {
+    text = trimmed(text);
+    if (!text.empty() && '+' == text.front())
+        text.remove_prefix(1);
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    double value = 0.;
+    if (std::from_chars(text.data(), text.data() + text.size(), value).ec != std::errc())
+        return 0.;
+    return value;
+#else
+    //no floating point from_chars
+    return QByteArray::fromRawData(text.data(), static_cast<qsizetype>(text.size())).toDouble();
+#endif
+}
+
+//same results as QString::toInt(nullptr, 16), 0 for invalid input
+unsigned toHex(std::string_view text) {
+    text = trimmed(text);
+    unsigned value = 0;
+    if (std::from_chars(text.data(), text.data() + text.size(), value, 16).ec != std::errc())
+        return 0;
+    return value;
+}
+
+/**
+ * Finds the first run of at least minDigits hexadecimal digits in text, as the
+ * regular expression [0-9A-Fa-f]{minDigits,maxDigits}.
+ * @return false, if there is no such run
+ */
+bool findHex(std::string_view text, size_t minDigits, size_t maxDigits, unsigned& value) {
+    for (size_t i = 0; i < text.size();) {
+        size_t length = 0;
+        while (i + length < text.size() && isHexDigit(text[i + length]))
+            ++length;
+        if (length >= minDigits) {
+            value = toHex(text.substr(i, std::min(length, maxDigits)));
+            return true;
+        }
+        i += std::max<size_t>(length, 1);
+    }
+    return false;
+}
+
+/**
+ * Splits text by the separator, skipping empty parts. Up to maxParts parts
+ * are stored.
+ * @return the number of parts
+ */
+int splitParts(std::string_view text, char separator, std::string_view* parts, int maxParts) {
+    int count = 0;
+    while (!text.empty()) {
+        const size_t end = std::min(text.find(separator), text.size());
+        if (end > 0) {
+            if (count < maxParts)
+                parts[count] = text.substr(0, end);
+            ++count;
+        }
+        text.remove_prefix(std::min(end + 1, text.size()));
+    }
+    return count;
+}
+
+/**
+ * Parses a setting line of the header, as "# Name: value".
+ * @return false, if the line is a comment
+ */
+bool parseSetting(std::string_view line, std::string_view& identifier, std::string_view& value) {
+    std::string_view parts[2];
+    if (splitParts(line.substr(1), ':', parts, 2) < 2)
+        return false;
+    identifier = trimmed(parts[0]);
+    value = trimmed(parts[1]);
+    return true;
+}
+
+QString decode(QStringDecoder& decoder, std::string_view text) {
+    return decoder(QByteArrayView(text.data(), static_cast<qsizetype>(text.size())));
+}
+
+void setEncoding(QStringDecoder& decoder, std::string_view name) {
+    const auto encoding = QStringConverter::encodingForName(
+        QByteArray(name.data(), static_cast<qsizetype>(name.size())).constData());
+    if (encoding)
+        decoder = QStringDecoder(*encoding);
+    else
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING, "LC_FontFile: unknown encoding %s",
+                        QByteArray(name.data(), static_cast<qsizetype>(name.size())).constData());
+}
+
+/**
+ * Formats value with the fixed number of decimals.
+ * @return the length of the text, 0 if the text doesn't fit
+ */
+size_t formatFixed(char* text, size_t size, double value, int decimals) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    const auto result = std::to_chars(text, text + size, value, std::chars_format::fixed, decimals);
+    return result.ec == std::errc() ? static_cast<size_t>(result.ptr - text) : 0;
+#else
+    //no floating point to_chars
+    const QByteArray number = QByteArray::number(value, 'f', decimals);
+    if (static_cast<size_t>(number.size()) > size)
+        return 0;
+    std::copy(number.cbegin(), number.cend(), text);
+    return static_cast<size_t>(number.size());
+#endif
+}
+
+/**
+ * Reads the settings common to CXF and LFF files.
+ * @return false, if the identifier is not one of them
+ */
+bool readSetting(std::string_view identifier, std::string_view value, QStringDecoder& decoder,
+                 LC_CompiledFont::Metrics& metrics) {
+    if (equalsNoCase(identifier, "letterspacing")) {
+        metrics.letterSpacing = toDouble(value);
+    } else if (equalsNoCase(identifier, "wordspacing")) {
+        metrics.wordSpacing = toDouble(value);
+    } else if (equalsNoCase(identifier, "linespacingfactor")) {
+        metrics.lineSpacingFactor = toDouble(value);
+    } else if (equalsNoCase(identifier, "author")) {
+        metrics.authors.append(decode(decoder, value));
+    } else if (equalsNoCase(identifier, "name")) {
+        metrics.names.append(decode(decoder, value));
+    } else if (equalsNoCase(identifier, "encoding")) {
+        metrics.encoding = decode(decoder, value);
+        setEncoding(decoder, value);
+    } else {
+        return false;
+    }
+    return true;
+}
+}
+
+void LC_FontFile::readCXF(const QByteArray& content, LC_CompiledFont::Builder& builder,
+                          LC_CompiledFont::Metrics& metrics) {
+    QStringDecoder decoder{QStringConverter::Utf8};
+    LineReader reader{content};
+
+    // Read line by line until we find a new letter:
+    while (!reader.atEnd()) {
+        std::string_view line = reader.next();
+        if (line.empty())
+            continue;
+
+        // Read font settings:
+        if (line.front() == '#') {
+            std::string_view identifier, value;
+            if (parseSetting(line, identifier, value))
+                readSetting(identifier, value, decoder, metrics);
+        }
+
+        // Add another letter to this font:
+        else if (line.front() == '[') {
+            // read unicode:
+            unsigned code = 0;
+            if (!findHex(line, 4, 4, code)) {
+                const size_t close = line.find(']');
+                QString name;
+                // read UTF8 (LibreCAD 1 compatibility)
+                if (close != std::string_view::npos && close >= 3)
+                    name = QString::fromUtf8(line.data() + 1, static_cast<qsizetype>(close - 1));
+                // read a character in the encoding of the file:
+                else
+                    name = decode(decoder, line.substr(1));
+                code = name.isEmpty() ? 0 : name.at(0).unicode();
+            }
+
+            // new letter, duplicates are ignored:
+            builder.beginGlyph(char16_t(code));
+
+            // Read entities of this letter:
+            for (line = reader.next(); !line.empty(); line = reader.next()) {
+                std::string_view parts[5];
+                const int count = std::min(splitParts(line.substr(std::min<size_t>(2, line.size())), ',', parts, 5), 5);
+                double values[5] = {};
+                for (int i = 0; i < count; ++i)
+                    values[i] = toDouble(parts[i]);
+
+                // Line:
+                if (line.front() == 'L') {
+                    builder.addLine(values[0], values[1], values[2], values[3]);
+                }
+                // Arc:
+                else if (line.front() == 'A') {
+                    const bool reversed = line.size() > 1 && line[1] == 'R';
+                    builder.addArc(values[0], values[1], values[2],
+                                   RS_Math::deg2rad(values[3]), RS_Math::deg2rad(values[4]), reversed);
+                }
+            }
+        }
+    }
+}
+
+void LC_FontFile::readLFF(const QByteArray& content, LC_CompiledFont::Builder& builder,
+                          LC_CompiledFont::Metrics& metrics) {
+    QStringDecoder decoder{QStringConverter::Utf8};
+    metrics.encoding = "UTF-8";
+    LineReader reader{content};
+    std::vector<double> vertices;
+
+    // Read line by line until we find a new letter:
+    while (!reader.atEnd()) {
+        std::string_view line = reader.next();
+        if (line.empty())
+            continue;
+
+        // Read font settings:
+        if (line.front() == '#') {
+            std::string_view identifier, value;
+            //a comment, if not a setting
+            if (!parseSetting(line, identifier, value))
+                continue;
+            if (readSetting(identifier, value, decoder, metrics))
+                continue;
+            if (equalsNoCase(identifier, "license"))
+                metrics.license = decode(decoder, value);
+            else if (equalsNoCase(identifier, "created"))
+                metrics.created = decode(decoder, value);
+        }
+
+        // Add another letter to this font:
+        else if (line.front() == '[') {
+            // only unicode allowed
+            unsigned code = 0;
+            if (!findHex(line, 1, 5, code)) {
+                RS_DEBUG_PRINT(RS_Debug::D_WARNING, "Ignoring code from LFF font file: %s",
+                                QByteArray(line.data(), static_cast<qsizetype>(line.size())).constData());
+                continue;
+            }
+
+            // new letter, duplicates are ignored:
+            builder.beginGlyph(char16_t(code));
+
+            // Read entities of this letter:
+            for (line = reader.next(); !line.empty(); line = reader.next()) {
+                // Defined char, resolved when the letter is generated:
+                if (line.front() == 'C') {
+                    builder.addReference(char16_t(toHex(line.substr(1))));
+                    continue;
+                }
+
+                //sequence, at least two vertices are required
+                if (splitParts(line, ';', nullptr, 0) < 2)
+                    continue;
+                vertices.clear();
+                std::string_view rest = line;
+                while (!rest.empty()) {
+                    const size_t end = std::min(rest.find(';'), rest.size());
+                    const std::string_view point = rest.substr(0, end);
+                    rest.remove_prefix(std::min(end + 1, rest.size()));
+
+                    std::string_view coords[3];
+                    const int count = splitParts(point, ',', coords, 3);
+                    //at least X,Y is required
+                    if (count < 2)
+                        continue;
+                    //check presence of bulge
+                    double bulge = 0.;
+                    if (count == 3 && coords[2].front() == 'A')
+                        bulge = toDouble(coords[2].substr(1));
+                    vertices.push_back(toDouble(coords[0]));
+                    vertices.push_back(toDouble(coords[1]));
+                    vertices.push_back(bulge);
+                }
+                builder.addPolyline(vertices);
+            }
+        }
+    }
+}
+
+LC_FontFile::Writer::Writer(QIODevice* device):
+    m_device{device}
+{
+    m_buffer.reserve(writeBlockSize + 256);
+}
+
+LC_FontFile::Writer::~Writer() {
+    flush();
+}
+
+void LC_FontFile::Writer::setEncoding(const QString& name) {
+    const auto encoding = QStringConverter::encodingForName(name.toLatin1().constData());
+    m_encoder = QStringEncoder(encoding ? *encoding : QStringConverter::Utf8);
+}
+
+LC_FontFile::Writer& LC_FontFile::Writer::operator << (std::string_view text) {
+    m_buffer.append(text.data(), static_cast<qsizetype>(text.size()));
+    if (m_buffer.size() >= writeBlockSize)
+        flush();
+    return *this;
+}
+
+LC_FontFile::Writer& LC_FontFile::Writer::operator << (char c) {
+    m_buffer.append(c);
+    if (m_buffer.size() >= writeBlockSize)
+        flush();
+    return *this;
+}
+
+LC_FontFile::Writer& LC_FontFile::Writer::operator << (const QString& text) {
+    m_buffer.append(m_encoder.encode(text));
+    if (m_buffer.size() >= writeBlockSize)
+        flush();
+    return *this;
+}
+
+void LC_FontFile::Writer::writeFixed(double value, int decimals) {
+    char text[64];
+    const size_t length = formatFixed(text, sizeof(text), value, decimals);
+    if (length > 0) {
+        *this << std::string_view(text, length);
+        return;
+    }
+    // large values
+    const QByteArray number = QByteArray::number(value, 'f', decimals);
+    *this << std::string_view(number.constData(), static_cast<size_t>(number.size()));
+}
+
+void LC_FontFile::Writer::writeTrimmed(double value, int decimals) {
+    char text[64];
+    size_t length = formatFixed(text, sizeof(text), value, decimals);
+    if (length == 0 || std::string_view(text, length).find('.') == std::string_view::npos) {
+        writeFixed(value, decimals);
+        return;
+    }
+    // trailing zeros are removed, and the point if there are no decimals left
+    while (length > 2 && text[length - 1] == '0')
+        --length;
+    if (text[length - 1] == '.')
+        --length;
+    *this << std::string_view(text, length);
+}
+
+void LC_FontFile::Writer::writeHex(unsigned value, int digits) {
+    char text[16];
+    const auto result = std::to_chars(text, text + sizeof(text), value, 16);
+    for (auto length = result.ptr - text; length < digits; ++length)
+        *this << '0';
+    *this << std::string_view(text, static_cast<size_t>(result.ptr - text));
+}
+
+bool LC_FontFile::Writer::flush() {
+    if (!m_buffer.isEmpty()) {
+        m_good = m_device->write(m_buffer) == m_buffer.size() && m_good;
+        m_buffer.clear();
+    }
+    return m_good;
+}
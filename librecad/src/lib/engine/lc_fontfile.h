@@ -0,0 +1,86 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_FONTFILE_H
+#define LC_FONTFILE_H
+
+#include <string_view>
+
+#include <QByteArray>
+#include <QString>
+#include <QStringConverter>
+
+#include "lc_compiledfont.h"
+
+class QIODevice;
+
+/**
+ * @brief The LC_FontFile namespace, parsers and writers of CXF and LFF font files.
+ * The parsers work on the bytes of the file, without strings for each line or
+ * coordinate, and collect the glyphs in the representation of the font cache.
+ */
+namespace LC_FontFile {
+    void readCXF(const QByteArray& content, LC_CompiledFont::Builder& builder,
+                 LC_CompiledFont::Metrics& metrics);
+    void readLFF(const QByteArray& content, LC_CompiledFont::Builder& builder,
+                 LC_CompiledFont::Metrics& metrics);
+
+    /**
+     * @brief The Writer class, formats the lines of a font file in a buffer,
+     * written to the device in large blocks
+     */
+    class Writer {
+    public:
+        explicit Writer(QIODevice* device);
+        ~Writer();
+        Writer(const Writer&) = delete;
+        Writer& operator = (const Writer&) = delete;
+
+        //! sets the encoding of the texts, UTF-8 by default
+        void setEncoding(const QString& name);
+
+        Writer& operator << (std::string_view text);
+        Writer& operator << (char c);
+        //! appends the text in the encoding of the file
+        Writer& operator << (const QString& text);
+        //! appends the value with the fixed number of decimals
+        void writeFixed(double value, int decimals);
+        //! appends the value with up to the number of decimals, without trailing zeros
+        void writeTrimmed(double value, int decimals);
+        //! appends the value as hexadecimal number, with at least digits digits
+        void writeHex(unsigned value, int digits);
+
+        //! writes the pending data, @return false on write errors
+        bool flush();
+
+    private:
+        QIODevice* m_device = nullptr;
+        QByteArray m_buffer;
+        QStringEncoder m_encoder{QStringConverter::Utf8};
+        bool m_good = true;
+    };
+}
+
+#endif // LC_FONTFILE_H
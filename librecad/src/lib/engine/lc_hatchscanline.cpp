@@ -0,0 +1,343 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "lc_hatchscanline.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
+#include "rs_ellipse.h"
+#include "rs_entitycontainer.h"
+#include "rs_math.h"
+
+namespace {
+
+// scanlines closer than this share their crossings
+bool isSameScanline(double y0, double y1)
+{
+    return std::abs(y1 - y0) <= RS_TOLERANCE * std::max(1., std::abs(y0));
+}
+
+// a scanline slightly off the given one, to avoid passing exactly through contour vertices
+double nudge(double y)
+{
+    return y + 1e3 * RS_TOLERANCE * std::max(1., std::abs(y));
+}
+}
+
+double LC_HatchScanline::Edge::crossing(double y) const
+{
+    if (line)
+        return p1.x + (y - p1.y) * (p2.x - p1.x) / (p2.y - p1.y);
+
+    // y = center.y + amplitude * sin(t + phase), monotone within the interval k
+    const double s = std::clamp((y - center.y) / amplitude, -1., 1.);
+    const double u = k * M_PI + ((k % 2 == 0) ? std::asin(s) : - std::asin(s));
+    const double t = u - phase;
+    return center.x + a * std::cos(t) * cosPhi - b * std::sin(t) * sinPhi;
+}
+
+LC_HatchScanline::LC_HatchScanline(const std::vector<const RS_EntityContainer*>& loops, double angle,
+                                   FillRule rule):
+    m_direction{angle}
+  , m_rule{rule}
+{
+    for (const RS_EntityContainer* loop: loops) {
+        for (const RS_Entity* e: *loop) {
+            addEdge(*e);
+            if (!m_valid)
+                return;
+        }
+    }
+    std::sort(m_edges.begin(), m_edges.end(), [](const Edge& e0, const Edge& e1) {
+        return e0.ymin < e1.ymin;
+    });
+}
+
+RS_Vector LC_HatchScanline::toScan(const RS_Vector& point) const
+{
+    return {point.x * m_direction.x + point.y * m_direction.y,
+            point.y * m_direction.x - point.x * m_direction.y};
+}
+
+RS_Vector LC_HatchScanline::fromScan(const RS_Vector& point) const
+{
+    return {point.x * m_direction.x - point.y * m_direction.y,
+            point.x * m_direction.y + point.y * m_direction.x};
+}
+
+void LC_HatchScanline::addEdge(const RS_Entity& entity)
+{
+    switch (entity.rtti()) {
+    case RS2::EntityLine:
+        addLine(entity.getStartpoint(), entity.getEndpoint());
+        break;
+    case RS2::EntityArc: {
+        const auto& arc = static_cast<const RS_Arc&>(entity);
+        addConic(arc.getCenter(), arc.getRadius(), arc.getRadius(), 0.,
+                 arc.getAngle1(), arc.getAngle2(), arc.isReversed());
+        break;
+    }
+    case RS2::EntityCircle:
+        addConic(entity.getCenter(), entity.getRadius(), entity.getRadius(), 0., 0., 2. * M_PI, false);
+        break;
+    case RS2::EntityEllipse: {
+        const auto& ellipse = static_cast<const RS_Ellipse&>(entity);
+        const double a = ellipse.getMajorRadius();
+        if (ellipse.isEllipticArc())
+            addConic(ellipse.getCenter(), a, a * ellipse.getRatio(), ellipse.getAngle(),
+                     ellipse.getAngle1(), ellipse.getAngle2(), ellipse.isReversed());
+        else
+            addConic(ellipse.getCenter(), a, a * ellipse.getRatio(), ellipse.getAngle(), 0., 2. * M_PI, false);
+        break;
+    }
+    default:
+        m_valid = false;
+        break;
+    }
+}
+
+void LC_HatchScanline::addLine(const RS_Vector& start, const RS_Vector& end)
+{
+    Edge edge;
+    edge.p1 = toScan(start);
+    edge.p2 = toScan(end);
+    // edges along the scanlines are never crossed
+    if (std::abs(edge.p2.y - edge.p1.y) < RS_TOLERANCE)
+        return;
+    edge.ymin = std::min(edge.p1.y, edge.p2.y);
+    edge.ymax = std::max(edge.p1.y, edge.p2.y);
+    edge.winding = (edge.p2.y > edge.p1.y) ? 1 : -1;
+    m_edges.push_back(edge);
+}
+
+/**
+ * Adds a conic arc: center + R(axisAngle) * (a cos(t), b sin(t)), t from t1 to t2,
+ * counterclockwise unless reversed.
+ */
+void LC_HatchScanline::addConic(const RS_Vector& center, double a, double b, double axisAngle,
+                                double t1, double t2, bool reversed)
+{
+    Edge edge;
+    edge.line = false;
+    edge.center = toScan(center);
+    edge.a = a;
+    edge.b = b;
+    const double phi = axisAngle - m_direction.angle();
+    edge.cosPhi = std::cos(phi);
+    edge.sinPhi = std::sin(phi);
+    // y - center.y = a sin(phi) cos(t) + b cos(phi) sin(t) = amplitude * sin(t + phase)
+    edge.amplitude = std::hypot(a * edge.sinPhi, b * edge.cosPhi);
+    edge.phase = std::atan2(a * edge.sinPhi, b * edge.cosPhi);
+    if (edge.amplitude < RS_TOLERANCE)
+        return;
+
+    // the same points counterclockwise
+    const double start = reversed ? t2 : t1;
+    double sweep = RS_Math::correctAngle(reversed ? t1 - t2 : t2 - t1);
+    if (sweep < RS_TOLERANCE_ANGLE)
+        sweep = 2. * M_PI;
+    const int direction = reversed ? -1 : 1;
+
+    // Split into pieces monotone in y, at the extrema of sin(u), u = t + phase. The y of
+    // shared piece ends is computed once, so no scanline passes between adjacent pieces.
+    auto yAt = [&edge](double u) {
+        return edge.center.y + edge.amplitude * std::sin(u);
+    };
+    const double uStart = start + edge.phase;
+    const double uEnd = uStart + sweep;
+    const double yStart = yAt(uStart);
+    const double yEnd = (sweep == 2. * M_PI) ? yStart : yAt(uEnd);
+    double u = uStart;
+    double y0 = yStart;
+    int k = int(std::floor((uStart + M_PI_2) / M_PI));
+    while (u < uEnd - RS_TOLERANCE_ANGLE) {
+        const double extremum = k * M_PI + M_PI_2;
+        const bool last = uEnd <= extremum;
+        const double pieceEnd = last ? uEnd : extremum;
+        const double y1 = last ? yEnd : edge.center.y + ((k % 2 == 0) ? edge.amplitude : - edge.amplitude);
+        if (pieceEnd - u > RS_TOLERANCE_ANGLE) {
+            edge.ymin = std::min(y0, y1);
+            edge.ymax = std::max(y0, y1);
+            edge.k = k;
+            edge.winding = ((k % 2 == 0) ? 1 : -1) * direction;
+            if (edge.ymax - edge.ymin >= RS_TOLERANCE)
+                m_edges.push_back(edge);
+        }
+        u = pieceEnd;
+        y0 = y1;
+        ++k;
+    }
+}
+
+std::vector<LC_HatchScanline::Span> LC_HatchScanline::spans(double y) const
+{
+    std::vector<const Edge*> crossed;
+    for (const Edge& edge: m_edges) {
+        if (edge.ymin > y)
+            break;
+        if (y < edge.ymax)
+            crossed.push_back(&edge);
+    }
+    bool balanced = true;
+    std::vector<Span> ret = spans(crossed, y, balanced);
+    // the scanline passes through a gap of the contour
+    if (!balanced && !isSameScanline(y, nudge(y)))
+        return spans(nudge(y));
+    return ret;
+}
+
+std::vector<LC_HatchScanline::Span> LC_HatchScanline::spans(const std::vector<const Edge*>& crossed, double y,
+                                                            bool& balanced) const
+{
+    std::vector<std::pair<double, int>> crossings;
+    crossings.reserve(crossed.size());
+    for (const Edge* edge: crossed)
+        crossings.emplace_back(edge->crossing(y), edge->winding);
+    std::sort(crossings.begin(), crossings.end());
+
+    std::vector<Span> ret;
+    if (m_rule == FillRule::EvenOdd) {
+        for (size_t i = 1; i < crossings.size(); i += 2)
+            ret.emplace_back(crossings[i - 1].first, crossings[i].first);
+        balanced = crossings.size() % 2 == 0;
+    } else {
+        int winding = 0;
+        double spanStart = 0.;
+        for (const auto& [x, w]: crossings) {
+            const int previous = winding;
+            winding += w;
+            if (previous == 0 && winding != 0)
+                spanStart = x;
+            else if (previous != 0 && winding == 0)
+                ret.emplace_back(spanStart, x);
+        }
+        balanced = winding == 0;
+    }
+    return ret;
+}
+
+std::vector<LC_HatchScanline::Segment> LC_HatchScanline::trim(const std::vector<Segment>& segments) const
+{
+    struct Item {
+        double y;
+        double x1;
+        double x2;
+    };
+    std::vector<Item> items;
+    items.reserve(segments.size());
+    for (const auto& [start, end]: segments) {
+        const RS_Vector p1 = toScan(start);
+        const RS_Vector p2 = toScan(end);
+        items.push_back({0.5 * (p1.y + p2.y), p1.x, p2.x});
+    }
+    std::sort(items.begin(), items.end(), [](const Item& i0, const Item& i1) {
+        return i0.y < i1.y;
+    });
+
+    // sweep the scanlines upwards, the active edges are crossed by the current scanline
+    std::vector<Segment> ret;
+    std::vector<const Edge*> active;
+    std::vector<Span> current;
+    size_t next = 0;
+    bool first = true;
+    double currentY = 0.;
+    for (const Item& item: items) {
+        if (first || !isSameScanline(currentY, item.y)) {
+            first = false;
+            currentY = item.y;
+            for (; next < m_edges.size() && m_edges[next].ymin <= currentY; ++next)
+                active.push_back(&m_edges[next]);
+            active.erase(std::remove_if(active.begin(), active.end(), [currentY](const Edge* edge) {
+                             return edge->ymax <= currentY;
+                         }), active.end());
+            bool balanced = true;
+            current = spans(active, currentY, balanced);
+            if (!balanced)
+                current = spans(nudge(currentY));
+        }
+
+        const double lo = std::min(item.x1, item.x2);
+        const double hi = std::max(item.x1, item.x2);
+        auto it = std::upper_bound(current.cbegin(), current.cend(), lo, [](double x, const Span& span) {
+            return x < span.second;
+        });
+        for (; it != current.cend() && it->first <= hi; ++it) {
+            const double x1 = std::max(lo, it->first);
+            const double x2 = std::min(hi, it->second);
+            // dots are kept if they are inside
+            if (x2 - x1 < RS_TOLERANCE && hi - lo >= RS_TOLERANCE)
+                continue;
+            const RS_Vector start = fromScan({x1, item.y});
+            const RS_Vector end = fromScan({x2, item.y});
+            if (item.x1 <= item.x2)
+                ret.emplace_back(start, end);
+            else
+                ret.emplace_back(end, start);
+        }
+    }
+    return ret;
+}
+
+std::optional<std::vector<LC_HatchScanline::Segment>> LC_HatchScanline::trimLines(
+        const std::vector<const RS_EntityContainer*>& loops,
+        const std::vector<Segment>& segments,
+        FillRule rule)
+{
+    // group by directions in [0, pi), dots go to the first group
+    std::vector<std::pair<double, std::vector<Segment>>> groups;
+    std::vector<Segment> dots;
+    for (const Segment& segment: segments) {
+        if (segment.first.distanceTo(segment.second) < RS_TOLERANCE) {
+            dots.push_back(segment);
+            continue;
+        }
+        double angle = RS_Math::correctAngle(segment.first.angleTo(segment.second));
+        if (angle >= M_PI)
+            angle -= M_PI;
+        auto it = std::find_if(groups.begin(), groups.end(), [angle](const auto& group) {
+            const double d = std::abs(group.first - angle);
+            return std::min(d, M_PI - d) < RS_TOLERANCE_ANGLE;
+        });
+        if (it == groups.end()) {
+            groups.emplace_back(angle, std::vector<Segment>{});
+            it = std::prev(groups.end());
+        }
+        it->second.push_back(segment);
+    }
+    if (groups.empty())
+        groups.emplace_back(0., std::vector<Segment>{});
+    groups.front().second.insert(groups.front().second.end(), dots.cbegin(), dots.cend());
+
+    std::vector<Segment> ret;
+    for (const auto& [angle, group]: groups) {
+        LC_HatchScanline scanline{loops, angle, rule};
+        if (!scanline.isValid())
+            return std::nullopt;
+        std::vector<Segment> trimmed = scanline.trim(group);
+        ret.insert(ret.end(), trimmed.cbegin(), trimmed.cend());
+    }
+    return ret;
+}
@@ -0,0 +1,139 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_HATCHSCANLINE_H
+#define LC_HATCHSCANLINE_H
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "rs_vector.h"
+
+class RS_Entity;
+class RS_EntityContainer;
+
+/**
+ * @brief The LC_HatchScanline class, trims lines to the inside of hatch contours by scanlines.
+ *
+ * The contour edges are rotated into the scanline space, where scanlines are horizontal, and
+ * split into y-monotone pieces once. Lines parallel to the scanline direction are then trimmed
+ * by sweeping them in the order of their scanline offsets, so each scanline only visits the
+ * edges it crosses, and collinear lines share the crossings of their scanline. Crossings of
+ * arcs, circles and ellipses are exact.
+ *
+ * Supported contour edges are lines, arcs, circles and ellipses. isValid() is false, if a
+ * contour contains anything else.
+ */
+class LC_HatchScanline {
+public:
+    enum class FillRule {
+        EvenOdd,
+        //! requires consistently oriented loops
+        NonZero
+    };
+    using Segment = std::pair<RS_Vector, RS_Vector>;
+    //! an inside interval of a scanline, in scanline coordinates
+    using Span = std::pair<double, double>;
+
+    /**
+     * @param loops - the contour loops
+     * @param angle - the scanline direction
+     * @param rule - the fill rule
+     */
+    LC_HatchScanline(const std::vector<const RS_EntityContainer*>& loops, double angle,
+                     FillRule rule = FillRule::EvenOdd);
+
+    bool isValid() const {
+        return m_valid;
+    }
+
+    //! \{ conversion between the drawing and the scanline space
+    RS_Vector toScan(const RS_Vector& point) const;
+    RS_Vector fromScan(const RS_Vector& point) const;
+    //! \}
+
+    /**
+     * @brief spans the inside intervals of the scanline at the offset y in scanline space,
+     * sorted by x
+     */
+    std::vector<Span> spans(double y) const;
+
+    /**
+     * @brief trim the inside parts of segments parallel to the scanline direction. The
+     * trimmed parts keep the direction of their segments.
+     */
+    std::vector<Segment> trim(const std::vector<Segment>& segments) const;
+
+    /**
+     * @brief trimLines the inside parts of segments in any directions. Segments are
+     * grouped by directions, with one scanline engine for each direction.
+     * @return no value, if the contour has unsupported edges
+     */
+    static std::optional<std::vector<Segment>> trimLines(const std::vector<const RS_EntityContainer*>& loops,
+                                                         const std::vector<Segment>& segments,
+                                                         FillRule rule = FillRule::EvenOdd);
+
+private:
+    /**
+     * @brief The Edge struct, a y-monotone piece of a contour edge in scanline space.
+     * Arcs and circles are stored as conics with equal semi axes.
+     */
+    struct Edge {
+        double ymin = 0.;
+        double ymax = 0.;
+        //! +1, if y increases along the edge
+        int winding = 1;
+        bool line = true;
+        //! line endpoints
+        RS_Vector p1;
+        RS_Vector p2;
+        //! conic center, semi axes, axis direction and y amplitude and phase
+        RS_Vector center;
+        double a = 0.;
+        double b = 0.;
+        double cosPhi = 1.;
+        double sinPhi = 0.;
+        double amplitude = 0.;
+        double phase = 0.;
+        //! the piece is within [k*pi - pi/2, k*pi + pi/2] of the phase shifted parameter
+        int k = 0;
+
+        double crossing(double y) const;
+    };
+
+    void addEdge(const RS_Entity& entity);
+    void addLine(const RS_Vector& start, const RS_Vector& end);
+    void addConic(const RS_Vector& center, double a, double b, double axisAngle,
+                  double t1, double t2, bool reversed);
+    //! @param balanced - false, if the crossings don't close all spans
+    std::vector<Span> spans(const std::vector<const Edge*>& crossed, double y, bool& balanced) const;
+
+    RS_Vector m_direction;
+    FillRule m_rule = FillRule::EvenOdd;
+    bool m_valid = true;
+    //! sorted by ymin
+    std::vector<Edge> m_edges;
+};
+
+#endif // LC_HATCHSCANLINE_H
@@ -24,6 +24,14 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <cmath>
+
+#include <QBrush>
+#include <QPainterPath>
+#include <QPolygonF>
+#include <QTransform>
+
 #include "lc_hyperbola.h"
 
 #include "rs_debug.h"
@@ -31,9 +39,59 @@
 #include "rs_graphicview.h"
 #include "rs_information.h"
 #include "rs_linetypepattern.h"
+#include "rs_math.h"
 #include "rs_painter.h"
 #include "lc_quadratic.h"
 
+namespace {
+// maximum distance of the tessellation to the branch, in pixels
+constexpr double tessellationTolerance = 0.25;
+// least segments of a tessellation, bisected further by the tolerance
+constexpr int minTessellationSegments = 8;
+// limit of the bisection of a segment
+constexpr int maxTessellationDepth = 12;
+// the whole branch is sampled beyond the view by this parameter margin, for panning
+constexpr double branchRangeMargin = 0.5;
+
+bool isSameData(const LC_HyperbolaData& d0, const LC_HyperbolaData& d1) {
+    return d0.center.x == d1.center.x && d0.center.y == d1.center.y
+            && d0.majorP.x == d1.majorP.x && d0.majorP.y == d1.majorP.y
+            && d0.ratio == d1.ratio && d0.angle1 == d1.angle1 && d0.angle2 == d1.angle2;
+}
+
+// appends the samples of (t1, t2] of a convex curve to points, bisecting while the
+// middle point is farther than tolerance from the chord
+template <typename Curve>
+void appendSamples(QPolygonF& points, const Curve& curve, double t1, const RS_Vector& p1,
+                   double t2, const RS_Vector& p2, double tolerance, int depth) {
+    const double tm = 0.5 * (t1 + t2);
+    const RS_Vector pm = curve(tm);
+    const RS_Vector chord = p2 - p1;
+    const double length = chord.magnitude();
+    const double deviation = (length > RS_TOLERANCE)
+            ? std::abs((pm.x - p1.x) * chord.y - (pm.y - p1.y) * chord.x) / length
+            : pm.distanceTo(p1);
+    if (depth < maxTessellationDepth && deviation > tolerance) {
+        appendSamples(points, curve, t1, p1, tm, pm, tolerance, depth + 1);
+        appendSamples(points, curve, tm, pm, t2, p2, tolerance, depth + 1);
+        return;
+    }
+    points << QPointF{p2.x, p2.y};
+}
+}
+
+/**
+ * The samples of the branch drawn, with the data, tolerance in graph units and
+ * parameter range they are sampled for.
+ */
+struct LC_Hyperbola::Tessellation {
+    LC_HyperbolaData data;
+    double tolerance = 0.;
+    double t1 = 0.;
+    double t2 = 0.;
+    QPolygonF points;
+};
+
 LC_HyperbolaData::LC_HyperbolaData(const RS_Vector& _center,
 			   const RS_Vector& _majorP,
 			   double _ratio,
@@ -278,6 +336,172 @@ LC_Quadratic LC_Hyperbola::getQuadratic() const
     return ret;
 }
 
+RS_Vector LC_Hyperbola::getPoint(double t) const
+{
+    const RS_Vector minorP = RS_Vector{-data.majorP.y, data.majorP.x} * data.ratio;
+    return data.center + data.majorP * std::cosh(t) + minorP * std::sinh(t);
+}
+
+bool LC_Hyperbola::isArc() const
+{
+    return std::abs(data.angle2 - data.angle1) > RS_TOLERANCE_ANGLE;
+}
+
+/**
+ * The borders of the arc, or of the whole branch between the ends of its latus
+ * rectum, as the branch is unbounded.
+ */
+void LC_Hyperbola::calculateBorders()
+{
+    double t1 = std::min(data.angle1, data.angle2);
+    double t2 = std::max(data.angle1, data.angle2);
+    if (!isArc()) {
+        // cosh(t) = c/a at the foci
+        t2 = std::acosh(std::sqrt(1. + data.ratio * data.ratio));
+        t1 = -t2;
+    }
+    // the extremes of x and y within the range, where the derivatives are zero
+    const double a = getMajorRadius();
+    const double b = getMinorRadius();
+    const double cosA = std::cos(getAngle());
+    const double sinA = std::sin(getAngle());
+    std::vector<double> ts{t1, t2};
+    auto addExtreme = [&ts, t1, t2](double numerator, double denominator) {
+        if (std::abs(denominator) <= RS_TOLERANCE || std::abs(numerator) >= std::abs(denominator))
+            return;
+        const double t = std::atanh(numerator / denominator);
+        if (t > t1 && t < t2)
+            ts.push_back(t);
+    };
+    // x'(t) = a sinh(t) cos - b cosh(t) sin
+    addExtreme(b * sinA, a * cosA);
+    // y'(t) = a sinh(t) sin + b cosh(t) cos
+    addExtreme(-b * cosA, a * sinA);
+
+    minV = maxV = getPoint(ts.front());
+    for (double t: ts) {
+        const RS_Vector p = getPoint(t);
+        minV = RS_Vector::minimum(minV, p);
+        maxV = RS_Vector::maximum(maxV, p);
+    }
+}
+
+RS_Vector LC_Hyperbola::getNearestPointOnEntity(const RS_Vector& coord,
+                                                bool onEntity, double* dist, RS_Entity** entity) const
+{
+    if (entity)
+        *entity = const_cast<LC_Hyperbola*>(this);
+    if (dist)
+        *dist = RS_MAXDOUBLE;
+    const double a = getMajorRadius();
+    const double b = getMinorRadius();
+    if (!m_bValid || a < RS_TOLERANCE || b < RS_TOLERANCE)
+        return RS_Vector(false);
+
+    // in the coordinates of the branch: x^2/a^2 - y^2/b^2 = 1, x > 0
+    const RS_Vector vp = RS_Vector{coord - data.center}.rotate(-getAngle());
+    // the normal through coord, (a cosh(t) - x) a sinh(t) + (b sinh(t) - y) b cosh(t) = 0,
+    // by u = exp(t): (a^2 + b^2)(u^4 - 1) - 2(ax + by) u^3 + 2(ax - by) u = 0
+    const double c2 = a * a + b * b;
+    const RS_Math::Roots roots = RS_Math::quarticSolver(std::array<double, 4>{
+        -2. * (a * vp.x + b * vp.y) / c2, 0., 2. * (a * vp.x - b * vp.y) / c2, -1.});
+    const double t1 = std::min(data.angle1, data.angle2);
+    const double t2 = std::max(data.angle1, data.angle2);
+    const bool isLimited = onEntity && isArc();
+    std::vector<double> ts;
+    if (isLimited)
+        ts = {t1, t2};
+    for (double u: roots) {
+        if (u <= 0.)
+            continue;
+        const double t = std::log(u);
+        ts.push_back(isLimited ? std::clamp(t, t1, t2) : t);
+    }
+
+    RS_Vector nearest(false);
+    double minDist = RS_MAXDOUBLE;
+    for (double t: ts) {
+        const RS_Vector p = getPoint(t);
+        const double d = p.distanceTo(coord);
+        if (d < minDist) {
+            minDist = d;
+            nearest = p;
+        }
+    }
+    if (dist)
+        *dist = minDist;
+    return nearest;
+}
+
+void LC_Hyperbola::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternOffset*/)
+{
+    if (!(painter && view) || !m_bValid)
+        return;
+    const double factor = view->getFactor().x;
+    if (factor <= RS_TOLERANCE)
+        return;
+
+    // the tolerance in powers of 2, so small zoom steps keep the samples
+    const double tolerance = std::exp2(std::floor(std::log2(tessellationTolerance / factor)));
+    double t1 = std::min(data.angle1, data.angle2);
+    double t2 = std::max(data.angle1, data.angle2);
+    if (!isArc()) {
+        // the points of the view are within a circle around the center, a cosh(t) <= radius
+        double radius = 0.;
+        for (const RS_Vector& corner: {view->toGraph(0, 0), view->toGraph(view->getWidth(), 0),
+             view->toGraph(0, view->getHeight()), view->toGraph(view->getWidth(), view->getHeight())})
+            radius = std::max(radius, corner.distanceTo(data.center));
+        t2 = std::acosh(std::max(1., radius / getMajorRadius()));
+        t1 = -t2;
+    }
+
+    std::shared_ptr<const Tessellation> tessellation = m_tessellation;
+    const bool isCached = tessellation != nullptr && isSameData(tessellation->data, data)
+            && tessellation->tolerance == tolerance
+            && tessellation->t1 <= t1 && tessellation->t2 >= t2
+            && (isArc() || tessellation->t2 <= t2 + 2. * branchRangeMargin);
+    if (!isCached) {
+        if (!isArc()) {
+            t2 += branchRangeMargin;
+            t1 = -t2;
+        }
+        auto samples = std::make_shared<Tessellation>();
+        samples->data = data;
+        samples->tolerance = tolerance;
+        samples->t1 = t1;
+        samples->t2 = t2;
+        auto curve = [this](double t) {
+            return getPoint(t);
+        };
+        const double step = (t2 - t1) / minTessellationSegments;
+        RS_Vector p1 = getPoint(t1);
+        samples->points << QPointF{p1.x, p1.y};
+        for (int i = 0; i < minTessellationSegments; ++i) {
+            const double ta = t1 + i * step;
+            const double tb = (i + 1 == minTessellationSegments) ? t2 : ta + step;
+            const RS_Vector p2 = getPoint(tb);
+            appendSamples(samples->points, curve, ta, p1, tb, p2, tolerance, 0);
+            p1 = p2;
+        }
+        tessellation = samples;
+        // kept by the GUI thread, concurrent drawing only reads it
+        if (!view->isConcurrentDrawing())
+            m_tessellation = tessellation;
+    }
+
+    // the graph to screen mapping of the view, the pen width stays in pixels
+    const RS_Vector origin = view->toGui(RS_Vector{0., 0.});
+    const RS_Vector unitX = view->toGui(RS_Vector{1., 0.}) - origin;
+    const RS_Vector unitY = view->toGui(RS_Vector{0., 1.}) - origin;
+    const QTransform toGui{unitX.x, unitX.y, unitY.x, unitY.y, origin.x, origin.y};
+    QPainterPath path;
+    path.addPolygon(toGui.map(tessellation->points));
+    const QBrush brush(painter->brush());
+    painter->setBrush(QBrush{Qt::NoBrush});
+    painter->drawPath(path);
+    painter->setBrush(brush);
+}
+
 //RS_Vector LC_Hyperbola::getNearestEndpoint(const RS_Vector& /*coord*/,
 //                                         double* /*dist*/ = NULL) const
 //{
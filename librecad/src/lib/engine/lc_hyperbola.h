@@ -26,6 +26,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #ifndef LC_HYPERBOLA_H
 #define LC_HYPERBOLA_H
 
+#include <memory>
+
 #include "rs_atomicentity.h"
 
 class RS_Circle;
@@ -55,9 +57,9 @@ struct LC_HyperbolaData {
     RS_Vector majorP{};
 	//! Ratio of minor axis to major axis.
     double ratio = 0.;
-	//! Start angle
+	//! Start angle, the parameter t of center + majorP cosh(t) + minorP sinh(t)
     double angle1 = 0.;
-	//! End angle
+	//! End angle, equal to the start angle for the whole branch
     double angle2 = 0.;
 	//! Reversed (cw) flag
     bool reversed = false;
@@ -188,15 +190,18 @@ public:
         return data.majorP.magnitude()*data.ratio;
     }
 
-	void calculateBorders() override{}
+	void calculateBorders() override;
 
 	RS_Vector getMiddlePoint(void)const override{return RS_Vector(false);}
 	RS_Vector getNearestEndpoint(const RS_Vector& /*coord*/,
 										 double*/* dist = NULL*/) const override
     {return RS_Vector(false);}
-	RS_Vector getNearestPointOnEntity(const RS_Vector& /*coord*/,
-			bool /*onEntity = true*/, double*/* dist = NULL*/, RS_Entity**/* entity=NULL*/) const override
-    {return RS_Vector(false);}
+	/**
+	 * @brief getNearestPointOnEntity the foot of the normal from coord, solved as
+	 * a quartic equation in exp(t)
+	 */
+	RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+			bool onEntity = true, double* dist = nullptr, RS_Entity** entity = nullptr) const override;
 	RS_Vector getNearestCenter(const RS_Vector& /*coord*/,
 									   double*/* dist = NULL*/) const override
    {return RS_Vector(false);}
@@ -213,11 +218,6 @@ public:
                                     const RS_Line& /*normal*/,
 									 bool /*onEntity = false*/) const override
     {return RS_Vector(false);}
-	double getDistanceToPoint(const RS_Vector& /*coord*/,
-                                      RS_Entity** /*entity=NULL*/,
-                                      RS2::ResolveLevel/* level=RS2::ResolveNone*/,
-									  double /*solidDist = RS_MAXDOUBLE*/) const override
-    {return RS_MAXDOUBLE;}
 	bool isPointOnEntity(const RS_Vector& /*coord*/,
 								 double /*tolerance=RS_TOLERANCE*/) const override;
 
@@ -232,7 +232,12 @@ public:
 
 	void moveRef(const RS_Vector& /*ref*/, const RS_Vector& /*offset*/)override{}
 
-	void draw(RS_Painter* /*painter*/, RS_GraphicView* /*view*/, double& /*patternOffset*/)override{}
+	/**
+	 * @brief draw draws the branch tessellated for the zoom of the view, the samples are
+	 * kept while the zoom changes by less than a factor 2. The whole branch is drawn up
+	 * to the view.
+	 */
+	void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
 
     friend std::ostream& operator << (std::ostream& os, const LC_Hyperbola& a);
 
@@ -257,6 +262,15 @@ protected:
     LC_HyperbolaData data;
     bool m_bValid = false;
 
+private:
+    //! the point of the branch at parameter t
+    RS_Vector getPoint(double t) const;
+    //! true if angle1 and angle2 limit the branch
+    bool isArc() const;
+
+    struct Tessellation;
+    mutable std::shared_ptr<const Tessellation> m_tessellation;
+
 };
 
 
@@ -0,0 +1,452 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+#include <QApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+
+#include "lc_imagepyramid.h"
+#include "qc_applicationwindow.h"
+#include "rs_debug.h"
+#include "rs_settings.h"
+
+namespace {
+// the lower levels of images with at least this many pixels are cached on disk
+constexpr qint64 cacheMinPixels = 4096LL * 4096LL;
+
+// the pyramids of the image files in use
+std::mutex registryMutex;
+std::map<QString, std::weak_ptr<LC_ImagePyramid>> registry;
+
+std::atomic<bool> redrawPending{false};
+
+// the formats drawn without conversion
+QImage toDrawingFormat(const QImage& image)
+{
+    return image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                         : QImage::Format_RGB32);
+}
+
+bool isCacheEnabled()
+{
+    auto guard = RS_SETTINGS->beginGroupGuard("/Appearance");
+    return RS_SETTINGS->readNumEntry("/ImageCache", 1) == 1;
+}
+
+// the longest wait for a worker thread, so a slow file share doesn't block exports
+std::chrono::seconds getTimeout()
+{
+    auto guard = RS_SETTINGS->beginGroupGuard("/Appearance");
+    return std::chrono::seconds{std::max(1, RS_SETTINGS->readNumEntry("/ImageTimeout", 30))};
+}
+
+// the workers reading image files, apart from the rendering workers of the global pool
+QThreadPool& getImagePool()
+{
+    static QThreadPool pool;
+    static std::once_flag once;
+    std::call_once(once, []() {
+        pool.setMaxThreadCount(std::max(2, QThread::idealThreadCount() / 2));
+        // the pending jobs are dropped on quitting
+        if (qApp != nullptr)
+            QObject::connect(qApp, &QCoreApplication::aboutToQuit, []() { pool.clear(); });
+    });
+    return pool;
+}
+
+// redraws the views with the decoded tiles, once for the tiles decoded meanwhile
+void redrawViews()
+{
+    if (qobject_cast<QApplication*>(qApp) == nullptr || redrawPending.exchange(true))
+        return;
+    QMetaObject::invokeMethod(qApp, []() {
+        redrawPending = false;
+        // the window is not created for console commands
+        for (QWidget* widget: QApplication::topLevelWidgets()) {
+            if (auto window = qobject_cast<QC_ApplicationWindow*>(widget))
+                window->redrawAll();
+        }
+    }, Qt::QueuedConnection);
+}
+
+// removes the pyramids no longer used, the registry mutex is locked
+void purgeRegistry()
+{
+    for (auto it = registry.begin(); it != registry.end();) {
+        if (it->second.expired())
+            it = registry.erase(it);
+        else
+            ++it;
+    }
+}
+}
+
+std::shared_ptr<LC_ImagePyramid> LC_ImagePyramid::request(const QString& filePath)
+{
+    const QFileInfo info(filePath);
+    const QString key = QDir::cleanPath(info.absoluteFilePath());
+    const QDateTime modified = info.lastModified();
+
+    std::shared_ptr<LC_ImagePyramid> pyramid;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        purgeRegistry();
+        pyramid = registry[key].lock();
+    }
+    // a pyramid still read by a worker thread after the timeout is not read again
+    if (pyramid != nullptr && !pyramid->waitReady() && !pyramid->isNull())
+        return pyramid;
+    if (pyramid == nullptr || pyramid->m_modified != modified) {
+        pyramid.reset(new LC_ImagePyramid(key));
+        pyramid->readHeader();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry[key] = pyramid;
+    }
+    return pyramid;
+}
+
+std::shared_ptr<LC_ImagePyramid> LC_ImagePyramid::requestInBackground(const QString& filePath)
+{
+    // the path is not resolved, that would access the file system
+    const QString key = QDir::cleanPath(QDir::isAbsolutePath(filePath) ? filePath
+                                                                       : QDir::current().absoluteFilePath(filePath));
+    std::lock_guard<std::mutex> lock(registryMutex);
+    purgeRegistry();
+    std::shared_ptr<LC_ImagePyramid> pyramid = registry[key].lock();
+    if (pyramid == nullptr) {
+        pyramid.reset(new LC_ImagePyramid(key));
+        pyramid->start([](LC_ImagePyramid& self) {
+            self.readHeader();
+        }, true);
+        registry[key] = pyramid;
+    }
+    return pyramid;
+}
+
+LC_ImagePyramid::LC_ImagePyramid(QString filePath):
+    m_filePath{std::move(filePath)}
+{
+}
+
+/**
+ * Reads the modification time and the size of the image file, and creates
+ * the empty levels.
+ */
+void LC_ImagePyramid::readHeader()
+{
+    const auto setState = [this](State state) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_state = state;
+        }
+        m_jobDone.notify_all();
+    };
+
+    m_modified = QFileInfo(m_filePath).lastModified();
+    // only the header is read
+    QImageReader reader(m_filePath);
+    m_size = reader.size();
+    m_regionDecoding = reader.supportsOption(QImageIOHandler::ClipRect);
+    QImage image;
+    if (!m_size.isValid() && reader.canRead()) {
+        // the size of the format is known only by decoding
+        image = reader.read();
+        m_size = image.size();
+    }
+    if (m_size.isEmpty()) {
+        m_size = {};
+        setState(State::Null);
+        return;
+    }
+
+    for (QSize size = m_size;; size = {(size.width() + 1) / 2, (size.height() + 1) / 2}) {
+        Level level;
+        level.size = size;
+        level.columns = (size.width() + tileSize - 1) / tileSize;
+        level.rows = (size.height() + tileSize - 1) / tileSize;
+        level.tiles.resize(level.columns * level.rows);
+        level.queued.resize(level.tiles.size(), false);
+        m_levels.push_back(std::move(level));
+        if (std::max(size.width(), size.height()) <= tileSize)
+            break;
+    }
+
+    if (m_levels.size() > 1 && qint64(m_size.width()) * m_size.height() >= cacheMinPixels
+            && isCacheEnabled()) {
+        QCryptographicHash hash{QCryptographicHash::Sha1};
+        hash.addData(m_filePath.toUtf8());
+        hash.addData(QByteArray::number(m_modified.toMSecsSinceEpoch()));
+        m_cacheKey = QString::fromLatin1(hash.result().toHex());
+    }
+
+    // tiles requested meanwhile are not decoded again
+    std::lock_guard<std::mutex> decode(m_decodeMutex);
+    setState(State::Ready);
+    if (!image.isNull())
+        decodeLevels(std::move(image));
+}
+
+LC_ImagePyramid::~LC_ImagePyramid() = default;
+
+bool LC_ImagePyramid::isReady() const
+{
+    return m_state == State::Ready;
+}
+
+bool LC_ImagePyramid::isNull() const
+{
+    return m_state == State::Null;
+}
+
+bool LC_ImagePyramid::waitReady()
+{
+    const auto timeout = getTimeout();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_jobDone.wait_for(lock, timeout, [this]() { return m_state != State::Reading; }))
+        LC_ERR << "LC_ImagePyramid::" << __func__ << "(): timeout reading " << m_filePath;
+    return m_state == State::Ready;
+}
+
+QSize LC_ImagePyramid::getSize() const
+{
+    return isReady() ? m_size : QSize{};
+}
+
+int LC_ImagePyramid::countLevels() const
+{
+    return isReady() ? int(m_levels.size()) : 0;
+}
+
+QSize LC_ImagePyramid::getLevelSize(int level) const
+{
+    return m_levels.at(level).size;
+}
+
+int LC_ImagePyramid::getLevelFor(double pixelSize) const
+{
+    if (isNull())
+        return 0;
+    if (pixelSize <= 0.)
+        return countLevels() - 1;
+    const int level = int(std::floor(std::log2(1. / pixelSize)));
+    return std::clamp(level, 0, countLevels() - 1);
+}
+
+QImage LC_ImagePyramid::getTile(int level, int column, int row, bool wait)
+{
+    if (level < 0 || level >= countLevels() || m_failed)
+        return {};
+    Level& l = m_levels[level];
+    if (column < 0 || column >= l.columns || row < 0 || row >= l.rows)
+        return {};
+    const int index = row * l.columns + column;
+    const auto timeout = wait ? getTimeout() : std::chrono::seconds{};
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!l.tiles[index].isNull())
+        return l.tiles[index];
+    if (!l.queued[index]) {
+        // a level is decoded at once, unless its tiles are decoded one by one
+        if (level == 0 && m_regionDecoding)
+            l.queued[index] = true;
+        else
+            std::fill(l.queued.begin(), l.queued.end(), true);
+        // the views waiting for the tile are not redrawn
+        start([level, index](LC_ImagePyramid& self) {
+            self.load(level, index);
+        }, !wait);
+    }
+    if (wait && !m_jobDone.wait_for(lock, timeout, [&]() { return !l.tiles[index].isNull() || m_failed; }))
+        LC_ERR << "LC_ImagePyramid::" << __func__ << "(): timeout decoding " << m_filePath;
+    return l.tiles[index];
+}
+
+/**
+ * Starts the job by a worker thread. The job is skipped, if the pyramid is no
+ * longer used by then.
+ */
+void LC_ImagePyramid::start(std::function<void(LC_ImagePyramid&)> job, bool redraw)
+{
+    getImagePool().start([weak = weak_from_this(), job = std::move(job), redraw]() {
+        const std::shared_ptr<LC_ImagePyramid> self = weak.lock();
+        if (self == nullptr)
+            return;
+        job(*self);
+        {
+            // the waiting threads check their condition before or after this
+            std::lock_guard<std::mutex> lock(self->m_mutex);
+        }
+        self->m_jobDone.notify_all();
+        if (redraw)
+            redrawViews();
+    });
+}
+
+bool LC_ImagePyramid::isTileReady(int level, int index) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_levels[level].tiles[index].isNull();
+}
+
+QRect LC_ImagePyramid::getTileRect(int level, int index) const
+{
+    const Level& l = m_levels[level];
+    const QRect tile{(index % l.columns) * tileSize, (index / l.columns) * tileSize, tileSize, tileSize};
+    return tile.intersected({QPoint{}, l.size});
+}
+
+std::size_t LC_ImagePyramid::getMemoryUsage() const
+{
+    // the levels are set up by readHeader()
+    if (!isReady())
+        return 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t bytes = 0;
+    for (const Level& l: m_levels) {
+        for (const QImage& tile: l.tiles)
+            bytes += std::size_t(tile.sizeInBytes());
+    }
+    return bytes;
+}
+
+void LC_ImagePyramid::setLevel(int level, const QImage& image)
+{
+    Level& l = m_levels[level];
+    std::vector<QImage> tiles(l.tiles.size());
+    for (size_t i = 0; i < tiles.size(); ++i)
+        tiles[i] = image.copy(getTileRect(level, int(i)));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    l.tiles = std::move(tiles);
+}
+
+/**
+ * Loads the tile of the level, and all other tiles decoded with it.
+ */
+void LC_ImagePyramid::load(int level, int index)
+{
+    if (level == 0 && m_regionDecoding) {
+        decodeTile(index);
+        return;
+    }
+    std::lock_guard<std::mutex> decode(m_decodeMutex);
+    // decoded meanwhile
+    if (isTileReady(level, index))
+        return;
+    if (level > 0 && loadCachedLevel(level))
+        return;
+    decodeLevels();
+}
+
+/**
+ * Decodes the full image and creates all levels from it. The full resolution is
+ * kept only if its tiles can't be decoded one by one.
+ */
+void LC_ImagePyramid::decodeLevels(QImage image)
+{
+    if (image.isNull()) {
+        QImageReader reader(m_filePath);
+        image = reader.read();
+        if (image.isNull()) {
+            LC_ERR << "LC_ImagePyramid::" << __func__ << "(): " << m_filePath << ": " << reader.errorString();
+            m_failed = true;
+            return;
+        }
+    }
+    image = toDrawingFormat(image);
+    if (image.size() != m_size)
+        image = image.scaled(m_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    for (int level = 0; level < countLevels(); ++level) {
+        if (level > 0) {
+            image = image.scaled(getLevelSize(level), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            const QString cacheFile = getCacheFile(level);
+            if (!cacheFile.isEmpty() && !QFileInfo::exists(cacheFile)) {
+                QDir().mkpath(QFileInfo(cacheFile).path());
+                QSaveFile file(cacheFile);
+                QImageWriter writer(&file, "png");
+                // low compression, writing is on the way to the drawing
+                writer.setQuality(90);
+                if (!file.open(QIODevice::WriteOnly) || !writer.write(image) || !file.commit())
+                    LC_ERR << "LC_ImagePyramid::" << __func__ << "(): can't write " << cacheFile;
+            }
+        }
+        if (level > 0 || !m_regionDecoding)
+            setLevel(level, image);
+    }
+}
+
+bool LC_ImagePyramid::loadCachedLevel(int level)
+{
+    const QString cacheFile = getCacheFile(level);
+    if (cacheFile.isEmpty() || !QFileInfo::exists(cacheFile))
+        return false;
+    const QImage image{cacheFile};
+    if (image.size() != getLevelSize(level))
+        return false;
+    setLevel(level, toDrawingFormat(image));
+    return true;
+}
+
+/**
+ * Decodes a full resolution tile, for formats decoding regions.
+ */
+void LC_ImagePyramid::decodeTile(int index)
+{
+    if (isTileReady(0, index))
+        return;
+    QImageReader reader(m_filePath);
+    reader.setClipRect(getTileRect(0, index));
+    const QImage tile = reader.read();
+    if (tile.isNull()) {
+        LC_ERR << "LC_ImagePyramid::" << __func__ << "(): " << m_filePath << ": " << reader.errorString();
+        m_failed = true;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_levels[0].tiles[index] = toDrawingFormat(tile);
+}
+
+QString LC_ImagePyramid::getCacheFile(int level) const
+{
+    if (m_cacheKey.isEmpty())
+        return {};
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty())
+        return {};
+    return QString("%1/images/%2-%3.png").arg(dir, m_cacheKey).arg(level);
+}
@@ -0,0 +1,154 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_IMAGEPYRAMID_H
+#define LC_IMAGEPYRAMID_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QDateTime>
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <QString>
+
+/**
+ * @brief The LC_ImagePyramid class, the resolution levels of a raster image file,
+ * split into tiles. Level 0 is the full resolution, each further level halves the
+ * size, down to a single tile.
+ *
+ * Only the image size is read when the pyramid is requested, or by a worker thread,
+ * when the pyramid is requested in background. Levels are decoded on the first
+ * request of one of their tiles, by worker threads; all graphic views are redrawn
+ * once they are ready. Waiting for the workers is limited by a timeout, and the
+ * pending work of pyramids no longer used is dropped. When the image format supports decoding a
+ * region, tiles of the full resolution are decoded one by one. The lower levels
+ * are optionally cached on disk, so they are read without decoding the full image
+ * again.
+ *
+ * Pyramids are shared by all images of the same file.
+ */
+class LC_ImagePyramid : public std::enable_shared_from_this<LC_ImagePyramid> {
+public:
+    static constexpr int tileSize = 512;
+
+    /**
+     * @return the pyramid of the image file, shared with the images using the
+     * same file as long as the file is not modified
+     */
+    static std::shared_ptr<LC_ImagePyramid> request(const QString& filePath);
+    /**
+     * @return the pyramid of the image file, like request(), but the file is read
+     * by a worker thread. The pyramid is not ready until then. A pyramid of the file
+     * in use is shared, without checking the file for modifications
+     */
+    static std::shared_ptr<LC_ImagePyramid> requestInBackground(const QString& filePath);
+
+    ~LC_ImagePyramid();
+    LC_ImagePyramid(const LC_ImagePyramid&) = delete;
+    LC_ImagePyramid& operator = (const LC_ImagePyramid&) = delete;
+
+    //! whether the file is read and is an image
+    bool isReady() const;
+    //! whether the file is read and is not a readable image
+    bool isNull() const;
+    /**
+     * @brief waitReady waits until the file is read, at most for the timeout
+     * @return whether the pyramid is ready
+     */
+    bool waitReady();
+    //! size of the full resolution image in pixels
+    QSize getSize() const;
+
+    int countLevels() const;
+    QSize getLevelSize(int level) const;
+    /**
+     * @return the level showing the image with at least one screen pixel per level pixel
+     * @param pixelSize size of an image pixel on the screen, in screen pixels
+     */
+    int getLevelFor(double pixelSize) const;
+
+    /**
+     * @return the tile in column and row of the level, counted from the top left.
+     * If the tile is not decoded yet, a null image is returned and the tile is
+     * decoded by a worker thread. If wait is true, the tile is waited for, at most for
+     * the timeout
+     */
+    QImage getTile(int level, int column, int row, bool wait);
+
+    //! @return bytes of the decoded tiles
+    std::size_t getMemoryUsage() const;
+
+private:
+    struct Level {
+        QSize size;
+        int columns = 0;
+        int rows = 0;
+        std::vector<QImage> tiles;
+        std::vector<bool> queued;
+    };
+
+    enum class State {
+        Reading,
+        Ready,
+        Null
+    };
+
+    explicit LC_ImagePyramid(QString filePath);
+    void readHeader();
+    void start(std::function<void(LC_ImagePyramid&)> job, bool redraw);
+    bool isTileReady(int level, int index) const;
+    QRect getTileRect(int level, int index) const;
+    void setLevel(int level, const QImage& image);
+    void decodeLevels(QImage image = {});
+    bool loadCachedLevel(int level);
+    void decodeTile(int index);
+    void load(int level, int index);
+    QString getCacheFile(int level) const;
+
+    const QString m_filePath;
+    //! the following members are set by readHeader(), before the state changes
+    QDateTime m_modified;
+    QString m_cacheKey;
+    QSize m_size;
+    //! whether the format decodes regions, so full resolution tiles are decoded one by one
+    bool m_regionDecoding = false;
+    std::vector<Level> m_levels;
+    std::atomic<State> m_state{State::Reading};
+    //! set when decoding failed, it's not tried again
+    std::atomic<bool> m_failed{false};
+    //! guards the tiles
+    mutable std::mutex m_mutex;
+    //! notified when a job of a worker thread is done
+    std::condition_variable m_jobDone;
+    //! serializes the decoding of levels
+    std::mutex m_decodeMutex;
+};
+
+#endif
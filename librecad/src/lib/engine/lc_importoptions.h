@@ -0,0 +1,82 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_IMPORTOPTIONS_H
+#define LC_IMPORTOPTIONS_H
+
+#include <QStringList>
+
+#include "lc_rect.h"
+
+/**
+ * @brief The LC_ImportOptions struct, options to import a part of a drawing.
+ * The default options import everything.
+ */
+struct LC_ImportOptions {
+    //! names of the layers to import, '*' and '?' wildcards are allowed. All layers, if empty
+    QStringList includeLayers;
+    //! names of the layers not to import, with the same wildcards
+    QStringList excludeLayers;
+    //! if set, only entities with borders intersecting the window are imported
+    bool useWindow = false;
+    LC_Rect window;
+    //! if set, timings of the import phases are written next to the file, as
+    //! <file>.profile.json
+    bool writeProfile = false;
+    //! if set, the drawing is opened for viewing and plotting, see RS_Graphic::setReadOnly()
+    bool readOnly = false;
+
+    bool filtersLayers() const
+    {
+        return !includeLayers.isEmpty() || !excludeLayers.isEmpty();
+    }
+
+    //! @return true, if everything is imported. Profiling and read-only don't change the import
+    bool isEmpty() const
+    {
+        return !filtersLayers() && !useWindow;
+    }
+
+    /**
+     * @brief setWindow sets the window from its corners, given as "x1,y1,x2,y2"
+     * @return false, if the corners can't be parsed
+     */
+    bool setWindow(const QString& corners)
+    {
+        const QStringList values = corners.split(',');
+        if (values.size() != 4)
+            return false;
+        double v[4];
+        for (int i = 0; i < 4; ++i) {
+            bool ok = false;
+            v[i] = values.at(i).trimmed().toDouble(&ok);
+            if (!ok)
+                return false;
+        }
+        window = LC_Rect{{v[0], v[1]}, {v[2], v[3]}};
+        useWindow = true;
+        return true;
+    }
+};
+
+#endif // LC_IMPORTOPTIONS_H
@@ -0,0 +1,92 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include "lc_librarycache.h"
+
+#include <algorithm>
+
+#include <QFileInfo>
+
+#include "lc_memoryreport.h"
+#include "rs_debug.h"
+#include "rs_graphic.h"
+
+namespace {
+// estimated memory of the cached drawings, the most recently used one is always kept
+constexpr std::size_t maxCacheBytes = std::size_t(64) << 20;
+}
+
+LC_LibraryCache& LC_LibraryCache::instance()
+{
+    static LC_LibraryCache uniqueInstance;
+    return uniqueInstance;
+}
+
+std::shared_ptr<RS_Graphic> LC_LibraryCache::get(const QString& fileName)
+{
+    const QFileInfo info(fileName);
+    const QString path = info.absoluteFilePath();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find_if(m_entries.begin(), m_entries.end(), [&path](const Entry& entry) {
+        return entry.path == path;
+    });
+    if (it != m_entries.end()) {
+        if (it->modified == info.lastModified() && it->size == info.size()) {
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            return it->graphic;
+        }
+        RS_DEBUG->print("LC_LibraryCache::get: %s changed", path.toLatin1().data());
+        m_bytes -= it->bytes;
+        m_entries.erase(it);
+    }
+
+    auto graphic = std::make_shared<RS_Graphic>();
+    if (!graphic->open(path, RS2::FormatUnknown)) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_LibraryCache::get: cannot open %s",
+                        path.toLatin1().data());
+        return nullptr;
+    }
+    const std::size_t bytes = LC_MemoryReport(*graphic).getDrawingBytes();
+    m_entries.push_front({path, info.lastModified(), info.size(), graphic, bytes});
+    m_bytes += bytes;
+    shrink();
+    return graphic;
+}
+
+void LC_LibraryCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_bytes = 0;
+}
+
+void LC_LibraryCache::shrink()
+{
+    // drawings still in use by actions stay alive through their shared pointers
+    while (m_bytes > maxCacheBytes && m_entries.size() > 1) {
+        m_bytes -= m_entries.back().bytes;
+        m_entries.pop_back();
+    }
+}
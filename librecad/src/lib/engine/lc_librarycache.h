@@ -0,0 +1,75 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_LIBRARYCACHE_H
+#define LC_LIBRARYCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include <QDateTime>
+#include <QString>
+
+class RS_Graphic;
+
+/**
+ * @brief The LC_LibraryCache class the recently inserted library files, parsed once
+ * and shared by the library insert actions of all windows. A file changed on disk
+ * is parsed again. The least recently used files are released when the estimated
+ * memory of the cached drawings exceeds the limit.
+ */
+class LC_LibraryCache {
+public:
+    static LC_LibraryCache& instance();
+
+    /**
+     * @brief get the parsed library file
+     * @param fileName path of the file
+     * @return the drawing of the file, nullptr if the file couldn't be read
+     */
+    std::shared_ptr<RS_Graphic> get(const QString& fileName);
+    //! releases all cached files
+    void clear();
+
+private:
+    LC_LibraryCache() = default;
+    void shrink();
+
+    struct Entry {
+        QString path;
+        QDateTime modified;
+        qint64 size = 0;
+        std::shared_ptr<RS_Graphic> graphic;
+        std::size_t bytes = 0;
+    };
+    std::mutex m_mutex;
+    //! most recently used first
+    std::list<Entry> m_entries;
+    std::size_t m_bytes = 0;
+};
+
+#endif // LC_LIBRARYCACHE_H
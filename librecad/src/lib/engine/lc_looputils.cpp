@@ -24,13 +24,18 @@
 */
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <map>
 #include <random>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "lc_looputils.h"
+#include "lc_rect.h"
+#include "lc_spatialindex.h"
 #include "rs_circle.h"
 #include "rs_debug.h"
 #include "rs_entity.h"
@@ -72,6 +77,76 @@ bool isConnected( const RS_Entity& entity1, const RS_Entity& entity2);
 // randomEngine
 std::default_random_engine randomEngine;
 
+// Edges by the grid cells, sized by the gap tolerance, of their end points
+class EndpointMap {
+public:
+    explicit EndpointMap(const RS_EntityContainer& edges)
+    {
+        for (RS_Entity* edge: edges) {
+            insert(edge->getStartpoint(), edge);
+            insert(edge->getEndpoint(), edge);
+        }
+    }
+
+    // edges with an end point in the cells around the point
+    std::vector<RS_Entity*> findCandidates(const RS_Vector& point) const
+    {
+        std::vector<RS_Entity*> candidates;
+        const std::int64_t cx = cellOf(point.x);
+        const std::int64_t cy = cellOf(point.y);
+        for (std::int64_t x = cx - 1; x <= cx + 1; ++x) {
+            for (std::int64_t y = cy - 1; y <= cy + 1; ++y) {
+                auto it = m_cells.find({x, y});
+                if (it == m_cells.end())
+                    continue;
+                for (RS_Entity* edge: it->second) {
+                    if (std::find(candidates.cbegin(), candidates.cend(), edge) == candidates.cend())
+                        candidates.push_back(edge);
+                }
+            }
+        }
+        return candidates;
+    }
+
+private:
+    struct CellHash {
+        std::size_t operator()(const std::pair<std::int64_t, std::int64_t>& cell) const
+        {
+            return std::hash<std::int64_t>{}(cell.first) * 1000003u ^ std::hash<std::int64_t>{}(cell.second);
+        }
+    };
+
+    void insert(const RS_Vector& point, RS_Entity* edge)
+    {
+        if (point.valid)
+            m_cells[{cellOf(point.x), cellOf(point.y)}].push_back(edge);
+    }
+
+    static std::int64_t cellOf(double coordinate)
+    {
+        // far away cells are merged, instead of overflowing
+        constexpr double limit = double(std::int64_t{1} << 62);
+        return std::int64_t(std::clamp(std::floor(coordinate / contourGapTolerance), -limit, limit));
+    }
+
+    std::unordered_map<std::pair<std::int64_t, std::int64_t>, std::vector<RS_Entity*>, CellHash> m_cells;
+};
+
+// The bounding box of an entity
+LC_Rect getBox(const RS_Entity& entity)
+{
+    return {entity.getMin(), entity.getMax()};
+}
+
+// Whether the bounding box of the loop contains the box of the other loop
+bool containsBox(const RS_EntityContainer& loop, const RS_EntityContainer& other)
+{
+    return loop.getMin().x <= other.getMin().x + RS_TOLERANCE
+            && loop.getMin().y <= other.getMin().y + RS_TOLERANCE
+            && loop.getMax().x + RS_TOLERANCE >= other.getMax().x
+            && loop.getMax().y + RS_TOLERANCE >= other.getMax().y;
+}
+
 // ------------------------------------------------------------------------------------- //
 // a random angle between 0 and 2 pi
 double getRandomAngle() {
@@ -190,12 +265,39 @@ struct LoopExtractor::LoopData {
     LoopData(RS_EntityContainer &edges):
         size{edges.getSize().magnitude()}
     , edges{edges}
+    , endpoints{edges}
     {}
     const double size = 0.;
     RS_Vector vertex;
     RS_Vector vertexTarget;
     RS_Entity* current = nullptr;
     RS_EntityContainer& edges;
+    // connectivity of the edges
+    const EndpointMap endpoints;
+    // edges added to loops, removed from edges once all loops are extracted
+    std::unordered_set<const RS_Entity*> processed;
+    // edges before this position are processed
+    unsigned firstUnprocessed = 0;
+
+    bool isProcessed(const RS_Entity* edge) const
+    {
+        return processed.count(edge) != 0;
+    }
+
+    void setProcessed(const RS_Entity* edge)
+    {
+        processed.insert(edge);
+    }
+
+    RS_Entity* nextUnprocessed()
+    {
+        for (; firstUnprocessed < edges.count(); ++firstUnprocessed) {
+            RS_Entity* edge = edges.entityAt(firstUnprocessed);
+            if (!isProcessed(edge))
+                return edge;
+        }
+        return nullptr;
+    }
 };
 
 LoopExtractor::LoopExtractor(RS_EntityContainer &edges) :
@@ -209,15 +311,15 @@ LoopExtractor::LoopExtractor(RS_EntityContainer &edges) :
 //------------------------------------------------------------------------------------//
 std::vector<RS_Entity*> LoopExtractor::getConnected() const
 {
-    std::vector<RS_Entity *> connected;
-    std::copy_if(m_data->edges.begin(), m_data->edges.end(), std::back_inserter(connected),
-                 [vertex = m_data->vertex, current = m_data->current](const RS_Entity *e) {
-        if (e == current)
-            return false;
+    std::vector<RS_Entity *> connected = m_data->endpoints.findCandidates(m_data->vertex);
+    connected.erase(std::remove_if(connected.begin(), connected.end(),
+                                   [this, vertex = m_data->vertex, current = m_data->current](const RS_Entity *e) {
+        if (e == current || m_data->isProcessed(e))
+            return true;
         double dist = RS_MAXDOUBLE;
         e->getNearestEndpoint(vertex, &dist);
-        return dist < contourGapTolerance;
-    });
+        return dist >= contourGapTolerance;
+    }), connected.end());
     return connected;
 }
 
@@ -236,7 +338,7 @@ RS_Entity* LoopExtractor::findFirst() const
 {
 
     // draw a line crossing the first edge
-    RS_Entity* first = m_data->edges.firstEntity();
+    RS_Entity* first = m_data->nextUnprocessed();
     RS_Vector p0 = first->getMiddlePoint();
     RS_Vector t0 = first->getTangentDirection(p0).normalize();
     // The dP0 direction is off the normal direction by a random angle smaller than 0.06*Pi
@@ -246,11 +348,14 @@ RS_Entity* LoopExtractor::findFirst() const
     std::array<RS_Vector, 2> linePoints = {{p0 - dP0, p0 + dP0}};
     std::sort(std::begin(linePoints), std::end(linePoints), ComparePoints{});
     RS_Line line0{linePoints.front(), linePoints.back()};
+    const LC_Rect lineBox = getBox(line0);
 
     // Find intersections: only keep the intersection of minimum xy-coordinates
     double dist=RS_MAXDOUBLE * RS_MAXDOUBLE;
     for(RS_Entity* edge: m_data->edges)
     {
+        if (m_data->isProcessed(edge) || !lineBox.intersects(getBox(*edge), RS_TOLERANCE))
+            continue;
         RS_VectorSolutions sol0 = RS_Information::getIntersection(&line0, edge, true);
         if (!sol0.empty()) {
             for (const RS_Vector& p00: sol0) {
@@ -277,7 +382,7 @@ RS_Entity* LoopExtractor::findFirst() const
     m_data->current = first;
     m_loop = std::make_unique<RS_EntityContainer>(nullptr, false);
     m_loop->addEntity(m_data->current);
-    m_data->edges.removeEntity(first);
+    m_data->setProcessed(first);
     return first;
 }
 
@@ -340,7 +445,7 @@ bool LoopExtractor::findNext() const
     }
     m_data->vertex = (m_data->vertex.squaredTo(m_data->current->getStartpoint()) > RS_TOLERANCE) ? m_data->current->getStartpoint() : m_data->current->getEndpoint();
     m_loop->addEntity(m_data->current);
-    m_data->edges.removeEntity(m_data->current);
+    m_data->setProcessed(m_data->current);
     return true;
 }
 
@@ -353,7 +458,7 @@ std::vector<std::unique_ptr<RS_EntityContainer>> LoopExtractor::extract() {
         return loops;
 
     bool success = true;
-    while(success && !m_data->edges.isEmpty()) {
+    while(success && m_data->nextUnprocessed() != nullptr) {
         findFirst();
         while(success && m_data->vertex.squaredTo(m_data->vertexTarget) > RS_TOLERANCE) {
             LC_LOG<<m_data->vertex.x<<", "<< m_data->vertex.y<<" : "<<" : ds2 = "
@@ -365,6 +470,11 @@ std::vector<std::unique_ptr<RS_EntityContainer>> LoopExtractor::extract() {
             LC_ERR << __func__<<"(): invalid loop of size = "<<m_loop->count();
         loops.push_back(std::move(m_loop));
     }
+    // remove the edges in loops at once
+    const std::unordered_set<const RS_Entity*>& processed = m_data->processed;
+    m_data->edges.removeEntities([&processed](const RS_Entity* edge) {
+        return processed.count(edge) != 0;
+    });
     LC_LOG<<__func__<<"(): loops.size() = "<<loops.size();
     return loops;
 }
@@ -417,6 +527,15 @@ struct LoopSorter::Data {
     std::multiset<RS_EntityContainer*, LoopSorter::AreaPredicate> toProcess;
     // lookup table for parent loops
     std::unordered_map<RS_EntityContainer*, RS_EntityContainer*> parents;
+    // bounding boxes of the loops, only loops containing the box of a loop may enclose it
+    LC_SpatialIndex boxes;
+
+    bool isPending(RS_EntityContainer* loop) const
+    {
+        // loops of equal areas are equivalent in toProcess
+        auto range = toProcess.equal_range(loop);
+        return std::find(range.first, range.second, loop) != range.second;
+    }
 };
 
 //------------------------------------------------------------------------------------//
@@ -443,8 +562,10 @@ LoopSorter::~LoopSorter() = default;
 //------------------------------------------------------------------------------------//
 void LoopSorter::init()
 {
-    for(const auto& loop: m_data->loops)
+    for(const auto& loop: m_data->loops) {
         m_data->toProcess.insert(loop.get());
+        m_data->boxes.insert(loop.get(), double(m_data->boxes.size()));
+    }
     std::vector<RS_EntityContainer*> loops{m_data->toProcess.begin(), m_data->toProcess.end()};
 
     for (RS_EntityContainer* loop : loops)
@@ -463,8 +584,9 @@ void LoopSorter::findAncestors(RS_EntityContainer* loop)
     // sorting by floating points is okay, the loops shouldn't be close to each other, with exception
     // of touching points
     std::map<double, RS_EntityContainer*> ancestors;
-    for(RS_EntityContainer* candidate: m_data->toProcess) {
-        if (candidate == loop)
+    for(RS_Entity* entity: m_data->boxes.query(getBox(*loop))) {
+        auto candidate = static_cast<RS_EntityContainer*>(entity);
+        if (candidate == loop || !containsBox(*candidate, *loop) || !m_data->isPending(candidate))
             continue;
         RS_VectorSolutions intersections = getIntersection(*ray, *candidate);
         if (intersections.size()%2 == 0)
@@ -0,0 +1,390 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <QJsonArray>
+#include <QObject>
+
+#include "lc_dimarc.h"
+#include "lc_hyperbola.h"
+#include "lc_imagepyramid.h"
+#include "lc_memoryreport.h"
+#include "lc_parabola.h"
+#include "lc_splinepoints.h"
+#include "rs_arc.h"
+#include "rs_block.h"
+#include "rs_blocklist.h"
+#include "rs_circle.h"
+#include "rs_constructionline.h"
+#include "rs_dimaligned.h"
+#include "rs_dimangular.h"
+#include "rs_dimdiametric.h"
+#include "rs_dimlinear.h"
+#include "rs_dimradial.h"
+#include "rs_ellipse.h"
+#include "rs_font.h"
+#include "rs_fontlist.h"
+#include "rs_graphic.h"
+#include "rs_hatch.h"
+#include "rs_image.h"
+#include "rs_insert.h"
+#include "rs_leader.h"
+#include "rs_line.h"
+#include "rs_mtext.h"
+#include "rs_pattern.h"
+#include "rs_patternlist.h"
+#include "rs_point.h"
+#include "rs_polyline.h"
+#include "rs_solid.h"
+#include "rs_spline.h"
+#include "rs_text.h"
+
+namespace {
+// flat polylines keep their segments as vertex arrays, see RS_Polyline::isFlat()
+bool isFlatPolyline(const RS_Entity& entity)
+{
+    return entity.rtti() == RS2::EntityPolyline && static_cast<const RS_Polyline&>(entity).isFlat();
+}
+
+// the size of an entity itself, with its point lists and text, but not its sub-entities
+std::size_t getEntityBytes(const RS_Entity& entity)
+{
+    // the slot in the entity list of the parent
+    std::size_t bytes = sizeof(RS_Entity*);
+    switch (entity.rtti()) {
+    case RS2::EntityPoint:
+        return bytes + sizeof(RS_Point);
+    case RS2::EntityLine:
+        return bytes + sizeof(RS_Line);
+    case RS2::EntityArc:
+        return bytes + sizeof(RS_Arc);
+    case RS2::EntityCircle:
+        return bytes + sizeof(RS_Circle);
+    case RS2::EntityEllipse:
+        return bytes + sizeof(RS_Ellipse);
+    case RS2::EntityHyperbola:
+        return bytes + sizeof(LC_Hyperbola);
+    case RS2::EntitySolid:
+        return bytes + sizeof(RS_Solid);
+    case RS2::EntityConstructionLine:
+        return bytes + sizeof(RS_ConstructionLine);
+    case RS2::EntityPolyline:
+        return bytes + sizeof(RS_Polyline)
+                + static_cast<const RS_Polyline&>(entity).countVertices() * (sizeof(RS_Vector) + sizeof(double));
+    case RS2::EntitySpline:
+        return bytes + sizeof(RS_Spline)
+                + static_cast<const RS_Spline&>(entity).getControlPoints().size() * sizeof(RS_Vector);
+    case RS2::EntitySplinePoints:
+    case RS2::EntityParabola: {
+        const auto& spline = static_cast<const LC_SplinePoints&>(entity);
+        return bytes + (entity.rtti() == RS2::EntityParabola ? sizeof(LC_Parabola) : sizeof(LC_SplinePoints))
+                + (spline.getPoints().size() + spline.getControlPoints().size()) * sizeof(RS_Vector);
+    }
+    case RS2::EntityText:
+        return bytes + sizeof(RS_Text)
+                + std::size_t(const_cast<RS_Text&>(static_cast<const RS_Text&>(entity)).getText().size()) * sizeof(QChar);
+    case RS2::EntityMText:
+        return bytes + sizeof(RS_MText)
+                + std::size_t(static_cast<const RS_MText&>(entity).getText().size()) * sizeof(QChar);
+    case RS2::EntityDimAligned:
+        return bytes + sizeof(RS_DimAligned);
+    case RS2::EntityDimLinear:
+        return bytes + sizeof(RS_DimLinear);
+    case RS2::EntityDimRadial:
+        return bytes + sizeof(RS_DimRadial);
+    case RS2::EntityDimDiametric:
+        return bytes + sizeof(RS_DimDiametric);
+    case RS2::EntityDimAngular:
+        return bytes + sizeof(RS_DimAngular);
+    case RS2::EntityDimArc:
+        return bytes + sizeof(LC_DimArc);
+    case RS2::EntityDimLeader:
+        return bytes + sizeof(RS_Leader);
+    case RS2::EntityHatch:
+        return bytes + sizeof(RS_Hatch);
+    case RS2::EntityImage:
+        return bytes + sizeof(RS_Image);
+    case RS2::EntityInsert:
+        return bytes + sizeof(RS_Insert);
+    default:
+        return bytes + (entity.isContainer() ? sizeof(RS_EntityContainer) : sizeof(RS_AtomicEntity));
+    }
+}
+
+// the entity with all its sub-entities. Entities created on demand are not created
+LC_MemoryReport::Usage getDeepUsage(RS_Entity& entity)
+{
+    LC_MemoryReport::Usage usage{1, getEntityBytes(entity)};
+    auto container = dynamic_cast<RS_EntityContainer*>(&entity);
+    if (container != nullptr && !isFlatPolyline(entity)) {
+        for (unsigned i = 0; i < container->count(); ++i)
+            usage += getDeepUsage(*container->entityAt(int(i)));
+    }
+    return usage;
+}
+
+// the kind of geometry generated by the entity as sub-entities, or an empty string
+// for entities with user geometry as sub-entities
+QString getGeneratedKind(const RS_Entity& entity)
+{
+    switch (entity.rtti()) {
+    case RS2::EntityText:
+    case RS2::EntityMText:
+        return QObject::tr("texts");
+    case RS2::EntityInsert:
+        return QObject::tr("inserts");
+    case RS2::EntitySpline:
+        return QObject::tr("splines");
+    case RS2::EntityDimAligned:
+    case RS2::EntityDimLinear:
+    case RS2::EntityDimRadial:
+    case RS2::EntityDimDiametric:
+    case RS2::EntityDimAngular:
+    case RS2::EntityDimArc:
+    case RS2::EntityDimLeader:
+        return QObject::tr("dimensions");
+    default:
+        return {};
+    }
+}
+
+QString getTypeName(const RS_Entity& entity)
+{
+    switch (entity.rtti()) {
+    case RS2::EntityPoint: return "Point";
+    case RS2::EntityLine: return "Line";
+    case RS2::EntityArc: return "Arc";
+    case RS2::EntityCircle: return "Circle";
+    case RS2::EntityEllipse: return "Ellipse";
+    case RS2::EntityHyperbola: return "Hyperbola";
+    case RS2::EntitySolid: return "Solid";
+    case RS2::EntityConstructionLine: return "ConstructionLine";
+    case RS2::EntityPolyline: return "Polyline";
+    case RS2::EntitySpline: return "Spline";
+    case RS2::EntitySplinePoints: return "SplinePoints";
+    case RS2::EntityParabola: return "Parabola";
+    case RS2::EntityText: return "Text";
+    case RS2::EntityMText: return "MText";
+    case RS2::EntityDimAligned: return "DimAligned";
+    case RS2::EntityDimLinear: return "DimLinear";
+    case RS2::EntityDimRadial: return "DimRadial";
+    case RS2::EntityDimDiametric: return "DimDiametric";
+    case RS2::EntityDimAngular: return "DimAngular";
+    case RS2::EntityDimArc: return "DimArc";
+    case RS2::EntityDimLeader: return "Leader";
+    case RS2::EntityHatch: return "Hatch";
+    case RS2::EntityImage: return "Image";
+    case RS2::EntityInsert: return "Insert";
+    default: return "Other";
+    }
+}
+
+QString formatUsage(const QString& name, const LC_MemoryReport::Usage& usage)
+{
+    return QObject::tr("  %1: %2 entities, %3 KiB").arg(name).arg(usage.count).arg(usage.bytes / 1024.0, 0, 'f', 1);
+}
+
+QJsonObject toJson(const LC_MemoryReport::Usage& usage)
+{
+    QJsonObject object;
+    object["count"] = qint64(usage.count);
+    object["bytes"] = qint64(usage.bytes);
+    return object;
+}
+
+QJsonObject toJson(const std::map<QString, LC_MemoryReport::Usage>& usages)
+{
+    QJsonObject object;
+    for (const auto& [name, usage]: usages)
+        object[name] = toJson(usage);
+    return object;
+}
+
+LC_MemoryReport::Usage getTotal(const std::map<QString, LC_MemoryReport::Usage>& usages)
+{
+    LC_MemoryReport::Usage total;
+    for (const auto& item: usages)
+        total += item.second;
+    return total;
+}
+}
+
+LC_MemoryReport::Usage& LC_MemoryReport::Usage::operator += (const Usage& other)
+{
+    count += other.count;
+    bytes += other.bytes;
+    return *this;
+}
+
+LC_MemoryReport::LC_MemoryReport(RS_Graphic& graphic):
+    m_undoEstimate{graphic.getMemoryUsage()}
+{
+    for (unsigned i = 0; i < graphic.count(); ++i) {
+        RS_Entity* entity = graphic.entityAt(int(i));
+        addEntity(*entity, getTypeName(*entity));
+    }
+    // block definitions are user geometry too
+    RS_BlockList* blocks = graphic.getBlockList();
+    for (int i = 0; blocks != nullptr && i < blocks->count(); ++i) {
+        RS_Block* block = blocks->at(i);
+        for (unsigned k = 0; k < block->count(); ++k) {
+            RS_Entity* entity = block->entityAt(int(k));
+            addEntity(*entity, getTypeName(*entity));
+        }
+    }
+    addImages();
+    addFonts();
+    addPatterns();
+}
+
+void LC_MemoryReport::addEntity(RS_Entity& entity, const QString& type)
+{
+    if (entity.isUndone()) {
+        m_undo += getDeepUsage(entity);
+        return;
+    }
+    Usage& usage = m_entities[type];
+    ++usage.count;
+    usage.bytes += getEntityBytes(entity);
+
+    if (entity.rtti() == RS2::EntityImage) {
+        if (const LC_ImagePyramid* pyramid = static_cast<RS_Image&>(entity).getPyramid())
+            m_pyramids.insert(pyramid);
+    }
+
+    auto container = dynamic_cast<RS_EntityContainer*>(&entity);
+    if (container == nullptr)
+        return;
+    const QString kind = getGeneratedKind(entity);
+    if (!kind.isEmpty()) {
+        Usage& generated = m_generated[kind];
+        for (unsigned i = 0; i < container->count(); ++i)
+            generated += getDeepUsage(*container->entityAt(int(i)));
+        return;
+    }
+    if (entity.rtti() == RS2::EntityHatch) {
+        // the loops are user geometry, the pattern is generated
+        const RS_EntityContainer* pattern = static_cast<RS_Hatch&>(entity).getPatternEntities();
+        for (unsigned i = 0; i < container->count(); ++i) {
+            RS_Entity* child = container->entityAt(int(i));
+            if (child == pattern)
+                m_generated[QObject::tr("hatch patterns")] += getDeepUsage(*child);
+            else
+                usage += getDeepUsage(*child);
+        }
+        return;
+    }
+    addUserGeometry(*container, usage);
+}
+
+void LC_MemoryReport::addUserGeometry(RS_EntityContainer& container, Usage& usage)
+{
+    if (isFlatPolyline(container))
+        return;
+    for (unsigned i = 0; i < container.count(); ++i) {
+        RS_Entity* child = container.entityAt(int(i));
+        if (!getGeneratedKind(*child).isEmpty() || child->rtti() == RS2::EntityHatch) {
+            // e.g. texts in groups
+            addEntity(*child, getTypeName(*child));
+            continue;
+        }
+        usage.count += 1;
+        usage.bytes += getEntityBytes(*child);
+        if (auto sub = dynamic_cast<RS_EntityContainer*>(child))
+            addUserGeometry(*sub, usage);
+    }
+}
+
+void LC_MemoryReport::addImages()
+{
+    for (const LC_ImagePyramid* pyramid: m_pyramids) {
+        ++m_images.count;
+        m_images.bytes += pyramid->getMemoryUsage();
+    }
+}
+
+void LC_MemoryReport::addFonts()
+{
+    for (const auto& font: *RS_FONTLIST) {
+        RS_BlockList* letters = font->getLetterList();
+        if (letters->count() == 0)
+            continue;
+        ++m_fonts.count;
+        for (int i = 0; i < letters->count(); ++i)
+            m_fonts.bytes += getDeepUsage(*letters->at(i)).bytes;
+    }
+}
+
+void LC_MemoryReport::addPatterns()
+{
+    for (auto it = RS_PATTERNLIST->cbegin(); it != RS_PATTERNLIST->cend(); ++it) {
+        if (it->second == nullptr)
+            continue;
+        ++m_patterns.count;
+        // patterns are shared read-only, their entities are never created on demand
+        auto& pattern = const_cast<RS_Pattern&>(*it->second);
+        m_patterns.bytes += getDeepUsage(pattern).bytes;
+    }
+}
+
+std::size_t LC_MemoryReport::getDrawingBytes() const
+{
+    return getTotal(m_entities).bytes + getTotal(m_generated).bytes;
+}
+
+QStringList LC_MemoryReport::toText() const
+{
+    auto kib = [](std::size_t bytes) {
+        return QString::number(bytes / 1024.0, 'f', 1);
+    };
+    QStringList lines;
+    const Usage entities = getTotal(m_entities);
+    lines << QObject::tr("Entities: %1 entities, %2 KiB").arg(entities.count).arg(kib(entities.bytes));
+    for (const auto& [type, usage]: m_entities)
+        lines << formatUsage(type, usage);
+    const Usage generated = getTotal(m_generated);
+    lines << QObject::tr("Generated geometry: %1 entities, %2 KiB").arg(generated.count).arg(kib(generated.bytes));
+    for (const auto& [kind, usage]: m_generated)
+        lines << formatUsage(kind, usage);
+    lines << QObject::tr("Undo history: %1 deleted entities, %2 KiB, estimated for all cycles %3 KiB")
+             .arg(m_undo.count).arg(kib(m_undo.bytes)).arg(kib(m_undoEstimate));
+    lines << QObject::tr("Images: %1 files, %2 KiB decoded").arg(m_images.count).arg(kib(m_images.bytes));
+    lines << QObject::tr("Fonts (shared): %1 loaded, %2 KiB").arg(m_fonts.count).arg(kib(m_fonts.bytes));
+    lines << QObject::tr("Patterns (shared): %1 loaded, %2 KiB").arg(m_patterns.count).arg(kib(m_patterns.bytes));
+    return lines;
+}
+
+QJsonObject LC_MemoryReport::toJson() const
+{
+    QJsonObject report;
+    report["entities"] = ::toJson(m_entities);
+    report["generated"] = ::toJson(m_generated);
+    QJsonObject undo = ::toJson(m_undo);
+    undo["estimated_bytes"] = qint64(m_undoEstimate);
+    report["undo"] = undo;
+    report["images"] = ::toJson(m_images);
+    report["fonts"] = ::toJson(m_fonts);
+    report["patterns"] = ::toJson(m_patterns);
+    return report;
+}
@@ -0,0 +1,87 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_MEMORYREPORT_H
+#define LC_MEMORYREPORT_H
+
+#include <cstddef>
+#include <map>
+#include <set>
+
+#include <QJsonObject>
+#include <QStringList>
+
+class LC_ImagePyramid;
+class RS_Entity;
+class RS_EntityContainer;
+class RS_Graphic;
+
+/**
+ * @brief The LC_MemoryReport class, the approximate memory used by a drawing: the
+ * entities by type, the geometry generated from entities (texts, hatch patterns,
+ * inserts, dimensions and splines), the entities kept by the undo history, decoded
+ * images, and the loaded fonts and patterns, which are shared by all drawings.
+ * Sizes are estimated from the sizes of the entity classes and their point lists,
+ * allocation overheads are not included.
+ */
+class LC_MemoryReport {
+public:
+    struct Usage {
+        std::size_t count = 0;
+        std::size_t bytes = 0;
+
+        Usage& operator += (const Usage& other);
+    };
+
+    explicit LC_MemoryReport(RS_Graphic& graphic);
+
+    //! @return the estimated bytes of the entities and their generated geometry
+    std::size_t getDrawingBytes() const;
+    //! the report as lines of text
+    QStringList toText() const;
+    QJsonObject toJson() const;
+
+private:
+    void addEntity(RS_Entity& entity, const QString& type);
+    void addUserGeometry(RS_EntityContainer& container, Usage& usage);
+    void addImages();
+    void addFonts();
+    void addPatterns();
+
+    //! entities of the drawing and its blocks by type, with their user sub-entities
+    std::map<QString, Usage> m_entities;
+    //! generated entities by the kind of the generating entity
+    std::map<QString, Usage> m_generated;
+    //! deleted entities, kept for undo
+    Usage m_undo;
+    //! the undo history estimate of RS_Undo
+    std::size_t m_undoEstimate = 0;
+    Usage m_images;
+    Usage m_fonts;
+    Usage m_patterns;
+    std::set<const LC_ImagePyramid*> m_pyramids;
+};
+
+#endif // LC_MEMORYREPORT_H
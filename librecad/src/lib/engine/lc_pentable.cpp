@@ -0,0 +1,130 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+#include <QHash>
+
+#include "lc_pentable.h"
+#include "rs_debug.h"
+#include "rs_pen.h"
+
+namespace {
+// pens are stored in chunks, which are never moved, so they are read without locking
+constexpr unsigned chunkBits = 10;
+constexpr unsigned chunkSize = 1u << chunkBits;
+constexpr unsigned maxChunks = 1u << 16;
+
+using PenKey = std::tuple<unsigned, int, int, double, QRgb, int, unsigned, double, double>;
+
+PenKey getKey(const RS_Pen& pen)
+{
+    const RS_Color color = pen.getColor();
+    return {pen.getFlags(), pen.getLineType(), pen.getWidth(), pen.getScreenWidth(),
+            color.rgba(), color.spec(), color.getFlags(), pen.getAlpha(), pen.dashOffset()};
+}
+
+struct KeyHash {
+    std::size_t operator () (const PenKey& key) const
+    {
+        std::size_t seed = 0;
+        std::apply([&seed](const auto&... values) {
+            ((seed = qHash(values, seed)), ...);
+        }, key);
+        return seed;
+    }
+};
+
+struct Table {
+    Table()
+    {
+        // the default pen has the handle 0
+        add(RS_Pen{});
+    }
+
+    LC_PenTable::Handle add(const RS_Pen& pen)
+    {
+        const unsigned chunk = size >> chunkBits;
+        if (chunks[chunk] == nullptr)
+            chunks[chunk] = new RS_Pen[chunkSize];
+        chunks[chunk][size & (chunkSize - 1)] = pen;
+        handles.emplace(getKey(pen), size);
+        return size++;
+    }
+
+    std::mutex mutex;
+    std::unordered_map<PenKey, LC_PenTable::Handle, KeyHash> handles;
+    std::array<std::atomic<RS_Pen*>, maxChunks> chunks{};
+    std::atomic<unsigned> size{0};
+};
+
+Table& getTable()
+{
+    // never destroyed, entities may be deleted at exit after static destructors
+    static Table* table = new Table;
+    return *table;
+}
+}
+
+LC_PenTable::Handle LC_PenTable::intern(const RS_Pen& pen)
+{
+    Table& table = getTable();
+    const PenKey key = getKey(pen);
+    // entities are mostly created in runs with the same pen
+    thread_local PenKey lastKey = getKey(RS_Pen{});
+    thread_local Handle lastHandle = defaultHandle;
+    if (key == lastKey)
+        return lastHandle;
+
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto it = table.handles.find(key);
+    Handle handle = defaultHandle;
+    if (it != table.handles.end()) {
+        handle = it->second;
+    } else if (table.size < maxChunks * chunkSize) {
+        handle = table.add(pen);
+    } else {
+        LC_ERR << "LC_PenTable::" << __func__ << "(): too many pens";
+        return defaultHandle;
+    }
+    lastKey = key;
+    lastHandle = handle;
+    return handle;
+}
+
+const RS_Pen& LC_PenTable::get(Handle handle)
+{
+    const Table& table = getTable();
+    return table.chunks[handle >> chunkBits].load(std::memory_order_acquire)[handle & (chunkSize - 1)];
+}
+
+unsigned LC_PenTable::count()
+{
+    return getTable().size;
+}
@@ -0,0 +1,65 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_PENTABLE_H
+#define LC_PENTABLE_H
+
+#include <cstdint>
+
+class RS_Pen;
+
+/**
+ * @brief The LC_PenTable class, the table of the unique pens in use. Entities
+ * store the handle of their pen, which is smaller than the pen and compared and
+ * hashed as an integer.
+ *
+ * The table is shared by all documents, as entities are copied between documents
+ * and created before they are added to a document. Pens are never removed; the
+ * pens of a drawing are few compared to its entities.
+ */
+class LC_PenTable {
+public:
+    using Handle = std::uint32_t;
+
+    //! the handle of the default pen, RS_Pen()
+    static constexpr Handle defaultHandle = 0;
+
+    /**
+     * @return the handle of the pen, equal for pens with equal attributes, including
+     * flags, screen width, alpha and dash offset. Thread safe.
+     */
+    static Handle intern(const RS_Pen& pen);
+
+    /**
+     * @return the pen of the handle. The reference stays valid, reading is
+     * thread safe and not locked.
+     */
+    static const RS_Pen& get(Handle handle);
+
+    //! the number of unique pens interned
+    static unsigned count();
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <algorithm>
+#include <utility>
+
+#include "lc_progress.h"
+
+namespace {
+// minimum time between the calls of the callback
+constexpr std::chrono::milliseconds reportInterval{50};
+}
+
+LC_Progress::LC_Progress(Callback callback):
+    m_callback(std::move(callback))
+    ,m_reported(std::chrono::steady_clock::now())
+{
+}
+
+void LC_Progress::start(std::size_t total)
+{
+    m_total = total;
+    m_done = 0;
+    report();
+}
+
+bool LC_Progress::advance(std::size_t steps)
+{
+    if (isCancelled())
+        return false;
+    m_done = std::min(m_done + steps, m_total);
+    if (!m_callback)
+        return true;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - m_reported < reportInterval)
+        return true;
+    m_reported = now;
+    return report();
+}
+
+void LC_Progress::cancel()
+{
+    m_token.cancel();
+}
+
+bool LC_Progress::isCancelled() const
+{
+    return m_token.isCancelled();
+}
+
+const LC_CancelToken* LC_Progress::getCancelToken() const
+{
+    return &m_token;
+}
+
+bool LC_Progress::report()
+{
+    if (isCancelled())
+        return false;
+    const double fraction = m_total == 0 ? 0. : double(m_done) / double(m_total);
+    if (m_callback && !m_callback(fraction))
+        cancel();
+    return !isCancelled();
+}
@@ -0,0 +1,77 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_PROGRESS_H
+#define LC_PROGRESS_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+#include "lc_taskscheduler.h"
+
+/**
+ * @brief The LC_Progress class, progress and cancellation of long running
+ * engine operations, e.g. RS_Modification::explode() of large blocks.
+ *
+ * The operation calls start() with the number of its steps and advance() for
+ * each step done. The callback is called with the done fraction at most every
+ * few milliseconds, as RS_FilterInterface::ProgressCallback it returns false
+ * to cancel the operation. Operations stop at the next advance() returning
+ * false and roll back their changes, e.g. by LC_UndoSection::cancel().
+ *
+ * The callback is called by the thread calling advance(), usually the GUI
+ * thread; parallel work checks getCancelToken() instead.
+ */
+class LC_Progress {
+public:
+    using Callback = std::function<bool(double)>;
+
+    explicit LC_Progress(Callback callback = {});
+
+    //! restarts the progress for the given number of steps
+    void start(std::size_t total);
+    /**
+     * @brief advance counts done steps and reports the progress
+     * @param steps done steps, 0 only checks for cancellation
+     * @return false, if the operation is cancelled
+     */
+    bool advance(std::size_t steps = 1);
+
+    void cancel();
+    bool isCancelled() const;
+    const LC_CancelToken* getCancelToken() const;
+
+private:
+    bool report();
+
+    Callback m_callback;
+    LC_CancelToken m_token;
+    std::size_t m_total = 0;
+    std::size_t m_done = 0;
+    std::chrono::steady_clock::time_point m_reported;
+};
+
+#endif // LC_PROGRESS_H
@@ -275,6 +275,20 @@ Area(coord, {coord.x + width, coord.y + height})
 					upperRightCorner(), upperLeftCorner()}};
 	}
 
+	bool LC_Rect::crossesLine(const Coordinate& p1, const Coordinate& p2) const
+	{
+		const Coordinate direction = Vector(p1, p2);
+		bool below = false;
+		bool above = false;
+		for (const Coordinate& corner: vertices()) {
+			const Coordinate v = Vector(p1, corner);
+			const double side = direction.x * v.y - direction.y * v.x;
+			below = below || side <= 0.;
+			above = above || side >= 0.;
+		}
+		return below && above;
+	}
+
 	std::ostream& operator<<(std::ostream& os, const Area& area) {
 		os << "Area(" << area.minP() << " " << area.maxP() << ")";
 		return os;
@@ -305,5 +319,10 @@ void LC_Rect::unitTest() {
 	INTERT_TEST(!rect0.inArea({1.1, 1.1}))
 	INTERT_TEST(!rect0.inArea({-1.1, -1.1}))
 
+	// crossesLine() tests
+	INTERT_TEST(rect0.crossesLine({-1., 0.5}, {-2., 0.5}))
+	INTERT_TEST(rect0.crossesLine({2., 0.}, {3., -1.}))
+	INTERT_TEST(!rect0.crossesLine({-1., 2.}, {0., 3.}))
+
 }
 
@@ -200,6 +200,13 @@ public:
 	 */
 	std::array<Coordinate, 4> vertices() const;
 
+	/**
+	 * @brief crossesLine whether the infinite line through two points intersects this area
+	 * @param p1, p2 two distinct points of the line
+	 * @return true if the corners of the area are not all on the same side of the line
+	 */
+	bool crossesLine(const Coordinate& p1, const Coordinate& p2) const;
+
 	static void unitTest();
 
 private:
@@ -0,0 +1,112 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
+
+#include "lc_pentable.h"
+#include "lc_rendercache.h"
+#include "rs_entity.h"
+#include "rs_entitycontainer.h"
+#include "rs_layer.h"
+#include "rs_pen.h"
+
+namespace {
+// incremented whenever resolved pens may have changed
+std::atomic<unsigned> g_penGeneration{0};
+
+// resolved pens are dropped beyond this count, as inserts give entries per parent
+constexpr size_t maxPens = 1 << 16;
+}
+
+struct LC_RenderCache::Data {
+    // entity layer, parent cache key and pen handle; the address of a deleted parent
+    // may be taken by a new container, its key is not
+    using Key = std::tuple<const RS_Layer*, unsigned long long, LC_PenTable::Handle>;
+
+    std::shared_mutex mutex;
+    std::map<Key, RS_Pen> pens;
+    // g_penGeneration when the pens were resolved
+    unsigned generation = 0;
+};
+
+LC_RenderCache::LC_RenderCache():
+    m_data{std::make_unique<Data>()}
+{
+}
+
+LC_RenderCache::~LC_RenderCache() = default;
+
+LC_RenderCache::LC_RenderCache(const LC_RenderCache&):
+    m_data{std::make_unique<Data>()}
+{
+}
+
+LC_RenderCache& LC_RenderCache::operator = (const LC_RenderCache& other)
+{
+    if (this != &other)
+        clear();
+    return *this;
+}
+
+RS_Pen LC_RenderCache::getResolvedPen(const RS_Entity& entity) const
+{
+    const RS_EntityContainer* parent = entity.getParent();
+    const Data::Key key{entity.getLayer(true), parent != nullptr ? parent->getCacheKey() : 0,
+                        entity.getPenHandle()};
+    const unsigned generation = g_penGeneration;
+    {
+        std::shared_lock<std::shared_mutex> lock{m_data->mutex};
+        if (m_data->generation == generation) {
+            auto it = m_data->pens.find(key);
+            if (it != m_data->pens.end())
+                return it->second;
+        }
+    }
+
+    RS_Pen pen = entity.getPen(true);
+
+    std::unique_lock<std::shared_mutex> lock{m_data->mutex};
+    if (m_data->generation != generation || m_data->pens.size() >= maxPens) {
+        m_data->pens.clear();
+        m_data->generation = generation;
+    }
+    m_data->pens.emplace(key, pen);
+    return pen;
+}
+
+void LC_RenderCache::clear()
+{
+    std::unique_lock<std::shared_mutex> lock{m_data->mutex};
+    m_data->pens.clear();
+}
+
+void LC_RenderCache::invalidatePens()
+{
+    ++g_penGeneration;
+}
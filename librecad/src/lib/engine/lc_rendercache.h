@@ -0,0 +1,71 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_RENDERCACHE_H
+#define LC_RENDERCACHE_H
+
+#include <memory>
+
+class RS_Entity;
+class RS_Pen;
+
+/**
+ * @brief The LC_RenderCache class, render data derived from a document and shared
+ * by all its views. Views keep the data depending on their transform only, such as
+ * pens scaled to the screen and raster tiles. Flattened splines, spatial indices
+ * and glyph boxes are kept by the entities, containers and fonts already.
+ *
+ * Resolved pens depend on the pens of layers and of parent containers, so they are
+ * dropped whenever one of those changes. Reading and filling is thread safe, views
+ * rendering tiles concurrently share the cache.
+ */
+class LC_RenderCache {
+public:
+    LC_RenderCache();
+    ~LC_RenderCache();
+    // a copied document has its own entities, so it starts with an empty cache
+    LC_RenderCache(const LC_RenderCache&);
+    LC_RenderCache& operator = (const LC_RenderCache&);
+
+    /**
+     * @return the pen of the entity with ByLayer and ByBlock attributes resolved,
+     * as RS_Entity::getPen(true)
+     */
+    RS_Pen getResolvedPen(const RS_Entity& entity) const;
+
+    void clear();
+
+    /**
+     * @brief invalidatePens called when the pen, layer or parent of a layer or a
+     * container changes, drops the resolved pens of all documents
+     */
+    static void invalidatePens();
+
+private:
+    struct Data;
+    std::unique_ptr<Data> m_data;
+};
+
+#endif // LC_RENDERCACHE_H
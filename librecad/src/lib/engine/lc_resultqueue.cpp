@@ -0,0 +1,78 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <utility>
+
+#include "lc_resultqueue.h"
+
+LC_ResultQueue::~LC_ResultQueue()
+{
+    for (Node* node = m_head.exchange(nullptr); node != nullptr;) {
+        Node* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+bool LC_ResultQueue::push(Result result)
+{
+    auto node = new Node{std::move(result)};
+    Node* head = m_head.load(std::memory_order_relaxed);
+    // only pushed on top, and taken all at once by the consumer: no ABA problem.
+    // The node belongs to the consumer once pushed, so the head is kept locally
+    do {
+        node->next = head;
+    } while (!m_head.compare_exchange_weak(head, node, std::memory_order_release,
+                                           std::memory_order_relaxed));
+    return head == nullptr;
+}
+
+bool LC_ResultQueue::apply()
+{
+    Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+    // in the order of pushing
+    Node* first = nullptr;
+    while (node != nullptr) {
+        Node* next = node->next;
+        node->next = first;
+        first = node;
+        node = next;
+    }
+
+    bool redraw = false;
+    while (first != nullptr) {
+        Node* next = first->next;
+        if (first->result())
+            redraw = true;
+        delete first;
+        first = next;
+    }
+    return redraw;
+}
+
+bool LC_ResultQueue::isEmpty() const
+{
+    return m_head.load(std::memory_order_relaxed) == nullptr;
+}
@@ -0,0 +1,76 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_RESULTQUEUE_H
+#define LC_RESULTQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+/**
+ * @brief The LC_ResultQueue class, hands the results of background work over to
+ * the GUI thread in batches, instead of a queued event per result.
+ *
+ * Any thread pushes results without locking. The GUI thread, the only consumer,
+ * takes all pending results at once and applies them in the order they were
+ * pushed. push() returns true for the first result of a batch, the producer then
+ * wakes the consumer once for the whole batch, e.g. by a queued invokeMethod().
+ */
+class LC_ResultQueue {
+public:
+    //! applies a result on the GUI thread, returns true if the view must be redrawn
+    using Result = std::function<bool()>;
+
+    LC_ResultQueue() = default;
+    LC_ResultQueue(const LC_ResultQueue&) = delete;
+    LC_ResultQueue& operator = (const LC_ResultQueue&) = delete;
+    //! drops the pending results
+    ~LC_ResultQueue();
+
+    /**
+     * @brief push adds a result, from any thread
+     * @return true, if the queue was empty: the consumer must be woken
+     */
+    bool push(Result result);
+    /**
+     * @brief apply applies the pending results, by the consumer thread only.
+     * Results pushed meanwhile are left for the next batch.
+     * @return true, if any of the results requested a redraw
+     */
+    bool apply();
+    bool isEmpty() const;
+
+private:
+    struct Node {
+        Result result;
+        Node* next = nullptr;
+    };
+
+    // the results pushed last first
+    std::atomic<Node*> m_head{nullptr};
+};
+
+#endif // LC_RESULTQUEUE_H
@@ -0,0 +1,163 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_SHAREDVECTOR_H
+#define LC_SHAREDVECTOR_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <QSharedData>
+#include <QSharedDataPointer>
+
+/**
+ * @brief The LC_SharedVector class, a std::vector shared by its copies until one of
+ * them is changed, as the implicitly shared Qt containers. Copies of entities, as
+ * previews, clipboard contents and block instances, share their geometry this way
+ * while they're only read.
+ *
+ * Reading through a const vector never copies the elements; non-const access,
+ * like non-const iterators, at() or operator[], copies them first if they're
+ * shared, so read only code should use const references. Vectors owned by
+ * different threads may share elements, a single vector isn't thread safe.
+ */
+template <typename T>
+class LC_SharedVector {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+    using reference = T&;
+    using const_reference = const T&;
+
+    LC_SharedVector() = default;
+    LC_SharedVector(std::vector<T> values)
+    {
+        if (!values.empty())
+            edit() = std::move(values);
+    }
+    LC_SharedVector& operator = (std::vector<T> values)
+    {
+        if (values.empty())
+            m_data.reset();
+        else
+            edit() = std::move(values);
+        return *this;
+    }
+
+    //! \{ the elements, copied before changes if they're shared
+    const std::vector<T>& get() const
+    {
+        return m_data ? m_data->values : emptyValues();
+    }
+    std::vector<T>& edit()
+    {
+        if (!m_data)
+            m_data = new Payload;
+        return m_data->values;
+    }
+    operator const std::vector<T>& () const
+    {
+        return get();
+    }
+    operator std::vector<T>& ()
+    {
+        return edit();
+    }
+    //! \}
+
+    //! \{ read access
+    size_type size() const {return get().size();}
+    bool empty() const {return get().empty();}
+    const T& at(size_type i) const {return get().at(i);}
+    const T& operator [] (size_type i) const {return get()[i];}
+    const T& front() const {return get().front();}
+    const T& back() const {return get().back();}
+    const T* data() const {return get().data();}
+    const_iterator begin() const {return get().begin();}
+    const_iterator end() const {return get().end();}
+    const_iterator cbegin() const {return get().cbegin();}
+    const_iterator cend() const {return get().cend();}
+    //! \}
+
+    //! \{ write access
+    T& at(size_type i) {return edit().at(i);}
+    T& operator [] (size_type i) {return edit()[i];}
+    T& front() {return edit().front();}
+    T& back() {return edit().back();}
+    T* data() {return edit().data();}
+    iterator begin() {return edit().begin();}
+    iterator end() {return edit().end();}
+    void push_back(const T& value) {edit().push_back(value);}
+    void push_back(T&& value) {edit().push_back(std::move(value));}
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {return edit().emplace_back(std::forward<Args>(args)...);}
+    void pop_back() {edit().pop_back();}
+    template <typename... Args>
+    iterator insert(Args&&... args) {return edit().insert(std::forward<Args>(args)...);}
+    template <typename... Args>
+    iterator erase(Args&&... args) {return edit().erase(std::forward<Args>(args)...);}
+    void reserve(size_type count) {edit().reserve(count);}
+    void resize(size_type count) {edit().resize(count);}
+    void resize(size_type count, const T& value) {edit().resize(count, value);}
+    //! drops the elements, without copying shared ones
+    void clear() {m_data.reset();}
+    void swap(LC_SharedVector& other) noexcept {m_data.swap(other.m_data);}
+    //! \}
+
+    friend bool operator == (const LC_SharedVector& a, const LC_SharedVector& b)
+    {
+        return a.m_data == b.m_data || a.get() == b.get();
+    }
+    friend bool operator == (const LC_SharedVector& a, const std::vector<T>& b)
+    {
+        return a.get() == b;
+    }
+    friend bool operator == (const std::vector<T>& a, const LC_SharedVector& b)
+    {
+        return a == b.get();
+    }
+    friend bool operator != (const LC_SharedVector& a, const LC_SharedVector& b)
+    {
+        return !(a == b);
+    }
+
+private:
+    struct Payload : public QSharedData {
+        std::vector<T> values;
+    };
+
+    static const std::vector<T>& emptyValues()
+    {
+        static const std::vector<T> values;
+        return values;
+    }
+
+    QSharedDataPointer<Payload> m_data;
+};
+
+#endif // LC_SHAREDVECTOR_H
@@ -0,0 +1,337 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include "lc_spatialindex.h"
+#include "rs.h"
+#include "rs_ellipse.h"
+#include "rs_entitycontainer.h"
+#include "rs_vector.h"
+
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+
+namespace {
+
+using Point = bg::model::point<double, 2, bg::cs::cartesian>;
+using Box = bg::model::box<Point>;
+using Value = std::pair<Box, RS_Entity*>;
+using RTree = bgi::rtree<Value, bgi::rstar<16>>;
+
+// Bounding boxes are considered valid only within this range, entities with larger
+// bounding boxes are treated as unbounded
+constexpr double maxBorder = RS_MAXDOUBLE;
+
+bool isBounded(const RS_Vector& minV, const RS_Vector& maxV)
+{
+    return minV.valid && maxV.valid
+            && minV.x <= maxV.x && minV.y <= maxV.y
+            && minV.x >= - maxBorder && minV.y >= - maxBorder
+            && maxV.x <= maxBorder && maxV.y <= maxBorder;
+}
+
+Box toBox(const RS_Vector& minV, const RS_Vector& maxV)
+{
+    return {{minV.x, minV.y}, {maxV.x, maxV.y}};
+}
+
+/**
+ * Extends the borders to the centers of the entity and its sub-entities. Instanced
+ * inserts have no sub-entities yet, their borders are used.
+ */
+void extendToCenters(const RS_Entity& entity, RS_Vector& minV, RS_Vector& maxV)
+{
+    const auto extend = [&minV, &maxV](const RS_Vector& point) {
+        if (point.valid) {
+            minV = RS_Vector::minimum(minV, point);
+            maxV = RS_Vector::maximum(maxV, point);
+        }
+    };
+    if (entity.isContainer()) {
+        for (RS_Entity* e: static_cast<const RS_EntityContainer&>(entity))
+            extendToCenters(*e, minV, maxV);
+        return;
+    }
+    extend(entity.getCenter());
+    if (entity.rtti() == RS2::EntityEllipse) {
+        for (const RS_Vector& focus: static_cast<const RS_Ellipse&>(entity).getFoci())
+            extend(focus);
+    }
+}
+
+bool isSameBox(const Box& a, const Box& b)
+{
+    return bg::get<bg::min_corner, 0>(a) == bg::get<bg::min_corner, 0>(b)
+            && bg::get<bg::min_corner, 1>(a) == bg::get<bg::min_corner, 1>(b)
+            && bg::get<bg::max_corner, 0>(a) == bg::get<bg::max_corner, 0>(b)
+            && bg::get<bg::max_corner, 1>(a) == bg::get<bg::max_corner, 1>(b);
+}
+}
+
+struct LC_SpatialIndex::Impl {
+    struct Record {
+        Box box;
+        Box centerBox;
+        double order = 0.;
+        bool bounded = false;
+        bool centerBounded = false;
+    };
+
+    void insert(RS_Entity* entity, Record& record)
+    {
+        RS_Vector minV = entity->getMin();
+        RS_Vector maxV = entity->getMax();
+        record.bounded = isBounded(minV, maxV);
+        if (record.bounded) {
+            record.box = toBox(minV, maxV);
+            tree.insert({record.box, entity});
+        } else {
+            unbounded.insert(entity);
+        }
+
+        extendToCenters(*entity, minV, maxV);
+        record.centerBounded = record.bounded && isBounded(minV, maxV);
+        if (record.centerBounded) {
+            record.centerBox = toBox(minV, maxV);
+            centerTree.insert({record.centerBox, entity});
+        } else {
+            centerUnbounded.insert(entity);
+        }
+    }
+
+    void erase(RS_Entity* entity, const Record& record)
+    {
+        if (record.bounded)
+            tree.remove(Value{record.box, entity});
+        else
+            unbounded.erase(entity);
+        if (record.centerBounded)
+            centerTree.remove(Value{record.centerBox, entity});
+        else
+            centerUnbounded.erase(entity);
+    }
+
+    void visitNearest(const RTree& boxes, const std::unordered_set<RS_Entity*>& others,
+                      const RS_Vector& point, const NearestVisitor& visitor) const
+    {
+        for (RS_Entity* entity: others) {
+            if (!visitor(entity, records.at(entity).order, 0.))
+                return;
+        }
+
+        if (boxes.empty())
+            return;
+
+        // the nearest query iterator is incremental
+        const Point target{point.x, point.y};
+        for (auto it = boxes.qbegin(bgi::nearest(target, unsigned(boxes.size()))); it != boxes.qend(); ++it) {
+            if (!visitor(it->second, records.at(it->second).order, bg::distance(target, it->first)))
+                return;
+        }
+    }
+
+    RTree tree;
+    RTree centerTree;
+    std::unordered_map<const RS_Entity*, Record> records;
+    std::unordered_set<RS_Entity*> unbounded;
+    std::unordered_set<RS_Entity*> centerUnbounded;
+    double minOrder = 0.;
+    double maxOrder = 0.;
+};
+
+LC_SpatialIndex::LC_SpatialIndex():
+    m_pImpl{std::make_unique<Impl>()}
+{}
+
+LC_SpatialIndex::~LC_SpatialIndex() = default;
+
+void LC_SpatialIndex::insert(RS_Entity* entity, double order)
+{
+    if (entity == nullptr)
+        return;
+    remove(entity);
+    auto& record = m_pImpl->records[entity];
+    record.order = order;
+    m_pImpl->insert(entity, record);
+    if (m_pImpl->records.size() == 1) {
+        m_pImpl->minOrder = order;
+        m_pImpl->maxOrder = order;
+    } else {
+        m_pImpl->minOrder = std::min(m_pImpl->minOrder, order);
+        m_pImpl->maxOrder = std::max(m_pImpl->maxOrder, order);
+    }
+}
+
+bool LC_SpatialIndex::remove(RS_Entity* entity)
+{
+    auto it = m_pImpl->records.find(entity);
+    if (it == m_pImpl->records.end())
+        return false;
+    m_pImpl->erase(entity, it->second);
+    m_pImpl->records.erase(it);
+    return true;
+}
+
+bool LC_SpatialIndex::update(RS_Entity* entity)
+{
+    auto it = m_pImpl->records.find(entity);
+    if (it == m_pImpl->records.end())
+        return false;
+    Impl::Record& record = it->second;
+    RS_Vector minV = entity->getMin();
+    RS_Vector maxV = entity->getMax();
+    const bool bounded = isBounded(minV, maxV);
+    extendToCenters(*entity, minV, maxV);
+    const bool centerBounded = bounded && isBounded(minV, maxV);
+    if (bounded == record.bounded && (!bounded || isSameBox(record.box, toBox(entity->getMin(), entity->getMax())))
+            && centerBounded == record.centerBounded
+            && (!centerBounded || isSameBox(record.centerBox, toBox(minV, maxV))))
+        return false;
+    m_pImpl->erase(entity, record);
+    m_pImpl->insert(entity, record);
+    return true;
+}
+
+void LC_SpatialIndex::renumber(const std::vector<RS_Entity*>& entities)
+{
+    double order = 0.;
+    for (RS_Entity* entity: entities) {
+        auto it = m_pImpl->records.find(entity);
+        if (it != m_pImpl->records.end())
+            it->second.order = order;
+        order += 1.;
+    }
+    m_pImpl->minOrder = 0.;
+    m_pImpl->maxOrder = std::max(0., order - 1.);
+}
+
+void LC_SpatialIndex::clear()
+{
+    m_pImpl = std::make_unique<Impl>();
+}
+
+bool LC_SpatialIndex::contains(const RS_Entity* entity) const
+{
+    return m_pImpl->records.count(entity) == 1;
+}
+
+std::size_t LC_SpatialIndex::size() const
+{
+    return m_pImpl->records.size();
+}
+
+double LC_SpatialIndex::order(const RS_Entity* entity) const
+{
+    auto it = m_pImpl->records.find(entity);
+    return (it != m_pImpl->records.end()) ? it->second.order : 0.;
+}
+
+double LC_SpatialIndex::minOrder() const
+{
+    return m_pImpl->minOrder;
+}
+
+double LC_SpatialIndex::maxOrder() const
+{
+    return m_pImpl->maxOrder;
+}
+
+std::vector<RS_Entity*> LC_SpatialIndex::query(const LC_Rect& area) const
+{
+    std::vector<Value> values;
+    m_pImpl->tree.query(bgi::intersects(toBox(area.minP(), area.maxP())),
+                        std::back_inserter(values));
+
+    std::vector<std::pair<double, RS_Entity*>> found;
+    found.reserve(values.size());
+    for (const Value& value: values)
+        found.emplace_back(m_pImpl->records.at(value.second).order, value.second);
+
+    for (RS_Entity* entity: m_pImpl->unbounded)
+        found.emplace_back(m_pImpl->records.at(entity).order, entity);
+
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    std::vector<RS_Entity*> ret;
+    ret.reserve(found.size());
+    std::transform(found.cbegin(), found.cend(), std::back_inserter(ret), [](const auto& item) {
+        return item.second;
+    });
+    return ret;
+}
+
+void LC_SpatialIndex::visitNearest(const RS_Vector& point, const NearestVisitor& visitor) const
+{
+    m_pImpl->visitNearest(m_pImpl->tree, m_pImpl->unbounded, point, visitor);
+}
+
+void LC_SpatialIndex::visitNearestCenters(const RS_Vector& point, const NearestVisitor& visitor) const
+{
+    m_pImpl->visitNearest(m_pImpl->centerTree, m_pImpl->centerUnbounded, point, visitor);
+}
+
+bool LC_SpatialIndex::getExtents(const Filter& filter, LC_Rect& extents) const
+{
+    const RTree& tree = m_pImpl->tree;
+    if (tree.empty())
+        return false;
+
+    const Box bounds = tree.bounds();
+    const double left = bg::get<bg::min_corner, 0>(bounds);
+    const double bottom = bg::get<bg::min_corner, 1>(bounds);
+    const double right = bg::get<bg::max_corner, 0>(bounds);
+    const double top = bg::get<bg::max_corner, 1>(bounds);
+    // the distance from a side of the bounds to a box is the distance to its side
+    const auto nearestBox = [&tree, &filter](const Box& side, Box& found) {
+        for (auto it = tree.qbegin(bgi::nearest(side, unsigned(tree.size()))); it != tree.qend(); ++it) {
+            if (filter(it->second)) {
+                found = it->first;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    Box box;
+    if (!nearestBox(Box{{left, bottom}, {left, top}}, box))
+        return false;
+    const double minX = bg::get<bg::min_corner, 0>(box);
+    nearestBox(Box{{right, bottom}, {right, top}}, box);
+    const double maxX = bg::get<bg::max_corner, 0>(box);
+    nearestBox(Box{{left, bottom}, {right, bottom}}, box);
+    const double minY = bg::get<bg::min_corner, 1>(box);
+    nearestBox(Box{{left, top}, {right, top}}, box);
+    const double maxY = bg::get<bg::max_corner, 1>(box);
+    extents = LC_Rect{RS_Vector{minX, minY}, RS_Vector{maxX, maxY}};
+    return true;
+}
@@ -0,0 +1,148 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_SPATIALINDEX_H
+#define LC_SPATIALINDEX_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "lc_rect.h"
+
+class RS_Entity;
+class RS_Vector;
+
+/**
+ * @brief The LC_SpatialIndex class, a 2D R-tree of entity bounding boxes.
+ *
+ * The index is owned by an RS_EntityContainer, and kept up to date by the container
+ * on entity additions, removals and bounding box changes. Each entity is stored with
+ * an order key, which follows the position of the entity in the container, so query
+ * results can be returned in drawing order.
+ *
+ * Entities without a valid bounding box (borders not calculated yet, or
+ * unbounded/corrupted borders) are not stored in the tree, but are always returned
+ * by queries, so the results are conservative.
+ *
+ * The snap points of an entity (endpoints, middle points, centers) are bounded by its
+ * bounding box extended to its centers, kept in a second tree, so point snapping
+ * visits the entities nearest to the mouse only.
+ */
+class LC_SpatialIndex {
+public:
+    /**
+     * @brief NearestVisitor visitor for nearest neighbor queries
+     * @param entity - the entity visited
+     * @param order - the order key of the entity
+     * @param boxDistance - the distance from the query point to the entity bounding box
+     * @return false to stop visiting
+     */
+    using NearestVisitor = std::function<bool(RS_Entity* entity, double order, double boxDistance)>;
+
+    LC_SpatialIndex();
+    ~LC_SpatialIndex();
+
+    /**
+     * @brief insert an entity with the given order key. The current bounding box
+     * of the entity is used.
+     */
+    void insert(RS_Entity* entity, double order);
+
+    /**
+     * @brief remove an entity from the index
+     * @return true, if the entity was in the index
+     */
+    bool remove(RS_Entity* entity);
+
+    /**
+     * @brief update re-read the bounding box of an indexed entity
+     * @return true, if the stored bounding box was changed
+     */
+    bool update(RS_Entity* entity);
+
+    /**
+     * @brief renumber reset order keys of all indexed entities by the given order
+     * @param entities - entities in the container order
+     */
+    void renumber(const std::vector<RS_Entity*>& entities);
+
+    void clear();
+
+    bool contains(const RS_Entity* entity) const;
+    std::size_t size() const;
+
+    /**
+     * @brief order the order key of an indexed entity
+     * @return the order key, 0. if the entity is not indexed
+     */
+    double order(const RS_Entity* entity) const;
+    //! \{ the lowest and the highest order keys
+    double minOrder() const;
+    double maxOrder() const;
+    //! \}
+
+    /**
+     * @brief query find entities with bounding boxes intersecting the area
+     * @param area - the area to query
+     * @return entities sorted by order keys
+     */
+    std::vector<RS_Entity*> query(const LC_Rect& area) const;
+
+    /**
+     * @brief visitNearest visit entities by increasing distances from the point to
+     * their bounding boxes. Entities are visited lazily, so the visitor can stop
+     * the search early. Unbounded entities are visited first with zero distances.
+     * @param point - the query point
+     * @param visitor - the visitor, returns false to stop visiting
+     */
+    void visitNearest(const RS_Vector& point, const NearestVisitor& visitor) const;
+
+    /**
+     * @brief visitNearestCenters visit entities like visitNearest(), by the distances
+     * to their bounding boxes extended to their centers, as the centers of arcs and the
+     * foci of ellipses may be out of the bounding boxes.
+     */
+    void visitNearestCenters(const RS_Vector& point, const NearestVisitor& visitor) const;
+
+    /**
+     * @brief Filter accepts entities for getExtents()
+     */
+    using Filter = std::function<bool(const RS_Entity* entity)>;
+
+    /**
+     * @brief getExtents the bounding box of the entities accepted by the filter. Each side
+     * is found by the nearest entities to that side of the tree bounds, so only the entities
+     * rejected near the sides are visited. Unbounded entities are ignored.
+     * @param extents - the bounding box found
+     * @return false, if no bounded entity is accepted
+     */
+    bool getExtents(const Filter& filter, LC_Rect& extents) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_pImpl;
+};
+
+#endif // LC_SPATIALINDEX_H
@@ -21,6 +21,10 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 **********************************************************************/
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+
 #include <QPainterPath>
 #include <QPolygonF>
 #include "lc_splinepoints.h"
@@ -205,8 +209,7 @@ double GetQuadPointAtDist(const RS_Vector& x1, const RS_Vector& c1, const RS_Vec
 	double dRes = RS_MAXDOUBLE;
     double a0, a1, a2/*, a3, a4*/;
 
-	std::vector<double> dCoefs(0, 0.);
-	std::vector<double> dSol(0, 0.);
+	RS_Math::Roots dSol;
 
 	if(dDet > RS_TOLERANCE)
 	{
@@ -217,11 +220,7 @@ double GetQuadPointAtDist(const RS_Vector& x1, const RS_Vector& c1, const RS_Vec
         //LenInt(v2) = 2.0*dx1*std::sqrt(dx1)*dDist/dDet + LenInt(v1);
         double dB = 2.0*dx1*std::sqrt(dx1)*dDist/dDet + LenInt(v1);
 
-		dCoefs.push_back(0.0);
-		dCoefs.push_back(0.0);
-		dCoefs.push_back(2.0*dB);
-		dCoefs.push_back(-dB*dB);
-		dSol = RS_Math::quarticSolver(dCoefs);
+		dSol = RS_Math::quarticSolver(std::array<double, 4>{0.0, 0.0, 2.0*dB, -dB*dB});
 
 		dRes = t1;
 		a1 = 0;
@@ -263,9 +262,7 @@ double GetQuadPointAtDist(const RS_Vector& x1, const RS_Vector& c1, const RS_Vec
 			a1 = dx12/dx2;
 			a2 = -dDist - a0*t1*t1 - a1*t1;
 
-			dCoefs.push_back(a1/a0);
-			dCoefs.push_back(a2/a0);
-			dSol = RS_Math::quadraticSolver(dCoefs);
+			dSol = RS_Math::quadraticSolver(std::array<double, 2>{a1/a0, a2/a0});
 
 			if(dSol.size() > 0)
 			{
@@ -359,6 +356,18 @@ double GetDistToQuadAtPointSquared(const RS_Vector& coord, const RS_Vector& x1,
 }
 
 // returns true if the new distance was smaller than previous one
+// splines with fewer control points are searched segment by segment
+constexpr size_t segmentTreeMinPoints = 32;
+// the number of segments in the leaves of the segment tree
+constexpr int segmentTreeLeafSize = 8;
+
+double GetDistToBoxSquared(const RS_Vector& coord, const RS_Vector& minV, const RS_Vector& maxV)
+{
+	const double dx = std::max({minV.x - coord.x, 0., coord.x - maxV.x});
+	const double dy = std::max({minV.y - coord.y, 0., coord.y - maxV.y});
+	return dx*dx + dy*dy;
+}
+
 bool SetNewDist(bool bResSet, double dNewDist, double dNewT,
 	double *pdDist, double *pdt)
 {
@@ -395,21 +404,15 @@ double GetDistToQuadSquared(const RS_Vector& coord, const RS_Vector& x1,
 		(x1.y - coord.y)*(x2.y - 2.0*c1.y + x1.y);
 	a4 = (x1.x - coord.x)*(c1.x - x1.x) + (x1.y - coord.y)*(c1.y - x1.y);
 
-	std::vector<double> dCoefs(0, 0.);
-	std::vector<double> dSol(0, 0.);
+	RS_Math::Roots dSol;
 
     if(std::abs(a1) > RS_TOLERANCE) // solve as cubic
 	{
-		dCoefs.push_back(a2/a1);
-		dCoefs.push_back(a3/a1);
-		dCoefs.push_back(a4/a1);
-		dSol = RS_Math::cubicSolver(dCoefs);
+		dSol = RS_Math::cubicSolver(std::array<double, 3>{a2/a1, a3/a1, a4/a1});
 	}
     else if(std::abs(a2) > RS_TOLERANCE) // solve as quadratic
 	{
-		dCoefs.push_back(a3/a2);
-		dCoefs.push_back(a4/a2);
-		dSol = RS_Math::quadraticSolver(dCoefs);
+		dSol = RS_Math::quadraticSolver(std::array<double, 2>{a3/a2, a4/a2});
 	}
     else if(std::abs(a3) > RS_TOLERANCE) // solve as linear
 	{
@@ -475,15 +478,11 @@ void AddQuadTangentPoints(RS_VectorSolutions *pVS, const RS_Vector& point,
 	double a2 = vx3.x*vx1.y - vx3.y*vx1.x;
 	double a3 = vx3.x*vx2.y - vx3.y*vx2.x;
 
-	std::vector<double> dSol(0, 0.);
+	RS_Math::Roots dSol;
 
     if(std::abs(a1) > RS_TOLERANCE)
 	{
-		std::vector<double> dCoefs(0, 0.);
-
-		dCoefs.push_back(a2/a1);
-		dCoefs.push_back(a3/a1);
-		dSol = RS_Math::quadraticSolver(dCoefs);
+		dSol = RS_Math::quadraticSolver(std::array<double, 2>{a2/a1, a3/a1});
 
 	}
     else if(std::abs(a2) > RS_TOLERANCE)
@@ -515,15 +514,11 @@ void addLineQuadIntersect(RS_VectorSolutions *pVS,
 	double a2 = 2.0*(x2.x*x4.y - x2.y*x4.x);
 	double a3 = x3.x*x4.y - x3.y*x4.x;
 
-	std::vector<double> dSol(0, 0.);
+	RS_Math::Roots dSol;
 
     if(std::abs(a1) > RS_TOLERANCE)
 	{
-		std::vector<double> dCoefs(0, 0.);
-
-		dCoefs.push_back(a2/a1);
-		dCoefs.push_back(a3/a1);
-		dSol = RS_Math::quadraticSolver(dCoefs);
+		dSol = RS_Math::quadraticSolver(std::array<double, 2>{a2/a1, a3/a1});
 
 	}
     else if(std::abs(a2) > RS_TOLERANCE)
@@ -815,6 +810,148 @@ int LC_SplinePoints::GetQuadPoints(int iSeg, RS_Vector *pvStart, RS_Vector *pvCo
 	return 3;
 }
 
+/**
+ * Bounding boxes of the quadratic segments, and a binary tree of the boxes of
+ * ranges of consecutive segments, which are compact as consecutive segments are
+ * close to each other. A segment is inside the triangle of its start, control
+ * and end points, so their box bounds it.
+ */
+struct LC_SplinePoints::SegmentTree
+{
+	struct Node
+	{
+		RS_Vector minV;
+		RS_Vector maxV;
+		// the range of segments, as indices to segments
+		int first = 0;
+		int last = 0;
+		// the child nodes, -1 for leaves
+		int left = -1;
+		int right = -1;
+	};
+
+	// the control points the tree is built for: the tree is rebuilt when they change,
+	// comparing them is much cheaper than solving the segments
+	std::vector<RS_Vector> controlPoints;
+	bool closed = false;
+	// the boxes of segments 1, 2, ...
+	std::vector<std::pair<RS_Vector, RS_Vector>> segments;
+	// the root first
+	std::vector<Node> nodes;
+
+	int build(int first, int last)
+	{
+		const int index = static_cast<int>(nodes.size());
+		nodes.emplace_back();
+		RS_Vector minV = segments[first].first;
+		RS_Vector maxV = segments[first].second;
+		for (int i = first + 1; i < last; ++i)
+		{
+			minV = RS_Vector::minimum(minV, segments[i].first);
+			maxV = RS_Vector::maximum(maxV, segments[i].second);
+		}
+		int left = -1;
+		int right = -1;
+		if (last - first > segmentTreeLeafSize)
+		{
+			const int middle = (first + last)/2;
+			left = build(first, middle);
+			right = build(middle, last);
+		}
+		nodes[index] = {minV, maxV, first, last, left, right};
+		return index;
+	}
+};
+
+std::shared_ptr<const LC_SplinePoints::SegmentTree> LC_SplinePoints::GetSegmentTree() const
+{
+	const size_t n = data.controlPoints.size();
+	std::shared_ptr<const SegmentTree> tree = std::atomic_load(&m_segmentTree);
+	if (tree != nullptr && tree->closed == data.closed && tree->controlPoints == data.controlPoints)
+		return tree;
+
+	auto built = std::make_shared<SegmentTree>();
+	built->controlPoints = data.controlPoints;
+	built->closed = data.closed;
+	const int nSegments = static_cast<int>(data.closed ? n : n - 2);
+	built->segments.reserve(nSegments);
+	RS_Vector vStart(false), vControl(false), vEnd(false);
+	for (int iSeg = 1; iSeg <= nSegments; ++iSeg)
+	{
+		GetQuadPoints(iSeg, &vStart, &vControl, &vEnd);
+		built->segments.emplace_back(
+			RS_Vector::minimum(RS_Vector::minimum(vStart, vControl), vEnd),
+			RS_Vector::maximum(RS_Vector::maximum(vStart, vControl), vEnd));
+	}
+	built->build(0, nSegments);
+
+	tree = built;
+	std::atomic_store(&m_segmentTree, tree);
+	return tree;
+}
+
+// the same as GetNearestQuad() for splines with many control points: the segments
+// are solved only if their boxes may be nearer than the nearest segment found yet
+int LC_SplinePoints::GetNearestQuadIndexed(const RS_Vector& coord,
+	double* dist, double* dt) const
+{
+	const std::shared_ptr<const SegmentTree> tree = GetSegmentTree();
+	const std::vector<SegmentTree::Node>& nodes = tree->nodes;
+
+	RS_Vector vStart(false), vControl(false), vEnd(false);
+	double dDist = RS_MAXDOUBLE, dNewDist = 0.;
+	double dRes = 0., dNewRes;
+	int iRes = -1;
+
+	std::vector<int> stack{0};
+	while (!stack.empty())
+	{
+		const SegmentTree::Node& node = nodes[stack.back()];
+		stack.pop_back();
+		if (GetDistToBoxSquared(coord, node.minV, node.maxV) > dDist) continue;
+
+		if (node.left >= 0)
+		{
+			// the nearer child is searched first
+			const SegmentTree::Node& left = nodes[node.left];
+			const SegmentTree::Node& right = nodes[node.right];
+			if (GetDistToBoxSquared(coord, left.minV, left.maxV)
+				< GetDistToBoxSquared(coord, right.minV, right.maxV))
+			{
+				stack.push_back(node.right);
+				stack.push_back(node.left);
+			}
+			else
+			{
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+			continue;
+		}
+
+		for (int i = node.first; i < node.last; ++i)
+		{
+			const auto& box = tree->segments[i];
+			if (GetDistToBoxSquared(coord, box.first, box.second) > dDist) continue;
+
+			const int iSeg = i + 1;
+			GetQuadPoints(iSeg, &vStart, &vControl, &vEnd);
+			dNewRes = GetDistToQuadSquared(coord, vStart, vControl, vEnd, &dNewDist);
+			// as the segments are searched in order, the first nearest one is kept
+			if (iRes < 0 || dNewDist < dDist || (dNewDist == dDist && iSeg < iRes))
+			{
+				dDist = dNewDist;
+				dRes = dNewRes;
+				iRes = iSeg;
+			}
+		}
+	}
+
+	*dt = dRes;
+	if(dist) *dist = std::sqrt(dDist);
+	return iRes;
+}
+
 // returns the index to the nearest segment, dt holds the t parameter
 // we will make an extrodrinary exception here and make the index 1-based
 // return values:
@@ -825,6 +962,8 @@ int LC_SplinePoints::GetNearestQuad(const RS_Vector& coord,
 	double* dist, double* dt) const
 {
 	size_t n = data.controlPoints.size();
+	if (n >= segmentTreeMinPoints)
+		return GetNearestQuadIndexed(coord, dist, dt);
 
 	RS_Vector vStart(false), vControl(false), vEnd(false), vRes(false);
 
@@ -1110,12 +1249,8 @@ printf("getNearestDist\n");
 
 void LC_SplinePoints::move(const RS_Vector& offset)
 {
-	for(auto & v: data.splinePoints){
-		v.move(offset);
-	}
-	for(auto& v: data.controlPoints){
-		v.move(offset);
-	}
+	RS_Vector::move(data.splinePoints, offset);
+	RS_Vector::move(data.controlPoints, offset);
 	update();
 }
 
@@ -1126,45 +1261,29 @@ void LC_SplinePoints::rotate(const RS_Vector& center, const double& angle)
 
 void LC_SplinePoints::rotate(const RS_Vector& center, const RS_Vector& angleVector)
 {
-	for(auto & v: data.splinePoints){
-		v.rotate(center, angleVector);
-	}
-	for(auto& v: data.controlPoints){
-		v.rotate(center, angleVector);
-	}
+	RS_Vector::rotate(data.splinePoints, center, angleVector);
+	RS_Vector::rotate(data.controlPoints, center, angleVector);
 	update();
 }
 
 void LC_SplinePoints::scale(const RS_Vector& center, const RS_Vector& factor)
 {
-	for(auto & v: data.splinePoints){
-		v.scale(center, factor);
-	}
-	for(auto& v: data.controlPoints){
-		v.scale(center, factor);
-	}
+	RS_Vector::scale(data.splinePoints, center, factor);
+	RS_Vector::scale(data.controlPoints, center, factor);
 	update();
 }
 
 void LC_SplinePoints::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
 {
-	for(auto & v: data.splinePoints){
-		v.mirror(axisPoint1, axisPoint2);
-	}
-	for(auto& v: data.controlPoints){
-		v.mirror(axisPoint1, axisPoint2);
-	}
+	RS_Vector::mirror(data.splinePoints, axisPoint1, axisPoint2);
+	RS_Vector::mirror(data.controlPoints, axisPoint1, axisPoint2);
 	update();
 }
 
 RS_Entity& LC_SplinePoints::shear(double k)
 {
-    for(auto & v: data.splinePoints){
-        v.shear(k);
-    }
-    for(auto& v: data.controlPoints){
-        v.shear(k);
-    }
+    RS_Vector::shear(data.splinePoints, k);
+    RS_Vector::shear(data.controlPoints, k);
     update();
     return *this;
 }
@@ -1917,12 +2036,19 @@ void LC_SplinePoints::drawSimple(RS_Painter* painter, RS_GraphicView* view)
 	painter->drawPath(qPath);
 }
 
+void LC_SplinePoints::prepareDraw()
+{
+    update();
+}
+
 void LC_SplinePoints::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset)
 {
     if(painter == nullptr || view == nullptr)
         return;
 
-    update();
+    // prepared on the GUI thread for concurrent drawing
+    if (!view->isConcurrentDrawing())
+        prepareDraw();
 
     // Adjust dash offset
     updateDashOffset(*painter, *view, patternOffset);
@@ -1933,8 +2059,7 @@ void LC_SplinePoints::draw(RS_Painter* painter, RS_GraphicView* view, double& pa
 LC_SplinePointsData LC_SplinePoints::mapDataToGui(RS_GraphicView& view) const
 {
     LC_SplinePointsData guiData = data;
-    for(RS_Vector& point: guiData.controlPoints)
-        point = view.toGui(point);
+    view.toGui(guiData.controlPoints);
     return guiData;
 }
 
@@ -3385,14 +3510,11 @@ RS_VectorSolutions getQuadraticLineIntersect(std::vector<double> dQuadCoefs,
 		a0 = dQuadCoefs[0]*vx1.x + dQuadCoefs[1]*vx1.y + dQuadCoefs[2];
 	}
 
-	std::vector<double> dSol(0, 0.);
-	std::vector<double> dCoefs(0, 0.);
+	RS_Math::Roots dSol;
 
     if(std::abs(a2) > RS_TOLERANCE)
 	{
-		dCoefs.push_back(a1/a2);
-		dCoefs.push_back(a0/a2);
-		dSol = RS_Math::quadraticSolver(dCoefs);
+		dSol = RS_Math::quadraticSolver(std::array<double, 2>{a1/a2, a0/a2});
 
 	}
     else if(std::abs(a1) > RS_TOLERANCE)
@@ -3447,29 +3569,19 @@ void addQuadraticQuadIntersect(RS_VectorSolutions *pVS, std::vector<double> dQua
 		a0 = dQuadCoefs[0]*vx1.x + dQuadCoefs[1]*vx1.y + dQuadCoefs[2];
 	}
 
-	std::vector<double> dSol(0, 0.);
-	std::vector<double> dCoefs(0, 0.);
+	RS_Math::Roots dSol;
 
     if(std::abs(a4) > RS_TOLERANCE)
 	{
-		dCoefs.push_back(a3/a4);
-		dCoefs.push_back(a2/a4);
-		dCoefs.push_back(a1/a4);
-		dCoefs.push_back(a0/a4);
-		dSol = RS_Math::quarticSolver(dCoefs);
+		dSol = RS_Math::quarticSolver(std::array<double, 4>{a3/a4, a2/a4, a1/a4, a0/a4});
 	}
     else if(std::abs(a3) > RS_TOLERANCE)
 	{
-		dCoefs.push_back(a2/a3);
-		dCoefs.push_back(a1/a3);
-		dCoefs.push_back(a0/a3);
-		dSol = RS_Math::cubicSolver(dCoefs);
+		dSol = RS_Math::cubicSolver(std::array<double, 3>{a2/a3, a1/a3, a0/a3});
 	}
     else if(std::abs(a2) > RS_TOLERANCE)
 	{
-		dCoefs.push_back(a1/a2);
-		dCoefs.push_back(a0/a2);
-		dSol = RS_Math::quadraticSolver(dCoefs);
+		dSol = RS_Math::quadraticSolver(std::array<double, 2>{a1/a2, a0/a2});
 
 	}
     else if(std::abs(a1) > RS_TOLERANCE)
@@ -25,7 +25,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #ifndef LC_SPLINEPOINTS_H
 #define LC_SPLINEPOINTS_H
 
+#include <memory>
 #include <vector>
+#include "lc_sharedvector.h"
 #include "rs_atomicentity.h"
 
 class QPolygonF;
@@ -57,9 +59,9 @@ struct LC_SplinePointsData
     bool cut = false;
     // directly use control points from data, instead of generating control points from splinePoints
     bool useControlPoints = false;
-    /** points on the spline. */
-	std::vector<RS_Vector> splinePoints;
-	std::vector<RS_Vector> controlPoints;
+    /** points on the spline, shared by copies until changed. */
+	LC_SharedVector<RS_Vector> splinePoints;
+	LC_SharedVector<RS_Vector> controlPoints;
 };
 
 std::ostream& operator << (std::ostream& os, const LC_SplinePointsData& ld);
@@ -82,7 +84,10 @@ private:
     LC_SplinePointsData mapDataToGui(RS_GraphicView& view) const;
 	void UpdateControlPoints();
 	void UpdateQuadExtent(const RS_Vector& x1, const RS_Vector& c1, const RS_Vector& x2);
+	struct SegmentTree;
+	std::shared_ptr<const SegmentTree> GetSegmentTree() const;
 	int GetNearestQuad(const RS_Vector& coord, double* dist, double* dt) const;
+	int GetNearestQuadIndexed(const RS_Vector& coord, double* dist, double* dt) const;
 	RS_Vector GetSplinePointAtDist(double dDist, int iStartSeg, double dStartT,
 		int *piSeg, double *pdt) const;
 	int GetQuadPoints(int iSeg, RS_Vector *pvStart, RS_Vector *pvControl,
@@ -93,6 +98,9 @@ private:
 	std::vector<RS_Entity*> offsetTwoSidesSpline(const double& distance) const;
 	std::vector<RS_Entity*> offsetTwoSidesCut(const double& distance) const;
     LC_SplinePointsData data;
+	// bounding boxes of the quadratic segments, built by the first nearest point query
+	// after the control points changed
+	mutable std::shared_ptr<const SegmentTree> m_segmentTree;
 
 public:
     LC_SplinePoints(RS_EntityContainer* parent, const LC_SplinePointsData& d);
@@ -217,6 +225,7 @@ public:
 	void moveRef(const RS_Vector& ref, const RS_Vector& offset) override;
 	void revertDirection() override;
 
+	void prepareDraw() override;
 	void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
     std::vector<RS_Vector> const& getPoints() const;
     std::vector<RS_Vector> const& getControlPoints() const;
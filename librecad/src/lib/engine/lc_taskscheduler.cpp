@@ -0,0 +1,372 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include "lc_taskscheduler.h"
+
+#include <chrono>
+#include <thread>
+#include <utility>
+
+#include "lc_entitypool.h"
+#include "rs_debug.h"
+
+namespace {
+//ranges of parallelFor() per thread, for the balance of ranges of uneven costs
+constexpr std::size_t rangesPerThread = 4;
+//period to look again for queued tasks, while waiting for tasks run by other threads
+constexpr std::chrono::milliseconds waitPeriod{1};
+//no worker index, for threads which are not workers
+constexpr std::size_t noWorker = static_cast<std::size_t>(-1);
+
+//worker of the calling thread
+thread_local const LC_TaskScheduler* currentScheduler = nullptr;
+thread_local std::size_t currentWorker = noWorker;
+}
+
+struct LC_TaskScheduler::Task {
+    LC_TaskGroup* group = nullptr;
+    std::function<void()> function;
+    //! the entity arena of the submitting thread, kept by it while it waits for the group
+    LC_EntityPool::Arena* arena = nullptr;
+};
+
+struct LC_TaskScheduler::Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::thread thread;
+};
+
+LC_TaskScheduler& LC_TaskScheduler::instance()
+{
+    static LC_TaskScheduler scheduler;
+    return scheduler;
+}
+
+int LC_TaskScheduler::idealThreadCount()
+{
+    return std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+}
+
+LC_TaskScheduler::LC_TaskScheduler():
+    m_threadCount{idealThreadCount()}
+{
+}
+
+LC_TaskScheduler::~LC_TaskScheduler()
+{
+    std::lock_guard<std::mutex> config{m_configMutex};
+    stopWorkers();
+}
+
+void LC_TaskScheduler::setThreadCount(int count)
+{
+    if (count <= 0)
+        count = idealThreadCount();
+    if (currentScheduler == this && currentWorker != noWorker) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_TaskScheduler::setThreadCount: called by a task, ignored");
+        return;
+    }
+    std::lock_guard<std::mutex> config{m_configMutex};
+    if (count == m_threadCount.load())
+        return;
+    m_threadCount.store(count);
+    RS_DEBUG->print("LC_TaskScheduler::setThreadCount: %d threads", count);
+    // the workers are started again with the next task
+    stopWorkers();
+}
+
+int LC_TaskScheduler::threadCount() const
+{
+    return m_threadCount.load(std::memory_order_relaxed);
+}
+
+std::size_t LC_TaskScheduler::countRanges(std::size_t size, std::size_t grain) const
+{
+    const auto threads = static_cast<std::size_t>(threadCount());
+    grain = std::max<std::size_t>(grain, 1);
+    if (threads <= 1 || size <= grain)
+        return 1;
+    return std::max<std::size_t>(std::min(size / grain, threads * rangesPerThread), 1);
+}
+
+void LC_TaskScheduler::startWorkers()
+{
+    std::lock_guard<std::mutex> config{m_configMutex};
+    if (m_started.load())
+        return;
+    // the thread waiting for the tasks is the last one
+    const int workers = threadCount() - 1;
+    for (int i = 0; i < workers; ++i)
+        m_workers.push_back(std::make_unique<Worker>());
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+        m_workers[i]->thread = std::thread{&LC_TaskScheduler::workerLoop, this, i};
+    m_started.store(true);
+}
+
+void LC_TaskScheduler::stopWorkers()
+{
+    if (!m_started.load())
+        return;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    // the workers stop once all queued tasks are run
+    for (auto& worker: m_workers)
+        worker->thread.join();
+    m_workers.clear();
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stopping = false;
+    }
+    m_started.store(false);
+}
+
+void LC_TaskScheduler::submit(LC_TaskGroup* group, std::function<void()> task)
+{
+    if (!m_started.load(std::memory_order_acquire))
+        startWorkers();
+
+    if (currentScheduler == this && currentWorker < m_workers.size()) {
+        Worker& worker = *m_workers[currentWorker];
+        {
+            std::lock_guard<std::mutex> lock{worker.mutex};
+            worker.tasks.push_back(Task{group, std::move(task), LC_EntityPool::threadArena()});
+        }
+        m_queued.fetch_add(1);
+        // an idle worker checks the count with m_mutex locked, before sleeping
+        std::lock_guard<std::mutex> lock{m_mutex};
+    } else {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_injected.push_back(Task{group, std::move(task), LC_EntityPool::threadArena()});
+        m_queued.fetch_add(1);
+    }
+    m_wake.notify_one();
+}
+
+bool LC_TaskScheduler::takeTask(std::size_t worker, Task& task)
+{
+    if (m_queued.load() == 0)
+        return false;
+
+    // the newest task of the own queue
+    if (worker < m_workers.size()) {
+        Worker& own = *m_workers[worker];
+        std::lock_guard<std::mutex> lock{own.mutex};
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            m_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (!m_injected.empty()) {
+            task = std::move(m_injected.front());
+            m_injected.pop_front();
+            m_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    // the oldest task of another worker, starting with the next one
+    const std::size_t count = m_workers.size();
+    const std::size_t first = worker < count ? worker + 1 : 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t index = (first + i) % count;
+        if (index == worker)
+            continue;
+        Worker& other = *m_workers[index];
+        std::lock_guard<std::mutex> lock{other.mutex};
+        if (!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            m_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LC_TaskScheduler::runPending()
+{
+    const std::size_t worker = currentScheduler == this ? currentWorker : noWorker;
+    Task task;
+    if (!takeTask(worker, task))
+        return false;
+    execute(task);
+    return true;
+}
+
+void LC_TaskScheduler::execute(Task& task)
+{
+    std::exception_ptr error;
+    if (!task.group->isCancelled()) {
+        // entities created by tasks belong to the document of the parallel work
+        LC_EntityPool::Scope arenaScope{task.arena};
+        try {
+            task.function();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+    // the task may hold references to the group, released before the group is done
+    task.function = nullptr;
+    task.group->finishTask(error);
+}
+
+void LC_TaskScheduler::workerLoop(std::size_t worker)
+{
+    currentScheduler = this;
+    currentWorker = worker;
+    for (;;) {
+        Task task;
+        if (takeTask(worker, task)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_wake.wait(lock, [this]() {
+            return m_stopping || m_queued.load() > 0;
+        });
+        if (m_stopping && m_queued.load() == 0)
+            break;
+    }
+    currentScheduler = nullptr;
+    currentWorker = noWorker;
+}
+
+LC_TaskGroup::LC_TaskGroup(const LC_CancelToken* cancel):
+    m_scheduler{LC_TaskScheduler::instance()}
+    , m_token{cancel}
+{
+}
+
+LC_TaskGroup::~LC_TaskGroup()
+{
+    waitForTasks();
+}
+
+void LC_TaskGroup::run(std::function<void()> task)
+{
+    m_pending.fetch_add(1);
+    m_scheduler.submit(this, std::move(task));
+}
+
+void LC_TaskGroup::wait()
+{
+    waitForTasks();
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        std::swap(error, m_error);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void LC_TaskGroup::waitForTasks()
+{
+    for (;;) {
+        if (m_pending.load() == 0) {
+            // the last task unlocks the mutex after it counted down
+            std::lock_guard<std::mutex> lock{m_mutex};
+            return;
+        }
+        if (m_scheduler.runPending())
+            continue;
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_done.wait_for(lock, waitPeriod, [this]() {
+            return m_pending.load() == 0;
+        });
+    }
+}
+
+void LC_TaskGroup::finishTask(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (error) {
+        if (!m_error)
+            m_error = error;
+        m_cancelled.store(true);
+    }
+    if (m_pending.fetch_sub(1) == 1)
+        m_done.notify_all();
+}
+
+void LC_TaskGroup::cancel()
+{
+    m_cancelled.store(true);
+}
+
+bool LC_TaskGroup::isCancelled() const
+{
+    return m_cancelled.load(std::memory_order_relaxed) || (m_token != nullptr && m_token->isCancelled());
+}
+
+LC_TaskGraph::Node LC_TaskGraph::add(std::function<void()> task, const std::vector<Node>& dependencies)
+{
+    const Node node = m_nodes.size();
+    NodeData data;
+    data.task = std::move(task);
+    for (Node dependency: dependencies) {
+        if (dependency >= node) {
+            RS_DEBUG->print(RS_Debug::D_ERROR, "LC_TaskGraph::add: invalid dependency %zu of task %zu",
+                            dependency, node);
+            continue;
+        }
+        m_nodes[dependency].successors.push_back(node);
+        ++data.dependencies;
+    }
+    m_nodes.push_back(std::move(data));
+    return node;
+}
+
+void LC_TaskGraph::run(const LC_CancelToken* cancel)
+{
+    if (m_nodes.empty())
+        return;
+    std::unique_ptr<std::atomic<int>[]> remaining{new std::atomic<int>[m_nodes.size()]};
+    for (std::size_t i = 0; i < m_nodes.size(); ++i)
+        remaining[i].store(m_nodes[i].dependencies);
+
+    LC_TaskGroup group{cancel};
+    // a node queues its successors when it is the last of their dependencies
+    std::function<void(Node)> start = [this, &group, &remaining, &start](Node node) {
+        group.run([this, &remaining, &start, node]() {
+            m_nodes[node].task();
+            for (Node successor: m_nodes[node].successors) {
+                if (remaining[successor].fetch_sub(1) == 1)
+                    start(successor);
+            }
+        });
+    };
+    for (Node node = 0; node < m_nodes.size(); ++node) {
+        if (m_nodes[node].dependencies == 0)
+            start(node);
+    }
+    group.wait();
+}
@@ -0,0 +1,254 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_TASKSCHEDULER_H
+#define LC_TASKSCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class LC_TaskGroup;
+
+/**
+ * @brief The LC_CancelToken class, a flag to stop parallel work cooperatively.
+ * Tasks not started when the token is cancelled are skipped, running tasks may
+ * check the token to stop early.
+ */
+class LC_CancelToken {
+public:
+    void cancel()
+    {
+        m_cancelled.store(true, std::memory_order_relaxed);
+    }
+    bool isCancelled() const
+    {
+        return m_cancelled.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<bool> m_cancelled{false};
+};
+
+/**
+ * @brief The LC_TaskScheduler class, the thread pool shared by the engine, the GUI
+ * and the console tools.
+ *
+ * Each worker thread has its own queue of tasks: tasks submitted by a task are
+ * queued by its worker and run last in first out, idle workers steal the oldest
+ * tasks of the others. Threads waiting for a LC_TaskGroup run queued tasks
+ * meanwhile, so parallel work can be nested without blocking workers.
+ *
+ * The worker threads are started with the first task.
+ */
+class LC_TaskScheduler {
+public:
+    static LC_TaskScheduler& instance();
+
+    //! @return the number of hardware threads, at least one
+    static int idealThreadCount();
+
+    /**
+     * @brief setThreadCount sets the number of threads of parallel work, the thread
+     * waiting for the work included. One runs all work sequentially, zero or less
+     * uses idealThreadCount(). Must not be called while parallel work runs
+     */
+    void setThreadCount(int count);
+    int threadCount() const;
+
+    /**
+     * @brief parallelFor calls body(first, last) for consecutive ranges covering
+     * [begin, end), concurrently. Ranges have at least grain indices, except the last.
+     * Returns when all ranges are done, exceptions thrown by body are rethrown.
+     */
+    template<typename Body>
+    void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, Body body,
+                     const LC_CancelToken* cancel = nullptr);
+
+    /**
+     * @brief parallelReduce returns reduce(...reduce(reduce(identity, map(r0)), map(r1))...)
+     * for the ranges r0, r1, ... of parallelFor(). The ranges are mapped concurrently,
+     * the results are reduced in the order of the ranges. Ranges skipped by a cancel
+     * are reduced as identity.
+     */
+    template<typename T, typename Map, typename Reduce>
+    T parallelReduce(std::size_t begin, std::size_t end, std::size_t grain, T identity,
+                     Map map, Reduce reduce, const LC_CancelToken* cancel = nullptr);
+
+    LC_TaskScheduler(const LC_TaskScheduler&) = delete;
+    LC_TaskScheduler& operator = (const LC_TaskScheduler&) = delete;
+
+private:
+    friend class LC_TaskGroup;
+    struct Task;
+    struct Worker;
+
+    LC_TaskScheduler();
+    ~LC_TaskScheduler();
+
+    //! @return the ranges parallelFor() splits [begin, end) into
+    std::size_t countRanges(std::size_t size, std::size_t grain) const;
+
+    void submit(LC_TaskGroup* group, std::function<void()> task);
+    //! runs one queued task, if any, by the calling thread
+    bool runPending();
+    bool takeTask(std::size_t worker, Task& task);
+    void execute(Task& task);
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop(std::size_t worker);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    //! tasks submitted by threads other than the workers
+    std::deque<Task> m_injected;
+    std::atomic<std::size_t> m_queued{0};
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+    //! restarts of the workers, guarded by m_configMutex
+    std::mutex m_configMutex;
+    std::atomic<bool> m_started{false};
+    std::atomic<int> m_threadCount;
+};
+
+/**
+ * @brief The LC_TaskGroup class, tasks run by the scheduler and waited for together.
+ *
+ * The first exception thrown by a task cancels the group and is rethrown by wait().
+ * The destructor waits for the tasks, without rethrowing.
+ */
+class LC_TaskGroup {
+public:
+    explicit LC_TaskGroup(const LC_CancelToken* cancel = nullptr);
+    ~LC_TaskGroup();
+
+    //! queues a task, it may be run by any thread, the thread calling wait() included
+    void run(std::function<void()> task);
+    //! waits for the tasks, running queued tasks meanwhile
+    void wait();
+
+    void cancel();
+    //! whether the group or its cancel token was cancelled
+    bool isCancelled() const;
+
+    LC_TaskGroup(const LC_TaskGroup&) = delete;
+    LC_TaskGroup& operator = (const LC_TaskGroup&) = delete;
+
+private:
+    friend class LC_TaskScheduler;
+    void waitForTasks();
+    void finishTask(std::exception_ptr error);
+
+    LC_TaskScheduler& m_scheduler;
+    const LC_CancelToken* m_token = nullptr;
+    std::atomic<int> m_pending{0};
+    std::atomic<bool> m_cancelled{false};
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+};
+
+/**
+ * @brief The LC_TaskGraph class, tasks run concurrently once their dependencies
+ * are done. Dependencies are tasks added before, so the graph has no cycles.
+ */
+class LC_TaskGraph {
+public:
+    using Node = std::size_t;
+
+    //! adds a task run after the tasks of dependencies, returns its node
+    Node add(std::function<void()> task, const std::vector<Node>& dependencies = {});
+    std::size_t size() const
+    {
+        return m_nodes.size();
+    }
+    /**
+     * @brief run runs the tasks and waits for them. After a cancel or an exception,
+     * the tasks not started are skipped; the exception is rethrown.
+     */
+    void run(const LC_CancelToken* cancel = nullptr);
+
+private:
+    struct NodeData {
+        std::function<void()> task;
+        std::vector<Node> successors;
+        int dependencies = 0;
+    };
+    std::vector<NodeData> m_nodes;
+};
+
+template<typename Body>
+void LC_TaskScheduler::parallelFor(std::size_t begin, std::size_t end, std::size_t grain, Body body,
+                                   const LC_CancelToken* cancel)
+{
+    if (begin >= end)
+        return;
+    const std::size_t ranges = countRanges(end - begin, grain);
+    if (ranges <= 1) {
+        if (cancel == nullptr || !cancel->isCancelled())
+            body(begin, end);
+        return;
+    }
+    const std::size_t rangeSize = (end - begin + ranges - 1) / ranges;
+    LC_TaskGroup group{cancel};
+    for (std::size_t first = begin; first < end; first += rangeSize) {
+        const std::size_t last = std::min(first + rangeSize, end);
+        group.run([&body, first, last]() {
+            body(first, last);
+        });
+    }
+    group.wait();
+}
+
+template<typename T, typename Map, typename Reduce>
+T LC_TaskScheduler::parallelReduce(std::size_t begin, std::size_t end, std::size_t grain, T identity,
+                                   Map map, Reduce reduce, const LC_CancelToken* cancel)
+{
+    if (begin >= end)
+        return identity;
+    const std::size_t ranges = countRanges(end - begin, grain);
+    const std::size_t rangeSize = (end - begin + ranges - 1) / ranges;
+    std::vector<T> results(ranges, identity);
+    parallelFor(0, ranges, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const std::size_t from = begin + i * rangeSize;
+            if (from < end)
+                results[i] = map(from, std::min(from + rangeSize, end));
+        }
+    }, cancel);
+    T result = std::move(identity);
+    for (T& value: results)
+        result = reduce(std::move(result), std::move(value));
+    return result;
+}
+
+#endif // LC_TASKSCHEDULER_H
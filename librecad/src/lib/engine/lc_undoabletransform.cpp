@@ -0,0 +1,163 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include "lc_undoabletransform.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "lc_taskscheduler.h"
+#include "rs_debug.h"
+#include "rs_entitycontainer.h"
+#include "rs_insert.h"
+#include "rs_polyline.h"
+
+namespace {
+// selections from this size on are transformed concurrently
+constexpr std::size_t parallelMinimum = 10000;
+// least entities of a task of the concurrent transformation
+constexpr std::size_t parallelGrain = 1000;
+
+/**
+ * @return true, if the transformation of the entity only changes the entity,
+ * e.g. not texts and inserts, which use the fonts and blocks of the graphic
+ */
+bool isSelfContained(const RS_Entity& entity)
+{
+    if (entity.isAtomic())
+        return true;
+    if (entity.rtti() != RS2::EntityPolyline)
+        return false;
+    const auto& polyline = static_cast<const RS_Polyline&>(entity);
+    if (polyline.isFlat())
+        return true;
+    return std::all_of(polyline.begin(), polyline.end(), [](const RS_Entity* e) {
+        return e->isAtomic();
+    });
+}
+}
+
+LC_UndoableTransform::LC_UndoableTransform(RS_EntityContainer& container,
+                                           std::vector<RS_Entity*> entities,
+                                           Type type, const RS_Vector& point,
+                                           const RS_Vector& vector, double angle):
+    m_container{container}
+    , m_entities{std::move(entities)}
+    , m_type{type}
+    , m_point{point}
+    , m_vector{vector}
+    , m_angle{angle}
+{}
+
+std::unique_ptr<LC_UndoableTransform> LC_UndoableTransform::createMove(
+        RS_EntityContainer& container, std::vector<RS_Entity*> entities,
+        const RS_Vector& offset)
+{
+    return std::unique_ptr<LC_UndoableTransform>{
+        new LC_UndoableTransform{container, std::move(entities), Move, {}, offset}};
+}
+
+std::unique_ptr<LC_UndoableTransform> LC_UndoableTransform::createRotate(
+        RS_EntityContainer& container, std::vector<RS_Entity*> entities,
+        const RS_Vector& center, double angle)
+{
+    return std::unique_ptr<LC_UndoableTransform>{
+        new LC_UndoableTransform{container, std::move(entities), Rotate, center, {}, angle}};
+}
+
+std::unique_ptr<LC_UndoableTransform> LC_UndoableTransform::createScale(
+        RS_EntityContainer& container, std::vector<RS_Entity*> entities,
+        const RS_Vector& center, const RS_Vector& factor)
+{
+    return std::unique_ptr<LC_UndoableTransform>{
+        new LC_UndoableTransform{container, std::move(entities), Scale, center, factor}};
+}
+
+std::unique_ptr<LC_UndoableTransform> LC_UndoableTransform::createMirror(
+        RS_EntityContainer& container, std::vector<RS_Entity*> entities,
+        const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
+{
+    return std::unique_ptr<LC_UndoableTransform>{
+        new LC_UndoableTransform{container, std::move(entities), Mirror, axisPoint1, axisPoint2}};
+}
+
+void LC_UndoableTransform::apply(bool inverse)
+{
+    if (m_entities.size() < parallelMinimum) {
+        for (RS_Entity* e: m_entities)
+            transform(*e, inverse);
+        m_container.calculateBorders();
+        return;
+    }
+
+    // self-contained entities are transformed in chunks by a thread each, the others
+    // and the borders of the container, with its spatial index, by this thread
+    RS_DEBUG->print("LC_UndoableTransform::apply: %zu entities", m_entities.size());
+    LC_TaskScheduler::instance().parallelFor(0, m_entities.size(), parallelGrain,
+                                             [this, inverse](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            RS_Entity* e = m_entities[i];
+            if (isSelfContained(*e)) {
+                transform(*e, inverse);
+                e->calculateBorders();
+            }
+        }
+    });
+
+    for (RS_Entity* e: m_entities) {
+        if (!isSelfContained(*e)) {
+            transform(*e, inverse);
+            e->calculateBorders();
+        }
+    }
+    m_container.mergeBorders();
+}
+
+void LC_UndoableTransform::transform(RS_Entity& entity, bool inverse) const
+{
+    switch (m_type) {
+    case Move:
+        entity.move(inverse ? -m_vector : m_vector);
+        break;
+    case Rotate:
+        entity.rotate(m_point, inverse ? -m_angle : m_angle);
+        break;
+    case Scale:
+        entity.scale(m_point, inverse ? RS_Vector{1. / m_vector.x, 1. / m_vector.y} : m_vector);
+        break;
+    case Mirror:
+        // a mirror is its own inverse
+        entity.mirror(m_point, m_vector);
+        break;
+    }
+    if (entity.rtti() == RS2::EntityInsert)
+        static_cast<RS_Insert&>(entity).update();
+}
+
+/**
+ * Transforms the entities back when undone and again when redone.
+ */
+void LC_UndoableTransform::undoStateChanged(bool undone)
+{
+    apply(undone);
+}
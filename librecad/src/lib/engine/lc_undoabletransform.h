@@ -0,0 +1,100 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_UNDOABLETRANSFORM_H
+#define LC_UNDOABLETRANSFORM_H
+
+#include <memory>
+#include <vector>
+
+#include "rs_undoable.h"
+#include "rs_vector.h"
+
+class RS_Entity;
+class RS_EntityContainer;
+
+/**
+ * @brief The LC_UndoableTransform class, an undo record of entities moved, rotated,
+ * scaled or mirrored in place.
+ *
+ * Instead of keeping the original entities and their transformed copies in the undo
+ * list, only the transformation is recorded: undoing applies the inverse transformation
+ * to the entities, redoing applies the transformation again. The record is owned by its
+ * undo cycle.
+ */
+class LC_UndoableTransform : public RS_Undoable {
+public:
+    enum Type {
+        Move,       /**< move by the vector */
+        Rotate,     /**< rotate around the point by the angle */
+        Scale,      /**< scale at the point by the vector factors */
+        Mirror      /**< mirror at the axis from the point to the vector */
+    };
+
+    static std::unique_ptr<LC_UndoableTransform> createMove(
+            RS_EntityContainer& container, std::vector<RS_Entity*> entities,
+            const RS_Vector& offset);
+    static std::unique_ptr<LC_UndoableTransform> createRotate(
+            RS_EntityContainer& container, std::vector<RS_Entity*> entities,
+            const RS_Vector& center, double angle);
+    static std::unique_ptr<LC_UndoableTransform> createScale(
+            RS_EntityContainer& container, std::vector<RS_Entity*> entities,
+            const RS_Vector& center, const RS_Vector& factor);
+    static std::unique_ptr<LC_UndoableTransform> createMirror(
+            RS_EntityContainer& container, std::vector<RS_Entity*> entities,
+            const RS_Vector& axisPoint1, const RS_Vector& axisPoint2);
+
+    /** @return RS2::UndoableTransform */
+    RS2::UndoableType undoRtti() const override {
+        return RS2::UndoableTransform;
+    }
+
+    /**
+     * Transforms the entities, or transforms them back with inverse set, and
+     * recalculates the borders of the container. Large selections are
+     * transformed concurrently.
+     */
+    void apply(bool inverse = false);
+
+    void undoStateChanged(bool undone) override;
+
+    const std::vector<RS_Entity*>& getEntities() const {
+        return m_entities;
+    }
+
+private:
+    LC_UndoableTransform(RS_EntityContainer& container, std::vector<RS_Entity*> entities,
+                         Type type, const RS_Vector& point, const RS_Vector& vector,
+                         double angle = 0.);
+
+    void transform(RS_Entity& entity, bool inverse) const;
+
+    RS_EntityContainer& m_container;
+    std::vector<RS_Entity*> m_entities;
+    Type m_type;
+    RS_Vector m_point;
+    RS_Vector m_vector;
+    double m_angle;
+};
+
+#endif // LC_UNDOABLETRANSFORM_H
@@ -23,6 +23,8 @@
 **
 **********************************************************************/
 
+#include <utility>
+
 #include "lc_undosection.h"
 #include "rs_document.h"
 
@@ -48,3 +50,18 @@ void LC_UndoSection::addUndoable(RS_Undoable *undoable)
         document->addUndoable( undoable);
     }
 }
+
+bool LC_UndoSection::cancel()
+{
+    if (valid) {
+        document->cancelUndoCycle();
+    }
+    return valid;
+}
+
+void LC_UndoSection::addUndoable(std::unique_ptr<RS_Undoable> undoable)
+{
+    if (valid) {
+        document->addUndoable( std::move( undoable));
+    }
+}
@@ -26,6 +26,8 @@
 #ifndef LC_UNDOSECTION_H
 #define LC_UNDOSECTION_H
 
+#include <memory>
+
 class RS_Document;
 class RS_Undoable;
 
@@ -47,6 +49,13 @@ public:
     ~LC_UndoSection();
 
     void addUndoable(RS_Undoable * undoable);
+    void addUndoable(std::unique_ptr<RS_Undoable> undoable);
+    /**
+     * @brief cancel rolls back the changes of the section and all enclosing
+     * sections when the outermost one ends, e.g. for a cancelled LC_Progress.
+     * @return false, if there's no undo cycle to roll back
+     */
+    bool cancel();
 
 private:
     RS_Document *document {nullptr};
@@ -0,0 +1,173 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include "lc_xrefcache.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QTimer>
+
+#include "rs_block.h"
+#include "rs_debug.h"
+#include "rs_graphic.h"
+
+namespace {
+// editors write files in several steps, wait for the last one before reloading
+constexpr int reloadDelay = 500;
+}
+
+// the graphic owns the layers and nested blocks of the content, released last
+struct LC_Xref::Loaded {
+    std::unique_ptr<RS_Graphic> graphic;
+    std::unique_ptr<RS_Block> content;
+};
+
+LC_Xref::LC_Xref(QString fileName):
+    m_fileName{std::move(fileName)}
+{
+}
+
+LC_Xref::~LC_Xref() = default;
+
+const QString& LC_Xref::getFileName() const
+{
+    return m_fileName;
+}
+
+std::shared_ptr<const RS_Graphic> LC_Xref::getGraphic() const
+{
+    std::shared_ptr<const Loaded> loaded = std::atomic_load(&m_loaded);
+    if (loaded == nullptr)
+        return nullptr;
+    return {loaded, loaded->graphic.get()};
+}
+
+std::shared_ptr<const RS_Block> LC_Xref::getContent() const
+{
+    std::shared_ptr<const Loaded> loaded = std::atomic_load(&m_loaded);
+    if (loaded == nullptr)
+        return nullptr;
+    // the reference keeps the graphic of the layers too
+    return {loaded, loaded->content.get()};
+}
+
+bool LC_Xref::load()
+{
+    auto graphic = std::make_unique<RS_Graphic>();
+    if (!graphic->open(m_fileName, RS2::FormatUnknown)) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_Xref::load: cannot open %s",
+                        m_fileName.toLatin1().data());
+        return false;
+    }
+
+    auto content = std::make_unique<RS_Block>(graphic.get(),
+        RS_BlockData(QFileInfo(m_fileName).completeBaseName(),
+                     graphic->getVariableVector("$INSBASE", RS_Vector(0., 0.)),
+                     false));
+    // the entities move to the content, the graphic keeps the layers and blocks
+    for (const auto& [position, e]: graphic->detachEntities([](const RS_Entity*) {return true;})) {
+        e->reparent(content.get());
+        content->appendEntity(e);
+    }
+    content->calculateBorders();
+
+    auto loaded = std::make_shared<Loaded>();
+    loaded->graphic = std::move(graphic);
+    loaded->content = std::move(content);
+    std::atomic_store(&m_loaded, std::shared_ptr<const Loaded>{std::move(loaded)});
+    return true;
+}
+
+LC_XrefCache* LC_XrefCache::instance()
+{
+    static LC_XrefCache* uniqueInstance = new LC_XrefCache();
+    return uniqueInstance;
+}
+
+LC_XrefCache::LC_XrefCache()
+{
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &LC_XrefCache::fileChanged);
+}
+
+std::shared_ptr<LC_Xref> LC_XrefCache::get(const QString& fileName)
+{
+    const QString path = QDir::cleanPath(QFileInfo(fileName).absoluteFilePath());
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::shared_ptr<LC_Xref> xref = m_xrefs[path].lock();
+    if (xref != nullptr)
+        return xref;
+
+    // files released by all documents
+    for (auto it = m_xrefs.begin(); it != m_xrefs.end();) {
+        if (it->second.expired() && it->first != path) {
+            m_watcher.removePath(it->first);
+            it = m_xrefs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // registered before loading: a file referencing itself gets an empty content
+    xref = std::make_shared<LC_Xref>(path);
+    m_xrefs[path] = xref;
+    xref->load();
+    // the watcher belongs to the main thread
+    QMetaObject::invokeMethod(this, [this, path]() {watch(path);}, Qt::QueuedConnection);
+    return xref;
+}
+
+void LC_XrefCache::watch(const QString& fileName)
+{
+    if (QFileInfo::exists(fileName) && !m_watcher.files().contains(fileName))
+        m_watcher.addPath(fileName);
+}
+
+void LC_XrefCache::fileChanged(const QString& fileName)
+{
+    if (!m_pendingReloads.insert(fileName).second)
+        return;
+    QTimer::singleShot(reloadDelay, this, [this, fileName]() {
+        m_pendingReloads.erase(fileName);
+        reload(fileName);
+    });
+}
+
+void LC_XrefCache::reload(const QString& fileName)
+{
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        auto it = m_xrefs.find(fileName);
+        std::shared_ptr<LC_Xref> xref = (it != m_xrefs.end()) ? it->second.lock() : nullptr;
+        if (xref == nullptr) {
+            m_watcher.removePath(fileName);
+            return;
+        }
+        // a file replaced by saving is no longer watched
+        watch(fileName);
+        RS_DEBUG->print("LC_XrefCache::reload: %s", fileName.toLatin1().data());
+        xref->load();
+    }
+    emit xrefReloaded(fileName);
+}
@@ -0,0 +1,105 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_XREFCACHE_H
+#define LC_XREFCACHE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QString>
+
+class RS_Block;
+class RS_Graphic;
+
+/**
+ * @brief The LC_Xref class a drawing file referenced by external reference
+ * blocks. The entities are loaded once and shared read-only by the blocks of
+ * all open documents. A reload publishes a new content, readers hold the
+ * content they got until they finish reading it.
+ */
+class LC_Xref {
+public:
+    explicit LC_Xref(QString fileName);
+    ~LC_Xref();
+
+    const QString& getFileName() const;
+    //! @return the graphic of the file, for its layers, blocks and units
+    std::shared_ptr<const RS_Graphic> getGraphic() const;
+    //! @return the entities of the file, nullptr if the file couldn't be read
+    std::shared_ptr<const RS_Block> getContent() const;
+    /**
+     * @brief load read the file, the previous content is released by its last reader
+     * @return false, if the file couldn't be read
+     */
+    bool load();
+
+private:
+    struct Loaded;
+
+    QString m_fileName;
+    // read and replaced by std::atomic_load() and std::atomic_store()
+    std::shared_ptr<const Loaded> m_loaded;
+};
+
+/**
+ * @brief The LC_XrefCache class the loaded files of external references.
+ * A file is kept as long as blocks reference it, and reloaded when it is
+ * changed on disk.
+ */
+class LC_XrefCache: public QObject {
+    Q_OBJECT
+public:
+    static LC_XrefCache* instance();
+
+    /**
+     * @brief get the loaded drawing file, the file is read on first request
+     * @param fileName absolute path of the file
+     */
+    std::shared_ptr<LC_Xref> get(const QString& fileName);
+
+signals:
+    //! the file was changed on disk and reloaded, inserts of the file need an update
+    void xrefReloaded(const QString& fileName);
+
+private:
+    LC_XrefCache();
+    void fileChanged(const QString& fileName);
+    void reload(const QString& fileName);
+    void watch(const QString& fileName);
+
+    // files are requested while drawings are imported in the background
+    std::recursive_mutex m_mutex;
+    std::map<QString, std::weak_ptr<LC_Xref>> m_xrefs;
+    QFileSystemWatcher m_watcher;
+    //! changed files waiting for the reload delay
+    std::set<QString> m_pendingReloads;
+};
+
+#endif // LC_XREFCACHE_H
@@ -107,6 +107,7 @@ namespace RS2 {
         FormatDXFRW2000,           /**< DXF format. v2000. */
         FormatDXFRW14,           /**< DXF format. v14. */
         FormatDXFRW12,           /**< DXF format. v12. */
+        FormatDXFRWBinary,           /**< Binary DXF format. v2007. */
 #ifdef DWGSUPPORT
         FormatDWG,           /**< DWG format. */
 #endif
@@ -349,6 +350,7 @@ namespace RS2 {
         ActionModifyTrim,
         ActionModifyTrim2,
         ActionModifyTrimAmount,
+        ActionModifyTrimToEdges,
         ActionModifyCut,
         ActionModifyStretch,
         ActionModifyBevel,
@@ -419,6 +421,8 @@ namespace RS2 {
 
         ActionModifyExplodeText,
         ActionModifyExplodeTextNoSelect,
+        ActionModifyOverkill,
+        ActionModifyOverkillNoSelect,
 
         ActionLibraryInsert,
 
@@ -476,7 +480,8 @@ namespace RS2 {
     enum UndoableType {
         UndoableUnknown,    /**< Unknown undoable */
         UndoableEntity,     /**< Entity */
-        UndoableLayer       /**< Layer */
+        UndoableLayer,      /**< Layer */
+        UndoableTransform   /**< Transformation of entities in place */
     };
 
     /**
@@ -966,7 +971,8 @@ namespace RS2 {
         enum OverlayGraphics: short {
                 ActionPreviewEntity = 0, // Action Entities
                 Snapper = 1, // Snapper
-                OverlayEffects =2 // special effects, like glowing on hover
+                OverlayEffects =2, // special effects, like glowing on hover
+                OverlayHighlights =3 // highlighted entities, see RS_GraphicView::drawEntityHighlighted()
         };
 
         //Different re-draw methods to speed up rendering of the screen
@@ -975,6 +981,12 @@ namespace RS2 {
                 RedrawGrid = 1,
                 RedrawOverlay = 2,
                 RedrawDrawing = 4,
+                /** the drawing is composed from cached rendering, only invalidated areas are rendered again */
+                RedrawCached = 8,
+                /** only the crosshair and the snap indicator are changed, painted over the layers */
+                RedrawSnapper = 16,
+                /** the view is moved or zoomed only, the drawing is not changed */
+                RedrawView = RedrawGrid | RedrawOverlay | RedrawCached,
                 RedrawAll = 0xffff
         };
 
@@ -213,6 +213,8 @@ void RS_AtomicEntity::moveSelectedRef(const RS_Vector& ref, const RS_Vector& off
 void RS_AtomicEntity::updateDashOffset(RS_Painter& painter, RS_GraphicView& view, double& patternOffset) const
 {
     // Adjust dash offset
+    if (painter.isDashChaining())
+        return;
     RS_Pen pen = painter.getPen();
     if (pen.getLineType() == RS2::SolidLine || view.getGraphic() == nullptr)
         return;
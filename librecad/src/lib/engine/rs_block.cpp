@@ -27,6 +27,10 @@
 #include<iostream>
 #include "rs_block.h"
 
+#include <QDir>
+#include <QFileInfo>
+
+#include "lc_xrefcache.h"
 #include "rs_graphic.h"
 #include "rs_insert.h"
 
@@ -52,7 +56,7 @@ RS_Block::RS_Block(RS_EntityContainer* parent,
                    const RS_BlockData& d)
         : RS_Document(parent), data(d) {
 
-    pen = RS_Pen(RS_Color(128,128,128), RS2::Width01, RS2::SolidLine);
+    setPen(RS_Pen(RS_Color(128,128,128), RS2::Width01, RS2::SolidLine));
 }
 
 
@@ -192,3 +196,31 @@ std::ostream& operator << (std::ostream& os, const RS_Block& b) {
     os << " entities: " << (RS_EntityContainer&)b << "\n";
     return os;
 }
+
+
+void RS_Block::setXrefFile(const QString& fileName) {
+    data.xrefFile = fileName;
+    m_xref.reset();
+}
+
+
+QString RS_Block::getXrefPath() const {
+    QFileInfo info(data.xrefFile);
+    RS_Graphic* g = getGraphic();
+    if (info.isRelative() && g != nullptr && !g->getFilename().isEmpty())
+        info.setFile(QFileInfo(g->getFilename()).absoluteDir(), data.xrefFile);
+    return QDir::cleanPath(info.absoluteFilePath());
+}
+
+
+std::shared_ptr<const RS_Block> RS_Block::getContent() const {
+    // the block itself is not owned by the reference
+    const std::shared_ptr<const RS_Block> self{std::shared_ptr<const RS_Block>{}, this};
+    if (!isXref())
+        return self;
+    if (m_xref == nullptr)
+        m_xref = LC_XrefCache::instance()->get(getXrefPath());
+    std::shared_ptr<const RS_Block> content = m_xref->getContent();
+    // a missing or unreadable file is shown as an empty block
+    return (content != nullptr) ? content : self;
+}
@@ -28,8 +28,12 @@
 #ifndef RS_BLOCK_H
 #define RS_BLOCK_H
 
+#include <memory>
+
 #include "rs_document.h"
 
+class LC_Xref;
+
 /**
  * Holds the data that defines a block.
  */
@@ -53,6 +57,7 @@ struct RS_BlockData {
 	RS_Vector basePoint;
 
 	bool frozen {false};              //!< Frozen flag
+	QString xrefFile;                 //!< Drawing file of an external reference
     mutable bool visibleInBlockList {true};   //!< Visible in block list
     mutable bool selectedInBlockList {false}; //!< selected in block list
 };
@@ -217,9 +222,48 @@ public:
      */
     QStringList findNestedInsert(const QString& bName);
 
+    /**
+     * @retval true if this block is an external reference of a drawing file.
+     * The entities of external references aren't stored in the block, they are
+     * loaded from the file on first use and shared by all documents.
+     */
+    bool isXref() const {
+        return !data.xrefFile.isEmpty();
+    }
+
+    /**
+     * @return the referenced file as stored in the drawing, may be relative
+     * to the folder of the drawing
+     */
+    QString getXrefFile() const {
+        return data.xrefFile;
+    }
+
+    /**
+     * Makes this block an external reference of the drawing file, or a
+     * regular block for an empty file name.
+     */
+    void setXrefFile(const QString& fileName);
+
+    /**
+     * @return the absolute path of the referenced file
+     */
+    QString getXrefPath() const;
+
+    /**
+     * @return the block holding the entities of inserts of this block. The shared
+     * entities of the referenced file for external references, held by the caller
+     * while it reads them, as a reload replaces them; this block otherwise.
+     */
+    std::shared_ptr<const RS_Block> getContent() const;
+
 protected:
 	//! Block data
 	RS_BlockData data;
+
+private:
+    //! the loaded file of an external reference
+    mutable std::shared_ptr<LC_Xref> m_xref;
 };
 
 
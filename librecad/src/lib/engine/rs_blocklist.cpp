@@ -24,6 +24,7 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include <set>
 #include <iostream>
 #include <QString>
@@ -53,6 +54,9 @@ RS_BlockList::RS_BlockList(bool owner) {
  */
 void RS_BlockList::clear() {
     blocks.clear();
+    m_nameIndex.clear();
+    m_dimensionNumber = 0;
+    m_unnamedNumber = 0;
 	activeBlock = nullptr;
 	setModified(true);
 }
@@ -98,9 +102,13 @@ bool RS_BlockList::add(RS_Block* block, bool notify) {
     RS_Block* b = find(block->getName());
 	if (!b) {
         blocks.append(block);
+        m_nameIndex.insert(block->getName(), block);
+        updateAnonymousNumbers(block->getName());
 
         if (notify) {
-            addNotification();
+            for(auto l: blockListListeners){
+                l->blockAdded(block);
+            }
         }
 		setModified(true);
 
@@ -130,6 +138,18 @@ void RS_BlockList::addNotification() {
 
 
 
+/**
+ * Notifies the listeners about a block that was changed, e.g. renamed or
+ * removed by its undo state.
+ */
+void RS_BlockList::editNotification(RS_Block* block) {
+	for(auto l: blockListListeners){
+		l->blockEdited(block);
+	}
+}
+
+
+
 /**
  * Removes a block from the list.
  * Listeners are notified after the block was removed from 
@@ -140,6 +160,8 @@ void RS_BlockList::remove(RS_Block* block) {
 
     // here the block is removed from the list but not deleted
     blocks.removeOne(block);
+    if (block != nullptr && m_nameIndex.value(block->getName()) == block)
+        m_nameIndex.remove(block->getName());
 
 	for(auto l: blockListListeners){
 		l->blockRemoved(block);
@@ -165,7 +187,7 @@ void RS_BlockList::remove(RS_Block* block) {
 
 /**
  * Tries to rename the given block to 'name'. Block names are unique in the
- * block list.
+ * block list. Listeners are notified.
  *
  * @retval true block was successfully renamed.
  * @retval false block couldn't be renamed.
@@ -174,7 +196,11 @@ bool RS_BlockList::rename(RS_Block* block, const QString& name) {
 	if (block) {
 		if (!find(name)) {
 			QString oldName = block->getName();
+			if (m_nameIndex.value(oldName) == block)
+				m_nameIndex.remove(oldName);
 			block->setName(name);
+			m_nameIndex.insert(name, block);
+			updateAnonymousNumbers(name);
 			setModified(true);
 
 			// when the renamed block is nested within other block, we need to rename its inserts as well
@@ -182,6 +208,8 @@ bool RS_BlockList::rename(RS_Block* block, const QString& name) {
 				b->renameInserts(oldName, name);
 			}
 
+			editNotification(block);
+
 			return true;
 		}
 	}
@@ -190,6 +218,35 @@ bool RS_BlockList::rename(RS_Block* block, const QString& name) {
 }
 
 
+int RS_BlockList::getAnonymousNumber(QChar type) const {
+    switch (type.toUpper().unicode()) {
+    case 'D':
+        return m_dimensionNumber;
+    case 'U':
+        return m_unnamedNumber;
+    default:
+        return 0;
+    }
+}
+
+void RS_BlockList::updateAnonymousNumbers(const QString& name) {
+    if (name.size() < 3 || name.at(0) != '*')
+        return;
+    int* number = nullptr;
+    switch (name.at(1).toUpper().unicode()) {
+    case 'D':
+        number = &m_dimensionNumber;
+        break;
+    case 'U':
+        number = &m_unnamedNumber;
+        break;
+    default:
+        return;
+    }
+    *number = std::max(*number, QStringView{name}.mid(2).toInt());
+}
+
+
 /**
  * Changes a block's attributes. The attributes of block 'block'
  * are copied from block 'source'.
@@ -219,12 +276,9 @@ RS_Block* RS_BlockList::find(const QString& name) {
         RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): wrong name to find");
         return nullptr;
     }
-	// Todo : reduce this from O(N) to O(log(N)) complexity based on sorted list or hash
-	//DFS
-	for(RS_Block* b: blocks) {
-		if (b->getName()==name) {
-			return b;
-		}
+	auto it = m_nameIndex.constFind(name);
+	if (it != m_nameIndex.cend()) {
+		return it.value();
 	}
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): bad");
 	return nullptr;
@@ -386,6 +440,8 @@ RS_Block* RS_BlockList::getActive() {
  */
 void RS_BlockList::setModified(bool m) {
 	modified = m;
+	if (m)
+		++version;
 
 	// Update each block modified status,
 	// but only when the status is set to false.
@@ -29,9 +29,10 @@
 #define RS_BLOCKLIST_H
 
 
+#include <QHash>
 #include <QList>
+#include <QString>
 
-class QString;
 class RS_Block;
 class RS_BlockListListener;
 
@@ -72,17 +73,27 @@ public:
 
     virtual bool add(RS_Block* block, bool notify=true);
     virtual void addNotification();
+    virtual void editNotification(RS_Block* block);
     virtual void remove(RS_Block* block);
     virtual bool rename(RS_Block* block, const QString& name);
     //virtual void editBlock(RS_Block* block, const RS_Block& source);
     RS_Block* find(const QString& name);
     QString newName(const QString& suggestion = "");
+    /**
+     * @return the highest number of the anonymous blocks named by '*', the type and
+     * a number: 'D' for dimensions, 'U' for other blocks. Maintained by add() and
+     * rename(), numbers of removed blocks are not reused.
+     */
+    int getAnonymousNumber(QChar type) const;
     void toggle(const QString& name);
     void toggle(RS_Block* block);
     void freezeAll(bool freeze);
 
     void addListener(RS_BlockListListener* listener);
     void removeListener(RS_BlockListListener* listener);
+    const QList<RS_BlockListListener*>& getListeners() const {
+        return blockListListeners;
+    }
 
     bool isOwner() const {return owner;}
     void setOwner(bool ow) {owner = ow;}
@@ -97,6 +108,12 @@ public:
      * @retval false The block list has not been modified.
      */
 	bool isModified() const;
+    /**
+     * @return a counter incremented whenever the list is set modified
+     */
+    unsigned long getVersion() const {
+        return version;
+    }
 
     friend std::ostream& operator << (std::ostream& os, RS_BlockList& b);
 
@@ -105,12 +122,19 @@ private:
     bool owner = false;
     //! Blocks in the graphic
     QList<RS_Block*> blocks;
+    //! Blocks by names, maintained by add(), remove() and rename()
+    QHash<QString, RS_Block*> m_nameIndex;
+    void updateAnonymousNumbers(const QString& name);
+    //! Highest numbers of *D and *U blocks
+    int m_dimensionNumber = 0;
+    int m_unnamedNumber = 0;
     //! List of registered BlockListListeners
     QList<RS_BlockListListener*> blockListListeners;
     //! Currently active block
     RS_Block* activeBlock = nullptr;
     /** Flag set if the block list was modified and not yet saved. */
     bool modified = false;
+    unsigned long version = 0;
 };
 
 #endif
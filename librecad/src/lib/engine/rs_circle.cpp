@@ -470,13 +470,11 @@ std::vector<RS_Circle> RS_Circle::solveAppolloniusSingle(const std::vector<RS_Ci
     if(std::abs(a)<RS_TOLERANCE*1e-4) {
         return ret;
     }
-    std::vector<double> ce(0,0.);
-    ce.push_back(2.*(dcp.dotP(vq)-radii[0])/a);
-    ce.push_back((dcp.squared()-radii[0]*radii[0])/a);
-    std::vector<double>&& vr=RS_Math::quadraticSolver(ce);
-    for(size_t i=0; i < vr.size();i++){
-        if(vr.at(i)<RS_TOLERANCE) continue;
-        ret.emplace_back(RS_Circle(nullptr, {vp+vq*vr.at(i),std::abs(vr.at(i))}));
+    const std::array<double, 2> ce{2.*(dcp.dotP(vq)-radii[0])/a,
+                                   (dcp.squared()-radii[0]*radii[0])/a};
+    for(const double r: RS_Math::quadraticSolver(ce)){
+        if(r<RS_TOLERANCE) continue;
+        ret.emplace_back(RS_Circle(nullptr, {vp+vq*r,std::abs(r)}));
     }
 //    std::cout<<__FILE__<<" : "<<__func__<<" : line "<<__LINE__<<std::endl;
 //    std::cout<<"Found "<<ret.size()<<" solutions"<<std::endl;
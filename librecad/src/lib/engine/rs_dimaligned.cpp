@@ -26,6 +26,7 @@
 
 #include <iostream>
 #include <cmath>
+#include "lc_regenstatistics.h"
 #include "rs_dimaligned.h"
 #include "rs_line.h"
 
@@ -153,6 +154,7 @@ RS_Vector const& RS_DimAligned::getExtensionPoint2() const {
 void RS_DimAligned::updateDim(bool autoText) {
 
     RS_DEBUG->print("RS_DimAligned::update");
+    const LC_RegenStatistics::Regen regen{LC_RegenStatistics::Dimension};
 
     clear();
 
@@ -28,6 +28,7 @@
 #include<cmath>
 #include<iostream>
 
+#include "lc_regenstatistics.h"
 #include "rs_arc.h"
 #include "rs_constructionline.h"
 #include "rs_debug.h"
@@ -288,6 +289,7 @@ void RS_DimAngular::updateDim(bool autoText /*= false*/)
 {
     Q_UNUSED( autoText)
     RS_DEBUG->print("RS_DimAngular::update");
+    const LC_RegenStatistics::Regen regen{LC_RegenStatistics::Dimension};
 
     clear();
 
@@ -25,6 +25,7 @@
 **********************************************************************/
 
 #include<iostream>
+#include "lc_regenstatistics.h"
 #include "rs_dimdiametric.h"
 #include "rs_graphic.h"
 #include "rs_units.h"
@@ -128,6 +129,7 @@ RS_VectorSolutions RS_DimDiametric::getRefPoints() const
 void RS_DimDiametric::updateDim(bool autoText) {
 
     RS_DEBUG->print("RS_DimDiametric::update");
+    const LC_RegenStatistics::Regen regen{LC_RegenStatistics::Dimension};
 
     clear();
 
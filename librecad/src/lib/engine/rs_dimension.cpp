@@ -26,14 +26,106 @@
 #include<iostream>
 #include<cmath>
 #include<string>
+#include<functional>
+#include<algorithm>
+#include<iterator>
+#include<utility>
+#include<vector>
+#include <QBrush>
+#include <QPainterPath>
+#include <QTransform>
 #include "rs_information.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
 #include "rs_line.h"
 #include "rs_dimension.h"
+#include "rs_graphicview.h"
+#include "rs_insert.h"
+#include "rs_painter.h"
 #include "rs_solid.h"
+#include "rs_text.h"
 #include "rs_units.h"
 #include "rs_math.h"
+#include "rs_fontlist.h"
+#include "rs_graphic.h"
 #include "rs_filterdxfrw.h" //for int <-> rs_color conversion
 
+namespace {
+// texts lower than this in pixels are drawn as their bounding box, as by RS_MText
+constexpr double textLodHeight = 4.;
+
+// appends the outline of a sub entity to strokes and its filled area to fills,
+// false for entities which aren't drawn as paths
+bool appendRenderPaths(QPainterPath& strokes, QPainterPath& fills, const RS_Entity& e) {
+    switch (e.rtti()) {
+    case RS2::EntityLine:
+        strokes.moveTo(e.getStartpoint().x, e.getStartpoint().y);
+        strokes.lineTo(e.getEndpoint().x, e.getEndpoint().y);
+        return true;
+    case RS2::EntityArc: {
+        // the angles of QPainterPath are clockwise in graph coordinates
+        auto& arc = static_cast<const RS_Arc&>(e);
+        const double radius = arc.getRadius();
+        const QRectF rect{arc.getCenter().x - radius, arc.getCenter().y - radius, 2. * radius, 2. * radius};
+        const double start = -RS_Math::rad2deg(arc.getAngle1());
+        const double sweep = RS_Math::rad2deg(arc.isReversed() ? arc.getAngleLength() : -arc.getAngleLength());
+        strokes.arcMoveTo(rect, start);
+        strokes.arcTo(rect, start, sweep);
+        return true;
+    }
+    case RS2::EntityCircle: {
+        auto& circle = static_cast<const RS_Circle&>(e);
+        strokes.addEllipse(QPointF{circle.getCenter().x, circle.getCenter().y},
+                           circle.getRadius(), circle.getRadius());
+        return true;
+    }
+    case RS2::EntitySolid: {
+        // arrows, as the triangles of RS_Solid::draw()
+        auto& solid = static_cast<const RS_Solid&>(e);
+        auto toPoint = [&solid](int corner) {
+            return QPointF{solid.getCorner(corner).x, solid.getCorner(corner).y};
+        };
+        fills.addPolygon(QPolygonF{toPoint(0), toPoint(1), toPoint(2)});
+        fills.closeSubpath();
+        if (!solid.isTriangle()) {
+            fills.addPolygon(QPolygonF{toPoint(1), toPoint(2), toPoint(3)});
+            fills.closeSubpath();
+        }
+        return true;
+    }
+    case RS2::EntityInsert:
+        // letters of the text
+        return RS_Text::appendGlyphPath(strokes, static_cast<const RS_Insert&>(e));
+    default:
+        if (!e.isContainer())
+            return false;
+        for (const RS_Entity* child: static_cast<const RS_EntityContainer&>(e)) {
+            if (!appendRenderPaths(strokes, fills, *child))
+                return false;
+        }
+        return true;
+    }
+}
+}
+
+/**
+ * The paths of the sub entities of a dimension, in graph coordinates. Each
+ * group is drawn in the pen of its first sub entity, given by the index, as
+ * the sub entities are shared by the clones of the dimension.
+ */
+struct RS_Dimension::RenderCache {
+    struct Group {
+        int index = 0;
+        // texts have their own group, small texts are drawn as boxes
+        bool isText = false;
+        QPainterPath strokes;
+        QPainterPath fills;
+    };
+    std::vector<Group> groups;
+    // false if a sub entity isn't drawn as paths
+    bool isPaths = true;
+};
+
 RS_DimensionData::RS_DimensionData():
 	definitionPoint(false),
 	middleOfText(false),
@@ -678,13 +770,13 @@ double RS_Dimension::getTextHeight() {
  * @return Dimension labels alignment text true= horizontal, false= aligned.
  */
 bool RS_Dimension::getInsideHorizontalText() {
-    int v = getGraphicVariableInt("$DIMTIH", 1);
-    if (v>0) {
+    // only written when missing or not 1, dimensions may be updated concurrently
+    int v = getGraphicVariableInt("$DIMTIH", -1);
+    if (v<0 || v>1) {
         addGraphicVariable("$DIMTIH", 1, 70);
-        getGraphicVariableInt("$DIMTIH", 1);
 		return true;
     }
-	return false;
+	return v==1;
 }
 
 
@@ -692,13 +784,7 @@ bool RS_Dimension::getInsideHorizontalText() {
  * @return Dimension fixed length for extension lines true= fixed, false= not fixed.
  */
 bool RS_Dimension::getFixedLengthOn() {
-    int v = getGraphicVariableInt("$DIMFXLON", 0);
-    if (v == 1) {
-        addGraphicVariable("$DIMFXLON", 1, 70);
-        getGraphicVariableInt("$DIMFXLON", 0);
-		return true;
-    }
-	return false;
+    return getGraphicVariableInt("$DIMFXLON", 0) == 1;
 }
 
 /**
@@ -756,6 +842,68 @@ QString RS_Dimension::getTextStyle() {
 }
 
 
+/**
+ * Adds the missing graphic variables of the dimension style with their defaults
+ * and loads the text font, so dimensions can be updated concurrently afterwards.
+ */
+void RS_Dimension::addDefaultStyleVariables() {
+    getGeneralFactor();
+    getGeneralScale();
+    getArrowSize();
+    getTickSize();
+    getExtensionLineExtension();
+    getExtensionLineOffset();
+    getDimensionLineGap();
+    getTextHeight();
+    getInsideHorizontalText();
+    getFixedLength();
+    RS_FONTLIST->requestFont(getTextStyle());
+}
+
+/**
+ * @return a hash of the graphic variables the dimension entities depend on,
+ * the $DIM variables and the unit, to find dimensions with an outdated style.
+ */
+std::size_t RS_Dimension::getStyleKey(RS_Graphic* graphic) {
+    if (graphic == nullptr)
+        return 0;
+
+    QStringList names;
+    const QHash<QString, RS_Variable>& variables = graphic->getVariableDict();
+    for (auto it = variables.cbegin(); it != variables.cend(); ++it) {
+        if (it.key().startsWith("$DIM") || it.key() == "$INSUNITS")
+            names << it.key();
+    }
+    names.sort();
+
+    std::size_t key = 0;
+    auto combine = [&key](std::size_t h) {
+        key ^= h + 0x9e3779b9 + (key << 6) + (key >> 2);
+    };
+    for (const QString& name: std::as_const(names)) {
+        const RS_Variable v = variables.value(name);
+        combine(qHash(name));
+        switch (v.getType()) {
+        case RS2::VariableString:
+            combine(qHash(v.getString()));
+            break;
+        case RS2::VariableInt:
+            combine(std::hash<int>{}(v.getInt()));
+            break;
+        case RS2::VariableDouble:
+            combine(std::hash<double>{}(v.getDouble()));
+            break;
+        case RS2::VariableVector:
+            combine(std::hash<double>{}(v.getVector().x));
+            combine(std::hash<double>{}(v.getVector().y));
+            break;
+        default:
+            break;
+        }
+    }
+    return key;
+}
+
 /**
  * @return the given graphic variable or the default value given in mm
  * converted to the graphic unit.
@@ -855,6 +1003,110 @@ QString RS_Dimension::stripZerosLinear(QString linear, int zeros){
 }
 
 
+void RS_Dimension::takeGeometry(RS_Dimension& updated) {
+    // the copy is deleted afterwards, its list is taken over as it is
+    QList<RS_Entity*> generated;
+    generated.swap(updated.entities);
+
+    clear();
+    reserveEntities(int(generated.size()));
+    for (RS_Entity* e: generated) {
+        e->setParent(this);
+        addEntity(e);
+    }
+    data = updated.data;
+    styleKey = updated.styleKey;
+    calculateBorders();
+}
+
+
+void RS_Dimension::clear() {
+    renderCache.reset();
+    RS_EntityContainer::clear();
+}
+
+
+std::shared_ptr<const RS_Dimension::RenderCache> RS_Dimension::createRenderCache() const {
+    auto cache = std::make_shared<RenderCache>();
+    for (int i = 0; i < entities.size(); ++i) {
+        const RS_Entity* e = entities.at(i);
+        const bool isText = e->rtti() == RS2::EntityMText;
+        auto group = std::find_if(cache->groups.begin(), cache->groups.end(),
+                                  [this, e, isText](const RenderCache::Group& g) {
+            const RS_Entity* first = entities.at(g.index);
+            return !isText && !g.isText && first->getPen(false) == e->getPen(false)
+                    && first->getLayer(false) == e->getLayer(false);
+        });
+        if (group == cache->groups.end()) {
+            cache->groups.push_back({i, isText, {}, {}});
+            group = std::prev(cache->groups.end());
+        }
+        if (!appendRenderPaths(group->strokes, group->fills, *e)) {
+            cache->isPaths = false;
+            break;
+        }
+    }
+    return cache;
+}
+
+
+void RS_Dimension::prepareDraw() {
+    if (renderCache == nullptr)
+        renderCache = createRenderCache();
+}
+
+
+/**
+ * Draws the sub entities as a few paths, one stroke and one fill path for
+ * each pen, instead of drawing every sub entity.
+ */
+void RS_Dimension::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) {
+    if (!(painter && view))
+        return;
+
+    // prepared on the GUI thread for concurrent drawing
+    if (!view->isConcurrentDrawing())
+        prepareDraw();
+
+    // a dimension drawn concurrently before it's prepared isn't cached
+    const std::shared_ptr<const RenderCache> cache = renderCache != nullptr ? renderCache : createRenderCache();
+    if (!cache->isPaths || view->isDraftMode()) {
+        RS_EntityContainer::draw(painter, view, patternOffset);
+        return;
+    }
+
+    // the graph to screen mapping of the view, the pen width stays in pixels
+    const RS_Vector origin = view->toGui(RS_Vector{0., 0.});
+    const RS_Vector unitX = view->toGui(RS_Vector{1., 0.}) - origin;
+    const RS_Vector unitY = view->toGui(RS_Vector{0., 1.}) - origin;
+    const QTransform toGui{unitX.x, unitX.y, unitY.x, unitY.y, origin.x, origin.y};
+    const bool isScreen = !view->isPrinting() && !view->isPrintPreview();
+
+    const QBrush brush(painter->brush());
+    for (const RenderCache::Group& group: cache->groups) {
+        RS_Entity* e = entities.at(group.index);
+        if (!e->isVisible() || e->isSelected() != painter->shouldDrawSelected())
+            continue;
+        if (group.isText && isScreen
+                && (view->isPanning() || view->toGuiDY(static_cast<RS_MText*>(e)->getHeight()) < textLodHeight)) {
+            view->drawEntity(painter, e);
+            continue;
+        }
+        double offset = 0.;
+        view->setPenForEntity(painter, e, offset);
+        if (!group.fills.isEmpty()) {
+            painter->setBrush(painter->getPen().getColor());
+            painter->drawPath(toGui.map(group.fills));
+        }
+        if (!group.strokes.isEmpty()) {
+            painter->setBrush(QBrush{Qt::NoBrush});
+            painter->drawPath(toGui.map(group.strokes));
+        }
+    }
+    painter->setBrush(brush);
+}
+
+
 void RS_Dimension::move(const RS_Vector& offset) {
 	data.definitionPoint.move(offset);
     data.middleOfText.move(offset);
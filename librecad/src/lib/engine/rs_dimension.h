@@ -28,6 +28,9 @@
 #ifndef RS_DIMENSION_H
 #define RS_DIMENSION_H
 
+#include <cstddef>
+#include <memory>
+
 #include "rs_entitycontainer.h"
 #include "rs_mtext.h"
 
@@ -129,6 +132,12 @@ public:
         }
 
     virtual void updateDim(bool autoText=false) = 0;
+    /**
+     * @brief takeGeometry replaces the sub entities and the label position by
+     * those of a copy of this dimension, updated by another thread. The sub
+     * entities of the copy are moved.
+     */
+    void takeGeometry(RS_Dimension& updated);
 
     void updateCreateDimensionLine(const RS_Vector& p1, const RS_Vector& p2,
                   bool arrow1=true, bool arrow2=true, bool autoText=false);
@@ -188,6 +197,17 @@ public:
     QString getTextStyle();
 
         double getGraphicVariable(const QString& key, double defMM, int code);
+        void addDefaultStyleVariables();
+        static std::size_t getStyleKey(RS_Graphic* graphic);
+
+        /** @return the style key of the graphic when the dimension was last updated
+         *  by RS_EntityContainer::updateDimensions() */
+        std::size_t getUpdatedStyleKey() const {
+            return styleKey;
+        }
+        void setUpdatedStyleKey(std::size_t key) {
+            styleKey = key;
+        }
         static QString stripZerosAngle(QString angle, int zeros=0);
         static QString stripZerosLinear(QString linear, int zeros=1);
 
@@ -205,6 +225,11 @@ public:
         return *this;
     }
 
+    /** removes the sub entities and the paths they are drawn by */
+    void clear() override;
+    void prepareDraw() override;
+    void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
+
 
 private:
     static RS_VectorSolutions  getIntersectionsLineContainer(
@@ -216,9 +241,16 @@ private:
         const RS_Vector& p1, const RS_Vector& p2,
         bool arrow1=true, bool arrow2=true, bool autoText=false);
 
+    /** the sub entities drawn as paths, grouped by pen */
+    struct RenderCache;
+    std::shared_ptr<const RenderCache> createRenderCache() const;
+    std::shared_ptr<const RenderCache> renderCache;
+
 protected:
     /** Data common to all dimension entities. */
     RS_DimensionData data;
+    /** style key of the last update by RS_EntityContainer::updateDimensions(), 0 if none */
+    std::size_t styleKey = 0;
 };
 
 #endif
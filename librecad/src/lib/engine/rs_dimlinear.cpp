@@ -26,6 +26,7 @@
 
 #include<iostream>
 #include<cmath>
+#include "lc_regenstatistics.h"
 #include "rs_dimlinear.h"
 #include "rs_line.h"
 #include "rs_constructionline.h"
@@ -156,6 +157,7 @@ bool RS_DimLinear::hasEndpointsWithinWindow(const RS_Vector& v1, const RS_Vector
 void RS_DimLinear::updateDim(bool autoText) {
 
     RS_DEBUG->print("RS_DimLinear::update");
+    const LC_RegenStatistics::Regen regen{LC_RegenStatistics::Dimension};
 
     clear();
 
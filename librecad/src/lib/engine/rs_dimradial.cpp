@@ -27,6 +27,7 @@
 #include <cmath>
 #include <iostream>
 
+#include "lc_regenstatistics.h"
 #include "rs_debug.h"
 #include "rs_dimradial.h"
 #include "rs_graphic.h"
@@ -129,6 +130,7 @@ RS_VectorSolutions RS_DimRadial::getRefPoints() const
 void RS_DimRadial::updateDim(bool autoText) {
 
     RS_DEBUG->print("RS_DimRadial::update");
+    const LC_RegenStatistics::Regen regen{LC_RegenStatistics::Dimension};
 
     clear();
 
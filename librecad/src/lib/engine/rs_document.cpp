@@ -26,8 +26,13 @@
 **********************************************************************/
 
 
+#include <algorithm>
+#include <unordered_set>
+
 #include "rs_document.h"
 #include "rs_debug.h"
+#include "rs_graphic.h"
+#include "rs_undocycle.h"
 
 
 /**
@@ -44,15 +49,134 @@ RS_Document::RS_Document(RS_EntityContainer* parent)
     RS_DEBUG->print("RS_Document::RS_Document() ");
 }
 
+RS_Document::~RS_Document()
+{
+    if (isOwner()) {
+        for (const auto& item: undoneEntities.positions)
+            delete item.first;
+    }
+}
+
+void* RS_Document::operator new(std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void RS_Document::operator delete(void* p, std::size_t /*size*/)
+{
+    ::operator delete(p);
+}
+
+void RS_Document::removeUndoable(RS_Undoable* u)
+{
+    if (u && u->undoRtti()==RS2::UndoableEntity && u->isUndone()) {
+        auto* entity = static_cast<RS_Entity*>(u);
+        if (undoneEntities.positions.erase(entity) == 1) {
+            if (isOwner())
+                delete entity;
+            return;
+        }
+        removeEntity(entity);
+    }
+}
+
+void RS_Document::undoCycleChanged(const RS_UndoCycle& cycle)
+{
+    advanceVersion();
+    // only entities of this document, entities of other containers stay in place
+    // with their undone flags
+    std::unordered_set<const RS_Entity*> undone;
+    std::vector<std::pair<int, RS_Entity*>> redone;
+    auto& positions = undoneEntities.positions;
+    for (RS_Undoable* u: cycle.getUndoables()) {
+        if (u->undoRtti() != RS2::UndoableEntity)
+            continue;
+        auto* entity = static_cast<RS_Entity*>(u);
+        if (entity->getParent() != this)
+            continue;
+        auto it = positions.find(entity);
+        if (entity->isUndone()) {
+            if (it == positions.end())
+                undone.insert(entity);
+        } else if (it != positions.end()) {
+            redone.emplace_back(it->second, entity);
+            positions.erase(it);
+        }
+    }
+
+    // the undo history restores the list in reverse order, so the positions of
+    // redone entities are those they were detached at
+    if (!redone.empty()) {
+        std::sort(redone.begin(), redone.end());
+        restoreEntities(redone);
+    }
+    if (!undone.empty()) {
+        for (const auto& [position, entity]: detachEntities([&undone](const RS_Entity* e) {
+                 return undone.count(e) == 1;
+             }))
+            positions.emplace(entity, position);
+    }
+}
+
+/**
+ * Removes the undone entities of the undoables in one pass
+ * through the entity container.
+ */
+void RS_Document::removeUndoables(const std::vector<RS_Undoable*>& undoables)
+{
+    std::unordered_set<const RS_Entity*> removed;
+    for (RS_Undoable* u: undoables) {
+        if (u == nullptr || u->undoRtti() != RS2::UndoableEntity || !u->isUndone())
+            continue;
+        auto* entity = static_cast<RS_Entity*>(u);
+        // entities taken out of the list are deleted directly
+        if (undoneEntities.positions.erase(entity) == 1) {
+            if (isOwner())
+                delete entity;
+        } else {
+            removed.insert(entity);
+        }
+    }
+    if (!removed.empty()) {
+        removeEntities([&removed](const RS_Entity* e) {
+            return removed.count(e) == 1;
+        });
+    }
+}
+
+std::vector<RS_Entity*> RS_Document::getUndoneLayerEntities(const RS_Layer* layer) const
+{
+    std::vector<std::pair<int, RS_Entity*>> found;
+    for (const auto& [entity, position]: undoneEntities.positions) {
+        if (entity->getLayer() == layer)
+            found.emplace_back(position, entity);
+    }
+    std::sort(found.begin(), found.end());
+    std::vector<RS_Entity*> entities;
+    entities.reserve(found.size());
+    for (const auto& item: found)
+        entities.push_back(item.second);
+    return entities;
+}
+
 /**
  * Overwritten to set modified flag when undo cycle finished with undoable(s).
  */
 void RS_Document::endUndoCycle()
 {
-    if (hasUndoable()) {
+    if (hasUndoable() && !isUndoCycleCancelled()) {
         setModified(true);
+        advanceVersion();
     }
 
     RS_Undo::endUndoCycle();
 }
 
+void RS_Document::advanceVersion()
+{
+    ++version;
+    RS_Document* graphic = getGraphic();
+    if (graphic != nullptr && graphic != this)
+        ++graphic->version;
+}
+
@@ -29,6 +29,9 @@
 #ifndef RS_DOCUMENT_H
 #define RS_DOCUMENT_H
 
+#include <unordered_map>
+
+#include "lc_rendercache.h"
 #include "rs_entitycontainer.h"
 #include "rs_undo.h"
 
@@ -47,6 +50,12 @@ class RS_Document : public RS_EntityContainer,
     public RS_Undo {
 public:
 	RS_Document(RS_EntityContainer* parent=nullptr);
+    ~RS_Document() override;
+
+    //! \{ documents are not allocated from the entity arenas, graphics own one
+    static void* operator new(std::size_t size);
+    static void operator delete(void* p, std::size_t size);
+    //! \}
 
     virtual RS_LayerList* getLayerList()= 0;
     virtual RS_BlockList* getBlockList() = 0;
@@ -69,11 +78,8 @@ public:
      * Removes an entity from the entity container. Implementation
      * from RS_Undo.
      */
-    void removeUndoable(RS_Undoable* u) override {
-        if (u && u->undoRtti()==RS2::UndoableEntity && u->isUndone()) {
-			removeEntity(static_cast<RS_Entity*>(u));
-        }
-    }
+    void removeUndoable(RS_Undoable* u) override;
+    void removeUndoables(const std::vector<RS_Undoable*>& undoables) override;
 
     /**
      * @return Currently active drawing pen.
@@ -104,6 +110,13 @@ public:
         return autosaveFilename;
     }
 
+    /**
+     * @return Format type of the document currently loaded.
+     */
+    RS2::FormatType getFormatType() const {
+        return formatType;
+    }
+
     /**
      * Sets file name for the document currently loaded.
      */
@@ -132,10 +145,35 @@ public:
      */
      void endUndoCycle() override;
 
+    /**
+     * @return a counter incremented by finished, undone and redone undo cycles of
+     * this document, and of the blocks for graphics.
+     */
+    unsigned long getVersion() const {
+        return version;
+    }
+
     void setGraphicView(RS_GraphicView * g) {gv = g;}
     RS_GraphicView* getGraphicView() {return gv;}
 
+    /**
+     * @return render data shared by all views of this document
+     */
+    const LC_RenderCache& getRenderCache() const {return renderCache;}
+
+    /**
+     * @return the undone entities on the layer, which are out of the entity list
+     * and so not found by getLayerEntities(), in the order of the list.
+     */
+    std::vector<RS_Entity*> getUndoneLayerEntities(const RS_Layer* layer) const;
+
 protected:
+    /**
+     * Moves the undone entities of this document out of the entity list, and the
+     * redone ones back, so traversals visit live entities only.
+     */
+    void undoCycleChanged(const RS_UndoCycle& cycle) override;
+
     /** Flag set if the document was modified and not yet saved. */
     bool modified = false;
     /** Active pen. */
@@ -148,6 +186,28 @@ protected:
     RS2::FormatType formatType = RS2::FormatUnknown;
     //used to read/save current view
     RS_GraphicView * gv = nullptr;
+    /** Render data of the entities, shared by the views */
+    LC_RenderCache renderCache;
+
+private:
+    //! increments the version, of the graphic too for blocks
+    void advanceVersion();
+
+    unsigned long version = 0;
+    /**
+     * Undone entities of this document, out of the entity list until they're redone
+     * or removed with their undo cycles. Copies of the document start without them.
+     */
+    struct UndoneEntities {
+        UndoneEntities() = default;
+        UndoneEntities(const UndoneEntities&) {}
+        UndoneEntities& operator = (const UndoneEntities&) {
+            return *this;
+        }
+        //! the positions in the entity list the entities are restored at
+        std::unordered_map<RS_Entity*, int> positions;
+    };
+    UndoneEntities undoneEntities;
 
 };
 #endif
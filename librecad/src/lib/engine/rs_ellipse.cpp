@@ -143,6 +143,12 @@ RS_Vector getNearestDistHelper(RS_Ellipse const& e,
     return vp;
 }
 
+bool isSameEllipse(const RS_EllipseData& d1, const RS_EllipseData& d2)
+{
+    return d1.center == d2.center && d1.majorP == d2.majorP && d1.ratio == d2.ratio
+            && d1.angle1 == d2.angle1 && d1.angle2 == d2.angle2 && d1.reversed == d2.reversed;
+}
+
 /**
  * @brief The ClosestElliptic class: find the closest point on an ellipse for a given point.
  * Intended for ellipses with small eccentricities.
@@ -372,8 +378,15 @@ RS_Vector RS_Ellipse::getTangentDirection(const RS_Vector &point) const {
   *
   * \author: Dongxu Li
   */
+/**
+ * @return the length, cached as long as the ellipse data doesn't change, as the
+ * elliptic integral is expensive
+ */
 double RS_Ellipse::getLength() const
 {
+    if (m_length >= 0. && isSameEllipse(m_lengthData, data))
+        return m_length;
+
     RS_Ellipse e(nullptr, data);
     //switch major/minor axis, because we need the ratio smaller than one
     if(e.getRatio()>1.)  e.switchMajorMinor();
@@ -381,7 +394,9 @@ double RS_Ellipse::getLength() const
         e.setReversed(false);
         std::swap(e.data.angle1,e.data.angle2);
     }
-    return e.getEllipseLength(e.data.angle1,e.data.angle2);
+    m_lengthData = data;
+    m_length = e.getEllipseLength(e.data.angle1,e.data.angle2);
+    return m_length;
 }
 
 /**
@@ -558,8 +573,8 @@ RS_Vector RS_Ellipse::getNearestPointOnEntity(const RS_Vector& coord,
     double twoax=2*a*x;
     double twoby=2*b*y;
     double a0=twoa2b2*twoa2b2;
-    std::vector<double> ce(4,0.);
-    std::vector<double> roots(0,0.);
+    std::array<double, 4> ce{};
+    RS_Math::Roots roots;
 
     //need to handle: a=b (i.e. a0=0); point close to the ellipse origin.
     if (a0 > RS_TOLERANCE && std::abs(getRatio() - 1.0) > RS_TOLERANCE && ret.squared() > RS_TOLERANCE2 ) {
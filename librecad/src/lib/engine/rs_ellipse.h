@@ -245,6 +245,11 @@ public:
 
 protected:
     RS_EllipseData data;
+
+private:
+    // see getLength()
+    mutable RS_EllipseData m_lengthData;
+    mutable double m_length = -1.;
 };
 
 #endif
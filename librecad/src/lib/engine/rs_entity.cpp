@@ -26,11 +26,18 @@
 **********************************************************************/
 
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 #include <QPolygon>
 #include <QString>
 
+#include "lc_entitypool.h"
+#include "lc_rendercache.h"
 #include "rs_arc.h"
 #include "rs_block.h"
 #include "rs_circle.h"
@@ -51,6 +58,40 @@
 
 #include "lc_quadratic.h"
 
+namespace {
+// side table of user defined variables, they are rarely used
+struct UserDefVars {
+    using Vars = std::map<QString, QString>;
+
+    std::mutex mutex;
+    std::unordered_map<const RS_Entity*, Vars> vars;
+    // fast path for entity destruction, no locking until any variable is set
+    std::atomic<bool> used{false};
+};
+
+// never destroyed, entities may outlive static destruction
+UserDefVars& userDefVars()
+{
+    static UserDefVars* instance = new UserDefVars;
+    return *instance;
+}
+
+void copyUserDefVars(const RS_Entity* from, const RS_Entity* to)
+{
+    UserDefVars& table = userDefVars();
+    if (!table.used)
+        return;
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto it = table.vars.find(from);
+    if (it != table.vars.end()) {
+        UserDefVars::Vars copy = it->second;
+        table.vars[to] = std::move(copy);
+    } else {
+        table.vars.erase(to);
+    }
+}
+}
+
 /**
  * Default constructor.
  * @param parent The parent entity of this entity.
@@ -63,6 +104,62 @@ RS_Entity::RS_Entity(RS_EntityContainer *parent)
     init();
 }
 
+RS_Entity::RS_Entity(const RS_Entity& other):
+    RS_Undoable{other}
+  , updateEnabled{other.updateEnabled}
+  , parent{other.parent}
+  , minV{other.minV}
+  , maxV{other.maxV}
+  , layer{other.layer}
+  , id{other.id}
+  , penHandle{other.penHandle}
+{
+    copyUserDefVars(&other, this);
+}
+
+RS_Entity& RS_Entity::operator = (const RS_Entity& other)
+{
+    if (this != &other) {
+        RS_EntityContainer* oldParent = parent;
+        RS_Layer* oldLayer = layer;
+        RS_Undoable::operator = (other);
+        updateEnabled = other.updateEnabled;
+        parent = other.parent;
+        minV = other.minV;
+        maxV = other.maxV;
+        layer = other.layer;
+        id = other.id;
+        penHandle = other.penHandle;
+        copyUserDefVars(&other, this);
+        if (isContainer())
+            LC_RenderCache::invalidatePens();
+        if (parent != nullptr && parent == oldParent) {
+            parent->selectionChanged(this);
+            parent->layerChanged(this, oldLayer);
+        }
+    }
+    return *this;
+}
+
+RS_Entity::~RS_Entity()
+{
+    UserDefVars& table = userDefVars();
+    if (table.used) {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        table.vars.erase(this);
+    }
+}
+
+void* RS_Entity::operator new(std::size_t size)
+{
+    return LC_EntityPool::allocate(size);
+}
+
+void RS_Entity::operator delete(void* p, std::size_t size)
+{
+    LC_EntityPool::deallocate(p, size);
+}
+
 
 /**
  * Copy constructor.
@@ -97,7 +194,8 @@ void RS_Entity::init() {
  * Gives this entity a new unique id.
  */
 void RS_Entity::initId() {
-    static unsigned long long idCounter=0;
+    // temporary entities may be created while drawing concurrently
+    static std::atomic<unsigned long long> idCounter{0};
     id = idCounter++;
 }
 
@@ -140,6 +238,8 @@ bool RS_Entity::setSelected(bool select) {
     } else {
         delFlag(RS2::FlagSelected);
     }
+    if (parent != nullptr)
+        parent->selectionChanged(this);
 
     return true;
 }
@@ -223,6 +323,47 @@ void RS_Entity::undoStateChanged(bool undone)
 
     setSelected(false);
     update();
+    if (parent != nullptr)
+        parent->visibilityChanged(this);
+}
+
+void RS_Entity::changeUndoStates(const std::vector<RS_Entity*>& entities)
+{
+    std::vector<RS_Entity*> texts;
+    std::vector<RS_Insert*> inserts;
+    std::vector<RS_EntityContainer*> parents;
+    for (RS_Entity* e: entities) {
+        e->toggleFlag(RS2::FlagUndone);
+        e->setSelected(false);
+        // undone entities are neither drawn nor found, they're updated once redone
+        if (!e->isUndone()) {
+            switch (e->rtti()) {
+            case RS2::EntityText:
+            case RS2::EntityMText:
+                texts.push_back(e);
+                break;
+            case RS2::EntityInsert:
+                inserts.push_back(static_cast<RS_Insert*>(e));
+                break;
+            default:
+                e->update();
+                break;
+            }
+        }
+        // entities of a cycle mostly share their parent
+        if (e->parent != nullptr && (parents.empty() || parents.back() != e->parent))
+            parents.push_back(e->parent);
+    }
+    RS_Text::updateAll(texts);
+    if (!inserts.empty()) {
+        RS_Insert::UpdatePass pass;
+        RS_Insert::updateAll(inserts, pass);
+    }
+
+    std::sort(parents.begin(), parents.end());
+    parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+    for (RS_EntityContainer* container: parents)
+        container->visibilityChanged(nullptr);
 }
 
 
@@ -744,11 +885,31 @@ RS_Layer* RS_Entity::getLayer(bool resolve) const {
  */
 void RS_Entity::setLayer(const QString& name) {
     RS_Graphic* graphic = getGraphic();
-    if (graphic) {
-        layer = graphic->findLayer(name);
-    } else {
-		layer = nullptr;
-    }
+    setLayer(graphic != nullptr ? graphic->findLayer(name) : nullptr);
+}
+
+
+
+/**
+ * Reparents this entity.
+ */
+void RS_Entity::setParent(RS_EntityContainer* p) {
+    parent = p;
+    // ByBlock pens of the children are resolved by the parents of the container
+    if (isContainer())
+        LC_RenderCache::invalidatePens();
+}
+
+
+
+/**
+ * Sets the explicit pen for this entity or a pen with special
+ * attributes such as BY_LAYER, ..
+ */
+void RS_Entity::setPen(const RS_Pen& pen) {
+    penHandle = LC_PenTable::intern(pen);
+    if (isContainer())
+        LC_RenderCache::invalidatePens();
 }
 
 
@@ -757,7 +918,13 @@ void RS_Entity::setLayer(const QString& name) {
  * Sets the layer of this entity to the layer given.
  */
 void RS_Entity::setLayer(RS_Layer* l) {
+    RS_Layer* oldLayer = layer;
     layer = l;
+    if (parent != nullptr)
+        parent->layerChanged(this, oldLayer);
+    // the pens of the children are resolved by the container layer
+    if (isContainer())
+        LC_RenderCache::invalidatePens();
 }
 
 
@@ -770,11 +937,7 @@ void RS_Entity::setLayer(RS_Layer* l) {
 void RS_Entity::setLayerToActive() {
     RS_Graphic* graphic = getGraphic();
 
-    if (graphic) {
-        layer = graphic->getActiveLayer();
-    } else {
-		layer = nullptr;
-    }
+    setLayer(graphic != nullptr ? graphic->getActiveLayer() : nullptr);
 }
 
 
@@ -793,10 +956,10 @@ void RS_Entity::setLayerToActive() {
 RS_Pen RS_Entity::getPen(bool resolve) const {
 
     if (!resolve) {
-        return pen;
+        return LC_PenTable::get(penHandle);
     } else {
 
-        RS_Pen p = pen;
+        RS_Pen p = LC_PenTable::get(penHandle);
         RS_Layer* l = getLayer(true);
 
         // use parental attributes (e.g. vertex of a polyline, block
@@ -866,7 +1029,7 @@ RS_Pen RS_Entity::getPen(bool resolve) const {
 void RS_Entity::setPenToActive() {
     RS_Document* doc = getDocument();
     if (doc) {
-        pen = doc->getActivePen();
+        setPen(doc->getActivePen());
     } else {
         //RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Entity::setPenToActive(): "
         //                "No document / active pen linked to this entity.");
@@ -950,9 +1113,14 @@ double RS_Entity::getStyleFactor(RS_GraphicView* view) {
  * @return User defined variable connected to this entity or nullptr if not found.
  */
 QString RS_Entity::getUserDefVar(const QString& key) const {
-	auto it=varList.find(key);
-	if(it==varList.end()) return nullptr;
-	return varList.at(key);
+	UserDefVars& table = userDefVars();
+	if (!table.used) return nullptr;
+	std::lock_guard<std::mutex> lock(table.mutex);
+	auto vars = table.vars.find(this);
+	if (vars == table.vars.end()) return nullptr;
+	auto it = vars->second.find(key);
+	if (it == vars->second.end()) return nullptr;
+	return it->second;
 }
 /*
  * @coord
@@ -971,14 +1139,24 @@ RS_Vector RS_Entity::getNearestOrthTan(const RS_Vector& /*coord*/,
  * Add a user defined variable to this entity.
  */
 void RS_Entity::setUserDefVar(QString key, QString val) {
-	varList.insert(std::make_pair(key, val));
+	UserDefVars& table = userDefVars();
+	std::lock_guard<std::mutex> lock(table.mutex);
+	table.used = true;
+	table.vars[this].insert(std::make_pair(key, val));
 }
 
 /**
  * Deletes the given user defined variable.
  */
 void RS_Entity::delUserDefVar(QString key) {
-	varList.erase(key);
+	UserDefVars& table = userDefVars();
+	if (!table.used) return;
+	std::lock_guard<std::mutex> lock(table.mutex);
+	auto vars = table.vars.find(this);
+	if (vars == table.vars.end()) return;
+	vars->second.erase(key);
+	if (vars->second.empty())
+		table.vars.erase(vars);
 }
 
 /**
@@ -986,7 +1164,12 @@ void RS_Entity::delUserDefVar(QString key) {
  */
 std::vector<QString> RS_Entity::getAllKeys() const{
 	std::vector<QString> ret(0);
-	for(auto const& v: varList){
+	UserDefVars& table = userDefVars();
+	if (!table.used) return ret;
+	std::lock_guard<std::mutex> lock(table.mutex);
+	auto vars = table.vars.find(this);
+	if (vars == table.vars.end()) return ret;
+	for(auto const& v: vars->second){
 		ret.push_back(v.first);
 	}
 	return ret;
@@ -1073,12 +1256,12 @@ std::ostream& operator << (std::ostream& os, RS_Entity& e) {
         os << " layer address: " << e.layer << " ";
     }
 
-    os << e.pen << "\n";
+    os << e.getPen(false) << "\n";
 
         os << "variable list:\n";
-	for(auto const& v: e.varList){
-		os << v.first.toLatin1().data()<< ": "
-		   << v.second.toLatin1().data()
+	for(auto const& key: e.getAllKeys()){
+		os << key.toLatin1().data()<< ": "
+		   << e.getUserDefVar(key).toLatin1().data()
 			   << ", ";
 	}
 
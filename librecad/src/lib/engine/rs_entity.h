@@ -29,7 +29,10 @@
 #ifndef RS_ENTITY_H
 #define RS_ENTITY_H
 
+#include <cstddef>
 #include <map>
+#include <vector>
+#include "lc_pentable.h"
 #include "rs_vector.h"
 #include "rs_pen.h"
 #include "rs_undoable.h"
@@ -61,6 +64,17 @@ class QString;
 class RS_Entity : public RS_Undoable {
 public:
 	RS_Entity(RS_EntityContainer* parent=nullptr);
+    /**
+     * Copies the user defined variables along with the entity.
+     */
+    RS_Entity(const RS_Entity& other);
+    RS_Entity& operator = (const RS_Entity& other);
+    ~RS_Entity() override;
+
+    //! \{ entities are allocated from LC_EntityPool
+    static void* operator new(std::size_t size);
+    static void operator delete(void* p, std::size_t size);
+    //! \}
 
     void init();
     virtual void initId();
@@ -129,9 +143,7 @@ public:
     /**
      * Reparents this entity.
      */
-    void setParent(RS_EntityContainer* p) {
-        parent = p;
-    }
+    void setParent(RS_EntityContainer* p);
     /** @return The center point (x) of this arc */
     //get center for entities: arc, circle and ellipse
 	virtual RS_Vector getCenter() const;
@@ -151,8 +163,12 @@ public:
      * Sets the explicit pen for this entity or a pen with special
      * attributes such as BY_LAYER, ..
      */
-    void setPen(const RS_Pen& pen) {
-        this->pen = pen;
+    void setPen(const RS_Pen& pen);
+    /**
+     * @return the handle of the explicit pen, equal for entities with equal pens
+     */
+    LC_PenTable::Handle getPenHandle() const {
+        return penHandle;
     }
 
 
@@ -206,6 +222,12 @@ public:
 	bool isLocked() const;
 
 	void undoStateChanged(bool undone) override;
+    /**
+     * @brief changeUndoStates undoes or redoes the entities in bulk, as their
+     * changeUndoState() one by one would. Only redone entities are updated, texts
+     * and inserts concurrently; each parent container is notified once
+     */
+    static void changeUndoStates(const std::vector<RS_Entity*>& entities);
     virtual bool isUndone() const;
 
     /**
@@ -547,6 +569,14 @@ public:
      */
     virtual void draw(RS_Painter* painter, RS_GraphicView* view,
                       double& patternOffset ) = 0;
+    /**
+     * Can be implemented by child classes to update data cached for drawing.
+     * prepareDraw() is called on the GUI thread before draw() is called from
+     * worker threads. While the view is drawing concurrently, draw() must not
+     * modify the entity or any shared state.
+     * @see RS_GraphicView::isConcurrentDrawing()
+     */
+    virtual void prepareDraw() {}
 
     double getStyleFactor(RS_GraphicView* view);
 
@@ -600,6 +630,10 @@ m0 x + m1 y + m2 =0
     virtual bool isArcCircleLine() const;
 
 protected:
+    // declared first to fill the padding after the flags of the base
+    //! auto updating enabled?
+    bool updateEnabled = false;
+
 	//! Entity's parent entity or nullptr is this entity has no parent.
 	RS_EntityContainer* parent = nullptr;
     //! minimum coordinates
@@ -613,14 +647,11 @@ protected:
     //! Entity id
     unsigned long long id = 0;
 
-    //! pen (attributes) for this entity
-    RS_Pen pen;
-
-    //! auto updating enabled?
-    bool updateEnabled = false;
+    //! pen (attributes) for this entity, interned in LC_PenTable
+    LC_PenTable::Handle penHandle = LC_PenTable::defaultHandle;
 
-private:
-    std::map<QString, QString> varList;
+    // User defined variables are rare, and are kept in a side table keyed by
+    // entity, instead of a map in every entity
 };
 
 #endif
@@ -24,12 +24,21 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 #include <QtGlobal>
 #include "lc_looputils.h"
+#include "lc_regenstatistics.h"
+#include "lc_spatialindex.h"
+#include "lc_taskscheduler.h"
 
 #include "qg_dialogfactory.h"
 
@@ -40,14 +49,36 @@
 #include "rs_dialogfactory.h"
 #include "rs_ellipse.h"
 #include "rs_entitycontainer.h"
+#include "rs_graphic.h"
 #include "rs_graphicview.h"
 #include "rs_information.h"
 #include "rs_insert.h"
 #include "rs_layer.h"
+#include "rs_layerlist.h"
 #include "rs_line.h"
 #include "rs_solid.h"
 
 namespace {
+// from this number on, dimensions are updated concurrently
+constexpr std::size_t parallelDimensionsMinimum = 1000;
+// from this number of candidates on, entities are tested concurrently for selections
+constexpr std::size_t parallelSelectionMinimum = 5000;
+// from this number of entities on, lengths are computed concurrently
+constexpr std::size_t parallelLengthMinimum = 5000;
+// least entities of a task of the concurrent loops
+constexpr std::size_t parallelGrain = 256;
+// from this number of generated entities on, like pattern lines or glyphs, the
+// children are picked through a spatial index
+constexpr unsigned childIndexMinimum = 64;
+// from this number of entities on, entities are tested for the nearest entity in
+// the order of their bounding box distances, without a spatial index
+constexpr int sortedNearestMinimum = 8;
+// up to this number of restored entities, entities are inserted one by one, instead
+// of a merge and renumbering of the spatial index
+constexpr std::size_t restoredInsertMaximum = 64;
+
+// the last key given to a container, see getCacheKey()
+std::atomic<unsigned long long> g_lastCacheKey{0};
 
 // the tolerance used to check topology of contours in hatching
 constexpr double contourTolerance = 1e-8;
@@ -75,6 +106,170 @@ double endPointDistance(const RS_Vector& point, const RS_Entity& entity)
     entity.getNearestEndpoint(point, &distance);
     return distance;
 }
+
+// Endpoints of contour edges hashed by grid cells of the contour tolerance, so the
+// edges connected to an endpoint are found without visiting all the edges
+class EndpointGrid {
+public:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    void insert(const RS_Vector& point, std::size_t edge)
+    {
+        if (point.valid)
+            m_cells[{cellOf(point.x), cellOf(point.y)}].emplace_back(point, edge);
+    }
+
+    // the edge with the endpoint closest to the point within the tolerance,
+    // among the edges not used yet, or npos
+    std::size_t findNearest(const RS_Vector& point, const std::vector<bool>& used, double& dist) const
+    {
+        std::size_t found = npos;
+        dist = RS_MAXDOUBLE;
+        const std::int64_t cx = cellOf(point.x);
+        const std::int64_t cy = cellOf(point.y);
+        for (std::int64_t x = cx - 1; x <= cx + 1; ++x) {
+            for (std::int64_t y = cy - 1; y <= cy + 1; ++y) {
+                auto it = m_cells.find({x, y});
+                if (it == m_cells.end())
+                    continue;
+                for (const auto& [endpoint, edge]: it->second) {
+                    const double d = endpoint.distanceTo(point);
+                    if (!used[edge] && d <= contourTolerance && d < dist) {
+                        dist = d;
+                        found = edge;
+                    }
+                }
+            }
+        }
+        return found;
+    }
+
+private:
+    struct CellHash {
+        std::size_t operator()(const std::pair<std::int64_t, std::int64_t>& cell) const
+        {
+            return std::hash<std::int64_t>{}(cell.first) * 1000003u ^ std::hash<std::int64_t>{}(cell.second);
+        }
+    };
+
+    static std::int64_t cellOf(double coordinate)
+    {
+        // far away cells are merged, instead of overflowing
+        constexpr double limit = double(std::int64_t{1} << 62);
+        return std::int64_t(std::clamp(std::floor(coordinate / contourTolerance), -limit, limit));
+    }
+
+    std::unordered_map<std::pair<std::int64_t, std::int64_t>,
+                       std::vector<std::pair<RS_Vector, std::size_t>>, CellHash> m_cells;
+};
+
+// The distance from a point to the bounding box of an entity, the bounding box
+// is ignored, if it's not valid
+double boxDistance(const RS_Vector& point, const RS_Entity& entity)
+{
+    const RS_Vector minV = entity.getMin();
+    const RS_Vector maxV = entity.getMax();
+    if (!(minV.x <= maxV.x && minV.y <= maxV.y))
+        return 0.;
+    const double dx = std::max({minV.x - point.x, 0., point.x - maxV.x});
+    const double dy = std::max({minV.y - point.y, 0., point.y - maxV.y});
+    return std::hypot(dx, dy);
+}
+
+// The distance from a point to a top level entity, as tested by getDistanceToPoint()
+// returns false, if the entity is not considered
+bool entityDistance(const RS_Vector& coord, RS_Entity* e, RS2::ResolveLevel level, double solidDist,
+                    double& curDist, RS_Entity*& closest)
+{
+    if (!e->isVisible() || (e->getLayer() != nullptr && e->getLayer()->isLocked()))
+        return false;
+    // bug#426, need to ignore Images to find nearest intersections
+    if(level==RS2::ResolveAllButTextImage && e->rtti()==RS2::EntityImage)
+        return false;
+    // the sub-entity is only requested, if it's picked, entities may create it on demand
+    const bool resolve = level == RS2::ResolveAll || level == RS2::ResolveAllButTextImage;
+    RS_Entity* subEntity = nullptr;
+    curDist = e->getDistanceToPoint(coord, resolve ? &subEntity : nullptr, level, solidDist);
+    closest = resolve ? subEntity : e;
+    return true;
+}
+
+// whether the entity is an infinite line: construction lines, and lines on
+// construction layers, which are drawn as infinite lines
+bool isInfinite(const RS_Entity& e)
+{
+    return e.rtti() == RS2::EntityConstructionLine
+            || (e.rtti() == RS2::EntityLine && e.isConstruction());
+}
+
+// whether the infinite line of the entity intersects the area
+bool crossesInfinitely(const RS_Entity& e, const LC_Rect& area)
+{
+    if (e.rtti() == RS2::EntityConstructionLine) {
+        const auto& line = static_cast<const RS_ConstructionLine&>(e);
+        return area.crossesLine(line.getPoint1(), line.getPoint2());
+    }
+    const auto& line = static_cast<const RS_Line&>(e);
+    return area.crossesLine(line.getStartpoint(), line.getEndpoint());
+}
+
+// whether the entity extends the extents of the drawing, as merged by mergeBorders(),
+// without the infinite lines
+bool isInExtents(const RS_Entity& e)
+{
+    const RS_Layer* layer = e.getLayer();
+    return e.isVisible() && !(layer && layer->isFrozen())
+            && !(e.isContainer() && e.count() == 0) && !isInfinite(e);
+}
+
+// Whether the container is resolved into its children by the resolve level
+bool isResolved(const RS_Entity& entity, RS2::ResolveLevel level)
+{
+    if (!entity.isContainer())
+        return false;
+    switch (level) {
+    case RS2::ResolveAll:
+        return true;
+    case RS2::ResolveAllButInserts:
+        return entity.rtti() != RS2::EntityInsert;
+    case RS2::ResolveAllButTextImage:
+    case RS2::ResolveAllButTexts:
+        return entity.rtti() != RS2::EntityText && entity.rtti() != RS2::EntityMText;
+    default:
+        return false;
+    }
+}
+}
+
+/**
+ * Intersections of entities with other entities in the container, cached for
+ * repeated queries of intersection snapping.
+ */
+struct RS_EntityContainer::IntersectionCache {
+    // upper limit of cached entities
+    static constexpr size_t maxEntries = 64;
+
+    struct Entry {
+        // borders of the entity, when the intersections were found
+        RS_Vector minV;
+        RS_Vector maxV;
+        std::vector<std::pair<RS_Entity*, RS_Vector>> intersections;
+    };
+    std::unordered_map<const RS_Entity*, Entry> entries;
+};
+
+struct RS_EntityContainer::BordersCache {
+    // the revision, the frozen and the construction layers the borders were found for
+    unsigned long revision = 0;
+    std::vector<const RS_Layer*> frozenLayers;
+    std::vector<const RS_Layer*> constructionLayers;
+    RS_Vector minV;
+    RS_Vector maxV;
+};
+
+RS_EntityContainer::CacheKey::CacheKey():
+    value{++g_lastCacheKey}
+{
 }
 
 /**
@@ -96,14 +291,43 @@ RS_EntityContainer::RS_EntityContainer(RS_EntityContainer* parent,
 
 
 /**
- * Copy constructor. Makes a deep copy of all entities.
+ * Copy constructor. Makes a shallow copy of the entity list, detach()
+ * is needed to make deep copies of the entities.
+ * The spatial index is not copied.
  */
-/*
-RS_EntityContainer::RS_EntityContainer(const RS_EntityContainer& ec)
- : RS_Entity(ec) {
+RS_EntityContainer::RS_EntityContainer(const RS_EntityContainer& other)
+    : RS_Entity(other)
+    , entities{other.entities}
+    , subContainer{other.subContainer}
+    , autoUpdateBorders{other.autoUpdateBorders}
+    , entIdx{other.entIdx}
+    , autoDelete{other.autoDelete}
+{
+}
 
+RS_EntityContainer& RS_EntityContainer::operator = (const RS_EntityContainer& other)
+{
+    if (this == &other)
+        return *this;
+    RS_Entity::operator = (other);
+    entities = other.entities;
+    subContainer = other.subContainer;
+    autoUpdateBorders = other.autoUpdateBorders;
+    entIdx = other.entIdx;
+    autoDelete = other.autoDelete;
+    invalidateIntersections();
+    if (m_spatialIndex != nullptr) {
+        m_spatialIndex->clear();
+        m_selectedEntities->clear();
+        m_layerEntities->clear();
+        m_constructionLines->clear();
+        for (int i = 0; i < entities.size(); ++i) {
+            m_spatialIndex->insert(entities.at(i), i);
+            trackEntity(entities.at(i));
+        }
+    }
+    return *this;
 }
-*/
 
 
 
@@ -112,10 +336,10 @@ RS_EntityContainer::RS_EntityContainer(const RS_EntityContainer& ec)
  */
 RS_EntityContainer::~RS_EntityContainer() {
     if (autoDelete) {
-        while (!entities.isEmpty())
-            delete entities.takeFirst();
-    } else
-        entities.clear();
+        for (RS_Entity* e: std::as_const(entities))
+            delete e;
+    }
+    entities.clear();
 }
 
 
@@ -143,6 +367,7 @@ RS_Entity* RS_EntityContainer::clone() const{
  * This is called after cloning entity containers.
  */
 void RS_EntityContainer::detach() {
+    invalidateBorders();
     QList<RS_Entity*> tmp;
     bool autoDel = isOwner();
     RS_DEBUG->print("RS_EntityContainer::detach: autoDel: %d",
@@ -182,6 +407,7 @@ void RS_EntityContainer::reparent(RS_EntityContainer* parent) {
 
 
 void RS_EntityContainer::setVisible(bool v) {
+    invalidateBorders();
     //    RS_DEBUG->print("RS_EntityContainer::setVisible: %d", v);
     RS_Entity::setVisible(v);
 
@@ -276,66 +502,81 @@ void RS_EntityContainer::setHighlighted(bool on)
 void RS_EntityContainer::selectWindow(enum RS2::EntityType typeToSelect,RS_Vector v1, RS_Vector v2,
                                       bool select, bool cross) {
 
-    bool included;
-
-    for(auto e: entities){
-
-        included = false;
-        if (e->isVisible()) {
-            if (e->isInWindow(v1, v2)) {
-                //e->setSelected(select);
-                included = true;
-            } else if (cross) {
-                RS_EntityContainer l;
-                l.addRectangle(v1, v2);
-                RS_VectorSolutions sol;
-
-                if (e->isContainer()) {
-                    RS_EntityContainer* ec = (RS_EntityContainer*)e;
-                    for (RS_Entity* se=ec->firstEntity(RS2::ResolveAll);
-                         se && included==false;
-                         se=ec->nextEntity(RS2::ResolveAll)) {
-
-                        if (se->rtti() == RS2::EntitySolid){
-                            included = static_cast<RS_Solid*>(se)->isInCrossWindow(v1,v2);
-                        } else {
-                            for (auto line: l) {
-                                sol = RS_Information::getIntersection(
-                                            se, line, true);
-                                if (sol.hasValid()) {
-                                    included = true;
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                } else if (e->rtti() == RS2::EntitySolid){
-                    included = static_cast<RS_Solid*>(e)->isInCrossWindow(v1,v2);
-                } else {
-                    for (auto line: l) {
-                        sol = RS_Information::getIntersection(e, line, true);
-                        if (sol.hasValid()) {
-                            included = true;
-                            break;
-                        }
-                    }
-                }
+    const LC_Rect window{v1, v2};
+    std::vector<RS_Entity*> candidates;
+    auto addCandidate = [&candidates, typeToSelect](RS_Entity* e) {
+        if (e->isVisible() && (typeToSelect == RS2::EntityUnknown || typeToSelect == e->rtti()))
+            candidates.push_back(e);
+    };
+    for (RS_Entity* e: cross ? getEntitiesCrossingArea(window) : getEntitiesInArea(window))
+        addCandidate(e);
+
+    const auto corners = window.vertices();
+    std::vector<RS_Line> edges;
+    for (std::size_t i = 0; i < corners.size(); ++i)
+        edges.emplace_back(corners[i], corners[(i + 1) % corners.size()]);
+    auto crosses = [&edges, &v1, &v2](RS_Entity* e) {
+        if (e->rtti() == RS2::EntitySolid)
+            return static_cast<RS_Solid*>(e)->isInCrossWindow(v1,v2);
+        return std::any_of(edges.cbegin(), edges.cend(), [e](const RS_Line& line) {
+            return RS_Information::getIntersection(e, &line, true).hasValid();
+        });
+    };
+
+    auto included = [&](RS_Entity* e) {
+        if (e->isInWindow(v1, v2))
+            return true;
+        if (!cross)
+            return false;
+        if (e->isContainer()) {
+            RS_EntityContainer* ec = static_cast<RS_EntityContainer*>(e);
+            for (RS_Entity* se: ec->resolvedEntities(RS2::ResolveAll)) {
+                if (crosses(se))
+                    return true;
             }
+            return false;
         }
+        return crosses(e);
+    };
 
-        if (included) {
-            if(typeToSelect!=RS2::EntityType::EntityUnknown){
-                if(typeToSelect==e->rtti()){
-                    e->setSelected(select);
-                } else {
-                    //Do not select
-                }
-            } else {
-                e->setSelected(select);
-            }
+    // the selection flags are set at once, when all entities are tested
+    for (RS_Entity* e: filterEntities(candidates, included))
+        e->setSelected(select);
+}
 
+/**
+ * Tests the entities, entities which are not containers concurrently for large
+ * numbers of entities. Containers, which may materialize their entities when
+ * iterated, are tested by this thread.
+ *
+ * @return the entities passing the test, in the order of the given entities
+ */
+std::vector<RS_Entity*> RS_EntityContainer::filterEntities(const std::vector<RS_Entity*>& candidates,
+                                                           const std::function<bool(RS_Entity*)>& test) {
+    std::vector<char> passed(candidates.size(), 0);
+    if (candidates.size() < parallelSelectionMinimum) {
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+            passed[i] = test(candidates[i]);
+    } else {
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            if (candidates[i]->isContainer())
+                passed[i] = test(candidates[i]);
         }
+        LC_TaskScheduler::instance().parallelFor(0, candidates.size(), parallelGrain,
+                                                 [&candidates, &test, &passed](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                if (!candidates[i]->isContainer())
+                    passed[i] = test(candidates[i]);
+            }
+        });
+    }
+
+    std::vector<RS_Entity*> result;
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (passed[i])
+            result.push_back(candidates[i]);
     }
+    return result;
 }
 
 
@@ -345,6 +586,7 @@ void RS_EntityContainer::selectWindow(enum RS2::EntityType typeToSelect,RS_Vecto
  * entity-container if autoUpdateBorders is true.
  */
 void RS_EntityContainer::addEntity(RS_Entity* entity) {
+    invalidateBorders();
     /*
        if (isDocument()) {
            RS_LayerList* lst = getDocument()->getLayerList();
@@ -362,8 +604,10 @@ void RS_EntityContainer::addEntity(RS_Entity* entity) {
     if (entity->rtti()==RS2::EntityImage ||
             entity->rtti()==RS2::EntityHatch) {
         entities.prepend(entity);
+        indexEntity(0);
     } else {
         entities.append(entity);
+        indexEntity(entities.size() - 1);
     }
     if (autoUpdateBorders) {
         adjustBorders(entity);
@@ -371,14 +615,22 @@ void RS_EntityContainer::addEntity(RS_Entity* entity) {
 }
 
 
+void RS_EntityContainer::reserveEntities(int additions) {
+    if (additions > 0)
+        entities.reserve(entities.size() + additions);
+}
+
+
 /**
  * Insert a entity at the end of entities list and updates the
  * borders of this entity-container if autoUpdateBorders is true.
  */
 void RS_EntityContainer::appendEntity(RS_Entity* entity){
+    invalidateBorders();
     if (!entity)
         return;
     entities.append(entity);
+    indexEntity(entities.size() - 1);
     if (autoUpdateBorders)
         adjustBorders(entity);
 }
@@ -388,8 +640,10 @@ void RS_EntityContainer::appendEntity(RS_Entity* entity){
  * borders of this entity-container if autoUpdateBorders is true.
  */
 void RS_EntityContainer::prependEntity(RS_Entity* entity){
+    invalidateBorders();
     if (!entity) return;
     entities.prepend(entity);
+    indexEntity(0);
     if (autoUpdateBorders)
         adjustBorders(entity);
 }
@@ -399,6 +653,7 @@ void RS_EntityContainer::prependEntity(RS_Entity* entity){
  * the borders of this entity-container if autoUpdateBorders is true.
  */
 void RS_EntityContainer::moveEntity(int index, QList<RS_Entity *>& entList){
+    invalidateBorders();
     if (entList.isEmpty()) return;
     int ci = 0; //current index for insert without invert order
     bool ret, into = false;
@@ -427,6 +682,7 @@ void RS_EntityContainer::moveEntity(int index, QList<RS_Entity *>& entList){
     for(auto e: entList){
         entities.insert(ci++, e);
     }
+    reindexOrder();
 }
 
 /**
@@ -434,9 +690,11 @@ void RS_EntityContainer::moveEntity(int index, QList<RS_Entity *>& entList){
  * the borders of this entity-container if autoUpdateBorders is true.
  */
 void RS_EntityContainer::insertEntity(int index, RS_Entity* entity) {
+    invalidateBorders();
     if (!entity) return;
 
     entities.insert(index, entity);
+    indexEntity(std::min(std::max(index, 0), int(entities.size()) - 1));
 
     if (autoUpdateBorders) {
         adjustBorders(entity);
@@ -451,6 +709,7 @@ void RS_EntityContainer::insertEntity(int index, RS_Entity* entity) {
  */
 /*RLZ unused function
 void RS_EntityContainer::replaceEntity(int index, RS_Entity* entity) {
+    invalidateBorders();
 //RLZ TODO: is needed to delete the old entity? not documented in Q3PtrList
 //    investigate in qt3support code if reactivate this function.
     if (!entity) {
@@ -471,10 +730,18 @@ void RS_EntityContainer::replaceEntity(int index, RS_Entity* entity) {
  * this entity-container if autoUpdateBorders is true.
  */
 bool RS_EntityContainer::removeEntity(RS_Entity* entity) {
+    invalidateBorders();
     //RLZ TODO: in Q3PtrList if 'entity' is nullptr remove the current item-> at.(entIdx)
     //    and sets 'entIdx' in next() or last() if 'entity' is the last item in the list.
     //    in LibreCAD is never called with nullptr
     bool ret = entities.removeOne(entity);
+    if (ret) {
+        invalidateIntersections();
+        if (m_spatialIndex != nullptr) {
+            m_spatialIndex->remove(entity);
+            untrackEntity(entity);
+        }
+    }
 
     if (autoDelete && ret) {
         delete entity;
@@ -487,15 +754,128 @@ bool RS_EntityContainer::removeEntity(RS_Entity* entity) {
 
 
 
+unsigned RS_EntityContainer::removeEntities(const std::function<bool(const RS_Entity*)>& predicate) {
+    invalidateBorders();
+    QList<RS_Entity*> kept;
+    kept.reserve(entities.size());
+    unsigned removed = 0;
+    for (RS_Entity* entity: std::as_const(entities)) {
+        if (!predicate(entity)) {
+            kept.append(entity);
+            continue;
+        }
+        ++removed;
+        if (m_spatialIndex != nullptr) {
+            m_spatialIndex->remove(entity);
+            untrackEntity(entity);
+        }
+        if (autoDelete)
+            delete entity;
+    }
+    if (removed == 0)
+        return 0;
+
+    entities.swap(kept);
+    invalidateIntersections();
+    if (autoUpdateBorders) {
+        calculateBorders();
+    }
+    return removed;
+}
+
+std::vector<std::pair<int, RS_Entity*>> RS_EntityContainer::detachEntities(const std::function<bool(const RS_Entity*)>& predicate)
+{
+    std::vector<std::pair<int, RS_Entity*>> detached;
+    QList<RS_Entity*> kept;
+    kept.reserve(entities.size());
+    for (int i = 0; i < entities.size(); ++i) {
+        RS_Entity* entity = entities.at(i);
+        if (!predicate(entity)) {
+            kept.append(entity);
+            continue;
+        }
+        detached.emplace_back(i, entity);
+        if (m_spatialIndex != nullptr) {
+            m_spatialIndex->remove(entity);
+            untrackEntity(entity);
+        }
+    }
+    if (detached.empty())
+        return detached;
+
+    invalidateBorders();
+    entities.swap(kept);
+    invalidateIntersections();
+    if (autoUpdateBorders)
+        calculateBorders();
+    return detached;
+}
+
+void RS_EntityContainer::restoreEntities(const std::vector<std::pair<int, RS_Entity*>>& detached)
+{
+    if (detached.empty())
+        return;
+    invalidateBorders();
+
+    // a few entities, like the entities of an undone modification, are inserted by
+    // their neighbors in the spatial index
+    if (detached.size() <= restoredInsertMaximum) {
+        for (const auto& [position, entity]: detached) {
+            const int index = std::min(position, int(entities.size()));
+            entities.insert(index, entity);
+            indexEntity(index);
+        }
+        if (autoUpdateBorders) {
+            for (const auto& item: detached)
+                adjustBorders(item.second);
+        }
+        return;
+    }
+
+    // merge in one pass, positions past the end are appended
+    QList<RS_Entity*> merged;
+    merged.reserve(entities.size() + int(detached.size()));
+    auto next = detached.cbegin();
+    for (RS_Entity* entity: std::as_const(entities)) {
+        for (; next != detached.cend() && next->first <= merged.size(); ++next)
+            merged.append(next->second);
+        merged.append(entity);
+    }
+    for (; next != detached.cend(); ++next)
+        merged.append(next->second);
+    entities.swap(merged);
+
+    invalidateIntersections();
+    if (m_spatialIndex != nullptr) {
+        for (const auto& [position, entity]: detached) {
+            m_spatialIndex->insert(entity, 0.);
+            trackEntity(entity);
+        }
+        reindexOrder();
+    }
+    if (autoUpdateBorders) {
+        for (const auto& item: detached)
+            adjustBorders(item.second);
+    }
+}
+
 /**
  * Erases all entities in this container and resets the borders..
  */
 void RS_EntityContainer::clear() {
+    invalidateBorders();
+    invalidateIntersections();
+    if (m_spatialIndex != nullptr) {
+        m_spatialIndex->clear();
+        m_selectedEntities->clear();
+        m_layerEntities->clear();
+        m_constructionLines->clear();
+    }
     if (autoDelete) {
-        while (!entities.isEmpty())
-            delete entities.takeFirst();
-    } else
-        entities.clear();
+        for (RS_Entity* e: std::as_const(entities))
+            delete e;
+    }
+    entities.clear();
     resetBorders();
 }
 
@@ -524,7 +904,11 @@ unsigned RS_EntityContainer::countSelected(bool deep, QList<RS2::EntityType> con
     unsigned c=0;
     std::set<RS2::EntityType> type{types.cbegin(), types.cend()};
 
-    for (RS_Entity* t: entities){
+    // only the candidates of the selection set, when it's maintained
+    const auto candidates = m_selectedEntities != nullptr
+            ? QList<RS_Entity*>{m_selectedEntities->cbegin(), m_selectedEntities->cend()}
+            : entities;
+    for (RS_Entity* t: candidates){
 
         if (t->isSelected())
 	    if (!types.size() || type.count(t->rtti()))
@@ -540,15 +924,35 @@ unsigned RS_EntityContainer::countSelected(bool deep, QList<RS2::EntityType> con
 /**
  * Counts the selected entities in this container.
  */
+/**
+ * The lengths of large selections are computed concurrently, except for containers,
+ * which may materialize their entities when iterated. The lengths are summed in the
+ * order of the selection, as they are for small selections.
+ */
 double RS_EntityContainer::totalSelectedLength() {
-    double ret(0.0);
-    for (RS_Entity* e: entities){
-
-        if (e->isVisible() && e->isSelected()) {
-            double l = e->getLength();
-            if (l>=0.) {
-                ret += l;
+    const std::vector<RS_Entity*> selected = getSelectedEntities();
+    std::vector<double> lengths(selected.size(), 0.);
+    if (selected.size() < parallelLengthMinimum) {
+        for (std::size_t i = 0; i < selected.size(); ++i)
+            lengths[i] = selected[i]->getLength();
+    } else {
+        for (std::size_t i = 0; i < selected.size(); ++i) {
+            if (selected[i]->isContainer())
+                lengths[i] = selected[i]->getLength();
+        }
+        LC_TaskScheduler::instance().parallelFor(0, selected.size(), parallelGrain,
+                                                 [&selected, &lengths](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                if (!selected[i]->isContainer())
+                    lengths[i] = selected[i]->getLength();
             }
+        });
+    }
+
+    double ret(0.0);
+    for (double l: lengths) {
+        if (l>=0.) {
+            ret += l;
         }
     }
     return ret;
@@ -570,6 +974,10 @@ void RS_EntityContainer::adjustBorders(RS_Entity* entity) {
             maxV = RS_Vector::maximum(entity->getMax(),maxV);
         }
 
+        invalidateIntersections();
+        if (m_spatialIndex != nullptr)
+            m_spatialIndex->update(entity);
+
         // Notify parents. The border for the parent might
         // also change TODO: Check for efficiency
         //if(parent) {
@@ -580,12 +988,13 @@ void RS_EntityContainer::adjustBorders(RS_Entity* entity) {
 
 
 /**
- * Recalculates the borders of this entity container.
+ * Recalculates the borders of this entity container. The borders of inserts,
+ * texts and dimensions, which entities are generated by their update(), are
+ * only recalculated when they're invalidated by a change.
  */
 void RS_EntityContainer::calculateBorders() {
     RS_DEBUG->print("RS_EntityContainer::calculateBorders");
 
-    resetBorders();
     for (RS_Entity* e: entities){
 
         RS_Layer* layer = e->getLayer();
@@ -593,13 +1002,27 @@ void RS_EntityContainer::calculateBorders() {
         //        RS_DEBUG->print("RS_EntityContainer::calculateBorders: "
         //                        "isVisible: %d", (int)e->isVisible());
 
-        if (e->isVisible() && !(layer && layer->isFrozen())) {
+        if (e->isVisible() && !(layer && layer->isFrozen()) && !hasCachedBorders(*e)) {
             e->calculateBorders();
+        }
+    }
+
+    mergeBorders();
+    m_bordersValid = true;
+}
+
+
+
+void RS_EntityContainer::mergeBorders() {
+    resetBorders();
+    for (RS_Entity* e: entities){
+        RS_Layer* layer = e->getLayer();
+        if (e->isVisible() && !(layer && layer->isFrozen())) {
             adjustBorders(e);
         }
     }
 
-    RS_DEBUG->print("RS_EntityContainer::calculateBorders: size 1: %f,%f",
+    RS_DEBUG->print("RS_EntityContainer::mergeBorders: size 1: %f,%f",
                     getSize().x, getSize().y);
 
     // needed for correcting corrupt data (PLANS.dxf)
@@ -616,7 +1039,7 @@ void RS_EntityContainer::calculateBorders() {
         maxV.y = 0.0;
     }
 
-    RS_DEBUG->print("RS_EntityContainer::calculateBorders: size: %f,%f",
+    RS_DEBUG->print("RS_EntityContainer::mergeBorders: size: %f,%f",
                     getSize().x, getSize().y);
 
     //RS_DEBUG->print("  borders: %f/%f %f/%f", minV.x, minV.y, maxV.x, maxV.y);
@@ -625,6 +1048,66 @@ void RS_EntityContainer::calculateBorders() {
     //RS_Entity::calculateBorders();
 }
 
+void RS_EntityContainer::updateBorders() {
+    if (m_spatialIndex == nullptr) {
+        calculateBorders();
+        if (std::none_of(entities.cbegin(), entities.cend(), [](const RS_Entity* e) {
+            return isInfinite(*e);
+        }))
+            return;
+
+        // the borders without the infinite lines
+        bool found = false;
+        LC_Rect extents;
+        for (const RS_Entity* e: entities) {
+            if (!isInExtents(*e))
+                continue;
+            const LC_Rect borders{e->getMin(), e->getMax()};
+            extents = found ? extents.merge(borders) : borders;
+            found = true;
+        }
+        minV = found ? extents.minP() : RS_Vector{0., 0.};
+        maxV = found ? extents.maxP() : RS_Vector{0., 0.};
+        return;
+    }
+
+    std::vector<const RS_Layer*> frozenLayers;
+    std::vector<const RS_Layer*> constructionLayers;
+    for (const auto& [layer, layerEntities]: *m_layerEntities) {
+        if (layer == nullptr || layerEntities.empty())
+            continue;
+        if (layer->isFrozen())
+            frozenLayers.push_back(layer);
+        if (layer->isConstruction())
+            constructionLayers.push_back(layer);
+    }
+    std::sort(frozenLayers.begin(), frozenLayers.end());
+    std::sort(constructionLayers.begin(), constructionLayers.end());
+    if (m_bordersCache != nullptr && m_bordersCache->revision == m_revision
+            && m_bordersCache->frozenLayers == frozenLayers
+            && m_bordersCache->constructionLayers == constructionLayers) {
+        minV = m_bordersCache->minV;
+        maxV = m_bordersCache->maxV;
+        return;
+    }
+
+    // the entities merged by mergeBorders(), except the infinite lines
+    LC_Rect extents;
+    const bool found = m_spatialIndex->getExtents([](const RS_Entity* e) {
+        return isInExtents(*e);
+    }, extents);
+    if (found) {
+        minV = extents.minP();
+        maxV = extents.maxP();
+    } else {
+        minV = maxV = RS_Vector{0., 0.};
+    }
+
+    if (m_bordersCache == nullptr)
+        m_bordersCache = std::make_unique<BordersCache>();
+    *m_bordersCache = {m_revision, std::move(frozenLayers), std::move(constructionLayers), minV, maxV};
+}
+
 //namespace {
 //bool isBoundingBoxValid(RS_Entity* e) {
 //	if (!(e->getMin() && e->getMax())) return false;
@@ -654,6 +1137,7 @@ void RS_EntityContainer::forcedCalculateBorders() {
         }
         adjustBorders(e);
     }
+    m_bordersValid = true;
 
     // needed for correcting corrupt data (PLANS.dxf)
     if (minV.x>maxV.x || minV.x>RS_MAXDOUBLE || maxV.x>RS_MAXDOUBLE
@@ -676,31 +1160,69 @@ void RS_EntityContainer::forcedCalculateBorders() {
 }
 
 /**
- * Updates all Dimension entities in this container and / or
- * reposition their labels.
+ * Updates the Dimension entities in this container and / or
+ * reposition their labels. Only dimensions updated with another dimension
+ * style, see RS_Dimension::getStyleKey(), are regenerated; large batches
+ * are regenerated concurrently.
  *
  * @param autoText Automatically reposition the text label bool autoText=true
  */
 void RS_EntityContainer::updateDimensions(bool autoText) {
 
     RS_DEBUG->print("RS_EntityContainer::updateDimensions()");
+    LC_REGEN_REASON("update dimensions");
 
-    //for (RS_Entity* e=firstEntity(RS2::ResolveNone);
-    //        e;
-    //        e=nextEntity(RS2::ResolveNone)) {
+    std::size_t styleKey = RS_Dimension::getStyleKey(getGraphic());
+    std::vector<RS_Dimension*> outdated;
+    collectOutdatedDimensions(styleKey, outdated);
+    if (outdated.empty())
+        return;
+
+    // the missing variables are added and the font loaded before the updates, which
+    // then only read them; the key changes, if variables were added
+    outdated.front()->addDefaultStyleVariables();
+    styleKey = RS_Dimension::getStyleKey(getGraphic());
+
+    RS_DEBUG->print("RS_EntityContainer::updateDimensions: %zu outdated dimensions",
+                    outdated.size());
+    if (outdated.size() < parallelDimensionsMinimum) {
+        for (RS_Dimension* dim: outdated) {
+            // update and reposition label:
+            dim->updateDim(autoText);
+            dim->setUpdatedStyleKey(styleKey);
+        }
+    } else {
+        LC_TaskScheduler::instance().parallelFor(0, outdated.size(), parallelGrain / 4,
+                                                 [&outdated, autoText, styleKey](std::size_t begin, std::size_t end) {
+            // the reasons of the calling thread are not known to workers
+            LC_REGEN_REASON("update dimensions");
+            for (std::size_t i = begin; i < end; ++i) {
+                outdated[i]->updateDim(autoText);
+                outdated[i]->setUpdatedStyleKey(styleKey);
+            }
+        });
+    }
+
+    RS_DEBUG->print("RS_EntityContainer::updateDimensions() OK");
+}
 
+/**
+ * Collects the dimensions of this container and its sub-containers, which were
+ * not updated with the given style key. Leaders are updated.
+ */
+void RS_EntityContainer::collectOutdatedDimensions(std::size_t styleKey,
+                                                   std::vector<RS_Dimension*>& outdated) {
     for (RS_Entity* e: entities){
         if (RS_Information::isDimension(e->rtti())) {
-            // update and reposition label:
-            ((RS_Dimension*)e)->updateDim(autoText);
+            auto* dim = static_cast<RS_Dimension*>(e);
+            if (dim->getUpdatedStyleKey() != styleKey || styleKey == 0)
+                outdated.push_back(dim);
         } else if(e->rtti()==RS2::EntityDimLeader)
             e->update();
         else if (e->isContainer()) {
-            ((RS_EntityContainer*)e)->updateDimensions(autoText);
+            static_cast<RS_EntityContainer*>(e)->collectOutdatedDimensions(styleKey, outdated);
         }
     }
-
-    RS_DEBUG->print("RS_EntityContainer::updateDimensions() OK");
 }
 
 
@@ -712,26 +1234,27 @@ void RS_EntityContainer::updateInserts() {
 
     std::string idTypeId = std::to_string(getId()) + "/" + std::to_string(rtti());
     RS_DEBUG->print("RS_EntityContainer::updateInserts() ID/type: %s", idTypeId.c_str());
+    LC_REGEN_REASON("update inserts");
 
-    for (RS_Entity* e: entities){
-        //// Only update our own inserts and not inserts of inserts
-        if (e->rtti()==RS2::EntityInsert  /*&& e->getParent()==this*/) {
-            ((RS_Insert*)e)->update();
-            RS_DEBUG->print("RS_EntityContainer::updateInserts: updated ID/type: %s", idTypeId.c_str());
-        } else if (e->isContainer()) {
-            if (e->rtti()==RS2::EntityHatch) {
-                RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_EntityContainer::updateInserts: skip hatch ID/type: %s", idTypeId.c_str());
-            } else {
-                RS_DEBUG->print("RS_EntityContainer::updateInserts: update container ID/type: %s", idTypeId.c_str());
-                ((RS_EntityContainer*)e)->updateInserts();
-            }
-        } else {
-            RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_EntityContainer::updateInserts: skip entity ID/type: %s", idTypeId.c_str());
-        }
-    }
+    RS_Insert::UpdatePass pass;
+    std::vector<RS_Insert*> inserts;
+    collectInserts(inserts);
+    RS_DEBUG->print("RS_EntityContainer::updateInserts: %zu inserts", inserts.size());
+    RS_Insert::updateAll(inserts, pass);
     RS_DEBUG->print("RS_EntityContainer::updateInserts() ID/type: %s", idTypeId.c_str());
 }
 
+void RS_EntityContainer::collectInserts(std::vector<RS_Insert*>& inserts) const
+{
+    for (RS_Entity* e: entities) {
+        // only our own inserts and not inserts of inserts
+        if (e->rtti() == RS2::EntityInsert)
+            inserts.push_back(static_cast<RS_Insert*>(e));
+        else if (e->isContainer() && e->rtti() != RS2::EntityHatch)
+            static_cast<const RS_EntityContainer*>(e)->collectInserts(inserts);
+    }
+}
+
 
 
 /**
@@ -768,6 +1291,7 @@ void RS_EntityContainer::renameInserts(const QString& oldName,
 void RS_EntityContainer::updateSplines() {
 
     RS_DEBUG->print("RS_EntityContainer::updateSplines()");
+    LC_REGEN_REASON("update splines");
 
     for (RS_Entity* e: entities){
         //// Only update our own inserts and not inserts of inserts
@@ -786,6 +1310,7 @@ void RS_EntityContainer::updateSplines() {
  * Updates the sub entities of this container.
  */
 void RS_EntityContainer::update() {
+    invalidateBorders();
     for (RS_Entity* e: entities){
         e->update();
     }
@@ -799,6 +1324,89 @@ void RS_EntityContainer::addRectangle(RS_Vector const& v0, RS_Vector const& v1)
     addEntity(new RS_Line{this, {v0.x, v1.y}, v0});
 }
 
+RS_EntityContainer::ResolvedIterator::ResolvedIterator(const RS_EntityContainer* container,
+                                                      RS2::ResolveLevel level):
+    m_level{level}
+{
+    if (container != nullptr) {
+        container->materializeEntities();
+        m_stack.emplace_back(container, 0);
+        settle();
+    }
+}
+
+void RS_EntityContainer::ResolvedIterator::settle()
+{
+    while (!m_stack.empty()) {
+        auto& [container, index] = m_stack.back();
+        if (index >= container->entities.size()) {
+            m_stack.pop_back();
+            if (!m_stack.empty())
+                ++m_stack.back().second;
+            continue;
+        }
+        const RS_Entity* e = container->entities.at(index);
+        if (e == nullptr || !isResolved(*e, m_level))
+            return;
+        auto* ec = static_cast<const RS_EntityContainer*>(e);
+        ec->materializeEntities();
+        m_stack.emplace_back(ec, 0);
+    }
+}
+
+RS_Entity* RS_EntityContainer::ResolvedIterator::operator*() const
+{
+    const auto& [container, index] = m_stack.back();
+    return container->entities.at(index);
+}
+
+RS_EntityContainer::ResolvedIterator& RS_EntityContainer::ResolvedIterator::operator++()
+{
+    if (!m_stack.empty()) {
+        ++m_stack.back().second;
+        settle();
+    }
+    return *this;
+}
+
+RS_EntityContainer::ResolvedIterator RS_EntityContainer::ResolvedIterator::operator++(int)
+{
+    ResolvedIterator ret = *this;
+    ++*this;
+    return ret;
+}
+
+bool RS_EntityContainer::ResolvedIterator::operator==(const ResolvedIterator& other) const
+{
+    return m_stack == other.m_stack;
+}
+
+bool RS_EntityContainer::ResolvedIterator::operator!=(const ResolvedIterator& other) const
+{
+    return !(*this == other);
+}
+
+RS_EntityContainer::ResolvedRange::ResolvedRange(const RS_EntityContainer* container,
+                                                RS2::ResolveLevel level):
+    m_container{container}
+  , m_level{level}
+{}
+
+RS_EntityContainer::ResolvedIterator RS_EntityContainer::ResolvedRange::begin() const
+{
+    return {m_container, m_level};
+}
+
+RS_EntityContainer::ResolvedIterator RS_EntityContainer::ResolvedRange::end() const
+{
+    return {};
+}
+
+RS_EntityContainer::ResolvedRange RS_EntityContainer::resolvedEntities(RS2::ResolveLevel level) const
+{
+    return {this, level};
+}
+
 /**
  * Returns the first entity or nullptr if this graphic is empty.
  * @param level
@@ -1150,10 +1758,16 @@ RS_Entity* RS_EntityContainer::entityAt(int index) {
 }
 
 void RS_EntityContainer::setEntityAt(int index,RS_Entity* en){
+    invalidateBorders();
+    if (m_spatialIndex != nullptr) {
+        m_spatialIndex->remove(entities.at(index));
+        untrackEntity(entities.at(index));
+    }
     if(autoDelete && entities.at(index)) {
         delete entities.at(index);
     }
     entities[index] = en;
+    indexEntity(index);
 }
 
 /**
@@ -1179,26 +1793,17 @@ int RS_EntityContainer::findEntity(RS_Entity const* const entity) {
  */
 RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
                                                  double* dist  )const {
-
-    double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist;                 // currently measured distance
-    RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
-
-    for (RS_Entity* en: entities){
-
+    double minDist = RS_MAXDOUBLE;
+    const RS_Vector closestPoint = findNearestPoint(coord, [&coord](RS_Entity* en, double* curDist) {
         if (en->isVisible()
                 && !en->getParent()->ignoredOnModification()
                 ){//no end point for Insert, text, Dim
-            point = en->getNearestEndpoint(coord, &curDist);
-            if (point.valid && curDist<minDist) {
-                closestPoint = point;
-                minDist = curDist;
-                if (dist) {
-                    *dist = minDist;
-                }
-            }
+            return en->getNearestEndpoint(coord, curDist);
         }
+        return RS_Vector(false);
+    }, &minDist, nullptr);
+    if (closestPoint.valid && dist) {
+        *dist = minDist;
     }
 
     return closestPoint;
@@ -1211,38 +1816,17 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
  */
 RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
                                                  double* dist,  RS_Entity** pEntity)const {
-
-    double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist;                 // currently measured distance
-    RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
-
-    //QListIterator<RS_Entity> it = createIterator();
-    //RS_Entity* en;
-    //while ( (en = it.current())  ) {
-    //    ++it;
-
-    for(auto en: entities){
+    double minDist = RS_MAXDOUBLE;
+    const RS_Vector closestPoint = findNearestPoint(coord, [&coord](RS_Entity* en, double* curDist) {
         if (!en->getParent()->ignoredOnModification() ){//no end point for Insert, text, Dim
-            //            std::cout<<"find nearest for entity "<<i0<<std::endl;
-            point = en->getNearestEndpoint(coord, &curDist);
-            if (point.valid && curDist<minDist) {
-                closestPoint = point;
-                minDist = curDist;
-                if (dist) {
-                    *dist = minDist;
-                }
-                if(pEntity){
-                    *pEntity=en;
-                }
-            }
+            return en->getNearestEndpoint(coord, curDist);
         }
+        return RS_Vector(false);
+    }, &minDist, pEntity);
+    if (closestPoint.valid && dist) {
+        *dist = minDist;
     }
 
-    //    std::cout<<__FILE__<<" : "<<__func__<<" : line "<<__LINE__<<std::endl;
-    //    std::cout<<"count()="<<const_cast<RS_EntityContainer*>(this)->count()<<"\tminDist= "<<minDist<<"\tclosestPoint="<<closestPoint;
-    //    if(pEntity ) std::cout<<"\t*pEntity="<<*pEntity;
-    //    std::cout<<std::endl;
     return closestPoint;
 }
 
@@ -1268,28 +1852,14 @@ RS_Vector RS_EntityContainer::getNearestPointOnEntity(const RS_Vector& coord,
 
 RS_Vector RS_EntityContainer::getNearestCenter(const RS_Vector& coord,
                                                double* dist) const{
-    double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist = RS_MAXDOUBLE;  // currently measured distance
-    RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
-
-    for(auto en: entities){
-
+    return findNearestPoint(coord, [&coord](RS_Entity* en, double* curDist) {
         if (en->isVisible()
                 && !en->getParent()->ignoredSnap()
                 ){//no center point for spline, text, Dim
-            point = en->getNearestCenter(coord, &curDist);
-            if (point.valid && curDist<minDist) {
-                closestPoint = point;
-                minDist = curDist;
-            }
+            return en->getNearestCenter(coord, curDist);
         }
-    }
-    if (dist) {
-        *dist = minDist;
-    }
-
-    return closestPoint;
+        return RS_Vector(false);
+    }, dist, nullptr, true);
 }
 
 /** @return the nearest of equidistant middle points of the line. */
@@ -1298,28 +1868,14 @@ RS_Vector RS_EntityContainer::getNearestMiddle(const RS_Vector& coord,
                                                double* dist,
                                                int middlePoints
                                                ) const{
-    double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist = RS_MAXDOUBLE;  // currently measured distance
-    RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
-
-    for(auto en: entities){
-
+    return findNearestPoint(coord, [&coord, middlePoints](RS_Entity* en, double* curDist) {
         if (en->isVisible()
                 && !en->getParent()->ignoredSnap()
                 ){//no midle point for spline, text, Dim
-            point = en->getNearestMiddle(coord, &curDist, middlePoints);
-            if (point.valid && curDist<minDist) {
-                closestPoint = point;
-                minDist = curDist;
-            }
+            return en->getNearestMiddle(coord, curDist, middlePoints);
         }
-    }
-    if (dist) {
-        *dist = minDist;
-    }
-
-    return closestPoint;
+        return RS_Vector(false);
+    }, dist, nullptr);
 }
 
 
@@ -1351,16 +1907,12 @@ RS_Vector RS_EntityContainer::getNearestIntersection(const RS_Vector& coord,
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist = RS_MAXDOUBLE;  // currently measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
-    RS_VectorSolutions sol;
     RS_Entity* closestEntity;
 
     closestEntity = getNearestEntity(coord, nullptr, RS2::ResolveAllButTextImage);
 
     if (closestEntity) {
-        for (RS_Entity* en = firstEntity(RS2::ResolveAllButTextImage);
-             en;
-             en = nextEntity(RS2::ResolveAllButTextImage)) {
+        for (const auto& [en, point]: getIntersections(closestEntity)) {
             if (
                     !en->isVisible()
                     || en->getParent()->ignoredSnap()
@@ -1368,16 +1920,11 @@ RS_Vector RS_EntityContainer::getNearestIntersection(const RS_Vector& coord,
                 continue;
             }
 
-            sol = RS_Information::getIntersection(closestEntity,
-                                                  en,
-                                                  true);
-
-            point=sol.getClosest(coord,&curDist,nullptr);
-            if(sol.getNumber()>0 && curDist<minDist){
+            curDist = coord.distanceTo(point);
+            if(curDist<minDist){
                 closestPoint=point;
                 minDist=curDist;
             }
-
         }
     }
     if(dist && closestPoint.valid) {
@@ -1387,6 +1934,81 @@ RS_Vector RS_EntityContainer::getNearestIntersection(const RS_Vector& coord,
     return closestPoint;
 }
 
+const std::vector<std::pair<RS_Entity*, RS_Vector>>& RS_EntityContainer::getIntersections(
+        RS_Entity* closestEntity)
+{
+    if (m_intersectionCache == nullptr)
+        m_intersectionCache = std::make_unique<IntersectionCache>();
+    auto& entries = m_intersectionCache->entries;
+
+    const RS_Vector minV = closestEntity->getMin();
+    const RS_Vector maxV = closestEntity->getMax();
+    auto it = entries.find(closestEntity);
+    if (it != entries.end() && it->second.minV == minV && it->second.maxV == maxV)
+        return it->second.intersections;
+
+    if (entries.size() >= IntersectionCache::maxEntries)
+        entries.clear();
+    IntersectionCache::Entry& entry = entries[closestEntity];
+    entry = {minV, maxV, {}};
+
+    // broad phase: only entities with overlapping bounding boxes are intersected,
+    // getIntersections() checks the boxes of the resolved sub-entities
+    const LC_Rect borders{minV, maxV};
+    std::vector<RS_Entity*> candidates;
+    for (RS_Entity* e: getEntitiesInArea(borders.increaseBy(RS_TOLERANCE))) {
+        if (isResolved(*e, RS2::ResolveAllButTextImage)) {
+            auto* ec = static_cast<const RS_EntityContainer*>(e);
+            for (RS_Entity* en: ec->resolvedEntities(RS2::ResolveAllButTextImage))
+                candidates.push_back(en);
+        } else {
+            candidates.push_back(e);
+        }
+    }
+    RS_Information::getIntersections(closestEntity, candidates, true, entry.intersections);
+    return entry.intersections;
+}
+
+void RS_EntityContainer::visibilityChanged(RS_Entity* /*entity*/)
+{
+    // intersections and borders of the shown entities are outdated
+    invalidateIntersections();
+}
+
+void RS_EntityContainer::invalidateIntersections()
+{
+    m_intersectionCache.reset();
+    ++m_revision;
+}
+
+/**
+ * Marks the borders of this container and of its parents as outdated, so they're
+ * recalculated by the next calculateBorders() of the parents.
+ */
+void RS_EntityContainer::invalidateBorders()
+{
+    for (RS_EntityContainer* c = this; c != nullptr; c = c->getParent())
+        c->m_bordersValid = false;
+}
+
+/**
+ * @return true, if the entity generates its sub-entities by update() and its
+ * borders are up to date
+ */
+bool RS_EntityContainer::hasCachedBorders(const RS_Entity& entity)
+{
+    switch (entity.rtti()) {
+    case RS2::EntityInsert:
+    case RS2::EntityText:
+    case RS2::EntityMText:
+        break;
+    default:
+        if (!RS_Information::isDimension(entity.rtti()))
+            return false;
+    }
+    return static_cast<const RS_EntityContainer&>(entity).m_bordersValid;
+}
+
 RS_Vector RS_EntityContainer::getNearestVirtualIntersection(const RS_Vector& coord,
                                                             const double& angle,
                                                             double* dist)
@@ -1484,46 +2106,12 @@ double RS_EntityContainer::getDistanceToPoint(const RS_Vector& coord,
 
     RS_DEBUG->print("RS_EntityContainer::getDistanceToPoint");
 
+    auto distance = [&coord, level, solidDist](RS_Entity* e, double& curDist, RS_Entity*& closest) {
+        return entityDistance(coord, e, level, solidDist, curDist, closest);
+    };
 
-    double minDist = RS_MAXDOUBLE;      // minimum measured distance
-    double curDist;                     // currently measured distance
-    RS_Entity* closestEntity = nullptr;    // closest entity found
-    RS_Entity* subEntity = nullptr;
-
-    for(auto e: entities){
-
-        if (e->isVisible() && (e->getLayer()==nullptr || !e->getLayer()->isLocked())) {
-            RS_DEBUG->print("entity: getDistanceToPoint");
-            RS_DEBUG->print("entity: %d", e->rtti());
-            // bug#426, need to ignore Images to find nearest intersections
-            if(level==RS2::ResolveAllButTextImage && e->rtti()==RS2::EntityImage) continue;
-            curDist = e->getDistanceToPoint(coord, &subEntity, level, solidDist);
-
-            RS_DEBUG->print("entity: getDistanceToPoint: OK");
-
-            /*
-             * By using '<=', we will prefer the *last* item in the container if there are multiple
-             * entities that are *exactly* the same distance away, which should tend to be the one
-             * drawn most recently, and the one most likely to be visible (as it is also the order
-             * that the software draws the entities). This makes a difference when one entity is
-             * drawn directly over top of another, and it's reasonable to assume that humans will
-             * tend to want to reference entities that they see or have recently drawn as opposed
-             * to deeper more forgotten and invisible ones...
-             */
-            if (curDist<=minDist)
-            {
-                switch(level){
-                case RS2::ResolveAll:
-                case RS2::ResolveAllButTextImage:
-                    closestEntity = subEntity;
-                    break;
-                default:
-                    closestEntity = e;
-                }
-                minDist = curDist;
-            }
-        }
-    }
+    double minDist = RS_MAXDOUBLE;
+    RS_Entity* closestEntity = findNearest(coord, RS_MAXDOUBLE, distance, &minDist);
 
     if (entity) {
         *entity = closestEntity;
@@ -1564,6 +2152,140 @@ RS_Entity* RS_EntityContainer::getNearestEntity(const RS_Vector& coord,
     return e;
 }
 
+RS_Entity* RS_EntityContainer::getNearestEntity(const RS_Vector& coord,
+                                                double range,
+                                                double* dist,
+                                                RS2::ResolveLevel level,
+                                                const std::function<bool(const RS_Entity*)>& filter) const
+{
+    // distance for points inside solids:
+    const double solidDist = (dist != nullptr) ? *dist : RS_MAXDOUBLE;
+
+    // the closest entity accepted by the filter, among the entity itself or its children
+    auto filtered = [&](RS_Entity* e, double& curDist, RS_Entity*& closest) {
+        if (!e->isVisible())
+            return false;
+        bool found = false;
+        auto test = [&](RS_Entity* en) {
+            if (!en->isVisible() || (en->getLayer() != nullptr && en->getLayer()->isLocked())
+                    || !filter(en))
+                return;
+            const double d = en->getDistanceToPoint(coord, nullptr, RS2::ResolveNone, solidDist);
+            if (!found || d <= curDist) {
+                found = true;
+                curDist = d;
+                closest = en;
+            }
+        };
+        if (isResolved(*e, level)) {
+            auto* ec = static_cast<const RS_EntityContainer*>(e);
+            for (RS_Entity* en: ec->resolvedEntities(level))
+                test(en);
+        } else {
+            test(e);
+        }
+        return found;
+    };
+
+    auto distance = [&coord, level, solidDist](RS_Entity* e, double& curDist, RS_Entity*& closest) {
+        return entityDistance(coord, e, level, solidDist, curDist, closest);
+    };
+
+    double d = RS_MAXDOUBLE;
+    RS_Entity* e = nullptr;
+    if (filter)
+        e = findNearest(coord, range, filtered, &d);
+    else
+        e = findNearest(coord, range, distance, &d);
+
+    if (e != nullptr && (!e->isVisible() || d > range))
+        e = nullptr;
+    if (dist != nullptr)
+        *dist = d;
+    return e;
+}
+
+RS_Entity* RS_EntityContainer::findNearest(const RS_Vector& coord, double range,
+                                           const std::function<bool(RS_Entity*, double&, RS_Entity*&)>& distance,
+                                           double* pDist, bool centers) const
+{
+    double minDist = RS_MAXDOUBLE;      // minimum measured distance
+    double minOrder = std::numeric_limits<double>::lowest(); // the order of the closest entity
+    RS_Entity* closestEntity = nullptr;    // closest entity found
+
+    // returns false, if the candidate is beyond the closest entity found
+    auto testCandidate = [&](RS_Entity* e, double order, double boxDist) {
+        if (boxDist > std::min(range, minDist))
+            return false;
+        double curDist = RS_MAXDOUBLE;
+        RS_Entity* closest = nullptr;
+        if (!distance(e, curDist, closest))
+            return true;
+        /*
+         * By using '<=', we will prefer the *last* item in the container if there are multiple
+         * entities that are *exactly* the same distance away, which should tend to be the one
+         * drawn most recently, and the one most likely to be visible (as it is also the order
+         * that the software draws the entities). This makes a difference when one entity is
+         * drawn directly over top of another, and it's reasonable to assume that humans will
+         * tend to want to reference entities that they see or have recently drawn as opposed
+         * to deeper more forgotten and invisible ones...
+         */
+        if (curDist < minDist || (curDist == minDist && order >= minOrder)) {
+            closestEntity = closest;
+            minDist = curDist;
+            minOrder = order;
+        }
+        return true;
+    };
+
+    if (m_spatialIndex != nullptr && centers) {
+        m_spatialIndex->visitNearestCenters(coord, testCandidate);
+    } else if (m_spatialIndex != nullptr) {
+        m_spatialIndex->visitNearest(coord, testCandidate);
+    } else if (centers || entities.size() < sortedNearestMinimum) {
+        for (int i = 0; i < entities.size(); ++i) {
+            RS_Entity* e = entities.at(i);
+            testCandidate(e, i, centers ? 0. : boxDistance(coord, *e));
+        }
+    } else {
+        // the closest boxes first, so the first distances found prune the remaining
+        // entities. Entities are still compared by their order for equal distances
+        std::vector<std::pair<double, int>> candidates;
+        candidates.reserve(entities.size());
+        for (int i = 0; i < entities.size(); ++i)
+            candidates.emplace_back(boxDistance(coord, *entities.at(i)), i);
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& [boxDist, i]: candidates) {
+            if (!testCandidate(entities.at(i), i, boxDist))
+                break;
+        }
+    }
+
+    if (pDist != nullptr)
+        *pDist = minDist;
+    return closestEntity;
+}
+
+RS_Vector RS_EntityContainer::findNearestPoint(const RS_Vector& coord,
+                                               const std::function<RS_Vector(RS_Entity*, double*)>& point,
+                                               double* pDist, RS_Entity** pEntity, bool centers) const
+{
+    // snap points are on the entities or at their centers, so their distances are
+    // bound by the bounding box distances
+    auto distance = [&point](RS_Entity* e, double& curDist, RS_Entity*& closest) {
+        if (!point(e, &curDist).valid)
+            return false;
+        closest = e;
+        return true;
+    };
+    RS_Entity* closestEntity = findNearest(coord, RS_MAXDOUBLE, distance, pDist, centers);
+    if (closestEntity == nullptr)
+        return RS_Vector(false);
+    if (pEntity != nullptr)
+        *pEntity = closestEntity;
+    return point(closestEntity, nullptr);
+}
+
 
 
 /**
@@ -1577,6 +2299,7 @@ RS_Entity* RS_EntityContainer::getNearestEntity(const RS_Vector& coord,
  * to do: find closed contour by flood-fill
  */
 bool RS_EntityContainer::optimizeContours() {
+    invalidateBorders();
     //    std::cout<<"RS_EntityContainer::optimizeContours: begin"<<std::endl;
 
     //    DEBUG_HEADER
@@ -1614,69 +2337,98 @@ bool RS_EntityContainer::optimizeContours() {
     //    std::cout<<"RS_EntityContainer::optimizeContours: 1"<<std::endl;
 
     /** remove unsupported entities */
-    for(RS_Entity* it: enList)
-        removeEntity(it);
+    const std::unordered_set<const RS_Entity*> unsupported{enList.cbegin(), enList.cend()};
+    removeEntities([&unsupported](const RS_Entity* e) {
+        return unsupported.count(e) != 0;
+    });
 
     /** check and form a closed contour **/
-    //    std::cout<<"RS_EntityContainer::optimizeContours: 2"<<std::endl;
+    if(count()==0 && tmp.count()==0)
+        return false;
+
+    // edges are chained through the grid of their endpoints
+    const std::vector<RS_Entity*> edges{entities.cbegin(), entities.cend()};
+    std::vector<bool> used(edges.size(), false);
+    std::size_t usedCount = 0;
+    std::size_t firstUnused = 0;
+    EndpointGrid grid;
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        grid.insert(edges[i]->getStartpoint(), i);
+        grid.insert(edges[i]->getEndpoint(), i);
+    }
+    auto useEdge = [&used, &usedCount](std::size_t i) {
+        used[i] = true;
+        ++usedCount;
+    };
+
     /** the first entity **/
-    RS_Entity* current(nullptr);
-    if(count()>0) {
-        current=entityAt(0)->clone();
-        tmp.addEntity(current);
-        removeEntity(entityAt(0));
-    }else {
-        if(tmp.count()==0) return false;
-    }
-    //    std::cout<<"RS_EntityContainer::optimizeContours: 3"<<std::endl;
     RS_Vector vpStart;
     RS_Vector vpEnd;
-    if(current){
+    if(!edges.empty()) {
+        RS_Entity* current=edges.front()->clone();
+        tmp.addEntity(current);
+        useEdge(0);
         vpStart=current->getStartpoint();
         vpEnd=current->getEndpoint();
     }
-    RS_Entity* next = nullptr;
-    //    std::cout<<"RS_EntityContainer::optimizeContours: 4"<<std::endl;
     /** connect entities **/
     const auto errMsg=QObject::tr("Hatch failed due to a gap=%1 between (%2, %3) and (%4, %5)");
 
-    while (count()>0) {
+    while (usedCount < edges.size()) {
         double dist = 0.;
-        RS_Vector vpTmp=getNearestEndpoint(vpEnd,&dist,&next);
-        if (dist > contourTolerance) {
+        const std::size_t next = grid.findNearest(vpEnd, used, dist);
+        if (next == EndpointGrid::npos) {
             if(vpEnd.squaredTo(vpStart) < contourTolerance) {
-                RS_Entity* e2=entityAt(0);
+                // a closed loop, continue with the next remaining edge
+                while (used[firstUnused])
+                    ++firstUnused;
+                RS_Entity* e2=edges[firstUnused];
                 tmp.addEntity(e2->clone());
                 vpStart=e2->getStartpoint();
                 vpEnd=e2->getEndpoint();
-                removeEntity(e2);
+                useEdge(firstUnused);
                 continue;
             }
-            else {
-                QG_DIALOGFACTORY->commandMessage(
-                            errMsg.arg(dist).arg(vpTmp.x).arg(vpTmp.y).arg(vpEnd.x).arg(vpEnd.y)
-                            );
-                RS_DEBUG->print(RS_Debug::D_ERROR, "RS_EntityContainer::optimizeContours: hatch failed due to a gap");
-                closed=false;
+
+            // the nearest endpoint beyond the tolerance, to report the gap
+            RS_Vector vpTmp(false);
+            dist = RS_MAXDOUBLE;
+            for (std::size_t i = 0; i < edges.size(); ++i) {
+                double curDist = RS_MAXDOUBLE;
+                const RS_Vector point = used[i] ? RS_Vector(false) : edges[i]->getNearestEndpoint(vpEnd, &curDist);
+                if (point.valid && curDist < dist) {
+                    vpTmp = point;
+                    dist = curDist;
+                }
+            }
+            if (!vpTmp.valid) {
+                RS_DEBUG->print("RS_EntityContainer::optimizeContours: next is nullptr");
                 break;
             }
+            QG_DIALOGFACTORY->commandMessage(
+                        errMsg.arg(dist).arg(vpTmp.x).arg(vpTmp.y).arg(vpEnd.x).arg(vpEnd.y)
+                        );
+            RS_DEBUG->print(RS_Debug::D_ERROR, "RS_EntityContainer::optimizeContours: hatch failed due to a gap");
+            closed=false;
+            break;
         }
-        if(!next) { 	    //workaround if next is nullptr
-            //      	    std::cout<<"RS_EntityContainer::optimizeContours: next is nullptr" <<std::endl;
-            RS_DEBUG->print("RS_EntityContainer::optimizeContours: next is nullptr");
-            //			closed=false;	//workaround if next is nullptr
-            break;			//workaround if next is nullptr
-        } 					//workaround if next is nullptr
-        if(closed) {
-            next->setProcessed(true);
-            RS_Entity* eTmp = next->clone();
-            if(vpEnd.squaredTo(eTmp->getStartpoint())>vpEnd.squaredTo(eTmp->getEndpoint()))
-                eTmp->revertDirection();
-            vpEnd=eTmp->getEndpoint();
-            tmp.addEntity(eTmp);
-            removeEntity(next);
-        }
-    }
+        RS_Entity* eTmp = edges[next]->clone();
+        if(vpEnd.squaredTo(eTmp->getStartpoint())>vpEnd.squaredTo(eTmp->getEndpoint()))
+            eTmp->revertDirection();
+        vpEnd=eTmp->getEndpoint();
+        tmp.addEntity(eTmp);
+        useEdge(next);
+    }
+
+    // the chained edges are replaced by their sorted copies
+    std::unordered_set<const RS_Entity*> chained;
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        if (used[i])
+            chained.insert(edges[i]);
+    }
+    removeEntities([&chained](const RS_Entity* e) {
+        return chained.count(e) != 0;
+    });
     //    DEBUG_HEADER
     //    if(vpEnd.valid && vpEnd.squaredTo(vpStart) > 1e-8) {
     //		QG_DIALOGFACTORY->commandMessage(errMsg.arg(vpEnd.distanceTo(vpStart))
@@ -1719,6 +2471,7 @@ bool RS_EntityContainer::hasEndpointsWithinWindow(const RS_Vector& v1, const RS_
 
 
 void RS_EntityContainer::move(const RS_Vector& offset) {
+    invalidateBorders();
     moveBorders(offset);
     for(auto* e: entities){
         e->move(offset);
@@ -1736,6 +2489,7 @@ void RS_EntityContainer::rotate(const RS_Vector& center, const double& angle) {
 
 
 void RS_EntityContainer::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
+    invalidateBorders();
     resetBorders();
 
     for(auto* e: entities){
@@ -1748,6 +2502,7 @@ void RS_EntityContainer::rotate(const RS_Vector& center, const RS_Vector& angleV
 
 
 void RS_EntityContainer::scale(const RS_Vector& center, const RS_Vector& factor) {
+    invalidateBorders();
     if (std::abs(factor.x)>RS_TOLERANCE && std::abs(factor.y)>RS_TOLERANCE) {
         scaleBorders(center, factor);
         for(auto* e: entities){
@@ -1762,6 +2517,7 @@ void RS_EntityContainer::scale(const RS_Vector& center, const RS_Vector& factor)
 
 
 void RS_EntityContainer::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
+    invalidateBorders();
     if (axisPoint1.distanceTo(axisPoint2)>RS_TOLERANCE) {
 
         resetBorders();
@@ -1774,6 +2530,7 @@ void RS_EntityContainer::mirror(const RS_Vector& axisPoint1, const RS_Vector& ax
 
 RS_Entity& RS_EntityContainer::shear(double k)
 {
+    invalidateBorders();
     for (auto* e: *this)
         e->shear(k);
     calculateBorders();
@@ -1784,6 +2541,7 @@ RS_Entity& RS_EntityContainer::shear(double k)
 void RS_EntityContainer::stretch(const RS_Vector& firstCorner,
                                  const RS_Vector& secondCorner,
                                  const RS_Vector& offset) {
+    invalidateBorders();
 
     if (getMin().isInWindow(firstCorner, secondCorner) &&
             getMax().isInWindow(firstCorner, secondCorner)) {
@@ -1804,6 +2562,7 @@ void RS_EntityContainer::stretch(const RS_Vector& firstCorner,
 
 void RS_EntityContainer::moveRef(const RS_Vector& ref,
                                  const RS_Vector& offset) {
+    invalidateBorders();
 
     resetBorders();
     for(auto* e: entities){
@@ -1818,6 +2577,7 @@ void RS_EntityContainer::moveRef(const RS_Vector& ref,
 
 void RS_EntityContainer::moveSelectedRef(const RS_Vector& ref,
                                          const RS_Vector& offset) {
+    invalidateBorders();
 
     resetBorders();
     for(auto* e: entities){
@@ -1830,6 +2590,7 @@ void RS_EntityContainer::moveSelectedRef(const RS_Vector& ref,
 }
 
 void RS_EntityContainer::revertDirection() {
+    invalidateBorders();
     // revert entity order in the container
     for(int k = 0; k < entities.size() / 2; ++k) {
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 13, 0))
@@ -1839,6 +2600,8 @@ void RS_EntityContainer::revertDirection() {
 #endif
     }
 
+    reindexOrder();
+
     // revert each entity itself
     for(RS_Entity* entity: entities)
         entity->revertDirection();
@@ -1854,6 +2617,18 @@ void RS_EntityContainer::draw(RS_Painter* painter, RS_GraphicView* view, double&
     if (painter == nullptr || view == nullptr)
         return;
 
+    // only visit entities within the viewport. Lines on construction layers are drawn
+    // as infinite lines, they're clipped by their lines instead of their bounding boxes
+    if (m_spatialIndex != nullptr && !view->isPrinting()) {
+        const LC_Rect viewRect{view->toGraph(0, 0),
+                    view->toGraph(view->getWidth(), view->getHeight())};
+        std::vector<RS_Entity*> found = m_spatialIndex->query(viewRect);
+        addInfiniteEntities(viewRect, found);
+        for (RS_Entity* e: found)
+            view->drawEntity(painter, e);
+        return;
+    }
+
     foreach (auto* e, entities)
         view->drawEntity(painter, e);
 }
@@ -1888,7 +2663,7 @@ double RS_EntityContainer::areaLineIntegral() const
         double lineIntegral = e->areaLineIntegral();
         RS_Vector startPoint = e->getStartpoint();
         RS_Vector endPoint = e->getEndpoint();
-        LC_ERR<<e->getId()<<": int = "<<lineIntegral<<": "<<startPoint.x<<" - "<<endPoint.x;
+        LC_LOG<<e->getId()<<": int = "<<lineIntegral<<": "<<startPoint.x<<" - "<<endPoint.x;
 
         // the line integral is always by the direction: from the start point to the end point
         if (previousPoint.valid) {
@@ -1948,21 +2723,25 @@ bool RS_EntityContainer::ignoredSnap() const
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::begin() const
 {
+    materializeEntities();
     return entities.begin();
 }
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::end() const
 {
+    materializeEntities();
     return entities.end();
 }
 
 QList<RS_Entity *>::iterator RS_EntityContainer::begin()
 {
+    materializeEntities();
     return entities.begin();
 }
 
 QList<RS_Entity *>::iterator RS_EntityContainer::end()
 {
+    materializeEntities();
     return entities.end();
 }
 
@@ -2025,19 +2804,252 @@ std::ostream& operator << (std::ostream& os, RS_EntityContainer& ec) {
 
 RS_Entity* RS_EntityContainer::first() const
 {
+    materializeEntities();
     return entities.first();
 }
 
 RS_Entity* RS_EntityContainer::last() const
 {
+    materializeEntities();
     return entities.last();
 }
 
 const QList<RS_Entity*>& RS_EntityContainer::getEntityList()
 {
+    materializeEntities();
     return entities;
 }
 
+void RS_EntityContainer::setSpatialIndexEnabled(bool enable)
+{
+    if (enable == isSpatialIndexEnabled())
+        return;
+    if (!enable) {
+        m_spatialIndex.reset();
+        m_selectedEntities.reset();
+        m_layerEntities.reset();
+        m_constructionLines.reset();
+        return;
+    }
+    m_spatialIndex = std::make_unique<LC_SpatialIndex>();
+    m_selectedEntities = std::make_unique<std::unordered_set<RS_Entity*>>();
+    m_layerEntities = std::make_unique<std::unordered_map<const RS_Layer*, std::unordered_set<RS_Entity*>>>();
+    m_constructionLines = std::make_unique<std::unordered_set<RS_Entity*>>();
+    for (int i = 0; i < entities.size(); ++i) {
+        m_spatialIndex->insert(entities.at(i), i);
+        trackEntity(entities.at(i));
+    }
+}
+
+bool RS_EntityContainer::isSpatialIndexEnabled() const
+{
+    return m_spatialIndex != nullptr;
+}
+
+void RS_EntityContainer::setSpatialIndexBySize()
+{
+    setSpatialIndexEnabled(count() >= childIndexMinimum);
+}
+
+std::vector<RS_Entity*> RS_EntityContainer::getEntitiesInArea(const LC_Rect& area) const
+{
+    if (m_spatialIndex != nullptr)
+        return m_spatialIndex->query(area);
+    return {entities.cbegin(), entities.cend()};
+}
+
+std::vector<RS_Entity*> RS_EntityContainer::getEntitiesCrossingArea(const LC_Rect& area) const
+{
+    std::vector<RS_Entity*> found = getEntitiesInArea(area);
+    if (m_spatialIndex != nullptr)
+        addInfiniteEntities(area, found);
+    return found;
+}
+
+/**
+ * Adds the infinite lines crossing the area outside their bounding boxes to the
+ * entities found by the spatial index. The construction lines and lines on
+ * construction layers are taken from the sets maintained with the index, not
+ * from the entity list.
+ */
+void RS_EntityContainer::addInfiniteEntities(const LC_Rect& area, std::vector<RS_Entity*>& found) const
+{
+    const std::size_t indexed = found.size();
+    auto addCrossing = [&area, &found](RS_Entity* e) {
+        if (isInfinite(*e) && !area.intersects(LC_Rect{e->getMin(), e->getMax()})
+                && crossesInfinitely(*e, area))
+            found.push_back(e);
+    };
+    for (RS_Entity* e: *m_constructionLines)
+        addCrossing(e);
+    for (const auto& [layer, layerEntities]: *m_layerEntities) {
+        if (layer == nullptr || !layer->isConstruction() || layer->isFrozen())
+            continue;
+        for (RS_Entity* e: layerEntities)
+            addCrossing(e);
+    }
+    if (found.size() > indexed)
+        sortByOrder(found);
+}
+
+void RS_EntityContainer::getStretchEntities(const RS_Vector& v1, const RS_Vector& v2,
+                                            std::vector<RS_Entity*>& inside,
+                                            std::vector<RS_Entity*>& crossing) const
+{
+    std::vector<RS_Entity*> candidates = getEntitiesCrossingArea(LC_Rect{v1, v2});
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [](const RS_Entity* e) {
+        return !e->isVisible() || e->isLocked();
+    }), candidates.end());
+
+    inside = filterEntities(candidates, [&v1, &v2](RS_Entity* e) {
+        return e->isInWindow(v1, v2);
+    });
+    crossing = filterEntities(candidates, [&v1, &v2](RS_Entity* e) {
+        return !e->isInWindow(v1, v2) && e->hasEndpointsWithinWindow(v1, v2);
+    });
+}
+
+void RS_EntityContainer::indexEntity(int index)
+{
+    invalidateIntersections();
+    if (m_spatialIndex == nullptr || index < 0 || index >= entities.size())
+        return;
+
+    RS_Entity* entity = entities.at(index);
+    trackEntity(entity);
+    if (entities.size() == 1) {
+        m_spatialIndex->insert(entity, 0.);
+    } else if (index + 1 == entities.size()) {
+        m_spatialIndex->insert(entity, m_spatialIndex->maxOrder() + 1.);
+    } else if (index == 0) {
+        m_spatialIndex->insert(entity, m_spatialIndex->minOrder() - 1.);
+    } else {
+        // between the neighbors, renumber all, if the key space is exhausted
+        const double prev = m_spatialIndex->order(entities.at(index - 1));
+        const double next = m_spatialIndex->order(entities.at(index + 1));
+        const double order = 0.5 * (prev + next);
+        m_spatialIndex->insert(entity, order);
+        if (order <= prev || order >= next)
+            reindexOrder();
+    }
+}
+
+void RS_EntityContainer::reindexOrder()
+{
+    if (m_spatialIndex != nullptr)
+        m_spatialIndex->renumber({entities.cbegin(), entities.cend()});
+}
+
+void RS_EntityContainer::trackSelection(RS_Entity* entity)
+{
+    if (entity->getFlag(RS2::FlagSelected))
+        m_selectedEntities->insert(entity);
+    else
+        m_selectedEntities->erase(entity);
+}
+
+void RS_EntityContainer::trackEntity(RS_Entity* entity)
+{
+    trackSelection(entity);
+    (*m_layerEntities)[entity->getLayer(false)].insert(entity);
+    if (entity->rtti() == RS2::EntityConstructionLine)
+        m_constructionLines->insert(entity);
+}
+
+void RS_EntityContainer::untrackEntity(RS_Entity* entity)
+{
+    m_selectedEntities->erase(entity);
+    untrackLayer(entity, entity->getLayer(false));
+    m_constructionLines->erase(entity);
+}
+
+void RS_EntityContainer::untrackLayer(RS_Entity* entity, const RS_Layer* layer)
+{
+    auto it = m_layerEntities->find(layer);
+    if (it == m_layerEntities->end() || it->second.erase(entity) == 0) {
+        // the layer change wasn't reported, if the entity refers to another parent
+        it = std::find_if(m_layerEntities->begin(), m_layerEntities->end(),
+                          [entity](const auto& layerEntities) {
+            return layerEntities.second.count(entity) != 0;
+        });
+        if (it == m_layerEntities->end())
+            return;
+        it->second.erase(entity);
+    }
+    if (it->second.empty())
+        m_layerEntities->erase(it);
+}
+
+void RS_EntityContainer::sortByOrder(std::vector<RS_Entity*>& entities) const
+{
+    std::sort(entities.begin(), entities.end(), [this](const RS_Entity* e0, const RS_Entity* e1) {
+        return m_spatialIndex->order(e0) < m_spatialIndex->order(e1);
+    });
+}
+
+void RS_EntityContainer::selectionChanged(RS_Entity* entity)
+{
+    // entities may refer to this container without being in it, like clones
+    if (m_spatialIndex != nullptr && m_spatialIndex->contains(entity))
+        trackSelection(entity);
+}
+
+std::vector<RS_Entity*> RS_EntityContainer::getSelectedEntities() const
+{
+    std::vector<RS_Entity*> selected;
+    if (m_selectedEntities == nullptr) {
+        for (RS_Entity* e: entities) {
+            if (e->isSelected())
+                selected.push_back(e);
+        }
+        return selected;
+    }
+
+    for (RS_Entity* e: *m_selectedEntities) {
+        if (e->isSelected())
+            selected.push_back(e);
+    }
+    sortByOrder(selected);
+    return selected;
+}
+
+void RS_EntityContainer::layerChanged(RS_Entity* entity, const RS_Layer* oldLayer)
+{
+    if (oldLayer == entity->getLayer(false) || m_spatialIndex == nullptr
+            || !m_spatialIndex->contains(entity))
+        return;
+    untrackLayer(entity, oldLayer);
+    (*m_layerEntities)[entity->getLayer(false)].insert(entity);
+}
+
+std::vector<RS_Entity*> RS_EntityContainer::getLayerEntities(const RS_Layer* layer) const
+{
+    std::vector<RS_Entity*> found;
+    if (m_layerEntities == nullptr) {
+        for (RS_Entity* e: entities) {
+            if (e->getLayer() == layer)
+                found.push_back(e);
+        }
+        return found;
+    }
+
+    // entities without a layer of their own are on the layer of this container
+    auto collect = [this, &found](const RS_Layer* key) {
+        auto it = m_layerEntities->find(key);
+        if (it == m_layerEntities->end())
+            return;
+        for (RS_Entity* e: it->second) {
+            if (e->getLayer(false) == key)
+                found.push_back(e);
+        }
+    };
+    collect(layer);
+    if (layer != nullptr && layer == getLayer())
+        collect(nullptr);
+    sortByOrder(found);
+    return found;
+}
+
 std::vector<std::unique_ptr<RS_EntityContainer>> RS_EntityContainer::getLoops() const
 {
     if (entities.empty())
@@ -28,11 +28,23 @@
 #ifndef RS_ENTITYCONTAINER_H
 #define RS_ENTITYCONTAINER_H
 
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 #include <QList>
+#include "lc_rect.h"
 #include "rs_entity.h"
 
+class LC_SpatialIndex;
+class RS_Dimension;
+class RS_Insert;
+
 /**
  * Class representing a tree of entities.
  * Typical entity containers are graphics, polylines, groups, texts, ...)
@@ -45,7 +57,11 @@ class RS_EntityContainer : public RS_Entity {
 public:
 
 	RS_EntityContainer(RS_EntityContainer* parent=nullptr, bool owner=true);
-    //RS_EntityContainer(const RS_EntityContainer& ec);
+	/**
+	 * Shallow copy, the spatial index is not copied.
+	 */
+	RS_EntityContainer(const RS_EntityContainer& other);
+	RS_EntityContainer& operator = (const RS_EntityContainer& other);
 	
 	~RS_EntityContainer() override;
 
@@ -88,12 +104,36 @@ public:
 				bool select=true, bool cross=false);*/
 	virtual void selectWindow(enum RS2::EntityType typeToSelect, RS_Vector v1, RS_Vector v2,
 				bool select=true, bool cross=false);
+    static std::vector<RS_Entity*> filterEntities(const std::vector<RS_Entity*>& candidates,
+                                                  const std::function<bool(RS_Entity*)>& test);
     virtual void addEntity(RS_Entity* entity);
+    /**
+     * @brief reserveEntities reserves the entity list for the additions, before
+     * many entities are added at once
+     */
+    void reserveEntities(int additions);
     virtual void appendEntity(RS_Entity* entity);
     virtual void prependEntity(RS_Entity* entity);
 	virtual void moveEntity(int index, QList<RS_Entity *>& entList);
     virtual void insertEntity(int index, RS_Entity* entity);
     virtual bool removeEntity(RS_Entity* entity);
+    /**
+     * @brief removeEntities remove all entities selected by the predicate, in one pass
+     * @return the number of entities removed
+     */
+    unsigned removeEntities(const std::function<bool(const RS_Entity*)>& predicate);
+    /**
+     * @brief detachEntities take all entities selected by the predicate out of this
+     * container in one pass, without deleting them. The entities keep this container
+     * as their parent, so they can be restored by restoreEntities()
+     * @return the detached entities with their positions in the container, ascending
+     */
+    std::vector<std::pair<int, RS_Entity*>> detachEntities(const std::function<bool(const RS_Entity*)>& predicate);
+    /**
+     * @brief restoreEntities insert detached entities back at their positions
+     * @param detached - the entities with their positions, ascending
+     */
+    void restoreEntities(const std::vector<std::pair<int, RS_Entity*>>& detached);
 
 	//!
 	//! \brief addRectangle add four lines to form a rectangle by
@@ -102,6 +142,64 @@ public:
 	//!
 	void addRectangle(RS_Vector const& v0, RS_Vector const& v1);
 
+    /**
+     * @brief ResolvedIterator depth-first iterator over the leaf entities of the
+     * container, with sub-containers resolved by a resolve level. The iteration state
+     * is kept in the iterator, so a const container can be traversed by several
+     * iterators, nested or from different threads, at the same time.
+     */
+    class ResolvedIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = RS_Entity*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = RS_Entity* const*;
+        using reference = RS_Entity* const&;
+
+        //! the end iterator
+        ResolvedIterator() = default;
+        ResolvedIterator(const RS_EntityContainer* container, RS2::ResolveLevel level);
+
+        RS_Entity* operator*() const;
+        ResolvedIterator& operator++();
+        ResolvedIterator operator++(int);
+        bool operator==(const ResolvedIterator& other) const;
+        bool operator!=(const ResolvedIterator& other) const;
+
+    private:
+        // skip to the next leaf entity
+        void settle();
+
+        RS2::ResolveLevel m_level = RS2::ResolveNone;
+        // containers being traversed and the current indices within them
+        std::vector<std::pair<const RS_EntityContainer*, int>> m_stack;
+    };
+
+    //! range of entities for range based loops, see resolvedEntities()
+    class ResolvedRange {
+    public:
+        ResolvedRange(const RS_EntityContainer* container, RS2::ResolveLevel level);
+        ResolvedIterator begin() const;
+        ResolvedIterator end() const;
+    private:
+        const RS_EntityContainer* m_container = nullptr;
+        RS2::ResolveLevel m_level = RS2::ResolveNone;
+    };
+
+    /**
+     * @brief resolvedEntities the entities in the container, with sub-containers
+     * resolved by the resolve level, to be used in range based loops. Unlike
+     * firstEntity()/nextEntity(), the traversal doesn't modify the container.
+     * Instanced inserts create their entities on the first traversal, which is not
+     * thread safe, see RS_Insert::isInstanced().
+     */
+    ResolvedRange resolvedEntities(RS2::ResolveLevel level=RS2::ResolveNone) const;
+
+    /**
+     * firstEntity()/nextEntity() keep the iteration cursor in the container, and
+     * are not reentrant. Only one traversal can be done at a time, use
+     * resolvedEntities() in nested loops or concurrent code.
+     */
     virtual RS_Entity* firstEntity(RS2::ResolveLevel level=RS2::ResolveNone) const;
     virtual RS_Entity* lastEntity(RS2::ResolveLevel level=RS2::ResolveNone) const;
     virtual RS_Entity* nextEntity(RS2::ResolveLevel level=RS2::ResolveNone) const;
@@ -124,6 +222,8 @@ public:
 	/** \brief countSelected number of selected
 	* @param deep count sub-containers, if true
 	* @param types if is not empty, only counts by types listed
+	* With the spatial index, only the selected entities are visited, see
+	* setSpatialIndexEnabled()
 	*/
     virtual unsigned countSelected(bool deep=true, QList<RS2::EntityType> const& types = {});
     virtual double totalSelectedLength();
@@ -136,8 +236,103 @@ public:
         autoUpdateBorders = enable;
     }
     virtual void adjustBorders(RS_Entity* entity);
+    /**
+     * Enables / disables the spatial index of the entities in this
+     * container. The index is kept up to date on entity additions,
+     * removals and border updates. By default this is turned off.
+     * With the index, the selected entities are also kept in a set, so
+     * the selection is counted without traversing all the entities.
+     */
+    void setSpatialIndexEnabled(bool enable);
+    bool isSpatialIndexEnabled() const;
+    /**
+     * Enables the spatial index for containers of generated entities, like hatch
+     * patterns and text glyphs, if they are large enough for the index to speed up
+     * picking, and disables it otherwise.
+     */
+    void setSpatialIndexBySize();
+    /**
+     * @return a counter incremented when entities are added to or removed from this
+     * container or their borders change, to tell whether results computed from the
+     * entities are still up to date.
+     */
+    unsigned long getRevision() const {
+        return m_revision;
+    }
+    /**
+     * @return a number identifying this container for the life of the process, to
+     * key caches of data derived from the container. Unlike addresses of deleted
+     * containers, keys are never reused; a copy gets a key of its own.
+     */
+    unsigned long long getCacheKey() const {
+        return m_cacheKey.value;
+    }
+    /**
+     * Called by the entities of this container, when they're selected or
+     * deselected, to update the set of selected entities.
+     */
+    void selectionChanged(RS_Entity* entity);
+    /**
+     * Called by the entities of this container, when their layer is changed,
+     * to update the entities by layer.
+     * @param oldLayer - the previous layer of the entity
+     */
+    void layerChanged(RS_Entity* entity, const RS_Layer* oldLayer);
+    /**
+     * Called by the entities of this container, when they're undone or redone,
+     * as they're hidden or shown. Entity is nullptr for many entities at once.
+     */
+    void visibilityChanged(RS_Entity* entity);
+    /**
+     * @brief getLayerEntities the entities of this container on the layer, with
+     * the spatial index only the entities on the layer are visited
+     * @return the entities in the container order
+     */
+    std::vector<RS_Entity*> getLayerEntities(const RS_Layer* layer) const;
+    /**
+     * @brief getSelectedEntities the selected entities of this container, not
+     * including the selected sub-entities of unselected containers
+     * @return the entities in the container order
+     */
+    std::vector<RS_Entity*> getSelectedEntities() const;
+    /**
+     * @brief getEntitiesInArea find entities, which bounding boxes intersect with the area
+     * @param area - the area in graph coordinates
+     * @return entities in the container order. Without the spatial index, all entities
+     * are returned
+     */
+    std::vector<RS_Entity*> getEntitiesInArea(const LC_Rect& area) const;
+    /**
+     * @brief getEntitiesCrossingArea like getEntitiesInArea(), with the construction
+     * lines, which may intersect the area, as they're infinite
+     */
+    std::vector<RS_Entity*> getEntitiesCrossingArea(const LC_Rect& area) const;
+    /**
+     * @brief getStretchEntities find the visible and unlocked entities affected by a
+     * stretch window, among the entities found by getEntitiesCrossingArea()
+     * @param inside - the entities within the window, moved by the stretch
+     * @param crossing - the entities with endpoints within the window, stretched
+     */
+    void getStretchEntities(const RS_Vector& v1, const RS_Vector& v2,
+                            std::vector<RS_Entity*>& inside, std::vector<RS_Entity*>& crossing) const;
 	void calculateBorders() override;
-	void forcedCalculateBorders();
+    /**
+     * Recalculates the borders of this container from the borders of its
+     * entities, which must be up to date, without recalculating them.
+     */
+    void mergeBorders();
+    /**
+     * Updates the borders of this container. With the spatial index, the borders
+     * are found by the index, like mergeBorders() would, and kept until the entities
+     * or the frozen layers change; otherwise they're recalculated.
+     */
+    void updateBorders();
+    /**
+     * Marks the borders of this container and its parents to be recalculated,
+     * called by the methods changing the entities of the container.
+     */
+    void invalidateBorders();
+	virtual void forcedCalculateBorders();
 	void updateDimensions( bool autoText=true);
     virtual void updateInserts();
     virtual void updateSplines();
@@ -153,6 +348,24 @@ public:
     RS_Entity* getNearestEntity(const RS_Vector& point,
 								double* dist = nullptr,
 								RS2::ResolveLevel level=RS2::ResolveAll) const;
+    /**
+     * @brief getNearestEntity find the closest entity within a range. Entities with
+     * bounding boxes farther than the range are not tested. The spatial index is
+     * used, if enabled.
+     * @param point - the query point
+     * @param range - the maximum distance
+     * @param dist - the distance to the closest entity; the input value is used as
+     *               the distance for points inside solids
+     * @param level - the resolve level of sub-containers
+     * @param filter - if not empty, only resolved entities accepted by the filter
+     *                 are tested
+     * @return the closest entity, or nullptr
+     */
+    RS_Entity* getNearestEntity(const RS_Vector& point,
+                                double range,
+                                double* dist,
+                                RS2::ResolveLevel level,
+                                const std::function<bool(const RS_Entity*)>& filter = {}) const;
 
 	RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
                                       bool onEntity = true,
@@ -238,8 +451,23 @@ public:
 	//! \}
 
     const QList<RS_Entity*>& getEntityList();
+    /**
+     * @brief getCreatedEntities the entities created so far, without materializing
+     * the entities of containers which create them on demand, like flat polylines
+     * and instanced inserts. Those create their entities from their own data.
+     */
+    const QList<RS_Entity*>& getCreatedEntities() const {
+        return entities;
+    }
 
 protected:
+    /**
+     * @brief materializeEntities create the entities of containers, which create their
+     * entities on demand, see RS_Insert. Called by the iteration methods before the
+     * entity list is accessed.
+     */
+    virtual void materializeEntities() const {}
+
     /**
      * @brief getLoops for hatch, split closed loops into single simple loops. All returned containers are owned by
      * the returned object.
@@ -261,6 +489,63 @@ protected:
     bool autoUpdateBorders = true;
 
 private:
+	/**
+	 * @brief indexEntity add the entity at the given position to the spatial index
+	 * @param index - the position of the entity in the entity list
+	 */
+	void indexEntity(int index);
+	//! reset the spatial index order by the entity list
+	void reindexOrder();
+	//! update the entity in the set of selected entities by its selection flag
+	void trackSelection(RS_Entity* entity);
+	//! add or remove the entity to the indexed entities by selection and layer
+	void trackEntity(RS_Entity* entity);
+	void untrackEntity(RS_Entity* entity);
+	void untrackLayer(RS_Entity* entity, const RS_Layer* layer);
+	//! collect the inserts of this container and of its sub-containers, except hatches
+	void collectInserts(std::vector<RS_Insert*>& inserts) const;
+	//! sort entities of this container in the container order, by the spatial index
+	void sortByOrder(std::vector<RS_Entity*>& entities) const;
+	//! add the infinite lines crossing the area to the entities found by the spatial index
+	void addInfiniteEntities(const LC_Rect& area, std::vector<RS_Entity*>& found) const;
+	/**
+	 * @brief findNearest the nearest neighbor search among entities in this container.
+	 * Candidates are visited by increasing bounding box distances, if the spatial
+	 * index is enabled, and the search stops at the first candidate with a bounding
+	 * box farther than the closest entity found.
+	 * @param coord - the query point
+	 * @param range - candidates with bounding boxes farther than range are skipped
+	 * @param distance - the exact distance of a candidate, returns false to reject
+	 *                   the candidate. The entity to return is set by the third argument
+	 * @param pDist - the distance to the closest entity found
+	 * @param centers - the candidates snap to their centers, which may be out of their
+	 *                  bounding boxes
+	 * @return the closest entity found
+	 */
+	RS_Entity* findNearest(const RS_Vector& coord, double range,
+						   const std::function<bool(RS_Entity*, double&, RS_Entity*&)>& distance,
+						   double* pDist, bool centers = false) const;
+	/**
+	 * @brief findNearestPoint the nearest snap point of the entities in this container,
+	 * found by findNearest()
+	 * @param point - the snap point of a candidate and its distance, or an invalid point
+	 */
+	RS_Vector findNearestPoint(const RS_Vector& coord,
+							   const std::function<RS_Vector(RS_Entity*, double*)>& point,
+							   double* pDist, RS_Entity** pEntity, bool centers = false) const;
+	/**
+	 * @brief getIntersections find intersections of an entity with all other entities
+	 * with overlapping bounding boxes. Results are cached per entity, until this
+	 * container is modified. Invisible entities are included, the caller is expected
+	 * to filter the results by the current visibility.
+	 * @param closestEntity - the entity to intersect
+	 * @return pairs of the other entity and the intersection point
+	 */
+	const std::vector<std::pair<RS_Entity*, RS_Vector>>& getIntersections(RS_Entity* closestEntity);
+	//! clear cached intersections, the entities changed
+	void invalidateIntersections();
+    void collectOutdatedDimensions(std::size_t styleKey, std::vector<RS_Dimension*>& outdated);
+    static bool hasCachedBorders(const RS_Entity& entity);
 	/**
 	 * @brief ignoredSnap whether snapping is ignored
 	 * @return true when entity of this container won't be considered for snapping points
@@ -268,6 +553,34 @@ private:
 	bool ignoredSnap() const;
     mutable int entIdx = 0;
     bool autoDelete = false;
+    /** optional spatial index of entities in this container */
+    std::unique_ptr<LC_SpatialIndex> m_spatialIndex;
+    /** entities with the selection flag, maintained along with the spatial index */
+    std::unique_ptr<std::unordered_set<RS_Entity*>> m_selectedEntities;
+    /** entities by their own layer, maintained along with the spatial index */
+    std::unique_ptr<std::unordered_map<const RS_Layer*, std::unordered_set<RS_Entity*>>> m_layerEntities;
+    /** construction lines, infinite, maintained along with the spatial index */
+    std::unique_ptr<std::unordered_set<RS_Entity*>> m_constructionLines;
+    /** the borders are up to date with the entities, see invalidateBorders() */
+    std::atomic<bool> m_bordersValid{false};
+    /** cached intersections for intersection snapping, created on demand */
+    struct IntersectionCache;
+    std::unique_ptr<IntersectionCache> m_intersectionCache;
+    /** the borders found by updateBorders() */
+    struct BordersCache;
+    std::unique_ptr<BordersCache> m_bordersCache;
+    /** see getRevision() */
+    unsigned long m_revision = 0;
+    /** see getCacheKey(), issued on construction, kept on assignment */
+    struct CacheKey {
+        CacheKey();
+        CacheKey(const CacheKey&): CacheKey{} {}
+        CacheKey& operator = (const CacheKey&) {
+            return *this;
+        }
+        unsigned long long value;
+    };
+    CacheKey m_cacheKey;
 };
 
 #endif
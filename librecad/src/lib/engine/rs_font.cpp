@@ -25,12 +25,17 @@
 **********************************************************************/
 
 #include <iostream>
-#include <QRegularExpression>
-#include <QStringConverter>
-#include <QTextStream>
+#include <mutex>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QPainterPath>
 
 #include "rs_font.h"
+#include "lc_entitypool.h"
+#include "lc_fontfile.h"
 #include "rs_arc.h"
+#include "rs_block.h"
 #include "rs_line.h"
 #include "rs_polyline.h"
 #include "rs_fontchar.h"
@@ -38,6 +43,45 @@
 #include "rs_math.h"
 #include "rs_debug.h"
 
+namespace {
+// distance of segment ends joined in one subpath of a glyph outline
+constexpr double glyphJoinTolerance = 1e-6;
+
+// appends the strokes of a glyph block to path, false for entities without outline
+bool appendGlyphOutline(QPainterPath& path, const RS_EntityContainer& container) {
+    for (const RS_Entity* e: container) {
+        const RS_Vector start = e->getStartpoint();
+        const bool joined = !path.isEmpty()
+                && RS_Vector{path.currentPosition().x(), path.currentPosition().y()}.distanceTo(start) < glyphJoinTolerance;
+        switch (e->rtti()) {
+        case RS2::EntityLine:
+            if (!joined)
+                path.moveTo(start.x, start.y);
+            path.lineTo(e->getEndpoint().x, e->getEndpoint().y);
+            break;
+        case RS2::EntityArc: {
+            // the angles of QPainterPath are clockwise in graph coordinates
+            auto arc = static_cast<const RS_Arc*>(e);
+            const double radius = arc->getRadius();
+            const QRectF rect{arc->getCenter().x - radius, arc->getCenter().y - radius, 2. * radius, 2. * radius};
+            const double startAngle = -RS_Math::rad2deg(arc->getAngle1());
+            const double sweep = RS_Math::rad2deg(arc->isReversed() ? arc->getAngleLength() : -arc->getAngleLength());
+            if (!joined)
+                path.arcMoveTo(rect, startAngle);
+            path.arcTo(rect, startAngle, sweep);
+            break;
+        }
+        default:
+            if (!e->isContainer() || e->rtti() == RS2::EntityInsert
+                    || !appendGlyphOutline(path, *static_cast<const RS_EntityContainer*>(e)))
+                return false;
+            break;
+        }
+    }
+    return true;
+}
+}
+
 /**
  * Constructor.
  *
@@ -50,9 +94,10 @@ RS_Font::RS_Font(const QString& fileName, bool owner)
     letterSpacing = 3.0;
     wordSpacing = 6.75;
     lineSpacingFactor = 1.0;
-    rawLffFontList.clear();
 }
 
+RS_Font::~RS_Font() = default;
+
 
 
 /**
@@ -62,16 +107,25 @@ RS_Font::RS_Font(const QString& fileName, bool owner)
  * @retval false font could not be loaded.
  */
 bool RS_Font::loadFont() {
-    RS_DEBUG->print("RS_Font::loadFont");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Font::loadFont");
 
     if (loaded) {
         return true;
     }
 
-    QString path;
+    // the font may be loaded by RS_FontList::preloadFonts() in the background
+    std::lock_guard<std::mutex> lock(loadMutex);
+    if (loaded) {
+        return true;
+    }
+    // fonts are shared by the documents, their glyphs must not keep a document arena
+    LC_EntityPool::Scope arenaScope{nullptr};
+
+    // the path may be known already from the font list
+    QString path = filePath;
 
     // Search for the appropriate font if we have only the name of the font:
-    if (!fileName.contains(".cxf", Qt::CaseInsensitive) &&
+    if (path.isEmpty() && !fileName.contains(".cxf", Qt::CaseInsensitive) &&
         !fileName.contains(".lff", Qt::CaseInsensitive)) {
         QStringList fonts = RS_SYSTEM->getNewFontList();
         fonts.append(RS_SYSTEM->getFontList());
@@ -85,13 +139,13 @@ bool RS_Font::loadFont() {
     }
 
     // We have the full path of the font:
-    else {
+    else if (path.isEmpty()) {
         path = fileName;
     }
 
     // No font paths found:
     if (path.isEmpty()) {
-        RS_DEBUG->print(RS_Debug::D_WARNING,
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING,
                         "RS_Font::loadFont: No fonts available.");
         return false;
     }
@@ -99,24 +153,44 @@ bool RS_Font::loadFont() {
     // Open cxf file:
     QFile f(path);
     if (!f.open(QIODevice::ReadOnly)) {
-        RS_DEBUG->print(RS_Debug::D_WARNING,
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING,
                         "RS_Font::loadFont: Cannot open font file: %s",
                         path.toLatin1().data());
         return false;
     } else {
-        RS_DEBUG->print("RS_Font::loadFont: "
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Font::loadFont: "
                         "Successfully opened font file: %s",
                         path.toLatin1().data());
     }
+    const QByteArray content = f.readAll();
     f.close();
 
-    if (path.contains(".cxf"))
-        readCXF(path);
-    if (path.contains(".lff"))
-        readLFF(path);
+    // the glyphs are compiled once and cached by the hash of the font file, letters
+    // are generated from the compiled glyphs on first use
+    const QByteArray hash = QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+    compiled = std::make_unique<LC_CompiledFont>();
+    if (!compiled->loadCache(hash)) {
+        LC_CompiledFont::Builder builder;
+        LC_CompiledFont::Metrics metrics;
+        if (path.contains(".cxf"))
+            LC_FontFile::readCXF(content, builder, metrics);
+        if (path.contains(".lff"))
+            LC_FontFile::readLFF(content, builder, metrics);
+        compiled->setCompiled(builder.compile(metrics, hash), hash);
+    }
 
-    RS_Block* bk = letterList.find(QChar(0xfffd));
-	if (!bk) {
+    const LC_CompiledFont::Metrics& metrics = compiled->getMetrics();
+    letterSpacing = metrics.letterSpacing;
+    wordSpacing = metrics.wordSpacing;
+    lineSpacingFactor = metrics.lineSpacingFactor;
+    encoding = metrics.encoding;
+    fileLicense = metrics.license;
+    fileCreate = metrics.created;
+    names = metrics.names;
+    authors = metrics.authors;
+
+    // the replacement character, if the font doesn't have it
+	if (!compiled->hasGlyph(0xfffd)) {
         // create new letter:
 		RS_FontChar* letter = new RS_FontChar(nullptr, QChar(0xfffd), RS_Vector(0.0, 0.0));
         RS_Polyline* pline = new RS_Polyline(letter, RS_PolylineData());
@@ -134,285 +208,91 @@ bool RS_Font::loadFont() {
 
     loaded = true;
 
-    RS_DEBUG->print("RS_Font::loadFont OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Font::loadFont OK");
 
     return true;
 }
 
 
-void RS_Font::readCXF(QString path) {
-    QString line;
-    QFile f(path);
-    f.open(QIODevice::ReadOnly);
-    QTextStream ts(&f);
-
-    // Read line by line until we find a new letter:
-    while (!ts.atEnd()) {
-        line = ts.readLine();
-
-        if (line.isEmpty())
-            continue;
-
-        // Read font settings:
-        if (line.at(0)=='#') {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-            QStringList lst = ( line.right(line.length()-1) ).split(':', Qt::SkipEmptyParts);
-#else
-            QStringList lst = ( line.right(line.length()-1) ).split(':', QString::SkipEmptyParts);
-#endif
-            QStringList::Iterator it3 = lst.begin();
-
-            // RVT_PORT sometimes it happens that the size is < 2
-            if (lst.size()<2)
-                continue;
-
-            QString identifier = (*it3).trimmed();
-            it3++;
-            QString value = (*it3).trimmed();
-
-            if (identifier.toLower()=="letterspacing") {
-                letterSpacing = value.toDouble();
-            } else if (identifier.toLower()=="wordspacing") {
-                wordSpacing = value.toDouble();
-            } else if (identifier.toLower()=="linespacingfactor") {
-                lineSpacingFactor = value.toDouble();
-            } else if (identifier.toLower()=="author") {
-                authors.append(value);
-            } else if (identifier.toLower()=="name") {
-                names.append(value);
-            } else if (identifier.toLower()=="encoding") {
-                ts.setEncoding(QStringConverter::encodingForName(value.toLatin1()).value());
-                encoding = value;
-            }
-        }
-
-        // Add another letter to this font:
-        else if (line.at(0)=='[') {
-
-            // uniode character:
-            QChar ch;
-
-            // read unicode:
-            QRegularExpression regexp("[0-9A-Fa-f]{4,4}");
-            QRegularExpressionMatch match=regexp.match(line);
-            if (match.hasMatch()) {
-	        QString cap = match.captured(0);
-		int uCode = cap.toInt(nullptr, 16);
-                ch = QChar(uCode);
-            }
-
-            // read UTF8 (LibreCAD 1 compatibility)
-            else if (line.indexOf(']')>=3) {
-                int i = line.indexOf(']');
-                QString mid = line.mid(1, i-1);
-                ch = QString::fromUtf8(mid.toLatin1()).at(0);
-            }
-
-            // read normal ascii character:
-            else {
-                ch = line.at(1);
-            }
-
-            // create new letter:
-            RS_FontChar* letter =
-					new RS_FontChar(nullptr, ch, RS_Vector(0.0, 0.0));
-
-            // Read entities of this letter:
-            QString coordsStr;
-            QStringList coords;
-            QStringList::Iterator it2;
-            do {
-                line = ts.readLine();
-
-                if (line.isEmpty()) {
-                    continue;
-                }
-
-                coordsStr = line.right(line.length()-2);
-                //                coords = QStringList::split(',', coordsStr);
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-                coords = coordsStr.split(',', Qt::SkipEmptyParts);
-#else
-                coords = coordsStr.split(',', QString::SkipEmptyParts);
-#endif
-                it2 = coords.begin();
-
-                // Line:
-                if (line.at(0)=='L') {
-                    double x1 = (*it2++).toDouble();
-                    double y1 = (*it2++).toDouble();
-                    double x2 = (*it2++).toDouble();
-                    double y2 = (*it2).toDouble();
-
-					RS_Line* line = new RS_Line{letter, {{x1, y1}, {x2, y2}}};
-                    line->setPen(RS_Pen(RS2::FlagInvalid));
-					line->setLayer(nullptr);
-                    letter->addEntity(line);
-                }
-
-                // Arc:
-                else if (line.at(0)=='A') {
-                    double cx = (*it2++).toDouble();
-                    double cy = (*it2++).toDouble();
-                    double r = (*it2++).toDouble();
-					double a1 = RS_Math::deg2rad((*it2++).toDouble());
-					double a2 = RS_Math::deg2rad((*it2).toDouble());
-                    bool reversed = (line.at(1)=='R');
-
-                    RS_ArcData ad(RS_Vector(cx,cy),
-                                  r, a1, a2, reversed);
-                    RS_Arc* arc = new RS_Arc(letter, ad);
-                    arc->setPen(RS_Pen(RS2::FlagInvalid));
-					arc->setLayer(nullptr);
-                    letter->addEntity(arc);
-                }
-            } while (!line.isEmpty());
-
-            if (letter->isEmpty()) {
-                delete letter;
-            } else {
-                letter->calculateBorders();
-                letterList.add(letter);
-            }
-        }
-    }
-    f.close();
-}
-
-void RS_Font::readLFF(QString path) {
-    QString line;
-    QFile f(path);
-    encoding = "UTF-8";
-    f.open(QIODevice::ReadOnly);
-    QTextStream ts(&f);
-
-    // Read line by line until we find a new letter:
-    while (!ts.atEnd()) {
-        line = ts.readLine();
-
-        if (line.isEmpty())
-            continue;
-
-        // Read font settings:
-        if (line.at(0)=='#') {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-            QStringList lst =line.remove(0,1).split(':', Qt::SkipEmptyParts);
-#else
-            QStringList lst =line.remove(0,1).split(':', QString::SkipEmptyParts);
-#endif
-            //if size is < 2 is a comentary not parameter
-            if (lst.size()<2)
-                continue;
-
-            QString identifier = lst.at(0).trimmed();
-            QString value = lst.at(1).trimmed();
-
-            if (identifier.toLower()=="letterspacing") {
-                letterSpacing = value.toDouble();
-            } else if (identifier.toLower()=="wordspacing") {
-                wordSpacing = value.toDouble();
-            } else if (identifier.toLower()=="linespacingfactor") {
-                lineSpacingFactor = value.toDouble();
-            } else if (identifier.toLower()=="author") {
-                authors.append(value);
-            } else if (identifier.toLower()=="name") {
-                names.append(value);
-            } else if (identifier.toLower()=="license") {
-                fileLicense = value;
-            } else if (identifier.toLower()=="encoding") {
-                ts.setEncoding(QStringConverter::encodingForName(value.toLatin1()).value());
-                encoding = value;
-            } else if (identifier.toLower()=="created") {
-                fileCreate = value;
-            }
-        }
-
-        // Add another letter to this font:
-        else if (line.at(0)=='[') {
-
-            // uniode character:
-            QChar ch;
-
-            // read unicode:
-            QRegularExpression regexp("[0-9A-Fa-f]{1,5}");
-	    QRegularExpressionMatch match=regexp.match(line);
-            if (match.hasMatch()) {
-	        QString cap = match.captured(0);
-		int uCode = cap.toInt(nullptr, 16);
-                ch = QChar(uCode);
-            }
-            // only unicode allowed
-            else {
-                RS_DEBUG->print(RS_Debug::D_WARNING,"Ignoring code from LFF font file: %s",qPrintable(line));
-                continue;
-            }
-
-            QStringList fontData;
-            do {
-                line = ts.readLine();
-                if(line.isEmpty()) break;
-                fontData.push_back(line);
-            } while(true);
-            if (0 < fontData.size()                             // valid data
-                && !rawLffFontList.contains( QString(ch))) {    // ignore duplicates
-                rawLffFontList[QString(ch)] = fontData;
-            }
-        }
-    }
-    f.close();
-}
-
 void RS_Font::generateAllFonts(){
-    QMap<QString, QStringList>::const_iterator i = rawLffFontList.constBegin();
-    while (i != rawLffFontList.constEnd()) {
-        generateLffFont(i.key());
-        ++i;
+    if (compiled == nullptr)
+        return;
+    std::lock_guard<std::mutex> lock(glyphMutex);
+    for (char16_t code: compiled->getCodes()) {
+        if (letterList.find(QChar(code)) == nullptr)
+            generateGlyph(QChar(code));
     }
 }
 
-RS_Block* RS_Font::generateLffFont(const QString& key){
-
-    if (!rawLffFontList.contains( key)) {
-        RS_DEBUG->print( RS_Debug::D_ERROR, "RS_Font::generateLffFont([%04X]) : can not find the letter in LFF file %s", QChar(key.at(0)), qPrintable(fileName));
+/**
+ * Generates the letter block of a glyph from the compiled font.
+ *
+ * @param depth the nesting of letters included by other letters
+ */
+RS_Block* RS_Font::generateGlyph(const QString& key, int depth){
+    // letters including each other
+    constexpr int maxDepth = 16;
+    const std::vector<LC_CompiledFont::Record> records = (compiled != nullptr && key.size() == 1)
+            ? compiled->getGlyph(key.at(0).unicode()) : std::vector<LC_CompiledFont::Record>{};
+    if (records.empty()) {
+        RS_DEBUG_PRINT( RS_Debug::D_ERROR, "RS_Font::generateGlyph(%s) : can not find the letter in font file %s", qPrintable(key), qPrintable(fileName));
         return nullptr;
     }
 
     // create new letter:
     RS_FontChar* letter = new RS_FontChar(nullptr, key, RS_Vector(0.0, 0.0));
 
-    // Read entities of this letter:
-    QStringList vertex;
-    QStringList coords;
-    QStringList fontData = rawLffFontList[key];
-    QString line;
-
-    while(fontData.isEmpty() == false) {
-        line = fontData.takeFirst();
-
-        if (line.isEmpty()) {
-            continue;
+    for (const LC_CompiledFont::Record& record: records) {
+        const double* v = record.values;
+        switch (record.type) {
+        case LC_CompiledFont::Line: {
+            if (record.count < 4)
+                break;
+            RS_Line* line = new RS_Line{letter, {{v[0], v[1]}, {v[2], v[3]}}};
+            line->setPen(RS_Pen(RS2::FlagInvalid));
+            line->setLayer(nullptr);
+            letter->addEntity(line);
+            break;
         }
-
-        // Defined char:
-        if (line.at(0)=='C') {
-            line.remove(0,1);
-			int uCode = line.toInt(nullptr, 16);
-            QChar ch = QChar(uCode);
-            if (QString(ch) == key) {   // recursion, a character can't include itself
-                RS_DEBUG->print( RS_Debug::D_ERROR, "RS_Font::generateLffFont([%04X]) : recursion, ignore this character from %s", uCode, qPrintable(fileName));
+        case LC_CompiledFont::Arc: {
+            if (record.count < 6)
+                break;
+            RS_ArcData ad(RS_Vector(v[0], v[1]), v[2], v[3], v[4], v[5] != 0.);
+            RS_Arc* arc = new RS_Arc(letter, ad);
+            arc->setPen(RS_Pen(RS2::FlagInvalid));
+            arc->setLayer(nullptr);
+            letter->addEntity(arc);
+            break;
+        }
+        case LC_CompiledFont::Polyline: {
+            RS_Polyline* pline = new RS_Polyline(letter, RS_PolylineData());
+            pline->setPen(RS_Pen(RS2::FlagInvalid));
+            pline->setLayer(nullptr);
+            for (size_t i = 0; i + 2 < record.count; i += 3) {
+                pline->setNextBulge(v[i + 2]);
+                pline->addVertex(RS_Vector(v[i], v[i + 1]), v[i + 2]);
+            }
+            letter->addEntity(pline);
+            break;
+        }
+        case LC_CompiledFont::Reference: {
+            if (record.count < 1)
+                break;
+            const QChar ch = QChar(char16_t(v[0]));
+            if (QString(ch) == key || depth >= maxDepth) {   // recursion, a character can't include itself
+                RS_DEBUG_PRINT( RS_Debug::D_ERROR, "RS_Font::generateGlyph(%s) : recursion, ignore this character from %s", qPrintable(key), qPrintable(fileName));
                 delete letter;
                 return nullptr;
             }
 
             RS_Block* bk = letterList.find(ch);
             if (nullptr == bk) {
-                if (!rawLffFontList.contains(ch)) {
-                    RS_DEBUG->print( RS_Debug::D_ERROR, "RS_Font::generateLffFont([%04X]) : can not find the letter C%04X in LFF file %s", QChar(key.at(0)), uCode, qPrintable(fileName));
+                if (!compiled->hasGlyph(ch.unicode())) {
+                    RS_DEBUG_PRINT( RS_Debug::D_ERROR, "RS_Font::generateGlyph(%s) : can not find the letter C%04X in font file %s", qPrintable(key), ch.unicode(), qPrintable(fileName));
                     delete letter;
                     return nullptr;
                 }
-                generateLffFont(ch);
-                bk = letterList.find(ch);
+                bk = generateGlyph(ch, depth + 1);
             }
             if (nullptr != bk) {
                 RS_Entity* bk2 = bk->clone();
@@ -420,45 +300,9 @@ RS_Block* RS_Font::generateLffFont(const QString& key){
                 bk2->setLayer(nullptr);
                 letter->addEntity(bk2);
             }
+            break;
         }
-        //sequence:
-        else {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-            vertex = line.split(';', Qt::SkipEmptyParts);
-#else
-            vertex = line.split(';', QString::SkipEmptyParts);
-#endif
-            //at least is required two vertex
-            if (vertex.size()<2)
-                continue;
-            RS_Polyline* pline = new RS_Polyline(letter, RS_PolylineData());
-            pline->setPen(RS_Pen(RS2::FlagInvalid));
-			pline->setLayer(nullptr);
-            foreach(const QString& point, vertex) {
-                double x1, y1;
-                double bulge = 0;
-
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-                coords = point.split(',', Qt::SkipEmptyParts);
-#else
-                coords = point.split(',', QString::SkipEmptyParts);
-#endif
-                //at least X,Y is required
-                if (coords.size()<2)
-                    continue;
-                x1 = coords.at(0).toDouble();
-                y1 = coords.at(1).toDouble();
-                //check presence of bulge
-                if (coords.size() == 3 && coords.at(2).at(0) == QChar('A')){
-                    QString bulgeStr = coords.at(2);
-                    bulge = bulgeStr.remove(0,1).toDouble();
-                }
-                pline->setNextBulge(bulge);
-                pline->addVertex(RS_Vector(x1, y1), bulge);
-            }
-            letter->addEntity(pline);
         }
-
     }
 
     if (letter->isEmpty()) {
@@ -472,10 +316,35 @@ RS_Block* RS_Font::generateLffFont(const QString& key){
 }
 
 RS_Block* RS_Font::findLetter(const QString& name) {
-    RS_Block* ret= letterList.find(name);
-	if (ret) return ret;
-    return generateLffFont(name);
+    const Glyph* glyph = findGlyph(name);
+    return (glyph != nullptr) ? glyph->block : nullptr;
+}
 
+const RS_Font::Glyph* RS_Font::findGlyph(const QString& name) {
+    // texts may be updated concurrently, e.g. by RS_EntityContainer::updateDimensions()
+    std::lock_guard<std::mutex> lock(glyphMutex);
+    auto it = glyphs.find(name);
+    if (it == glyphs.end()) {
+        LC_EntityPool::Scope arenaScope{nullptr};
+        Glyph glyph;
+        glyph.block = letterList.find(name);
+        if (glyph.block == nullptr)
+            glyph.block = generateGlyph(name);
+        if (glyph.block != nullptr) {
+            glyph.minV = glyph.block->getMin() - glyph.block->getBasePoint();
+            glyph.maxV = glyph.block->getMax() - glyph.block->getBasePoint();
+            // the outline stroked by texts, letters of other entities are drawn as inserts
+            if (glyph.block->rtti() == RS2::EntityFontChar) {
+                QPainterPath outline;
+                if (appendGlyphOutline(outline, *glyph.block)) {
+                    outline.translate(-glyph.block->getBasePoint().x, -glyph.block->getBasePoint().y);
+                    static_cast<RS_FontChar*>(glyph.block)->setPath(outline);
+                }
+            }
+        }
+        it = glyphs.insert(name, glyph);
+    }
+    return (it->block != nullptr) ? &*it : nullptr;
 }
 /**
  * Dumps the fonts data to stdout.
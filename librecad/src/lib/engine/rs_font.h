@@ -28,9 +28,15 @@
 #ifndef RS_FONT_H
 #define RS_FONT_H
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 #include <QStringList>
 #include <QMap>
+#include "lc_compiledfont.h"
 #include "rs_blocklist.h"
+#include "rs_vector.h"
 
 /**
  * Class for representing a font. This is implemented as a RS_Graphic
@@ -41,7 +47,20 @@
  */
 class RS_Font {
 public:
+    /**
+     * @brief The Glyph struct, cached letter geometry shared by all texts using
+     * the font. Texts insert the letter block, and place letters by the box.
+     */
+    struct Glyph {
+        RS_Block* block = nullptr;
+        //! \{ bounding box of the letter, relative to the block base point
+        RS_Vector minV;
+        RS_Vector maxV;
+        //! \}
+    };
+
     RS_Font(const QString& name, bool owner=true);
+    ~RS_Font();
     //RS_Font(const char* name);
 
     /** @return the fileName of this font. */
@@ -98,6 +117,12 @@ public:
         return &letterList;
     }
     RS_Block* findLetter(const QString& name);
+    /**
+     * @brief findGlyph find a letter, the letter is generated from the font file
+     * and its box is found on first use only
+     * @return the glyph, or nullptr, if the font doesn't have the letter
+     */
+    const Glyph* findGlyph(const QString& name);
     //    RS_Block* findLetter(const QString& name) {
     //		return letterList.find(name);
     //	}
@@ -113,17 +138,18 @@ public:
     friend class RS_FontList;
 
 private:
-    void readCXF(QString path);
-    void readLFF(QString path);
-    RS_Block* generateLffFont(const QString& key);
+    RS_Block* generateGlyph(const QString& key, int depth = 0);
 
 private:
-    //raw lff font file list, not processed into blocks yet
-    QMap<QString, QStringList> rawLffFontList;
+    //! glyphs of the font file, not processed into blocks yet
+    std::unique_ptr<LC_CompiledFont> compiled;
 
     //! block list (letters)
     RS_BlockList letterList;
 
+    //! letters looked up so far, with nullptr blocks for missing letters
+    QMap<QString, Glyph> glyphs;
+
     //! Font file name
     QString fileName;
 
@@ -142,8 +168,15 @@ private:
     //! Authors
     QStringList authors;
 
+    //! Font file path, if known before loading
+    QString filePath;
+
     //! Is this font currently loaded into memory?
-    bool loaded = false;
+    std::atomic<bool> loaded{false};
+    //! serializes loading
+    std::mutex loadMutex;
+    //! guards the glyphs generated on first use
+    std::mutex glyphMutex;
 
     //! Default letter spacing for this font
     double letterSpacing = 0.;
@@ -28,6 +28,8 @@
 #ifndef RS_FONTCHAR_H
 #define RS_FONTCHAR_H
 
+#include <QPainterPath>
+
 #include "rs_block.h"
 
 
@@ -57,6 +59,17 @@ public:
     }
 
 
+    /**
+     * @return the outline of the letter relative to the base point, as
+     * stroked by texts. Empty if the letter has no outline path.
+     */
+    const QPainterPath& getPath() const {
+        return path;
+    }
+    void setPath(const QPainterPath& p) {
+        path = p;
+    }
+
     /*friend std::ostream& operator << (std::ostream& os, const RS_FontChar& b) {
        	os << " name: " << b.getName().latin1() << "\n";
     	os << " entities: " << (RS_EntityContainer&)b << "\n";
@@ -65,6 +78,7 @@ public:
 
 
 protected:
+    QPainterPath path;
 };
 
 
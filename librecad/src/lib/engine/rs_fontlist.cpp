@@ -25,19 +25,18 @@
 **********************************************************************/
 
 #include <iostream>
+#include <QFileInfo>
 #include <QHash>
+#include <QStringList>
 #include "rs_fontlist.h"
 #include "rs_debug.h"
 #include "rs_font.h"
 #include "rs_system.h"
 
-RS_FontList* RS_FontList::uniqueInstance = nullptr;
-
 RS_FontList* RS_FontList::instance() {
-	if (!uniqueInstance) {
-		uniqueInstance = new RS_FontList();
-	}
-	return uniqueInstance;
+    // created once, also if first used by concurrent text layout
+    static RS_FontList* uniqueInstance = new RS_FontList();
+    return uniqueInstance;
 }
 
 
@@ -46,22 +45,27 @@ RS_FontList* RS_FontList::instance() {
  * objects, one for each font that could be found.
  */
 void RS_FontList::init() {
-    RS_DEBUG->print("RS_FontList::initFonts");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FontList::initFonts");
 
     QStringList list = RS_SYSTEM->getNewFontList();
     list.append(RS_SYSTEM->getFontList());
     QHash<QString, int> added; //used to remember added fonts (avoid duplication)
 
     for (int i = 0; i < list.size(); ++i) {
-        RS_DEBUG->print(RS_Debug::D_ERROR, "font: %s:", list.at(i).toLatin1().data());
+        RS_DEBUG_PRINT(RS_Debug::D_ERROR, "font: %s:", list.at(i).toLatin1().data());
 
         QFileInfo fi( list.at(i) );
         if ( !added.contains(fi.baseName()) ) {
 			fonts.emplace_back(new RS_Font(fi.baseName()));
             added.insert(fi.baseName(), 1);
+            RS_Font* font = fonts.back().get();
+            font->filePath = list.at(i);
+            const QString key = font->getFileName().toLower();
+            if (!fontIndex.contains(key))
+                fontIndex.insert(key, font);
         }
 
-        RS_DEBUG->print(RS_Debug::D_ERROR, "base: %s", fi.baseName().toLatin1().data());
+        RS_DEBUG_PRINT(RS_Debug::D_ERROR, "base: %s", fi.baseName().toLatin1().data());
     }
 }
 
@@ -83,6 +87,8 @@ std::vector<std::unique_ptr<RS_Font> >::const_iterator RS_FontList::end() const
  * Removes all fonts in the fontlist.
  */
 void RS_FontList::clearFonts() {
+    loader.waitForDone();
+    fontIndex.clear();
 	fonts.clear();
 }
 
@@ -92,12 +98,26 @@ void RS_FontList::clearFonts() {
  * memory if it's not already.
  */
 RS_Font* RS_FontList::requestFont(const QString& name) {
-    RS_DEBUG->print("RS_FontList::requestFont %s",  name.toLatin1().data());
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FontList::requestFont %s",  name.toLatin1().data());
 
-    QString name2 = name.toLower();
-    RS_Font* foundFont = nullptr;
     if (name.isEmpty())
-        return foundFont;
+        return nullptr;
+
+    RS_Font* foundFont = findFont(name);
+    if (foundFont != nullptr) {
+        // Make sure this font is loaded into memory:
+        foundFont->loadFont();
+    }
+
+	if (!foundFont && name!="standard") {
+        foundFont = requestFont("standard");
+    }
+
+    return foundFont;
+}
+
+RS_Font* RS_FontList::findFont(const QString& name) const {
+    QString name2 = name.toLower();
 
     // QCAD 1 compatibility:
     if (name2.contains('#') && name2.contains('_')) {
@@ -106,24 +126,24 @@ RS_Font* RS_FontList::requestFont(const QString& name) {
         name2 = name2.left(name2.indexOf('#'));
     }
 
-    RS_DEBUG->print("name2: %s", name2.toLatin1().data());
-
-	// Search our list of available fonts:
-	for( auto const& f: fonts){
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "name2: %s", name2.toLatin1().data());
 
-        if (f->getFileName().toLower() == name2) {
-            // Make sure this font is loaded into memory:
-            f->loadFont();
-			foundFont = f.get();
-            break;
-        }
-    }
+    return fontIndex.value(name2, nullptr);
+}
 
-	if (!foundFont && name!="standard") {
-        foundFont = requestFont("standard");
+void RS_FontList::preloadFonts(const QStringList& names) {
+    for (const QString& name: names) {
+        RS_Font* font = name.isEmpty() ? nullptr : findFont(name);
+        // missing fonts are replaced by the standard font
+        if (font == nullptr)
+            font = findFont("standard");
+        if (font == nullptr || font->loaded)
+            continue;
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FontList::preloadFonts: %s", name.toLatin1().data());
+        loader.start([font]() {
+            font->loadFont();
+        });
     }
-
-    return foundFont;
 }
 
 /**
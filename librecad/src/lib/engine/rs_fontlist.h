@@ -28,7 +28,11 @@
 #include <memory>
 #include <vector>
 
-class QString;
+#include <QHash>
+#include <QString>
+#include <QThreadPool>
+
+class QStringList;
 class RS_Font;
 
 #define RS_FONTLIST RS_FontList::instance()
@@ -36,6 +40,8 @@ class RS_Font;
 /**
  * The global list of fonts. This is implemented as a singleton.
  * Use RS_FontList::instance() to get a pointer to the object.
+ * Fonts may be requested by concurrent threads: the list is only changed
+ * by init() and clearFonts(), fonts lock their loading and glyphs.
  *
  * @author Andrew Mustun
  */
@@ -54,6 +60,13 @@ public:
     void clearFonts();
     size_t countFonts() const;
     RS_Font* requestFont(const QString& name);
+    /**
+     * @brief preloadFonts start loading fonts in the background, so fonts are ready,
+     * when texts are created. Fonts, which are requested while loading, wait for
+     * their loading to finish.
+     * @param names - font names, as passed to requestFont()
+     */
+    void preloadFonts(const QStringList& names);
     std::vector<std::unique_ptr<RS_Font> >::const_iterator begin() const;
     std::vector<std::unique_ptr<RS_Font> >::const_iterator end() const;
 
@@ -63,9 +76,15 @@ private:
     RS_FontList()=default;
     RS_FontList(RS_FontList const&)=delete;
     RS_FontList& operator = (RS_FontList const&)=delete;
-    static RS_FontList* uniqueInstance;
+    // the font by the name, without loading
+    RS_Font* findFont(const QString& name) const;
+
     //! fonts in the graphic
     std::vector<std::unique_ptr<RS_Font>> fonts;
+    //! fonts by lower case file names
+    QHash<QString, RS_Font*> fontIndex;
+    //! threads for preloading
+    QThreadPool loader;
 };
 
 #endif
@@ -24,8 +24,10 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <unordered_set>
 
 #include <QDir>
 
@@ -33,16 +35,76 @@
 
 #include "dxf_format.h"
 #include "lc_defaults.h"
+#include "lc_documentsnapshot.h"
+#include "lc_regenstatistics.h"
+#include "lc_trace.h"
 #include "rs_block.h"
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "rs_fileio.h"
+#include "rs_insert.h"
 #include "rs_layer.h"
 #include "rs_math.h"
 #include "rs_settings.h"
+#include "rs_text.h"
 #include "rs_units.h"
 
 
+namespace {
+/**
+ * @return blocks with entities on the layers, followed by blocks which insert them
+ */
+std::vector<RS_Block*> getLayersBlocks(RS_BlockList& blockList, const std::vector<RS_Layer*>& layers)
+{
+    const std::unordered_set<const RS_Layer*> layerSet{layers.cbegin(), layers.cend()};
+    std::vector<RS_Block*> blocks;
+    std::unordered_set<const RS_Block*> found;
+    for (RS_Block* blk: blockList) {
+        if (blk != nullptr && std::any_of(blk->begin(), blk->end(), [&layerSet](const RS_Entity* e) {
+                return layerSet.count(e->getLayer()) == 1;
+            })) {
+            blocks.push_back(blk);
+            found.insert(blk);
+        }
+    }
+
+    // nested inserts
+    for (bool added = !blocks.empty(); added; ) {
+        added = false;
+        for (RS_Block* blk: blockList) {
+            if (blk == nullptr || found.count(blk) == 1)
+                continue;
+            if (std::any_of(blk->begin(), blk->end(), [&found](const RS_Entity* e) {
+                    return e->rtti() == RS2::EntityInsert
+                            && found.count(static_cast<const RS_Insert*>(e)->getBlockForInsert()) == 1;
+                })) {
+                blocks.push_back(blk);
+                found.insert(blk);
+                added = true;
+            }
+        }
+    }
+    return blocks;
+}
+
+/**
+ * @return inserts of the container, which insert one of the blocks
+ */
+std::vector<RS_Entity*> getBlocksInserts(const RS_EntityContainer& container, const std::vector<RS_Block*>& blocks)
+{
+    std::vector<RS_Entity*> inserts;
+    if (blocks.empty())
+        return inserts;
+    const std::unordered_set<const RS_Block*> blockSet{blocks.cbegin(), blocks.cend()};
+    for (RS_Entity* e: container) {
+        if (e->rtti() == RS2::EntityInsert
+                && blockSet.count(static_cast<const RS_Insert*>(e)->getBlockForInsert()) == 1)
+            inserts.push_back(e);
+    }
+    return inserts;
+}
+}
+
 /**
  * Default constructor.
  */
@@ -58,6 +120,8 @@ RS_Graphic::RS_Graphic(RS_EntityContainer* parent)
         pagesNumH(1),
         pagesNumV(1)
 {
+    // top level entities are culled and picked through the spatial index
+    setSpatialIndexEnabled(true);
 
     RS_SETTINGS->beginGroup("/Defaults");
     setUnit(RS_Units::stringToUnit(RS_SETTINGS->readEntry("/Unit", "None")));
@@ -104,7 +168,11 @@ RS_Graphic::RS_Graphic(RS_EntityContainer* parent)
 /**
  * Destructor.
  */
-RS_Graphic::~RS_Graphic() = default;
+RS_Graphic::~RS_Graphic()
+{
+    // the chunks are released with the last entity, deleted after this
+    LC_EntityPool::releaseArena(entityArena);
+}
 
 
 
@@ -116,12 +184,8 @@ unsigned long int RS_Graphic::countLayerEntities(RS_Layer* layer) {
     int c=0;
 
 	if (layer) {
-        for(RS_Entity* t: entities){
-
-			if (t->getLayer() &&
-                    t->getLayer()->getName()==layer->getName()) {
-                c+=t->countDeep();
-            }
+        for(RS_Entity* t: getLayerEntities(layer)){
+            c+=t->countDeep();
         }
     }
 
@@ -137,14 +201,8 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
 
     if (layer && layer->getName()!="0") {
 
-		std::vector<RS_Entity*> toRemove;
 		//find entities on layer
-        for(RS_Entity* e: entities){
-			if (e->getLayer() &&
-                    e->getLayer()->getName()==layer->getName()) {
-				toRemove.push_back(e);
-            }
-        }
+		std::vector<RS_Entity*> toRemove = getLayerEntities(layer);
 		// remove all entities on that layer:
 		if(toRemove.size()){
 			startUndoCycle();
@@ -155,6 +213,9 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
 			}
 			endUndoCycle();
 		}
+		// entities undone before are out of the list, they come back on layer "0"
+		for (RS_Entity* e: getUndoneLayerEntities(layer))
+			e->setLayer("0");
 
 		toRemove.clear();
         // remove all entities in blocks that are on that layer:
@@ -167,6 +228,8 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
 					toRemove.push_back(e);
 				}
 			}
+			for (RS_Entity* e: blk->getUndoneLayerEntities(layer))
+				toRemove.push_back(e);
 		}
 
         for(RS_Entity* e: toRemove){
@@ -179,6 +242,67 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
 }
 
 
+std::vector<RS_Entity*> RS_Graphic::getLayersDependents(const std::vector<RS_Layer*>& layers)
+{
+    std::vector<RS_Entity*> dependents;
+    for (RS_Layer* layer: layers) {
+        const std::vector<RS_Entity*> layerEntities = getLayerEntities(layer);
+        dependents.insert(dependents.end(), layerEntities.cbegin(), layerEntities.cend());
+    }
+    // inserts on the layers are found already
+    for (RS_Entity* insert: getBlocksInserts(*this, getLayersBlocks(blockList, layers))) {
+        if (std::find(layers.cbegin(), layers.cend(), insert->getLayer()) == layers.cend())
+            dependents.push_back(insert);
+    }
+    return dependents;
+}
+
+void RS_Graphic::updateLayersVisibility(const std::vector<RS_Layer*>& layers)
+{
+    LC_TRACE_ZONE("RS_Graphic::updateLayersVisibility");
+    const std::vector<RS_Block*> blocks = getLayersBlocks(blockList, layers);
+    const std::unordered_set<const RS_Block*> blockSet{blocks.cbegin(), blocks.cend()};
+    // inserted blocks come first, so nested inserts are bounded by their updated blocks
+    for (RS_Block* blk: blocks) {
+        for (RS_Entity* e: *blk) {
+            if (e->rtti() == RS2::EntityInsert
+                    && blockSet.count(static_cast<const RS_Insert*>(e)->getBlockForInsert()) == 1)
+                e->calculateBorders();
+        }
+        blk->calculateBorders();
+    }
+
+    // the borders of entities on frozen layers may be outdated
+    for (RS_Layer* layer: layers) {
+        if (layer == nullptr || layer->isFrozen())
+            continue;
+        for (RS_Entity* e: getLayerEntities(layer)) {
+            if (e->isContainer())
+                e->calculateBorders();
+            adjustBorders(e);
+        }
+    }
+    for (RS_Entity* insert: getBlocksInserts(*this, blocks)) {
+        insert->calculateBorders();
+        adjustBorders(insert);
+    }
+    updateBorders();
+}
+
+bool RS_Graphic::updateXrefs(const QString& fileName)
+{
+    const bool referenced = std::any_of(blockList.begin(), blockList.end(),
+                                        [&fileName](const RS_Block* blk) {
+        return blk != nullptr && blk->isXref() && blk->getXrefPath() == fileName;
+    });
+    if (!referenced)
+        return false;
+    // blocks may nest inserts of the reference
+    updateInserts();
+    calculateBorders();
+    return true;
+}
+
 /**
  * Clears all layers, blocks and entities of this graphic.
  * A default layer (0) is created.
@@ -304,6 +428,7 @@ bool RS_Graphic::BackupDrawingFile(const QString &filename)
 
 bool RS_Graphic::save(bool isAutoSave)
 {
+    LC_TRACE_ZONE("RS_Graphic::save", "file", filename);
     bool ret	= false;
 
     RS_DEBUG->print("RS_Graphic::save: Entering...");
@@ -324,8 +449,12 @@ bool RS_Graphic::save(bool isAutoSave)
         {
 			actualName = autosaveFilename;
 
-            if (formatType == RS2::FormatUnknown)
-                actualType = RS2::FormatDXFRW;
+            if (formatType == RS2::FormatUnknown || formatType == RS2::FormatDXFRW) {
+                // binary DXF is smaller and faster to write
+                auto groupGuard = RS_SETTINGS->beginGroupGuard("/Defaults");
+                actualType = RS_SETTINGS->readNumEntry("/AutoSaveBinary", 0) != 0
+                    ? RS2::FormatDXFRWBinary : RS2::FormatDXFRW;
+            }
 		} else {
 			//	- This is not an AutoSave operation.  This is a manual
 			//	  save operation.  So, ...
@@ -435,6 +564,7 @@ bool RS_Graphic::save(bool isAutoSave)
 
 bool RS_Graphic::saveAs(const QString &filename, RS2::FormatType type, bool force)
 {
+    LC_TRACE_ZONE("RS_Graphic::saveAs", "file", filename);
 	RS_DEBUG->print("RS_Graphic::saveAs: Entering...");
 
 	// Set to "failed" by default.
@@ -502,6 +632,7 @@ bool RS_Graphic::loadTemplate(const QString &filename, RS2::FormatType type) {
     newDoc();
 
     // import template file:
+    LC_EntityPool::Scope arenaScope{entityArena};
     ret = RS_FileIO::instance()->fileImport(*this, filename, type);
 
     setModified(false);
@@ -519,6 +650,18 @@ bool RS_Graphic::loadTemplate(const QString &filename, RS2::FormatType type) {
  * Loads the given file into this graphic.
  */
 bool RS_Graphic::open(const QString &filename, RS2::FormatType type) {
+    return open(filename, type, {});
+}
+
+/**
+ * Loads the given file into this graphic, the progress is reported while
+ * the file is imported in background.
+ */
+bool RS_Graphic::open(const QString &filename, RS2::FormatType type,
+                      const std::function<bool(double)>& progress,
+                      const LC_ImportOptions& options) {
+    LC_TRACE_ZONE("RS_Graphic::open", "file", filename);
+    LC_REGEN_REASON("open");
     RS_DEBUG->print("RS_Graphic::open(%s)", filename.toLatin1().data());
 
         bool ret = false;
@@ -531,11 +674,16 @@ bool RS_Graphic::open(const QString &filename, RS2::FormatType type) {
 
     // clean all:
     newDoc();
+    readOnly = false;
 
     // import file:
-    ret = RS_FileIO::instance()->fileImport(*this, filename, type);
+    {
+        LC_EntityPool::Scope arenaScope{entityArena};
+        ret = RS_FileIO::instance()->fileImport(*this, filename, type, progress, options);
+    }
 
     if( ret) {
+        setReadOnly(options.readOnly);
         setModified(false);
         layerList.setModified(false);
         blockList.setModified(false);
@@ -571,6 +719,9 @@ void RS_Graphic::addVariable(const QString& key, int value, int code) {
 void RS_Graphic::addVariable(const QString& key, double value, int code) {
     variableDict.add(key, value, code);
 }
+void RS_Graphic::addVariableUtf8(const QString& key, const QByteArray& value, int code) {
+    variableDict.addUtf8(key, value, code);
+}
 void RS_Graphic::removeVariable(const QString& key) {
     variableDict.remove(key);
 }
@@ -591,7 +742,19 @@ double RS_Graphic::getVariableDouble(const QString& key, double def) const {
     return variableDict.getDouble(key, def);
 }
 
-QHash<QString, RS_Variable>& RS_Graphic::getVariableDict() {
+RS_Vector RS_Graphic::getVariableVector(RS_VariableDict::CachedVariable var, const RS_Vector& def) const {
+    return variableDict.getVector(var, def);
+}
+
+int RS_Graphic::getVariableInt(RS_VariableDict::CachedVariable var, int def) const {
+    return variableDict.getInt(var, def);
+}
+
+double RS_Graphic::getVariableDouble(RS_VariableDict::CachedVariable var, double def) const {
+    return variableDict.getDouble(var, def);
+}
+
+const QHash<QString, RS_Variable>& RS_Graphic::getVariableDict() const {
     return variableDict.getVariableDict();
 }
 
@@ -599,7 +762,7 @@ QHash<QString, RS_Variable>& RS_Graphic::getVariableDict() {
  * @return true if the grid is switched on (visible).
  */
 bool RS_Graphic::isGridOn() const {
-        int on = getVariableInt("$GRIDMODE", 1);
+        int on = getVariableInt(RS_VariableDict::GridMode, 1);
         return on != 0;
 }
 
@@ -616,7 +779,7 @@ void RS_Graphic::setGridOn(bool on) {
  */
 bool RS_Graphic::isIsometricGrid() const{
     //$ISOMETRICGRID == $SNAPSTYLE
-        int on = getVariableInt("$SNAPSTYLE", 0);
+        int on = getVariableInt(RS_VariableDict::SnapStyle, 0);
         return on!=0;
 }
 
@@ -656,7 +819,7 @@ void RS_Graphic::setUnit(RS2::Unit u) {
  * Gets the unit of this graphic
  */
 RS2::Unit RS_Graphic::getUnit() const {
-    return static_cast<RS2::Unit>(getVariableInt("$INSUNITS", 0));
+    return static_cast<RS2::Unit>(getVariableInt(RS_VariableDict::InsUnits, 0));
 }
 
 
@@ -666,7 +829,7 @@ RS2::Unit RS_Graphic::getUnit() const {
  * This is determined by the variable "$LUNITS".
  */
 RS2::LinearFormat RS_Graphic::getLinearFormat() {
-    int lunits = getVariableInt("$LUNITS", 2);
+    int lunits = getVariableInt(RS_VariableDict::LinearUnits, 2);
     return getLinearFormat(lunits);
 /* changed by RS2::LinearFormat getLinearFormat(int f)
     switch (lunits) {
@@ -735,7 +898,7 @@ RS2::LinearFormat RS_Graphic::getLinearFormat(int f){
  * This is determined by the variable "$LUPREC".
  */
 int RS_Graphic::getLinearPrecision() {
-    return getVariableInt("$LUPREC", 4);
+    return getVariableInt(RS_VariableDict::LinearPrecision, 4);
 }
 
 
@@ -745,7 +908,7 @@ int RS_Graphic::getLinearPrecision() {
  * This is determined by the variable "$AUNITS".
  */
 RS2::AngleFormat RS_Graphic::getAngleFormat() {
-    int aunits = getVariableInt("$AUNITS", 0);
+    int aunits = getVariableInt(RS_VariableDict::AngleUnits, 0);
 
     switch (aunits) {
     default:
@@ -780,7 +943,7 @@ RS2::AngleFormat RS_Graphic::getAngleFormat() {
  * This is determined by the variable "$LUPREC".
  */
 int RS_Graphic::getAnglePrecision() {
-    return getVariableInt("$AUPREC", 4);
+    return getVariableInt(RS_VariableDict::AnglePrecision, 4);
 }
 
 
@@ -899,7 +1062,7 @@ void RS_Graphic::setPaperFormat(RS2::PaperFormat f, bool landscape) {
  * @return Paper space scaling (DXF: $PSVPSCALE).
  */
 double RS_Graphic::getPaperScale() const {
-    double paperScale = getVariableDouble("$PSVPSCALE", 1.0);
+    double paperScale = getVariableDouble(RS_VariableDict::PaperScale, 1.0);
     if (paperScale < 1.0e-6) {
         RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Graphic:: %s(), invalid paper scale %lg\n", __func__, paperScale);
     }
@@ -1018,6 +1181,67 @@ std::ostream& operator << (std::ostream& os, RS_Graphic& g) {
     return os;
 }
 
+void RS_Graphic::setReadOnly(bool on) {
+    if (readOnly == on)
+        return;
+    readOnly = on;
+
+    std::vector<RS_EntityContainer*> containers{this};
+    for (RS_Block* blk: blockList)
+        containers.push_back(blk);
+    if (on) {
+        unsigned compacted = 0;
+        for (RS_EntityContainer* container: containers) {
+            for (RS_Entity* e: *container) {
+                if (e->rtti() == RS2::EntityText && static_cast<RS_Text*>(e)->compact())
+                    ++compacted;
+            }
+        }
+        RS_DEBUG->print("RS_Graphic::setReadOnly: %u texts compacted", compacted);
+        return;
+    }
+
+    std::vector<RS_Entity*> texts;
+    for (RS_EntityContainer* container: containers) {
+        for (RS_Entity* e: *container) {
+            if (e->rtti() == RS2::EntityText && static_cast<RS_Text*>(e)->isCompact())
+                texts.push_back(e);
+        }
+    }
+    RS_DEBUG->print("RS_Graphic::setReadOnly: laying out %zu texts", texts.size());
+    RS_Text::updateAll(texts);
+}
+
+std::shared_ptr<LC_DxfSaveIndex> RS_Graphic::getDxfSaveIndex(const QString& fileName) const {
+    return dxfSaveIndexes.value(fileName);
+}
+
+void RS_Graphic::setDxfSaveIndex(const QString& fileName, std::shared_ptr<LC_DxfSaveIndex> index) {
+    if (index)
+        dxfSaveIndexes.insert(fileName, std::move(index));
+    else
+        dxfSaveIndexes.remove(fileName);
+}
+
+unsigned long RS_Graphic::getSnapshotVersion() const {
+    // the counters only grow, so their sum changes with each of them
+    return getVersion() + getRevision() + layerList.getVersion() + blockList.getVersion();
+}
+
+std::shared_ptr<const LC_DocumentSnapshot> RS_Graphic::snapshot() {
+    if (lastSnapshot == nullptr || lastSnapshot->getVersion() != getSnapshotVersion()) {
+        // copies shared with a snapshot still read are not relinked
+        const LC_DocumentSnapshot* previous = (lastSnapshot != nullptr && !lastSnapshot->isInUse())
+                ? lastSnapshot.get() : nullptr;
+        lastSnapshot = std::make_shared<LC_DocumentSnapshot>(*this, previous);
+    }
+    // the readers are counted by the handle, which keeps the snapshot
+    lastSnapshot->m_readers.fetch_add(1, std::memory_order_relaxed);
+    return {lastSnapshot.get(), [kept = lastSnapshot](const LC_DocumentSnapshot* released) {
+        released->m_readers.fetch_sub(1, std::memory_order_release);
+    }};
+}
+
 /**
  * Removes invalid objects.
  * @return how many objects were removed
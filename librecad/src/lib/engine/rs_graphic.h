@@ -29,12 +29,21 @@
 #ifndef RS_GRAPHIC_H
 #define RS_GRAPHIC_H
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include <QDateTime>
+#include <QHash>
+#include "lc_entitypool.h"
+#include "lc_importoptions.h"
 #include "rs_blocklist.h"
 #include "rs_layerlist.h"
 #include "rs_variabledict.h"
 #include "rs_document.h"
 
+class LC_DocumentSnapshot;
+class LC_DxfSaveIndex;
 class QG_LayerWidget;
 
 /**
@@ -69,6 +78,13 @@ public:
     bool save(bool isAutoSave = false) override;
     bool saveAs(const QString& filename, RS2::FormatType type, bool force = false) override;
     bool open(const QString& filename, RS2::FormatType type) override;
+    /**
+     * Opens the file reporting the progress, see RS_FileIO::fileImport().
+     * Only the part of the file selected by the options is imported.
+     */
+    bool open(const QString& filename, RS2::FormatType type,
+              const std::function<bool(double)>& progress,
+              const LC_ImportOptions& options = {});
     bool loadTemplate(const QString &filename, RS2::FormatType type) override;
 
         // Wrappers for Layer functions:
@@ -95,6 +111,23 @@ public:
     }
     void addEntity(RS_Entity* entity) override;
     virtual void removeLayer(RS_Layer* layer);
+    /**
+     * @brief getLayersDependents the entities which appearance depends on the visibility of
+     * the layers: the entities on the layers, and the inserts of blocks with entities on the layers
+     */
+    std::vector<RS_Entity*> getLayersDependents(const std::vector<RS_Layer*>& layers);
+    /**
+     * @brief updateLayersVisibility recalculates the borders changed by freezing or thawing
+     * of the layers: of blocks with entities on the layers, of their inserts and of the drawing.
+     * Inserts are not regenerated, their entities don't depend on the visibility of layers
+     */
+    void updateLayersVisibility(const std::vector<RS_Layer*>& layers);
+    /**
+     * @brief updateXrefs regenerates the inserts after a referenced file was reloaded
+     * @param fileName absolute path of the reloaded file
+     * @return true, if external references of this graphic use the file
+     */
+    bool updateXrefs(const QString& fileName);
     virtual void editLayer(RS_Layer* layer, const RS_Layer& source) {
         layerList.edit(layer, source);
     }
@@ -189,9 +222,10 @@ public:
     void addVariable(const QString& key, const QString& value, int code);
     void addVariable(const QString& key, int value, int code);
     void addVariable(const QString& key, double value, int code);
+    void addVariableUtf8(const QString& key, const QByteArray& value, int code);
     void removeVariable(const QString& key);
 
-    QHash<QString, RS_Variable>& getVariableDict();
+    const QHash<QString, RS_Variable>& getVariableDict() const;
 
     RS_Vector getVariableVector(const QString& key, const RS_Vector& def) const;
 
@@ -201,6 +235,11 @@ public:
 
     double getVariableDouble(const QString& key, double def) const;
 
+    // Variables read for each frame, without lookups by name:
+    RS_Vector getVariableVector(RS_VariableDict::CachedVariable var, const RS_Vector& def) const;
+    int getVariableInt(RS_VariableDict::CachedVariable var, int def) const;
+    double getVariableDouble(RS_VariableDict::CachedVariable var, double def) const;
+
 
     RS_VariableDict getVariableDictObject()
     {
@@ -280,6 +319,46 @@ public:
         return modifiedTime;
     }
 
+    /**
+     * @brief setReadOnly sets whether the graphic is opened for viewing and plotting
+     * only, see LC_ImportOptions::readOnly. The texts of read-only graphics and of their
+     * blocks are kept compact, see RS_Text::compact(); they're laid out again, when
+     * the graphic is made editable
+     */
+    void setReadOnly(bool on);
+    bool isReadOnly() const {
+        return readOnly;
+    }
+
+    /**
+     * @return the arena of the entities of this graphic and of its blocks, its chunks
+     * are released when the graphic is deleted, see LC_EntityPool
+     */
+    LC_EntityPool::Arena* getEntityArena() const {
+        return entityArena;
+    }
+
+    /**
+     * Index of the entities of a DXF file saved before, used to save
+     * the file again incrementally.
+     */
+    std::shared_ptr<LC_DxfSaveIndex> getDxfSaveIndex(const QString& fileName) const;
+    void setDxfSaveIndex(const QString& fileName, std::shared_ptr<LC_DxfSaveIndex> index);
+
+    /**
+     * @return a counter changed by any change of the entities, layers, blocks or
+     * undo history, which snapshots are compared with.
+     */
+    unsigned long getSnapshotVersion() const;
+    /**
+     * A read only snapshot of the graphic for background readers, as autosave
+     * or snapping on worker threads. It's taken by the thread of the graphic,
+     * which returns the same snapshot again as long as the graphic doesn't change.
+     * Readers release it when done, the next snapshot then shares the unchanged
+     * copies with it.
+     */
+    std::shared_ptr<const LC_DocumentSnapshot> snapshot();
+
     //if set to true, will refuse to modify paper scale
     void setPaperScaleFixed(bool fixed)
     {
@@ -348,12 +427,20 @@ private:
         QDateTime modifiedTime;
         QString currentFileName; //keep a copy of filename for the modifiedTime
 
+        //! see getEntityArena()
+        LC_EntityPool::Arena* entityArena = LC_EntityPool::createArena();
         RS_LayerList layerList;
         RS_BlockList blockList;
         RS_VariableDict variableDict;
+        //! indexes of the saved DXF files, by file name
+        QHash<QString, std::shared_ptr<LC_DxfSaveIndex>> dxfSaveIndexes;
+        //! the last snapshot taken, see snapshot()
+        std::shared_ptr<LC_DocumentSnapshot> lastSnapshot;
         RS2::CrosshairType crosshairType; //crosshair type used by isometric grid
         //if set to true, will refuse to modify paper scale
         bool paperScaleFixed = false;
+        //! opened for viewing only, see setReadOnly()
+        bool readOnly = false;
 
         // Paper margins in millimeters
         double marginLeft = 0.;
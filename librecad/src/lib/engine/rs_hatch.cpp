@@ -24,14 +24,24 @@
 **
 **********************************************************************/
 #include <cmath>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include <QHash>
 #include <QPainterPath>
 #include <QBrush>
 #include <QString>
+#include <QTransform>
 
+#include "lc_hatchscanline.h"
 #include "lc_looputils.h"
+#include "lc_preparedcontour.h"
+#include "lc_regenstatistics.h"
+#include "lc_taskscheduler.h"
+#include "lc_trace.h"
 
 #include "rs_arc.h"
 #include "rs_circle.h"
@@ -49,6 +59,21 @@
 
 namespace
 {
+// from this number of pending patterns on, patterns are created concurrently
+constexpr std::size_t parallelPatternMinimum = 4;
+// edges of a solid fill loop closing a contour within this distance start a new contour
+constexpr double fillContourTolerance = 1.0e-6;
+// the unit circle of elliptic arcs, in graph orientation
+const QRectF unitCircle{-1., -1., 2., 2.};
+
+void hashCombine(std::size_t& seed, double value) {
+    seed ^= std::hash<double>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+void hashCombine(std::size_t& seed, const RS_Vector& value) {
+    hashCombine(seed, value.valid ? value.x : RS_MAXDOUBLE);
+    hashCombine(seed, value.valid ? value.y : RS_MAXDOUBLE);
+}
 
 // angular distance corrected for direction and range [0, 2 pi]
 double angularDist(double a, double startAngle, bool reversed) {
@@ -137,14 +162,21 @@ bool RS_Hatch::validate() {
 
 
 RS_Entity* RS_Hatch::clone() const{
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::clone()");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::clone()");
     RS_Hatch* t = new RS_Hatch(*this);
     t->setOwner(isOwner());
     t->initId();
     t->detach();
+    // detach() skips the pattern, copy it instead of regenerating it
+    t->hatch = nullptr;
+    if (hatch != nullptr && !updateRunning) {
+        t->hatch = static_cast<RS_EntityContainer*>(hatch->clone());
+        t->hatch->reparent(t);
+        t->hatch->setSpatialIndexEnabled(hatch->isSpatialIndexEnabled());
+        t->addEntity(t->hatch);
+    }
     t->update();
-//    t->hatch = nullptr;
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::clone(): OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::clone(): OK");
     return t;
 }
 
@@ -168,13 +200,13 @@ bool RS_Hatch::isContainer() const {
  * Recalculates the borders of this hatch.
  */
 void RS_Hatch::calculateBorders() {
-    RS_DEBUG->print("RS_Hatch::calculateBorders");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::calculateBorders");
 
     activateContour(true);
 
     RS_EntityContainer::calculateBorders();
 
-        RS_DEBUG->print("RS_Hatch::calculateBorders: size: %f,%f",
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::calculateBorders: size: %f,%f",
                 getSize().x, getSize().y);
 
     activateContour(false);
@@ -186,110 +218,186 @@ void RS_Hatch::calculateBorders() {
  * Updates the Hatch. Called when the
  * hatch or it's data, position, alignment, .. changes.
  *
- * Refill hatch with pattern. Move, scale, rotate, trim, etc.
+ * The pattern is regenerated only if the contour, the pattern name, scale or
+ * angle changed since the pattern was created. Regenerating a pattern is
+ * deferred until the hatch is drawn, see ensurePattern().
  */
 void RS_Hatch::update() {
+    LC_TRACE_ZONE("RS_Hatch::update");
+    const LC_RegenStatistics::Regen regen{LC_RegenStatistics::Hatch};
 
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update");
 
     updateError = HATCH_OK;
+    // the edges of the contour may be changed
+    m_pickContour.reset();
+    m_fillPath.reset();
     if (updateRunning) {
-        RS_DEBUG->print(RS_Debug::D_NOTICE, "RS_Hatch::update: skip hatch in updating process");
+        RS_DEBUG_PRINT(RS_Debug::D_NOTICE, "RS_Hatch::update: skip hatch in updating process");
         return;
     }
 
     if (updateEnabled==false) {
-        RS_DEBUG->print(RS_Debug::D_NOTICE, "RS_Hatch::update: skip hatch forbidden to update");
+        RS_DEBUG_PRINT(RS_Debug::D_NOTICE, "RS_Hatch::update: skip hatch forbidden to update");
         return;
     }
 
     if (data.solid==true) {
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: processing solid hatch");
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: processing solid hatch");
+        setContourLayer();
         calculateBorders();
         return;
     }
 
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: contour has %d loops", count());
+    // an undone hatch keeps its pattern, so redo doesn't regenerate it
+    if (isUndone()) {
+        RS_DEBUG_PRINT(RS_Debug::D_NOTICE, "RS_Hatch::update: skip undone hatch");
+        return;
+    }
+
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: contour has %d loops", count());
     updateRunning = true;
+    const bool valid = validate();
+    updateRunning = false;
 
-    // save attributes for the current hatch
-    RS_Layer* hatch_layer = this->getLayer();
-    RS_Pen hatch_pen = this->getPen();
+    if (!valid) {
+        RS_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_Hatch::update: invalid contour in hatch found");
+        if (hatch) {
+            removeEntity(hatch);
+            hatch = nullptr;
+        }
+        m_patternPending = false;
+        updateError = HATCH_INVALID_CONTOUR;
+        return;
+    }
+
+    const std::size_t key = patternKey();
+    // the key is current, if the pattern is created, pending, or failed for the same key
+    if (key == m_patternKey && (hatch != nullptr || m_patternPending || m_patternError != HATCH_OK)) {
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: pattern unchanged");
+        updateError = m_patternError;
+        // the attributes of the hatch may have changed
+        if (hatch != nullptr) {
+            const RS_Pen hatch_pen = getPen();
+            RS_Layer* hatch_layer = getLayer();
+            if (hatch->getPen(false) != hatch_pen || hatch->getLayer(false) != hatch_layer) {
+                hatch->setPen(hatch_pen);
+                hatch->setLayer(hatch_layer);
+                for (RS_Entity* e: *hatch) {
+                    e->setPen(hatch_pen);
+                    e->setLayer(hatch_layer);
+                }
+            }
+        }
+        return;
+    }
 
     // delete old hatch:
     if (hatch) {
         removeEntity(hatch);
-		hatch = nullptr;
+        hatch = nullptr;
     }
 
-    if (isUndone()) {
-        RS_DEBUG->print(RS_Debug::D_NOTICE, "RS_Hatch::update: skip undone hatch");
-        updateRunning = false;
+    m_patternKey = key;
+    m_patternPending = true;
+    m_patternError = HATCH_OK;
+    calculateBorders();
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: OK");
+}
+
+/**
+ * Creates the pattern entities if update() deferred it.
+ */
+void RS_Hatch::ensurePattern() {
+    if (!m_patternPending || updateRunning)
         return;
-    }
 
-    if (!validate()) {
-        RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: invalid contour in hatch found");
-        updateRunning = false;
-        updateError = HATCH_INVALID_CONTOUR;
+    m_patternPending = false;
+    updateRunning = true;
+    m_patternError = HATCH_OK;
+    regeneratePattern();
+    if (m_patternError == HATCH_OK)
+        m_updated = true;
+    updateRunning = false;
+}
+
+void RS_Hatch::ensurePatterns(const std::vector<RS_Hatch*>& hatches)
+{
+    std::vector<RS_Hatch*> pending;
+    // pattern files are loaded and their errors reported by this thread
+    QHash<QString, bool> found;
+    for (RS_Hatch* h: hatches) {
+        if (h->data.solid || !h->m_patternPending || h->updateRunning)
+            continue;
+        auto it = found.find(h->data.pattern);
+        if (it == found.end())
+            it = found.insert(h->data.pattern, RS_PATTERNLIST->requestPattern(h->data.pattern) != nullptr);
+        if (it.value())
+            pending.push_back(h);
+    }
+    if (pending.size() < parallelPatternMinimum) {
+        for (RS_Hatch* h: pending)
+            h->ensurePattern();
         return;
     }
 
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::ensurePatterns: %zu patterns", pending.size());
+    LC_TaskScheduler::instance().parallelFor(0, pending.size(), 1,
+                                             [&pending](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            pending[i]->ensurePattern();
+    });
+}
+
+/**
+ * Refill hatch with pattern. Move, scale, rotate, trim, etc.
+ */
+void RS_Hatch::regeneratePattern() {
+
+    // save attributes for the current hatch
+    RS_Layer* hatch_layer = this->getLayer();
+    RS_Pen hatch_pen = this->getPen();
+
     // search for pattern
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: requesting pattern");
-    std::unique_ptr<RS_Pattern> pat = RS_PATTERNLIST->requestPattern(data.pattern);
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: requesting pattern");
+    std::shared_ptr<const RS_Pattern> pat = RS_PATTERNLIST->requestPattern(data.pattern);
     if (pat == nullptr) {
-        updateRunning = false;
-        RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: requesting pattern: %s not found", data.pattern.toUtf8().constData());
-        updateError = HATCH_PATTERN_NOT_FOUND;
+        RS_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_Hatch::update: requesting pattern: %s not found", data.pattern.toUtf8().constData());
+        m_patternError = HATCH_PATTERN_NOT_FOUND;
         return;
-    } else {
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: requesting pattern: OK");
-        // make a working copy of hatch pattern
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cloning pattern");
-        pat.reset((RS_Pattern*)pat->clone());
-        if (pat != nullptr) {
-            RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cloning pattern: OK");
-        } else {
-            RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: error while cloning hatch pattern");
-            return;
-        }
     }
+    // requestPattern() returns the shared pattern, which is read only
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: requesting pattern: OK");
 
-    // scale pattern
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: scaling pattern");
-    pat->scale(RS_Vector(0.0,0.0), RS_Vector(data.scale, data.scale));
-    pat->calculateBorders();
     forcedCalculateBorders();
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: scaling pattern: OK");
 
     std::unique_ptr<RS_Hatch> copy {(RS_Hatch*)this->clone()};
     copy->rotate(RS_Vector(0.0,0.0), -data.angle);
     copy->forcedCalculateBorders();
 
     // create a pattern over the whole contour.
-    RS_Vector pSize = pat->getSize();
-    RS_Vector rot_center=pat->getMin();
+    // the borders of the pattern scale with it
+    RS_Vector pSize = pat->getSize() * data.scale;
+    RS_Vector rot_center = pat->getMin() * data.scale;
 //    RS_Vector cPos = getMin();
     RS_Vector cSize = getSize();
 
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: pattern size: %f/%f", pSize.x, pSize.y);
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: contour size: %f/%f", cSize.x, cSize.y);
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: pattern size: %f/%f", pSize.x, pSize.y);
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: contour size: %f/%f", cSize.x, cSize.y);
 
     // check pattern sizes for sanity
     if (cSize.x<1.0e-6 || cSize.y<1.0e-6 ||
             pSize.x<1.0e-6 || pSize.y<1.0e-6 ||
             cSize.x>RS_MAXDOUBLE-1 || cSize.y>RS_MAXDOUBLE-1 ||
             pSize.x>RS_MAXDOUBLE-1 || pSize.y>RS_MAXDOUBLE-1) {
-        updateRunning = false;
-        RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: contour size or pattern size too small");
-        updateError = HATCH_TOO_SMALL;
+        RS_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_Hatch::update: contour size or pattern size too small");
+        m_patternError = HATCH_TOO_SMALL;
         return;
     }
     // avoid huge memory consumption:
     else if ( cSize.x* cSize.y/(pSize.x*pSize.y)>1e4) {
-        RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: contour size too large or pattern size too small");
-        updateError = HATCH_AREA_TOO_BIG;
+        RS_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_Hatch::update: contour size too large or pattern size too small");
+        m_patternError = HATCH_AREA_TOO_BIG;
         return;
     }
 
@@ -301,34 +409,70 @@ void RS_Hatch::update() {
     int py2 = (int)ceil(copy->getMax().y/pSize.y);
     RS_Vector dvx=RS_Vector(data.angle)*pSize.x;
     RS_Vector dvy=RS_Vector(data.angle+M_PI*0.5)*pSize.y;
-    pat->rotate(rot_center, data.angle);
-    pat->move(-rot_center);
 
-    RS_EntityContainer tmp;   // container for untrimmed lines
+    // one pattern instance: scaled, rotated around its corner and moved to the origin.
+    // Lines are transformed as plain segments, only other entities are cloned
+    const RS_Vector rotation{data.angle};
+    const auto transform = [&](RS_Vector v) {
+        return (v * data.scale - rot_center).rotate(rotation);
+    };
+    std::vector<LC_HatchScanline::Segment> tileLines;
+    RS_EntityContainer tile;
+    for (const RS_Entity* e: *pat) {
+        if (e->rtti() == RS2::EntityLine) {
+            tileLines.emplace_back(transform(e->getStartpoint()), transform(e->getEndpoint()));
+            continue;
+        }
+        RS_Entity* te = e->clone();
+        te->reparent(&tile);
+        te->scale(RS_Vector(0.0,0.0), RS_Vector(data.scale, data.scale));
+        te->rotate(rot_center, data.angle);
+        te->move(-rot_center);
+        tile.addEntity(te);
+    }
+
+    // lines are trimmed by scanlines, other pattern entities by their intersections with the contour
+    RS_EntityContainer tmp;   // container for untrimmed pattern entities
+    std::vector<LC_HatchScanline::Segment> lines;
+    lines.reserve(tileLines.size() * (px2 - px1) * (py2 - py1));
 
     // adding array of patterns to tmp:
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet");
     for (int px=px1; px<px2; px++) {
 		for (int py=py1; py<py2; py++) {
-			for(auto e: *pat){
+            const RS_Vector offset = dvx*px + dvy*py;
+            for (const auto& [start, end]: tileLines)
+                lines.emplace_back(start + offset, end + offset);
+			for(auto e: tile){
                 RS_Entity* te=e->clone();
-                te->move(dvx*px + dvy*py);
+                te->move(offset);
                 tmp.addEntity(te);
             }
         }
     }
 
     // clean memory
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet: OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet: OK");
 
     // cut pattern to contour shape
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet");
+    std::vector<const RS_EntityContainer*> loops;
+    for (const RS_Entity* l: entities) {
+        if (l->isContainer() && !l->getFlag(RS2::FlagTemp))
+            loops.push_back(static_cast<const RS_EntityContainer*>(l));
+    }
+    const auto trimmedLines = LC_HatchScanline::trimLines(loops, lines);
+    if (!trimmedLines) {
+        // the contour has edges not supported by scanlines
+        for (const auto& [start, end]: lines)
+            tmp.addEntity(new RS_Line{&tmp, start, end});
+    }
     // start for very very long for(auto e: tmp) loop
     RS_EntityContainer tmp2 = trimPattern(tmp);   // container for small cut lines
     // end for very very long for(auto e: tmp) loop
 
     // updating hatch / adding entities that are inside
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet: OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet: OK");
 
     // add the hatch pattern entities
     hatch = new RS_EntityContainer(this);
@@ -336,7 +480,19 @@ void RS_Hatch::update() {
     hatch->setLayer(hatch_layer);
     hatch->setFlag(RS2::FlagTemp);
 
+    // lines trimmed by scanlines are inside already
+    if (trimmedLines) {
+        for (const auto& [start, end]: *trimmedLines) {
+            auto* te = new RS_Line{hatch, start, end};
+            te->setPen(hatch_pen);
+            te->setLayer(hatch_layer);
+            hatch->addEntity(te);
+        }
+    }
+
     //calculateBorders();
+    // the contour is tested for two points of each line
+    const LC_PreparedContour contour{*this};
 	for(auto e: tmp2){
 
         RS_Vector middlePoint;
@@ -359,10 +515,8 @@ void RS_Hatch::update() {
         if (middlePoint.valid) {
             bool onContour=false;
 
-            if (RS_Information::isPointInsideContour(
-                        middlePoint,
-                        this, &onContour) ||
-                    RS_Information::isPointInsideContour(middlePoint2, this)) {
+            if (contour.isPointInside(middlePoint, &onContour) ||
+                    contour.isPointInside(middlePoint2)) {
 
                 RS_Entity* te = e->clone();
                 te->setPen(hatch_pen);
@@ -377,14 +531,56 @@ void RS_Hatch::update() {
     //getGraphic()->addEntity(rubbish);
 
     forcedCalculateBorders();
+    // large patterns are picked by the index of the pattern entities
+    hatch->setSpatialIndexBySize();
 
     // deactivate contour:
     activateContour(false);
 
-    updateRunning = false;
-    m_updated = true;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::regeneratePattern: OK");
+}
 
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: OK");
+/**
+ * @return hash of everything the pattern depends on: the contour geometry,
+ * the pattern name, the scale and the angle.
+ */
+std::size_t RS_Hatch::patternKey() const {
+    std::size_t key = qHash(data.pattern);
+    hashCombine(key, data.scale);
+    hashCombine(key, data.angle);
+    for (const RS_Entity* l: entities) {
+        if (!l->isContainer() || l->getFlag(RS2::FlagTemp))
+            continue;
+        hashCombine(key, -1.);
+        for (const RS_Entity* e: *static_cast<const RS_EntityContainer*>(l)) {
+            hashCombine(key, double(e->rtti()));
+            hashCombine(key, e->getStartpoint());
+            hashCombine(key, e->getEndpoint());
+            switch (e->rtti()) {
+            case RS2::EntityArc:
+                hashCombine(key, e->getCenter());
+                hashCombine(key, static_cast<const RS_Arc*>(e)->isReversed() ? 1. : 0.);
+                break;
+            case RS2::EntityCircle:
+                hashCombine(key, e->getCenter());
+                hashCombine(key, e->getRadius());
+                break;
+            case RS2::EntityEllipse: {
+                const auto* ellipse = static_cast<const RS_Ellipse*>(e);
+                hashCombine(key, ellipse->getCenter());
+                hashCombine(key, ellipse->getMajorP());
+                hashCombine(key, ellipse->getRatio());
+                hashCombine(key, ellipse->getAngle1());
+                hashCombine(key, ellipse->getAngle2());
+                hashCombine(key, ellipse->isReversed() ? 1. : 0.);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+    return key;
 }
 
 
@@ -392,10 +588,21 @@ RS_EntityContainer RS_Hatch::trimPattern(const RS_EntityContainer& patternEntiti
 {
     LC_LOG<<"RS_Hatch::"<<__func__<<": begin";
     RS_EntityContainer trimmed;
+
+    // the edges of the loops, intersected with each pattern entity
+    std::vector<RS_Entity*> edges;
+    for (RS_Entity* loop: entities) {
+        if (loop->isContainer()) {
+            for (RS_Entity* edge: *static_cast<RS_EntityContainer*>(loop))
+                edges.push_back(edge);
+        }
+    }
+    std::vector<std::pair<RS_Entity*, RS_Vector>> intersections;
+
     for(auto* e: patternEntities) {
 
         if (!e) {
-            RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Hatch::update: nullptr entity found");
+            RS_DEBUG_PRINT(RS_Debug::D_WARNING, "RS_Hatch::update: nullptr entity found");
             continue;
         }
 
@@ -443,22 +650,11 @@ RS_EntityContainer RS_Hatch::trimPattern(const RS_EntityContainer& patternEntiti
         // getting all intersections of this pattern line with the contour:
         QList<RS_Vector> is;
 
-        foreach(const auto& loop, entities){
-
-            if (loop->isContainer()) {
-                for(auto p: * static_cast<RS_EntityContainer*>(loop)){
-
-                    RS_VectorSolutions sol =
-                        RS_Information::getIntersection(e, p, true);
-
-                    for (const RS_Vector& vp: sol) {
-                        if (vp.valid) {
-                            is.append(vp);
-                            RS_DEBUG->print(RS_Debug::D_DEBUGGING, "  pattern line intersection: %f/%f", vp.x, vp.y);
-                        }
-                    }
-                }
-            }
+        intersections.clear();
+        RS_Information::getIntersections(e, edges, true, intersections);
+        for (const auto& [edge, vp]: intersections) {
+            is.append(vp);
+            RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "  pattern line intersection: %f/%f", vp.x, vp.y);
         }
 
         QList<RS_Vector> is2;       //to be filled with sorted intersections
@@ -547,42 +743,55 @@ RS_EntityContainer RS_Hatch::trimPattern(const RS_EntityContainer& patternEntiti
  * Activates of deactivates the hatch boundary.
  */
 void RS_Hatch::activateContour(bool on) {
-        RS_DEBUG->print("RS_Hatch::activateContour: %d", (int)on);
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::activateContour: %d", (int)on);
         foreach(auto* e, entities){
         if (!e->isUndone()) {
             if (!e->getFlag(RS2::FlagTemp)) {
-                                RS_DEBUG->print("RS_Hatch::activateContour: set visible");
+                                RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::activateContour: set visible");
                 e->setVisible(on);
             }
                         else {
-                                RS_DEBUG->print("RS_Hatch::activateContour: entity temp");
+                                RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::activateContour: entity temp");
                         }
         }
                 else {
-                        RS_DEBUG->print("RS_Hatch::activateContour: entity undone");
+                        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::activateContour: entity undone");
                 }
     }
-        RS_DEBUG->print("RS_Hatch::activateContour: OK");
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::activateContour: OK");
+}
+
+int RS_Hatch::getUpdateError() {
+    ensurePattern();
+    return updateError == HATCH_OK ? m_patternError : updateError;
 }
 
 /**
- * Overrides drawing of subentities. This is only ever called for solid fills.
+ * Assigns the layer of the hatch to the contours, if it changed.
  */
-void RS_Hatch::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternOffset*/) {
+void RS_Hatch::setContourLayer() {
+    RS_Layer* hatchLayer = getLayer();
+    for (RS_Entity* l: entities) {
+        if (l->getLayer(false) == hatchLayer)
+            continue;
+        l->setLayer(hatchLayer);
+        if (l->rtti()==RS2::EntityContainer) {
+            for(auto e: *static_cast<RS_EntityContainer*>(l))
+                e->setLayer(hatchLayer);
+        }
+    }
+}
 
+/**
+ * Creates patterns deferred by update(). Optimizes contours of solid fills, and creates
+ * their fill path.
+ */
+void RS_Hatch::prepareDraw() {
     if (!data.solid) {
-        foreach (auto se, entities){
-
-            view->drawEntity(painter,se);
-        }
+        ensurePattern();
         return;
     }
 
-    //area of solid fill. Use polygon approximation, except trivial cases
-    QPainterPath path;
-    QList<QPolygon> paClosed;
-    QPolygon pa;
-
     if (needOptimization==true) {
         foreach (auto l, entities){
 
@@ -593,111 +802,132 @@ void RS_Hatch::draw(RS_Painter* painter, RS_GraphicView* view, double& /*pattern
             }
         }
         needOptimization = false;
+        m_fillPath.reset();
     }
 
-    foreach (auto l, entities){
-        l->setLayer(getLayer());
-
-        if (l->rtti()==RS2::EntityContainer) {
-            RS_EntityContainer* loop = (RS_EntityContainer*)l;
-
-            // edges:
-            for(auto e: *loop){
-
-                e->setLayer(getLayer());
-                switch (e->rtti()) {
-                case RS2::EntityLine: {
-                    QPoint pt1(RS_Math::round(view->toGuiX(e->getStartpoint().x)),
-                               RS_Math::round(view->toGuiY(e->getStartpoint().y)));
-                    QPoint pt2(RS_Math::round(view->toGuiX(e->getEndpoint().x)),
-                               RS_Math::round(view->toGuiY(e->getEndpoint().y)));
-
-                    if(!pa.size() || (pa.last() - pt1).manhattanLength() >= 1) {
-                        pa << pt1;
-                    }
-                    pa << pt2;
-                }
-                    break;
-
-                case RS2::EntityArc: {
-                    QPolygon pa2;
-                    RS_Arc* arc=static_cast<RS_Arc*>(e);
-
-                    painter->createArc(pa2, view->toGui(arc->getCenter()),
-                                       view->toGuiDX(arc->getRadius())
-                                       ,arc->getAngle1(),arc->getAngle2(),arc->isReversed());
-                    if(pa.size() &&pa2.size()&&(pa.last()-pa2.first()).manhattanLength()<1)
-                        pa2.remove(0,1);
-                    pa<<pa2;
+    if (m_fillPath == nullptr)
+        m_fillPath = std::make_shared<const QPainterPath>(createFillPath());
+}
 
-                }
-                    break;
+/**
+ * The solid fill in graph coordinates. Edges are chained to contours, circles and
+ * full ellipses are contours, arcs are kept as curves.
+ */
+QPainterPath RS_Hatch::createFillPath() const {
+    QPainterPath path;
+    // the start of the contour of the last edge, if it's still open
+    RS_Vector contourStart{false};
+    auto addEdge = [&path, &contourStart](const QPainterPath& edge, const RS_Vector& start, const RS_Vector& end) {
+        if (contourStart.valid) {
+            path.connectPath(edge);
+        } else {
+            path.addPath(edge);
+            contourStart = start;
+        }
+        if (contourStart.distanceTo(end) < fillContourTolerance) {
+            path.closeSubpath();
+            contourStart = RS_Vector{false};
+        }
+    };
 
-                case RS2::EntityCircle: {
-                    RS_Circle* circle = static_cast<RS_Circle*>(e);
-                    RS_Vector c=view->toGui(circle->getCenter());
-                    double r=view->toGuiDX(circle->getRadius());
-                    path.addEllipse(QPoint(c.x,c.y),r,r);
-                }
-                    break;
-                case RS2::EntityEllipse:
-                if(static_cast<RS_Ellipse*>(e)->isArc()) {
-                    QPolygon pa2;
-                    auto ellipse=static_cast<RS_Ellipse*>(e);
-
-                    painter->createEllipse(pa2,
-                                           view->toGui(ellipse->getCenter()),
-                                           view->toGuiDX(ellipse->getMajorRadius()),
-                                           view->toGuiDX(ellipse->getMinorRadius()),
-                                           ellipse->getAngle()
-                                           ,ellipse->getAngle1(),ellipse->getAngle2(),ellipse->isReversed()
-                                           );
-
-                    if(pa.size() && pa2.size()&&(pa.last()-pa2.first()).manhattanLength()<1)
-                        pa2.remove(0,1);
-                    pa<<pa2;
-                }else{
-                    QPolygon pa2;
-                    auto ellipse=static_cast<RS_Ellipse*>(e);
-                    painter->createEllipse(pa2,
-                                           view->toGui(ellipse->getCenter()),
-                                           view->toGuiDX(ellipse->getMajorRadius()),
-                                           view->toGuiDX(ellipse->getMinorRadius()),
-                                           ellipse->getAngle(),
-                                           ellipse->getAngle1(), ellipse->getAngle2(),
-                                           ellipse->isReversed()
-                                           );
-                    path.addPolygon(pa2);
-                }
-                    break;
-                default:
+    for (const RS_Entity* l: entities) {
+        if (l->rtti()!=RS2::EntityContainer)
+            continue;
+        const RS_EntityContainer* loop = static_cast<const RS_EntityContainer*>(l);
+        for(auto e: *loop){
+            QPainterPath edge;
+            switch (e->rtti()) {
+            case RS2::EntityLine:
+                edge.moveTo(e->getStartpoint().x, e->getStartpoint().y);
+                edge.lineTo(e->getEndpoint().x, e->getEndpoint().y);
+                addEdge(edge, e->getStartpoint(), e->getEndpoint());
+                break;
+            case RS2::EntityArc: {
+                // the angles of QPainterPath are clockwise in graph coordinates
+                auto arc = static_cast<const RS_Arc*>(e);
+                const double radius = arc->getRadius();
+                const QRectF rect{arc->getCenter().x - radius, arc->getCenter().y - radius, 2. * radius, 2. * radius};
+                const double start = -RS_Math::rad2deg(arc->getAngle1());
+                const double sweep = RS_Math::rad2deg(arc->isReversed() ? arc->getAngleLength() : -arc->getAngleLength());
+                edge.arcMoveTo(rect, start);
+                edge.arcTo(rect, start, sweep);
+                addEdge(edge, arc->getStartpoint(), arc->getEndpoint());
+                break;
+            }
+            case RS2::EntityCircle: {
+                auto circle = static_cast<const RS_Circle*>(e);
+                path.addEllipse(QPointF{circle->getCenter().x, circle->getCenter().y},
+                                circle->getRadius(), circle->getRadius());
+                break;
+            }
+            case RS2::EntityEllipse: {
+                // the unit circle mapped to the ellipse
+                auto ellipse = static_cast<const RS_Ellipse*>(e);
+                const RS_Vector majorP = ellipse->getMajorP();
+                const RS_Vector minorP = RS_Vector{-majorP.y, majorP.x} * ellipse->getRatio();
+                const QTransform toEllipse{majorP.x, majorP.y, minorP.x, minorP.y,
+                            ellipse->getCenter().x, ellipse->getCenter().y};
+                if (!ellipse->isArc()) {
+                    edge.addEllipse(unitCircle);
+                    path.addPath(toEllipse.map(edge));
                     break;
                 }
+                const double start = -RS_Math::rad2deg(ellipse->getAngle1());
+                const double sweep = RS_Math::rad2deg(ellipse->isReversed() ? ellipse->getAngleLength() : -ellipse->getAngleLength());
+                edge.arcMoveTo(unitCircle, start);
+                edge.arcTo(unitCircle, start, sweep);
+                addEdge(toEllipse.map(edge), ellipse->getStartpoint(), ellipse->getEndpoint());
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        // loops are closed
+        if (contourStart.valid) {
+            path.closeSubpath();
+            contourStart = RS_Vector{false};
+        }
+    }
+    return path;
+}
 
-                if( pa.size()>2 && pa.first() == pa.last()) {
-                    paClosed<<pa;
-                    pa.clear();
-                }
+/**
+ * Overrides drawing of subentities. This is only ever called for solid fills.
+ */
+void RS_Hatch::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternOffset*/) {
 
-            }
+    if (!data.solid) {
+        // prepared on the GUI thread for concurrent drawing
+        if (!view->isConcurrentDrawing())
+            ensurePattern();
+        foreach (auto se, entities){
 
+            view->drawEntity(painter,se);
         }
-    }
-    if(pa.size()>2){
-        pa<<pa.first();
-        paClosed<<pa;
+        return;
     }
 
-    for(auto& p:paClosed){
-        path.addPolygon(p);
-    }
+    // prepared on the GUI thread for concurrent drawing
+    if (!view->isConcurrentDrawing())
+        prepareDraw();
+
+    // a hatch drawn concurrently before it's prepared isn't cached
+    const QPainterPath fillPath = m_fillPath != nullptr ? *m_fillPath : createFillPath();
+    // the graph to screen mapping of the view
+    const RS_Vector origin = view->toGui(RS_Vector{0., 0.});
+    const RS_Vector unitX = view->toGui(RS_Vector{1., 0.}) - origin;
+    const RS_Vector unitY = view->toGui(RS_Vector{0., 1.}) - origin;
+    const QTransform toGui{unitX.x, unitX.y, unitY.x, unitY.y, origin.x, origin.y};
 
     //bug#474, restore brush after solid fill
     const QBrush brush(painter->brush());
     const RS_Pen pen=painter->getPen();
     painter->setBrush(pen.getColor());
     painter->disablePen();
-    painter->drawPath(path);
+    painter->setScreenTransform(toGui);
+    painter->drawPath(fillPath);
+    painter->resetScreenTransform();
     painter->setBrush(brush);
     painter->setPen(pen);
 }
@@ -709,7 +939,7 @@ double RS_Hatch::getTotalArea() {
     try {
         getTotalAreaImpl();
     } catch(...) {
-        RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch:: %s() failure in find hatch area", __func__);
+        RS_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_Hatch:: %s() failure in find hatch area", __func__);
     }
 
     return m_area;
@@ -738,6 +968,16 @@ double RS_Hatch::getTotalAreaImpl() {
     return m_area;
 }
 
+/**
+ * @return the contour prepared for point inside tests, created on the first pick
+ * after an update
+ */
+const LC_PreparedContour& RS_Hatch::getPickContour() const {
+    if (m_pickContour == nullptr)
+        m_pickContour = std::make_shared<LC_PreparedContour>(*const_cast<RS_Hatch*>(this));
+    return *m_pickContour;
+}
+
 double RS_Hatch::getDistanceToPoint(
     const RS_Vector& coord,
     RS_Entity** entity,
@@ -750,9 +990,7 @@ double RS_Hatch::getDistanceToPoint(
         }
 
         bool onContour;
-        if (RS_Information::isPointInsideContour(
-                    coord,
-                     const_cast<RS_Hatch*>(this), &onContour)) {
+        if (getPickContour().isPointInside(coord, &onContour)) {
 
             // distance is the snap range:
             return solidDist;
@@ -760,6 +998,7 @@ double RS_Hatch::getDistanceToPoint(
 
         return RS_MAXDOUBLE;
     } else {
+        const_cast<RS_Hatch*>(this)->ensurePattern();
         return RS_EntityContainer::getDistanceToPoint(coord, entity,
                 level, solidDist);
     }
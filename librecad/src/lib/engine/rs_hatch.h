@@ -28,9 +28,15 @@
 #ifndef RS_HATCH_H
 #define RS_HATCH_H
 
+#include <cstddef>
+#include <memory>
+
 #include "rs_entity.h"
 #include "rs_entitycontainer.h"
 
+class LC_PreparedContour;
+class QPainterPath;
+
 /**
  * Holds the data that defines a hatch entity.
  */
@@ -102,6 +108,11 @@ public:
 
     int countLoops() const;
 
+    /** @return the entities generated for the hatch pattern, or nullptr */
+    const RS_EntityContainer* getPatternEntities() const {
+        return hatch;
+    }
+
     /** @return true if this is a solid fill. false if it is a pattern hatch. */
     bool isSolid() const {
             return data.solid;
@@ -134,11 +145,17 @@ public:
 
     void calculateBorders() override;
     void update() override;
-    int getUpdateError() {
-            return updateError;
-    }
+    /** @return the error of the last update, creates the pattern if it's not created yet */
+    int getUpdateError();
     void activateContour(bool on);
 
+    void prepareDraw() override;
+    /**
+     * @brief ensurePatterns creates the patterns deferred by update() of the hatches,
+     * concurrently for many hatches. The patterns are requested by the calling
+     * thread; hatches of patterns not found are left to prepareDraw()
+     */
+    static void ensurePatterns(const std::vector<RS_Hatch*>& hatches);
     void draw(RS_Painter* painter, RS_GraphicView* view,
                       double& patternOffset) override;
 
@@ -162,9 +179,24 @@ public:
 private:
     double getTotalAreaImpl();
     RS_EntityContainer trimPattern(const RS_EntityContainer& patternEntities) const;
+    void ensurePattern();
+    void regeneratePattern();
+    std::size_t patternKey() const;
+    const LC_PreparedContour& getPickContour() const;
+    QPainterPath createFillPath() const;
+    void setContourLayer();
     RS_HatchData data;
     RS_EntityContainer* hatch = nullptr;
+    //! patternKey() of the current pattern
+    std::size_t m_patternKey = 0;
+    //! pattern creation is deferred to the first draw
+    bool m_patternPending = false;
+    int m_patternError = HATCH_OK;
     double m_area = RS_MAXDOUBLE;
+    //! the contour prepared for picking solid hatches, until the hatch is updated
+    mutable std::shared_ptr<LC_PreparedContour> m_pickContour;
+    //! the solid fill in graph coordinates, until the hatch is updated
+    std::shared_ptr<const QPainterPath> m_fillPath;
     int  updateError = 0;
     bool updateRunning = false;
     bool needOptimization = false;
@@ -24,10 +24,16 @@
 **
 **********************************************************************/
 #include<iostream>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include <QDir>
 #include <QFileInfo>
 #include <QImage>
 
+#include "lc_imagepyramid.h"
+#include "lc_rect.h"
 #include "rs_debug.h"
 #include "rs_document.h"
 #include "rs_graphicview.h"
@@ -61,6 +67,47 @@ QString imageRelativePathName(QString& imageFile)
     // search the current folder of the dxf for the dxf file name
     return dxfFileInfo.canonicalPath() + "/" + fileInfo.fileName();
 }
+
+/**
+ * @return the indices of the tiles of the level in the view
+ */
+std::vector<int> getVisibleTiles(const LC_ImagePyramid& pyramid, int level,
+                                 const RS_ImageData& data, const RS_GraphicView& view)
+{
+    const RS_Vector& u = data.uVector;
+    const RS_Vector& v = data.vVector;
+    const double det = u.x * v.y - u.y * v.x;
+    if (std::abs(det) < RS_TOLERANCE2)
+        return {};
+
+    // the view corners in level pixels, counted from the top left
+    const RS_Vector& size = data.size;
+    const QSize levelSize = pyramid.getLevelSize(level);
+    const LC_Rect& rect = view.getViewRect();
+    double minX = RS_MAXDOUBLE, minY = RS_MAXDOUBLE, maxX = -RS_MAXDOUBLE, maxY = -RS_MAXDOUBLE;
+    for (const RS_Vector& corner: {rect.minP(), rect.maxP(), rect.upperLeftCorner(), rect.lowerRightCorner()}) {
+        const RS_Vector d = corner - data.insertionPoint;
+        const double x = (d.x * v.y - d.y * v.x) / det * levelSize.width() / size.x;
+        const double y = (size.y - (u.x * d.y - u.y * d.x) / det) * levelSize.height() / size.y;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+
+    const int tileSize = LC_ImagePyramid::tileSize;
+    const int columns = (levelSize.width() + tileSize - 1) / tileSize;
+    const int rows = (levelSize.height() + tileSize - 1) / tileSize;
+    const int column1 = std::max(0, int(std::floor(minX / tileSize)));
+    const int column2 = std::min(columns - 1, int(std::floor(maxX / tileSize)));
+    const int row1 = std::max(0, int(std::floor(minY / tileSize)));
+    const int row2 = std::min(rows - 1, int(std::floor(maxY / tileSize)));
+    std::vector<int> tiles;
+    for (int row = row1; row <= row2; ++row)
+        for (int column = column1; column <= column2; ++column)
+            tiles.push_back(row * columns + column);
+    return tiles;
+}
 }
 
 RS_ImageData::RS_ImageData(int _handle,
@@ -126,50 +173,23 @@ void RS_Image::update() {
     // the whole image:
     QString filePathName = imageRelativePathName(data.file);
 
-    //QImage image = QImage(data.file);
-    img = std::make_shared<QImage>(filePathName);
-	if (!img->isNull()) {
-		data.size = RS_Vector(img->width(), img->height());
+    img = LC_ImagePyramid::request(filePathName);
+	if (img->isReady()) {
+		data.size = RS_Vector(img->getSize().width(), img->getSize().height());
 		calculateBorders(); // image update need this.
     } else {
         LC_LOG(RS_Debug::D_ERROR)<<"RS_Image::"<<__func__<<"(): image file not found: "<<data.file<<"("<<filePathName<<")";
     }
 
     RS_DEBUG->print("RS_Image::update: OK");
+}
 
-    /*
-    // number of small images:
-    nx = image.width()/100;
-    ny = image.height()/100;
-
-    // create small images:
-    img = new QImage*[nx];
-    QPixmap pm;
-    int w,h;
-    for (int x = 0; x<nx; ++x) {
-        img[x] = new QImage[ny];
-        for (int y = 0; y<ny; ++y) {
-                if (x<nx-1) {
-                        w = 100;
-                }
-                else {
-                        w = image.width()%100;
-                }
-
-                if (y<ny-1) {
-                        h = 100;
-                }
-                else {
-                        h = image.height()%100;
-                }
-
-                pm = QPixmap(w, h);
-                RS_PainterQt painter(&pm);
-                painter.drawImage(-x*100, -y*100, image);
-                img[x][y] = pm.convertToImage();
-        }
+void RS_Image::updateInBackground() {
+    img = LC_ImagePyramid::requestInBackground(imageRelativePathName(data.file));
+    if (img->isReady()) {
+        data.size = RS_Vector(img->getSize().width(), img->getSize().height());
+        calculateBorders();
     }
-    */
 }
 
 
@@ -380,29 +400,77 @@ void RS_Image::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
 
 
 void RS_Image::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternOffset*/) {
-	if (!(painter && view) || !img.get() || img->isNull())
+	if (!(painter && view) || img == nullptr)
 		return;
 
-    // erase image:
-    //if (painter->getPen().getColor()==view->getBackground()) {
-    //	RS_VectorSolutions sol = getCorners();
-    //
-    //}
-
-	RS_Vector scale{view->toGuiDX(data.uVector.magnitude()),
-								view->toGuiDY(data.vVector.magnitude())};
-
-    painter->drawImg(*img,
-                     view->toGui(data.insertionPoint),
-                     data.uVector, data.vVector, scale);
-
-    if (isSelected() && !(view->isPrinting() || view->isPrintPreview())) {
+    const auto drawFrame = [&]() {
         RS_VectorSolutions sol = getCorners();
 		for (size_t i = 0; i < sol.size(); ++i){
 			size_t const j = (i+1)%sol.size();
 			painter->drawLine(view->toGui(sol.get(i)), view->toGui(sol.get(j)));
 		}
+    };
+    const bool printing = view->isPrinting() || view->isPrintPreview();
+
+    // views not shown, like exports, printing and rendering workers, wait for the decoded tiles
+    const bool wait = !view->isVisible();
+    if (wait)
+        img->waitReady();
+    // the frame is shown while the file is read, or if it is not an image
+    if (!img->isReady() || data.size.x < 1. || data.size.y < 1.) {
+        if (!printing)
+            drawFrame();
+        return;
     }
+
+	RS_Vector scale{view->toGuiDX(data.uVector.magnitude()),
+								view->toGuiDY(data.vVector.magnitude())};
+
+    const int tileSize = LC_ImagePyramid::tileSize;
+    // the image is fit into the image data size, which differs from the file, if it
+    // was modified after the drawing was saved
+    const RS_Vector& size = data.size;
+
+    // draws a tile of the level at its place in the image
+    const auto drawTile = [&](int level, int index, QImage& tile) {
+        const QSize levelSize = img->getLevelSize(level);
+        const int columns = (levelSize.width() + tileSize - 1) / tileSize;
+        const double fx = size.x / levelSize.width();
+        const double fy = size.y / levelSize.height();
+        // the bottom left corner of the tile, in image pixels
+        const double x = (index % columns) * tileSize * fx;
+        const double y = size.y - ((index / columns) * tileSize + tile.height()) * fy;
+        painter->drawImg(tile,
+                         view->toGui(data.insertionPoint + data.uVector * x + data.vVector * y),
+                         data.uVector, data.vVector, {scale.x * fx, scale.y * fy});
+    };
+
+    // the level with about one screen pixel per level pixel
+    const int level = img->getLevelFor(std::min(scale.x, scale.y));
+    const int columns = (img->getLevelSize(level).width() + tileSize - 1) / tileSize;
+    const std::vector<int> indices = getVisibleTiles(*img, level, data, *view);
+    std::vector<QImage> tiles;
+    tiles.reserve(indices.size());
+    bool complete = true;
+    for (int index: indices) {
+        tiles.push_back(img->getTile(level, index % columns, index / columns, wait));
+        complete = complete && !tiles.back().isNull();
+    }
+
+    // the coarsest level is shown while the tiles are decoded
+    const int coarsest = img->countLevels() - 1;
+    if (!complete && level != coarsest) {
+        QImage tile = img->getTile(coarsest, 0, 0, false);
+        if (!tile.isNull())
+            drawTile(coarsest, 0, tile);
+    }
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        if (!tiles[i].isNull())
+            drawTile(level, indices[i], tiles[i]);
+    }
+
+    if (isSelected() && !printing)
+        drawFrame();
 }
 
 
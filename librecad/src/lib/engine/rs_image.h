@@ -29,7 +29,7 @@
 #include <memory>
 #include "rs_atomicentity.h"
 
-class QImage;
+class LC_ImagePyramid;
 
 /**
  * Holds the data that defines a line.
@@ -90,12 +90,23 @@ public:
     }
 
 		void update() override;
+    /**
+     * @brief updateInBackground like update(), but the image file is read by a worker
+     * thread, so opening a drawing doesn't wait for the image files. The size of the
+     * image data is kept, unless the file was read before
+     */
+    void updateInBackground();
 
     /** @return Copy of data that defines the image. */
     RS_ImageData getData() const {
         return data;
     }
 
+    /** @return the decoded image, shared by the images of the file, or nullptr */
+    const LC_ImagePyramid* getPyramid() const {
+        return img.get();
+    }
+
     /** @return Insertion point of the entity */
 	RS_Vector getInsertionPoint() const {
         return data.insertionPoint;
@@ -220,10 +231,8 @@ protected:
 	// whether the point is within image
 	bool containsPoint(const RS_Vector& coord) const;
 	RS_ImageData data;
-    std::shared_ptr<QImage> img;
-        //QImage** img;
-        //int nx;
-        //int ny;
+    //! resolution levels of the image file, decoded on demand
+    std::shared_ptr<LC_ImagePyramid> img;
 };
 
 #endif
@@ -27,14 +27,26 @@
 #include "rs_insert.h"
 
 #include<cmath>
+#include<algorithm>
+#include<functional>
 #include<iostream>
+#include<memory>
+#include<mutex>
+#include<unordered_map>
+#include<unordered_set>
 
+#include <QTransform>
+
+#include "lc_regenstatistics.h"
+#include "lc_taskscheduler.h"
+#include "lc_trace.h"
 #include "rs_arc.h"
 #include "rs_block.h"
 #include "rs_circle.h"
 #include "rs_debug.h"
 #include "rs_ellipse.h"
 #include "rs_graphic.h"
+#include "rs_graphicview.h"
 #include "rs_layer.h"
 #include "rs_math.h"
 
@@ -43,6 +55,31 @@ namespace {
 // Minimum scaling factor allowed
 constexpr double MIN_Scale_Factor = 1.0e-6;
 
+// serializes creating instances while drawing concurrently
+std::mutex instanceMutex;
+
+// whether the block entity is drawn by mapping its points only, through the screen
+// transform of the instance; other entities map sizes or clip by the view, and are
+// drawn as instances
+bool drawsTransformed(const RS_Entity& e, const RS_Layer* layer)
+{
+    switch (e.rtti()) {
+    case RS2::EntityLine:
+        // construction lines are clipped by the view
+        return layer == nullptr || !layer->isConstruction();
+    case RS2::EntityCircle:
+    case RS2::EntitySolid:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// from this number of inserts on, inserts are updated concurrently
+constexpr std::size_t parallelUpdateMinimum = 64;
+// least inserts of a task of the concurrent updates
+constexpr std::size_t parallelUpdateGrain = 16;
+
 // update the entity pen according to the blockPen
 RS_Pen updatePen(RS_Pen&& pen, const RS_Pen& blockPen)
 {
@@ -119,6 +156,16 @@ RS_Entity* RS_Insert::clone() const{
  * needs to be called whenever the block this insert is based on changes.
  */
 void RS_Insert::update() {
+    updateEntities(nullptr);
+}
+
+void RS_Insert::update(UpdatePass& pass) {
+    updateEntities(&pass);
+}
+
+void RS_Insert::updateEntities(UpdatePass* pass) {
+    LC_TRACE_ZONE("RS_Insert::update");
+    const LC_RegenStatistics::Regen regen{LC_RegenStatistics::Insert};
 
         RS_DEBUG->print("RS_Insert::update");
         RS_DEBUG->print("RS_Insert::update: name: %s", data.name.toLatin1().data());
@@ -130,8 +177,9 @@ void RS_Insert::update() {
         }
 
     clear();
+    m_instanced = false;
 
-    RS_Block* blk = getBlockForInsert();
+    const std::shared_ptr<const RS_Block> blk = getBlockContent();
     if (blk == nullptr) {
         RS_DEBUG->print("RS_Insert::update: Block is nullptr");
         return;
@@ -151,105 +199,438 @@ void RS_Insert::update() {
                     data.cols, data.rows);
     RS_DEBUG->print("RS_Insert::update: block has %d entities",
                     blk->count());
+
+    // within an update pass, nested inserts of a block are updated once; the blocks
+    // of concurrent updates are marked before, so workers don't write the pass
+    const bool updateNested = data.updateMode != RS2::PreviewUpdate
+            && (pass == nullptr
+                || (pass->updatedBlocks.count(blk.get()) == 0 && pass->updatedBlocks.insert(blk.get()).second));
+    if (updateNested) {
         for(auto* e: *blk){
-            for (int c=0; c<data.cols; ++c) {
-//            RS_DEBUG->print("RS_Insert::update: col %d", c);
-                for (int r=0; r<data.rows; ++r) {
-//                i_en_counts++;
-//                RS_DEBUG->print("RS_Insert::update: row %d", r);
+            if (e->rtti()==RS2::EntityInsert) {
+//                RS_DEBUG->print("RS_Insert::update: updating sub-insert");
+                static_cast<RS_Insert*>(e)->updateEntities(pass);
+            }
+        }
+    }
 
-                    if (e->rtti()==RS2::EntityInsert &&
-                            data.updateMode!=RS2::PreviewUpdate) {
+    if (canInstance()) {
+        m_instanced = true;
+        calculateBorders();
+        RS_DEBUG->print("RS_Insert::update: instanced: OK");
+        return;
+    }
 
-//                                        RS_DEBUG->print("RS_Insert::update: updating sub-insert");
-                        e->update();
-                }
+    for(auto* e: *blk){
+        for (int c=0; c<data.cols; ++c) {
+            for (int r=0; r<data.rows; ++r) {
+//                RS_DEBUG->print("RS_Insert::update: adding new entity");
+                appendEntity(createInstance(*blk, *e, c, r));
+            }
+        }
+    }
+    calculateBorders();
+
+    RS_DEBUG->print("RS_Insert::update: OK");
+}
+
+void RS_Insert::updateAll(const std::vector<RS_Insert*>& inserts, UpdatePass& pass)
+{
+    if (inserts.size() < parallelUpdateMinimum) {
+        for (RS_Insert* insert: inserts)
+            insert->update(pass);
+        return;
+    }
+
+    // the level of a block is one more than the levels of the blocks of its nested
+    // inserts, or zero without nested inserts; the nested inserts of a block are
+    // updated with the blocks of its level, after the lower levels
+    std::unordered_map<const RS_Block*, int> levels;
+    std::vector<std::vector<RS_Insert*>> nested;
+    std::function<int(const RS_Insert&)> levelOf = [&](const RS_Insert& insert) {
+        const std::shared_ptr<const RS_Block> blk = insert.getBlockContent();
+        if (blk == nullptr || insert.data.updateMode == RS2::PreviewUpdate
+                || pass.updatedBlocks.count(blk.get()) != 0)
+            return 0;
+        auto it = levels.find(blk.get());
+        if (it != levels.end())
+            return it->second;
+        // a block inserting itself, directly or not, is not updated again
+        levels.emplace(blk.get(), 0);
+        int level = 0;
+        std::vector<RS_Insert*> own;
+        for (RS_Entity* e: *blk) {
+            if (e->rtti() == RS2::EntityInsert) {
+                auto* sub = static_cast<RS_Insert*>(e);
+                own.push_back(sub);
+                level = std::max(level, levelOf(*sub) + 1);
+            }
+        }
+        levels[blk.get()] = level;
+        if (level > 0) {
+            if (nested.size() < std::size_t(level))
+                nested.resize(level);
+            nested[level - 1].insert(nested[level - 1].end(), own.begin(), own.end());
+        }
+        return level;
+    };
+    for (RS_Insert* insert: inserts)
+        levelOf(*insert);
+    for (const auto& level: levels)
+        pass.updatedBlocks.insert(level.first);
+
+    RS_DEBUG->print("RS_Insert::updateAll: %zu inserts, %zu blocks in %zu levels",
+                    inserts.size(), levels.size(), nested.size());
+    auto updateRange = [&pass](const std::vector<RS_Insert*>& range) {
+        LC_TaskScheduler::instance().parallelFor(0, range.size(), parallelUpdateGrain,
+                                                 [&range, &pass](std::size_t begin, std::size_t end) {
+            // the reasons of the calling thread are not known to workers
+            LC_REGEN_REASON("update inserts");
+            for (std::size_t i = begin; i < end; ++i)
+                range[i]->update(pass);
+        });
+    };
+    for (const auto& level: nested)
+        updateRange(level);
+    updateRange(inserts);
+}
+
+bool RS_Insert::canInstance() const
+{
+    return data.updateMode != RS2::PreviewUpdate;
+}
+
+RS_Entity* RS_Insert::createInstance(const RS_Block& blk, const RS_Entity& e, int c, int r) const
+{
+    RS_Entity* ne = nullptr;
+    if ( (data.scaleFactor.x - data.scaleFactor.y)>MIN_Scale_Factor) {
+        if (e.rtti()== RS2::EntityArc) {
+            const RS_Arc& a = static_cast<const RS_Arc&>(e);
+            ne = new RS_Ellipse{const_cast<RS_Insert*>(this),
+            {a.getCenter(), {a.getRadius(), 0.},
+                    1, a.getAngle1(), a.getAngle2(),
+                    a.isReversed()}};
+            ne->setLayer(e.getLayer());
+            ne->setPen(e.getPen(false));
+        } else if (e.rtti()== RS2::EntityCircle) {
+            const RS_Circle& a = static_cast<const RS_Circle&>(e);
+            ne = new RS_Ellipse{const_cast<RS_Insert*>(this),
+            { a.getCenter(), {a.getRadius(), 0.}, 1, 0., 2.*M_PI, false}};
+            ne->setLayer(e.getLayer());
+            ne->setPen(e.getPen(false));
+        } else {
+            ne = e.clone();
+        }
+    } else {
+        ne = e.clone();
+    }
+    ne->initId();
+    ne->setUpdateEnabled(false);
+    // if entity layer are 0 set to insert layer to allow "1 layer control" bug ID #3602152
+    RS_Layer *l= ne->getLayer();//special fontchar block don't have
+    if (l != nullptr  && ne->getLayer()->getName() == "0")
+        ne->setLayer(getLayer());
+    ne->setParent(const_cast<RS_Insert*>(this));
+    ne->setVisible(getFlag(RS2::FlagVisible));
+
+    // Move:
+    if (std::abs(data.scaleFactor.x)>MIN_Scale_Factor &&
+            std::abs(data.scaleFactor.y)>MIN_Scale_Factor) {
+        ne->move(data.insertionPoint +
+                 RS_Vector(data.spacing.x/data.scaleFactor.x*c,
+                           data.spacing.y/data.scaleFactor.y*r));
+    }
+    else {
+        ne->move(data.insertionPoint);
+    }
+    // Move because of block base point:
+    ne->move(blk.getBasePoint()*(-1));
+    // Scale:
+    ne->scale(data.insertionPoint, data.scaleFactor);
+    // Rotate:
+    ne->rotate(data.insertionPoint, data.angle);
+
+    // Select:
+    ne->setSelected(isSelected());
+
+    // individual entities can be on indiv. layers
+    RS_Pen tmpPen = updatePen(ne->getPen(false), getPen());
+    // now that we've evaluated all flags, let's strip them:
+    // TODO: strip all flags (width, line type)
+    //tmpPen.setColor(tmpPen.getColor().stripFlags());
+    ne->setPen(tmpPen);
+
+    ne->setUpdateEnabled(true);
+
+    // insert must be updated even in preview mode
+    if (data.updateMode != RS2::PreviewUpdate
+            || ne->rtti() == RS2::EntityInsert) {
+        ne->update();
+    }
+    return ne;
+}
 
-//                                RS_DEBUG->print("RS_Insert::update: cloning entity");
-
-                    RS_Entity* ne = nullptr;
-                    if ( (data.scaleFactor.x - data.scaleFactor.y)>MIN_Scale_Factor) {
-                        if (e->rtti()== RS2::EntityArc) {
-                            RS_Arc* a= static_cast<RS_Arc*>(e);
-                            ne = new RS_Ellipse{this,
-                            {a->getCenter(), {a->getRadius(), 0.},
-                                    1, a->getAngle1(), a->getAngle2(),
-                                    a->isReversed()}};
-                            ne->setLayer(e->getLayer());
-                            ne->setPen(e->getPen(false));
-                        } else if (e->rtti()== RS2::EntityCircle) {
-                            RS_Circle* a= static_cast<RS_Circle*>(e);
-                            ne = new RS_Ellipse{this,
-                            { a->getCenter(), {a->getRadius(), 0.}, 1, 0., 2.*M_PI, false}};
-                            ne->setLayer(e->getLayer());
-                            ne->setPen(e->getPen(false));
-                        } else {
-                            ne = e->clone();
+RS_Layer* RS_Insert::getInstanceLayer(const RS_Entity& e) const
+{
+    // as createInstance(), entities on the layer 0 are on the layer of the insert
+    RS_Layer* layer = e.getLayer(false);
+    if (layer == nullptr || layer->getName() == "0")
+        return getLayer();
+    return layer;
+}
+
+RS_Pen RS_Insert::getInstancePen(const RS_Entity& e, const RS_Layer* layer) const
+{
+    // as RS_Entity::getPen(true) of the instance, a child of this insert
+    RS_Pen pen = updatePen(e.getPen(false), getPen(false));
+    if (!pen.isValid())
+        pen = getPen();
+    const RS_Pen blockPen = getPen();
+    if (pen.getColor().isByBlock())
+        pen.setColor(blockPen.getColor());
+    if (pen.getWidth() == RS2::WidthByBlock)
+        pen.setWidth(blockPen.getWidth());
+    if (pen.getLineType() == RS2::LineByBlock)
+        pen.setLineType(blockPen.getLineType());
+
+    if (layer != nullptr) {
+        const RS_Pen layerPen = layer->getPen();
+        if (pen.getColor().isByLayer())
+            pen.setColor(layerPen.getColor());
+        if (pen.getWidth() == RS2::WidthByLayer)
+            pen.setWidth(layerPen.getWidth());
+        if (pen.getLineType() == RS2::LineByLayer)
+            pen.setLineType(layerPen.getLineType());
+    }
+    return pen;
+}
+
+RS_Vector RS_Insert::toInsert(const RS_Block& blk, const RS_Vector& v, int c, int r) const
+{
+    RS_Vector ret = v - blk.getBasePoint();
+    ret.x *= data.scaleFactor.x;
+    ret.y *= data.scaleFactor.y;
+    ret += RS_Vector{data.spacing.x*c, data.spacing.y*r};
+    ret.rotate(data.angle);
+    return data.insertionPoint + ret;
+}
+
+QTransform RS_Insert::instanceTransform(const RS_Block& blk, int c, int r) const
+{
+    // the last transform applies first
+    QTransform transform;
+    transform.translate(data.insertionPoint.x, data.insertionPoint.y);
+    transform.rotateRadians(data.angle);
+    transform.translate(data.spacing.x*c, data.spacing.y*r);
+    transform.scale(data.scaleFactor.x, data.scaleFactor.y);
+    transform.translate(- blk.getBasePoint().x, - blk.getBasePoint().y);
+    return transform;
+}
+
+LC_Rect RS_Insert::instanceBox(const RS_Block& blk, const RS_Vector& minV, const RS_Vector& maxV,
+                               int c, int r) const
+{
+    // exact for unrotated inserts, otherwise the box of the transformed corners
+    LC_Rect box{toInsert(blk, minV, c, r), toInsert(blk, maxV, c, r)};
+    if (std::abs(std::remainder(data.angle, M_PI_2)) > RS_TOLERANCE_ANGLE) {
+        box = box.merge(LC_Rect{toInsert(blk, {minV.x, maxV.y}, c, r),
+                                toInsert(blk, {maxV.x, minV.y}, c, r)});
+    }
+    return box;
+}
+
+void RS_Insert::calculateBorders()
+{
+    if (!m_instanced) {
+        RS_EntityContainer::calculateBorders();
+        return;
+    }
+
+    resetBorders();
+    const std::shared_ptr<const RS_Block> blk = getBlockContent();
+    if (blk == nullptr || blk->isEmpty() || !blk->getMin().valid || !blk->getMax().valid)
+        return;
+
+    // letters of texts come from a block source, the box of the rotated letter box
+    // is close enough for them
+    if (data.blockSource == nullptr
+            && std::abs(std::remainder(data.angle, M_PI_2)) > RS_TOLERANCE_ANGLE) {
+        // the box of a rotated block box is too large, transform the entities. Lines,
+        // points and circles are transformed directly, other entities as instances.
+        const bool uniform = std::abs(std::abs(data.scaleFactor.x) - std::abs(data.scaleFactor.y)) <= RS_TOLERANCE;
+        for(auto* e: *blk) {
+            RS_Layer* layer = e->getLayer();
+            if (layer != nullptr && layer->getName() == "0")
+                layer = getLayer();
+            const bool visible = getFlag(RS2::FlagVisible) && !e->isUndone()
+                    && !(layer && layer->isFrozen());
+            for (int c=0; c<data.cols; ++c) {
+                for (int r=0; r<data.rows; ++r) {
+                    switch (e->rtti()) {
+                    case RS2::EntityLine:
+                    case RS2::EntityPoint:
+                        if (visible) {
+                            const RS_Vector start = toInsert(*blk, e->getStartpoint(), c, r);
+                            const RS_Vector end = toInsert(*blk, e->getEndpoint(), c, r);
+                            minV = RS_Vector::minimum(minV, RS_Vector::minimum(start, end));
+                            maxV = RS_Vector::maximum(maxV, RS_Vector::maximum(start, end));
                         }
-                    } else {
-                        ne = e->clone();
-                    }
-                    ne->initId();
-                    ne->setUpdateEnabled(false);
-                // if entity layer are 0 set to insert layer to allow "1 layer control" bug ID #3602152
-                    RS_Layer *l= ne->getLayer();//special fontchar block don't have
-                    if (l != nullptr  && ne->getLayer()->getName() == "0")
-                    ne->setLayer(getLayer());
-                    ne->setParent(this);
-                    ne->setVisible(getFlag(RS2::FlagVisible));
-
-//                                RS_DEBUG->print("RS_Insert::update: transforming entity");
-
-                // Move:
-//                                RS_DEBUG->print("RS_Insert::update: move 1");
-                    if (std::abs(data.scaleFactor.x)>MIN_Scale_Factor &&
-                            std::abs(data.scaleFactor.y)>MIN_Scale_Factor) {
-                        ne->move(data.insertionPoint +
-                                 RS_Vector(data.spacing.x/data.scaleFactor.x*c,
-                                           data.spacing.y/data.scaleFactor.y*r));
-                    }
-                    else {
-                        ne->move(data.insertionPoint);
+                        continue;
+                    case RS2::EntityCircle:
+                        if (uniform) {
+                            if (visible) {
+                                const RS_Vector center = toInsert(*blk, e->getCenter(), c, r);
+                                const double radius = e->getRadius() * std::abs(data.scaleFactor.x);
+                                minV = RS_Vector::minimum(minV, center - RS_Vector{radius, radius});
+                                maxV = RS_Vector::maximum(maxV, center + RS_Vector{radius, radius});
+                            }
+                            continue;
+                        }
+                        break;
+                    default:
+                        break;
                     }
-                // Move because of block base point:
-//                                RS_DEBUG->print("RS_Insert::update: move 2");
-                    ne->move(blk->getBasePoint()*(-1));
-                // Scale:
-//                                RS_DEBUG->print("RS_Insert::update: scale");
-                    ne->scale(data.insertionPoint, data.scaleFactor);
-                // Rotate:
-//                                RS_DEBUG->print("RS_Insert::update: rotate");
-                    ne->rotate(data.insertionPoint, data.angle);
-
-                   // RS_DEBUG->print(RS_Debug::D_ERROR, "ne: angle: %lg\n", data.angle);
-                // Select:
-                    ne->setSelected(isSelected());
-
-                // individual entities can be on indiv. layers
-                    RS_Pen tmpPen = updatePen(ne->getPen(false), getPen());
-                // now that we've evaluated all flags, let's strip them:
-                // TODO: strip all flags (width, line type)
-                //tmpPen.setColor(tmpPen.getColor().stripFlags());
-                    ne->setPen(tmpPen);
-
-                    ne->setUpdateEnabled(true);
-
-                // insert must be updated even in preview mode
-                    if (data.updateMode != RS2::PreviewUpdate
-                            || ne->rtti() == RS2::EntityInsert) {
-                        //RS_DEBUG->print("RS_Insert::update: updating new entity");
-                        ne->update();
+                    std::unique_ptr<RS_Entity> ne{createInstance(*blk, *e, c, r)};
+                    RS_Layer* instanceLayer = ne->getLayer();
+                    if (ne->isVisible() && !(instanceLayer && instanceLayer->isFrozen())) {
+                        ne->calculateBorders();
+                        adjustBorders(ne.get());
                     }
-
-//                                RS_DEBUG->print("RS_Insert::update: adding new entity");
-                    appendEntity(ne);
-//                std::cout<<"done # of entity: "<<i_en_counts<<std::endl;
                 }
             }
         }
+        return;
+    }
+
+    for (int c=0; c<data.cols; ++c) {
+        for (int r=0; r<data.rows; ++r) {
+            const LC_Rect box = instanceBox(*blk, blk->getMin(), blk->getMax(), c, r);
+            minV = RS_Vector::minimum(minV, box.minP());
+            maxV = RS_Vector::maximum(maxV, box.maxP());
+        }
+    }
+}
+
+void RS_Insert::forcedCalculateBorders()
+{
+    if (m_instanced)
         calculateBorders();
+    else
+        RS_EntityContainer::forcedCalculateBorders();
+}
+
+unsigned RS_Insert::count() const
+{
+    if (!m_instanced)
+        return RS_EntityContainer::count();
+    const std::shared_ptr<const RS_Block> blk = getBlockContent();
+    return (blk != nullptr) ? blk->count() * data.cols * data.rows : 0;
+}
+
+unsigned RS_Insert::countDeep() const
+{
+    if (!m_instanced)
+        return RS_EntityContainer::countDeep();
+    const std::shared_ptr<const RS_Block> blk = getBlockContent();
+    return (blk != nullptr) ? blk->countDeep() * data.cols * data.rows : 0;
+}
 
-        RS_DEBUG->print("RS_Insert::update: OK");
+void RS_Insert::materializeEntities() const
+{
+    if (!m_instanced)
+        return;
+    m_instanced = false;
+
+    const std::shared_ptr<const RS_Block> blk = getBlockContent();
+    if (blk == nullptr)
+        return;
+
+    RS_DEBUG->print("RS_Insert::materializeEntities: name: %s", data.name.toLatin1().data());
+    auto* self = const_cast<RS_Insert*>(this);
+    // keep the borders, they are the same
+    const RS_Vector minBorder = minV;
+    const RS_Vector maxBorder = maxV;
+    self->setAutoUpdateBorders(false);
+    for(auto* e: *blk){
+        for (int c=0; c<data.cols; ++c) {
+            for (int r=0; r<data.rows; ++r) {
+                self->appendEntity(createInstance(*blk, *e, c, r));
+            }
+        }
+    }
+    self->setAutoUpdateBorders(true);
+    self->minV = minBorder;
+    self->maxV = maxBorder;
+}
+
+void RS_Insert::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset)
+{
+    if (!m_instanced) {
+        RS_EntityContainer::draw(painter, view, patternOffset);
+        return;
+    }
+    if (painter == nullptr || view == nullptr)
+        return;
+    const std::shared_ptr<const RS_Block> blk = getBlockContent();
+    if (blk == nullptr)
+        return;
+
+    const LC_Rect viewRect{view->toGraph(0, 0),
+                view->toGraph(view->getWidth(), view->getHeight())};
+    // construction lines are drawn as infinite lines, borders can't be used
+    const bool cull = !view->isPrinting();
+    // the graph to screen mapping of the view
+    const RS_Vector origin = view->toGui(RS_Vector{0., 0.});
+    const RS_Vector unitX = view->toGui(RS_Vector{1., 0.}) - origin;
+    const RS_Vector unitY = view->toGui(RS_Vector{0., 1.}) - origin;
+    const QTransform toGui{unitX.x, unitX.y, unitY.x, unitY.y, origin.x, origin.y};
+    const QTransform toGraph = toGui.inverted();
+    const bool visible = getFlag(RS2::FlagVisible);
+    // const, the entity list must not detach while drawing concurrently
+    const RS_Block& blockEntities = *blk;
+    for (int c=0; c<data.cols; ++c) {
+        for (int r=0; r<data.rows; ++r) {
+            // the shared block entities are drawn through the transform, in block order
+            bool transformed = false;
+            for(auto* e: blockEntities){
+                const bool construction = e->isConstruction(false);
+                if (cull && !construction && e->getMin().valid && e->getMax().valid
+                        && !instanceBox(*blk, e->getMin(), e->getMax(), c, r).intersects(viewRect))
+                    continue;
+
+                RS_Layer* layer = getInstanceLayer(*e);
+                if (drawsTransformed(*e, layer)) {
+                    if (!visible || e->isUndone() || (layer != nullptr && layer->isFrozen()))
+                        continue;
+                    if (!transformed) {
+                        painter->setScreenTransform(toGraph * instanceTransform(*blk, c, r) * toGui);
+                        transformed = true;
+                    }
+                    view->drawInstanced(painter, e, *this, layer, patternOffset);
+                    continue;
+                }
+                if (transformed) {
+                    painter->resetScreenTransform();
+                    transformed = false;
+                }
+
+                std::unique_ptr<RS_Entity> ne;
+                {
+                    // entity updates may load fonts and look up blocks
+                    std::unique_lock<std::mutex> lock(instanceMutex, std::defer_lock);
+                    if (view->isConcurrentDrawing())
+                        lock.lock();
+                    ne.reset(createInstance(*blk, *e, c, r));
+                    ne->setHighlighted(isHighlighted());
+                }
+                // the instance is private to this call, and can be prepared here
+                ne->prepareDraw();
+                view->drawEntity(painter, ne.get());
+            }
+            if (transformed)
+                painter->resetScreenTransform();
+        }
+    }
 }
 
 
@@ -287,6 +668,17 @@ RS_Block* RS_Insert::getBlockForInsert() const{
     return blk;
 }
 
+std::shared_ptr<const RS_Block> RS_Insert::getBlockContent() const
+{
+    RS_Block* blk = getBlockForInsert();
+    return (blk != nullptr) ? blk->getContent() : nullptr;
+}
+
+
+void RS_Insert::prepareDraw()
+{
+    getBlockForInsert();
+}
 
 /**
  * Is this insert visible? (re-implementation from RS_Entity)
@@ -391,6 +783,150 @@ void RS_Insert::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
 }
 
 
+double RS_Insert::getLength() const
+{
+    materializeEntities();
+    return RS_EntityContainer::getLength();
+}
+
+void RS_Insert::selectWindow(enum RS2::EntityType typeToSelect, RS_Vector v1, RS_Vector v2,
+                             bool select, bool cross)
+{
+    materializeEntities();
+    RS_EntityContainer::selectWindow(typeToSelect, v1, v2, select, cross);
+}
+
+RS_Entity* RS_Insert::firstEntity(RS2::ResolveLevel level) const
+{
+    materializeEntities();
+    return RS_EntityContainer::firstEntity(level);
+}
+
+RS_Entity* RS_Insert::lastEntity(RS2::ResolveLevel level) const
+{
+    materializeEntities();
+    return RS_EntityContainer::lastEntity(level);
+}
+
+RS_Entity* RS_Insert::entityAt(int index)
+{
+    materializeEntities();
+    return RS_EntityContainer::entityAt(index);
+}
+
+int RS_Insert::findEntity(RS_Entity const* const entity)
+{
+    materializeEntities();
+    return RS_EntityContainer::findEntity(entity);
+}
+
+unsigned RS_Insert::countSelected(bool deep, QList<RS2::EntityType> const& types)
+{
+    // instances are selected along with the insert
+    if (m_instanced && !isSelected())
+        return 0;
+    materializeEntities();
+    return RS_EntityContainer::countSelected(deep, types);
+}
+
+double RS_Insert::totalSelectedLength()
+{
+    if (m_instanced && !isSelected())
+        return 0.;
+    materializeEntities();
+    return RS_EntityContainer::totalSelectedLength();
+}
+
+RS_Vector RS_Insert::getNearestEndpoint(const RS_Vector& coord, double* dist) const
+{
+    materializeEntities();
+    return RS_EntityContainer::getNearestEndpoint(coord, dist);
+}
+
+RS_Vector RS_Insert::getNearestPointOnEntity(const RS_Vector& coord, bool onEntity,
+                                             double* dist, RS_Entity** entity) const
+{
+    materializeEntities();
+    return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
+}
+
+RS_Vector RS_Insert::getNearestCenter(const RS_Vector& coord, double* dist) const
+{
+    materializeEntities();
+    return RS_EntityContainer::getNearestCenter(coord, dist);
+}
+
+RS_Vector RS_Insert::getNearestMiddle(const RS_Vector& coord, double* dist,
+                                      int middlePoints) const
+{
+    materializeEntities();
+    return RS_EntityContainer::getNearestMiddle(coord, dist, middlePoints);
+}
+
+RS_Vector RS_Insert::getNearestDist(double distance, const RS_Vector& coord,
+                                    double* dist) const
+{
+    materializeEntities();
+    return RS_EntityContainer::getNearestDist(distance, coord, dist);
+}
+
+RS_Vector RS_Insert::getNearestSelectedRef(const RS_Vector& coord, double* dist) const
+{
+    materializeEntities();
+    return RS_EntityContainer::getNearestSelectedRef(coord, dist);
+}
+
+double RS_Insert::getDistanceToPoint(const RS_Vector& coord, RS_Entity** entity,
+                                     RS2::ResolveLevel level, double solidDist) const
+{
+    materializeEntities();
+    return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+}
+
+bool RS_Insert::hasEndpointsWithinWindow(const RS_Vector& v1, const RS_Vector& v2)
+{
+    materializeEntities();
+    return RS_EntityContainer::hasEndpointsWithinWindow(v1, v2);
+}
+
+void RS_Insert::stretch(const RS_Vector& firstCorner, const RS_Vector& secondCorner,
+                        const RS_Vector& offset)
+{
+    materializeEntities();
+    RS_EntityContainer::stretch(firstCorner, secondCorner, offset);
+}
+
+void RS_Insert::moveRef(const RS_Vector& ref, const RS_Vector& offset)
+{
+    materializeEntities();
+    RS_EntityContainer::moveRef(ref, offset);
+}
+
+void RS_Insert::moveSelectedRef(const RS_Vector& ref, const RS_Vector& offset)
+{
+    materializeEntities();
+    RS_EntityContainer::moveSelectedRef(ref, offset);
+}
+
+void RS_Insert::revertDirection()
+{
+    materializeEntities();
+    RS_EntityContainer::revertDirection();
+}
+
+RS_Entity& RS_Insert::shear(double k)
+{
+    materializeEntities();
+    return RS_EntityContainer::shear(k);
+}
+
+double RS_Insert::areaLineIntegral() const
+{
+    materializeEntities();
+    return RS_EntityContainer::areaLineIntegral();
+}
+
+
 std::ostream& operator << (std::ostream& os, const RS_Insert& i) {
     os << " Insert: " << i.getData() << std::endl;
     return os;
@@ -28,8 +28,12 @@
 #ifndef RS_INSERT_H
 #define RS_INSERT_H
 
+#include <memory>
+#include <unordered_set>
+
 #include "rs_entitycontainer.h"
 
+class QTransform;
 class RS_BlockList;
 
 /**
@@ -90,6 +94,24 @@ std::ostream& operator << (std::ostream& os, const RS_InsertData& d);
  */
 class RS_Insert : public RS_EntityContainer {
 public:
+    /**
+     * @brief The UpdatePass class, inserts updated with the same pass update the
+     * inserts nested in each block only once, instead of once per insert of the block.
+     * A pass is created by the caller of the updates and belongs to its thread, the
+     * concurrent updates of updateAll() only read it.
+     */
+    class UpdatePass {
+    public:
+        UpdatePass() = default;
+        UpdatePass(const UpdatePass&) = delete;
+        UpdatePass& operator = (const UpdatePass&) = delete;
+
+    private:
+        friend class RS_Insert;
+        //! blocks with nested inserts updated in this pass
+        std::unordered_set<const RS_Block*> updatedBlocks;
+    };
+
     RS_Insert(RS_EntityContainer* parent,
               const RS_InsertData& d);
 
@@ -106,16 +128,59 @@ public:
     }
 
         /**
-         * Reimplementation of reparent. Invalidates block cache pointer.
+         * Reimplementation of reparent. Invalidates block cache pointer,
+         * unless the block is from the blockSource.
          */
     void reparent(RS_EntityContainer* parent)  override{
                 RS_Entity::reparent(parent);
-                block = nullptr;
+                if (data.blockSource == nullptr)
+                    block = nullptr;
     }
 
 	RS_Block* getBlockForInsert() const;
+    /**
+     * Sets the block cache pointer to a block already found, as the glyph
+     * of a letter, so it is not looked up again in the block source.
+     */
+    void setBlockForInsert(RS_Block* blk) {
+        block = blk;
+    }
+
+    /** Looks up the block, which is cached on first use */
+    void prepareDraw() override;
 
     void update() override;
+    //! updates the insert, and the nested inserts of its block once in the pass
+    void update(UpdatePass& pass);
+    /**
+     * @brief updateAll updates the inserts, concurrently for many inserts. The inserts
+     * nested in their blocks are updated before, level by level of nesting, also
+     * concurrently. Blocks are resolved and marked in the pass by the calling thread.
+     */
+    static void updateAll(const std::vector<RS_Insert*>& inserts, UpdatePass& pass);
+
+    /**
+     * @brief isInstanced whether the insert is drawn from the block on the fly.
+     * Inserts, except previews, don't keep copies of the block entities. The
+     * borders and the entity count are found from the block, and the block entities
+     * are transformed while drawing. The entities are created on demand, when the
+     * insert is traversed, exploded or picked.
+     */
+    bool isInstanced() const {
+        return m_instanced;
+    }
+    /**
+     * @brief getInstancePen the pen of a block entity drawn by this insert, resolved
+     * as the pen of its instance on the layer of the instance
+     */
+    RS_Pen getInstancePen(const RS_Entity& e, const RS_Layer* layer) const;
+
+    void calculateBorders() override;
+    void forcedCalculateBorders() override;
+    unsigned count() const override;
+    unsigned countDeep() const override;
+
+    void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
 
     QString getName() const {
         return data.name;
@@ -181,6 +246,48 @@ public:
     RS_Vector getNearestRef(const RS_Vector& coord,
                             double* dist = nullptr) const override;
 
+    //! \{ create the entities of an instanced insert, and use the container methods
+    double getLength() const override;
+    void selectWindow(enum RS2::EntityType typeToSelect, RS_Vector v1, RS_Vector v2,
+                      bool select=true, bool cross=false) override;
+    RS_Entity* firstEntity(RS2::ResolveLevel level=RS2::ResolveNone) const override;
+    RS_Entity* lastEntity(RS2::ResolveLevel level=RS2::ResolveNone) const override;
+    RS_Entity* entityAt(int index) override;
+    int findEntity(RS_Entity const* const entity) override;
+    unsigned countSelected(bool deep=true, QList<RS2::EntityType> const& types = {}) override;
+    double totalSelectedLength() override;
+    using RS_EntityContainer::getNearestEndpoint;
+    RS_Vector getNearestEndpoint(const RS_Vector& coord,
+                                 double* dist = nullptr) const override;
+    RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+                                      bool onEntity = true,
+                                      double* dist = nullptr,
+                                      RS_Entity** entity=nullptr) const override;
+    RS_Vector getNearestCenter(const RS_Vector& coord,
+                               double* dist = nullptr) const override;
+    RS_Vector getNearestMiddle(const RS_Vector& coord,
+                               double* dist = nullptr,
+                               int middlePoints = 1) const override;
+    RS_Vector getNearestDist(double distance,
+                             const RS_Vector& coord,
+                             double* dist = nullptr) const override;
+    RS_Vector getNearestSelectedRef(const RS_Vector& coord,
+                                    double* dist = nullptr) const override;
+    double getDistanceToPoint(const RS_Vector& coord,
+                              RS_Entity** entity,
+                              RS2::ResolveLevel level=RS2::ResolveNone,
+                              double solidDist = RS_MAXDOUBLE) const override;
+    bool hasEndpointsWithinWindow(const RS_Vector& v1, const RS_Vector& v2) override;
+    void stretch(const RS_Vector& firstCorner,
+                 const RS_Vector& secondCorner,
+                 const RS_Vector& offset) override;
+    void moveRef(const RS_Vector& ref, const RS_Vector& offset) override;
+    void moveSelectedRef(const RS_Vector& ref, const RS_Vector& offset) override;
+    void revertDirection() override;
+    RS_Entity& shear(double k) override;
+    double areaLineIntegral() const override;
+    //! \}
+
     void move(const RS_Vector& offset) override;
     void rotate(const RS_Vector& center, const double& angle) override;
     void rotate(const RS_Vector& center, const RS_Vector& angleVector) override;
@@ -190,8 +297,31 @@ public:
     friend std::ostream& operator << (std::ostream& os, const RS_Insert& i);
 
 protected:
+    void materializeEntities() const override;
+
     RS_InsertData data{};
     mutable RS_Block* block = nullptr;
+
+private:
+    // the entities of the block, shared by all documents for external references
+    std::shared_ptr<const RS_Block> getBlockContent() const;
+    // whether the insert is drawn from the block, see isInstanced()
+    bool canInstance() const;
+    // updates the insert, within the pass if not nullptr
+    void updateEntities(UpdatePass* pass);
+    // the layer of the instance of the block entity e
+    RS_Layer* getInstanceLayer(const RS_Entity& e) const;
+    // the entity for the block entity e in the column c and the row r
+    RS_Entity* createInstance(const RS_Block& blk, const RS_Entity& e, int c, int r) const;
+    // transform the block coordinates of the column c and the row r
+    RS_Vector toInsert(const RS_Block& blk, const RS_Vector& v, int c, int r) const;
+    // the transform of toInsert()
+    QTransform instanceTransform(const RS_Block& blk, int c, int r) const;
+    // the bounding box of a block area in the column c and the row r
+    LC_Rect instanceBox(const RS_Block& blk, const RS_Vector& minV, const RS_Vector& maxV,
+                        int c, int r) const;
+
+    mutable bool m_instanced = false;
 };
 
 
@@ -25,11 +25,17 @@
 **
 **********************************************************************/
 
+#include <atomic>
 #include <iostream>
 #include <QString>
 #include <rs_debug.h>
+#include "lc_rendercache.h"
 #include "rs_layer.h"
 
+namespace {
+std::atomic<unsigned> g_nameGeneration{0};
+}
+
 RS_LayerData::RS_LayerData(const QString& name,
 						   const RS_Pen& pen,
 						   bool frozen,
@@ -57,6 +63,7 @@ RS_Layer* RS_Layer::clone() const{
 /** sets a new name for this layer. */
 void RS_Layer::setName(const QString& name) {
 	data.name = name;
+	++g_nameGeneration;
 }
 
 /** @return the name of this layer. */
@@ -64,9 +71,14 @@ QString RS_Layer::getName() const {
 	return data.name;
 }
 
+unsigned RS_Layer::nameGeneration() {
+	return g_nameGeneration;
+}
+
 /** sets the default pen for this layer. */
 void RS_Layer::setPen(const RS_Pen& pen) {
 	data.pen = pen;
+	LC_RenderCache::invalidatePens();
 }
 
 /** @return default pen for this layer. */
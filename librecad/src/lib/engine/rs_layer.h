@@ -82,6 +82,12 @@ public:
     /** @return the name of this layer. */
 	QString getName() const;
 
+    /**
+     * @return counter incremented by every call of setName(). Layer lists
+     * compare it to find out if their name index is stale.
+     */
+    static unsigned nameGeneration();
+
     /** sets the default pen for this layer. */
 	void setPen(const RS_Pen& pen);
 
@@ -27,6 +27,7 @@
 
 #include<iostream>
 
+#include "lc_rendercache.h"
 #include "rs_debug.h"
 #include "rs_layerlist.h"
 #include "rs_layer.h"
@@ -47,9 +48,31 @@ RS_LayerList::RS_LayerList() {
  */
 void RS_LayerList::clear() {
     layers.clear();
+    invalidateNameIndex();
 	setModified(true);
 }
 
+void RS_LayerList::invalidateNameIndex() {
+    m_nameIndex.clear();
+    m_nameIndexValid = false;
+}
+
+const QHash<QString, RS_Layer*>& RS_LayerList::nameIndex() {
+    // layers may be renamed directly by RS_Layer::setName(), without the list knowing
+    if (m_nameIndexValid && m_nameGeneration == RS_Layer::nameGeneration())
+        return m_nameIndex;
+
+    m_nameIndex.clear();
+    m_nameIndex.reserve(layers.size());
+    for (RS_Layer* l: layers) {
+        if (!m_nameIndex.contains(l->getName()))
+            m_nameIndex.insert(l->getName(), l);
+    }
+    m_nameGeneration = RS_Layer::nameGeneration();
+    m_nameIndexValid = true;
+    return m_nameIndex;
+}
+
 
 QList<RS_Layer*>::iterator RS_LayerList::begin()
 {
@@ -155,7 +178,10 @@ void RS_LayerList::add(RS_Layer* layer) {
     RS_Layer* l = find(layer->getName());
     if (l==nullptr) {
         layers.append(layer);
+        if (m_nameIndexValid)
+            m_nameIndex.insert(layer->getName(), layer);
         this->sort();
+        LC_RenderCache::invalidatePens();
         // notify listeners
         for (int i=0; i<layerListListeners.size(); ++i) {
             RS_LayerListListener* l = layerListListeners.at(i);
@@ -201,6 +227,8 @@ void RS_LayerList::remove(RS_Layer* layer) {
 
     // here the layer is removed from the list but not deleted
     layers.removeOne(layer);
+    invalidateNameIndex();
+    LC_RenderCache::invalidatePens();
 
     for (int i=0; i<layerListListeners.size(); ++i) {
         RS_LayerListListener* l = layerListListeners.at(i);
@@ -231,6 +259,8 @@ void RS_LayerList::edit(RS_Layer* layer, const RS_Layer& source) {
     }
 
     *layer = source;
+    invalidateNameIndex();
+    LC_RenderCache::invalidatePens();
 
     fireEdit(layer);
 }
@@ -252,21 +282,9 @@ void RS_LayerList::fireEdit(RS_Layer* layer) {
  * \p nullptr if no such layer was found.
  */
 RS_Layer* RS_LayerList::find(const QString& name) {
-    //RS_DEBUG->print("RS_LayerList::find begin");
-
-    RS_Layer* ret = nullptr;
-
-    for (int i=0; i<layers.size(); ++i) {
-        RS_Layer* l = layers.at(i);
-        if (l->getName()==name) {
-            ret = l;
-            break;
-        }
-    }
-
-    //RS_DEBUG->print("RS_LayerList::find end");
-
-    return ret;
+    const QHash<QString, RS_Layer*>& index = nameIndex();
+    auto it = index.constFind(name);
+    return (it != index.cend()) ? it.value() : nullptr;
 }
 
 
@@ -276,22 +294,8 @@ RS_Layer* RS_LayerList::find(const QString& name) {
  * was not found.
  */
 int RS_LayerList::getIndex(const QString& name) {
-    //RS_DEBUG->print("RS_LayerList::find begin");
-
-    int ret = -1;
-
-    for (int i=0; i<layers.size(); i++) {
-        RS_Layer* l = layers.at(i);
-
-        if (l->getName()==name) {
-            ret = i;
-            break;
-        }
-    }
-
-    //RS_DEBUG->print("RS_LayerList::find end");
-
-    return ret;
+    RS_Layer* l = find(name);
+    return (l != nullptr) ? layers.indexOf(l) : -1;
 }
 
 
@@ -414,6 +418,18 @@ void RS_LayerList::fireLayerToggled(){
     }
 }
 
+/**
+ * Notifies listeners of frozen or thawed layers, so views redraw just the entities on them
+ */
+void RS_LayerList::fireLayersToggled(const std::vector<RS_Layer*>& toggledLayers){
+    setModified(true);
+
+    for (int i=0; i<layerListListeners.size(); ++i) {
+        RS_LayerListListener* l = layerListListeners.at(i);
+        l->layersToggled(toggledLayers);
+    }
+}
+
 /**
  * Freezes or defreezes all layers.
  *
@@ -421,13 +437,15 @@ void RS_LayerList::fireLayerToggled(){
  */
 void RS_LayerList::freezeAll(bool freeze) {
 
+    std::vector<RS_Layer*> toggledLayers;
     for (unsigned l=0; l<count(); l++) {
-        if (at(l)->isVisibleInLayerList()) {
+        if (at(l)->isVisibleInLayerList() && at(l)->isFrozen() != freeze) {
              at(l)->freeze(freeze);
+             toggledLayers.push_back(at(l));
          }
     }
 
-    fireLayerToggled();
+    fireLayersToggled(toggledLayers);
 
 }
 
@@ -483,21 +501,24 @@ void RS_LayerList::toggleConstructionMulti(QList<RS_Layer*> toggleLayers){
 }
 
 void RS_LayerList::setFreezeMulti(QList<RS_Layer*> layersEnable, QList<RS_Layer*> layersDisable){
+    std::vector<RS_Layer*> toggledLayers;
     int countUnFreeze = layersEnable.count();
     for (int i = 0; i < countUnFreeze; i++){
         RS_Layer* layer = layersEnable.at(i);
-        if (layer){
+        if (layer && layer->isFrozen()){
             layer->freeze(false);
+            toggledLayers.push_back(layer);
         }
     }
     int countFreeze = layersDisable.count();
     for (int i = 0; i < countFreeze; i++){
         RS_Layer* layer = layersDisable.at(i);
-        if (layer){
+        if (layer && !layer->isFrozen()){
             layer->freeze(true);
+            toggledLayers.push_back(layer);
         }
     }
-   fireLayerToggled();
+   fireLayersToggled(toggledLayers);
 }
 
 void RS_LayerList::setLockMulti(QList<RS_Layer*> layersToUnlock, QList<RS_Layer*> layersToLock){
@@ -555,14 +576,16 @@ void RS_LayerList::setConstructionMulti(QList<RS_Layer*> layersNoConstruction, Q
 }
 
 void RS_LayerList::toggleFreezeMulti(QList<RS_Layer*> toggleLayers){
+    std::vector<RS_Layer*> toggledLayers;
     int count = toggleLayers.count();
     for (int i = 0; i < count; i++){
         RS_Layer* layer = toggleLayers.at(i);
         if (layer){
             layer->toggle();
+            toggledLayers.push_back(layer);
         }
     }
-   fireLayerToggled();
+   fireLayersToggled(toggledLayers);
 }
 
 
@@ -607,6 +630,8 @@ std::ostream& operator << (std::ostream& os, RS_LayerList& l) {
  */
 void RS_LayerList::setModified(bool m) {
     modified = m;
+    if (m)
+        ++version;
 
     // Notify listeners
     for (auto* l: layerListListeners) {
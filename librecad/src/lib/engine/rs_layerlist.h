@@ -29,7 +29,11 @@
 #ifndef RS_LAYERLIST_H
 #define RS_LAYERLIST_H
 
+#include <vector>
+
+#include <QHash>
 #include <QList>
+#include <QString>
 
 class RS_Layer;
 class RS_LayerListListener;
@@ -117,6 +121,9 @@ public:
 
     void addListener(RS_LayerListListener* listener);
     void removeListener(RS_LayerListListener* listener);
+    const QList<RS_LayerListListener*>& getListeners() const {
+        return layerListListeners;
+    }
 
     /**
      * Sets the layer lists modified status to 'm'.
@@ -130,6 +137,12 @@ public:
     virtual bool isModified() const {
         return modified;
     }
+    /**
+     * @return a counter incremented whenever the list is set modified
+     */
+    unsigned long getVersion() const {
+        return version;
+    }
     /**
      * @brief sort by layer names
      */
@@ -142,8 +155,18 @@ public:
 private:
 
     void fireLayerToggled();
+    void fireLayersToggled(const std::vector<RS_Layer*>& toggledLayers);
+    void invalidateNameIndex();
+    //! @brief the name index, rebuilt if layers were renamed since it was built
+    const QHash<QString, RS_Layer*>& nameIndex();
+
 	//! layers in the graphic
     QList<RS_Layer*> layers;
+    //! layers by names, the first one in the list on duplicated names
+    QHash<QString, RS_Layer*> m_nameIndex;
+    //! RS_Layer::nameGeneration() at the time the name index was built
+    unsigned m_nameGeneration = 0;
+    bool m_nameIndexValid = false;
     //! List of registered LayerListListeners
     QList<RS_LayerListListener*> layerListListeners;
     QG_LayerWidget *layerWidget = nullptr;
@@ -151,6 +174,7 @@ private:
     RS_Layer *activeLayer = nullptr;
     /** Flag set if the layer list was modified and not yet saved. */
     bool modified = false;
+    unsigned long version = 0;
 };
 
 #endif
@@ -29,6 +29,8 @@
 #ifndef RS_LAYERLISTLISTENER_H
 #define RS_LAYERLISTLISTENER_H
 
+#include <vector>
+
 #include "rs_layer.h"
 
 /**
@@ -64,6 +66,13 @@ public:
      */
     virtual void layerToggled(RS_Layer*) {}
 
+    /**
+     * Called when the visibility of several layers is changed at once.
+     */
+    virtual void layersToggled(const std::vector<RS_Layer*>& /*layers*/) {
+        layerToggled(nullptr);
+    }
+
     /**
      * Called when a layer's lock attribute is toggled.
      */
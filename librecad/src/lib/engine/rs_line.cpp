@@ -625,49 +625,31 @@ void RS_Line::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOff
 
 void RS_Line::drawInfinite(RS_Painter& painter, RS_GraphicView& view)
 {
-    LC_Rect viewportRect = view.getViewRect();
-    RS_VectorSolutions endPoints{{ getStartpoint(), getEndpoint()}};
-
-    RS_EntityContainer borders(nullptr, true);
-    borders.addRectangle(viewportRect.minP(), viewportRect.maxP());
-
-    RS_Vector pStart{view.toGui(endPoints.at(0))};
-    RS_Vector pEnd{view.toGui(endPoints.at(1))};
-    //    std::cout<<"draw line: "<<pStart<<" to "<<pEnd<<std::endl;
-    RS_Vector direction = pEnd-pStart;
-    if (direction.squared() < RS_TOLERANCE2)
+    const RS_Vector& start = getStartpoint();
+    if ((view.toGui(getEndpoint()) - view.toGui(start)).squared() < RS_TOLERANCE2)
         return;
 
-    RS_VectorSolutions vpIts;
-    for(RS_Entity* border: borders) {
-        auto const sol=RS_Information::getIntersection(this, border, false);
-        for(const RS_Vector& vp: sol) {
-            if (vpIts.getClosestDistance(vp) > RS_TOLERANCE * 10.)
-                vpIts.push_back(vp);
-        }
-    }
-
-    //draw construction lines up to viewport border
-    switch (vpIts.size()) {
-    case 2:
-        // no need to sort intersections
-        break;
-    case 3:
-    case 4: {
-        // will use the inner two points
-        size_t i{0};
-        for (size_t j = 0; j < vpIts.size(); ++j)
-            if (viewportRect.inArea(vpIts.at(j), RS_TOLERANCE * 10.))
-                std::swap(vpIts[j], vpIts[i++]);
-
-    }
-        break;
-    default:
-        //should not happen
+    // the parameter range of the line within the viewport, clipped by the
+    // slabs of the viewport borders
+    const LC_Rect viewportRect = view.getViewRect();
+    const RS_Vector direction = getEndpoint() - start;
+    double tMin = -RS_MAXDOUBLE;
+    double tMax = RS_MAXDOUBLE;
+    auto clip = [&tMin, &tMax](double origin, double delta, double low, double high) {
+        if (std::abs(delta) < RS_TOLERANCE2)
+            return origin >= low && origin <= high;
+        const double t1 = (low - origin) / delta;
+        const double t2 = (high - origin) / delta;
+        tMin = std::max(tMin, std::min(t1, t2));
+        tMax = std::min(tMax, std::max(t1, t2));
+        return tMin <= tMax;
+    };
+    if (!clip(start.x, direction.x, viewportRect.minP().x, viewportRect.maxP().x)
+            || !clip(start.y, direction.y, viewportRect.minP().y, viewportRect.maxP().y))
         return;
-    }
 
-    painter.drawLine(view.toGui(vpIts.get(0)), view.toGui(vpIts.get(1)));
+    //draw construction lines up to viewport border
+    painter.drawLine(view.toGui(start + direction * tMin), view.toGui(start + direction * tMax));
 }
 
 /**
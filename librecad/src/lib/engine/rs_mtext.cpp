@@ -24,11 +24,14 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
 #include "rs_mtext.h"
 
+#include "lc_regenstatistics.h"
+#include "lc_trace.h"
 #include "rs_debug.h"
 #include "rs_font.h"
 #include "rs_fontlist.h"
@@ -181,9 +184,13 @@ int RS_MText::getNumberOfLines() {
  * This method also updates the usedTextWidth / usedTextHeight property.
  */
 void RS_MText::update() {
-  RS_DEBUG->print("RS_MText::update");
+    LC_TRACE_ZONE("RS_MText::update");
+    const LC_RegenStatistics::Regen regen{LC_RegenStatistics::Text};
+  RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_MText::update");
 
   clear();
+  // the index is created for the final line positions
+  setSpatialIndexEnabled(false);
   if (isUndone()) {
     return;
   }
@@ -372,8 +379,9 @@ void RS_MText::update() {
   usedTextHeight -=
       data.height * data.lineSpacingFactor * 5.0 / 3.0 - data.height;
   forcedCalculateBorders();
+  setSpatialIndexBySize();
 
-  RS_DEBUG->print("RS_MText::update: OK");
+  RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_MText::update: OK");
 }
 
 /**
@@ -391,11 +399,13 @@ void RS_MText::addLetter(RS_EntityContainer &oneLine, QChar letter,
                          RS_Font &font, const RS_Vector &letterSpace,
                          RS_Vector &letterPosition) {
   QString letterText{QString(letter)};
-  if (nullptr == font.findLetter(letterText)) {
-    RS_DEBUG->print("RS_MText::update: missing font for letter( %s ), replaced "
+  const RS_Font::Glyph *glyph = font.findGlyph(letterText);
+  if (nullptr == glyph) {
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_MText::update: missing font for letter( %s ), replaced "
                     "it with QChar(0xfffd)",
                     qPrintable(letterText));
     letterText = QChar(0xfffd);
+    glyph = font.findGlyph(letterText);
   }
 
   LC_LOG << "RS_MText::update: insert a letter at pos:(" << letterPosition.x
@@ -403,22 +413,27 @@ void RS_MText::addLetter(RS_EntityContainer &oneLine, QChar letter,
 
   if (letterSpace.x < 0)
     letterPosition.x += letterSpace.x;
-  RS_InsertData d(letterText, letterPosition, RS_Vector(1.0, 1.0), 0.0, 1, 1,
-                  RS_Vector(0.0, 0.0), font.getLetterList(), RS2::NoUpdate);
 
-  RS_Insert *letterEntity{new RS_Insert(this, d)};
-  letterEntity->setPen(RS_Pen(RS2::FlagInvalid));
-  letterEntity->setLayer(nullptr);
-  letterEntity->update();
-  letterEntity->forcedCalculateBorders();
-
-  RS_Vector letterWidth{letterEntity->getMax().x - letterEntity->getMin().x,
-                        0.};
+  RS_Vector letterWidth{
+      (nullptr != glyph) ? std::max(glyph->maxV.x - glyph->minV.x, 0.) : 0., 0.};
   letterWidth.x = std::copysign(letterWidth.x, letterSpace.x);
 
-  oneLine.addEntity(letterEntity);
-  if (letterSpace.x < 0)
-    letterEntity->move({letterWidth.x, 0.});
+  // letters are instances of the shared glyph blocks, the block is set
+  // directly, as texts may be laid out concurrently
+  if (nullptr != glyph) {
+    RS_InsertData d(letterText, letterPosition, RS_Vector(1.0, 1.0), 0.0, 1, 1,
+                    RS_Vector(0.0, 0.0), font.getLetterList(), RS2::NoUpdate);
+
+    RS_Insert *letterEntity{new RS_Insert(this, d)};
+    letterEntity->setBlockForInsert(glyph->block);
+    letterEntity->setPen(RS_Pen(RS2::FlagInvalid));
+    letterEntity->setLayer(nullptr);
+    letterEntity->update();
+
+    oneLine.addEntity(letterEntity);
+    if (letterSpace.x < 0)
+      letterEntity->move({letterWidth.x, 0.});
+  }
 
   // next letter position:
   letterPosition += letterWidth;
@@ -449,10 +464,10 @@ RS_MText *RS_MText::createUpperLower(QString text, const RS_MTextData &data,
 double RS_MText::updateAddLine(RS_EntityContainer *textLine, int lineCounter) {
   constexpr double ls = 5.0 / 3.0;
 
-  RS_DEBUG->print("RS_MText::updateAddLine: width: %f", textLine->getSize().x);
+  RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_MText::updateAddLine: width: %f", textLine->getSize().x);
 
   // textLine->forcedCalculateBorders();
-  // RS_DEBUG->print("RS_MText::updateAddLine: width 2: %f",
+  // RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_MText::updateAddLine: width 2: %f",
   // textLine->getSize().x);
 
   // Move to correct line position:
@@ -465,14 +480,14 @@ double RS_MText::updateAddLine(RS_EntityContainer *textLine, int lineCounter) {
   }
   RS_Vector textSize = textLine->getSize();
 
-  RS_DEBUG->print("RS_MText::updateAddLine: width 2: %f", textSize.x);
+  RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_MText::updateAddLine: width 2: %f", textSize.x);
 
   // Horizontal Align:
   if (data.drawingDirection == RS_MTextData::RightToLeft)
       textSize.x = - textSize.x;
   switch (data.halign) {
   case RS_MTextData::HACenter:
-    RS_DEBUG->print("RS_MText::updateAddLine: move by: %f", -textSize.x / 2.0);
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_MText::updateAddLine: move by: %f", -textSize.x / 2.0);
     textLine->move(RS_Vector(-textSize.x / 2.0, 0.0));
     break;
 
@@ -528,6 +543,8 @@ double RS_MText::updateAddLine(RS_EntityContainer *textLine, int lineCounter) {
   textLine->setPen(RS_Pen(RS2::FlagInvalid));
   textLine->setLayer(nullptr);
   textLine->forcedCalculateBorders();
+  // long lines are picked by the index of the glyphs
+  textLine->setSpatialIndexBySize();
 
   addEntity(textLine);
   return textTail;
@@ -43,7 +43,7 @@ RS_Pattern::RS_Pattern(const QString& fileName)
 		,fileName(fileName)
 		,loaded(false)
 {
-	RS_DEBUG->print("RS_Pattern::RS_Pattern() ");
+	RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Pattern::RS_Pattern() ");
 }
 
 
@@ -70,7 +70,7 @@ bool RS_Pattern::loadPattern() {
         return true;
     }
 
-    RS_DEBUG->print("RS_Pattern::loadPattern");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Pattern::loadPattern");
 
     // Search for the appropriate pattern if we have only the name of the pattern:
     QString path;
@@ -80,7 +80,7 @@ bool RS_Pattern::loadPattern() {
         foreach (const QString& path0, RS_SYSTEM->getPatternList()) {
             if (QFileInfo(path0).baseName().toLower()==fileName.toLower()) {
                 path = path0;
-                RS_DEBUG->print("Pattern found: %s", path.toLatin1().data());
+                RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "Pattern found: %s", path.toLatin1().data());
                 break;
             }
         }
@@ -93,7 +93,7 @@ bool RS_Pattern::loadPattern() {
 
     // No pattern paths found:
     if (path.isEmpty()) {
-        RS_DEBUG->print("No pattern \"%s\"available.", fileName.toLatin1().data());
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "No pattern \"%s\"available.", fileName.toLatin1().data());
         return false;
     }
 
@@ -115,7 +115,7 @@ bool RS_Pattern::loadPattern() {
 	}
 
     loaded = true;
-    RS_DEBUG->print("RS_Pattern::loadPattern: OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Pattern::loadPattern: OK");
 
     return true;
 }
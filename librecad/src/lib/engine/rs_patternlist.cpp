@@ -45,19 +45,19 @@ RS_PatternList::~RS_PatternList() = default;
  * objects, one for each pattern that could be found.
  */
 void RS_PatternList::init() {
-    RS_DEBUG->print("RS_PatternList::initPatterns");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_PatternList::initPatterns");
 
 	QStringList list = RS_SYSTEM->getPatternList();
 
 	patterns.clear();
 
     foreach(auto const& s, list) {
-        RS_DEBUG->print("pattern: %s:", s.toLatin1().data());
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "pattern: %s:", s.toLatin1().data());
 
         QString const name = QFileInfo(s).baseName().toLower();
-        patterns.emplace(name, std::unique_ptr<RS_Pattern>{});
+        patterns.emplace(name, std::shared_ptr<const RS_Pattern>{});
 
-        RS_DEBUG->print("base: %s", name.toLatin1().data());
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "base: %s", name.toLatin1().data());
     }
     if (patterns.empty())
         RS_DIALOGFACTORY->commandMessage(QObject::tr("Hatch:: no pattern found. Please set pattern path in application preferences"));
@@ -65,46 +65,39 @@ void RS_PatternList::init() {
 
 
 /**
- * @return Pointer to the pattern with the given name or
- * \p NULL if no such pattern was found. The pattern will be loaded into
+ * @return the pattern with the given name or
+ * \p nullptr if no such pattern was found. The pattern will be loaded into
  * memory if it's not already.
  */
-std::unique_ptr<RS_Pattern> RS_PatternList::requestPattern(const QString& name) {
-    RS_DEBUG->print("RS_PatternList::requestPattern %s", name.toLatin1().data());
+std::shared_ptr<const RS_Pattern> RS_PatternList::requestPattern(const QString& name) {
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_PatternList::requestPattern %s", name.toLatin1().data());
 
     QString name2 = name.toLower();
-    RS_DEBUG->print("Pattern: name2: %s", name2.toLatin1().data());
-    if (patterns.count(name2) == 0 || patterns.at(name2) == nullptr) {
-        auto p = std::make_unique<RS_Pattern>(name2);
-        if (p!=nullptr) {
-            if (p->loadPattern()) {
-                patterns.emplace(name2,  std::unique_ptr<RS_Pattern>{});
-                patterns[name2].swap(p);
-            }
-            else {
-                patterns.erase(name2);
-            }
-        }
-        else {
-            LC_ERR<<"RS_PatternList::"<<__func__<<"(): loading pattern failed: "<<name2;
-            RS_DIALOGFACTORY->commandMessage(QObject::tr("Hatch:: loading pattern failed: %1").arg(name2));
-            return {};
-        }
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "Pattern: name2: %s", name2.toLatin1().data());
+    std::lock_guard<std::mutex> lock(requestMutex);
+    auto it = patterns.find(name2);
+    if (it != patterns.end() && it->second != nullptr)
+        return it->second;
+
+    auto p = std::make_shared<RS_Pattern>(name2);
+    if (!p->loadPattern()) {
+        LC_ERR<<"RS_PatternList::"<<__func__<<"(): loading pattern failed: "<<name2;
+        RS_DIALOGFACTORY->commandMessage(QObject::tr("Hatch:: loading pattern failed: %1").arg(name2));
+        if (it != patterns.end())
+            patterns.erase(it);
+        return {};
     }
-
-    if (patterns.count(name2) == 1) {
-        RS_DEBUG->print("name2: %s, size= %d", name2.toLatin1().data(),
-                        patterns[name2]->countDeep());
-        return std::unique_ptr<RS_Pattern>{static_cast<RS_Pattern*>(patterns[name2]->clone())};
-	}
-
-    return {};
-
+    // borders are final, readers only access the pattern by const reference
+    p->calculateBorders();
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "name2: %s, size= %d", name2.toLatin1().data(), p->countDeep());
+    patterns[name2] = p;
+    return p;
 }
 
 	
 bool RS_PatternList::contains(const QString& name) const {
-
+    // patterns are added by concurrent requests
+    std::lock_guard<std::mutex> lock(requestMutex);
 	return patterns.count(name.toLower());
 
 }
@@ -118,7 +111,7 @@ std::ostream& operator << (std::ostream& os, RS_PatternList& l) {
     os << "Patternlist: \n";
 	for (auto const& pa: l.patterns)
 		if (pa.second)
-			os<< *pa.second << '\n';
+			os<< pa.first.toStdString() << ": " << pa.second->count() << " entities\n";
 
     return os;
 }
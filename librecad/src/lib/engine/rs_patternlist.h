@@ -30,6 +30,7 @@
 
 #include<map>
 #include<memory>
+#include<mutex>
 
 class RS_Pattern;
 class QString;
@@ -43,7 +44,7 @@ class QString;
  * @author Andrew Mustun
  */
 class RS_PatternList {
-	using PTN_MAP = std::map<QString, std::unique_ptr<RS_Pattern>>;
+	using PTN_MAP = std::map<QString, std::shared_ptr<const RS_Pattern>>;
 	RS_PatternList() = default;
 
 public:
@@ -79,7 +80,12 @@ public:
 	}
 	//! \}
 
-    std::unique_ptr<RS_Pattern> requestPattern(const QString& name);
+    /**
+     * @return the pattern, loaded on the first request. Patterns are parsed
+     * once and shared read-only, so they may be requested by concurrent threads
+     * without copying
+     */
+    std::shared_ptr<const RS_Pattern> requestPattern(const QString& name);
 
 	bool contains(const QString& name) const;
 
@@ -89,6 +95,7 @@ public:
 private:
     //! patterns in the graphic
     PTN_MAP patterns;
+    mutable std::mutex requestMutex;
 };
 
 #endif
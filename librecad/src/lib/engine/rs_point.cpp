@@ -206,8 +206,8 @@ void RS_Point::draw(RS_Painter* painter,RS_GraphicView* view, double& /*patternO
 
     RS_Graphic* graphic = getGraphic();
     if (graphic) {
-		int pdmode = getGraphicVariableInt("$PDMODE", LC_DEFAULTS_PDMode);
-		double pdsize = getGraphicVariableDouble("$PDSIZE", LC_DEFAULTS_PDSize);
+		int pdmode = graphic->getVariableInt(RS_VariableDict::PointMode, LC_DEFAULTS_PDMode);
+		double pdsize = graphic->getVariableDouble(RS_VariableDict::PointSize, LC_DEFAULTS_PDSize);
 		RS_Vector guiPos = view->toGui(getPos());
 
 		int deviceHeight = painter->getHeight();
@@ -23,6 +23,7 @@
 ** This copyright notice MUST APPEAR in all copies of the script!
 **
 **********************************************************************/
+#include<algorithm>
 #include<cassert>
 #include<cmath>
 #include<iostream>
@@ -37,6 +38,60 @@
 #include "rs_math.h"
 #include "rs_painter.h"
 
+namespace {
+// the arc from start to end with the bulge (see DXF documentation)
+RS_ArcData getBulgeArc(const RS_Vector& start, const RS_Vector& end, double bulge)
+{
+    bool reversed = std::signbit(bulge);
+    double alpha = std::atan(std::abs(bulge)) * 4.0;
+
+    RS_Vector middle = (start + end)/2.0;
+    double dist=start.distanceTo(end)/2.0;
+    double angle=start.angleTo(end);
+
+    // alpha can't be 0.0 at this point
+    double const radius = std::abs(dist / std::sin(alpha/2.0));
+
+    double const wu = std::abs(radius*radius - dist*dist);
+    double angleNew = reversed ? angle - M_PI_2 : angle + M_PI_2;
+    double h = (std::abs(alpha)>M_PI) ? -std::sqrt(wu) : std::sqrt(wu);
+
+    RS_Vector center = RS_Vector::polar(h, angleNew);
+    center += middle;
+
+    return {center, radius, center.angleTo(start), center.angleTo(end), reversed};
+}
+
+// the distance from the point to a line segment
+double lineDistance(const RS_Vector& start, const RS_Vector& end, const RS_Vector& coord)
+{
+    const RS_Vector direction = end - start;
+    const double length2 = direction.squared();
+    if (length2 < RS_TOLERANCE2)
+        return coord.distanceTo(start);
+    const double t = std::clamp(RS_Vector::dotP(coord - start, direction) / length2, 0., 1.);
+    return coord.distanceTo(start + direction * t);
+}
+}
+
+bool RS_PolylineSegment::isArc() const
+{
+    return std::abs(bulge) >= RS_TOLERANCE && std::abs(bulge) < RS_MAXDOUBLE;
+}
+
+RS_ArcData RS_PolylineSegment::getArcData() const
+{
+    return getBulgeArc(start, end, bulge);
+}
+
+double RS_PolylineSegment::getLength() const
+{
+    if (!isArc())
+        return start.distanceTo(end);
+    const double alpha = std::atan(std::abs(bulge)) * 4.0;
+    return std::abs(start.distanceTo(end) / (2.0 * std::sin(alpha/2.0))) * alpha;
+}
+
 RS_PolylineData::RS_PolylineData(const RS_Vector& _startpoint,
 				const RS_Vector& _endpoint,
 				bool _closed):
@@ -129,6 +184,7 @@ RS_Entity* RS_Polyline::addVertex(const RS_Vector& v, double bulge, bool prepend
 
 	RS_Entity* entity=nullptr;
     //static double nextBulge = 0.0;
+    materializeEntities();
 
     // very first vertex:
     if (!data.startpoint.valid) {
@@ -163,6 +219,7 @@ RS_Entity* RS_Polyline::addVertex(const RS_Vector& v, double bulge, bool prepend
  * sets the startpoint to the first point if not exist.
  *
  * The very first vertex added with this method is the startpoint if not exists.
+ * The vertices of an empty polyline are kept in flat arrays, see isFlat().
  *
  * @param vl list of vertexs coordinate to be added
  * @param Pair are RS_Vector of coord and the bulge of the arc or 0 for a line segment (see DXF documentation)
@@ -173,7 +230,24 @@ void RS_Polyline::appendVertexs(const std::vector< std::pair<RS_Vector, double>
 	RS_Entity* entity=nullptr;
     //static double nextBulge = 0.0;
 	if (!vl.size()) return;
+    if (!data.startpoint.valid && !m_flat && RS_EntityContainer::count() == 0) {
+        m_flat = true;
+        m_vertices.reserve(vl.size());
+        m_bulges.reserve(vl.size());
+        for (const auto& [vertex, bulge]: vl) {
+            m_vertices.push_back(vertex);
+            m_bulges.push_back(bulge);
+        }
+        data.startpoint = m_vertices.front();
+        data.endpoint = m_vertices.back();
+        nextBulge = m_bulges.back();
+        calculateBorders();
+        return;
+    }
+    materializeEntities();
 	size_t idx = 0;
+	// the segments, and the closing one
+	reserveEntities(int(vl.size()) + 1);
     // very first vertex:
     if (!data.startpoint.valid) {
 		data.startpoint = data.endpoint = vl.at(idx).first;
@@ -224,29 +298,9 @@ std::unique_ptr<RS_Entity> RS_Polyline::createVertex(const RS_Vector& v, double
         entity->setLayer(nullptr);
     } else {
         // create arc for the polyline:
-        bool reversed = std::signbit(bulge);
-        double alpha = std::atan(std::abs(bulge)) * 4.0;
-
-        RS_Vector start = prepend ? data.startpoint : data.endpoint;
-        RS_Vector middle = (start + v)/2.0;
-        double dist=start.distanceTo(v)/2.0;
-        double angle=start.angleTo(v);
-
-        // alpha can't be 0.0 at this point
-        double const radius = std::abs(dist / std::sin(alpha/2.0));
-
-        double const wu = std::abs(radius*radius - dist*dist);
-        double angleNew = reversed ? angle - M_PI_2 : angle + M_PI_2;
-        double h = (std::abs(alpha)>M_PI) ? -std::sqrt(wu) : std::sqrt(wu);
-
-        RS_Vector center = RS_Vector::polar(h, angleNew);
-        center += middle;
-        double a1 = center.angleTo(prepend ? v : data.endpoint);
-        double a2 = center.angleTo(prepend ? data.startpoint : v);
-
-        RS_ArcData const d(center, radius,
-                     a1, a2,
-                     reversed);
+        RS_ArcData d = getBulgeArc(prepend ? data.startpoint : data.endpoint, v, bulge);
+        if (prepend)
+            std::swap(d.angle1, d.angle2);
 
         entity = std::make_unique<RS_Arc>(this, d);
         entity->setSelected(isSelected());
@@ -263,6 +317,7 @@ std::unique_ptr<RS_Entity> RS_Polyline::createVertex(const RS_Vector& v, double
  */
 void RS_Polyline::endPolyline() {
         RS_DEBUG->print("RS_Polyline::endPolyline");
+    materializeEntities();
 
     if (isClosed()) {
                 RS_DEBUG->print("RS_Polyline::endPolyline: adding closing entity");
@@ -287,6 +342,7 @@ void RS_Polyline::endPolyline() {
 //RLZ: rewrite this:
 void RS_Polyline::setClosed(bool cl, double bulge) {
     Q_UNUSED(bulge);
+    materializeEntities();
     bool areClosed = isClosed();
     setClosed(cl);
     if (isClosed()) {
@@ -339,6 +395,10 @@ RS_Vector RS_Polyline::getEndpoint() const {
  * @return The bulge of the closing entity.
  */
 double RS_Polyline::getClosingBulge() const{
+    if (m_flat) {
+        const bool arc = hasClosingSegment() && getSegment(count() - 1).isArc();
+        return arc ? m_bulges.back() : 0.0;
+    }
 	if (isClosed()) {
 		RS_Entity const* e = last();
 		if (e && e->rtti()==RS2::EntityArc) {
@@ -354,6 +414,8 @@ bool RS_Polyline::isClosed() const {
 }
 
 void RS_Polyline::setClosed(bool cl) {
+    // the closing segment of flat polylines depends on the flag
+    materializeEntities();
 	if (cl) {
 		data.setFlag(RS2::FlagClosed);
 	}
@@ -411,6 +473,12 @@ void RS_Polyline::addEntity(RS_Entity* /*entity*/) {
 
 RS_VectorSolutions RS_Polyline::getRefPoints() const{
 	RS_VectorSolutions ret{{data.startpoint}};
+    if (m_flat) {
+        for (unsigned i = 0; i < count(); ++i)
+            ret.push_back(getSegment(i).end);
+        ret.push_back(data.endpoint);
+        return ret;
+    }
 	for(auto e: *this){
 		if (e->isAtomic()) {
 			ret.push_back(e->getEndpoint());
@@ -613,6 +681,8 @@ bool RS_Polyline::offset(const RS_Vector& coord, const double& distance){
 }
 
 void RS_Polyline::move(const RS_Vector& offset) {
+    for (RS_Vector& vertex: m_vertices)
+        vertex.move(offset);
     RS_EntityContainer::move(offset);
     data.startpoint.move(offset);
     data.endpoint.move(offset);
@@ -627,6 +697,8 @@ void RS_Polyline::rotate(const RS_Vector& center, const double& angle) {
 
 
 void RS_Polyline::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
+    for (RS_Vector& vertex: m_vertices)
+        vertex.rotate(center, angleVector);
     RS_EntityContainer::rotate(center, angleVector);
     data.startpoint.rotate(center, angleVector);
     data.endpoint.rotate(center, angleVector);
@@ -636,6 +708,20 @@ void RS_Polyline::rotate(const RS_Vector& center, const RS_Vector& angleVector)
 
 
 void RS_Polyline::scale(const RS_Vector& center, const RS_Vector& factor) {
+    if (m_flat) {
+        // arcs are kept by non-uniform scaling only, if it mirrors them
+        const bool uniform = std::abs(std::abs(factor.x) - std::abs(factor.y)) < RS_TOLERANCE;
+        if (!uniform && std::any_of(m_bulges.cbegin(), m_bulges.cend(),
+                                    [](double bulge) {return RS_PolylineSegment{{}, {}, bulge}.isArc();}))
+            materializeEntities();
+    }
+    if (m_flat) {
+        for (RS_Vector& vertex: m_vertices)
+            vertex.scale(center, factor);
+        if (factor.x * factor.y < 0.)
+            for (double& bulge: m_bulges)
+                bulge = -bulge;
+    }
     RS_EntityContainer::scale(center, factor);
     data.startpoint.scale(center, factor);
     data.endpoint.scale(center, factor);
@@ -645,6 +731,10 @@ void RS_Polyline::scale(const RS_Vector& center, const RS_Vector& factor) {
 
 
 void RS_Polyline::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
+    for (RS_Vector& vertex: m_vertices)
+        vertex.mirror(axisPoint1, axisPoint2);
+    for (double& bulge: m_bulges)
+        bulge = -bulge;
     RS_EntityContainer::mirror(axisPoint1, axisPoint2);
     data.startpoint.mirror(axisPoint1, axisPoint2);
     data.endpoint.mirror(axisPoint1, axisPoint2);
@@ -654,6 +744,7 @@ void RS_Polyline::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint
 
 
 void RS_Polyline::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
+    materializeEntities();
         RS_EntityContainer::moveRef(ref, offset);
     if (ref.distanceTo(data.startpoint)<1.0e-4) {
        data.startpoint.move(offset);
@@ -666,6 +757,18 @@ void RS_Polyline::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
 }
 
 void RS_Polyline::revertDirection() {
+    if (m_flat && !m_vertices.empty()) {
+        // the bulge of a segment is kept by its reversed start vertex, negated
+        const size_t n = m_vertices.size();
+        std::vector<double> bulges(n, 0.);
+        for (size_t i = 0; i + 1 < n; ++i)
+            bulges[i] = -m_bulges[n - 2 - i];
+        if (isClosed())
+            bulges[n - 1] = -m_bulges[n - 1];
+        std::reverse(m_vertices.begin(), m_vertices.end());
+        m_bulges = std::move(bulges);
+        nextBulge = m_bulges.back();
+    }
 	RS_EntityContainer::revertDirection();
 	RS_Vector tmp = data.startpoint;
 	data.startpoint = data.endpoint;
@@ -676,6 +779,7 @@ void RS_Polyline::stretch(const RS_Vector& firstCorner,
                           const RS_Vector& secondCorner,
                           const RS_Vector& offset) {
 
+    materializeEntities();
     if (data.startpoint.isInWindow(firstCorner, secondCorner)) {
         data.startpoint.move(offset);
     }
@@ -687,6 +791,264 @@ void RS_Polyline::stretch(const RS_Vector& firstCorner,
     calculateBorders();
 }
 
+bool RS_Polyline::hasClosingSegment() const
+{
+    return isClosed() && m_vertices.size() >= 2
+            && RS_PolylineSegment{m_vertices.back(), m_vertices.front(), m_bulges.back()}.getLength() > 1.0E-4;
+}
+
+RS_PolylineSegment RS_Polyline::getSegment(unsigned index) const
+{
+    assert(m_flat && index < count());
+    const unsigned next = index + 1 < m_vertices.size() ? index + 1 : 0;
+    return {m_vertices[index], m_vertices[next], m_bulges[index]};
+}
+
+void RS_Polyline::materializeEntities() const
+{
+    if (!m_flat)
+        return;
+    const unsigned segments = count();
+    m_flat = false;
+
+    auto* self = const_cast<RS_Polyline*>(this);
+    // keep the borders, they are the same
+    const RS_Vector minBorder = minV;
+    const RS_Vector maxBorder = maxV;
+    self->setAutoUpdateBorders(false);
+    self->reserveEntities(int(segments));
+    for (unsigned i = 0; i < segments; ++i) {
+        const unsigned next = i + 1 < m_vertices.size() ? i + 1 : 0;
+        const RS_PolylineSegment segment{m_vertices[i], m_vertices[next], m_bulges[i]};
+        RS_Entity* entity = segment.isArc()
+                ? static_cast<RS_Entity*>(new RS_Arc(self, segment.getArcData()))
+                : new RS_Line(self, segment.start, segment.end);
+        entity->setSelected(isSelected());
+        entity->setPen(RS_Pen(RS2::FlagInvalid));
+        entity->setLayer(nullptr);
+        self->RS_EntityContainer::addEntity(entity);
+        if (next == 0)
+            self->closingEntity = entity;
+    }
+    self->setAutoUpdateBorders(true);
+    self->minV = minBorder;
+    self->maxV = maxBorder;
+    m_vertices = {};
+    m_bulges = {};
+}
+
+unsigned RS_Polyline::count() const
+{
+    if (!m_flat)
+        return RS_EntityContainer::count();
+    return m_vertices.empty() ? 0 : unsigned(m_vertices.size() - 1) + (hasClosingSegment() ? 1 : 0);
+}
+
+unsigned RS_Polyline::countDeep() const
+{
+    if (!m_flat)
+        return RS_EntityContainer::countDeep();
+    return count();
+}
+
+double RS_Polyline::getLength() const
+{
+    if (!m_flat)
+        return RS_EntityContainer::getLength();
+    double length = 0.;
+    for (unsigned i = 0; i < count(); ++i)
+        length += getSegment(i).getLength();
+    return length;
+}
+
+void RS_Polyline::calculateBorders()
+{
+    if (!m_flat) {
+        RS_EntityContainer::calculateBorders();
+        return;
+    }
+    resetBorders();
+    for (unsigned i = 0; i < count(); ++i) {
+        const RS_PolylineSegment segment = getSegment(i);
+        if (segment.isArc()) {
+            const RS_Arc arc{nullptr, segment.getArcData()};
+            minV = RS_Vector::minimum(minV, arc.getMin());
+            maxV = RS_Vector::maximum(maxV, arc.getMax());
+        } else {
+            minV = RS_Vector::minimum(minV, RS_Vector::minimum(segment.start, segment.end));
+            maxV = RS_Vector::maximum(maxV, RS_Vector::maximum(segment.start, segment.end));
+        }
+    }
+}
+
+void RS_Polyline::forcedCalculateBorders()
+{
+    if (m_flat)
+        calculateBorders();
+    else
+        RS_EntityContainer::forcedCalculateBorders();
+}
+
+RS_Vector RS_Polyline::getNearestEndpoint(const RS_Vector& coord, double* dist) const
+{
+    if (!m_flat || count() == 0)
+        return RS_EntityContainer::getNearestEndpoint(coord, dist);
+    const auto nearest = std::min_element(m_vertices.cbegin(), m_vertices.cend(),
+                                          [&coord](const RS_Vector& v0, const RS_Vector& v1) {
+        return coord.squaredTo(v0) < coord.squaredTo(v1);
+    });
+    if (dist != nullptr)
+        *dist = coord.distanceTo(*nearest);
+    return *nearest;
+}
+
+RS_Vector RS_Polyline::getNearestPointOnEntity(const RS_Vector& coord, bool onEntity,
+                                               double* dist, RS_Entity** entity) const
+{
+    // the segment entities are created, if they are requested
+    if (!m_flat || entity != nullptr || count() == 0)
+        return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
+    double minDist = RS_MAXDOUBLE;
+    RS_Vector point(false);
+    for (unsigned i = 0; i < count(); ++i) {
+        const RS_PolylineSegment segment = getSegment(i);
+        double curDist = RS_MAXDOUBLE;
+        RS_Vector curPoint;
+        if (segment.isArc())
+            curPoint = RS_Arc{nullptr, segment.getArcData()}.getNearestPointOnEntity(coord, onEntity, &curDist);
+        else
+            curPoint = RS_Line{nullptr, segment.start, segment.end}.getNearestPointOnEntity(coord, onEntity, &curDist);
+        if (curPoint.valid && curDist < minDist) {
+            minDist = curDist;
+            point = curPoint;
+        }
+    }
+    if (dist != nullptr)
+        *dist = minDist;
+    return point;
+}
+
+double RS_Polyline::getDistanceToPoint(const RS_Vector& coord, RS_Entity** entity,
+                                       RS2::ResolveLevel level, double solidDist) const
+{
+    // the segment entities are created, if they are requested
+    if (!m_flat || entity != nullptr)
+        return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+    double minDist = RS_MAXDOUBLE;
+    for (unsigned i = 0; i < count(); ++i) {
+        const RS_PolylineSegment segment = getSegment(i);
+        const double curDist = segment.isArc()
+                ? RS_Arc{nullptr, segment.getArcData()}.getDistanceToPoint(coord)
+                : lineDistance(segment.start, segment.end, coord);
+        minDist = std::min(minDist, curDist);
+    }
+    return minDist;
+}
+
+unsigned RS_Polyline::countSelected(bool deep, QList<RS2::EntityType> const& types)
+{
+    if (!m_flat)
+        return RS_EntityContainer::countSelected(deep, types);
+    // the segments are selected along with the polyline
+    if (!isSelected())
+        return 0;
+    unsigned c = 0;
+    for (unsigned i = 0; i < count(); ++i) {
+        const RS2::EntityType type = getSegment(i).isArc() ? RS2::EntityArc : RS2::EntityLine;
+        if (types.isEmpty() || types.contains(type))
+            ++c;
+    }
+    return c;
+}
+
+double RS_Polyline::totalSelectedLength()
+{
+    if (!m_flat)
+        return RS_EntityContainer::totalSelectedLength();
+    return isSelected() ? getLength() : 0.;
+}
+
+void RS_Polyline::selectWindow(enum RS2::EntityType typeToSelect, RS_Vector v1, RS_Vector v2,
+                               bool select, bool cross)
+{
+    materializeEntities();
+    RS_EntityContainer::selectWindow(typeToSelect, v1, v2, select, cross);
+}
+
+RS_Entity* RS_Polyline::firstEntity(RS2::ResolveLevel level) const
+{
+    materializeEntities();
+    return RS_EntityContainer::firstEntity(level);
+}
+
+RS_Entity* RS_Polyline::lastEntity(RS2::ResolveLevel level) const
+{
+    materializeEntities();
+    return RS_EntityContainer::lastEntity(level);
+}
+
+RS_Entity* RS_Polyline::entityAt(int index)
+{
+    materializeEntities();
+    return RS_EntityContainer::entityAt(index);
+}
+
+int RS_Polyline::findEntity(RS_Entity const* const entity)
+{
+    materializeEntities();
+    return RS_EntityContainer::findEntity(entity);
+}
+
+RS_Vector RS_Polyline::getNearestCenter(const RS_Vector& coord, double* dist) const
+{
+    materializeEntities();
+    return RS_EntityContainer::getNearestCenter(coord, dist);
+}
+
+RS_Vector RS_Polyline::getNearestMiddle(const RS_Vector& coord, double* dist,
+                                        int middlePoints) const
+{
+    materializeEntities();
+    return RS_EntityContainer::getNearestMiddle(coord, dist, middlePoints);
+}
+
+RS_Vector RS_Polyline::getNearestDist(double distance, const RS_Vector& coord,
+                                      double* dist) const
+{
+    materializeEntities();
+    return RS_EntityContainer::getNearestDist(distance, coord, dist);
+}
+
+bool RS_Polyline::optimizeContours()
+{
+    materializeEntities();
+    return RS_EntityContainer::optimizeContours();
+}
+
+bool RS_Polyline::hasEndpointsWithinWindow(const RS_Vector& v1, const RS_Vector& v2)
+{
+    materializeEntities();
+    return RS_EntityContainer::hasEndpointsWithinWindow(v1, v2);
+}
+
+void RS_Polyline::moveSelectedRef(const RS_Vector& ref, const RS_Vector& offset)
+{
+    materializeEntities();
+    RS_EntityContainer::moveSelectedRef(ref, offset);
+}
+
+RS_Entity& RS_Polyline::shear(double k)
+{
+    materializeEntities();
+    return RS_EntityContainer::shear(k);
+}
+
+double RS_Polyline::areaLineIntegral() const
+{
+    materializeEntities();
+    return RS_EntityContainer::areaLineIntegral();
+}
+
 
 /**
  * Slightly optimized drawing for polylines.
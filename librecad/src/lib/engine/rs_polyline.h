@@ -29,9 +29,11 @@
 #define RS_POLYLINE_H
 
 #include <memory>
+#include <vector>
 #include "rs_entity.h"
 #include "rs_entitycontainer.h"
 
+struct RS_ArcData;
 
 
 /**
@@ -49,6 +51,21 @@ struct RS_PolylineData : public RS_Flags {
 
 std::ostream& operator << (std::ostream& os, const RS_PolylineData& pd);
 
+/**
+ * A segment of a polyline, from a vertex to the next one, see RS_Polyline::getSegment().
+ */
+struct RS_PolylineSegment {
+    RS_Vector start;
+    RS_Vector end;
+    //! the bulge of an arc, 0 for a line (see DXF documentation)
+    double bulge = 0.;
+
+    bool isArc() const;
+    //! the arc of an arc segment
+    RS_ArcData getArcData() const;
+    double getLength() const;
+};
+
 /**
  * Class for a poly line entity (lots of connected lines and arcs).
  *
@@ -115,6 +132,28 @@ public:
 	void setNextBulge(double bulge) {
                 nextBulge = bulge;
         }
+
+    /**
+     * @brief isFlat whether the vertices are kept in flat arrays of points and bulges,
+     * as polylines are imported by appendVertexs(). The segments are drawn, measured,
+     * picked and transformed from the arrays. The segment entities are created on
+     * demand, when the polyline is traversed, edited or its segments are picked,
+     * which is not thread safe, as for RS_Insert::isInstanced().
+     */
+    bool isFlat() const {
+        return m_flat;
+    }
+    //! the segment at the index of a flat polyline, index < count()
+    RS_PolylineSegment getSegment(unsigned index) const;
+    //! the number of vertices of a flat polyline
+    unsigned countVertices() const {
+        return unsigned(m_vertices.size());
+    }
+    //! the vertices of a flat polyline
+    const std::vector<RS_Vector>& getVertices() const {
+        return m_vertices;
+    }
+
 	void addEntity(RS_Entity* entity) override;
 	//void addSegment(RS_Entity* entity) override;
 	void removeLastVertex();
@@ -139,16 +178,69 @@ public:
 	void draw(RS_Painter* painter, RS_GraphicView* view,
 					  double& patternOffset) override;
 
+    //! \{ computed from the arrays of a flat polyline
+    unsigned count() const override;
+    unsigned countDeep() const override;
+    double getLength() const override;
+    void calculateBorders() override;
+    void forcedCalculateBorders() override;
+    using RS_EntityContainer::getNearestEndpoint;
+    RS_Vector getNearestEndpoint(const RS_Vector& coord,
+                                 double* dist = nullptr) const override;
+    RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+                                      bool onEntity = true,
+                                      double* dist = nullptr,
+                                      RS_Entity** entity=nullptr) const override;
+    double getDistanceToPoint(const RS_Vector& coord,
+                              RS_Entity** entity,
+                              RS2::ResolveLevel level=RS2::ResolveNone,
+                              double solidDist = RS_MAXDOUBLE) const override;
+    unsigned countSelected(bool deep=true, QList<RS2::EntityType> const& types = {}) override;
+    double totalSelectedLength() override;
+    //! \}
+
+    //! \{ create the entities of a flat polyline, and use the container methods
+    void selectWindow(enum RS2::EntityType typeToSelect, RS_Vector v1, RS_Vector v2,
+                      bool select=true, bool cross=false) override;
+    RS_Entity* firstEntity(RS2::ResolveLevel level=RS2::ResolveNone) const override;
+    RS_Entity* lastEntity(RS2::ResolveLevel level=RS2::ResolveNone) const override;
+    RS_Entity* entityAt(int index) override;
+    int findEntity(RS_Entity const* const entity) override;
+    RS_Vector getNearestCenter(const RS_Vector& coord,
+                               double* dist = nullptr) const override;
+    RS_Vector getNearestMiddle(const RS_Vector& coord,
+                               double* dist = nullptr,
+                               int middlePoints = 1) const override;
+    RS_Vector getNearestDist(double distance,
+                             const RS_Vector& coord,
+                             double* dist = nullptr) const override;
+    bool optimizeContours() override;
+    bool hasEndpointsWithinWindow(const RS_Vector& v1, const RS_Vector& v2) override;
+    void moveSelectedRef(const RS_Vector& ref, const RS_Vector& offset) override;
+    RS_Entity& shear(double k) override;
+    double areaLineIntegral() const override;
+    //! \}
+
     friend std::ostream& operator << (std::ostream& os, const RS_Polyline& l);
 
 protected:
     std::unique_ptr<RS_Entity> createVertex(const RS_Vector& v,
                 double bulge=0.0, bool prepend=false);
+    void materializeEntities() const override;
 
 protected:
     RS_PolylineData data;
     RS_Entity* closingEntity = nullptr;
     double nextBulge = 0.;
+
+private:
+    // whether the closing segment of a flat polyline is long enough to be kept
+    bool hasClosingSegment() const;
+
+    // the vertices and the bulges of the segments starting at them, see isFlat()
+    mutable bool m_flat = false;
+    mutable std::vector<RS_Vector> m_vertices;
+    mutable std::vector<double> m_bulges;
 };
 
 #endif
@@ -25,11 +25,28 @@
 **********************************************************************/
 
 // RVT_PORT changed QSettings s(QSettings::Ini) to QSettings s("./qcad.ini", QSettings::IniFormat);
+#include <mutex>
+
+#include <QRegularExpression>
 #include <QSettings>
 
 #include "rs_debug.h"
 #include "rs_settings.h"
 
+namespace {
+// the group is kept per thread, so settings may be read by concurrent threads,
+// like the workers of dxf2pdf
+thread_local QString threadGroup;
+
+// @return the key in the current group with a leading and single separators, as "/Group/Key"
+QString fullKey(const QString& key) {
+    QString full = "/" + threadGroup + "/" + key;
+    static const QRegularExpression separators("/{2,}");
+    full.replace(separators, "/");
+    return full;
+}
+}
+
 RS_Settings::GroupGuard::GroupGuard(QString group): m_group{std::move(group)}
 {}
 
@@ -68,27 +85,34 @@ RS_Settings* RS_Settings::instance() {
 void RS_Settings::init(const QString& companyKey,
                        const QString& appKey) {
 
-    m_group = "";
+    threadGroup = "";
 	
     this->companyKey = companyKey;
     this->appKey = appKey;
 
     //insertSearchPath(QSettings::Windows, companyKey + appKey);
     //insertSearchPath(QSettings::Unix, "/usr/share/");
+
+    // read all settings once
+    std::lock_guard<std::mutex> lock(m_mutex);
+    cache.clear();
+    QSettings s(companyKey, appKey);
+    for (const QString& key: s.allKeys())
+        cache[fullKey(key)] = s.value(key);
     initialized = true;
 }
 
 void RS_Settings::beginGroup(QString group) {
-    m_group = std::move(group);
+    threadGroup = std::move(group);
 }
 
 void RS_Settings::endGroup() {
-    m_group.clear();
+    threadGroup.clear();
 }
 
 std::unique_ptr<RS_Settings::GroupGuard> RS_Settings::beginGroupGuard(QString group) {
-    auto guard = std::make_unique<RS_Settings::GroupGuard>(std::move(m_group));
-    m_group = std::move(group);
+    auto guard = std::make_unique<RS_Settings::GroupGuard>(std::move(threadGroup));
+    threadGroup = std::move(group);
     return guard;
 }
 
@@ -105,104 +129,83 @@ bool RS_Settings::writeEntry(const QString& key, double value) {
 }
 
 bool RS_Settings::writeEntry(const QString& key, const QVariant& value) {
+    const QString full = fullKey(key);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Skip writing operations if the key is found in the cache and
+        // its value is the same as the new one (it was already written).
+        auto it = cache.find(full);
+        if (it != cache.end() && it->second == value) {
+            return true;
+        }
 
-    // Skip writing operations if the key is found in the cache and
-    // its value is the same as the new one (it was already written).
-    QVariant ret = readEntryCache(key);
-    if (ret.isValid() && ret == value) {
-        return true;
-    }
-
-	QSettings s(companyKey, appKey);
-    // RVT_PORT not supported anymore s.insertSearchPath(QSettings::Windows, companyKey);
+        QSettings s(companyKey, appKey);
+        // RVT_PORT not supported anymore s.insertSearchPath(QSettings::Windows, companyKey);
 
-    s.setValue(QString("%1%2").arg(m_group).arg(key), value);
-	cache[key]=value;
+        s.setValue(full, value);
+        cache[full]=value;
+    }
 
+    emit optionChanged(full, value);
     return true;
 }
 
 QString RS_Settings::readEntry(const QString& key,
                                  const QString& def,
                                  bool* ok) {
-	
-    // lookup:
-    QVariant ret = readEntryCache(key);
-    if (!ret.isValid()) {
-				
-        QSettings s(companyKey, appKey);
-    	// RVT_PORT not supported anymore s.insertSearchPath(QSettings::Windows, companyKey);
-		
-		if (ok) {
-            *ok=s.contains(QString("%1%2").arg(m_group).arg(key));
-		}
-		
-        ret = s.value(QString("%1%2").arg(m_group).arg(key), QVariant(def));
-		cache[key]=ret;
-    }
-
-    return ret.toString();
-
+    return readEntryCache(key, QVariant(def), ok).toString();
 }
 
 QByteArray RS_Settings::readByteArrayEntry(const QString& key,
                     const QString& def,
                     bool* ok) {
-    QVariant ret = readEntryCache(key);
-    if (!ret.isValid()) {
-
-        QSettings s(companyKey, appKey);
-        // RVT_PORT not supported anymore s.insertSearchPath(QSettings::Windows, companyKey);
-
-                if (ok) {
-                        *ok=s.contains(QString("%1%2").arg(m_group).arg(key));
-                }
-
-        ret = s.value(QString("%1%2").arg(m_group).arg(key), QVariant(def));
-		cache[key]=ret;
-    }
-
-    return ret.toByteArray();
-
+    return readEntryCache(key, QVariant(def), ok).toByteArray();
 }
 
 int RS_Settings::readNumEntry(const QString& key, int def)
 {
-	QVariant value = readEntryCache(key);
-	if (!value.isValid())
-	{
-		QSettings s(companyKey, appKey);
-        QString str = QString("%1%2").arg(m_group).arg(key);
-		// qDebug() << str;
-		value = s.value(str, QVariant(def));
-		cache[key] = value;
-	}
+    QVariant value = readEntryCache(key, QVariant(def), nullptr);
     unsigned long long uValue = value.toULongLong();
     uValue = uValue % 0x80000000ull;
     return int(uValue);
 }
 
 
-QVariant RS_Settings::readEntryCache(const QString& key) {
-	if(!cache.count(key)) return QVariant();
-	return cache[key];
-}
-
-
-void RS_Settings::addToCache(const QString& key, const QVariant& value) {
-    cache[key]=value;
+/**
+ * @return the value of the key in the current group from the snapshot, or def
+ * if there is no such entry. Before init(), the value is read from the settings.
+ */
+QVariant RS_Settings::readEntryCache(const QString& key, const QVariant& def, bool* ok) {
+    const QString full = fullKey(key);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = cache.find(full);
+    if (it == cache.end() && !initialized) {
+        QSettings s(companyKey, appKey);
+        if (s.contains(full))
+            it = cache.emplace(full, s.value(full)).first;
+    }
+    if (ok)
+        *ok = it != cache.end();
+    return it != cache.end() ? it->second : def;
 }
 
 void RS_Settings::clear_all()
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     QSettings s(companyKey, appKey);
     s.clear();
+    cache.clear();
     save_is_allowed = false;
 }
 
 void RS_Settings::clear_geometry()
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     QSettings s(companyKey, appKey);
     s.remove("/Geometry");
+    auto it = cache.lower_bound("/Geometry/");
+    while (it != cache.end() && it->first.startsWith("/Geometry/"))
+        it = cache.erase(it);
     save_is_allowed = false;
 }
@@ -30,10 +30,11 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 
+#include <QObject>
 #include <QString>
-
-class QVariant;
+#include <QVariant>
 
 
 // ---------------------------------------------------------------------------
@@ -46,9 +47,13 @@ class QVariant;
  * Please note that the Qt default implementation doesn't
  * work as one would expect. That's why this class overwrites
  * most of the default behaviour.
- * 
+ *
+ * All settings are read into memory once by init(), reads are served from
+ * this snapshot and writes update it, so reading settings in hot paths
+ * doesn't access the configuration file or the registry.
  */
-class RS_Settings {
+class RS_Settings : public QObject {
+    Q_OBJECT
 
 public:
 
@@ -109,19 +114,27 @@ public:
     void clear_geometry();
     static bool save_is_allowed;
 
+signals:
+    /**
+     * Emitted when an entry is written with a new value.
+     * @param key the full key of the entry, including the group, e.g. "/Appearance/ScaleGrid"
+     */
+    void optionChanged(const QString& key, const QVariant& value);
+
 private:
     RS_Settings();
 	RS_Settings(RS_Settings const&) = delete;
 	RS_Settings& operator = (RS_Settings const&) = delete;
-	QVariant readEntryCache(const QString& key);
-	void addToCache(const QString& key, const QVariant& value);
+	QVariant readEntryCache(const QString& key, const QVariant& def, bool* ok);
 
 protected:
 
+    //! snapshot of all settings, by full key
 	std::map<QString, QVariant> cache;
     QString companyKey;
     QString appKey;
-    QString m_group;
+    //! guards the cache for concurrent threads
+    std::mutex m_mutex;
     bool initialized = false;
 };
 
@@ -27,6 +27,8 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <numeric>
 
 #include "rs_spline.h"
@@ -193,19 +195,9 @@ void RS_Spline::update() {
         RS_DEBUG->print(RS_Debug::D_NOTICE, "%s: controlPoints: size=%llu\n", __func__, data.controlPoints.size());
     }
 
-	const size_t npts = tControlPoints.size();
-    // order:
-    const size_t  k = data.degree + 1;
     // resolution:
-	const size_t  p1 = getGraphicVariableInt("$SPLINESEGS", 8) * npts;
-
-	std::vector<double> h(npts+1, 1.);
-	std::vector<RS_Vector> p(p1, {0., 0.});
-    if (data.closed) {
-		rbsplinu(npts,k,p1,tControlPoints,h,p);
-    } else {
-		rbspline(npts,k,p1,tControlPoints,h,p);
-    }
+	const size_t  p1 = getGraphicVariableInt("$SPLINESEGS", 8) * tControlPoints.size();
+	const std::vector<RS_Vector> p = evaluate(p1);
 
 	RS_Vector prev{};
 	for (auto const& vp: p) {
@@ -221,6 +213,116 @@ void RS_Spline::update() {
 	}
 }
 
+/**
+ * @return p1 points of the spline, equally spaced in the parameter
+ */
+std::vector<RS_Vector> RS_Spline::evaluate(size_t p1) const
+{
+	const size_t npts = data.controlPoints.size();
+	// order:
+	const size_t k = data.degree + 1;
+
+	std::vector<double> h(npts+1, 1.);
+	std::vector<RS_Vector> p(p1, {0., 0.});
+	if (data.closed) {
+		rbsplinu(npts,k,p1,data.controlPoints.get(),h,p);
+	} else {
+		rbspline(npts,k,p1,data.controlPoints.get(),h,p);
+	}
+	return p;
+}
+
+/**
+ * @return the number of points for the chords between them to deviate from the
+ * spline by at most tolerance: the deviation is bounded by the second derivative,
+ * itself bounded by the control points of the second derivative spline.
+ */
+size_t RS_Spline::getFlatteningResolution(double tolerance) const
+{
+	const size_t npts = data.controlPoints.size();
+	const size_t segs = getGraphicVariableInt("$SPLINESEGS", 8);
+	const size_t minPoints = std::max<size_t>(npts, 2);
+	const size_t maxPoints = flatteningMaxPointsPerControlPoint * npts;
+	const int d = data.degree;
+	if (d < 2) {
+		// the chords match the control polygon only through the knots
+		return segs * npts;
+	}
+
+	const std::vector<double> x = data.closed ? knotu(npts, d + 1) : knot(npts, d + 1);
+	const std::vector<RS_Vector>& b = data.controlPoints;
+	double maxSecondDerivative = 0.;
+	for (size_t i = 0; i + 2 < npts; ++i) {
+		const double a1 = x[i + d + 1] - x[i + 1];
+		const double a2 = x[i + d + 2] - x[i + 2];
+		const double c = x[i + d + 1] - x[i + 2];
+		if (a1 <= RS_TOLERANCE || a2 <= RS_TOLERANCE || c <= RS_TOLERANCE)
+			continue;
+		const RS_Vector q = ((b[i + 2] - b[i + 1]) / a2 - (b[i + 1] - b[i]) / a1) * (d * (d - 1) / c);
+		maxSecondDerivative = std::max(maxSecondDerivative, q.magnitude());
+	}
+	if (maxSecondDerivative < RS_TOLERANCE)
+		return minPoints;
+
+	const double range = data.closed ? double(npts - d) : x.back() - x.front();
+	const double step = std::sqrt(8. * tolerance / maxSecondDerivative);
+	const double points = std::ceil(range / step) + 1.;
+	if (!(points < double(maxPoints)))
+		return maxPoints;
+	return std::max(minPoints, size_t(points));
+}
+
+/**
+ * The flattened splines for the tolerances used, and the spline data they are for.
+ */
+struct RS_Spline::FlatteningCache {
+	RS_SplineData data;
+	std::map<int, std::shared_ptr<const std::vector<RS_Vector>>> levels;
+
+	bool isFor(const RS_SplineData& d) const
+	{
+		return data.degree == d.degree && data.closed == d.closed
+				&& data.controlPoints == d.controlPoints && data.knotslist == d.knotslist;
+	}
+};
+
+/**
+ * @return points of the spline, for the chords between them to deviate from the
+ * spline by at most about tolerance. The points are cached for the tolerance
+ * rounded down to a power of two, for as long as the spline isn't changed.
+ * @param cache false to only use already cached points, as draw() does while
+ * the view is drawing concurrently
+ */
+std::shared_ptr<const std::vector<RS_Vector>> RS_Spline::getFlattened(double tolerance, bool cache) const
+{
+	if (isUndone() || data.degree < 1 || data.degree > 3
+			|| (!data.closed && data.controlPoints.size() < size_t(data.degree)+1)
+			|| data.controlPoints.size() < 3)
+		return std::make_shared<const std::vector<RS_Vector>>();
+
+	const int level = (std::isfinite(tolerance) && tolerance > 0.)
+			? std::clamp(int(std::floor(std::log2(tolerance))), -60, 60) : 0;
+	if (m_flatteningCache != nullptr && m_flatteningCache->isFor(data)) {
+		auto it = m_flatteningCache->levels.find(level);
+		if (it != m_flatteningCache->levels.end())
+			return it->second;
+	}
+
+	auto points = std::make_shared<const std::vector<RS_Vector>>(
+				evaluate(getFlatteningResolution(std::ldexp(1., level))));
+	if (cache) {
+		if (m_flatteningCache == nullptr || !m_flatteningCache->isFor(data)) {
+			// a new cache, as it's shared with the copies of the spline
+			m_flatteningCache = std::make_shared<FlatteningCache>();
+			m_flatteningCache->data = data;
+		}
+		if (m_flatteningCache->levels.size() >= flatteningMaxLevels)
+			m_flatteningCache->levels.clear();
+		m_flatteningCache->levels.emplace(level, points);
+	}
+	return points;
+}
+
 RS_Vector RS_Spline::getStartpoint() const {
    if (data.closed) return RS_Vector(false);
    return static_cast<RS_Line*>(const_cast<RS_Spline*>(this)->firstEntity())->getStartpoint();
@@ -312,9 +414,7 @@ RS_Vector RS_Spline::getNearestDist(double /*distance*/,
 
 void RS_Spline::move(const RS_Vector& offset) {
     RS_EntityContainer::move(offset);
-	for (RS_Vector& vp: data.controlPoints) {
-		vp.move(offset);
-    }
+	RS_Vector::move(data.controlPoints, offset);
 }
 
 
@@ -327,34 +427,26 @@ void RS_Spline::rotate(const RS_Vector& center, const double& angle) {
 
 void RS_Spline::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
 	RS_EntityContainer::rotate(center, angleVector);
-	for (RS_Vector& vp: data.controlPoints) {
-		vp.rotate(center, angleVector);
-	}
+	RS_Vector::rotate(data.controlPoints, center, angleVector);
 //    update();
 }
 
 void RS_Spline::scale(const RS_Vector& center, const RS_Vector& factor) {
-	for (RS_Vector& vp: data.controlPoints) {
-		vp.scale(center, factor);
-	}
+	RS_Vector::scale(data.controlPoints, center, factor);
 
     update();
 }
 
 RS_Entity& RS_Spline::shear(double k)
 {
-    for (RS_Vector& vp: data.controlPoints) {
-        vp.shear(k);
-    }
+    RS_Vector::shear(data.controlPoints, k);
 
     update();
     return *this;
 }
 
 void RS_Spline::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
-	for (RS_Vector& vp: data.controlPoints) {
-		vp.mirror(axisPoint1, axisPoint2);
-	}
+	RS_Vector::mirror(data.controlPoints, axisPoint1, axisPoint2);
 
 	update();
 }
@@ -28,7 +28,9 @@
 #ifndef RS_SPLINE_H
 #define RS_SPLINE_H
 
+#include <memory>
 #include <vector>
+#include "lc_sharedvector.h"
 #include "rs_entitycontainer.h"
 
 /**
@@ -47,9 +49,9 @@ struct RS_SplineData {
     int degree = 3;
 	/** Closed flag. */
     bool closed = false;
-	/** Control points of the spline. */
-	std::vector<RS_Vector> controlPoints;
-	std::vector<double> knotslist;
+	/** Control points of the spline, shared by copies until changed. */
+	LC_SharedVector<RS_Vector> controlPoints;
+	LC_SharedVector<double> knotslist;
 };
 
 std::ostream& operator << (std::ostream& os, const RS_SplineData& ld);
@@ -146,6 +148,7 @@ public:
 
 		void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
 		const std::vector<RS_Vector>& getControlPoints() const;
+		std::shared_ptr<const std::vector<RS_Vector>> getFlattened(double tolerance, bool cache = true) const;
 
         friend std::ostream& operator << (std::ostream& os, const RS_Spline& l);
 
@@ -154,6 +157,13 @@ public:
         friend class RS_FilterDXFRW;
 
 private:
+		// the number of zoom levels the flattened spline is cached for
+		static constexpr size_t flatteningMaxLevels = 4;
+		static constexpr size_t flatteningMaxPointsPerControlPoint = 64;
+		struct FlatteningCache;
+
+		std::vector<RS_Vector> evaluate(size_t p1) const;
+		size_t getFlatteningResolution(double tolerance) const;
 		std::vector<double> knot(size_t num, size_t order) const;
 		void rbspline(size_t npts, size_t k, size_t p1,
 		              const std::vector<RS_Vector>& b,
@@ -174,6 +184,8 @@ private:
          */
         bool hasWrappedControlPoints() const;
 
+		mutable std::shared_ptr<FlatteningCache> m_flatteningCache;
+
 protected:
 		RS_SplineData data;
 }
@@ -26,16 +26,31 @@
 
 #include<iostream>
 #include<cmath>
+#include <QBrush>
+#include <QSet>
+#include <QTransform>
 #include "rs_font.h"
+#include "rs_fontchar.h"
 #include "rs_text.h"
 
+#include "lc_regenstatistics.h"
+#include "lc_trace.h"
 #include "rs_fontlist.h"
+#include "lc_taskscheduler.h"
 #include "rs_insert.h"
 #include "rs_math.h"
 #include "rs_debug.h"
 #include "rs_graphicview.h"
+#include "rs_mtext.h"
 #include "rs_painter.h"
 
+namespace {
+// from this number of texts on, texts are laid out concurrently
+constexpr std::size_t parallelLayoutMinimum = 64;
+// least texts of a task of the concurrent layout
+constexpr std::size_t parallelLayoutGrain = 16;
+}
+
 RS_TextData::RS_TextData(const RS_Vector& _insertionPoint,
 						 const RS_Vector& _secondPoint,
 						 double _height,
@@ -245,6 +260,33 @@ int RS_Text::getNumberOfLines() {
 }
 
 
+void RS_Text::updateAll(const std::vector<RS_Entity*>& texts)
+{
+    // the fonts are loaded before, the layout then only creates missing glyphs
+    QSet<QString> styles;
+    for (const RS_Entity* e: texts) {
+        if (e->rtti() == RS2::EntityText)
+            styles.insert(static_cast<const RS_Text*>(e)->getStyle());
+        else if (e->rtti() == RS2::EntityMText)
+            styles.insert(static_cast<const RS_MText*>(e)->getStyle());
+    }
+    for (const QString& style: styles)
+        RS_FONTLIST->requestFont(style);
+
+    if (texts.size() < parallelLayoutMinimum) {
+        for (RS_Entity* e: texts)
+            e->update();
+        return;
+    }
+    RS_DEBUG->print("RS_Text::updateAll: %zu texts in %d styles", texts.size(), int(styles.size()));
+    LC_TaskScheduler::instance().parallelFor(0, texts.size(), parallelLayoutGrain,
+                                             [&texts](std::size_t begin, std::size_t end) {
+        // the reasons of the calling thread are not known to workers
+        LC_REGEN_REASON("text layout");
+        for (std::size_t i = begin; i < end; ++i)
+            texts[i]->update();
+    });
+}
 
 
 /**
@@ -253,10 +295,16 @@ int RS_Text::getNumberOfLines() {
  * This method also updates the usedTextWidth / usedTextHeight property.
  */
 void RS_Text::update() {
+    LC_TRACE_ZONE("RS_Text::update");
+    const LC_RegenStatistics::Regen regen{LC_RegenStatistics::Text};
 
-    RS_DEBUG->print("RS_Text::update");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Text::update");
 
+    m_compact = false;
     clear();
+    glyphPath = QPainterPath{};
+    // the index is created for the final glyph positions
+    setSpatialIndexEnabled(false);
 
     if (isUndone()) {
         return;
@@ -289,34 +337,39 @@ void RS_Text::update() {
         } else {
             // One Letter:
             QString letterText = QString(data.text.at(i));
-            if (font->findLetter(letterText) == NULL) {
-                RS_DEBUG->print("RS_Text::update: missing font for letter( %s ), replaced it with QChar(0xfffd)",qPrintable(letterText));
+            const RS_Font::Glyph* glyph = font->findGlyph(letterText);
+            if (glyph == nullptr) {
+                RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Text::update: missing font for letter( %s ), replaced it with QChar(0xfffd)",qPrintable(letterText));
                 letterText = QChar(0xfffd);
+                glyph = font->findGlyph(letterText);
             }
-            RS_DEBUG->print("RS_Text::update: insert a "
+            RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Text::update: insert a "
                             "letter at pos: %f/%f", letterPos.x, letterPos.y);
 
-            RS_InsertData d(letterText,
-                            letterPos,
-                            RS_Vector(1.0, 1.0),
-                            0.0,
-                            1,1, RS_Vector(0.0,0.0),
-                            font->getLetterList(), RS2::NoUpdate);
-
-            RS_Insert* letter = new RS_Insert(this, d);
-            RS_Vector letterWidth;
-            letter->setPen(RS_Pen(RS2::FlagInvalid));
-            letter->setLayer(NULL);
-            letter->update();
-            letter->forcedCalculateBorders();
-
-            letterWidth = RS_Vector(letter->getMax().x-letterPos.x, 0.0);
+            // letters are instances of the shared glyph blocks, the block
+            // is set directly, as texts may be laid out concurrently
+            if (glyph != nullptr) {
+                RS_InsertData d(letterText,
+                                letterPos,
+                                RS_Vector(1.0, 1.0),
+                                0.0,
+                                1,1, RS_Vector(0.0,0.0),
+                                font->getLetterList(), RS2::NoUpdate);
+
+                RS_Insert* letter = new RS_Insert(this, d);
+                letter->setBlockForInsert(glyph->block);
+                letter->setPen(RS_Pen(RS2::FlagInvalid));
+                letter->setLayer(NULL);
+                letter->update();
+
+//                oneLine->addEntity(letter);
+                addEntity(letter);
+            }
+
+            RS_Vector letterWidth{(glyph != nullptr) ? glyph->maxV.x : -1., 0.0};
             if (letterWidth.x < 0)
                 letterWidth.x = -letterSpace.x;
 
-//            oneLine->addEntity(letter);
-            addEntity(letter);
-
             // next letter position:
             letterPos += letterWidth;
             letterPos += letterSpace;
@@ -329,7 +382,7 @@ void RS_Text::update() {
     }
     RS_Vector textSize = getSize();
 
-    RS_DEBUG->print("RS_Text::updateAddLine: width 2: %f", textSize.x);
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Text::updateAddLine: width 2: %f", textSize.x);
 
     // Vertical Align:
     double vSize = 9.0;
@@ -363,7 +416,7 @@ void RS_Text::update() {
         offset.move(RS_Vector(-textSize.x/2.0, -(vSize + textSize.y/2.0 + getMin().y) ));
         break;}
     case RS_TextData::HACenter:
-        RS_DEBUG->print("RS_Text::updateAddLine: move by: %f", -textSize.x/2.0);
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Text::updateAddLine: move by: %f", -textSize.x/2.0);
         offset.move(RS_Vector(-textSize.x/2.0, 0.0));
         break;
     case RS_TextData::HARight:
@@ -417,8 +470,182 @@ void RS_Text::update() {
     RS_EntityContainer::move(data.insertionPoint);
 
     forcedCalculateBorders();
+    // long texts are picked by the index of the glyphs
+    setSpatialIndexBySize();
+    createGlyphPath();
+
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Text::update: OK");
+}
+
+/**
+ * Combines the cached outlines of the letters, placed as the letter inserts.
+ * The path is left empty if a letter has no outline.
+ */
+void RS_Text::createGlyphPath() {
+    glyphPath = QPainterPath{};
+    QPainterPath path;
+    for (const RS_Entity* e: entities) {
+        if (e->rtti() != RS2::EntityInsert
+                || !appendGlyphPath(path, *static_cast<const RS_Insert*>(e)))
+            return;
+    }
+    glyphPath = path;
+}
+
+bool RS_Text::appendGlyphPath(QPainterPath& path, const RS_Insert& letter) {
+    const RS_Block* block = letter.getBlockForInsert();
+    if (block == nullptr || block->rtti() != RS2::EntityFontChar)
+        return false;
+    const QPainterPath& outline = static_cast<const RS_FontChar*>(block)->getPath();
+    if (outline.isEmpty())
+        return block->count() == 0;
+    const RS_InsertData d = letter.getData();
+    QTransform toLetter;
+    toLetter.translate(d.insertionPoint.x, d.insertionPoint.y);
+    toLetter.rotateRadians(d.angle);
+    toLetter.scale(d.scaleFactor.x, d.scaleFactor.y);
+    path.addPath(toLetter.map(outline));
+    return true;
+}
+
+
+bool RS_Text::compact() {
+    if (m_compact)
+        return true;
+    if (glyphPath.isEmpty() || isUndone())
+        return false;
+    m_letterCount = RS_EntityContainer::count();
+    m_letterCountDeep = RS_EntityContainer::countDeep();
+    // the borders stay those of the letters
+    const RS_Vector minBorder = minV;
+    const RS_Vector maxBorder = maxV;
+    clear();
+    setSpatialIndexEnabled(false);
+    minV = minBorder;
+    maxV = maxBorder;
+    m_compact = true;
+    return true;
+}
+
+void RS_Text::materializeEntities() const {
+    if (!m_compact)
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Text::materializeEntities: %s", qPrintable(data.text));
+    // the layout creates the same letters and borders again
+    const_cast<RS_Text*>(this)->update();
+}
+
+void RS_Text::calculateBorders() {
+    if (!m_compact)
+        RS_EntityContainer::calculateBorders();
+}
+
+void RS_Text::forcedCalculateBorders() {
+    if (!m_compact)
+        RS_EntityContainer::forcedCalculateBorders();
+}
+
+unsigned RS_Text::count() const {
+    return m_compact ? m_letterCount : RS_EntityContainer::count();
+}
+
+unsigned RS_Text::countDeep() const {
+    return m_compact ? m_letterCountDeep : RS_EntityContainer::countDeep();
+}
+
+double RS_Text::getLength() const {
+    materializeEntities();
+    return RS_EntityContainer::getLength();
+}
 
-    RS_DEBUG->print("RS_Text::update: OK");
+void RS_Text::selectWindow(enum RS2::EntityType typeToSelect, RS_Vector v1, RS_Vector v2,
+                           bool select, bool cross) {
+    materializeEntities();
+    RS_EntityContainer::selectWindow(typeToSelect, v1, v2, select, cross);
+}
+
+RS_Entity* RS_Text::firstEntity(RS2::ResolveLevel level) const {
+    materializeEntities();
+    return RS_EntityContainer::firstEntity(level);
+}
+
+RS_Entity* RS_Text::lastEntity(RS2::ResolveLevel level) const {
+    materializeEntities();
+    return RS_EntityContainer::lastEntity(level);
+}
+
+RS_Entity* RS_Text::entityAt(int index) {
+    materializeEntities();
+    return RS_EntityContainer::entityAt(index);
+}
+
+int RS_Text::findEntity(RS_Entity const* const entity) {
+    materializeEntities();
+    return RS_EntityContainer::findEntity(entity);
+}
+
+unsigned RS_Text::countSelected(bool deep, QList<RS2::EntityType> const& types) {
+    // the letters are selected along with the text
+    if (m_compact && !isSelected())
+        return 0;
+    materializeEntities();
+    return RS_EntityContainer::countSelected(deep, types);
+}
+
+double RS_Text::totalSelectedLength() {
+    if (m_compact && !isSelected())
+        return 0.;
+    materializeEntities();
+    return RS_EntityContainer::totalSelectedLength();
+}
+
+RS_Vector RS_Text::getNearestPointOnEntity(const RS_Vector& coord, bool onEntity,
+                                           double* dist, RS_Entity** entity) const {
+    materializeEntities();
+    return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
+}
+
+RS_Vector RS_Text::getNearestCenter(const RS_Vector& coord, double* dist) const {
+    materializeEntities();
+    return RS_EntityContainer::getNearestCenter(coord, dist);
+}
+
+RS_Vector RS_Text::getNearestMiddle(const RS_Vector& coord, double* dist,
+                                    int middlePoints) const {
+    materializeEntities();
+    return RS_EntityContainer::getNearestMiddle(coord, dist, middlePoints);
+}
+
+RS_Vector RS_Text::getNearestDist(double distance, const RS_Vector& coord,
+                                  double* dist) const {
+    materializeEntities();
+    return RS_EntityContainer::getNearestDist(distance, coord, dist);
+}
+
+RS_Vector RS_Text::getNearestSelectedRef(const RS_Vector& coord, double* dist) const {
+    materializeEntities();
+    return RS_EntityContainer::getNearestSelectedRef(coord, dist);
+}
+
+double RS_Text::getDistanceToPoint(const RS_Vector& coord, RS_Entity** entity,
+                                   RS2::ResolveLevel level, double solidDist) const {
+    materializeEntities();
+    return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+}
+
+void RS_Text::revertDirection() {
+    materializeEntities();
+    RS_EntityContainer::revertDirection();
+}
+
+RS_Entity& RS_Text::shear(double k) {
+    materializeEntities();
+    return RS_EntityContainer::shear(k);
+}
+
+double RS_Text::areaLineIntegral() const {
+    materializeEntities();
+    return RS_EntityContainer::areaLineIntegral();
 }
 
 
@@ -435,7 +662,9 @@ RS_VectorSolutions RS_Text::getRefPoints() const{
 }
 
 void RS_Text::move(const RS_Vector& offset) {
+    materializeEntities();
     RS_EntityContainer::move(offset);
+    glyphPath.translate(offset.x, offset.y);
     data.insertionPoint.move(offset);
     data.secondPoint.move(offset);
 //    update();
@@ -444,15 +673,19 @@ void RS_Text::move(const RS_Vector& offset) {
 
 
 void RS_Text::rotate(const RS_Vector& center, const double& angle) {
+    materializeEntities();
     RS_Vector angleVector(angle);
     RS_EntityContainer::rotate(center, angleVector);
+    createGlyphPath();
     data.insertionPoint.rotate(center, angleVector);
     data.secondPoint.rotate(center, angleVector);
     data.angle = RS_Math::correctAngle(data.angle+angle);
 //    update();
 }
 void RS_Text::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
+    materializeEntities();
     RS_EntityContainer::rotate(center, angleVector);
+    createGlyphPath();
     data.insertionPoint.rotate(center, angleVector);
     data.secondPoint.rotate(center, angleVector);
     data.angle = RS_Math::correctAngle(data.angle+angleVector.angle());
@@ -510,6 +743,18 @@ bool RS_Text::hasEndpointsWithinWindow(const RS_Vector& /*v1*/, const RS_Vector&
     return false;
 }
 
+void RS_Text::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
+    materializeEntities();
+    RS_EntityContainer::moveRef(ref, offset);
+    createGlyphPath();
+}
+
+void RS_Text::moveSelectedRef(const RS_Vector& ref, const RS_Vector& offset) {
+    materializeEntities();
+    RS_EntityContainer::moveSelectedRef(ref, offset);
+    createGlyphPath();
+}
+
 
 
 /**
@@ -551,6 +796,22 @@ void RS_Text::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternO
         }
     }
 
+    // the letters stroked as one path in the pen of the text, set by the view
+    if (!glyphPath.isEmpty()) {
+        if (isSelected() != painter->shouldDrawSelected())
+            return;
+        // the graph to screen mapping of the view, the pen width stays in pixels
+        const RS_Vector origin = view->toGui(RS_Vector{0., 0.});
+        const RS_Vector unitX = view->toGui(RS_Vector{1., 0.}) - origin;
+        const RS_Vector unitY = view->toGui(RS_Vector{0., 1.}) - origin;
+        const QTransform toGui{unitX.x, unitX.y, unitY.x, unitY.y, origin.x, origin.y};
+        const QBrush brush(painter->brush());
+        painter->setBrush(QBrush{Qt::NoBrush});
+        painter->drawPath(toGui.map(glyphPath));
+        painter->setBrush(brush);
+        return;
+    }
+
     foreach (auto e, entities)
     {
         view->drawEntity(painter, e);
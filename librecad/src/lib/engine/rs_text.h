@@ -28,8 +28,12 @@
 #ifndef RS_TEXT_H
 #define RS_TEXT_H
 
+#include <QPainterPath>
+
 #include "rs_entitycontainer.h"
 
+class RS_Insert;
+
 /**
  * Holds the data that defines a text entity.
  */
@@ -153,6 +157,28 @@ public:
     }
 
     void update() override;
+    /**
+     * Lays out the letters of texts and mtexts, concurrently for many
+     * texts. Their fonts are requested by the calling thread before.
+     */
+    static void updateAll(const std::vector<RS_Entity*>& texts);
+    /**
+     * @brief appendGlyphPath appends the cached outline of a letter, placed by
+     * the letter insert, to path.
+     * @return false if the letter has no outline, true for empty letters
+     */
+    static bool appendGlyphPath(QPainterPath& path, const RS_Insert& letter);
+    /**
+     * @brief compact releases the letters of a text drawn from its glyph path, for
+     * drawings opened read-only. The letters are laid out again on demand, when the
+     * text is traversed, snapped to or transformed, as the entities of instanced inserts
+     * @return true, if the letters were released
+     */
+    bool compact();
+    //! whether the letters are released, see compact()
+    bool isCompact() const {
+        return m_compact;
+    }
 
     int getNumberOfLines();
 
@@ -228,12 +254,52 @@ public:
                                          double* dist = NULL)const override;
      RS_VectorSolutions getRefPoints() const override;
 
+    void calculateBorders() override;
+    void forcedCalculateBorders() override;
+    unsigned count() const override;
+    unsigned countDeep() const override;
+
+    //! \{ lay out the letters of a compact text, and use the container methods
+    double getLength() const override;
+    void selectWindow(enum RS2::EntityType typeToSelect, RS_Vector v1, RS_Vector v2,
+                      bool select=true, bool cross=false) override;
+    RS_Entity* firstEntity(RS2::ResolveLevel level=RS2::ResolveNone) const override;
+    RS_Entity* lastEntity(RS2::ResolveLevel level=RS2::ResolveNone) const override;
+    RS_Entity* entityAt(int index) override;
+    int findEntity(RS_Entity const* const entity) override;
+    unsigned countSelected(bool deep=true, QList<RS2::EntityType> const& types = {}) override;
+    double totalSelectedLength() override;
+    RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+                                      bool onEntity = true,
+                                      double* dist = nullptr,
+                                      RS_Entity** entity=nullptr) const override;
+    RS_Vector getNearestCenter(const RS_Vector& coord,
+                               double* dist = nullptr) const override;
+    RS_Vector getNearestMiddle(const RS_Vector& coord,
+                               double* dist = nullptr,
+                               int middlePoints = 1) const override;
+    RS_Vector getNearestDist(double distance,
+                             const RS_Vector& coord,
+                             double* dist = nullptr) const override;
+    RS_Vector getNearestSelectedRef(const RS_Vector& coord,
+                                    double* dist = nullptr) const override;
+    double getDistanceToPoint(const RS_Vector& coord,
+                              RS_Entity** entity,
+                              RS2::ResolveLevel level=RS2::ResolveNone,
+                              double solidDist = RS_MAXDOUBLE) const override;
+    void revertDirection() override;
+    RS_Entity& shear(double k) override;
+    double areaLineIntegral() const override;
+    //! \}
+
      void move(const RS_Vector& offset) override;
      void rotate(const RS_Vector& center, const double& angle) override;
      void rotate(const RS_Vector& center, const RS_Vector& angleVector) override;
      void scale(const RS_Vector& center, const RS_Vector& factor) override;
      void mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) override;
      bool hasEndpointsWithinWindow(const RS_Vector& v1, const RS_Vector& v2) override;
+     void moveRef(const RS_Vector& ref, const RS_Vector& offset) override;
+     void moveSelectedRef(const RS_Vector& ref, const RS_Vector& offset) override;
     virtual void stretch(const RS_Vector& firstCorner,
                          const RS_Vector& secondCorner,
                          const RS_Vector& offset) override;
@@ -243,6 +309,8 @@ public:
     void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
 
 protected:
+    void materializeEntities() const override;
+
     RS_TextData data;
 
     /**
@@ -257,6 +325,16 @@ protected:
      * @see update
      */
     double usedTextHeight = 0.;
+
+private:
+    //! the outlines of the letters in graph coordinates, empty when drawn as inserts
+    QPainterPath glyphPath;
+    void createGlyphPath();
+    // the letters are released, see compact()
+    mutable bool m_compact = false;
+    // the letters and their entities, counted when released
+    unsigned m_letterCount = 0;
+    unsigned m_letterCountDeep = 0;
 };
 
 #endif
@@ -25,11 +25,18 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include<iostream>
+#include <unordered_set>
+#include <utility>
+
+#include "lc_regenstatistics.h"
+#include "lc_trace.h"
 #include "qc_applicationwindow.h"
 #include "rs_undocycle.h"
 #include "rs_undo.h"
 #include "rs_debug.h"
+#include "rs_settings.h"
 
 /**
  * @return Number of Cycles that can be undone.
@@ -120,14 +127,17 @@ void RS_Undo::startUndoCycle()
         obsolete.unique();
 
         // delete obsolete undoables which are not in keep list
+        std::vector<RS_Undoable*> removed;
         for (auto it = obsolete.begin(); it != obsolete.end(); ++it) {
             if (keep.end() == std::find( keep.begin(), keep.end(), *it)) {
-                removeUndoable( *it);
+                removed.push_back( *it);
             }
         }
+        removeUndoables(removed);
 
         // clean up obsolete undoCycles
         while (undoList.size() > removePointer) {
+            memoryUsage -= undoList.back()->memoryUsage();
             undoList.pop_back();
         }
     }
@@ -154,6 +164,17 @@ void RS_Undo::addUndoable(RS_Undoable* u) {
 
 
 
+void RS_Undo::addUndoable(std::unique_ptr<RS_Undoable> u) {
+    if( nullptr == currentCycle) {
+        RS_DEBUG->print( RS_Debug::D_CRITICAL, "RS_Undo::%s(): invalid currentCycle, possibly missing startUndoCycle()", __func__);
+        return;
+    }
+
+    currentCycle->addUndoable(std::move(u));
+}
+
+
+
 /**
  * Ends the current undo cycle.
  */
@@ -171,9 +192,19 @@ void RS_Undo::endUndoCycle()
         return;
     }
 
-    if (hasUndoable()) {
+    if (currentCycle != nullptr)
+        currentCycle->removeDuplicates();
+    if (cancelled) {
+        rollbackUndoCycle();
+    } else if (hasUndoable()) {
         // only keep the undoCycle, when it contains undoables
+        currentCycle->memory = currentCycle->estimateMemoryUsage();
+        memoryUsage += currentCycle->memory;
+        RS_DEBUG->print("RS_Undo::endUndoCycle: %zu undoables, %zu KiB, undo list %zu KiB",
+                        currentCycle->size(), currentCycle->memory >> 10, memoryUsage >> 10);
+        undoCycleChanged(*currentCycle);
         addUndoCycle(currentCycle);
+        limitMemoryUsage();
     }
 
     setGUIButtons();
@@ -182,10 +213,99 @@ void RS_Undo::endUndoCycle()
 
 
 
+/**
+ * Marks the current undo cycle to be rolled back, by the final (outermost)
+ * endUndoCycle() call of nested cycles.
+ */
+void RS_Undo::cancelUndoCycle()
+{
+    if (nullptr == currentCycle) {
+        RS_DEBUG->print( RS_Debug::D_WARNING, "RS_Undo::%s(): no current undo cycle", __func__);
+        return;
+    }
+    cancelled = true;
+}
+
+/**
+ * Restores the state before the current cycle, as undo() does, and deletes
+ * the undoables created in the cycle, which are undone now.
+ */
+void RS_Undo::rollbackUndoCycle()
+{
+    cancelled = false;
+    if (!hasUndoable())
+        return;
+
+    RS_DEBUG->print("RS_Undo::rollbackUndoCycle: %zu undoables", currentCycle->size());
+    currentCycle->changeUndoState();
+    undoCycleChanged(*currentCycle);
+    std::vector<RS_Undoable*> created;
+    for (RS_Undoable* u: currentCycle->getUndoables()) {
+        if (u->isUndone())
+            created.push_back(u);
+    }
+    removeUndoables(created);
+}
+
+/**
+ * Deletes the undoables one by one.
+ */
+void RS_Undo::removeUndoables(const std::vector<RS_Undoable*>& undoables)
+{
+    for (RS_Undoable* u: undoables)
+        removeUndoable(u);
+}
+
+/**
+ * Drops the oldest undo cycles, when the undo list uses more memory than
+ * /Defaults/UndoMemoryLimit (in MiB, 0 for no limit). The last cycle which
+ * can be undone is always kept.
+ */
+void RS_Undo::limitMemoryUsage()
+{
+    RS_SETTINGS->beginGroup("/Defaults");
+    const int limitMiB = RS_SETTINGS->readNumEntry("/UndoMemoryLimit", 0);
+    RS_SETTINGS->endGroup();
+    const std::size_t limit = static_cast<std::size_t>(std::max(limitMiB, 0)) << 20;
+    if (limit == 0 || memoryUsage <= limit)
+        return;
+
+    // drop down to 90% of the limit, so cycles are not dropped after each action
+    const std::size_t target = limit - limit / 10;
+    int dropped = 0;
+    while (dropped < undoPointer && memoryUsage > target)
+        memoryUsage -= undoList[dropped++]->memoryUsage();
+    if (dropped == 0)
+        return;
+
+    // undone entities of dropped cycles can't be restored anymore, unless
+    // a kept cycle refers to them
+    std::unordered_set<RS_Undoable*> candidates;
+    for (int i = 0; i < dropped; ++i) {
+        for (RS_Undoable* u: undoList[i]->getUndoables()) {
+            if (u->isUndone())
+                candidates.insert(u);
+        }
+    }
+    for (auto it = undoList.cbegin() + dropped; it != undoList.cend() && !candidates.empty(); ++it) {
+        for (RS_Undoable* u: (*it)->getUndoables())
+            candidates.erase(u);
+    }
+
+    RS_DEBUG->print("RS_Undo::limitMemoryUsage: dropping %d cycles, %zu undoables",
+                    dropped, candidates.size());
+    undoList.erase(undoList.begin(), undoList.begin() + dropped);
+    undoPointer -= dropped;
+    removeUndoables({candidates.cbegin(), candidates.cend()});
+    setGUIButtons();
+}
+
 /**
  * Undoes the last undo cycle.
  */
 bool RS_Undo::undo() {
+    LC_TRACE_ZONE("RS_Undo::undo");
+    LC_REGEN_REASON("undo");
     RS_DEBUG->print("RS_Undo::undo");
 
 	if (undoPointer < 0) return false;
@@ -194,6 +314,7 @@ bool RS_Undo::undo() {
 
 	setGUIButtons();
 	uc->changeUndoState();
+	undoCycleChanged(*uc);
 	return true;
 }
 
@@ -202,6 +323,8 @@ bool RS_Undo::undo() {
  * Redoes the undo cycle which was at last undone.
  */
 bool RS_Undo::redo() {
+    LC_TRACE_ZONE("RS_Undo::redo");
+    LC_REGEN_REASON("redo");
     RS_DEBUG->print("RS_Undo::redo");
 
 	if (undoPointer+1 < int(undoList.size())) {
@@ -210,6 +333,7 @@ bool RS_Undo::redo() {
 
 		setGUIButtons();
 		uc->changeUndoState();
+		undoCycleChanged(*uc);
 		return true;
 	}
     return false;
@@ -220,20 +344,12 @@ bool RS_Undo::redo() {
  * @return The undo item that is next if we're about to undo
  * or nullptr.
  */
-/**
-std::shared_ptr<RS_UndoCycle> RS_Undo::getUndoCycle() {
-		std::shared_ptr<RS_UndoCycle> ret;
-
-	RS_DEBUG->print("RS_Undo::getUndoCycle");
-
+std::shared_ptr<RS_UndoCycle> RS_Undo::getUndoCycle() const {
 	if ((undoPointer>=0) && (undoPointer < int(undoList.size()))) {
-		ret = undoList.at(undoPointer);
+		return undoList.at(undoPointer);
 	}
-	RS_DEBUG->print("RS_Undo::getUndoCycle: OK");
-
-	return ret;
+	return {};
 }
-*/
 
 
 
@@ -241,17 +357,13 @@ std::shared_ptr<RS_UndoCycle> RS_Undo::getUndoCycle() {
  * @return The redo item that is next if we're about to redo
  * or nullptr.
  */
-/**
-std::shared_ptr<RS_UndoCycle> RS_Undo::getRedoCycle() {
-    RS_DEBUG->print("RS_Undo::getRedoCycle");
-
+std::shared_ptr<RS_UndoCycle> RS_Undo::getRedoCycle() const {
 	if ((undoPointer+1>=0) && (undoPointer+1 < int(undoList.size()))) {
         return undoList.at(undoPointer+1);
     }
 
-	return std::shared_ptr<RS_UndoCycle>();
+	return {};
 }
-*/
 
 /**
   * enable/disable redo/undo buttons in main application window
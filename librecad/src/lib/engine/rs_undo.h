@@ -29,6 +29,7 @@
 #ifndef RS_UNDO_H
 #define RS_UNDO_H
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -49,8 +50,10 @@ public:
     virtual bool undo();
     virtual bool redo();
 
-//	virtual std::shared_ptr<RS_UndoCycle> getUndoCycle();
-//	virtual std::shared_ptr<RS_UndoCycle> getRedoCycle();
+    //! the cycle to be undone by the next undo(), nullptr if none
+    std::shared_ptr<RS_UndoCycle> getUndoCycle() const;
+    //! the cycle to be redone by the next redo(), nullptr if none
+    std::shared_ptr<RS_UndoCycle> getRedoCycle() const;
 
     virtual int countUndoCycles();
     virtual int countRedoCycles();
@@ -58,7 +61,18 @@ public:
 
     virtual void startUndoCycle();
     virtual void addUndoable(RS_Undoable* u);
+    //! adds an undoable owned by the current cycle, deleted if there's no current cycle
+    void addUndoable(std::unique_ptr<RS_Undoable> u);
     virtual void endUndoCycle();
+    /**
+     * Cancels the current undo cycle: the final endUndoCycle() restores the
+     * undoables of the cycle and drops it, instead of adding it to the list.
+     */
+    void cancelUndoCycle();
+    //! true, if the current undo cycle is cancelled
+    bool isUndoCycleCancelled() const {
+        return cancelled;
+    }
 
     /**
      * Must be overwritten by the implementing class and delete
@@ -67,6 +81,19 @@ public:
      */
     virtual void removeUndoable(RS_Undoable* u) = 0;
 
+    /**
+     * Deletes the given Undoables, which are no longer in the undo buffer.
+     * Can be overwritten to delete many Undoables at once.
+     */
+    virtual void removeUndoables(const std::vector<RS_Undoable*>& undoables);
+
+    /**
+     * @return estimated memory held by the undo list in bytes
+     */
+    std::size_t getMemoryUsage() const {
+        return memoryUsage;
+    }
+
     /**
 	  *\brief enable/disable redo/undo buttons in main application window
 	  *\author: Dongxu Li
@@ -77,9 +104,19 @@ public:
 
     static bool test();
 
+protected:
+    /**
+     * Called after the undoables of the cycle are undone or redone, by the final
+     * endUndoCycle(), undo() and redo(). Can be overwritten to move undone
+     * undoables out of their containers.
+     */
+    virtual void undoCycleChanged(const RS_UndoCycle& /*cycle*/) {}
+
 private:
 
 	void addUndoCycle(std::shared_ptr<RS_UndoCycle> const& i);
+    void limitMemoryUsage();
+    void rollbackUndoCycle();
     //! List of undo list items. every item is something that can be undone.
 	std::vector<std::shared_ptr<RS_UndoCycle>> undoList;
 
@@ -97,6 +134,10 @@ private:
     std::shared_ptr<RS_UndoCycle> currentCycle {nullptr};
 
     int refCount {0}; ///< reference counter for nested start/end calls
+    bool cancelled {false}; ///< the current cycle is rolled back by the final endUndoCycle()
+
+    //! estimated memory of the cycles in the undo list
+    std::size_t memoryUsage = 0;
 };
 
 
@@ -26,9 +26,17 @@
 **********************************************************************/
 
 
+#include <algorithm>
 #include <ostream>
+#include <unordered_set>
+#include <utility>
 #include"rs_undocycle.h"
 
+namespace {
+// rough size of an entity, with its allocation overhead
+constexpr std::size_t entityMemory = 256;
+}
+
 /**
  * Adds an Undoable to this Undo Cycle. Every Cycle can contain one or
  * more Undoables.
@@ -37,7 +45,15 @@ void RS_UndoCycle::addUndoable(RS_Undoable* u) {
     if (!u)
         return;
 
-    undoables.insert(u);
+    undoables.push_back(u);
+}
+
+void RS_UndoCycle::addUndoable(std::unique_ptr<RS_Undoable> u) {
+    if (!u)
+        return;
+
+    undoables.push_back(u.get());
+    ownedUndoables.push_back(std::move(u));
 }
 
 /**
@@ -47,7 +63,16 @@ void RS_UndoCycle::removeUndoable(RS_Undoable* u) {
     if (!u)
         return;
 
-    undoables.erase(u);
+    undoables.erase(std::remove(undoables.begin(), undoables.end(), u), undoables.end());
+}
+
+void RS_UndoCycle::removeDuplicates()
+{
+    std::unordered_set<const RS_Undoable*> added;
+    added.reserve(undoables.size());
+    undoables.erase(std::remove_if(undoables.begin(), undoables.end(), [&added](const RS_Undoable* u) {
+        return !added.insert(u).second;
+    }), undoables.end());
 }
 
 /**
@@ -58,17 +83,48 @@ size_t RS_UndoCycle::size()
     return undoables.size();
 }
 
+/**
+ * Entities are undone or redone in bulk, the other undoables, like transformation
+ * records, one by one after them.
+ */
 void RS_UndoCycle::changeUndoState()
 {
-	for (RS_Undoable* u: undoables)
-		u->changeUndoState();
+    std::vector<RS_Entity*> entities;
+    entities.reserve(undoables.size());
+    for (RS_Undoable* u: undoables) {
+        if (u->undoRtti() == RS2::UndoableEntity)
+            entities.push_back(static_cast<RS_Entity*>(u));
+    }
+    RS_Entity::changeUndoStates(entities);
+    if (entities.size() == undoables.size())
+        return;
+    for (RS_Undoable* u: undoables) {
+        if (u->undoRtti() != RS2::UndoableEntity)
+            u->changeUndoState();
+    }
 }
 
-std::set<RS_Undoable*> const& RS_UndoCycle::getUndoables() const
+std::vector<RS_Undoable*> const& RS_UndoCycle::getUndoables() const
 {
     return undoables;
 }
 
+/**
+ * Estimates the memory of the undoables from their number of entities,
+ * containers count with all their sub-entities.
+ */
+std::size_t RS_UndoCycle::estimateMemoryUsage() const
+{
+    std::size_t entities = 0;
+    for (RS_Undoable* u: undoables) {
+        if (u->undoRtti() == RS2::UndoableEntity)
+            entities += static_cast<RS_Entity*>(u)->countDeep();
+        else
+            ++entities;
+    }
+    return entities * entityMemory;
+}
+
 
 std::ostream& operator << (std::ostream& os,
 								  RS_UndoCycle& uc) {
@@ -92,6 +148,7 @@ std::ostream& operator << (std::ostream& os,
 		}
 
 	}
+	os << "\n   Memory: " << (uc.memory >> 10) << " KiB";
 
 	return os;
 }
@@ -29,8 +29,10 @@
 #ifndef RS_UNDOLISTITEM_H
 #define RS_UNDOLISTITEM_H
 
+#include <cstddef>
 #include <iosfwd>
-#include <set>
+#include <memory>
+#include <vector>
 
 #include "rs_entity.h"
 #include "rs_undoable.h"
@@ -61,6 +63,12 @@ public:
      */
     void addUndoable(RS_Undoable* u);
 
+    /**
+     * Adds an Undoable owned by this Undo Cycle, e.g. a transformation record,
+     * which is deleted with the cycle.
+     */
+    void addUndoable(std::unique_ptr<RS_Undoable> u);
+
     /**
      * Removes an undoable from the list.
      */
@@ -71,6 +79,14 @@ public:
      */
     size_t size(void);
 
+    /**
+     * @return estimated memory held by the undoables of the cycle in bytes,
+     * as estimated when the cycle was ended
+     */
+    std::size_t memoryUsage() const {
+        return memory;
+    }
+
 
     //! change undo state of all undoable in the current cycle
     void changeUndoState();
@@ -79,13 +95,23 @@ public:
 
     friend class RS_Undo;
 
-    std::set<RS_Undoable*> const& getUndoables() const;
+    //! the undoables in the order they were added, without duplicates once the cycle is ended
+    std::vector<RS_Undoable*> const& getUndoables() const;
 
 private:
+    std::size_t estimateMemoryUsage() const;
+    //! removes undoables added more than once, keeps their first position
+    void removeDuplicates();
+
     //! Undo type:
     //RS2::UndoType type;
-    //! List of entity id's that were affected by this action
-    std::set<RS_Undoable*> undoables;
+    //! List of entity id's that were affected by this action, a vector to switch
+    //! their undo states in bulk
+    std::vector<RS_Undoable*> undoables;
+    //! Undoables owned by this cycle
+    std::vector<std::unique_ptr<RS_Undoable>> ownedUndoables;
+    //! estimated memory of the undoables
+    std::size_t memory = 0;
 };
 
 #endif
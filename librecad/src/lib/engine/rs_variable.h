@@ -28,6 +28,7 @@
 #ifndef RS_VARIABLE_H
 #define RS_VARIABLE_H
 
+#include <QByteArray>
 #include <QString>
 #include "rs.h"
 #include "rs_vector.h"
@@ -42,6 +43,8 @@
 class RS_Variable {
 	struct RS_VariableContents {
 		QString s;
+		//! UTF-8 text of strings read from files, decoded when accessed
+		QByteArray utf8;
         int i=0;
         double d=0.;
         RS_Vector v{false};
@@ -72,6 +75,16 @@ public:
 
 	void setString(const QString& str) {
 		contents.s = str;
+		contents.utf8.clear();
+		type = RS2::VariableString;
+	}
+	/**
+	 * Sets a string from its UTF-8 text. The text is only converted
+	 * by getString(), most header strings of a file are never read.
+	 */
+	void setUtf8String(const QByteArray& str) {
+		contents.s.clear();
+		contents.utf8 = str;
 		type = RS2::VariableString;
 	}
 	void setInt(int i) {
@@ -88,6 +101,8 @@ public:
 	}
 
 	QString getString() const {
+		if (!contents.utf8.isNull())
+			return QString::fromUtf8(contents.utf8);
 		return contents.s;
 	}
 	int getInt() const {
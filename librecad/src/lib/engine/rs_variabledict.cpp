@@ -29,12 +29,57 @@
 #include "rs_variabledict.h"
 #include "rs_debug.h"
 
+namespace {
+//names of the variables in RS_VariableDict::CachedVariable
+const std::array<QLatin1String, RS_VariableDict::CachedCount> cachedNames{{
+    QLatin1String("$INSUNITS"),
+    QLatin1String("$GRIDMODE"),
+    QLatin1String("$SNAPSTYLE"),
+    QLatin1String("$GRIDUNIT"),
+    QLatin1String("$DIMSCALE"),
+    QLatin1String("$PSVPSCALE"),
+    QLatin1String("$PDMODE"),
+    QLatin1String("$PDSIZE"),
+    QLatin1String("$LUNITS"),
+    QLatin1String("$LUPREC"),
+    QLatin1String("$AUNITS"),
+    QLatin1String("$AUPREC")
+}};
+}
+
 /**
  * Removes all variables in the blocklist.
  */
 void RS_VariableDict::clear()
 {
     variables.clear();
+    cached.fill(RS_Variable{});
+}
+
+
+/**
+ * Stores a variable and its copy in the cached table.
+ */
+void RS_VariableDict::insert(const QString& key, const RS_Variable& value)
+{
+    variables.insert(key, value);
+    updateCached(key);
+}
+
+
+/**
+ * Copies the variable key to the cached table, if it is one of the
+ * variables of CachedVariable.
+ */
+void RS_VariableDict::updateCached(const QString& key)
+{
+    for (size_t i = 0; i < cachedNames.size(); ++i) {
+        if (key == cachedNames[i]) {
+            auto it = variables.constFind(key);
+            cached[i] = variables.cend() != it ? it.value() : RS_Variable{};
+            return;
+        }
+    }
 }
 
 
@@ -77,7 +122,7 @@ void RS_VariableDict::add(const QString& key,
         return;
     }
 
-    variables.insert(key, RS_Variable(value, code));
+    insert(key, RS_Variable(value, code));
 }
 
 
@@ -95,7 +140,7 @@ void RS_VariableDict::add(const QString& key, int value, int code)
         return;
     }
 
-    variables.insert(key, RS_Variable(value, code));
+    insert(key, RS_Variable(value, code));
 }
 
 
@@ -113,7 +158,7 @@ void RS_VariableDict::add(const QString& key, double value, int code)
         return;
     }
 
-    variables.insert(key, RS_Variable(value, code));
+    insert(key, RS_Variable(value, code));
 }
 
 
@@ -132,7 +177,26 @@ void RS_VariableDict::add(const QString& key,
         return;
     }
 
-    variables.insert(key, RS_Variable(value, code));
+    insert(key, RS_Variable(value, code));
+}
+
+
+/**
+ * Adds a string variable from its UTF-8 text, as read from a file.
+ * The text is converted when the variable is read.
+ */
+void RS_VariableDict::addUtf8(const QString& key,
+                              const QByteArray& value, int code)
+{
+    if (key.isEmpty()) {
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "RS_VariableDict::addUtf8(): No empty keys allowed.");
+        return;
+    }
+
+    RS_Variable variable;
+    variable.setUtf8String(value);
+    insert(key, variable);
 }
 
 
@@ -235,6 +299,39 @@ double RS_VariableDict::getDouble(const QString& key, double def) const
 }
 
 
+/**
+ * Gets the value of a variable of the cached table.
+ *
+ * @return The value for the given variable or the given default value
+ * if the variable isn't set or has another type.
+ */
+RS_Vector RS_VariableDict::getVector(CachedVariable var, const RS_Vector& def) const
+{
+    const RS_Variable& v = cached[var];
+    return RS2::VariableVector == v.getType() ? v.getVector() : def;
+}
+
+
+/**
+ * Gets the value of a variable of the cached table as int.
+ */
+int RS_VariableDict::getInt(CachedVariable var, int def) const
+{
+    const RS_Variable& v = cached[var];
+    return RS2::VariableInt == v.getType() ? v.getInt() : def;
+}
+
+
+/**
+ * Gets the value of a variable of the cached table as double.
+ */
+double RS_VariableDict::getDouble(CachedVariable var, double def) const
+{
+    const RS_Variable& v = cached[var];
+    return RS2::VariableDouble == v.getType() ? v.getDouble() : def;
+}
+
+
 /**
  * Notifies the listeners about layers that were added. This can be
  * used after adding a lot of variables without auto-update.
@@ -261,6 +358,7 @@ void RS_VariableDict::remove(const QString& key)
 
     // here the block is removed from the list but not deleted
     variables.remove(key);
+    updateCached(key);
 }
 
 
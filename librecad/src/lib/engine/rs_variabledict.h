@@ -29,6 +29,7 @@
 #ifndef RS_VARIABLEDICT_H
 #define RS_VARIABLEDICT_H
 
+#include <array>
 #include <QHash>
 #include "rs_variable.h"
 
@@ -43,6 +44,27 @@ class QString;
  */
 class RS_VariableDict {
 public:
+    /**
+     * Variables read for each drawn frame. Their values are also kept
+     * in a table indexed by this enum, to read them without hashing
+     * their names.
+     */
+    enum CachedVariable {
+        InsUnits,         //!< $INSUNITS
+        GridMode,         //!< $GRIDMODE
+        SnapStyle,        //!< $SNAPSTYLE
+        GridUnit,         //!< $GRIDUNIT
+        DimScale,         //!< $DIMSCALE
+        PaperScale,       //!< $PSVPSCALE
+        PointMode,        //!< $PDMODE
+        PointSize,        //!< $PDSIZE
+        LinearUnits,      //!< $LUNITS
+        LinearPrecision,  //!< $LUPREC
+        AngleUnits,       //!< $AUNITS
+        AnglePrecision,   //!< $AUPREC
+        CachedCount
+    };
+
 	RS_VariableDict() = default;
 
     void clear();
@@ -57,28 +79,35 @@ public:
     void add(const QString& key, const QString& value, int code);
     void add(const QString& key, int value, int code);
     void add(const QString& key, double value, int code);
+    void addUtf8(const QString& key, const QByteArray& value, int code);
 
 	RS_Vector getVector(const QString& key, const RS_Vector& def) const;
 	QString getString(const QString& key, const QString& def) const;
 	int getInt(const QString& key, int def) const;
 	double getDouble(const QString& key, double def) const;
 
+	RS_Vector getVector(CachedVariable var, const RS_Vector& def) const;
+	int getInt(CachedVariable var, int def) const;
+	double getDouble(CachedVariable var, double def) const;
+
 	void remove(const QString& key);
 
 	QHash<QString, RS_Variable> const& getVariableDict() const {
         return variables;
     }
-	QHash<QString, RS_Variable>& getVariableDict() {
-		return variables;
-	}
 
     //void addVariableDictListener(RS_VariableDictListener* listener);
 
     friend std::ostream& operator << (std::ostream& os, RS_VariableDict& v);
 
 private:
+    void insert(const QString& key, const RS_Variable& value);
+    void updateCached(const QString& key);
+
     //! Variables for the graphic
     QHash<QString, RS_Variable> variables;
+    //! Copies of the variables in CachedVariable, void if not set
+    std::array<RS_Variable, CachedCount> cached;
 };
 
 #endif
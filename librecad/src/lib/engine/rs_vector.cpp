@@ -352,6 +352,83 @@ RS_Vector& RS_Vector::shear(double k)
     return *this;
 }
 
+/**
+ * Batched transforms of point lists, for entities storing many points: the
+ * transformation is set up once, and the plain loops over the coordinates are
+ * left for the compiler to vectorize.
+ */
+void RS_Vector::move(std::vector<RS_Vector>& points, const RS_Vector& offset)
+{
+    const double dx = offset.x;
+    const double dy = offset.y;
+    const double dz = offset.z;
+    for (RS_Vector& v: points) {
+        v.x += dx;
+        v.y += dy;
+        v.z += dz;
+    }
+}
+
+void RS_Vector::rotate(std::vector<RS_Vector>& points, const RS_Vector& center,
+                       const RS_Vector& angleVector)
+{
+    const double cx = center.x;
+    const double cy = center.y;
+    const double c = angleVector.x;
+    const double s = angleVector.y;
+    for (RS_Vector& v: points) {
+        const double dx = v.x - cx;
+        const double dy = v.y - cy;
+        v.x = cx + dx * c - dy * s;
+        v.y = cy + dx * s + dy * c;
+    }
+}
+
+void RS_Vector::scale(std::vector<RS_Vector>& points, const RS_Vector& center,
+                      const RS_Vector& factor)
+{
+    const double cx = center.x;
+    const double cy = center.y;
+    const double fx = factor.x;
+    const double fy = factor.y;
+    for (RS_Vector& v: points) {
+        v.x = cx + (v.x - cx) * fx;
+        v.y = cy + (v.y - cy) * fy;
+    }
+}
+
+/**
+ * Mirrors the points at the axis, as mirror(); the points are left unchanged
+ * if the axis points coincide.
+ */
+void RS_Vector::mirror(std::vector<RS_Vector>& points, const RS_Vector& axisPoint1,
+                       const RS_Vector& axisPoint2)
+{
+    const RS_Vector direction = axisPoint2 - axisPoint1;
+    const double a = direction.squared();
+    if (a < RS_TOLERANCE2)
+        return;
+
+    const double ax = axisPoint1.x;
+    const double ay = axisPoint1.y;
+    const double ux = direction.x / a;
+    const double uy = direction.y / a;
+    const double dx = direction.x;
+    const double dy = direction.y;
+    for (RS_Vector& v: points) {
+        // twice the projection point on the axis, minus the point
+        const double t = (v.x - ax) * ux + (v.y - ay) * uy;
+        v.x = 2. * (ax + dx * t) - v.x;
+        v.y = 2. * (ay + dy * t) - v.y;
+    }
+}
+
+void RS_Vector::shear(std::vector<RS_Vector>& points, double k)
+{
+    for (RS_Vector& v: points)
+        v.x += k * v.y;
+}
+
 /**
  * Streams the vector components to stdout. e.g.: "1/4/0"
  */
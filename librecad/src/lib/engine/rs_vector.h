@@ -132,6 +132,18 @@ public:
 	bool operator == (bool valid) const;
 	bool operator != (bool valid) const;
 
+    //! \{
+    //! transform all the points at once
+    static void move(std::vector<RS_Vector>& points, const RS_Vector& offset);
+    static void rotate(std::vector<RS_Vector>& points, const RS_Vector& center,
+                       const RS_Vector& angleVector);
+    static void scale(std::vector<RS_Vector>& points, const RS_Vector& center,
+                      const RS_Vector& factor);
+    static void mirror(std::vector<RS_Vector>& points, const RS_Vector& axisPoint1,
+                       const RS_Vector& axisPoint2);
+    static void shear(std::vector<RS_Vector>& points, double k);
+    //! \}
+
     static RS_Vector minimum(const RS_Vector& v1, const RS_Vector& v2);
     static RS_Vector maximum(const RS_Vector& v1, const RS_Vector& v2);
 //    crossP only defined for 3D
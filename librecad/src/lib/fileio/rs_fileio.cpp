@@ -25,20 +25,109 @@
 **
 **********************************************************************/
 
+#include <atomic>
 #include <cstddef>
+#include <QEventLoop>
 #include <QFileInfo>
 #include <QTextStream>
 #ifdef DWGSUPPORT
 #include <QMessageBox>
 #include <QApplication>
+#include <QThread>
+#include <QTimer>
 #endif
 #include "rs_fileio.h"
+#include "lc_entitypool.h"
 #include "rs_filtercxf.h"
 #include "rs_filterdxf1.h"
 #include "rs_filterjww.h"
 #include "rs_filterlff.h"
 #include "rs_filterdxfrw.h"
 #include "rs_debug.h"
+#include "rs_blocklist.h"
+#include "rs_layerlist.h"
+
+namespace {
+/**
+ * Detaches the listeners of the layer and block lists of a graphic, while
+ * a worker imports into the graphic. The listeners are GUI objects, they
+ * get the active layer again when attached.
+ */
+class DetachedListeners {
+public:
+    explicit DetachedListeners(RS_Graphic& graphic):
+        layerList{*graphic.getLayerList()}
+      , blockList{*graphic.getBlockList()}
+      , layerListeners{layerList.getListeners()}
+      , blockListeners{blockList.getListeners()}
+    {
+        for (RS_LayerListListener* listener: layerListeners)
+            layerList.removeListener(listener);
+        for (RS_BlockListListener* listener: blockListeners)
+            blockList.removeListener(listener);
+    }
+
+    ~DetachedListeners()
+    {
+        for (RS_LayerListListener* listener: layerListeners)
+            layerList.addListener(listener);
+        for (RS_BlockListListener* listener: blockListeners)
+            blockList.addListener(listener);
+        layerList.activate(layerList.getActive(), true);
+    }
+
+    DetachedListeners(const DetachedListeners&) = delete;
+    DetachedListeners& operator = (const DetachedListeners&) = delete;
+
+private:
+    RS_LayerList& layerList;
+    RS_BlockList& blockList;
+    const QList<RS_LayerListListener*> layerListeners;
+    const QList<RS_BlockListListener*> blockListeners;
+};
+
+/**
+ * Imports on a worker thread, if the filter reports the progress. The GUI
+ * thread keeps processing events and reports the progress meanwhile.
+ */
+bool importFile(RS_FilterInterface& filter, RS_Graphic& graphic, const QString& file,
+                RS2::FormatType type, const RS_FilterInterface::ProgressCallback& progress,
+                bool& cancelled)
+{
+    cancelled = false;
+    std::atomic<double> fraction{0.};
+    std::atomic<bool> cancel{false};
+    if (!progress || !filter.setProgressCallback(file, [&fraction, &cancel](double done) {
+        fraction = done;
+        return !cancel;
+    }))
+        return filter.fileImport(graphic, file, type);
+
+    RS_DEBUG->print("RS_FileIO::fileImport: importing in background");
+    DetachedListeners detached{graphic};
+    bool imported = false;
+    // the entities come from the arena of the caller, e.g. of the graphic
+    LC_EntityPool::Arena* arena = LC_EntityPool::threadArena();
+    std::unique_ptr<QThread> worker{QThread::create([&]() {
+        LC_EntityPool::Scope arenaScope{arena};
+        imported = filter.fileImport(graphic, file, type);
+    })};
+    QEventLoop loop;
+    QTimer timer;
+    QObject::connect(worker.get(), &QThread::finished, &loop, &QEventLoop::quit);
+    QObject::connect(&timer, &QTimer::timeout, &loop, [&]() {
+        if (!cancel && !progress(fraction))
+            cancel = true;
+    });
+    timer.start(100);
+    worker->start();
+    loop.exec();
+    worker->wait();
+
+    cancelled = cancel;
+    return imported && !cancelled;
+}
+}
 
 /**
  * Calls the import method of the filter responsible for the format
@@ -48,9 +137,15 @@
  *        entities. Usually that's an RS_Graphic entity but
  *        it can also be a polyline, text, ...
  * @param file Path and name of the file to import.
+ * @param progress Optional progress callback. If the filter supports it,
+ *        the file is imported on a worker thread, and the callback is
+ *        regularly called from the calling thread until done.
+ * @param options Optional options to import a part of the file. Filters
+ *        without partial imports import the whole file.
  */
 bool RS_FileIO::fileImport(RS_Graphic& graphic, const QString& file,
-        RS2::FormatType type) {
+        RS2::FormatType type, const RS_FilterInterface::ProgressCallback& progress,
+        const LC_ImportOptions& options) {
 
     RS_DEBUG->print("Trying to import file '%s'...", file.toLatin1().data());
 
@@ -65,6 +160,10 @@ bool RS_FileIO::fileImport(RS_Graphic& graphic, const QString& file,
     if (RS2::FormatUnknown != t) {
 		std::unique_ptr<RS_FilterInterface>&& filter(getImportFilter(file, t));
 		if (filter){
+            if ((!options.isEmpty() || options.writeProfile)
+                    && !filter->setImportOptions(options))
+                RS_DEBUG->print(RS_Debug::D_WARNING,
+                                "RS_FileIO::fileImport: no partial import, importing the whole file");
 #ifdef DWGSUPPORT
             bool isDwg {file.endsWith( ".dwg", Qt::CaseInsensitive)};
             if (isDwg) {
@@ -84,7 +183,12 @@ bool RS_FileIO::fileImport(RS_Graphic& graphic, const QString& file,
                 QApplication::setOverrideCursor( QCursor(Qt::WaitCursor));
             }
 #endif
-            bool bImported {filter->fileImport(graphic, file, t)};
+            bool cancelled {false};
+            bool bImported {importFile(*filter, graphic, file, t, progress, cancelled)};
+            if (cancelled) {
+                RS_DEBUG->print("RS_FileIO::fileImport: cancelled");
+                return false;
+            }
             if (!bImported) {
                 QApplication::restoreOverrideCursor();  // disable WaitCursor for massagebox
 
@@ -163,12 +267,19 @@ RS2::FormatType RS_FileIO::detectFormat(QString const& file, bool forRead)
 	// only read support for dwg
 	if(forRead) list["dwg"]=RS2::FormatDWG;
 
-	QString const extension = QFileInfo(file).suffix().toLower();
+	QFileInfo const info(file);
+	QString extension = info.suffix().toLower();
+	// gzip compressed drawings, as drawing.dxf.gz
+	bool const compressed = extension == "gz";
+	if (compressed)
+		extension = QFileInfo(info.completeBaseName()).suffix().toLower();
 	RS2::FormatType type=(list.find(extension)!=
 			list.end()) ? list[extension]:RS2::FormatUnknown;
+	if (compressed && type!=RS2::FormatDXFRW)
+		return RS2::FormatUnknown;
 
-	//only read dxf to verify
-	if (forRead && type==RS2::FormatDXFRW) {
+	//only read dxf to verify, compressed files are verified by libdxfrw
+	if (forRead && type==RS2::FormatDXFRW && !compressed) {
 		type = RS2::FormatDXFRW;
 		QFile f(file);
 
@@ -66,7 +66,9 @@ public:
 										RS2::FormatType t) const;
 
     bool fileImport(RS_Graphic& graphic, const QString& file,
-		RS2::FormatType type = RS2::FormatUnknown);
+		RS2::FormatType type = RS2::FormatUnknown,
+		const RS_FilterInterface::ProgressCallback& progress = {},
+		const LC_ImportOptions& options = {});
 		
     bool fileExport(RS_Graphic& graphic, const QString& file,
 		RS2::FormatType type = RS2::FormatUnknown);
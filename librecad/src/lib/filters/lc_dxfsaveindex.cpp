@@ -0,0 +1,56 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <QFileInfo>
+
+#include "lc_dxfsaveindex.h"
+
+LC_DxfSaveIndex::LC_DxfSaveIndex(int format, const QString& codePage):
+    m_format{format}
+  , m_codePage{codePage}
+{}
+
+bool LC_DxfSaveIndex::isValidFor(const QString& fileName, int format, const QString& codePage) const {
+    if (m_fileSize < 0 || format != m_format || codePage != m_codePage || fileName != m_fileName)
+        return false;
+    const QFileInfo info{fileName};
+    return info.exists() && info.size() == m_fileSize && info.lastModified() == m_modified;
+}
+
+void LC_DxfSaveIndex::setWritten(const QString& fileName) {
+    const QFileInfo info{fileName};
+    m_fileName = fileName;
+    m_fileSize = info.exists() ? info.size() : -1;
+    m_modified = info.lastModified();
+}
+
+const LC_DxfSaveIndex::Record* LC_DxfSaveIndex::find(unsigned long id) const {
+    const auto it = m_records.constFind(id);
+    return it != m_records.cend() ? &it.value() : nullptr;
+}
+
+void LC_DxfSaveIndex::insert(unsigned long id, const Record& record) {
+    m_records.insert(id, record);
+}
@@ -0,0 +1,77 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_DXFSAVEINDEX_H
+#define LC_DXFSAVEINDEX_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+
+/**
+ * @brief The LC_DxfSaveIndex class, positions and handles of the entities in a
+ * DXF file written by LibreCAD, to save the file again by copying the records
+ * of unchanged entities. The index is valid while the file is not changed by
+ * others, and for saves in the same format and code page.
+ */
+class LC_DxfSaveIndex {
+public:
+    //! the records of an entity in the file
+    struct Record {
+        //! hash of the written data, to detect changes of the entity
+        quint64 fingerprint = 0;
+        int handle = 0;
+        qint64 offset = 0;
+        qint64 size = 0;
+    };
+
+    LC_DxfSaveIndex(int format, const QString& codePage);
+
+    /**
+     * @brief isValidFor whether the file was written with this index, and not
+     * changed since then
+     */
+    bool isValidFor(const QString& fileName, int format, const QString& codePage) const;
+    //! records the size and the modification time of the written file
+    void setWritten(const QString& fileName);
+
+    const Record* find(unsigned long id) const;
+    void insert(unsigned long id, const Record& record);
+
+    //! the handles of all entities are above the first handle, the last one is the largest
+    int firstHandle = 0;
+    int lastHandle = 0;
+
+private:
+    int m_format = 0;
+    QString m_codePage;
+    QString m_fileName;
+    qint64 m_fileSize = -1;
+    QDateTime m_modified;
+    //! records by entity id
+    QHash<unsigned long, Record> m_records;
+};
+
+#endif // LC_DXFSAVEINDEX_H
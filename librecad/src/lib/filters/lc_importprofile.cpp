@@ -0,0 +1,124 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <algorithm>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QObject>
+
+#include "lc_importprofile.h"
+
+LC_ImportProfile::Phase::Phase(LC_ImportProfile* profile, const char* name):
+    m_profile{profile}
+{
+    if (m_profile != nullptr)
+        m_profile->begin(name);
+}
+
+LC_ImportProfile::Phase::~Phase()
+{
+    if (m_profile != nullptr)
+        m_profile->end();
+}
+
+LC_ImportProfile::LC_ImportProfile()
+{
+    m_timer.start();
+}
+
+void LC_ImportProfile::begin(const char* name)
+{
+    const qint64 now = m_timer.nsecsElapsed();
+    // the enclosing phase is paused
+    if (!m_stack.empty())
+        m_stack.back().first->nsecs += now - m_stack.back().second;
+    Entry& entry = m_phases[name];
+    ++entry.count;
+    m_stack.emplace_back(&entry, now);
+}
+
+void LC_ImportProfile::end()
+{
+    const qint64 now = m_timer.nsecsElapsed();
+    m_stack.back().first->nsecs += now - m_stack.back().second;
+    m_stack.pop_back();
+    if (!m_stack.empty())
+        m_stack.back().second = now;
+}
+
+std::vector<std::pair<std::string, LC_ImportProfile::Entry>> LC_ImportProfile::getSorted(qint64& other) const
+{
+    std::vector<std::pair<std::string, Entry>> phases{m_phases.cbegin(), m_phases.cend()};
+    std::sort(phases.begin(), phases.end(), [](const auto& a, const auto& b) {
+        return a.second.nsecs > b.second.nsecs;
+    });
+    other = m_timer.nsecsElapsed();
+    for (const auto& phase: phases)
+        other -= phase.second.nsecs;
+    return phases;
+}
+
+QJsonObject LC_ImportProfile::toJson() const
+{
+    qint64 other = 0;
+    QJsonArray phases;
+    for (const auto& [name, entry]: getSorted(other)) {
+        QJsonObject phase;
+        phase["name"] = QString::fromStdString(name);
+        phase["ms"] = entry.nsecs * 1e-6;
+        phase["count"] = entry.count;
+        phases.append(phase);
+    }
+    QJsonObject report;
+    report["total_ms"] = m_timer.nsecsElapsed() * 1e-6;
+    report["other_ms"] = other * 1e-6;
+    report["phases"] = phases;
+    return report;
+}
+
+QStringList LC_ImportProfile::toText() const
+{
+    qint64 other = 0;
+    const auto phases = getSorted(other);
+    QStringList lines;
+    lines << QObject::tr("Import profile: %1 ms").arg(m_timer.nsecsElapsed() * 1e-6, 0, 'f', 1);
+    for (const auto& [name, entry]: phases) {
+        lines << QObject::tr("  %1: %2 ms, %3 times")
+                 .arg(QString::fromStdString(name))
+                 .arg(entry.nsecs * 1e-6, 0, 'f', 1)
+                 .arg(entry.count);
+    }
+    lines << QObject::tr("  other: %1 ms").arg(other * 1e-6, 0, 'f', 1);
+    return lines;
+}
+
+bool LC_ImportProfile::write(const QString& fileName) const
+{
+    QFile file{fileName};
+    const QByteArray json = QJsonDocument(toJson()).toJson();
+    return file.open(QIODevice::WriteOnly) && file.write(json) == json.size();
+}
@@ -0,0 +1,89 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_IMPORTPROFILE_H
+#define LC_IMPORTPROFILE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QStringList>
+
+/**
+ * @brief The LC_ImportProfile class, timings of the phases of an import, and the
+ * number of times each phase was entered, so the phases of entity callbacks count
+ * the imported entities by type.
+ * The times are exclusive: a phase nested in another one is not included in the
+ * time of the enclosing phase, so the times of all phases add up to the import.
+ */
+class LC_ImportProfile {
+public:
+    /**
+     * @brief The Phase class, times its scope as a phase of a profile. Does nothing,
+     * if there is no profile
+     */
+    class Phase {
+    public:
+        Phase(LC_ImportProfile* profile, const char* name);
+        ~Phase();
+        Phase(const Phase&) = delete;
+        Phase& operator = (const Phase&) = delete;
+    private:
+        LC_ImportProfile* m_profile;
+    };
+
+    LC_ImportProfile();
+
+    //! the report with the phases sorted by time, and the total time
+    QJsonObject toJson() const;
+    //! the report as lines of text, the slowest phases first
+    QStringList toText() const;
+    /**
+     * @brief write writes the JSON report to a file
+     * @return false, if the file can't be written
+     */
+    bool write(const QString& fileName) const;
+
+private:
+    void begin(const char* name);
+    void end();
+
+    struct Entry {
+        qint64 nsecs = 0;
+        qint64 count = 0;
+    };
+    //! the phases, slowest first, and the time not in any phase
+    std::vector<std::pair<std::string, Entry>> getSorted(qint64& other) const;
+
+    std::map<std::string, Entry> m_phases;
+    //! the phases entered, with the time the innermost one was entered or resumed
+    std::vector<std::pair<Entry*, qint64>> m_stack;
+    QElapsedTimer m_timer;
+};
+
+#endif // LC_IMPORTPROFILE_H
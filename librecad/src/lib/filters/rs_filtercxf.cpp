@@ -25,11 +25,14 @@
 **********************************************************************/
 
 
+#include <QFile>
 #include <QStringList>
 #include "rs_filtercxf.h"
 
 #include <fstream>
+#include <initializer_list>
 
+#include "lc_fontfile.h"
 #include "rs_arc.h"
 #include "rs_line.h"
 #include "rs_font.h"
@@ -83,6 +86,8 @@ bool RS_FilterCXF::fileImport(RS_Graphic& g, const QString& file, RS2::FormatTyp
         g.addVariable("Encoding", font.getEncoding(), 0);
     }
 
+    // letters are generated on first use otherwise
+    font.generateAllFonts();
     RS_BlockList* letterList = font.getLetterList();
     for (unsigned i=0; i<font.countLetters(); ++i) {
         RS_Block* ch = font.letterAt(i);
@@ -117,157 +122,99 @@ bool RS_FilterCXF::fileImport(RS_Graphic& g, const QString& file, RS2::FormatTyp
 bool RS_FilterCXF::fileExport(RS_Graphic& g, const QString& file, RS2::FormatType /*type*/) {
 
     RS_DEBUG->print("CXF Filter: exporting file '%s'...", file.toLatin1().data());
-
-    // crashes under windoze xp:
-    //std::ofstream fout;
-
     RS_DEBUG->print("RS_FilterCXF::fileExport: open");
-    //fout.open((const char*)file.toLocal8Bit());
-    FILE* fp;
-
-    if ((fp = fopen(file.toLocal8Bit(), "wt")) != NULL) {
-
-        RS_DEBUG->print("RS_FilterCXF::fileExport: open: OK");
 
-        RS_DEBUG->print("RS_FilterCXF::fileExport: header");
-
-        // header:
-        fprintf(fp, "# Format:            QCad II Font\n");
-
-        fprintf(fp, "# Creator:           %s\n",
-                (const char*)RS_SYSTEM->getAppName().toLocal8Bit());
-        fprintf(fp, "# Version:           %s\n",
-                (const char*)RS_SYSTEM->getAppVersion().toLocal8Bit());
+    QFile f(file);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        RS_DEBUG->print("CXF Filter: exporting file failed");
+        return false;
+    }
+    RS_DEBUG->print("RS_FilterCXF::fileExport: open: OK");
+
+    // the lines are formatted in a buffer, written in large blocks
+    LC_FontFile::Writer fp(&f);
+    QString es = g.getVariableString("Encoding", "");
+    if (!es.isEmpty())
+        fp.setEncoding(es);
+
+    // header:
+    fp << "# Format:            QCad II Font\n";
+    fp << "# Creator:           " << RS_SYSTEM->getAppName() << '\n';
+    fp << "# Version:           " << RS_SYSTEM->getAppVersion() << '\n';
+
+    QString ns = g.getVariableString("Names", "");
+    if (!ns.isEmpty()) {
+        for (const QString& name: ns.split(','))
+            fp << "# Name:              " << name << '\n';
+    }
 
-        RS_DEBUG->print("001");
-        QString ns = g.getVariableString("Names", "");
-        if (!ns.isEmpty()) {
-            QStringList names = ns.split(',');
-            RS_DEBUG->print("002");
-            for (int i = 0; i < names.size(); ++i) {
-                fprintf(fp, "# Name:              %s\n",
-                        names.at(i).toLocal8Bit().data() );
-             }
-        }
+    if (!es.isEmpty())
+        fp << "# Encoding:          " << es << '\n';
+
+    fp << "# LetterSpacing:     ";
+    fp.writeFixed(g.getVariableDouble("LetterSpacing", 3.0), 6);
+    fp << "\n# WordSpacing:       ";
+    fp.writeFixed(g.getVariableDouble("WordSpacing", 6.75), 6);
+    fp << "\n# LineSpacingFactor: ";
+    fp.writeFixed(g.getVariableDouble("LineSpacingFactor", 1.0), 6);
+    fp << '\n';
+
+    QString sa = g.getVariableString("Authors", "");
+    if (!sa.isEmpty()) {
+        for (const QString& author: sa.split(','))
+            fp << "# Author:            " << author << '\n';
+    }
 
-        RS_DEBUG->print("003");
+    RS_DEBUG->print("RS_FilterCXF::fileExport: header: OK");
 
-        QString es = g.getVariableString("Encoding", "");
-        if (!es.isEmpty()) {
-            fprintf(fp, "# Encoding:          %s\n",
-                    es.toLocal8Bit().data());
+    // values as "%f"
+    auto writeValues = [&fp](std::initializer_list<double> values) {
+        bool first = true;
+        for (double value: values) {
+            if (!first)
+                fp << ',';
+            fp.writeFixed(value, 6);
+            first = false;
         }
-
-        RS_DEBUG->print("004a");
-
-        fprintf(fp, "# LetterSpacing:     %f\n",
-                g.getVariableDouble("LetterSpacing", 3.0));
-        fprintf(fp, "# WordSpacing:       %f\n",
-                g.getVariableDouble("WordSpacing", 6.75));
-        fprintf(fp, "# LineSpacingFactor: %f\n",
-                g.getVariableDouble("LineSpacingFactor", 1.0));
-
-        QString sa = g.getVariableString("Authors", "");
-        RS_DEBUG->print("authors: %s", sa.toLocal8Bit().data());
-        if (!sa.isEmpty()) {
-            QStringList authors = sa.split(',');
-            RS_DEBUG->print("006");
-            RS_DEBUG->print("count: %d", authors.count());
-
-            QString a;
-            for (QStringList::Iterator it2 = authors.begin();
-                    it2!=authors.end(); ++it2) {
-
-                RS_DEBUG->print("006a");
-                a = QString(*it2);
-                RS_DEBUG->print("006b");
-                RS_DEBUG->print("string is: %s", a.toLatin1().data());
-                RS_DEBUG->print("006b0");
-                fprintf(fp, "# Author:            ");
-                RS_DEBUG->print("006b1");
-                fprintf(fp, "%s\n", a.toLatin1().data());
-                //fout << "# Author:            " << a.ascii() << "\n";
+        fp << '\n';
+    };
+
+    // iterate through blocks (=letters of font)
+    for (unsigned i=0; i<g.countBlocks(); ++i) {
+        RS_Block* blk = g.blockAt(i);
+        if (blk == nullptr || blk->isUndone())
+            continue;
+
+        fp << '\n' << blk->getName() << '\n';
+
+        // iterate through entities of this letter:
+        for (RS_Entity* e: blk->resolvedEntities(RS2::ResolveAll)) {
+            if (e->isUndone())
+                continue;
+
+            // lines:
+            if (e->rtti()==RS2::EntityLine) {
+                RS_Line* l = (RS_Line*)e;
+                fp << "L ";
+                writeValues({l->getStartpoint().x, l->getStartpoint().y,
+                             l->getEndpoint().x, l->getEndpoint().y});
             }
-            RS_DEBUG->print("007");
-        }
 
-        RS_DEBUG->print("RS_FilterCXF::fileExport: header: OK");
-
-        RS_DEBUG->print("008");
-        // iterate through blocks (=letters of font)
-        for (unsigned i=0; i<g.countBlocks(); ++i) {
-            RS_Block* blk = g.blockAt(i);
-
-            RS_DEBUG->print("block: %d", i);
-            RS_DEBUG->print("001");
-
-            if (blk && !blk->isUndone()) {
-                RS_DEBUG->print("002");
-                RS_DEBUG->print("002a: %s",
-                                (blk->getName().toLocal8Bit().data()));
-
-                fprintf(fp, "\n%s\n",
-                        (blk->getName().toLocal8Bit().data()));
-
-
-                // iterate through entities of this letter:
-                for (RS_Entity* e=blk->firstEntity(RS2::ResolveAll);
-                        e;
-                        e=blk->nextEntity(RS2::ResolveAll)) {
-
-                    if (!e->isUndone()) {
-
-                        RS_DEBUG->print("004");
-
-                        // lines:
-                        if (e->rtti()==RS2::EntityLine) {
-                            RS_Line* l = (RS_Line*)e;
-
-                            fprintf(fp, "L %f,%f,%f,%f\n",
-                                    l->getStartpoint().x,
-                                    l->getStartpoint().y,
-                                    l->getEndpoint().x,
-                                    l->getEndpoint().y);
-                        }
-
-                        // arcs:
-                        else if (e->rtti()==RS2::EntityArc) {
-                            RS_Arc* a = (RS_Arc*)e;
-
-                            if (!a->isReversed()) {
-                                fprintf(fp, "A ");
-                            } else {
-                                fprintf(fp, "AR ");
-                            }
-
-                            fprintf(fp, "%f,%f,%f,%f,%f\n",
-                                    a->getCenter().x,
-                                    a->getCenter().y,
-                                    a->getRadius(),
-									RS_Math::rad2deg(a->getAngle1()),
-									RS_Math::rad2deg(a->getAngle2())
-													 );
-                        }
-                        // Ignore entities other than arcs / lines
-                        else {}
-                    }
-
-                    RS_DEBUG->print("005");
-                }
-                RS_DEBUG->print("006");
+            // arcs:
+            else if (e->rtti()==RS2::EntityArc) {
+                RS_Arc* a = (RS_Arc*)e;
+                fp << (a->isReversed() ? "AR " : "A ");
+                writeValues({a->getCenter().x, a->getCenter().y, a->getRadius(),
+                             RS_Math::rad2deg(a->getAngle1()),
+                             RS_Math::rad2deg(a->getAngle2())});
             }
-            RS_DEBUG->print("007");
+            // Ignore entities other than arcs / lines
         }
-        //fout.close();
-        fclose(fp);
-    	RS_DEBUG->print("CXF Filter: exporting file: OK");
-		return true;
     }
-	else {
-    	RS_DEBUG->print("CXF Filter: exporting file failed");
-	}
-
-	return false;
+    const bool success = fp.flush();
+    f.close();
+    RS_DEBUG->print("CXF Filter: exporting file: %s", success ? "OK" : "failed");
+    return success;
 }
 
 
@@ -23,13 +23,26 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <cstdio>
 #include<cstdlib>
+#include <fstream>
+#include <unordered_set>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
 #include <QRegularExpression>
+#include <QStandardPaths>
 #include <QStringList>
 #include <QStringConverter>
+#include <QThread>
 
 #include "rs_filterdxfrw.h"
 
+#include "lc_dxfsaveindex.h"
+#include "lc_importprofile.h"
 #include "lc_parabola.h"
 #include "rs_arc.h"
 #include "rs_circle.h"
@@ -39,6 +52,7 @@
 #include "rs_dimlinear.h"
 #include "rs_dimradial.h"
 #include "rs_ellipse.h"
+#include "rs_fontlist.h"
 #include "rs_hatch.h"
 #include "rs_image.h"
 #include "rs_insert.h"
@@ -56,6 +70,7 @@
 #include "rs_graphicview.h"
 #include "rs_dialogfactory.h"
 #include "rs_math.h"
+#include "rs_settings.h"
 #include "dxf_format.h"
 #include "lc_defaults.h"
 
@@ -64,6 +79,104 @@
 #include "rs_debug.h"
 #endif
 
+namespace {
+//! change to ignore the snapshots written by older versions
+constexpr int snapshotVersion = 1;
+
+// imports may run on a worker thread, their command messages are shown by the GUI thread
+void showCommandMessage(const QString& message)
+{
+    QCoreApplication* application = QCoreApplication::instance();
+    if (application == nullptr || QThread::currentThread() == application->thread()) {
+        RS_DIALOGFACTORY->commandMessage(message);
+        return;
+    }
+    QMetaObject::invokeMethod(application, [message]() {
+        RS_DIALOGFACTORY->commandMessage(message);
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * Snapshots of imported files are binary DXF files in the cache location. They are
+ * named by the hash of the file path, followed by the file size and modification time,
+ * so a changed file doesn't match its old snapshot.
+ */
+QString snapshotPrefix(const QFileInfo& info)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(info.absoluteFilePath().toUtf8(),
+                                                        QCryptographicHash::Sha1).toHex()) + '-';
+}
+
+QString snapshotFile(const QString& file)
+{
+    const QFileInfo info{file};
+    if (!info.isFile())
+        return {};
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty())
+        return {};
+    return QDir{dir + "/documents"}.filePath(snapshotPrefix(info)
+                                             + QString("%1-%2-%3.dxb")
+                                             .arg(info.size())
+                                             .arg(info.lastModified().toMSecsSinceEpoch())
+                                             .arg(snapshotVersion));
+}
+
+// fingerprints of entities, FNV-1a hashes of their written data
+void hashBytes(quint64& hash, const void* data, std::size_t size)
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+void hashDouble(quint64& hash, double value)
+{
+    hashBytes(hash, &value, sizeof(value));
+}
+
+void hashInt(quint64& hash, int value)
+{
+    hashBytes(hash, &value, sizeof(value));
+}
+
+void hashVector(quint64& hash, const RS_Vector& vector)
+{
+    hashDouble(hash, vector.x);
+    hashDouble(hash, vector.y);
+}
+
+void hashString(quint64& hash, const std::string& text)
+{
+    hashInt(hash, static_cast<int>(text.size()));
+    hashBytes(hash, text.data(), text.size());
+}
+
+/**
+ * Replaces the file by the one written aside. On Windows, the old file
+ * can't be replaced by renaming, it is moved away until the new one is in place.
+ */
+bool replaceFile(const QString& written, const QString& fileName)
+{
+#ifdef Q_OS_WIN
+    const QString old = written + ".old";
+    if (QFile::exists(fileName) && !QFile::rename(fileName, old))
+        return false;
+    if (!QFile::rename(written, fileName)) {
+        QFile::rename(old, fileName);
+        return false;
+    }
+    QFile::remove(old);
+    return true;
+#else
+    return std::rename(QFile::encodeName(written).constData(),
+                       QFile::encodeName(fileName).constData()) == 0;
+#endif
+}
+}
+
 /**
  * Default constructor.
  *
@@ -71,10 +184,18 @@
 RS_FilterDXFRW::RS_FilterDXFRW()
     :RS_FilterInterface(),DRW_Interface() {
 
-    RS_DEBUG->print("RS_FilterDXFRW::RS_FilterDXFRW()");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::RS_FilterDXFRW()");
 
 	currentContainer = nullptr;
 	graphic = nullptr;
+
+    // read by the calling thread, the import may run on a worker thread
+    RS_SETTINGS->beginGroup("/Defaults");
+    useSnapshots = RS_SETTINGS->readNumEntry("/DocumentCache", 0) != 0;
+    reportProfile = RS_SETTINGS->readNumEntry("/ProfileImport", 0) != 0;
+    incrementalSave = RS_SETTINGS->readNumEntry("/IncrementalSave", 0) != 0;
+    RS_SETTINGS->endGroup();
+
 // Init hash to change the QCAD "normal" style to the more correct ISO-3059
 // or draftsight symbol (AR*.shx) to sy*.lff
     fontList["normal"] = "iso";
@@ -87,14 +208,14 @@ RS_FilterDXFRW::RS_FilterDXFRW()
     fontList["armusic"] = "symusic";
 
 
-    RS_DEBUG->print("RS_FilterDXFRW::RS_FilterDXFRW(): OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::RS_FilterDXFRW(): OK");
 }
 
 /**
  * Destructor.
  */
 RS_FilterDXFRW::~RS_FilterDXFRW() {
-    RS_DEBUG->print("RS_FilterDXFRW::~RS_FilterDXFRW(): OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::~RS_FilterDXFRW(): OK");
 }
 
 QString RS_FilterDXFRW::lastError() const
@@ -146,18 +267,88 @@ QString RS_FilterDXFRW::lastError() const
  * taken to be stored in a file.
  */
 bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatType type) {
-    RS_DEBUG->print("RS_FilterDXFRW::fileImport");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::fileImport");
+
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "DXFRW Filter: importing file '%s'...", (const char*)QFile::encodeName(file));
 
-    RS_DEBUG->print("DXFRW Filter: importing file '%s'...", (const char*)QFile::encodeName(file));
+    graphic = &g;
+    this->file = file;
+    if (reportProfile || importOptions.writeProfile)
+        profile = std::make_unique<LC_ImportProfile>();
+
+    // partial imports don't use the snapshot of the whole file
+    const QString snapshot = (useSnapshots && importOptions.isEmpty()) ? snapshotFile(file) : QString{};
+    bool fromSnapshot = !snapshot.isEmpty() && QFileInfo::exists(snapshot);
+    if (fromSnapshot) {
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::fileImport: reading snapshot '%s'",
+                        (const char*)QFile::encodeName(snapshot));
+        fromSnapshot = importFile(snapshot, RS2::FormatDXFRW);
+        if (!fromSnapshot) {
+            if (progressCallback && !progressCallback(0.))
+                return false;
+            RS_DEBUG_PRINT(RS_Debug::D_WARNING,
+                            "RS_FilterDXFRW::fileImport: invalid snapshot, reading the file");
+            QFile::remove(snapshot);
+            graphic->newDoc();
+        }
+    }
+    if (!fromSnapshot && !importFile(file, type))
+        return false;
+
+    /*set current layer */
+    RS_Layer* cl = graphic->findLayer(graphic->getVariableString("$CLAYER", "0"));
+	if (cl ){
+        //require to notify
+        graphic->getLayerList()->activate(cl, true);
+    }
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::fileImport: updating inserts");
+    {
+        const LC_ImportProfile::Phase phase{profile.get(), "update inserts"};
+        graphic->updateInserts();
+    }
+    if (importOptions.useWindow) {
+        const LC_ImportProfile::Phase phase{profile.get(), "window"};
+        const LC_Rect& window = importOptions.window;
+        const unsigned removed = graphic->removeEntities([&window](const RS_Entity* e) {
+            // entities without valid borders are kept
+            const RS_Vector minV = e->getMin();
+            const RS_Vector maxV = e->getMax();
+            return minV.valid && maxV.valid && !window.intersects(LC_Rect{minV, maxV});
+        });
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::fileImport: %u entities out of the window", removed);
+    }
+    if (!snapshot.isEmpty() && !fromSnapshot) {
+        const LC_ImportProfile::Phase phase{profile.get(), "snapshot"};
+        writeSnapshot(file, snapshot);
+    }
+    if (profile) {
+        {
+            // otherwise calculated by the view showing the drawing
+            const LC_ImportProfile::Phase phase{profile.get(), "borders"};
+            graphic->calculateBorders();
+        }
+        writeProfile(fromSnapshot);
+    }
+    if (progressCallback)
+        progressCallback(1.);
+
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::fileImport OK");
+
+    return true;
+}
+
+/**
+ * Reads a DXF or DWG file into the graphic.
+ *
+ * @param fileName The file to read, the imported file or its snapshot.
+ */
+bool RS_FilterDXFRW::importFile(const QString& fileName, RS2::FormatType type) {
 #ifndef DWGSUPPORT
     Q_UNUSED(type)
 #endif
-
-    graphic = &g;
     currentContainer = graphic;
 	dummyContainer = new RS_EntityContainer(nullptr, true);
 
-    this->file = file;
     // add some variables that need to be there for DXF drawings:
     graphic->addVariable("$DIMSTYLE", "Standard", 2);
     dimStyle = "Standard";
@@ -166,79 +357,221 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatT
     //reset library version
     isLibDxfRw = false;
     libDxfRwVersion = 0;
+    importedLayers.clear();
+    importedLineTypes.clear();
+    skippedLayers.clear();
+    pendingTexts.clear();
 
 #ifdef DWGSUPPORT
     if (type == RS2::FormatDWG) {
-        dwgR dwgr(QFile::encodeName(file));
-        RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading DWG file");
+        dwgR dwgr(QFile::encodeName(fileName));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::fileImport: reading DWG file");
         if (RS_DEBUG->getLevel()== RS_Debug::D_DEBUGGING)
             dwgr.setDebug(DRW::DebugLevel::Debug);
-        bool success = dwgr.read(this, true);
-        RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading DWG file: OK");
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("Opened dwg file version %1.").arg(printDwgVersion(dwgr.getVersion())));
+        // entities are decoded in parallel, and added in handle order
+        dwgr.setReadThreads(QThread::idealThreadCount());
+        bool success = false;
+        {
+            const LC_ImportProfile::Phase phase{profile.get(), "parse"};
+            success = dwgr.read(this, true);
+        }
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::fileImport: reading DWG file: OK");
+        showCommandMessage(QObject::tr("Opened dwg file version %1.").arg(printDwgVersion(dwgr.getVersion())));
         int  lastError = dwgr.getError();
         if (false == success) {
             printDwgError(lastError);
-            RS_DEBUG->print(RS_Debug::D_WARNING,
-                            "Cannot open DWG file '%s'.", (const char*)QFile::encodeName(file));
+            RS_DEBUG_PRINT(RS_Debug::D_WARNING,
+                            "Cannot open DWG file '%s'.", (const char*)QFile::encodeName(fileName));
             errorCode = dwgr.getError();
+            delete dummyContainer;
             return false;
         }
     } else {
 #endif
-        dxfRW dxfR(QFile::encodeName(file));
+        dxfRW dxfR(QFile::encodeName(fileName));
 
-        RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading file");
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::fileImport: reading file");
         if (RS_Debug::D_DEBUGGING == RS_DEBUG->getLevel()) {
             dxfR.setDebug(DRW::DebugLevel::Debug);
         }
-        bool success = dxfR.read(this, true);
-        RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading file: OK");
+        // entities are decoded in parallel, and added in file order
+        dxfR.setReadThreads(QThread::idealThreadCount());
+        if (progressCallback) {
+            dxfR.setProgressCallback([this](double fraction) {
+                return progressCallback(progressRead * fraction);
+            });
+        }
+        bool success = false;
+        {
+            const LC_ImportProfile::Phase phase{profile.get(), "parse"};
+            success = dxfR.read(this, true);
+        }
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::fileImport: reading file: OK");
         //graphic->setAutoUpdateBorders(true);
 
         if (false == success) {
-            RS_DEBUG->print(RS_Debug::D_WARNING,
-                            "Cannot open DXF file '%s'.", (const char*)QFile::encodeName(file));
+            RS_DEBUG_PRINT(RS_Debug::D_WARNING,
+                            "Cannot open DXF file '%s'.", (const char*)QFile::encodeName(fileName));
             errorCode = dxfR.getError();
+            delete dummyContainer;
             return false;
         }
 #ifdef DWGSUPPORT
     }
 #endif
 
+    updateTexts();
     delete dummyContainer;
-    /*set current layer */
-    RS_Layer* cl = graphic->findLayer(graphic->getVariableString("$CLAYER", "0"));
-	if (cl ){
-        //require to notify
-        graphic->getLayerList()->activate(cl, true);
+    return true;
+}
+
+/**
+ * Lays out the texts read by the import, and updates the borders of the blocks
+ * with texts, as the inserts of the blocks are updated next.
+ */
+void RS_FilterDXFRW::updateTexts() {
+    // orphan entities are not imported
+    pendingTexts.erase(std::remove_if(pendingTexts.begin(), pendingTexts.end(), [this](const RS_Entity* e) {
+        return e->getParent() == dummyContainer;
+    }), pendingTexts.end());
+    if (pendingTexts.empty())
+        return;
+
+    const LC_ImportProfile::Phase phase{profile.get(), "text update"};
+    RS_Text::updateAll(pendingTexts);
+    std::unordered_set<RS_EntityContainer*> blocks;
+    for (const RS_Entity* e: pendingTexts) {
+        if (e->getParent() != graphic)
+            blocks.insert(e->getParent());
     }
-    RS_DEBUG->print("RS_FilterDXFRW::fileImport: updating inserts");
-    graphic->updateInserts();
+    for (RS_EntityContainer* block: blocks)
+        block->calculateBorders();
+    pendingTexts.clear();
+}
 
-    RS_DEBUG->print("RS_FilterDXFRW::fileImport OK");
+/**
+ * Reports the profile of the import, to a file next to the imported file and as
+ * command messages.
+ *
+ * @param fromSnapshot the graphic was read from the snapshot of the file
+ */
+void RS_FilterDXFRW::writeProfile(bool fromSnapshot) {
+    const QString profileFile = file + ".profile.json";
+    if (importOptions.writeProfile && !profile->write(profileFile)) {
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING, "RS_FilterDXFRW::writeProfile: can't write '%s'",
+                        (const char*)QFile::encodeName(profileFile));
+    }
+    if (reportProfile) {
+        QStringList lines = profile->toText();
+        if (fromSnapshot)
+            lines.first() += QObject::tr(", read from the cache");
+        for (const QString& line: lines)
+            showCommandMessage(line);
+    }
+    profile.reset();
+}
+
+/**
+ * Writes the imported graphic to its snapshot, and removes the snapshots of
+ * older versions of the file.
+ */
+void RS_FilterDXFRW::writeSnapshot(const QString& fileName, const QString& snapshot) {
+    const QFileInfo info{snapshot};
+    QDir dir = info.dir();
+    if (!dir.mkpath(".")) {
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING, "RS_FilterDXFRW::writeSnapshot: can't create '%s'",
+                        (const char*)QFile::encodeName(dir.path()));
+        return;
+    }
+    const QStringList older = dir.entryList({snapshotPrefix(QFileInfo{fileName}) + "*"}, QDir::Files);
+    for (const QString& name: older)
+        dir.remove(name);
+
+    // written aside, so a partial snapshot is never read
+    const QString part = snapshot + QString(".%1.part").arg(QCoreApplication::applicationPid());
+    if (!writeDxf(part, RS2::FormatDXFRW, true) || !QFile::rename(part, snapshot)) {
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING, "RS_FilterDXFRW::writeSnapshot: can't write '%s'",
+                        (const char*)QFile::encodeName(snapshot));
+        QFile::remove(part);
+    }
+}
 
+/**
+ * DXF files are read without using the GUI, so the import can run on a
+ * worker thread. DWG files report errors with the dialog factory.
+ */
+bool RS_FilterDXFRW::setProgressCallback(const QString& fileName, ProgressCallback callback) {
+    if (fileName.endsWith(".dwg", Qt::CaseInsensitive)) {
+        progressCallback = nullptr;
+        return false;
+    }
+    progressCallback = std::move(callback);
+    return true;
+}
+
+bool RS_FilterDXFRW::setImportOptions(const LC_ImportOptions& options) {
+    importOptions = options;
+    auto toPatterns = [](const QStringList& names) {
+        std::vector<QRegularExpression> patterns;
+        for (const QString& name: names) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 6, 0)
+            const QString pattern = QRegularExpression::wildcardToRegularExpression(
+                        name, QRegularExpression::NonPathWildcardConversion);
+#else
+            const QString pattern = QRegularExpression::wildcardToRegularExpression(name);
+#endif
+            patterns.emplace_back(pattern, QRegularExpression::CaseInsensitiveOption);
+        }
+        return patterns;
+    };
+    includedLayers = toPatterns(options.includeLayers);
+    excludedLayers = toPatterns(options.excludeLayers);
     return true;
 }
 
+/**
+ * @return true, if the entity is out of the layers imported by the import options.
+ * Entities are skipped before creating any RS_Entity. Entities of blocks are always
+ * imported, as inserts on imported layers may use them.
+ */
+bool RS_FilterDXFRW::isSkipped(const DRW_Entity& data) {
+    if (!importOptions.filtersLayers() || currentContainer != graphic)
+        return false;
+    auto it = skippedLayers.find(data.layer);
+    if (it == skippedLayers.end()) {
+        const QString name = toNativeString(QString::fromUtf8(data.layer.c_str()));
+        auto matches = [&name](const std::vector<QRegularExpression>& patterns) {
+            return std::any_of(patterns.cbegin(), patterns.cend(),
+                               [&name](const QRegularExpression& pattern) {
+                return pattern.match(name).hasMatch();
+            });
+        };
+        const bool skipped = (!includedLayers.empty() && !matches(includedLayers))
+                || matches(excludedLayers);
+        it = skippedLayers.emplace(data.layer, skipped).first;
+    }
+    return it->second;
+}
+
 /**
  * Implementation of the method which handles layers.
  */
 void RS_FilterDXFRW::addLayer(const DRW_Layer &data) {
-    RS_DEBUG->print("RS_FilterDXF::addLayer");
-    RS_DEBUG->print("  adding layer: %s", data.name.c_str());
+    const LC_ImportProfile::Phase phase{profile.get(), "LAYER"};
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLayer");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "  adding layer: %s", data.name.c_str());
 
-    RS_DEBUG->print("RS_FilterDXF::addLayer: creating layer");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLayer: creating layer");
 
     QString name = QString::fromUtf8(data.name.c_str());
     if (name != "0" && graphic->findLayer(name)) {
         return;
     }
     RS_Layer* layer = new RS_Layer(name);
-    RS_DEBUG->print("RS_FilterDXF::addLayer: set pen");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLayer: set pen");
     layer->setPen(attributesToPen(&data));
 
-    RS_DEBUG->print("RS_FilterDXF::addLayer: flags");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLayer: flags");
     if (data.flags&0x01) {
         layer->freeze(true);
     }
@@ -249,7 +582,7 @@ void RS_FilterDXFRW::addLayer(const DRW_Layer &data) {
 
     //parse extended data to read construction flag
     if (!data.extData.empty()){
-        RS_DEBUG->print(RS_Debug::D_WARNING, "RS_FilterDXF::addLayer: layer %s have extended data", layer->getName().toStdString().c_str());
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING, "RS_FilterDXF::addLayer: layer %s have extended data", layer->getName().toStdString().c_str());
         bool isLCdata = false;
         for (std::vector<DRW_Variant*>::const_iterator it=data.extData.begin(); it!=data.extData.end(); ++it){
             if ((*it)->code() == 1001){
@@ -270,18 +603,19 @@ void RS_FilterDXFRW::addLayer(const DRW_Layer &data) {
     }
 
     if (layer->isConstruction())
-        RS_DEBUG->print(RS_Debug::D_WARNING, "RS_FilterDXF::addLayer: layer %s is construction layer", layer->getName().toStdString().c_str());
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING, "RS_FilterDXF::addLayer: layer %s is construction layer", layer->getName().toStdString().c_str());
 
-    RS_DEBUG->print("RS_FilterDXF::addLayer: add layer to graphic");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLayer: add layer to graphic");
     graphic->addLayer(layer);
-    RS_DEBUG->print("RS_FilterDXF::addLayer: OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLayer: OK");
 }
 
 /**
  * Implementation of the method which handles dimension styles.
  */
 void RS_FilterDXFRW::addDimStyle(const DRW_Dimstyle& data){
-    RS_DEBUG->print("RS_FilterDXFRW::addLayer");
+    const LC_ImportProfile::Phase phase{profile.get(), "DIMSTYLE"};
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addLayer");
     QString dimstyle = graphic->getVariableString("$DIMSTYLE", "standard");
 
     if (QString::compare(data.name.c_str(), dimstyle, Qt::CaseInsensitive) == 0) {
@@ -298,10 +632,25 @@ void RS_FilterDXFRW::addDimStyle(const DRW_Dimstyle& data){
     }
 }
 
+/**
+ * Implementation of the method which handles text styles.
+ * Texts use the style names as font names, the fonts of the styles
+ * are loaded in the background while the rest of the file is read.
+ */
+void RS_FilterDXFRW::addTextStyle(const DRW_Textstyle& data) {
+    const LC_ImportProfile::Phase phase{profile.get(), "STYLE"};
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addTextStyle");
+    QString sty = QString::fromUtf8(data.name.c_str()).toLower();
+    if (sty.isEmpty())
+        return;
+    RS_FONTLIST->preloadFonts({fontList.value(sty, sty)});
+}
+
 /**
  * Implementation of the method which handles vports.
  */
 void RS_FilterDXFRW::addVport(const DRW_Vport &data) {
+    const LC_ImportProfile::Phase phase{profile.get(), "VPORT"};
     QString name = QString::fromStdString(data.name);
     if (name.toLower() == "*active") {
         data.grid == 1? graphic->setGridOn(true):graphic->setGridOn(false);
@@ -328,10 +677,11 @@ void RS_FilterDXFRW::addVport(const DRW_Vport &data) {
  * @todo Adding blocks to blocks (stack for currentContainer)
  */
 void RS_FilterDXFRW::addBlock(const DRW_Block& data) {
+    const LC_ImportProfile::Phase phase{profile.get(), "BLOCK"};
 
-    RS_DEBUG->print("RS_FilterDXF::addBlock");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addBlock");
 
-    RS_DEBUG->print("  adding block: %s", data.name.c_str());
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "  adding block: %s", data.name.c_str());
 /*TODO correct handle of model-space*/
 
     QString name = QString::fromUtf8(data.name.c_str());
@@ -343,6 +693,9 @@ void RS_FilterDXFRW::addBlock(const DRW_Block& data) {
             RS_Block* block =
                 new RS_Block(graphic, RS_BlockData(name, bp, false ));
             //block->setFlags(flags);
+            // external reference, the entities are loaded from the file
+            if ((data.flags & 4) != 0 && !data.xrefPath.empty())
+                block->setXrefFile(QString::fromUtf8(data.xrefPath.c_str()));
 
             if (graphic->addBlock(block)) {
                 currentContainer = block;
@@ -387,6 +740,9 @@ void RS_FilterDXFRW::endBlock() {
  * Implementation of the method which handles point entities.
  */
 void RS_FilterDXFRW::addPoint(const DRW_Point& data) {
+    const LC_ImportProfile::Phase phase{profile.get(), "POINT"};
+    if (isSkipped(data))
+        return;
     RS_Vector v(data.basePoint.x, data.basePoint.y);
 
     RS_Point* entity = new RS_Point(currentContainer,
@@ -402,26 +758,29 @@ void RS_FilterDXFRW::addPoint(const DRW_Point& data) {
  * Implementation of the method which handles line entities.
  */
 void RS_FilterDXFRW::addLine(const DRW_Line& data) {
-    RS_DEBUG->print("RS_FilterDXF::addLine");
+    const LC_ImportProfile::Phase phase{profile.get(), "LINE"};
+    if (isSkipped(data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLine");
 
     RS_Vector v1(data.basePoint.x, data.basePoint.y);
     RS_Vector v2(data.secPoint.x, data.secPoint.y);
 
-    RS_DEBUG->print("RS_FilterDXF::addLine: create line");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLine: create line");
 
 	if (!currentContainer) {
-		RS_DEBUG->print("RS_FilterDXF::addLine: currentContainer is nullptr");
+		RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLine: currentContainer is nullptr");
     }
 
 	RS_Line* entity = new RS_Line{currentContainer, {v1, v2}};
-    RS_DEBUG->print("RS_FilterDXF::addLine: set attributes");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLine: set attributes");
     setEntityAttributes(entity, &data);
 
-    RS_DEBUG->print("RS_FilterDXF::addLine: add entity");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLine: add entity");
 
 	if (currentContainer) currentContainer->addEntity(entity);
 
-    RS_DEBUG->print("RS_FilterDXF::addLine: OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addLine: OK");
 }
 
 
@@ -429,27 +788,30 @@ void RS_FilterDXFRW::addLine(const DRW_Line& data) {
  * Implementation of the method which handles ray entities.
  */
 void RS_FilterDXFRW::addRay(const DRW_Ray& data) {
-    RS_DEBUG->print("RS_FilterDXF::addRay");
+    const LC_ImportProfile::Phase phase{profile.get(), "RAY"};
+    if (isSkipped(data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addRay");
 
 	RS_Vector v1{data.basePoint.x, data.basePoint.y};
 	RS_Vector v2{data.basePoint.x+data.secPoint.x,
 				data.basePoint.y+data.secPoint.y};
 
-    RS_DEBUG->print("RS_FilterDXF::addRay: create line");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addRay: create line");
 
 	if (!currentContainer) {
-		RS_DEBUG->print("RS_FilterDXF::addRay: currentContainer is nullptr");
+		RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addRay: currentContainer is nullptr");
     }
 
 	RS_Line* entity = new RS_Line{currentContainer, {v1, v2}};
-    RS_DEBUG->print("RS_FilterDXF::addRay: set attributes");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addRay: set attributes");
     setEntityAttributes(entity, &data);
 
-    RS_DEBUG->print("RS_FilterDXF::addRay: add entity");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addRay: add entity");
 
 	if (currentContainer) currentContainer->addEntity(entity);
 
-    RS_DEBUG->print("RS_FilterDXF::addRay: OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addRay: OK");
 }
 
 
@@ -457,26 +819,29 @@ void RS_FilterDXFRW::addRay(const DRW_Ray& data) {
  * Implementation of the method which handles line entities.
  */
 void RS_FilterDXFRW::addXline(const DRW_Xline& data) {
-    RS_DEBUG->print("RS_FilterDXF::addXline");
+    const LC_ImportProfile::Phase phase{profile.get(), "XLINE"};
+    if (isSkipped(data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addXline");
 
     RS_Vector v1(data.basePoint.x, data.basePoint.y);
     RS_Vector v2(data.basePoint.x+data.secPoint.x, data.basePoint.y+data.secPoint.y);
 
-    RS_DEBUG->print("RS_FilterDXF::addXline: create line");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addXline: create line");
 
 	if (!currentContainer) {
-		RS_DEBUG->print("RS_FilterDXF::addXline: currentContainer is nullptr");
+		RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addXline: currentContainer is nullptr");
     }
 
 	RS_Line* entity = new RS_Line{currentContainer, {v1, v2}};
-    RS_DEBUG->print("RS_FilterDXF::addXline: set attributes");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addXline: set attributes");
     setEntityAttributes(entity, &data);
 
-    RS_DEBUG->print("RS_FilterDXF::addXline: add entity");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addXline: add entity");
 
 	if (currentContainer) currentContainer->addEntity(entity);
 
-    RS_DEBUG->print("RS_FilterDXF::addXline: OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addXline: OK");
 }
 
 
@@ -485,7 +850,10 @@ void RS_FilterDXFRW::addXline(const DRW_Xline& data) {
  * Implementation of the method which handles circle entities.
  */
 void RS_FilterDXFRW::addCircle(const DRW_Circle& data) {
-    RS_DEBUG->print("RS_FilterDXF::addCircle");
+    const LC_ImportProfile::Phase phase{profile.get(), "CIRCLE"};
+    if (isSkipped(data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addCircle");
 
 	RS_Vector v{data.basePoint.x, data.basePoint.y};
 	RS_Circle* entity = new RS_Circle(currentContainer, {v, data.radious});
@@ -503,7 +871,10 @@ void RS_FilterDXFRW::addCircle(const DRW_Circle& data) {
  * @param angle2 End angle in deg (!)
  */
 void RS_FilterDXFRW::addArc(const DRW_Arc& data) {
-    RS_DEBUG->print("RS_FilterDXF::addArc");
+    const LC_ImportProfile::Phase phase{profile.get(), "ARC"};
+    if (isSkipped(data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addArc");
     RS_Vector v(data.basePoint.x, data.basePoint.y);
     RS_ArcData d(v, data.radious,
                  data.staangle,
@@ -524,7 +895,10 @@ void RS_FilterDXFRW::addArc(const DRW_Arc& data) {
  * @param angle2 End angle in rad (!)
  */
 void RS_FilterDXFRW::addEllipse(const DRW_Ellipse& data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addEllipse");
+    const LC_ImportProfile::Phase phase{profile.get(), "ELLIPSE"};
+    if (isSkipped(data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addEllipse");
 
 	RS_Vector v1(data.basePoint.x, data.basePoint.y);
 	RS_Vector v2(data.secPoint.x, data.secPoint.y);
@@ -546,6 +920,9 @@ void RS_FilterDXFRW::addEllipse(const DRW_Ellipse& data) {
  * Implementation of the method which handles trace entities.
  */
 void RS_FilterDXFRW::addTrace(const DRW_Trace& data) {
+    const LC_ImportProfile::Phase phase{profile.get(), "SOLID/TRACE"};
+    if (isSkipped(data))
+        return;
     RS_Solid* entity;
 	RS_Vector v1{data.basePoint.x, data.basePoint.y};
 	RS_Vector v2{data.secPoint.x, data.secPoint.y};
@@ -571,7 +948,10 @@ void RS_FilterDXFRW::addSolid(const DRW_Solid& data) {
  * Implementation of the method which handles lightweight polyline entities.
  */
 void RS_FilterDXFRW::addLWPolyline(const DRW_LWPolyline& data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addLWPolyline");
+    const LC_ImportProfile::Phase phase{profile.get(), "LWPOLYLINE"};
+    if (isSkipped(data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addLWPolyline");
     if (data.vertlist.empty())
         return;
     RS_PolylineData d(RS_Vector{},
@@ -594,7 +974,10 @@ void RS_FilterDXFRW::addLWPolyline(const DRW_LWPolyline& data) {
  * Implementation of the method which handles polyline entities.
  */
 void RS_FilterDXFRW::addPolyline(const DRW_Polyline& data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addPolyline");
+    const LC_ImportProfile::Phase phase{profile.get(), "POLYLINE"};
+    if (isSkipped(data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addPolyline");
     if ( data.flags&0x10)
         return; //the polyline is a polygon mesh, not handled
 
@@ -624,7 +1007,10 @@ void RS_FilterDXFRW::addPolyline(const DRW_Polyline& data) {
  * Implementation of the method which handles splines.
  */
 void RS_FilterDXFRW::addSpline(const DRW_Spline* data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addSpline: degree: %d", data->degree);
+    const LC_ImportProfile::Phase phase{profile.get(), "SPLINE"};
+    if (isSkipped(*data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addSpline: degree: %d", data->degree);
 
 	if(data->degree == 2)
 	{
@@ -669,7 +1055,7 @@ void RS_FilterDXFRW::addSpline(const DRW_Spline* data) {
 
         currentContainer->addEntity(spline);
     } else {
-        RS_DEBUG->print(RS_Debug::D_WARNING,
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING,
                         "RS_FilterDXF::addSpline: Invalid degree for spline: %d. "
                         "Accepted values are 1..3.", data->degree);
         return;
@@ -693,8 +1079,11 @@ void RS_FilterDXFRW::addSpline(const DRW_Spline* data) {
  * Implementation of the method which handles inserts.
  */
 void RS_FilterDXFRW::addInsert(const DRW_Insert& data) {
+    const LC_ImportProfile::Phase phase{profile.get(), "INSERT"};
+    if (isSkipped(data))
+        return;
 
-    RS_DEBUG->print("RS_FilterDXF::addInsert");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addInsert");
 
     RS_Vector ip(data.basePoint.x, data.basePoint.y);
     RS_Vector sc(data.xscale, data.yscale);
@@ -708,7 +1097,7 @@ void RS_FilterDXFRW::addInsert(const DRW_Insert& data) {
 					sp, nullptr, RS2::NoUpdate);
     RS_Insert* entity = new RS_Insert(currentContainer, d);
     setEntityAttributes(entity, &data);
-    RS_DEBUG->print("  id: %lu", entity->getId());
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "  id: %lu", entity->getId());
 //    entity->update();
     currentContainer->addEntity(entity);
 }
@@ -720,7 +1109,10 @@ void RS_FilterDXFRW::addInsert(const DRW_Insert& data) {
  * multi texts (MTEXT).
  */
 void RS_FilterDXFRW::addMText(const DRW_MText& data) {
-    RS_DEBUG->print("RS_FilterDXF::addMText: %s", data.text.c_str());
+    const LC_ImportProfile::Phase phase{profile.get(), "MTEXT"};
+    if (isSkipped(data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addMText: %s", data.text.c_str());
 
     RS_MTextData::VAlign valign;
     RS_MTextData::HAlign halign;
@@ -771,7 +1163,7 @@ void RS_FilterDXFRW::addMText(const DRW_MText& data) {
         sty = fontList.value(sty, sty);
     }
 
-    RS_DEBUG->print("Text as unicode:");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "Text as unicode:");
     RS_DEBUG->printUnicode(mtext);
     double interlin = data.interlin;
     double angle = data.angle*M_PI/180.;
@@ -811,7 +1203,8 @@ void RS_FilterDXFRW::addMText(const DRW_MText& data) {
     RS_MText* entity = new RS_MText(currentContainer, d);
 
     setEntityAttributes(entity, &data);
-    entity->update();
+    // laid out after reading, with the other texts
+    pendingTexts.push_back(entity);
     currentContainer->addEntity(entity);
 }
 
@@ -822,7 +1215,10 @@ void RS_FilterDXFRW::addMText(const DRW_MText& data) {
  * texts (TEXT).
  */
 void RS_FilterDXFRW::addText(const DRW_Text& data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addText");
+    const LC_ImportProfile::Phase phase{profile.get(), "TEXT"};
+    if (isSkipped(data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addText");
     RS_Vector refPoint = RS_Vector(data.basePoint.x, data.basePoint.y);;
     RS_Vector secPoint = RS_Vector(data.secPoint.x, data.secPoint.y);;
     double angle = data.angle;
@@ -860,7 +1256,7 @@ void RS_FilterDXFRW::addText(const DRW_Text& data) {
         sty = fontList.value(sty, sty);
     }
 
-    RS_DEBUG->print("Text as unicode:");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "Text as unicode:");
     RS_DEBUG->printUnicode(mtext);
 
     RS_TextData d(refPoint, secPoint, data.height, data.widthscale,
@@ -870,7 +1266,8 @@ void RS_FilterDXFRW::addText(const DRW_Text& data) {
     RS_Text* entity = new RS_Text(currentContainer, d);
 
     setEntityAttributes(entity, &data);
-    entity->update();
+    // laid out after reading, with the other texts
+    pendingTexts.push_back(entity);
     currentContainer->addEntity(entity);
 }
 
@@ -928,7 +1325,7 @@ RS_DimensionData RS_FilterDXFRW::convDimensionData(const  DRW_Dimension* data) {
         sty = dimStyle;
     }
 
-    RS_DEBUG->print("Text as unicode:");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "Text as unicode:");
     RS_DEBUG->printUnicode(t);
 
     // data needed to add the actual dimension entity
@@ -946,7 +1343,10 @@ RS_DimensionData RS_FilterDXFRW::convDimensionData(const  DRW_Dimension* data) {
  * aligned dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimAlign(const DRW_DimAligned *data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addDimAligned");
+    const LC_ImportProfile::Phase phase{profile.get(), "DIMENSION aligned"};
+    if (isSkipped(*data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addDimAligned");
 
     RS_DimensionData dimensionData = convDimensionData((DRW_Dimension*)data);
 
@@ -959,7 +1359,10 @@ void RS_FilterDXFRW::addDimAlign(const DRW_DimAligned *data) {
                             dimensionData, d);
     setEntityAttributes(entity, data);
     entity->updateDimPoint();
-    entity->update();
+    {
+        const LC_ImportProfile::Phase update{profile.get(), "dimension update"};
+        entity->update();
+    }
     currentContainer->addEntity(entity);
 }
 
@@ -970,7 +1373,10 @@ void RS_FilterDXFRW::addDimAlign(const DRW_DimAligned *data) {
  * linear dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimLinear(const DRW_DimLinear *data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addDimLinear");
+    const LC_ImportProfile::Phase phase{profile.get(), "DIMENSION linear"};
+    if (isSkipped(*data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addDimLinear");
 
     RS_DimensionData dimensionData = convDimensionData((DRW_Dimension*)data);
 
@@ -983,7 +1389,10 @@ void RS_FilterDXFRW::addDimLinear(const DRW_DimLinear *data) {
     RS_DimLinear* entity = new RS_DimLinear(currentContainer,
                                             dimensionData, d);
     setEntityAttributes(entity, data);
-    entity->update();
+    {
+        const LC_ImportProfile::Phase update{profile.get(), "dimension update"};
+        entity->update();
+    }
     currentContainer->addEntity(entity);
 }
 
@@ -994,7 +1403,10 @@ void RS_FilterDXFRW::addDimLinear(const DRW_DimLinear *data) {
  * radial dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimRadial(const DRW_DimRadial* data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addDimRadial");
+    const LC_ImportProfile::Phase phase{profile.get(), "DIMENSION radial"};
+    if (isSkipped(*data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addDimRadial");
 
     RS_DimensionData dimensionData = convDimensionData((DRW_Dimension*)data);
     RS_Vector dp(data->getDiameterPoint().x, data->getDiameterPoint().y);
@@ -1005,7 +1417,10 @@ void RS_FilterDXFRW::addDimRadial(const DRW_DimRadial* data) {
                                             dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
+    {
+        const LC_ImportProfile::Phase update{profile.get(), "dimension update"};
+        entity->update();
+    }
     currentContainer->addEntity(entity);
 }
 
@@ -1016,7 +1431,10 @@ void RS_FilterDXFRW::addDimRadial(const DRW_DimRadial* data) {
  * diametric dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimDiametric(const DRW_DimDiametric* data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addDimDiametric");
+    const LC_ImportProfile::Phase phase{profile.get(), "DIMENSION diametric"};
+    if (isSkipped(*data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addDimDiametric");
 
     RS_DimensionData dimensionData = convDimensionData((DRW_Dimension*)data);
     RS_Vector dp(data->getDiameter1Point().x, data->getDiameter1Point().y);
@@ -1027,7 +1445,10 @@ void RS_FilterDXFRW::addDimDiametric(const DRW_DimDiametric* data) {
                               dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
+    {
+        const LC_ImportProfile::Phase update{profile.get(), "dimension update"};
+        entity->update();
+    }
     currentContainer->addEntity(entity);
 }
 
@@ -1038,7 +1459,10 @@ void RS_FilterDXFRW::addDimDiametric(const DRW_DimDiametric* data) {
  * angular dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimAngular(const DRW_DimAngular* data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addDimAngular");
+    const LC_ImportProfile::Phase phase{profile.get(), "DIMENSION angular"};
+    if (isSkipped(*data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addDimAngular");
 
     RS_DimensionData dimensionData = convDimensionData(data);
     RS_Vector dp1(data->getFirstLine1().x, data->getFirstLine1().y);
@@ -1052,7 +1476,10 @@ void RS_FilterDXFRW::addDimAngular(const DRW_DimAngular* data) {
                             dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
+    {
+        const LC_ImportProfile::Phase update{profile.get(), "dimension update"};
+        entity->update();
+    }
     currentContainer->addEntity(entity);
 }
 
@@ -1063,7 +1490,10 @@ void RS_FilterDXFRW::addDimAngular(const DRW_DimAngular* data) {
  * angular dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimAngular3P(const DRW_DimAngular3p* data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addDimAngular3P");
+    const LC_ImportProfile::Phase phase{profile.get(), "DIMENSION angular 3P"};
+    if (isSkipped(*data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addDimAngular3P");
 
     RS_DimensionData dimensionData = convDimensionData(data);
     RS_Vector dp1(data->getFirstLine().x, data->getFirstLine().y);
@@ -1078,14 +1508,17 @@ void RS_FilterDXFRW::addDimAngular3P(const DRW_DimAngular3p* data) {
                             dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
+    {
+        const LC_ImportProfile::Phase update{profile.get(), "dimension update"};
+        entity->update();
+    }
     currentContainer->addEntity(entity);
 }
 
 
 
 void RS_FilterDXFRW::addDimOrdinate(const DRW_DimOrdinate* /*data*/) {
-    RS_DEBUG->print("RS_FilterDXFRW::addDimOrdinate(const DL_DimensionData&, const DL_DimOrdinateData&) not yet implemented");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addDimOrdinate(const DL_DimensionData&, const DL_DimOrdinateData&) not yet implemented");
 }
 
 
@@ -1093,7 +1526,10 @@ void RS_FilterDXFRW::addDimOrdinate(const DRW_DimOrdinate* /*data*/) {
  * Implementation of the method which handles leader entities.
  */
 void RS_FilterDXFRW::addLeader(const DRW_Leader *data) {
-    RS_DEBUG->print("RS_FilterDXFRW::addDimLeader");
+    const LC_ImportProfile::Phase phase{profile.get(), "LEADER"};
+    if (isSkipped(*data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::addDimLeader");
     RS_LeaderData d(data->arrow!=0);
     RS_Leader* leader = new RS_Leader(currentContainer, d);
     setEntityAttributes(leader, data);
@@ -1112,7 +1548,10 @@ void RS_FilterDXFRW::addLeader(const DRW_Leader *data) {
  * Implementation of the method which handles hatch entities.
  */
 void RS_FilterDXFRW::addHatch(const DRW_Hatch *data) {
-    RS_DEBUG->print("RS_FilterDXF::addHatch()");
+    const LC_ImportProfile::Phase phase{profile.get(), "HATCH"};
+    if (isSkipped(*data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addHatch()");
     RS_Hatch* hatch;
     RS_EntityContainer* hatchLoop;
 
@@ -1137,8 +1576,7 @@ void RS_FilterDXFRW::addHatch(const DRW_Hatch *data) {
 			for (auto const& vert: pline->vertlist)
 				polyline.addVertex(RS_Vector{vert->x, vert->y}, vert->bulge);
 
-			for (RS_Entity* e=polyline.firstEntity(); e;
-					e=polyline.nextEntity()) {
+			for (RS_Entity* e: polyline.resolvedEntities()) {
                 RS_Entity* tmp = e->clone();
                 tmp->reparent(hatchLoop);
 				tmp->setLayer(nullptr);
@@ -1223,12 +1661,13 @@ void RS_FilterDXFRW::addHatch(const DRW_Hatch *data) {
 
     }
 
-    RS_DEBUG->print("hatch->update()");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "hatch->update()");
     if (hatch->validate()) {
+        const LC_ImportProfile::Phase update{profile.get(), "hatch update"};
         hatch->update();
     } else {
         graphic->removeEntity(hatch);
-        RS_DEBUG->print(RS_Debug::D_ERROR,
+        RS_DEBUG_PRINT(RS_Debug::D_ERROR,
                     "RS_FilterDXFRW::endEntity(): updating hatch failed: invalid hatch area");
     }
 }
@@ -1238,7 +1677,10 @@ void RS_FilterDXFRW::addHatch(const DRW_Hatch *data) {
  * Implementation of the method which handles image entities.
  */
 void RS_FilterDXFRW::addImage(const DRW_Image *data) {
-    RS_DEBUG->print("RS_FilterDXF::addImage");
+    const LC_ImportProfile::Phase phase{profile.get(), "IMAGE"};
+    if (isSkipped(*data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addImage");
 
     RS_Vector ip(data->basePoint.x, data->basePoint.y);
     RS_Vector uv(data->secPoint.x, data->secPoint.y);
@@ -1260,7 +1702,8 @@ void RS_FilterDXFRW::addImage(const DRW_Image *data) {
  * Implementation of the method which links image entities to image files.
  */
 void RS_FilterDXFRW::linkImage(const DRW_ImageDef *data) {
-    RS_DEBUG->print("RS_FilterDXFRW::linkImage");
+    const LC_ImportProfile::Phase phase{profile.get(), "IMAGEDEF"};
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::linkImage");
 
     int handle = data->handle;
     QString sfile(QString::fromUtf8(data->name.c_str()));
@@ -1271,33 +1714,32 @@ void RS_FilterDXFRW::linkImage(const DRW_ImageDef *data) {
 
     // first: absolute path:
     if (!fiBitmap.exists()) {
-        RS_DEBUG->print("File %s doesn't exist.",
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "File %s doesn't exist.",
                         (const char*)QFile::encodeName(sfile));
         // try relative path:
         QString f1 = fiDxf.absolutePath() + "/" + sfile;
         if (QFileInfo(f1).exists()) {
             sfile = f1;
         } else {
-            RS_DEBUG->print("File %s doesn't exist.", (const char*)QFile::encodeName(f1));
+            RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "File %s doesn't exist.", (const char*)QFile::encodeName(f1));
             // try drawing path:
             QString f2 = fiDxf.absolutePath() + "/" + fiBitmap.fileName();
             if (QFileInfo(f2).exists()) {
                 sfile = f2;
             } else {
-                RS_DEBUG->print("File %s doesn't exist.", (const char*)QFile::encodeName(f2));
+                RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "File %s doesn't exist.", (const char*)QFile::encodeName(f2));
             }
         }
     }
 
     // Also link images in subcontainers (e.g. inserts):
-    for (RS_Entity* e=graphic->firstEntity(RS2::ResolveNone);
-            e; e=graphic->nextEntity(RS2::ResolveNone)) {
+    for (RS_Entity* e: graphic->resolvedEntities(RS2::ResolveNone)) {
         if (e->rtti()==RS2::EntityImage) {
             RS_Image* img = (RS_Image*)e;
             if (img->getHandle()==handle) {
                 img->setFile(sfile);
-                RS_DEBUG->print("image found: %s", (const char*)QFile::encodeName(img->getFile()));
-                img->update();
+                RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "image found: %s", (const char*)QFile::encodeName(img->getFile()));
+                img->updateInBackground();
             }
         }
     }
@@ -1305,20 +1747,19 @@ void RS_FilterDXFRW::linkImage(const DRW_ImageDef *data) {
     // update images in blocks:
     for (unsigned i=0; i<graphic->countBlocks(); ++i) {
         RS_Block* b = graphic->blockAt(i);
-        for (RS_Entity* e=b->firstEntity(RS2::ResolveNone);
-                e; e=b->nextEntity(RS2::ResolveNone)) {
+        for (RS_Entity* e: b->resolvedEntities(RS2::ResolveNone)) {
             if (e->rtti()==RS2::EntityImage) {
                 RS_Image* img = (RS_Image*)e;
                 if (img->getHandle()==handle) {
                     img->setFile(sfile);
-                    RS_DEBUG->print("image in block found: %s",
+                    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "image in block found: %s",
                                     (const char*)QFile::encodeName(img->getFile()));
-                    img->update();
+                    img->updateInBackground();
                 }
             }
         }
     }
-    RS_DEBUG->print("linking image: OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "linking image: OK");
 }
 
 using std::map;
@@ -1326,13 +1767,15 @@ using std::map;
  * Sets the header variables from the DXF file.
  */
 void RS_FilterDXFRW::addHeader(const DRW_Header* data){
+    const LC_ImportProfile::Phase phase{profile.get(), "HEADER"};
 	RS_Graphic* container = nullptr;
     if (currentContainer->rtti()==RS2::EntityGraphic) {
         container = (RS_Graphic*)currentContainer;
     } else return;
 
     for (auto it = data->vars.begin() ; it != data->vars.end(); ++it ) {
-        QString key = QString::fromStdString((*it).first);
+        //header variable names are ASCII
+        const QString key = QString::fromLatin1((*it).first.data(), static_cast<int>((*it).first.size()));
         DRW_Variant *var = (*it).second;
         switch (var->type()) {
         case DRW_Variant::COORD:
@@ -1340,7 +1783,7 @@ void RS_FilterDXFRW::addHeader(const DRW_Header* data){
             RS_Vector(var->content.v->x, var->content.v->y, var->content.v->z), var->code());
             break;
         case DRW_Variant::STRING:
-            container->addVariable(key, QString::fromUtf8(var->content.s->c_str()), var->code());
+            container->addVariableUtf8(key, QByteArray(var->content.s->data(), static_cast<int>(var->content.s->size())), var->code());
             break;
         case DRW_Variant::INTEGER:
             container->addVariable(key, var->content.i, var->code());
@@ -1417,9 +1860,9 @@ void RS_FilterDXFRW::addHeader(const DRW_Header* data){
  */
 bool RS_FilterDXFRW::fileExport(RS_Graphic& g, const QString& file, RS2::FormatType type) {
 
-    RS_DEBUG->print("RS_FilterDXFDW::fileExport: exporting file '%s'...",
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFDW::fileExport: exporting file '%s'...",
                     (const char*)QFile::encodeName(file));
-    RS_DEBUG->print("RS_FilterDXFDW::fileExport: file type '%d'", (int)type);
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFDW::fileExport: file type '%d'", (int)type);
 
     this->graphic = &g;
 
@@ -1428,13 +1871,45 @@ bool RS_FilterDXFRW::fileExport(RS_Graphic& g, const QString& file, RS2::FormatT
 
     QString path = QFileInfo(file).absolutePath();
     if (QFileInfo(path).isWritable()==false) {
-        RS_DEBUG->print("RS_FilterDXFRW::fileExport: can't write file: "
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::fileExport: can't write file: "
                         "no permission");
         return false;
     }
     //
 #endif
 
+    // compressed files can't be copied by byte ranges
+    const bool incremental = incrementalSave && !file.endsWith(".gz", Qt::CaseInsensitive);
+    bool success = incremental ? writeIncremental(file, type)
+                               : writeDxf(file, type, type == RS2::FormatDXFRWBinary);
+/*RLZ pte*/
+/*    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "writing tables...");
+    dw->sectionTables();
+    // VPORT:
+    dxf.writeVPort(*dw);
+    dw->tableEnd();
+
+    // VIEW:
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "writing views...");
+    dxf.writeView(*dw);
+
+    // UCS:
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "writing ucs...");
+    dxf.writeUcs(*dw);
+
+    // Appid:
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "writing appid...");
+    dw->tableAppid(1);
+    writeAppid(*dw, "ACAD");
+    dw->tableEnd();
+*/
+    return success;
+}
+
+/**
+ * Writes the graphic to a DXF file, in the version of the format type.
+ */
+bool RS_FilterDXFRW::writeDxf(const QString& file, RS2::FormatType type, bool binary) {
     // set version for DXF filter:
     exactColor = false;
     DRW::Version exportVersion;
@@ -1458,35 +1933,64 @@ bool RS_FilterDXFRW::fileExport(RS_Graphic& g, const QString& file, RS2::FormatT
     }
 
     dxfW = new dxfRW(QFile::encodeName(file));
-    bool success = dxfW->write(this, exportVersion, false); //ascii
-//    bool success = dxf->write(this, exportVersion, true); //binary
+    dxfW->setWriteThreads(QThread::idealThreadCount());
+    // the positions of the entities are recorded as byte offsets
+    dxfW->setRawOutput(saveIndex != nullptr);
+    bool success = dxfW->write(this, exportVersion, binary);
     delete dxfW;
 
     if (!success) {
-        RS_DEBUG->print("RS_FilterDXFDW::fileExport: can't write file");
-        return false;
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFDW::fileExport: can't write file");
     }
-/*RLZ pte*/
-/*    RS_DEBUG->print("writing tables...");
-    dw->sectionTables();
-    // VPORT:
-    dxf.writeVPort(*dw);
-    dw->tableEnd();
-
-    // VIEW:
-    RS_DEBUG->print("writing views...");
-    dxf.writeView(*dw);
+    return success;
+}
 
-    // UCS:
-    RS_DEBUG->print("writing ucs...");
-    dxf.writeUcs(*dw);
+/**
+ * Saves the graphic incrementally: if the file was saved before by this filter in the
+ * same format, and not changed since then, the records of the unchanged entities
+ * are copied from it. The file is written aside, and replaces the old one when complete.
+ */
+bool RS_FilterDXFRW::writeIncremental(const QString& file, RS2::FormatType type) {
+    const QString fileName = QFileInfo(file).absoluteFilePath();
+    const QString codePage = graphic->getVariableString("$DWGCODEPAGE", "ANSI_1252");
+    const bool binary = type == RS2::FormatDXFRWBinary;
+
+    previousIndex = graphic->getDxfSaveIndex(fileName);
+    if (previousIndex != nullptr && previousIndex->isValidFor(fileName, type, codePage)) {
+        previousFile = std::make_unique<std::ifstream>(QFile::encodeName(fileName).constData(),
+                                                       std::ios::in | std::ios::binary);
+        if (!previousFile->is_open())
+            previousIndex.reset();
+    } else {
+        previousIndex.reset();
+    }
 
-    // Appid:
-    RS_DEBUG->print("writing appid...");
-    dw->tableAppid(1);
-    writeAppid(*dw, "ACAD");
-    dw->tableEnd();
-*/
+    const QString part = fileName + QString(".%1.part").arg(QCoreApplication::applicationPid());
+    saveIndex = std::make_shared<LC_DxfSaveIndex>(type, codePage);
+    copyFailed = false;
+    bool success = writeDxf(part, type, binary);
+    if (success && copyFailed) {
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING, "RS_FilterDXFRW::writeIncremental: can't copy from '%s', "
+                        "writing all entities", (const char*)QFile::encodeName(fileName));
+        previousIndex.reset();
+        saveIndex = std::make_shared<LC_DxfSaveIndex>(type, codePage);
+        success = writeDxf(part, type, binary);
+    }
+    previousFile.reset();
+    previousIndex.reset();
+
+    if (success && QFileInfo::exists(fileName))
+        QFile::setPermissions(part, QFile::permissions(fileName));
+    success = success && replaceFile(part, fileName);
+    if (success) {
+        saveIndex->setWritten(fileName);
+        graphic->setDxfSaveIndex(fileName, saveIndex);
+    } else {
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING, "RS_FilterDXFRW::writeIncremental: can't write '%s'",
+                        (const char*)QFile::encodeName(fileName));
+        QFile::remove(part);
+    }
+    saveIndex.reset();
     return success;
 }
 
@@ -1494,24 +1998,13 @@ bool RS_FilterDXFRW::fileExport(RS_Graphic& g, const QString& file, RS2::FormatT
  * Prepare unnamed blocks.
  */
 void RS_FilterDXFRW::prepareBlocks() {
-    RS_Block *blk;
-    int dimNum = 0, hatchNum= 0;
-    QString prefix, sufix;
-
-    //check for existing *D?? or  *U??
-    for (unsigned i = 0; i < graphic->countBlocks(); i++) {
-        blk = graphic->blockAt(i);
-        prefix = blk->getName().left(2).toUpper();
-        sufix = blk->getName().mid(2);
-        if (prefix == "*D") {
-            if (sufix.toInt() > dimNum) dimNum = sufix.toInt();
-        } else if (prefix == "*U") {
-            if (sufix.toInt() > hatchNum) hatchNum = sufix.toInt();
-        }
-    }
+    //continue the numbers of existing *D?? or *U??
+    int dimNum = graphic->getBlockList()->getAnonymousNumber('D');
+    int hatchNum = graphic->getBlockList()->getAnonymousNumber('U');
+    QString prefix;
+    noNameBlock.clear();
     //Add a name to each dimension, in dxfR12 also for hatches
-    for (RS_Entity *e = graphic->firstEntity(RS2::ResolveNone);
-		 e ; e = graphic->nextEntity(RS2::ResolveNone)) {
+    for (RS_Entity* e: graphic->resolvedEntities(RS2::ResolveNone)) {
         if ( !(e->getFlag(RS2::FlagUndone)) ) {
             switch (e->rtti()) {
             case RS2::EntityDimLinear:
@@ -1555,7 +2048,7 @@ void RS_FilterDXFRW::writeBlockRecords(){
     for (unsigned i = 0; i < graphic->countBlocks(); i++) {
         blk = graphic->blockAt(i);
         if (!blk->isUndone()){
-            RS_DEBUG->print("writing block record: %s", (const char*)blk->getName().toLocal8Bit());
+            RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "writing block record: %s", (const char*)blk->getName().toLocal8Bit());
             dxfW->writeBlockRecord(blk->getName().toUtf8().data());
         }
     }
@@ -1577,13 +2070,7 @@ void RS_FilterDXFRW::writeBlocks() {
         block.basePoint.z = 0.0;
         block.flags = 1;//flag for unnamed block
         dxfW->writeBlock(&block);
-        RS_EntityContainer *ct = (RS_EntityContainer *)it.key();
-        for (RS_Entity* e=ct->firstEntity(RS2::ResolveNone);
-             e; e=ct->nextEntity(RS2::ResolveNone)) {
-            if ( !(e->getFlag(RS2::FlagUndone)) ) {
-                writeEntity(e);
-            }
-        }
+        writeContainerEntities(*static_cast<RS_EntityContainer*>(it.key()));
         ++it;
     }
 
@@ -1591,20 +2078,19 @@ void RS_FilterDXFRW::writeBlocks() {
     for (unsigned i = 0; i < graphic->countBlocks(); i++) {
         blk = graphic->blockAt(i);
         if (!blk->isUndone()) {
-            RS_DEBUG->print("writing block: %s", (const char*)blk->getName().toLocal8Bit());
+            RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "writing block: %s", (const char*)blk->getName().toLocal8Bit());
 
             DRW_Block block;
             block.name = blk->getName().toUtf8().data();
             block.basePoint.x = blk->getBasePoint().x;
             block.basePoint.y = blk->getBasePoint().y;
             block.basePoint.z = blk->getBasePoint().z;
-            dxfW->writeBlock(&block);
-            for (RS_Entity* e=blk->firstEntity(RS2::ResolveNone);
-                 e; e=blk->nextEntity(RS2::ResolveNone)) {
-                if ( !(e->getFlag(RS2::FlagUndone)) ) {
-                    writeEntity(e);
-                }
+            if (blk->isXref()) {
+                block.flags = 4;//flag for external reference
+                block.xrefPath = blk->getXrefFile().toUtf8().data();
             }
+            dxfW->writeBlock(&block);
+            writeContainerEntities(*blk);
         }
     }
 }
@@ -1947,7 +2433,7 @@ void RS_FilterDXFRW::writeLayers(){
         if( l->isConstruction()) {
             lay.extData.push_back(new DRW_Variant(1001, "LibreCad"));
             lay.extData.push_back(new DRW_Variant(1070, 1));
-            RS_DEBUG->print(RS_Debug::D_WARNING, "RS_FilterDXF::writeLayers: layer %s saved as construction layer", lay.name.c_str());
+            RS_DEBUG_PRINT(RS_Debug::D_WARNING, "RS_FilterDXF::writeLayers: layer %s saved as construction layer", lay.name.c_str());
         }
         dxfW->writeLayer(&lay);
     }
@@ -1957,8 +2443,7 @@ void RS_FilterDXFRW::writeTextstyles(){
     QHash<QString, QString> styles;
     QString sty;
     //Find fonts used by text entities in drawing
-    for (RS_Entity *e = graphic->firstEntity(RS2::ResolveNone);
-		 e ; e = graphic->nextEntity(RS2::ResolveNone)) {
+    for (RS_Entity* e: graphic->resolvedEntities(RS2::ResolveNone)) {
         if ( !(e->getFlag(RS2::FlagUndone)) ) {
             switch (e->rtti()) {
             case RS2::EntityMText:
@@ -1979,8 +2464,7 @@ void RS_FilterDXFRW::writeTextstyles(){
     RS_Block *blk;
     for (unsigned i = 0; i < graphic->countBlocks(); i++) {
         blk = graphic->blockAt(i);
-        for (RS_Entity *e = blk->firstEntity(RS2::ResolveNone);
-			 e ; e = blk->nextEntity(RS2::ResolveNone)) {
+        for (RS_Entity* e: blk->resolvedEntities(RS2::ResolveNone)) {
             if ( !(e->getFlag(RS2::FlagUndone)) ) {
                 switch (e->rtti()) {
                 case RS2::EntityMText:
@@ -2092,36 +2576,278 @@ void RS_FilterDXFRW::writeAppId(){
 }
 
 void RS_FilterDXFRW::writeEntities(){
-    for (RS_Entity *e = graphic->firstEntity(RS2::ResolveNone);
-		 e ; e = graphic->nextEntity(RS2::ResolveNone)) {
-        if ( !(e->getFlag(RS2::FlagUndone)) ) {
+    if (saveIndex != nullptr)
+        writeIndexedEntities();
+    else
+        writeContainerEntities(*graphic);
+}
+
+/**
+ * Writes the entities of the graphic in order, recording the positions of the
+ * independent entities in the index. Unchanged entities of the file saved before
+ * are copied, in large ranges of adjacent records, and keep their handles.
+ * Changed entities are written again with their handles, new ones get handles
+ * above the handles of the file saved before.
+ */
+void RS_FilterDXFRW::writeIndexedEntities(){
+    const LC_DxfSaveIndex* previous = copyFailed ? nullptr : previousIndex.get();
+    // the handles of the tables and blocks may not reach the entities saved before
+    if (previous != nullptr && dxfW->getHandleCount() > previous->firstHandle)
+        previous = nullptr;
+    if (previous != nullptr) {
+        saveIndex->firstHandle = previous->firstHandle;
+        dxfW->setHandleCount(std::max(dxfW->getHandleCount(), previous->lastHandle));
+    } else {
+        saveIndex->firstHandle = dxfW->getHandleCount();
+    }
+
+    // pending range of adjacent records in the file saved before
+    long long copyOffset = 0;
+    long long copySize = 0;
+    auto copyRecords = [this, &copyOffset, &copySize]() {
+        if (copySize > 0 && !dxfW->copyRecords(*previousFile, copyOffset, copySize))
+            copyFailed = true;
+        copySize = 0;
+    };
+
+    for (RS_Entity* e: graphic->resolvedEntities(RS2::ResolveNone)) {
+        if (e->getFlag(RS2::FlagUndone))
+            continue;
+        if (!isIndependentEntity(e)) {
+            copyRecords();
             writeEntity(e);
+            continue;
+        }
+        LC_DxfSaveIndex::Record record;
+        record.fingerprint = getFingerprint(e);
+        const LC_DxfSaveIndex::Record* old = previous != nullptr ? previous->find(e->getId()) : nullptr;
+        if (old != nullptr && old->fingerprint == record.fingerprint) {
+            if (copySize > 0 && copyOffset + copySize != old->offset)
+                copyRecords();
+            if (copySize == 0)
+                copyOffset = old->offset;
+            record.handle = old->handle;
+            record.offset = dxfW->getWritePosition() + copySize;
+            record.size = old->size;
+            copySize += old->size;
+        } else {
+            copyRecords();
+            record.offset = dxfW->getWritePosition();
+            if (old != nullptr) {
+                const int handleCount = dxfW->getHandleCount();
+                dxfW->setHandleCount(old->handle - 1);
+                writeIndependentEntity(*dxfW, e);
+                dxfW->setHandleCount(handleCount);
+                record.handle = old->handle;
+            } else {
+                writeIndependentEntity(*dxfW, e);
+                record.handle = dxfW->getHandleCount();
+            }
+            record.size = dxfW->getWritePosition() - record.offset;
         }
+        // empty polylines and texts are not written
+        if (record.size > 0)
+            saveIndex->insert(e->getId(), record);
     }
+    copyRecords();
+    saveIndex->lastHandle = dxfW->getHandleCount();
 }
 
-void RS_FilterDXFRW::writeEntity(RS_Entity* e){
+/**
+ * @return the hash of the data written for an independent entity, to find
+ * the entities changed since the file was saved
+ */
+quint64 RS_FilterDXFRW::getFingerprint(RS_Entity* e){
+    quint64 hash = 0xcbf29ce484222325ULL;
+    hashInt(hash, e->rtti());
+    DRW_Point attributes;
+    getEntityAttributes(&attributes, e);
+    hashString(hash, attributes.layer);
+    hashString(hash, attributes.lineType);
+    hashInt(hash, attributes.color);
+    hashInt(hash, attributes.color24);
+    hashInt(hash, attributes.lWeight);
+
     switch (e->rtti()) {
     case RS2::EntityPoint:
-        writePoint((RS_Point*)e);
+        hashVector(hash, static_cast<RS_Point*>(e)->getStartpoint());
+        break;
+    case RS2::EntityLine: {
+        auto* line = static_cast<RS_Line*>(e);
+        hashVector(hash, line->getStartpoint());
+        hashVector(hash, line->getEndpoint());
+        break;
+    }
+    case RS2::EntityCircle: {
+        auto* circle = static_cast<RS_Circle*>(e);
+        hashVector(hash, circle->getCenter());
+        hashDouble(hash, circle->getRadius());
+        break;
+    }
+    case RS2::EntityArc: {
+        auto* arc = static_cast<RS_Arc*>(e);
+        hashVector(hash, arc->getCenter());
+        hashDouble(hash, arc->getRadius());
+        hashDouble(hash, arc->getAngle1());
+        hashDouble(hash, arc->getAngle2());
+        hashInt(hash, arc->isReversed());
+        break;
+    }
+    case RS2::EntityEllipse: {
+        auto* ellipse = static_cast<RS_Ellipse*>(e);
+        hashVector(hash, ellipse->getCenter());
+        hashVector(hash, ellipse->getMajorP());
+        hashDouble(hash, ellipse->getRatio());
+        hashDouble(hash, ellipse->getAngle1());
+        hashDouble(hash, ellipse->getAngle2());
+        hashInt(hash, ellipse->isReversed());
+        break;
+    }
+    case RS2::EntitySolid: {
+        auto* solid = static_cast<RS_Solid*>(e);
+        hashInt(hash, solid->isTriangle());
+        for (int i = 0; i < (solid->isTriangle() ? 3 : 4); ++i)
+            hashVector(hash, solid->getCorner(i));
+        break;
+    }
+    case RS2::EntityPolyline: {
+        auto* polyline = static_cast<RS_Polyline*>(e);
+        hashInt(hash, polyline->isClosed());
+        if (polyline->isFlat()) {
+            // as the segment entities, which are created on demand
+            for (unsigned i = 0; i < polyline->count(); ++i) {
+                const RS_PolylineSegment segment = polyline->getSegment(i);
+                if (segment.isArc()) {
+                    const RS_Arc arc{nullptr, segment.getArcData()};
+                    hashVector(hash, arc.getStartpoint());
+                    hashVector(hash, arc.getEndpoint());
+                    hashDouble(hash, arc.getBulge());
+                } else {
+                    hashVector(hash, segment.start);
+                    hashVector(hash, segment.end);
+                    hashDouble(hash, 0.);
+                }
+            }
+            break;
+        }
+        for (RS_Entity* segment: polyline->resolvedEntities(RS2::ResolveNone)) {
+            if (!segment->isAtomic())
+                continue;
+            auto* atomic = static_cast<RS_AtomicEntity*>(segment);
+            hashVector(hash, atomic->getStartpoint());
+            hashVector(hash, atomic->getEndpoint());
+            hashDouble(hash, segment->rtti() == RS2::EntityArc ? static_cast<RS_Arc*>(segment)->getBulge() : 0.);
+        }
+        break;
+    }
+    case RS2::EntityText: {
+        auto* text = static_cast<RS_Text*>(e);
+        hashVector(hash, text->getInsertionPoint());
+        hashVector(hash, text->getSecondPoint());
+        hashDouble(hash, text->getHeight());
+        hashDouble(hash, text->getAngle());
+        hashDouble(hash, text->getWidthRel());
+        hashInt(hash, text->getHAlign());
+        hashInt(hash, text->getVAlign());
+        hashString(hash, text->getStyle().toStdString());
+        hashString(hash, text->getText().toStdString());
+        break;
+    }
+    default:
+        break;
+    }
+    return hash;
+}
+
+void RS_FilterDXFRW::writeContainerEntities(RS_EntityContainer& container){
+    // runs of independent entities are converted and written in parallel
+    std::vector<RS_Entity*> run;
+    auto writeRun = [this, &run]() {
+        if (run.empty())
+            return;
+        dxfW->writeEntities(run.size(), [this, &run](dxfRW& dxf, std::size_t i) {
+            writeIndependentEntity(dxf, run[i]);
+            return true;
+        });
+        run.clear();
+    };
+    for (RS_Entity* e: container.resolvedEntities(RS2::ResolveNone)) {
+        if (e->getFlag(RS2::FlagUndone))
+            continue;
+        if (isIndependentEntity(e)) {
+            run.push_back(e);
+        } else {
+            writeRun();
+            writeEntity(e);
+        }
+    }
+    writeRun();
+}
+
+/**
+ * @return true for entities written with a single handle, without using
+ * the writing state of the filter, so they can be written by worker threads.
+ */
+bool RS_FilterDXFRW::isIndependentEntity(const RS_Entity* e) const {
+    switch (e->rtti()) {
+    case RS2::EntityPoint:
+    case RS2::EntityLine:
+    case RS2::EntityCircle:
+    case RS2::EntityArc:
+    case RS2::EntitySolid:
+    case RS2::EntityText:
+        return true;
+    case RS2::EntityEllipse:
+    case RS2::EntityPolyline:
+        // version 12 polylines are written with vertices
+        return version != 1009;
+    default:
+        return false;
+    }
+}
+
+void RS_FilterDXFRW::writeIndependentEntity(dxfRW& dxf, RS_Entity* e){
+    switch (e->rtti()) {
+    case RS2::EntityPoint:
+        writePoint(dxf, (RS_Point*)e);
         break;
     case RS2::EntityLine:
-        writeLine((RS_Line*)e);
+        writeLine(dxf, (RS_Line*)e);
         break;
     case RS2::EntityCircle:
-        writeCircle((RS_Circle*)e);
+        writeCircle(dxf, (RS_Circle*)e);
         break;
     case RS2::EntityArc:
-        writeArc((RS_Arc*)e);
+        writeArc(dxf, (RS_Arc*)e);
         break;
     case RS2::EntitySolid:
-        writeSolid((RS_Solid*)e);
+        writeSolid(dxf, (RS_Solid*)e);
         break;
     case RS2::EntityEllipse:
-        writeEllipse((RS_Ellipse*)e);
+        writeEllipse(dxf, (RS_Ellipse*)e);
         break;
     case RS2::EntityPolyline:
-        writeLWPolyline((RS_Polyline*)e);
+        writeLWPolyline(dxf, (RS_Polyline*)e);
+        break;
+    case RS2::EntityText:
+        writeText(dxf, (RS_Text*)e);
+        break;
+    default:
+        break;
+    }
+}
+
+void RS_FilterDXFRW::writeEntity(RS_Entity* e){
+    switch (e->rtti()) {
+    case RS2::EntityPoint:
+    case RS2::EntityLine:
+    case RS2::EntityCircle:
+    case RS2::EntityArc:
+    case RS2::EntitySolid:
+    case RS2::EntityEllipse:
+    case RS2::EntityPolyline:
+    case RS2::EntityText:
+        writeIndependentEntity(*dxfW, e);
         break;
     case RS2::EntitySpline:
         writeSpline((RS_Spline*)e);
@@ -2138,9 +2864,6 @@ void RS_FilterDXFRW::writeEntity(RS_Entity* e){
     case RS2::EntityMText:
         writeMText((RS_MText*)e);
         break;
-    case RS2::EntityText:
-        writeText((RS_Text*)e);
-        break;
     case RS2::EntityDimLinear:
     case RS2::EntityDimAligned:
     case RS2::EntityDimAngular:
@@ -2166,46 +2889,46 @@ void RS_FilterDXFRW::writeEntity(RS_Entity* e){
 /**
  * Writes the given Point entity to the file.
  */
-void RS_FilterDXFRW::writePoint(RS_Point* p) {
+void RS_FilterDXFRW::writePoint(dxfRW& dxf, RS_Point* p) {
     DRW_Point point;
     getEntityAttributes(&point, p);
     point.basePoint.x = p->getStartpoint().x;
     point.basePoint.y = p->getStartpoint().y;
-    dxfW->writePoint(&point);
+    dxf.writePoint(&point);
 }
 
 
 /**
  * Writes the given Line( entity to the file.
  */
-void RS_FilterDXFRW::writeLine(RS_Line* l) {
+void RS_FilterDXFRW::writeLine(dxfRW& dxf, RS_Line* l) {
     DRW_Line line;
     getEntityAttributes(&line, l);
     line.basePoint.x = l->getStartpoint().x;
     line.basePoint.y = l->getStartpoint().y;
     line.secPoint.x = l->getEndpoint().x;
     line.secPoint.y = l->getEndpoint().y;
-    dxfW->writeLine(&line);
+    dxf.writeLine(&line);
 }
 
 
 /**
  * Writes the given circle entity to the file.
  */
-void RS_FilterDXFRW::writeCircle(RS_Circle* c) {
+void RS_FilterDXFRW::writeCircle(dxfRW& dxf, RS_Circle* c) {
     DRW_Circle circle;
     getEntityAttributes(&circle, c);
     circle.basePoint.x = c->getCenter().x;
     circle.basePoint.y = c->getCenter().y;
     circle.radious = c->getRadius();
-    dxfW->writeCircle(&circle);
+    dxf.writeCircle(&circle);
 }
 
 
 /**
  * Writes the given arc entity to the file.
  */
-void RS_FilterDXFRW::writeArc(RS_Arc* a) {
+void RS_FilterDXFRW::writeArc(dxfRW& dxf, RS_Arc* a) {
     DRW_Arc arc;
     getEntityAttributes(&arc, a);
     arc.basePoint.x = a->getCenter().x;
@@ -2218,14 +2941,14 @@ void RS_FilterDXFRW::writeArc(RS_Arc* a) {
         arc.staangle = a->getAngle1();
         arc.endangle = a->getAngle2();
     }
-    dxfW->writeArc(&arc);
+    dxf.writeArc(&arc);
 }
 
 
 /**
  * Writes the given polyline entity to the file as lwpolyline.
  */
-void RS_FilterDXFRW::writeLWPolyline(RS_Polyline* l) {
+void RS_FilterDXFRW::writeLWPolyline(dxfRW& dxf, RS_Polyline* l) {
     //skip if are empty polyline
     if (l->isEmpty())
             return;
@@ -2236,15 +2959,30 @@ void RS_FilterDXFRW::writeLWPolyline(RS_Polyline* l) {
     }
     DRW_LWPolyline pol;
     RS_Entity* currEntity = 0;
-    RS_Entity* nextEntity = 0;
 	RS_AtomicEntity* ae = nullptr;
     double bulge=0.0;
 
-    for (RS_Entity* e=l->firstEntity(RS2::ResolveNone);
-         e; e=nextEntity) {
+    if (l->isFlat()) {
+        // the vertices as read, the segment entities are not created
+        for (unsigned i = 0; i < l->count(); ++i) {
+            const RS_PolylineSegment segment = l->getSegment(i);
+            pol.addVertex(DRW_Vertex2D(segment.start.x, segment.start.y, segment.bulge));
+        }
+        if (l->isClosed()) {
+            pol.flags = 1;
+        } else {
+            const RS_PolylineSegment segment = l->getSegment(l->count() - 1);
+            pol.addVertex(DRW_Vertex2D(segment.end.x, segment.end.y, segment.bulge));
+        }
+        pol.vertexnum = pol.vertlist.size();
+        getEntityAttributes(&pol, l);
+        dxf.writeLWPolyline(&pol);
+        return;
+    }
+
+    for (RS_Entity* e: l->resolvedEntities(RS2::ResolveNone)) {
 
         currEntity = e;
-        nextEntity = l->nextEntity(RS2::ResolveNone);
 
         if (!e->isAtomic()) {
             continue;
@@ -2271,7 +3009,7 @@ void RS_FilterDXFRW::writeLWPolyline(RS_Polyline* l) {
     }
     pol.vertexnum = pol.vertlist.size();
     getEntityAttributes(&pol, l);
-    dxfW->writeLWPolyline(&pol);
+    dxf.writeLWPolyline(&pol);
 }
 
 /**
@@ -2280,15 +3018,29 @@ void RS_FilterDXFRW::writeLWPolyline(RS_Polyline* l) {
 void RS_FilterDXFRW::writePolyline(RS_Polyline* p) {
     DRW_Polyline pol;
     RS_Entity* currEntity = 0;
-    RS_Entity* nextEntity = 0;
 	RS_AtomicEntity* ae = nullptr;
     double bulge=0.0;
 
-    for (RS_Entity* e=p->firstEntity(RS2::ResolveNone);
-         e; e=nextEntity) {
+    if (p->isFlat()) {
+        // the vertices as read, the segment entities are not created
+        for (unsigned i = 0; i < p->count(); ++i) {
+            const RS_PolylineSegment segment = p->getSegment(i);
+            pol.addVertex(DRW_Vertex(segment.start.x, segment.start.y, 0.0, segment.bulge));
+        }
+        if (p->isClosed()) {
+            pol.flags = 1;
+        } else {
+            const RS_PolylineSegment segment = p->getSegment(p->count() - 1);
+            pol.addVertex(DRW_Vertex(segment.end.x, segment.end.y, 0.0, segment.bulge));
+        }
+        getEntityAttributes(&pol, p);
+        dxfW->writePolyline(&pol);
+        return;
+    }
+
+    for (RS_Entity* e: p->resolvedEntities(RS2::ResolveNone)) {
 
         currEntity = e;
-        nextEntity = p->nextEntity(RS2::ResolveNone);
 
         if (!e->isAtomic()) {
             continue;
@@ -2326,7 +3078,7 @@ void RS_FilterDXFRW::writeSpline(RS_Spline *s) {
         return;
 
     if (s->getNumberOfControlPoints() < size_t(s->getDegree()+1)) {
-        RS_DEBUG->print(RS_Debug::D_ERROR, "RS_FilterDXF::writeSpline: "
+        RS_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_FilterDXF::writeSpline: "
                         "Discarding spline: not enough control points given.");
         return;
     }
@@ -2334,9 +3086,7 @@ void RS_FilterDXFRW::writeSpline(RS_Spline *s) {
     // version 12 do not support Spline write as polyline
     if (version==1009) {
         DRW_Polyline pol;
-        RS_Entity* e;
-        for (e=s->firstEntity(RS2::ResolveNone);
-             e; e=s->nextEntity(RS2::ResolveNone)) {
+        for (RS_Entity* e: s->resolvedEntities(RS2::ResolveNone)) {
             pol.addVertex( DRW_Vertex(e->getStartpoint().x,
                                       e->getStartpoint().y, 0.0, 0.0));
         }
@@ -2454,7 +3204,7 @@ void RS_FilterDXFRW::writeSplinePoints(LC_SplinePoints *s)
 /**
  * Writes the given Ellipse entity to the file.
  */
-void RS_FilterDXFRW::writeEllipse(RS_Ellipse* s) {
+void RS_FilterDXFRW::writeEllipse(dxfRW& dxf, RS_Ellipse* s) {
 // version 12 do not support Ellipse but are
 // converted in polyline by library
     DRW_Ellipse el;
@@ -2471,7 +3221,7 @@ void RS_FilterDXFRW::writeEllipse(RS_Ellipse* s) {
         el.staparam = s->getAngle1();
         el.endparam = s->getAngle2();
     }
-    dxfW->writeEllipse(&el);
+    dxf.writeEllipse(&el);
 }
 
 /**
@@ -2593,7 +3343,7 @@ void RS_FilterDXFRW::writeMText(RS_MText* t) {
 /**
  * Writes the given Text entity to the file.
  */
-void RS_FilterDXFRW::writeText(RS_Text* t){
+void RS_FilterDXFRW::writeText(dxfRW& dxf, RS_Text* t){
     DRW_Text text;
 
     getEntityAttributes(&text, t);
@@ -2625,7 +3375,7 @@ void RS_FilterDXFRW::writeText(RS_Text* t){
 
     if (!t->getText().isEmpty()) {
         text.text = toDxfString(t->getText()).toUtf8().data();
-        dxfW->writeText(&text);
+        dxf.writeText(&text);
     }
 }
 
@@ -2633,10 +3383,7 @@ void RS_FilterDXFRW::writeText(RS_Text* t){
  * Writes the given dimension entity to the file.
  */
 void RS_FilterDXFRW::writeDimension(RS_Dimension* d) {
-    QString blkName;
-    if (noNameBlock.contains(d)) {
-        blkName = noNameBlock.take(d);
-    }
+    QString blkName = noNameBlock.take(d);
 
     // version 12 are inserts of *D blocks
     if (version==1009) {
@@ -2751,7 +3498,7 @@ void RS_FilterDXFRW::writeDimension(RS_Dimension* d) {
  */
 void RS_FilterDXFRW::writeLeader(RS_Leader* l) {
     if (l->count()<=0)
-        RS_DEBUG->print(RS_Debug::D_WARNING, "dropping leader with no vertices");
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING, "dropping leader with no vertices");
 
     DRW_Leader leader;
     getEntityAttributes(&leader, l);
@@ -2765,8 +3512,7 @@ void RS_FilterDXFRW::writeLeader(RS_Leader* l) {
     leader.textwidth = 10;
     leader.vertnum = l->count();
 	RS_Line* li =nullptr;
-    for (RS_Entity* v=l->firstEntity(RS2::ResolveNone);
-            v;   v=l->nextEntity(RS2::ResolveNone)) {
+    for (RS_Entity* v: l->resolvedEntities(RS2::ResolveNone)) {
         if (v->rtti()==RS2::EntityLine) {
             li = (RS_Line*)v;
 			leader.vertexlist.push_back(std::make_shared<DRW_Coord>(li->getStartpoint().x, li->getStartpoint().y, 0.0));
@@ -2804,9 +3550,7 @@ void RS_FilterDXFRW::writeHatch(RS_Hatch * h) {
     bool writeIt = true;
     if (h->countLoops()>0) {
         // check if all of the loops contain entities:
-        for (RS_Entity* l=h->firstEntity(RS2::ResolveNone);
-                l;
-                l=h->nextEntity(RS2::ResolveNone)) {
+        for (RS_Entity* l: h->resolvedEntities(RS2::ResolveNone)) {
 
             if (l->isContainer() && !l->getFlag(RS2::FlagTemp)) {
                 if (l->count()==0) {
@@ -2819,7 +3563,7 @@ void RS_FilterDXFRW::writeHatch(RS_Hatch * h) {
     }
 
     if (!writeIt) {
-        RS_DEBUG->print(RS_Debug::D_WARNING,
+        RS_DEBUG_PRINT(RS_Debug::D_WARNING,
                         "RS_FilterDXF::writeHatch: Dropping Hatch");
         return;
     }
@@ -2835,18 +3579,14 @@ void RS_FilterDXFRW::writeHatch(RS_Hatch * h) {
         ha.name = h->getPattern().toUtf8().data();
     ha.loopsnum = h->countLoops();
 
-    for (RS_Entity* l=h->firstEntity(RS2::ResolveNone);
-         l;
-         l=h->nextEntity(RS2::ResolveNone)) {
+    for (RS_Entity* l: h->resolvedEntities(RS2::ResolveNone)) {
 
         // Write hatch loops:
         if (l->isContainer() && !l->getFlag(RS2::FlagTemp)) {
             RS_EntityContainer* loop = (RS_EntityContainer*)l;
 			std::shared_ptr<DRW_HatchLoop> lData = std::make_shared<DRW_HatchLoop>(0);
 
-            for (RS_Entity* ed=loop->firstEntity(RS2::ResolveNone);
-                 ed;
-                 ed=loop->nextEntity(RS2::ResolveNone)) {
+            for (RS_Entity* ed: loop->resolvedEntities(RS2::ResolveNone)) {
 
                 // Write hatch loop edges:
                 if (ed->rtti()==RS2::EntityLine) {
@@ -2913,7 +3653,7 @@ void RS_FilterDXFRW::writeHatch(RS_Hatch * h) {
 /**
  * Writes the given Solid entity to the file.
  */
-void RS_FilterDXFRW::writeSolid(RS_Solid* s) {
+void RS_FilterDXFRW::writeSolid(dxfRW& dxf, RS_Solid* s) {
     RS_SolidData data;
     DRW_Solid solid;
     RS_Vector corner;
@@ -2935,7 +3675,7 @@ void RS_FilterDXFRW::writeSolid(RS_Solid* s) {
         solid.fourPoint.x = corner.x;
         solid.fourPoint.y = corner.y;
     }
-    dxfW->writeSolid(&solid);
+    dxf.writeSolid(&solid);
 }
 
 
@@ -3036,20 +3776,24 @@ void RS_FilterDXFRW::writeImage(RS_Image * i) {
  */
 void RS_FilterDXFRW::setEntityAttributes(RS_Entity* entity,
                                        const DRW_Entity* attrib) {
-    RS_DEBUG->print("RS_FilterDXF::setEntityAttributes");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::setEntityAttributes");
 
     RS_Pen pen;
     pen.setColor(Qt::black);
     pen.setLineType(RS2::SolidLine);
-    QString layName = toNativeString(QString::fromUtf8(attrib->layer.c_str()));
-
     // Layer: add layer in case it doesn't exist:
-	if (!graphic->findLayer(layName)) {
-        DRW_Layer lay;
-        lay.name = attrib->layer;
-        addLayer(lay);
+    auto layerIt = importedLayers.find(attrib->layer);
+    if (layerIt == importedLayers.end()) {
+        QString layName = toNativeString(QString::fromUtf8(attrib->layer.c_str()));
+        if (!graphic->findLayer(layName)) {
+            DRW_Layer lay;
+            lay.name = attrib->layer;
+            addLayer(lay);
+        }
+        layerIt = importedLayers.emplace(attrib->layer, graphic->findLayer(layName)).first;
     }
-    entity->setLayer(layName);
+    // same as setLayer(name): entities out of the graphic get no layer
+    entity->setLayer(entity->getGraphic() != nullptr ? layerIt->second : nullptr);
 
     // Color:
     if (attrib->color24 >= 0)
@@ -3060,13 +3804,17 @@ void RS_FilterDXFRW::setEntityAttributes(RS_Entity* entity,
     pen.setColor(numberToColor(attrib->color));
 
     // Linetype:
-    pen.setLineType(nameToLineType( QString::fromUtf8(attrib->lineType.c_str()) ));
+    auto lineTypeIt = importedLineTypes.find(attrib->lineType);
+    if (lineTypeIt == importedLineTypes.end())
+        lineTypeIt = importedLineTypes.emplace(attrib->lineType,
+                                               nameToLineType(QString::fromUtf8(attrib->lineType.c_str()))).first;
+    pen.setLineType(lineTypeIt->second);
 
     // Width:
     pen.setWidth(numberToWidth(attrib->lWeight));
 
     entity->setPen(pen);
-    RS_DEBUG->print("RS_FilterDXF::setEntityAttributes: OK");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::setEntityAttributes: OK");
 }
 
 
@@ -3144,7 +3892,7 @@ RS_Color RS_FilterDXFRW::numberToColor(int num) {
                             DRW::dxfColors[num][1],
                             DRW::dxfColors[num][2]);
         } else {
-            RS_DEBUG->print(RS_Debug::D_WARNING,
+            RS_DEBUG_PRINT(RS_Debug::D_WARNING,
                                 "RS_FilterDXF::numberToColor: Invalid color number given.");
             return RS_Color(RS2::FlagByLayer);
         }
@@ -3214,7 +3962,10 @@ int RS_FilterDXFRW::colorToNumber(const RS_Color& col, int *rgb) {
 }
 
 void RS_FilterDXFRW::add3dFace(const DRW_3Dface& data) {
-    RS_DEBUG->print("RS_FilterDXFRW::add3dFace");
+    const LC_ImportProfile::Phase phase{profile.get(), "3DFACE"};
+    if (isSkipped(data))
+        return;
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::add3dFace");
     RS_PolylineData d(RS_Vector(false),
                       RS_Vector(false),
                       !data.invisibleflag);
@@ -3234,10 +3985,11 @@ void RS_FilterDXFRW::add3dFace(const DRW_3Dface& data) {
 }
 
 void RS_FilterDXFRW::addComment(const char*) {
-    RS_DEBUG->print("RS_FilterDXF::addComment(const char*) not yet implemented.");
+    RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXF::addComment(const char*) not yet implemented.");
 }
 
 void RS_FilterDXFRW::addPlotSettings(const DRW_PlotSettings *data) {
+    const LC_ImportProfile::Phase phase{profile.get(), "PLOTSETTINGS"};
     graphic->setPagesNum(QString::fromStdString(data->plotViewName));
     graphic->setMargins(data->marginLeft, data->marginTop,
                         data->marginRight, data->marginBottom);
@@ -4033,52 +4785,52 @@ QString RS_FilterDXFRW::printDwgVersion(int v){
 void RS_FilterDXFRW::printDwgError(int le){
     switch (le) {
     case DRW::BAD_UNKNOWN:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("unknown error opening dwg file"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_UNKNOWN");
+        showCommandMessage(QObject::tr("unknown error opening dwg file"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_UNKNOWN");
         break;
     case DRW::BAD_OPEN:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("can't open this dwg file"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_OPEN");
+        showCommandMessage(QObject::tr("can't open this dwg file"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_OPEN");
         break;
     case DRW::BAD_VERSION:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("unsupported dwg version"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_VERSION");
+        showCommandMessage(QObject::tr("unsupported dwg version"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_VERSION");
         break;
     case DRW::BAD_READ_METADATA:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("error reading file metadata in dwg file"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_READ_FILE_HEADER");
+        showCommandMessage(QObject::tr("error reading file metadata in dwg file"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_READ_FILE_HEADER");
         break;
     case DRW::BAD_READ_FILE_HEADER:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("error reading file header in dwg file"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_READ_FILE_HEADER");
+        showCommandMessage(QObject::tr("error reading file header in dwg file"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_READ_FILE_HEADER");
         break;
     case DRW::BAD_READ_HEADER:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("error reading header vars in dwg file"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_READ_HEADER");
+        showCommandMessage(QObject::tr("error reading header vars in dwg file"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_READ_HEADER");
         break;
     case DRW::BAD_READ_CLASSES:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("error reading classes in dwg file"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_READ_CLASSES");
+        showCommandMessage(QObject::tr("error reading classes in dwg file"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_READ_CLASSES");
         break;
     case DRW::BAD_READ_HANDLES:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("error reading offsets in dwg file"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_READ_OFFSETS");
+        showCommandMessage(QObject::tr("error reading offsets in dwg file"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_READ_OFFSETS");
         break;
     case DRW::BAD_READ_TABLES:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("error reading tables in dwg file"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_READ_TABLES");
+        showCommandMessage(QObject::tr("error reading tables in dwg file"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_READ_TABLES");
         break;
     case DRW::BAD_READ_BLOCKS:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("error reading blocks in dwg file"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_READ_OFFSETS");
+        showCommandMessage(QObject::tr("error reading blocks in dwg file"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_READ_OFFSETS");
         break;
     case DRW::BAD_READ_ENTITIES:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("error reading entities in dwg file"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_READ_ENTITIES");
+        showCommandMessage(QObject::tr("error reading entities in dwg file"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_READ_ENTITIES");
         break;
     case DRW::BAD_READ_OBJECTS:
-        RS_DIALOGFACTORY->commandMessage(QObject::tr("error reading objects in dwg file"));
-        RS_DEBUG->print("RS_FilterDXFRW::printDwgError: DRW::BAD_READ_OBJECTS");
+        showCommandMessage(QObject::tr("error reading objects in dwg file"));
+        RS_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_FilterDXFRW::printDwgError: DRW::BAD_READ_OBJECTS");
         break;
     default:
         break;
@@ -27,6 +27,14 @@
 #ifndef RS_FILTERDXFRW_H
 #define RS_FILTERDXFRW_H
 
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QRegularExpression>
+
 #include "rs_filterinterface.h"
 
 #include "rs_color.h"
@@ -51,6 +59,8 @@ class RS_Image;
 class RS_Leader;
 class RS_Polyline;
 class DL_WriterA;
+class LC_DxfSaveIndex;
+class LC_ImportProfile;
 
 /**
  * This format filter class can import and export DXF files.
@@ -73,7 +83,7 @@ public:
         
      bool canExport(const QString &/*fileName*/, RS2::FormatType t) const override {
         return (t==RS2::FormatDXFRW || t==RS2::FormatDXFRW2004 || t==RS2::FormatDXFRW2000
-                || t==RS2::FormatDXFRW14 || t==RS2::FormatDXFRW12);
+                || t==RS2::FormatDXFRW14 || t==RS2::FormatDXFRW12 || t==RS2::FormatDXFRWBinary);
     }
 
     // Error messages
@@ -81,6 +91,8 @@ public:
 
     // Import:
      bool fileImport(RS_Graphic& g, const QString& file, RS2::FormatType type) override;
+     bool setProgressCallback(const QString& fileName, ProgressCallback callback) override;
+     bool setImportOptions(const LC_ImportOptions& options) override;
 
     // Methods from DRW_CreationInterface:
      void addHeader(const DRW_Header* data) override;
@@ -88,7 +100,7 @@ public:
      void addLayer(const DRW_Layer& data) override;
      void addDimStyle(const DRW_Dimstyle& data) override;
      void addVport(const DRW_Vport& data) override;
-     void addTextStyle(const DRW_Textstyle& /*data*/) override{}
+     void addTextStyle(const DRW_Textstyle& data) override;
      void addAppId(const DRW_AppId& /*data*/) override{}
      void addBlock(const DRW_Block& data) override;
      void setBlock(const int handle) override;
@@ -143,18 +155,18 @@ public:
      void writeObjects() override;
      void writeAppId() override;
 
-    void writePoint(RS_Point* p);
-    void writeLine(RS_Line* l);
-    void writeCircle(RS_Circle* c);
-    void writeArc(RS_Arc* a);
-    void writeEllipse(RS_Ellipse* s);
-    void writeSolid(RS_Solid* s);
-    void writeLWPolyline(RS_Polyline* l);
+    void writePoint(dxfRW& dxf, RS_Point* p);
+    void writeLine(dxfRW& dxf, RS_Line* l);
+    void writeCircle(dxfRW& dxf, RS_Circle* c);
+    void writeArc(dxfRW& dxf, RS_Arc* a);
+    void writeEllipse(dxfRW& dxf, RS_Ellipse* s);
+    void writeSolid(dxfRW& dxf, RS_Solid* s);
+    void writeLWPolyline(dxfRW& dxf, RS_Polyline* l);
     void writeSpline(RS_Spline* s);
 	void writeSplinePoints(LC_SplinePoints *s);
     void writeInsert(RS_Insert* i);
     void writeMText(RS_MText* t);
-    void writeText(RS_Text* t);
+    void writeText(dxfRW& dxf, RS_Text* t);
     void writeHatch(RS_Hatch* h);
     void writeImage(RS_Image* i);
     void writeLeader(RS_Leader* l);
@@ -197,8 +209,22 @@ public:
     static RS_FilterInterface* createFilter(){return new RS_FilterDXFRW();}
 
 private:
+    bool importFile(const QString& fileName, RS2::FormatType type);
+    void updateTexts();
+    bool isSkipped(const DRW_Entity& data);
+    void writeSnapshot(const QString& fileName, const QString& snapshot);
+    void writeProfile(bool fromSnapshot);
+    bool writeDxf(const QString& file, RS2::FormatType type, bool binary);
+    bool writeIncremental(const QString& file, RS2::FormatType type);
+    //! writes the entities of the graphic, copying unchanged ones from the file saved before
+    void writeIndexedEntities();
+    quint64 getFingerprint(RS_Entity* e);
     void prepareBlocks();
     void writeEntity(RS_Entity* e);
+    //! writes the entities of the graphic or a block, runs of independent entities in parallel
+    void writeContainerEntities(RS_EntityContainer& container);
+    bool isIndependentEntity(const RS_Entity* e) const;
+    void writeIndependentEntity(dxfRW& dxf, RS_Entity* e);
 #ifdef DWGSUPPORT
     void printDwgError(int le);
     QString printDwgVersion(int v);
@@ -235,6 +261,36 @@ private:
     QHash<int, RS_EntityContainer*> blockHash;
     /** Pointer to entity container to store possible orphan entities like paper space */
     RS_EntityContainer* dummyContainer;
+    /** Layers and line types of imported entities by their names in the file, to
+     * resolve each distinct name only once */
+    std::unordered_map<std::string, RS_Layer*> importedLayers;
+    std::unordered_map<std::string, RS2::LineType> importedLineTypes;
+    /** Imported texts and mtexts, laid out together after reading */
+    std::vector<RS_Entity*> pendingTexts;
+    //! progress of DXF imports, reading is reported up to progressRead
+    ProgressCallback progressCallback;
+    static constexpr double progressRead = 0.9;
+    /** Imported files are read from binary snapshots in the cache, while they
+     * are not changed */
+    bool useSnapshots {false};
+    /** Options of partial imports, with their layer patterns, and the layer names
+     * of the file with the entities skipped by them */
+    LC_ImportOptions importOptions;
+    std::vector<QRegularExpression> includedLayers;
+    std::vector<QRegularExpression> excludedLayers;
+    std::unordered_map<std::string, bool> skippedLayers;
+    /** Profile of the current import, if enabled by the setting to report it, or
+     * by the import options */
+    bool reportProfile {false};
+    std::unique_ptr<LC_ImportProfile> profile;
+    /** Files saved before by this filter are saved again incrementally, if enabled
+     * by the setting. The index and the file saved before, if they can be used,
+     * and the index of the file being written */
+    bool incrementalSave {false};
+    std::shared_ptr<LC_DxfSaveIndex> previousIndex;
+    std::unique_ptr<std::ifstream> previousFile;
+    std::shared_ptr<LC_DxfSaveIndex> saveIndex;
+    bool copyFailed {false};
 };
 
 #endif
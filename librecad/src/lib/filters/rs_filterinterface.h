@@ -29,6 +29,9 @@
 #ifndef RS_FILTERINTERFACE_H
 #define RS_FILTERINTERFACE_H
 
+#include <functional>
+
+#include "lc_importoptions.h"
 #include "rs_graphic.h"
 
 #include <QObject>
@@ -43,6 +46,12 @@
  */
 class RS_FilterInterface {
 public:
+    /**
+     * Callback for the progress of imports, with the fraction of the
+     * import done. Returning false cancels the import.
+     */
+    using ProgressCallback = std::function<bool(double)>;
+
     /**
      * Constructor.
      */
@@ -76,6 +85,27 @@ public:
      */
     virtual bool fileImport(RS_Graphic& g, const QString& file, RS2::FormatType type) = 0;
 
+    /**
+     * Sets the progress callback for the next import of the given file.
+     * Filters reporting the progress don't use the GUI while importing,
+     * so the import can run on a worker thread. The callback is called
+     * from the importing thread.
+     *
+     * @return true if the filter reports the progress of importing the file.
+     */
+    virtual bool setProgressCallback(const QString& /*fileName*/, ProgressCallback /*callback*/) {
+        return false;
+    }
+
+    /**
+     * Sets the options for the next import, to import only a part of the file.
+     *
+     * @return true if the filter supports partial imports.
+     */
+    virtual bool setImportOptions(const LC_ImportOptions& /*options*/) {
+        return false;
+    }
+
     /**
      * The implementation of this method in a inherited format
      * class should write the entities in the current entity container
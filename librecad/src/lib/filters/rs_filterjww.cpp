@@ -107,6 +107,8 @@ bool RS_FilterJWW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatTyp
         graphic = &g;
         currentContainer = graphic;
         this->file = file;
+        dxfEncoding.clear();
+        layerNames.clear();
 
         RS_DEBUG->print("graphic->countLayers(): %d", graphic->countLayers());
 
@@ -153,7 +155,11 @@ void RS_FilterJWW::addLayer(const DL_LayerData& data) {
 
         RS_DEBUG->print("RS_FilterJWW::addLayer: creating layer");
 ////////////////////2006/06/05
-        RS_Layer* layer = new RS_Layer(toNativeString(data.name.c_str(),getDXFEncoding()));
+        const QByteArray name{data.name.c_str()};
+        auto it = layerNames.find(name);
+        if (it == layerNames.end())
+                it = layerNames.insert(name, toNativeString(name.constData(), getDXFEncoding()));
+        RS_Layer* layer = new RS_Layer(it.value());
 ////////////////////
         RS_DEBUG->print("RS_FilterJWW::addLayer: set pen");
         layer->setPen(attributesToPen(attributes));
@@ -486,6 +492,8 @@ void RS_FilterJWW::addMTextChunk(const char* text) {
  * Acad versions >= 2007 are UTF-8, others in ANSI_1252
  */
 QString RS_FilterJWW::getDXFEncoding() {
+    if (!dxfEncoding.isEmpty())
+        return dxfEncoding;
 
     QString acadver=variables.getString("$ACADVER", "");
     acadver.replace(QRegularExpression("[a-zA-Z]"), "");
@@ -494,12 +502,14 @@ QString RS_FilterJWW::getDXFEncoding() {
 
     // >= ACAD2007
     if (ok && version >= 1021) {
-        return RS_System::getEncoding("UTF-8");
+        dxfEncoding = RS_System::getEncoding("UTF-8");
+        return dxfEncoding;
     }
 
     // < ACAD2007
     QString codePage=variables.getString("$DWGCODEPAGE", "ANSI_1252");
-    return RS_System::getEncoding(codePage);
+    dxfEncoding = RS_System::getEncoding(codePage);
+    return dxfEncoding;
 }
 
 /**
@@ -1065,7 +1075,7 @@ void RS_FilterJWW::linkImage(const DL_ImageDefData& data) {
                         if (img->getHandle()==handle) {
                                 img->setFile(sfile);
                                 RS_DEBUG->print("image found: %s", (const char*)QFile::encodeName(img->getFile()));
-                                img->update();
+                                img->updateInBackground();
                         }
                 }
         }
@@ -1081,7 +1091,7 @@ void RS_FilterJWW::linkImage(const DL_ImageDefData& data) {
                                         img->setFile(sfile);
                                         RS_DEBUG->print("image in block found: %s",
                                                                         (const char*)QFile::encodeName(img->getFile()));
-                                        img->update();
+                                        img->updateInBackground();
                                 }
                         }
                 }
@@ -1147,6 +1157,10 @@ void RS_FilterJWW::setVariableString(const char* key,
 
         // update local JWW variable list:
         variables.add(QString(key), QString(value), code);
+        if (QString(key) == "$DWGCODEPAGE" || QString(key) == "$ACADVER") {
+                dxfEncoding.clear();
+                layerNames.clear();
+        }
 
         // update document's variable list:
         if (currentContainer->rtti()==RS2::EntityGraphic) {
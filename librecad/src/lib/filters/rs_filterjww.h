@@ -28,6 +28,8 @@
 #ifndef RS_FILTERJWW_H
 #define RS_FILTERJWW_H
 
+#include <QHash>
+
 #include "rs_filterinterface.h"
 
 #include "rs_color.h"
@@ -230,6 +232,10 @@ private:
 
     DL_Jww jww;
     RS_VariableDict variables;
+    /** Encoding of the code page, cached by getDXFEncoding() */
+    QString dxfEncoding;
+    /** Converted layer names, every JWW shape adds its layer */
+    QHash<QByteArray, QString> layerNames;
 };
 
 #endif
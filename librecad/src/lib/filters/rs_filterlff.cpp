@@ -26,12 +26,13 @@
 
 #include <fstream>
 
-#include <QTextStream>
-#include <QStringList>
 #include <QDate>
+#include <QFile>
+#include <QStringList>
 
 #include "rs_filterlff.h"
 
+#include "lc_fontfile.h"
 #include "rs_arc.h"
 #include "rs_line.h"
 #include "rs_font.h"
@@ -111,17 +112,6 @@ bool RS_FilterLFF::fileImport(RS_Graphic& g, const QString& file, RS2::FormatTyp
 }
 
 
-QString clearZeros(double num, int prec){
-    QString str = QString::number(num, 'f', prec);
-    int i = str.length()- 1;
-    while (str.at(i) == '0' && i>1) {
-        --i;
-    }
-    if (str.at(i) != '.')
-            i++;
-    return str.left(i);
-}
-
 /**
  * Implementation of the method used for RS_Export to communicate
  * with this filter.
@@ -134,142 +124,119 @@ bool RS_FilterLFF::fileExport(RS_Graphic& g, const QString& file, RS2::FormatTyp
     RS_DEBUG->print("RS_FilterLFF::fileExport: open");
 
     QFile f(file);
-    QTextStream ts(&f);
-    ts.setEncoding(QStringConverter::Utf8);
-    if (f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        RS_DEBUG->print("LFF Filter: exporting file failed");
+        return false;
+    }
+    RS_DEBUG->print("RS_FilterLFF::fileExport: open: OK");
 
-        RS_DEBUG->print("RS_FilterLFF::fileExport: open: OK");
+    // the lines are formatted in a buffer, written in large blocks
+    LC_FontFile::Writer ts(&f);
 
-        RS_DEBUG->print("RS_FilterLFF::fileExport: header");
+    // header:
+    ts << "# Format:            LibreCAD Font 1\n";
+    ts << QString("# Creator:           %1\n").arg(RS_SYSTEM->getAppName());
+    ts << QString("# Version:           %1\n").arg(RS_SYSTEM->getAppVersion());
 
-        // header:
-        ts << "# Format:            LibreCAD Font 1\n";
-        ts << QString("# Creator:           %1\n").arg(RS_SYSTEM->getAppName());
-        ts << QString("# Version:           %1\n").arg(RS_SYSTEM->getAppVersion());
+    QString ns = g.getVariableString("Names", "");
+    if (!ns.isEmpty()) {
+        for (const QString& name: ns.split(','))
+            ts << QString("# Name:              %1\n").arg(name);
+    }
 
-        QString ns = g.getVariableString("Names", "");
-        if (!ns.isEmpty()) {
-            QStringList names = ns.split(',');
-            RS_DEBUG->print("002");
-            for (int i = 0; i < names.size(); ++i) {
-                ts << QString("# Name:              %1\n").arg(names.at(i));
+    ts << "# Encoding:          UTF-8\n";
+    ts << QString("# LetterSpacing:     %1\n").arg(
+              g.getVariableDouble("LetterSpacing", 3.0));
+    ts << QString("# WordSpacing:       %1\n").arg(
+              g.getVariableDouble("WordSpacing", 6.75));
+    ts << QString("# LineSpacingFactor: %1\n").arg(
+              g.getVariableDouble("LineSpacingFactor", 1.0));
+    QString dateline = QDate::currentDate().toString ("yyyy-MM-dd");
+    ts << QString("# Created:           %1\n").arg(
+              g.getVariableString("Created", dateline));
+    ts << QString("# Last modified:     %1\n").arg(dateline);
+
+    QString sa = g.getVariableString("Authors", "");
+    if (!sa.isEmpty()) {
+        for (const QString& author: sa.split(','))
+            ts << QString("# Author:            %1\n").arg(author);
+    }
+    QString es = g.getVariableString("License", "");
+    if (!es.isEmpty()) {
+        ts << QString("# License:           %1\n").arg(es);
+    } else
+        ts << "# License:           unknown\n";
+
+    RS_DEBUG->print("RS_FilterLFF::fileExport: header: OK");
+
+    // coordinates with up to 5 decimals
+    auto writePoint = [&ts](const RS_Vector& point) {
+        ts.writeTrimmed(point.x, 5);
+        ts << ',';
+        ts.writeTrimmed(point.y, 5);
+    };
+
+    // iterate through blocks (=letters of font)
+    for (unsigned i=0; i<g.countBlocks(); ++i) {
+        RS_Block* blk = g.blockAt(i);
+        if (blk == nullptr || blk->isUndone())
+            continue;
+
+        ts << '\n' << blk->getName() << '\n';
+
+        // iterate through entities of this letter:
+        for (RS_Entity* e: blk->resolvedEntities(RS2::ResolveNone)) {
+            if (e->isUndone())
+                continue;
+
+            // lines:
+            if (e->rtti()==RS2::EntityLine) {
+                RS_Line* l = (RS_Line*)e;
+                writePoint(l->getStartpoint());
+                ts << ';';
+                writePoint(l->getEndpoint());
+                ts << '\n';
             }
-        }
-
-        QString es = g.getVariableString("Encoding", "");
-        ts << QString("# Encoding:          UTF-8\n");
-        ts << QString("# LetterSpacing:     %1\n").arg(
-                  g.getVariableDouble("LetterSpacing", 3.0));
-        ts << QString("# WordSpacing:       %1\n").arg(
-                  g.getVariableDouble("WordSpacing", 6.75));
-        ts << QString("# LineSpacingFactor: %1\n").arg(
-                  g.getVariableDouble("LineSpacingFactor", 1.0));
-        QString dateline = QDate::currentDate().toString ("yyyy-MM-dd");
-        ts << QString("# Created:           %1\n").arg(
-                  g.getVariableString("Created", dateline));
-        ts << QString("# Last modified:     %1\n").arg(dateline);
-
-        QString sa = g.getVariableString("Authors", "");
-        RS_DEBUG->print("authors: %s", sa.toLocal8Bit().data());
-        if (!sa.isEmpty()) {
-            QStringList authors = sa.split(',');
-            RS_DEBUG->print("count: %d", authors.count());
-
-            QString a;
-            for (int i = 0; i < authors.size(); ++i) {
-                ts << QString("# Author:            %1\n").arg(authors.at(i));
+            // arcs:
+            else if (e->rtti()==RS2::EntityArc) {
+                RS_Arc* a = (RS_Arc*)e;
+                writePoint(a->getStartpoint());
+                ts << ';';
+                writePoint(a->getEndpoint());
+                ts << ",A";
+                ts.writeTrimmed(a->getBulge(), 5);
+                ts << '\n';
             }
-        }
-        es = g.getVariableString("License", "");
-        if (!es.isEmpty()) {
-            ts << QString("# License:           %1\n").arg(es);
-        } else
-            ts << "# License:           unknown\n";
-
-        RS_DEBUG->print("RS_FilterLFF::fileExport: header: OK");
-
-        // iterate through blocks (=letters of font)
-        for (unsigned i=0; i<g.countBlocks(); ++i) {
-            RS_Block* blk = g.blockAt(i);
-
-            RS_DEBUG->print("block: %d", i);
-
-            if (blk && !blk->isUndone()) {
-                RS_DEBUG->print("002a: %s",
-                                (blk->getName().toLocal8Bit().data()));
-
-                ts << QString("\n%1\n").arg(blk->getName());
-
-                // iterate through entities of this letter:
-                for (RS_Entity* e=blk->firstEntity(RS2::ResolveNone);
-                     e;
-                     e=blk->nextEntity(RS2::ResolveNone)) {
-
-                    if (!e->isUndone()) {
-
-                        // lines:
-                        if (e->rtti()==RS2::EntityLine) {
-                            RS_Line* l = (RS_Line*)e;
-                            ts << clearZeros(l->getStartpoint().x, 5) << ',';
-                            ts << clearZeros(l->getStartpoint().y, 5) << ';';
-                            ts << clearZeros(l->getEndpoint().x, 5) << ',';
-                            ts << clearZeros(l->getEndpoint().y, 5) << '\n';
-                        }
-                        // arcs:
-                        else if (e->rtti()==RS2::EntityArc) {
-                            RS_Arc* a = (RS_Arc*)e;
-                            ts << clearZeros(a->getStartpoint().x, 5) << ',';
-                            ts << clearZeros(a->getStartpoint().y, 5) << ';';
-                            ts << clearZeros(a->getEndpoint().x, 5) << ',';
-                            ts << clearZeros(a->getEndpoint().y, 5) << ",A";
-                            ts << clearZeros(a->getBulge(), 5) << '\n';
-                        }
-                        else if (e->rtti()==RS2::EntityBlock) {
-                            RS_Block* b = (RS_Block*)e;
-                            QString uCode;
-                            uCode.setNum(b->getName().at(0).unicode(), 16);
-                            if (uCode.length()<4) {
-                                uCode = uCode.rightJustified(4, '0');
-                            }
-                            ts << QString("C%1\n").arg(uCode);
-                        }
-                        else if (e->rtti()==RS2::EntityPolyline) {
-                            RS_Polyline* p = (RS_Polyline*)e;
-                            ts << clearZeros(p->getStartpoint().x, 5) << ',';
-                            ts << clearZeros(p->getStartpoint().y, 5);
-                            for (RS_Entity* e2=p->firstEntity(RS2::ResolveNone);
-                                 e2;
-                                 e2=p->nextEntity(RS2::ResolveNone)) {
-                                if (e2->rtti()==RS2::EntityLine){
-                                    RS_Line* l = (RS_Line*)e2;
-                                    ts << ';' << clearZeros(l->getEndpoint().x, 5) << ',';
-                                    ts << clearZeros(l->getEndpoint().y, 5);
-                                } else if (e2->rtti()==RS2::EntityArc){
-                                    RS_Arc* a = (RS_Arc*)e2;
-                                    ts << ';' << clearZeros(a->getEndpoint().x, 5) << ',';
-                                    ts << clearZeros(a->getEndpoint().y, 5) <<",A";
-                                    ts << clearZeros(a->getBulge(), 5);
-                                }
-                            }
-                            ts<<'\n';
-                        }
-                        // Ignore entities other than arcs / lines
-                        else {}
+            else if (e->rtti()==RS2::EntityBlock) {
+                RS_Block* b = (RS_Block*)e;
+                ts << 'C';
+                ts.writeHex(b->getName().at(0).unicode(), 4);
+                ts << '\n';
+            }
+            else if (e->rtti()==RS2::EntityPolyline) {
+                RS_Polyline* p = (RS_Polyline*)e;
+                writePoint(p->getStartpoint());
+                for (RS_Entity* e2: p->resolvedEntities(RS2::ResolveNone)) {
+                    if (e2->rtti()==RS2::EntityLine){
+                        ts << ';';
+                        writePoint(((RS_Line*)e2)->getEndpoint());
+                    } else if (e2->rtti()==RS2::EntityArc){
+                        RS_Arc* a = (RS_Arc*)e2;
+                        ts << ';';
+                        writePoint(a->getEndpoint());
+                        ts << ",A";
+                        ts.writeTrimmed(a->getBulge(), 5);
                     }
-
                 }
+                ts << '\n';
             }
+            // Ignore entities other than arcs / lines
         }
-        f.close();
-        RS_DEBUG->print("LFF Filter: exporting file: OK");
-        return true;
-    }
-    else {
-        RS_DEBUG->print("LFF Filter: exporting file failed");
     }
-
-    return false;
+    const bool success = ts.flush();
+    f.close();
+    RS_DEBUG->print("LFF Filter: exporting file: %s", success ? "OK" : "failed");
+    return success;
 }
 
 
@@ -0,0 +1,273 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <algorithm>
+#include <iterator>
+
+#include "lc_drawinggenerator.h"
+#include "rs_arc.h"
+#include "rs_block.h"
+#include "rs_circle.h"
+#include "rs_graphic.h"
+#include "rs_hatch.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
+#include "rs_line.h"
+#include "rs_math.h"
+#include "rs_mtext.h"
+#include "rs_polyline.h"
+#include "rs_spline.h"
+#include "rs_text.h"
+
+namespace {
+// fonts shipped with LibreCAD, for texts in mixed fonts
+const char* const fonts[] = {"standard", "iso", "romans", "cursive", "simplex", "unicode"};
+}
+
+LC_DrawingGenerator::LC_DrawingGenerator(unsigned seed):
+    m_random{seed}
+{
+}
+
+void LC_DrawingGenerator::generate(RS_Graphic& graphic, const Parameters& parameters)
+{
+    const double size = parameters.size;
+    // the order is fixed, every step draws from the same random sequence
+    addLayers(graphic, parameters.layers);
+    addLines(graphic, parameters.lines, size);
+    addCircles(graphic, parameters.circles, size);
+    addArcs(graphic, parameters.arcs, size);
+    addPolylines(graphic, parameters.polylines, parameters.polylineVertices, size);
+    addSplines(graphic, parameters.splines, size);
+    addTexts(graphic, parameters.texts, size);
+    addHatches(graphic, parameters.hatches, parameters.hatchLoops, parameters.hatchVertices, size);
+    addBlocks(graphic, parameters.blocks, parameters.inserts, parameters.blockDepth, size);
+    graphic.calculateBorders();
+}
+
+RS_Vector LC_DrawingGenerator::point(double size)
+{
+    std::uniform_real_distribution<double> distribution{0., size};
+    const double x = distribution(m_random);
+    return {x, distribution(m_random)};
+}
+
+double LC_DrawingGenerator::number(double min, double max)
+{
+    return std::uniform_real_distribution<double>{min, max}(m_random);
+}
+
+void LC_DrawingGenerator::addLayers(RS_Graphic& graphic, int count)
+{
+    m_graphic = &graphic;
+    m_layers.clear();
+    for (int i = 0; i < count; ++i) {
+        auto layer = new RS_Layer(QString("layer%1").arg(i));
+        const int shade = 255 * i / std::max(count - 1, 1);
+        layer->setPen(RS_Pen(RS_Color(shade, 255 - shade, 128), RS2::Width00, RS2::SolidLine));
+        graphic.addLayer(layer);
+        m_layers.push_back(layer);
+    }
+}
+
+void LC_DrawingGenerator::add(RS_EntityContainer& container, RS_Entity* entity)
+{
+    // entities of blocks keep the layer and pen of the insert
+    if (container.rtti() == RS2::EntityBlock) {
+        entity->setLayer(nullptr);
+        entity->setPen(RS_Pen(RS_Color(RS2::FlagByBlock), RS2::WidthByBlock, RS2::LineByBlock));
+    } else {
+        if (!m_layers.empty() && container.getGraphic() == m_graphic)
+            entity->setLayer(m_layers[std::uniform_int_distribution<std::size_t>{0, m_layers.size() - 1}(m_random)]);
+        entity->setPen(RS_Pen(RS_Color(RS2::FlagByLayer), RS2::WidthByLayer, RS2::LineByLayer));
+    }
+    container.addEntity(entity);
+}
+
+void LC_DrawingGenerator::addLines(RS_EntityContainer& container, int count, double size)
+{
+    const double length = size / 25.;
+    for (int i = 0; i < count; ++i) {
+        const RS_Vector start = point(size);
+        const RS_Vector end = start + point(length) - RS_Vector{length / 2., length / 2.};
+        add(container, new RS_Line(&container, start, end));
+    }
+}
+
+void LC_DrawingGenerator::addCircles(RS_EntityContainer& container, int count, double size)
+{
+    for (int i = 0; i < count; ++i) {
+        const RS_Vector center = point(size);
+        add(container, new RS_Circle(&container, {center, number(size / 2000., size / 50.)}));
+    }
+}
+
+void LC_DrawingGenerator::addArcs(RS_EntityContainer& container, int count, double size)
+{
+    for (int i = 0; i < count; ++i) {
+        const RS_Vector center = point(size);
+        const double radius = number(size / 2000., size / 50.);
+        const double angle1 = number(0., M_PI);
+        const double angle2 = number(M_PI, 2. * M_PI);
+        add(container, new RS_Arc(&container, {center, radius, angle1, angle2, false}));
+    }
+}
+
+void LC_DrawingGenerator::addPolylines(RS_EntityContainer& container, int count, int vertices,
+                                       double size)
+{
+    const double step = size / 100.;
+    for (int i = 0; i < count; ++i) {
+        auto polyline = new RS_Polyline(&container);
+        RS_Vector vertex = point(size);
+        for (int j = 0; j < std::max(vertices, 2); ++j) {
+            // every third segment is an arc
+            const double bulge = j % 3 == 2 ? number(-1., 1.) : 0.;
+            polyline->addVertex(vertex, bulge);
+            vertex += point(step) - RS_Vector{step / 2., step / 2.};
+        }
+        add(container, polyline);
+    }
+}
+
+void LC_DrawingGenerator::addSplines(RS_EntityContainer& container, int count, double size)
+{
+    const double step = size / 100.;
+    for (int i = 0; i < count; ++i) {
+        auto spline = new RS_Spline(&container, RS_SplineData(3, false));
+        RS_Vector controlPoint = point(size);
+        for (int j = 0; j < 6; ++j) {
+            spline->addControlPoint(controlPoint);
+            controlPoint += point(step) - RS_Vector{step / 2., step / 2.};
+        }
+        spline->update();
+        add(container, spline);
+    }
+}
+
+std::vector<RS_Text*> LC_DrawingGenerator::addTexts(RS_EntityContainer& container, int count, double size)
+{
+    std::vector<RS_Text*> texts;
+    for (int i = 0; i < count; ++i) {
+        const RS_Vector position = point(size);
+        const double height = number(size / 1000., size / 100.);
+        const double angle = number(0., 2. * M_PI);
+        const QString font = fonts[i % std::size(fonts)];
+        if (i % 4 == 3) {
+            add(container, new RS_MText(&container, RS_MTextData(
+                                            position, height, height * 40., RS_MTextData::VATop,
+                                            RS_MTextData::HALeft, RS_MTextData::LeftToRight,
+                                            RS_MTextData::AtLeast, 1.,
+                                            QString("Generated mtext %1\\Pin %2").arg(i).arg(font),
+                                            font, angle)));
+            continue;
+        }
+        auto text = new RS_Text(&container, RS_TextData(
+                                    position, position, height, 1., RS_TextData::VABaseline,
+                                    RS_TextData::HALeft, RS_TextData::None,
+                                    QString("Generated text %1 in %2").arg(i).arg(font),
+                                    font, angle));
+        add(container, text);
+        texts.push_back(text);
+    }
+    return texts;
+}
+
+std::vector<RS_Hatch*> LC_DrawingGenerator::addHatches(RS_EntityContainer& container, int count,
+                                                       int loops, int vertices, double size)
+{
+    std::vector<RS_Hatch*> hatches;
+    vertices = std::max(vertices, 3);
+    for (int i = 0; i < count; ++i) {
+        const RS_Vector center = point(size);
+        const double radius = number(size / 200., size / 20.);
+        const double scale = number(0.5, 2.) * size / 1000.;
+        const double angle = number(0., M_PI);
+        auto hatch = new RS_Hatch(&container, RS_HatchData(false, scale, angle, "ANSI31"));
+        // star shaped loops around the center, each inside the previous one
+        for (int loopIndex = 0; loopIndex < std::max(loops, 1); ++loopIndex) {
+            const double loopRadius = radius / (loopIndex + 1);
+            std::vector<RS_Vector> corners;
+            for (int j = 0; j < vertices; ++j) {
+                const double direction = 2. * M_PI * j / vertices;
+                corners.push_back(center + RS_Vector{direction} * loopRadius * number(0.7, 0.95));
+            }
+            auto loop = new RS_EntityContainer(hatch);
+            loop->setPen(RS_Pen(RS2::FlagInvalid));
+            for (std::size_t j = 0; j < corners.size(); ++j) {
+                auto edge = new RS_Line(loop, corners[j], corners[(j + 1) % corners.size()]);
+                edge->setPen(RS_Pen(RS2::FlagInvalid));
+                loop->addEntity(edge);
+            }
+            hatch->addEntity(loop);
+        }
+        add(container, hatch);
+        hatch->update();
+        hatches.push_back(hatch);
+    }
+    return hatches;
+}
+
+void LC_DrawingGenerator::addBlocks(RS_Graphic& graphic, int blocks, int inserts, int depth,
+                                    double size)
+{
+    if (blocks <= 0)
+        return;
+    depth = std::clamp(depth, 1, blocks);
+    const double blockSize = size / 50.;
+    // the blocks of each level, from the lowest
+    std::vector<std::vector<RS_Block*>> levels(depth);
+    for (int i = 0; i < blocks; ++i) {
+        const int level = i * depth / blocks;
+        auto block = new RS_Block(&graphic, RS_BlockData(QString("block%1").arg(i), {}, false));
+        addLines(*block, 5, blockSize);
+        addArcs(*block, 2, blockSize);
+        if (level > 0) {
+            const std::vector<RS_Block*>& below = levels[level - 1];
+            for (int j = 0; j < 2; ++j) {
+                RS_Block* inserted = below[std::uniform_int_distribution<std::size_t>{0, below.size() - 1}(m_random)];
+                const RS_Vector position = point(blockSize);
+                const double angle = number(0., 2. * M_PI);
+                add(*block, new RS_Insert(block, RS_InsertData(
+                                              inserted->getName(), position, {0.5, 0.5},
+                                              angle, 1, 1, {}, nullptr, RS2::NoUpdate)));
+            }
+        }
+        graphic.addBlock(block, false);
+        levels[level].push_back(block);
+    }
+
+    const std::vector<RS_Block*>& top = levels.back();
+    for (int i = 0; i < inserts; ++i) {
+        RS_Block* inserted = top[std::uniform_int_distribution<std::size_t>{0, top.size() - 1}(m_random)];
+        const double scale = number(0.5, 2.);
+        const RS_Vector position = point(size);
+        const double angle = number(0., 2. * M_PI);
+        add(graphic, new RS_Insert(&graphic, RS_InsertData(
+                                       inserted->getName(), position, {scale, scale},
+                                       angle, 1, 1, {}, nullptr, RS2::NoUpdate)));
+    }
+    graphic.updateInserts();
+}
@@ -0,0 +1,113 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_DRAWINGGENERATOR_H
+#define LC_DRAWINGGENERATOR_H
+
+#include <random>
+#include <vector>
+
+#include "rs_vector.h"
+
+class RS_Block;
+class RS_Entity;
+class RS_EntityContainer;
+class RS_Graphic;
+class RS_Hatch;
+class RS_Layer;
+class RS_Text;
+
+/**
+ * @brief The LC_DrawingGenerator class creates synthetic drawings for benchmarks and
+ * stress tests, through the engine API. The drawings only depend on the seed and
+ * the parameters.
+ */
+class LC_DrawingGenerator {
+public:
+    struct Parameters {
+        //! side of the square the entities are placed in, in drawing units
+        double size = 1000.;
+        int layers = 10;
+        int lines = 0;
+        int circles = 0;
+        int arcs = 0;
+        int polylines = 0;
+        //! vertices of each polyline
+        int polylineVertices = 8;
+        int splines = 0;
+        //! texts, every fourth one an mtext, in fonts shipped with LibreCAD
+        int texts = 0;
+        //! block definitions, each with a few lines and arcs
+        int blocks = 0;
+        //! inserts of the blocks into the drawing
+        int inserts = 0;
+        //! levels of blocks inserting blocks of the level below, 1 for no nesting
+        int blockDepth = 1;
+        int hatches = 0;
+        //! loops of each hatch, the first one is the outer boundary
+        int hatchLoops = 1;
+        //! edges of each hatch loop
+        int hatchVertices = 4;
+    };
+
+    explicit LC_DrawingGenerator(unsigned seed);
+
+    //! adds the entities of the parameters to the graphic
+    void generate(RS_Graphic& graphic, const Parameters& parameters);
+
+    //! @return a point in the square from 0,0 to size,size
+    RS_Vector point(double size);
+    //! @return a number from min to max
+    double number(double min, double max);
+
+    /**
+     * Adds layers, which the entities added afterwards to the graphic are spread over
+     */
+    void addLayers(RS_Graphic& graphic, int count);
+
+    void addLines(RS_EntityContainer& container, int count, double size);
+    void addCircles(RS_EntityContainer& container, int count, double size);
+    void addArcs(RS_EntityContainer& container, int count, double size);
+    void addPolylines(RS_EntityContainer& container, int count, int vertices, double size);
+    void addSplines(RS_EntityContainer& container, int count, double size);
+    std::vector<RS_Text*> addTexts(RS_EntityContainer& container, int count, double size);
+    std::vector<RS_Hatch*> addHatches(RS_EntityContainer& container, int count,
+                                      int loops, int vertices, double size);
+    /**
+     * Adds blocks, the blocks of each level but the lowest insert two blocks of the
+     * level below, and inserts of the blocks of the highest level into the graphic
+     */
+    void addBlocks(RS_Graphic& graphic, int blocks, int inserts, int depth, double size);
+
+private:
+    void add(RS_EntityContainer& container, RS_Entity* entity);
+
+    std::mt19937 m_random;
+    //! the graphic of the layers
+    const RS_Graphic* m_graphic = nullptr;
+    std::vector<RS_Layer*> m_layers;
+};
+
+#endif
@@ -0,0 +1,435 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <QIODevice>
+#include <QString>
+
+#include "lc_imagestreamwriter.h"
+
+namespace {
+
+// CRC-32 of PNG chunks
+class Crc32 {
+public:
+    void update(const char* data, size_t size)
+    {
+        static const std::array<std::uint32_t, 256> table = [] {
+            std::array<std::uint32_t, 256> t{};
+            for (std::uint32_t n = 0; n < 256; ++n) {
+                std::uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[n] = c;
+            }
+            return t;
+        }();
+        for (size_t i = 0; i < size; ++i)
+            m_crc = table[(m_crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (m_crc >> 8);
+    }
+
+    std::uint32_t value() const
+    {
+        return m_crc ^ 0xFFFFFFFFu;
+    }
+
+private:
+    std::uint32_t m_crc = 0xFFFFFFFFu;
+};
+
+/**
+ * A zlib stream of a single deflate block with the fixed Huffman codes. Only runs of
+ * repeated pixels, at a distance of 3 bytes, are matched: fast, and efficient for
+ * drawings, which are mostly runs of the background color.
+ */
+class DeflateEncoder {
+public:
+    explicit DeflateEncoder(std::string& out):
+        m_out{out}
+    {}
+
+    void begin()
+    {
+        // zlib header: deflate with a 32K window, fastest compression
+        m_out.push_back(char(0x78));
+        m_out.push_back(char(0x01));
+        // not the final block, fixed Huffman codes
+        putBits(0, 1);
+        putBits(1, 2);
+    }
+
+    void compress(const unsigned char* data, size_t size)
+    {
+        updateAdler(data, size);
+        constexpr size_t distance = 3;
+        constexpr size_t maxLength = 258;
+        size_t i = 0;
+        while (i < size) {
+            size_t length = 0;
+            if (i >= distance) {
+                const size_t limit = std::min(maxLength, size - i);
+                while (length < limit && data[i + length] == data[i + length - distance])
+                    ++length;
+            }
+            if (length >= 3) {
+                putLength(int(length));
+                // distance code 2 stands for the distance 3, no extra bits
+                putCode(2, 5);
+                i += length;
+            } else {
+                putSymbol(data[i++]);
+            }
+        }
+    }
+
+    void finish()
+    {
+        putSymbol(256);
+        // an empty final block
+        putBits(1, 1);
+        putBits(1, 2);
+        putSymbol(256);
+        if (m_bitCount > 0)
+            putBits(0, 8 - m_bitCount);
+        const std::uint32_t adler = (m_adlerB << 16) | m_adlerA;
+        for (int shift = 24; shift >= 0; shift -= 8)
+            m_out.push_back(char((adler >> shift) & 0xFF));
+    }
+
+private:
+    void updateAdler(const unsigned char* data, size_t size)
+    {
+        constexpr std::uint32_t base = 65521;
+        // the largest number of bytes summed before the 32 bit sums may overflow
+        constexpr size_t block = 5552;
+        while (size > 0) {
+            const size_t n = std::min(size, block);
+            for (size_t i = 0; i < n; ++i) {
+                m_adlerA += data[i];
+                m_adlerB += m_adlerA;
+            }
+            m_adlerA %= base;
+            m_adlerB %= base;
+            data += n;
+            size -= n;
+        }
+    }
+
+    // bits are packed starting with the least significant bit
+    void putBits(std::uint32_t value, int count)
+    {
+        m_bitBuffer |= std::uint64_t(value) << m_bitCount;
+        m_bitCount += count;
+        while (m_bitCount >= 8) {
+            m_out.push_back(char(m_bitBuffer & 0xFF));
+            m_bitBuffer >>= 8;
+            m_bitCount -= 8;
+        }
+    }
+
+    // Huffman codes are packed starting with the most significant bit
+    void putCode(std::uint32_t code, int length)
+    {
+        std::uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i) {
+            reversed = (reversed << 1) | (code & 1);
+            code >>= 1;
+        }
+        putBits(reversed, length);
+    }
+
+    // a literal or length symbol, by the fixed Huffman codes
+    void putSymbol(int symbol)
+    {
+        if (symbol < 144)
+            putCode(0x30 + symbol, 8);
+        else if (symbol < 256)
+            putCode(0x190 + symbol - 144, 9);
+        else if (symbol < 280)
+            putCode(symbol - 256, 7);
+        else
+            putCode(0xC0 + symbol - 280, 8);
+    }
+
+    void putLength(int length)
+    {
+        static const int bases[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+                                    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const int extraBits[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        int code = 28;
+        while (bases[code] > length)
+            --code;
+        putSymbol(257 + code);
+        if (extraBits[code] > 0)
+            putBits(std::uint32_t(length - bases[code]), extraBits[code]);
+    }
+
+    std::string& m_out;
+    std::uint64_t m_bitBuffer = 0;
+    int m_bitCount = 0;
+    std::uint32_t m_adlerA = 1;
+    std::uint32_t m_adlerB = 0;
+};
+
+void appendBigEndian(std::string& out, std::uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(char((value >> shift) & 0xFF));
+}
+
+void appendLittleEndian(std::string& out, std::uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        out.push_back(char((value >> (8 * i)) & 0xFF));
+}
+
+bool writeAll(QIODevice& device, const std::string& data)
+{
+    return device.write(data.data(), qint64(data.size())) == qint64(data.size());
+}
+
+class PngWriter: public LC_ImageStreamWriter {
+public:
+    explicit PngWriter(QIODevice& device):
+        m_device{device}
+    {}
+
+    bool begin(int width, int height, int dotsPerMeterX, int dotsPerMeterY) override
+    {
+        m_rowSize = size_t(width) * 3;
+        m_row.resize(m_rowSize + 1);
+
+        std::string header{"\x89PNG\r\n\x1a\n", 8};
+        std::string ihdr;
+        appendBigEndian(ihdr, std::uint32_t(width));
+        appendBigEndian(ihdr, std::uint32_t(height));
+        // 8 bit RGB, deflate, adaptive filters, no interlace
+        ihdr.append({char(8), char(2), char(0), char(0), char(0)});
+        std::string phys;
+        appendBigEndian(phys, std::uint32_t(dotsPerMeterX));
+        appendBigEndian(phys, std::uint32_t(dotsPerMeterY));
+        phys.push_back(char(1));
+        m_deflate.begin();
+        return writeAll(m_device, header) && writeChunk("IHDR", ihdr) && writeChunk("pHYs", phys);
+    }
+
+    bool writeRow(const unsigned char* rgb) override
+    {
+        // no filter: runs of pixels are matched by the encoder
+        m_row[0] = 0;
+        std::memcpy(m_row.data() + 1, rgb, m_rowSize);
+        m_deflate.compress(m_row.data(), m_row.size());
+        if (m_idat.size() < chunkSize)
+            return true;
+        const bool ok = writeChunk("IDAT", m_idat);
+        m_idat.clear();
+        return ok;
+    }
+
+    bool end() override
+    {
+        m_deflate.finish();
+        return writeChunk("IDAT", m_idat) && writeChunk("IEND", {});
+    }
+
+private:
+    bool writeChunk(const char* type, const std::string& data)
+    {
+        std::string chunk;
+        chunk.reserve(data.size() + 12);
+        appendBigEndian(chunk, std::uint32_t(data.size()));
+        chunk.append(type, 4);
+        chunk.append(data);
+        Crc32 crc;
+        crc.update(chunk.data() + 4, chunk.size() - 4);
+        appendBigEndian(chunk, crc.value());
+        return writeAll(m_device, chunk);
+    }
+
+    static constexpr size_t chunkSize = 1 << 16;
+    QIODevice& m_device;
+    size_t m_rowSize = 0;
+    std::vector<unsigned char> m_row;
+    std::string m_idat;
+    DeflateEncoder m_deflate{m_idat};
+};
+
+// PackBits runs of a row
+void packBits(const unsigned char* data, size_t size, std::string& out)
+{
+    out.clear();
+    size_t i = 0;
+    while (i < size) {
+        size_t run = 1;
+        while (i + run < size && run < 128 && data[i + run] == data[i])
+            ++run;
+        if (run >= 3) {
+            out.push_back(char(257 - run));
+            out.push_back(char(data[i]));
+            i += run;
+            continue;
+        }
+        const size_t start = i;
+        while (i < size && i - start < 128
+               && !(i + 2 < size && data[i] == data[i + 1] && data[i] == data[i + 2]))
+            ++i;
+        out.push_back(char(i - start - 1));
+        out.append(reinterpret_cast<const char*>(data + start), i - start);
+    }
+}
+
+/**
+ * A little endian baseline TIFF. Strips are written first, the directory is appended
+ * at the end, and its offset is patched in the header, so the device must be a file.
+ */
+class TiffWriter: public LC_ImageStreamWriter {
+public:
+    explicit TiffWriter(QIODevice& device):
+        m_device{device}
+    {}
+
+    bool begin(int width, int height, int dotsPerMeterX, int dotsPerMeterY) override
+    {
+        if (m_device.isSequential())
+            return false;
+        m_width = std::uint32_t(width);
+        m_height = std::uint32_t(height);
+        m_dotsPerMeterX = std::uint32_t(dotsPerMeterX);
+        m_dotsPerMeterY = std::uint32_t(dotsPerMeterY);
+        m_stripOffsets.reserve(size_t(height));
+        m_stripByteCounts.reserve(size_t(height));
+        // the directory offset is written by end()
+        std::string header{"II*\0\0\0\0\0", 8};
+        m_position = header.size();
+        return writeAll(m_device, header);
+    }
+
+    bool writeRow(const unsigned char* rgb) override
+    {
+        packBits(rgb, size_t(m_width) * 3, m_packed);
+        m_stripOffsets.push_back(std::uint32_t(m_position));
+        m_stripByteCounts.push_back(std::uint32_t(m_packed.size()));
+        m_position += m_packed.size();
+        // offsets are 32 bit
+        return m_position <= UINT32_MAX && writeAll(m_device, m_packed);
+    }
+
+    bool end() override
+    {
+        enum Type {Short = 3, Long = 4, Rational = 5};
+        struct Entry {
+            std::uint16_t tag;
+            std::uint16_t type;
+            std::vector<std::uint32_t> values;
+        };
+        // tags in ascending order
+        const std::vector<Entry> entries = {
+            {256, Long, {m_width}},
+            {257, Long, {m_height}},
+            {258, Short, {8, 8, 8}},
+            {259, Short, {32773}}, // PackBits
+            {262, Short, {2}}, // RGB
+            {273, Long, m_stripOffsets},
+            {277, Short, {3}},
+            {278, Long, {1}},
+            {279, Long, m_stripByteCounts},
+            {282, Rational, {m_dotsPerMeterX, 100}},
+            {283, Rational, {m_dotsPerMeterY, 100}},
+            {284, Short, {1}},
+            {296, Short, {3}} // centimeters
+        };
+
+        // values not fitting into the entries precede the directory
+        std::string data;
+        if (m_position % 2 != 0)
+            data.push_back('\0');
+        std::string directory;
+        appendLittleEndian(directory, std::uint32_t(entries.size()), 2);
+        for (const Entry& entry: entries) {
+            const int size = entry.type == Short ? 2 : 4;
+            const size_t count = entry.type == Rational ? entry.values.size() / 2 : entry.values.size();
+            appendLittleEndian(directory, entry.tag, 2);
+            appendLittleEndian(directory, entry.type, 2);
+            appendLittleEndian(directory, std::uint32_t(count), 4);
+            std::string values;
+            for (std::uint32_t value: entry.values)
+                appendLittleEndian(values, value, size);
+            if (values.size() <= 4) {
+                values.resize(4, '\0');
+                directory.append(values);
+            } else {
+                appendLittleEndian(directory, std::uint32_t(m_position + data.size()), 4);
+                data.append(values);
+            }
+        }
+        // no next directory
+        appendLittleEndian(directory, 0, 4);
+
+        const quint64 directoryOffset = m_position + data.size();
+        if (directoryOffset + directory.size() > UINT32_MAX)
+            return false;
+        std::string offset;
+        appendLittleEndian(offset, std::uint32_t(directoryOffset), 4);
+        return writeAll(m_device, data) && writeAll(m_device, directory)
+            && m_device.seek(4) && writeAll(m_device, offset)
+            && m_device.seek(qint64(directoryOffset + directory.size()));
+    }
+
+private:
+    QIODevice& m_device;
+    std::uint32_t m_width = 0;
+    std::uint32_t m_height = 0;
+    std::uint32_t m_dotsPerMeterX = 0;
+    std::uint32_t m_dotsPerMeterY = 0;
+    //! the position in the file
+    quint64 m_position = 0;
+    std::vector<std::uint32_t> m_stripOffsets;
+    std::vector<std::uint32_t> m_stripByteCounts;
+    std::string m_packed;
+};
+}
+
+bool LC_ImageStreamWriter::isSupported(const QString& format)
+{
+    const QString f = format.toLower();
+    return f == "png" || f == "tif" || f == "tiff";
+}
+
+std::unique_ptr<LC_ImageStreamWriter> LC_ImageStreamWriter::create(const QString& format, QIODevice& device)
+{
+    const QString f = format.toLower();
+    if (f == "png")
+        return std::make_unique<PngWriter>(device);
+    if (f == "tif" || f == "tiff")
+        return std::make_unique<TiffWriter>(device);
+    return {};
+}
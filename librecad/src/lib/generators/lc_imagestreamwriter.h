@@ -0,0 +1,77 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_IMAGESTREAMWRITER_H
+#define LC_IMAGESTREAMWRITER_H
+
+#include <memory>
+
+class QIODevice;
+class QString;
+
+/**
+ * Writes an 8 bit RGB image row by row, so images larger than the memory available
+ * for a whole QImage can be written while they are rendered.
+ *
+ * PNG files are compressed by a fast deflate encoder with fixed Huffman codes, TIFF
+ * files by PackBits, one strip per row.
+ */
+class LC_ImageStreamWriter {
+public:
+    virtual ~LC_ImageStreamWriter() = default;
+
+    /**
+     * @brief isSupported whether images of the format may be written by rows
+     * @param format - the image format, e.g. "png", case insensitive
+     */
+    static bool isSupported(const QString& format);
+
+    /**
+     * @brief create a writer of the format to the device, which is open for writing
+     * @return the writer, nullptr for an unsupported format
+     */
+    static std::unique_ptr<LC_ImageStreamWriter> create(const QString& format, QIODevice& device);
+
+    /**
+     * @brief begin write the header of an image
+     * @param dotsPerMeterX, dotsPerMeterY - the resolution stored in the image
+     * @return false on write errors
+     */
+    virtual bool begin(int width, int height, int dotsPerMeterX, int dotsPerMeterY) = 0;
+
+    /**
+     * @brief writeRow append the next row of the image
+     * @param rgb - width pixels of 3 bytes: red, green, blue
+     * @return false on write errors
+     */
+    virtual bool writeRow(const unsigned char* rgb) = 0;
+
+    /**
+     * @brief end complete the image, after all rows are written
+     * @return false on write errors
+     */
+    virtual bool end() = 0;
+};
+
+#endif // LC_IMAGESTREAMWRITER_H
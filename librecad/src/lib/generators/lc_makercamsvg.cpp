@@ -22,6 +22,11 @@
 **
 **********************************************************************/
 #include<cmath>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "lc_makercamsvg.h"
 
 #include "lc_xmlwriterinterface.h"
@@ -48,6 +53,42 @@ namespace {
 const std::string NAMESPACE_URI_SVG = "http://www.w3.org/2000/svg";
 const std::string NAMESPACE_URI_LC = "https://librecad.org";
 const std::string NAMESPACE_URI_XLINK = "http://www.w3.org/1999/xlink";
+constexpr int maxPrecision = 12;
+
+// a number with fixed decimal places, without trailing zeros, independent of the locale
+std::string fixedToString(double value, int precision)
+{
+    static const double powers[maxPrecision + 1] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+                                                    1e7, 1e8, 1e9, 1e10, 1e11, 1e12};
+    const double scaled = std::abs(value) * powers[precision];
+    // out of the range of integer digits, or not a number
+    if (!(scaled < 9e18))
+        return RS_Utility::doubleToString(value, precision).toStdString();
+
+    unsigned long long digits = std::llround(scaled);
+    const bool negative = value < 0. && digits != 0;
+    int decimals = precision;
+    while (decimals > 0 && digits % 10 == 0) {
+        digits /= 10;
+        --decimals;
+    }
+    char buffer[32];
+    char* const end = buffer + sizeof(buffer);
+    char* p = end;
+    for (int i = 0; i < decimals; ++i) {
+        *--p = char('0' + digits % 10);
+        digits /= 10;
+    }
+    if (decimals > 0)
+        *--p = '.';
+    do {
+        *--p = char('0' + digits % 10);
+        digits /= 10;
+    } while (digits > 0);
+    if (negative)
+        *--p = '-';
+    return std::string(p, end);
+}
 }
 
 LC_MakerCamSVG::LC_MakerCamSVG(std::unique_ptr<LC_XMLWriterInterface> xmlWriter,
@@ -86,6 +127,16 @@ std::string LC_MakerCamSVG::resultAsString() {
     return xmlWriter->documentAsString();
 }
 
+void LC_MakerCamSVG::endDocument() {
+
+    xmlWriter->endDocument();
+}
+
+void LC_MakerCamSVG::setPrecision(int precision) {
+
+    m_precision = std::clamp(precision, 0, maxPrecision);
+}
+
 void LC_MakerCamSVG::write(RS_Graphic* graphic) {
 
     RS_DEBUG->print("RS_MakerCamSVG::write: Writing root node ...");
@@ -222,6 +273,10 @@ void LC_MakerCamSVG::writeEntities(RS_Document* document, RS_Layer* layer) {
 
     RS_DEBUG->print("RS_MakerCamSVG::writeEntities: Writing entities from layer ...");
 
+    // paths of the enclosing layer, while an inline block is written
+    std::vector<PathSegment> enclosingSegments;
+    std::swap(enclosingSegments, m_pathSegments);
+
 	for (auto e: *document) {
 
         if (e->getLayer() == layer) {
@@ -232,6 +287,81 @@ void LC_MakerCamSVG::writeEntities(RS_Document* document, RS_Layer* layer) {
             }
         }
     }
+
+    if (m_mergePaths) {
+
+        writeMergedPaths(m_pathSegments);
+    }
+    m_pathSegments = std::move(enclosingSegments);
+}
+
+void LC_MakerCamSVG::writePath(const RS_Vector& start, const std::string& commands, const RS_Vector& end,
+                               bool closed) {
+
+    if (m_mergePaths) {
+        m_pathSegments.push_back({pointXml(start), commands, pointXml(end), closed});
+        return;
+    }
+
+    xmlWriter->addElement("path", NAMESPACE_URI_SVG);
+
+    xmlWriter->addAttribute("d", svgPathMoveTo(start) + commands);
+
+    xmlWriter->closeElement();
+}
+
+void LC_MakerCamSVG::writeMergedPaths(const std::vector<PathSegment>& segments) {
+
+    RS_DEBUG->print("RS_MakerCamSVG::writeMergedPaths: Merging %d paths ...", int(segments.size()));
+
+    // open segments by their start points, and the end points of all segments
+    std::unordered_multimap<std::string, size_t> starts;
+    std::unordered_set<std::string> ends;
+    for (size_t i = 0; i < segments.size(); i++) {
+        if (!segments[i].closed) {
+            starts.emplace(segments[i].start, i);
+            ends.insert(segments[i].end);
+        }
+    }
+
+    std::vector<bool> written(segments.size(), false);
+    auto writeChain = [&](size_t first) {
+        const PathSegment& segment = segments[first];
+        written[first] = true;
+        std::string path = "M" + segment.start + " " + segment.commands;
+        if (!segment.closed) {
+            const std::string* end = &segment.end;
+            for (;;) {
+                auto [begin, last] = starts.equal_range(*end);
+                auto next = std::find_if(begin, last, [&written](const auto& entry) {
+                    return !written[entry.second];
+                });
+                if (next == last)
+                    break;
+                const size_t i = next->second;
+                starts.erase(next);
+                written[i] = true;
+                path += segments[i].commands;
+                end = &segments[i].end;
+            }
+        }
+
+        xmlWriter->addElement("path", NAMESPACE_URI_SVG);
+
+        xmlWriter->addAttribute("d", path);
+
+        xmlWriter->closeElement();
+    };
+
+    // chains start at segments not continuing another one, remaining segments form loops
+    for (size_t i = 0; i < segments.size(); i++) {
+        if (!written[i] && (segments[i].closed || ends.count(segments[i].start) == 0))
+            writeChain(i);
+    }
+    for (size_t i = 0; i < segments.size(); i++) {
+        if (!written[i])
+            writeChain(i);
+    }
 }
 
 void LC_MakerCamSVG::writeEntity(RS_Entity* entity) {
@@ -369,6 +499,11 @@ void LC_MakerCamSVG::writeLine(RS_Line* line) {
         xmlWriter->addAttribute("d", path);
         xmlWriter->closeElement();
     }
+    else if (m_mergePaths) {
+        RS_DEBUG->print("RS_MakerCamSVG::writeLine: write line as path to merge");
+
+        writePath(startpoint, svgPathLineTo(endpoint), endpoint);
+    }
     else {
         RS_DEBUG->print("RS_MakerCamSVG::writeLine: write standard line ");
         xmlWriter->addElement("line", NAMESPACE_URI_SVG);
@@ -386,7 +521,7 @@ void LC_MakerCamSVG::writePolyline(RS_Polyline* polyline) {
 
     RS_DEBUG->print("RS_MakerCamSVG::writePolyline: Writing polyline ...");
 
-    std::string path = svgPathMoveTo(convertToSvg(polyline->getStartpoint()));
+    std::string path;
 
 	for (auto entity: *polyline) {
 
@@ -409,11 +544,8 @@ void LC_MakerCamSVG::writePolyline(RS_Polyline* polyline) {
         path += svgPathClose();
     }
 
-    xmlWriter->addElement("path", NAMESPACE_URI_SVG);
-
-    xmlWriter->addAttribute("d", path);
-
-    xmlWriter->closeElement();
+    writePath(convertToSvg(polyline->getStartpoint()), path, convertToSvg(polyline->getEndpoint()),
+              polyline->isClosed());
 }
 
 void LC_MakerCamSVG::writeCircle(RS_Circle* circle) {
@@ -435,14 +567,7 @@ void LC_MakerCamSVG::writeArc(RS_Arc* arc) {
 
     RS_DEBUG->print("RS_MakerCamSVG::writeArc: Writing arc ...");
 
-    std::string path = svgPathMoveTo(convertToSvg(arc->getStartpoint())) +
-                       svgPathArc(arc);
-
-    xmlWriter->addElement("path", NAMESPACE_URI_SVG);
-
-    xmlWriter->addAttribute("d", path);
-
-    xmlWriter->closeElement();
+    writePath(convertToSvg(arc->getStartpoint()), svgPathArc(arc), convertToSvg(arc->getEndpoint()));
 }
 
 void LC_MakerCamSVG::writeEllipse(RS_Ellipse* ellipse) {
@@ -456,6 +581,9 @@ void LC_MakerCamSVG::writeEllipse(RS_Ellipse* ellipse) {
     if (convertEllipsesToBeziers) {
 
         std::string path = "";
+        RS_Vector path_start;
+        RS_Vector path_end;
+        bool closed = false;
 
         if (ellipse->isEllipticArc()) {
 
@@ -484,7 +612,8 @@ void LC_MakerCamSVG::writeEllipse(RS_Ellipse* ellipse) {
 
 			RS_Vector start_point = centerTranslation + ellipse->getEllipsePoint(start_angle);
 
-            path = svgPathMoveTo(start_point);
+            path_start = start_point;
+            path_end = start_point;
 
             for (int i = 1; i <= segments; i++) {
                 double segment_start_angle = start_angle + ((i - 1) / (double)segments) * total_angle;
@@ -497,6 +626,7 @@ void LC_MakerCamSVG::writeEllipse(RS_Ellipse* ellipse) {
                 RS_Vector segment_control_point_2 = segment_end_point - calcEllipsePointDerivative(majorradius, minorradius, x_axis_rotation, segment_end_angle) * alpha;
 
                 path += svgPathCurveTo(segment_end_point, segment_control_point_1, segment_control_point_2);
+                path_end = segment_end_point;
             }
         }
         else {
@@ -519,19 +649,17 @@ void LC_MakerCamSVG::writeEllipse(RS_Ellipse* ellipse) {
             RS_Vector offsetmajor {major * kappa};
             RS_Vector offsetminor {minor * kappa};
 
-            path = svgPathMoveTo(center - major) +
-                   svgPathCurveTo((center - minor), (center - major - offsetminor), (center - minor - offsetmajor)) +
+            path_start = center - major;
+            path_end = path_start;
+            closed = true;
+            path = svgPathCurveTo((center - minor), (center - major - offsetminor), (center - minor - offsetmajor)) +
                    svgPathCurveTo((center + major), (center - minor + offsetmajor), (center + major - offsetminor)) +
                    svgPathCurveTo((center + minor), (center + major + offsetminor), (center + minor + offsetmajor)) +
                    svgPathCurveTo((center - major), (center + minor - offsetmajor), (center - major + offsetminor)) +
                    svgPathClose();
         }
 
-        xmlWriter->addElement("path", NAMESPACE_URI_SVG);
-
-        xmlWriter->addAttribute("d", path);
-
-        xmlWriter->closeElement();
+        writePath(path_start, path, path_end, closed);
     }
     else {
 
@@ -556,14 +684,11 @@ void LC_MakerCamSVG::writeEllipse(RS_Ellipse* ellipse) {
                 sweep_flag = !sweep_flag;
             }
 
-            std::string path = svgPathMoveTo(convertToSvg(ellipse->getStartpoint())) +
-                               svgPathArc(convertToSvg(ellipse->getEndpoint()), majorradius, minorradius, x_axis_rotation, large_arc_flag, sweep_flag);
-
-            xmlWriter->addElement("path", NAMESPACE_URI_SVG);
-
-            xmlWriter->addAttribute("d", path);
+            RS_Vector endpoint = convertToSvg(ellipse->getEndpoint());
 
-            xmlWriter->closeElement();
+            writePath(convertToSvg(ellipse->getStartpoint()),
+                      svgPathArc(endpoint, majorradius, minorradius, x_axis_rotation, large_arc_flag, sweep_flag),
+                      endpoint);
         }
         else {
 
@@ -620,7 +745,7 @@ void LC_MakerCamSVG::writeCubicBeziers(const std::vector<RS_Vector> &control_poi
 
     std::vector<RS_Vector> bezier_points = calcCubicBezierPoints(control_points, is_closed);
 
-    std::string path = svgPathMoveTo(convertToSvg(bezier_points[0]));
+    std::string path;
 
     int bezier_points_size = bezier_points.size();
 
@@ -630,18 +755,14 @@ void LC_MakerCamSVG::writeCubicBeziers(const std::vector<RS_Vector> &control_poi
         path += svgPathCurveTo(convertToSvg(bezier_points[3 * (i + 1)]), convertToSvg(bezier_points[3 * (i + 1) - 2]), convertToSvg(bezier_points[3 * (i + 1) - 1]));
     }
 
-    xmlWriter->addElement("path", NAMESPACE_URI_SVG);
-
-    xmlWriter->addAttribute("d", path);
-
-    xmlWriter->closeElement();
+    writePath(convertToSvg(bezier_points[0]), path, convertToSvg(bezier_points[3 * bezier_count]));
 }
 
 void LC_MakerCamSVG::writeQuadraticBeziers(const std::vector<RS_Vector> &control_points, bool is_closed) {
 
     std::vector<RS_Vector> bezier_points = calcQuadraticBezierPoints(control_points, is_closed);
 
-    std::string path = svgPathMoveTo(convertToSvg(bezier_points[0]));
+    std::string path;
 
     int bezier_points_size = bezier_points.size();
 
@@ -651,11 +772,7 @@ void LC_MakerCamSVG::writeQuadraticBeziers(const std::vector<RS_Vector> &control
         path += svgPathQuadraticCurveTo(convertToSvg(bezier_points[2 * (i + 1)]), convertToSvg(bezier_points[2 * (i + 1) - 1]));
     }
 
-    xmlWriter->addElement("path", NAMESPACE_URI_SVG);
-
-    xmlWriter->addAttribute("d", path);
-
-    xmlWriter->closeElement();
+    writePath(convertToSvg(bezier_points[0]), path, convertToSvg(bezier_points[2 * bezier_count]));
 }
 
 std::vector<RS_Vector> LC_MakerCamSVG::calcCubicBezierPoints(const std::vector<RS_Vector> &control_points, bool is_closed) {
@@ -772,9 +889,9 @@ std::vector<RS_Vector> LC_MakerCamSVG::calcQuadraticBezierPoints(const std::vect
     return bezier_points;
 }
 
-std::string LC_MakerCamSVG::numXml(double value) {
-
-    return RS_Utility::doubleToString(value, 8).toStdString();
+std::string LC_MakerCamSVG::numXml(double value) const
+{
+    return fixedToString(value, m_precision);
 }
 
 std::string LC_MakerCamSVG::lengthXml(double value) const
@@ -782,6 +899,11 @@ std::string LC_MakerCamSVG::lengthXml(double value) const
     return numXml(lengthFactor*value);
 }
 
+std::string LC_MakerCamSVG::pointXml(const RS_Vector& point) const
+{
+    return lengthXml(point.x) + "," + lengthXml(point.y);
+}
+
 RS_Vector LC_MakerCamSVG::convertToSvg(RS_Vector vector) const
 {
 
@@ -811,12 +933,12 @@ std::string LC_MakerCamSVG::svgPathQuadraticCurveTo(RS_Vector point, RS_Vector c
 
 std::string LC_MakerCamSVG::svgPathLineTo(RS_Vector point) const
 {
-    return "L" + lengthXml(point.x) + "," + lengthXml(point.y) + " ";
+    return "L" + pointXml(point) + " ";
 }
 
 std::string LC_MakerCamSVG::svgPathMoveTo(RS_Vector point) const
 {
-    return "M" + lengthXml(point.x) + "," + lengthXml(point.y) + " ";
+    return "M" + pointXml(point) + " ";
 }
 
 std::string LC_MakerCamSVG::svgPathArc(RS_Arc* arc) const
@@ -27,6 +27,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "rs.h"
 #include "rs_vector.h"
@@ -71,9 +72,23 @@ public:
 
     bool generate(RS_Graphic* graphic);
     std::string resultAsString();
+    /**
+     * @brief endDocument end the document, when the xml writer streams it to a device
+     */
+    void endDocument();
     void setExportPoints(bool exportPoints) {
         m_exportPoints = exportPoints;
     }
+    /**
+     * @brief setMergePaths write connected segments of a layer as single paths
+     */
+    void setMergePaths(bool mergePaths) {
+        m_mergePaths = mergePaths;
+    }
+    /**
+     * @brief setPrecision the number of decimal places of written numbers
+     */
+    void setPrecision(int precision);
 
 private:
     void write(RS_Graphic* graphic);
@@ -101,10 +116,22 @@ private:
     void writeQuadraticBeziers(const std::vector<RS_Vector> &control_points, bool is_closed);
     void writeImage(RS_Image* image);
 
+    /**
+     * @brief writePath write a path, or keep it to be merged with connected paths
+     * @param start - the start point in svg coordinates
+     * @param commands - the path commands after moving to the start point
+     * @param end - the end point in svg coordinates
+     * @param closed - whether the commands close the path, so it's never merged
+     */
+    void writePath(const RS_Vector& start, const std::string& commands, const RS_Vector& end,
+                   bool closed = false);
+    struct PathSegment;
+    void writeMergedPaths(const std::vector<PathSegment>& segments);
+
     std::vector<RS_Vector> calcCubicBezierPoints(const std::vector<RS_Vector> &control_points, bool is_closed);
     std::vector<RS_Vector> calcQuadraticBezierPoints(const std::vector<RS_Vector> &control_points, bool is_closed);
 
-    static std::string numXml(double value);
+    std::string numXml(double value) const;
     /**
      * @brief lengthXml convert length to xml string
      * using lengthFactor to convert unknown units into mm
@@ -112,6 +139,7 @@ private:
      * @return
      */
     std::string lengthXml(double value) const;
+    std::string pointXml(const RS_Vector& point) const;
     RS_Vector convertToSvg(RS_Vector vector) const;
 
     std::string svgPathClose() const;
@@ -140,6 +168,8 @@ private:
     bool exportImages = false;
     bool convertLineTypes = false;
     bool m_exportPoints = false;
+    bool m_mergePaths = false;
+    int m_precision = 8;
     double defaultElementWidth = 0.;
     double defaultDashLinePatternLength = 0.;
 
@@ -154,6 +184,14 @@ private:
      */
     double lengthFactor = 0.;
 
+    struct PathSegment {
+        std::string start;
+        std::string commands;
+        std::string end;
+        bool closed = false;
+    };
+    //! paths of the entities being written, to be merged
+    std::vector<PathSegment> m_pathSegments;
 };
 
 #endif
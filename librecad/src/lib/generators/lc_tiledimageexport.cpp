@@ -0,0 +1,167 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QFile>
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+
+#include "lc_imagestreamwriter.h"
+#include "lc_tiledimageexport.h"
+#include "rs_debug.h"
+#include "rs_graphic.h"
+#include "rs_painterqt.h"
+#include "rs_staticgraphicview.h"
+
+namespace {
+//! images with more pixels are exported by bands
+constexpr qint64 tiledPixels = qint64(8192) * 8192;
+//! the number of pixels of a band, for the band height
+constexpr int bandPixels = 1 << 22;
+//! the resolution of the exported images, 72 dpi as QImage by default
+constexpr int dotsPerMeter = 2835;
+}
+
+bool LC_TiledImageExport::isTiled(const QString& format, const QSize& size)
+{
+    return LC_ImageStreamWriter::isSupported(format)
+        && qint64(size.width()) * size.height() > tiledPixels;
+}
+
+bool LC_TiledImageExport::exportImage(RS_Graphic& graphic, const QString& name, const QString& format,
+                                      const QSize& size, const QSize& borders, bool black, bool bw)
+{
+    const int width = size.width();
+    const int height = size.height();
+    if (width <= 0 || height <= 0)
+        return false;
+
+    QFile file{name};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_TiledImageExport::exportImage: cannot open %s",
+                        name.toLatin1().data());
+        return false;
+    }
+    std::unique_ptr<LC_ImageStreamWriter> writer = LC_ImageStreamWriter::create(format, file);
+    if (writer == nullptr)
+        return false;
+
+    // the zoom factor and the offsets of the whole image
+    RS_StaticGraphicView fullView(width, height, nullptr, &borders);
+    fullView.setBackground(black ? Qt::black : Qt::white);
+    fullView.setContainer(&graphic);
+    fullView.zoomAuto(false);
+
+    const QColor background = black ? Qt::black : Qt::white;
+    RS2::DrawingMode drawingMode = RS2::ModeFull;
+    if (bw)
+        drawingMode = black ? RS2::ModeWB : RS2::ModeBW;
+
+    RS_GraphicView::prepareConcurrentDrawing(std::vector<RS_Entity*>(graphic.begin(), graphic.end()));
+
+    const int bandHeight = std::min(std::max(bandPixels / width, 16), height);
+    const int bands = (height + bandHeight - 1) / bandHeight;
+    QThreadPool pool;
+    const int workers = std::clamp(pool.maxThreadCount(), 1, bands);
+    pool.setMaxThreadCount(workers);
+
+    // each running band takes a view, shifted to the band
+    std::vector<std::unique_ptr<RS_StaticGraphicView>> views;
+    std::vector<RS_StaticGraphicView*> freeViews;
+    for (int i = 0; i < workers; ++i) {
+        views.push_back(std::make_unique<RS_StaticGraphicView>(width, bandHeight, nullptr));
+        views.back()->copyRenderSettings(fullView);
+        views.back()->setConcurrentDrawing(true);
+        freeViews.push_back(views.back().get());
+    }
+
+    std::mutex mutex;
+    std::condition_variable rendered;
+    std::map<int, QImage> images;
+    auto renderBand = [&](int band) {
+        RS_StaticGraphicView* view = nullptr;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            view = freeViews.back();
+            freeViews.pop_back();
+        }
+        view->setOffset(fullView.getOffsetX(),
+                        fullView.getOffsetY() + band * bandHeight + bandHeight - height);
+
+        QImage image(width, bandHeight, QImage::Format_RGB32);
+        RS_PainterQt painter(&image);
+        painter.setBackground(background);
+        painter.setDrawingMode(drawingMode);
+        painter.eraseRect(0, 0, width, bandHeight);
+        view->drawEntity(&painter, &graphic);
+        painter.flushAndEnd();
+        image = image.convertToFormat(QImage::Format_RGB888);
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            freeViews.push_back(view);
+            images[band] = std::move(image);
+        }
+        rendered.notify_all();
+    };
+
+    // bands are written in order; at most two bands per worker are pending
+    const int window = 2 * workers;
+    int started = 0;
+    bool ok = writer->begin(width, height, dotsPerMeter, dotsPerMeter);
+    for (int band = 0; ok && band < bands; ++band) {
+        for (; started < bands && started < band + window; ++started)
+            pool.start([&renderBand, started]() { renderBand(started); });
+
+        QImage image;
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            rendered.wait(lock, [&images, band]() { return images.count(band) > 0; });
+            image = std::move(images[band]);
+            images.erase(band);
+        }
+        const int rows = std::min(bandHeight, height - band * bandHeight);
+        for (int y = 0; ok && y < rows; ++y)
+            ok = writer->writeRow(image.constScanLine(y));
+    }
+    // running bands refer to the views
+    pool.waitForDone();
+
+    ok = ok && writer->end();
+    file.close();
+    if (!ok) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_TiledImageExport::exportImage: cannot write %s",
+                        name.toLatin1().data());
+        file.remove();
+    }
+    return ok;
+}
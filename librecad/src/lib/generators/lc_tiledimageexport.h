@@ -0,0 +1,56 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_TILEDIMAGEEXPORT_H
+#define LC_TILEDIMAGEEXPORT_H
+
+class QSize;
+class QString;
+class RS_Graphic;
+
+/**
+ * Exports a drawing as a raster image by horizontal bands, rendered concurrently and
+ * streamed to the image file in order, so the whole image is never held in memory.
+ */
+class LC_TiledImageExport {
+public:
+    /**
+     * @brief isTiled whether an image is large enough to be exported by bands, and the
+     * format can be written by rows
+     * @param format - the image format, e.g. "png", case insensitive
+     */
+    static bool isTiled(const QString& format, const QSize& size);
+
+    /**
+     * @brief exportImage render the drawing, zoomed to fit into the image, to a file
+     * @param borders - the borders around the drawing, in pixels
+     * @param black - true for a black background, false for white
+     * @param bw - true for a black and white image, false for colors
+     * @return false on open or write errors, and for unsupported formats
+     */
+    static bool exportImage(RS_Graphic& graphic, const QString& name, const QString& format,
+                            const QSize& size, const QSize& borders, bool black, bool bw);
+};
+
+#endif // LC_TILEDIMAGEEXPORT_H
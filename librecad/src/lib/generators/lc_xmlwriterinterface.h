@@ -38,6 +38,8 @@ public:
 
     virtual void closeElement() = 0;
 
+    virtual void endDocument() = 0;
+
     virtual std::string documentAsString() = 0;
 
 	LC_XMLWriterInterface() = default;
@@ -32,6 +32,12 @@ LC_XMLWriterQXmlStreamWriter::LC_XMLWriterQXmlStreamWriter():
 	//xmlWriter->setEncoding("UTF-8");
 }
 
+LC_XMLWriterQXmlStreamWriter::LC_XMLWriterQXmlStreamWriter(QIODevice* device):
+	xmlWriter(new QXmlStreamWriter(device))
+{
+	xmlWriter->setAutoFormatting(true);
+}
+
 LC_XMLWriterQXmlStreamWriter::~LC_XMLWriterQXmlStreamWriter() = default;
 
 void LC_XMLWriterQXmlStreamWriter::createRootElement(const std::string &name, const std::string &namespace_uri) {
@@ -56,8 +62,14 @@ void LC_XMLWriterQXmlStreamWriter::closeElement() {
     xmlWriter->writeEndElement();
 }
 
+void LC_XMLWriterQXmlStreamWriter::endDocument() {
+    if (!ended)
+        xmlWriter->writeEndDocument();
+    ended = true;
+}
+
 std::string LC_XMLWriterQXmlStreamWriter::documentAsString() {
-    xmlWriter->writeEndDocument();
+    endDocument();
 
     return xml.toStdString();
 }
@@ -25,9 +25,34 @@
 **********************************************************************/
 
 
+#include <QCoreApplication>
+#include <QThread>
+
 #include "rs_dialogfactory.h"
 #include "rs_debug.h"
 
+namespace {
+/**
+ * Factory used by worker threads: no dialogs are shown, command messages
+ * are queued to the factory object of the GUI thread.
+ */
+class WorkerFactory : public RS_DialogFactoryAdapter {
+public:
+	void commandMessage(const QString& m) override {
+		QCoreApplication* app = QCoreApplication::instance();
+		if (app != nullptr)
+			QMetaObject::invokeMethod(app, [m]() {
+				RS_DialogFactory::instance()->commandMessage(m);
+			}, Qt::QueuedConnection);
+	}
+};
+
+bool isGuiThread() {
+	QCoreApplication* app = QCoreApplication::instance();
+	return app == nullptr || QThread::currentThread() == app->thread();
+}
+}
+
 /**
  * Private constructor.
  */
@@ -64,11 +89,17 @@ void RS_DialogFactory::setFactoryObject(RS_DialogFactoryInterface* fo) {
 
 /**
  * @return Factory object. This is never nullptr. If no factory
- * object was set, the default adapter will be returned.
+ * object was set, the default adapter will be returned. Worker threads
+ * get an adapter which only forwards command messages to the GUI thread.
  */
 RS_DialogFactoryInterface* RS_DialogFactory::getFactoryObject()
 {
-	return factoryObject ? factoryObject : &factoryAdapter;
+	if (!isGuiThread()) {
+		static WorkerFactory workerFactory;
+		return &workerFactory;
+	}
+	RS_DialogFactoryInterface* fo = factoryObject;
+	return fo ? fo : &factoryAdapter;
 }
 
 
@@ -76,6 +107,5 @@ RS_DialogFactoryInterface* RS_DialogFactory::getFactoryObject()
 void RS_DialogFactory::commandMessage(const QString& m) {
 	RS_DEBUG->print("RS_DialogFactory::commandMessage");
 
-	if (factoryObject)
-		factoryObject->commandMessage(m);
+	RS_DialogFactory::getFactoryObject()->commandMessage(m);
 }
@@ -28,6 +28,8 @@
 #ifndef RS_DIALOGFACTORY_H
 #define RS_DIALOGFACTORY_H
 
+#include <atomic>
+
 #include "rs_dialogfactoryadapter.h"
 
 class RS_DialogFactoryInterface;
@@ -53,7 +55,7 @@ public:
 	void commandMessage(const QString& m);
 
 private:
-	RS_DialogFactoryInterface* factoryObject;
+	std::atomic<RS_DialogFactoryInterface*> factoryObject;
 	RS_DialogFactoryAdapter factoryAdapter;
 };
 
@@ -27,19 +27,28 @@
 
 #include<climits>
 #include<cmath>
+#include <map>
+#include <optional>
+#include <tuple>
 
 #include <QApplication>
 #include <QAction>
 #include <QMouseEvent>
+#include <QScreen>
+#include <QWindow>
 #include <QtAlgorithms>
 #include "rs_graphicview.h"
 
+#include "lc_pentable.h"
 #include "rs_color.h"
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "rs_eventhandler.h"
 #include "rs_graphic.h"
 #include "rs_grid.h"
+#include "rs_hatch.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
 #include "rs_line.h"
 #include "rs_linetypepattern.h"
 #include "rs_math.h"
@@ -79,6 +88,50 @@ struct RS_GraphicView::ColorData {
     bool hideRelativeZero = false;
 };
 
+// Resolved pens of entities drawn in the current frame, at the zoom of the view
+struct RS_GraphicView::PenCache {
+    // entity layer, parent and pen handle
+    using Key = std::tuple<const RS_Layer*, const RS_EntityContainer*, LC_PenTable::Handle>;
+    std::map<Key, RS_Pen> pens;
+    // the view factor of the screen widths of the pens
+    RS_Vector factor{0., 0.};
+};
+
+namespace {
+// adds the painter calls and pen changes while drawing a frame to the statistics
+class PainterCounter {
+public:
+    PainterCounter(const RS_Painter& painter, RS_GraphicView::DrawStatistics& statistics):
+        m_painter{painter}
+      , m_statistics{statistics}
+      , m_drawCalls{painter.getDrawCalls()}
+      , m_penChanges{painter.getPenChanges()}
+    {}
+
+    ~PainterCounter()
+    {
+        m_statistics.painterCalls += m_painter.getDrawCalls() - m_drawCalls;
+        m_statistics.penChanges += m_painter.getPenChanges() - m_penChanges;
+    }
+
+private:
+    const RS_Painter& m_painter;
+    RS_GraphicView::DrawStatistics& m_statistics;
+    const unsigned long m_drawCalls;
+    const unsigned long m_penChanges;
+};
+}
+
+RS_GraphicView::DrawStatistics& RS_GraphicView::DrawStatistics::operator += (const DrawStatistics& other)
+{
+    visited += other.visited;
+    culled += other.culled;
+    drawn += other.drawn;
+    penChanges += other.penChanges;
+    painterCalls += other.painterCalls;
+    return *this;
+}
+
 /**
  * Constructor.
  */
@@ -86,9 +139,11 @@ RS_GraphicView::RS_GraphicView(QWidget* parent, Qt::WindowFlags f)
     :QWidget(parent, f)
 	,eventHandler{new RS_EventHandler{this}}
     , m_colorData{std::make_unique<ColorData>()}
+    , m_penCache{std::make_unique<PenCache>()}
     ,grid{std::make_unique<RS_Grid>(this)}
     ,defaultSnapMode{std::make_unique<RS_SnapMode>()}
 	,drawingMode(RS2::ModeFull)
+    ,m_results{std::make_unique<LC_ResultQueue>()}
 	,savedViews(16)
     ,previousViewTime{std::make_unique<QDateTime>(QDateTime::currentDateTime())}
 {
@@ -108,6 +163,51 @@ RS_GraphicView::RS_GraphicView(QWidget* parent, Qt::WindowFlags f)
     RS_SETTINGS->beginGroup("/Appearance");
     RS_SETTINGS->writeEntry("/hideRelativeZero", RS_SETTINGS->readNumEntry("/hideRelativeZero", 0));
     RS_SETTINGS->endGroup();
+
+    // the primary screen, until the view is shown
+    updateScreenMetrics();
+}
+
+/**
+ * Follows the window of the view to other screens, once the window exists
+ */
+void RS_GraphicView::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    QWindow* handle = window()->windowHandle();
+    if (handle != nullptr && handle != m_screenWindow) {
+        m_screenWindow = handle;
+        connect(handle, &QWindow::screenChanged, this, [this]() {
+            if (updateScreenMetrics())
+                redraw(RS2::RedrawGrid);
+        });
+    }
+    if (updateScreenMetrics())
+        redraw(RS2::RedrawGrid);
+}
+
+/**
+ * @return whether the resolution of the screen changed
+ */
+bool RS_GraphicView::updateScreenMetrics()
+{
+    disconnect(m_screenConnection);
+    const QScreen* s = screen();
+    if (s == nullptr)
+        return false;
+
+    ScreenMetrics metrics;
+    metrics.logicalDpi = s->logicalDotsPerInch();
+    if (s->refreshRate() > 1.)
+        metrics.refreshRate = s->refreshRate();
+    m_screenConnection = connect(s, &QScreen::logicalDotsPerInchChanged, this, [this](qreal dpi) {
+        m_screenMetrics.logicalDpi = dpi;
+        redraw(RS2::RedrawGrid);
+    });
+
+    const bool changed = metrics.logicalDpi != m_screenMetrics.logicalDpi;
+    m_screenMetrics = metrics;
+    return changed;
 }
 
 RS_GraphicView::~RS_GraphicView()
@@ -115,6 +215,25 @@ RS_GraphicView::~RS_GraphicView()
     qDeleteAll(overlayEntities);
 }
 
+void RS_GraphicView::postResult(LC_ResultQueue::Result result)
+{
+    // only the first result of a batch wakes the GUI thread
+    if (m_results->push(std::move(result)))
+        scheduleResults();
+}
+
+void RS_GraphicView::applyResults()
+{
+    if (m_results->apply())
+        redraw(RS2::RedrawAll);
+}
+
+void RS_GraphicView::scheduleResults()
+{
+    // dropped with the view
+    QMetaObject::invokeMethod(this, [this]() { applyResults(); }, Qt::QueuedConnection);
+}
+
 /**
  * Must be called by any derived class in the destructor.
  */
@@ -386,7 +505,7 @@ void RS_GraphicView::zoomIn(double f, const RS_Vector& center) {
 	//adjustOffsetControls();
 	//adjustZoomControls();
 	// updateGrid();
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -400,7 +519,7 @@ void RS_GraphicView::zoomInX(double f) {
 	adjustOffsetControls();
 	adjustZoomControls();
 	// updateGrid();
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -414,7 +533,7 @@ void RS_GraphicView::zoomInY(double f) {
 	adjustOffsetControls();
 	adjustZoomControls();
 	//    updateGrid();
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -447,7 +566,7 @@ void RS_GraphicView::zoomOutX(double f) {
 	adjustOffsetControls();
 	adjustZoomControls();
 	//    updateGrid();
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -466,7 +585,7 @@ void RS_GraphicView::zoomOutY(double f) {
 	adjustOffsetControls();
 	adjustZoomControls();
 	//    updateGrid();
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 /**
@@ -483,7 +602,9 @@ void RS_GraphicView::zoomAuto(bool axis, bool keepAspectRatio) {
 
 
 	if (container) {
-        container->calculateBorders();
+        // the entity borders are kept up to date by the spatial index, only the
+        // borders of the container are updated
+        container->updateBorders();
 
 		double sx, sy;
 		if (axis) {
@@ -797,7 +918,7 @@ void RS_GraphicView::zoomPan(int dx, int dy) {
 	//adjustZoomControls();
 	//    updateGrid();
 
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -824,7 +945,7 @@ void RS_GraphicView::zoomScroll(RS2::Direction direction) {
 	adjustZoomControls();
 	//    updateGrid();
 
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -915,33 +1036,42 @@ void RS_GraphicView::drawLayer1(RS_Painter *painter) {
 
 	// drawing meta grid:
 	if (!isPrintPreview()) {
-
-		//increase grid point size on for DPI>96
-		auto dpiX = int(qApp->screens().front()->logicalDotsPerInch());
-        const bool isHiDpi = dpiX > 96;
-		//        DEBUG_HEADER
-		//        RS_DEBUG->print(RS_Debug::D_ERROR, "dpiX=%d\n",dpiX);
 		const RS_Pen penSaved=painter->getPen();
-        if(isHiDpi) {
-			RS_Pen pen=penSaved;
-			pen.setWidth(RS2::Width01);
-			painter->setPen(pen);
-		}
 
-		//only drawGrid updates the grid layout (updatePointArray())
-		drawMetaGrid(painter);
-		//draw grid after metaGrid to avoid overwriting grid points by metaGrid lines
-		//bug# 3430258
-		drawGrid(painter);
+		drawGrids(painter);
 
         if(isDraftMode())
             drawDraftSign(painter);
 
-        if(isHiDpi)
-            painter->setPen(penSaved);
+        painter->setPen(penSaved);
 	}
 }
 
+/**
+ * Draws the meta grid and the grid.
+ *
+ * @see drawLayer1()
+ */
+void RS_GraphicView::drawGrids(RS_Painter *painter) {
+
+	//increase grid point size on for DPI>96
+	auto dpiX = int(m_screenMetrics.logicalDpi);
+	const bool isHiDpi = dpiX > 96;
+	//        DEBUG_HEADER
+	//        RS_DEBUG->print(RS_Debug::D_ERROR, "dpiX=%d\n",dpiX);
+	if(isHiDpi) {
+		RS_Pen pen=painter->getPen();
+		pen.setWidth(RS2::Width01);
+		painter->setPen(pen);
+	}
+
+	//only drawMetaGrid updates the grid layout (updatePointArray())
+	drawMetaGrid(painter);
+	//draw grid after metaGrid to avoid overwriting grid points by metaGrid lines
+	//bug# 3430258
+	drawGrid(painter);
+}
+
 
 /*	*
  *	Function name:
@@ -958,7 +1088,11 @@ void RS_GraphicView::drawLayer1(RS_Painter *painter) {
 
 void RS_GraphicView::drawLayer2(RS_Painter *painter)
 {
+	// entities created while drawing, e.g. hatch patterns, belong to the drawing of the view
+	RS_Graphic* graphic = getGraphic();
+	LC_EntityPool::Scope arenaScope{graphic != nullptr ? graphic->getEntityArena() : LC_EntityPool::threadArena()};
 	drawEntity(painter, container);	//	Draw all entities.
+	painter->flush();
 
 	//	If not in print preview, draw the absolute zero reference.
 	//	----------------------------------------------------------
@@ -976,35 +1110,47 @@ void RS_GraphicView::drawLayer3(RS_Painter *painter) {
 }
 
 
-/*	*
- *	Function name:
- *
- *	Description:	- Sets the pen of the painter object to the suitable pen
- *						  for the given entity.
- *
- *	Author(s):		..., Claude Sylvain
- *	Created:			?
- *	Last modified:	17 November 2011
- *
- *	Parameters:		RS_Painter *painter:
- *							...
- *
- *						RS_Entity *e:
- *							...
- *
- *	Returns:			void
+/**
+ * @brief getResolvedPen the pen of an entity, with ByLayer/ByBlock attributes resolved
+ * and the width scaled to the screen. Resolved pens are cached for a frame by the
+ * entity pen, layer and parent, which determine the resolved pen, and dropped when the
+ * zoom changes. The attributes are
+ * resolved by the render cache of the document, shared with the other views
  */
+RS_Pen RS_GraphicView::getResolvedPen(const RS_Entity& entity)
+{
+    PenCache& cache = getPenCache();
+    const PenCache::Key key{entity.getLayer(true), entity.getParent(), entity.getPenHandle()};
+    auto it = cache.pens.find(key);
+    if (it != cache.pens.end())
+        return it->second;
 
-void RS_GraphicView::setPenForEntity(RS_Painter *painter,RS_Entity *e, double& patternOffset)
+    RS_Pen pen = computeResolvedPen(entity);
+    cache.pens.emplace(key, pen);
+    return pen;
+}
+
+RS_GraphicView::PenCache& RS_GraphicView::getPenCache()
 {
-	if (draftMode) {
-        painter->setPen(RS_Pen(m_colorData->foreground,
-							   RS2::Width00, RS2::SolidLine));
-	}
+    // overlays and previews are drawn between frames, after zooms too
+    if (m_penCache->factor != factor) {
+        m_penCache->pens.clear();
+        m_penCache->factor = factor;
+    }
+    return *m_penCache;
+}
 
-	// Getting pen from entity (or layer)
-	RS_Pen pen = e->getPen(true);
+RS_Pen RS_GraphicView::computeResolvedPen(const RS_Entity& entity) const
+{
+	// Getting pen from entity (or layer), resolved once for all views of the document
+	const RS_Document* document = (container != nullptr) ? container->getDocument() : nullptr;
+	RS_Pen pen = (document != nullptr) ? document->getRenderCache().getResolvedPen(entity)
+	                                    : entity.getPen(true);
+	return toScreenPen(std::move(pen));
+}
 
+RS_Pen RS_GraphicView::toScreenPen(RS_Pen pen) const
+{
     // Avoid negative widths
     int w = std::max(static_cast<int>(pen.getWidth()), 0);
 
@@ -1029,7 +1175,7 @@ void RS_GraphicView::setPenForEntity(RS_Painter *painter,RS_Entity *e, double& p
 			{
 				if (scaleLineWidth)
 				{
-					wf = graphic->getVariableDouble("$DIMSCALE", 1.0);
+					wf = graphic->getVariableDouble(RS_VariableDict::DimScale, 1.0);
 				}
 				else
 				{
@@ -1060,22 +1206,56 @@ void RS_GraphicView::setPenForEntity(RS_Painter *painter,RS_Entity *e, double& p
              && penColor.colorDistance(m_colorData->background) < RS_Color::MinColorDistance)) {
         pen.setColor(m_colorData->foreground);
     }
+    return pen;
+}
+
+/*	*
+ *	Function name:
+ *
+ *	Description:	- Sets the pen of the painter object to the suitable pen
+ *						  for the given entity.
+ *
+ *	Author(s):		..., Claude Sylvain
+ *	Created:			?
+ *	Last modified:	17 November 2011
+ *
+ *	Parameters:		RS_Painter *painter:
+ *							...
+ *
+ *						RS_Entity *e:
+ *							...
+ *
+ *	Returns:			void
+ */
+
+void RS_GraphicView::setPenForEntity(RS_Painter *painter,RS_Entity *e, double& patternOffset)
+{
+	if (draftMode) {
+        painter->setPen(RS_Pen(m_colorData->foreground,
+							   RS2::Width00, RS2::SolidLine));
+	}
 
+	// Getting pen from entity (or layer)
+	setPen(painter, getResolvedPen(*e), *e, patternOffset);
+}
+
+void RS_GraphicView::setPen(RS_Painter *painter, RS_Pen pen, const RS_Entity& state, double patternOffset)
+{
     pen.setDashOffset(patternOffset);
 
     if (!isPrinting() && !isPrintPreview())
     {
         // this entity is selected:
-        if (e->isSelected()) {
+        if (state.isSelected()) {
             pen.setLineType(RS2::DashLineTiny);
             pen.setWidth(RS2::Width00);
             pen.setColor(m_colorData->selectedColor);
         }
 
-        // this entity is highlighted:
-        if (e->isHighlighted()) {
+        // this entity is highlighted, unless its copy in the overlay is:
+        if (state.isHighlighted() && !isHighlightedInOverlay(state)) {
             // Glowing effects on mouse hovering: use the "selected" color
-            if (e->getParent() == overlayEntities[RS2::OverlayEffects])
+            if (state.getParent() == overlayEntities[RS2::OverlayEffects])
             {
                 // for glowing effects on mouse hovering, draw solid lines
                 pen.setColor(m_colorData->selectedColor);
@@ -1134,31 +1314,54 @@ void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e, double& patte
 		return;
 	}
 
+	// a new frame: layers, pens and zoom may have changed since the last one
+	std::optional<PainterCounter> frameCounter;
+	if (e == container) {
+		m_penCache->pens.clear();
+		frameCounter.emplace(*painter, m_drawStatistics);
+	}
+	++m_drawStatistics.visited;
+
 	// entity is not visible:
 	if (!e->isVisible()) {
+		++m_drawStatistics.culled;
 		return;
 	}
 	if( isPrintPreview() || isPrinting() ) {
 		// do not draw construction layer on print preview or print
 		if( ! e->isPrint()
-				||  e->isConstruction())
-        return;
+				||  e->isConstruction()) {
+			++m_drawStatistics.culled;
+			return;
+		}
 	}
 
     // test if the entity is in the viewport
-    if (!isPrinting() &&
-        e->rtti() != RS2::EntityGraphic &&
-        e->rtti() != RS2::EntityLine &&
-       (toGuiX(e->getMax().x)<0 || toGuiX(e->getMin().x)>getWidth() ||
-        toGuiY(e->getMin().y)<0 || toGuiY(e->getMax().y)>getHeight())) {
-        return;
+    if (!isPrinting() && e->rtti() != RS2::EntityGraphic) {
+        bool outside = false;
+        if (e->rtti() == RS2::EntityLine && e->isConstruction()) {
+            // construction lines are infinite, clipped by their lines
+            const auto* line = static_cast<RS_Line*>(e);
+            const LC_Rect viewRect{toGraph(0, 0), toGraph(getWidth(), getHeight())};
+            outside = !viewRect.crossesLine(line->getStartpoint(), line->getEndpoint());
+        } else {
+            outside = toGuiX(e->getMax().x)<0 || toGuiX(e->getMin().x)>getWidth() ||
+                    toGuiY(e->getMin().y)<0 || toGuiY(e->getMax().y)>getHeight();
+        }
+        if (outside) {
+            ++m_drawStatistics.culled;
+            return;
+        }
     }
+    ++m_drawStatistics.drawn;
 
 	// set pen (color):
     setPenForEntity(painter, e, patternOffset);
 
 	//RS_DEBUG->print("draw plain");
-	if (isDraftMode()) {
+	if (drawEntityLod(painter, e)) {
+		// too small for details
+	} else if (isDraftMode()) {
         switch(e->rtti()){
         case RS2::EntityMText:
         case RS2::EntityText:
@@ -1208,6 +1411,75 @@ void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e, double& patte
 }
 
 
+void RS_GraphicView::drawInstanced(RS_Painter *painter, RS_Entity* e, const RS_Insert& insert,
+                                   const RS_Layer* layer, double& patternOffset)
+{
+	++m_drawStatistics.visited;
+	if ((isPrintPreview() || isPrinting())
+			&& layer != nullptr && (!layer->isPrint() || layer->isConstruction())) {
+		// do not draw construction layer on print preview or print
+		++m_drawStatistics.culled;
+		return;
+	}
+	++m_drawStatistics.drawn;
+
+	// selected and not selected entities are drawn in separate passes
+	if (insert.isSelected() != painter->shouldDrawSelected())
+		return;
+
+	// as for the instance, a child of the insert on the layer
+	PenCache& cache = getPenCache();
+	const PenCache::Key key{layer, &insert, e->getPenHandle()};
+	auto it = cache.pens.find(key);
+	if (it == cache.pens.end())
+		it = cache.pens.emplace(key, toScreenPen(insert.getInstancePen(*e, layer))).first;
+	setPen(painter, it->second, insert, patternOffset);
+
+	e->draw(painter, this, patternOffset);
+}
+
+
+bool RS_GraphicView::drawEntityLod(RS_Painter *painter, RS_Entity* e)
+{
+    // print previews are simplified in their drafts only
+    if (lodThreshold <= 0. || isPrinting() || (isPrintPreview() && !isDraftMode())
+            || e->isDocument())
+        return false;
+
+    switch (e->rtti()) {
+    case RS2::EntityPoint:
+        // drawn by the point style
+        return false;
+    case RS2::EntityLine:
+        // construction lines are infinite
+        if (e->isConstruction())
+            return false;
+        break;
+    default:
+        break;
+    }
+
+    const RS_Vector minV = e->getMin();
+    const RS_Vector maxV = e->getMax();
+    if (!minV.valid || !maxV.valid)
+        return false;
+    const double extent = std::max(toGuiDX(maxV.x - minV.x), toGuiDY(maxV.y - minV.y));
+    // a line costs no more than its bounding box
+    const double threshold = (e->rtti() == RS2::EntityLine) ? std::min(lodThreshold, 1.) : lodThreshold;
+    if (extent >= threshold)
+        return false;
+
+    // selected and not selected entities are drawn in separate passes
+    if (e->isSelected() != painter->shouldDrawSelected())
+        return true;
+
+    if (extent < 1.)
+        painter->drawGridPoint(toGui((minV + maxV) * 0.5));
+    else
+        painter->drawRect(toGui(minV), toGui(maxV));
+    return true;
+}
+
 /**
  * Draws an entity.
  * The painter must be initialized and all the attributes (pen) must be set.
@@ -1240,11 +1512,100 @@ void RS_GraphicView::drawEntityHighlighted(RS_Entity* e, bool highlighted)
 {
     if (e==nullptr)
         return;
-    if (e->isHighlighted() != highlighted)
-    {
-        e->setHighlighted(highlighted);
-        drawEntity(e);
+    const bool hasCopy = highlightedCopies.count(e) == 1;
+    if (e->isHighlighted() == highlighted && hasCopy == highlighted)
+        return;
+    e->setHighlighted(highlighted);
+
+    // the rendered drawing keeps the entity as it is, the highlighted copy is drawn over it
+    RS_EntityContainer* overlay = getOverlayContainer(RS2::OverlayHighlights);
+    auto it = highlightedCopies.find(e);
+    if (it != highlightedCopies.end()) {
+        overlay->removeEntity(it->second);
+        highlightedCopies.erase(it);
+    }
+    if (highlighted) {
+        RS_Entity* copy = e->clone();
+        copy->reparent(overlay);
+        copy->setHighlighted(true);
+        overlay->addEntity(copy);
+        highlightedCopies.emplace(e, copy);
+    }
+    redraw(RS2::RedrawOverlay);
+}
+
+bool RS_GraphicView::isHighlightedInOverlay(const RS_Entity& e) const
+{
+    if (highlightedCopies.empty())
+        return false;
+    // sub-entities are highlighted with their container
+    for (const RS_Entity* entity = &e; entity != nullptr; entity = entity->getParent()) {
+        if (highlightedCopies.count(entity) == 1)
+            return true;
+    }
+    return false;
+}
+
+void RS_GraphicView::redrawArea(const LC_Rect& area)
+{
+    invalidateArea(area);
+    redraw(RS2::RedrawCached);
+}
+
+void RS_GraphicView::invalidateAreas(const std::vector<LC_Rect>& areas)
+{
+    for (const LC_Rect& area: areas)
+        invalidateArea(area);
+}
+
+void RS_GraphicView::redrawLayers(const std::vector<RS_Layer*>& layers)
+{
+    RS_Graphic* graphic = container != nullptr ? container->getGraphic() : nullptr;
+    // views of blocks show the block entities only
+    if (graphic == nullptr || graphic != container || layers.empty()) {
+        redraw(RS2::RedrawDrawing);
+        return;
+    }
+
+    const std::vector<RS_Entity*> dependents = graphic->getLayersDependents(layers);
+    std::vector<LC_Rect> areas;
+    areas.reserve(dependents.size());
+    for (const RS_Entity* e: dependents)
+        areas.push_back(getRenderedArea(*e));
+    // the borders of containers grow, if their entities are thawed
+    graphic->updateLayersVisibility(layers);
+    for (const RS_Entity* e: dependents) {
+        if (e->isContainer())
+            areas.push_back(getRenderedArea(*e));
+    }
+    if (areas.empty())
+        return;
+    invalidateAreas(areas);
+    redraw(RS2::RedrawCached);
+}
+
+LC_Rect RS_GraphicView::getRenderedArea(const RS_Entity& e) const
+{
+    const RS_Vector minV = e.getMin();
+    const RS_Vector maxV = e.getMax();
+    // construction lines are infinite
+    if (!(minV.valid && maxV.valid) || minV.x > maxV.x || minV.y > maxV.y
+            || (e.rtti() == RS2::EntityLine && e.isConstruction()))
+        return {{-RS_MAXDOUBLE, -RS_MAXDOUBLE}, {RS_MAXDOUBLE, RS_MAXDOUBLE}};
+
+    // margin for handles and antialiasing
+    double margin = toGraphDX(8);
+    const RS_Graphic* graphic = container != nullptr ? container->getGraphic() : nullptr;
+    const int width = static_cast<int>(e.getPen(true).getWidth());
+    if (graphic != nullptr && width > 0) {
+        // same width scaling as setPenForEntity()
+        double wf = 1.0;
+        if (isPrintPreview() && graphic->getPaperScale() > RS_TOLERANCE)
+            wf = scaleLineWidth ? graphic->getVariableDouble(RS_VariableDict::DimScale, 1.0) : 1.0 / graphic->getPaperScale();
+        margin += 0.5 * wf * RS_Units::convert(width / 100.0, RS2::Millimeter, graphic->getUnit());
     }
+
+    return LC_Rect{minV, maxV}.increaseBy(margin);
 }
 
 /**
@@ -1554,9 +1915,12 @@ void RS_GraphicView::drawOverlay(RS_Painter *painter)
 {
     double patternOffset(0.);
 
-    foreach (auto ec, overlayEntities)
+    for (auto it = overlayEntities.cbegin(); it != overlayEntities.cend(); ++it)
     {
-        foreach (auto e, ec->getEntityList())
+        // the snapper is painted on its own by drawSnapperOverlay()
+        if (it.key() == RS2::Snapper)
+            continue;
+        foreach (auto e, it.value()->getEntityList())
         {
             setPenForEntity(painter, e, patternOffset);
             e->draw(painter, this, patternOffset);
@@ -1564,6 +1928,20 @@ void RS_GraphicView::drawOverlay(RS_Painter *painter)
     }
 }
 
+void RS_GraphicView::drawSnapperOverlay(RS_Painter *painter)
+{
+    RS_EntityContainer* snapper = overlayEntities.value(RS2::Snapper);
+    if (isPrintPreview() || snapper == nullptr)
+        return;
+
+    double patternOffset(0.);
+    foreach (auto e, snapper->getEntityList())
+    {
+        setPenForEntity(painter, e, patternOffset);
+        e->draw(painter, this, patternOffset);
+    }
+}
+
 RS2::SnapRestriction RS_GraphicView::getSnapRestriction() const
 {
 	return defaultSnapRes;
@@ -1602,6 +1980,28 @@ RS_Vector RS_GraphicView::toGui(RS_Vector v) const{
 	return RS_Vector(toGuiX(v.x), toGuiY(v.y));
 }
 
+void RS_GraphicView::toGui(const RS_Vector* points, std::size_t count, QPointF* guiPoints) const{
+	// the mapping of toGuiX() and toGuiY(), as one multiply-add per coordinate
+	// in a loop without calls, which the compiler vectorizes
+	const double scaleX = factor.x;
+	const double scaleY = -factor.y;
+	const double shiftX = offsetX;
+	const double shiftY = getHeight() - offsetY;
+	for (std::size_t i = 0; i < count; ++i)
+		guiPoints[i] = QPointF{points[i].x * scaleX + shiftX, points[i].y * scaleY + shiftY};
+}
+
+void RS_GraphicView::toGui(std::vector<RS_Vector>& points) const{
+	const double scaleX = factor.x;
+	const double scaleY = -factor.y;
+	const double shiftX = offsetX;
+	const double shiftY = getHeight() - offsetY;
+	for (RS_Vector& point: points) {
+		point.x = point.x * scaleX + shiftX;
+		point.y = point.y * scaleY + shiftY;
+	}
+}
+
 /**
  * Translates a real coordinate in X to a screen coordinate X.
  * @param visible Pointer to a boolean which will contain true
@@ -1734,7 +2134,7 @@ RS_EntityContainer* RS_GraphicView::getOverlayContainer(RS2::OverlayGraphics pos
     }
 
     overlayEntities[position]=new RS_EntityContainer(nullptr);
-    if (position == RS2::OverlayEffects) {
+    if (position == RS2::OverlayEffects || position == RS2::OverlayHighlights) {
         overlayEntities[position]->setOwner(true);
     }
 
@@ -1781,6 +2181,10 @@ void RS_GraphicView::setGridColor(const RS_Color& c) {
     m_colorData->gridColor = c;
 }
 
+RS_Color RS_GraphicView::getGridColor() const {
+    return m_colorData->gridColor;
+}
+
 /**
      * Sets the meta grid color.
      */
@@ -1788,6 +2192,10 @@ void RS_GraphicView::setMetaGridColor(const RS_Color& c) {
     m_colorData->metaGridColor = c;
 }
 
+RS_Color RS_GraphicView::getMetaGridColor() const {
+    return m_colorData->metaGridColor;
+}
+
 /**
      * Sets the selection color.
      */
@@ -1869,6 +2277,30 @@ void RS_GraphicView::freezeZoom(bool freeze) {
 bool RS_GraphicView::isZoomFrozen() const{
 	return zoomFrozen;
 }
+
+void RS_GraphicView::setRedrawDeferred(bool defer) {
+	if (defer) {
+		++redrawDeferred;
+		return;
+	}
+	if (redrawDeferred == 0 || --redrawDeferred > 0)
+		return;
+	const RS2::RedrawMethod method = deferredRedraw;
+	deferredRedraw = RS2::RedrawNone;
+	if (method != RS2::RedrawNone)
+		redraw(method);
+}
+
+bool RS_GraphicView::isRedrawDeferred() const{
+	return redrawDeferred > 0;
+}
+
+bool RS_GraphicView::deferRedraw(RS2::RedrawMethod method) {
+	if (redrawDeferred == 0)
+		return false;
+	deferredRedraw = static_cast<RS2::RedrawMethod>(deferredRedraw | method);
+	return true;
+}
 void RS_GraphicView::setOffsetX(int ox) {
 	offsetX = ox;
 }
@@ -1930,6 +2362,75 @@ void RS_GraphicView::setPanning(bool state) {
     panning = state;
 }
 
+void RS_GraphicView::setLodThreshold(double pixels) {
+    lodThreshold = std::max(pixels, 0.);
+}
+
+double RS_GraphicView::getLodThreshold() const {
+    return lodThreshold;
+}
+
+bool RS_GraphicView::isConcurrentDrawing() const {
+    return concurrentDrawing;
+}
+
+void RS_GraphicView::setConcurrentDrawing(bool state) {
+    concurrentDrawing = state;
+}
+
+void RS_GraphicView::prepareConcurrentDrawing(RS_Entity& entity)
+{
+    entity.prepareDraw();
+    // instanced inserts prepare their entities while drawing
+    if (entity.isContainer() && !(entity.rtti() == RS2::EntityInsert
+                                  && static_cast<RS_Insert&>(entity).isInstanced())) {
+        for (RS_Entity* e: static_cast<RS_EntityContainer&>(entity))
+            prepareConcurrentDrawing(*e);
+    }
+}
+
+namespace {
+// hatches prepared with the entity, as by prepareConcurrentDrawing()
+void collectHatches(RS_Entity& entity, std::vector<RS_Hatch*>& hatches)
+{
+    if (entity.rtti() == RS2::EntityHatch) {
+        hatches.push_back(static_cast<RS_Hatch*>(&entity));
+        return;
+    }
+    if (entity.isContainer() && !(entity.rtti() == RS2::EntityInsert
+                                  && static_cast<RS_Insert&>(entity).isInstanced())) {
+        for (RS_Entity* e: static_cast<RS_EntityContainer&>(entity))
+            collectHatches(*e, hatches);
+    }
+}
+}
+
+void RS_GraphicView::prepareConcurrentDrawing(const std::vector<RS_Entity*>& entities)
+{
+    std::vector<RS_Hatch*> hatches;
+    for (RS_Entity* e: entities)
+        collectHatches(*e, hatches);
+    RS_Hatch::ensurePatterns(hatches);
+    for (RS_Entity* e: entities)
+        prepareConcurrentDrawing(*e);
+}
+
+void RS_GraphicView::copyRenderSettings(const RS_GraphicView& view)
+{
+    container = view.container;
+    *m_colorData = *view.m_colorData;
+    factor = view.factor;
+    drawingMode = view.drawingMode;
+    deleteMode = view.deleteMode;
+    draftMode = view.draftMode;
+    printPreview = view.printPreview;
+    printing = view.printing;
+    panning = view.panning;
+    scaleLineWidth = view.scaleLineWidth;
+    lodThreshold = view.lodThreshold;
+    m_screenMetrics = view.m_screenMetrics;
+}
+
 
 
 /* Sets the color for the relative-zero marker. */
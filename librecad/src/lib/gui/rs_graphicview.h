@@ -28,19 +28,24 @@
 #ifndef RS_GRAPHICVIEW_H
 #define RS_GRAPHICVIEW_H
 
+#include <map>
 #include <memory>
 #include <tuple>
 #include <vector>
 
 #include <QMap>
+#include <QPointer>
 #include <QWidget>
 
 #include "lc_rect.h"
+#include "lc_resultqueue.h"
 #include "rs.h"
 
 class QDateTime;
 class QMouseEvent;
 class QKeyEvent;
+class QShowEvent;
+class QWindow;
 
 class RS_ActionInterface;
 class RS_Entity;
@@ -50,7 +55,10 @@ class RS_Color;
 class RS_CommandEvent;
 class RS_Graphic;
 class RS_Grid;
+class RS_Insert;
+class RS_Layer;
 class RS_Painter;
+class RS_Pen;
 
 struct RS_LineTypePattern;
 struct RS_SnapMode;
@@ -119,6 +127,46 @@ public:
 	/** This virtual method must be overwritten to redraw
 	  the widget. */
 	virtual void redraw(RS2::RedrawMethod method=RS2::RedrawAll) = 0;
+    /**
+     * @brief postResult hands a result of background work over to the GUI
+     * thread, may be called by any thread. The results are applied in batches,
+     * with one redraw for the batch.
+     */
+    void postResult(LC_ResultQueue::Result result);
+    /**
+     * @brief deferRedraw called by redraw() implementations
+     * @return true, if redraws are deferred, the method is kept for later
+     */
+    bool deferRedraw(RS2::RedrawMethod method);
+	/**
+	 * @brief invalidateArea mark the rendered drawing within the area as outdated,
+	 * for views caching the rendered drawing. No redraw is triggered.
+	 * @param area - the area in graph coordinates
+	 */
+	virtual void invalidateArea(const LC_Rect& /*area*/) {}
+	/**
+	 * @brief invalidateAreas mark the rendered drawing within the areas as outdated,
+	 * like invalidateArea() for each of them
+	 * @param areas - the areas in graph coordinates
+	 */
+	virtual void invalidateAreas(const std::vector<LC_Rect>& areas);
+	/**
+	 * @brief redrawArea redraw the drawing within the area only, after entities within
+	 * the area are changed, e.g. the union of the old and new borders of changed entities
+	 * @param area - the area in graph coordinates
+	 */
+	void redrawArea(const LC_Rect& area);
+	/**
+	 * @brief redrawLayers redraw the entities shown or hidden by freezing or thawing of
+	 * the layers only, found by the entities by layer. The borders changed by the layers
+	 * are updated before the redraw
+	 */
+	void redrawLayers(const std::vector<RS_Layer*>& layers);
+	/**
+	 * @brief getRenderedArea the area covered by the rendered entity, including its pen
+	 * width and handles. The whole graph plane, if the entity has no valid borders
+	 */
+	LC_Rect getRenderedArea(const RS_Entity& e) const;
 	/** This virtual method must be overwritten and is then
 	  called whenever the view changed */
     virtual void adjustOffsetControls() = 0;
@@ -146,11 +194,13 @@ public:
 		 * Sets the grid color.
 		 */
     void setGridColor(const RS_Color& c);
+    RS_Color getGridColor() const;
 
 	/**
 		 * Sets the meta grid color.
 		 */
     void setMetaGridColor(const RS_Color& c);
+    RS_Color getMetaGridColor() const;
 
 	/**
 		 * Sets the selection color.
@@ -223,6 +273,13 @@ public:
 
 	void freezeZoom(bool freeze);
 	bool isZoomFrozen() const;
+    /**
+     * @brief setRedrawDeferred defers the redraws, while commands are played back
+     * as a macro. Deferrals nest, the redraws requested meanwhile are merged into
+     * one, issued by the end of the last deferral
+     */
+    void setRedrawDeferred(bool defer);
+    bool isRedrawDeferred() const;
 
 	void setDefaultAction(RS_ActionInterface* action);
 	RS_ActionInterface*  getDefaultAction();
@@ -269,7 +326,29 @@ public:
 	virtual void drawEntityPlain(RS_Painter *painter, RS_Entity* e);
 	virtual void drawEntityPlain(RS_Painter *painter, RS_Entity* e, double& patternOffset);
     virtual void setPenForEntity(RS_Painter *painter, RS_Entity* e, double& patternOffset);
+    /**
+     * @brief getResolvedPen the pen of an entity with ByLayer/ByBlock attributes resolved
+     * and the width scaled to the screen, cached for the current frame
+     */
+    RS_Pen getResolvedPen(const RS_Entity& entity);
+    /**
+     * @brief drawInstanced draws an entity of a block shared by inserts, through the
+     * screen transform the insert set on the painter. The entity is drawn by its pen
+     * resolved for the insert on the layer of its instance, selected and highlighted
+     * as the insert. It isn't culled, inserts cull their instances
+     */
+    void drawInstanced(RS_Painter *painter, RS_Entity* e, const RS_Insert& insert,
+                       const RS_Layer* layer, double& patternOffset);
+    /**
+     * @brief drawEntityHighlighted highlights an entity by a copy in the overlay, the
+     * rendered drawing isn't redrawn
+     */
     virtual void drawEntityHighlighted(RS_Entity* e, bool highlighted = true);
+    /**
+     * @brief drawEntityLod draw an entity simplified by the level of detail threshold
+     * @return true, if the entity is too small for details and is drawn simplified
+     */
+    bool drawEntityLod(RS_Painter *painter, RS_Entity* e);
     virtual RS_Vector getMousePosition() const = 0;
 
 	virtual const RS_LineTypePattern* getPattern(RS2::LineType t);
@@ -277,9 +356,15 @@ public:
 	virtual void drawAbsoluteZero(RS_Painter *painter);
 	virtual void drawRelativeZero(RS_Painter *painter);
 	virtual void drawPaper(RS_Painter *painter);
+	virtual void drawGrids(RS_Painter *painter);
 	virtual void drawGrid(RS_Painter *painter);
 	virtual void drawMetaGrid(RS_Painter *painter);
 	virtual void drawOverlay(RS_Painter *painter);
+    /**
+     * @brief drawSnapperOverlay draws the crosshair and the snap indicator, which are
+     * left out by drawOverlay() and painted over the composed layers
+     */
+    virtual void drawSnapperOverlay(RS_Painter *painter);
     /**
      * @brief drawDraftSign     Display "Draft" at corners if the draft mode is turned on
      * @param painter           Painter assumed to be non-nullptr
@@ -300,6 +385,13 @@ public:
 	RS2::CrosshairType getCrosshairType() const;
 
 	RS_Vector toGui(RS_Vector v) const;
+	/**
+	 * Translates count points to screen coordinates, the view parameters are
+	 * read once for all points, for drawing vertex arrays.
+	 */
+	void toGui(const RS_Vector* points, std::size_t count, QPointF* guiPoints) const;
+	//! translates the points to screen coordinates, in place
+	void toGui(std::vector<RS_Vector>& points) const;
 	double toGuiX(double x) const;
 	double toGuiY(double y) const;
 	double toGuiDX(double d) const;
@@ -376,6 +468,54 @@ public:
     bool isPanning() const;
     void setPanning(bool state);
 
+    /**
+     * @brief setLodThreshold set the level of detail threshold. Entities with screen
+     * extents smaller than the threshold are drawn as bounding boxes, entities smaller
+     * than one pixel as points. Independent of the draft mode, not used for printing,
+     * nor for print previews out of the draft mode
+     * @param pixels - the threshold in pixels, 0 to always draw all details
+     */
+    void setLodThreshold(double pixels);
+    double getLodThreshold() const;
+
+    /**
+     * @brief isConcurrentDrawing whether entities are drawn by worker threads in this view.
+     * Entities are prepared by RS_Entity::prepareDraw() on the GUI thread beforehand, and
+     * RS_Entity::draw() must not modify entities or any shared state
+     */
+    bool isConcurrentDrawing() const;
+    void setConcurrentDrawing(bool state);
+    /**
+     * @brief prepareConcurrentDrawing prepare an entity and its sub-entities on the GUI
+     * thread, before the entity is drawn by worker threads
+     */
+    static void prepareConcurrentDrawing(RS_Entity& entity);
+    //! prepare the entities, deferred hatch patterns are created concurrently first
+    static void prepareConcurrentDrawing(const std::vector<RS_Entity*>& entities);
+
+    /**
+     * @brief copyRenderSettings copy the settings affecting the rendered drawing from
+     * another view: the container, zoom factors, colors and drawing modes. Offsets are
+     * not copied
+     */
+    void copyRenderSettings(const RS_GraphicView& view);
+
+    /**
+     * @brief The ScreenMetrics struct metrics of the screen showing the view
+     */
+    struct ScreenMetrics {
+        double logicalDpi = 96.;
+        //! frames per second
+        double refreshRate = 60.;
+    };
+    /**
+     * @return metrics of the screen showing the view, updated when the view moves
+     * to another screen or the resolution of the screen changes
+     */
+    const ScreenMetrics& getScreenMetrics() const {
+        return m_screenMetrics;
+    }
+
     void setLineWidthScaling(bool state){
         scaleLineWidth = state;
     }
@@ -388,6 +528,31 @@ public:
 
     void setTypeToSelect(RS2::EntityType mType);
 
+    /**
+     * @brief The DrawStatistics struct counters of drawEntity(), to find out what
+     * makes drawing slow. Counted since the last resetDrawStatistics()
+     */
+    struct DrawStatistics {
+        //! entities passed to drawEntity()
+        unsigned long visited = 0;
+        //! entities skipped, as hidden or outside of the view
+        unsigned long culled = 0;
+        //! entities drawn
+        unsigned long drawn = 0;
+        //! changes of the painter pen
+        unsigned long penChanges = 0;
+        //! calls of painter drawing methods
+        unsigned long painterCalls = 0;
+
+        DrawStatistics& operator += (const DrawStatistics& other);
+    };
+    const DrawStatistics& getDrawStatistics() const {
+        return m_drawStatistics;
+    }
+    void resetDrawStatistics() {
+        m_drawStatistics = {};
+    }
+
 protected:
 
     RS_EntityContainer* container = nullptr; // Holds a pointer to all the enties
@@ -396,6 +561,10 @@ protected:
     /** colors for different usages*/
     struct ColorData;
     std::unique_ptr<ColorData> m_colorData;
+    /** resolved pens for the current frame */
+    struct PenCache;
+    std::unique_ptr<PenCache> m_penCache;
+    DrawStatistics m_drawStatistics;
 	/** Grid */
 	std::unique_ptr<RS_Grid> grid;
 	/**
@@ -419,10 +588,38 @@ protected:
 
     LC_Rect view_rect;
 
+    void showEvent(QShowEvent* event) override;
+
+    //! applies the posted results and redraws once, by the GUI thread
+    void applyResults();
+    /**
+     * Called by the thread posting the first result of a batch, to apply the
+     * batch on the GUI thread. Applies it with the next event loop iteration.
+     */
+    virtual void scheduleResults();
+
 private:
+    RS_Pen computeResolvedPen(const RS_Entity& entity) const;
+    // the pen scaled to the screen and adjusted to the background
+    RS_Pen toScreenPen(RS_Pen pen) const;
+    // the pen cache of the frame, cleared when the zoom changed
+    PenCache& getPenCache();
+    // sets the pen for drawing the entity, selected and highlighted as the state entity
+    void setPen(RS_Painter *painter, RS_Pen pen, const RS_Entity& state, double patternOffset);
+
+    // the screen of the view, cached instead of queried per frame
+    bool updateScreenMetrics();
+    ScreenMetrics m_screenMetrics;
+    QPointer<QWindow> m_screenWindow;
+    QMetaObject::Connection m_screenConnection;
+
+    // results of background work, posted by any thread
+    std::unique_ptr<LC_ResultQueue> m_results;
 
 	bool zoomFrozen=false;
 	bool draftMode=false;
+	int redrawDeferred=0;
+	RS2::RedrawMethod deferredRedraw=RS2::RedrawNone;
 
     RS_Vector factor{1.,1.};
 	int offsetX=0;
@@ -448,11 +645,19 @@ private:
 
 	// Map that will be used for overlaying additional items on top of the main CAD drawing
 	QMap<int, RS_EntityContainer *> overlayEntities;
+	// the copies in the overlay of entities highlighted by drawEntityHighlighted(),
+	// the entities are only looked up
+	std::map<const RS_Entity*, RS_Entity*> highlightedCopies;
+	bool isHighlightedInOverlay(const RS_Entity& e) const;
 	/** if true, graphicView is under cleanup */
 	bool m_bIsCleanUp=false;
 
     bool panning = false;
 
+    bool concurrentDrawing = false;
+
+    double lodThreshold = 0.;
+
     bool scaleLineWidth = false;
 
     RS2::EntityType typeToSelect = RS2::EntityType::EntityUnknown;
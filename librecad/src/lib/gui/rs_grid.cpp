@@ -50,7 +50,20 @@ const double minimumGridWidth=1.0e-8;
 RS_Grid::RS_Grid(RS_GraphicView* graphicView)
     :graphicView(graphicView)
     ,baseGrid(false)
-{}
+{
+	loadSettings();
+}
+
+void RS_Grid::loadSettings() {
+	RS_SETTINGS->beginGroup("/Appearance");
+	settings.scaleGrid = (bool)RS_SETTINGS->readNumEntry("/ScaleGrid", 1);
+	settings.isometric = (bool)RS_SETTINGS->readNumEntry("/IsometricGrid", 0);
+	settings.crosshairType=static_cast<RS2::CrosshairType>(RS_SETTINGS->readNumEntry("/CrosshairType",0));
+	settings.userGrid.x = RS_SETTINGS->readEntry("/GridSpacingX",QString("-1")).toDouble();
+	settings.userGrid.y = RS_SETTINGS->readEntry("/GridSpacingY",QString("-1")).toDouble();
+	settings.minGridSpacing = RS_SETTINGS->readNumEntry("/MinGridSpacing", 10);
+	RS_SETTINGS->endGroup();
+}
 
 /**
  * find the closest grid point
@@ -73,39 +86,30 @@ RS_Vector RS_Grid::snapGrid(const RS_Vector& coord) const {
 }
 
 /**
- * Updates the grid point array.
+ * Updates the grid and meta grid widths.
  */
-void RS_Grid::updatePointArray() {
-	if (!graphicView->isGridOn()) return;
-
+void RS_Grid::updateGridWidth() {
 	RS_Graphic* graphic = graphicView->getGraphic();
 
 	// auto scale grid?
-	RS_SETTINGS->beginGroup("/Appearance");
-	bool scaleGrid = (bool)RS_SETTINGS->readNumEntry("/ScaleGrid", 1);
+	bool scaleGrid = settings.scaleGrid;
 	// get grid setting
 	RS_Vector userGrid;
 	if (graphic) {
 		//$ISOMETRICGRID == $SNAPSTYLE
-		isometric = static_cast<bool>(graphic->getVariableInt("$SNAPSTYLE",0));
+		isometric = static_cast<bool>(graphic->getVariableInt(RS_VariableDict::SnapStyle, 0));
 		crosshairType=graphic->getCrosshairType();
-		userGrid = graphic->getVariableVector("$GRIDUNIT",
+		userGrid = graphic->getVariableVector(RS_VariableDict::GridUnit,
 											 RS_Vector(-1.0, -1.0));
 	}else {
-		isometric = (bool)RS_SETTINGS->readNumEntry("/IsometricGrid", 0);
-		crosshairType=static_cast<RS2::CrosshairType>(RS_SETTINGS->readNumEntry("/CrosshairType",0));
-		userGrid.x = RS_SETTINGS->readEntry("/GridSpacingX",QString("-1")).toDouble();
-		userGrid.y = RS_SETTINGS->readEntry("/GridSpacingY",QString("-1")).toDouble();
+		isometric = settings.isometric;
+		crosshairType = settings.crosshairType;
+		userGrid = settings.userGrid;
 	}
-	int minGridSpacing = RS_SETTINGS->readNumEntry("/MinGridSpacing", 10);
-	RS_SETTINGS->endGroup();
+	int minGridSpacing = settings.minGridSpacing;
 
 	// std::cout<<"Grid userGrid="<<userGrid<<std::endl;
 
-	pt.clear();
-	metaX.clear();
-	metaY.clear();
-
 	// RS_DEBUG->print("RS_Grid::update: 001");
 
 	// find out unit:
@@ -116,9 +120,6 @@ void RS_Grid::updatePointArray() {
 		format = graphic->getLinearFormat();
 	}
 
-	RS_Vector gridWidth;
-	// RS_Vector metaGridWidth;
-
 	// RS_DEBUG->print("RS_Grid::update: 002");
 
 	// init grid spacing:
@@ -141,6 +142,19 @@ void RS_Grid::updatePointArray() {
 	metaSpacing = metaGridWidth.x;
 	//std::cout<<"Grid spacing="<<spacing<<std::endl;
 	//std::cout<<"Grid metaSpacing="<<metaSpacing<<std::endl;
+}
+
+/**
+ * Updates the grid point array.
+ */
+void RS_Grid::updatePointArray() {
+	if (!graphicView->isGridOn()) return;
+
+	updateGridWidth();
+
+	pt.clear();
+	metaX.clear();
+	metaY.clear();
 
 	if (gridWidth.x>minimumGridWidth && gridWidth.y>minimumGridWidth &&
 			graphicView->toGuiDX(gridWidth.x)>2 &&
@@ -519,6 +533,11 @@ RS_Vector RS_Grid::getMetaGridWidth() const {
 	return metaGridWidth;
 }
 
+RS_Vector const& RS_Grid::getGridWidth() const
+{
+	return gridWidth;
+}
+
 RS_Vector const& RS_Grid::getCellVector() const
 {
 	return cellV;
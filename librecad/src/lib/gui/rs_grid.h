@@ -53,6 +53,15 @@ class RS_Grid
 public:
 	RS_Grid(RS_GraphicView* graphicView);
 
+	/**
+	 * Reads the grid settings, they're kept until read again.
+	 */
+	void loadSettings();
+	/**
+	 * Updates the grid and meta grid widths for the current zoom,
+	 * without the grid points.
+	 */
+	void updateGridWidth();
 	void updatePointArray();
 
 	/**
@@ -92,6 +101,7 @@ public:
 	bool isIsometric() const;
 	void setIsometric(bool b);
 	RS_Vector getMetaGridWidth() const;
+	RS_Vector const& getGridWidth() const;
 	RS_Vector const& getCellVector() const;
 
 private:
@@ -111,6 +121,18 @@ private:
     //! Graphic view this grid is connected to.
     RS_GraphicView *graphicView = nullptr;
 
+    //! Settings, see loadSettings()
+    struct Settings {
+        bool scaleGrid = true;
+        int minGridSpacing = 10;
+        //! \{ \brief used without a graphic
+        bool isometric = false;
+        RS2::CrosshairType crosshairType = RS2::LeftCrosshair;
+        RS_Vector userGrid{-1., -1.};
+        //! \}
+    };
+    Settings settings;
+
     //! Current grid spacing
     double spacing = 0.;
     //! Current meta grid spacing
@@ -120,6 +142,7 @@ private:
     std::vector<RS_Vector> pt;
     RS_Vector baseGrid; // the left-bottom grid point
     RS_Vector cellV;    // (dx,dy)
+    RS_Vector gridWidth;
     RS_Vector metaGridWidth;
     //! Meta grid positions in X
     std::vector<double> metaX;
@@ -37,6 +37,7 @@ class RS_Pen;
 class RS_Polyline;
 class RS_Spline;
 class QPainterPath;
+class QTransform;
 class QRect;
 class QRectF;
 class QPolygon;
@@ -88,6 +89,20 @@ public:
         return drawingMode;
     }
 
+    /**
+     * Submits primitives batched by the painter implementation to the device.
+     * Called implicitly on pen or state changes, and before the painter ends.
+     */
+    virtual void flush() {}
+
+    /**
+     * @return whether connected dashed strokes are joined into chains, dashed by the
+     * device as one path. Entities then leave dash offsets at the pen's default.
+     */
+    virtual bool isDashChaining() const {
+        return false;
+    }
+
     virtual void moveTo(int x, int y) = 0;
     virtual void lineTo(int x, int y) = 0;
 
@@ -160,9 +175,26 @@ public:
 
     virtual void setClipRect(int x, int y, int w, int h) = 0;
     virtual void resetClipping() = 0;
+
+    /**
+     * Transforms the screen coordinates of everything drawn, until the transform
+     * is reset. Used to preview entities transformed without transforming them, and
+     * to draw the block entities of inserts. Pen widths stay in screen pixels.
+     */
+    virtual void setScreenTransform(const QTransform& transform) = 0;
+    virtual void resetScreenTransform() = 0;
 	int toScreenX(double x) const;
 	int toScreenY(double y) const;
 
+    //! @return the number of drawing calls made by this painter, for diagnostics
+    unsigned long getDrawCalls() const {
+        return drawCalls;
+    }
+    //! @return the number of times the pen was changed to a different one
+    unsigned long getPenChanges() const {
+        return penChanges;
+    }
+
 protected:
     /**
      * Current drawing mode.
@@ -176,6 +208,9 @@ protected:
     // When set to true, only selected entities should be drawn
     bool drawSelectedEntities = false;
 
+    // counted by implementations, see getDrawCalls() and getPenChanges()
+    unsigned long drawCalls = 0;
+    unsigned long penChanges = 0;
 
 };
 
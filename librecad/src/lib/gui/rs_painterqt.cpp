@@ -24,9 +24,19 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QPixmapCache>
+#include <QThread>
 
 #include "dxf_format.h"
 #include "lc_splinepoints.h"
@@ -59,6 +69,24 @@ QVector<qreal> rsToQDashPattern(RS2::LineType t, double screenWidth, double dpmm
     return dashPattern;
 }
 
+// Dash patterns by line type, pen width and device resolution. The zoom changes the
+// patterns only through the pen width, so they are kept across frames; per thread, as
+// views are drawn by concurrent threads. Returned vectors share the cached data.
+QVector<qreal> getDashPattern(RS2::LineType t, double screenWidth, double dpmm)
+{
+    using Key = std::tuple<RS2::LineType, long, long>;
+    thread_local std::map<Key, QVector<qreal>> patterns;
+    const Key key{t, std::lround(std::max(screenWidth, 1.)), std::lround(dpmm * 1000.)};
+    auto it = patterns.find(key);
+    if (it == patterns.end()) {
+        // pen widths scaled by the zoom add patterns while zooming
+        if (patterns.size() >= 1024)
+            patterns.clear();
+        it = patterns.emplace(key, rsToQDashPattern(t, std::lround(std::max(screenWidth, 1.)), dpmm)).first;
+    }
+    return it->second;
+}
+
 /**
  * Wrapper for Qt
  * convert RS2::LineType to Qt::PenStyle
@@ -100,46 +128,38 @@ Qt::PenStyle rsToQtLineType(RS2::LineType t) {
     }
 }
 
-// For a given elliptic arc, create a QPainterPath to allow clipping the complete QR
-// to the desirable
-QPainterPath getEllipticArcClipping(const RS_Vector& origin,
-                                double radius1, double radius2,
-                                double angle, double angle1, double angle2)
+// the pen to stroke with, including line patterns
+QPen createStrokePen(RS_PainterQt& painter)
 {
-
-    // Elliptic arc: QPainter doesn't support drawing an elliptic arc natively.
-    // Create a QPainterPath to clip the complete ellipse to draw an arc.
-    // Get a point on ellipse by the elliptic angle
-    auto getP = [&origin, &radius1, &radius2, &angle](double a) {
-        auto point = origin + RS_Vector{a}.scale({radius1, -radius2});
-        point.rotate(origin, -angle);
-        return point;
-    };
-    RS_Vector p1 = getP(angle1);
-    RS_Vector p2 = getP(angle2);
-    // Find a direction vector along the two end points of the arc
-    auto dp = p2 - p1;
-    dp /= dp.magnitude();
-    // Find a point on the arc
-    RS_Vector p3 = getP((angle1+angle2)*0.5) - p1;
-    // Find a direction normal to the line p1-p2
-    p3 -= dp * p3.dotP(dp);
-    // the QPainterPath should
-    double ellipseSize = 2.0 * std::max(radius1, radius2);
-    p3 *= ellipseSize/p3.magnitude();
-
-    // makes the path larger
-    dp *= ellipseSize;
-    p1 -= dp;
-    p2 += dp;
-
-    QPainterPath path;
-    path.moveTo(p1.x, p1.y);
-    path.lineTo(p1.x+p3.x, p1.y+p3.y);
-    path.lineTo(p2.x+p3.x, p2.y+p3.y);
-    path.lineTo(p2.x, p2.y);
-    path.lineTo(p1.x, p1.y);
-    return path;
+    RS_Pen& rsPen = painter.getRsPen();
+    Qt::PenStyle styleToUse = rsPen.getLineType() == RS2::SolidLine ? Qt::SolidLine : Qt::CustomDashLine;
+    QPen qPen = painter.pen();
+    qPen.setStyle(styleToUse);
+    qPen.setColor(rsPen.getColor());
+    if (rsPen.getLineType() == RS2::NoPen)
+    {
+        qPen.setStyle(Qt::NoPen);
+    } else if (styleToUse == Qt::CustomDashLine)
+    {
+        QVector<qreal> dashPattern = getDashPattern(rsPen.getLineType(),
+                                                    qPen.widthF(),
+                                                    painter.getDpmm());
+        if (!dashPattern.isEmpty()) {
+            qPen.setDashPattern(std::move(dashPattern));
+
+            double dpmm = std::max(painter.getDpmm(), 1e-6);
+            double k = dpmm / std::max(rsPen.getScreenWidth(), 1.);
+            qPen.setDashOffset(rsPen.dashOffset() * k);
+            // Cap style at line end points
+            // Join style
+            qPen.setJoinStyle(Qt::RoundJoin);
+        } else {
+            qPen.setStyle(Qt::SolidLine);
+        }
+        qPen.setJoinStyle(Qt::RoundJoin);
+        qPen.setCapStyle(Qt::RoundCap);
+    }
+    return qPen;
 }
 
 // RAII style saving and restore QPainter states
@@ -148,37 +168,10 @@ public:
     PainterGuard(RS_PainterQt& painter):
         m_painter{painter}
     {
+        painter.flush();
         painter.save();
         // set pen
-        RS_Pen& rsPen = painter.getRsPen();
-        Qt::PenStyle styleToUse = rsPen.getLineType() == RS2::SolidLine ? Qt::SolidLine : Qt::CustomDashLine;
-        QPen qPen = painter.pen();
-        qPen.setStyle(styleToUse);
-        qPen.setColor(rsPen.getColor());
-        if (rsPen.getLineType() == RS2::NoPen)
-        {
-            qPen.setStyle(Qt::NoPen);
-        } else if (styleToUse == Qt::CustomDashLine)
-        {
-            QVector<qreal> dashPattern = rsToQDashPattern(rsPen.getLineType(),
-                                                          qPen.widthF(),
-                                                          painter.getDpmm());
-            if (!dashPattern.isEmpty()) {
-                qPen.setDashPattern(std::move(dashPattern));
-
-                double dpmm = std::max(painter.getDpmm(), 1e-6);
-                double k = dpmm / std::max(rsPen.getScreenWidth(), 1.);
-                qPen.setDashOffset(rsPen.dashOffset() * k);
-                // Cap style at line end points
-                // Join style
-                qPen.setJoinStyle(Qt::RoundJoin);
-            } else {
-                qPen.setStyle(Qt::SolidLine);
-            }
-            qPen.setJoinStyle(Qt::RoundJoin);
-            qPen.setCapStyle(Qt::RoundCap);
-        }
-        painter.QPainter::setPen(qPen);
+        painter.QPainter::setPen(painter.getStrokePen());
     }
 
     ~PainterGuard()
@@ -261,6 +254,24 @@ QPainterPath createPolyline(const RS_Polyline& polyline, const RS_GraphicView& v
         return {point.x(), point.y()};
     };
     LC_Rect viewRect{mapingRs(view.getViewRect().minP()), mapingRs(view.getViewRect().maxP())};
+    if (polyline.isFlat()) {
+        // from the vertex arrays, without creating the segment entities,
+        // the vertices are translated to screen coordinates at once
+        const unsigned vertexCount = polyline.countVertices();
+        if (vertexCount == 0)
+            return path;
+        QPolygonF vertices(int(vertexCount));
+        view.toGui(polyline.getVertices().data(), vertexCount, vertices.data());
+        path.moveTo(vertices.front());
+        for (unsigned i = 0; i < polyline.count(); ++i) {
+            const RS_PolylineSegment segment = polyline.getSegment(i);
+            if (segment.isArc())
+                drawArc(path, RS_Arc{nullptr, segment.getArcData()}, viewRect, toGui);
+            else
+                path.lineTo(vertices.at(int(i + 1 < vertexCount ? i + 1 : 0)));
+        }
+        return path;
+    }
     path.moveTo(toGui(static_cast<RS_AtomicEntity*>(*polyline.begin())->getStartpoint()));
 
     for(RS_Entity* entity: polyline)
@@ -268,6 +279,181 @@ QPainterPath createPolyline(const RS_Polyline& polyline, const RS_GraphicView& v
 
     return path;
 }
+
+// maximum distance of tessellated arcs to the arc, in pixels
+constexpr double arcTolerance = 0.25;
+constexpr double arcTolerancePreview = 1.;
+// arcs are clipped to the device with this margin, in pixels, so clipped ends are not seen
+constexpr double arcClipMargin = 16.;
+// maximum number of chords of a full circle
+constexpr int maxArcDivisions = 1 << 16;
+
+using UnitCircle = std::vector<std::pair<double, double>>;
+
+// Cosine and sine of the angles 2 pi i/n, i = 0...n. As the circle divisions are powers
+// of two, the few tables are kept across frames; per thread, as views are drawn by
+// concurrent threads.
+const UnitCircle& getUnitCircle(int n)
+{
+    thread_local std::map<int, UnitCircle> tables;
+    UnitCircle& table = tables[n];
+    if (table.empty()) {
+        table.reserve(n + 1);
+        for (int i = 0; i <= n; ++i) {
+            const double a = 2. * M_PI * i / n;
+            table.emplace_back(std::cos(a), std::sin(a));
+        }
+    }
+    return table;
+}
+
+// circle divisions, with chords not further than the tolerance from the circle
+int getArcDivisions(double radius, double tolerance)
+{
+    // the chord height of a step is r (1 - cos(step/2))
+    const double step = radius > tolerance ? 2. * std::acos(1. - tolerance / radius) : M_PI;
+    int n = 8;
+    while (n < maxArcDivisions && 2. * M_PI / n > step)
+        n *= 2;
+    return n;
+}
+
+// Angular ranges of the counterclockwise arc from a1 to a2, a1 < a2 <= a1 + 2 pi, in the
+// rectangle. Screen points of the arc are center + radius (cos(a), -sin(a)).
+std::vector<std::pair<double, double>> getVisibleArcRanges(const QPointF& center, double radius,
+                                                           double a1, double a2, const QRectF& rect)
+{
+    std::vector<double> angles{a1, a2};
+    auto addAngle = [&angles, a1, a2](double a) {
+        a = a1 + RS_Math::correctAngle(a - a1);
+        if (a > a1 && a < a2)
+            angles.push_back(a);
+    };
+    // crossings of the lines of the rectangle sides
+    for (double x: {rect.left(), rect.right()}) {
+        const double c = (x - center.x()) / radius;
+        if (std::abs(c) < 1.) {
+            addAngle(std::acos(c));
+            addAngle(-std::acos(c));
+        }
+    }
+    for (double y: {rect.top(), rect.bottom()}) {
+        const double s = (center.y() - y) / radius;
+        if (std::abs(s) < 1.) {
+            addAngle(std::asin(s));
+            addAngle(M_PI - std::asin(s));
+        }
+    }
+    std::sort(angles.begin(), angles.end());
+
+    std::vector<std::pair<double, double>> ranges;
+    for (size_t i = 1; i < angles.size(); ++i) {
+        const double a = 0.5 * (angles[i - 1] + angles[i]);
+        if (!rect.contains(center.x() + radius * std::cos(a), center.y() - radius * std::sin(a)))
+            continue;
+        if (!ranges.empty() && ranges.back().second == angles[i - 1])
+            ranges.back().second = angles[i];
+        else
+            ranges.emplace_back(angles[i - 1], angles[i]);
+    }
+    return ranges;
+}
+
+// Polylines of the counterclockwise elliptic arc from the elliptic angles a1 to a2, in the
+// rectangle. Screen points are center + radius1 cos(t) u - radius2 sin(t) v, with the
+// major axis direction u and the minor one v rotated by the angle.
+std::vector<QPolygonF> flattenEllipticArc(const QPointF& center, double radius1, double radius2,
+                                          double angle, double a1, double a2,
+                                          double tolerance, const QRectF& rect)
+{
+    const int n = getArcDivisions(std::max(radius1, radius2), tolerance);
+    const UnitCircle& unitCircle = getUnitCircle(n);
+    const double step = 2. * M_PI / n;
+    const double ca = std::cos(angle);
+    const double sa = std::sin(angle);
+    auto getPoint = [&](double c, double s) {
+        const double x = radius1 * c;
+        const double y = radius2 * s;
+        return QPointF(center.x() + x * ca - y * sa, center.y() - x * sa - y * ca);
+    };
+
+    // chords are kept while one of their ends is in the rectangle
+    std::vector<QPolygonF> polylines;
+    QPolygonF polyline;
+    QPointF previous = getPoint(std::cos(a1), std::sin(a1));
+    bool previousIn = rect.contains(previous);
+    const double c0 = std::cos(a1);
+    const double s0 = std::sin(a1);
+    const int steps = std::max(1, int(std::ceil((a2 - a1) / step - 1.0e-10)));
+    for (int i = 1; i <= steps; ++i) {
+        QPointF point;
+        if (i == steps) {
+            point = getPoint(std::cos(a2), std::sin(a2));
+        } else {
+            const auto& [c, s] = unitCircle[i];
+            point = getPoint(c0 * c - s0 * s, s0 * c + c0 * s);
+        }
+        const bool pointIn = rect.contains(point);
+        if (previousIn || pointIn) {
+            if (polyline.isEmpty())
+                polyline << previous;
+            polyline << point;
+        } else if (!polyline.isEmpty()) {
+            polylines.push_back(std::move(polyline));
+            polyline = {};
+        }
+        previous = point;
+        previousIn = pointIn;
+    }
+    if (!polyline.isEmpty())
+        polylines.push_back(std::move(polyline));
+    return polylines;
+}
+
+// size of the cache of scaled images, in KiB, about the tiles of a few screens
+constexpr int scaledImageCacheLimit = 64 * 1024;
+
+/**
+ * Draws the image scaled by the factors, with its top left corner at the position, from
+ * a pixmap scaled once for the zoom. The pixmap is reused while the view is panned.
+ * Pixmaps are cached on the GUI thread, for unrotated images drawn on raster devices.
+ * @return false, if the image isn't drawn
+ */
+bool drawScaledImage(QPainter& painter, const QImage& img, const QPointF& pos, double fx, double fy)
+{
+    const int type = painter.device()->devType();
+    if ((type != QInternal::Image && type != QInternal::Pixmap)
+            || painter.worldTransform().type() > QTransform::TxTranslate
+            || QThread::currentThread() != QCoreApplication::instance()->thread())
+        return false;
+    static const bool cacheLimited = [] {
+        QPixmapCache::setCacheLimit(std::max(QPixmapCache::cacheLimit(), scaledImageCacheLimit));
+        return true;
+    }();
+    (void) cacheLimited;
+
+    // device pixel edges, so tiles drawn side by side don't overlap or leave gaps
+    const double ratio = painter.device()->devicePixelRatioF();
+    const QPointF offset{painter.worldTransform().dx(), painter.worldTransform().dy()};
+    const QPointF topLeft = (pos + offset) * ratio;
+    const QPointF bottomRight = (pos + offset + QPointF{img.width() * fx, img.height() * fy}) * ratio;
+    const QPoint corner{int(std::lround(topLeft.x())), int(std::lround(topLeft.y()))};
+    const QSize size{int(std::lround(bottomRight.x())) - corner.x(), int(std::lround(bottomRight.y())) - corner.y()};
+    if (size.isEmpty() || size.width() > 2 * img.width() * ratio + 2 || size.height() > 2 * img.height() * ratio + 2)
+        return false;
+
+    const QString key = QStringLiteral("lc_image_%1_%2x%3").arg(img.cacheKey())
+            .arg(size.width()).arg(size.height());
+    QPixmap pixmap;
+    if (!QPixmapCache::find(key, &pixmap)) {
+        // smooth, as the transformed images
+        pixmap = QPixmap::fromImage(img.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+        QPixmapCache::insert(key, pixmap);
+    }
+    pixmap.setDevicePixelRatio(ratio);
+    painter.drawPixmap(QPointF{corner} / ratio - offset, pixmap);
+    return true;
+}
 }
 
 /**
@@ -275,7 +461,135 @@ QPainterPath createPolyline(const RS_Polyline& polyline, const RS_GraphicView& v
  */
 // RVT_PORT changed from RS_PainterQt::RS_PainterQt( const QPaintDevice* pd)
 RS_PainterQt::RS_PainterQt( QPaintDevice* pd)
-        : QPainter{pd} {}
+        : QPainter{pd}
+{
+    // batching saves QPainter state changes per line, which are costly on raster
+    // devices. Vector devices, such as printers, get long paths with few pen changes
+    const int type = (pd != nullptr) ? pd->devType() : 0;
+    m_batchLines = type == QInternal::Image || type == QInternal::Pixmap;
+    m_batchPaths = type == QInternal::Printer || type == QInternal::Picture;
+}
+
+RS_PainterQt::~RS_PainterQt()
+{
+    if (isActive())
+        flush();
+}
+
+bool RS_PainterQt::flushAndEnd()
+{
+    flush();
+    // the painter may begin on another device
+    m_dpmm = 0.;
+    m_strokePen.valid = false;
+    return QPainter::end();
+}
+
+void RS_PainterQt::flush()
+{
+    if (!m_lineBatch.isEmpty()) {
+        save();
+        QPainter::setPen(m_batchPen);
+        QPainter::drawLines(m_lineBatch);
+        restore();
+        m_lineBatch.clear();
+    }
+    if (!m_dashChain.isEmpty()) {
+        save();
+        QPainter::setPen(m_batchPen);
+        QPainter::setBrush(Qt::NoBrush);
+        QPainter::drawPath(m_dashChain);
+        restore();
+        m_dashChain.clear();
+    }
+    if (!m_pathBatches.empty()) {
+        save();
+        QPainter::setBrush(Qt::NoBrush);
+        for (const auto& [pen, path]: m_pathBatches) {
+            QPainter::setPen(pen);
+            QPainter::drawPath(path);
+        }
+        restore();
+        m_pathBatches.clear();
+        m_lastPathBatch = 0;
+    }
+}
+
+void RS_PainterQt::setPathBatching(bool state)
+{
+    if (!state)
+        flush();
+    m_batchPaths = state;
+}
+
+/**
+ * Batched strokes of connected entities continue their subpaths, which the devices
+ * dash as one line.
+ */
+bool RS_PainterQt::isDashChaining() const
+{
+    return m_batchLines || m_batchPaths;
+}
+
+/**
+ * @return the chain of dashed strokes by the current pen on raster devices, or
+ * nullptr for solid pens and unbatched painting
+ */
+QPainterPath* RS_PainterQt::dashChain()
+{
+    if (!m_batchLines || !isActive())
+        return nullptr;
+    QPen pen = getStrokePen();
+    if (pen.style() != Qt::CustomDashLine)
+        return nullptr;
+    if ((!m_lineBatch.isEmpty() || !m_dashChain.isEmpty()) && pen != m_batchPen)
+        flush();
+    m_batchPen = std::move(pen);
+    return &m_dashChain;
+}
+
+/**
+ * @return the batched path of strokes by the current pen
+ */
+QPainterPath& RS_PainterQt::strokeBatch()
+{
+    QPen pen = getStrokePen();
+    if (m_lastPathBatch < m_pathBatches.size() && m_pathBatches[m_lastPathBatch].first == pen)
+        return m_pathBatches[m_lastPathBatch].second;
+
+    auto it = std::find_if(m_pathBatches.begin(), m_pathBatches.end(), [&pen](const auto& batch) {
+        return batch.first == pen;
+    });
+    if (it == m_pathBatches.end()) {
+        m_pathBatches.emplace_back(std::move(pen), QPainterPath{});
+        it = std::prev(m_pathBatches.end());
+    }
+    m_lastPathBatch = it - m_pathBatches.begin();
+    return it->second;
+}
+
+void RS_PainterQt::addStroke(const QPainterPath& path)
+{
+    strokeBatch().addPath(path);
+}
+
+void RS_PainterQt::setScreenTransform(const QTransform& transform)
+{
+    flush();
+    save();
+    setWorldTransform(transform, true);
+    ++m_screenTransforms;
+    QPen cosmetic = pen();
+    cosmetic.setCosmetic(true);
+    QPainter::setPen(cosmetic);
+}
+
+void RS_PainterQt::resetScreenTransform()
+{
+    flush();
+    restore();
+    --m_screenTransforms;
+}
 
 void RS_PainterQt::moveTo(int x, int y) {
         //RVT_PORT changed from QPainter::moveTo(x,y);
@@ -285,6 +599,8 @@ void RS_PainterQt::moveTo(int x, int y) {
 
 
 void RS_PainterQt::lineTo(int x, int y) {
+    ++drawCalls;
+    flush();
         // RVT_PORT changed from QPainter::lineTo(x, y);
         QPainterPath path;
         path.moveTo(rememberX,rememberY);
@@ -298,6 +614,8 @@ void RS_PainterQt::lineTo(int x, int y) {
  * Draws a grid point at (x1, y1).
  */
 void RS_PainterQt::drawGridPoint(const RS_Vector& p) {
+    ++drawCalls;
+    flush();
     QPainter::drawPoint(toScreenX(p.x), toScreenY(p.y));
 }
 
@@ -307,6 +625,8 @@ void RS_PainterQt::drawGridPoint(const RS_Vector& p) {
  * Draws a point at (x1, y1).
  */
 void RS_PainterQt::drawPoint(const RS_Vector& p, int pdmode, int pdsize) {
+    ++drawCalls;
+    flush();
 	int screenX = toScreenX(p.x);
 	int screenY = toScreenY(p.y);
 	int halfPDSize = pdsize/2;
@@ -395,6 +715,36 @@ void RS_PainterQt::drawPoint(const RS_Vector& p, int pdmode, int pdsize) {
  */
 void RS_PainterQt::drawLine(const RS_Vector& p1, const RS_Vector& p2)
 {
+    ++drawCalls;
+    if (m_batchPaths && isActive()) {
+        QPainterPath& path = strokeBatch();
+        const QPointF start(toScreenX(p1.x), toScreenY(p1.y));
+        // connected lines continue the subpath
+        if (path.elementCount() == 0 || path.currentPosition() != start)
+            path.moveTo(start);
+        path.lineTo(toScreenX(p2.x), toScreenY(p2.y));
+        return;
+    }
+
+    if (QPainterPath* chain = dashChain()) {
+        const QPointF start(toScreenX(p1.x), toScreenY(p1.y));
+        // connected lines continue the chain, and its dashes
+        if (chain->isEmpty() || chain->currentPosition() != start)
+            chain->moveTo(start);
+        chain->lineTo(toScreenX(p2.x), toScreenY(p2.y));
+        return;
+    }
+
+    if (m_batchLines && isActive()) {
+        QPen pen = getStrokePen();
+        if ((!m_lineBatch.isEmpty() || !m_dashChain.isEmpty()) && pen != m_batchPen)
+            flush();
+        m_batchPen = std::move(pen);
+        m_lineBatch.append(QLineF(toScreenX(p1.x), toScreenY(p1.y),
+                                  toScreenX(p2.x), toScreenY(p2.y)));
+        return;
+    }
+
     PainterGuard painterGuard{*this};
     QPainter::drawLine(toScreenX(p1.x), toScreenY(p1.y),
                        toScreenX(p2.x), toScreenY(p2.y));
@@ -439,82 +789,49 @@ void RS_PainterQt::drawLine(const RS_Vector& p1, const RS_Vector& p2)
  */
 void RS_PainterQt::drawArc(const RS_Vector& cp, double radius,
                            double a1, double a2,
-                           const RS_Vector& p1, const RS_Vector& p2,
+                           [[maybe_unused]] const RS_Vector& p1,
+                           [[maybe_unused]] const RS_Vector& p2,
                            bool reversed) {
-    /*
-    QPainter::drawArc(cx-radius, cy-radius,
-                      2*radius, 2*radius,
-                      a1*16, (a2-a1)*16);
-    */
+    ++drawCalls;
+    flush();
 
     if(radius<=0.5) {
         drawGridPoint(cp);
-    } else {
-        int   cix;            // Next point on circle
-        int   ciy;            //
-        double aStep;         // Angle Step (rad)
-        double a;             // Current Angle (rad)
-        double linStep;       // linear step (pixels)
-
-        if (drawingMode==RS2::ModePreview) {
-            linStep = 20.0;
-        } else {
-            linStep = 6.0;
-        }
-
-        if (std::abs(linStep/radius)<=1.0) {
-            aStep=std::asin(linStep/radius);
-        } else {
-            aStep=1.0;
-        }
-
-        if (aStep<0.05) {
-            aStep = 0.05;
-        }
+        return;
+    }
 
-        if(!reversed) {
-            // Arc Counterclockwise:
-            if(a1>a2-1.0e-10) {
-                a2+=2*M_PI;
-            }
-            //moveTo(toScreenX(p1.x), toScreenY(p1.y));
-            QPolygon pa;
-            int i=0;
-            pa.resize(i+1);
-            pa.setPoint(i++, toScreenX(p1.x), toScreenY(p1.y));
-            for(a=a1+aStep; a<=a2; a+=aStep) {
-                cix = toScreenX(cp.x+std::cos(a)*radius);
-                ciy = toScreenY(cp.y-std::sin(a)*radius);
-                //lineTo(cix, ciy);
-                pa.resize(i+1);
-                pa.setPoint(i++, cix, ciy);
-            }
-            //lineTo(toScreenX(p2.x), toScreenY(p2.y));
-            pa.resize(i+1);
-            pa.setPoint(i++, toScreenX(p2.x), toScreenY(p2.y));
-            QPainter::drawPolyline(pa);
-        } else {
-            // Arc Clockwise:
-            if(a1<a2+1.0e-10) {
-                a2-=2*M_PI;
-            }
-            QPolygon pa;
-            int i=0;
-            pa.resize(i+1);
-            pa.setPoint(i++, toScreenX(p1.x), toScreenY(p1.y));
-            //moveTo(toScreenX(p1.x), toScreenY(p1.y));
-            for(a=a1-aStep; a>=a2; a-=aStep) {
-                cix = toScreenX(cp.x+std::cos(a)*radius);
-                ciy = toScreenY(cp.y-std::sin(a)*radius);
-                //lineTo(cix, ciy);
-                pa.resize(i+1);
-                pa.setPoint(i++, cix, ciy);
-            }
-            //lineTo(toScreenX(p2.x), toScreenY(p2.y));
-            pa.resize(i+1);
-            pa.setPoint(i++, toScreenX(p2.x), toScreenY(p2.y));
-            QPainter::drawPolyline(pa);
+    // counterclockwise from a1 to a2, with a1 in the range of 0 to 2 pi
+    if (reversed)
+        std::swap(a1, a2);
+    a1 = RS_Math::correctAngle(a1);
+    double length = RS_Math::correctAngle(a2 - a1);
+    if (length < 1.0e-10)
+        length = 2. * M_PI;
+    a2 = a1 + length;
+
+    // only the part on the device is tessellated
+    const QPointF center{offset.x + cp.x, offset.y + cp.y};
+    const QRectF device = worldTransform().inverted().mapRect(QRectF(0., 0., getWidth(), getHeight()))
+                              .adjusted(-arcClipMargin, -arcClipMargin, arcClipMargin, arcClipMargin);
+    const double tolerance = drawingMode == RS2::ModePreview ? arcTolerancePreview : arcTolerance;
+    const int n = getArcDivisions(radius, tolerance);
+    const UnitCircle& unitCircle = getUnitCircle(n);
+    const double step = 2. * M_PI / n;
+
+    for (const auto& [start, end]: getVisibleArcRanges(center, radius, a1, a2, device)) {
+        // points at start + i step, by rotating the table points
+        const double c0 = std::cos(start);
+        const double s0 = std::sin(start);
+        const int steps = int(std::ceil((end - start) / step - 1.0e-10));
+        QPolygonF pa;
+        pa.reserve(steps + 1);
+        for (int i = 0; i < steps; ++i) {
+            const auto& [c, s] = unitCircle[i];
+            pa << QPointF(center.x() + radius * (c0 * c - s0 * s),
+                          center.y() - radius * (s0 * c + c0 * s));
         }
+        pa << QPointF(center.x() + radius * std::cos(end), center.y() - radius * std::sin(end));
+        QPainter::drawPolyline(pa);
     }
 }
 
@@ -536,15 +853,13 @@ void RS_PainterQt::drawArc( const RS_Vector& cp,
                             double a2,
                             [[maybe_unused]] bool reversed)
 {
+    ++drawCalls;
     if (radius <= 0.5)
     {
         drawGridPoint(cp);
     }
     else
     {
-        // RAII style: setting and restoring QPen dashPattern
-        PainterGuard painterGuard{*this};
-
         if (reversed)
             std::swap(a1, a2);
 
@@ -553,6 +868,31 @@ void RS_PainterQt::drawArc( const RS_Vector& cp,
         // shift a2 - a1 to the range of 0 to 2 pi
         a2 = a1+ M_PI + std::remainder(a2 - a1 - M_PI, 2. * M_PI);
 
+        if (m_batchPaths && isActive()) {
+            const QRectF rect(toScreenX(cp.x - radius), toScreenY(cp.y - radius),
+                              2.0 * radius, 2.0 * radius);
+            QPainterPath path;
+            path.arcMoveTo(rect, RS_Math::rad2deg(a1));
+            path.arcTo(rect, RS_Math::rad2deg(a1), RS_Math::rad2deg(a2 - a1));
+            addStroke(path);
+            return;
+        }
+
+        if (QPainterPath* chain = dashChain()) {
+            const QRectF rect(toScreenX(cp.x - radius), toScreenY(cp.y - radius),
+                              2.0 * radius, 2.0 * radius);
+            // arcTo() connects the current position, within a pixel of connected arcs
+            const QPointF start = rect.center() + QPointF(std::cos(a1), -std::sin(a1)) * radius;
+            const QPointF gap = start - chain->currentPosition();
+            if (chain->isEmpty() || std::abs(gap.x()) + std::abs(gap.y()) > 1.)
+                chain->moveTo(start);
+            chain->arcTo(rect, RS_Math::rad2deg(a1), RS_Math::rad2deg(a2 - a1));
+            return;
+        }
+
+        // RAII style: setting and restoring QPen dashPattern
+        PainterGuard painterGuard{*this};
+
         QPainter::drawArc( toScreenX(cp.x - radius), 
                            toScreenY(cp.y - radius), 
                            2.0 * radius, 
@@ -576,6 +916,7 @@ void RS_PainterQt::drawArc( const RS_Vector& cp,
 void RS_PainterQt::drawArcMac(const RS_Vector& cp, double radius,
                            double a1, double a2,
                            bool reversed) {
+    flush();
         RS_DEBUG->print("RS_PainterQt::drawArcMac");
     if(radius<=0.5) {
         drawGridPoint(cp);
@@ -662,6 +1003,14 @@ void RS_PainterQt::drawArcMac(const RS_Vector& cp, double radius,
  */
 void RS_PainterQt::drawCircle(const RS_Vector& cp, double radius)
 {
+    ++drawCalls;
+    if (m_batchPaths && isActive()) {
+        QPainterPath path;
+        path.addEllipse(QPointF(cp.x, cp.y), radius, radius);
+        addStroke(path);
+        return;
+    }
+
     // RAII style: setting and restoring QPen dashPattern
     PainterGuard painterGuard{*this};
     QPainter::drawEllipse(QPointF(cp.x, cp.y), radius, radius);
@@ -677,6 +1026,7 @@ void RS_PainterQt::drawEllipse(const RS_Vector& cp,
                                double angle,
                                double a1, double a2,
                                bool reversed) {
+    ++drawCalls;
 
     if (reversed)
         std::swap(a1, a2);
@@ -686,18 +1036,40 @@ void RS_PainterQt::drawEllipse(const RS_Vector& cp,
     a2 = a1+ M_PI + std::remainder(a2 - a1 - M_PI, 2. * M_PI);
 
     QPointF center = {double(toScreenX(cp.x)), double(toScreenY(cp.y))};
+    const bool isArc = std::abs(std::remainder(a2 - a1, 2. * M_PI)) > RS_TOLERANCE_ANGLE;
+
+    if (m_batchPaths && isActive()) {
+        // arc angles of QPainterPath are elliptic angles, as a1 and a2
+        const QRectF rect(center.x() - radius1, center.y() - radius2, 2. * radius1, 2. * radius2);
+        QPainterPath path;
+        if (isArc) {
+            path.arcMoveTo(rect, RS_Math::rad2deg(a1));
+            path.arcTo(rect, RS_Math::rad2deg(a1), RS_Math::rad2deg(a2 - a1));
+        } else {
+            path.addEllipse(rect);
+        }
+        QTransform t;
+        t.translate(center.x(), center.y());
+        t.rotate(-angle*180./M_PI);
+        t.translate(-center.x(), -center.y());
+        addStroke(t.map(path));
+        return;
+    }
 
     // RAII style QPainter state saving/restoring
     PainterGuard painterGuard{*this};
 
-    if (std::abs(std::remainder(a2 - a1, 2. * M_PI)) > RS_TOLERANCE_ANGLE)
+    if (isArc)
     {
         // Elliptic arc: QPainter doesn't support drawing an elliptic arc natively.
-        // Create a QPainterPath to clip the complete ellipse to draw an arc.
-        QPainterPath path = getEllipticArcClipping({double(toScreenX(cp.x)), double(toScreenY(cp.y))}
-                                               , radius1, radius2, angle, a1, a2);
-        setClipping(true);
-        setClipPath(path);
+        // Flatten the part on the device, instead of clipping the complete ellipse
+        const QRectF device = worldTransform().inverted().mapRect(QRectF(0., 0., getWidth(), getHeight()))
+                                  .adjusted(-arcClipMargin, -arcClipMargin, arcClipMargin, arcClipMargin);
+        const double tolerance = drawingMode == RS2::ModePreview ? arcTolerancePreview : arcTolerance;
+        for (const QPolygonF& polyline: flattenEllipticArc(center, radius1, radius2, angle, a1, a2,
+                                                         tolerance, device))
+            QPainter::drawPolyline(polyline);
+        return;
     }
 
     // The transform to align the
@@ -705,12 +1077,18 @@ void RS_PainterQt::drawEllipse(const RS_Vector& cp,
     t1.translate(center.x(), center.y());
     t1.rotate(-angle*180./M_PI);
     t1.translate(-center.x(), -center.y());
-    setTransform(t1, false);
+    // combined with a screen transform
+    setTransform(t1, true);
     QPainter::drawEllipse(center, radius1, radius2);
 }
 
 void RS_PainterQt::drawSplinePoints(const LC_SplinePointsData& splineData)
 {
+    ++drawCalls;
+    if (m_batchPaths && isActive()) {
+        addStroke(createSplinePoints(splineData));
+        return;
+    }
     // RAII style QPainter state saving/restoring
     PainterGuard painterGuard{*this};
     drawPath(createSplinePoints(splineData));
@@ -718,6 +1096,11 @@ void RS_PainterQt::drawSplinePoints(const LC_SplinePointsData& splineData)
 
 void RS_PainterQt::drawPolyline(const RS_Polyline& polyline, const RS_GraphicView& view)
 {
+    ++drawCalls;
+    if (m_batchPaths && isActive()) {
+        addStroke(createPolyline(polyline, view));
+        return;
+    }
     // RAII style QPainter state saving/restoring
     PainterGuard painterGuard{*this};
     drawPath(createPolyline(polyline, view));
@@ -725,6 +1108,11 @@ void RS_PainterQt::drawPolyline(const RS_Polyline& polyline, const RS_GraphicVie
 
 void RS_PainterQt::drawSpline(const RS_Spline& spline, const RS_GraphicView& view)
 {
+    ++drawCalls;
+    if (m_batchPaths && isActive()) {
+        addStroke(createSpline(spline, view));
+        return;
+    }
     // RAII style QPainter state saving/restoring
     PainterGuard painterGuard{*this};
     drawPath(createSpline(spline, view));
@@ -733,6 +1121,16 @@ void RS_PainterQt::drawSpline(const RS_Spline& spline, const RS_GraphicView& vie
 
 void RS_PainterQt::drawImg(QImage& img, const RS_Vector& pos,
                            const RS_Vector& uVector, const RS_Vector& vVector, const RS_Vector& factor) {
+    ++drawCalls;
+    flush();
+
+    // images which are not rotated nor mirrored are blitted from pixmaps scaled for the zoom
+    const bool axisAligned = uVector.x > 0. && vVector.y > 0.
+            && std::abs(uVector.y) < RS_TOLERANCE * uVector.x && std::abs(vVector.x) < RS_TOLERANCE * vVector.y;
+    if (axisAligned && drawScaledImage(*this, img, {pos.x, pos.y - img.height() * factor.y},
+                                       factor.x, factor.y))
+        return;
+
     save();
 
     // Render smooth only at close zooms
@@ -756,7 +1154,7 @@ void RS_PainterQt::drawImg(QImage& img, const RS_Vector& pos,
     }
 
     wm->scale(factor.x, factor.y);
-    setWorldTransform(*wm);
+    setWorldTransform(*wm, true);
 
     drawImage(0,-img.height(), img);
 
@@ -767,6 +1165,8 @@ void RS_PainterQt::drawImg(QImage& img, const RS_Vector& pos,
 void RS_PainterQt::drawTextH(int x1, int y1,
                              int x2, int y2,
                              const QString& text) {
+    ++drawCalls;
+    flush();
     QPainter::drawText(x1, y1, x2, y2,
              Qt::AlignRight|Qt::AlignVCenter,
              text);
@@ -777,6 +1177,8 @@ void RS_PainterQt::drawTextH(int x1, int y1,
 void RS_PainterQt::drawTextV(int x1, int y1,
                              int x2, int y2,
                              const QString& text) {
+    ++drawCalls;
+    flush();
     save();
     QTransform wm = worldTransform();
     wm.rotate(-90.0);
@@ -791,6 +1193,8 @@ void RS_PainterQt::drawTextV(int x1, int y1,
 
 void RS_PainterQt::fillRect(int x1, int y1, int w, int h,
                             const RS_Color& col) {
+    ++drawCalls;
+    flush();
     QPainter::fillRect(x1, y1, w, h, col);
 }
 
@@ -798,6 +1202,8 @@ void RS_PainterQt::fillRect(int x1, int y1, int w, int h,
 void RS_PainterQt::fillTriangle(const RS_Vector& p1,
                                 const RS_Vector& p2,
                                 const RS_Vector& p3) {
+    ++drawCalls;
+    flush();
 
     QPolygon arr(3);
     QBrush brushSaved=brush();
@@ -812,6 +1218,7 @@ void RS_PainterQt::fillTriangle(const RS_Vector& p1,
 
 
 void RS_PainterQt::erase() {
+    flush();
     QPainter::eraseRect(0,0,getWidth(),getHeight());
 }
 
@@ -824,9 +1231,13 @@ int RS_PainterQt::getWidth() const{
   *@return density per millimeter in pixel/mm
   */
 double RS_PainterQt::getDpmm() const{
-    int mm(device()->widthMM());
-    if(mm==0) mm=400;
-    return double(device()->width())/mm;
+    // the device is the same for the lifetime of the painter
+    if (m_dpmm <= 0.) {
+        int mm(device()->widthMM());
+        if(mm==0) mm=400;
+        m_dpmm = double(device()->width())/mm;
+    }
+    return m_dpmm;
 }
 
 
@@ -849,38 +1260,54 @@ RS_Pen RS_PainterQt::getPen() const{
 }
 
 void RS_PainterQt::setPen(const RS_Pen& pen) {
-    lpen = pen;
+    RS_Pen modePen = pen;
     switch (drawingMode) {
     case RS2::ModeBW:
-        lpen.setColor( RS_Color( Qt::black));
+        modePen.setColor( RS_Color( Qt::black));
         break;
 
     case RS2::ModeWB:
-        lpen.setColor( RS_Color( Qt::white));
+        modePen.setColor( RS_Color( Qt::white));
         break;
 
     default:
         break;
     }
+    if (modePen != lpen)
+        ++penChanges;
+    lpen = modePen;
 
     QColor pColor { lpen.getColor() };
 
     pColor.setAlphaF(pen.getAlpha());
-    QPen p(pColor, RS_Math::round(lpen.getScreenWidth()),
-           rsToQtLineType(lpen.getLineType()));
-    if (p.style() == Qt::CustomDashLine)
-    {
-        auto dashPattern = rsToQDashPattern(lpen.getLineType(),
-                                            p.widthF(),
-                                            getDpmm());
-        if (!dashPattern.isEmpty())
-            p.setDashPattern(dashPattern);
-        else
-            p.setStyle(Qt::SolidLine);
+    // pens with dash patterns are costly to build, and most entities share few pens
+    const PenKey key{pColor.rgba(), RS_Math::round(lpen.getScreenWidth()), lpen.getLineType()};
+    auto it = m_qPens.find(key);
+    if (it == m_qPens.end()) {
+        QPen p(pColor, RS_Math::round(lpen.getScreenWidth()),
+               rsToQtLineType(lpen.getLineType()));
+        if (p.style() == Qt::CustomDashLine)
+        {
+            auto dashPattern = getDashPattern(lpen.getLineType(),
+                                              p.widthF(),
+                                              getDpmm());
+            if (!dashPattern.isEmpty())
+                p.setDashPattern(dashPattern);
+            else
+                p.setStyle(Qt::SolidLine);
+        }
+        p.setJoinStyle(Qt::RoundJoin);
+        p.setCapStyle(Qt::RoundCap);
+        it = m_qPens.emplace(key, p).first;
     }
-    p.setJoinStyle(Qt::RoundJoin);
-    p.setCapStyle(Qt::RoundCap);
-    QPainter::setPen(p);
+    if (m_screenTransforms == 0) {
+        QPainter::setPen(it->second);
+        return;
+    }
+    // widths and patterns are in screen pixels, not scaled by the transform
+    QPen cosmetic = it->second;
+    cosmetic.setCosmetic(true);
+    QPainter::setPen(cosmetic);
 }
 
 void RS_PainterQt::setPen(const RS_Color& color) {
@@ -944,24 +1371,31 @@ void RS_PainterQt::setBrush(const QBrush& color) {
 }
 
 void RS_PainterQt::drawPolygon(const QPolygon& a, Qt::FillRule rule) {
+    ++drawCalls;
+    flush();
     QPainter::drawPolygon(a,rule);
 }
 
 void RS_PainterQt::drawPath ( const QPainterPath & path ) {
+    ++drawCalls;
+    flush();
     QPainter::drawPath(path);
 }
 
 
 void RS_PainterQt::setClipRect(int x, int y, int w, int h) {
+    flush();
     QPainter::setClipRect(x, y, w, h);
     setClipping(true);
 }
 
 void RS_PainterQt::resetClipping() {
+    flush();
     setClipping(false);
 }
 
 void RS_PainterQt::fillRect ( const QRectF & rectangle, const RS_Color & color ) {
+    flush();
 
         double x1=rectangle.left();
         double x2=rectangle.right();
@@ -971,6 +1405,7 @@ void RS_PainterQt::fillRect ( const QRectF & rectangle, const RS_Color & color )
         QPainter::fillRect(toScreenX(x1),toScreenY(y1),toScreenX(x2)-toScreenX(x1),toScreenY(y2)-toScreenX(y1), color);
 }
 void RS_PainterQt::fillRect ( const QRectF & rectangle, const QBrush & brush ) {
+    flush();
         double x1=rectangle.left();
         double x2=rectangle.right();
         double y1=rectangle.top();
@@ -978,6 +1413,28 @@ void RS_PainterQt::fillRect ( const QRectF & rectangle, const QBrush & brush ) {
         QPainter::fillRect(toScreenX(x1),toScreenY(y1),toScreenX(x2),toScreenY(y2), brush);
 }
 
+/**
+ * @return the pen to stroke with, including line patterns. Consecutive strokes
+ * mostly share their pen, the last one is kept
+ */
+const QPen& RS_PainterQt::getStrokePen()
+{
+    const QPen base = pen();
+    StrokePen& last = m_strokePen;
+    if (!last.valid || last.base != base || last.lineType != lpen.getLineType()
+            || last.color != lpen.getColor() || last.screenWidth != lpen.getScreenWidth()
+            || last.dashOffset != lpen.dashOffset()) {
+        last.base = base;
+        last.lineType = lpen.getLineType();
+        last.color = lpen.getColor();
+        last.screenWidth = lpen.getScreenWidth();
+        last.dashOffset = lpen.dashOffset();
+        last.pen = createStrokePen(*this);
+        last.valid = true;
+    }
+    return last.pen;
+}
+
 RS_Pen& RS_PainterQt::getRsPen()
 {
     return lpen;
@@ -1077,25 +1534,21 @@ QPainterPath RS_PainterQt::createSplinePoints(const LC_SplinePointsData& data) c
 QPainterPath RS_PainterQt::createSpline(const RS_Spline& spline, const RS_GraphicView& view) const
 {
     QPainterPath path;
-    auto toGui = [&view](const RS_Vector& v) -> QPointF {
-        RS_Vector vGui = view.toGui(v);
-        return {vGui.x, vGui.y};
-    };
-
-    RS_Entity* e=spline.firstEntity(RS2::ResolveNone);
-    do {
-        auto line = dynamic_cast<RS_Line*>(e);
-        if (line == nullptr)
-            break;
-        if (path.isEmpty())
-            path.moveTo(toGui(line->getStartpoint()));
-        path.lineTo(toGui(line->getEndpoint()));
-    } while ((e = spline.nextEntity(RS2::ResolveNone)) != nullptr);
+    // flattened for a deviation of half a pixel, cached by the spline for the zoom level
+    const double tolerance = 0.5 / std::max(view.getFactor().x, RS_TOLERANCE);
+    const auto points = spline.getFlattened(tolerance, !view.isConcurrentDrawing());
+    if (points->size() < 2)
+        return path;
+    QPolygonF polygon(int(points->size()));
+    view.toGui(points->data(), points->size(), polygon.data());
+    path.addPolygon(polygon);
     return path;
 }
 
 void RS_PainterQt::drawText(const QRect& rect, const QString& text, QRect* boundingBox)
 {
+    ++drawCalls;
+    flush();
     QPainter::drawText(rect, Qt::AlignTop | Qt::AlignLeft | Qt::TextDontClip, text, boundingBox);
 }
 
@@ -28,8 +28,14 @@
 #ifndef RS_PAINTERQT_H
 #define RS_PAINTERQT_H
 
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 #include <QPainter>
 #include <QPainterPath>
+#include <QVector>
 
 #include "rs_painter.h"
 #include "rs_pen.h"
@@ -46,7 +52,22 @@ class RS_PainterQt: public QPainter, public RS_Painter {
 
 public:
     RS_PainterQt( QPaintDevice* pd);
-    virtual ~RS_PainterQt()=default;
+    virtual ~RS_PainterQt();
+
+    /**
+     * Flushes batched lines and ends painting. QPainter::end() is not virtual, it's
+     * not overridden, so calls through QPainter can't skip the flush
+     */
+    bool flushAndEnd();
+    void flush() override;
+    /**
+     * @brief setPathBatching collect strokes into one path per pen, drawn by flush().
+     * Strokes of different pens may be reordered, until a fill, text, image or a clipping
+     * or transform change flushes them. Enabled for printers and pictures, where each
+     * primitive would otherwise be written with its own pen state
+     */
+    void setPathBatching(bool state);
+    bool isDashChaining() const override;
 
     void moveTo(int x, int y) override;
     void lineTo(int x, int y) override;
@@ -93,6 +114,8 @@ public:
 
     void drawPolygon(const QPolygon& a,Qt::FillRule rule=Qt::WindingFill) override;
     void drawPath ( const QPainterPath & path ) override;
+    void setScreenTransform(const QTransform& transform) override;
+    void resetScreenTransform() override;
     void erase() override;
     int getWidth() const override;
     /** get Density per millimeter on screen/print device
@@ -116,12 +139,44 @@ public:
     void resetClipping() override;
 
     RS_Pen& getRsPen();
+    const QPen& getStrokePen();
 
 protected:
 
     QPainterPath createSplinePoints(const LC_SplinePointsData& data) const;
     QPainterPath createSpline(const RS_Spline& spline, const RS_GraphicView& view) const;
     RS_Pen lpen;
+    // consecutive lines with the same pen, drawn at once on raster devices
+    bool m_batchLines = false;
+    QPen m_batchPen;
+    QVector<QLineF> m_lineBatch;
+    // connected dashed strokes with the batch pen, on raster devices
+    QPainterPath* dashChain();
+    QPainterPath m_dashChain;
+    // strokes by pen, in the order of the first stroke of each pen, on vector devices
+    void addStroke(const QPainterPath& path);
+    QPainterPath& strokeBatch();
+    bool m_batchPaths = false;
+    std::vector<std::pair<QPen, QPainterPath>> m_pathBatches;
+    size_t m_lastPathBatch = 0;
+    // pens set by setPen(const RS_Pen&), by color, width and line type
+    using PenKey = std::tuple<QRgb, int, RS2::LineType>;
+    std::map<PenKey, QPen> m_qPens;
+    // the last pen of getStrokePen(), with the pens it was created from
+    struct StrokePen {
+        QPen base;
+        RS2::LineType lineType = RS2::SolidLine;
+        RS_Color color;
+        double screenWidth = 0.;
+        double dashOffset = 0.;
+        QPen pen;
+        bool valid = false;
+    };
+    StrokePen m_strokePen;
+    // nesting of setScreenTransform(), pens are cosmetic while transformed
+    int m_screenTransforms = 0;
+    //! density of the device, in pixels per mm
+    mutable double m_dpmm = 0.;
     long rememberX = 0; // Used for the moment because QPainter doesn't support moveTo anymore, thus we need to remember ourselves the moveTo positions
     long rememberY = 0;
 };
@@ -63,6 +63,12 @@ int RS_StaticGraphicView::getHeight() const{
     return height;
 }
 
+void RS_StaticGraphicView::setOffset(int ox, int oy)
+{
+    RS_GraphicView::setOffset(ox, oy);
+    view_rect = LC_Rect(toGraph(0, 0), toGraph(getWidth(), getHeight()));
+}
+
 RS_Vector RS_StaticGraphicView::getMousePosition() const
 {
     return RS_Vector(false);
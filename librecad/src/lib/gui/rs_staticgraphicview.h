@@ -43,6 +43,8 @@ public:
 	void adjustOffsetControls() override{}
 	void adjustZoomControls() override{}
 	void setMouseCursor(RS2::CursorType ) override{}
+	/** Sets the offset and updates the viewport rectangle */
+	void setOffset(int ox, int oy) override;
 
     void updateGridStatusWidget(QString) override{}
 	RS_Vector getMousePosition() const override;
@@ -0,0 +1,208 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include "lc_preparedcontour.h"
+
+#include <cmath>
+
+#include "rs_arc.h"
+#include "rs_ellipse.h"
+#include "rs_entitycontainer.h"
+#include "rs_information.h"
+#include "rs_line.h"
+#include "rs_math.h"
+
+LC_PreparedContour::LC_PreparedContour(RS_EntityContainer& contour):
+    m_min{contour.getMin()}
+    , m_max{contour.getMax()}
+    , m_width{contour.getSize().x + 1.0}
+{
+    for (RS_Entity* e = contour.firstEntity(RS2::ResolveAll); e;
+         e = contour.nextEntity(RS2::ResolveAll)) {
+        m_edges.push_back(e);
+        // intersections with entities on construction layers are not limited by borders
+        const bool bounded = !e->isConstruction();
+        m_minX.push_back(bounded ? e->getMin().x : - RS_MAXDOUBLE);
+        m_minY.push_back(bounded ? e->getMin().y : - RS_MAXDOUBLE);
+        m_maxX.push_back(bounded ? e->getMax().x : RS_MAXDOUBLE);
+        m_maxY.push_back(bounded ? e->getMax().y : RS_MAXDOUBLE);
+    }
+}
+
+void LC_PreparedContour::findCandidates(const RS_Line& ray, std::vector<RS_Entity*>& candidates) const
+{
+    // the same test as RS_Information::getIntersection() does for bounding boxes
+    const double minX = ray.getMin().x - RS_TOLERANCE;
+    const double minY = ray.getMin().y - RS_TOLERANCE;
+    const double maxX = ray.getMax().x + RS_TOLERANCE;
+    const double maxY = ray.getMax().y + RS_TOLERANCE;
+    candidates.clear();
+    const std::size_t size = m_edges.size();
+    for (std::size_t i = 0; i < size; ++i) {
+        if (m_maxX[i] >= minX && m_maxY[i] >= minY && m_minX[i] <= maxX && m_minY[i] <= maxY)
+            candidates.push_back(m_edges[i]);
+    }
+}
+
+bool LC_PreparedContour::isPointInside(const RS_Vector& point, bool* onContour) const
+{
+    if (point.x < m_min.x || point.x > m_max.x ||
+            point.y < m_min.y || point.y > m_max.y) {
+        return false;
+    }
+
+    bool sure;
+    int counter;
+    int tries = 0;
+    double rayAngle = 0.0;
+    std::vector<RS_Entity*> candidates;
+    do {
+        sure = true;
+
+        // create ray:
+        RS_Vector v = RS_Vector::polar(m_width*10.0, rayAngle);
+        RS_Line ray{point, point+v};
+        counter = 0;
+        RS_VectorSolutions sol;
+
+        if (onContour) {
+            *onContour = false;
+        }
+
+        findCandidates(ray, candidates);
+        for (RS_Entity* e: candidates) {
+
+            // intersection(s) from ray with contour entity:
+            sol = RS_Information::getIntersection(&ray, e, true);
+
+            for (int i=0; i<=1; ++i) {
+                RS_Vector p = sol.get(i);
+
+                if (p.valid) {
+                    // point is on the contour itself
+                    if (p.distanceTo(point)<1.0e-5) {
+                        if (onContour) {
+                            *onContour = true;
+                        }
+                    } else {
+                        if (e->rtti()==RS2::EntityLine) {
+                            RS_Line* line = (RS_Line*)e;
+
+                            // ray goes through startpoint of line:
+                            if (p.distanceTo(line->getStartpoint())<1.0e-4) {
+                                if (RS_Math::correctAngle(line->getAngle1())<M_PI) {
+                                    sure = false;
+                                }
+                            }
+
+                            // ray goes through endpoint of line:
+                            else if (p.distanceTo(line->getEndpoint())<1.0e-4) {
+                                if (RS_Math::correctAngle(line->getAngle2())<M_PI) {
+                                    sure = false;
+                                }
+                            }
+                            // else: ray goes through the line
+
+                            counter++;
+                        } else if (e->rtti()==RS2::EntityArc) {
+                            RS_Arc* arc = (RS_Arc*)e;
+
+                            if (p.distanceTo(arc->getStartpoint())<1.0e-4) {
+                                double dir = arc->getDirection1();
+                                if ((dir<M_PI && dir>=1.0e-5) ||
+                                        ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
+                                         arc->getCenter().y>p.y)) {
+                                    counter++;
+                                    sure = false;
+                                }
+                            }
+                            else if (p.distanceTo(arc->getEndpoint())<1.0e-4) {
+                                double dir = arc->getDirection2();
+                                if ((dir<M_PI && dir>=1.0e-5) ||
+                                        ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
+                                         arc->getCenter().y>p.y)) {
+                                    counter++;
+                                    sure = false;
+                                }
+                            } else {
+                                counter++;
+                            }
+                        } else if (e->rtti()==RS2::EntityCircle) {
+                            // tangent:
+                            if (i==0 && sol.get(1).valid==false) {
+                                if (!sol.isTangent()) {
+                                    counter++;
+                                } else {
+                                    sure = false;
+                                }
+                            } else if (i==1 || sol.get(1).valid==true) {
+                                counter++;
+                            }
+                        } else if (e->rtti()==RS2::EntityEllipse) {
+                            RS_Ellipse* ellipse=static_cast<RS_Ellipse*>(e);
+                            if(ellipse->isArc()){
+                                if (p.distanceTo(ellipse->getStartpoint())<1.0e-4) {
+                                    double dir = ellipse->getDirection1();
+                                    if ((dir<M_PI && dir>=1.0e-5) ||
+                                            ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
+                                             ellipse->getCenter().y>p.y)) {
+                                        counter++;
+                                        sure = false;
+                                    }
+                                }
+                                else if (p.distanceTo(ellipse->getEndpoint())<1.0e-4) {
+                                    double dir = ellipse->getDirection2();
+                                    if ((dir<M_PI && dir>=1.0e-5) ||
+                                            ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
+                                             ellipse->getCenter().y>p.y)) {
+                                        counter++;
+                                        sure = false;
+                                    }
+                                } else {
+                                    counter++;
+                                }
+                            }else{
+                                // tangent:
+                                if (i==0 && sol.get(1).valid==false) {
+                                    if (!sol.isTangent()) {
+                                        counter++;
+                                    } else {
+                                        sure = false;
+                                    }
+                                } else if (i==1 || sol.get(1).valid==true) {
+                                    counter++;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        rayAngle+=0.02;
+        tries++;
+    }
+    while (!sure && rayAngle<2*M_PI && tries<6);
+
+    return ((counter%2)==1);
+}
@@ -0,0 +1,71 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_PREPAREDCONTOUR_H
+#define LC_PREPAREDCONTOUR_H
+
+#include <vector>
+
+#include "rs_vector.h"
+
+class RS_Entity;
+class RS_EntityContainer;
+class RS_Line;
+
+/**
+ * @brief The LC_PreparedContour class, a contour prepared to test many points
+ * for being inside.
+ *
+ * The edges of the contour are collected once, with their bounding boxes in
+ * contiguous arrays, so each query only intersects its rays with the edges
+ * which bounding boxes overlap the ray. The results are the same as for
+ * RS_Information::isPointInsideContour(), which uses this class. The contour
+ * must not be modified while it's prepared.
+ */
+class LC_PreparedContour {
+public:
+    explicit LC_PreparedContour(RS_EntityContainer& contour);
+
+    /**
+     * @brief isPointInside whether the point is inside the contour
+     * @param onContour - set to whether the point is on the contour, if it's
+     * inside the bounding box of the contour
+     */
+    bool isPointInside(const RS_Vector& point, bool* onContour = nullptr) const;
+
+private:
+    // edges which may intersect with the ray
+    void findCandidates(const RS_Line& ray, std::vector<RS_Entity*>& candidates) const;
+
+    RS_Vector m_min;
+    RS_Vector m_max;
+    double m_width = 0.;
+    std::vector<RS_Entity*> m_edges;
+    // bounding boxes of the edges, unbounded for edges on construction layers
+    std::vector<double> m_minX;
+    std::vector<double> m_minY;
+    std::vector<double> m_maxX;
+    std::vector<double> m_maxY;
+};
+
+#endif // LC_PREPAREDCONTOUR_H
@@ -25,8 +25,13 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 #include "rs_information.h"
+#include "lc_preparedcontour.h"
 #include "rs_entitycontainer.h"
 #include "rs_vector.h"
 
@@ -204,50 +209,62 @@ RS_Entity* RS_Information::getNearestEntity(const RS_Vector& coord,
 
 
 
+namespace {
+bool isUnsupported(RS_Entity const* e)
+{
+    const RS2::EntityType type = e->rtti();
+    return type == RS2::EntityMText || type == RS2::EntityText
+            || RS_Information::isDimension(type);
+}
+
 /**
- * Calculates the intersection point(s) between two entities.
- *
- * @param onEntities true: only return intersection points which are
- *                   on both entities.
- *                   false: return all intersection points.
- *
- * @todo support more entities
- *
- * @return All intersections of the two entities. The tangent flag in
- * RS_VectorSolutions is set if one intersection is a tangent point.
+ * Memo of the intersections of pairs of conics, keyed by their coefficients: the
+ * conic solver is expensive and snapping, trimming and hatching intersect the
+ * same pairs again and again.
  */
-RS_VectorSolutions RS_Information::getIntersection(RS_Entity const* e1,
-		RS_Entity const* e2, bool onEntities) {
-
-    RS_VectorSolutions ret;
-    const double tol = 1.0e-4;
-
-	if (!(e1 && e2) ) {
-		RS_DEBUG->print("RS_Information::getIntersection() for nullptr entities");
-        return ret;
-    }
-    if (e1->getId() == e2->getId()) {
-        RS_DEBUG->print("RS_Information::getIntersection() of the same entity");
-        return ret;
+class ConicIntersectionCache {
+public:
+    RS_VectorSolutions get(const LC_Quadratic& qf1, const LC_Quadratic& qf2)
+    {
+        const std::vector<double> ce1 = qf1.getCoefficients();
+        const std::vector<double> ce2 = qf2.getCoefficients();
+        Key key{};
+        std::copy(ce1.begin(), ce1.end(), key.begin());
+        std::copy(ce2.begin(), ce2.end(), key.begin() + ce1.size());
+
+        auto it = m_entries.find(key);
+        if (it != m_entries.end())
+            return it->second;
+        if (m_entries.size() >= maxEntries)
+            m_entries.clear();
+        return m_entries.emplace(key, LC_Quadratic::getIntersection(qf1, qf2)).first->second;
     }
 
-    // unsupported entities / entity combinations:
-    if (
-        e1->rtti()==RS2::EntityMText || e2->rtti()==RS2::EntityMText ||
-        e1->rtti()==RS2::EntityText || e2->rtti()==RS2::EntityText ||
-        isDimension(e1->rtti()) || isDimension(e2->rtti())) {
-        return ret;
-    }
-
-	if (onEntities && !(e1->isConstruction() || e2->isConstruction())) {
-	// a little check to avoid doing unneeded intersections, an attempt to avoid O(N^2) increasing of checking two-entity information
-		LC_Rect const rect1{e1->getMin(), e1->getMax()};
-		LC_Rect const rect2{e2->getMin(), e2->getMax()};
+private:
+    using Key = std::array<double, 12>;
+    struct KeyHash {
+        size_t operator()(const Key& key) const
+        {
+            size_t hash = 0;
+            for (double value: key)
+                hash = hash * 1000003 ^ std::hash<double>{}(value);
+            return hash;
+        }
+    };
+    static constexpr size_t maxEntries = 1024;
+    std::unordered_map<Key, RS_VectorSolutions, KeyHash> m_entries;
+};
 
-		if (onEntities && !rect1.intersects(rect2, RS_TOLERANCE)) {
-			return ret;
-		}
-	}
+/**
+ * The intersections of two supported entities, once the cheap checks are done.
+ *
+ * @param quadratic1 the quadratic form of e1, computed on first use
+ */
+RS_VectorSolutions solveIntersection(RS_Entity const* e1, RS_Entity const* e2,
+                                     bool onEntities, std::optional<LC_Quadratic>& quadratic1)
+{
+    const double tol = 1.0e-4;
+    RS_VectorSolutions ret;
 
     //avoid intersections between line segments the same spline
     /* ToDo: 24 Aug 2011, Dongxu Li, if rtti() is not defined for the parent, the following check for splines may still cause segfault */
@@ -276,11 +293,18 @@ RS_VectorSolutions RS_Information::getIntersection(RS_Entity const* e1,
 
 		if(isArc(e1) && isArc(e2)){
 			//use specialized arc-arc intersection solver
-			ret=getIntersectionArcArc(e1, e2);
+			ret=RS_Information::getIntersectionArcArc(e1, e2);
 		}else{
-			const auto qf1=e1->getQuadratic();
+			if (!quadratic1)
+				quadratic1 = e1->getQuadratic();
+			const LC_Quadratic& qf1=*quadratic1;
 			const auto qf2=e2->getQuadratic();
-			ret=LC_Quadratic::getIntersection(qf1,qf2);
+			if (qf1 && qf2 && qf1.isQuadratic() && qf2.isQuadratic()) {
+				thread_local ConicIntersectionCache conicIntersections;
+				ret=conicIntersections.get(qf1,qf2);
+			} else {
+				ret=LC_Quadratic::getIntersection(qf1,qf2);
+			}
 		}
 	}
     RS_VectorSolutions ret2;
@@ -331,6 +355,85 @@ RS_VectorSolutions RS_Information::getIntersection(RS_Entity const* e1,
 
     return ret2;
 }
+}
+
+
+
+/**
+ * Calculates the intersection point(s) between two entities.
+ *
+ * @param onEntities true: only return intersection points which are
+ *                   on both entities.
+ *                   false: return all intersection points.
+ *
+ * @todo support more entities
+ *
+ * @return All intersections of the two entities. The tangent flag in
+ * RS_VectorSolutions is set if one intersection is a tangent point.
+ */
+RS_VectorSolutions RS_Information::getIntersection(RS_Entity const* e1,
+		RS_Entity const* e2, bool onEntities) {
+
+    RS_VectorSolutions ret;
+
+	if (!(e1 && e2) ) {
+		RS_DEBUG->print("RS_Information::getIntersection() for nullptr entities");
+        return ret;
+    }
+    if (e1->getId() == e2->getId()) {
+        RS_DEBUG->print("RS_Information::getIntersection() of the same entity");
+        return ret;
+    }
+
+    // unsupported entities / entity combinations:
+    if (isUnsupported(e1) || isUnsupported(e2)) {
+        return ret;
+    }
+
+	if (onEntities && !(e1->isConstruction() || e2->isConstruction())) {
+	// a little check to avoid doing unneeded intersections, an attempt to avoid O(N^2) increasing of checking two-entity information
+		LC_Rect const rect1{e1->getMin(), e1->getMax()};
+		LC_Rect const rect2{e2->getMin(), e2->getMax()};
+
+		if (onEntities && !rect1.intersects(rect2, RS_TOLERANCE)) {
+			return ret;
+		}
+	}
+
+    std::optional<LC_Quadratic> quadratic1;
+    return solveIntersection(e1, e2, onEntities, quadratic1);
+}
+
+
+
+/**
+ * Calculates the intersection points of an entity with many candidate entities,
+ * see getIntersection(). The checks of the entity, its bounding box and its
+ * quadratic form are done once for all the candidates.
+ *
+ * @param intersections the points found are appended to it, with the candidate
+ *        they are on; it can be reused from batch to batch
+ */
+void RS_Information::getIntersections(RS_Entity const* entity,
+                                      const std::vector<RS_Entity*>& candidates, bool onEntities,
+                                      std::vector<std::pair<RS_Entity*, RS_Vector>>& intersections)
+{
+    if (entity == nullptr || isUnsupported(entity))
+        return;
+
+    const bool checkBorders = onEntities && !entity->isConstruction();
+    const LC_Rect borders{entity->getMin(), entity->getMax()};
+    std::optional<LC_Quadratic> quadratic;
+    for (RS_Entity* candidate: candidates) {
+        if (candidate == nullptr || candidate->getId() == entity->getId() || isUnsupported(candidate))
+            continue;
+        if (checkBorders && !candidate->isConstruction()
+                && !borders.intersects(LC_Rect{candidate->getMin(), candidate->getMax()}, RS_TOLERANCE))
+            continue;
+        for (const RS_Vector& vp: solveIntersection(entity, candidate, onEntities, quadratic))
+            intersections.emplace_back(candidate, vp);
+    }
+}
 
 
 
@@ -766,169 +869,7 @@ bool RS_Information::isPointInsideContour(const RS_Vector& point,
         return false;
     }
 
-    double width = contour->getSize().x+1.0;
-
-    bool sure;
-    int counter;
-    int tries = 0;
-    double rayAngle = 0.0;
-    do {
-        sure = true;
-
-        // create ray:
-		RS_Vector v = RS_Vector::polar(width*10.0, rayAngle);
-		RS_Line ray{point, point+v};
-        counter = 0;
-        RS_VectorSolutions sol;
-
-		if (onContour) {
-            *onContour = false;
-        }
-
-        for (RS_Entity* e = contour->firstEntity(RS2::ResolveAll);
-				e;
-                e = contour->nextEntity(RS2::ResolveAll)) {
-
-            // intersection(s) from ray with contour entity:
-            sol = RS_Information::getIntersection(&ray, e, true);
-
-            for (int i=0; i<=1; ++i) {
-                RS_Vector p = sol.get(i);
-
-                if (p.valid) {
-                    // point is on the contour itself
-                    if (p.distanceTo(point)<1.0e-5) {
-						if (onContour) {
-                            *onContour = true;
-                        }
-                    } else {
-                        if (e->rtti()==RS2::EntityLine) {
-                            RS_Line* line = (RS_Line*)e;
-
-                            // ray goes through startpoint of line:
-                            if (p.distanceTo(line->getStartpoint())<1.0e-4) {
-                                if (RS_Math::correctAngle(line->getAngle1())<M_PI) {
-                                    sure = false;
-                                }
-                            }
-
-                            // ray goes through endpoint of line:
-                            else if (p.distanceTo(line->getEndpoint())<1.0e-4) {
-                                if (RS_Math::correctAngle(line->getAngle2())<M_PI) {
-                                    sure = false;
-                                }
-                            }
-                            // else: ray goes through the line
-
-
-                                counter++;
-                            
-                        } else if (e->rtti()==RS2::EntityArc) {
-                            RS_Arc* arc = (RS_Arc*)e;
-
-                            if (p.distanceTo(arc->getStartpoint())<1.0e-4) {
-                                double dir = arc->getDirection1();
-                                if ((dir<M_PI && dir>=1.0e-5) ||
-                                        ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
-                                         arc->getCenter().y>p.y)) {
-                                    counter++;
-                                    sure = false;
-                                }
-                            }
-                            else if (p.distanceTo(arc->getEndpoint())<1.0e-4) {
-                                double dir = arc->getDirection2();
-                                if ((dir<M_PI && dir>=1.0e-5) ||
-                                        ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
-                                         arc->getCenter().y>p.y)) {
-                                    counter++;
-                                    sure = false;
-                                }
-                            } else {
-                                counter++;
-                            }
-                        } else if (e->rtti()==RS2::EntityCircle) {
-                            // tangent:
-                            if (i==0 && sol.get(1).valid==false) {
-                                if (!sol.isTangent()) {
-                                    counter++;
-                                } else {
-                                    sure = false;
-                                }
-                            } else if (i==1 || sol.get(1).valid==true) {
-                                counter++;
-                            }
-                        } else if (e->rtti()==RS2::EntityEllipse) {
-                            RS_Ellipse* ellipse=static_cast<RS_Ellipse*>(e);
-                            if(ellipse->isArc()){
-                                if (p.distanceTo(ellipse->getStartpoint())<1.0e-4) {
-                                    double dir = ellipse->getDirection1();
-                                    if ((dir<M_PI && dir>=1.0e-5) ||
-                                            ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
-                                             ellipse->getCenter().y>p.y)) {
-                                        counter++;
-                                        sure = false;
-                                    }
-                                }
-                                else if (p.distanceTo(ellipse->getEndpoint())<1.0e-4) {
-                                    double dir = ellipse->getDirection2();
-                                    if ((dir<M_PI && dir>=1.0e-5) ||
-                                            ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
-                                             ellipse->getCenter().y>p.y)) {
-                                        counter++;
-                                        sure = false;
-                                    }
-                                } else {
-                                    counter++;
-                                }
-                            }else{
-                                // tangent:
-                                if (i==0 && sol.get(1).valid==false) {
-                                    if (!sol.isTangent()) {
-                                        counter++;
-                                    } else {
-                                        sure = false;
-                                    }
-                                } else if (i==1 || sol.get(1).valid==true) {
-                                    counter++;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        rayAngle+=0.02;
-        tries++;
-    }
-    while (!sure && rayAngle<2*M_PI && tries<6);
-
-    // remove double intersections:
-    /*
-       QList<RS_Vector> is2;
-       bool done;
-    RS_Vector* av;
-       do {
-           done = true;
-           double minDist = RS_MAXDOUBLE;
-           double dist;
-		av = nullptr;
-		   for (RS_Vector* v = is.first(); v; v = is.next()) {
-               dist = point.distanceTo(*v);
-               if (dist<minDist) {
-                   minDist = dist;
-                   done = false;
-                        av = v;
-               }
-           }
-
-		if (!done && av) {
-                is2.append(*av);
-        }
-       } while (!done);
-    */
-
-    return ((counter%2)==1);
+    return LC_PreparedContour{*contour}.isPointInside(point, onContour);
 }
 
 
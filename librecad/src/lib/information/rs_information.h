@@ -27,6 +27,9 @@
 #ifndef RS_INFORMATION_H
 #define RS_INFORMATION_H
 
+#include <utility>
+#include <vector>
+
 #include "rs.h"
 
 class RS_Ellipse;
@@ -69,6 +72,9 @@ public:
 	static RS_VectorSolutions getIntersection(RS_Entity const* e1,
 			RS_Entity const* e2,
             bool onEntities = false);
+	static void getIntersections(RS_Entity const* entity,
+			const std::vector<RS_Entity*>& candidates, bool onEntities,
+			std::vector<std::pair<RS_Entity*, RS_Vector>>& intersections);
 
     static RS_VectorSolutions getIntersectionLineLine(RS_Line* e1,
             RS_Line* e2);
@@ -0,0 +1,134 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <cmath>
+#include <map>
+
+#include <muParser.h>
+
+#include "lc_expression.h"
+#include "rs_math.h"
+
+namespace {
+mu::string_type toParserString(const QString& text)
+{
+#ifdef _UNICODE
+    return text.toStdWString();
+#else
+    return text.toStdString();
+#endif
+}
+
+QString fromParserString(const mu::string_type& text)
+{
+#ifdef _UNICODE
+    return QString::fromStdWString(text);
+#else
+    return QString::fromStdString(text);
+#endif
+}
+}
+
+struct LC_Expression::Parser {
+    QString expression;
+    QString error;
+    bool valid = false;
+    // the parser keeps pointers to the values, the nodes of the map don't move
+    std::map<QString, double> variables;
+    mu::Parser parser;
+};
+
+LC_Expression::LC_Expression():
+    m_parser{std::make_unique<Parser>()}
+{
+}
+
+LC_Expression::LC_Expression(const QString& expr, const QStringList& variables):
+    m_parser{std::make_unique<Parser>()}
+{
+    m_parser->expression = expr;
+    if (expr.isEmpty())
+        return;
+    try {
+        mu::Parser& p = m_parser->parser;
+        p.DefineConst(_T("pi"), M_PI);
+        for (const QString& name: variables) {
+            double& value = m_parser->variables[name];
+            p.DefineVar(toParserString(name), &value);
+        }
+        p.SetExpr(toParserString(RS_Math::derationalize(expr)));
+        // compiles the expression, unknown names or syntax errors throw
+        p.Eval();
+        m_parser->valid = true;
+    } catch (mu::Parser::exception_type& e) {
+        m_parser->error = fromParserString(e.GetMsg());
+    }
+}
+
+LC_Expression::~LC_Expression() = default;
+LC_Expression::LC_Expression(LC_Expression&&) noexcept = default;
+LC_Expression& LC_Expression::operator = (LC_Expression&&) noexcept = default;
+
+const QString& LC_Expression::getExpression() const
+{
+    return m_parser->expression;
+}
+
+bool LC_Expression::isValid() const
+{
+    return m_parser->valid;
+}
+
+const QString& LC_Expression::getError() const
+{
+    return m_parser->error;
+}
+
+bool LC_Expression::setVariable(const QString& name, double value)
+{
+    auto it = m_parser->variables.find(name);
+    if (it == m_parser->variables.end())
+        return false;
+    it->second = value;
+    return true;
+}
+
+double LC_Expression::evaluate(bool* ok) const
+{
+    bool okTmp = false;
+    if (ok == nullptr)
+        ok = &okTmp;
+    *ok = false;
+    if (!m_parser->valid)
+        return 0.;
+    try {
+        const double ret = m_parser->parser.Eval();
+        *ok = true;
+        return ret;
+    } catch (mu::Parser::exception_type& e) {
+        m_parser->error = fromParserString(e.GetMsg());
+    }
+    return 0.;
+}
@@ -0,0 +1,89 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_EXPRESSION_H
+#define LC_EXPRESSION_H
+
+#include <memory>
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * A math expression, parsed once and evaluated repeatedly with the values
+ * bound to its variables.
+ *
+ * The expression text is preprocessed like by RS_Math::eval(): fractions and
+ * unit symbols are converted by RS_Math::derationalize() and "pi" is defined.
+ * The parser compiles the expression at the first evaluation, later
+ * evaluations only run the compiled byte code.
+ *
+ * @code
+ * LC_Expression f{"2*r^2 + h", {"r", "h"}};
+ * for (double r: radii) {
+ *     f.setVariable("r", r);
+ *     f.setVariable("h", h);
+ *     double v = f.evaluate();
+ * }
+ * @endcode
+ */
+class LC_Expression {
+public:
+    LC_Expression();
+    /**
+     * @brief LC_Expression parses the expression
+     * @param expr expression text
+     * @param variables names of the variables of the expression, initially 0
+     */
+    explicit LC_Expression(const QString& expr, const QStringList& variables = {});
+    ~LC_Expression();
+    LC_Expression(LC_Expression&&) noexcept;
+    LC_Expression& operator = (LC_Expression&&) noexcept;
+
+    //! @return the expression text
+    const QString& getExpression() const;
+    //! @return false, if the expression is empty or can't be parsed
+    bool isValid() const;
+    //! @return the parser message of an invalid expression
+    const QString& getError() const;
+
+    /**
+     * @brief setVariable sets the value of a variable for the next evaluations
+     * @return false, if the expression has no variable of the name
+     */
+    bool setVariable(const QString& name, double value);
+    /**
+     * @brief evaluate the expression with the current values of the variables
+     * @param ok set to false on errors, if not nullptr
+     * @return the value of the expression, 0 on errors
+     */
+    double evaluate(bool* ok = nullptr) const;
+
+private:
+    struct Parser;
+    std::unique_ptr<Parser> m_parser;
+};
+
+#endif // LC_EXPRESSION_H
@@ -29,12 +29,15 @@
 #include <boost/math/special_functions/ellint_2.hpp>
 
 #include <cmath>
-#include <muParser.h>
+#include <list>
+#include <unordered_map>
+
 #include <QString>
 #include <QRegularExpression>
 #include <QRegularExpressionMatch>
 #include <QDebug>
 
+#include "lc_expression.h"
 #include "rs.h"
 #include "rs_math.h"
 #include "rs_vector.h"
@@ -46,6 +49,31 @@
 
 
 namespace {
+    // the expressions parsed by RS_Math::eval(), the least recently used dropped first
+    class ExpressionCache {
+    public:
+        const LC_Expression& get(const QString& expr)
+        {
+            auto it = m_index.find(expr);
+            if (it != m_index.end()) {
+                m_expressions.splice(m_expressions.begin(), m_expressions, it->second);
+                return *it->second;
+            }
+            m_expressions.emplace_front(expr);
+            m_index.emplace(expr, m_expressions.begin());
+            if (m_expressions.size() > capacity) {
+                m_index.erase(m_expressions.back().getExpression());
+                m_expressions.pop_back();
+            }
+            return m_expressions.front();
+        }
+
+    private:
+        static constexpr size_t capacity = 64;
+        std::list<LC_Expression> m_expressions;
+        std::unordered_map<QString, std::list<LC_Expression>::iterator> m_index;
+    };
+
     constexpr double m_piX2 = M_PI*2; //2*PI
     constexpr double m_halfPI = M_PI/2; //PI/2
     const QRegularExpression unitreg(
@@ -348,25 +376,13 @@ double RS_Math::eval(const QString& expr, bool* ok) {
         return 0.0;
     }
 
-    QString derationalized = derationalize(expr);
-
-    double ret(0.);
-    try{
-        mu::Parser p;
-        p.DefineConst(_T("pi"),M_PI);
-#ifdef _UNICODE
-        p.SetExpr(derationalized.toStdWString());
-#else
-        p.SetExpr(derationalized.toStdString());
-#endif
-        ret=p.Eval();
-        *ok=true;
-    }
-    catch (mu::Parser::exception_type &e)
-    {
-        mu::console() << e.GetMsg() << std::endl;
-        *ok=false;
-    }
+    // parsers are not shared by threads
+    thread_local ExpressionCache cache;
+    const LC_Expression& expression = cache.get(expr);
+    const double ret = expression.evaluate(ok);
+    if (!*ok)
+        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Math::eval: %s: %s",
+                        expr.toLatin1().data(), expression.getError().toLatin1().data());
     return ret;
 }
 
@@ -517,12 +533,11 @@ void RS_Math::test() {
 // solvers assume arguments are valid, and there's no attempt to verify validity of the argument pointers
 //
 // @author Dongxu Li <dongxuli2011@gmail.com>
-std::vector<double> RS_Math::quadraticSolver(const std::vector<double>& ce)
+RS_Math::Roots RS_Math::quadraticSolver(const std::array<double, 2>& ce)
 //quadratic solver for
 // x^2 + ce[0] x + ce[1] =0
 {
-    std::vector<double> ans(0,0.);
-	if (ce.size() != 2) return ans;
+    Roots ans;
 	using LDouble = long double;
 	LDouble const b = -0.5L * ce[0];
 	LDouble const c = ce[1];
@@ -569,14 +584,19 @@ std::vector<double> RS_Math::quadraticSolver(const std::vector<double>& ce)
 	return ans;
 }
 
+std::vector<double> RS_Math::quadraticSolver(const std::vector<double>& ce)
+{
+	if (ce.size() != 2) return {};
+	return quadraticSolver(std::array<double, 2>{ce[0], ce[1]});
+}
 
-std::vector<double> RS_Math::cubicSolver(const std::vector<double>& ce)
+
+RS_Math::Roots RS_Math::cubicSolver(const std::array<double, 3>& ce)
 //cubic equation solver
 // x^3 + ce[0] x^2 + ce[1] x + ce[2] = 0
 {
 //    std::cout<<"x^3 + ("<<ce[0]<<")*x^2+("<<ce[1]<<")*x+("<<ce[2]<<")==0"<<std::endl;
-    std::vector<double> ans(0,0.);
-	if (ce.size() != 3) return ans;
+    Roots ans;
     // depressed cubic, Tschirnhaus transformation, x= t - b/(3a)
     // t^3 + p t +q =0
     double shift=(1./3)*ce[0];
@@ -604,10 +624,7 @@ std::vector<double> RS_Math::cubicSolver(const std::vector<double>& ce)
     }
     //std::cout<<"discriminant="<<discriminant<<std::endl;
     if(discriminant>0) {
-        std::vector<double> ce2(2,0.);
-        ce2[0]=q;
-        ce2[1]=-1./27*p*p*p;
-		auto r=quadraticSolver(ce2);
+		auto r=quadraticSolver(std::array<double, 2>{q, -1./27*p*p*p});
         if ( r.empty() ) { //should not happen
             std::cerr<<__FILE__<<" : "<<__func__<<" : line"<<__LINE__<<" :cubicSolver()::Error cubicSolver("<<ce[0]<<' '<<ce[1]<<' '<<ce[2]<<")\n";
             return {};
@@ -655,20 +672,22 @@ std::vector<double> RS_Math::cubicSolver(const std::vector<double>& ce)
     return ans;
 }
 
+std::vector<double> RS_Math::cubicSolver(const std::vector<double>& ce)
+{
+	if (ce.size() != 3) return {};
+	return cubicSolver(std::array<double, 3>{ce[0], ce[1], ce[2]});
+}
+
 /** quartic solver
 * x^4 + ce[0] x^3 + ce[1] x^2 + ce[2] x + ce[3] = 0
-@ce, a vector of size 4 contains the coefficient in order
-@return, a vector contains real roots
+@ce, the coefficients in order
+@return, the real roots
 **/
-std::vector<double> RS_Math::quarticSolver(const std::vector<double>& ce)
+RS_Math::Roots RS_Math::quarticSolver(const std::array<double, 4>& ce)
 {
-    std::vector<double> ans(0,0.);
+    Roots ans;
     if(RS_DEBUG->getLevel()>=RS_Debug::D_INFORMATIONAL){
 		DEBUG_HEADER
-        std::cout<<"expected array size=4, got "<<ce.size()<<std::endl;
-    }
-    if(ce.size() != 4) return ans;
-    if(RS_DEBUG->getLevel()>=RS_Debug::D_INFORMATIONAL){
         std::cout<<"x^4+("<<ce[0]<<")*x^3+("<<ce[1]<<")*x^2+("<<ce[2]<<")*x+("<<ce[3]<<")==0"<<std::endl;
     }
 
@@ -717,13 +736,10 @@ std::vector<double> RS_Math::quarticSolver(const std::vector<double>& ce)
         return ans;
     }
     if ( std::abs(r)< 1.0e-75 ) {
-        std::vector<double> cubic(3,0.);
-        cubic[1]=p;
-        cubic[2]=q;
         ans.push_back(0.);
-		auto r=cubicSolver(cubic);
-		std::copy(r.begin(),r.end(), std::back_inserter(ans));
-        for(size_t i=0; i<ans.size(); i++) ans[i] -= shift;
+		for (double x: cubicSolver(std::array<double, 3>{0., p, q}))
+			ans.push_back(x);
+        for(double& x: ans) x -= shift;
         return ans;
     }
     // depressed quartic to two quadratic equations
@@ -737,11 +753,7 @@ std::vector<double> RS_Math::quarticSolver(const std::vector<double>& ce)
     //  y=u^2,
     //  y^3 + 2 p y^2 + ( p^2 - 4 r) y - q^2 =0
     //
-    std::vector<double> cubic(3,0.);
-    cubic[0]=2.*p;
-    cubic[1]=p*p-4.*r;
-    cubic[2]=-q*q;
-	auto r3= cubicSolver(cubic);
+	auto r3= cubicSolver(std::array<double, 3>{2.*p, p*p-4.*r, -q*q});
     if (r3.empty())
         return {};
     //std::cout<<"quartic_solver:: real roots from cubic: "<<ret<<std::endl;
@@ -755,14 +767,9 @@ std::vector<double> RS_Math::quarticSolver(const std::vector<double>& ce)
             return ans;
         }
         double sqrtz0=sqrt(r3[0]);
-        std::vector<double> ce2(2,0.);
-        ce2[0]=	-sqrtz0;
-        ce2[1]=0.5*(p+r3[0])+0.5*q/sqrtz0;
-        auto r1=quadraticSolver(ce2);
+        auto r1=quadraticSolver(std::array<double, 2>{-sqrtz0, 0.5*(p+r3[0])+0.5*q/sqrtz0});
         if (r1.size()==0 ) {
-            ce2[0]=	sqrtz0;
-            ce2[1]=0.5*(p+r3[0])-0.5*q/sqrtz0;
-            r1=quadraticSolver(ce2);
+            r1=quadraticSolver(std::array<double, 2>{sqrtz0, 0.5*(p+r3[0])-0.5*q/sqrtz0});
         }
 		for(auto& x: r1){
 			x -= shift;
@@ -771,14 +778,9 @@ std::vector<double> RS_Math::quarticSolver(const std::vector<double>& ce)
     }
     if ( r3[0]> 0. && r3[1] > 0. ) {
         double sqrtz0=sqrt(r3[0]);
-        std::vector<double> ce2(2,0.);
-        ce2[0]=	-sqrtz0;
-        ce2[1]=0.5*(p+r3[0])+0.5*q/sqrtz0;
-        ans=quadraticSolver(ce2);
-        ce2[0]=	sqrtz0;
-        ce2[1]=0.5*(p+r3[0])-0.5*q/sqrtz0;
-		auto r1=quadraticSolver(ce2);
-		std::copy(r1.begin(),r1.end(),std::back_inserter(ans));
+        ans=quadraticSolver(std::array<double, 2>{-sqrtz0, 0.5*(p+r3[0])+0.5*q/sqrtz0});
+		for (double x: quadraticSolver(std::array<double, 2>{sqrtz0, 0.5*(p+r3[0])-0.5*q/sqrtz0}))
+			ans.push_back(x);
 		for(auto& x: ans){
 			x -= shift;
 		}
@@ -803,21 +805,34 @@ std::vector<double> RS_Math::quarticSolver(const std::vector<double>& ce)
 }
 
 /** quartic solver
-* ce[4] x^4 + ce[3] x^3 + ce[2] x^2 + ce[1] x + ce[0] = 0
-@ce, a vector of size 5 contains the coefficient in order
+* x^4 + ce[0] x^3 + ce[1] x^2 + ce[2] x + ce[3] = 0
+@ce, a vector of size 4 contains the coefficient in order
 @return, a vector contains real roots
+**/
+std::vector<double> RS_Math::quarticSolver(const std::vector<double>& ce)
+{
+    if(RS_DEBUG->getLevel()>=RS_Debug::D_INFORMATIONAL){
+		DEBUG_HEADER
+        std::cout<<"expected array size=4, got "<<ce.size()<<std::endl;
+    }
+    if(ce.size() != 4) return {};
+    return quarticSolver(std::array<double, 4>{ce[0], ce[1], ce[2], ce[3]});
+}
+
+/** quartic solver
+* ce[4] x^4 + ce[3] x^3 + ce[2] x^2 + ce[1] x + ce[0] = 0
+@ce, the coefficients in order
+@return, the real roots
 *ToDo, need a robust algorithm to locate zero terms, better handling of tolerances
 **/
-std::vector<double> RS_Math::quarticSolverFull(const std::vector<double>& ce)
+RS_Math::Roots RS_Math::quarticSolverFull(const std::array<double, 5>& ce)
 {
     if(RS_DEBUG->getLevel()>=RS_Debug::D_INFORMATIONAL){
 		DEBUG_HEADER
         std::cout<<ce[4]<<"*y^4+("<<ce[3]<<")*y^3+("<<ce[2]<<"*y^2+("<<ce[1]<<")*y+("<<ce[0]<<")==0"<<std::endl;
     }
 
-    std::vector<double> roots(0,0.);
-    if(ce.size()!=5) return roots;
-    std::vector<double> ce2(4,0.);
+    Roots roots;
 
     if ( std::abs(ce[4]) < 1.0e-14) { // this should not happen
         if ( std::abs(ce[3]) < 1.0e-14) { // this should not happen
@@ -828,33 +843,24 @@ std::vector<double> RS_Math::quarticSolverFull(const std::vector<double>& ce)
                     return roots;
                 }
             } else {
-                ce2.resize(2);
-                ce2[0]=ce[1]/ce[2];
-                ce2[1]=ce[0]/ce[2];
+                const std::array<double, 2> ce2{ce[1]/ce[2], ce[0]/ce[2]};
                 //std::cout<<"ce2[2]={ "<<ce2[0]<<' '<<ce2[1]<<" }\n";
                 roots=RS_Math::quadraticSolver(ce2);
             }
         } else {
-            ce2.resize(3);
-            ce2[0]=ce[2]/ce[3];
-            ce2[1]=ce[1]/ce[3];
-            ce2[2]=ce[0]/ce[3];
+            const std::array<double, 3> ce2{ce[2]/ce[3], ce[1]/ce[3], ce[0]/ce[3]};
             //std::cout<<"ce2[3]={ "<<ce2[0]<<' '<<ce2[1]<<' '<<ce2[2]<<" }\n";
             roots=RS_Math::cubicSolver(ce2);
         }
     } else {
-        ce2[0]=ce[3]/ce[4];
-        ce2[1]=ce[2]/ce[4];
-        ce2[2]=ce[1]/ce[4];
-        ce2[3]=ce[0]/ce[4];
+        const std::array<double, 4> ce2{ce[3]/ce[4], ce[2]/ce[4], ce[1]/ce[4], ce[0]/ce[4]};
         if(RS_DEBUG->getLevel()>=RS_Debug::D_INFORMATIONAL){
 			DEBUG_HEADER
             std::cout<<"ce2[4]={ "<<ce2[0]<<' '<<ce2[1]<<' '<<ce2[2]<<' '<<ce2[3]<<" }\n";
         }
         if(std::abs(ce2[3])<= RS_TOLERANCE15) {
             //constant term is zero, factor 0 out, solve a cubic equation
-            ce2.resize(3);
-            roots=RS_Math::cubicSolver(ce2);
+            roots=RS_Math::cubicSolver(std::array<double, 3>{ce2[0], ce2[1], ce2[2]});
             roots.push_back(0.);
         }else
             roots=RS_Math::quarticSolver(ce2);
@@ -862,6 +868,12 @@ std::vector<double> RS_Math::quarticSolverFull(const std::vector<double>& ce)
     return roots;
 }
 
+std::vector<double> RS_Math::quarticSolverFull(const std::vector<double>& ce)
+{
+    if(ce.size()!=5) return {};
+    return quarticSolverFull(std::array<double, 5>{ce[0], ce[1], ce[2], ce[3], ce[4]});
+}
+
 //linear Equation solver by Gauss-Jordan
 /**
   * Solve linear equation set
@@ -989,59 +1001,113 @@ double RS_Math::ellipticIntegral_2(const double& k, const double& phi)
     }
 }
 
-/** solver quadratic simultaneous equations of set two **/
-/* solve the following quadratic simultaneous equations,
-  *  ma000 x^2 + ma011 y^2 - 1 =0
-  * ma100 x^2 + 2 ma101 xy + ma111 y^2 + mb10 x + mb11 y +mc1 =0
-  *
-  *@m, a vector of size 8 contains coefficients in the strict order of:
-  ma000 ma011 ma100 ma101 ma111 mb10 mb11 mc1
-  * m[0] m[1] must be positive
-  *@return a vector contains real roots
-  */
-RS_VectorSolutions RS_Math::simultaneousQuadraticSolver(const std::vector<double>& m)
+namespace {
+/**
+ * solves the 2x2 linear system of the Newton steps, without allocations
+ * a0 x + b0 y = c0
+ * a1 x + b1 y = c1
+ * by Gauss-Jordan elimination with partial pivoting, as linearSolver()
+ *@return false, for a singular matrix
+ */
+bool solveLinear2(double a0, double b0, double c0,
+                  double a1, double b1, double c1, RS_Vector& sn)
 {
-    RS_VectorSolutions ret(0);
-    if(m.size() != 8 ) return ret; // valid m should contain exact 8 elements
-    std::vector< double> c1(0,0.);
-    std::vector< std::vector<double> > m1(0,c1);
-    c1.resize(6);
-    c1[0]=m[0];
-    c1[1]=0.;
-    c1[2]=m[1];
-    c1[3]=0.;
-    c1[4]=0.;
-    c1[5]=-1.;
-    m1.push_back(c1);
-    c1[0]=m[2];
-    c1[1]=2.*m[3];
-    c1[2]=m[4];
-    c1[3]=m[5];
-    c1[4]=m[6];
-    c1[5]=m[7];
-    m1.push_back(c1);
+    if (std::abs(a1) > std::abs(a0)) {
+        std::swap(a0, a1);
+        std::swap(b0, b1);
+        std::swap(c0, c1);
+    }
+    if (std::abs(a0) < RS_TOLERANCE)
+        return false;
+    b0 /= a0;
+    c0 /= a0;
+    b1 -= b0*a1;
+    c1 -= c0*a1;
+    if (std::abs(b1) < RS_TOLERANCE)
+        return false;
+    sn.y = c1/b1;
+    sn.x = c0 - b0*sn.y;
+    sn.valid = true;
+    return true;
+}
 
-    return simultaneousQuadraticSolverFull(m1);
+template <typename Matrix>
+bool verifyQuadratics(const Matrix& m, RS_Vector& v)
+{
+	RS_Vector v0=v;
+	auto& a=m[0][0];
+	auto& b=m[0][1];
+	auto& c=m[0][2];
+	auto& d=m[0][3];
+	auto& e=m[0][4];
+	auto& f=m[0][5];
+
+	auto& g=m[1][0];
+	auto& h=m[1][1];
+	auto& i=m[1][2];
+	auto& j=m[1][3];
+	auto& k=m[1][4];
+	auto& l=m[1][5];
+    /**
+      * tolerance test for bug#3606099
+      * verifying the equations to floating point tolerance by terms
+      */
+	double sum0=0., sum1=0.;
+	double f00=0.,f01=0.;
+	double amax0, amax1;
+	for(size_t i0=0; i0<20; ++i0){
+		double& x=v.x;
+		double& y=v.y;
+		double x2=x*x;
+		double y2=y*y;
+		double const terms0[12]={ a*x2, b*x*y, c*y2, d*x, e*y, f, g*x2, h*x*y, i*y2, j*x, k*y, l};
+        amax0=std::abs(terms0[0]), amax1=std::abs(terms0[6]);
+		const double px0=2.*a*x+b*y+d;
+		const double py0=b*x+2.*c*y+e;
+		sum0=0.;
+		for(int i=0; i<6; i++) {
+            if(amax0<std::abs(terms0[i])) amax0=std::abs(terms0[i]);
+			sum0 += terms0[i];
+		}
+		const double px1=2.*g*x+h*y+j;
+		const double py1=h*x+2.*i*y+k;
+		sum1=0.;
+		for(int i=6; i<12; i++) {
+            if(amax1<std::abs(terms0[i])) amax1=std::abs(terms0[i]);
+			sum1 += terms0[i];
+		}
+		RS_Vector dn;
+		bool ret=solveLinear2(px0, py0, sum0, px1, py1, sum1, dn);
+//		DEBUG_HEADER
+//		qDebug()<<"i0="<<i0<<"\tf=("<<sum0<<','<<sum1<<")\tdn=("<<dn[0]<<","<<dn[1]<<")";
+		if(!i0){
+			f00=sum0;
+			f01=sum1;
+		}
+		if(!ret) break;
+		v -= dn;
+	}
+    if( std::abs(sum0)> std::abs(f00) && std::abs(sum1)>std::abs(f01)){
+		v=v0;
+		sum0=f00;
+		sum1=f01;
+	}
+
+//    DEBUG_HEADER
+//    std::cout<<"verifying: x="<<x<<"\ty="<<y<<std::endl;
+//    std::cout<<"0: maxterm: "<<amax0<<std::endl;
+//    std::cout<<"verifying: std::abs(a*x2 + b*x*y+c*y2+d*x+e*y+f)/maxterm="<<std::abs(sum0)/amax0<<" required to be smaller than "<<sqrt(6.)*sqrt(DBL_EPSILON)<<std::endl;
+//    std::cout<<"1: maxterm: "<<amax1<<std::endl;
+//    std::cout<<"verifying: std::abs(g*x2+h*x*y+i*y2+j*x+k*y+l)/maxterm="<< std::abs(sum1)/amax1<<std::endl;
+    const double tols=2.*sqrt(6.)*sqrt(DBL_EPSILON); //experimental tolerances to verify simultaneous quadratic
+
+    return (amax0<=tols || std::abs(sum0)/amax0<tols) &&  (amax1<=tols || std::abs(sum1)/amax1<tols);
 }
 
-/** solver quadratic simultaneous equations of a set of two **/
-/* solve the following quadratic simultaneous equations,
-  * ma000 x^2 + ma001 xy + ma011 y^2 + mb00 x + mb01 y + mc0 =0
-  * ma100 x^2 + ma101 xy + ma111 y^2 + mb10 x + mb11 y + mc1 =0
-  *
-  *@m, a vector of size 2 each contains a vector of size 6 coefficients in the strict order of:
-  ma000 ma001 ma011 mb00 mb01 mc0
-  ma100 ma101 ma111 mb10 mb11 mc1
-  *@return a RS_VectorSolutions contains real roots (x,y)
-  */
-RS_VectorSolutions RS_Math::simultaneousQuadraticSolverFull(const std::vector<std::vector<double> >& m)
+template <typename Matrix>
+RS_VectorSolutions solveQuadratics(const Matrix& m)
 {
     RS_VectorSolutions ret;
-    if(m.size()!=2)  return ret;
-    if( m[0].size() ==3 || m[1].size()==3 ){
-        return simultaneousQuadraticSolverMixed(m);
-    }
-    if(m[0].size()!=6 || m[1].size()!=6) return ret;
     /** eliminate x, quartic equation of y **/
     auto& a=m[0][0];
     auto& b=m[0][1];
@@ -1087,7 +1153,7 @@ RS_VectorSolutions RS_Math::simultaneousQuadraticSolverFull(const std::vector<st
     double  j2=j*j;
     double  k2=k*k;
     double  l2=l*l;
-    std::vector<double> qy(5,0.);
+    std::array<double, 5> qy{};
     //y^4
     qy[4]=-c2*g2 + b*c*g*h - a*c*h2 - b2*g*i + 2.*a*c*g*i + a*b*h*i - a2*i2;
     //y^3
@@ -1108,7 +1174,7 @@ RS_VectorSolutions RS_Math::simultaneousQuadraticSolverFull(const std::vector<st
         std::cout<<qy[4]<<"*y^4 +("<<qy[3]<<")*y^3+("<<qy[2]<<")*y^2+("<<qy[1]<<")*y+("<<qy[0]<<")==0"<<std::endl;
 	}
     //quarticSolver
-	auto roots=quarticSolverFull(qy);
+	auto roots=RS_Math::quarticSolverFull(qy);
     if(RS_DEBUG->getLevel()>=RS_Debug::D_INFORMATIONAL){
         std::cout<<"roots.size()= "<<roots.size()<<std::endl;
     }
@@ -1116,7 +1182,7 @@ RS_VectorSolutions RS_Math::simultaneousQuadraticSolverFull(const std::vector<st
     if (roots.size()==0 ) { // no intersection found
         return ret;
     }
-    std::vector<double> ce(0,0.);
+    std::array<double, 3> ce{};
 
     for(size_t i0=0;i0<roots.size();i0++){
         if(RS_DEBUG->getLevel()>=RS_Debug::D_INFORMATIONAL){
@@ -1126,7 +1192,6 @@ RS_VectorSolutions RS_Math::simultaneousQuadraticSolverFull(const std::vector<st
         /*
           Collect[Eliminate[{ a*x^2 + b*x*y+c*y^2+d*x+e*y+f==0,g*x^2+h*x*y+i*y^2+j*x+k*y+l==0},x],y]
           */
-        ce.resize(3);
         ce[0]=a;
         ce[1]=b*roots[i0]+d;
         ce[2]=c*roots[i0]*roots[i0]+e*roots[i0]+f;
@@ -1143,22 +1208,20 @@ RS_VectorSolutions RS_Math::simultaneousQuadraticSolverFull(const std::vector<st
         if(std::abs(ce[0])<1e-75 && std::abs(ce[1])<1e-75) continue;
 
         if(std::abs(a)>1e-75){
-            std::vector<double> ce2(2,0.);
-            ce2[0]=ce[1]/ce[0];
-            ce2[1]=ce[2]/ce[0];
+            const std::array<double, 2> ce2{ce[1]/ce[0], ce[2]/ce[0]};
 //                DEBUG_HEADER
 //                        std::cout<<"x^2 +("<<ce2[0]<<")*x+("<<ce2[1]<<")==0"<<std::endl;
-			auto xRoots=quadraticSolver(ce2);
+			auto xRoots=RS_Math::quadraticSolver(ce2);
             for(size_t j0=0;j0<xRoots.size();j0++){
 //                DEBUG_HEADER
 //                std::cout<<"x="<<xRoots[j0]<<std::endl;
                 RS_Vector vp(xRoots[j0],roots[i0]);
-                if(simultaneousQuadraticVerify(m,vp)) ret.push_back(vp);
+                if(verifyQuadratics(m,vp)) ret.push_back(vp);
             }
             continue;
         }
         RS_Vector vp(-ce[2]/ce[1],roots[i0]);
-        if(simultaneousQuadraticVerify(m,vp)) ret.push_back(vp);
+        if(verifyQuadratics(m,vp)) ret.push_back(vp);
     }
 	if(RS_DEBUG->getLevel()>=RS_Debug::D_INFORMATIONAL){
 		DEBUG_HEADER
@@ -1166,6 +1229,52 @@ RS_VectorSolutions RS_Math::simultaneousQuadraticSolverFull(const std::vector<st
 	}
     return ret;
 }
+}
+
+/** solver quadratic simultaneous equations of set two **/
+/* solve the following quadratic simultaneous equations,
+  *  ma000 x^2 + ma011 y^2 - 1 =0
+  * ma100 x^2 + 2 ma101 xy + ma111 y^2 + mb10 x + mb11 y +mc1 =0
+  *
+  *@m, a vector of size 8 contains coefficients in the strict order of:
+  ma000 ma011 ma100 ma101 ma111 mb10 mb11 mc1
+  * m[0] m[1] must be positive
+  *@return a vector contains real roots
+  */
+RS_VectorSolutions RS_Math::simultaneousQuadraticSolver(const std::vector<double>& m)
+{
+    if(m.size() != 8 ) return RS_VectorSolutions(0); // valid m should contain exact 8 elements
+    const std::array<std::array<double, 6>, 2> m1{{
+        {m[0], 0., m[1], 0., 0., -1.},
+        {m[2], 2.*m[3], m[4], m[5], m[6], m[7]}
+    }};
+    return simultaneousQuadraticSolverFull(m1);
+}
+
+/** solver quadratic simultaneous equations of a set of two **/
+/* solve the following quadratic simultaneous equations,
+  * ma000 x^2 + ma001 xy + ma011 y^2 + mb00 x + mb01 y + mc0 =0
+  * ma100 x^2 + ma101 xy + ma111 y^2 + mb10 x + mb11 y + mc1 =0
+  *
+  *@m, a vector of size 2 each contains a vector of size 6 coefficients in the strict order of:
+  ma000 ma001 ma011 mb00 mb01 mc0
+  ma100 ma101 ma111 mb10 mb11 mc1
+  *@return a RS_VectorSolutions contains real roots (x,y)
+  */
+RS_VectorSolutions RS_Math::simultaneousQuadraticSolverFull(const std::vector<std::vector<double> >& m)
+{
+    if(m.size()!=2)  return RS_VectorSolutions();
+    if( m[0].size() ==3 || m[1].size()==3 ){
+        return simultaneousQuadraticSolverMixed(m);
+    }
+    if(m[0].size()!=6 || m[1].size()!=6) return RS_VectorSolutions();
+    return solveQuadratics(m);
+}
+
+RS_VectorSolutions RS_Math::simultaneousQuadraticSolverFull(const std::array<std::array<double, 6>, 2>& m)
+{
+    return solveQuadratics(m);
+}
 
 RS_VectorSolutions RS_Math::simultaneousQuadraticSolverMixed(const std::vector<std::vector<double> >& m)
 {
@@ -1244,76 +1353,11 @@ RS_VectorSolutions RS_Math::simultaneousQuadraticSolverMixed(const std::vector<s
   **/
 bool RS_Math::simultaneousQuadraticVerify(const std::vector<std::vector<double> >& m, RS_Vector& v)
 {
-	RS_Vector v0=v;
-	auto& a=m[0][0];
-	auto& b=m[0][1];
-	auto& c=m[0][2];
-	auto& d=m[0][3];
-	auto& e=m[0][4];
-	auto& f=m[0][5];
-
-	auto& g=m[1][0];
-	auto& h=m[1][1];
-	auto& i=m[1][2];
-	auto& j=m[1][3];
-	auto& k=m[1][4];
-	auto& l=m[1][5];
-    /**
-      * tolerance test for bug#3606099
-      * verifying the equations to floating point tolerance by terms
-      */
-	double sum0=0., sum1=0.;
-	double f00=0.,f01=0.;
-	double amax0, amax1;
-	for(size_t i0=0; i0<20; ++i0){
-		double& x=v.x;
-		double& y=v.y;
-		double x2=x*x;
-		double y2=y*y;
-		double const terms0[12]={ a*x2, b*x*y, c*y2, d*x, e*y, f, g*x2, h*x*y, i*y2, j*x, k*y, l};
-        amax0=std::abs(terms0[0]), amax1=std::abs(terms0[6]);
-		double px=2.*a*x+b*y+d;
-		double py=b*x+2.*c*y+e;
-		sum0=0.;
-		for(int i=0; i<6; i++) {
-            if(amax0<std::abs(terms0[i])) amax0=std::abs(terms0[i]);
-			sum0 += terms0[i];
-		}
-		std::vector<std::vector<double>> nrCe;
-		nrCe.push_back(std::vector<double>{px, py, sum0});
-		px=2.*g*x+h*y+j;
-		py=h*x+2.*i*y+k;
-		sum1=0.;
-		for(int i=6; i<12; i++) {
-            if(amax1<std::abs(terms0[i])) amax1=std::abs(terms0[i]);
-			sum1 += terms0[i];
-		}
-		nrCe.push_back(std::vector<double>{px, py, sum1});
-		std::vector<double> dn;
-		bool ret=linearSolver(nrCe, dn);
-//		DEBUG_HEADER
-//		qDebug()<<"i0="<<i0<<"\tf=("<<sum0<<','<<sum1<<")\tdn=("<<dn[0]<<","<<dn[1]<<")";
-		if(!i0){
-			f00=sum0;
-			f01=sum1;
-		}
-		if(!ret) break;
-		v -= RS_Vector(dn[0], dn[1]);
-	}
-    if( std::abs(sum0)> std::abs(f00) && std::abs(sum1)>std::abs(f01)){
-		v=v0;
-		sum0=f00;
-		sum1=f01;
-	}
-
-//    DEBUG_HEADER
-//    std::cout<<"verifying: x="<<x<<"\ty="<<y<<std::endl;
-//    std::cout<<"0: maxterm: "<<amax0<<std::endl;
-//    std::cout<<"verifying: std::abs(a*x2 + b*x*y+c*y2+d*x+e*y+f)/maxterm="<<std::abs(sum0)/amax0<<" required to be smaller than "<<sqrt(6.)*sqrt(DBL_EPSILON)<<std::endl;
-//    std::cout<<"1: maxterm: "<<amax1<<std::endl;
-//    std::cout<<"verifying: std::abs(g*x2+h*x*y+i*y2+j*x+k*y+l)/maxterm="<< std::abs(sum1)/amax1<<std::endl;
-    const double tols=2.*sqrt(6.)*sqrt(DBL_EPSILON); //experimental tolerances to verify simultaneous quadratic
+    return verifyQuadratics(m, v);
+}
 
-    return (amax0<=tols || std::abs(sum0)/amax0<tols) &&  (amax1<=tols || std::abs(sum1)/amax1<tols);
+bool RS_Math::simultaneousQuadraticVerify(const std::array<std::array<double, 6>, 2>& m, RS_Vector& v)
+{
+    return verifyQuadratics(m, v);
 }
 //EOF
@@ -27,7 +27,9 @@
 #ifndef RS_MATH_H
 #define RS_MATH_H
 
+#include <array>
 #include <cmath>
+#include <cstddef>
 #include <limits>
 #include <vector>
 
@@ -40,6 +42,32 @@ class QRegularExpressionMatch;
  * Math functions.
  */
 namespace RS_Math {
+/**
+ * @brief The Roots class, the real roots of a polynomial of degree up to 4,
+ * stored without heap allocation
+ */
+class Roots {
+public:
+    void push_back(double x) {
+        if (m_size < m_roots.size())
+            m_roots[m_size++] = x;
+    }
+    std::size_t size() const {return m_size;}
+    bool empty() const {return m_size == 0;}
+    double operator[](std::size_t i) const {return m_roots[i];}
+    double& operator[](std::size_t i) {return m_roots[i];}
+    double front() const {return m_roots.front();}
+    const double* begin() const {return m_roots.data();}
+    const double* end() const {return m_roots.data() + m_size;}
+    double* begin() {return m_roots.data();}
+    double* end() {return m_roots.data() + m_size;}
+    operator std::vector<double>() const {return {begin(), end()};}
+
+private:
+    std::array<double, 4> m_roots{};
+    std::size_t m_size = 0;
+};
+
 int round(double v);
 double round(const double v, const double precision);
 double pow(double x, double y);
@@ -82,6 +110,13 @@ double eval(const QString &expr, double def = 0.0);
 double eval(const QString &expr, bool *ok);
 //! \}
 
+//! \{ \brief the solvers of fixed size coefficients, without heap allocation, for inner loops
+Roots quadraticSolver(const std::array<double, 2> &ce);
+Roots cubicSolver(const std::array<double, 3> &ce);
+Roots quarticSolver(const std::array<double, 4> &ce);
+Roots quarticSolverFull(const std::array<double, 5> &ce);
+//! \}
+
 std::vector<double> quadraticSolver(const std::vector<double> &ce);
 std::vector<double> cubicSolver(const std::vector<double> &ce);
 /** quartic solver
@@ -129,6 +164,8 @@ RS_VectorSolutions simultaneousQuadraticSolver(const std::vector<double> &m);
       *@return a RS_VectorSolutions contains real roots (x,y)
       */
 RS_VectorSolutions simultaneousQuadraticSolverFull(const std::vector<std::vector<double> > &m);
+//! the same for two quadratics, without allocation of the coefficients
+RS_VectorSolutions simultaneousQuadraticSolverFull(const std::array<std::array<double, 6>, 2> &m);
 RS_VectorSolutions simultaneousQuadraticSolverMixed(const std::vector<std::vector<double> > &m);
 
 /** \brief verify simultaneousQuadraticVerify a solution for simultaneousQuadratic
@@ -137,6 +174,7 @@ RS_VectorSolutions simultaneousQuadraticSolverMixed(const std::vector<std::vecto
       *@return true, for a valid solution
       **/
 bool simultaneousQuadraticVerify(const std::vector<std::vector<double> > &m, RS_Vector &v);
+bool simultaneousQuadraticVerify(const std::array<std::array<double, 6>, 2> &m, RS_Vector &v);
 /** wrapper for elliptic integral **/
 /**
      * wrapper of elliptic integral of the second type, Legendre form
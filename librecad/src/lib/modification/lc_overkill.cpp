@@ -0,0 +1,412 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+#include "lc_overkill.h"
+#include "lc_taskscheduler.h"
+#include "rs.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
+#include "rs_line.h"
+#include "rs_modification.h"
+#include "rs_point.h"
+
+namespace {
+// lines normalized, and line buckets swept, per parallel task
+constexpr std::size_t parallelGrain = 1000;
+constexpr std::size_t parallelBucketGrain = 64;
+
+// entities are duplicates only with the same layer and pen, unless attributes are ignored
+struct Attributes {
+    const RS_Layer* layer = nullptr;
+    LC_PenTable::Handle pen = LC_PenTable::defaultHandle;
+
+    bool operator == (const Attributes& other) const
+    {
+        return layer == other.layer && pen == other.pen;
+    }
+    bool operator < (const Attributes& other) const
+    {
+        if (layer != other.layer)
+            return std::less<const RS_Layer*>{}(layer, other.layer);
+        return pen < other.pen;
+    }
+};
+
+Attributes getAttributes(const RS_Entity& entity, bool ignore)
+{
+    if (ignore)
+        return {};
+    return {entity.getLayer(false), entity.getPenHandle()};
+}
+
+// ------------------------------------------------------------------------------------- //
+// points, circles and arcs, by the grid cells of their positions and centers
+struct Cell {
+    Attributes attributes;
+    RS2::EntityType type = RS2::EntityUnknown;
+    std::int64_t x = 0;
+    std::int64_t y = 0;
+
+    bool operator == (const Cell& other) const
+    {
+        return attributes == other.attributes && type == other.type && x == other.x && y == other.y;
+    }
+};
+
+struct CellHash {
+    std::size_t operator()(const Cell& cell) const
+    {
+        std::size_t seed = std::hash<const void*>{}(cell.attributes.layer);
+        for (std::size_t value: {std::size_t(cell.attributes.pen), std::size_t(cell.type),
+                                 std::hash<std::int64_t>{}(cell.x), std::hash<std::int64_t>{}(cell.y)})
+            seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
+
+class RoundGrid {
+public:
+    RoundGrid(double tolerance, bool ignoreAttributes):
+        m_tolerance{tolerance}
+      , m_ignoreAttributes{ignoreAttributes}
+    {}
+
+    // whether the entity duplicates an entity added before, otherwise it's added
+    bool addUnique(RS_Entity* entity)
+    {
+        const RS_Vector position = getPosition(*entity);
+        Cell cell{getAttributes(*entity, m_ignoreAttributes), entity->rtti(),
+                  cellOf(position.x), cellOf(position.y)};
+        const std::int64_t cx = cell.x;
+        const std::int64_t cy = cell.y;
+        for (cell.x = cx - 1; cell.x <= cx + 1; ++cell.x) {
+            for (cell.y = cy - 1; cell.y <= cy + 1; ++cell.y) {
+                auto it = m_cells.find(cell);
+                if (it == m_cells.end())
+                    continue;
+                for (const RS_Entity* other: it->second) {
+                    if (isDuplicate(*entity, *other))
+                        return true;
+                }
+            }
+        }
+        cell.x = cx;
+        cell.y = cy;
+        m_cells[cell].push_back(entity);
+        return false;
+    }
+
+private:
+    static RS_Vector getPosition(const RS_Entity& entity)
+    {
+        if (entity.rtti() == RS2::EntityPoint)
+            return static_cast<const RS_Point&>(entity).getPos();
+        return entity.getCenter();
+    }
+
+    bool isNear(const RS_Vector& p0, const RS_Vector& p1) const
+    {
+        return p0.distanceTo(p1) <= m_tolerance;
+    }
+
+    // entities of the same type, with positions in neighbouring cells
+    bool isDuplicate(const RS_Entity& entity, const RS_Entity& other) const
+    {
+        if (!isNear(getPosition(entity), getPosition(other)))
+            return false;
+        switch (entity.rtti()) {
+        case RS2::EntityPoint:
+            return true;
+        case RS2::EntityCircle:
+            return std::abs(entity.getRadius() - other.getRadius()) <= m_tolerance;
+        case RS2::EntityArc:
+            // reversed arcs are duplicates, arcs sharing their end points only are not
+            return std::abs(entity.getRadius() - other.getRadius()) <= m_tolerance
+                    && isNear(entity.getMiddlePoint(), other.getMiddlePoint())
+                    && ((isNear(entity.getStartpoint(), other.getStartpoint())
+                         && isNear(entity.getEndpoint(), other.getEndpoint()))
+                        || (isNear(entity.getStartpoint(), other.getEndpoint())
+                            && isNear(entity.getEndpoint(), other.getStartpoint())));
+        default:
+            return false;
+        }
+    }
+
+    std::int64_t cellOf(double coordinate) const
+    {
+        // far away cells are merged, instead of overflowing
+        constexpr double limit = double(std::int64_t{1} << 62);
+        return std::int64_t(std::clamp(std::floor(coordinate / m_tolerance), -limit, limit));
+    }
+
+    const double m_tolerance;
+    const bool m_ignoreAttributes;
+    std::unordered_map<Cell, std::vector<RS_Entity*>, CellHash> m_cells;
+};
+
+// ------------------------------------------------------------------------------------- //
+// lines, by buckets of their directions and positions
+struct LineItem {
+    RS_Line* line = nullptr;
+    std::size_t order = 0;
+    Attributes attributes;
+    // the direction angle, in [-angleTolerance, pi - angleTolerance)
+    double angle = 0.;
+    // the position across the bucket direction, and the end positions along it
+    double offset = 0.;
+    double t0 = 0.;
+    double t1 = 0.;
+    // the end points at t0 and t1
+    RS_Vector p0;
+    RS_Vector p1;
+    // whether p0 is the end point of the line
+    bool reversed = false;
+};
+
+class LineSweep {
+public:
+    LineSweep(std::vector<LineItem>& items, double tolerance, bool mergeOverlaps):
+        m_items{items}
+      , m_tolerance{tolerance}
+      , m_mergeOverlaps{mergeOverlaps}
+    {}
+
+    // the lines of a bucket of the same direction and attributes
+    void sweepBucket(std::size_t first, std::size_t last, LC_Overkill::Result& result) const
+    {
+        const RS_Vector direction{m_items[first].angle};
+        const RS_Vector normal{-direction.y, direction.x};
+        for (std::size_t i = first; i < last; ++i) {
+            LineItem& item = m_items[i];
+            const RS_Vector start = item.line->getStartpoint();
+            const RS_Vector end = item.line->getEndpoint();
+            item.offset = normal.dotP((start + end) * 0.5);
+            item.t0 = direction.dotP(start);
+            item.t1 = direction.dotP(end);
+            item.p0 = start;
+            item.p1 = end;
+            item.reversed = item.t0 > item.t1;
+            if (item.reversed) {
+                std::swap(item.t0, item.t1);
+                std::swap(item.p0, item.p1);
+            }
+        }
+        const auto begin = m_items.begin();
+        std::sort(begin + first, begin + last, [](const LineItem& a, const LineItem& b) {
+            return a.offset < b.offset;
+        });
+        // collinear lines
+        for (std::size_t i = first; i < last;) {
+            std::size_t j = i + 1;
+            while (j < last && m_items[j].offset - m_items[j - 1].offset <= m_tolerance)
+                ++j;
+            if (j - i > 1)
+                sweepLine(i, j, result);
+            i = j;
+        }
+    }
+
+private:
+    void sweepLine(std::size_t first, std::size_t last, LC_Overkill::Result& result) const
+    {
+        const auto begin = m_items.begin();
+        std::sort(begin + first, begin + last, [](const LineItem& a, const LineItem& b) {
+            return a.t0 < b.t0 || (a.t0 == b.t0 && a.order < b.order);
+        });
+        if (!m_mergeOverlaps) {
+            // lines covered by a line before
+            std::size_t cover = first;
+            for (std::size_t i = first + 1; i < last; ++i) {
+                if (m_items[i].t1 <= m_items[cover].t1 + m_tolerance) {
+                    result.removed.push_back(m_items[i].line);
+                    ++result.duplicates;
+                } else {
+                    cover = i;
+                }
+            }
+            return;
+        }
+        // groups of overlapping lines, lines touching at end points are not merged
+        std::size_t group = first;
+        double groupEnd = m_items[first].t1;
+        for (std::size_t i = first + 1; i <= last; ++i) {
+            if (i < last && m_items[i].t0 < groupEnd - m_tolerance) {
+                groupEnd = std::max(groupEnd, m_items[i].t1);
+                continue;
+            }
+            mergeGroup(group, i, result);
+            group = i;
+            if (i < last)
+                groupEnd = m_items[i].t1;
+        }
+    }
+
+    void mergeGroup(std::size_t first, std::size_t last, LC_Overkill::Result& result) const
+    {
+        if (last - first <= 1)
+            return;
+        std::size_t endItem = first;
+        std::size_t source = first;
+        for (std::size_t i = first + 1; i < last; ++i) {
+            if (m_items[i].t1 > m_items[endItem].t1)
+                endItem = i;
+            if (m_items[i].order < m_items[source].order)
+                source = i;
+        }
+        // a line covering the group is kept
+        const double groupStart = m_items[first].t0;
+        const double groupEnd = m_items[endItem].t1;
+        std::size_t cover = last;
+        for (std::size_t i = first; i < last; ++i) {
+            if (m_items[i].t0 <= groupStart + m_tolerance && m_items[i].t1 >= groupEnd - m_tolerance
+                    && (cover == last || m_items[i].order < m_items[cover].order))
+                cover = i;
+        }
+        if (cover != last) {
+            for (std::size_t i = first; i < last; ++i) {
+                if (i != cover)
+                    result.removed.push_back(m_items[i].line);
+            }
+            result.duplicates += last - first - 1;
+            return;
+        }
+        // merged in the direction of the source line
+        LC_Overkill::Merge merge{m_items[source].line, m_items[first].p0, m_items[endItem].p1};
+        if (m_items[source].reversed)
+            std::swap(merge.start, merge.end);
+        result.merges.push_back(merge);
+        for (std::size_t i = first; i < last; ++i)
+            result.removed.push_back(m_items[i].line);
+        result.mergedLines += last - first;
+    }
+
+    std::vector<LineItem>& m_items;
+    const double m_tolerance;
+    const bool m_mergeOverlaps;
+};
+
+void append(LC_Overkill::Result& result, LC_Overkill::Result&& part)
+{
+    result.removed.insert(result.removed.end(), part.removed.begin(), part.removed.end());
+    result.merges.insert(result.merges.end(), part.merges.begin(), part.merges.end());
+    result.zeroLength += part.zeroLength;
+    result.duplicates += part.duplicates;
+    result.mergedLines += part.mergedLines;
+}
+}
+
+LC_Overkill::Result LC_Overkill::find(const std::vector<RS_Entity*>& entities, const RS_OverkillData& data)
+{
+    Result result;
+    const double tolerance = std::max(data.tolerance, RS_TOLERANCE);
+    RoundGrid grid{tolerance, data.ignoreAttributes};
+    std::vector<LineItem> lines;
+    double maxLength = 0.;
+    for (std::size_t i = 0; i < entities.size(); ++i) {
+        RS_Entity* entity = entities[i];
+        switch (entity->rtti()) {
+        case RS2::EntityLine: {
+            const double length = entity->getLength();
+            if (length <= tolerance)
+                break;
+            maxLength = std::max(maxLength, length);
+            lines.push_back({static_cast<RS_Line*>(entity), i, getAttributes(*entity, data.ignoreAttributes)});
+            continue;
+        }
+        case RS2::EntityCircle:
+            if (entity->getRadius() <= tolerance)
+                break;
+            if (grid.addUnique(entity)) {
+                result.removed.push_back(entity);
+                ++result.duplicates;
+            }
+            continue;
+        case RS2::EntityArc:
+            if (entity->getRadius() <= tolerance || entity->getLength() <= tolerance)
+                break;
+            [[fallthrough]];
+        case RS2::EntityPoint:
+            if (grid.addUnique(entity)) {
+                result.removed.push_back(entity);
+                ++result.duplicates;
+            }
+            continue;
+        default:
+            continue;
+        }
+        // zero length
+        result.removed.push_back(entity);
+        ++result.zeroLength;
+    }
+    if (lines.size() < 2)
+        return result;
+
+    // collinear within the tolerance over the longest line
+    const double angleTolerance = tolerance / maxLength;
+    LC_TaskScheduler& scheduler = LC_TaskScheduler::instance();
+    scheduler.parallelFor(0, lines.size(), parallelGrain, [&lines, angleTolerance](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const RS_Vector delta = lines[i].line->getEndpoint() - lines[i].line->getStartpoint();
+            double angle = std::atan2(delta.y, delta.x);
+            if (angle < 0.)
+                angle += M_PI;
+            // directions near pi are bucketed with directions near 0
+            if (angle >= M_PI - angleTolerance)
+                angle -= M_PI;
+            lines[i].angle = angle;
+        }
+    });
+    std::sort(lines.begin(), lines.end(), [](const LineItem& a, const LineItem& b) {
+        if (!(a.attributes == b.attributes))
+            return a.attributes < b.attributes;
+        return a.angle < b.angle;
+    });
+    std::vector<std::pair<std::size_t, std::size_t>> buckets;
+    for (std::size_t i = 0; i < lines.size();) {
+        std::size_t j = i + 1;
+        while (j < lines.size() && lines[j].attributes == lines[i].attributes
+               && lines[j].angle - lines[j - 1].angle <= angleTolerance)
+            ++j;
+        if (j - i > 1)
+            buckets.emplace_back(i, j);
+        i = j;
+    }
+
+    const LineSweep sweep{lines, tolerance, data.mergeOverlaps};
+    std::vector<Result> bucketResults(buckets.size());
+    scheduler.parallelFor(0, buckets.size(), parallelBucketGrain,
+                          [&sweep, &buckets, &bucketResults](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            sweep.sweepBucket(buckets[i].first, buckets[i].second, bucketResults[i]);
+    });
+    for (Result& part: bucketResults)
+        append(result, std::move(part));
+    return result;
+}
@@ -0,0 +1,77 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_OVERKILL_H
+#define LC_OVERKILL_H
+
+#include <cstddef>
+#include <vector>
+
+#include "rs_vector.h"
+
+class RS_Entity;
+class RS_Line;
+struct RS_OverkillData;
+
+/**
+ * @brief The LC_Overkill class, finds the duplicate, overlapping and zero length
+ * entities of a set, as imported survey and CAM drawings have in masses.
+ *
+ * Points, circles and arcs are hashed by grid cells of the tolerance on their
+ * positions and centers, and compared to the earlier entities of the neighbouring
+ * cells. Lines are sorted by their directions into buckets of collinear lines, which
+ * are swept in the order of their positions along the direction, so each bucket is
+ * handled in O(n log n); buckets are swept concurrently.
+ *
+ * Entities are compared by geometry, and by layer and pen, unless attributes are
+ * ignored. Other entity types are not changed.
+ */
+class LC_Overkill {
+public:
+    /** a line replacing overlapping collinear lines */
+    struct Merge {
+        //! the line to copy the attributes from, one of the lines replaced
+        const RS_Line* source = nullptr;
+        RS_Vector start;
+        RS_Vector end;
+    };
+
+    struct Result {
+        //! entities to remove: zero length and duplicates, and the lines replaced by merges
+        std::vector<RS_Entity*> removed;
+        std::vector<Merge> merges;
+        std::size_t zeroLength = 0;
+        std::size_t duplicates = 0;
+        //! the number of lines replaced by merges
+        std::size_t mergedLines = 0;
+    };
+
+    /**
+     * @brief find the entities to remove and the lines to merge
+     * @param entities - the entities to clean up, earlier entities are kept over later duplicates
+     */
+    static Result find(const std::vector<RS_Entity*>& entities, const RS_OverkillData& data);
+};
+
+#endif // LC_OVERKILL_H
@@ -0,0 +1,881 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include "lc_polylineoffset.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+#include <QThreadPool>
+
+#include "rs_arc.h"
+#include "rs_debug.h"
+#include "rs_math.h"
+#include "rs_polyline.h"
+
+namespace {
+// segments shorter than this are skipped
+constexpr double zeroLength = 1.0e-12;
+// points nearer than this are the same join or intersection point
+constexpr double pointTolerance = 1.0e-8;
+// a join intersection farther from the vertex than this times the distance is replaced by an arc
+constexpr double miterLimit = 10.;
+// from this number of segments to offset in total on, offsets are computed concurrently
+constexpr std::size_t parallelOffsetMinimum = 10000;
+
+using Vertex = LC_PolylineOffset::Vertex;
+using Path = LC_PolylineOffset::Path;
+
+double cross(const RS_Vector& a, const RS_Vector& b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+/** a line segment, or an arc segment when its sweep isn't zero */
+struct Segment {
+    RS_Vector start;
+    RS_Vector end;
+    RS_Vector center;
+    double radius = 0.;
+    double startAngle = 0.;
+    // signed, counterclockwise positive
+    double sweep = 0.;
+
+    Segment(const RS_Vector& startPoint, const RS_Vector& endPoint, double bulge = 0.):
+        start{startPoint}
+      , end{endPoint}
+    {
+        if (std::abs(bulge) < RS_TOLERANCE)
+            return;
+        const RS_Vector chord = end - start;
+        center = start + chord * 0.5 + RS_Vector{-chord.y, chord.x} * ((1. - bulge * bulge) / (4. * bulge));
+        radius = center.distanceTo(start);
+        startAngle = center.angleTo(start);
+        sweep = 4. * std::atan(bulge);
+    }
+
+    static Segment circle(const RS_Vector& center, double radius)
+    {
+        Segment circle{center + RS_Vector{radius, 0.}, center + RS_Vector{radius, 0.}};
+        circle.center = center;
+        circle.radius = radius;
+        circle.sweep = 2. * M_PI;
+        return circle;
+    }
+
+    bool isArc() const
+    {
+        return sweep != 0.;
+    }
+
+    double getBulge() const
+    {
+        return std::tan(sweep / 4.);
+    }
+
+    double paramOfAngle(double angle) const
+    {
+        return (std::remainder(angle - startAngle - 0.5 * sweep, 2. * M_PI) + 0.5 * sweep) / sweep;
+    }
+
+    /** @return the parameter of the nearest point on the curve of the segment, 0 at start and 1 at end */
+    double paramOf(const RS_Vector& point) const
+    {
+        if (isArc())
+            return paramOfAngle(center.angleTo(point));
+        const RS_Vector chord = end - start;
+        const double length2 = chord.squared();
+        return length2 > RS_TOLERANCE2 ? RS_Vector::dotP(point - start, chord) / length2 : 0.;
+    }
+
+    RS_Vector pointAt(double t) const
+    {
+        if (isArc())
+            return center + RS_Vector::polar(radius, startAngle + sweep * t);
+        return start + (end - start) * t;
+    }
+
+    RS_Vector getNearestPoint(const RS_Vector& point) const
+    {
+        const double t = paramOf(point);
+        if (t <= 0.)
+            return start;
+        if (t >= 1.)
+            return end;
+        return pointAt(t);
+    }
+
+    double distanceTo(const RS_Vector& point) const
+    {
+        return point.distanceTo(getNearestPoint(point));
+    }
+
+    double chordDistanceTo(const RS_Vector& point) const
+    {
+        const RS_Vector chord = end - start;
+        const double length2 = chord.squared();
+        const double t = length2 > RS_TOLERANCE2 ? RS_Vector::dotP(point - start, chord) / length2 : 0.;
+        return point.distanceTo(start + chord * std::clamp(t, 0., 1.));
+    }
+
+    /** @return the farthest distance of points of the segment from its chord, infinite for arcs over a half circle */
+    double getSagitta() const
+    {
+        if (std::abs(sweep) > M_PI)
+            return std::numeric_limits<double>::infinity();
+        return radius * (1. - std::cos(0.5 * sweep));
+    }
+
+    RS_Vector getTangent(double t) const
+    {
+        if (!isArc())
+            return end - start;
+        const double angle = startAngle + sweep * t;
+        return RS_Vector{-std::sin(angle), std::cos(angle)} * (sweep > 0. ? 1. : -1.);
+    }
+
+    std::pair<RS_Vector, RS_Vector> getBox() const
+    {
+        std::pair<RS_Vector, RS_Vector> box{RS_Vector::minimum(start, end), RS_Vector::maximum(start, end)};
+        if (isArc()) {
+            for (int quadrant = 0; quadrant < 4; ++quadrant) {
+                const double angle = quadrant * M_PI_2;
+                const double t = paramOfAngle(angle);
+                if (t > 0. && t < 1.) {
+                    const RS_Vector point = center + RS_Vector::polar(radius, angle);
+                    box = {RS_Vector::minimum(box.first, point), RS_Vector::maximum(box.second, point)};
+                }
+            }
+        }
+        return box;
+    }
+
+    /** @return the part of the segment from t0 to t1, starting at startPoint and ending at endPoint */
+    Segment getPart(double t0, double t1, const RS_Vector& startPoint, const RS_Vector& endPoint) const
+    {
+        Segment part = *this;
+        part.start = startPoint;
+        part.end = endPoint;
+        part.startAngle = startAngle + sweep * t0;
+        part.sweep = sweep * (t1 - t0);
+        return part;
+    }
+
+    /**
+     * Moves the segment to its left by the distance. An arc offset beyond its center is
+     * turned to the other side of the center, so its endpoints are still at the distance
+     * from the original endpoints; it's clipped with the pieces near to the polyline.
+     * @return false when an arc collapsed to its center
+     */
+    bool offset(double distance)
+    {
+        if (!isArc()) {
+            const RS_Vector chord = end - start;
+            const RS_Vector normal = RS_Vector{-chord.y, chord.x} * (distance / chord.magnitude());
+            start += normal;
+            end += normal;
+            return true;
+        }
+        // the center of counterclockwise arcs is on their left
+        radius += sweep > 0. ? -distance : distance;
+        if (std::abs(radius) <= RS_TOLERANCE)
+            return false;
+        if (radius < 0.) {
+            radius = -radius;
+            startAngle += M_PI;
+        }
+        start = center + RS_Vector::polar(radius, startAngle);
+        end = center + RS_Vector::polar(radius, startAngle + sweep);
+        return true;
+    }
+
+    /** moves the endpoints along the curve of the segment, arcs keep the sweep direction nearest to theirs */
+    void setEndpoints(const RS_Vector& startPoint, const RS_Vector& endPoint)
+    {
+        start = startPoint;
+        end = endPoint;
+        if (isArc()) {
+            const double angle0 = center.angleTo(start);
+            const double angle1 = center.angleTo(end);
+            sweep += std::remainder(angle1 - angle0 - sweep, 2. * M_PI);
+            startAngle = angle0;
+        }
+    }
+};
+
+int intersectLineCircle(const Segment& line, const RS_Vector& center, double radius,
+                        std::array<RS_Vector, 2>& points)
+{
+    const RS_Vector direction = (line.end - line.start).normalized();
+    const RS_Vector foot = line.start + direction * RS_Vector::dotP(center - line.start, direction);
+    const double h2 = radius * radius - foot.squaredTo(center);
+    if (h2 < -RS_TOLERANCE * radius * radius)
+        return 0;
+    if (h2 <= RS_TOLERANCE * radius * radius) {
+        points[0] = foot;
+        return 1;
+    }
+    const double h = std::sqrt(h2);
+    points[0] = foot - direction * h;
+    points[1] = foot + direction * h;
+    return 2;
+}
+
+/** @return the number of intersections of the curves of the segments, the lines and circles */
+int intersect(const Segment& a, const Segment& b, std::array<RS_Vector, 2>& points)
+{
+    if (!a.isArc() && !b.isArc()) {
+        const RS_Vector d1 = a.end - a.start;
+        const RS_Vector d2 = b.end - b.start;
+        const double denominator = cross(d1, d2);
+        if (std::abs(denominator) <= RS_TOLERANCE * d1.magnitude() * d2.magnitude())
+            return 0;
+        points[0] = a.start + d1 * (cross(b.start - a.start, d2) / denominator);
+        return 1;
+    }
+    if (!a.isArc())
+        return intersectLineCircle(a, b.center, b.radius, points);
+    if (!b.isArc())
+        return intersectLineCircle(b, a.center, a.radius, points);
+
+    const RS_Vector d = b.center - a.center;
+    const double distance = d.magnitude();
+    if (distance <= RS_TOLERANCE)
+        return 0;
+    const double tolerance = RS_TOLERANCE * (a.radius + b.radius);
+    if (distance > a.radius + b.radius + tolerance || distance < std::abs(a.radius - b.radius) - tolerance)
+        return 0;
+    const double along = (a.radius * a.radius - b.radius * b.radius + distance * distance) / (2. * distance);
+    const RS_Vector foot = a.center + d * (along / distance);
+    const double h2 = a.radius * a.radius - along * along;
+    if (h2 <= tolerance * a.radius) {
+        points[0] = foot;
+        return 1;
+    }
+    const RS_Vector normal = RS_Vector{-d.y, d.x} * (std::sqrt(h2) / distance);
+    points[0] = foot - normal;
+    points[1] = foot + normal;
+    return 2;
+}
+
+/** @return the segments of the path, without the zero length ones */
+std::vector<Segment> getSegments(const Path& path)
+{
+    std::vector<Segment> segments;
+    const std::size_t n = path.vertices.size();
+    const std::size_t count = path.closed ? n : std::max<std::size_t>(n, 1) - 1;
+    segments.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Vertex& vertex = path.vertices[i];
+        const RS_Vector& next = path.vertices[(i + 1) % n].point;
+        if (vertex.point.distanceTo(next) > zeroLength)
+            segments.emplace_back(vertex.point, next, vertex.bulge);
+    }
+    return segments;
+}
+
+/**
+ * @brief The SegmentTree class, a tree of the segment boxes to find whether points are
+ * nearer to the segments than a distance, and whether other segments cross them.
+ */
+class SegmentTree {
+public:
+    explicit SegmentTree(const std::vector<Segment>& segments):
+        m_segments{segments}
+      , m_order(segments.size())
+    {
+        m_boxes.reserve(segments.size());
+        for (const Segment& segment: segments)
+            m_boxes.push_back(segment.getBox());
+        std::iota(m_order.begin(), m_order.end(), 0);
+        if (!segments.empty())
+            build(0, segments.size());
+    }
+
+    bool isNearer(const RS_Vector& point, double distance) const
+    {
+        return !m_nodes.empty() && isNearer(0, point, distance);
+    }
+
+    /**
+     * @return whether all the segment is nearer than the distance to one of the segments:
+     * as the distance to a line segment is convex, it holds when the endpoints are near
+     * to its chord, less the sagittas
+     */
+    bool isCovering(const Segment& segment, double distance) const
+    {
+        const double reach = distance - segment.getSagitta();
+        return reach > 0. && !m_nodes.empty() && isCovering(0, segment.start, segment.end, reach);
+    }
+
+    bool intersects(const Segment& segment) const
+    {
+        return !m_nodes.empty() && findIntersections(0, segment, segment.getBox(), nullptr);
+    }
+
+    /** adds the intersections of the segment with the segments of the tree to points */
+    void getIntersections(const Segment& segment, std::vector<RS_Vector>& points) const
+    {
+        if (!m_nodes.empty())
+            findIntersections(0, segment, segment.getBox(), &points);
+    }
+
+private:
+    static constexpr std::size_t leafSize = 8;
+
+    struct Node {
+        RS_Vector minV;
+        RS_Vector maxV;
+        std::size_t first = 0;
+        std::size_t last = 0;
+        std::size_t left = 0;
+        std::size_t right = 0;
+    };
+
+    std::size_t build(std::size_t first, std::size_t last)
+    {
+        const std::size_t index = m_nodes.size();
+        m_nodes.emplace_back();
+        Node node;
+        node.first = first;
+        node.last = last;
+        node.minV = m_boxes[m_order[first]].first;
+        node.maxV = m_boxes[m_order[first]].second;
+        for (std::size_t i = first + 1; i < last; ++i) {
+            node.minV = RS_Vector::minimum(node.minV, m_boxes[m_order[i]].first);
+            node.maxV = RS_Vector::maximum(node.maxV, m_boxes[m_order[i]].second);
+        }
+        if (last - first > leafSize) {
+            const bool alongX = node.maxV.x - node.minV.x >= node.maxV.y - node.minV.y;
+            const std::size_t middle = first + (last - first) / 2;
+            std::nth_element(m_order.begin() + first, m_order.begin() + middle, m_order.begin() + last,
+                             [this, alongX](std::size_t a, std::size_t b) {
+                const RS_Vector ca = m_boxes[a].first + m_boxes[a].second;
+                const RS_Vector cb = m_boxes[b].first + m_boxes[b].second;
+                return alongX ? ca.x < cb.x : ca.y < cb.y;
+            });
+            node.left = build(first, middle);
+            node.right = build(middle, last);
+        }
+        m_nodes[index] = node;
+        return index;
+    }
+
+    static double getDistanceSquared(const Node& node, const RS_Vector& point)
+    {
+        const double dx = std::max({node.minV.x - point.x, 0., point.x - node.maxV.x});
+        const double dy = std::max({node.minV.y - point.y, 0., point.y - node.maxV.y});
+        return dx * dx + dy * dy;
+    }
+
+    bool isNearer(std::size_t index, const RS_Vector& point, double distance) const
+    {
+        const Node& node = m_nodes[index];
+        if (getDistanceSquared(node, point) >= distance * distance)
+            return false;
+        if (node.left == node.right) {
+            for (std::size_t i = node.first; i < node.last; ++i) {
+                if (m_segments[m_order[i]].distanceTo(point) < distance)
+                    return true;
+            }
+            return false;
+        }
+        return isNearer(node.left, point, distance) || isNearer(node.right, point, distance);
+    }
+
+    bool isCovering(std::size_t index, const RS_Vector& start, const RS_Vector& end, double distance) const
+    {
+        const Node& node = m_nodes[index];
+        if (getDistanceSquared(node, start) >= distance * distance || getDistanceSquared(node, end) >= distance * distance)
+            return false;
+        if (node.left == node.right) {
+            for (std::size_t i = node.first; i < node.last; ++i) {
+                const Segment& segment = m_segments[m_order[i]];
+                const double reach = distance - segment.getSagitta();
+                if (segment.chordDistanceTo(start) < reach && segment.chordDistanceTo(end) < reach)
+                    return true;
+            }
+            return false;
+        }
+        return isCovering(node.left, start, end, distance) || isCovering(node.right, start, end, distance);
+    }
+
+    static bool overlaps(const RS_Vector& minV, const RS_Vector& maxV, const std::pair<RS_Vector, RS_Vector>& box)
+    {
+        return minV.x <= box.second.x + pointTolerance && maxV.x >= box.first.x - pointTolerance
+                && minV.y <= box.second.y + pointTolerance && maxV.y >= box.first.y - pointTolerance;
+    }
+
+    /** @return whether an intersection is found, all of them are searched for when points are given */
+    bool findIntersections(std::size_t index, const Segment& segment, const std::pair<RS_Vector, RS_Vector>& box,
+                           std::vector<RS_Vector>* found) const
+    {
+        const Node& node = m_nodes[index];
+        if (!overlaps(node.minV, node.maxV, box))
+            return false;
+        if (node.left != node.right) {
+            const bool left = findIntersections(node.left, segment, box, found);
+            return (left && found == nullptr) || findIntersections(node.right, segment, box, found) || left;
+        }
+        bool any = false;
+        std::array<RS_Vector, 2> points;
+        for (std::size_t i = node.first; i < node.last; ++i) {
+            const std::pair<RS_Vector, RS_Vector>& segmentBox = m_boxes[m_order[i]];
+            if (!overlaps(segmentBox.first, segmentBox.second, box))
+                continue;
+            const Segment& other = m_segments[m_order[i]];
+            const int count = intersect(segment, other, points);
+            for (int k = 0; k < count; ++k) {
+                if (segment.distanceTo(points[k]) <= pointTolerance && other.distanceTo(points[k]) <= pointTolerance) {
+                    if (found == nullptr)
+                        return true;
+                    found->push_back(points[k]);
+                    any = true;
+                }
+            }
+        }
+        return any;
+    }
+
+    const std::vector<Segment>& m_segments;
+    std::vector<std::pair<RS_Vector, RS_Vector>> m_boxes;
+    std::vector<std::size_t> m_order;
+    std::vector<Node> m_nodes;
+};
+
+/**
+ * Joins the offset segments b following a at the vertex of the polyline.
+ * @param turn the cross product of the polyline tangents before and after the vertex
+ * @return whether a connecting segment is needed, then set to connector
+ */
+bool join(Segment& a, Segment& b, const RS_Vector& vertex, double turn, double distance, Segment& connector)
+{
+    if (a.end.distanceTo(b.start) <= pointTolerance) {
+        b.setEndpoints(a.end, b.end);
+        return false;
+    }
+    // the intersection nearest to the vertex: lines may be extended towards it, arcs not,
+    // unless the vertex is concave and the intersection near to it
+    constexpr double paramTolerance = 1.0e-9;
+    const bool convex = distance > 0. ? turn < 0. : turn > 0.;
+    std::array<RS_Vector, 2> points;
+    const int count = intersect(a, b, points);
+    int best = -1;
+    double bestDistance = 0.;
+    for (int i = 0; i < count; ++i) {
+        const double ta = a.paramOf(points[i]);
+        const double tb = b.paramOf(points[i]);
+        const bool onSegments = ta >= -paramTolerance && (!a.isArc() || ta <= 1. + paramTolerance)
+                && tb <= 1. + paramTolerance && (!b.isArc() || tb >= -paramTolerance);
+        const double limit = onSegments ? miterLimit * std::abs(distance) : (convex ? -1. : 2. * std::abs(distance));
+        const double d = vertex.distanceTo(points[i]);
+        if (d <= limit && (best < 0 || d < bestDistance)) {
+            best = i;
+            bestDistance = d;
+        }
+    }
+    if (best >= 0) {
+        a.setEndpoints(a.start, points[best]);
+        b.setEndpoints(points[best], b.end);
+        return false;
+    }
+
+    // an arc around convex vertices; a line at concave ones, the loop it makes is clipped,
+    // and where a collapsed arc left no common vertex
+    const double tolerance = pointTolerance + RS_TOLERANCE * std::abs(distance);
+    connector = Segment{a.end, b.start};
+    if (convex && std::abs(vertex.distanceTo(a.end) - std::abs(distance)) <= tolerance
+            && std::abs(vertex.distanceTo(b.start) - std::abs(distance)) <= tolerance) {
+        connector.center = vertex;
+        connector.radius = std::abs(distance);
+        connector.startAngle = vertex.angleTo(a.end);
+        // the vertex is on the right of left offsets, so they turn around it clockwise
+        connector.sweep = std::remainder(vertex.angleTo(b.start) - connector.startAngle, 2. * M_PI);
+        if (distance > 0. && connector.sweep > 0.)
+            connector.sweep -= 2. * M_PI;
+        else if (distance < 0. && connector.sweep < 0.)
+            connector.sweep += 2. * M_PI;
+    }
+    return true;
+}
+
+/** @return the offset segments joined, the raw offset before clipping */
+std::vector<Segment> getJoinedOffset(const std::vector<Segment>& segments, bool closed, double distance)
+{
+    std::vector<Segment> offsets;
+    // the polyline segment of each offset segment
+    std::vector<const Segment*> originals;
+    offsets.reserve(segments.size());
+    originals.reserve(segments.size());
+    for (const Segment& segment: segments) {
+        Segment offset = segment;
+        if (offset.offset(distance)) {
+            offsets.push_back(offset);
+            originals.push_back(&segment);
+        }
+    }
+
+    const std::size_t n = offsets.size();
+    std::vector<std::pair<bool, Segment>> connectors(n, {false, Segment{RS_Vector{}, RS_Vector{}}});
+    const std::size_t joins = closed && n > 1 ? n : std::max<std::size_t>(n, 1) - 1;
+    for (std::size_t i = 0; i < joins; ++i) {
+        const std::size_t next = (i + 1) % n;
+        const double turn = cross(originals[i]->getTangent(1.), originals[next]->getTangent(0.));
+        connectors[i].first = join(offsets[i], offsets[next], originals[i]->end, turn, distance, connectors[i].second);
+    }
+
+    std::vector<Segment> joined;
+    joined.reserve(2 * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        joined.push_back(offsets[i]);
+        if (connectors[i].first)
+            joined.push_back(connectors[i].second);
+    }
+    // a closed offset ends exactly where it starts
+    if (closed && !joined.empty())
+        joined.back().setEndpoints(joined.back().start, joined.front().start);
+    return joined;
+}
+
+/**
+ * @return the offset path pieces, clipped where they are nearer to the polyline than the distance
+ * @param boundary the other curves bounding the region near to the polyline the offset may cross
+ */
+std::vector<Path> clipOffset(const std::vector<Segment>& offset, bool closed, const SegmentTree& tree,
+                             const SegmentTree* boundary, double distance)
+{
+    const std::size_t n = offset.size();
+    if (n == 0)
+        return {};
+
+    // the nodes of the offset: the joints of the segments, then the self intersections
+    std::vector<RS_Vector> nodes;
+    nodes.reserve(n + 1);
+    for (const Segment& segment: offset)
+        nodes.push_back(segment.start);
+    if (!closed)
+        nodes.push_back(offset.back().end);
+    const auto startNode = [](std::size_t i) {
+        return i;
+    };
+    const auto endNode = [n, closed](std::size_t i) {
+        return closed ? (i + 1) % n : i + 1;
+    };
+
+    // segments near to the polyline as a whole are clipped, and where they intersect
+    // other segments, these are near to it too: they are left out of the intersections
+    const double clipDistance = std::abs(distance) * (1. - 1.0e-6) - pointTolerance;
+    std::vector<bool> clipped(n);
+    for (std::size_t i = 0; i < n; ++i)
+        clipped[i] = tree.isCovering(offset[i], clipDistance);
+
+    // the self intersections, by a sweep over the segment boxes sorted by their left side
+    struct Split {
+        double t;
+        std::size_t node;
+    };
+    std::vector<std::vector<Split>> splits(n);
+    std::vector<std::pair<RS_Vector, RS_Vector>> boxes;
+    boxes.reserve(n);
+    for (const Segment& segment: offset)
+        boxes.push_back(segment.getBox());
+    std::vector<std::size_t> order;
+    order.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!clipped[i])
+            order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&boxes](std::size_t a, std::size_t b) {
+        return boxes[a].first.x < boxes[b].first.x;
+    });
+    std::vector<std::size_t> active;
+    std::array<RS_Vector, 2> points;
+    for (std::size_t i: order) {
+        const std::pair<RS_Vector, RS_Vector>& box = boxes[i];
+        active.erase(std::remove_if(active.begin(), active.end(), [&boxes, &box](std::size_t j) {
+            return boxes[j].second.x < box.first.x - pointTolerance;
+        }), active.end());
+        for (std::size_t j: active) {
+            if (boxes[j].second.y < box.first.y - pointTolerance || boxes[j].first.y > box.second.y + pointTolerance)
+                continue;
+            // neighbours meet at their joint, which is no intersection
+            const std::size_t first = std::min(i, j);
+            const std::size_t second = std::max(i, j);
+            RS_Vector joint{false};
+            if (second == first + 1)
+                joint = nodes[second];
+            else if (closed && first == 0 && second == n - 1)
+                joint = nodes[0];
+            const int count = intersect(offset[i], offset[j], points);
+            for (int k = 0; k < count; ++k) {
+                const RS_Vector& point = points[k];
+                if ((joint.valid && joint.distanceTo(point) <= pointTolerance)
+                        || offset[i].distanceTo(point) > pointTolerance
+                        || offset[j].distanceTo(point) > pointTolerance)
+                    continue;
+                const std::size_t node = nodes.size();
+                nodes.push_back(point);
+                splits[i].push_back({std::clamp(offset[i].paramOf(point), 0., 1.), node});
+                splits[j].push_back({std::clamp(offset[j].paramOf(point), 0., 1.), node});
+            }
+        }
+        active.push_back(i);
+    }
+    if (boundary != nullptr) {
+        std::vector<RS_Vector> crossings;
+        for (std::size_t i: order) {
+            crossings.clear();
+            boundary->getIntersections(offset[i], crossings);
+            for (const RS_Vector& point: crossings) {
+                splits[i].push_back({std::clamp(offset[i].paramOf(point), 0., 1.), nodes.size()});
+                nodes.push_back(point);
+            }
+        }
+    }
+
+    // the nodes at the same point are one, as an intersection may be at a joint
+    std::vector<std::size_t> merged(nodes.size());
+    std::iota(merged.begin(), merged.end(), 0);
+    const auto find = [&merged](std::size_t i) {
+        while (merged[i] != i)
+            i = merged[i] = merged[merged[i]];
+        return i;
+    };
+    std::vector<std::size_t> byX(nodes.size());
+    std::iota(byX.begin(), byX.end(), 0);
+    std::sort(byX.begin(), byX.end(), [&nodes](std::size_t a, std::size_t b) {
+        return nodes[a].x < nodes[b].x;
+    });
+    for (std::size_t a = 0; a < byX.size(); ++a) {
+        for (std::size_t b = a + 1; b < byX.size() && nodes[byX[b]].x - nodes[byX[a]].x <= pointTolerance; ++b) {
+            if (nodes[byX[a]].distanceTo(nodes[byX[b]]) <= pointTolerance)
+                merged[find(byX[b])] = find(byX[a]);
+        }
+    }
+
+    // the pieces between the nodes, kept when at the distance from the polyline: as
+    // pieces split at all the self intersections aren't crossed by the offset, sampling
+    // them and testing whether they cross the polyline tells whether they are there
+    const auto isValid = [&tree, clipDistance](const Segment& part) {
+        for (double t: {0.25, 0.5, 0.75}) {
+            if (tree.isNearer(part.pointAt(t), clipDistance))
+                return false;
+        }
+        return !tree.intersects(part);
+    };
+    struct Piece {
+        std::size_t from;
+        std::size_t to;
+        double bulge;
+    };
+    std::vector<Piece> pieces;
+    pieces.reserve(n + 2 * (nodes.size() - n));
+    for (std::size_t i: order) {
+        std::vector<Split>& segmentSplits = splits[i];
+        std::sort(segmentSplits.begin(), segmentSplits.end(), [](const Split& a, const Split& b) {
+            return a.t < b.t;
+        });
+        segmentSplits.push_back({1., endNode(i)});
+        Split previous{0., find(startNode(i))};
+        for (Split split: segmentSplits) {
+            split.node = find(split.node);
+            if (split.node != previous.node) {
+                const Segment part = offset[i].getPart(previous.t, split.t, nodes[previous.node], nodes[split.node]);
+                if (isValid(part))
+                    pieces.push_back({previous.node, split.node, part.getBulge()});
+            }
+            previous = split;
+        }
+    }
+    // overlapping segments give the same piece twice
+    std::sort(pieces.begin(), pieces.end(), [](const Piece& a, const Piece& b) {
+        return std::tie(a.from, a.to, a.bulge) < std::tie(b.from, b.to, b.bulge);
+    });
+    pieces.erase(std::unique(pieces.begin(), pieces.end(), [](const Piece& a, const Piece& b) {
+        return a.from == b.from && a.to == b.to && std::abs(a.bulge - b.bulge) <= RS_TOLERANCE;
+    }), pieces.end());
+
+    // chains the pieces at their nodes, starting with the open ends
+    std::vector<std::vector<std::size_t>> outgoing(nodes.size());
+    std::vector<unsigned> incoming(nodes.size(), 0);
+    for (std::size_t i = 0; i < pieces.size(); ++i) {
+        outgoing[pieces[i].from].push_back(i);
+        ++incoming[pieces[i].to];
+    }
+    std::vector<bool> used(pieces.size(), false);
+    std::vector<Path> paths;
+    const auto chain = [&](std::size_t first) {
+        Path path;
+        const std::size_t firstNode = pieces[first].from;
+        std::size_t node = firstNode;
+        std::size_t current = first;
+        for (;;) {
+            used[current] = true;
+            const Piece& piece = pieces[current];
+            path.vertices.push_back({nodes[piece.from], piece.bulge});
+            node = piece.to;
+            if (node == firstNode) {
+                path.closed = true;
+                break;
+            }
+            auto next = std::find_if(outgoing[node].cbegin(), outgoing[node].cend(), [&used](std::size_t i) {
+                return !used[i];
+            });
+            if (next == outgoing[node].cend())
+                break;
+            current = *next;
+        }
+        if (!path.closed)
+            path.vertices.push_back({nodes[node], 0.});
+        // the offset of a closed polyline is closed, the open rests are slivers of overlaps
+        if (path.vertices.size() >= 2 && (path.closed || !closed))
+            paths.push_back(std::move(path));
+    };
+    for (std::size_t i = 0; i < pieces.size(); ++i) {
+        if (!used[i] && incoming[pieces[i].from] == 0)
+            chain(i);
+    }
+    for (std::size_t i = 0; i < pieces.size(); ++i) {
+        if (!used[i])
+            chain(i);
+    }
+    return paths;
+}
+}
+
+LC_PolylineOffset::LC_PolylineOffset(const RS_Polyline& polyline)
+{
+    RS_Vector end{false};
+    for (const RS_Entity* entity: polyline) {
+        if (entity->getLength() <= zeroLength)
+            continue;
+        double bulge = 0.;
+        if (entity->rtti() == RS2::EntityArc)
+            bulge = static_cast<const RS_Arc*>(entity)->getBulge();
+        else if (entity->rtti() != RS2::EntityLine)
+            continue;
+        m_path.vertices.push_back({entity->getStartpoint(), bulge});
+        end = entity->getEndpoint();
+    }
+    m_path.closed = polyline.isClosed();
+    if (!m_path.closed && end.valid)
+        m_path.vertices.push_back({end, 0.});
+}
+
+LC_PolylineOffset::LC_PolylineOffset(std::vector<Vertex> vertices, bool closed):
+    m_path{std::move(vertices), closed}
+{}
+
+double LC_PolylineOffset::getSide(const RS_Vector& point) const
+{
+    const std::vector<Segment> segments = getSegments(m_path);
+    const Segment* nearest = nullptr;
+    double nearestDistance = 0.;
+    for (const Segment& segment: segments) {
+        const double d = segment.distanceTo(point);
+        if (nearest == nullptr || d < nearestDistance) {
+            nearest = &segment;
+            nearestDistance = d;
+        }
+    }
+    if (nearest == nullptr)
+        return 1.;
+    const double t = std::clamp(nearest->paramOf(point), 0., 1.);
+    return cross(nearest->getTangent(t), point - nearest->pointAt(t)) >= 0. ? 1. : -1.;
+}
+
+std::vector<LC_PolylineOffset::Path> LC_PolylineOffset::offset(double distance) const
+{
+    if (std::abs(distance) <= RS_TOLERANCE)
+        return {m_path};
+    const std::vector<Segment> segments = getSegments(m_path);
+    if (segments.empty())
+        return {};
+    const SegmentTree tree{segments};
+    const std::vector<Segment> joined = getJoinedOffset(segments, m_path.closed, distance);
+    if (m_path.closed)
+        return clipOffset(joined, true, tree, nullptr, distance);
+
+    // the offset of an open polyline may turn around its ends to its other side, where the
+    // region near to it is bounded by the offset to the other side and the circles at the ends
+    std::vector<Segment> boundary = getJoinedOffset(segments, false, -distance);
+    boundary.push_back(Segment::circle(segments.front().start, std::abs(distance)));
+    boundary.push_back(Segment::circle(segments.back().end, std::abs(distance)));
+    const SegmentTree boundaryTree{boundary};
+    return clipOffset(joined, false, tree, &boundaryTree, distance);
+}
+
+std::vector<std::vector<LC_PolylineOffset::Path>> LC_PolylineOffset::offset(const std::vector<double>& distances) const
+{
+    std::vector<Task> tasks;
+    tasks.reserve(distances.size());
+    for (double distance: distances)
+        tasks.emplace_back(this, distance);
+    return offset(tasks);
+}
+
+std::vector<std::vector<LC_PolylineOffset::Path>> LC_PolylineOffset::offset(const std::vector<Task>& tasks)
+{
+    std::vector<std::vector<Path>> results(tasks.size());
+    std::size_t total = 0;
+    for (const Task& task: tasks)
+        total += task.first->m_path.vertices.size();
+
+    if (tasks.size() < 2 || total < parallelOffsetMinimum) {
+        for (std::size_t i = 0; i < tasks.size(); ++i)
+            results[i] = tasks[i].first->offset(tasks[i].second);
+        return results;
+    }
+
+    QThreadPool pool;
+    const std::size_t chunks = std::max(pool.maxThreadCount(), 1);
+    const std::size_t chunkSize = (tasks.size() + chunks - 1) / chunks;
+    for (std::size_t begin = 0; begin < tasks.size(); begin += chunkSize) {
+        const std::size_t end = std::min(begin + chunkSize, tasks.size());
+        pool.start([&tasks, &results, begin, end]() {
+            for (std::size_t i = begin; i < end; ++i)
+                results[i] = tasks[i].first->offset(tasks[i].second);
+        });
+    }
+    pool.waitForDone();
+    RS_DEBUG->print("LC_PolylineOffset::offset: %zu offsets of %zu vertices computed concurrently",
+                    tasks.size(), total);
+    return results;
+}
+
+RS_Polyline* LC_PolylineOffset::createPolyline(const Path& path, RS_EntityContainer* parent)
+{
+    auto* polyline = new RS_Polyline(parent);
+    // closed before the vertices are added, so the closing segment is added once
+    polyline->setClosed(path.closed);
+    std::vector<std::pair<RS_Vector, double>> vertices;
+    vertices.reserve(path.vertices.size());
+    for (const Vertex& vertex: path.vertices)
+        vertices.emplace_back(vertex.point, vertex.bulge);
+    polyline->appendVertexs(vertices);
+    return polyline;
+}
@@ -0,0 +1,90 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_POLYLINEOFFSET_H
+#define LC_POLYLINEOFFSET_H
+
+#include <utility>
+#include <vector>
+
+#include "rs_vector.h"
+
+class RS_EntityContainer;
+class RS_Polyline;
+
+/**
+ * @brief The LC_PolylineOffset class, offsets of a polyline computed on its vertices
+ * and bulges, instead of on its line and arc entities.
+ *
+ * The segments are offset and joined at the intersections of neighbouring offset
+ * segments, or by an arc around the vertex where they don't meet. The self
+ * intersections of the joined offset are found by a sweep over the segment boxes; the
+ * offset is split at them, and the pieces nearer to the polyline than the offset
+ * distance are clipped. The remaining pieces are chained to the offset paths, so an
+ * offset may give several paths, or none when it collapsed.
+ */
+class LC_PolylineOffset {
+public:
+    struct Vertex {
+        RS_Vector point;
+        // the bulge of the segment to the next vertex, as in DXF: positive is counterclockwise
+        double bulge = 0.;
+    };
+
+    struct Path {
+        std::vector<Vertex> vertices;
+        // the last vertex is joined to the first one by its bulge
+        bool closed = false;
+    };
+
+    /** an offset to compute: the polyline and the offset distance */
+    using Task = std::pair<const LC_PolylineOffset*, double>;
+
+    explicit LC_PolylineOffset(const RS_Polyline& polyline);
+    LC_PolylineOffset(std::vector<Vertex> vertices, bool closed);
+
+    const Path& getPath() const {
+        return m_path;
+    }
+
+    /** @return 1 when the point is left of the polyline, -1 when it's right of it */
+    double getSide(const RS_Vector& point) const;
+
+    /**
+     * @return the offset paths, to the left of the polyline for positive distances
+     * and to the right of it for negative ones
+     */
+    std::vector<Path> offset(double distance) const;
+    /** @return the offset paths for each of the distances, computed concurrently for many */
+    std::vector<std::vector<Path>> offset(const std::vector<double>& distances) const;
+    /** @return the offset paths for each of the tasks, computed concurrently for many */
+    static std::vector<std::vector<Path>> offset(const std::vector<Task>& tasks);
+
+    /** @return a new polyline of the path */
+    static RS_Polyline* createPolyline(const Path& path, RS_EntityContainer* parent);
+
+private:
+    Path m_path;
+};
+
+#endif // LC_POLYLINEOFFSET_H
@@ -23,12 +23,16 @@
 ** This copyright notice MUST APPEAR in all copies of the script!
 **
 **********************************************************************/
+#include <algorithm>
 #include<cmath>
+#include <map>
 
 #include <QSet>
 
 #include "rs_modification.h"
 
+#include "lc_regenstatistics.h"
+#include "lc_trace.h"
 #include "rs_arc.h"
 #include "rs_block.h"
 #include "rs_circle.h"
@@ -47,7 +51,14 @@
 #include "rs_polyline.h"
 #include "rs_text.h"
 #include "rs_units.h"
+#include "lc_overkill.h"
+#include "lc_polylineoffset.h"
+#include "lc_progress.h"
+#include "lc_rect.h"
+#include "lc_spatialindex.h"
 #include "lc_splinepoints.h"
+#include "lc_taskscheduler.h"
+#include "lc_undoabletransform.h"
 #include "lc_undosection.h"
 
 #ifdef EMU_C99
@@ -55,6 +66,8 @@
 #endif
 
 namespace {
+// exploded atomic entities updated per task
+constexpr std::size_t parallelExplodeGrain = 1000;
 
 /**
  * @brief getPasteScale - find scaling factor for pasting
@@ -97,6 +110,193 @@ RS_Block* addNewBlock(const QString& name, RS_Graphic& graphic)
     return b;
 }
 
+/**
+ * Repetitive recursive block of code for the explode() method.
+ */
+void update_exploded_children_recursively(
+        RS_EntityContainer* ec,
+        RS_Entity* e,
+        RS_Entity* clone,
+        RS2::ResolveLevel rl,
+        bool resolveLayer,
+        bool resolvePen) {
+
+    if (!ec) {
+        return;
+    }
+    if (!e) {
+        return;
+    }
+    if (!clone) {
+        return;
+    }
+
+    if (resolveLayer) {
+        clone->setLayer(ec->getLayer());
+    } else {
+        clone->setLayer(e->getLayer());
+    }
+
+    if (resolvePen) {
+        //clone->setPen(ec->getPen(true));
+        clone->setPen(ec->getPen(false));
+    } else {
+        clone->setPen(e->getPen(false));
+    }
+
+    clone->update();
+
+    if (clone->isContainer()) {
+        // Note: reassigning ec and e here, so keep
+        // that in mind when writing code below this block.
+        ec = (RS_EntityContainer*) clone;
+        for (e = ec->firstEntity(rl); e; e = ec->nextEntity(rl)) {
+            if (e) {
+                // Run the same code for every children recursively
+                update_exploded_children_recursively(ec, clone, e,
+                        rl, resolveLayer, resolvePen);
+            }
+        }
+    }
+}
+
+
+/**
+ * How the entities of an exploded container are resolved, and whether they
+ * take the layer and the pen of the container.
+ */
+struct ExplodeResolve {
+    RS2::ResolveLevel level = RS2::ResolveAll;
+    bool layer = true;
+    bool pen = false;
+};
+
+ExplodeResolve explodeResolve(RS2::EntityType type)
+{
+    switch (type) {
+    case RS2::EntityMText:
+    case RS2::EntityText:
+    case RS2::EntityHatch:
+    case RS2::EntityPolyline:
+        return {RS2::ResolveAll, true, true};
+
+    case RS2::EntityInsert:
+        return {RS2::ResolveNone, false, false};
+
+    case RS2::EntityDimAligned:
+    case RS2::EntityDimLinear:
+    case RS2::EntityDimRadial:
+    case RS2::EntityDimDiametric:
+    case RS2::EntityDimAngular:
+    case RS2::EntityDimLeader:
+    case RS2::EntityDimArc:
+        return {RS2::ResolveNone, true, false};
+
+    default:
+        return {};
+    }
+}
+
+/**
+ * Adds clones of the entities of the container to the list, as new single
+ * entities of the target container.
+ */
+void explodeContainer(RS_EntityContainer& ec, RS_EntityContainer* target,
+                      std::vector<RS_Entity*>& addList) {
+    const ExplodeResolve resolve = explodeResolve(ec.rtti());
+    const RS2::ResolveLevel rl = resolve.level;
+
+    for (RS_Entity* e2 = ec.firstEntity(rl); e2;
+            e2 = ec.nextEntity(rl)) {
+
+        if (e2) {
+            RS_Entity* clone = e2->clone();
+            clone->setSelected(false);
+            clone->reparent(target);
+
+            addList.push_back(clone);
+
+            // In order to fix bug #819 and escape similar issues,
+            // we have to update all children of exploded entity,
+            // even those (below the tree) which are not direct
+            // subjects to the current explode() call.
+            update_exploded_children_recursively(&ec, e2, clone,
+                    rl, resolve.layer, resolve.pen);
+        }
+    }
+}
+
+/**
+ * Adds clones of the entities of many containers to the list, as
+ * explodeContainer(), with the updates of the clones batched: atomic entities
+ * are updated concurrently, texts are laid out by RS_Text::updateAll(), and
+ * inserts are left to the RS_EntityContainer::updateInserts() following the
+ * explode. As these updates regenerate the entities of texts and inserts, only
+ * the children of other containers take the attributes of the clones.
+ */
+void explodeContainers(const std::vector<RS_EntityContainer*>& sources, RS_EntityContainer* target,
+                       std::vector<RS_Entity*>& addList) {
+    struct Pending {
+        RS_EntityContainer* ec;
+        RS_Entity* e;
+        RS_Entity* clone;
+        ExplodeResolve resolve;
+    };
+
+    std::size_t count = 0;
+    for (const RS_EntityContainer* ec: sources)
+        count += ec->count();
+    addList.reserve(addList.size() + count);
+
+    std::vector<RS_Entity*> atomics;
+    std::vector<RS_Entity*> texts;
+    std::vector<Pending> containers;
+    atomics.reserve(count);
+    for (RS_EntityContainer* ec: sources) {
+        const ExplodeResolve resolve = explodeResolve(ec->rtti());
+        for (RS_Entity* e2 = ec->firstEntity(resolve.level); e2;
+                e2 = ec->nextEntity(resolve.level)) {
+            RS_Entity* clone = e2->clone();
+            clone->setSelected(false);
+            clone->reparent(target);
+            clone->setLayer(resolve.layer ? ec->getLayer() : e2->getLayer());
+            clone->setPen(resolve.pen ? ec->getPen(false) : e2->getPen(false));
+            addList.push_back(clone);
+
+            switch (clone->rtti()) {
+            case RS2::EntityInsert:
+                break;
+            case RS2::EntityText:
+            case RS2::EntityMText:
+                texts.push_back(clone);
+                break;
+            case RS2::EntityImage:
+                // images load their files
+                containers.push_back({ec, e2, clone, resolve});
+                break;
+            default:
+                if (clone->isAtomic())
+                    atomics.push_back(clone);
+                else
+                    containers.push_back({ec, e2, clone, resolve});
+                break;
+            }
+        }
+    }
+
+    LC_TaskScheduler::instance().parallelFor(0, atomics.size(), parallelExplodeGrain,
+                                             [&atomics](std::size_t begin, std::size_t end) {
+        // the reasons of the calling thread are not known to workers
+        LC_REGEN_REASON("explode");
+        for (std::size_t i = begin; i < end; ++i)
+            atomics[i]->update();
+    });
+    RS_Text::updateAll(texts);
+    for (const Pending& p: containers)
+        update_exploded_children_recursively(p.ec, p.e, p.clone,
+                p.resolve.level, p.resolve.layer, p.resolve.pen);
+}
+
 RS_VectorSolutions findIntersection(const RS_Entity& trimEntity, const RS_Entity& limitEntity, double tolerance = 1e-4)
 {
 
@@ -211,6 +411,15 @@ RS_AtomicEntity* trimCircleForRound(RS_AtomicEntity* entity, const RS_Arc& arcFi
     delete entity;
     return arc;
 }
+
+// deletes the entities from first on, which a cancelled operation created
+// but didn't add, returns false for the cancelled operation
+bool discardEntities(const std::vector<RS_Entity*>& entities, std::size_t first = 0)
+{
+    for (std::size_t i = first; i < entities.size(); ++i)
+        delete entities[i];
+    return false;
+}
 }
 
 RS_PasteData::RS_PasteData(RS_Vector _insertionPoint,
@@ -246,12 +455,41 @@ RS_Modification::RS_Modification(RS_EntityContainer& container,
     document = container.getDocument();
 }
 
+/**
+ * Sets the progress of the following operations, nullptr for none. Cancelled
+ * operations return false, after deleting their copies or rolling back their
+ * undo cycle.
+ */
+void RS_Modification::setProgress(LC_Progress* progress)
+{
+    this->progress = progress;
+}
+
+/**
+ * Starts the progress for the given number of copies of the selected entities.
+ */
+void RS_Modification::startProgress(int copies)
+{
+    if (progress != nullptr)
+        progress->start(std::size_t(copies) * container->countSelected(false));
+}
+
+/**
+ * @return false, if the operation is cancelled
+ */
+bool RS_Modification::advanceProgress(std::size_t steps)
+{
+    return progress == nullptr || progress->advance(steps);
+}
+
 
 
 /**
  * Deletes all selected entities.
  */
 void RS_Modification::remove() {
+    LC_TRACE_ZONE("RS_Modification::remove");
+    LC_REGEN_REASON("remove");
 
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::remove");
 
@@ -286,6 +524,8 @@ void RS_Modification::remove() {
  * Revert direction of selected entities.
  */
 void RS_Modification::revertDirection() {
+    LC_TRACE_ZONE("RS_Modification::revertDirection");
+    LC_REGEN_REASON("revert direction");
 
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::revertDirection");
 
@@ -322,6 +562,8 @@ void RS_Modification::revertDirection() {
  */
 bool RS_Modification::changeAttributes(RS_AttributesData& data)
 {
+    LC_TRACE_ZONE("RS_Modification::changeAttributes");
+    LC_REGEN_REASON("change attributes");
     return changeAttributes(data, container);
 }
 
@@ -420,6 +662,8 @@ bool RS_Modification::changeAttributes(
  * @param cut true: cut instead of copying, false: copy
  */
 void RS_Modification::copy(const RS_Vector& ref, const bool cut) {
+    LC_TRACE_ZONE("RS_Modification::copy");
+    LC_REGEN_REASON("copy");
 
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::copy");
 
@@ -632,6 +876,8 @@ void RS_Modification::copyBlocks(RS_Entity* e) {
  *      is the clipboard.
  */
 void RS_Modification::paste(const RS_PasteData& data, RS_Graphic* source) {
+    LC_TRACE_ZONE("RS_Modification::paste");
+    LC_REGEN_REASON("paste");
 
     RS_DEBUG->print(RS_Debug::D_INFORMATIONAL, "RS_Modification::paste");
 
@@ -724,14 +970,20 @@ void RS_Modification::paste(const RS_PasteData& data, RS_Graphic* source) {
     // unblock all entities if not pasting as a new block by demand
     LC_UndoSection undo(document, handleUndo);
     if (!data.asInsert) {
-        // no inserts should be selected except from paste block and insert
-        container->setSelected(false);
-        i->setSelected(true);
-        explode(false);
+        // replace the paste block insert by its entities, added in one batch
+        std::vector<RS_Entity*> addList;
+        addList.reserve(b->count());
+        explodeContainer(*i, container, addList);
+        for (RS_Entity* e: getSelectedEntities()) {
+            if (graphicView)
+                graphicView->invalidateArea(graphicView->getRenderedArea(*e));
+            e->setSelected(false);
+        }
         document->removeEntity(i);
         b->clear();
         // if this call a destructor for the block?
         graphic->removeBlock(b);
+        addNewEntities(addList);
     } else {
         undo.addUndoable(i);
     }
@@ -781,7 +1033,7 @@ bool RS_Modification::pasteLayers(RS_Graphic* source) {
  * Create inserts and blocks in destination graphic corresponding to entity to be copied
  *
  **/
-bool RS_Modification::pasteContainer(RS_Entity* entity, RS_EntityContainer* container, QHash<QString, QString>blocksDict, RS_Vector insertionPoint) {
+bool RS_Modification::pasteContainer(RS_Entity* entity, RS_EntityContainer* container, QHash<QString, QString>& blocksDict, const RS_Vector& insertionPoint) {
 
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::pasteInsert");
 
@@ -1736,14 +1988,24 @@ RS_Polyline* RS_Modification::polylineTrim(RS_Polyline& polyline,
  * modification.
  */
 bool RS_Modification::move(RS_MoveData& data) {
+    LC_TRACE_ZONE("RS_Modification::move");
+    LC_REGEN_REASON("move");
 	if (!container) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Modification::move: no valid container");
         return false;
     }
 
+    if (data.number == 0 && !data.useCurrentLayer && !data.useCurrentAttributes) {
+        // no copies: move the originals, since 2.0.4.0 the selection is kept
+        transformInPlace(LC_UndoableTransform::createMove(*container, getSelectedEntities(),
+                                                          data.offset), true);
+        return true;
+    }
+
 	std::vector<RS_Entity*> addList;
 
+    startProgress(std::max(data.number, 1));
     // Create new entities
     for (int num=1;
             num<=data.number || (data.number==0 && num<=1);
@@ -1768,15 +2030,15 @@ bool RS_Modification::move(RS_MoveData& data) {
                 // since 2.0.4.0: keep selection
                 ec->setSelected(true);
 				addList.push_back(ec);
+                if (!advanceProgress())
+                    return discardEntities(addList);
             }
         }
     }
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.number==0);
-    addNewEntities(addList);
-
-    return true;
+    return addNewEntities(addList);
 }
 
 
@@ -1786,6 +2048,8 @@ bool RS_Modification::move(RS_MoveData& data) {
  *@Author: Dongxu Li
  */
 bool RS_Modification::offset(const RS_OffsetData& data) {
+    LC_TRACE_ZONE("RS_Modification::offset");
+    LC_REGEN_REASON("offset");
 	if (!container) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Modification::offset: no valid container");
@@ -1793,14 +2057,53 @@ bool RS_Modification::offset(const RS_OffsetData& data) {
     }
 
 	std::vector<RS_Entity*> addList;
+    const int count = std::max(data.number, 1);
+    const auto setAttributes = [&data, &addList](RS_Entity* ec) {
+        if (data.useCurrentLayer) {
+            ec->setLayerToActive();
+        }
+        if (data.useCurrentAttributes) {
+            ec->setPenToActive();
+        }
+        // since 2.0.4.0: keep selection
+        ec->setSelected(true);
+        addList.push_back(ec);
+    };
+
+    // the offsets of the selected polylines, all computed at once
+    std::vector<LC_PolylineOffset> polylines;
+    std::map<const RS_Entity*, size_t> polylineIndices;
+    for (auto e: *container) {
+        if (e && e->isSelected() && e->rtti() == RS2::EntityPolyline) {
+            polylineIndices.emplace(e, polylines.size());
+            polylines.emplace_back(*static_cast<RS_Polyline*>(e));
+        }
+    }
+    std::vector<LC_PolylineOffset::Task> tasks;
+    for (const LC_PolylineOffset& polyline: polylines) {
+        const double side = polyline.getSide(data.coord);
+        for (int num=1; num<=count; num++)
+            tasks.emplace_back(&polyline, side*num*data.distance);
+    }
+    const std::vector<std::vector<LC_PolylineOffset::Path>> polylineOffsets
+            = LC_PolylineOffset::offset(tasks);
 
     // Create new entities
-    for (int num=1;
-            num<=data.number || (data.number==0 && num<=1);
-            num++) {
+    for (int num=1; num<=count; num++) {
         // too slow:
 		for(auto e: *container){
 			if (e && e->isSelected()) {
+                auto it = polylineIndices.find(e);
+                if (it != polylineIndices.end()) {
+                    for (const auto& path: polylineOffsets.at(it->second*count + num - 1)) {
+                        RS_Polyline* pl = LC_PolylineOffset::createPolyline(path, container);
+                        pl->setLayer(e->getLayer(false));
+                        pl->setPen(e->getPen(false));
+                        setAttributes(pl);
+                    }
+                    continue;
+                }
+
                 RS_Entity* ec = e->clone();
 				//highlight is used by trim actions. do not carry over flag
 				ec->setHighlighted(false);
@@ -1809,18 +2112,10 @@ bool RS_Modification::offset(const RS_OffsetData& data) {
                     delete ec;
                     continue;
                 }
-                if (data.useCurrentLayer) {
-                    ec->setLayerToActive();
-                }
-                if (data.useCurrentAttributes) {
-                    ec->setPenToActive();
-                }
                 if (ec->rtti()==RS2::EntityInsert) {
 					static_cast<RS_Insert*>(ec)->update();
                 }
-                // since 2.0.4.0: keep selection
-                ec->setSelected(true);
-				addList.push_back(ec);
+                setAttributes(ec);
             }
         }
     }
@@ -1839,14 +2134,23 @@ bool RS_Modification::offset(const RS_OffsetData& data) {
  * Rotates all selected entities with the given data for the rotation.
  */
 bool RS_Modification::rotate(RS_RotateData& data) {
+    LC_TRACE_ZONE("RS_Modification::rotate");
+    LC_REGEN_REASON("rotate");
 	if (!container) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Modification::rotate: no valid container");
         return false;
     }
 
+    if (data.number == 0 && !data.useCurrentLayer && !data.useCurrentAttributes) {
+        transformInPlace(LC_UndoableTransform::createRotate(*container, getSelectedEntities(),
+                                                            data.center, data.angle), false);
+        return true;
+    }
+
 	std::vector<RS_Entity*> addList;
 
+    startProgress(std::max(data.number, 1));
     // Create new entities
     for (int num=1;
             num<=data.number || (data.number==0 && num<=1);
@@ -1870,15 +2174,15 @@ bool RS_Modification::rotate(RS_RotateData& data) {
                     ((RS_Insert*)ec)->update();
                 }
 				addList.push_back(ec);
+                if (!advanceProgress())
+                    return discardEntities(addList);
             }
         }
     }
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.number==0);
-    addNewEntities(addList);
-
-    return true;
+    return addNewEntities(addList);
 }
 
 
@@ -1888,12 +2192,23 @@ bool RS_Modification::rotate(RS_RotateData& data) {
  * modification.
  */
 bool RS_Modification::scale(RS_ScaleData& data) {
+    LC_TRACE_ZONE("RS_Modification::scale");
+    LC_REGEN_REASON("scale");
 	if (!container) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Modification::scale: no valid container");
         return false;
     }
 
+    // non-isotropic scaling replaces circles and arcs by ellipses, so they are copied
+    if (data.number == 0 && !data.useCurrentLayer && !data.useCurrentAttributes
+            && std::abs(data.factor.x - data.factor.y) <= RS_TOLERANCE
+            && std::abs(data.factor.x) > RS_TOLERANCE) {
+        transformInPlace(LC_UndoableTransform::createScale(*container, getSelectedEntities(),
+                                                           data.referencePoint, data.factor), false);
+        return true;
+    }
+
 	std::vector<RS_Entity*> selectedList,addList;
 
 	for(auto ec: *container){
@@ -1923,6 +2238,7 @@ bool RS_Modification::scale(RS_ScaleData& data) {
         }
     }
 
+    startProgress(std::max(data.number, 1));
     // Create new entities
     for (int num=1;
             num<=data.number || (data.number==0 && num<=1);
@@ -1949,15 +2265,15 @@ bool RS_Modification::scale(RS_ScaleData& data) {
                     ((RS_Insert*)ec)->update();
                 }
 				addList.push_back(ec);
+                if (!advanceProgress())
+                    return discardEntities(addList);
             }
         }
     }
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.number==0);
-    addNewEntities(addList);
-
-    return true;
+    return addNewEntities(addList);
 }
 
 
@@ -1967,14 +2283,23 @@ bool RS_Modification::scale(RS_ScaleData& data) {
  * modification.
  */
 bool RS_Modification::mirror(RS_MirrorData& data) {
+    LC_TRACE_ZONE("RS_Modification::mirror");
+    LC_REGEN_REASON("mirror");
 	if (!container) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Modification::mirror: no valid container");
         return false;
     }
 
+    if (!data.copy && !data.useCurrentLayer && !data.useCurrentAttributes) {
+        transformInPlace(LC_UndoableTransform::createMirror(*container, getSelectedEntities(),
+                                                            data.axisPoint1, data.axisPoint2), false);
+        return true;
+    }
+
 	std::vector<RS_Entity*> addList;
 
+    startProgress(1);
     // Create new entities
     for (int num=1;
             num<=(int)data.copy || (data.copy==false && num<=1);
@@ -1998,15 +2323,15 @@ bool RS_Modification::mirror(RS_MirrorData& data) {
                     ((RS_Insert*)ec)->update();
                 }
 				addList.push_back(ec);
+                if (!advanceProgress())
+                    return discardEntities(addList);
             }
         }
     }
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.copy==false);
-    addNewEntities(addList);
-
-    return true;
+    return addNewEntities(addList);
 }
 
 
@@ -2015,6 +2340,8 @@ bool RS_Modification::mirror(RS_MirrorData& data) {
  * Rotates entities around two centers with the given parameters.
  */
 bool RS_Modification::rotate2(RS_Rotate2Data& data) {
+    LC_TRACE_ZONE("RS_Modification::rotate2");
+    LC_REGEN_REASON("rotate two");
 	if (!container) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Modification::rotate2: no valid container");
@@ -2023,6 +2350,7 @@ bool RS_Modification::rotate2(RS_Rotate2Data& data) {
 
 	std::vector<RS_Entity*> addList;
 
+    startProgress(std::max(data.number, 1));
     // Create new entities
     for (int num=1;
             num<=data.number || (data.number==0 && num<=1);
@@ -2051,15 +2379,15 @@ bool RS_Modification::rotate2(RS_Rotate2Data& data) {
                     ((RS_Insert*)ec)->update();
                 }
 				addList.push_back(ec);
+                if (!advanceProgress())
+                    return discardEntities(addList);
             }
         }
     }
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.number==0);
-    addNewEntities(addList);
-
-    return true;
+    return addNewEntities(addList);
 }
 
 
@@ -2068,6 +2396,8 @@ bool RS_Modification::rotate2(RS_Rotate2Data& data) {
  * Moves and rotates entities with the given parameters.
  */
 bool RS_Modification::moveRotate(RS_MoveRotateData& data) {
+    LC_TRACE_ZONE("RS_Modification::moveRotate");
+    LC_REGEN_REASON("move rotate");
 	if (!container) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Modification::moveRotate: no valid container");
@@ -2076,6 +2406,7 @@ bool RS_Modification::moveRotate(RS_MoveRotateData& data) {
 
 	std::vector<RS_Entity*> addList;
 
+    startProgress(std::max(data.number, 1));
     // Create new entities
     for (int num=1;
             num<=data.number || (data.number==0 && num<=1);
@@ -2101,15 +2432,15 @@ bool RS_Modification::moveRotate(RS_MoveRotateData& data) {
                     ((RS_Insert*)ec)->update();
                 }
 				addList.push_back(ec);
+                if (!advanceProgress())
+                    return discardEntities(addList);
             }
         }
     }
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.number==0);
-    addNewEntities(addList);
-
-    return true;
+    return addNewEntities(addList);
 }
 
 
@@ -2147,6 +2478,9 @@ void RS_Modification::deselectOriginals(bool remove)
             }
 
             if (selected) {
+                // the original is deselected or removed, new entities are drawn by addNewEntities()
+                if (graphicView)
+                    graphicView->invalidateArea(graphicView->getRenderedArea(*e));
                 e->setSelected(false);
                 if (remove
                    ) {
@@ -2172,23 +2506,85 @@ void RS_Modification::deselectOriginals(bool remove)
  * there's a graphic view available.
  *
  * @param addList Entities to add.
+ * @return false, if the operation is cancelled and rolled back
  */
-void RS_Modification::addNewEntities(std::vector<RS_Entity*>& addList)
+bool RS_Modification::addNewEntities(std::vector<RS_Entity*>& addList)
 {
     LC_UndoSection undo( document, handleUndo);
 
-    for (RS_Entity* e: addList) {
+    LC_Rect area;
+    bool hasArea = false;
+    for (std::size_t i = 0; i < addList.size(); ++i) {
+        // the added entities are removed with the undo cycle, the others deleted
+        if (!advanceProgress(0) && undo.cancel())
+            return discardEntities(addList, i);
+        RS_Entity* e = addList[i];
         if (e) {
             container->addEntity(e);
             undo.addUndoable(e);
+            if (graphicView) {
+                const LC_Rect entityArea = graphicView->getRenderedArea(*e);
+                area = hasArea ? area.merge(entityArea) : entityArea;
+                hasArea = true;
+            }
         }
     }
 
     container->calculateBorders();
 
+    // only redraw areas of changed entities, originals are invalidated by deselectOriginals()
+    if (graphicView) {
+        if (hasArea)
+            graphicView->redrawArea(area);
+        else
+            graphicView->redraw(RS2::RedrawCached);
+    }
+    return true;
+}
+
+
+
+/**
+ * @return the selected entities of the container
+ */
+std::vector<RS_Entity*> RS_Modification::getSelectedEntities() const
+{
+    return container->getSelectedEntities();
+}
+
+
+
+/**
+ * Transforms the entities of the transformation in place, instead of replacing
+ * them by transformed copies, and adds the transformation to the undo cycle.
+ * Undoing it transforms the entities back.
+ *
+ * @param keepSelection false: deselect the entities.
+ */
+void RS_Modification::transformInPlace(std::unique_ptr<LC_UndoableTransform> transform,
+                                       bool keepSelection)
+{
+    if (transform->getEntities().empty())
+        return;
+
+    for (RS_Entity* e: transform->getEntities()) {
+        if (graphicView)
+            graphicView->invalidateArea(graphicView->getRenderedArea(*e));
+        if (!keepSelection)
+            e->setSelected(false);
+    }
+
+    transform->apply();
+
     if (graphicView) {
-        graphicView->redraw(RS2::RedrawDrawing);
+        LC_Rect area = graphicView->getRenderedArea(*transform->getEntities().front());
+        for (RS_Entity* e: transform->getEntities())
+            area = area.merge(graphicView->getRenderedArea(*e));
+        graphicView->redrawArea(area);
     }
+
+    LC_UndoSection undo( document, handleUndo);
+    undo.addUndoable(std::move(transform));
 }
 
 
@@ -2210,6 +2606,8 @@ bool RS_Modification::trim(const RS_Vector& trimCoord,
                            const RS_Vector& limitCoord,
                            RS_Entity* limitEntity,
                            bool both) {
+    LC_TRACE_ZONE("RS_Modification::trim");
+    LC_REGEN_REASON("trim");
 
     if (trimEntity == nullptr || limitEntity == nullptr) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
@@ -2352,6 +2750,143 @@ bool RS_Modification::trim(const RS_Vector& trimCoord,
 
 
 
+/**
+ * Trims or extends the ends of many entities to the limiting edges in one pass,
+ * e.g. to clean up the overshoots and undershoots of exploded linework.
+ *
+ * Each end of a line, arc or elliptic arc is moved to the intersection of the
+ * entity or its extension with a limiting edge nearest to it, if that is at most
+ * maxDistance away and nearer to this end than to the other end. Ends already on
+ * a limiting edge are kept. The intersections are computed by batches of the
+ * limiting edges found around each entity with a spatial index.
+ *
+ * @param limitEntities the limiting edges, containers are resolved to their edges
+ * @return true if any entity was trimmed or extended, as one undo cycle
+ */
+bool RS_Modification::trimToEdges(const std::vector<RS_Entity*>& trimEntities,
+                                  const std::vector<RS_Entity*>& limitEntities,
+                                  double maxDistance)
+{
+    LC_TRACE_ZONE("RS_Modification::trimToEdges");
+    LC_REGEN_REASON("trim to edges");
+    const double tolerance = 1e-4;
+
+    std::vector<RS_Entity*> edges;
+    for (RS_Entity* limitEntity: limitEntities) {
+        if (limitEntity == nullptr || !limitEntity->isVisible())
+            continue;
+        if (limitEntity->isContainer()) {
+            auto ec = static_cast<RS_EntityContainer*>(limitEntity);
+            for (RS_Entity* e = ec->firstEntity(RS2::ResolveAll); e != nullptr;
+                 e = ec->nextEntity(RS2::ResolveAll))
+                edges.push_back(e);
+        } else {
+            edges.push_back(limitEntity);
+        }
+    }
+    LC_SpatialIndex edgeIndex;
+    for (std::size_t i = 0; i < edges.size(); ++i)
+        edgeIndex.insert(edges[i], double(i));
+
+    std::vector<std::pair<RS_Entity*, RS_Entity*>> replaced;
+    std::vector<std::pair<RS_Entity*, RS_Vector>> intersections;
+    if (progress != nullptr)
+        progress->start(trimEntities.size());
+    for (RS_Entity* trimEntity: trimEntities) {
+        if (!advanceProgress()) {
+            for (const auto& [original, trimmed]: replaced)
+                delete trimmed;
+            return false;
+        }
+        if (trimEntity == nullptr || trimEntity->isLocked() || !trimEntity->isVisible())
+            continue;
+        const RS2::EntityType type = trimEntity->rtti();
+        if (!(type == RS2::EntityLine || type == RS2::EntityArc
+              || (type == RS2::EntityEllipse && static_cast<RS_Ellipse*>(trimEntity)->isEllipticArc())))
+            continue;
+
+        const RS_Vector start = trimEntity->getStartpoint();
+        const RS_Vector end = trimEntity->getEndpoint();
+        const LC_Rect area = LC_Rect{trimEntity->getMin(), trimEntity->getMax()}.increaseBy(maxDistance);
+        // an entity chosen as an edge too does not limit itself
+        std::vector<RS_Entity*> candidates = edgeIndex.query(area);
+        candidates.erase(std::remove(candidates.begin(), candidates.end(), trimEntity), candidates.end());
+        intersections.clear();
+        RS_Information::getIntersections(trimEntity, candidates, false, intersections);
+
+        RS_Vector newStart{false};
+        RS_Vector newEnd{false};
+        double startDistance = maxDistance;
+        double endDistance = maxDistance;
+        bool startOnEdge = false;
+        bool endOnEdge = false;
+        for (const auto& [edge, point]: intersections) {
+            if (!edge->isPointOnEntity(point, tolerance))
+                continue;
+            const double toStart = point.distanceTo(start);
+            const double toEnd = point.distanceTo(end);
+            if (toStart < toEnd) {
+                startOnEdge = startOnEdge || toStart < tolerance;
+                if (toStart <= startDistance) {
+                    startDistance = toStart;
+                    newStart = point;
+                }
+            } else {
+                endOnEdge = endOnEdge || toEnd < tolerance;
+                if (toEnd <= endDistance) {
+                    endDistance = toEnd;
+                    newEnd = point;
+                }
+            }
+        }
+        if (startOnEdge)
+            newStart = RS_Vector{false};
+        if (endOnEdge)
+            newEnd = RS_Vector{false};
+        if (!newStart.valid && !newEnd.valid)
+            continue;
+
+        auto trimmed = static_cast<RS_AtomicEntity*>(trimEntity->clone());
+        trimmed->setHighlighted(false);
+        trimmed->setSelected(false);
+        if (newStart.valid)
+            trimmed->trimStartpoint(newStart);
+        if (newEnd.valid)
+            trimmed->trimEndpoint(newEnd);
+        replaced.emplace_back(trimEntity, trimmed);
+    }
+
+    RS_DEBUG->print("RS_Modification::trimToEdges: %zu of %zu entities trimmed against %zu edges",
+                    replaced.size(), trimEntities.size(), edges.size());
+    if (replaced.empty())
+        return false;
+
+    LC_UndoSection undo(document, handleUndo);
+    LC_Rect area;
+    bool hasArea = false;
+    for (const auto& [original, trimmed]: replaced) {
+        if (graphicView) {
+            const LC_Rect entityArea = graphicView->getRenderedArea(*original);
+            area = hasArea ? area.merge(entityArea) : entityArea;
+            hasArea = true;
+        }
+        original->setSelected(false);
+        container->addEntity(trimmed);
+        undo.addUndoable(trimmed);
+        original->setUndoState(true);
+        undo.addUndoable(original);
+        if (graphicView)
+            area = area.merge(graphicView->getRenderedArea(*trimmed));
+    }
+
+    // one redraw for all the trimmed entities
+    if (graphicView)
+        graphicView->redrawArea(area);
+    return true;
+}
+
+
+
 /**
  * Trims or extends the given trimEntity by the given amount.
  *
@@ -2363,6 +2898,8 @@ bool RS_Modification::trim(const RS_Vector& trimCoord,
 bool RS_Modification::trimAmount(const RS_Vector& trimCoord,
                                  RS_AtomicEntity* trimEntity,
                                  double dist) {
+    LC_TRACE_ZONE("RS_Modification::trimAmount");
+    LC_REGEN_REASON("trim amount");
 
 	if (!trimEntity) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
@@ -2413,6 +2950,8 @@ bool RS_Modification::trimAmount(const RS_Vector& trimCoord,
  */
 bool RS_Modification::cut(const RS_Vector& cutCoord,
                           RS_AtomicEntity* cutEntity) {
+    LC_TRACE_ZONE("RS_Modification::cut");
+    LC_REGEN_REASON("cut");
 
 #ifndef EMU_C99
     using std::isnormal;
@@ -2548,6 +3087,8 @@ bool RS_Modification::cut(const RS_Vector& cutCoord,
 bool RS_Modification::stretch(const RS_Vector& firstCorner,
                               const RS_Vector& secondCorner,
                               const RS_Vector& offset) {
+    LC_TRACE_ZONE("RS_Modification::stretch");
+    LC_REGEN_REASON("stretch");
 
     if (!offset.valid) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
@@ -2555,27 +3096,36 @@ bool RS_Modification::stretch(const RS_Vector& firstCorner,
         return false;
     }
 
+    std::vector<RS_Entity*> inside;
+    std::vector<RS_Entity*> crossing;
+    container->getStretchEntities(firstCorner, secondCorner, inside, crossing);
+
 	std::vector<RS_Entity*> addList;
+    addList.reserve(inside.size() + crossing.size());
 
 	// Create new entities
-	for(auto e: *container){
-		if (e &&
-                e->isVisible() &&
-                !e->isLocked() ) {
-//            &&
-            if (  (e->isInWindow(firstCorner, secondCorner) ||
-                    e->hasEndpointsWithinWindow(firstCorner, secondCorner))) {
-
-                RS_Entity* ec = e->clone();
-                ec->stretch(firstCorner, secondCorner, offset);
-				addList.push_back(ec);
-                e->setSelected(true);
-            }
-        }
+    for (RS_Entity* e: inside) {
+        RS_Entity* ec = e->clone();
+        ec->move(offset);
+        addList.push_back(ec);
+    }
+    for (RS_Entity* e: crossing) {
+        RS_Entity* ec = e->clone();
+        ec->stretch(firstCorner, secondCorner, offset);
+        addList.push_back(ec);
     }
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
-    deselectOriginals(true);
+    // only the stretched entities are replaced
+    for (auto* originals: {&inside, &crossing}) {
+        for (RS_Entity* e: *originals) {
+            if (graphicView)
+                graphicView->invalidateArea(graphicView->getRenderedArea(*e));
+            e->setSelected(false);
+            e->changeUndoState();
+            undo.addUndoable(e);
+        }
+    }
     addNewEntities(addList);
 
     return true;
@@ -2595,6 +3145,8 @@ bool RS_Modification::stretch(const RS_Vector& firstCorner,
 bool RS_Modification::bevel(const RS_Vector& coord1, RS_AtomicEntity* entity1,
                             const RS_Vector& coord2, RS_AtomicEntity* entity2,
                             RS_BevelData& data) {
+    LC_TRACE_ZONE("RS_Modification::bevel");
+    LC_REGEN_REASON("bevel");
 
     RS_DEBUG->print("RS_Modification::bevel");
 
@@ -2861,6 +3413,8 @@ bool RS_Modification::round(const RS_Vector& coord,
                             const RS_Vector& coord2,
                             RS_AtomicEntity* entity2,
                             RS_RoundData& data) {
+    LC_TRACE_ZONE("RS_Modification::round");
+    LC_REGEN_REASON("round");
 
 	if (!(entity1 && entity2)) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
@@ -3075,63 +3629,14 @@ bool RS_Modification::round(const RS_Vector& coord,
 }
 
 
-/**
- * Repetitive recursive block of code for the explode() method.
- */
-static void update_exploded_children_recursively(
-        RS_EntityContainer* ec,
-        RS_Entity* e,
-        RS_Entity* clone,
-        RS2::ResolveLevel rl,
-        bool resolveLayer,
-        bool resolvePen) {
-
-    if (!ec) {
-        return;
-    }
-    if (!e) {
-        return;
-    }
-    if (!clone) {
-        return;
-    }
-
-    if (resolveLayer) {
-        clone->setLayer(ec->getLayer());
-    } else {
-        clone->setLayer(e->getLayer());
-    }
-
-    if (resolvePen) {
-        //clone->setPen(ec->getPen(true));
-        clone->setPen(ec->getPen(false));
-    } else {
-        clone->setPen(e->getPen(false));
-    }
-
-    clone->update();
-
-    if (clone->isContainer()) {
-        // Note: reassigning ec and e here, so keep
-        // that in mind when writing code below this block.
-        ec = (RS_EntityContainer*) clone;
-        for (e = ec->firstEntity(rl); e; e = ec->nextEntity(rl)) {
-            if (e) {
-                // Run the same code for every children recursively
-                update_exploded_children_recursively(ec, clone, e,
-                        rl, resolveLayer, resolvePen);
-            }
-        }
-    }
-}
-
-
 /**
  * Removes the selected entity containers and adds the entities in them as
  * new single entities.
  */
 bool RS_Modification::explode(const bool remove /*= true*/)
 {
+    LC_TRACE_ZONE("RS_Modification::explode");
+    LC_REGEN_REASON("explode");
     if (!container) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Modification::explode: no valid container for addinge entities");
@@ -3139,106 +3644,40 @@ bool RS_Modification::explode(const bool remove /*= true*/)
     }
 	if (container->isLocked() || ! container->isVisible()) return false;
 
-	std::vector<RS_Entity*> addList;
+	std::vector<RS_EntityContainer*> sources;
 
+    startProgress(1);
     for(auto e: *container){
-        //for (unsigned i=0; i<container->count(); ++i) {
-        //RS_Entity* e = container->entityAt(i);
-
         if (e && e->isSelected()) {
+            if (!advanceProgress())
+                return false;
             if (e->isContainer()) {
-
-                // add entities from container:
-                RS_EntityContainer* ec = (RS_EntityContainer*)e;
-                //ec->setSelected(false);
-
-                // iterate and explode container:
-                //for (unsigned i2=0; i2<ec->count(); ++i2) {
-                //    RS_Entity* e2 = ec->entityAt(i2);
-                RS2::ResolveLevel rl;
-                bool resolvePen;
-                bool resolveLayer;
-
-                switch (ec->rtti()) {
-                case RS2::EntityMText:
-                case RS2::EntityText:
-                case RS2::EntityHatch:
-                case RS2::EntityPolyline:
-                    rl = RS2::ResolveAll;
-                    resolveLayer = true;
-                    resolvePen = true;
-                    break;
-
-                case RS2::EntityInsert:
-                    resolvePen = false;
-                    resolveLayer = false;
-                    rl = RS2::ResolveNone;
-                    break;
-
-                case RS2::EntityDimAligned:
-                case RS2::EntityDimLinear:
-                case RS2::EntityDimRadial:
-                case RS2::EntityDimDiametric:
-                case RS2::EntityDimAngular:
-                case RS2::EntityDimLeader:
-                case RS2::EntityDimArc:
-                    rl = RS2::ResolveNone;
-                    resolveLayer = true;
-                    resolvePen = false;
-                    break;
-
-                default:
-                    rl = RS2::ResolveAll;
-                    resolveLayer = true;
-                    resolvePen = false;
-                    break;
-                }
-
-                for (RS_Entity* e2 = ec->firstEntity(rl); e2;
-                        e2 = ec->nextEntity(rl)) {
-
-                    if (e2) {
-                        RS_Entity* clone = e2->clone();
-                        clone->setSelected(false);
-                        clone->reparent(container);
-
-                        addList.push_back(clone);
-
-                        // In order to fix bug #819 and escape similar issues,
-                        // we have to update all children of exploded entity,
-                        // even those (below the tree) which are not direct
-                        // subjects to the current explode() call.
-                        update_exploded_children_recursively(ec, e2, clone,
-                                rl, resolveLayer, resolvePen);
-/*
-                        if (resolveLayer) {
-                            clone->setLayer(ec->getLayer());
-                        } else {
-                            clone->setLayer(e2->getLayer());
-                        }
-
-//                        clone->setPen(ec->getPen(resolvePen));
-                        if (resolvePen) {
-                            clone->setPen(ec->getPen(true));
-                        } else {
-                            clone->setPen(e2->getPen(false));
-                        }
-
-						addList.push_back(clone);
-
-                        clone->update();
-*/
-                    }
-                }
+                sources.push_back(static_cast<RS_EntityContainer*>(e));
             } else {
+                if (graphicView)
+                    graphicView->invalidateArea(graphicView->getRenderedArea(*e));
                 e->setSelected(false);
             }
         }
     }
 
+    std::vector<RS_Entity*> addList;
+    explodeContainers(sources, container, addList);
+
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
-    deselectOriginals( remove);
-    addNewEntities(addList);
+    // the exploded containers are the only selected entities left
+    for (RS_EntityContainer* e: sources) {
+        if (graphicView)
+            graphicView->invalidateArea(graphicView->getRenderedArea(*e));
+        e->setSelected(false);
+        if (remove) {
+            e->changeUndoState();
+            undo.addUndoable(e);
+        }
+    }
+    container->reserveEntities(int(addList.size()));
+    if (!addNewEntities(addList))
+        return false;
     container->updateInserts();
 
     return true;
@@ -3247,6 +3686,8 @@ bool RS_Modification::explode(const bool remove /*= true*/)
 
 
 bool RS_Modification::explodeTextIntoLetters() {
+    LC_TRACE_ZONE("RS_Modification::explodeTextIntoLetters");
+    LC_REGEN_REASON("explode text");
 	if (!container) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Modification::explodeTextIntoLetters: no valid container for addinge entities");
@@ -3267,18 +3708,72 @@ bool RS_Modification::explodeTextIntoLetters() {
                 RS_Text* text = (RS_Text*)e;
                 explodeTextIntoLetters(text, addList);
             } else {
+                if (graphicView)
+                    graphicView->invalidateArea(graphicView->getRenderedArea(*e));
                 e->setSelected(false);
             }
         }
     }
+    // the letters are laid out together, concurrently for many letters
+    RS_Text::updateAll(addList);
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(true);
+    container->reserveEntities(int(addList.size()));
     addNewEntities(addList);
 
     return true;
 }
 
+/**
+ * Removes the zero length and duplicate entities of the selection, and replaces
+ * overlapping collinear lines by single lines, in one undo cycle.
+ * Entities found by LC_Overkill.
+ *
+ * @return the number of entities less in the container
+ */
+std::size_t RS_Modification::overkill(const RS_OverkillData& data)
+{
+    LC_TRACE_ZONE("RS_Modification::overkill");
+    LC_REGEN_REASON("overkill");
+    if (!container) {
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "RS_Modification::overkill: no valid container");
+        return 0;
+    }
+    if(container->isLocked() || ! container->isVisible()) return 0;
+
+    std::vector<RS_Entity*> entities = getSelectedEntities();
+    entities.erase(std::remove_if(entities.begin(), entities.end(), [](const RS_Entity* e) {
+        return e->isLocked() || !e->isVisible();
+    }), entities.end());
+    const LC_Overkill::Result result = LC_Overkill::find(entities, data);
+    if (result.removed.empty())
+        return 0;
+
+    std::vector<RS_Entity*> addList;
+    addList.reserve(result.merges.size());
+    for (const LC_Overkill::Merge& merge: result.merges) {
+        auto line = static_cast<RS_Line*>(merge.source->clone());
+        line->setSelected(false);
+        line->setStartpoint(merge.start);
+        line->setEndpoint(merge.end);
+        addList.push_back(line);
+    }
+
+    LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
+    for (RS_Entity* e: result.removed) {
+        if (graphicView)
+            graphicView->invalidateArea(graphicView->getRenderedArea(*e));
+        e->setSelected(false);
+        e->changeUndoState();
+        undo.addUndoable(e);
+    }
+    addNewEntities(addList);
+
+    return result.removed.size() - result.merges.size();
+}
+
 
 bool RS_Modification::explodeTextIntoLetters(RS_MText* text, std::vector<RS_Entity*>& addList) {
 
@@ -3329,13 +3824,12 @@ bool RS_Modification::explodeTextIntoLetters(RS_MText* text, std::vector<RS_Enti
                                     letter->getName(),
                                     text->getStyle(),
                                     letter->getAngle(),
-                                    RS2::Update));
+                                    RS2::NoUpdate));
 
                     tl->setLayer(text->getLayer());
                     tl->setPen(text->getPen());
 
 					addList.push_back(tl);
-                    tl->update();
                 }
             }
         }
@@ -3373,13 +3867,12 @@ bool RS_Modification::explodeTextIntoLetters(RS_Text* text, std::vector<RS_Entit
                                     letter->getName(),
                                     text->getStyle(),
                                     letter->getAngle(),
-                                    RS2::Update));
+                                    RS2::NoUpdate));
 
             tl->setLayer(text->getLayer());
             tl->setPen(text->getPen());
 
 			addList.push_back(tl);
-            tl->update();
         }
     }
 
@@ -3391,6 +3884,8 @@ bool RS_Modification::explodeTextIntoLetters(RS_Text* text, std::vector<RS_Entit
  * Moves all reference points of selected entities with the given data.
  */
 bool RS_Modification::moveRef(RS_MoveRefData& data) {
+    LC_TRACE_ZONE("RS_Modification::moveRef");
+    LC_REGEN_REASON("move reference");
 	if (!container) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Modification::moveRef: no valid container");
@@ -27,10 +27,15 @@
 #ifndef RS_MODIFICATION_H
 #define RS_MODIFICATION_H
 
+#include <cstddef>
+#include <memory>
+
 #include <QHash>
 #include "rs_pen.h"
 #include "rs_vector.h"
 
+class LC_Progress;
+class LC_UndoableTransform;
 class RS_AtomicEntity;
 class RS_Entity;
 class RS_EntityContainer;
@@ -161,6 +166,19 @@ struct RS_MoveRefData {
 
 
 
+/**
+ * Holds the data needed for removing duplicate and overlapping entities.
+ */
+struct RS_OverkillData {
+    //! entities within the tolerance are duplicates
+    double tolerance = 1.0e-6;
+    //! replace overlapping collinear lines by one line, otherwise only covered lines are removed
+    bool mergeOverlaps = true;
+    //! compare geometry only, regardless of layers and pens
+    bool ignoreAttributes = false;
+};
+
+
 /**
  * Holds the data needed for changing attributes.
  */
@@ -216,6 +234,8 @@ public:
                     RS_GraphicView* graphicView=nullptr,
                                         bool handleUndo=true);
 
+    void setProgress(LC_Progress* progress);
+
 	void remove();
 	void revertDirection();
 	bool changeAttributes(RS_AttributesData& data);
@@ -238,6 +258,9 @@ public:
               bool both);
     bool trimAmount(const RS_Vector& trimCoord, RS_AtomicEntity* trimEntity,
                     double dist);
+    bool trimToEdges(const std::vector<RS_Entity*>& trimEntities,
+                     const std::vector<RS_Entity*>& limitEntities,
+                     double maxDistance);
     bool offset(const RS_OffsetData& data);
     bool cut(const RS_Vector& cutCoord, RS_AtomicEntity* cutEntity);
     bool stretch(const RS_Vector& firstCorner,
@@ -256,6 +279,7 @@ public:
 
     bool explode(const bool remove = true);
     bool explodeTextIntoLetters();
+    std::size_t overkill(const RS_OverkillData& data);
     bool moveRef(RS_MoveRefData& data);
 
     bool splitPolyline(RS_Polyline& polyline,
@@ -279,10 +303,14 @@ private:
     void copyLayers(RS_Entity* e);
     void copyBlocks(RS_Entity* e);
     bool pasteLayers(RS_Graphic* source);
-    bool pasteContainer(RS_Entity* entity, RS_EntityContainer* container, QHash<QString, QString>blocksDict, RS_Vector insertionPoint);
+    bool pasteContainer(RS_Entity* entity, RS_EntityContainer* container, QHash<QString, QString>& blocksDict, const RS_Vector& insertionPoint);
     bool pasteEntity(RS_Entity* entity, RS_EntityContainer* container);
     void deselectOriginals(bool remove);
-	void addNewEntities(std::vector<RS_Entity*>& addList);
+	bool addNewEntities(std::vector<RS_Entity*>& addList);
+    void startProgress(int copies);
+    bool advanceProgress(std::size_t steps = 1);
+    std::vector<RS_Entity*> getSelectedEntities() const;
+    void transformInPlace(std::unique_ptr<LC_UndoableTransform> transform, bool keepSelection);
 	bool explodeTextIntoLetters(RS_MText* text, std::vector<RS_Entity*>& addList);
 	bool explodeTextIntoLetters(RS_Text* text, std::vector<RS_Entity*>& addList);
 
@@ -292,6 +320,7 @@ protected:
     RS_Document* document = nullptr;
     RS_GraphicView* graphicView = nullptr;
     bool handleUndo = false;
+    LC_Progress* progress = nullptr;
 };
 
 #endif
@@ -29,6 +29,7 @@
 
 #include "qg_dialogfactory.h"
 
+#include "lc_endpointgraph.h"
 #include "rs_block.h"
 #include "rs_dialogfactory.h"
 #include "rs_entity.h"
@@ -186,54 +187,32 @@ void RS_Selection::selectIntersected(const RS_Vector& v1, const RS_Vector& v2,
                                      bool select) {
 
 	RS_Line line{v1, v2};
-    bool inters;
-
-	for(auto e: *container){
-    //for (unsigned i=0; i<container->count(); ++i) {
-        //RS_Entity* e = container->entityAt(i);
-
-        if (e && e->isVisible()) {
-
-            inters = false;
-
-            // select containers / groups:
-            if (e->isContainer()) {
-                RS_EntityContainer* ec = (RS_EntityContainer*)e;
-
-                for (RS_Entity* e2=ec->firstEntity(RS2::ResolveAll); e2;
-                        e2=ec->nextEntity(RS2::ResolveAll)) {
-
-                    RS_VectorSolutions sol =
-                        RS_Information::getIntersection(&line, e2, true);
-
-                    if (sol.hasValid()) {
-                        inters = true;
-                    }
-                }
-            } else {
-
-                RS_VectorSolutions sol =
-                    RS_Information::getIntersection(&line, e, true);
-
-                if (sol.hasValid()) {
-                    inters = true;
-                }
+    auto intersects = [&line](RS_Entity* e) {
+        // select containers / groups:
+        if (e->isContainer()) {
+            RS_EntityContainer* ec = static_cast<RS_EntityContainer*>(e);
+            for (RS_Entity* e2: ec->resolvedEntities(RS2::ResolveAll)) {
+                if (RS_Information::getIntersection(&line, e2, true).hasValid())
+                    return true;
             }
+            return false;
+        }
+        return RS_Information::getIntersection(&line, e, true).hasValid();
+    };
 
-            if (inters) {
-                if (graphicView) {
-                    graphicView->deleteEntity(e);
-                }
+    std::vector<RS_Entity*> candidates;
+    for (RS_Entity* e: container->getEntitiesCrossingArea(LC_Rect{v1, v2})) {
+        if (e->isVisible())
+            candidates.push_back(e);
+    }
 
-                e->setSelected(select);
+    const std::vector<RS_Entity*> intersected = RS_EntityContainer::filterEntities(candidates, intersects);
+    for (RS_Entity* e: intersected)
+        e->setSelected(select);
 
-                if (graphicView) {
-                    graphicView->drawEntity(e);
-                }
-            }
-        }
+    if (graphicView && !intersected.empty()) {
+        graphicView->redraw();
     }
-
 }
 
 
@@ -255,9 +234,8 @@ void RS_Selection::selectContour(RS_Entity* e) {
 
     bool select = !e->isSelected();
     RS_AtomicEntity* ae = (RS_AtomicEntity*)e;
-    RS_Vector p1 = ae->getStartpoint();
-    RS_Vector p2 = ae->getEndpoint();
-    bool found = false;
+    const RS_Vector p1 = ae->getStartpoint();
+    const RS_Vector p2 = ae->getEndpoint();
 
     // (de)select 1st entity:
     if (graphicView) {
@@ -268,57 +246,24 @@ void RS_Selection::selectContour(RS_Entity* e) {
         graphicView->drawEntity(e);
     }
 
-    do {
-        found = false;
-
-		for(auto en: *container){
-        //for (unsigned i=0; i<container->count(); ++i) {
-            //RS_Entity* en = container->entityAt(i);
-
-            if (en && en->isVisible() && 
-				en->isAtomic() && en->isSelected()!=select && 
-				(!(en->getLayer() && en->getLayer()->isLocked()))) {
-
-                ae = (RS_AtomicEntity*)en;
-                bool doit = false;
-
-                // startpoint connects to 1st point
-                if (ae->getStartpoint().distanceTo(p1)<1.0e-4) {
-                    doit = true;
-                    p1 = ae->getEndpoint();
-                }
-
-                // endpoint connects to 1st point
-                else if (ae->getEndpoint().distanceTo(p1)<1.0e-4) {
-                    doit = true;
-                    p1 = ae->getStartpoint();
-                }
-
-                // startpoint connects to 2nd point
-                else if (ae->getStartpoint().distanceTo(p2)<1.0e-4) {
-                    doit = true;
-                    p2 = ae->getEndpoint();
-                }
-
-                // endpoint connects to 1st point
-                else if (ae->getEndpoint().distanceTo(p2)<1.0e-4) {
-                    doit = true;
-                    p2 = ae->getStartpoint();
-                }
-
-                if (doit) {
-                    if (graphicView) {
-                        graphicView->deleteEntity(ae);
-                    }
-                    ae->setSelected(select);
-                    if (graphicView) {
-                        graphicView->drawEntity(ae);
-                    }
-                    found = true;
-                }
+    // follow the contour from both end points
+    LC_EndpointGraph graph{*container, [select](const RS_Entity* en) {
+        return en->isVisible() && en->isAtomic() && en->isSelected() != select
+                && !(en->getLayer() && en->getLayer()->isLocked());
+    }};
+    for (RS_Vector point: {p1, p2}) {
+        RS_Vector next;
+        while (RS_Entity* en = graph.takeEdge(point, next)) {
+            if (graphicView) {
+                graphicView->deleteEntity(en);
+            }
+            en->setSelected(select);
+            if (graphicView) {
+                graphicView->drawEntity(en);
             }
+            point = next;
         }
-    } while(found);
+    }
 }
 
 
@@ -348,25 +293,67 @@ void RS_Selection::selectLayer(RS_Entity* e) {
  */
 void RS_Selection::selectLayer(const QString& layerName, bool select) {
 
-	for(auto en: *container){
-
-        if (en && en->isVisible() && 
-				en->isSelected()!=select && 
-				(!(en->getLayer() && en->getLayer()->isLocked()))) {
+    RS_Layer* layer = graphic != nullptr ? graphic->findLayer(layerName) : nullptr;
+    if (layer == nullptr || layer->isLocked())
+        return;
 
-            RS_Layer* l = en->getLayer(true);
+	for(auto en: container->getLayerEntities(layer)){
 
-            if (l != nullptr && l->getName()==layerName) {
-                if (graphicView) {
-                    graphicView->deleteEntity(en);
-                }
-                en->setSelected(select);
-                if (graphicView) {
-                    graphicView->drawEntity(en);
-                }
+        if (en->isVisible() && en->isSelected()!=select) {
+            if (graphicView) {
+                graphicView->deleteEntity(en);
+            }
+            en->setSelected(select);
+            if (graphicView) {
+                graphicView->drawEntity(en);
             }
         }
     }
 }
 
+/**
+ * Selects the entities with the same properties as the reference entity.
+ * The entities are selected at once and the view redrawn once.
+ */
+int RS_Selection::selectSimilar(RS_Entity* reference, int properties, bool select) {
+
+    if (reference == nullptr)
+        return 0;
+
+    const RS2::EntityType type = reference->rtti();
+    RS_Layer* layer = reference->getLayer();
+    const RS_Pen pen = reference->getPen(false);
+
+    // entities on the reference layer from the layer index
+    std::vector<RS_Entity*> candidates;
+    if ((properties & SimilarLayer) != 0) {
+        if (layer == nullptr || layer->isLocked())
+            return 0;
+        candidates = container->getLayerEntities(layer);
+    } else {
+        candidates.assign(container->begin(), container->end());
+    }
+
+    auto similar = [=](RS_Entity* e) {
+        if (e->isSelected() == select || !e->isVisible() || e->isLocked())
+            return false;
+        if ((properties & SimilarType) != 0 && e->rtti() != type)
+            return false;
+        if ((properties & (SimilarColor | SimilarLineType | SimilarWidth)) == 0)
+            return true;
+        const RS_Pen ePen = e->getPen(false);
+        return ((properties & SimilarColor) == 0 || ePen.getColor() == pen.getColor())
+                && ((properties & SimilarLineType) == 0 || ePen.getLineType() == pen.getLineType())
+                && ((properties & SimilarWidth) == 0 || ePen.getWidth() == pen.getWidth());
+    };
+    const std::vector<RS_Entity*> found = RS_EntityContainer::filterEntities(candidates, similar);
+    for (RS_Entity* e: found)
+        e->setSelected(select);
+
+    if (graphicView && !found.empty()) {
+        graphicView->redraw();
+    }
+    return static_cast<int>(found.size());
+}
+
 // EOF
@@ -72,6 +72,24 @@ public:
 		selectLayer(layerName, false);
 	}
 
+    /**
+     * Properties compared by selectSimilar(), combined by or
+     */
+    enum SimilarProperty {
+        SimilarType = 1,
+        SimilarLayer = 2,
+        SimilarColor = 4,
+        SimilarLineType = 8,
+        SimilarWidth = 16
+    };
+    /**
+     * @brief selectSimilar selects the visible entities with the same properties as the
+     * reference entity, with the layer only the entities on the layer are visited
+     * @param properties SimilarProperty values to compare, the pens are compared unresolved
+     * @return the number of entities with the selection changed
+     */
+    int selectSimilar(RS_Entity* reference, int properties, bool select=true);
+
 protected:
     RS_EntityContainer* container = nullptr;
     RS_Graphic* graphic = nullptr;
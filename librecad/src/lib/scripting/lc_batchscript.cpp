@@ -0,0 +1,571 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+
+#include "lc_batchscript.h"
+#include "lc_expression.h"
+#include "rs_entitycontainer.h"
+#include "rs_fileio.h"
+#include "rs_filterdxfrw.h"
+#include "rs_graphic.h"
+#include "rs_layer.h"
+#include "rs_math.h"
+#include "rs_modification.h"
+#include "rs_selection.h"
+
+namespace {
+
+struct EntityTypeName {
+    const char* name;
+    RS2::EntityType first;
+    RS2::EntityType last;
+};
+
+// the entity types of the type filter, dimension covers all kinds of dimensions
+const EntityTypeName entityTypeNames[] = {
+    {"point", RS2::EntityPoint, RS2::EntityPoint},
+    {"line", RS2::EntityLine, RS2::EntityLine},
+    {"polyline", RS2::EntityPolyline, RS2::EntityPolyline},
+    {"arc", RS2::EntityArc, RS2::EntityArc},
+    {"circle", RS2::EntityCircle, RS2::EntityCircle},
+    {"ellipse", RS2::EntityEllipse, RS2::EntityEllipse},
+    {"solid", RS2::EntitySolid, RS2::EntitySolid},
+    {"xline", RS2::EntityConstructionLine, RS2::EntityConstructionLine},
+    {"mtext", RS2::EntityMText, RS2::EntityMText},
+    {"text", RS2::EntityText, RS2::EntityText},
+    {"dimension", RS2::EntityDimAligned, RS2::EntityDimLeader},
+    {"hatch", RS2::EntityHatch, RS2::EntityHatch},
+    {"image", RS2::EntityImage, RS2::EntityImage},
+    {"spline", RS2::EntitySpline, RS2::EntitySplinePoints},
+    {"insert", RS2::EntityInsert, RS2::EntityInsert},
+};
+
+/**
+ * @brief splitWords splits a script line at spaces, outside of double quotes,
+ * up to a "#" starting a comment
+ */
+QStringList splitWords(const QString& line)
+{
+    QStringList words;
+    QString word;
+    bool quoted = false;
+    bool inWord = false;
+    for (const QChar c: line) {
+        if (quoted) {
+            if (c == '"')
+                quoted = false;
+            else
+                word += c;
+        } else if (c == '"') {
+            quoted = inWord = true;
+        } else if (c == '#') {
+            break;
+        } else if (c.isSpace()) {
+            if (inWord)
+                words << word;
+            word.clear();
+            inWord = false;
+        } else {
+            word += c;
+            inWord = true;
+        }
+    }
+    if (inWord)
+        words << word;
+    return words;
+}
+
+bool parseColor(const QString& value, RS_Color& color)
+{
+    if (value.compare("bylayer", Qt::CaseInsensitive) == 0) {
+        color = RS_Color(RS2::FlagByLayer);
+        return true;
+    }
+    if (value.compare("byblock", Qt::CaseInsensitive) == 0) {
+        color = RS_Color(RS2::FlagByBlock);
+        return true;
+    }
+    color = RS_Color(value);
+    return color.isValid();
+}
+
+bool parseLineType(const QString& value, RS2::LineType& lineType)
+{
+    lineType = RS_FilterDXFRW::nameToLineType(value);
+    // unknown names are continuous
+    const QString name = value.toUpper();
+    return lineType != RS2::SolidLine || name == "CONTINUOUS" || name == "ACAD_ISO01W100";
+}
+
+bool parseWidth(const QString& value, RS2::LineWidth& width)
+{
+    if (value.compare("bylayer", Qt::CaseInsensitive) == 0) {
+        width = RS2::WidthByLayer;
+    } else if (value.compare("byblock", Qt::CaseInsensitive) == 0) {
+        width = RS2::WidthByBlock;
+    } else if (value.compare("default", Qt::CaseInsensitive) == 0) {
+        width = RS2::WidthDefault;
+    } else {
+        // in 1/100 mm, as in DXF
+        bool ok = false;
+        const int value100 = value.toInt(&ok);
+        if (!ok || value100 < 0)
+            return false;
+        width = RS2::intToLineWidth(value100);
+    }
+    return true;
+}
+
+} // namespace
+
+LC_BatchScript::LC_BatchScript(RS_Graphic* graphic):
+    m_graphic{graphic}
+{
+}
+
+LC_BatchScript::~LC_BatchScript() = default;
+
+const QString& LC_BatchScript::getError() const
+{
+    return m_error;
+}
+
+RS_Graphic* LC_BatchScript::getGraphic() const
+{
+    return m_graphic;
+}
+
+void LC_BatchScript::setVariable(const QString& name, double value)
+{
+    m_variables[name] = value;
+}
+
+void LC_BatchScript::setOutput(std::function<void(const QString&)> output)
+{
+    m_output = std::move(output);
+}
+
+QStringList LC_BatchScript::help()
+{
+    return {
+        "open FILE                     loads a DXF or DWG drawing",
+        "save FILE                     writes the drawing as DXF",
+        "set NAME EXPR                 sets a variable of the expressions",
+        "echo TEXT...                  prints the text, $NAME prints a variable",
+        "count                         prints the number of selected entities",
+        "select [FILTER...]            selects the matching entities, all without filters",
+        "add [FILTER...]               adds the matching entities to the selection",
+        "deselect [FILTER...]          deselects the matching entities",
+        "    filters: type=line,arc,... layer=NAME,... color=COLOR,... linetype=NAME,...",
+        "             width=WIDTH,... window=X1,Y1,X2,Y2 (entities inside)",
+        "move DX DY [COPIES]           moves the selection, or moves copies of it",
+        "rotate CX CY ANGLE [COPIES]   rotates the selection by degrees",
+        "scale CX CY FX [FY [COPIES]]  scales the selection",
+        "mirror X1 Y1 X2 Y2 [copy]     mirrors the selection about the axis",
+        "delete                        deletes the selection",
+        "layer NAME                    moves the selection to the layer, creates it if missing",
+        "color COLOR                   bylayer, byblock, #rrggbb or a color name",
+        "linetype NAME                 bylayer, byblock or a DXF line type name",
+        "width WIDTH                   bylayer, byblock, default or 1/100 mm",
+    };
+}
+
+bool LC_BatchScript::runFile(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_error = QString("cannot read %1: %2").arg(fileName, file.errorString());
+        return false;
+    }
+    return run(QTextStream(&file).readAll());
+}
+
+bool LC_BatchScript::run(const QString& script)
+{
+    m_error.clear();
+    const QStringList lines = script.split('\n');
+    for (int i = 0; i < lines.size(); ++i) {
+        const QStringList words = splitWords(lines.at(i));
+        if (words.isEmpty())
+            continue;
+        if (!runCommand(words)) {
+            m_error = QString("line %1: %2: %3").arg(i + 1).arg(words.first(), m_error);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LC_BatchScript::runCommand(const QStringList& words)
+{
+    const QString command = words.first().toLower();
+    const int argc = words.size() - 1;
+
+    if (command == "set") {
+        if (argc < 2) {
+            m_error = "expected a name and an expression";
+            return false;
+        }
+        double value = 0.;
+        if (!evaluate(words.mid(2).join(' '), value))
+            return false;
+        m_variables[words.at(1)] = value;
+        return true;
+    }
+    if (command == "echo") {
+        QStringList out;
+        for (int i = 1; i <= argc; ++i) {
+            const QString& word = words.at(i);
+            const auto it = word.startsWith('$') ? m_variables.find(word.mid(1))
+                                                 : m_variables.end();
+            out << (it != m_variables.end() ? QString::number(it->second, 'g', 12) : word);
+        }
+        print(out.join(' '));
+        return true;
+    }
+    if (command == "open") {
+        if (argc != 1) {
+            m_error = "expected a file";
+            return false;
+        }
+        auto graphic = std::make_unique<RS_Graphic>();
+        if (!RS_FileIO::instance()->fileImport(*graphic, words.at(1))) {
+            m_error = "cannot load " + words.at(1);
+            return false;
+        }
+        m_ownedGraphic = std::move(graphic);
+        m_graphic = m_ownedGraphic.get();
+        return true;
+    }
+
+    // the other commands edit the drawing
+    if (m_graphic == nullptr) {
+        m_error = "no drawing, open one first";
+        return false;
+    }
+
+    if (command == "save") {
+        if (argc != 1) {
+            m_error = "expected a file";
+            return false;
+        }
+        if (!RS_FileIO::instance()->fileExport(*m_graphic, words.at(1), RS2::FormatDXFRW)) {
+            m_error = "cannot write " + words.at(1);
+            return false;
+        }
+        return true;
+    }
+    if (command == "count") {
+        print(QString::number(m_graphic->countSelected(false)));
+        return true;
+    }
+    if (command == "select" || command == "add" || command == "deselect")
+        return select(words.mid(1), command != "deselect", command == "select");
+    if (command == "layer" || command == "color" || command == "linetype"
+        || command == "width") {
+        if (argc != 1) {
+            m_error = "expected a value";
+            return false;
+        }
+        return changeAttributes(command, words.at(1));
+    }
+
+    RS_Modification modification(*m_graphic);
+    std::vector<double> values;
+    if (command == "delete") {
+        modification.remove();
+        return true;
+    }
+    if (command == "move") {
+        if (!evaluate(words, 1, 3, values) || values.size() < 2)
+            return false;
+        RS_MoveData data;
+        data.offset = {values[0], values[1]};
+        data.number = values.size() > 2 ? int(values[2]) : 0;
+        return modification.move(data);
+    }
+    if (command == "rotate") {
+        if (!evaluate(words, 1, 4, values) || values.size() < 3)
+            return false;
+        RS_RotateData data;
+        data.center = {values[0], values[1]};
+        data.angle = RS_Math::deg2rad(values[2]);
+        data.number = values.size() > 3 ? int(values[3]) : 0;
+        return modification.rotate(data);
+    }
+    if (command == "scale") {
+        if (!evaluate(words, 1, 5, values) || values.size() < 3)
+            return false;
+        RS_ScaleData data;
+        data.referencePoint = {values[0], values[1]};
+        data.factor = {values[2], values.size() > 3 ? values[3] : values[2]};
+        data.number = values.size() > 4 ? int(values[4]) : 0;
+        return modification.scale(data);
+    }
+    if (command == "mirror") {
+        const bool copy = argc == 5 && words.at(5).compare("copy", Qt::CaseInsensitive) == 0;
+        if (argc != (copy ? 5 : 4)) {
+            m_error = "expected two axis points and an optional copy";
+            return false;
+        }
+        if (!evaluate(words.mid(0, 5), 1, 4, values))
+            return false;
+        RS_MirrorData data;
+        data.axisPoint1 = {values[0], values[1]};
+        data.axisPoint2 = {values[2], values[3]};
+        data.copy = copy;
+        return modification.mirror(data);
+    }
+
+    m_error = "unknown command";
+    return false;
+}
+
+bool LC_BatchScript::evaluate(const QString& expression, double& value)
+{
+    QStringList names;
+    for (const auto& [name, variable]: m_variables)
+        names << name;
+    LC_Expression parsed(expression, names);
+    if (!parsed.isValid()) {
+        m_error = parsed.getError();
+        return false;
+    }
+    for (const auto& [name, variable]: m_variables)
+        parsed.setVariable(name, variable);
+    bool ok = false;
+    value = parsed.evaluate(&ok);
+    if (!ok) {
+        m_error = "cannot evaluate " + expression;
+        return false;
+    }
+    return true;
+}
+
+bool LC_BatchScript::evaluate(const QStringList& words, int first, int count,
+                              std::vector<double>& values)
+{
+    if (words.size() > first + count) {
+        m_error = QString("expected at most %1 numbers").arg(count);
+        return false;
+    }
+    values.clear();
+    for (int i = first; i < words.size(); ++i) {
+        double value = 0.;
+        if (!evaluate(words.at(i), value))
+            return false;
+        values.push_back(value);
+    }
+    return true;
+}
+
+std::function<bool(RS_Entity*)> LC_BatchScript::parseFilters(const QStringList& filters)
+{
+    std::vector<std::function<bool(RS_Entity*)>> tests;
+    for (const QString& filter: filters) {
+        const int separator = filter.indexOf('=');
+        if (separator <= 0) {
+            m_error = "expected NAME=VALUES: " + filter;
+            return {};
+        }
+        const QString name = filter.left(separator).toLower();
+        const QStringList values = filter.mid(separator + 1).split(',', Qt::SkipEmptyParts);
+        if (values.isEmpty()) {
+            m_error = "no values: " + filter;
+            return {};
+        }
+
+        if (name == "type") {
+            std::vector<std::pair<RS2::EntityType, RS2::EntityType>> ranges;
+            for (const QString& value: values) {
+                bool found = false;
+                for (const EntityTypeName& type: entityTypeNames) {
+                    if (value.compare(type.name, Qt::CaseInsensitive) == 0) {
+                        ranges.emplace_back(type.first, type.last);
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    m_error = "unknown entity type: " + value;
+                    return {};
+                }
+            }
+            tests.push_back([ranges](RS_Entity* e) {
+                const RS2::EntityType type = e->rtti();
+                for (const auto& [first, last]: ranges)
+                    if (type >= first && type <= last)
+                        return true;
+                return false;
+            });
+        } else if (name == "layer") {
+            tests.push_back([values](RS_Entity* e) {
+                const RS_Layer* layer = e->getLayer();
+                return layer != nullptr && values.contains(layer->getName(), Qt::CaseInsensitive);
+            });
+        } else if (name == "color") {
+            std::vector<RS_Color> colors;
+            for (const QString& value: values) {
+                RS_Color color;
+                if (!parseColor(value, color)) {
+                    m_error = "unknown color: " + value;
+                    return {};
+                }
+                colors.push_back(color);
+            }
+            tests.push_back([colors](RS_Entity* e) {
+                const RS_Color color = e->getPen(false).getColor();
+                return std::find(colors.cbegin(), colors.cend(), color) != colors.cend();
+            });
+        } else if (name == "linetype") {
+            std::vector<RS2::LineType> lineTypes;
+            for (const QString& value: values) {
+                RS2::LineType lineType = RS2::SolidLine;
+                if (!parseLineType(value, lineType)) {
+                    m_error = "unknown line type: " + value;
+                    return {};
+                }
+                lineTypes.push_back(lineType);
+            }
+            tests.push_back([lineTypes](RS_Entity* e) {
+                const RS2::LineType lineType = e->getPen(false).getLineType();
+                return std::find(lineTypes.cbegin(), lineTypes.cend(), lineType)
+                       != lineTypes.cend();
+            });
+        } else if (name == "width") {
+            std::vector<RS2::LineWidth> widths;
+            for (const QString& value: values) {
+                RS2::LineWidth width = RS2::WidthDefault;
+                if (!parseWidth(value, width)) {
+                    m_error = "unknown line width: " + value;
+                    return {};
+                }
+                widths.push_back(width);
+            }
+            tests.push_back([widths](RS_Entity* e) {
+                const RS2::LineWidth width = e->getPen(false).getWidth();
+                return std::find(widths.cbegin(), widths.cend(), width) != widths.cend();
+            });
+        } else if (name == "window") {
+            std::vector<double> corners;
+            if (!evaluate(values, 0, 4, corners) || corners.size() != 4) {
+                if (m_error.isEmpty())
+                    m_error = "expected X1,Y1,X2,Y2: " + filter;
+                return {};
+            }
+            const RS_Vector minimum{std::min(corners[0], corners[2]),
+                                    std::min(corners[1], corners[3])};
+            const RS_Vector maximum{std::max(corners[0], corners[2]),
+                                    std::max(corners[1], corners[3])};
+            tests.push_back([minimum, maximum](RS_Entity* e) {
+                return e->isInWindow(minimum, maximum);
+            });
+        } else {
+            m_error = "unknown filter: " + name;
+            return {};
+        }
+    }
+    return [tests = std::move(tests)](RS_Entity* e) {
+        for (const auto& test: tests)
+            if (!test(e))
+                return false;
+        return true;
+    };
+}
+
+bool LC_BatchScript::select(const QStringList& filters, bool select, bool replace)
+{
+    m_error.clear();
+    const std::function<bool(RS_Entity*)> test = parseFilters(filters);
+    if (!test)
+        return false;
+
+    if (replace) {
+        RS_Selection selection(*m_graphic);
+        selection.selectAll(false);
+    }
+
+    const std::vector<RS_Entity*> candidates(m_graphic->begin(), m_graphic->end());
+    const std::vector<RS_Entity*> found = RS_EntityContainer::filterEntities(candidates,
+        [select, &test](RS_Entity* e) {
+            return e->isSelected() != select && e->isVisible() && !e->isLocked() && test(e);
+        });
+    for (RS_Entity* e: found)
+        e->setSelected(select);
+
+    m_variables["count"] = m_graphic->countSelected(false);
+    return true;
+}
+
+bool LC_BatchScript::changeAttributes(const QString& property, const QString& value)
+{
+    RS_AttributesData data;
+    if (property == "layer") {
+        if (m_graphic->findLayer(value) == nullptr)
+            m_graphic->addLayer(new RS_Layer(value));
+        data.layer = value;
+        data.changeLayer = true;
+    } else if (property == "color") {
+        RS_Color color;
+        if (!parseColor(value, color)) {
+            m_error = "unknown color: " + value;
+            return false;
+        }
+        data.pen.setColor(color);
+        data.changeColor = true;
+    } else if (property == "linetype") {
+        RS2::LineType lineType = RS2::SolidLine;
+        if (!parseLineType(value, lineType)) {
+            m_error = "unknown line type: " + value;
+            return false;
+        }
+        data.pen.setLineType(lineType);
+        data.changeLineType = true;
+    } else {
+        RS2::LineWidth width = RS2::WidthDefault;
+        if (!parseWidth(value, width)) {
+            m_error = "unknown line width: " + value;
+            return false;
+        }
+        data.pen.setWidth(width);
+        data.changeWidth = true;
+    }
+    RS_Modification modification(*m_graphic);
+    return modification.changeAttributes(data);
+}
+
+void LC_BatchScript::print(const QString& text) const
+{
+    if (m_output)
+        m_output(text);
+    else
+        qDebug().noquote() << text;
+}
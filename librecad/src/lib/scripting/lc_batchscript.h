@@ -0,0 +1,106 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_BATCHSCRIPT_H
+#define LC_BATCHSCRIPT_H
+
+#include <functional>
+#include <map>
+#include <memory>
+
+#include <QString>
+#include <QStringList>
+
+class RS_Entity;
+class RS_Graphic;
+
+/**
+ * Runs scripts of batch edits on a drawing, without a view.
+ *
+ * A script has one command per line, "#" starts a comment and arguments with
+ * spaces are quoted. The commands work on the selected top level entities at
+ * once, through the bulk operations of RS_Modification:
+ *
+ * @code
+ * open "plan.dxf"
+ * set dx 2.5 * 4
+ * select type=line,arc layer=walls
+ * move dx 0
+ * select type=text window=0,0,100,50
+ * layer labels
+ * color #ff0000
+ * echo moved $count texts
+ * save "plan-edited.dxf"
+ * @endcode
+ *
+ * Numbers are expressions, see LC_Expression, with the variables set by
+ * "set" and "count", the number of entities selected by the last selection.
+ * The selections take filters: type, layer, color, linetype, width (lists
+ * separated by commas) and window=x1,y1,x2,y2 for entities inside the window.
+ * See help() for the commands.
+ */
+class LC_BatchScript {
+public:
+    /**
+     * @param graphic drawing to edit, the commands open and save replace and write it;
+     * a drawing is created by open, if not given
+     */
+    explicit LC_BatchScript(RS_Graphic* graphic = nullptr);
+    ~LC_BatchScript();
+
+    //! runs the script, stops at the first failed command
+    bool run(const QString& script);
+    //! runs the script file
+    bool runFile(const QString& fileName);
+
+    //! @return the error of the failed command, with its line
+    const QString& getError() const;
+    //! @return the edited drawing, nullptr before open if none was given
+    RS_Graphic* getGraphic() const;
+    //! sets a variable for the expressions of the script
+    void setVariable(const QString& name, double value);
+    //! the output of echo and count, to the debug output by default
+    void setOutput(std::function<void(const QString&)> output);
+
+    //! @return the description of the commands
+    static QStringList help();
+
+private:
+    bool runCommand(const QStringList& words);
+    bool evaluate(const QString& expression, double& value);
+    bool evaluate(const QStringList& words, int first, int count, std::vector<double>& values);
+    bool select(const QStringList& filters, bool select, bool replace);
+    std::function<bool(RS_Entity*)> parseFilters(const QStringList& filters);
+    bool changeAttributes(const QString& property, const QString& value);
+    void print(const QString& text) const;
+
+    std::unique_ptr<RS_Graphic> m_ownedGraphic;
+    RS_Graphic* m_graphic = nullptr;
+    std::map<QString, double> m_variables;
+    std::function<void(const QString&)> m_output;
+    QString m_error;
+};
+
+#endif // LC_BATCHSCRIPT_H
@@ -0,0 +1,399 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include "main.h"
+
+#include "console_benchmark.h"
+#include "lc_drawinggenerator.h"
+#include "lc_undosection.h"
+#include "rs.h"
+#include "rs_debug.h"
+#include "rs_fileio.h"
+#include "rs_fontlist.h"
+#include "rs_graphic.h"
+#include "rs_hatch.h"
+#include "rs_line.h"
+#include "rs_painterqt.h"
+#include "rs_patternlist.h"
+#include "rs_settings.h"
+#include "rs_staticgraphicview.h"
+#include "rs_system.h"
+#include "rs_text.h"
+
+namespace {
+
+// side of the square the generated entities are placed in, in drawing units
+constexpr double drawingSize = 1000.;
+// number of query points for snapping and windows for selecting
+constexpr int queryCount = 1000;
+constexpr int windowCount = 100;
+
+/**
+ * Times cases, each for a number of iterations after one warm up run, and collects
+ * the timings as JSON
+ */
+class Benchmark {
+public:
+    explicit Benchmark(int iterations):
+        m_iterations{std::max(iterations, 1)}
+    {}
+
+    /**
+     * @brief run times the case
+     * @param name - the name in the results
+     * @param timed - the timed code
+     * @param prepare - called before each run, not timed
+     */
+    void run(const QString& name, const std::function<void()>& timed,
+             const std::function<void()>& prepare = {})
+    {
+        std::vector<double> times;
+        for (int i = 0; i <= m_iterations; ++i) {
+            if (prepare)
+                prepare();
+            QElapsedTimer timer;
+            timer.start();
+            timed();
+            // the first run warms up caches
+            if (i > 0)
+                times.push_back(timer.nsecsElapsed() * 1e-6);
+        }
+        std::sort(times.begin(), times.end());
+        QJsonObject result;
+        result["name"] = name;
+        result["iterations"] = m_iterations;
+        result["min_ms"] = times.front();
+        result["median_ms"] = times[times.size() / 2];
+        result["mean_ms"] = std::accumulate(times.cbegin(), times.cend(), 0.) / times.size();
+        result["max_ms"] = times.back();
+        m_results.append(result);
+        qDebug() << qPrintable(name) << times[times.size() / 2] << "ms";
+    }
+
+    /**
+     * @brief addDrawStatistics adds the counters of drawing a frame to the last result
+     */
+    void addDrawStatistics(const RS_GraphicView::DrawStatistics& statistics)
+    {
+        QJsonObject result = m_results.last().toObject();
+        result["entities_visited"] = qint64(statistics.visited);
+        result["entities_culled"] = qint64(statistics.culled);
+        result["entities_drawn"] = qint64(statistics.drawn);
+        result["pen_changes"] = qint64(statistics.penChanges);
+        result["painter_calls"] = qint64(statistics.painterCalls);
+        m_results[m_results.size() - 1] = result;
+    }
+
+    QJsonArray getResults() const
+    {
+        return m_results;
+    }
+
+private:
+    const int m_iterations;
+    QJsonArray m_results;
+};
+
+void draw(RS_StaticGraphicView& view, RS_PainterQt& painter, QImage& image, RS_Graphic& graphic)
+{
+    painter.eraseRect(0, 0, image.width(), image.height());
+    view.drawEntity(&painter, &graphic);
+    // the batched lines are part of the drawing, and must not be erased by the next one
+    painter.flush();
+}
+}
+
+/////////
+/// \brief console_benchmark is called if librecad
+/// as console benchmark for timing the core operations.
+/// \param argc
+/// \param argv
+/// \return
+///
+int console_benchmark(int argc, char* argv[])
+{
+    RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
+
+    setHeadlessPlatform();
+    QApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QFileInfo prgInfo(QFile::decodeName(argv[0]));
+    QString prgDir(prgInfo.absolutePath());
+    RS_SETTINGS->init(app.organizationName(), app.applicationName());
+    RS_SYSTEM->init(app.applicationName(), app.applicationVersion(),
+        XSTR(QC_APPDIR), prgDir.toLatin1().data());
+
+    QCommandLineParser parser;
+
+    QString appDesc = "\nTime import, export, drawing, snapping, selecting, hatching, text"
+                      " layout and undo.";
+    appDesc += "\n\n";
+    appDesc += "The drawing is generated from the seed, so runs with equal options are"
+               " comparable;\n";
+    appDesc += "a DXF or DWG file given instead is imported and used for the other cases.\n";
+    appDesc += "The results are written as JSON, with the minimum, median, mean and maximum"
+               " time of each case.\n";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption outFileOpt(QStringList() << "o" << "outfile",
+        "Output JSON file, standard output by default.", "file");
+    parser.addOption(outFileOpt);
+
+    QCommandLineOption entitiesOpt(QStringList() << "n" << "entities",
+        "Number of generated entities.", "integer", "20000");
+    parser.addOption(entitiesOpt);
+
+    QCommandLineOption seedOpt(QStringList() << "s" << "seed",
+        "Seed of the generated drawing.", "integer", "1");
+    parser.addOption(seedOpt);
+
+    QCommandLineOption iterationsOpt(QStringList() << "i" << "iterations",
+        "Number of timed runs of each case.", "integer", "5");
+    parser.addOption(iterationsOpt);
+
+    QCommandLineOption resolutionOpt(QStringList() << "r" << "resolution",
+        "Size of the drawn view.", "WxH", "1920x1080");
+    parser.addOption(resolutionOpt);
+
+    parser.addPositionalArgument("<file>", "Optional DXF or DWG file to benchmark.");
+
+    parser.process(app);
+
+    const auto readNumber = [&parser](const QCommandLineOption& option, int defaultValue) {
+        bool ok = false;
+        const int value = parser.value(option).toInt(&ok);
+        if (!ok || value < 1) {
+            qDebug() << "WARNING: Ignoring bad value of" << option.names().last() << ":"
+                     << parser.value(option);
+            return defaultValue;
+        }
+        return value;
+    };
+    const int entities = readNumber(entitiesOpt, 20000);
+    const unsigned seed = unsigned(readNumber(seedOpt, 1));
+    const int iterations = readNumber(iterationsOpt, 5);
+
+    QSize resolution{1920, 1080};
+    const QStringList sizes = parser.value(resolutionOpt).split('x');
+    if (sizes.size() == 2 && sizes[0].toInt() > 0 && sizes[1].toInt() > 0)
+        resolution = {sizes[0].toInt(), sizes[1].toInt()};
+    else
+        qDebug() << "WARNING: Ignoring bad resolution:" << parser.value(resolutionOpt);
+
+    const QStringList files = parser.positionalArguments();
+    const QString file = files.isEmpty() ? QString{} : files.first();
+
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        qDebug() << "ERROR: Cannot create a temporary directory";
+        return 1;
+    }
+
+    RS_FONTLIST->init();
+    RS_PATTERNLIST->init();
+
+    Benchmark benchmark{iterations};
+    LC_DrawingGenerator generator{seed};
+
+    // the drawing for the cases
+    auto graphic = std::make_unique<RS_Graphic>();
+    if (file.isEmpty()) {
+        LC_DrawingGenerator::Parameters parameters;
+        parameters.size = drawingSize;
+        parameters.lines = entities * 6 / 10;
+        parameters.circles = entities / 5;
+        parameters.arcs = entities - parameters.lines - parameters.circles;
+        generator.generate(*graphic, parameters);
+        const QString dxfFile = tempDir.filePath("benchmark.dxf");
+        benchmark.run("export_dxf", [&]() {
+            RS_FileIO::instance()->fileExport(*graphic, dxfFile, RS2::FormatDXFRW);
+        });
+        benchmark.run("import_dxf", [&]() {
+            RS_Graphic imported;
+            RS_FileIO::instance()->fileImport(imported, dxfFile);
+        });
+    } else {
+        if (!RS_FileIO::instance()->fileImport(*graphic, file)) {
+            qDebug() << "ERROR: Cannot open" << file;
+            return 1;
+        }
+        benchmark.run("import_file", [&]() {
+            RS_Graphic imported;
+            RS_FileIO::instance()->fileImport(imported, file);
+        });
+        // DWG files are exported as DXF
+        benchmark.run("export_dxf", [&]() {
+            RS_FileIO::instance()->fileExport(*graphic, tempDir.filePath("benchmark.dxf"),
+                                              RS2::FormatDXFRW);
+        });
+    }
+    graphic->calculateBorders();
+
+    // drawing
+    QImage image(resolution, QImage::Format_ARGB32_Premultiplied);
+    RS_PainterQt painter(&image);
+    painter.setBackground(Qt::white);
+    RS_StaticGraphicView view(image.width(), image.height(), &painter);
+    view.setContainer(graphic.get());
+    for (double zoom: {1., 4., 16.}) {
+        view.zoomAuto(false);
+        view.zoomIn(zoom, (graphic->getMin() + graphic->getMax()) * 0.5);
+        benchmark.run(QString("redraw_zoom_%1").arg(zoom), [&]() {
+            draw(view, painter, image, *graphic);
+        });
+        view.resetDrawStatistics();
+        draw(view, painter, image, *graphic);
+        benchmark.addDrawStatistics(view.getDrawStatistics());
+    }
+    // a sequence of pans of a zoomed view, each drawn
+    benchmark.run("pan_20_steps", [&]() {
+        for (int i = 0; i < 20; ++i) {
+            view.zoomPan(i < 10 ? 37 : -37, i < 10 ? 23 : -23);
+            draw(view, painter, image, *graphic);
+        }
+    }, [&]() {
+        view.zoomAuto(false);
+        view.zoomIn(4., (graphic->getMin() + graphic->getMax()) * 0.5);
+    });
+
+    // snapping under the cursor, at reproducible points of the drawing
+    std::vector<RS_Vector> queries;
+    const RS_Vector min = graphic->getMin();
+    const RS_Vector extent = graphic->getMax() - min;
+    for (int i = 0; i < queryCount; ++i) {
+        const RS_Vector p = generator.point(1.);
+        queries.emplace_back(min.x + p.x * extent.x, min.y + p.y * extent.y);
+    }
+    const double snapRange = std::max(extent.x, extent.y) / 100.;
+    benchmark.run("snap_endpoint", [&]() {
+        for (const RS_Vector& query: queries)
+            graphic->getNearestEndpoint(query, nullptr);
+    });
+    benchmark.run("snap_on_entity", [&]() {
+        for (const RS_Vector& query: queries)
+            graphic->getNearestPointOnEntity(query, true, nullptr);
+    });
+    benchmark.run("snap_entity_in_range", [&]() {
+        double dist = 0.;
+        for (const RS_Vector& query: queries)
+            graphic->getNearestEntity(query, snapRange, &dist, RS2::ResolveAll);
+    });
+
+    // window selection of boxes of a tenth of the drawing
+    benchmark.run("select_window", [&]() {
+        for (int i = 0; i < windowCount; ++i) {
+            const RS_Vector& corner = queries[i];
+            const RS_Vector opposite = corner + extent * 0.1;
+            graphic->selectWindow(RS2::EntityUnknown, corner, opposite, true, false);
+            graphic->selectWindow(RS2::EntityUnknown, corner, opposite, false, false);
+        }
+    });
+    benchmark.run("select_crossing", [&]() {
+        for (int i = 0; i < windowCount; ++i) {
+            const RS_Vector& corner = queries[i];
+            const RS_Vector opposite = corner + extent * 0.1;
+            graphic->selectWindow(RS2::EntityUnknown, corner, opposite, true, true);
+            graphic->selectWindow(RS2::EntityUnknown, corner, opposite, false, true);
+        }
+    });
+
+    // regeneration of hatches and texts, in a separate drawing
+    RS_Graphic details;
+    const std::vector<RS_Hatch*> hatches = generator.addHatches(details, 200, 1, 4, drawingSize);
+    benchmark.run("hatch_update", [&]() {
+        for (RS_Hatch* hatch: hatches)
+            hatch->update();
+    });
+    const std::vector<RS_Text*> texts = generator.addTexts(details, 1000, drawingSize);
+    benchmark.run("text_update", [&]() {
+        for (RS_Text* text: texts)
+            text->update();
+    });
+
+    // undo and redo of cycles adding lines
+    RS_Graphic undoGraphic;
+    for (int i = 0; i < 100; ++i) {
+        LC_UndoSection undo(&undoGraphic);
+        for (int j = 0; j < 10; ++j) {
+            const RS_Vector start = generator.point(drawingSize);
+            auto line = new RS_Line(&undoGraphic, start, start + generator.point(40.));
+            undoGraphic.addEntity(line);
+            undo.addUndoable(line);
+        }
+    }
+    benchmark.run("undo_redo_100_cycles", [&]() {
+        while (undoGraphic.undo()) {}
+        while (undoGraphic.redo()) {}
+    });
+
+    painter.flushAndEnd();
+
+    QJsonObject report;
+    report["librecad"] = QString(XSTR(LC_VERSION));
+    report["qt"] = QString(qVersion());
+    report["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["file"] = file;
+    report["seed"] = int(seed);
+    report["entities"] = int(graphic->count());
+    report["resolution"] = QJsonArray{resolution.width(), resolution.height()};
+    report["results"] = benchmark.getResults();
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (!parser.isSet(outFileOpt)) {
+        QFile out;
+        out.open(stdout, QIODevice::WriteOnly);
+        out.write(json);
+        return 0;
+    }
+    QFile out(parser.value(outFileOpt));
+    if (!out.open(QIODevice::WriteOnly) || out.write(json) != json.size()) {
+        qDebug() << "ERROR: Cannot write" << parser.value(outFileOpt);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,390 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <string>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "main.h"
+
+#include "console_dwgcorpus.h"
+#include "drw_interface.h"
+#include "libdwgr.h"
+
+namespace {
+
+/**
+ * Counts the tables, blocks and entities read, by their DXF names
+ */
+class CountingInterface : public DRW_Interface {
+public:
+    const std::map<std::string, int>& getCounts() const
+    {
+        return m_counts;
+    }
+
+    void addHeader(const DRW_Header*) override {}
+    void addLType(const DRW_LType&) override { count("LTYPE"); }
+    void addLayer(const DRW_Layer&) override { count("LAYER"); }
+    void addDimStyle(const DRW_Dimstyle&) override { count("DIMSTYLE"); }
+    void addVport(const DRW_Vport&) override { count("VPORT"); }
+    void addTextStyle(const DRW_Textstyle&) override { count("STYLE"); }
+    void addAppId(const DRW_AppId&) override { count("APPID"); }
+    void addBlock(const DRW_Block&) override { count("BLOCK"); }
+    void setBlock(const int) override {}
+    void endBlock() override {}
+    void addPoint(const DRW_Point&) override { count("POINT"); }
+    void addLine(const DRW_Line&) override { count("LINE"); }
+    void addRay(const DRW_Ray&) override { count("RAY"); }
+    void addXline(const DRW_Xline&) override { count("XLINE"); }
+    void addArc(const DRW_Arc&) override { count("ARC"); }
+    void addCircle(const DRW_Circle&) override { count("CIRCLE"); }
+    void addEllipse(const DRW_Ellipse&) override { count("ELLIPSE"); }
+    void addLWPolyline(const DRW_LWPolyline&) override { count("LWPOLYLINE"); }
+    void addPolyline(const DRW_Polyline&) override { count("POLYLINE"); }
+    void addSpline(const DRW_Spline*) override { count("SPLINE"); }
+    void addKnot(const DRW_Entity&) override {}
+    void addInsert(const DRW_Insert&) override { count("INSERT"); }
+    void addTrace(const DRW_Trace&) override { count("TRACE"); }
+    void add3dFace(const DRW_3Dface&) override { count("3DFACE"); }
+    void addSolid(const DRW_Solid&) override { count("SOLID"); }
+    void addMText(const DRW_MText&) override { count("MTEXT"); }
+    void addText(const DRW_Text&) override { count("TEXT"); }
+    void addDimAlign(const DRW_DimAligned*) override { count("DIMENSION aligned"); }
+    void addDimLinear(const DRW_DimLinear*) override { count("DIMENSION linear"); }
+    void addDimRadial(const DRW_DimRadial*) override { count("DIMENSION radial"); }
+    void addDimDiametric(const DRW_DimDiametric*) override { count("DIMENSION diametric"); }
+    void addDimAngular(const DRW_DimAngular*) override { count("DIMENSION angular"); }
+    void addDimAngular3P(const DRW_DimAngular3p*) override { count("DIMENSION angular 3p"); }
+    void addDimOrdinate(const DRW_DimOrdinate*) override { count("DIMENSION ordinate"); }
+    void addLeader(const DRW_Leader*) override { count("LEADER"); }
+    void addHatch(const DRW_Hatch*) override { count("HATCH"); }
+    void addViewport(const DRW_Viewport&) override { count("VIEWPORT"); }
+    void addImage(const DRW_Image*) override { count("IMAGE"); }
+    void linkImage(const DRW_ImageDef*) override { count("IMAGEDEF"); }
+    void addComment(const char*) override {}
+    void addPlotSettings(const DRW_PlotSettings*) override { count("PLOTSETTINGS"); }
+
+    // the reader doesn't write
+    void writeHeader(DRW_Header&) override {}
+    void writeBlocks() override {}
+    void writeBlockRecords() override {}
+    void writeEntities() override {}
+    void writeLTypes() override {}
+    void writeLayers() override {}
+    void writeTextstyles() override {}
+    void writeVports() override {}
+    void writeDimstyles() override {}
+    void writeObjects() override {}
+    void writeAppId() override {}
+
+private:
+    void count(const char* type)
+    {
+        ++m_counts[type];
+    }
+
+    std::map<std::string, int> m_counts;
+};
+
+QString getVersionName(DRW::Version version)
+{
+    for (const auto& [name, value]: DRW::dwgVersionStrings) {
+        if (value == version)
+            return name;
+    }
+    return "unknown";
+}
+
+QString getErrorName(DRW::error error)
+{
+    switch (error) {
+    case DRW::BAD_NONE: return "none";
+    case DRW::BAD_UNKNOWN: return "unknown";
+    case DRW::BAD_OPEN: return "open";
+    case DRW::BAD_VERSION: return "version";
+    case DRW::BAD_READ_METADATA: return "metadata";
+    case DRW::BAD_READ_FILE_HEADER: return "file header";
+    case DRW::BAD_READ_HEADER: return "header";
+    case DRW::BAD_READ_HANDLES: return "handles";
+    case DRW::BAD_READ_CLASSES: return "classes";
+    case DRW::BAD_READ_TABLES: return "tables";
+    case DRW::BAD_READ_BLOCKS: return "blocks";
+    case DRW::BAD_READ_ENTITIES: return "entities";
+    case DRW::BAD_READ_OBJECTS: return "objects";
+    case DRW::BAD_READ_SECTION: return "section";
+    case DRW::BAD_CODE_PARSED: return "code parsed";
+    default: return "unknown";
+    }
+}
+
+double getMegabytesPerSecond(double bytes, double ms)
+{
+    return (ms > 0.) ? bytes / (1024. * 1024.) / (ms * 1e-3) : 0.;
+}
+
+/**
+ * @brief readFile reads the file the given number of times
+ * @return the result of the file with the fastest read time
+ */
+QJsonObject readFile(const QString& path, int iterations, int threads)
+{
+    QJsonObject result;
+    double bestMs = std::numeric_limits<double>::max();
+    for (int i = 0; i < iterations; ++i) {
+        CountingInterface counter;
+        dwgR reader(QFile::encodeName(path).constData());
+        reader.setReadThreads(threads);
+        QElapsedTimer timer;
+        timer.start();
+        const bool ok = reader.read(&counter, false);
+        const double ms = timer.nsecsElapsed() * 1e-6;
+        if (i == 0) {
+            // the counts and errors don't depend on the run
+            QJsonObject entities;
+            int total = 0;
+            for (const auto& [type, number]: counter.getCounts()) {
+                entities[QString::fromStdString(type)] = number;
+                total += number;
+            }
+            result["version"] = getVersionName(reader.getVersion());
+            result["ok"] = ok;
+            result["error"] = getErrorName(reader.getError());
+            result["entities"] = entities;
+            result["total"] = total;
+        }
+        bestMs = std::min(bestMs, ms);
+    }
+    const qint64 bytes = QFileInfo(path).size();
+    result["bytes"] = bytes;
+    result["ms"] = bestMs;
+    result["mb_per_s"] = getMegabytesPerSecond(bytes, bestMs);
+    return result;
+}
+
+/**
+ * @brief compare reports differences of the report to the baseline: files read
+ * differently are changed, and versions read more slowly than the threshold
+ * are regressions
+ * @return the number of changes and regressions
+ */
+int compare(const QJsonObject& report, const QJsonObject& baseline, double threshold)
+{
+    int failures = 0;
+    const QJsonObject files = report["files"].toObject();
+    const QJsonObject baseFiles = baseline["files"].toObject();
+    for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+        if (!baseFiles.contains(it.key())) {
+            qDebug().noquote() << "NEW" << it.key();
+            continue;
+        }
+        const QJsonObject file = it.value().toObject();
+        const QJsonObject baseFile = baseFiles[it.key()].toObject();
+        if (file["error"] != baseFile["error"]) {
+            qDebug().noquote() << "CHANGED" << it.key() << "error" << baseFile["error"].toString()
+                               << "->" << file["error"].toString();
+            ++failures;
+        }
+        if (file["entities"] != baseFile["entities"]) {
+            qDebug().noquote() << "CHANGED" << it.key() << "entities" << baseFile["total"].toInt()
+                               << "->" << file["total"].toInt();
+            ++failures;
+        }
+    }
+    for (auto it = baseFiles.constBegin(); it != baseFiles.constEnd(); ++it) {
+        if (!files.contains(it.key()))
+            qDebug().noquote() << "MISSING" << it.key();
+    }
+
+    const QJsonObject versions = report["versions"].toObject();
+    const QJsonObject baseVersions = baseline["versions"].toObject();
+    for (auto it = versions.constBegin(); it != versions.constEnd(); ++it) {
+        const double speed = it.value().toObject()["mb_per_s"].toDouble();
+        const double baseSpeed = baseVersions[it.key()].toObject()["mb_per_s"].toDouble();
+        if (baseSpeed <= 0.)
+            continue;
+        const double change = (speed - baseSpeed) / baseSpeed * 100.;
+        if (change < -threshold) {
+            qDebug().noquote() << "SLOWER" << it.key() << baseSpeed << "->" << speed << "MB/s";
+            ++failures;
+        } else if (change > threshold) {
+            qDebug().noquote() << "FASTER" << it.key() << baseSpeed << "->" << speed << "MB/s";
+        }
+    }
+    return failures;
+}
+
+QJsonObject readJson(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "ERROR: Cannot read" << fileName;
+        return {};
+    }
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+}
+
+int console_dwgcorpus(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QCommandLineParser parser;
+
+    QString appDesc = "\nRead the DWG files of a directory and its subdirectories.";
+    appDesc += "\n\n";
+    appDesc += "The entities read per type, the reader errors and the throughput per DWG"
+               " version are written as JSON.\n";
+    appDesc += "Given a baseline report, files read differently and versions read more"
+               " slowly than the threshold\n";
+    appDesc += "are reported, and the exit code is not zero.\n";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption outFileOpt(QStringList() << "o" << "outfile",
+        "Output JSON file, standard output by default.", "file");
+    parser.addOption(outFileOpt);
+
+    QCommandLineOption baselineOpt(QStringList() << "b" << "baseline",
+        "JSON report of an earlier run to compare with.", "file");
+    parser.addOption(baselineOpt);
+
+    QCommandLineOption thresholdOpt(QStringList() << "t" << "threshold",
+        "Throughput change per version reported, in percent.", "number", "10");
+    parser.addOption(thresholdOpt);
+
+    QCommandLineOption iterationsOpt(QStringList() << "i" << "iterations",
+        "Number of reads of each file, the fastest is reported.", "integer", "3");
+    parser.addOption(iterationsOpt);
+
+    QCommandLineOption threadsOpt(QStringList() << "j" << "threads",
+        "Number of threads decoding the entities of a file.", "integer", "1");
+    parser.addOption(threadsOpt);
+
+    parser.addPositionalArgument("<directory>", "Directory of DWG files.");
+
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    // the first argument is the command
+    const QStringList dirs = args.mid((!args.isEmpty() && args[0] == "dwgcorpus") ? 1 : 0);
+    if (dirs.size() != 1 || !QFileInfo(dirs[0]).isDir())
+        parser.showHelp(EXIT_FAILURE);
+    const QDir corpus(dirs[0]);
+
+    const int iterations = std::max(parser.value(iterationsOpt).toInt(), 1);
+    const int threads = std::max(parser.value(threadsOpt).toInt(), 1);
+    bool thresholdOk;
+    double threshold = parser.value(thresholdOpt).toDouble(&thresholdOk);
+    if (!thresholdOk || threshold < 0.) {
+        qDebug() << "WARNING: Ignoring bad threshold:" << parser.value(thresholdOpt);
+        threshold = 10.;
+    }
+
+    QStringList paths;
+    QDirIterator it(corpus.path(), {"*.dwg", "*.DWG"}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        paths << it.next();
+    paths.sort();
+
+    QJsonObject files;
+    // bytes, time and files per version
+    struct Totals {
+        double bytes = 0.;
+        double ms = 0.;
+        int files = 0;
+        int failed = 0;
+    };
+    std::map<QString, Totals> totals;
+    for (const QString& path: paths) {
+        const QJsonObject result = readFile(path, iterations, threads);
+        const QString name = corpus.relativeFilePath(path);
+        files[name] = result;
+        Totals& version = totals[result["version"].toString()];
+        version.bytes += result["bytes"].toDouble();
+        version.ms += result["ms"].toDouble();
+        ++version.files;
+        if (!result["ok"].toBool())
+            ++version.failed;
+        qDebug().noquote() << name << result["version"].toString() << result["total"].toInt()
+                           << "entities" << result["mb_per_s"].toDouble() << "MB/s"
+                           << (result["ok"].toBool() ? QString{} : "ERROR " + result["error"].toString());
+    }
+
+    QJsonObject versions;
+    for (const auto& [name, version]: totals) {
+        QJsonObject object;
+        object["files"] = version.files;
+        object["failed"] = version.failed;
+        object["bytes"] = version.bytes;
+        object["ms"] = version.ms;
+        object["mb_per_s"] = getMegabytesPerSecond(version.bytes, version.ms);
+        versions[name] = object;
+    }
+
+    QJsonObject report;
+    report["librecad"] = QString(XSTR(LC_VERSION));
+    report["iterations"] = iterations;
+    report["threads"] = threads;
+    report["files"] = files;
+    report["versions"] = versions;
+
+    int failures = 0;
+    if (parser.isSet(baselineOpt)) {
+        const QJsonObject baseline = readJson(parser.value(baselineOpt));
+        if (baseline.isEmpty())
+            return 1;
+        failures = compare(report, baseline, threshold);
+    }
+
+    const QByteArray json = QJsonDocument(report).toJson();
+    if (!parser.isSet(outFileOpt)) {
+        QFile out;
+        out.open(stdout, QIODevice::WriteOnly);
+        out.write(json);
+    } else {
+        QFile out(parser.value(outFileOpt));
+        if (!out.open(QIODevice::WriteOnly) || out.write(json) != json.size()) {
+            qDebug() << "ERROR: Cannot write" << parser.value(outFileOpt);
+            return 1;
+        }
+    }
+    return (failures == 0) ? 0 : 1;
+}
@@ -28,6 +28,7 @@
 #include <QApplication>
 
 #include "rs_debug.h"
+#include "rs_fileio.h"
 #include "rs_fontlist.h"
 #include "rs_patternlist.h"
 #include "rs_settings.h"
@@ -48,6 +49,7 @@ int console_dxf2pdf(int argc, char* argv[])
 {
     RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
 
+    setHeadlessPlatform();
     QApplication app(argc, argv);
     QCoreApplication::setOrganizationName("LibreCAD");
     QCoreApplication::setApplicationName("LibreCAD");
@@ -125,6 +127,30 @@ int console_dxf2pdf(int argc, char* argv[])
         QObject::tr( "Target output directory."), "path");
     parser.addOption(outDirOpt);
 
+    QCommandLineOption layersOpt(QStringList() << "l" << "layers",
+        QObject::tr( "Print only these layers, wildcards are allowed."), QObject::tr( "layer1,layer2,..."));
+    parser.addOption(layersOpt);
+
+    QCommandLineOption excludeLayersOpt(QStringList() << "x" << "exclude-layers",
+        QObject::tr( "Don't print these layers, wildcards are allowed."), QObject::tr( "layer1,layer2,..."));
+    parser.addOption(excludeLayersOpt);
+
+    QCommandLineOption windowOpt(QStringList() << "w" << "window",
+        QObject::tr( "Print only entities intersecting the window."), QObject::tr( "x1,y1,x2,y2"));
+    parser.addOption(windowOpt);
+
+    QCommandLineOption profileOpt(QStringList() << "profile-import",
+        QObject::tr( "Write the timings of importing each file to <dxf_file>.profile.json."));
+    parser.addOption(profileOpt);
+
+    QCommandLineOption memoryOpt(QStringList() << "memory-report",
+        QObject::tr( "Print the approximate memory used by each opened file."));
+    parser.addOption(memoryOpt);
+
+    QCommandLineOption jobsOpt(QStringList() << "j" << "jobs",
+        QObject::tr( "Number of files converted concurrently, 0 for the number of cores."), "integer");
+    parser.addOption(jobsOpt);
+
     parser.addPositionalArgument(QObject::tr( "<dxf_files>"), QObject::tr( "Input DXF file(s)"));
 
     parser.process(app);
@@ -152,16 +178,35 @@ int console_dxf2pdf(int argc, char* argv[])
     if (scaleOk)
         params.scale = scale;
 
+    if (parser.isSet(jobsOpt)) {
+        bool jobsOk;
+        int jobs = parser.value(jobsOpt).toInt(&jobsOk);
+        if (jobsOk && jobs >= 0)
+            params.jobs = (jobs == 0) ? QThread::idealThreadCount() : jobs;
+        else
+            qDebug() << "WARNING: Ignoring bad number of jobs:" << parser.value(jobsOpt);
+    }
+
     parseMarginsArg(parser.value(marginsOpt), params);
     parsePagesNumArg(parser.value(pagesNumOpt), params);
 
     params.outFile = parser.value(outFileOpt);
     params.outDir = parser.value(outDirOpt);
 
+    if (parser.isSet(layersOpt))
+        params.importOptions.includeLayers = parser.value(layersOpt).split(',', Qt::SkipEmptyParts);
+    if (parser.isSet(excludeLayersOpt))
+        params.importOptions.excludeLayers = parser.value(excludeLayersOpt).split(',', Qt::SkipEmptyParts);
+    if (parser.isSet(windowOpt) && !params.importOptions.setWindow(parser.value(windowOpt)))
+        qDebug() << "WARNING: Ignoring bad window:" << parser.value(windowOpt);
+    params.importOptions.writeProfile = parser.isSet(profileOpt);
+    // drawings are only plotted
+    params.importOptions.readOnly = true;
+    params.memoryReport = parser.isSet(memoryOpt);
+
     for (auto arg : args) {
-        QFileInfo dxfFileInfo(arg);
-        if (dxfFileInfo.suffix().toLower() != "dxf")
-            continue; // Skip files without .dxf extension
+        if (RS_FileIO::detectFormat(arg, false) != RS2::FormatDXFRW)
+            continue; // Skip files without .dxf or .dxf.gz extension
         params.dxfFiles.append(arg);
     }
 
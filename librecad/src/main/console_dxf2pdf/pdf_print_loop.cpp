@@ -22,11 +22,18 @@
 **
 ******************************************************************************/
 
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <vector>
+
 #include <QtCore>
+#include <QPicture>
 
 #include "rs.h"
 #include "rs_graphic.h"
 #include "rs_painterqt.h"
+#include "lc_memoryreport.h"
 #include "lc_printing.h"
 #include "rs_staticgraphicview.h"
 #include "rs_units.h"
@@ -34,14 +41,36 @@
 #include "pdf_print_loop.h"
 
 
-static bool openDocAndSetGraphic(RS_Document**, RS_Graphic**, const QString&);
-static void touchGraphic(RS_Graphic*, PdfPrintParams&);
-static void setupPrinterAndPaper(RS_Graphic*, QPrinter&, PdfPrintParams&);
+// The printable area of the printer, as used to draw pages
+struct PageGeometry {
+    int width = 0;
+    int height = 0;
+    int widthMM = 0;
+    int heightMM = 0;
+};
+
+static bool openDocAndSetGraphic(RS_Document**, RS_Graphic**, const QString&,
+    const PdfPrintParams&);
+static void touchGraphic(RS_Graphic*, const PdfPrintParams&);
+static void setupPrinterAndPaper(RS_Graphic*, QPrinter&, const PdfPrintParams&);
 static void drawPage(RS_Graphic*, QPrinter&, RS_PainterQt&);
+static void drawSheet(RS_Graphic*, const PageGeometry&, RS_PainterQt&, int, int);
+static std::vector<QPicture> renderPages(const QString&, const PdfPrintParams&,
+    const PageGeometry&);
 
 void PdfPrintLoop::run()
 {
-    if (params.outFile.isEmpty()) {
+    if (params.outFile.isEmpty() && params.jobs > 1) {
+        // every file is opened, touched and printed by a worker
+        QThreadPool pool;
+        pool.setMaxThreadCount(params.jobs);
+        for (const QString& f : params.dxfFiles) {
+            pool.start([this, f]() {
+                printOneDxfToOnePdf(f);
+            });
+        }
+        pool.waitForDone();
+    } else if (params.outFile.isEmpty()) {
         for (auto &&f : params.dxfFiles) {
             printOneDxfToOnePdf(f);
         }
@@ -53,30 +82,32 @@ void PdfPrintLoop::run()
 }
 
 
-void PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile) {
+void PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile) const {
 
     // Main code logic and flow for this method is originally stolen from
     // QC_ApplicationWindow::slotFilePrint(bool printPDF) method.
     // But finally it was split in to smaller parts.
 
+    // files may be printed concurrently, each with its own output file
+    PdfPrintParams fileParams = params;
     QFileInfo dxfFileInfo(dxfFile);
-    params.outFile =
+    fileParams.outFile =
         (params.outDir.isEmpty() ? dxfFileInfo.path() : params.outDir)
         + "/" + dxfFileInfo.completeBaseName() + ".pdf";
 
     RS_Document *doc;
     RS_Graphic *graphic;
 
-    if (!openDocAndSetGraphic(&doc, &graphic, dxfFile))
+    if (!openDocAndSetGraphic(&doc, &graphic, dxfFile, params))
         return;
 
-    qDebug() << "Printing" << dxfFile << "to" << params.outFile << ">>>>";
+    qDebug() << "Printing" << dxfFile << "to" << fileParams.outFile << ">>>>";
 
-    touchGraphic(graphic, params);
+    touchGraphic(graphic, fileParams);
 
     QPrinter printer(QPrinter::HighResolution);
 
-    setupPrinterAndPaper(graphic, printer, params);
+    setupPrinterAndPaper(graphic, printer, fileParams);
 
     RS_PainterQt painter(&printer);
 
@@ -85,9 +116,9 @@ void PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile) {
 
     drawPage(graphic, printer, painter);
 
-    painter.end();
+    painter.flushAndEnd();
 
-    qDebug() << "Printing" << dxfFile << "to" << params.outFile << "DONE";
+    qDebug() << "Printing" << dxfFile << "to" << fileParams.outFile << "DONE";
 
     delete doc;
 }
@@ -107,6 +138,41 @@ void PdfPrintLoop::printManyDxfToOnePdf() {
         params.outFile = params.outDir + "/" + outFileInfo.fileName();
     }
 
+    if (params.jobs > 1) {
+        // The first document sets up the printer, as below, and is printed
+        // directly. The other documents are rendered by workers.
+        for (int i = 0; i < params.dxfFiles.size(); ++i) {
+            const QString& dxfFile = params.dxfFiles.at(i);
+            RS_Document* doc;
+            RS_Graphic* graphic;
+            if (!openDocAndSetGraphic(&doc, &graphic, dxfFile,
+                                      params))
+                continue;
+
+            qDebug() << "Opened" << dxfFile;
+
+            touchGraphic(graphic, params);
+
+            QPrinter printer(QPrinter::HighResolution);
+            setupPrinterAndPaper(graphic, printer, params);
+            RS_PainterQt painter(&printer);
+            if (params.monochrome)
+                painter.setDrawingMode(RS2::ModeBW);
+
+            qDebug() << "Printing" << dxfFile
+                     << "to" << params.outFile << ">>>>";
+            drawPage(graphic, printer, painter);
+            delete doc;
+
+            printManyDxfToOnePdfConcurrently(printer, painter, i + 1);
+
+            painter.flushAndEnd();
+            return;
+        }
+        qDebug() << "ERROR: No document opened for" << params.outFile;
+        return;
+    }
+
     QVector<DxfPage> pages;
     int nrPages = 0;
 
@@ -121,7 +187,8 @@ void PdfPrintLoop::printManyDxfToOnePdf() {
 
         page.dxfFile = dxfFile;
 
-        if (!openDocAndSetGraphic(&page.doc, &page.graphic, dxfFile))
+        if (!openDocAndSetGraphic(&page.doc, &page.graphic, dxfFile,
+                                  params))
             continue;
 
         qDebug() << "Opened" << dxfFile;
@@ -165,16 +232,108 @@ void PdfPrintLoop::printManyDxfToOnePdf() {
             printer.newPage();
     }
 
-    painter.end();
+    painter.flushAndEnd();
+}
+
+
+/**
+ * Prints the documents from the first index on after the pages already printed.
+ * The pages of the documents are rendered concurrently into pictures, which are
+ * printed in the order of the documents.
+ */
+void PdfPrintLoop::printManyDxfToOnePdfConcurrently(QPrinter& printer,
+    RS_PainterQt& painter, int first)
+{
+    const PageGeometry geometry{printer.width(), printer.height(),
+                                printer.widthMM(), printer.heightMM()};
+    const int count = params.dxfFiles.size();
+    // documents rendered ahead of the next one to print, which bounds the
+    // documents and pages held in memory
+    const int window = 2 * params.jobs;
+
+    std::mutex mutex;
+    std::condition_variable rendered;
+    std::map<int, std::vector<QPicture>> pages;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(params.jobs);
+    int submitted = first;
+    for (int next = first; next < count; ++next) {
+        for (; submitted < count && submitted - next < window; ++submitted) {
+            pool.start([this, &geometry, &mutex, &rendered, &pages, submitted]() {
+                std::vector<QPicture> pictures = renderPages(
+                    params.dxfFiles.at(submitted), params, geometry);
+                std::lock_guard<std::mutex> lock(mutex);
+                pages.emplace(submitted, std::move(pictures));
+                rendered.notify_one();
+            });
+        }
+
+        std::vector<QPicture> pictures;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            rendered.wait(lock, [&pages, next]() { return pages.count(next) == 1; });
+            pictures = std::move(pages.at(next));
+            pages.erase(next);
+        }
+        if (pictures.empty())
+            continue;
+
+        qDebug() << "Printing" << params.dxfFiles.at(next)
+                 << "to" << params.outFile << ">>>>";
+        for (const QPicture& picture : pictures) {
+            printer.newPage();
+            painter.drawPicture(0, 0, picture);
+        }
+    }
+    pool.waitForDone();
+}
+
+
+/**
+ * Opens and touches a dxf file, and renders its pages into pictures of the page
+ * geometry. Called by workers. Returns no pages, if the file can't be opened.
+ */
+static std::vector<QPicture> renderPages(const QString& dxfFile,
+    const PdfPrintParams& params, const PageGeometry& geometry)
+{
+    std::vector<QPicture> pictures;
+
+    RS_Document* doc;
+    RS_Graphic* graphic;
+    if (!openDocAndSetGraphic(&doc, &graphic, dxfFile, params))
+        return pictures;
+
+    qDebug() << "Opened" << dxfFile;
+
+    touchGraphic(graphic, params);
+
+    for (int pY = 0; pY < graphic->getPagesNumVert(); pY++) {
+        for (int pX = 0; pX < graphic->getPagesNumHoriz(); pX++) {
+            pictures.emplace_back();
+            QPicture& picture = pictures.back();
+            // the painted device size, as for the printer
+            picture.setBoundingRect({0, 0, geometry.width, geometry.height});
+            RS_PainterQt painter(&picture);
+            if (params.monochrome)
+                painter.setDrawingMode(RS2::ModeBW);
+            drawSheet(graphic, geometry, painter, pX, pY);
+            painter.flushAndEnd();
+        }
+    }
+
+    delete doc;
+    return pictures;
 }
 
 
 static bool openDocAndSetGraphic(RS_Document** doc, RS_Graphic** graphic,
-    const QString& dxfFile)
+    const QString& dxfFile, const PdfPrintParams& params)
 {
-    *doc = new RS_Graphic();
+    auto* newGraphic = new RS_Graphic();
+    *doc = newGraphic;
 
-    if (!(*doc)->open(dxfFile, RS2::FormatUnknown)) {
+    if (!newGraphic->open(dxfFile, RS2::FormatUnknown, {}, params.importOptions)) {
         qDebug() << "ERROR: Failed to open document" << dxfFile;
         delete *doc;
         return false;
@@ -187,11 +346,16 @@ static bool openDocAndSetGraphic(RS_Document** doc, RS_Graphic** graphic,
         return false;
     }
 
+    // one message per file, files may be opened concurrently
+    if (params.memoryReport)
+        qDebug().noquote() << "Memory report of" << dxfFile << '\n'
+                           << LC_MemoryReport{**graphic}.toText().join('\n');
+
     return true;
 }
 
 
-static void touchGraphic(RS_Graphic* graphic, PdfPrintParams& params)
+static void touchGraphic(RS_Graphic* graphic, const PdfPrintParams& params)
 {
     graphic->calculateBorders();
     graphic->setMargins(params.margins.left, params.margins.top,
@@ -212,7 +376,7 @@ static void touchGraphic(RS_Graphic* graphic, PdfPrintParams& params)
 
 
 static void setupPrinterAndPaper(RS_Graphic* graphic, QPrinter& printer,
-    PdfPrintParams& params)
+    const PdfPrintParams& params)
 {
     bool landscape = false;
 
@@ -255,8 +419,30 @@ static void setupPrinterAndPaper(RS_Graphic* graphic, QPrinter& printer,
 static void drawPage(RS_Graphic* graphic, QPrinter& printer,
     RS_PainterQt& painter)
 {
-    double printerFx = (double)printer.width() / printer.widthMM();
-    double printerFy = (double)printer.height() / printer.heightMM();
+    const PageGeometry geometry{printer.width(), printer.height(),
+                                printer.widthMM(), printer.heightMM()};
+    int numX = graphic->getPagesNumHoriz();
+    int numY = graphic->getPagesNumVert();
+
+    for (int pY = 0; pY < numY; pY++) {
+        for (int pX = 0; pX < numX; pX++) {
+            // First page is created automatically.
+            // Extra pages must be created manually.
+            if (pX > 0 || pY > 0) printer.newPage();
+            drawSheet(graphic, geometry, painter, pX, pY);
+        }
+    }
+}
+
+
+/**
+ * Draws one of the pages of a graphic printed on multiple pages.
+ */
+static void drawSheet(RS_Graphic* graphic, const PageGeometry& geometry,
+    RS_PainterQt& painter, int pX, int pY)
+{
+    double printerFx = (double)geometry.width / geometry.widthMM;
+    double printerFy = (double)geometry.height / geometry.heightMM;
 
     double marginLeft = graphic->getMarginLeft();
     double marginTop = graphic-> getMarginTop();
@@ -264,10 +450,10 @@ static void drawPage(RS_Graphic* graphic, QPrinter& printer,
     double marginBottom = graphic->getMarginBottom();
 
     painter.setClipRect(marginLeft * printerFx, marginTop * printerFy,
-                        printer.width() - (marginLeft + marginRight) * printerFx,
-                        printer.height() - (marginTop + marginBottom) * printerFy);
+                        geometry.width - (marginLeft + marginRight) * printerFx,
+                        geometry.height - (marginTop + marginBottom) * printerFy);
 
-    RS_StaticGraphicView gv(printer.width(), printer.height(), &painter);
+    RS_StaticGraphicView gv(geometry.width, geometry.height, &painter);
     gv.setPrinting(true);
     gv.setBorders(0,0,0,0);
 
@@ -285,20 +471,13 @@ static void drawPage(RS_Graphic* graphic, QPrinter& printer,
 
     double baseX = graphic->getPaperInsertionBase().x;
     double baseY = graphic->getPaperInsertionBase().y;
-    int numX = graphic->getPagesNumHoriz();
-    int numY = graphic->getPagesNumVert();
     RS_Vector printArea = graphic->getPrintAreaSize(false);
 
-    for (int pY = 0; pY < numY; pY++) {
-        double offsetY = printArea.y * pY;
-        for (int pX = 0; pX < numX; pX++) {
-            double offsetX = printArea.x * pX;
-            // First page is created automatically.
-            // Extra pages must be created manually.
-            if (pX > 0 || pY > 0) printer.newPage();
-            gv.setOffset((int)((baseX - offsetX) * f),
-                         (int)((baseY - offsetY) * f));
-            gv.drawEntity(&painter, graphic );
-        }
-    }
+    double offsetY = printArea.y * pY;
+    double offsetX = printArea.x * pX;
+    gv.setOffset((int)((baseX - offsetX) * f),
+                 (int)((baseY - offsetY) * f));
+    gv.drawEntity(&painter, graphic );
+    // strokes are batched by pen, until the sheet is complete
+    painter.flush();
 }
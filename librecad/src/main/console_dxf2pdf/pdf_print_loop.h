@@ -27,8 +27,11 @@
 #include <QtCore>
 #include <QPrinter>
 
+#include "lc_importoptions.h"
 #include "rs_vector.h"
 
+class RS_PainterQt;
+
 
 struct PdfPrintParams {
         QStringList dxfFiles;
@@ -49,6 +52,9 @@ struct PdfPrintParams {
         } margins;           // If margin < 0.0, use value from dxf file.
         int pagesH = 0;      // If number of pages < 1,
         int pagesV = 0;      // use value from dxf file.
+        LC_ImportOptions importOptions; // If empty, import whole files.
+        bool memoryReport = false;  // Print the memory used by each opened file.
+        int jobs = 1;        // If jobs > 1, files are converted concurrently.
 };
 
 
@@ -75,8 +81,9 @@ signals:
 private:
     PdfPrintParams params{};
 
-    void printOneDxfToOnePdf(const QString&);
+    void printOneDxfToOnePdf(const QString&) const;
     void printManyDxfToOnePdf();
+    void printManyDxfToOnePdfConcurrently(QPrinter&, RS_PainterQt&, int first);
 };
 
 #endif
@@ -22,6 +22,7 @@
 **
 ******************************************************************************/
 
+#include <atomic>
 #include <memory>
 #include <set>
 
@@ -33,13 +34,13 @@
 
 #include "main.h"
 
-#include "qc_applicationwindow.h"
-#include "qg_dialogfactory.h"
-
 #include "lc_actionfileexportmakercam.h"
+#include "lc_memoryreport.h"
+#include "lc_tiledimageexport.h"
 #include "rs.h"
 #include "rs_debug.h"
 #include "rs_document.h"
+#include "rs_fileio.h"
 #include "rs_fontlist.h"
 #include "rs_graphic.h"
 #include "rs_math.h"
@@ -55,10 +56,12 @@
 /// for further manipulations
 /// \return
 //////////////////////////////////////////////////////////////////////
-static std::unique_ptr<RS_Document> openDocAndSetGraphic(QString);
+static std::unique_ptr<RS_Document> openDocAndSetGraphic(QString, const LC_ImportOptions&);
 
 static void touchGraphic(RS_Graphic*);
 
+static bool convertDxfFile(const QString&, const QString&, QSize, const LC_ImportOptions&, bool);
+
 static QSize parsePngSizeArg(QString);
 
 bool slotFileExport(RS_Graphic* graphic,
@@ -83,6 +86,38 @@ QString getFormatFromFile(const QString& fileName)
     }
     return "png";
 }
+
+// the output file of a dxf file, from the output file option, if set, or from the
+// dxf file name with the extension of the tool
+QString getOutputFile(const QString& dxfFile, const QString& outFile, const QString& extension)
+{
+    QFileInfo dxfFileInfo(dxfFile);
+    QString fn = dxfFileInfo.completeBaseName(); // original DXF file name
+    if(fn.isEmpty())
+        fn = "unnamed";
+
+    if (outFile.isEmpty())
+        return dxfFileInfo.path() + "/" + fn + "." + extension;
+    return dxfFileInfo.path() + "/" + outFile;
+}
+
+// the dxf files listed in a text file, one file per line
+QStringList readListFile(const QString& listFile)
+{
+    QStringList files;
+    QFile file{listFile};
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "ERROR: Cannot read the list file" << listFile;
+        return files;
+    }
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (!line.isEmpty())
+            files.append(line);
+    }
+    return files;
+}
 }
 
 /////////
@@ -96,6 +131,7 @@ int console_dxf2png(int argc, char* argv[])
 {
     RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
 
+    setHeadlessPlatform();
     QApplication app(argc, argv);
     QCoreApplication::setOrganizationName("LibreCAD");
     QCoreApplication::setApplicationName("LibreCAD");
@@ -122,7 +158,9 @@ int console_dxf2png(int argc, char* argv[])
     appDesc += "\n\n";
     appDesc += "Examples:\n\n";
     appDesc += "  " + librecad + " dxf2png *.dxf";
-    appDesc += "    -- print a dxf file to a png file with the same name.\n";
+    appDesc += "    -- print dxf files to png files with the same names.\n";
+    appDesc += "  " + librecad + " dxf2png -j 0 -i files.txt";
+    appDesc += "    -- print the dxf files listed in files.txt on all cores.\n";
     parser.setApplicationDescription(appDesc);
 
     parser.addHelpOption();
@@ -136,23 +174,66 @@ int console_dxf2png(int argc, char* argv[])
         "Output PNG size (Width x Height) in pixels.", "WxH");
     parser.addOption(pngSizeOpt);
 
-    parser.addPositionalArgument("<dxf_files>", "Input DXF file");
+    QCommandLineOption layersOpt(QStringList() << "l" << "layers",
+        "Import only these layers, wildcards are allowed.", "layer1,layer2,...");
+    parser.addOption(layersOpt);
+
+    QCommandLineOption excludeLayersOpt(QStringList() << "x" << "exclude-layers",
+        "Don't import these layers, wildcards are allowed.", "layer1,layer2,...");
+    parser.addOption(excludeLayersOpt);
+
+    QCommandLineOption windowOpt(QStringList() << "w" << "window",
+        "Import only entities intersecting the window.", "x1,y1,x2,y2");
+    parser.addOption(windowOpt);
+
+    QCommandLineOption profileOpt(QStringList() << "profile-import",
+        "Write the timings of importing each file to <dxf_file>.profile.json.");
+    parser.addOption(profileOpt);
+
+    QCommandLineOption memoryOpt(QStringList() << "memory-report",
+        "Print the approximate memory used by each opened file.");
+    parser.addOption(memoryOpt);
+
+    QCommandLineOption listFileOpt(QStringList() << "i" << "input-list",
+        "Text file listing input DXF files, one per line.", "file");
+    parser.addOption(listFileOpt);
+
+    QCommandLineOption jobsOpt(QStringList() << "j" << "jobs",
+        "Number of files converted concurrently, 0 for the number of cores.", "integer");
+    parser.addOption(jobsOpt);
+
+    parser.addPositionalArgument("<dxf_files>", "Input DXF file(s)");
 
     parser.process(app);
 
     const QStringList args = parser.positionalArguments();
 
-    if (args.isEmpty() || (args.size() == 1 && (args[0] == "dxf2png" || args[0] == "dxf2svg")))
+    const bool toolArg = !args.isEmpty() && allowed.count(args[0]) == 1;
+    if ((args.isEmpty() || (args.size() == 1 && toolArg)) && !parser.isSet(listFileOpt))
         parser.showHelp(EXIT_FAILURE);
     // Set PNG size from user input
     QSize pngSize = parsePngSizeArg(parser.value(pngSizeOpt)); // If nothing, use default values.
 
+    LC_ImportOptions importOptions;
+    if (parser.isSet(layersOpt))
+        importOptions.includeLayers = parser.value(layersOpt).split(',', Qt::SkipEmptyParts);
+    if (parser.isSet(excludeLayersOpt))
+        importOptions.excludeLayers = parser.value(excludeLayersOpt).split(',', Qt::SkipEmptyParts);
+    if (parser.isSet(windowOpt) && !importOptions.setWindow(parser.value(windowOpt)))
+        qDebug() << "WARNING: Ignoring bad window:" << parser.value(windowOpt);
+    importOptions.writeProfile = parser.isSet(profileOpt);
+    // drawings are only plotted
+    importOptions.readOnly = true;
+    const bool memoryReport = parser.isSet(memoryOpt);
+
     QStringList dxfFiles;
 
-    for (auto arg : args) {
-        QFileInfo dxfFileInfo(arg);
-        if (dxfFileInfo.suffix().toLower() != "dxf")
-            continue; // Skip files without .dxf extension
+    QStringList inputs = args;
+    if (parser.isSet(listFileOpt))
+        inputs += readListFile(parser.value(listFileOpt));
+    for (auto arg : inputs) {
+        if (RS_FileIO::detectFormat(arg, false) != RS2::FormatDXFRW)
+            continue; // Skip files without .dxf or .dxf.gz extension
         dxfFiles.append(arg);
     }
 
@@ -161,29 +242,73 @@ int console_dxf2png(int argc, char* argv[])
 
     // Output setup
 
-    QString& dxfFile = dxfFiles[0];
-
-    QFileInfo dxfFileInfo(dxfFile);
-    QString fn = dxfFileInfo.completeBaseName(); // original DXF file name
-    if(fn.isEmpty())
-        fn = "unnamed";
-
     // Set output filename from user input if present
     QString outFile = parser.value(outFileOpt);
-    if (outFile.isEmpty()) {
-        outFile = dxfFileInfo.path() + "/" + fn + "." + args[0].mid(args[0].size()-3);
-    } else {
-        outFile = dxfFileInfo.path() + "/" + outFile;
+    if (!outFile.isEmpty() && dxfFiles.size() > 1) {
+        qDebug() << "WARNING: Ignoring output file for multiple input files:" << outFile;
+        outFile.clear();
+    }
+    // the extension of the tool name: dxf2png or dxf2svg
+    const QString tool = toolArg ? args[0] : prgInfo.baseName();
+    const QString extension = tool.mid(tool.size()-3);
+
+    int jobs = 1;
+    if (parser.isSet(jobsOpt)) {
+        bool jobsOk;
+        jobs = parser.value(jobsOpt).toInt(&jobsOk);
+        if (!jobsOk || jobs < 0) {
+            qDebug() << "WARNING: Ignoring bad number of jobs:" << parser.value(jobsOpt);
+            jobs = 1;
+        } else if (jobs == 0) {
+            jobs = QThread::idealThreadCount();
+        }
     }
 
-    // Open the file and process the graphics
+    // fonts and patterns are initialized once for all files
+    RS_FONTLIST->init();
+    RS_PATTERNLIST->init();
+
+    // Open the files and process the graphics, by workers for many jobs
+    std::atomic<bool> opened{true};
+    QThreadPool pool;
+    pool.setMaxThreadCount(jobs);
+    for (const QString& dxfFile: dxfFiles) {
+        const QString fileOut = getOutputFile(dxfFile, outFile, extension);
+        if (jobs > 1) {
+            pool.start([&opened, &pngSize, &importOptions, memoryReport, dxfFile, fileOut]() {
+                if (!convertDxfFile(dxfFile, fileOut, pngSize, importOptions, memoryReport))
+                    opened = false;
+            });
+        } else if (!convertDxfFile(dxfFile, fileOut, pngSize, importOptions, memoryReport)) {
+            opened = false;
+        }
+    }
+    pool.waitForDone();
+
+    return opened ? 0 : 1;
+}
+
 
-    std::unique_ptr<RS_Document> doc = openDocAndSetGraphic(dxfFile);
+/**
+ * Converts a dxf file to the image format of the output file name.
+ * Files may be converted concurrently.
+ * \return false, if the dxf file can't be opened
+ */
+static bool convertDxfFile(const QString& dxfFile, const QString& outFile,
+                           QSize pngSize, const LC_ImportOptions& importOptions,
+                           bool memoryReport)
+{
+    std::unique_ptr<RS_Document> doc = openDocAndSetGraphic(dxfFile, importOptions);
 
     if (doc == nullptr || doc->getGraphic() == nullptr)
-        return 1;
+        return false;
     RS_Graphic *graphic = doc->getGraphic();
 
+    // one message per file, files may be converted concurrently
+    if (memoryReport)
+        qDebug().noquote() << "Memory report of" << dxfFile << '\n'
+                           << LC_MemoryReport{*graphic}.toText().join('\n');
+
     LC_LOG << "Printing" << dxfFile << "to" << outFile << ">>>>";
 
     touchGraphic(graphic);
@@ -194,16 +319,10 @@ int console_dxf2png(int argc, char* argv[])
 
     // read default settings:
     auto groupGuard = RS_SETTINGS->beginGroupGuard("/Export");
-    QString defDir = dxfFileInfo.path();
 
     // find out extension:
     QString format = getFormatFromFile(outFile).toUpper();
 
-    // append extension to file:
-    if (!QFileInfo(fn).fileName().contains(".")) {
-        fn.push_back("." + format.toLower());
-    }
-
     bool ret = false;
     if (format.compare("SVG", Qt::CaseInsensitive) == 0) {
         ret = LC_ActionFileExportMakerCam::writeSvg(outFile, *graphic);
@@ -216,15 +335,16 @@ int console_dxf2png(int argc, char* argv[])
     }
 
     qDebug() << "Printing" << dxfFile << "to" << outFile << (ret ? "Done" : "Failed");
-    return 0;
+    return true;
 }
 
 
-static std::unique_ptr<RS_Document> openDocAndSetGraphic(QString dxfFile)
+static std::unique_ptr<RS_Document> openDocAndSetGraphic(QString dxfFile,
+                                                        const LC_ImportOptions& importOptions)
 {
     auto doc = std::make_unique<RS_Graphic>();
 
-    if (!doc->open(dxfFile, RS2::FormatUnknown)) {
+    if (!doc->open(dxfFile, RS2::FormatUnknown, {}, importOptions)) {
         qDebug() << "ERROR: Failed to open document" << dxfFile;
         qDebug() << "Check if file exists";
         return {};
@@ -271,11 +391,14 @@ bool slotFileExport(RS_Graphic* graphic, const QString& name,
         return false;
     }
 
-    QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
+    // large images are streamed to the file by bands
+    if (LC_TiledImageExport::isTiled(format, size))
+        return LC_TiledImageExport::exportImage(*graphic, name, format, size, borders, black, bw);
 
     bool ret = false;
     // set vars for normal pictures and vectors (svg)
-    QPixmap* picture = new QPixmap(size);
+    // images, unlike pixmaps, may be painted by worker threads
+    QImage* picture = new QImage(size, QImage::Format_ARGB32_Premultiplied);
 
     QSvgGenerator* vector = new QSvgGenerator();
 
@@ -318,13 +441,15 @@ bool slotFileExport(RS_Graphic* graphic, const QString& name,
     gv.setContainer(graphic);
     gv.zoomAuto(false);
     gv.drawEntity(&painter, gv.getContainer());
+    // the batched lines are drawn before the image is written
+    painter.flush();
 
     // end the picture output
     if(format.toLower() != "svg")
     {
         // RVT_PORT QImageIO iio;
         QImageWriter iio;
-        QImage img = picture->toImage();
+        const QImage& img = *picture;
         // RVT_PORT iio.setImage(img);
         iio.setFileName(name);
         iio.setFormat(format.toLatin1());
@@ -334,10 +459,9 @@ bool slotFileExport(RS_Graphic* graphic, const QString& name,
         }
 //        QString error=iio.errorString();
     }
-    QApplication::restoreOverrideCursor();
 
     // GraphicView deletes painter
-    painter.end();
+    painter.flushAndEnd();
     // delete vars
     delete picture;
     delete vector;
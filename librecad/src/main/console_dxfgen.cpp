@@ -0,0 +1,162 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <vector>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+
+#include "main.h"
+
+#include "console_dxfgen.h"
+#include "lc_drawinggenerator.h"
+#include "rs_debug.h"
+#include "rs_filterdxfrw.h"
+#include "rs_fontlist.h"
+#include "rs_graphic.h"
+#include "rs_patternlist.h"
+#include "rs_settings.h"
+#include "rs_system.h"
+
+/////////
+/// \brief console_dxfgen is called if librecad
+/// as console dxfgen tool for generating synthetic drawings.
+/// \param argc
+/// \param argv
+/// \return
+///
+int console_dxfgen(int argc, char* argv[])
+{
+    RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
+
+    setHeadlessPlatform();
+    QApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QFileInfo prgInfo(QFile::decodeName(argv[0]));
+    QString prgDir(prgInfo.absolutePath());
+    RS_SETTINGS->init(app.organizationName(), app.applicationName());
+    RS_SYSTEM->init(app.applicationName(), app.applicationVersion(),
+        XSTR(QC_APPDIR), prgDir.toLatin1().data());
+
+    QCommandLineParser parser;
+
+    QString appDesc = "\nGenerate a synthetic DXF drawing for stress tests.";
+    appDesc += "\n\n";
+    appDesc += "Entities are placed at random in a square, on random layers; the drawing"
+               " only depends on the seed\n";
+    appDesc += "and the counts, so a problem can be reproduced without sharing the"
+               " drawing it was found in.\n";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    LC_DrawingGenerator::Parameters parameters;
+
+    // the integer options, with the parameters they set
+    struct CountOption {
+        QCommandLineOption option;
+        int* parameter;
+    };
+    const auto countOption = [](const QString& name, const QString& description, int* parameter) {
+        return CountOption{QCommandLineOption(name, description, "integer", QString::number(*parameter)),
+                    parameter};
+    };
+    int seed = 1;
+    std::vector<CountOption> counts{
+        countOption("seed", "Seed of the random placement.", &seed),
+        countOption("layers", "Number of layers.", &parameters.layers),
+        countOption("lines", "Number of lines.", &parameters.lines),
+        countOption("circles", "Number of circles.", &parameters.circles),
+        countOption("arcs", "Number of arcs.", &parameters.arcs),
+        countOption("polylines", "Number of polylines.", &parameters.polylines),
+        countOption("polyline-vertices", "Vertices of each polyline.", &parameters.polylineVertices),
+        countOption("splines", "Number of splines.", &parameters.splines),
+        countOption("texts", "Number of texts, every fourth one an mtext, in mixed fonts.",
+                    &parameters.texts),
+        countOption("blocks", "Number of block definitions.", &parameters.blocks),
+        countOption("inserts", "Number of inserts of the blocks.", &parameters.inserts),
+        countOption("block-depth", "Nesting depth of the blocks, 1 for no nesting.",
+                    &parameters.blockDepth),
+        countOption("hatches", "Number of pattern hatches.", &parameters.hatches),
+        countOption("hatch-loops", "Loops of each hatch.", &parameters.hatchLoops),
+        countOption("hatch-vertices", "Edges of each hatch loop.", &parameters.hatchVertices),
+    };
+    for (const CountOption& count: counts)
+        parser.addOption(count.option);
+
+    QCommandLineOption sizeOpt(QStringList() << "size",
+        "Side of the square the entities are placed in, in drawing units.", "number",
+        QString::number(parameters.size));
+    parser.addOption(sizeOpt);
+
+    parser.addPositionalArgument("<dxf_file>", "Output DXF file.");
+
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.size() != 1) {
+        qDebug() << "ERROR: Expected one output file";
+        parser.showHelp(1);
+    }
+
+    for (const CountOption& count: counts) {
+        bool ok = false;
+        const int value = parser.value(count.option).toInt(&ok);
+        if (!ok || value < 0) {
+            qDebug() << "ERROR: Bad value of" << count.option.names().first() << ":"
+                     << parser.value(count.option);
+            return 1;
+        }
+        *count.parameter = value;
+    }
+    bool sizeOk = false;
+    parameters.size = parser.value(sizeOpt).toDouble(&sizeOk);
+    if (!sizeOk || parameters.size <= 0.) {
+        qDebug() << "ERROR: Bad size:" << parser.value(sizeOpt);
+        return 1;
+    }
+
+    // fonts for the texts, patterns for the hatches
+    RS_FONTLIST->init();
+    RS_PATTERNLIST->init();
+
+    QElapsedTimer timer;
+    timer.start();
+    RS_Graphic graphic;
+    LC_DrawingGenerator{unsigned(seed)}.generate(graphic, parameters);
+    qDebug() << "Generated" << graphic.countDeep() << "entities in" << timer.restart() << "ms";
+
+    RS_FilterDXFRW filter;
+    if (!filter.fileExport(graphic, files.first(), RS2::FormatDXFRW)) {
+        qDebug() << "ERROR: Cannot write" << files.first();
+        return 1;
+    }
+    qDebug() << "Saved" << files.first() << "in" << timer.elapsed() << "ms";
+    return 0;
+}
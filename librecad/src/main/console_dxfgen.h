@@ -0,0 +1,34 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef CONSOLE_DXFGEN_H
+#define CONSOLE_DXFGEN_H
+
+/**
+ * @brief console_dxfgen runs librecad as a generator of synthetic DXF drawings, for
+ * reproducing scaling problems without the original drawings. The drawing only
+ * depends on the seed and the counts of entities given
+ */
+int console_dxfgen(int argc, char* argv[]);
+
+#endif // CONSOLE_DXFGEN_H
@@ -0,0 +1,483 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+#include <QApplication>
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageWriter>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPdfWriter>
+#include <QPointer>
+#include <QRegularExpression>
+#include <QThread>
+#include <QThreadPool>
+
+#include "main.h"
+
+#include "console_renderserver.h"
+#include "rs.h"
+#include "rs_debug.h"
+#include "rs_fontlist.h"
+#include "rs_graphic.h"
+#include "rs_layer.h"
+#include "rs_layerlist.h"
+#include "rs_painterqt.h"
+#include "rs_patternlist.h"
+#include "rs_settings.h"
+#include "rs_staticgraphicview.h"
+#include "rs_system.h"
+
+namespace {
+
+// border around a drawing rendered without a viewport, in pixels
+constexpr int borderPixels = 5;
+// largest rendered width or height, in pixels or points
+constexpr int maxRenderSize = 16384;
+// resolution of PDF files, in dots per inch
+constexpr int pdfResolution = 300;
+
+struct RenderRequest {
+    QString file;
+    // the rendered data is returned in the reply, if no output file is given
+    QString output;
+    QString format;
+    QSize size{2000, 1000};
+    bool hasViewport = false;
+    RS_Vector viewMin;
+    RS_Vector viewMax;
+    // the rendered layers, wildcards are allowed; all layers, if empty
+    QStringList layers;
+    bool black = false;
+};
+
+/**
+ * A loaded document. Entities are prepared for concurrent drawing before the document
+ * is published, requests render it concurrently under a shared lock, and selecting
+ * layers, which changes the document, takes the lock exclusively.
+ */
+struct CachedDocument {
+    std::unique_ptr<RS_Graphic> graphic;
+    QDateTime modified;
+    std::shared_mutex mutex;
+};
+
+/**
+ * Documents kept loaded between requests, keyed by their path and modification time.
+ * The least recently used documents are released beyond the capacity, once the
+ * requests rendering them are done.
+ */
+class DocumentCache {
+public:
+    explicit DocumentCache(int capacity):
+        m_capacity{std::size_t(std::max(capacity, 1))}
+    {}
+
+    std::shared_ptr<CachedDocument> get(const QString& file, QString& error)
+    {
+        const QFileInfo info{file};
+        if (!info.isFile()) {
+            error = "no such file: " + file;
+            return {};
+        }
+        const QString path = info.canonicalFilePath();
+        const QDateTime modified = info.lastModified();
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            auto it = find(path);
+            if (it != m_documents.end()) {
+                if (it->second->modified == modified) {
+                    m_documents.splice(m_documents.end(), m_documents, it);
+                    return m_documents.back().second;
+                }
+                // changed on disk
+                m_documents.erase(it);
+            }
+        }
+
+        // loaded out of the lock; the first requests of a file may load it twice
+        auto document = std::make_shared<CachedDocument>();
+        document->graphic = std::make_unique<RS_Graphic>();
+        document->modified = modified;
+        if (!document->graphic->open(path, RS2::FormatUnknown)) {
+            error = "cannot open " + file;
+            return {};
+        }
+        document->graphic->calculateBorders();
+        RS_GraphicView::prepareConcurrentDrawing(
+            std::vector<RS_Entity*>(document->graphic->begin(), document->graphic->end()));
+
+        std::lock_guard<std::mutex> lock{m_mutex};
+        auto it = find(path);
+        if (it != m_documents.end())
+            m_documents.erase(it);
+        m_documents.emplace_back(path, document);
+        while (m_documents.size() > m_capacity)
+            m_documents.pop_front();
+        return document;
+    }
+
+private:
+    using Documents = std::list<std::pair<QString, std::shared_ptr<CachedDocument>>>;
+
+    Documents::iterator find(const QString& path)
+    {
+        return std::find_if(m_documents.begin(), m_documents.end(),
+                            [&path](const auto& document) {
+            return document.first == path;
+        });
+    }
+
+    const std::size_t m_capacity;
+    std::mutex m_mutex;
+    // least recently used first
+    Documents m_documents;
+};
+
+/**
+ * Freezes the layers not matching the wildcards for the lifetime of the selection
+ */
+class LayerSelection {
+public:
+    LayerSelection(RS_Graphic& graphic, const QStringList& layers)
+    {
+        if (layers.isEmpty())
+            return;
+        std::vector<QRegularExpression> patterns;
+        for (const QString& name: layers) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 6, 0)
+            const QString pattern = QRegularExpression::wildcardToRegularExpression(
+                        name, QRegularExpression::NonPathWildcardConversion);
+#else
+            const QString pattern = QRegularExpression::wildcardToRegularExpression(name);
+#endif
+            patterns.emplace_back(pattern, QRegularExpression::CaseInsensitiveOption);
+        }
+        for (RS_Layer* layer: *graphic.getLayerList()) {
+            const bool selected = std::any_of(patterns.cbegin(), patterns.cend(),
+                                              [layer](const QRegularExpression& pattern) {
+                return pattern.match(layer->getName()).hasMatch();
+            });
+            m_frozen.emplace_back(layer, layer->isFrozen());
+            layer->freeze(!selected || layer->isFrozen());
+        }
+    }
+
+    ~LayerSelection()
+    {
+        for (const auto& [layer, frozen]: m_frozen)
+            layer->freeze(frozen);
+    }
+
+private:
+    std::vector<std::pair<RS_Layer*, bool>> m_frozen;
+};
+
+// reads a render request; returns the error, if the request is not valid
+QString parseRequest(const QJsonObject& json, RenderRequest& request)
+{
+    request.file = json.value("file").toString();
+    if (request.file.isEmpty())
+        return "no file";
+    request.output = json.value("output").toString();
+
+    request.format = json.value("format").toString().toLower();
+    if (request.format.isEmpty())
+        request.format = request.output.isEmpty() ? QString{"png"}
+                                                  : QFileInfo(request.output).suffix().toLower();
+    if (request.format != "pdf"
+            && !QImageWriter::supportedImageFormats().contains(request.format.toLatin1()))
+        return "unsupported format: " + request.format;
+
+    const int width = json.value("width").toInt(request.size.width());
+    const int height = json.value("height").toInt(request.size.height());
+    if (width <= 0 || height <= 0 || width > maxRenderSize || height > maxRenderSize)
+        return QString("bad size: %1x%2").arg(width).arg(height);
+    request.size = {width, height};
+
+    if (json.contains("viewport")) {
+        const QJsonArray viewport = json.value("viewport").toArray();
+        if (viewport.size() != 4
+                || !std::all_of(viewport.begin(), viewport.end(),
+                                [](const QJsonValue& value) { return value.isDouble(); }))
+            return "bad viewport, expected [x1, y1, x2, y2]";
+        request.hasViewport = true;
+        request.viewMin = {viewport[0].toDouble(), viewport[1].toDouble()};
+        request.viewMax = {viewport[2].toDouble(), viewport[3].toDouble()};
+    }
+
+    for (const QJsonValue& layer: json.value("layers").toArray())
+        request.layers.append(layer.toString());
+    request.black = json.value("black").toBool();
+    return {};
+}
+
+void drawDocument(RS_PainterQt& painter, RS_Graphic& graphic,
+                  const RenderRequest& request, const QSize& size)
+{
+    const QColor background = request.black ? Qt::black : Qt::white;
+    painter.setBackground(background);
+    painter.eraseRect(0, 0, size.width(), size.height());
+
+    RS_Vector v1 = request.viewMin;
+    RS_Vector v2 = request.viewMax;
+    if (!request.hasViewport) {
+        // the borders computed on loading; zoomAuto() would update those of the
+        // shared document
+        v1 = graphic.getMin();
+        v2 = graphic.getMax();
+        if (!v1.valid || !v2.valid || v1.x > v2.x || v1.y > v2.y)
+            return;
+        const double unitsPerPixel = std::max(
+                    (v2.x - v1.x) / std::max(1, size.width() - 2 * borderPixels),
+                    (v2.y - v1.y) / std::max(1, size.height() - 2 * borderPixels));
+        const RS_Vector margin{borderPixels * unitsPerPixel, borderPixels * unitsPerPixel};
+        v1 -= margin;
+        v2 += margin;
+    }
+
+    RS_StaticGraphicView view(size.width(), size.height(), &painter);
+    view.setBackground(background);
+    view.setContainer(&graphic);
+    view.setConcurrentDrawing(true);
+    view.zoomWindow(v1, v2);
+    view.drawEntity(&painter, &graphic);
+}
+
+// renders a document to the output file, or to data
+bool renderDocument(const RenderRequest& request, CachedDocument& document,
+                    QByteArray& data, QString& error)
+{
+    std::shared_lock<std::shared_mutex> sharedLock{document.mutex, std::defer_lock};
+    std::unique_lock<std::shared_mutex> exclusiveLock{document.mutex, std::defer_lock};
+    if (request.layers.isEmpty())
+        sharedLock.lock();
+    else
+        exclusiveLock.lock();
+    LayerSelection selection{*document.graphic, request.layers};
+
+    std::unique_ptr<QIODevice> device;
+    if (request.output.isEmpty())
+        device = std::make_unique<QBuffer>(&data);
+    else
+        device = std::make_unique<QFile>(request.output);
+    if (!device->open(QIODevice::WriteOnly)) {
+        error = "cannot write " + request.output;
+        return false;
+    }
+
+    if (request.format == "pdf") {
+        QPdfWriter writer(device.get());
+        writer.setResolution(pdfResolution);
+        writer.setPageSize(QPageSize(QSizeF(request.size), QPageSize::Point));
+        writer.setPageMargins(QMarginsF{});
+        RS_PainterQt painter(&writer);
+        drawDocument(painter, *document.graphic, request, {writer.width(), writer.height()});
+        painter.flushAndEnd();
+        return true;
+    }
+
+    QImage image(request.size, QImage::Format_ARGB32_Premultiplied);
+    RS_PainterQt painter(&image);
+    drawDocument(painter, *document.graphic, request, request.size);
+    painter.flushAndEnd();
+
+    QImageWriter writer(device.get(), request.format.toLatin1());
+    if (!writer.write(image)) {
+        error = writer.errorString();
+        return false;
+    }
+    return true;
+}
+
+// handles a request line; returns the reply line
+QByteArray handleRequest(const QByteArray& line, DocumentCache& cache)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QJsonObject reply;
+    QString error;
+    QJsonParseError parseError;
+    const QJsonDocument json = QJsonDocument::fromJson(line, &parseError);
+    RenderRequest request;
+    if (!json.isObject()) {
+        error = "bad request: " + parseError.errorString();
+    } else {
+        // replies of concurrent requests may come out of order
+        if (json.object().contains("id"))
+            reply["id"] = json.object().value("id");
+        error = parseRequest(json.object(), request);
+    }
+
+    if (error.isEmpty()) {
+        const std::shared_ptr<CachedDocument> document = cache.get(request.file, error);
+        QByteArray data;
+        if (document != nullptr && renderDocument(request, *document, data, error)) {
+            if (request.output.isEmpty())
+                reply["data"] = QString::fromLatin1(data.toBase64());
+            else
+                reply["output"] = request.output;
+        }
+    }
+
+    reply["ok"] = error.isEmpty();
+    if (!error.isEmpty())
+        reply["error"] = error;
+    reply["ms"] = double(timer.elapsed());
+    return QJsonDocument(reply).toJson(QJsonDocument::Compact) + '\n';
+}
+}
+
+/////////
+/// \brief console_renderserver is called if librecad
+/// as console render server for rendering DXF files on requests.
+/// \param argc
+/// \param argv
+/// \return
+///
+int console_renderserver(int argc, char* argv[])
+{
+    RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
+
+    setHeadlessPlatform();
+    QApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QFileInfo prgInfo(QFile::decodeName(argv[0]));
+    QString prgDir(prgInfo.absolutePath());
+    RS_SETTINGS->init(app.organizationName(), app.applicationName());
+    RS_SYSTEM->init(app.applicationName(), app.applicationVersion(),
+        XSTR(QC_APPDIR), prgDir.toLatin1().data());
+
+    QCommandLineParser parser;
+
+    QString appDesc = "\nRender DXF files to images or PDF files on requests.";
+    appDesc += "\n\n";
+    appDesc += "Requests are read from a local socket, one JSON object per line:\n\n";
+    appDesc += "  {\"id\": 1, \"file\": \"a.dxf\", \"output\": \"a.png\", \"width\": 800,"
+               " \"height\": 600,\n";
+    appDesc += "   \"viewport\": [x1, y1, x2, y2], \"layers\": [\"walls*\"], \"black\": false}\n\n";
+    appDesc += "The format is taken from \"format\" or the output file, png by default;"
+               " the size of PDF files is in points.\n";
+    appDesc += "Each request is answered by one line {\"id\", \"ok\", \"error\", \"ms\"},"
+               " with the base64 \"data\" if no output file is given.\n";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption socketOpt(QStringList() << "s" << "socket",
+        "Name of the local socket, librecad-render by default.", "name", "librecad-render");
+    parser.addOption(socketOpt);
+
+    QCommandLineOption jobsOpt(QStringList() << "j" << "jobs",
+        "Number of requests rendered concurrently, 0 for the number of cores.", "integer", "0");
+    parser.addOption(jobsOpt);
+
+    QCommandLineOption cacheOpt(QStringList() << "c" << "cache",
+        "Number of documents kept loaded.", "integer", "16");
+    parser.addOption(cacheOpt);
+
+    parser.process(app);
+
+    bool jobsOk;
+    int jobs = parser.value(jobsOpt).toInt(&jobsOk);
+    if (!jobsOk || jobs < 0) {
+        qDebug() << "WARNING: Ignoring bad number of jobs:" << parser.value(jobsOpt);
+        jobs = 0;
+    }
+    if (jobs == 0)
+        jobs = QThread::idealThreadCount();
+
+    bool cacheOk;
+    int cacheSize = parser.value(cacheOpt).toInt(&cacheOk);
+    if (!cacheOk || cacheSize < 1) {
+        qDebug() << "WARNING: Ignoring bad cache size:" << parser.value(cacheOpt);
+        cacheSize = 16;
+    }
+
+    // fonts and patterns are initialized once for all requests
+    RS_FONTLIST->init();
+    RS_PATTERNLIST->init();
+
+    DocumentCache cache{cacheSize};
+    QThreadPool pool;
+    pool.setMaxThreadCount(jobs);
+
+    QLocalServer server;
+    const QString socketName = parser.value(socketOpt);
+    // a stale socket of a crashed server
+    QLocalServer::removeServer(socketName);
+    if (!server.listen(socketName)) {
+        qDebug() << "ERROR: Cannot listen on" << socketName << ":" << server.errorString();
+        return 1;
+    }
+    qDebug() << "Listening on" << server.fullServerName();
+
+    QObject::connect(&server, &QLocalServer::newConnection, &server, [&server, &pool, &cache]() {
+        while (QLocalSocket* socket = server.nextPendingConnection()) {
+            QObject::connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+            QObject::connect(socket, &QLocalSocket::readyRead, socket, [socket, &pool, &cache]() {
+                while (socket->canReadLine()) {
+                    const QByteArray line = socket->readLine().trimmed();
+                    if (line.isEmpty())
+                        continue;
+                    // requests are rendered by workers, replies are written by the main
+                    // thread, unless the client is gone
+                    QPointer<QLocalSocket> client{socket};
+                    pool.start([line, client, &cache]() {
+                        const QByteArray reply = handleRequest(line, cache);
+                        QMetaObject::invokeMethod(qApp, [client, reply]() {
+                            if (client != nullptr)
+                                client->write(reply);
+                        }, Qt::QueuedConnection);
+                    });
+                }
+            });
+        }
+    });
+
+    const int ret = app.exec();
+    pool.waitForDone();
+    return ret;
+}
@@ -0,0 +1,374 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "main.h"
+
+#include "console_rendertest.h"
+#include "lc_drawinggenerator.h"
+#include "rs.h"
+#include "rs_debug.h"
+#include "rs_fileio.h"
+#include "rs_fontlist.h"
+#include "rs_graphic.h"
+#include "rs_painterqt.h"
+#include "rs_patternlist.h"
+#include "rs_settings.h"
+#include "rs_staticgraphicview.h"
+#include "rs_system.h"
+
+namespace {
+
+// the size of the rendered images
+constexpr int imageWidth = 800;
+constexpr int imageHeight = 600;
+// the file of the golden render times in the golden directory
+const char* const timesFile = "times.json";
+
+// a reference drawing, generated from a fixed seed, or read from a file
+struct Drawing {
+    QString name;
+    std::unique_ptr<RS_Graphic> graphic;
+};
+
+// a view of a drawing: zoomed by the factor to the point, relative to the extent
+struct Viewport {
+    const char* name;
+    double zoom;
+    double x;
+    double y;
+};
+
+const std::vector<Viewport> viewports{
+    {"fit", 1., 0.5, 0.5},
+    {"zoom4", 4., 0.5, 0.5},
+    {"zoom16", 16., 0.3, 0.7},
+};
+
+std::vector<Drawing> generateDrawings()
+{
+    const auto generate = [](const char* name, unsigned seed, const LC_DrawingGenerator::Parameters& parameters) {
+        Drawing drawing{name, std::make_unique<RS_Graphic>()};
+        LC_DrawingGenerator{seed}.generate(*drawing.graphic, parameters);
+        return drawing;
+    };
+    std::vector<Drawing> drawings;
+
+    LC_DrawingGenerator::Parameters geometry;
+    geometry.lines = 3000;
+    geometry.circles = 1000;
+    geometry.arcs = 1000;
+    geometry.polylines = 200;
+    geometry.splines = 100;
+    drawings.push_back(generate("geometry", 1, geometry));
+
+    LC_DrawingGenerator::Parameters texts;
+    texts.texts = 400;
+    drawings.push_back(generate("texts", 2, texts));
+
+    LC_DrawingGenerator::Parameters hatches;
+    hatches.hatches = 60;
+    hatches.hatchLoops = 2;
+    hatches.hatchVertices = 6;
+    drawings.push_back(generate("hatches", 3, hatches));
+
+    LC_DrawingGenerator::Parameters inserts;
+    inserts.blocks = 30;
+    inserts.inserts = 300;
+    inserts.blockDepth = 3;
+    drawings.push_back(generate("inserts", 4, inserts));
+    return drawings;
+}
+
+/**
+ * @brief countDifferences counts the pixels with a channel differing by more than
+ * the tolerance, the differing pixels are red in the difference image
+ */
+qint64 countDifferences(const QImage& image, const QImage& golden, int tolerance, QImage& differences)
+{
+    differences = QImage(image.size(), QImage::Format_ARGB32);
+    differences.fill(Qt::white);
+    qint64 count = 0;
+    for (int y = 0; y < image.height(); ++y) {
+        const auto* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        const auto* goldenLine = reinterpret_cast<const QRgb*>(golden.constScanLine(y));
+        auto* differenceLine = reinterpret_cast<QRgb*>(differences.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            const QRgb a = line[x];
+            const QRgb b = goldenLine[x];
+            const int difference = std::max({std::abs(qRed(a) - qRed(b)), std::abs(qGreen(a) - qGreen(b)),
+                                             std::abs(qBlue(a) - qBlue(b)), std::abs(qAlpha(a) - qAlpha(b))});
+            if (difference > tolerance) {
+                differenceLine[x] = qRgb(255, 0, 0);
+                ++count;
+            } else {
+                // the golden image faded
+                const int gray = 192 + qGray(b) / 4;
+                differenceLine[x] = qRgb(gray, gray, gray);
+            }
+        }
+    }
+    return count;
+}
+
+QJsonObject readJson(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+bool writeJson(const QString& fileName, const QJsonObject& object)
+{
+    const QByteArray json = QJsonDocument(object).toJson();
+    if (fileName.isEmpty()) {
+        QFile out;
+        out.open(stdout, QIODevice::WriteOnly);
+        return out.write(json) == json.size();
+    }
+    QFile out(fileName);
+    if (!out.open(QIODevice::WriteOnly) || out.write(json) != json.size()) {
+        qDebug() << "ERROR: Cannot write" << fileName;
+        return false;
+    }
+    return true;
+}
+}
+
+int console_rendertest(int argc, char* argv[])
+{
+    RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
+
+    setHeadlessPlatform();
+    QApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QFileInfo prgInfo(QFile::decodeName(argv[0]));
+    QString prgDir(prgInfo.absolutePath());
+    RS_SETTINGS->init(app.organizationName(), app.applicationName());
+    RS_SYSTEM->init(app.applicationName(), app.applicationVersion(),
+        XSTR(QC_APPDIR), prgDir.toLatin1().data());
+
+    QCommandLineParser parser;
+
+    QString appDesc = "\nRender reference drawings at fixed viewports and compare them with"
+                      " golden images.";
+    appDesc += "\n\n";
+    appDesc += "The reference drawings are generated from fixed seeds; DXF or DWG files given"
+               " are rendered too.\n";
+    appDesc += "Images differing from the golden images by more than the tolerance, and render"
+               " times slower\n";
+    appDesc += "than the golden times by more than the threshold are reported, and the exit"
+               " code is not zero.\n";
+    appDesc += "Differing images are written with difference images to the subdirectory"
+               " 'failed' of the golden directory.\n";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption goldenOpt(QStringList() << "g" << "golden",
+        "Directory of the golden images and times.", "directory");
+    parser.addOption(goldenOpt);
+
+    QCommandLineOption updateOpt(QStringList() << "u" << "update",
+        "Write the images and times as the golden ones, instead of comparing.");
+    parser.addOption(updateOpt);
+
+    QCommandLineOption toleranceOpt(QStringList() << "t" << "tolerance",
+        "Difference of a color channel ignored, from 0 to 255.", "integer", "32");
+    parser.addOption(toleranceOpt);
+
+    QCommandLineOption pixelsOpt(QStringList() << "p" << "pixels",
+        "Differing pixels allowed per image, in percent.", "number", "0.1");
+    parser.addOption(pixelsOpt);
+
+    QCommandLineOption thresholdOpt(QStringList() << "s" << "slower",
+        "Render time increase allowed, in percent.", "number", "25");
+    parser.addOption(thresholdOpt);
+
+    QCommandLineOption iterationsOpt(QStringList() << "i" << "iterations",
+        "Number of timed renders of each view, the median is reported.", "integer", "5");
+    parser.addOption(iterationsOpt);
+
+    QCommandLineOption outFileOpt(QStringList() << "o" << "outfile",
+        "Output JSON file of the results, standard output by default.", "file");
+    parser.addOption(outFileOpt);
+
+    parser.addPositionalArgument("<files>", "Optional DXF or DWG files rendered too.");
+
+    parser.process(app);
+
+    if (!parser.isSet(goldenOpt))
+        parser.showHelp(EXIT_FAILURE);
+    const QDir golden(parser.value(goldenOpt));
+    const bool update = parser.isSet(updateOpt);
+    if (update && !golden.mkpath(".")) {
+        qDebug() << "ERROR: Cannot create" << golden.path();
+        return 1;
+    }
+    const int tolerance = std::clamp(parser.value(toleranceOpt).toInt(), 0, 255);
+    const double pixels = std::max(parser.value(pixelsOpt).toDouble(), 0.);
+    const double threshold = std::max(parser.value(thresholdOpt).toDouble(), 0.);
+    const int iterations = std::max(parser.value(iterationsOpt).toInt(), 1);
+
+    RS_FONTLIST->init();
+    RS_PATTERNLIST->init();
+
+    std::vector<Drawing> drawings = generateDrawings();
+    QStringList files = parser.positionalArguments();
+    // the first argument is the command
+    if (!files.isEmpty() && files.first() == "rendertest")
+        files.removeFirst();
+    for (const QString& file: files) {
+        Drawing drawing{QFileInfo(file).completeBaseName(), std::make_unique<RS_Graphic>()};
+        if (!RS_FileIO::instance()->fileImport(*drawing.graphic, file)) {
+            qDebug() << "ERROR: Cannot open" << file;
+            return 1;
+        }
+        drawings.push_back(std::move(drawing));
+    }
+
+    const QJsonObject goldenTimes = update ? QJsonObject{} : readJson(golden.filePath(timesFile));
+    QJsonObject times;
+    QJsonArray results;
+    int failures = 0;
+
+    QImage image(imageWidth, imageHeight, QImage::Format_ARGB32_Premultiplied);
+    RS_PainterQt painter(&image);
+    painter.setBackground(Qt::white);
+    RS_StaticGraphicView view(image.width(), image.height(), &painter);
+    for (Drawing& drawing: drawings) {
+        RS_Graphic& graphic = *drawing.graphic;
+        graphic.calculateBorders();
+        view.setContainer(&graphic);
+        const RS_Vector extent = graphic.getMax() - graphic.getMin();
+        for (const Viewport& viewport: viewports) {
+            const QString name = drawing.name + "_" + viewport.name;
+            view.zoomAuto(false);
+            view.zoomIn(viewport.zoom, graphic.getMin() + RS_Vector{extent.x * viewport.x, extent.y * viewport.y});
+
+            std::vector<double> renderTimes;
+            for (int i = 0; i <= iterations; ++i) {
+                QElapsedTimer timer;
+                timer.start();
+                painter.eraseRect(0, 0, image.width(), image.height());
+                view.drawEntity(&painter, &graphic);
+                // the batched lines are part of the drawing, and of the image compared
+                painter.flush();
+                // the first render warms up caches
+                if (i > 0)
+                    renderTimes.push_back(timer.nsecsElapsed() * 1e-6);
+            }
+            std::sort(renderTimes.begin(), renderTimes.end());
+            const double ms = renderTimes[renderTimes.size() / 2];
+            times[name] = ms;
+
+            QJsonObject result;
+            result["name"] = name;
+            result["ms"] = ms;
+            const QString imageFile = golden.filePath(name + ".png");
+            if (update) {
+                if (!image.save(imageFile)) {
+                    qDebug() << "ERROR: Cannot write" << imageFile;
+                    return 1;
+                }
+                results.append(result);
+                qDebug().noquote() << name << ms << "ms";
+                continue;
+            }
+
+            // the image
+            const QImage goldenImage = QImage(imageFile).convertToFormat(image.format());
+            bool imageOk = false;
+            if (goldenImage.isNull() || goldenImage.size() != image.size()) {
+                qDebug().noquote() << "MISSING" << imageFile;
+                result["image"] = "missing";
+            } else {
+                QImage differences;
+                const qint64 differing = countDifferences(image, goldenImage, tolerance, differences);
+                const double percent = 100. * differing / (image.width() * image.height());
+                imageOk = percent <= pixels;
+                result["image"] = imageOk ? "ok" : "changed";
+                result["differing_percent"] = percent;
+                if (!imageOk) {
+                    qDebug().noquote() << "CHANGED" << name << percent << "% of the pixels differ";
+                    golden.mkpath("failed");
+                    image.save(golden.filePath("failed/" + name + ".png"));
+                    differences.save(golden.filePath("failed/" + name + ".diff.png"));
+                }
+            }
+
+            // the time
+            bool timeOk = true;
+            const double goldenMs = goldenTimes[name].toDouble();
+            if (goldenMs > 0.) {
+                const double change = (ms - goldenMs) / goldenMs * 100.;
+                result["golden_ms"] = goldenMs;
+                result["change_percent"] = change;
+                timeOk = change <= threshold;
+                if (!timeOk)
+                    qDebug().noquote() << "SLOWER" << name << goldenMs << "->" << ms << "ms";
+            }
+            result["time"] = timeOk ? "ok" : "slower";
+            if (!imageOk || !timeOk)
+                ++failures;
+            results.append(result);
+            qDebug().noquote() << name << ms << "ms" << result["image"].toString();
+        }
+    }
+    painter.flushAndEnd();
+
+    if (update && !writeJson(golden.filePath(timesFile), times))
+        return 1;
+
+    QJsonObject report;
+    report["librecad"] = QString(XSTR(LC_VERSION));
+    report["qt"] = QString(qVersion());
+    report["tolerance"] = tolerance;
+    report["pixels_percent"] = pixels;
+    report["slower_percent"] = threshold;
+    report["failures"] = failures;
+    report["results"] = results;
+    if (!writeJson(parser.value(outFileOpt), report))
+        return 1;
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <memory>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QFileInfo>
+
+#include "main.h"
+
+#include "console_script.h"
+#include "lc_batchscript.h"
+#include "qg_actionhandler.h"
+#include "qg_commandedit.h"
+#include "rs.h"
+#include "rs_debug.h"
+#include "rs_fileio.h"
+#include "rs_fontlist.h"
+#include "rs_graphic.h"
+#include "rs_patternlist.h"
+#include "rs_settings.h"
+#include "rs_staticgraphicview.h"
+#include "rs_system.h"
+
+namespace {
+
+/**
+ * @brief runCommandFile plays back a command file of the command line on the
+ * drawing as one macro, with the actions run by a view without painting
+ */
+void runCommandFile(RS_Graphic& graphic, const QString& path)
+{
+    RS_StaticGraphicView view(1000, 1000, nullptr);
+    view.setContainer(&graphic);
+    view.zoomAuto(false);
+
+    QG_ActionHandler actionHandler(nullptr);
+    actionHandler.set_view(&view);
+    actionHandler.set_document(&graphic);
+
+    QG_CommandEdit commandEdit;
+    QObject::connect(&commandEdit, &QG_CommandEdit::command, [&actionHandler](QString cmd) {
+        cmd = cmd.simplified();
+        if (!actionHandler.command(cmd) && !(cmd.contains(',') || cmd.startsWith('@')))
+            qDebug() << "WARNING: Unknown command:" << cmd;
+    });
+    QObject::connect(&commandEdit, &QG_CommandEdit::macroStarted,
+                     [&actionHandler]() { actionHandler.beginMacro(); });
+    QObject::connect(&commandEdit, &QG_CommandEdit::macroFinished,
+                     [&actionHandler]() { actionHandler.endMacro(); });
+    commandEdit.readCommandFile(path);
+
+    view.killAllActions();
+}
+
+} // namespace
+
+/////////
+/// \brief console_script is called if librecad
+/// as console script runner for batch edits of drawings.
+/// \param argc
+/// \param argv
+/// \return
+///
+int console_script(int argc, char* argv[])
+{
+    RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
+
+    setHeadlessPlatform();
+    QApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QFileInfo prgInfo(QFile::decodeName(argv[0]));
+    QString prgDir(prgInfo.absolutePath());
+    RS_SETTINGS->init(app.organizationName(), app.applicationName());
+    RS_SYSTEM->init(app.applicationName(), app.applicationVersion(),
+        XSTR(QC_APPDIR), prgDir.toLatin1().data());
+
+    QCommandLineParser parser;
+
+    QString appDesc = "\nRun a script of batch edits on a drawing.";
+    appDesc += "\n\n";
+    appDesc += "The script has one command per line, \"#\" starts a comment.\n";
+    appDesc += "The commands edit the selected entities all at once:\n\n";
+    appDesc += LC_BatchScript::help().join('\n');
+    appDesc += "\n\nNumbers are expressions, with the variables of \"set\" and -D.\n";
+    appDesc += "Command files of the command line given by -m are played back on the"
+               " drawing first;\n";
+    appDesc += "the script is optional then.\n";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption outFileOpt(QStringList() << "o" << "outfile",
+        "Output DXF file, the drawing is saved, if given.", "file");
+    parser.addOption(outFileOpt);
+
+    QCommandLineOption defineOpt(QStringList() << "D" << "define",
+        "Variable of the script.", "name=value");
+    parser.addOption(defineOpt);
+
+    QCommandLineOption macroOpt(QStringList() << "m" << "macro",
+        "Command file of the command line, played back before the script.", "file");
+    parser.addOption(macroOpt);
+
+    parser.addPositionalArgument("<script>", "Script file to run.");
+    parser.addPositionalArgument("[<file>]", "Optional DXF or DWG file to edit,"
+                                 " instead of the one opened by the script.");
+
+    parser.process(app);
+
+    // with macros, a single argument is the drawing
+    const QStringList macros = parser.values(macroOpt);
+    QStringList arguments = parser.positionalArguments();
+    if (!macros.isEmpty() && arguments.size() == 1)
+        arguments.prepend(QString{});
+    if (arguments.isEmpty() || arguments.size() > 2)
+        parser.showHelp(EXIT_FAILURE);
+
+    RS_FONTLIST->init();
+    RS_PATTERNLIST->init();
+
+    std::unique_ptr<RS_Graphic> graphic;
+    if (arguments.size() == 2) {
+        graphic = std::make_unique<RS_Graphic>();
+        if (!RS_FileIO::instance()->fileImport(*graphic, arguments.at(1))) {
+            qDebug() << "ERROR: Failed to load file:" << arguments.at(1);
+            return EXIT_FAILURE;
+        }
+    }
+
+    LC_BatchScript script{graphic.get()};
+    for (const QString& define: parser.values(defineOpt)) {
+        const int separator = define.indexOf('=');
+        bool ok = false;
+        const double value = define.mid(separator + 1).toDouble(&ok);
+        if (separator <= 0 || !ok) {
+            qDebug() << "ERROR: Bad variable:" << define;
+            return EXIT_FAILURE;
+        }
+        script.setVariable(define.left(separator), value);
+    }
+
+    for (const QString& macro: macros) {
+        if (!QFileInfo::exists(macro)) {
+            qDebug() << "ERROR: Cannot read command file:" << macro;
+            return EXIT_FAILURE;
+        }
+        runCommandFile(*graphic, macro);
+    }
+
+    if (!arguments.first().isEmpty() && !script.runFile(arguments.first())) {
+        qDebug().noquote() << "ERROR:" << arguments.first() << script.getError();
+        return EXIT_FAILURE;
+    }
+
+    if (parser.isSet(outFileOpt)) {
+        if (script.getGraphic() == nullptr) {
+            qDebug() << "ERROR: No drawing to save";
+            return EXIT_FAILURE;
+        }
+        const QString outFile = parser.value(outFileOpt);
+        if (!RS_FileIO::instance()->fileExport(*script.getGraphic(), outFile,
+                                               RS2::FormatDXFRW)) {
+            qDebug() << "ERROR: Failed to save file:" << outFile;
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -24,6 +24,12 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <map>
+#include <string_view>
+#include <vector>
+
+#include <QElapsedTimer>
 #include <QEventLoop>
 #include <QList>
 #include <QInputDialog>
@@ -46,13 +52,214 @@
 #include "rs_ellipse.h"
 #include "rs_polyline.h"
 #include "lc_splinepoints.h"
+#include "lc_regenstatistics.h"
 #include "lc_undosection.h"
 #include "intern/qc_actiongetpoint.h"
 #include "intern/qc_actiongetselect.h"
 #include "intern/qc_actiongetent.h"
 #include "rs_math.h"
 #include "rs_debug.h"
+#include "rs_fontlist.h"
 #include "rs_units.h"
+#include "rs_selection.h"
+#include "rs_settings.h"
+
+struct Doc_plugin_interface::Profile {
+    struct Method {
+        unsigned long calls = 0;
+        qint64 ns = 0;
+    };
+
+    void addConverted(qsizetype values)
+    {
+        ++convertedEntities;
+        convertedValues += values;
+    }
+
+    // methods by name, names are string literals
+    std::map<std::string_view, Method> methods;
+    // the time since the plugin interface was created
+    QElapsedTimer timer;
+    // outermost calls: in the interface, and waiting for the user
+    qint64 interfaceNs = 0;
+    qint64 inputNs = 0;
+    int depth = 0;
+    unsigned long wrappedEntities = 0;
+    unsigned long createdEntities = 0;
+    unsigned long convertedEntities = 0;
+    qint64 convertedValues = 0;
+};
+
+namespace {
+// a call of a plugin interface method, counted and timed if the plugin is profiled
+class ProfiledCall {
+public:
+    ProfiledCall(Doc_plugin_interface::Profile* profile, const char* method, bool input = false):
+        m_profile{profile}
+      , m_method{method}
+      , m_input{input}
+    {
+        if (m_profile != nullptr) {
+            ++m_profile->depth;
+            m_timer.start();
+        }
+    }
+    ~ProfiledCall()
+    {
+        if (m_profile == nullptr)
+            return;
+        const qint64 ns = m_timer.nsecsElapsed();
+        Doc_plugin_interface::Profile::Method& method = m_profile->methods[m_method];
+        ++method.calls;
+        method.ns += ns;
+        if (--m_profile->depth == 0)
+            (m_input ? m_profile->inputNs : m_profile->interfaceNs) += ns;
+    }
+    ProfiledCall(const ProfiledCall&) = delete;
+    ProfiledCall& operator = (const ProfiledCall&) = delete;
+
+private:
+    Doc_plugin_interface::Profile* const m_profile;
+    const char* const m_method;
+    const bool m_input;
+    QElapsedTimer m_timer;
+};
+
+DPI::ETYPE toPluginType(RS2::EntityType type)
+{
+    switch (type) {
+    case RS2::EntityLine: return DPI::LINE;
+    case RS2::EntityPoint: return DPI::POINT;
+    case RS2::EntityArc: return DPI::ARC;
+    case RS2::EntityCircle: return DPI::CIRCLE;
+    case RS2::EntityEllipse: return DPI::ELLIPSE;
+    case RS2::EntitySolid: return DPI::SOLID;
+    case RS2::EntityConstructionLine: return DPI::CONSTRUCTIONLINE;
+    case RS2::EntityImage: return DPI::IMAGE;
+    case RS2::EntityOverlayBox: return DPI::OVERLAYBOX;
+    case RS2::EntityInsert: return DPI::INSERT;
+    case RS2::EntityMText: return DPI::MTEXT;
+    case RS2::EntityText: return DPI::TEXT;
+    case RS2::EntityHatch: return DPI::HATCH;
+    case RS2::EntitySpline: return DPI::SPLINE;
+    case RS2::EntitySplinePoints: return DPI::SPLINEPOINTS;
+    case RS2::EntityPolyline: return DPI::POLYLINE;
+    case RS2::EntityDimAligned: return DPI::DIMALIGNED;
+    case RS2::EntityDimLinear: return DPI::DIMLINEAR;
+    case RS2::EntityDimRadial: return DPI::DIMRADIAL;
+    case RS2::EntityDimDiametric: return DPI::DIMDIAMETRIC;
+    case RS2::EntityDimAngular: return DPI::DIMANGULAR;
+    case RS2::EntityDimLeader: return DPI::DIMLEADER;
+    default: return DPI::UNKNOWN;
+    }
+}
+
+// appends the vertices of the polyline with the bulges of the following segments
+template<class Container>
+void appendPolylineVertices(RS_Polyline* polyline, Container& vertices)
+{
+    RS_Entity* v = polyline->firstEntity(RS2::ResolveNone);
+    //bad polyline without vertex
+    if (v == nullptr)
+        return;
+
+    //First polyline vertex
+    double bulge = (v->rtti() == RS2::EntityArc) ? static_cast<RS_Arc*>(v)->getBulge() : 0.;
+    auto ae = static_cast<RS_AtomicEntity*>(v);
+    vertices.push_back(Plug_VertexData(QPointF(ae->getStartpoint().x, ae->getStartpoint().y), bulge));
+
+    RS_Entity* nextEntity = nullptr;
+    for (v = polyline->firstEntity(RS2::ResolveNone); v; v = nextEntity) {
+        nextEntity = polyline->nextEntity(RS2::ResolveNone);
+        bulge = 0.0;
+        if (!v->isAtomic())
+            continue;
+        ae = static_cast<RS_AtomicEntity*>(v);
+
+        if (nextEntity != nullptr && nextEntity->rtti() == RS2::EntityArc)
+            bulge = static_cast<RS_Arc*>(nextEntity)->getBulge();
+
+        if (!polyline->isClosed() || nextEntity != nullptr)
+            vertices.push_back(Plug_VertexData(QPointF(ae->getEndpoint().x, ae->getEndpoint().y), bulge));
+    }
+}
+
+// adds the lines between consecutive points, from the point of each index
+template <typename PointAt>
+void addLineEntities(RS_Document* doc, std::size_t count, bool closed, PointAt pointAt)
+{
+    if (count < 2)
+        return;
+    LC_UndoSection undo(doc);
+    doc->reserveEntities(int(count));
+    RS_Vector start = pointAt(0);
+    const auto addLine = [doc, &undo](const RS_Vector& from, const RS_Vector& to) {
+        RS_Line* line = new RS_Line{doc, from, to};
+        doc->addEntity(line);
+        undo.addUndoable(line);
+    };
+    for (std::size_t i = 1; i < count; ++i) {
+        const RS_Vector end = pointAt(i);
+        addLine(start, end);
+        start = end;
+    }
+    if (closed)
+        addLine(start, pointAt(0));
+}
+
+// creates a polyline from the vertex and bulge of each index, the segments are added at once
+template <typename VertexAt>
+RS_Polyline* createPolyline(RS_Document* doc, std::size_t count, bool closed, VertexAt vertexAt)
+{
+    RS_PolylineData data;
+    if (closed)
+        data.setFlag(RS2::FlagClosed);
+    RS_Polyline* entity = new RS_Polyline(doc, data);
+
+    std::vector<std::pair<RS_Vector, double>> vertices;
+    vertices.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        vertices.push_back(vertexAt(i));
+    entity->appendVertexs(vertices);
+    return entity;
+}
+
+// creates splinepoints through the point of each index
+template <typename PointAt>
+LC_SplinePoints* createSplinePoints(RS_Document* doc, std::size_t count, bool closed,
+                                    PointAt pointAt)
+{
+    LC_SplinePointsData data(closed, false); //cut = false
+    data.splinePoints.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        data.splinePoints.push_back(pointAt(i));
+    return new LC_SplinePoints(doc, data);
+}
+
+DPI::VAlign toPluginVAlign(RS_TextData::VAlign va)
+{
+    switch (va) {
+    case RS_TextData::VATop: return DPI::VAlignTop;
+    case RS_TextData::VAMiddle: return DPI::VAlignMiddle;
+    default: return DPI::VAlignBottom;
+    }
+}
+
+DPI::HAlign toPluginHAlign(RS_TextData::HAlign ha)
+{
+    switch (ha) {
+    case RS_TextData::HACenter:
+    case RS_TextData::HAMiddle:
+        return DPI::HAlignCenter;
+    case RS_TextData::HARight: return DPI::HAlignRight;
+    default: return DPI::HAlignLeft;
+    }
+}
+}
+
+// profiles the method of the plugin interface, input methods wait for the user
+#define DPI_PROFILE(dpi, ...) \
+    const ProfiledCall profiledCall{(dpi) != nullptr ? (dpi)->getProfile() : nullptr, __VA_ARGS__}
 
 convLTW::convLTW(){
 //    QHash<int, QString> lType;
@@ -142,6 +349,8 @@ Plugin_Entity::Plugin_Entity(RS_Entity* ent, Doc_plugin_interface* d):
   ,hasContainer(true)
   ,dpi(d)
 {
+    if (dpi != nullptr && dpi->getProfile() != nullptr)
+        ++dpi->getProfile()->wrappedEntities;
 }
 
 /*RS_EntityContainer* parent,
@@ -226,10 +435,12 @@ Plugin_Entity::~Plugin_Entity() {
 }
 
 RS2::EntityType Plugin_Entity::getEntityType(){
+    DPI_PROFILE(dpi, "Plugin_Entity::getEntityType");
     return entity->rtti();
 }
 
 void Plugin_Entity::getData(QHash<int, QVariant> *data){
+    DPI_PROFILE(dpi, "Plugin_Entity::getData");
 	if (!entity) return;
     RS2::EntityType et = entity->rtti();
     data->insert(DPI::EID, (qulonglong)entity->getId());
@@ -377,10 +588,15 @@ void Plugin_Entity::getData(QHash<int, QVariant> *data){
         data->insert(DPI::ETYPE, DPI::UNKNOWN);
         break;
     }
+    if (dpi != nullptr && dpi->getProfile() != nullptr)
+        dpi->getProfile()->addConverted(data->size());
 }
 
 void Plugin_Entity::updateData(QHash<int, QVariant> *data){
+    DPI_PROFILE(dpi, "Plugin_Entity::updateData");
 	if (!entity) return;
+    if (dpi != nullptr && dpi->getProfile() != nullptr)
+        dpi->getProfile()->addConverted(data->size());
     RS_Entity *ec= entity;
     if(hasContainer && dpi) {
         ec = entity->clone();
@@ -641,53 +857,23 @@ void Plugin_Entity::updateData(QHash<int, QVariant> *data){
 }
 
 void Plugin_Entity::getPolylineData(QList<Plug_VertexData> *data){
+    DPI_PROFILE(dpi, "Plugin_Entity::getPolylineData");
 	if (!entity) return;
     RS2::EntityType et = entity->rtti();
     if (et != RS2::EntityPolyline) return;
-    RS_Polyline *l = static_cast<RS_Polyline*>(entity);
-
-    RS_Entity* nextEntity = 0;
-	RS_AtomicEntity* ae = nullptr;
-    RS_Entity* v = l->firstEntity(RS2::ResolveNone);
-    double bulge=0.0;
-//bad polyline without vertex
-	if (!v) return;
-
-//First polyline vertex
-    if (v->rtti() == RS2::EntityArc) {
-        bulge = ((RS_Arc*)v)->getBulge();
-    }
-    ae = (RS_AtomicEntity*)v;
-    data->append(Plug_VertexData(QPointF(ae->getStartpoint().x,
-                                         ae->getStartpoint().y),bulge));
-
-	for (v=l->firstEntity(RS2::ResolveNone); v; v=nextEntity) {
-		nextEntity = l->nextEntity(RS2::ResolveNone);
-        bulge = 0.0;
-        if (!v->isAtomic()) {
-            continue;
-        }
-        ae = (RS_AtomicEntity*)v;
-
-        if (nextEntity) {
-            if (nextEntity->rtti()==RS2::EntityArc) {
-                bulge = ((RS_Arc*)nextEntity)->getBulge();
-            }
-        }
-
-		if (!l->isClosed() || nextEntity) {
-            data->append(Plug_VertexData(QPointF(ae->getEndpoint().x,
-                                         ae->getEndpoint().y),bulge));
-        }
-    }
-
+    appendPolylineVertices(static_cast<RS_Polyline*>(entity), *data);
+    if (dpi != nullptr && dpi->getProfile() != nullptr)
+        dpi->getProfile()->addConverted(data->size());
 }
 
 void Plugin_Entity::updatePolylineData(QList<Plug_VertexData> *data){
+    DPI_PROFILE(dpi, "Plugin_Entity::updatePolylineData");
 	if (!entity) return;
     RS2::EntityType et = entity->rtti();
     if (et != RS2::EntityPolyline) return;
     if (data->size()<2) return; //At least two vertex
+    if (dpi != nullptr && dpi->getProfile() != nullptr)
+        dpi->getProfile()->addConverted(data->size());
     RS_Vector vec(false);
     RS_Polyline *pl = static_cast<RS_Polyline*>(entity);
 //    vec.x = data->at(0).point.x();
@@ -706,6 +892,7 @@ void Plugin_Entity::updatePolylineData(QList<Plug_VertexData> *data){
 }
 
 void Plugin_Entity::move(QPointF offset, DPI::Disposition disp) {
+    DPI_PROFILE(dpi, "Plugin_Entity::move");
     RS_Entity *ne = entity->clone();
     ne->move( RS_Vector(offset.x(), offset.y()) );
     bool ok = dpi->addToUndo(entity, ne, disp);
@@ -718,6 +905,7 @@ void Plugin_Entity::move(QPointF offset, DPI::Disposition disp) {
 }
 
 void Plugin_Entity::moveRotate(QPointF const& offset, QPointF const& center, double angle, DPI::Disposition disp) {
+    DPI_PROFILE(dpi, "Plugin_Entity::moveRotate");
 	RS_Entity *ne = entity->clone();
 	ne->move( RS_Vector(offset.x(), offset.y()) );
 	ne->rotate( RS_Vector(center.x(), center.y()) , angle);
@@ -732,6 +920,7 @@ void Plugin_Entity::moveRotate(QPointF const& offset, QPointF const& center, dou
 }
 
 void Plugin_Entity::rotate(QPointF center, double angle, DPI::Disposition disp) {
+    DPI_PROFILE(dpi, "Plugin_Entity::rotate");
     RS_Entity *ne = entity->clone();
     ne->rotate( RS_Vector(center.x(), center.y()) , angle);
     bool ok = dpi->addToUndo(entity, ne, disp);
@@ -744,6 +933,7 @@ void Plugin_Entity::rotate(QPointF center, double angle, DPI::Disposition disp)
 }
 
 void Plugin_Entity::scale(QPointF center, QPointF factor, DPI::Disposition disp) {
+    DPI_PROFILE(dpi, "Plugin_Entity::scale");
     RS_Entity *ne = entity->clone();
     ne->scale( RS_Vector(center.x(), center.y()),
                 RS_Vector(factor.x(), factor.y()) );
@@ -758,6 +948,7 @@ void Plugin_Entity::scale(QPointF center, QPointF factor, DPI::Disposition disp)
 }
 
 QString Plugin_Entity::intColor2str(int color){
+    DPI_PROFILE(dpi, "Plugin_Entity::intColor2str");
     return Converter.intColor2str(color);
 }
 
@@ -767,6 +958,54 @@ doc(d)
 ,gView(gv)
 ,main_window(parent)
 {
+    RS_SETTINGS->beginGroup("/Defaults");
+    if (RS_SETTINGS->readNumEntry("/ProfilePlugins", 0) != 0) {
+        profile = std::make_unique<Profile>();
+        profile->timer.start();
+    }
+    RS_SETTINGS->endGroup();
+}
+
+Doc_plugin_interface::~Doc_plugin_interface()
+{
+    // a batch left open by the plugin
+    if (batchDepth > 0) {
+        batchDepth = 1;
+        endBatch();
+    }
+}
+
+/**
+ * The total time of the plugin is split in the time spent in the interface, waiting
+ * for the user, and in the plugin itself. Methods are sorted by time, their times
+ * include the interface methods they call.
+ */
+QStringList Doc_plugin_interface::getProfileReport() const
+{
+    if (profile == nullptr)
+        return {};
+    const auto ms = [](qint64 ns) {
+        return QString::number(ns * 1e-6, 'f', 1);
+    };
+    const qint64 totalNs = profile->timer.nsecsElapsed();
+    QStringList lines;
+    lines << QObject::tr("Plugin: %1 ms, %2 ms in the interface, %3 ms waiting for input, %4 ms in the plugin")
+             .arg(ms(totalNs), ms(profile->interfaceNs), ms(profile->inputNs),
+                  ms(totalNs - profile->interfaceNs - profile->inputNs));
+    lines << QObject::tr("  entities: %1 wrapped, %2 created, %3 converted with %4 values")
+             .arg(profile->wrappedEntities).arg(profile->createdEntities)
+             .arg(profile->convertedEntities).arg(profile->convertedValues);
+
+    std::vector<std::pair<std::string_view, Profile::Method>> methods{profile->methods.cbegin(),
+                                                                 profile->methods.cend()};
+    std::sort(methods.begin(), methods.end(), [](const auto& a, const auto& b) {
+        return a.second.ns > b.second.ns;
+    });
+    for (const auto& [name, method]: methods)
+        lines << QObject::tr("  %1: %2 calls, %3 ms")
+                 .arg(QLatin1String(name.data(), qsizetype(name.size())))
+                 .arg(method.calls).arg(ms(method.ns));
+    return lines;
 }
 
 bool Doc_plugin_interface::addToUndo(RS_Entity* current, RS_Entity* modified,
@@ -788,12 +1027,18 @@ bool Doc_plugin_interface::addToUndo(RS_Entity* current, RS_Entity* modified,
 }
 
 void Doc_plugin_interface::updateView(){
+    DPI_PROFILE(this, "updateView");
     doc->setSelected(false);
+    if (batchDepth > 0) {
+        batchRedraw = true;
+        return;
+    }
     gView->getContainer()->calculateBorders();
     gView->redraw();
 }
 
 void Doc_plugin_interface::addPoint(QPointF *start){
+    DPI_PROFILE(this, "addPoint");
 
     RS_Vector v1(start->x(), start->y());
     if (doc) {
@@ -806,6 +1051,7 @@ void Doc_plugin_interface::addPoint(QPointF *start){
 }
 
 void Doc_plugin_interface::addLine(QPointF *start, QPointF *end){
+    DPI_PROFILE(this, "addLine");
 
     RS_Vector v1(start->x(), start->y());
     RS_Vector v2(end->x(), end->y());
@@ -820,6 +1066,7 @@ void Doc_plugin_interface::addLine(QPointF *start, QPointF *end){
 
 void Doc_plugin_interface::addMText(QString txt, QString sty, QPointF *start,
             double height, double angle, DPI::HAlign ha,  DPI::VAlign va){
+    DPI_PROFILE(this, "addMText");
 
     RS_Vector v1(start->x(), start->y());
     if (doc) {
@@ -841,6 +1088,7 @@ void Doc_plugin_interface::addMText(QString txt, QString sty, QPointF *start,
 
 void Doc_plugin_interface::addText(QString txt, QString sty, QPointF *start,
             double height, double angle, DPI::HAlign ha,  DPI::VAlign va){
+    DPI_PROFILE(this, "addText");
 
     RS_Vector v1(start->x(), start->y());
     if (doc) {
@@ -860,6 +1108,7 @@ void Doc_plugin_interface::addText(QString txt, QString sty, QPointF *start,
 }
 
 void Doc_plugin_interface::addCircle(QPointF *start, qreal radius){
+    DPI_PROFILE(this, "addCircle");
     if (doc) {
         RS_Vector v(start->x(), start->y());
         RS_CircleData d(v, radius);
@@ -873,6 +1122,7 @@ void Doc_plugin_interface::addCircle(QPointF *start, qreal radius){
 }
 
 void Doc_plugin_interface::addArc(QPointF *start, qreal radius, qreal a1, qreal a2){
+    DPI_PROFILE(this, "addArc");
     if (doc) {
         RS_Vector v(start->x(), start->y());
         RS_ArcData d(v, radius,
@@ -888,6 +1138,7 @@ void Doc_plugin_interface::addArc(QPointF *start, qreal radius, qreal a1, qreal
 }
 
 void Doc_plugin_interface::addEllipse(QPointF *start, QPointF *end, qreal ratio, qreal a1, qreal a2){
+    DPI_PROFILE(this, "addEllipse");
     if (doc) {
         RS_Vector v1(start->x(), start->y());
         RS_Vector v2(end->x(), end->y());
@@ -904,41 +1155,131 @@ void Doc_plugin_interface::addEllipse(QPointF *start, QPointF *end, qreal ratio,
 
 void Doc_plugin_interface::addLines(std::vector<QPointF> const& points, bool closed)
 {
+    DPI_PROFILE(this, "addLines");
+    if (doc) {
+        addLineEntities(doc, points.size(), closed, [&points](std::size_t i) {
+            return RS_Vector(points[i].x(), points[i].y());
+        });
+    } else
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+}
+
+void Doc_plugin_interface::addLines(const double* xy, std::size_t count, bool closed)
+{
+    DPI_PROFILE(this, "addLines");
     if (doc) {
-        RS_LineData data;
+        addLineEntities(doc, count, closed, [xy](std::size_t i) {
+            return RS_Vector(xy[2 * i], xy[2 * i + 1]);
+        });
+    } else
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+}
+
+void Doc_plugin_interface::beginBatch()
+{
+    DPI_PROFILE(this, "beginBatch");
+    if (doc == nullptr || batchDepth++ > 0)
+        return;
+    // one undo cycle for the whole batch, the undo sections of the additions nest in it
+    doc->startUndoCycle();
+    doc->setAutoUpdateBorders(false);
+    batchRedraw = false;
+}
+
+void Doc_plugin_interface::endBatch()
+{
+    DPI_PROFILE(this, "endBatch");
+    if (doc == nullptr || batchDepth == 0 || --batchDepth > 0)
+        return;
+    doc->endUndoCycle();
+    doc->setAutoUpdateBorders(true);
+    doc->calculateBorders();
+    if (gView != nullptr)
+        gView->redraw(batchRedraw ? RS2::RedrawAll : RS2::RedrawDrawing);
+    batchRedraw = false;
+}
 
+void Doc_plugin_interface::addPoints(std::vector<QPointF> const& points)
+{
+    DPI_PROFILE(this, "addPoints");
+    if (doc) {
         LC_UndoSection undo(doc);
-        data.endpoint=RS_Vector(points.front().x(), points.front().y());
-
-        for(size_t i=1; i<points.size(); ++i){
-            data.startpoint=data.endpoint;
-            data.endpoint=RS_Vector(points[i].x(), points[i].y());
-            RS_Line* line=new RS_Line(doc, data);
-            doc->addEntity(line);
-            undo.addUndoable(line);
+        for (const QPointF& point: points) {
+            RS_Point* entity = new RS_Point(doc, RS_PointData(RS_Vector(point.x(), point.y())));
+            doc->addEntity(entity);
+            undo.addUndoable(entity);
         }
-        if(closed){
-            data.startpoint=data.endpoint;
-            data.endpoint=RS_Vector(points.front().x(), points.front().y());
-            RS_Line* line=new RS_Line(doc, data);
-            doc->addEntity(line);
-            undo.addUndoable(line);
+    } else
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+}
+
+void Doc_plugin_interface::addLineSegments(std::vector<QLineF> const& lines)
+{
+    DPI_PROFILE(this, "addLineSegments");
+    if (doc) {
+        LC_UndoSection undo(doc);
+        for (const QLineF& line: lines) {
+            RS_Line* entity = new RS_Line{doc, RS_Vector(line.x1(), line.y1()),
+                                          RS_Vector(line.x2(), line.y2())};
+            doc->addEntity(entity);
+            undo.addUndoable(entity);
         }
     } else
 		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
 }
 
-void Doc_plugin_interface::addPolyline(std::vector<Plug_VertexData> const& points, bool closed)
+void Doc_plugin_interface::addTexts(std::vector<Plug_TextData> const& texts)
 {
+    DPI_PROFILE(this, "addTexts");
     if (doc) {
-        RS_PolylineData data;
-        if(closed)
-            data.setFlag(RS2::FlagClosed);
-        RS_Polyline* entity = new RS_Polyline(doc, data);
+        LC_REGEN_REASON("plugin texts");
+        std::vector<RS_Text*> entities;
+        entities.reserve(texts.size());
+        for (const Plug_TextData& text: texts) {
+            RS_Vector v1(text.start.x(), text.start.y());
+            RS_TextData d(v1, v1, text.height, 1.0,
+                          static_cast<RS_TextData::VAlign>(text.va),
+                          static_cast<RS_TextData::HAlign>(text.ha),
+                          RS_TextData::None, text.text, text.style, text.angle, RS2::NoUpdate);
+            entities.push_back(new RS_Text(doc, d));
+        }
+        // the glyphs before the borders of the document are adjusted to the texts
+        RS_Text::updateAll({entities.begin(), entities.end()});
 
-        for(auto const& pt: points){
-            entity->addVertex(RS_Vector(pt.point.x(), pt.point.y()), pt.bulge);
+        LC_UndoSection undo(doc);
+        for (RS_Text* entity: entities) {
+            doc->addEntity(entity);
+            undo.addUndoable(entity);
         }
+    } else
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+}
+
+void Doc_plugin_interface::addPolyline(std::vector<Plug_VertexData> const& points, bool closed)
+{
+    DPI_PROFILE(this, "addPolyline");
+    if (doc) {
+        RS_Polyline* entity = createPolyline(doc, points.size(), closed, [&points](std::size_t i) {
+            const Plug_VertexData& vertex = points[i];
+            return std::make_pair(RS_Vector(vertex.point.x(), vertex.point.y()), vertex.bulge);
+        });
+
+        doc->addEntity(entity);
+        LC_UndoSection undo(doc);
+        undo.addUndoable(entity);
+    } else
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+}
+
+void Doc_plugin_interface::addPolyline(const double* xy, const double* bulges,
+                                       std::size_t count, bool closed)
+{
+    DPI_PROFILE(this, "addPolyline");
+    if (doc) {
+        RS_Polyline* entity = createPolyline(doc, count, closed, [xy, bulges](std::size_t i) {
+            return std::make_pair(RS_Vector(xy[2 * i], xy[2 * i + 1]),
+                                  bulges != nullptr ? bulges[i] : 0.);
+        });
 
         doc->addEntity(entity);
         LC_UndoSection undo(doc);
@@ -949,13 +1290,27 @@ void Doc_plugin_interface::addPolyline(std::vector<Plug_VertexData> const& point
 
 void Doc_plugin_interface::addSplinePoints(std::vector<QPointF> const& points, bool closed)
 {
+    DPI_PROFILE(this, "addSplinePoints");
     if (doc) {
-        LC_SplinePointsData data(closed, false); //cut = false
-        for(auto const& pt: points){
-            data.splinePoints.emplace_back(RS_Vector(pt.x(), pt.y()));
-        }
+        LC_SplinePoints* entity = createSplinePoints(doc, points.size(), closed,
+                                                     [&points](std::size_t i) {
+            return RS_Vector(points[i].x(), points[i].y());
+        });
 
-        LC_SplinePoints* entity = new LC_SplinePoints(doc, data);
+        doc->addEntity(entity);
+        LC_UndoSection undo(doc);
+        undo.addUndoable(entity);
+    } else
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+}
+
+void Doc_plugin_interface::addSplinePoints(const double* xy, std::size_t count, bool closed)
+{
+    DPI_PROFILE(this, "addSplinePoints");
+    if (doc) {
+        LC_SplinePoints* entity = createSplinePoints(doc, count, closed, [xy](std::size_t i) {
+            return RS_Vector(xy[2 * i], xy[2 * i + 1]);
+        });
 
         doc->addEntity(entity);
         LC_UndoSection undo(doc);
@@ -966,6 +1321,7 @@ void Doc_plugin_interface::addSplinePoints(std::vector<QPointF> const& points, b
 
 void Doc_plugin_interface::addImage(int handle, QPointF *start, QPointF *uvr, QPointF *vvr,
                                     int w, int h, QString name, int br, int con, int fade){
+    DPI_PROFILE(this, "addImage");
     if (doc) {
         RS_Vector ip(start->x(), start->y());
         RS_Vector uv(uvr->x(), uvr->y());
@@ -991,6 +1347,7 @@ void Doc_plugin_interface::addImage(int handle, QPointF *start, QPointF *uvr, QP
 }
 
 void Doc_plugin_interface::addInsert(QString name, QPointF ins, QPointF scale, qreal rot){
+    DPI_PROFILE(this, "addInsert");
     if (doc) {
         RS_Vector ip(ins.x(), ins.y());
         RS_Vector sp(scale.x(), scale.y());
@@ -1007,6 +1364,7 @@ void Doc_plugin_interface::addInsert(QString name, QPointF ins, QPointF scale, q
 
 /*TODO RLZ: add undo support in this method*/
 QString Doc_plugin_interface::addBlockfromFromdisk(QString fullName){
+    DPI_PROFILE(this, "addBlockfromFromdisk");
 	if (fullName.isEmpty() || !doc)
 		return nullptr;
     RS_BlockList* blockList = doc->getBlockList();
@@ -1051,7 +1409,24 @@ QString Doc_plugin_interface::addBlockfromFromdisk(QString fullName){
     }
 }
 
+QString Doc_plugin_interface::addXrefFromDisk(QString fullName){
+    DPI_PROFILE(this, "addXrefFromDisk");
+    if (fullName.isEmpty() || !doc)
+        return nullptr;
+    RS_BlockList* blockList = doc->getBlockList();
+    QFileInfo fi(fullName);
+    if (!blockList || !fi.isReadable())
+        return nullptr;
+
+    QString name = blockList->newName(fi.completeBaseName());
+    RS_Block *b = new RS_Block(doc, RS_BlockData(name, RS_Vector(0,0), false));
+    b->setXrefFile(fi.absoluteFilePath());
+    docGr->addBlock(b);
+    return name;
+}
+
 void Doc_plugin_interface::addEntity(Plug_Entity *handle){
+    DPI_PROFILE(this, "addEntity");
     if (doc) {
         RS_Entity *ent = (reinterpret_cast<Plugin_Entity*>(handle))->getEnt();
 		if (ent) {
@@ -1065,16 +1440,20 @@ void Doc_plugin_interface::addEntity(Plug_Entity *handle){
 
 /*newEntity not added into graphic, then not needed undo support*/
 Plug_Entity *Doc_plugin_interface::newEntity( enum DPI::ETYPE type){
+    DPI_PROFILE(this, "newEntity");
     Plugin_Entity *e = new Plugin_Entity(doc, type);
     if( !(e->isValid()) ) {
         delete e;
 		return nullptr;
     }
+    if (profile != nullptr)
+        ++profile->createdEntities;
     return  reinterpret_cast<Plug_Entity*>(e);
 }
 
 /*TODO RLZ: add undo support in this method*/
 void Doc_plugin_interface::removeEntity(Plug_Entity *ent){
+    DPI_PROFILE(this, "removeEntity");
     RS_Entity *e = (reinterpret_cast<Plugin_Entity*>(ent))->getEnt();
     if (doc && e) {
         LC_UndoSection undo(doc);
@@ -1082,7 +1461,10 @@ void Doc_plugin_interface::removeEntity(Plug_Entity *ent){
         e->changeUndoState();
         undo.addUndoable(e);
 
-        gView->redraw(RS2::RedrawDrawing);
+        if (batchDepth > 0)
+            batchRedraw = true;
+        else
+            gView->redraw(RS2::RedrawDrawing);
     }
 }
 
@@ -1099,6 +1481,7 @@ void Doc_plugin_interface::updateEntity(RS_Entity *org, RS_Entity *newe){
 
 /*TODO RLZ: add undo support in the remaining methods*/
 void Doc_plugin_interface::setLayer(QString name){
+    DPI_PROFILE(this, "setLayer");
     RS_LayerList* listLay = doc->getLayerList();
     RS_Layer *lay = listLay->find(name);
 	if (!lay) {
@@ -1109,10 +1492,12 @@ void Doc_plugin_interface::setLayer(QString name){
 }
 
 QString Doc_plugin_interface::getCurrentLayer(){
+    DPI_PROFILE(this, "getCurrentLayer");
     return docGr->getActiveLayer()->getName();
 }
 
 QStringList Doc_plugin_interface::getAllLayer(){
+    DPI_PROFILE(this, "getAllLayer");
     QStringList listName;
     RS_LayerList* listLay = doc->getLayerList();
     for (unsigned int i = 0; i < listLay->count(); ++i) {
@@ -1122,6 +1507,7 @@ QStringList Doc_plugin_interface::getAllLayer(){
 }
 
 QStringList Doc_plugin_interface::getAllBlocks(){
+    DPI_PROFILE(this, "getAllBlocks");
     QStringList listName;
     RS_BlockList* listBlk = doc->getBlockList();
     for (int i = 0; i < listBlk->count(); ++i) {
@@ -1131,6 +1517,7 @@ QStringList Doc_plugin_interface::getAllBlocks(){
 }
 
 bool Doc_plugin_interface::deleteLayer(QString name){
+    DPI_PROFILE(this, "deleteLayer");
     RS_Layer* layer = docGr->findLayer(name);
 	if (layer) {
         docGr->removeLayer(layer);
@@ -1140,6 +1527,7 @@ bool Doc_plugin_interface::deleteLayer(QString name){
 }
 
 void Doc_plugin_interface::getCurrentLayerProperties(int *c, DPI::LineWidth *w, DPI::LineType *t){
+    DPI_PROFILE(this, "getCurrentLayerProperties");
     RS_Pen pen = docGr->getActiveLayer()->getPen();
     *c = pen.getColor().toIntColor();
 //    RS_Color col = pen.getColor();
@@ -1149,6 +1537,7 @@ void Doc_plugin_interface::getCurrentLayerProperties(int *c, DPI::LineWidth *w,
 }
 
 void Doc_plugin_interface::getCurrentLayerProperties(int *c, QString *w, QString *t){
+    DPI_PROFILE(this, "getCurrentLayerProperties");
     RS_Pen pen = docGr->getActiveLayer()->getPen();
     *c = pen.getColor().toIntColor();
 //    RS_Color col = pen.getColor();
@@ -1160,6 +1549,7 @@ void Doc_plugin_interface::getCurrentLayerProperties(int *c, QString *w, QString
 }
 
 void Doc_plugin_interface::setCurrentLayerProperties(int c, DPI::LineWidth w, DPI::LineType t){
+    DPI_PROFILE(this, "setCurrentLayerProperties");
     RS_Layer* layer = docGr->getActiveLayer();
 	if (layer) {
         RS_Color co;
@@ -1172,6 +1562,7 @@ void Doc_plugin_interface::setCurrentLayerProperties(int c, DPI::LineWidth w, DP
 
 void Doc_plugin_interface::setCurrentLayerProperties(int c, QString const& w,
 													 QString const& t){
+    DPI_PROFILE(this, "setCurrentLayerProperties");
     RS_Layer* layer = docGr->getActiveLayer();
 	if (layer) {
         RS_Color co;
@@ -1184,6 +1575,7 @@ void Doc_plugin_interface::setCurrentLayerProperties(int c, QString const& w,
 
 bool Doc_plugin_interface::getPoint(QPointF *point, const QString& message,
 									QPointF *base){
+    DPI_PROFILE(this, "getPoint", true);
     bool status = false;
     QC_ActionGetPoint* a = new QC_ActionGetPoint(*doc, *gView);
     if (a) {
@@ -1209,6 +1601,7 @@ bool Doc_plugin_interface::getPoint(QPointF *point, const QString& message,
 }
 
 Plug_Entity *Doc_plugin_interface::getEnt(const QString& message){
+    DPI_PROFILE(this, "getEnt", true);
     QC_ActionGetEnt* a = new QC_ActionGetEnt(*doc, *gView);
     if (a) {
         if (!(message.isEmpty()) )
@@ -1230,6 +1623,7 @@ Plug_Entity *Doc_plugin_interface::getEnt(const QString& message){
 }
 
 bool Doc_plugin_interface::getSelect(QList<Plug_Entity *> *sel, const QString& message){
+    DPI_PROFILE(this, "getSelect", true);
     bool status = false;
     QC_ActionGetSelect* a = new QC_ActionGetSelect(*doc, *gView);
     if (a) {
@@ -1258,6 +1652,7 @@ bool Doc_plugin_interface::getSelect(QList<Plug_Entity *> *sel, const QString& m
 }
 
 bool Doc_plugin_interface::getSelectByType(QList<Plug_Entity *> *sel, enum DPI::ETYPE type, const QString& message){
+    DPI_PROFILE(this, "getSelectByType", true);
     bool status = false;
     RS2::EntityType typeToSelect = RS2::EntityType::EntityUnknown;
     if(type==DPI::LINE){
@@ -1301,6 +1696,7 @@ bool Doc_plugin_interface::getSelectByType(QList<Plug_Entity *> *sel, enum DPI::
 }
 
 bool Doc_plugin_interface::getAllEntities(QList<Plug_Entity *> *sel, bool visible){
+    DPI_PROFILE(this, "getAllEntities");
     bool status = false;
 
 	for(auto e: *doc){
@@ -1314,12 +1710,129 @@ bool Doc_plugin_interface::getAllEntities(QList<Plug_Entity *> *sel, bool visibl
     return status;
 }
 
+int Doc_plugin_interface::visitEntities(Plug_EntityVisitor& visitor, DPI::ETYPE type,
+                                        const QString& layer, bool visible)
+{
+    DPI_PROFILE(this, "visitEntities");
+    if (visitor.dataVersion() > PLUG_ENTITY_DATA_VERSION) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "%s: data version %d not supported", __func__,
+                        visitor.dataVersion());
+        return -1;
+    }
+    RS_Layer* filterLayer = nullptr;
+    if (!layer.isEmpty()) {
+        filterLayer = (docGr != nullptr) ? docGr->findLayer(layer) : nullptr;
+        if (filterLayer == nullptr)
+            return 0;
+    }
+
+    // reused for all entities, the visitor only gets references
+    Plug_EntityAttributes attributes;
+    Plug_PolylineData polyline;
+    int count = 0;
+    for (RS_Entity* e: *doc) {
+        if (e->isUndone() || (visible && !e->isVisible()))
+            continue;
+        RS_Layer* entityLayer = e->getLayer();
+        if (filterLayer != nullptr && entityLayer != filterLayer)
+            continue;
+        const DPI::ETYPE et = toPluginType(e->rtti());
+        if (type != DPI::UNKNOWN && et != type)
+            continue;
+
+        attributes.type = et;
+        attributes.id = e->getId();
+        attributes.layer = (entityLayer != nullptr) ? entityLayer->getName() : QString{};
+        attributes.color = e->getPen(false).getColor().toIntColor();
+        attributes.visible = e->isVisible();
+        attributes.selected = e->isSelected();
+        ++count;
+
+        bool proceed = true;
+        switch (e->rtti()) {
+        case RS2::EntityPoint: {
+            const RS_Vector& pos = static_cast<RS_Point*>(e)->getPos();
+            proceed = visitor.visitPoint(attributes, QPointF(pos.x, pos.y));
+            break;}
+        case RS2::EntityLine: {
+            const RS_LineData& d = static_cast<RS_Line*>(e)->getData();
+            proceed = visitor.visitLine(attributes, {{d.startpoint.x, d.startpoint.y},
+                                                    {d.endpoint.x, d.endpoint.y}});
+            break;}
+        case RS2::EntityCircle: {
+            const RS_CircleData& d = static_cast<RS_Circle*>(e)->getData();
+            proceed = visitor.visitCircle(attributes, {{d.center.x, d.center.y}, d.radius});
+            break;}
+        case RS2::EntityArc: {
+            const RS_ArcData& d = static_cast<RS_Arc*>(e)->getData();
+            proceed = visitor.visitArc(attributes, {{d.center.x, d.center.y}, d.radius,
+                                                   d.angle1, d.angle2, d.reversed});
+            break;}
+        case RS2::EntityPolyline: {
+            auto pl = static_cast<RS_Polyline*>(e);
+            polyline.closed = pl->isClosed();
+            polyline.vertices.clear();
+            appendPolylineVertices(pl, polyline.vertices);
+            proceed = visitor.visitPolyline(attributes, polyline);
+            break;}
+        case RS2::EntityText: {
+            const RS_TextData& d = static_cast<RS_Text*>(e)->getData();
+            proceed = visitor.visitText(attributes, {d.text, d.style,
+                                                    {d.insertionPoint.x, d.insertionPoint.y},
+                                                    d.height, d.angle, toPluginHAlign(d.halign),
+                                                    toPluginVAlign(d.valign)});
+            break;}
+        case RS2::EntityMText: {
+            const RS_MTextData& d = static_cast<RS_MText*>(e)->getData();
+            proceed = visitor.visitText(attributes, {d.text, d.style,
+                                                    {d.insertionPoint.x, d.insertionPoint.y},
+                                                    d.height, d.angle,
+                                                    static_cast<DPI::HAlign>(d.halign),
+                                                    static_cast<DPI::VAlign>(d.valign)});
+            break;}
+        case RS2::EntityInsert: {
+            const RS_InsertData& d = static_cast<RS_Insert*>(e)->getData();
+            Plug_InsertData data;
+            data.name = d.name;
+            data.insertionPoint = {d.insertionPoint.x, d.insertionPoint.y};
+            data.scale = {d.scaleFactor.x, d.scaleFactor.y};
+            data.angle = d.angle;
+            proceed = visitor.visitInsert(attributes, data);
+            break;}
+        default:
+            proceed = visitor.visitOther(attributes);
+            break;
+        }
+        if (!proceed)
+            break;
+    }
+    return count;
+}
+
+int Doc_plugin_interface::selectSimilar(Plug_Entity* reference, int properties)
+{
+    DPI_PROFILE(this, "selectSimilar");
+    RS_Entity* e = (reference != nullptr) ? reinterpret_cast<Plugin_Entity*>(reference)->getEnt() : nullptr;
+    if (doc == nullptr || e == nullptr)
+        return 0;
+    static_assert(int(DPI::SAME_TYPE) == int(RS_Selection::SimilarType)
+                  && int(DPI::SAME_LAYER) == int(RS_Selection::SimilarLayer)
+                  && int(DPI::SAME_COLOR) == int(RS_Selection::SimilarColor)
+                  && int(DPI::SAME_LTYPE) == int(RS_Selection::SimilarLineType)
+                  && int(DPI::SAME_LWIDTH) == int(RS_Selection::SimilarWidth),
+                  "plugin and selection properties differ");
+    RS_Selection selection(*doc, gView);
+    return selection.selectSimilar(e, properties);
+}
+
 void Doc_plugin_interface::unselectEntities() {
+    DPI_PROFILE(this, "unselectEntities");
     QC_ActionGetSelect* a = new QC_ActionGetSelect(*doc, *gView);
     a->unselectEntities();
 }
 
 bool Doc_plugin_interface::getVariableInt(const QString& key, int *num){
+    DPI_PROFILE(this, "getVariableInt");
     if( (*num = docGr->getVariableInt(key, 0)) )
         return true;
     else
@@ -1327,6 +1840,7 @@ bool Doc_plugin_interface::getVariableInt(const QString& key, int *num){
 }
 
 bool Doc_plugin_interface::getVariableDouble(const QString& key, double *num){
+    DPI_PROFILE(this, "getVariableDouble");
     if( (*num = docGr->getVariableDouble(key, 0.0)) )
         return true;
     else
@@ -1334,6 +1848,7 @@ bool Doc_plugin_interface::getVariableDouble(const QString& key, double *num){
 }
 
 bool Doc_plugin_interface::addVariable(const QString& key, int value, int code){
+    DPI_PROFILE(this, "addVariable");
     docGr->addVariable(key, value, code);
     if (key.startsWith("$DIM"))
         doc->updateDimensions(true);
@@ -1341,6 +1856,7 @@ bool Doc_plugin_interface::addVariable(const QString& key, int value, int code){
 }
 
 bool Doc_plugin_interface::addVariable(const QString& key, double value, int code){
+    DPI_PROFILE(this, "addVariable");
    docGr->addVariable(key, value, code);
    if (key.startsWith("$DIM"))
        doc->updateDimensions(true);
@@ -1348,6 +1864,7 @@ bool Doc_plugin_interface::addVariable(const QString& key, double value, int cod
 }
 
 bool Doc_plugin_interface::getInt(int *num, const QString& message, const QString& title){
+    DPI_PROFILE(this, "getInt", true);
     bool ok;
     QString msg, tit;
     if ( message.isEmpty() )
@@ -1366,6 +1883,7 @@ bool Doc_plugin_interface::getInt(int *num, const QString& message, const QStrin
     return ok;
 }
 bool Doc_plugin_interface::getReal(qreal *num, const QString& message, const QString& title){
+    DPI_PROFILE(this, "getReal", true);
     bool ok;
     QString msg, tit;
     if ( message.isEmpty() )
@@ -1383,6 +1901,7 @@ bool Doc_plugin_interface::getReal(qreal *num, const QString& message, const QSt
     return ok;
 }
 bool Doc_plugin_interface::getString(QString *txt, const QString& message, const QString& title){
+    DPI_PROFILE(this, "getString", true);
     bool ok;
     QString msg, tit;
     if ( message.isEmpty() )
@@ -1404,6 +1923,7 @@ bool Doc_plugin_interface::getString(QString *txt, const QString& message, const
 }
 
 QString Doc_plugin_interface::realToStr(const qreal num, const int units, const int prec){
+    DPI_PROFILE(this, "realToStr");
     RS2::LinearFormat lf;
     int pr = prec;
     if (pr == 0)
@@ -26,6 +26,8 @@
 #ifndef DOC_PLUGIN_INTERFACE_H
 #define DOC_PLUGIN_INTERFACE_H
 
+#include <memory>
+
 #include <QObject>
 
 #include "document_interface.h"
@@ -76,6 +78,7 @@ class Doc_plugin_interface : public Document_Interface
 {
 public:
     Doc_plugin_interface(RS_Document *d, RS_GraphicView* gv, QWidget* parent);
+    ~Doc_plugin_interface() override;
     void updateView() override;
     void addPoint(QPointF *start) override;
     void addLine(QPointF *start, QPointF *end) override;
@@ -128,13 +131,43 @@ public:
     bool getString(QString *txt, const QString& message, const QString& title) override;
     QString realToStr(const qreal num, const int units = 0, const int prec = 0) override;
 
+    void beginBatch() override;
+    void endBatch() override;
+    void addPoints(std::vector<QPointF> const& points) override;
+    void addLineSegments(std::vector<QLineF> const& lines) override;
+    void addLines(const double* xy, std::size_t count, bool closed=false) override;
+    void addPolyline(const double* xy, const double* bulges, std::size_t count,
+                     bool closed=false) override;
+    void addSplinePoints(const double* xy, std::size_t count, bool closed=false) override;
+    void addTexts(std::vector<Plug_TextData> const& texts) override;
+    int visitEntities(Plug_EntityVisitor& visitor, DPI::ETYPE type = DPI::UNKNOWN,
+                      const QString& layer = QString(), bool visible = false) override;
+    int selectSimilar(Plug_Entity* reference, int properties) override;
+    QString addXrefFromDisk(QString fullName) override;
+
     //method to handle undo in Plugin_Entity 
     bool addToUndo(RS_Entity* current, RS_Entity* modified, DPI::Disposition how);
+
+    /**
+     * Call counts and times of the interface methods, and the entities wrapped
+     * and converted for the plugin, collected if the setting /Defaults/ProfilePlugins
+     * is set
+     */
+    struct Profile;
+    //! @return the profile, nullptr if the plugin is not profiled
+    Profile* getProfile() const {return profile.get();}
+    //! @return the profile as lines of text, empty if the plugin is not profiled
+    QStringList getProfileReport() const;
 private:
+    std::unique_ptr<Profile> profile;
     RS_Document *doc;
     RS_Graphic *docGr;
     RS_GraphicView *gView;
     QWidget* main_window;
+    //! nesting depth of beginBatch() calls
+    int batchDepth = 0;
+    //! a redraw was requested within the batch
+    bool batchRedraw = false;
 };
 
 /*void addArc(QPointF *start);			->Without start
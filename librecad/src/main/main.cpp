@@ -26,7 +26,10 @@
 ** This copyright notice MUST APPEAR in all copies of the script!
 **
 **********************************************************************/
+#include <algorithm>
 #include <clocale>
+#include <cstdio>
+#include <cstdlib>
 #include "main.h"
 
 #include <QApplication>
@@ -44,15 +47,25 @@
 #include "qg_dlginitial.h"
 
 #include "lc_application.h"
+#include "lc_documentdisposer.h"
+#include "lc_taskscheduler.h"
+#include "lc_trace.h"
 #include "qc_applicationwindow.h"
 #include "rs_debug.h"
 
+#include "console_benchmark.h"
 #include "console_dxf2pdf.h"
+#include "console_dwgcorpus.h"
+#include "console_dxfgen.h"
 #include "console_dxf2png.h"
+#include "console_renderserver.h"
+#include "console_rendertest.h"
+#include "console_script.h"
 
 namespace
 {
 void restoreWindowGeometry(QC_ApplicationWindow& appWin, QSettings& settings);
+int takeThreadsOption(int& argc, char** argv);
 }
 /**
  * Main. Creates Application window.
@@ -61,6 +74,26 @@ int main(int argc, char** argv)
 {
     QT_REQUIRE_VERSION(argc, argv, "5.2.1");
 
+    // the main operations are traced to the file, for console commands too
+    const QString traceFile = qEnvironmentVariable("LIBRECAD_TRACE");
+    if (!traceFile.isEmpty())
+        LC_Trace::start(traceFile);
+    // the trace is written when main returns
+    struct TraceWriter {
+        ~TraceWriter()
+        {
+            LC_Trace::finish();
+        }
+    } traceWriter;
+
+    // the threads of parallel work are set for console commands too, before
+    // their own options are parsed
+    int threads = takeThreadsOption(argc, argv);
+    if (threads < 0 && qEnvironmentVariableIsSet("LIBRECAD_THREADS"))
+        threads = std::max(qEnvironmentVariableIntValue("LIBRECAD_THREADS"), 0);
+    if (threads >= 0)
+        LC_TaskScheduler::instance().setThreadCount(threads);
+
     // Check first two arguments in order to decide if we want to run librecad
     // as console dxf2pdf or dxf2png tools. On Linux we can create a link to
     // librecad executable and  name it dxf2pdf. So, we can run either:
@@ -82,6 +115,24 @@ int main(int argc, char** argv)
         if (arg.compare("dxf2png") == 0 || arg == "dxf2svg") {
             return console_dxf2png(argc, argv);
         }
+        if (arg.compare("renderserver") == 0) {
+            return console_renderserver(argc, argv);
+        }
+        if (arg.compare("dxfgen") == 0) {
+            return console_dxfgen(argc, argv);
+        }
+        if (arg.compare("benchmark") == 0) {
+            return console_benchmark(argc, argv);
+        }
+        if (arg.compare("dwgcorpus") == 0) {
+            return console_dwgcorpus(argc, argv);
+        }
+        if (arg.compare("rendertest") == 0) {
+            return console_rendertest(argc, argv);
+        }
+        if (arg.compare("script") == 0) {
+            return console_script(argc, argv);
+        }
     }
 
     RS_DEBUG->setLevel(RS_Debug::D_WARNING);
@@ -121,11 +172,19 @@ int main(int argc, char** argv)
             qDebug()<<"  dxf2pdf\tRun librecad as console dxf2pdf tool. Use -h for help.";
             qDebug()<<"  dxf2png\tRun librecad as console dxf2png tool. Use -h for help.";
             qDebug()<<"  dxf2svg\tRun librecad as console dxf2svg tool. Use -h for help.";
+            qDebug()<<"  renderserver\tRun librecad as render server on a local socket. Use -h for help.";
+            qDebug()<<"  dxfgen\tRun librecad as generator of synthetic DXF drawings. Use -h for help.";
+            qDebug()<<"  benchmark\tTime core operations and write the timings as JSON. Use -h for help.";
+            qDebug()<<"  dwgcorpus\tCheck the DWG readers on a directory of drawings. Use -h for help.";
+            qDebug()<<"  rendertest\tCompare rendered drawings and render times with golden ones. Use -h for help.";
+            qDebug()<<"  script\tRun a script of batch edits on a drawing. Use -h for help.";
             qDebug()<<"";
             qDebug()<<"Options:";
             qDebug()<<"";
             qDebug()<<"  -h, --help\tdisplay this message";
             qDebug()<<"  -d, --debug <level>";
+            qDebug()<<"  --trace <file>\twrite a Chrome trace of the main operations, also set by LIBRECAD_TRACE";
+            qDebug()<<"  --threads <n>\tthreads of parallel work, 0 for all cores, also set by LIBRECAD_THREADS";
             qDebug()<<"";
             RS_DEBUG->print( RS_Debug::D_NOTHING, "possible debug levels:");
             RS_DEBUG->print( RS_Debug::D_NOTHING, "    %d Nothing", RS_Debug::D_NOTHING);
@@ -137,6 +196,12 @@ int main(int argc, char** argv)
             RS_DEBUG->print( RS_Debug::D_NOTHING, "    %d Debugging", RS_Debug::D_DEBUGGING);
             exit(0);
         }
+        if (allowOptions && argstr == "--trace" && i + 1 < argc)
+        {
+            argClean << i << i + 1;
+            LC_Trace::start(QFile::decodeName(argv[++i]));
+            continue;
+        }
         if ( allowOptions&& (argstr.startsWith(lpDebugSwitch0, Qt::CaseInsensitive) ||
                              argstr.startsWith(lpDebugSwitch1, Qt::CaseInsensitive) ))
         {
@@ -220,6 +285,11 @@ int main(int argc, char** argv)
     QFileInfo prgInfo( QFile::decodeName(argv[0]) );
     QString prgDir(prgInfo.absolutePath());
     RS_SETTINGS->init(app.organizationName(), app.applicationName());
+    if (threads < 0) {
+        RS_SETTINGS->beginGroup("/Defaults");
+        LC_TaskScheduler::instance().setThreadCount(RS_SETTINGS->readNumEntry("/WorkerThreads", 0));
+        RS_SETTINGS->endGroup();
+    }
     RS_SYSTEM->init(app.applicationName(), app.applicationVersion(), XSTR(QC_APPDIR), prgDir);
 
     // parse command line arguments that might not need a launched program:
@@ -261,6 +331,8 @@ int main(int argc, char** argv)
 
     RS_DEBUG->print("main: init fontlist..");
     RS_FONTLIST->init();
+    // the default font of new drawings
+    RS_FONTLIST->preloadFonts({"standard"});
     RS_DEBUG->print("main: init fontlist: OK");
 
     RS_DEBUG->print("main: init patternlist..");
@@ -388,11 +460,25 @@ int main(int argc, char** argv)
 
     // Destroy the singleton
     QC_ApplicationWindow::getAppWindow().reset();
+    // closed drawings not destroyed yet are released with the process; a drawing
+    // still being destroyed after the wait must not see the static destructors run
+    if (!LC_DocumentDisposer::abandon(std::chrono::seconds{5})) {
+        std::fflush(nullptr);
+        std::_Exit(return_code);
+    }
 
     return return_code;
 }
 
 
+void setHeadlessPlatform()
+{
+    // a -platform argument still takes precedence
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+}
+
+
 /**
  * Handles command line arguments that might not require a GUI.
  *
@@ -428,6 +514,34 @@ QStringList handleArgs(int argc, char** argv, const QList<int>& argClean)
 }
 
 namespace {
+/**
+ * Removes the option --threads <n> or --threads=<n> from the arguments.
+ * @return the number of threads, -1 if the option is not given
+ */
+int takeThreadsOption(int& argc, char** argv)
+{
+    int threads = -1;
+    int taken = 0;
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray arg{argv[i]};
+        if (arg == "--")
+            break;
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(QByteArray{argv[i + 1]}.toInt(), 0);
+            taken = 2;
+        } else if (arg.startsWith("--threads=")) {
+            threads = std::max(arg.mid(10).toInt(), 0);
+            taken = 1;
+        } else {
+            continue;
+        }
+        std::copy(argv + i + taken, argv + argc + 1, argv + i);
+        argc -= taken;
+        break;
+    }
+    return threads;
+}
+
 void restoreWindowGeometry(QC_ApplicationWindow& appWin, QSettings& settings)
 {
     settings.beginGroup("Geometry");
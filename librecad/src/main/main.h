@@ -41,4 +41,11 @@
  */
 QStringList handleArgs(int argc, char** argv, const QList<int>& argClean);
 
+/**
+ * @brief setHeadlessPlatform selects the offscreen platform for the console tools,
+ * unless a platform is set by QT_QPA_PLATFORM, so they run without a display and
+ * don't connect to a window system on start up
+ */
+void setHeadlessPlatform();
+
 #endif
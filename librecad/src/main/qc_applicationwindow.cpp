@@ -33,8 +33,12 @@
 
 #include <QByteArray>
 #include <QDockWidget>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QImageWriter>
+#include <QInputDialog>
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QMdiArea>
 #include <QMenuBar>
 #include <QMessageBox>
@@ -66,6 +70,8 @@
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "rs_document.h"
+#include "rs_graphic.h"
+#include "rs_grid.h"
 #include "rs_painterqt.h"
 #include "rs_pen.h"
 #include "rs_settings.h"
@@ -77,10 +83,14 @@
 #include "lc_actionfactory.h"
 #include "lc_actiongroupmanager.h"
 #include "lc_centralwidget.h"
+#include "lc_memoryreport.h"
 #include "lc_penwizard.h"
 #include "lc_printing.h"
+#include "lc_regenstatistics.h"
+#include "lc_tiledimageexport.h"
 #include "lc_widgetfactory.h"
 #include "lc_widgetoptionsdialog.h"
+#include "lc_xrefcache.h"
 #include "lc_undosection.h"
 
 #include "qc_dialogfactory.h"
@@ -133,6 +143,17 @@ QC_ApplicationWindow::QC_ApplicationWindow()
 {
     RS_DEBUG->print("QC_ApplicationWindow::QC_ApplicationWindow");
 
+    // startup phases are timed, the log tracks where startup time goes
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+    qint64 phaseStart = 0;
+    auto logPhase = [&startupTimer, &phaseStart](const char* phase) {
+        const qint64 now = startupTimer.elapsed();
+        RS_DEBUG->print(RS_Debug::D_INFORMATIONAL, "QC_ApplicationWindow: startup: %s: %lld ms",
+                        phase, now - phaseStart);
+        phaseStart = now;
+    };
+
 #ifdef _WINDOWS
 	qt_ntfs_permission_lookup++; // turn checking on
 #endif
@@ -188,6 +209,7 @@ QC_ApplicationWindow::QC_ApplicationWindow()
     status_bar->setMinimumHeight( height);
     status_bar->setMaximumHeight( height);
     settings.endGroup();
+    logPhase("status bar");
 
     RS_DEBUG->print("QC_ApplicationWindow::QC_ApplicationWindow: creating LC_CentralWidget");
 
@@ -218,6 +240,9 @@ QC_ApplicationWindow::QC_ApplicationWindow()
 
     connect(mdiAreaCAD, SIGNAL(subWindowActivated(QMdiSubWindow*)),
             this, SLOT(slotWindowActivated(QMdiSubWindow*)));
+    connect(mdiAreaCAD, &QMdiArea::subWindowActivated, this, &QC_ApplicationWindow::slotUpdateWindowRendering);
+    connect(LC_XrefCache::instance(), &LC_XrefCache::xrefReloaded,
+            this, &QC_ApplicationWindow::slotXrefReloaded);
 
     settings.beginGroup("Widgets");
     bool custom_size = settings.value("AllowToolbarIconSize", 0).toBool();
@@ -226,10 +251,12 @@ QC_ApplicationWindow::QC_ApplicationWindow()
 
     if (custom_size)
         setIconSize(QSize(icon_size, icon_size));
+    logPhase("central widget");
 
     LC_ActionFactory a_factory(this, actionHandler);
     a_factory.using_theme = settings.value("Widgets/AllowTheme", 0).toBool();
     a_factory.fillActionContainer(a_map, ag_manager);
+    logPhase("actions");
 
     LC_WidgetFactory widget_factory(this, a_map, ag_manager);
     if (enable_left_sidebar){
@@ -241,6 +268,7 @@ QC_ApplicationWindow::QC_ApplicationWindow()
     widget_factory.createRightSidebar(actionHandler);
     widget_factory.createCategoriesToolbar();
     widget_factory.createStandardToolbars(actionHandler);
+    logPhase("toolbars and docks");
 
     foreach(auto action, widget_factory.snap_toolbar->actions())
     {
@@ -283,6 +311,7 @@ QC_ApplicationWindow::QC_ApplicationWindow()
     }
 
     widget_factory.createMenus(menuBar());
+    logPhase("custom toolbars and menus");
 
     undoButton = a_map["EditUndo"];
     redoButton = a_map["EditRedo"];
@@ -305,8 +334,6 @@ QC_ApplicationWindow::QC_ApplicationWindow()
     blockWidget = widget_factory.block_widget;
     commandWidget = widget_factory.command_widget;
 
-    penPaletteWidget = widget_factory.pen_palette;
-
     file_menu = widget_factory.file_menu;
     windowsMenu = widget_factory.windows_menu;
 
@@ -346,9 +373,11 @@ QC_ApplicationWindow::QC_ApplicationWindow()
     auto recent_menu = new QMenu(tr("Recent Files"), file_menu);
     file_menu->addMenu(recent_menu);
     recentFiles->addFiles(recent_menu);
+    logPhase("dialog factory");
 
     RS_DEBUG->print("QC_ApplicationWindow::QC_ApplicationWindow: init settings");
     initSettings();
+    logPhase("settings");
 
     auto command_file = settings.value("Paths/VariableFile", "").toString();
     if (!command_file.isEmpty())
@@ -364,10 +393,23 @@ QC_ApplicationWindow::QC_ApplicationWindow()
     RS_COMMANDS->updateAlias();
     //plugin load
     loadPlugins();
+    logPhase("plugins");
+    RS_DEBUG->print(RS_Debug::D_INFORMATIONAL, "QC_ApplicationWindow: startup: total: %lld ms",
+                    startupTimer.elapsed());
 
     statusBar()->showMessage(qApp->applicationName() + " Ready", 2000);
 }
 
+void QC_ApplicationWindow::setPenPaletteWidget(LC_PenPaletteWidget* widget) {
+    penPaletteWidget = widget;
+    QC_MDIWindow* m = getMDIWindow();
+    penPaletteWidget->setEnabled(m != nullptr);
+    if (m != nullptr) {
+        penPaletteWidget->setLayerList(m->getDocument()->getLayerList());
+        penPaletteWidget->setMdiWindow(m);
+    }
+}
+
 void QC_ApplicationWindow::startAutoSave(bool startAutoBackup)
 {
     if (startAutoBackup)
@@ -673,6 +715,12 @@ void QC_ApplicationWindow::enableFileActions(QC_MDIWindow* w)
 /**
  * Loads the found plugins.
  */
+/**
+ * Discovers the plugins. Menu entries are read from the metadata the plugins
+ * ship, so a plugin library is only loaded the first time one of its actions
+ * is triggered. Plugins without menu entries in their metadata are loaded
+ * right away to ask for their capabilities.
+ */
 void QC_ApplicationWindow::loadPlugins() {
 
     loadedPlugins.clear();
@@ -697,53 +745,105 @@ void QC_ApplicationWindow::loadPlugins() {
             if (loadedPluginFileNames.contains(fileName)) {
                 continue;
             }
-            QPluginLoader pluginLoader(pluginsDir.absoluteFilePath(fileName));
-            QObject *plugin = pluginLoader.instance();
-            if (plugin) {
-                QC_PluginInterface *pluginInterface = qobject_cast<QC_PluginInterface *>(plugin);
-                if (pluginInterface) {
-                    loadedPlugins.push_back(pluginInterface);
-                    loadedPluginFileNames.push_back(fileName);
-                    PluginCapabilities pluginCapabilities=pluginInterface->getCapabilities();
-                    for(const PluginMenuLocation& loc: pluginCapabilities.menuEntryPoints) {
-                        QAction *actpl = new QAction(loc.menuEntryActionName, plugin);
-                        actpl->setData(loc.menuEntryActionName);
-                        connect(actpl, SIGNAL(triggered()), this, SLOT(execPlug()));
-                        connect(this, SIGNAL(windowsChanged(bool)), actpl, SLOT(setEnabled(bool)));
-                        QMenu *atMenu = findMenu("/"+loc.menuEntryPoint, menuBar()->children(), "");
-                        if (atMenu) {
-                            atMenu->addAction(actpl);
-                        } else {
+            // the loader owns the actions of the plugin
+            auto pluginLoader = new QPluginLoader(pluginsDir.absoluteFilePath(fileName), this);
+            const QJsonObject metaData = pluginLoader->metaData();
+            if (metaData.isEmpty()) {
+                // not a plugin, loading tells why
+                pluginLoader->load();
+                QMessageBox::information(this, "Info", pluginLoader->errorString());
+                RS_DEBUG->print("QC_ApplicationWindow::loadPlugin: %s", pluginLoader->errorString().toLatin1().data());
+                delete pluginLoader;
+                continue;
+            }
+            if (metaData.value("IID").toString() != LC_DocumentInterface_iid) {
+                delete pluginLoader;
+                continue;
+            }
+            loadedPluginFileNames.push_back(fileName);
+
+            const QJsonArray menuEntries = metaData.value("MetaData").toObject().value("MenuEntries").toArray();
+            if (!menuEntries.isEmpty()) {
+                // action names are translated in the context of the plugin class, as tr() does in the plugin
+                const QByteArray context = metaData.value("className").toString().toLatin1();
+                for (const QJsonValue& entry: menuEntries) {
+                    const QJsonObject location = entry.toObject();
+                    const QString name = QCoreApplication::translate(context.constData(),
+                                                                     location.value("action").toString().toUtf8().constData());
+                    auto actpl = new QAction(name, pluginLoader);
+                    actpl->setData(name);
+                    addPluginAction(actpl, location.value("menu").toString());
+                }
+                continue;
+            }
+
+            QC_PluginInterface *pluginInterface = pluginInstance(pluginLoader);
+            if (pluginInterface == nullptr)
+                continue;
+            PluginCapabilities pluginCapabilities=pluginInterface->getCapabilities();
+            for(const PluginMenuLocation& loc: pluginCapabilities.menuEntryPoints) {
+                QAction *actpl = new QAction(loc.menuEntryActionName, pluginLoader);
+                actpl->setData(loc.menuEntryActionName);
+                addPluginAction(actpl, loc.menuEntryPoint);
+            }
+        }
+    }
+}
+
+/**
+ * Adds the action of a plugin to the menu at menuEntryPoint, the menu is
+ * created if needed.
+ */
+void QC_ApplicationWindow::addPluginAction(QAction* actpl, const QString& menuEntryPoint) {
+    connect(actpl, SIGNAL(triggered()), this, SLOT(execPlug()));
+    connect(this, SIGNAL(windowsChanged(bool)), actpl, SLOT(setEnabled(bool)));
+    actpl->setEnabled(getMDIWindow() != nullptr);
+    QMenu *atMenu = findMenu("/"+menuEntryPoint, menuBar()->children(), "");
+    if (atMenu) {
+        atMenu->addAction(actpl);
+        return;
+    }
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-                            QStringList treemenu = loc.menuEntryPoint.split('/', Qt::SkipEmptyParts);
+    QStringList treemenu = menuEntryPoint.split('/', Qt::SkipEmptyParts);
 #else
-                            QStringList treemenu = loc.menuEntryPoint.split('/', QString::SkipEmptyParts);
+    QStringList treemenu = menuEntryPoint.split('/', QString::SkipEmptyParts);
 #endif
-                            QString currentLevel="";
-                            QMenu *parentMenu=0;
-                            do {
-                                QString menuName=treemenu.at(0); treemenu.removeFirst();
-                                currentLevel=currentLevel+"/"+menuName;
-                                atMenu = findMenu(currentLevel, menuBar()->children(), "");
-                                if (atMenu==0) {
-                                    if (parentMenu==0) {
-                                        parentMenu=menuBar()->addMenu(menuName);
-                                    } else {
-                                        parentMenu=parentMenu->addMenu(menuName);
-                                    }
-                                    parentMenu->setObjectName(menuName);
-                                }
-                            } while(treemenu.size()>0);
-							if (parentMenu) parentMenu->addAction(actpl);
-                        }
-                    }
-                }
+    QString currentLevel="";
+    QMenu *parentMenu=0;
+    while (treemenu.size()>0) {
+        QString menuName=treemenu.at(0); treemenu.removeFirst();
+        currentLevel=currentLevel+"/"+menuName;
+        atMenu = findMenu(currentLevel, menuBar()->children(), "");
+        if (atMenu==0) {
+            if (parentMenu==0) {
+                parentMenu=menuBar()->addMenu(menuName);
             } else {
-                QMessageBox::information(this, "Info", pluginLoader.errorString());
-                RS_DEBUG->print("QC_ApplicationWindow::loadPlugin: %s", pluginLoader.errorString().toLatin1().data());
+                parentMenu=parentMenu->addMenu(menuName);
             }
+            parentMenu->setObjectName(menuName);
         }
     }
+    if (parentMenu) parentMenu->addAction(actpl);
+}
+
+/**
+ * @return the plugin of the loader, the library is loaded on the first call.
+ * nullptr, if the plugin can't be loaded
+ */
+QC_PluginInterface* QC_ApplicationWindow::pluginInstance(QPluginLoader* loader) {
+    const bool loaded = loader->isLoaded();
+    QC_PluginInterface *pluginInterface = qobject_cast<QC_PluginInterface *>(loader->instance());
+    if (pluginInterface == nullptr) {
+        QMessageBox::information(this, "Info", loader->errorString());
+        RS_DEBUG->print("QC_ApplicationWindow::loadPlugin: %s", loader->errorString().toLatin1().data());
+        return nullptr;
+    }
+    if (!loaded) {
+        RS_DEBUG->print(RS_Debug::D_INFORMATIONAL, "QC_ApplicationWindow: plugin loaded: %s",
+                        loader->fileName().toLatin1().data());
+        loadedPlugins.push_back(pluginInterface);
+    }
+    return pluginInterface;
 }
 
 /**
@@ -751,15 +851,25 @@ void QC_ApplicationWindow::loadPlugins() {
  */
 void QC_ApplicationWindow::execPlug() {
     QAction *action = qobject_cast<QAction *>(sender());
-    QC_PluginInterface *plugin = qobject_cast<QC_PluginInterface *>(action->parent());
-//get actual drawing
     QC_MDIWindow* w = getMDIWindow();
+    if (w == nullptr)
+        return;
+    QC_PluginInterface *plugin = pluginInstance(qobject_cast<QPluginLoader *>(action->parent()));
+    if (plugin == nullptr)
+        return;
+//get actual drawing
     RS_Document* currdoc = w->getDocument();
 //create document interface instance
     Doc_plugin_interface pligundoc(currdoc, w->getGraphicView(), this);
 //execute plugin
     LC_UndoSection undo(currdoc);
     plugin->execComm(&pligundoc, this, action->data().toString());
+    const QStringList profile = pligundoc.getProfileReport();
+    if (!profile.isEmpty()) {
+        commandWidget->appendHistory(tr("Profile of %1:").arg(action->text().remove('&')));
+        for (const QString& line: profile)
+            commandWidget->appendHistory(line);
+    }
 //TODO call update view
 w->getGraphicView()->redraw();
 }
@@ -1025,6 +1135,38 @@ void QC_ApplicationWindow::slotWindowActivated(int index){
     slotWindowActivated(mdiAreaCAD->subWindowList().at(index));
 }
 
+/**
+ * Suspends rendering of the drawing windows which can't be seen: minimized windows,
+ * the other tabs in tabbed view and the windows behind a maximized window.
+ * Suspended views are repainted when shown again.
+ */
+void QC_ApplicationWindow::slotUpdateWindowRendering()
+{
+    QMdiSubWindow* current = mdiAreaCAD->currentSubWindow();
+    bool covered = mdiAreaCAD->viewMode() == QMdiArea::TabbedView
+                   || (current != nullptr && current->isMaximized());
+    for (QMdiSubWindow* w: mdiAreaCAD->subWindowList()) {
+        auto m = qobject_cast<QC_MDIWindow*>(w);
+        if (m == nullptr || m->getGraphicView() == nullptr)
+            continue;
+        bool hidden = w->isMinimized() || (covered && w != current);
+        m->getGraphicView()->setRenderingSuspended(hidden);
+    }
+}
+
+/**
+ * Redraws the drawings with external references of a file reloaded after
+ * changes on disk.
+ */
+void QC_ApplicationWindow::slotXrefReloaded(const QString& fileName)
+{
+    for (QC_MDIWindow* w: window_list) {
+        RS_Graphic* graphic = w->getGraphic();
+        if (graphic != nullptr && graphic->updateXrefs(fileName) && w->getGraphicView() != nullptr)
+            w->getGraphicView()->redraw(RS2::RedrawDrawing);
+    }
+}
+
 /**
  * Called when a document window was activated.
  */
@@ -1035,6 +1177,7 @@ void QC_ApplicationWindow::slotWindowActivated(QMdiSubWindow* w, bool forced)
     if(w==nullptr) {
         emit windowsChanged(false);
         activedMdiSubWindow=w;
+        LC_EntityPool::setThreadArena(nullptr);
         return;
     }
 
@@ -1044,6 +1187,10 @@ void QC_ApplicationWindow::slotWindowActivated(QMdiSubWindow* w, bool forced)
     QC_MDIWindow* m = qobject_cast<QC_MDIWindow*>(w);
     enableFileActions(m);
 
+    // entities created by the actions belong to the active drawing
+    RS_Graphic* activeGraphic = (m != nullptr && m->getDocument() != nullptr) ? m->getDocument()->getGraphic() : nullptr;
+    LC_EntityPool::setThreadArena(activeGraphic != nullptr ? activeGraphic->getEntityArena() : nullptr);
+
     if (m && m->getDocument()) {
 
         RS_DEBUG->print("QC_ApplicationWindow::slotWindowActivated: "
@@ -1071,6 +1218,7 @@ void QC_ApplicationWindow::slotWindowActivated(QMdiSubWindow* w, bool forced)
         blockWidget->setBlockList(m->getDocument()->getBlockList());
 
         // Update all inserts in this graphic (blocks might have changed):
+        LC_REGEN_REASON("window activated");
         m->getDocument()->updateInserts();
         // whether to enable undo/redo buttons
         m->getDocument()->setGUIButtons();
@@ -1465,6 +1613,7 @@ void QC_ApplicationWindow::slotToggleTab()
         mdiAreaCAD->setViewMode(QMdiArea::SubWindowView);
 		doArrangeWindows(RS2::CurrentMode);
     }
+    slotUpdateWindowRendering();
 }
 
 /**
@@ -1518,6 +1667,9 @@ QC_MDIWindow* QC_ApplicationWindow::slotFileNew(RS_Document* doc) {
 
     RS_SETTINGS->beginGroup("/Appearance");
     int aa = RS_SETTINGS->readNumEntry("/Antialiasing", 0);
+    int parallelRendering = RS_SETTINGS->readNumEntry("/ParallelRendering", 0);
+    int performanceHud = RS_SETTINGS->readNumEntry("/PerformanceHud", 0);
+    int lodThreshold = RS_SETTINGS->readNumEntry("/LodThreshold", 0);
     int scrollbars = RS_SETTINGS->readNumEntry("/ScrollBars", 1);
     int cursor_hiding = RS_SETTINGS->readNumEntry("/cursor_hiding", 0);
     RS_SETTINGS->endGroup();
@@ -1525,6 +1677,9 @@ QC_MDIWindow* QC_ApplicationWindow::slotFileNew(RS_Document* doc) {
     QG_GraphicView* view = w->getGraphicView();
 
     view->setAntialiasing(aa);
+    view->setParallelRendering(parallelRendering);
+    view->setPerformanceHud(performanceHud);
+    view->setLodThreshold(lodThreshold);
     view->setCursorHiding(cursor_hiding);
     view->device = settings.value("Hardware/Device", "Mouse").toString();
     if (scrollbars) view->addScrollbars();
@@ -1553,8 +1708,11 @@ QC_MDIWindow* QC_ApplicationWindow::slotFileNew(RS_Document* doc) {
     actionHandler->set_view(view);
     actionHandler->set_document(w->getDocument());
 
+    connect(w, &QMdiSubWindow::windowStateChanged, this, &QC_ApplicationWindow::slotUpdateWindowRendering);
     connect(w, SIGNAL(signalClosing(QC_MDIWindow*)),
             this, SLOT(slotFileClosing(QC_MDIWindow*)));
+    connect(w, &QC_MDIWindow::signalAutoSaved,
+            this, &QC_ApplicationWindow::slotFileAutoSaved);
 
     if (w->getDocument()->rtti()==RS2::EntityBlock) {
         w->setWindowTitle(tr("Block '%1'").arg(((RS_Block*)(w->getDocument()))->getName()) + "[*]");
@@ -1801,6 +1959,61 @@ void QC_ApplicationWindow::slotFileOpen() {
     RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen(): OK");
 }
 
+/**
+ * Menu file -> open partially.
+ */
+void QC_ApplicationWindow::slotFileOpenPartial() {
+    RS_DEBUG->print("QC_ApplicationWindow::slotFileOpenPartial()");
+
+    RS2::FormatType type = RS2::FormatUnknown;
+    QG_FileDialog dlg(this);
+    QString fileName = dlg.getOpenFile(&type);
+    if (fileName.isEmpty())
+        return;
+
+    bool ok = false;
+    const QString layers = QInputDialog::getText(
+                this, tr("Open Partially"),
+                tr("Layers to import, separated by commas ('*' and '?' are wildcards):"),
+                QLineEdit::Normal, "*", &ok);
+    if (!ok)
+        return;
+    const QString window = QInputDialog::getText(
+                this, tr("Open Partially"),
+                tr("Window to import as x1,y1,x2,y2, empty for the whole drawing:"),
+                QLineEdit::Normal, {}, &ok);
+    if (!ok)
+        return;
+
+    LC_ImportOptions options;
+    options.includeLayers = layers.split(',', Qt::SkipEmptyParts);
+    for (QString& layer: options.includeLayers)
+        layer = layer.trimmed();
+    if (!window.trimmed().isEmpty() && !options.setWindow(window)) {
+        QMessageBox::warning(this, tr("Open Partially"),
+                             tr("Invalid window: %1").arg(window));
+        return;
+    }
+    slotFileOpen(fileName, type, options);
+}
+
+/**
+ * Menu file -> open read-only.
+ */
+void QC_ApplicationWindow::slotFileOpenReadOnly() {
+    RS_DEBUG->print("QC_ApplicationWindow::slotFileOpenReadOnly()");
+
+    RS2::FormatType type = RS2::FormatUnknown;
+    QG_FileDialog dlg(this);
+    QString fileName = dlg.getOpenFile(&type);
+    if (fileName.isEmpty())
+        return;
+
+    LC_ImportOptions options;
+    options.readOnly = true;
+    slotFileOpen(fileName, type, options);
+}
+
 
 /**
  *
@@ -1845,7 +2058,8 @@ QString QC_ApplicationWindow::
  *	Notes:			Menu file -> open.
  *	*/
 void QC_ApplicationWindow::
-        slotFileOpen(const QString& fileName, RS2::FormatType type)
+        slotFileOpen(const QString& fileName, RS2::FormatType type,
+                     const LC_ImportOptions& options)
 {
     RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen(..)");
 
@@ -1897,7 +2111,7 @@ void QC_ApplicationWindow::
         // open the file in the new view:
         bool success=false;
         if (QFileInfo( fileName).exists()) {
-            success = w->slotFileOpen( fileName, type);
+            success = w->slotFileOpen( fileName, type, options);
         }
         else {
             QString msg=tr("Cannot open the file\n%1\nPlease "
@@ -1925,6 +2139,8 @@ void QC_ApplicationWindow::
         // update recent files menu:
         recentFiles->add(fileName);
         openedFiles.push_back(fileName);
+        // block list changes were not notified while the file was imported
+        blockWidget->setBlockList(w->getDocument()->getBlockList());
         layerWidget->slotUpdateLayerList();
         if (layerTreeWidget != nullptr)
             layerTreeWidget->slotFilteringMaskChanged();
@@ -1948,6 +2164,8 @@ void QC_ApplicationWindow::
                 /*	Format and set caption.
                  *	----------------------- */
         w->setWindowTitle(format_filename_caption(fileName) + "[*]");
+        if (graphic != nullptr && graphic->isReadOnly())
+            w->setWindowTitle(w->windowTitle() + " [" + tr("Read-Only") + "]");
 
 		if (mdiAreaCAD->viewMode() == QMdiArea::TabbedView) {
 			QList<QTabBar *> tabBarList = mdiAreaCAD->findChildren<QTabBar*>();
@@ -2055,26 +2273,49 @@ void QC_ApplicationWindow::slotFileAutoSave() {
         return;
     }
 
+    QC_MDIWindow* w = getMDIWindow();
+    if (w && w->isLoading()) {
+        // try again with the next timer tick
+        RS_DEBUG->print("QC_ApplicationWindow::slotFileAutoSave(): document is loading");
+        return;
+    }
+
+    if (w && w->isAutoSaving()) {
+        // the previous auto-save is still written
+        RS_DEBUG->print("QC_ApplicationWindow::slotFileAutoSave(): document is auto-saving");
+        return;
+    }
+
     statusBar()->showMessage(tr("Auto-saving drawing..."), 2000);
 
-    QC_MDIWindow* w = getMDIWindow();
     if (w) {
+        // drawings are written in background from a snapshot, so editing goes on
+        if (w->autoSaveInBackground())
+            return;
         bool cancelled;
-        if (w->slotFileSave(cancelled, true)) {
-            // auto-save cannot be cancelled by user, so the
-            // "cancelled" parameter is a dummy
-            statusBar()->showMessage(tr("Auto-saved drawing"), 2000);
-        } else {
-            // error
+        // auto-save cannot be cancelled by user, so the
+        // "cancelled" parameter is a dummy
+        slotFileAutoSaved(w, w->slotFileSave(cancelled, true));
+    }
+}
+
+/**
+ * Reports the result of an auto-save, auto-saving is disabled on errors.
+ */
+void QC_ApplicationWindow::slotFileAutoSaved(QC_MDIWindow* w, bool saved) {
+    if (saved) {
+        statusBar()->showMessage(tr("Auto-saved drawing"), 2000);
+    } else {
+        // error
+        if (m_autosaveTimer != nullptr)
             m_autosaveTimer->stop();
-            QMessageBox::information(this, QMessageBox::tr("Warning"),
-                                     tr("Cannot auto-save the file\n%1\nPlease "
-                                        "check the permissions.\n"
-                                        "Auto-save disabled.")
-                                     .arg(w->getDocument()->getAutoSaveFilename()),
-                                     QMessageBox::Ok);
-            statusBar()->showMessage(tr("Auto-saving failed"), 2000);
-        }
+        QMessageBox::information(this, QMessageBox::tr("Warning"),
+                                 tr("Cannot auto-save the file\n%1\nPlease "
+                                    "check the permissions.\n"
+                                    "Auto-save disabled.")
+                                 .arg(w->getDocument()->getAutoSaveFilename()),
+                                 QMessageBox::Ok);
+        statusBar()->showMessage(tr("Auto-saving failed"), 2000);
     }
 }
 
@@ -2225,6 +2466,15 @@ bool QC_ApplicationWindow::slotFileExport(const QString& name,
     statusBar()->showMessage(tr("Exporting..."));
     QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
 
+    // large images are streamed to the file by bands
+    if (LC_TiledImageExport::isTiled(format, size)) {
+        const bool ret = LC_TiledImageExport::exportImage(*graphic, name, format, size, borders,
+                                                          black, bw);
+        QApplication::restoreOverrideCursor();
+        statusBar()->showMessage(ret ? tr("Export complete") : tr("Export failed!"), 2000);
+        return ret;
+    }
+
     bool ret = false;
     // set vars for normal pictures and vectors (svg)
     QPixmap* picture = new QPixmap(size);
@@ -2270,6 +2520,8 @@ bool QC_ApplicationWindow::slotFileExport(const QString& name,
     gv.setContainer(graphic);
     gv.zoomAuto(false);
 	gv.drawEntity(&painter, gv.getContainer());
+    // the batched lines are drawn before the image is written
+    painter.flush();
 
     // end the picture output
     if(format.toLower() != "svg")
@@ -2289,7 +2541,7 @@ bool QC_ApplicationWindow::slotFileExport(const QString& name,
     QApplication::restoreOverrideCursor();
 
     // GraphicView deletes painter
-    painter.end();
+    painter.flushAndEnd();
     // delete vars
     delete picture;
     delete vector;
@@ -2602,11 +2854,13 @@ void QC_ApplicationWindow::slotFilePrint(bool printPDF) {
                 gv.drawEntity(&painter, graphic);
                 painter.setDrawSelectedOnly(false);
                 gv.drawEntity(&painter, graphic);
+                // strokes are batched by pen, until the page is complete
+                painter.flush();
             }
         }
 
         // GraphicView deletes painter
-        painter.end();
+        painter.flushAndEnd();
 
         RS_SETTINGS->beginGroup("/Print");
         RS_SETTINGS->writeEntry("/ColorMode", (int)printer.colorMode());
@@ -2690,6 +2944,7 @@ void QC_ApplicationWindow::slotFilePrintPreview(bool on)
                 QC_MDIWindow* w = new QC_MDIWindow(parent->getDocument(), mdiAreaCAD, {});
                 mdiAreaCAD->addSubWindow(w);
                 parent->addChildWindow(w);
+                connect(w, &QMdiSubWindow::windowStateChanged, this, &QC_ApplicationWindow::slotUpdateWindowRendering);
                 connect(w, SIGNAL(signalClosing(QC_MDIWindow*)),
                         this, SLOT(slotFileClosing(QC_MDIWindow*)));
 
@@ -2801,6 +3056,31 @@ void QC_ApplicationWindow::slotViewGrid(bool toggle) {
     RS_DEBUG->print("QC_ApplicationWindow::slotViewGrid() OK");
 }
 
+bool QC_ApplicationWindow::requestEditing(RS_Graphic& graphic)
+{
+    if (!graphic.isReadOnly())
+        return true;
+    const auto answer = QMessageBox::question(this, tr("Read-Only Drawing"),
+                                              tr("The drawing is open read-only.\n"
+                                                 "Do you want to edit it?"));
+    if (answer != QMessageBox::Yes)
+        return false;
+
+    QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+    graphic.setReadOnly(false);
+    QApplication::restoreOverrideCursor();
+
+    const QString readOnlyString = " [" + tr("Read-Only") + "]";
+    for (QC_MDIWindow* w: window_list) {
+        if (w->getGraphic() == &graphic) {
+            QString title = w->windowTitle();
+            title.remove(readOnlyString);
+            w->setWindowTitle(title);
+        }
+    }
+    return true;
+}
+
 /**
  * Enables / disables the draft mode.
  *
@@ -2907,6 +3187,9 @@ void QC_ApplicationWindow::slotOptionsGeneral() {
 
     RS_SETTINGS->beginGroup("/Appearance");
     int antialiasing = RS_SETTINGS->readNumEntry("/Antialiasing");
+    int parallelRendering = RS_SETTINGS->readNumEntry("/ParallelRendering", 0);
+    int performanceHud = RS_SETTINGS->readNumEntry("/PerformanceHud", 0);
+    int lodThreshold = RS_SETTINGS->readNumEntry("/LodThreshold", 0);
     bool hideRelativeZero = RS_SETTINGS->readNumEntry("/hideRelativeZero", 0) == 1;
     RS_SETTINGS->endGroup();
 
@@ -2929,7 +3212,12 @@ void QC_ApplicationWindow::slotOptionsGeneral() {
                 gv->setRelativeZeroColor(relativeZeroColor);
                 gv->setRelativeZeroHiddenState(hideRelativeZero);
                 gv->setAntialiasing(antialiasing);
-                gv->redraw(RS2::RedrawGrid);
+                gv->setParallelRendering(parallelRendering);
+                gv->setPerformanceHud(performanceHud);
+                gv->setLodThreshold(lodThreshold);
+                if (gv->getGrid() != nullptr)
+                    gv->getGrid()->loadSettings();
+                gv->redraw(RS2::RedrawView);
             }
         }
     }
@@ -3752,6 +4040,22 @@ void QC_ApplicationWindow::changeEvent(QEvent* event)
 }
 
 
+/**
+ * Shows the approximate memory used by the current drawing on the command line.
+ */
+void QC_ApplicationWindow::showMemoryReport()
+{
+    QC_MDIWindow* w = getMDIWindow();
+    RS_Graphic* graphic = (w != nullptr) ? w->getGraphic() : nullptr;
+    if (graphic == nullptr) {
+        commandWidget->appendHistory(tr("Memory report: no drawing is open"));
+        return;
+    }
+    commandWidget->appendHistory(tr("Memory report of %1:").arg(w->windowTitle()));
+    for (const QString& line: LC_MemoryReport{*graphic}.toText())
+        commandWidget->appendHistory(line);
+}
+
 void QC_ApplicationWindow::invokeLicenseWindow()
 {
     // author: ravas
@@ -33,6 +33,7 @@
 
 #include <QMap>
 
+#include "lc_importoptions.h"
 #include "rs.h"
 #include "rs_pen.h"
 #include "rs_snapper.h"
@@ -62,9 +63,11 @@ class QG_RecentFiles;
 class QG_SelectionWidget;
 class QG_SnapToolBar;
 class QMdiArea;
+class QPluginLoader;
 class QMdiSubWindow;
 class RS_Block;
 class RS_Document;
+class RS_Graphic;
 class RS_GraphicView;
 class RS_Pen;
 class TwoStackedLabels;
@@ -123,6 +126,8 @@ public slots:
     void slotWindowActivated(int);
     void slotWindowActivated(QMdiSubWindow* w, bool forced=false);
     void slotWindowsMenuAboutToShow();
+    void slotUpdateWindowRendering();
+    void slotXrefReloaded(const QString& fileName);
     void slotWindowsMenuActivated(bool);
     void slotCascade();
     void slotTile();
@@ -153,10 +158,16 @@ public slots:
     /** opens a document */
     void slotFileOpen();
 
+    /** opens only the layers of a document selected by the user */
+    void slotFileOpenPartial();
+    /** opens a document for viewing and plotting, in the compact read-only form */
+    void slotFileOpenReadOnly();
+
     /**
-     * opens the given file.
+     * opens the given file, or the part of it selected by the options.
      */
-    void slotFileOpen(const QString& fileName, RS2::FormatType type);
+    void slotFileOpen(const QString& fileName, RS2::FormatType type,
+                      const LC_ImportOptions& options = {});
     void slotFileOpen(const QString& fileName); // Assume Unknown type
     void slotFileOpenRecent(QAction* action);
     /** saves a document */
@@ -167,6 +178,7 @@ public slots:
 	bool slotFileSaveAll();
     /** auto-save document */
     void slotFileAutoSave();
+    void slotFileAutoSaved(QC_MDIWindow* w, bool saved);
     /** exports the document as bitmap */
     void slotFileExport();
     bool slotFileExport(const QString& name,
@@ -238,6 +250,8 @@ public slots:
     void updateMenu(const QString& menu_name);
 
     void invokeLicenseWindow();
+    /** shows the memory used by the current drawing on the command line */
+    void showMemoryReport();
 
 
 signals:
@@ -284,6 +298,13 @@ public:
 	const RS_Document* getDocument() const;
 	RS_Document* getDocument();
 
+    /**
+     * @brief requestEditing asks the user whether to edit a drawing opened read-only,
+     * which is then converted to the editable form
+     * @return true, if the drawing is editable
+     */
+    bool requestEditing(RS_Graphic& graphic);
+
     /**
      * Creates a new document. Implementation from RS_MainWindowInterface.
      */
@@ -310,6 +331,10 @@ public:
     }
 
     LC_PenPaletteWidget* getPenPaletteWidget(void) const{ return penPaletteWidget;};
+    /**
+     * @brief setPenPaletteWidget the pen palette is created on the first show of its dock
+     */
+    void setPenPaletteWidget(LC_PenPaletteWidget* widget);
 
     /**
      * Find opened window for specified document.
@@ -357,6 +382,8 @@ private:
 
     //Plugin support
     void loadPlugins();
+    void addPluginAction(QAction* action, const QString& menuEntryPoint);
+    QC_PluginInterface* pluginInstance(QPluginLoader* loader);
     QMenu *findMenu(const QString &searchMenu, const QObjectList thisMenuList, const QString& currentEntry);
 
     #ifdef LC_DEBUGGING
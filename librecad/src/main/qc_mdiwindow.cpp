@@ -32,13 +32,18 @@
 #include <QApplication>
 #include <QCloseEvent>
 #include <QCursor>
+#include <QFile>
 #include <QFileInfo>
 #include <QMessageBox>
 #include <QMdiArea>
 #include <QPainter>
+#include <QProgressDialog>
+#include <QThread>
 
 #include "qc_mdiwindow.h"
 
+#include "lc_documentdisposer.h"
+#include "lc_documentsnapshot.h"
 #include "qg_filedialog.h"
 #include "qg_graphicview.h"
 #include "rs_debug.h"
@@ -98,11 +103,14 @@ QC_MDIWindow::QC_MDIWindow(RS_Document *doc, QWidget *parent, Qt::WindowFlags wf
 /**
  * Destructor.
  *
- * Deletes the document associated with this window.
+ * Detaches the document associated with this window, and deletes it by
+ * a background thread.
  */
 QC_MDIWindow::~QC_MDIWindow()
 {
     RS_DEBUG->print("~QC_MDIWindow: begin");
+    if (m_autosaveWorker != nullptr)
+        m_autosaveWorker->wait();
     if(!(graphicView != nullptr && graphicView->isCleanUp())){
 
 		//do not clear layer/block lists, if application is being closed
@@ -118,7 +126,11 @@ QC_MDIWindow::~QC_MDIWindow()
 		}
 
         if (m_owner) {
-			delete document;
+            // the closed drawing must not receive new entities
+            RS_Graphic* graphic = document->getGraphic();
+            if (graphic != nullptr && LC_EntityPool::threadArena() == graphic->getEntityArena())
+                LC_EntityPool::setThreadArena(nullptr);
+            LC_DocumentDisposer::dispose(document);
 		}
 		document = nullptr;
 	}
@@ -225,6 +237,11 @@ QC_MDIWindow* QC_MDIWindow::getPrintPreview() {
 void QC_MDIWindow::closeEvent(QCloseEvent* ce) {
     RS_DEBUG->print("QC_MDIWindow::closeEvent begin");
 
+    if (m_loading) {
+        // the document is filled by the file import
+        ce->ignore();
+        return;
+    }
     emit(signalClosing(this));
     ce->accept(); // handling delegated to QApplication
 
@@ -284,7 +301,8 @@ bool QC_MDIWindow::slotFileNewTemplate(const QString& fileName, RS2::FormatType
 /**
  * Opens the given file in this MDI window.
  */
-bool QC_MDIWindow::slotFileOpen(const QString& fileName, RS2::FormatType type) {
+bool QC_MDIWindow::slotFileOpen(const QString& fileName, RS2::FormatType type,
+                                const LC_ImportOptions& options) {
 
     RS_DEBUG->print("QC_MDIWindow::slotFileOpen");
     bool ret = false;
@@ -296,7 +314,37 @@ bool QC_MDIWindow::slotFileOpen(const QString& fileName, RS2::FormatType type) {
                 // RVT_PORT qApp->processEvents(1000);
                 qApp->processEvents(QEventLoop::AllEvents, 1000);
 
-        ret = document->open(fileName, type);
+        RS_Graphic* graphic = getGraphic();
+        if (graphic != nullptr) {
+            // the file is imported in background, the view must not draw
+            // the document until the import is done
+            QProgressDialog progress(tr("Opening %1").arg(QFileInfo(fileName).fileName()),
+                                     tr("Cancel"), 0, 1000, this);
+            progress.setWindowModality(Qt::ApplicationModal);
+            progress.setAutoReset(false);
+            progress.setAutoClose(false);
+            // shown at once, the event loop waiting for the import must not take
+            // input for the other windows before the modal dialog blocks it
+            progress.setMinimumDuration(0);
+            progress.show();
+
+            m_loading = true;
+            graphicView->setUpdatesEnabled(false);
+            ret = graphic->open(fileName, type, [&progress](double fraction) {
+                progress.setValue(static_cast<int>(fraction * progress.maximum()));
+                return !progress.wasCanceled();
+            }, options);
+            graphicView->setUpdatesEnabled(true);
+            m_loading = false;
+        } else {
+            ret = document->open(fileName, type);
+        }
+
+        if (ret && !options.isEmpty()) {
+            // saving a part of the drawing must not overwrite the whole file
+            document->setFilename({});
+            document->setModified(true);
+        }
 
         if (ret) {
             //QString message=tr("Loaded document: ")+fileName;
@@ -474,6 +522,47 @@ std::ostream& operator << (std::ostream& os, QC_MDIWindow& w) {
 /**
  * Return true if this window has children (QC_MDIWindow).
  */
+bool QC_MDIWindow::isLoading() const
+{
+    return m_loading;
+}
+
+bool QC_MDIWindow::autoSaveInBackground()
+{
+    RS_Graphic* graphic = getGraphic();
+    if (graphic == nullptr || m_loading || m_autosaveWorker != nullptr
+            || !graphic->isModified() || graphic->getAutoSaveFilename().isEmpty())
+        return false;
+
+    const QString fileName = graphic->getAutoSaveFilename();
+    RS2::FormatType type = graphic->getFormatType();
+    if (type == RS2::FormatUnknown)
+        type = RS2::FormatDXFRW;
+
+    RS_DEBUG->print("QC_MDIWindow::autoSaveInBackground: taking snapshot");
+    m_autosaveSnapshot = graphic->snapshot();
+    m_autosaved = false;
+    m_autosaveWorker.reset(QThread::create([this, fileName, type]() {
+        m_autosaved = m_autosaveSnapshot->saveAs(fileName, type);
+    }));
+    connect(m_autosaveWorker.get(), &QThread::finished, this, [this, fileName]() {
+        m_autosaveWorker->wait();
+        m_autosaveWorker.reset();
+        m_autosaveSnapshot.reset();
+        // the document was saved meanwhile, and its auto-save file removed
+        if (m_autosaved && document != nullptr && !document->isModified())
+            QFile::remove(fileName);
+        emit signalAutoSaved(this, m_autosaved);
+    });
+    m_autosaveWorker->start();
+    return true;
+}
+
+bool QC_MDIWindow::isAutoSaving() const
+{
+    return m_autosaveWorker != nullptr;
+}
+
 bool QC_MDIWindow::has_children() const
 {
     return !childWindows.isEmpty();
@@ -27,13 +27,18 @@
 #ifndef QC_MDIWINDOW_H
 #define QC_MDIWINDOW_H
 
+#include <memory>
+
 #include <QMdiSubWindow>
 #include <QList>
+#include "lc_importoptions.h"
 #include "rs.h"
 #include "rs_layerlistlistener.h"
 #include "rs_blocklistlistener.h"
 
+class LC_DocumentSnapshot;
 class QG_GraphicView;
+class QThread;
 class RS_Document;
 class RS_Graphic;
 class RS_Pen;
@@ -63,7 +68,8 @@ public slots:
 	void slotPenChanged(const RS_Pen& p);
     void slotFileNew();
     bool slotFileNewTemplate(const QString& fileName, RS2::FormatType type);
-    bool slotFileOpen(const QString& fileName, RS2::FormatType type);
+    bool slotFileOpen(const QString& fileName, RS2::FormatType type,
+                      const LC_ImportOptions& options = {});
     bool slotFileSave(bool &cancelled, bool isAutoSave=false);
     bool slotFileSaveAs(bool &cancelled);
     void slotFilePrint();
@@ -114,8 +120,26 @@ public:
 
     bool has_children() const;
 
+    /**
+     * @return true while a file is opened in background.
+     */
+    bool isLoading() const;
+
+    /**
+     * Starts auto-saving a snapshot of the document in background,
+     * signalAutoSaved() is emitted when done.
+     * @return false, if the document can't be auto-saved in background
+     */
+    bool autoSaveInBackground();
+
+    /**
+     * @return true while the document is auto-saved in background.
+     */
+    bool isAutoSaving() const;
+
 signals:
     void signalClosing(QC_MDIWindow*);
+    void signalAutoSaved(QC_MDIWindow*, bool saved);
 
 protected:
     void closeEvent(QCloseEvent*) override;
@@ -132,6 +156,12 @@ private:
     RS_Document* document = nullptr;
     /** Does the window own the document? */
     bool m_owner = false;
+    /** Is a file opened in background? */
+    bool m_loading = false;
+    /** Snapshot being auto-saved, released when saved so the next snapshot shares its copies */
+    std::shared_ptr<const LC_DocumentSnapshot> m_autosaveSnapshot;
+    std::unique_ptr<QThread> m_autosaveWorker;
+    bool m_autosaved = false;
     /**
      * List of known child windows that show blocks of the same drawing.
      */
@@ -26,12 +26,14 @@
 #ifndef DOCUMENT_INTERFACE_H
 #define DOCUMENT_INTERFACE_H
 
+#include <QLineF>
 #include <QPointF>
 #include <QHash>
+#include <QString>
 #include <QVariant>
+#include<cstddef>
 #include<vector>
 //#include <QColor>
-class QString;
 
 namespace DPI {
     //! Vertical alignments.
@@ -48,6 +50,15 @@ namespace DPI {
         HAlignRight     /*!< Right */
     };
 
+    //! Properties compared by Document_Interface::selectSimilar(), combined by or
+    enum SimilarProperty {
+        SAME_TYPE = 1,      /*!< entity type */
+        SAME_LAYER = 2,     /*!< layer */
+        SAME_COLOR = 4,     /*!< color, ByLayer only matches ByLayer */
+        SAME_LTYPE = 8,     /*!< line type */
+        SAME_LWIDTH = 16    /*!< line width */
+    };
+
     //! Options for what to do with originals in a modification
     enum Disposition {
 	DELETE_ORIGINAL,
@@ -197,6 +208,114 @@ public:
     double bulge;
 };
 
+//! Text entity data, for adding many texts at once with Document_Interface::addTexts()
+class Plug_TextData
+{
+public:
+    Plug_TextData(QString const& t, QString const& s, QPointF p, double h,
+                  double a = 0.0, DPI::HAlign hAlign = DPI::HAlignLeft,
+                  DPI::VAlign vAlign = DPI::VAlignBottom):
+        text{t}
+      , style{s}
+      , start{p}
+      , height{h}
+      , angle{a}
+      , ha{hAlign}
+      , va{vAlign}
+    {}
+    QString text;
+    QString style;
+    QPointF start;
+    double height;
+    double angle;
+    DPI::HAlign ha;
+    DPI::VAlign va;
+};
+
+//! Version of the typed entity data read by Plug_EntityVisitor.
+/*! Increased when a data struct changes, see Plug_EntityVisitor::dataVersion()
+*/
+const int PLUG_ENTITY_DATA_VERSION = 1;
+
+//! Common attributes of an entity read by Plug_EntityVisitor.
+struct Plug_EntityAttributes
+{
+    DPI::ETYPE type = DPI::UNKNOWN;
+    unsigned long long id = 0;
+    QString layer;
+    //! -1 ByLayer, -2 ByBlock, other 24 bit RGB color, as DPI::COLOR
+    int color = -1;
+    bool visible = true;
+    bool selected = false;
+};
+
+//! Line data read by Plug_EntityVisitor.
+struct Plug_LineData
+{
+    QPointF start;
+    QPointF end;
+};
+
+//! Circle data read by Plug_EntityVisitor.
+struct Plug_CircleData
+{
+    QPointF center;
+    double radius = 0.;
+};
+
+//! Arc data read by Plug_EntityVisitor, angles in radians.
+struct Plug_ArcData
+{
+    QPointF center;
+    double radius = 0.;
+    double startAngle = 0.;
+    double endAngle = 0.;
+    bool reversed = false;
+};
+
+//! Polyline data read by Plug_EntityVisitor.
+/*! The vertices are only valid within the visit, the vector is reused for the next
+*  polyline.
+*/
+struct Plug_PolylineData
+{
+    bool closed = false;
+    std::vector<Plug_VertexData> vertices;
+};
+
+//! Insert data read by Plug_EntityVisitor.
+struct Plug_InsertData
+{
+    QString name;
+    QPointF insertionPoint;
+    QPointF scale{1., 1.};
+    double angle = 0.;
+};
+
+//! Typed read access to the entities of a document.
+/*! Passed to Document_Interface::visitEntities(), which calls the method for the type of
+*  each entity with the data on the stack, without a Plug_Entity wrapper or QVariant
+*  conversion. The data references are only valid within the call. Each method returns
+*  false to stop the visit. Texts and mtexts are passed as Plug_TextData, the types
+*  without a typed method to visitOther().
+*/
+class Plug_EntityVisitor
+{
+public:
+    virtual ~Plug_EntityVisitor() = default;
+    //! version of the data the visitor is built for, PLUG_ENTITY_DATA_VERSION
+    virtual int dataVersion() const {return PLUG_ENTITY_DATA_VERSION;}
+
+    virtual bool visitPoint(const Plug_EntityAttributes&, const QPointF&) {return true;}
+    virtual bool visitLine(const Plug_EntityAttributes&, const Plug_LineData&) {return true;}
+    virtual bool visitCircle(const Plug_EntityAttributes&, const Plug_CircleData&) {return true;}
+    virtual bool visitArc(const Plug_EntityAttributes&, const Plug_ArcData&) {return true;}
+    virtual bool visitPolyline(const Plug_EntityAttributes&, const Plug_PolylineData&) {return true;}
+    virtual bool visitText(const Plug_EntityAttributes&, const Plug_TextData&) {return true;}
+    virtual bool visitInsert(const Plug_EntityAttributes&, const Plug_InsertData&) {return true;}
+    virtual bool visitOther(const Plug_EntityAttributes&) {return true;}
+};
+
 //! Wrapper for access entities from plugins.
  /*!
  *  Wrapper class for create, access and modify entities from plugins.
@@ -525,6 +644,113 @@ public:
     * \return a string with the converted number.
     */
     virtual QString realToStr(const qreal num, const int units = 0, const int prec = 0) = 0;
+
+    //! Start a batch of document changes.
+    /*! Until the matching endBatch(), all additions and removals go to a single undo
+    * cycle, the borders of the document are not updated and the view is not redrawn.
+    * Batches nest, only the outermost endBatch() finishes the batch. See Plug_Batch.
+    */
+    virtual void beginBatch() = 0;
+
+    //! Finish a batch of document changes started by beginBatch().
+    /*! The borders are updated and the view is redrawn once.
+    */
+    virtual void endBatch() = 0;
+
+    //! Add point entities to current document.
+    /*! Add a point entity for each coordinate with current attributes, in one undo cycle.
+    *  \param points point coordinates.
+    */
+    virtual void addPoints(std::vector<QPointF> const& points) = 0;
+
+    //! Add line entities to current document.
+    /*! Add a line entity for each segment with current attributes, in one undo cycle.
+    *  \param lines start and end points of the lines.
+    */
+    virtual void addLineSegments(std::vector<QLineF> const& lines) = 0;
+
+    //! Add text entities to current document.
+    /*! Add a text entity for each data with current attributes, in one undo cycle.
+    *  \param texts content, style, insertion point, height, angle and alignment of the texts.
+    */
+    virtual void addTexts(std::vector<Plug_TextData> const& texts) = 0;
+
+    //! Add line entities from a coordinate buffer to current document.
+    /*! Add a line entity between each two consecutive points with current attributes, in one undo cycle.
+    *  \param xy point coordinates, x and y of each point in turn.
+    *  \param count number of points.
+    *  \param closed whether a line from the last to the first point is added.
+    */
+    virtual void addLines(const double* xy, std::size_t count, bool closed=false) = 0;
+
+    //! Add polyline entity from a coordinate buffer to current document.
+    /*! Add polyline entity to current document with current attributes.
+    *  \param xy vertex coordinates, x and y of each vertex in turn.
+    *  \param bulges bulge of the segment starting at each vertex, nullptr for straight segments.
+    *  \param count number of vertices.
+    *  \param closed whether polyline is closed
+    */
+    virtual void addPolyline(const double* xy, const double* bulges, std::size_t count,
+                             bool closed=false) = 0;
+
+    //! Add LC_SplinePoints entity from a coordinate buffer to current document.
+    /*! Add splinepoints entity to current document with current attributes.
+    *  \param xy interpolation point coordinates, x and y of each point in turn.
+    *  \param count number of points.
+    *  \param closed whether splinepoints is closed
+    */
+    virtual void addSplinePoints(const double* xy, std::size_t count, bool closed=false) = 0;
+
+    //! Read the entities of the document without wrappers.
+    /*! Calls the visitor for each top level entity in drawing order.
+    *  \param visitor receives the typed data of each entity.
+    *  \param type only visit entities of this type, DPI::UNKNOWN for all types.
+    *  \param layer only visit entities of this layer, all layers if empty.
+    *  \param visible if true, only visit visible entities.
+    *  \return number of entities visited, -1 if the visitor is built for a later data version.
+    */
+    virtual int visitEntities(Plug_EntityVisitor& visitor, DPI::ETYPE type = DPI::UNKNOWN,
+                              const QString& layer = QString(), bool visible = false) = 0;
+
+    //! Select the entities with the same properties.
+    /*! Selects the visible entities on unlocked layers with the properties of the
+    *  reference entity, in one selection update of the document.
+    *  \param reference entity to compare with.
+    *  \param properties DPI::SimilarProperty values to compare.
+    *  \return number of entities selected.
+    */
+    virtual int selectSimilar(Plug_Entity* reference, int properties) = 0;
+
+    //! Add a external reference of a drawing file to current document.
+    /*! Unlike addBlockfromFromdisk() the entities are not copied, they are loaded
+    *  from the file on first use, shared with other documents referencing the file
+    *  and reloaded when the file changes.
+    *  \param fullName path+name of dxf file to reference.
+    *  \return name of created block or NULL if fail.
+    */
+    virtual QString addXrefFromDisk(QString fullName) = 0;
+};
+
+//! Batch of document changes for the lifetime of the object.
+/*! Calls Document_Interface::beginBatch() on construction and
+*  Document_Interface::endBatch() on destruction.
+*/
+class Plug_Batch
+{
+public:
+    explicit Plug_Batch(Document_Interface* doc):
+        m_doc{doc}
+    {
+        m_doc->beginBatch();
+    }
+    ~Plug_Batch()
+    {
+        m_doc->endBatch();
+    }
+    Plug_Batch(Plug_Batch const&) = delete;
+    Plug_Batch& operator = (Plug_Batch const&) = delete;
+private:
+    Document_Interface* m_doc;
 };
 
 
@@ -26,7 +26,7 @@ CONFIG += qt \
     verbose \
     depend_includepath
 
-QT += widgets printsupport
+QT += widgets printsupport network
 CONFIG += c++17
 
 # using qt5 connections for UI forms
@@ -94,6 +94,9 @@ LIBS += -L../../generated/lib  \
     -ldxfrw \
     -ljwwlib
 
+# compressed DXF files, as drawing.dxf.gz
+LIBS += -lz
+
 INCLUDEPATH += \
     ../../libraries/libdxfrw/src \
     ../../libraries/jwwlib/src \
@@ -110,6 +113,7 @@ INCLUDEPATH += \
     lib/math \
     lib/modification \
     lib/printing \
+    lib/scripting \
     actions \
     main \
     main/console_dxf2pdf \
@@ -156,6 +160,8 @@ HEADERS += \
     lib/actions/rs_snapper.h \
     lib/creation/rs_creation.h \
     lib/debug/rs_debug.h \
+    lib/debug/lc_trace.h \
+    lib/debug/lc_regenstatistics.h \
     lib/engine/lc_looputils.h \
     lib/engine/lc_parabola.h \
     lib/engine/rs.h \
@@ -222,6 +228,8 @@ HEADERS += \
     lib/filters/rs_filterjww.h \
     lib/filters/rs_filterlff.h \
     lib/filters/rs_filterinterface.h \
+    lib/filters/lc_importprofile.h \
+    lib/filters/lc_dxfsaveindex.h \
     lib/gui/rs_commandevent.h \
     lib/gui/rs_coordinateevent.h \
     lib/gui/rs_dialogfactory.h \
@@ -238,20 +246,48 @@ HEADERS += \
     lib/information/rs_locale.h \
     lib/information/rs_information.h \
     lib/information/rs_infoarea.h \
+    lib/information/lc_preparedcontour.h \
     lib/math/lc_linemath.h \
     lib/modification/rs_modification.h \
     lib/modification/rs_selection.h \
+    lib/scripting/lc_batchscript.h \
+    lib/modification/lc_polylineoffset.h \
+    lib/modification/lc_overkill.h \
     lib/math/rs_math.h \
     lib/math/lc_quadratic.h \
+    lib/math/lc_expression.h \
     actions/lc_actiondrawcircle2pr.h \
     main/console_dxf2png.h \
     test/lc_simpletests.h \
     lib/generators/lc_makercamsvg.h \
     lib/generators/lc_xmlwriterinterface.h \
     lib/generators/lc_xmlwriterqxmlstreamwriter.h \
+    lib/generators/lc_imagestreamwriter.h \
+    lib/generators/lc_tiledimageexport.h \
+    lib/generators/lc_drawinggenerator.h \
     actions/lc_actionfileexportmakercam.h \
     lib/engine/lc_rect.h \
     lib/engine/lc_undosection.h \
+    lib/engine/lc_spatialindex.h \
+    lib/engine/lc_entitypool.h \
+    lib/engine/lc_hatchscanline.h \
+    lib/engine/lc_importoptions.h \
+    lib/engine/lc_documentsnapshot.h \
+    lib/engine/lc_undoabletransform.h \
+    lib/engine/lc_compiledfont.h \
+    lib/engine/lc_imagepyramid.h \
+    lib/engine/lc_pentable.h \
+    lib/engine/lc_memoryreport.h \
+    lib/engine/lc_rendercache.h \
+    lib/engine/lc_xrefcache.h \
+    lib/engine/lc_librarycache.h \
+    lib/engine/lc_fontfile.h \
+    lib/engine/lc_taskscheduler.h \
+    lib/engine/lc_sharedvector.h \
+    lib/engine/lc_progress.h \
+    lib/engine/lc_resultqueue.h \
+    lib/engine/lc_endpointgraph.h \
+    lib/engine/lc_documentdisposer.h \
     lib/printing/lc_printing.h \
     actions/lc_actiondrawlinepolygon3.h \
     main/lc_application.h \
@@ -316,6 +352,8 @@ SOURCES += \
     lib/actions/rs_snapper.cpp \
     lib/creation/rs_creation.cpp \
     lib/debug/rs_debug.cpp \
+    lib/debug/lc_trace.cpp \
+    lib/debug/lc_regenstatistics.cpp \
     lib/engine/lc_looputils.cpp \
     lib/engine/lc_parabola.cpp \
     lib/engine/rs_arc.cpp \
@@ -371,6 +409,8 @@ SOURCES += \
     lib/filters/rs_filterdxf1.cpp \
     lib/filters/rs_filterjww.cpp \
     lib/filters/rs_filterlff.cpp \
+    lib/filters/lc_importprofile.cpp \
+    lib/filters/lc_dxfsaveindex.cpp \
     lib/gui/rs_dialogfactory.cpp \
     lib/gui/rs_eventhandler.cpp \
     lib/gui/rs_graphicview.cpp \
@@ -382,11 +422,16 @@ SOURCES += \
     lib/information/rs_locale.cpp \
     lib/information/rs_information.cpp \
     lib/information/rs_infoarea.cpp \
+    lib/information/lc_preparedcontour.cpp \
     lib/math/lc_linemath.cpp \
     lib/math/rs_math.cpp \
     lib/math/lc_quadratic.cpp \
+    lib/math/lc_expression.cpp \
     lib/modification/rs_modification.cpp \
     lib/modification/rs_selection.cpp \
+    lib/scripting/lc_batchscript.cpp \
+    lib/modification/lc_polylineoffset.cpp \
+    lib/modification/lc_overkill.cpp \
     lib/engine/rs_color.cpp \
     lib/engine/rs_pen.cpp \
     actions/lc_actiondrawcircle2pr.cpp \
@@ -394,6 +439,9 @@ SOURCES += \
     test/lc_simpletests.cpp \
     lib/generators/lc_xmlwriterqxmlstreamwriter.cpp \
     lib/generators/lc_makercamsvg.cpp \
+    lib/generators/lc_imagestreamwriter.cpp \
+    lib/generators/lc_tiledimageexport.cpp \
+    lib/generators/lc_drawinggenerator.cpp \
     actions/lc_actionfileexportmakercam.cpp \
     lib/engine/rs_atomicentity.cpp \
     lib/engine/rs_undocycle.cpp \
@@ -401,6 +449,24 @@ SOURCES += \
     lib/engine/lc_rect.cpp \
     lib/engine/lc_undosection.cpp \
     lib/engine/rs.cpp \
+    lib/engine/lc_spatialindex.cpp \
+    lib/engine/lc_entitypool.cpp \
+    lib/engine/lc_hatchscanline.cpp \
+    lib/engine/lc_documentsnapshot.cpp \
+    lib/engine/lc_undoabletransform.cpp \
+    lib/engine/lc_compiledfont.cpp \
+    lib/engine/lc_imagepyramid.cpp \
+    lib/engine/lc_pentable.cpp \
+    lib/engine/lc_memoryreport.cpp \
+    lib/engine/lc_rendercache.cpp \
+    lib/engine/lc_xrefcache.cpp \
+    lib/engine/lc_librarycache.cpp \
+    lib/engine/lc_fontfile.cpp \
+    lib/engine/lc_taskscheduler.cpp \
+    lib/engine/lc_progress.cpp \
+    lib/engine/lc_resultqueue.cpp \
+    lib/engine/lc_endpointgraph.cpp \
+    lib/engine/lc_documentdisposer.cpp \
     lib/printing/lc_printing.cpp \
     actions/lc_actiondrawlinepolygon3.cpp \
     main/lc_application.cpp \
@@ -581,6 +647,8 @@ HEADERS += actions/rs_actionblocksadd.h \
     actions/rs_actionzoomprevious.h \
     actions/rs_actionzoomredraw.h \
     actions/rs_actionzoomscroll.h \
+    actions/lc_actionmodifyoverkill.h \
+    actions/lc_actionmodifytrimtoedges.h \
     actions/rs_actionzoomwindow.h
 
 SOURCES += actions/rs_actionblocksadd.cpp \
@@ -721,6 +789,8 @@ SOURCES += actions/rs_actionblocksadd.cpp \
     actions/rs_actionzoomprevious.cpp \
     actions/rs_actionzoomredraw.cpp \
     actions/rs_actionzoomscroll.cpp \
+    actions/lc_actionmodifyoverkill.cpp \
+    actions/lc_actionmodifytrimtoedges.cpp \
     actions/rs_actionzoomwindow.cpp
 
 
@@ -830,6 +900,8 @@ HEADERS += ui/lc_actionfactory.h \
     ui/generic/colorcombobox.h \
     ui/generic/colorwizard.h \
     ui/lc_penwizard.h \
+    ui/lc_layernamefilter.h \
+    ui/lc_progressdialog.h \
     ui/generic/textfileviewer.h \
     ui/lc_filedialogservice.h
 
@@ -936,6 +1008,8 @@ SOURCES += ui/lc_actionfactory.cpp \
     ui/lc_penwizard.cpp \
     ui/generic/textfileviewer.cpp \
     ui/lc_filedialogservice.cpp\
+    ui/lc_layernamefilter.cpp \
+    ui/lc_progressdialog.cpp \
     ui/lc_penitem.cpp
 
 FORMS = ui/forms/qg_commandwidget.ui \
@@ -1047,6 +1121,12 @@ HEADERS += \
     plugins/intern/qc_actiongetent.h \
     main/main.h \
     main/mainwindowx.h \
+    main/console_renderserver.h \
+    main/console_benchmark.h \
+    main/console_dxfgen.h \
+    main/console_dwgcorpus.h \
+    main/console_rendertest.h \
+    main/console_script.h \
     main/console_dxf2pdf/console_dxf2pdf.h \
     main/console_dxf2pdf/pdf_print_loop.h
 
@@ -1060,6 +1140,12 @@ SOURCES += \
     plugins/intern/qc_actiongetent.cpp \
     main/main.cpp \
     main/mainwindowx.cpp \
+    main/console_renderserver.cpp \
+    main/console_benchmark.cpp \
+    main/console_dxfgen.cpp \
+    main/console_dwgcorpus.cpp \
+    main/console_rendertest.cpp \
+    main/console_script.cpp \
     main/console_dxf2pdf/console_dxf2pdf.cpp \
     main/console_dxf2pdf/pdf_print_loop.cpp
 
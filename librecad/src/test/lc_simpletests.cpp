@@ -49,6 +49,11 @@ LC_SimpleTests::LC_SimpleTests(QWidget *parent):
 				this, SLOT(slotTestUpdateInserts()));
 		testMenu->addAction(action);
 
+		action = new QAction("Undo Layer Removal", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestUndoLayerRemoval()));
+		testMenu->addAction(action);
+
 			 action = new QAction("Draw Freehand", this);
 		connect(action, SIGNAL(triggered()),
 				this, SLOT(slotTestDrawFreehand()));
@@ -429,6 +434,46 @@ void LC_SimpleTests::slotTestUpdateInserts() {
 	RS_DEBUG->print("%s\n: end\n", __func__);
 }
 
+/**
+ * Testing function. A line on layer L is deleted, L is removed, and the deletion
+ * is undone: the line must come back on layer "0", not on the deleted layer.
+ */
+void LC_SimpleTests::slotTestUndoLayerRemoval() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+
+	RS_Graphic graphic;
+	graphic.newDoc();
+	RS_Layer* layer0 = graphic.findLayer("0");
+	graphic.addLayer(new RS_Layer("L"));
+
+	auto* line = new RS_Line(&graphic, {0., 0.}, {10., 0.});
+	line->setLayer("L");
+	graphic.addEntity(line);
+	graphic.startUndoCycle();
+	graphic.addUndoable(line);
+	graphic.endUndoCycle();
+
+	graphic.startUndoCycle();
+	line->setUndoState(true);
+	graphic.addUndoable(line);
+	graphic.endUndoCycle();
+
+	graphic.removeLayer(graphic.findLayer("L"));
+
+	bool passed = graphic.findLayer("L") == nullptr;
+	// the deletion, then the creation
+	graphic.undo();
+	passed = passed && !line->isUndone() && line->getLayer() == layer0
+			&& graphic.getLayerEntities(layer0).size() == 1;
+	graphic.undo();
+	passed = passed && line->isUndone() && line->getLayer() == layer0;
+	graphic.redo();
+	passed = passed && !line->isUndone() && line->getLayer() == layer0;
+
+	std::cout << "Undo Layer Removal: " << (passed ? "passed" : "FAILED") << std::endl;
+	RS_DEBUG->print("%s\n: end\n", __func__);
+}
+
 /**
  * Testing function.
  */
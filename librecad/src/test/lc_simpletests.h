@@ -19,6 +19,8 @@ public slots:
 	void slotTestDumpUndo();
 	/** updates all inserts */
 	void slotTestUpdateInserts();
+	/** undoes the deletion of an entity across the removal of its layer */
+	void slotTestUndoLayerRemoval();
 	/** draws some random lines */
 	void slotTestDrawFreehand();
 	/** inserts a test block */
@@ -62,6 +62,14 @@ QG_CommandWidget::QG_CommandWidget(QWidget* parent, const char* name, Qt::Window
     connect(leCommand, SIGNAL(clearCommandsHistory()), teHistory, SLOT(clear()));
     connect(leCommand, SIGNAL(message(QString)), this, SLOT(appendHistory(QString)));
     connect(leCommand, &QG_CommandEdit::keycode, this, &QG_CommandWidget::handleKeycode);
+    connect(leCommand, &QG_CommandEdit::macroStarted, this, [this]() {
+        if (actionHandler != nullptr)
+            actionHandler->beginMacro();
+    });
+    connect(leCommand, &QG_CommandEdit::macroFinished, this, [this]() {
+        if (actionHandler != nullptr)
+            actionHandler->endMacro();
+    });
 
     auto a1 = new QAction(QObject::tr("Keycode mode"), this);
     a1->setObjectName("keycode_action");
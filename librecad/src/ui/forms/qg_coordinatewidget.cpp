@@ -25,6 +25,11 @@
 **********************************************************************/
 #include "qg_coordinatewidget.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include <QScreen>
+
 #include "rs_graphic.h"
 #include "rs_settings.h"
 #include "rs_vector.h"
@@ -50,6 +55,9 @@ QG_CoordinateWidget::QG_CoordinateWidget(QWidget* parent, const char* name, Qt::
     format = RS2::Decimal;
     aprec = 2;
     aformat = RS2::DegreesDecimal;
+
+    updateTimer.setSingleShot(true);
+    connect(&updateTimer, &QTimer::timeout, this, &QG_CoordinateWidget::updateLabels);
 }
 
 /*
@@ -71,6 +79,7 @@ void QG_CoordinateWidget::languageChange()
 
 void QG_CoordinateWidget::setGraphic(RS_Graphic* graphic) {
     this->graphic = graphic;
+    shownValid = false;
 
     setCoordinates(RS_Vector(0.0,0.0), RS_Vector(0.0,0.0), true);
 }
@@ -82,16 +91,58 @@ void QG_CoordinateWidget::setCoordinates(const RS_Vector& abs,
 }
 
 
+/**
+ * Keeps the coordinates of mouse moves, the labels show the latest coordinates at the
+ * next display frame
+ */
 void QG_CoordinateWidget::setCoordinates(double x, double y,
         double rx, double ry, bool updateFormat) {
+    pending[0] = x;
+    pending[1] = y;
+    pending[2] = rx;
+    pending[3] = ry;
+    pendingFormat = pendingFormat || updateFormat;
+    if (!updateTimer.isActive()) {
+        const QScreen* s = screen();
+        const double rate = (s != nullptr && s->refreshRate() > 1.) ? s->refreshRate() : 60.;
+        updateTimer.start(std::max(1, int(1000. / rate)));
+    }
+}
+
+
+void QG_CoordinateWidget::updateLabels() {
 
     if (graphic) {
-        if (updateFormat) {
+        if (pendingFormat) {
             format = graphic->getLinearFormat();
             prec = graphic->getLinearPrecision();
             aformat = graphic->getAngleFormat();
             aprec = graphic->getAnglePrecision();
+            shownValid = false;
         }
+        pendingFormat = false;
+
+        // the labels don't change while the coordinates round to the shown ones
+        const double scale = std::pow(10., std::min(prec, 12));
+        // radians, finer than the shown degrees or gradians
+        const double angleScale = std::pow(10., std::min(aprec + 2, 12));
+        const RS_Vector absolute{pending[0], pending[1]};
+        const RS_Vector relative{pending[2], pending[3]};
+        const double rounded[8] = {
+            std::round(pending[0] * scale), std::round(pending[1] * scale),
+            std::round(pending[2] * scale), std::round(pending[3] * scale),
+            std::round(absolute.magnitude() * scale), std::round(relative.magnitude() * scale),
+            std::round(absolute.angle() * angleScale), std::round(relative.angle() * angleScale)
+        };
+        if (shownValid && std::equal(rounded, rounded + 8, shown))
+            return;
+        std::copy(rounded, rounded + 8, shown);
+        shownValid = true;
+
+        const double x = pending[0];
+        const double y = pending[1];
+        const double rx = pending[2];
+        const double ry = pending[3];
 
         // abs / rel coordinates:
         QString absX = RS_Units::formatLinear(x,
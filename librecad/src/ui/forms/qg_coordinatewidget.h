@@ -26,6 +26,8 @@
 #ifndef QG_COORDINATEWIDGET_H
 #define QG_COORDINATEWIDGET_H
 
+#include <QTimer>
+
 #include "ui_qg_coordinatewidget.h"
 #include "rs.h"
 
@@ -48,6 +50,9 @@ public slots:
 protected slots:
     virtual void languageChange();
 
+private slots:
+    void updateLabels();
+
 private:
     RS_Graphic* graphic = nullptr;
     int prec = 0;
@@ -55,6 +60,13 @@ private:
     int aprec = 0;
     RS2::AngleFormat aformat = RS2::DegreesDecimal;
 
+    // coordinates not shown yet, the labels are updated once per display frame
+    double pending[4] = {0., 0., 0., 0.};
+    bool pendingFormat = false;
+    // the shown coordinates and polar coordinates, rounded to the precision
+    double shown[8] = {};
+    bool shownValid = false;
+    QTimer updateTimer;
 };
 
 #endif // QG_COORDINATEWIDGET_H
@@ -154,7 +154,7 @@ void QG_DlgHatch::updatePreview() {
         return;
     }
 	pattern = cbPattern->getPattern();
-	if (pattern->countDeep()==0)
+	if (pattern == nullptr || pattern->countDeep()==0)
 		return;
 
     QString patName = cbPattern->currentText();
@@ -162,10 +162,7 @@ void QG_DlgHatch::updatePreview() {
     double scale = RS_Math::eval(leScale->text(), 1.0);
     double angle = RS_Math::deg2rad(RS_Math::eval(leAngle->text(), 0.0));
 	double prevSize = 100.0;
-    if (pattern) {
-        pattern->calculateBorders();
-		prevSize = std::max(prevSize, pattern->getSize().magnitude());
-	}
+	prevSize = std::max(prevSize, pattern->getSize().magnitude());
 
     preview->clear();
 
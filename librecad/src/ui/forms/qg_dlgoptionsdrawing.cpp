@@ -36,6 +36,7 @@
 
 #include "dxf_format.h"
 #include "lc_defaults.h"
+#include "lc_regenstatistics.h"
 #include "rs_debug.h"
 #include "rs_filterdxfrw.h"
 #include "rs_font.h"
@@ -639,6 +640,7 @@ void QG_DlgOptionsDrawing::validate() {
 
         // update all dimension and spline entities in the graphic to match the new settings:
         // update text position when text height or text gap changed
+        LC_REGEN_REASON("drawing options");
         graphic->updateDimensions(ok1);
         graphic->updateSplines();
 
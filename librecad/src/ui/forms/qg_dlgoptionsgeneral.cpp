@@ -29,6 +29,7 @@
 #include <qc_applicationwindow.h>
 #include <QColorDialog>
 
+#include "lc_taskscheduler.h"
 #include "qg_filedialog.h"
 
 #include "rs_debug.h"
@@ -135,6 +136,14 @@ void QG_DlgOptionsGeneral::init()
     int checked = RS_SETTINGS->readNumEntry("/Antialiasing");
     cb_antialiasing->setChecked(checked?true:false);
 
+    checked = RS_SETTINGS->readNumEntry("/ParallelRendering");
+    cb_parallel_rendering->setChecked(checked?true:false);
+
+    checked = RS_SETTINGS->readNumEntry("/PerformanceHud");
+    cb_performance_hud->setChecked(checked?true:false);
+
+    sbLodThreshold->setValue(RS_SETTINGS->readNumEntry("/LodThreshold", 0));
+
     checked = RS_SETTINGS->readNumEntry("/Autopanning");
     cb_autopanning->setChecked(checked?true:false);
 
@@ -143,6 +152,8 @@ void QG_DlgOptionsGeneral::init()
 
     // preview:
 	initComboBox(cbMaxPreview, RS_SETTINGS->readEntry("/MaxPreview", "100"));
+    cbPreviewSelectionBorder->setChecked(RS_SETTINGS->readNumEntry("/PreviewSelectionBorder", 0) != 0);
+    cbAsyncSnapping->setChecked(RS_SETTINGS->readNumEntry("/AsyncSnapping", 0) != 0);
 
     RS_SETTINGS->endGroup();
 
@@ -185,6 +196,13 @@ void QG_DlgOptionsGeneral::init()
     // Auto save timer
     cbAutoSaveTime->setValue(RS_SETTINGS->readNumEntry("/AutoSaveTime", 5));
     cbAutoBackup->setChecked(RS_SETTINGS->readNumEntry("/AutoBackupDocument", 1));
+    cbAutoSaveBinary->setChecked(RS_SETTINGS->readNumEntry("/AutoSaveBinary", 0));
+    cbIncrementalSave->setChecked(RS_SETTINGS->readNumEntry("/IncrementalSave", 0));
+    cbDocumentCache->setChecked(RS_SETTINGS->readNumEntry("/DocumentCache", 0));
+    cbProfileImport->setChecked(RS_SETTINGS->readNumEntry("/ProfileImport", 0));
+    cbProfilePlugins->setChecked(RS_SETTINGS->readNumEntry("/ProfilePlugins", 0));
+    sbUndoMemory->setValue(RS_SETTINGS->readNumEntry("/UndoMemoryLimit", 0));
+    sbWorkerThreads->setValue(RS_SETTINGS->readNumEntry("/WorkerThreads", 0));
     cbUseQtFileOpenDialog->setChecked(RS_SETTINGS->readNumEntry("/UseQtFileOpenDialog", 1));
     cbWheelScrollInvertH->setChecked(RS_SETTINGS->readNumEntry("/WheelScrollInvertH", 0));
     cbWheelScrollInvertV->setChecked(RS_SETTINGS->readNumEntry("/WheelScrollInvertV", 0));
@@ -248,6 +266,8 @@ void QG_DlgOptionsGeneral::ok()
         RS_SETTINGS->writeEntry("/VisualizeHovering", QString{cbVisualizeHovering->isChecked() ? "1" : "0"});
         RS_SETTINGS->writeEntry("/MinGridSpacing", cbMinGridSpacing->currentText());
         RS_SETTINGS->writeEntry("/MaxPreview", cbMaxPreview->currentText());
+        RS_SETTINGS->writeEntry("/PreviewSelectionBorder", cbPreviewSelectionBorder->isChecked() ? 1 : 0);
+        RS_SETTINGS->writeEntry("/AsyncSnapping", cbAsyncSnapping->isChecked() ? 1 : 0);
         RS_SETTINGS->writeEntry("/Language",cbLanguage->itemData(cbLanguage->currentIndex()));
         RS_SETTINGS->writeEntry("/LanguageCmd",cbLanguageCmd->itemData(cbLanguageCmd->currentIndex()));
         RS_SETTINGS->writeEntry("/indicator_lines_state", indicator_lines_checkbox->isChecked());
@@ -256,6 +276,9 @@ void QG_DlgOptionsGeneral::ok()
         RS_SETTINGS->writeEntry("/indicator_shape_type", indicator_shape_combobox->currentText());
         RS_SETTINGS->writeEntry("/cursor_hiding", cursor_hiding_checkbox->isChecked());
         RS_SETTINGS->writeEntry("/Antialiasing", cb_antialiasing->isChecked()?1:0);
+        RS_SETTINGS->writeEntry("/ParallelRendering", cb_parallel_rendering->isChecked()?1:0);
+        RS_SETTINGS->writeEntry("/PerformanceHud", cb_performance_hud->isChecked()?1:0);
+        RS_SETTINGS->writeEntry("/LodThreshold", sbLodThreshold->value());
         RS_SETTINGS->writeEntry("/Autopanning", cb_autopanning->isChecked()?1:0);
         RS_SETTINGS->writeEntry("/ScrollBars", scrollbars_check_box->isChecked()?1:0);
         RS_SETTINGS->endGroup();
@@ -287,6 +310,14 @@ void QG_DlgOptionsGeneral::ok()
             RS_Units::unitToString( RS_Units::stringToUnit( cbUnit->currentText() ), false/*untr.*/) );
         RS_SETTINGS->writeEntry("/AutoSaveTime", cbAutoSaveTime->value() );
         RS_SETTINGS->writeEntry("/AutoBackupDocument", cbAutoBackup->isChecked() ? 1 : 0);
+        RS_SETTINGS->writeEntry("/AutoSaveBinary", cbAutoSaveBinary->isChecked() ? 1 : 0);
+        RS_SETTINGS->writeEntry("/IncrementalSave", cbIncrementalSave->isChecked() ? 1 : 0);
+        RS_SETTINGS->writeEntry("/DocumentCache", cbDocumentCache->isChecked() ? 1 : 0);
+        RS_SETTINGS->writeEntry("/ProfileImport", cbProfileImport->isChecked() ? 1 : 0);
+        RS_SETTINGS->writeEntry("/ProfilePlugins", cbProfilePlugins->isChecked() ? 1 : 0);
+        RS_SETTINGS->writeEntry("/UndoMemoryLimit", sbUndoMemory->value());
+        RS_SETTINGS->writeEntry("/WorkerThreads", sbWorkerThreads->value());
+        LC_TaskScheduler::instance().setThreadCount(sbWorkerThreads->value());
         RS_SETTINGS->writeEntry("/UseQtFileOpenDialog", cbUseQtFileOpenDialog->isChecked() ? 1 : 0);
         RS_SETTINGS->writeEntry("/WheelScrollInvertH", cbWheelScrollInvertH->isChecked() ? 1 : 0);
         RS_SETTINGS->writeEntry("/WheelScrollInvertV", cbWheelScrollInvertV->isChecked() ? 1 : 0);
@@ -38,6 +38,7 @@ QG_DlgOptionsMakerCam::QG_DlgOptionsMakerCam(QWidget* parent, bool modal, Qt::Wi
     this->dSpinBoxDefaultElementWidth->setToolTip(tr("Default width of elements can affect some CAM's/SVG Editors, \nbut ignored by other"));
     this->dSpinBoxDashLinePatternLength->setToolTip(tr("Length of line pattern related to zoom, \nso default step value required for baking"));
     gbImages->setToolTip(tr("Whether to export points"));
+    this->gbPaths->setToolTip(tr("Merged paths and fewer decimal places make smaller files, \nwhich are faster to load by CAM's."));
 
     loadSettings();
 }
@@ -71,6 +72,8 @@ void QG_DlgOptionsMakerCam::loadSettings() {
     updateCheckbox(checkPoint, "ExportPoints", 0);
     updateDoubleSpinBox(dSpinBoxDefaultElementWidth, "DefaultElementWidth", 1.0);
     updateDoubleSpinBox(dSpinBoxDashLinePatternLength, "DefaultDashLinePatternLength", 2.5);
+    updateCheckbox(checkMergePaths, "MergePaths", 0);
+    spinBoxPrecision->setValue(RS_SETTINGS->readNumEntry("/Precision", 8));
 }
 
 void QG_DlgOptionsMakerCam::updateCheckbox(QCheckBox* checkbox, QString name, int defaultValue) {
@@ -96,6 +99,8 @@ void QG_DlgOptionsMakerCam::saveSettings() {
     saveBoolean("ExportPoints", checkPoint);
     saveDouble("DefaultElementWidth", dSpinBoxDefaultElementWidth);
     saveDouble("DefaultDashLinePatternLength", dSpinBoxDashLinePatternLength);
+    saveBoolean("MergePaths", checkMergePaths);
+    RS_SETTINGS->writeEntry("/Precision", spinBoxPrecision->value());
 }
 
 void QG_DlgOptionsMakerCam::saveBoolean(QString name, QCheckBox* checkbox) {
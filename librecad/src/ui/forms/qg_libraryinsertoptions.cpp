@@ -61,6 +61,7 @@ void QG_LibraryInsertOptions::saveSettings() {
     RS_SETTINGS->beginGroup("/LibraryInsert");
 	RS_SETTINGS->writeEntry("/LibraryInsertAngle", ui->leAngle->text());
 	RS_SETTINGS->writeEntry("/LibraryInsertFactor", ui->leFactor->text());
+	RS_SETTINGS->writeEntry("/LibraryInsertReference", ui->cbReference->isChecked() ? 1 : 0);
     RS_SETTINGS->endGroup();
 }
 
@@ -70,17 +71,21 @@ void QG_LibraryInsertOptions::setAction(RS_ActionInterface* a, bool update) {
 
         QString sAngle;
         QString sFactor;
+        bool reference = false;
         if (update) {
             sAngle = QString("%1").arg(RS_Math::rad2deg(action->getAngle()));
             sFactor = QString("%1").arg(action->getFactor());
+            reference = action->isReference();
         } else {
             RS_SETTINGS->beginGroup("/LibraryInsert");
             sAngle = RS_SETTINGS->readEntry("/LibraryInsertAngle", "0.0");
             sFactor = RS_SETTINGS->readEntry("/LibraryInsertFactor", "1.0");
+            reference = RS_SETTINGS->readNumEntry("/LibraryInsertReference", 0) == 1;
             RS_SETTINGS->endGroup();
         }
 	ui->leAngle->setText(sAngle);
 	ui->leFactor->setText(sFactor);
+	ui->cbReference->setChecked(reference);
     } else {
         RS_DEBUG->print(RS_Debug::D_ERROR, 
 			"QG_LibraryInsertOptions::setAction: wrong action type");
@@ -92,6 +97,7 @@ void QG_LibraryInsertOptions::updateData() {
     if (action) {
 		action->setAngle(RS_Math::deg2rad(RS_Math::eval(ui->leAngle->text())));
 		action->setFactor(RS_Math::eval(ui->leFactor->text()));
+		action->setReference(ui->cbReference->isChecked());
         saveSettings();
     }
 }
@@ -47,6 +47,11 @@ QG_SelectionWidget::QG_SelectionWidget(QWidget* parent, const char* name, Qt::Wi
     timer = new QTimer(this);
     timer->setSingleShot(true);
     connect( timer, &QTimer::timeout, this, &QG_SelectionWidget::removeAuxData);
+
+    updateTimer = new QTimer(this);
+    updateTimer->setSingleShot(true);
+    updateTimer->setInterval(0);
+    connect( updateTimer, &QTimer::timeout, this, &QG_SelectionWidget::updateLabels);
 }
 
 /*
@@ -69,31 +74,54 @@ void QG_SelectionWidget::languageChange()
 
 void QG_SelectionWidget::setNumber(int n)
 {
-    if (auxDataMode)
+    pendingNumber = n;
+    updateTimer->start();
+}
+
+void QG_SelectionWidget::setTotalLength(double l) {
+    pendingLength = l;
+    updateTimer->start();
+}
+
+/**
+ * Shows the latest number and length of the selected entities
+ */
+void QG_SelectionWidget::updateLabels()
+{
+    updateTimer->stop();
+    if (pendingNumber >= 0)
     {
-        QSettings settings("QGDialogFactory", "QGSelectionWidget");
-        settings.setValue("lEntities_text", n);
+        if (auxDataMode)
+        {
+            QSettings settings("QGDialogFactory", "QGSelectionWidget");
+            settings.setValue("lEntities_text", pendingNumber);
+        }
+        else /* if (!auxDataMode) */
+        {
+            QString str;
+            str.setNum(pendingNumber);
+            lEntities->setText(str);
+        }
+        pendingNumber = -1;
     }
-    else /* if (!auxDataMode) */
+    if (pendingLength >= 0.)
     {
         QString str;
-        str.setNum(n);
-        lEntities->setText(str);
+        str.setNum(pendingLength, 'g', 6);
+        lTotalLength->setText(str);
+        pendingLength = -1.;
     }
 }
 
-void QG_SelectionWidget::setTotalLength(double l) {
-    QString str;
-    str.setNum(l, 'g', 6);
-    lTotalLength->setText(str);
-}
-
 
 void QG_SelectionWidget::flashAuxData( const QString& header, 
                                        const QString& data, 
                                        const unsigned int& timeout, 
                                        const bool& flash)
 {
+    // the labels are saved and restored with the latest selection
+    updateLabels();
+
     if (flash)
     {
         QSettings settings("QGDialogFactory", "QGSelectionWidget");
@@ -144,6 +172,7 @@ void QG_SelectionWidget::flashAuxData( const QString& header,
 
 void QG_SelectionWidget::removeAuxData()
 {
+    updateLabels();
     auxDataMode = false;
 
     QSettings settings("QGDialogFactory", "QGSelectionWidget");
@@ -57,9 +57,17 @@ public slots:
 protected slots:
     virtual void languageChange();
 
+private slots:
+    void updateLabels();
+
 private:
     bool auxDataMode    {false};
     QTimer *timer       {nullptr};
 
+    // selection counts of loops are shown once, when the event loop runs
+    QTimer *updateTimer {nullptr};
+    int pendingNumber   {-1};
+    double pendingLength{-1.};
+
 };
 #endif // QG_SELECTIONWIDGET_H
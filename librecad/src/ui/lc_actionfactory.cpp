@@ -804,6 +804,14 @@ void LC_ActionFactory::fillActionContainer(QMap<QString, QAction*>& a_map, LC_Ac
     action->setData("lengthen, le");
     a_map["ModifyTrimAmount"] = action;
 
+    action = new QAction(tr("Trim to &Edges"), agm->modify);
+    action->setIcon(QIcon(":/icons/trim2.svg"));
+    connect(action, SIGNAL(triggered()),
+    action_handler, SLOT(slotModifyTrimToEdges()));
+    action->setObjectName("ModifyTrimToEdges");
+    action->setData("trimedges, te");
+    a_map["ModifyTrimToEdges"] = action;
+
     action = new QAction(tr("O&ffset"),agm->modify);
     action->setIcon(QIcon(":/icons/offset.svg"));
     connect(action, SIGNAL(triggered()),
@@ -851,6 +859,12 @@ void LC_ActionFactory::fillActionContainer(QMap<QString, QAction*>& a_map, LC_Ac
     action->setObjectName("ModifyExplodeText");
     a_map["ModifyExplodeText"] = action;
 
+    action = new QAction(tr("Delete D&uplicates"), agm->modify);
+    connect(action, SIGNAL(triggered()),
+    action_handler, SLOT(slotModifyOverkill()));
+    action->setObjectName("ModifyOverkill");
+    a_map["ModifyOverkill"] = action;
+
     action = new QAction(tr("Ex&plode"), agm->modify);
     action->setIcon(QIcon(":/icons/explode.svg"));
     connect(action, SIGNAL(triggered()),
@@ -1566,6 +1580,18 @@ void LC_ActionFactory::commonActions(QMap<QString, QAction*>& a_map, LC_ActionGr
     action->setObjectName("FileOpen");
     a_map["FileOpen"] = action;
 
+    action = new QAction(tr("Open &Partially..."), agm->file);
+    action->setIcon(QIcon(":/icons/open.svg"));
+    connect(action, SIGNAL(triggered()), main_window, SLOT(slotFileOpenPartial()));
+    action->setObjectName("FileOpenPartial");
+    a_map["FileOpenPartial"] = action;
+
+    action = new QAction(tr("Open &Read-Only..."), agm->file);
+    action->setIcon(QIcon(":/icons/open.svg"));
+    connect(action, SIGNAL(triggered()), main_window, SLOT(slotFileOpenReadOnly()));
+    action->setObjectName("FileOpenReadOnly");
+    a_map["FileOpenReadOnly"] = action;
+
     action = new QAction(tr("&Save"), agm->file);
     if (using_theme)
         action->setIcon(QIcon::fromTheme("document-save", QIcon(":/icons/save.svg")));
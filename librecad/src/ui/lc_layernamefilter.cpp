@@ -0,0 +1,167 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include <QMetaObject>
+
+#include "lc_layernamefilter.h"
+
+namespace {
+
+// delay after the last pattern change, in milliseconds
+constexpr int debounceDelay = 250;
+// fewer names are matched by the calling thread
+constexpr int parallelNamesMinimum = 5000;
+
+bool isLiteral(const QString &text, const QString &specialCharacters)
+{
+    for (const QChar c: text) {
+        if (specialCharacters.contains(c))
+            return false;
+    }
+    return true;
+}
+
+QSet<QString> collectMatches(const QStringList &candidates, const QRegularExpression &expression)
+{
+    QSet<QString> result;
+    for (const QString &name: candidates) {
+        if (expression.match(name).hasMatch())
+            result.insert(name);
+    }
+    return result;
+}
+
+} // namespace
+
+LC_LayerNameFilter::LC_LayerNameFilter(Syntax filterSyntax, QObject *parent):
+    QObject(parent)
+    , syntax{filterSyntax}
+{
+    debounceTimer.setSingleShot(true);
+    debounceTimer.setInterval(debounceDelay);
+    connect(&debounceTimer, &QTimer::timeout, this, &LC_LayerNameFilter::startMatching);
+    pool.setMaxThreadCount(1);
+}
+
+LC_LayerNameFilter::~LC_LayerNameFilter(){
+    ++generation;
+    pool.waitForDone();
+}
+
+void LC_LayerNameFilter::setNames(const QStringList &layerNames){
+    if (layerNames == names)
+        return;
+    names = layerNames;
+    nameSet = QSet<QString>(names.cbegin(), names.cend());
+    matchesValid = false;
+    ++generation;
+}
+
+void LC_LayerNameFilter::setPattern(const QString &patternText){
+    if (patternText == pattern && matchesValid)
+        return;
+    pattern = patternText;
+    expression = createExpression(pattern);
+    ++generation;
+    if (pattern.isEmpty()){
+        // everything matches, no need to wait
+        debounceTimer.stop();
+        emit matched();
+    } else {
+        debounceTimer.start();
+    }
+}
+
+bool LC_LayerNameFilter::matches(const QString &name) const{
+    if (pattern.isEmpty())
+        return true;
+    if (matchesValid && matchedPattern == pattern && nameSet.contains(name))
+        return matchedNames.contains(name);
+    return expression.match(name).hasMatch();
+}
+
+QRegularExpression LC_LayerNameFilter::createExpression(const QString &patternText) const{
+    if (syntax == Wildcard)
+        return QRegularExpression::fromWildcard(patternText);
+    return QRegularExpression(patternText);
+}
+
+/**
+ * Whether all matches of the next pattern are matches of the previous one, so
+ * only the previous matches are to be matched again
+ */
+bool LC_LayerNameFilter::narrows(const QString &previous, const QString &next) const{
+    if (previous.isEmpty())
+        return false;
+    if (syntax == Wildcard){
+        // names starting with a longer text
+        static const QString special = "*?[]\\";
+        return previous.endsWith('*') && next.endsWith('*')
+               && isLiteral(previous.chopped(1), special) && isLiteral(next.chopped(1), special)
+               && next.startsWith(previous.chopped(1));
+    }
+    // names containing a longer text
+    static const QString special = "\\^$.|?*+()[]{}";
+    return isLiteral(previous, special) && isLiteral(next, special) && next.contains(previous);
+}
+
+void LC_LayerNameFilter::startMatching(){
+    if (pattern.isEmpty() || !expression.isValid()){
+        matchedNames.clear();
+        matchedPattern = pattern;
+        matchesValid = true;
+        emit matched();
+        return;
+    }
+
+    QStringList candidates = names;
+    if (matchesValid && narrows(matchedPattern, pattern))
+        candidates = QStringList(matchedNames.cbegin(), matchedNames.cend());
+
+    const unsigned matchGeneration = generation;
+    const QString currentPattern = pattern;
+    if (candidates.size() < parallelNamesMinimum){
+        setMatches(matchGeneration, currentPattern, collectMatches(candidates, expression));
+        return;
+    }
+    // the GUI stays responsive while the worker matches
+    const QRegularExpression currentExpression = expression;
+    pool.start([this, matchGeneration, currentPattern, candidates, currentExpression]() {
+        const QSet<QString> result = collectMatches(candidates, currentExpression);
+        QMetaObject::invokeMethod(this, [this, matchGeneration, currentPattern, result]() {
+            setMatches(matchGeneration, currentPattern, result);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void LC_LayerNameFilter::setMatches(unsigned matchGeneration, const QString &currentPattern,
+                                    const QSet<QString> &result){
+    if (matchGeneration != generation)
+        return;
+    matchedPattern = currentPattern;
+    matchedNames = result;
+    matchesValid = true;
+    emit matched();
+}
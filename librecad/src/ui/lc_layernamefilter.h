@@ -0,0 +1,101 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_LAYERNAMEFILTER_H
+#define LC_LAYERNAMEFILTER_H
+
+#include <QObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+/**
+ * Filter of layer names, for the filter boxes of the layer widgets.
+ *
+ * Pattern changes are debounced, the matching names are collected by a worker
+ * thread for long layer lists and signalled by matched(). If a pattern only
+ * extends the previous one, the previous matches are narrowed instead of matching
+ * all names again.
+ */
+class LC_LayerNameFilter: public QObject {
+    Q_OBJECT
+
+public:
+    enum Syntax {
+        // the whole name matches the wildcard pattern
+        Wildcard,
+        // a part of the name matches the regular expression
+        RegularExpression
+    };
+
+    LC_LayerNameFilter(Syntax syntax, QObject *parent = nullptr);
+    ~LC_LayerNameFilter() override;
+
+    /**
+     * @brief setNames sets names of the layers, the matches are kept for the same names
+     */
+    void setNames(const QStringList &names);
+    /**
+     * @brief setPattern sets the pattern, the names are matched after the debounce delay
+     */
+    void setPattern(const QString &pattern);
+    const QString &getPattern() const {return pattern;}
+    bool isEmpty() const {return pattern.isEmpty();}
+    /**
+     * @brief matches whether the name matches the pattern. Names other than the names
+     * set are matched directly
+     */
+    bool matches(const QString &name) const;
+
+signals:
+    //! the names are matched to current pattern
+    void matched();
+
+private:
+    void startMatching();
+    void setMatches(unsigned matchGeneration, const QString &matchedPattern, const QSet<QString> &names);
+    bool narrows(const QString &previous, const QString &next) const;
+    QRegularExpression createExpression(const QString &patternText) const;
+
+    Syntax syntax;
+    QString pattern;
+    QRegularExpression expression;
+    QStringList names;
+    QSet<QString> nameSet;
+
+    // matches of the pattern, valid for the names
+    QString matchedPattern;
+    QSet<QString> matchedNames;
+    bool matchesValid {false};
+
+    QTimer debounceTimer;
+    QThreadPool pool;
+    // increased by new patterns and names, results of older matches are dropped
+    unsigned generation {0};
+};
+
+#endif // LC_LAYERNAMEFILTER_H
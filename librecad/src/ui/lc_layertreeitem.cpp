@@ -22,6 +22,8 @@
 **
 **********************************************************************/
 
+#include <utility>
+
 #include "lc_layertreeitem.h"
 
 LC_LayerTreeItem::LC_LayerTreeItem(LC_LayerTreeItem *parent):
@@ -44,6 +46,33 @@ void LC_LayerTreeItem::appendChild(LC_LayerTreeItem *item){
     childItems.append(item);
 }
 
+void LC_LayerTreeItem::insertChild(int row, LC_LayerTreeItem *item){
+    childItems.insert(row, item);
+}
+
+/**
+ * Removes the child from this item, without deleting it
+ * @param row row of the child
+ * @return the removed child
+ */
+LC_LayerTreeItem *LC_LayerTreeItem::takeChild(int row){
+    return childItems.takeAt(row);
+}
+
+/**
+ * Finds the child of this item with given name, of any type
+ * @param childName child name
+ * @return item or nullptr if not found
+ */
+LC_LayerTreeItem *LC_LayerTreeItem::findChild(const QString &childName){
+    for (LC_LayerTreeItem *child: std::as_const(childItems)) {
+        if (child->name == childName){
+            return child;
+        }
+    }
+    return nullptr;
+}
+
 LC_LayerTreeItem *LC_LayerTreeItem::child(int row){
     return childItems.value(row);
 }
@@ -101,6 +130,19 @@ void LC_LayerTreeItem::sortChildren(){
  * value of this flag is true for all children of the item.
  */
 void LC_LayerTreeItem::updateCalculatedFlagsForDescendentVirtualLayers(){
+    if (isVirtual()){
+        int count = childItems.length();
+        for (int i = 0; i < count; i++) {
+            childItems.at(i)->updateCalculatedFlagsForDescendentVirtualLayers();
+        }
+        updateCalculatedFlags();
+    }
+}
+/**
+ * Calculates virtual flags for virtual layer from the flags of its children, without
+ * updating the children. Used for updating the parents of a changed item.
+ */
+void LC_LayerTreeItem::updateCalculatedFlags(){
     if (isVirtual()){
         int count = childItems.length();
         virtualConstruction = true;
@@ -109,7 +151,6 @@ void LC_LayerTreeItem::updateCalculatedFlagsForDescendentVirtualLayers(){
         virtualVisible = true;
         for (int i = 0; i < count; i++) {
             LC_LayerTreeItem *child = childItems.at(i);
-            child->updateCalculatedFlagsForDescendentVirtualLayers();
 
             virtualConstruction &= child->isConstruction();
             virtualVisible = virtualVisible && child->isVisible();
@@ -366,16 +407,7 @@ LC_LayerTreeItem *LC_LayerTreeItem::findPrimaryLayerChild(QString &childNameToFi
  * @return virtual child with given name
  */
 LC_LayerTreeItem *LC_LayerTreeItem::getOrCreateVirtualChild(QString &targetChildName){
-    LC_LayerTreeItem *result = nullptr;
-    int count = childItems.length();
-    for (int i = 0; i < count; i++) {
-        LC_LayerTreeItem *child = childItems.at(i);
-        QString childName = child->getName();
-        if (targetChildName == childName){
-            result = child;
-            break;
-        }
-    }
+    LC_LayerTreeItem *result = findChild(targetChildName);
     if (result == nullptr){
         result = new LC_LayerTreeItem(targetChildName, nullptr, this);
         result->setLayerType(VIRTUAL);
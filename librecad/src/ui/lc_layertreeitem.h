@@ -69,6 +69,9 @@ public:
     ~LC_LayerTreeItem();
 
     void appendChild(LC_LayerTreeItem *child);
+    void insertChild(int row, LC_LayerTreeItem *child);
+    LC_LayerTreeItem *takeChild(int row);
+    LC_LayerTreeItem *findChild(const QString &childName);
 
     LC_LayerTreeItem *child(int row);
     int childCount() const;
@@ -86,6 +89,7 @@ public:
     void setDisplayName(QString &newName){displayName = newName;};
     RS_Layer* getLayer();
     void updateCalculatedFlagsForDescendentVirtualLayers();
+    void updateCalculatedFlags();
     LC_LayerTreeItem* createLayerChild(QString &childName, RS_Layer* childLayer);
     LC_LayerTreeItem* getOrCreateVirtualChild(QString &targetChildName);
     int getIndent() const { return indent;};
@@ -22,6 +22,9 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <utility>
+
 #include <QColor>
 
 #include "lc_layertreemodel.h"
@@ -140,6 +143,9 @@ void LC_LayerTreeModel::setLayerList(RS_LayerList* ll) {
     delete rootItem;
 
     rootItem = new LC_LayerTreeItem();
+    layerItems.clear();
+    layerNames.clear();
+    activeItem = nullptr;
 
     if (ll == nullptr) {
         endResetModel();
@@ -203,10 +209,6 @@ void LC_LayerTreeModel::reset(){
 
 void LC_LayerTreeModel::rebuildModel(QList<RS_Layer*> &listLayer, RS_Layer* activeLayer){
 
-    int alternatePositionLayerNameSuffixLen = options->alternatePositionLayerNameSuffix.length();
-    int informationLayerNameSuffixLen = options->informationalLayerNameSuffix.length();
-    int dimensionalLayerNameSuffixLen = options->dimensionalLayerNameSuffix.length();
-
     int number = 0;
 
     int layersCount = listLayer.count();
@@ -224,8 +226,12 @@ void LC_LayerTreeModel::rebuildModel(QList<RS_Layer*> &listLayer, RS_Layer* acti
 
         bool hasRegexpMatch = false;
         if (hasRegexp){
-            int pos = 0;
-            hasRegexpMatch =filteringRegexp.match(layerName, pos).hasMatch();
+            if (nameFilter != nullptr && nameFilter->getPattern() == filteringRegexp.pattern()){
+                hasRegexpMatch = nameFilter->matches(layerName);
+            } else {
+                int pos = 0;
+                hasRegexpMatch = filteringRegexp.match(layerName, pos).hasMatch();
+            }
 
             if (regexpHighlightMode){
                 // we'll highlight it later based on the flag
@@ -272,37 +278,7 @@ void LC_LayerTreeModel::rebuildModel(QList<RS_Layer*> &listLayer, RS_Layer* acti
         QString primaryLayerName = "";
 
         // check whether it's helper layer (dimensions, info, alternate position) so we try to find primary layer for this (without _pos)
-
-        int type = LC_LayerTreeItem::NORMAL;
-
-        // determining level item type, name and position based on naming.
-        // TODO - actually, a more flexible and generic policy may be used there, and so it will allow to
-        // support additional types of layers... however, not sure that it is necessary at the moment
-
-        if (layerName.endsWith(options->alternatePositionLayerNameSuffix)){
-            type = LC_LayerTreeItem::ALTERNATE_POSITION;
-            QString mainName =  layerName.left(layerName.length() - alternatePositionLayerNameSuffixLen);
-            primaryLayerName = mainName;
-            if (!flatMode){
-              layerName = mainName;
-            }
-        }
-        else if (layerName.endsWith(options->informationalLayerNameSuffix)){
-            type = LC_LayerTreeItem::INFORMATIONAL;
-            QString mainName = layerName.left(layerName.length() - informationLayerNameSuffixLen);
-            primaryLayerName = mainName;
-            if (!flatMode){
-               layerName = mainName;
-            }
-        }
-        else if (layerName.endsWith(options->dimensionalLayerNameSuffix)){
-            type = LC_LayerTreeItem::DIMENSIONAL;
-            QString mainName = layerName.left(layerName.length() - dimensionalLayerNameSuffixLen);
-            primaryLayerName = mainName;
-            if (!flatMode){
-                layerName = mainName;
-            }
-        }
+        int type = detectLayerType(layerName, primaryLayerName);
 
         LC_LayerTreeItem* primaryLayerItem = nullptr;
         if (primaryLayerName.length() > 0){
@@ -345,15 +321,217 @@ void LC_LayerTreeModel::rebuildModel(QList<RS_Layer*> &listLayer, RS_Layer* acti
         // if we're here and flag is matched, we are in highlight mode, always false for filtering mode
         layerItem->setMatched(hasRegexpMatch);
 
+        layerItems.insert(layer, layerItem);
+        layerNames.insert(layer, layerFullName);
+
         // go up and mark all parent items up to the root as active path items
         if (layer == activeLayer){
             layerItem->setActiveLayer(true);
             layerItem->markAsActivePath();
+            activeItem = layerItem;
         }
         number++;
     }
 }
 
+/**
+ * Determines the type of layer by the suffix of its name. For secondary layers
+ * (dimensions, info, alternate position) the name of the primary layer is
+ * returned, and the suffix is removed from the name in tree mode.
+ * @param layerName last part of layer name
+ * @param primaryLayerName name of primary layer, for secondary layers
+ * @return layer type
+ */
+int LC_LayerTreeModel::detectLayerType(QString &layerName, QString &primaryLayerName) const{
+    // TODO - actually, a more flexible and generic policy may be used there, and so it will allow to
+    // support additional types of layers... however, not sure that it is necessary at the moment
+    const std::pair<const QString&, int> suffixes[] = {
+        {options->alternatePositionLayerNameSuffix, LC_LayerTreeItem::ALTERNATE_POSITION},
+        {options->informationalLayerNameSuffix, LC_LayerTreeItem::INFORMATIONAL},
+        {options->dimensionalLayerNameSuffix, LC_LayerTreeItem::DIMENSIONAL}
+    };
+    for (const auto &[suffix, type]: suffixes) {
+        if (layerName.endsWith(suffix)){
+            primaryLayerName = layerName.left(layerName.length() - suffix.length());
+            if (!flatMode){
+                layerName = primaryLayerName;
+            }
+            return type;
+        }
+    }
+    return LC_LayerTreeItem::NORMAL;
+}
+
+/**
+ * Updates the item of the layer after changes of its flags or attributes, and the virtual
+ * parents of the item. A renamed layer is moved to its new position.
+ * @param layer changed layer, nullptr if several layers are changed
+ * @return false, if the item is not found and the model should be rebuilt
+ */
+bool LC_LayerTreeModel::updateLayer(RS_Layer *layer){
+    if (layer == nullptr){
+        updateFlags();
+        return true;
+    }
+    LC_LayerTreeItem *item = layerItems.value(layer);
+    if (item == nullptr){
+        return false;
+    }
+    if (layerNames.value(layer) != layer->getName()){
+        return removeLayer(layer) && addLayer(layer);
+    }
+    emitItemPathChanged(item);
+    return true;
+}
+
+/**
+ * Inserts item for added layer, if its parent items are present already.
+ * @param layer added layer
+ * @return false, if the structure of the tree changes and the model should be rebuilt
+ */
+bool LC_LayerTreeModel::addLayer(RS_Layer *layer){
+    if (layer == nullptr || hasRegexp || layerItems.contains(layer)){
+        return false;
+    }
+
+    QString layerFullName = layer->getName();
+    QString layerName = layerFullName;
+    LC_LayerTreeItem *parentItem = rootItem;
+    if (!flatMode){
+        QStringList nameParts = layerFullName.split(options->layerLevelSeparator, Qt::KeepEmptyParts);
+        for (int indent = 0; indent < nameParts.count() - 1; ++indent){
+            parentItem = parentItem->findChild(nameParts.at(indent));
+            if (parentItem == nullptr){
+                // new virtual items are needed
+                return false;
+            }
+        }
+        if (!nameParts.isEmpty()){
+            layerName = nameParts.last();
+        }
+    }
+
+    QString primaryLayerName = "";
+    int type = detectLayerType(layerName, primaryLayerName);
+
+    // an item of the same name, or secondary items without primary one, would be restructured
+    for (int i = 0; i < parentItem->childCount(); i++){
+        LC_LayerTreeItem *child = parentItem->child(i);
+        QString childName = child->getName();
+        if (childName == layerName || (type == LC_LayerTreeItem::NORMAL && child->getPrimaryItem() == nullptr &&
+                                       child->getLayerType() > LC_LayerTreeItem::NORMAL && childName.startsWith(layerName))){
+            return false;
+        }
+    }
+
+    LC_LayerTreeItem *primaryLayerItem = nullptr;
+    if (primaryLayerName.length() > 0){
+        primaryLayerItem = parentItem->findPrimaryLayerChild(primaryLayerName);
+    }
+    if (primaryLayerItem != nullptr && !flatMode){
+        parentItem = primaryLayerItem;
+    }
+
+    // children are sorted by names
+    int row = 0;
+    while (row < parentItem->childCount() && !(layerName < parentItem->child(row)->getName())){
+        row++;
+    }
+
+    beginInsertRows(indexForItem(parentItem, 0), row, row);
+    auto *layerItem = new LC_LayerTreeItem(layerName, layer, parentItem);
+    parentItem->insertChild(row, layerItem);
+    layerItem->setLayerType(type);
+    if ("0" == layerFullName){
+        layerItem->markAsZero();
+    }
+    layerItem->setPrimaryItem(primaryLayerItem);
+    maxIndent = std::max(maxIndent, layerItem->getIndent());
+    setupDisplayNames(layerItem);
+    layerItems.insert(layer, layerItem);
+    layerNames.insert(layer, layerFullName);
+    endInsertRows();
+
+    emitItemPathChanged(layerItem);
+    return true;
+}
+
+/**
+ * Removes item of removed layer, if it has no children and is not the last child of virtual item
+ * @param layer removed layer
+ * @return false, if the structure of the tree changes and the model should be rebuilt
+ */
+bool LC_LayerTreeModel::removeLayer(RS_Layer *layer){
+    LC_LayerTreeItem *layerItem = layerItems.value(layer);
+    if (layerItem == nullptr){
+        // filtered out layers have no items
+        return hasRegexp;
+    }
+    LC_LayerTreeItem *parentItem = layerItem->parent();
+    if (layerItem->childCount() > 0 || layerItem == currentlyDraggingItem ||
+        (parentItem != rootItem && parentItem->isVirtual() && parentItem->childCount() == 1)){
+        return false;
+    }
+    // in flat mode secondary items refer to primary siblings
+    for (int i = 0; i < parentItem->childCount(); i++){
+        if (parentItem->child(i)->getPrimaryItem() == layerItem){
+            return false;
+        }
+    }
+
+    int row = layerItem->row();
+    beginRemoveRows(indexForItem(parentItem, 0), row, row);
+    delete parentItem->takeChild(row);
+    layerItems.remove(layer);
+    layerNames.remove(layer);
+    if (activeItem == layerItem){
+        activeItem = nullptr;
+    }
+    endRemoveRows();
+
+    if (parentItem != rootItem){
+        emitItemPathChanged(parentItem);
+    } else {
+        rootItem->updateCalculatedFlags();
+    }
+    return true;
+}
+
+/**
+ * Recalculates flags of virtual items after changes of several layers, and repaints the items
+ */
+void LC_LayerTreeModel::updateFlags(){
+    rootItem->updateCalculatedFlagsForDescendentVirtualLayers();
+    int rows = rootItem->childCount();
+    if (rows > 0){
+        emit dataChanged(index(0, 0, QModelIndex()), index(rows - 1, columnCount(QModelIndex()) - 1, QModelIndex()));
+    }
+}
+
+/**
+ * Recalculates flags of virtual parents of changed item, and notifies views about changes
+ * of the item and of its parents
+ * @param item changed item
+ */
+void LC_LayerTreeModel::emitItemPathChanged(LC_LayerTreeItem *item){
+    int lastColumn = columnCount(QModelIndex()) - 1;
+    for (LC_LayerTreeItem *pathItem = item; pathItem != nullptr && pathItem != rootItem; pathItem = pathItem->parent()){
+        pathItem->updateCalculatedFlags();
+        emit dataChanged(indexForItem(pathItem, 0), indexForItem(pathItem, lastColumn));
+    }
+    rootItem->updateCalculatedFlags();
+}
+
+/**
+ * Model index for the item, invalid index for root item
+ */
+QModelIndex LC_LayerTreeModel::indexForItem(LC_LayerTreeItem *item, int column) const{
+    if (item == nullptr || item == rootItem){
+        return QModelIndex();
+    }
+    return createIndex(item->row(), column, item);
+}
+
 /**
  * Method calculates display name (that will be shown in UI) for given item as well as full path to the item
  * @param item layer tree item
@@ -755,7 +933,14 @@ void LC_LayerTreeModel::proceedActiveLayerChanged(RS_LayerList* ll) {
         return;
     RS_Layer* activeLayer = ll->getActive();
     // remark items for active layer (without rebuilding entire model)
+    LC_LayerTreeItem *previousItem = activeItem;
     rootItem->rebuildActivePath(activeLayer);
+    activeItem = layerItems.value(activeLayer);
+    // repaint the previous and the new paths
+    if (previousItem != activeItem){
+        emitItemPathChanged(previousItem);
+        emitItemPathChanged(activeItem);
+    }
 }
 
  /**
@@ -1023,15 +1208,7 @@ void LC_LayerTreeModel::emitDataChanged(){
  * @return tree item that stores target level
  */
 LC_LayerTreeItem* LC_LayerTreeModel::getItemForLayer(RS_Layer* layer) const{
-    QG_LayerTreeItemAcceptorSameLayerAs ACCEPT_SAME(layer);
-    QList<LC_LayerTreeItem*> items;
-    rootItem->collectDescendantChildren(items, &ACCEPT_SAME, false);
-
-    LC_LayerTreeItem* result = nullptr;
-    if (items.size() == 1){ // only 1 result expected to be returned.
-        result = items.at(0);
-    }
-    return result;
+    return layerItems.value(layer);
 }
 
 /**
@@ -26,11 +26,13 @@
 #define LC_LAYERTREEMODEL_H
 
 #include <QAbstractTableModel>
+#include <QHash>
 #include <QIcon>
 #include <QItemSelection>
 #include <QRegularExpression>
 #include <QWidget>
 
+#include "lc_layernamefilter.h"
 #include "lc_layertreeitem.h"
 #include "lc_layertreemodel_options.h"
 #include "rs_layer.h"
@@ -58,10 +60,19 @@ public:
     QModelIndex index(int row, int column, const QModelIndex &parent) const override;
     void setLayerList(RS_LayerList *ll);
     void proceedActiveLayerChanged(RS_LayerList *ll);
+    // incremental updates for changes of single layers, false if the model should be rebuilt
+    bool updateLayer(RS_Layer *layer);
+    bool addLayer(RS_Layer *layer);
+    bool removeLayer(RS_Layer *layer);
     QList<RS_Layer *> collectLayers(LC_LayerTreeItemAcceptor *acceptor);
     QModelIndexList getPersistentIndexList();
     LC_LayerTreeItem *getRoot(){return rootItem;};
     void setFilteringRegexp(QString &reqgexp, bool highlightMode);
+    /**
+     * @brief setNameFilter filter with the matches of the filtering regexp, used instead of
+     * matching each layer name while the model is rebuilt
+     */
+    void setNameFilter(const LC_LayerNameFilter *filter){nameFilter = filter;}
     Qt::DropActions supportedDropActions() const override{return Qt::CopyAction | Qt::MoveAction;}
     void setCurrentlyDraggingItem(LC_LayerTreeItem *item);
     LC_LayerTreeItem *getCurrentlyDraggingItem();
@@ -88,6 +99,10 @@ private:
     QHash<RS_Layer *, RS_Layer *> doCreateLayersCopy(LC_LayerTreeItem *source, bool includeChildren, int newLayerType);
     bool renameLayers(QList<LC_LayerTreeItem *> layersList, QString &fromNamePrefix, QString &toNamePrefix);
     void emitDataChanged();
+    void emitItemPathChanged(LC_LayerTreeItem *item);
+    void updateFlags();
+    QModelIndex indexForItem(LC_LayerTreeItem *item, int column) const;
+    int detectLayerType(QString &layerName, QString &primaryLayerName) const;
     QString generateLayersPathString(QList<LC_LayerTreeItem *> items, bool alternateName, QString &alternativeName);
     QString restoreNamePart(QString name, int layerType);
     void setupDisplayNames(LC_LayerTreeItem *item);
@@ -127,6 +142,9 @@ private:
     // flat that controls whether regexp should be applied
     bool hasRegexp{false};
 
+    // matches of the filtering regexp, if set
+    const LC_LayerNameFilter *nameFilter{nullptr};
+
     //  controls whether items matched to regexp are just highlighted or filtered
     bool regexpHighlightMode{true};
 
@@ -136,6 +154,12 @@ private:
     // root item for layers hierarchy
     LC_LayerTreeItem *rootItem = nullptr;
 
+    // items and names of the layers in the model, for updating items without walking the tree
+    QHash<RS_Layer *, LC_LayerTreeItem *> layerItems;
+    QHash<RS_Layer *, QString> layerNames;
+    // item of active layer, if any
+    LC_LayerTreeItem *activeItem = nullptr;
+
     bool flatMode{false};
 
     LC_LayerTreeModelOptions* options = nullptr;
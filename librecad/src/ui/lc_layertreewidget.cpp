@@ -34,6 +34,7 @@
 #include <QtWidgets>
 
 #include "lc_layerdialog_ex.h"
+#include "lc_regenstatistics.h"
 #include "lc_layertreeitem.h"
 #include "lc_layertreemodel_options.h"
 #include "lc_layertreeoptionsdialog.h"
@@ -146,11 +147,15 @@ QLayout *LC_LayerTreeWidget::initFilterAndSettingsSection(){
     matchLayerName->setToolTip(tr("Looking for matching layer names"));
     connect(matchLayerName, &QLineEdit::textChanged, this, &LC_LayerTreeWidget::slotFilteringMaskChanged);
 
+    // typing is debounced, the tree is rebuilt once the names are matched
+    nameFilter = new LC_LayerNameFilter(LC_LayerNameFilter::RegularExpression, this);
+    connect(nameFilter, &LC_LayerNameFilter::matched, this, &LC_LayerTreeWidget::slotFilteringMaskMatched);
+
     // TODO - in general, it is possible to use persistent settings for the state, yet not sure it is reasonable
     matchModeCheckBox = new QCheckBox(this);
     matchModeCheckBox->setText(tr("Highlight Mode"));
     matchModeCheckBox->setChecked(true);
-    connect(matchModeCheckBox, &QCheckBox::clicked, this, &LC_LayerTreeWidget::slotFilteringMaskChanged);
+    connect(matchModeCheckBox, &QCheckBox::clicked, this, &LC_LayerTreeWidget::slotFilteringMaskMatched);
 
     layFiltering->addWidget(matchLayerName);
     layFiltering->addWidget(matchModeCheckBox);
@@ -359,7 +364,6 @@ void LC_LayerTreeWidget::update(){
     } else {
         // complete rebuild of the model and update of UI
         int yPos = layerTreeView->verticalScrollBar()->value();
-        layerTreeView->verticalScrollBar()->setValue(yPos);
 
         QStringList treeExpansionState = layerTreeView->saveTreeExpansionState();
 
@@ -369,6 +373,8 @@ void LC_LayerTreeWidget::update(){
         if (!treeExpansionState.isEmpty()){
             layerTreeView->restoreTreeExpansionState(treeExpansionState);
         }
+        // the scroll position after the items are expanded again
+        layerTreeView->verticalScrollBar()->setValue(yPos);
 
         layerTreeView->viewport()->update();
     }
@@ -388,7 +394,8 @@ void LC_LayerTreeWidget::activateLayer(RS_Layer *layer){
     }
 
     layerList->activate(layer, false);
-    update();
+    // only the active paths are changed
+    layerTreeModel->proceedActiveLayerChanged(layerList);
     layerTreeView->viewport()->update();
 
     //update active layer name in main window status bar
@@ -632,13 +639,30 @@ void LC_LayerTreeWidget::slotTreeClicked(QModelIndex layerIdx /*const QString& l
 
 // ----------  Filtering mask
 /**
- * Called when reg-expression matchLayerName->text or match mode check box changed.
- * Simply notifies model about filtering change and updates model and ui
+ * Called when reg-expression matchLayerName->text changed.
+ * Passes the mask to the name filter, which matches layer names after typing pauses
  */
 void LC_LayerTreeWidget::slotFilteringMaskChanged(){
-    QString mask = matchLayerName->text();
+    QStringList names;
+    if (layerList != nullptr){
+        names.reserve(layerList->count());
+        for (RS_Layer *layer: *layerList) {
+            names << layer->getName();
+        }
+    }
+    nameFilter->setNames(names);
+    nameFilter->setPattern(matchLayerName->text());
+}
+
+/**
+ * Called when layer names are matched to the mask or match mode check box changed.
+ * Simply notifies model about filtering change and updates model and ui
+ */
+void LC_LayerTreeWidget::slotFilteringMaskMatched(){
+    QString mask = nameFilter->getPattern();
     bool highlightMode = matchModeCheckBox->isChecked();
     layerTreeModel->setFilteringRegexp(mask, highlightMode);
+    layerTreeModel->setNameFilter(nameFilter);
     update();
 }
 
@@ -1012,38 +1036,53 @@ void LC_LayerTreeWidget::layerActivated(RS_Layer *layer){
     activateLayer(layer);
 }
 
-void LC_LayerTreeWidget::layerAdded([[maybe_unused]] RS_Layer *layer){
+/**
+ * Updates the model for the changed layer by changes of its items only, and
+ * rebuilds the model if the structure of the tree is changed.
+ * @param layer changed layer, nullptr for several layers
+ */
+void LC_LayerTreeWidget::updateLayer(RS_Layer *layer){
+    if (layerList == nullptr || !layerTreeModel->updateLayer(layer)){
+        update();
+    }
+}
+
+void LC_LayerTreeWidget::layerAdded(RS_Layer *layer){
     RS_DEBUG->print("QG_LayerWidget::layerAdded() begin");
-    update();
+    if (layerList == nullptr || !layerTreeModel->addLayer(layer)){
+        update();
+    }
 }
 
-void LC_LayerTreeWidget::layerEdited(RS_Layer *){
+void LC_LayerTreeWidget::layerEdited(RS_Layer *layer){
     RS_DEBUG->print("LC_LayerTreeWidget::layerEdited()");
-    update();
+    updateLayer(layer);
     layerTreeView->viewport()->update();
 }
 
-void LC_LayerTreeWidget::layerRemoved(RS_Layer *){
+void LC_LayerTreeWidget::layerRemoved(RS_Layer *layer){
     RS_DEBUG->print("LC_LayerTreeWidget::layerRemoved()");
-    update();
+    if (layerList == nullptr || !layerTreeModel->removeLayer(layer)){
+        update();
+    }
     activateLayer(layerList->at(0));
 }
 
-void LC_LayerTreeWidget::layerToggled(RS_Layer *){
+void LC_LayerTreeWidget::layerToggled(RS_Layer *layer){
     RS_DEBUG->print("LC_LayerTreeWidget::layerToggled()");
-    update();
+    updateLayer(layer);
 }
 
-void LC_LayerTreeWidget::layerToggledLock(RS_Layer *){
-    update();
+void LC_LayerTreeWidget::layerToggledLock(RS_Layer *layer){
+    updateLayer(layer);
 }
 
-void LC_LayerTreeWidget::layerToggledPrint(RS_Layer *){
-    update();
+void LC_LayerTreeWidget::layerToggledPrint(RS_Layer *layer){
+    updateLayer(layer);
 }
 
-void LC_LayerTreeWidget::layerToggledConstruction(RS_Layer *){
-    update();
+void LC_LayerTreeWidget::layerToggledConstruction(RS_Layer *layer){
+    updateLayer(layer);
 }
 // --------- Drag & Drop support ---
 /**
@@ -1479,13 +1518,23 @@ void LC_LayerTreeWidget::deselectEntities(RS_Layer *layer){
  */
 void LC_LayerTreeWidget::manageLayersVisibilityFlag(QList<RS_Layer *> &layersToEnable, QList<RS_Layer *> &layersToDisable, bool toggleMode){
     if (view){
+        LC_REGEN_REASON("toggle layers");
         if (toggleMode){
             layerList->toggleFreezeMulti(layersToEnable);
         } else {
             layerList->setFreezeMulti(layersToEnable, layersToDisable);
         }
-        document->updateInserts();
-        document->calculateBorders();
+        RS_Graphic* graphic = document->getGraphic();
+        if (graphic != nullptr){
+            // only borders depend on the visibility of layers
+            std::vector<RS_Layer*> toggled{layersToEnable.cbegin(), layersToEnable.cend()};
+            if (!toggleMode){
+                toggled.insert(toggled.end(), layersToDisable.cbegin(), layersToDisable.cend());
+            }
+            graphic->updateLayersVisibility(toggled);
+        } else {
+            document->calculateBorders();
+        }
     }
 }
 /**
@@ -1572,10 +1621,12 @@ void LC_LayerTreeWidget::doSelectLayersEntities(QList<RS_Layer *> &layers){
     // NOTE:  actually, the more correct location for this logic is RS_Selection class or something like that...
     // yet leave it for now here to reduce amount of codebase modifications.
 
-    for (auto en: *document) {
-        if (en && en->isVisible() && !en->isSelected() && (!(en->getLayer() && en->getLayer()->isLocked()))){
-            RS_Layer *l = en->getLayer(true);
-            if (l != nullptr && layers.contains(l)){
+    for (RS_Layer *layer: layers) {
+        if (layer == nullptr || layer->isLocked()){
+            continue;
+        }
+        for (auto en: document->getLayerEntities(layer)) {
+            if (en->isVisible() && !en->isSelected()){
                 if (view){
                     view->deleteEntity(en);
                 }
@@ -1780,6 +1831,7 @@ void LC_LayerTreeWidget::doRemoveLayerItems(QList<LC_LayerTreeItem *> &itemsToRe
  * @param layersToRemove list of layers to remove
  */
 void LC_LayerTreeWidget::doRemoveLayers(QList<RS_Layer *> &layersToRemove){
+    LC_REGEN_REASON("remove layers");
     for (auto layer: layersToRemove) {
         RS_Graphic *graphic = document->getGraphic();
         if (graphic){
@@ -37,6 +37,7 @@
 #include "rs_graphicview.h"
 #include "rs_layerlist.h"
 #include "rs_layerlistlistener.h"
+#include "lc_layernamefilter.h"
 #include "lc_layertreemodel.h"
 
 class QTreeView;
@@ -83,6 +84,7 @@ public slots:
     void slotTreeClicked(QModelIndex layerIdx);
     void slotTreeDoubleClicked(QModelIndex layerIdx);
     void slotFilteringMaskChanged();
+    void slotFilteringMaskMatched();
     void expandAllLayers();
     void collapseAllLayers();
     void collapseSecondaryLayers();
@@ -128,6 +130,7 @@ private:
     RS_LayerList *layerList = nullptr;
     QLineEdit *matchLayerName = nullptr;
     QCheckBox *matchModeCheckBox = nullptr;
+    LC_LayerNameFilter *nameFilter = nullptr;
     LC_LayerTreeView *layerTreeView = nullptr;
     LC_LayerTreeModel *layerTreeModel = nullptr;
     RS_GraphicView *view = nullptr;
@@ -153,6 +156,7 @@ private:
     LC_LayerTreeView *initTreeView();
 
     void updateToolBarButtons();
+    void updateLayer(RS_Layer *layer);
     void doConvertSelectedItemLayerToNewType(int newType);
     void deselectEntitiesOnLockedLayer(RS_Layer *layer);
     void deselectEntities(RS_Layer *layer);
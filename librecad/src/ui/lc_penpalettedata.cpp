@@ -21,7 +21,11 @@
 ** This copyright notice MUST APPEAR in all copies of the script!
 **
 **********************************************************************/
+#include <utility>
+
+#include <QCoreApplication>
 #include <QFile>
+#include <QSaveFile>
 #include <QTextStream>
 #include "lc_penpalettedata.h"
 /**
@@ -29,43 +33,96 @@
  */
 static const char *const PEN_DATA_FIELDS_SEPARATOR = ",";
 
+namespace {
+/**
+ * Writes pens lines to the file. The file is replaced only if all lines are written,
+ * so an interrupted save doesn't truncate the palette
+ */
+bool writeItemsLines(const QString &fileName, const QStringList &lines){
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)){
+        return false;
+    }
+    QTextStream out(&file);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
+    out.setEncoding(QStringConverter::Utf8);
+#else
+    out.setCodec("UTF-8");
+#endif
+    for (const QString &line: lines){
+        out << line;
+    }
+    out.flush();
+    return file.commit();
+}
+}
+
 LC_PenPaletteData::LC_PenPaletteData(LC_PenPaletteOptions *opts){
     options = opts;
+    saveTimer.setSingleShot(true);
+    saveTimer.setInterval(saveDelay);
+    connect(&saveTimer, &QTimer::timeout, this, &LC_PenPaletteData::startSave);
+    savePool.setMaxThreadCount(1);
+    // don't lose modifications which are not saved yet
+    if (QCoreApplication::instance() != nullptr){
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
+            if (saveTimer.isActive()){
+                saveItems();
+            }
+            savePool.waitForDone();
+        });
+    }
 }
 
 LC_PenPaletteData::~LC_PenPaletteData(){
+    if (saveTimer.isActive()){
+        saveItems();
+    }
+    savePool.waitForDone();
     qDeleteAll(persistentItems);
     persistentItems.clear();
 }
+
+/**
+ * Converts all pens to lines of the file
+ */
+QStringList LC_PenPaletteData::getItemsLines(){
+    QStringList result;
+    result.reserve(persistentItems.count());
+    for (LC_PenItem* item: std::as_const(persistentItems)){
+        result << toStringRepresentation(item);
+    }
+    return result;
+}
+
 /**
  * Saves list of pens in the underlying file.
  * The file format is CSV, each line represents one pen
  */
 bool LC_PenPaletteData::saveItems(){
-    QString fileName = options->pensFileName;
-    QFile file(fileName);
-    bool result = false;
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text)){
-        QTextStream out(&file);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
-        out.setEncoding(QStringConverter::Utf8);
-#else
-        out.setCodec("UTF-8");
-#endif
+    saveTimer.stop();
+    // an earlier delayed save should not overwrite this one
+    savePool.waitForDone();
+    return writeItemsLines(options->pensFileName, getItemsLines());
+}
 
-        // just convert each pen to string and store in file
-        int count = persistentItems.count();
-        for (int i= 0; i < count; i++){
-            LC_PenItem* item = persistentItems.at(i);
-            out << toStringRepresentation(item);
-        }
-        file.close();
-        result = true;
-    }
-    else{
-        // handle error later
-    }
-    return result;
+void LC_PenPaletteData::saveItemsLater(){
+    saveTimer.start();
+}
+
+/**
+ * Starts delayed save. Pens are converted to strings here, as items may be modified, the file is
+ * written by the worker
+ */
+void LC_PenPaletteData::startSave(){
+    const QString fileName = options->pensFileName;
+    const QStringList lines = getItemsLines();
+    savePool.start([this, fileName, lines]() {
+        const bool saved = writeItemsLines(fileName, lines);
+        QMetaObject::invokeMethod(this, [this, saved]() {
+            emit itemsSaved(saved);
+        }, Qt::QueuedConnection);
+    });
 }
 
 bool LC_PenPaletteData::loadItems(){
@@ -26,6 +26,9 @@
 
 #include <QObject>
 #include <QList>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
 
 #include "lc_penitem.h"
 #include "lc_penpaletteoptions.h"
@@ -46,9 +49,14 @@ public:
      */
     bool loadItems();
     /**
-     * Saves list to file
+     * Saves list to file, pending delayed save is completed too
      */
     bool saveItems();
+    /**
+     * Saves list to file after a delay, by a worker thread. Several modifications made
+     * within the delay are saved once. The result is reported by itemsSaved()
+     */
+    void saveItemsLater();
 
     /**
      * Removes given pen from the list
@@ -85,6 +93,11 @@ public:
 
 signals:
     void modelDataChange();
+    /**
+     * Emitted when delayed save is completed
+     * @param saved false if the file could not be written
+     */
+    void itemsSaved(bool saved);
 
 private:
     /**
@@ -114,6 +127,17 @@ private:
     void createDefaultPens();
     LC_PenItem *doCreateNewDefaultPenItem(QString penName, RS2::LineType lineType, RS2::LineWidth lineWidth, RS_Color color);
     void emitDataChange();
+    QStringList getItemsLines();
+    void startSave();
+    /**
+     * delay of save after the last modification, ms
+     */
+    static constexpr int saveDelay = 1000;
+    QTimer saveTimer;
+    /**
+     * single worker, so saves are written in order
+     */
+    QThreadPool savePool;
 };
 
 #endif // LC_PENPALETTEDATA_H
@@ -21,6 +21,10 @@
 ** This copyright notice MUST APPEAR in all copies of the script!
 **
 **********************************************************************/
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include <QFile>
 #include <QFont>
 #include <QRegularExpression>
@@ -32,6 +36,19 @@
 
 static int COLOR_ICON_SIZE = 24;
 
+namespace {
+bool lessByName(const LC_PenItem *s1, const LC_PenItem *s2){
+    return s1->getName() < s2->getName();
+}
+
+/**
+ * @return position of the given item in the list sorted by names, or the position to insert it
+ */
+int getSortedPosition(const QList<LC_PenItem*> &items, const LC_PenItem *item){
+    return int(std::lower_bound(items.cbegin(), items.cend(), item, lessByName) - items.cbegin());
+}
+}
+
 LC_PenPaletteModel::LC_PenPaletteModel(LC_PenPaletteOptions *modelOptions, LC_PenPaletteData* data, QObject * parent) :
     QAbstractTableModel(parent),
     m_filteringRegexp{std::make_unique<QRegularExpression>()}
@@ -66,53 +83,152 @@ void LC_PenPaletteModel::update(bool updateNames){
     beginResetModel();
     // remove all from items list
     displayItems.clear();
+    sortedItems.clear();
 
     // simply iterate by pens data
     int count = penPaletteData->getItemsCount();
+    sortedItems.reserve(count);
     for (int i=0; i < count; i++){
         LC_PenItem* item = penPaletteData->getItemAt(i);
-        QString itemName = item->getName();
-
-        if (hasRegexp){
-            // check whether filtering is case-sensitive
-            if (options->ignoreCaseOnMatch){
-                itemName = itemName.toLower();
-            }
-            QRegularExpressionMatch match = m_filteringRegexp->match(itemName);
-            bool hasRegexpMatch = match.hasMatch();
-            item->setMatched(hasRegexpMatch);
-
-            if (options->filterIsInHighlightMode){
-                // just add item into the list to display
-                displayItems << item;
-            } else if (hasRegexpMatch){
-                // add it item as highlighted
-                displayItems << item;
-            } else {
-                continue; // skip this item at all as it was not matched, so it will not be shown in the table
-            }
-        }
-        else{ // just add all items to display
-            displayItems << item;
-            item->setMatched(false);
-        }
-
         // names should be updated on initial build and after options change
         if (updateNames){
             setupItemForDisplay(item);
         }
+        sortedItems << item;
     }
 
-    // sort collected items alphabetically
-    std::sort(displayItems.begin(), displayItems.end(), [](const LC_PenItem *s1, const LC_PenItem *s2)-> bool{
-        return s1->getName() < s2->getName();
-    } );
+    // sort items alphabetically, once - filtering keeps that order
+    std::sort(sortedItems.begin(), sortedItems.end(), lessByName);
+
+    for (LC_PenItem* item: std::as_const(sortedItems)){
+        if (matchItem(item)){
+            displayItems << item;
+        }
+    }
 
     // notify that model was updated
     endResetModel();
     emitModelChange();
 }
 
+/**
+ * Matches the item against regexp (if any) and updates its matched flag
+ * @param item
+ * @return true if item should be displayed in the table
+ */
+bool LC_PenPaletteModel::matchItem(LC_PenItem *item) const{
+    if (!hasRegexp){
+        item->setMatched(false);
+        return true;
+    }
+    QString itemName = item->getName();
+    // check whether filtering is case-sensitive
+    if (options->ignoreCaseOnMatch){
+        itemName = itemName.toLower();
+    }
+    bool hasRegexpMatch = m_filteringRegexp->match(itemName).hasMatch();
+    item->setMatched(hasRegexpMatch);
+    // in highlight mode all items are shown, matched ones are just highlighted
+    return hasRegexpMatch || options->filterIsInHighlightMode;
+}
+
+/**
+ * Refilters items after change of regexp or filtering mode. Both sorted and displayed items are in
+ * the same order, so they are walked together and only runs of rows which changed their visibility
+ * are removed or inserted, without reset of the model and so without losing the selection.
+ */
+void LC_PenPaletteModel::applyFilter(){
+    int count = sortedItems.size();
+    std::vector<bool> shown(count);
+    for (int i = 0; i < count; i++){
+        shown[i] = matchItem(sortedItems.at(i));
+    }
+
+    int row = 0;
+    int i = 0;
+    while (i < count){
+        // the next displayed item is either the current one or one after it
+        bool displayed = row < displayItems.size() && displayItems.at(row) == sortedItems.at(i);
+        if (displayed == shown[i]){
+            if (displayed){
+                row++;
+            }
+            i++;
+            continue;
+        }
+        int last = i;
+        if (displayed){
+            // run of displayed items that are hidden now
+            while (last + 1 < count && !shown[last + 1] && row + last + 1 - i < displayItems.size()
+                   && displayItems.at(row + last + 1 - i) == sortedItems.at(last + 1)){
+                last++;
+            }
+            beginRemoveRows(QModelIndex(), row, row + last - i);
+            displayItems.erase(displayItems.begin() + row, displayItems.begin() + row + last - i + 1);
+            endRemoveRows();
+        } else {
+            // run of hidden items that are shown now
+            while (last + 1 < count && shown[last + 1]
+                   && !(row < displayItems.size() && displayItems.at(row) == sortedItems.at(last + 1))){
+                last++;
+            }
+            beginInsertRows(QModelIndex(), row, row + last - i);
+            for (int k = i; k <= last; k++){
+                displayItems.insert(row + k - i, sortedItems.at(k));
+            }
+            endInsertRows();
+            row += last - i + 1;
+        }
+        i = last + 1;
+    }
+
+    // highlighting of the rows that stayed might be changed
+    if (!displayItems.isEmpty()){
+        emit dataChanged(index(0, 0, QModelIndex()), index(displayItems.size() - 1, columnCount(QModelIndex()) - 1, QModelIndex()),
+                         {Qt::ForegroundRole});
+    }
+    emitModelChange();
+}
+
+/**
+ * Inserts the item into sorted items and, if it matches the filter, into displayed rows
+ * @param item
+ */
+void LC_PenPaletteModel::insertDisplayItem(LC_PenItem *item){
+    sortedItems.insert(getSortedPosition(sortedItems, item), item);
+    if (matchItem(item)){
+        int row = getSortedPosition(displayItems, item);
+        beginInsertRows(QModelIndex(), row, row);
+        displayItems.insert(row, item);
+        endInsertRows();
+    }
+}
+
+/**
+ * Removes the item from sorted and displayed items
+ * @param item
+ */
+void LC_PenPaletteModel::removeDisplayItem(LC_PenItem *item){
+    sortedItems.removeOne(item);
+    int row = displayItems.indexOf(item);
+    if (row >= 0){
+        beginRemoveRows(QModelIndex(), row, row);
+        displayItems.removeAt(row);
+        endRemoveRows();
+    }
+}
+
+/**
+ * Notifies views that the row of given item should be repainted
+ * @param item
+ */
+void LC_PenPaletteModel::notifyItemChanged(LC_PenItem *item){
+    int row = displayItems.indexOf(item);
+    if (row >= 0){
+        emit dataChanged(index(row, 0, QModelIndex()), index(row, columnCount(QModelIndex()) - 1, QModelIndex()));
+    }
+}
+
 /**
  * Sets regexp string that should be used for items filtering or highlighting. This is setter only,
  * does not updates the model.
@@ -406,9 +522,8 @@ void LC_PenPaletteModel::setupItemForDisplay(LC_PenItem *newPen){
 void LC_PenPaletteModel::addItem(LC_PenItem *item){
     setupItemForDisplay(item);
     penPaletteData->addItem(item);
-    activePen = item;
-    update(false);
-    emitModelChange();
+    insertDisplayItem(item);
+    setActivePen(item);
 }
 /**
  * Finds pen with given name. Name is expected to be unique
@@ -426,9 +541,27 @@ LC_PenItem *LC_PenPaletteModel::findPenForName(QString &name){
 void LC_PenPaletteModel::itemEdited(LC_PenItem* item){
     setupItemForDisplay(item);
     penPaletteData->itemEdited(item);
-    activePen = item;
-    update(false);
-    emitModelChange();
+
+    // the name might be changed, so move the row to its sorted position
+    int row = displayItems.indexOf(item);
+    sortedItems.removeOne(item);
+    bool shown = matchItem(item);
+    if (row >= 0 && shown){
+        displayItems.removeAt(row);
+        int newRow = getSortedPosition(displayItems, item);
+        displayItems.insert(row, item);
+        if (newRow != row){
+            beginMoveRows(QModelIndex(), row, row, QModelIndex(), newRow > row ? newRow + 1 : newRow);
+            displayItems.move(row, newRow);
+            endMoveRows();
+        }
+        sortedItems.insert(getSortedPosition(sortedItems, item), item);
+        notifyItemChanged(item);
+    } else {
+        removeDisplayItem(item);
+        insertDisplayItem(item);
+    }
+    setActivePen(item);
 }
 /**
  * Removes given item from model and underlying storage
@@ -436,17 +569,15 @@ void LC_PenPaletteModel::itemEdited(LC_PenItem* item){
  */
 void LC_PenPaletteModel::removeItem(LC_PenItem *item){
     bool activePenRemoval = item == activePen;
+    removeDisplayItem(item);
     penPaletteData->removeItem(item);
-    update(false);
     if (activePenRemoval){
         // is it the last one?
-        if (displayItems.isEmpty()){
-            activePen = nullptr;
-        } else {
-            activePen = displayItems.at(0);
-        }
+        activePen = nullptr;
+        setActivePen(displayItems.isEmpty() ? nullptr : displayItems.at(0));
+    } else {
+        emitModelChange();
     }
-    emitModelChange();
 }
 
 /**
@@ -470,10 +601,16 @@ LC_PenItem *LC_PenPaletteModel::getItemForIndex(QModelIndex index){
  * @param l
  */
 void LC_PenPaletteModel::setActivePen(LC_PenItem *l){
-    beginResetModel();
+    // repaint just rows of previous and new active pens
+    LC_PenItem* previous = activePen;
     activePen = l;
+    if (previous != nullptr && previous != l){
+        notifyItemChanged(previous);
+    }
+    if (l != nullptr){
+        notifyItemChanged(l);
+    }
     emitModelChange();
-    endResetModel();
 }
 
 /**
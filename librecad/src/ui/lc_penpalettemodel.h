@@ -76,6 +76,11 @@ public:
     int translateColumn(int column) const;
 
     void update(bool updateNames);
+    /**
+     * Applies the current regexp to the displayed items, inserting and removing
+     * only the rows which changed their visibility
+     */
+    void applyFilter();
     LC_PenPaletteOptions* getOptions(){return options;};
 
     LC_PenItem *createNewItem(QString qString);
@@ -94,6 +99,11 @@ private:
      * List of items that will be displayed in the table - may exclude some pens if filter by name is applied
      */
     QList<LC_PenItem*> displayItems;
+    /**
+     * All pens sorted by name, kept in order on additions, edits and removals. Display items are the
+     * filtered subsequence of it, so filtering never needs to sort
+     */
+    QList<LC_PenItem*> sortedItems;
     /**
      * Underlying pen data holder
      */
@@ -119,6 +129,10 @@ private:
      */
     LC_PenInfoRegistry* registry = LC_PenInfoRegistry::instance();
     void setupItemForDisplay(LC_PenItem *penItem);
+    bool matchItem(LC_PenItem *item) const;
+    void insertDisplayItem(LC_PenItem *item);
+    void removeDisplayItem(LC_PenItem *item);
+    void notifyItemChanged(LC_PenItem *item);
 
     void emitModelChange();
 
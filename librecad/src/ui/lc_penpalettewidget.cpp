@@ -28,7 +28,6 @@
 #include <QMenu>
 #include <QMessageBox>
 #include <QPainter>
-#include <QScrollBar>
 #include <QStyleHints>
 #include <QStyledItemDelegate>
 #include <QTimer>
@@ -192,6 +191,7 @@ void LC_PenPaletteWidget::initTableView(){
 
     connect(penPaletteModel, &LC_PenPaletteModel::modelChange, this, &LC_PenPaletteWidget::onModelChanged);
     connect(penPaletteData, &LC_PenPaletteData::modelDataChange, this, &LC_PenPaletteWidget::onPersistentItemsChanged);
+    connect(penPaletteData, &LC_PenPaletteData::itemsSaved, this, &LC_PenPaletteWidget::onPersistentItemsSaved);
 
     tableView->setContextMenuPolicy(Qt::CustomContextMenu);
     tableView->setItemDelegate(new LC_PenPaletteGridDelegate(tableView, penPaletteModel->getOptions()));
@@ -199,13 +199,22 @@ void LC_PenPaletteWidget::initTableView(){
 
 /**
  * Handler for changes of persistent model (pen data).
- * Here save of pen data model occurs - and if file may not be opened for save, the user is prompted to change the option for correct file location.
+ * Here save of pen data model is scheduled - it is performed in background after a short delay, so a series of edits
+ * of a large palette writes the file once.
+ */
+void LC_PenPaletteWidget::onPersistentItemsChanged(){
+    penPaletteData->saveItemsLater();
+}
+
+/**
+ * Handler for completion of background save of pen data.
+ * If file may not be opened for save, the user is prompted to change the option for correct file location.
  * If the user decide not to change options with file - file will not be saved, and this logic will be involved on next modification of model.
  * If there will not be modifications and the user will exist the application - well, all not saved changes will be lost.
- *
+ * @param saved result of save
  */
-void LC_PenPaletteWidget::onPersistentItemsChanged(){
-    bool itemsSaved = penPaletteData ->saveItems();
+void LC_PenPaletteWidget::onPersistentItemsSaved(bool saved){
+    bool itemsSaved = saved;
     while (!itemsSaved){
         bool showOptions = invokeUnableToSavePenDataDialog();
         if (showOptions){
@@ -237,8 +246,12 @@ void LC_PenPaletteWidget::initPenEditor(){
 void LC_PenPaletteWidget::initFilteringSection(){
     // restore mode for filter
     cbHighlightMode->setChecked(penPaletteModel->getOptions()->filterIsInHighlightMode);
-    // add handlers
-    connect(leFilterMask, &QLineEdit::textChanged, this, &LC_PenPaletteWidget::filterMaskChanged);
+    // add handlers, typed mask is applied once typing pauses
+    filterTimer = new QTimer(this);
+    filterTimer->setSingleShot(true);
+    filterTimer->setInterval(150);
+    connect(filterTimer, &QTimer::timeout, this, &LC_PenPaletteWidget::filterMaskChanged);
+    connect(leFilterMask, &QLineEdit::textChanged, filterTimer, qOverload<>(&QTimer::start));
     connect(cbHighlightMode, &QCheckBox::clicked, this, &LC_PenPaletteWidget::filterMaskChanged);
 }
 
@@ -858,7 +871,6 @@ void LC_PenPaletteWidget::doRemovePenItem(LC_PenItem *penItem){
     if (dialogResult == QMessageBox::Ok){
         // remove in model
         penPaletteModel->removeItem(penItem);
-        updateModel();
     }
 }
 
@@ -876,7 +888,6 @@ void LC_PenPaletteWidget::doRemovePenItems(QList<LC_PenItem *> &penItems){
             LC_PenItem* item = penItems.at(i);
             penPaletteModel->removeItem(item);
         }
-        updateModel();
     }
 }
 /**
@@ -1143,6 +1154,7 @@ void LC_PenPaletteWidget::applyEditorPenToActiveLayer(){
  * Simpy stores the value of filtering mode in setting and updates table model accordingly
  */
 void LC_PenPaletteWidget::filterMaskChanged(){
+    filterTimer->stop();
     QString mask = leFilterMask->text();
     bool highlightMode = cbHighlightMode->isChecked();
 
@@ -1161,11 +1173,8 @@ void LC_PenPaletteWidget::filterMaskChanged(){
  * Updates table view and pens model
  */
 void LC_PenPaletteWidget::updateModel(){
-    // complete rebuild of the model and update of UI
-    int yPos = tableView->verticalScrollBar()->value();
-    tableView->verticalScrollBar()->setValue(yPos);
-    penPaletteModel->update(false);
-    tableView->viewport()->update();
+    // only rows which changed visibility are inserted or removed, so the scroll position and selection are kept
+    penPaletteModel->applyFilter();
 }
 
 /**
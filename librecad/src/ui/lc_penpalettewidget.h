@@ -34,6 +34,8 @@
 #include "rs_pen.h"
 #include "ui_lc_penpalettewidget.h"
 
+class QTimer;
+
 /**
  * Central widget for Pens Palette
  */
@@ -97,6 +99,8 @@ private:
     RS_LayerList* layerList = nullptr;
     bool inEditorControlsSetup = false;
     bool editorChanged = false;
+    // delays filtering while the mask is typed
+    QTimer* filterTimer = nullptr;
     void initTableView();
     void initFilteringSection();
     void fillPenEditorByPenItem(LC_PenItem *pen);
@@ -126,6 +130,7 @@ private:
     void initToolBar() const;
     void onTableRowDoubleClicked();
     void onPersistentItemsChanged();
+    void onPersistentItemsSaved(bool saved);
     bool invokeUnableToSavePenDataDialog();
 };
 
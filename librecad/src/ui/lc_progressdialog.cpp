@@ -0,0 +1,47 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#include "lc_progressdialog.h"
+
+namespace {
+// steps of the progress bar
+constexpr int progressSteps = 1000;
+// time before the dialog is shown, in ms
+constexpr int progressDelay = 500;
+}
+
+LC_ProgressDialog::LC_ProgressDialog(const QString& label, QWidget* parent):
+    QProgressDialog(label, tr("Cancel"), 0, progressSteps, parent)
+    ,m_progress([this](double fraction) {
+        // processes the events of the modal dialog, as the cancel button
+        setValue(static_cast<int>(fraction * maximum()));
+        return !wasCanceled();
+    })
+{
+    setWindowModality(Qt::WindowModal);
+    setMinimumDuration(progressDelay);
+    setAutoReset(false);
+    setAutoClose(false);
+}
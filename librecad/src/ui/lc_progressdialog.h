@@ -0,0 +1,54 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2026 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+
+#ifndef LC_PROGRESSDIALOG_H
+#define LC_PROGRESSDIALOG_H
+
+#include <QProgressDialog>
+
+#include "lc_progress.h"
+
+/**
+ * @brief The LC_ProgressDialog class, the progress of a long running engine
+ * operation with a cancel button, instead of the wait cursor.
+ *
+ * The dialog is shown, if the operation takes longer than half a second, and
+ * blocks the input to its window only. The events are processed while the
+ * operation reports its progress.
+ */
+class LC_ProgressDialog : public QProgressDialog {
+public:
+    LC_ProgressDialog(const QString& label, QWidget* parent);
+
+    //! the progress to pass to the operation, cancelled by the cancel button
+    LC_Progress* getProgress() {
+        return &m_progress;
+    }
+
+private:
+    LC_Progress m_progress;
+};
+
+#endif // LC_PROGRESSDIALOG_H
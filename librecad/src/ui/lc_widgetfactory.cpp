@@ -22,8 +22,13 @@
 **********************************************************************************
 */
 
+#include <functional>
+#include <memory>
+
 #include <QMenu>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QPushButton>
 #include <QMenuBar>
 #include <QActionGroup>
 #include <QDesktopServices>
@@ -53,6 +58,23 @@ namespace {
         auto guard= RS_SETTINGS->beginGroupGuard("/CustomToolbars");
         return RS_SETTINGS->readNumEntry("/UsePenPallet", 1) == 1;
     }
+
+    // creates the contents of a dock widget when the dock is shown the first time.
+    // The dock itself exists from the start, so restoreState() restores its placement
+    void createOnFirstShow(QDockWidget* dock, std::function<QWidget*()> create) {
+        auto connection = std::make_shared<QMetaObject::Connection>();
+        *connection = QObject::connect(dock, &QDockWidget::visibilityChanged, dock,
+                                       [dock, create = std::move(create), connection](bool visible) {
+            if (!visible || dock->widget() != nullptr)
+                return;
+            QObject::disconnect(*connection);
+            QElapsedTimer timer;
+            timer.start();
+            dock->setWidget(create());
+            RS_DEBUG->print(RS_Debug::D_INFORMATIONAL, "LC_WidgetFactory: %s created on first show: %lld ms",
+                            dock->objectName().toLatin1().data(), timer.elapsed());
+        });
+    }
 } // namespace
 
 LC_WidgetFactory::LC_WidgetFactory(QC_ApplicationWindow* main_win,
@@ -185,6 +207,7 @@ LC_WidgetFactory::LC_WidgetFactory(QC_ApplicationWindow* main_win,
             << a_map["ModifyTrim"]
             << a_map["ModifyTrim2"]
             << a_map["ModifyTrimAmount"]
+            << a_map["ModifyTrimToEdges"]
             << a_map["ModifyLineJoin"]
             << a_map["ModifyBreakDivide"]
             << a_map["ModifyLineGap"]
@@ -197,6 +220,7 @@ LC_WidgetFactory::LC_WidgetFactory(QC_ApplicationWindow* main_win,
             << a_map["ModifyAttributes"]
             << a_map["ModifyExplodeText"]
             << a_map["BlocksExplode"]
+            << a_map["ModifyOverkill"]
             << a_map["ModifyDeleteQuick"];
 
     order_actions
@@ -335,11 +359,15 @@ void LC_WidgetFactory::createRightSidebar(QG_ActionHandler* action_handler)
         dock_pen_palette = new QDockWidget(main_window);
         dock_pen_palette->setWindowTitle(QC_ApplicationWindow::tr("Pen Palette"));
         dock_pen_palette->setObjectName("pen_palette_dockwidget");
-        pen_palette = new LC_PenPaletteWidget("Layer", dock_pen_palette);
-        pen_palette->setFocusPolicy(Qt::NoFocus);
-        connect(pen_palette, SIGNAL(escape()), main_window, SLOT(slotFocus()));
-        connect(main_window, SIGNAL(windowsChanged(bool)), pen_palette, SLOT(setEnabled(bool)));
-        dock_pen_palette ->setWidget(pen_palette);
+        // the palette loads its pens from storage, so do it only once it is needed
+        createOnFirstShow(dock_pen_palette, [window = main_window, dock_pen_palette]() -> QWidget* {
+            auto pen_palette = new LC_PenPaletteWidget("Layer", dock_pen_palette);
+            pen_palette->setFocusPolicy(Qt::NoFocus);
+            connect(pen_palette, SIGNAL(escape()), window, SLOT(slotFocus()));
+            connect(window, SIGNAL(windowsChanged(bool)), pen_palette, SLOT(setEnabled(bool)));
+            window->setPenPaletteWidget(pen_palette);
+            return pen_palette;
+        });
     }
     QDockWidget* dock_layer = new QDockWidget(main_window);
     dock_layer->setWindowTitle(QC_ApplicationWindow::tr("Layer List"));
@@ -378,13 +406,17 @@ void LC_WidgetFactory::createRightSidebar(QG_ActionHandler* action_handler)
     dock_library->setWindowTitle(tr("Library Browser"));
     dock_library->setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
     dock_library->setObjectName("library_dockwidget");
-    library_widget = new QG_LibraryWidget(dock_library, "Library");
-    library_widget->setActionHandler(action_handler);
-    library_widget->setFocusPolicy(Qt::NoFocus);
-    connect(library_widget, SIGNAL(escape()), main_window, SLOT(slotFocus()));
-    connect(main_window, SIGNAL(windowsChanged(bool)),
-            (QObject*) library_widget->getInsertButton(), SLOT(setEnabled(bool)));
-    dock_library->setWidget(library_widget);
+    // the library tree is built by scanning the library paths
+    createOnFirstShow(dock_library, [window = main_window, dock_library, action_handler]() -> QWidget* {
+        auto library_widget = new QG_LibraryWidget(dock_library, "Library");
+        library_widget->setActionHandler(action_handler);
+        library_widget->setFocusPolicy(Qt::NoFocus);
+        connect(library_widget, SIGNAL(escape()), window, SLOT(slotFocus()));
+        QPushButton* insert = library_widget->getInsertButton();
+        insert->setEnabled(window->getMDIWindow() != nullptr);
+        connect(window, SIGNAL(windowsChanged(bool)), (QObject*) insert, SLOT(setEnabled(bool)));
+        return library_widget;
+    });
     dock_library->resize(240, 400);
 
     QDockWidget* dock_command = new QDockWidget(tr("Command line"), main_window);
@@ -677,6 +709,8 @@ void LC_WidgetFactory::createMenus(QMenuBar* menu_bar)
 	file_menu->addAction(a_map["FileNew"]);
 	file_menu->addAction(a_map["FileNewTemplate"]);
 	file_menu->addAction(a_map["FileOpen"]);
+	file_menu->addAction(a_map["FileOpenPartial"]);
+	file_menu->addAction(a_map["FileOpenReadOnly"]);
 	file_menu->addSeparator();
 	file_menu->addAction(a_map["FileSave"]);
 	file_menu->addAction(a_map["FileSaveAs"]);
@@ -927,6 +961,10 @@ void LC_WidgetFactory::createMenus(QMenuBar* menu_bar)
 
     help_menu->addSeparator();
 
+    QAction* memory_report = new QAction(QC_ApplicationWindow::tr("&Memory Report"), main_window);
+    connect(memory_report, SIGNAL(triggered()), main_window, SLOT(showMemoryReport()));
+    help_menu->addAction(memory_report);
+
     QAction* help_about = new QAction(QIcon(":/main/librecad.png"), QC_ApplicationWindow::tr("About"), main_window);
     connect(help_about, SIGNAL(triggered()), main_window, SLOT(showAboutWindow()));
     help_menu->addAction(help_about);
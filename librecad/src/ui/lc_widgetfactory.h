@@ -18,7 +18,6 @@ class QG_LayerWidget;
 class LC_LayerTreeWidget;
 class QG_BlockWidget;
 class QG_ActionHandler;
-class QG_LibraryWidget;
 class QG_CommandWidget;
 class LC_CustomToolbar;
 class QC_ApplicationWindow;
@@ -53,9 +52,7 @@ public:
 
     QG_LayerWidget* layer_widget = nullptr;
     LC_LayerTreeWidget* layer_tree_widget = nullptr;
-    LC_PenPaletteWidget* pen_palette = nullptr;
     QG_BlockWidget* block_widget = nullptr;
-    QG_LibraryWidget* library_widget = nullptr;
     QG_CommandWidget* command_widget = nullptr;
 
     QMenu* file_menu = nullptr;
@@ -175,6 +175,7 @@
 #include "rs_actionorder.h"
 #include "qg_snaptoolbar.h"
 #include "rs_debug.h"
+#include "rs_graphic.h"
 #include "rs_graphicview.h"
 #include "rs_layer.h"
 #include "rs_settings.h"
@@ -191,10 +192,115 @@
 #include "lc_actionmodifylinejoin.h"
 #include "lc_actiondrawlinepoints.h"
 #include "lc_actionmodifyduplicate.h"
+#include "lc_actionmodifyoverkill.h"
+#include "lc_actionmodifytrimtoedges.h"
 #include "lc_actiondrawstar.h"
 #include "lc_actionmodifybreakdivide.h"
 #include "lc_actionmodifylinegap.h"
 
+namespace {
+/**
+ * @return true for the actions which don't change the drawing, they're allowed
+ * in drawings opened read-only
+ */
+bool isViewingAction(RS2::ActionType id)
+{
+    switch (id) {
+    case RS2::ActionNone:
+    case RS2::ActionDefault:
+    case RS2::ActionFileNew:
+    case RS2::ActionFileNewTemplate:
+    case RS2::ActionFileOpen:
+    case RS2::ActionFileSave:
+    case RS2::ActionFileSaveAs:
+    case RS2::ActionFileExport:
+    case RS2::ActionFileClose:
+    case RS2::ActionFilePrint:
+    case RS2::ActionFilePrintPDF:
+    case RS2::ActionFilePrintPreview:
+    case RS2::ActionFileExportMakerCam:
+    case RS2::ActionFileQuit:
+    case RS2::ActionEditKillAllActions:
+    case RS2::ActionEditUndo:
+    case RS2::ActionEditRedo:
+    case RS2::ActionEditCopy:
+    case RS2::ActionEditCopyNoSelect:
+    case RS2::ActionViewStatusBar:
+    case RS2::ActionViewLayerList:
+    case RS2::ActionViewBlockList:
+    case RS2::ActionViewCommandLine:
+    case RS2::ActionViewLibrary:
+    case RS2::ActionViewPenToolbar:
+    case RS2::ActionViewOptionToolbar:
+    case RS2::ActionViewCadToolbar:
+    case RS2::ActionViewFileToolbar:
+    case RS2::ActionViewEditToolbar:
+    case RS2::ActionViewSnapToolbar:
+    case RS2::ActionViewGrid:
+    case RS2::ActionViewDraft:
+    case RS2::ActionZoomIn:
+    case RS2::ActionZoomOut:
+    case RS2::ActionZoomAuto:
+    case RS2::ActionZoomWindow:
+    case RS2::ActionZoomPan:
+    case RS2::ActionZoomRedraw:
+    case RS2::ActionZoomPrevious:
+    case RS2::ActionSelect:
+    case RS2::ActionSelectSingle:
+    case RS2::ActionSelectContour:
+    case RS2::ActionSelectWindow:
+    case RS2::ActionDeselectWindow:
+    case RS2::ActionSelectAll:
+    case RS2::ActionDeselectAll:
+    case RS2::ActionSelectIntersected:
+    case RS2::ActionDeselectIntersected:
+    case RS2::ActionSelectInvert:
+    case RS2::ActionSelectLayer:
+    case RS2::ActionSelectDouble:
+    case RS2::ActionGetSelect:
+    case RS2::ActionSnapFree:
+    case RS2::ActionSnapGrid:
+    case RS2::ActionSnapEndpoint:
+    case RS2::ActionSnapOnEntity:
+    case RS2::ActionSnapCenter:
+    case RS2::ActionSnapMiddle:
+    case RS2::ActionSnapDist:
+    case RS2::ActionSnapMiddleManual:
+    case RS2::ActionSnapIntersection:
+    case RS2::ActionSnapIntersectionManual:
+    case RS2::ActionRestrictNothing:
+    case RS2::ActionRestrictOrthogonal:
+    case RS2::ActionRestrictHorizontal:
+    case RS2::ActionRestrictVertical:
+    case RS2::ActionSetRelativeZero:
+    case RS2::ActionLockRelativeZero:
+    case RS2::ActionUnlockRelativeZero:
+    case RS2::ActionInfoInside:
+    case RS2::ActionInfoDist:
+    case RS2::ActionInfoDist2:
+    case RS2::ActionInfoAngle:
+    case RS2::ActionInfoTotalLength:
+    case RS2::ActionInfoTotalLengthNoSelect:
+    case RS2::ActionInfoArea:
+    case RS2::ActionLayersDefreezeAll:
+    case RS2::ActionLayersFreezeAll:
+    case RS2::ActionLayersToggleView:
+    case RS2::ActionLayersExportSelected:
+    case RS2::ActionLayersExportVisible:
+    case RS2::ActionBlocksDefreezeAll:
+    case RS2::ActionBlocksFreezeAll:
+    case RS2::ActionBlocksToggleView:
+    case RS2::ActionBlocksSave:
+    case RS2::ActionOptionsGeneral:
+    case RS2::ActionPenPick:
+    case RS2::ActionPenPickResolved:
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
 /**
  * Constructor
  */
@@ -256,6 +362,14 @@ RS_ActionInterface* QG_ActionHandler::setCurrentAction(RS2::ActionType id) {
         return nullptr;
     }
 
+    // drawings opened read-only are converted, when the user chooses to edit them
+    RS_Graphic* graphic = document->getGraphic();
+    if (graphic != nullptr && graphic->isReadOnly() && !isViewingAction(id)) {
+        auto& appWindow = QC_ApplicationWindow::getAppWindow();
+        if (appWindow == nullptr || !appWindow->requestEditing(*graphic))
+            return nullptr;
+    }
+
     auto a_layer = (document->getLayerList() != nullptr) ? document->getLayerList()->getActive() : nullptr;
 
     switch (id) {
@@ -807,6 +921,9 @@ RS_ActionInterface* QG_ActionHandler::setCurrentAction(RS2::ActionType id) {
     case RS2::ActionModifyTrimAmount:
         a = new RS_ActionModifyTrimAmount(*document, *view);
         break;
+    case RS2::ActionModifyTrimToEdges:
+        a = new LC_ActionModifyTrimToEdges(*document, *view);
+        break;
     case RS2::ActionModifyCut:
         a = new RS_ActionModifyCut(*document, *view);
         break;
@@ -840,6 +957,15 @@ RS_ActionInterface* QG_ActionHandler::setCurrentAction(RS2::ActionType id) {
     case RS2::ActionModifyExplodeTextNoSelect:
         a = new RS_ActionModifyExplodeText(*document, *view);
         break;
+    case RS2::ActionModifyOverkill:
+        if(!document->countSelected(false)){
+            a = new RS_ActionSelect(this, *document, *view, RS2::ActionModifyOverkillNoSelect);
+            break;
+        }
+        // fall-through
+    case RS2::ActionModifyOverkillNoSelect:
+        a = new LC_ActionModifyOverkill(*document, *view);
+        break;
 
         // Snapping actions:
         //
@@ -1846,6 +1972,10 @@ void QG_ActionHandler::slotModifyTrimAmount() {
     setCurrentAction(RS2::ActionModifyTrimAmount);
 }
 
+void QG_ActionHandler::slotModifyTrimToEdges() {
+    setCurrentAction(RS2::ActionModifyTrimToEdges);
+}
+
 void QG_ActionHandler::slotModifyCut() {
     setCurrentAction(RS2::ActionModifyCut);
 }
@@ -1854,6 +1984,10 @@ void QG_ActionHandler::slotModifyExplodeText() {
     setCurrentAction(RS2::ActionModifyExplodeText);
 }
 
+void QG_ActionHandler::slotModifyOverkill() {
+    setCurrentAction(RS2::ActionModifyOverkill);
+}
+
 void QG_ActionHandler::slotSetSnaps(RS_SnapMode const& s) {
     RS_DEBUG->print("QG_ActionHandler::slotSetSnaps()");
 
@@ -2181,6 +2315,31 @@ void QG_ActionHandler::slotPenSyncFromLayer(){
 //    penPaletteWidget->updatePenToolbarByActiveLayer();
 }
 
+void QG_ActionHandler::beginMacro()
+{
+    if (macroDepth++ > 0)
+        return;
+    macroView = view;
+    macroDocument = document;
+    if (macroDocument != nullptr)
+        macroDocument->startUndoCycle();
+    if (macroView != nullptr)
+        macroView->setRedrawDeferred(true);
+}
+
+void QG_ActionHandler::endMacro()
+{
+    if (macroDepth == 0 || --macroDepth > 0)
+        return;
+    if (macroDocument != nullptr)
+        macroDocument->endUndoCycle();
+    // the single redraw of the macro
+    if (macroView != nullptr)
+        macroView->setRedrawDeferred(false);
+    macroView = nullptr;
+    macroDocument = nullptr;
+}
+
 void QG_ActionHandler::set_view(RS_GraphicView* gview)
 {
     view = gview;
@@ -61,6 +61,13 @@ public:
 	//return true if handled
 	bool commandLineActions(RS2::ActionType id);
 	bool command(const QString& cmd);
+    /**
+     * @brief beginMacro starts playing back commands as a macro: the redraws and
+     * previews of the view are deferred to endMacro() and the edits are undone
+     * at once. Macros nest
+     */
+    void beginMacro();
+    void endMacro();
 	QStringList getAvailableCommands();
 	RS_SnapMode getSnaps();
 	RS2::SnapRestriction getSnapRestriction();
@@ -211,12 +218,14 @@ public slots:
 	void slotModifyTrim();
 	void slotModifyTrim2();
 	void slotModifyTrimAmount();
+	void slotModifyTrimToEdges();
 	void slotModifyCut();
 	void slotModifyStretch();
 	void slotModifyBevel();
 	void slotModifyRound();
 	void slotModifyOffset();
 	void slotModifyExplodeText();
+	void slotModifyOverkill();
 
 	void slotSetSnaps(RS_SnapMode const& s);
 	void slotSnapFree();
@@ -298,6 +307,10 @@ private:
     QG_SnapToolBar* snap_toolbar{nullptr};
     RS_GraphicView* view{nullptr};
     RS_Document*    document{nullptr};
+    // the view and document of the running macro
+    int macroDepth{0};
+    RS_GraphicView* macroView{nullptr};
+    RS_Document*    macroDocument{nullptr};
 };
 
 #endif
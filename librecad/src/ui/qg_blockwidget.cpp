@@ -36,11 +36,13 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QContextMenuEvent>
+#include <QCoreApplication>
 
 #include "qg_actionhandler.h"
 #include "qg_blockwidget.h"
 #include "rs_blocklist.h"
 #include "rs_debug.h"
+#include "rs_settings.h"
 
 QG_BlockModel::QG_BlockModel(QObject * parent) : QAbstractTableModel(parent) {
     blockVisible = QIcon(":/icons/visible.svg");
@@ -75,8 +77,9 @@ void QG_BlockModel::setBlockList(RS_BlockList* bl) {
         endResetModel();
         return;
     }
+    listBlock.reserve(bl->count());
     for (int i=0; i<bl->count(); ++i) {
-        if ( !bl->at(i)->isUndone() )
+        if (isListed(bl->at(i)))
             listBlock.append(bl->at(i));
     }
     setActiveBlock(bl->getActive());
@@ -94,12 +97,89 @@ RS_Block *QG_BlockModel::getBlock( int row ){
 }
 
 QModelIndex QG_BlockModel::getIndex (RS_Block * blk){
-    int row = listBlock.indexOf(blk);
+    int row = getRow(blk);
     if (row<0)
         return QModelIndex();
     return createIndex ( row, NAME);
 }
 
+int QG_BlockModel::getRow(const RS_Block* blk) const {
+    if (blk == nullptr)
+        return -1;
+    // the list is sorted by the unique block names
+    auto it = std::lower_bound(listBlock.cbegin(), listBlock.cend(), blk, blockLessThan);
+    if (it == listBlock.cend() || *it != blk)
+        return -1;
+    return int(it - listBlock.cbegin());
+}
+
+bool QG_BlockModel::isAnonymous(const RS_Block* blk) {
+    return blk->getName().startsWith('*');
+}
+
+bool QG_BlockModel::isListed(const RS_Block* blk) const {
+    return blk != nullptr && !blk->isUndone() && (showAnonymous || !isAnonymous(blk));
+}
+
+/**
+ * Inserts the row of a block added to the block list
+ */
+void QG_BlockModel::addBlock(RS_Block* blk) {
+    if (!isListed(blk) || getRow(blk) >= 0)
+        return;
+    auto it = std::lower_bound(listBlock.cbegin(), listBlock.cend(), blk, blockLessThan);
+    int row = int(it - listBlock.cbegin());
+    beginInsertRows(QModelIndex(), row, row);
+    listBlock.insert(row, blk);
+    endInsertRows();
+}
+
+/**
+ * Removes the row of a block removed from the block list
+ */
+void QG_BlockModel::removeBlock(RS_Block* blk) {
+    int row = getRow(blk);
+    if (row < 0)
+        row = listBlock.indexOf(blk);
+    if (activeBlock == blk)
+        activeBlock = nullptr;
+    if (row < 0)
+        return;
+    beginRemoveRows(QModelIndex(), row, row);
+    listBlock.removeAt(row);
+    endRemoveRows();
+}
+
+/**
+ * Updates the row of a changed block, the row is moved if the block was renamed
+ */
+void QG_BlockModel::updateBlock(RS_Block* blk) {
+    if (blk == nullptr)
+        return;
+    // a renamed block is out of order, so it isn't found by getRow()
+    int row = listBlock.indexOf(blk);
+    if (row < 0) {
+        addBlock(blk);
+        return;
+    }
+    bool ordered = (row == 0 || blockLessThan(listBlock.at(row - 1), blk))
+                   && (row == listBlock.size() - 1 || blockLessThan(blk, listBlock.at(row + 1)));
+    if (ordered && isListed(blk)) {
+        emit dataChanged(index(row, VISIBLE), index(row, LAST - 1));
+        return;
+    }
+    beginRemoveRows(QModelIndex(), row, row);
+    listBlock.removeAt(row);
+    endRemoveRows();
+    addBlock(blk);
+}
+
+void QG_BlockModel::updateVisibility() {
+    if (listBlock.isEmpty())
+        return;
+    emit dataChanged(index(0, VISIBLE), index(listBlock.size() - 1, VISIBLE), {Qt::DecorationRole});
+}
+
 QVariant QG_BlockModel::data ( const QModelIndex & index, int role ) const {
     if (!index.isValid() || index.row() >= listBlock.size())
         return QVariant();
@@ -116,6 +196,11 @@ QVariant QG_BlockModel::data ( const QModelIndex & index, int role ) const {
     if (role ==Qt::DisplayRole && index.column() == NAME) {
         return blk->getName();
     }
+    if (role == Qt::ToolTipRole && index.column() == NAME) {
+        // requested only for the hovered row
+        return QCoreApplication::translate("QG_BlockModel", "%1\n%n entities", nullptr, int(blk->count()))
+            .arg(blk->getName());
+    }
     if (role == Qt::FontRole && index.column() == NAME) {
         if (activeBlock && activeBlock == blk) {
             QFont font;
@@ -140,6 +225,9 @@ QG_BlockWidget::QG_BlockWidget(QG_ActionHandler* ah, QWidget* parent,
     lastBlock = nullptr;
 
     blockModel = new QG_BlockModel(this);
+    RS_SETTINGS->beginGroup("BlockList");
+    blockModel->setShowAnonymous(RS_SETTINGS->readNumEntry("/showAnonymousBlocks", 1) != 0);
+    RS_SETTINGS->endGroup();
     blockView = new QTableView(this);
     blockView->setModel (blockModel);
     blockView->setShowGrid (false);
@@ -148,6 +236,8 @@ QG_BlockWidget::QG_BlockWidget(QG_ActionHandler* ah, QWidget* parent,
     blockView->setFocusPolicy(Qt::NoFocus);
     blockView->setColumnWidth(QG_BlockModel::VISIBLE, 20);
     blockView->verticalHeader()->hide();
+    // rows have the same height, so thousands of blocks aren't measured one by one
+    blockView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     blockView->horizontalHeader()->setStretchLastSection(true);
     blockView->horizontalHeader()->hide();
 
@@ -262,7 +352,9 @@ void QG_BlockWidget::update() {
     RS_Block* b = lastBlock;
     activateBlock(activeBlock);
     lastBlock = b;
-    blockView->resizeRowsToContents();
+    if (blockModel->rowCount() > 0) {
+        blockView->verticalHeader()->setDefaultSectionSize(blockView->sizeHintForRow(0));
+    }
 
     restoreSelections();
 
@@ -273,16 +365,18 @@ void QG_BlockWidget::update() {
 void QG_BlockWidget::restoreSelections() {
 
     QItemSelectionModel* selectionModel = blockView->selectionModel();
+    QItemSelection selection;
 
-    for (auto block: *blockList) {
+    for (int row = 0; row < blockModel->rowCount(); row++) {
+        RS_Block* block = blockModel->getBlock(row);
         if (!block) continue;
         if (!block->isVisibleInBlockList()) continue;
         if (!block->isSelectedInBlockList()) continue;
 
-        QModelIndex idx = blockModel->getIndex(block);
-        QItemSelection selection(idx, idx);
-        selectionModel->select(selection, QItemSelectionModel::Select);
+        QModelIndex idx = blockModel->index(row, QG_BlockModel::NAME);
+        selection.select(idx, idx);
     }
+    selectionModel->select(selection, QItemSelectionModel::Select);
 }
 
 
@@ -404,6 +498,11 @@ void QG_BlockWidget::contextMenuEvent(QContextMenuEvent *e) {
     addActionFunc(tr("&Edit Block"), &QG_ActionHandler::slotBlocksEdit);
     addActionFunc(tr("&Insert Block"), &QG_ActionHandler::slotBlocksInsert);
     addActionFunc(tr("&Create New Block"), &QG_ActionHandler::slotBlocksCreate);
+    contextMenu->addSeparator();
+    QAction* showAnonymous = contextMenu->addAction(tr("Show &Anonymous Blocks"));
+    showAnonymous->setCheckable(true);
+    showAnonymous->setChecked(blockModel->isShowAnonymous());
+    connect(showAnonymous, &QAction::toggled, this, &QG_BlockWidget::slotShowAnonymousBlocks);
     contextMenu->exec(QCursor::pos());
 
     e->accept();
@@ -427,10 +526,72 @@ void QG_BlockWidget::keyPressEvent(QKeyEvent* e) {
 }
 
 
-void QG_BlockWidget::blockAdded(RS_Block*) {
-    update();
-    if (! matchBlockName->text().isEmpty()) {
-        slotUpdateBlockList();
+/**
+ * Adds the row of a block, without block all blocks are updated
+ */
+void QG_BlockWidget::blockAdded(RS_Block* block) {
+    if (block == nullptr || blockList == nullptr) {
+        update();
+        if (! matchBlockName->text().isEmpty()) {
+            slotUpdateBlockList();
+        }
+        return;
+    }
+    blockModel->addBlock(block);
+    filterRow(blockModel->getRow(block), getFilterExpression());
+}
+
+
+void QG_BlockWidget::blockEdited(RS_Block* block) {
+    if (block == nullptr || blockList == nullptr) {
+        update();
+        return;
+    }
+    blockModel->updateBlock(block);
+    filterRow(blockModel->getRow(block), getFilterExpression());
+    restoreSelections();
+}
+
+
+void QG_BlockWidget::blockRemoved(RS_Block* block) {
+    if (block == nullptr || blockList == nullptr) {
+        update();
+        return;
+    }
+    if (lastBlock == block) {
+        lastBlock = nullptr;
+    }
+    blockModel->removeBlock(block);
+}
+
+
+void QG_BlockWidget::blockToggled(RS_Block* block) {
+    if (block == nullptr) {
+        // all blocks are frozen or defrozen
+        blockModel->updateVisibility();
+        return;
+    }
+    blockModel->updateBlock(block);
+}
+
+
+QRegularExpression QG_BlockWidget::getFilterExpression() const {
+    return QRegularExpression{QRegularExpression::wildcardToRegularExpression(matchBlockName->text())};
+}
+
+
+/**
+ * Shows or hides the row depending on whether its block name matches the filter
+ */
+void QG_BlockWidget::filterRow(int row, const QRegularExpression& rx) {
+    RS_Block* block = blockModel->getBlock(row);
+    if (!block) return;
+    if (matchBlockName->text().isEmpty() || block->getName().indexOf(rx) == 0) {
+        blockView->showRow(row);
+        block->visibleInBlockList(true);
+    } else {
+        blockView->hideRow(row);
+        block->visibleInBlockList(false);
     }
 }
 
@@ -444,19 +605,27 @@ void QG_BlockWidget::slotUpdateBlockList() {
         return;
     }
 
-    QRegularExpression rx{ QRegularExpression::wildcardToRegularExpression(matchBlockName->text())};
+    QRegularExpression rx = getFilterExpression();
 
-    for (int i = 0; i < blockList->count(); i++) {
-        RS_Block* block = blockModel->getBlock(i);
-        if (!block) continue;
-        if (block->getName().indexOf(rx) == 0) {
-            blockView->showRow(i);
-            blockModel->getBlock(i)->visibleInBlockList(true);
-        } else {
-            blockView->hideRow(i);
-            blockModel->getBlock(i)->visibleInBlockList(false);
-        }
+    for (int i = 0; i < blockModel->rowCount(); i++) {
+        filterRow(i, rx);
     }
 
     restoreSelections();
 }
+
+
+/**
+ * Lists or skips anonymous blocks, the choice is kept in the settings
+ */
+void QG_BlockWidget::slotShowAnonymousBlocks(bool show) {
+    RS_SETTINGS->beginGroup("BlockList");
+    RS_SETTINGS->writeEntry("/showAnonymousBlocks", show ? 1 : 0);
+    RS_SETTINGS->endGroup();
+
+    blockModel->setShowAnonymous(show);
+    update();
+    if (! matchBlockName->text().isEmpty()) {
+        slotUpdateBlockList();
+    }
+}
@@ -30,6 +30,7 @@
 #include <QAbstractTableModel>
 #include <QIcon>
 #include <QItemSelection>
+#include <QRegularExpression>
 #include <QWidget>
 
 #include "rs_blocklistlistener.h"
@@ -60,15 +61,36 @@ public:
     void setBlockList(RS_BlockList* bl);
     RS_Block *getBlock( int row );
     QModelIndex getIndex (RS_Block * blk);
+    //! @return row of the block, or -1 if the block isn't listed
+    int getRow(const RS_Block* blk) const;
+
+    // incremental updates for changes of single blocks
+    void addBlock(RS_Block* blk);
+    void removeBlock(RS_Block* blk);
+    void updateBlock(RS_Block* blk);
+    //! repaints the visibility icons of all rows
+    void updateVisibility();
 
     RS_Block* getActiveBlock() const { return activeBlock; }
     void setActiveBlock(RS_Block* b) { activeBlock = b; }
 
+    /**
+     * @brief setShowAnonymous whether anonymous blocks, as *D dimension and *U
+     * blocks of imported drawings, are listed. Applied by the next setBlockList()
+     */
+    void setShowAnonymous(bool show) { showAnonymous = show; }
+    bool isShowAnonymous() const { return showAnonymous; }
+    static bool isAnonymous(const RS_Block* blk);
+
 private:
+    bool isListed(const RS_Block* blk) const;
+
+    // blocks sorted by name
     QList<RS_Block*> listBlock;
     QIcon blockVisible;
     QIcon blockHidden;
     RS_Block* activeBlock {nullptr};
+    bool showAnonymous {true};
 };
 
 
@@ -95,17 +117,10 @@ public:
     void update();
     void activateBlock(RS_Block* block);
 
-    void blockAdded(RS_Block*) override;
-
-    void blockEdited(RS_Block*) override{
-        update();
-    }
-    void blockRemoved(RS_Block*) override{
-        update();
-    }
-    void blockToggled(RS_Block*) override{
-        update();
-    }
+    void blockAdded(RS_Block* block) override;
+    void blockEdited(RS_Block* block) override;
+    void blockRemoved(RS_Block* block) override;
+    void blockToggled(RS_Block* block) override;
 
 signals:
     void escape();
@@ -116,6 +131,7 @@ public slots:
         const QItemSelection &selected,
         const QItemSelection &deselected);
     void slotUpdateBlockList();
+    void slotShowAnonymousBlocks(bool show);
 
 protected:
     void contextMenuEvent(QContextMenuEvent *e) override;
@@ -131,6 +147,8 @@ private:
     QG_ActionHandler* actionHandler = nullptr;
 
     void restoreSelections();
+    void filterRow(int row, const QRegularExpression& rx);
+    QRegularExpression getFilterExpression() const;
 };
 
 #endif
@@ -220,6 +220,8 @@ void QG_CommandEdit::processInput(QString input)
     {
         if (input.contains(";"))
         {
+            // pasted commands are played back as a macro
+            emit macroStarted();
             foreach (auto str, input.split(";"))
             {
                 if (str.contains("\\"))
@@ -227,6 +229,7 @@ void QG_CommandEdit::processInput(QString input)
                 else
                     emit command(str);
             }
+            emit macroFinished();
         }
         else
         {
@@ -354,6 +357,8 @@ void QG_CommandEdit::processVariable(QString input)
         input = variables[input];
         if (input.contains(";"))
         {
+            // pasted commands are played back as a macro
+            emit macroStarted();
             foreach (auto str, input.split(";"))
             {
                 if (str.contains("\\"))
@@ -361,6 +366,7 @@ void QG_CommandEdit::processVariable(QString input)
                 else
                     emit command(str);
             }
+            emit macroFinished();
         }
         else emit command(input);
     }
@@ -376,6 +382,7 @@ void QG_CommandEdit::readCommandFile(const QString& path)
 
     QTextStream txt_stream(&file);
     QString line;
+    emit macroStarted();
     while (!txt_stream.atEnd())
     {
         line = txt_stream.readLine();
@@ -383,6 +390,7 @@ void QG_CommandEdit::readCommandFile(const QString& path)
         if (!line.startsWith("#"))
             processInput(line);
     }
+    emit macroFinished();
 }
 
 void QG_CommandEdit::modifiedPaste()
@@ -42,6 +42,10 @@ public:
     QG_CommandEdit(QWidget* parent=nullptr);
     virtual ~QG_CommandEdit() = default;
 
+    /**
+     * @brief readCommandFile plays back the commands of the file as a macro,
+     * between the signals macroStarted() and macroFinished()
+     */
     void readCommandFile(const QString& path);
 
     bool keycode_mode = false;
@@ -70,6 +74,8 @@ signals:
     void command(QString cmd);
     void message(QString msg);
     void keycode(QString code);
+    void macroStarted();
+    void macroFinished();
 
 private:
     /**
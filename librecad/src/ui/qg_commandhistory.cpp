@@ -25,14 +25,26 @@
 // -- https://github.com/LibreCAD/LibreCAD --
 
 #include "qg_commandhistory.h"
+#include <algorithm>
+
 #include <QAction>
 #include <QMouseEvent>
 
+#include "rs_settings.h"
+
 // -- commandline history (output) widget --
 
 QG_CommandHistory::QG_CommandHistory(QWidget* parent) :
-    QTextEdit(parent)
+    QPlainTextEdit(parent)
 {
+    RS_SETTINGS->beginGroup("Widgets");
+    setMaximumLines(RS_SETTINGS->readNumEntry("/CommandHistoryLines", 10000));
+    RS_SETTINGS->endGroup();
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(0);
+    connect(&m_flushTimer, &QTimer::timeout, this, &QG_CommandHistory::slotFlush);
+
 	setContextMenuPolicy(Qt::ActionsContextMenu);
 
 	m_pCopy = new QAction(tr("&Copy"), this);
@@ -56,7 +68,7 @@ QG_CommandHistory::QG_CommandHistory(QWidget* parent) :
 
 void QG_CommandHistory::mouseReleaseEvent(QMouseEvent* event)
 {
-    QTextEdit::mouseReleaseEvent(event);
+    QPlainTextEdit::mouseReleaseEvent(event);
 	if (event->button() == Qt::LeftButton && m_pCopy->isVisible())
     {
         copy();
@@ -66,6 +78,54 @@ void QG_CommandHistory::mouseReleaseEvent(QMouseEvent* event)
 void QG_CommandHistory::slotTextChanged()
 {
 	//only show the selectAll item when there is text
-	m_pSelectAll->setVisible(! toPlainText().isEmpty());
+	m_pSelectAll->setVisible(! document()->isEmpty());
+}
+
+void QG_CommandHistory::append(const QString& message)
+{
+    if (!m_pending.isEmpty() && m_pending.last().first == message) {
+        ++m_pending.last().second;
+        return;
+    }
+    m_pending.append({message, 1});
+    // older messages would be dropped by the line limit anyway
+    const int lines = getMaximumLines();
+    if (lines > 0 && m_pending.size() > lines)
+        m_pending.removeFirst();
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void QG_CommandHistory::slotFlush()
+{
+    if (m_pending.isEmpty())
+        return;
+    QStringList lines;
+    lines.reserve(m_pending.size());
+    for (const auto& [message, count]: m_pending) {
+        if (count > 1)
+            lines << tr("%1 (repeated %2 times)").arg(message).arg(count);
+        else
+            lines << message;
+    }
+    m_pending.clear();
+    // a single insertion for all the queued messages
+    appendPlainText(lines.join('\n'));
+}
+
+void QG_CommandHistory::clear()
+{
+    m_pending.clear();
+    m_flushTimer.stop();
+    QPlainTextEdit::clear();
 }
 
+void QG_CommandHistory::setMaximumLines(int lines)
+{
+    setMaximumBlockCount(std::max(lines, 0));
+}
+
+int QG_CommandHistory::getMaximumLines() const
+{
+    return maximumBlockCount();
+}
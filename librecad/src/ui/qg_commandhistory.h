@@ -26,30 +26,52 @@
 
 #ifndef QG_COMMANDHISTORY_H
 #define QG_COMMANDHISTORY_H
-#include <QTextEdit>
+#include <QPair>
+#include <QPlainTextEdit>
+#include <QTimer>
+#include <QVector>
 
 /**
  * @brief The QG_CommandHistory class holds commands and messages.
- * It's a read only textedit widget.
+ * It's a read only plain text widget, which lays out the visible lines only and
+ * keeps a limited number of lines, the oldest lines are dropped.
  * \author ravas
  */
-class QG_CommandHistory : public QTextEdit
+class QG_CommandHistory : public QPlainTextEdit
 {
     Q_OBJECT
 
 public:
     explicit QG_CommandHistory(QWidget* parent);
 
+    /**
+     * @brief append queues a message. Messages are appended together once the event
+     * loop runs, so messages of loops are shown at once and repeats are merged
+     */
+    void append(const QString& message);
+
+    //! the maximum number of lines kept, 0 for no limit
+    void setMaximumLines(int lines);
+    int getMaximumLines() const;
+
+public slots:
+    void clear();
+
 private slots:
 
     void mouseReleaseEvent(QMouseEvent* event) override;
 	void slotTextChanged();
+	void slotFlush();
 
 private:
 	/*menu item for Copy*/
     QAction* m_pCopy = nullptr;
 	/*menu item for Select All*/
     QAction* m_pSelectAll = nullptr;
+
+    // queued messages and the number of consecutive repeats of each
+    QVector<QPair<QString, int>> m_pending;
+    QTimer m_flushTimer;
 };
 
 #endif // QG_COMMANDHISTORY_H
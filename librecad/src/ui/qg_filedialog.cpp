@@ -43,7 +43,7 @@ void QG_FileDialog::getType(const QString filter)
         ftype = RS2::FormatLFF;
     } else if (filter == fCxf) {
         ftype = RS2::FormatCXF;
-    } else if (filter == fDxfrw2007 || filter == fDxfrw) {
+    } else if (filter == fDxfrw2007 || filter == fDxfrw || filter == fDxfrwGz) {
         ftype = RS2::FormatDXFRW;
     } else if (filter == fDxfrw2004) {
         ftype = RS2::FormatDXFRW2004;
@@ -53,6 +53,8 @@ void QG_FileDialog::getType(const QString filter)
         ftype = RS2::FormatDXFRW14;
     } else if (filter == fDxfrw12) {
         ftype = RS2::FormatDXFRW12;
+    } else if (filter == fDxfrwBinary) {
+        ftype = RS2::FormatDXFRWBinary;
 #ifdef DWGSUPPORT
     } else if (filter == fDwg) {
         ftype = RS2::FormatDWG;
@@ -89,7 +91,9 @@ QG_FileDialog::QG_FileDialog(QWidget* parent, Qt::WindowFlags f, FileType type)
     fDxfrw2000 = tr("Drawing Exchange DXF 2000 %1").arg("(*.dxf)");
     fDxfrw14 = tr("Drawing Exchange DXF R14 %1").arg("(*.dxf)");
     fDxfrw12 = tr("Drawing Exchange DXF R12 %1").arg("(*.dxf)");
-    fDxfrw = tr("Drawing Exchange %1").arg("(*.dxf)");
+    fDxfrwBinary = tr("Binary Drawing Exchange DXF 2007 %1").arg("(*.dxf)");
+    fDxfrw = tr("Drawing Exchange %1").arg("(*.dxf *.dxf.gz)");
+    fDxfrwGz = tr("Compressed Drawing Exchange DXF 2007 %1").arg("(*.dxf.gz)");
 
     fLff = tr("LFF Font %1").arg("(*.lff)");
 #ifdef DWGSUPPORT
@@ -208,9 +212,9 @@ QString QG_FileDialog::getSaveFile(RS2::FormatType* type){
     QStringList filters;
 
 #ifdef JWW_WRITE_SUPPORT
-    filters << fDxfrw2007 << fDxfrw2004 << fDxfrw2000 << fDxfrw14 << fDxfrw12 << fJww << fLff << fCxf;
+    filters << fDxfrw2007 << fDxfrwGz << fDxfrw2004 << fDxfrw2000 << fDxfrw14 << fDxfrw12 << fDxfrwBinary << fJww << fLff << fCxf;
 #else
-    filters << fDxfrw2007 << fDxfrw2004 << fDxfrw2000 << fDxfrw14 << fDxfrw12 << fLff << fCxf;
+    filters << fDxfrw2007 << fDxfrwGz << fDxfrw2004 << fDxfrw2000 << fDxfrw14 << fDxfrw12 << fDxfrwBinary << fLff << fCxf;
 #endif
 
     ftype = RS2::FormatDXFRW;
@@ -257,7 +261,10 @@ QString QG_FileDialog::getSaveFile(RS2::FormatType* type){
         *type = ftype;
 
     // append default extension:
-    if (!fi.fileName().endsWith(".dxf",Qt::CaseInsensitive))
+    if (selectedNameFilter() == fDxfrwGz) {
+        if (!fi.fileName().endsWith(".dxf.gz",Qt::CaseInsensitive))
+            fn += ".dxf.gz";
+    } else if (!fi.fileName().endsWith(".dxf",Qt::CaseInsensitive))
         fn += getExtension(ftype);
 
     // store new default settings:
@@ -302,6 +309,7 @@ QString QG_FileDialog::getSaveFileName(QWidget* parent, RS2::FormatType* type) {
     filters.append("Drawing Exchange DXF 2000 (*.dxf)");
     filters.append("Drawing Exchange DXF R14 (*.dxf)");
     filters.append("Drawing Exchange DXF R12 (*.dxf)");
+    filters.append("Binary Drawing Exchange DXF 2007 (*.dxf)");
     filters.append("LFF Font (*.lff)");
     filters.append("Font (*.cxf)");
     filters.append("JWW (*.jww)");
@@ -351,6 +359,8 @@ QString QG_FileDialog::getSaveFileName(QWidget* parent, RS2::FormatType* type) {
                     *type = RS2::FormatDXFRW14;
                 } else if (fileDlg->selectedNameFilter()=="Drawing Exchange DXF R12 (*.dxf)") {
                     *type = RS2::FormatDXFRW12;
+                } else if (fileDlg->selectedNameFilter()=="Binary Drawing Exchange DXF 2007 (*.dxf)") {
+                    *type = RS2::FormatDXFRWBinary;
                 } else if (fileDlg->selectedNameFilter()=="JWW (*.jww)") {
                     *type = RS2::FormatJWW;
                 } else {
@@ -61,7 +61,9 @@ private:
     QString fDxfrw2000;
     QString fDxfrw14;
     QString fDxfrw12;
+    QString fDxfrwBinary;
     QString fDxfrw;
+    QString fDxfrwGz;
 #ifdef DWGSUPPORT
     QString fDwg;
 #endif
@@ -24,17 +24,29 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
 #include <cmath>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <tuple>
+#include <vector>
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QGridLayout>
+#include <QImage>
 #include <QLabel>
 #include <QMenu>
 #include <QNativeGestureEvent>
 #include <QPoint>
 #include <QPointingDevice>
+#include <QStringList>
+#include <QThreadPool>
 #include <QTimer>
+#include <QTransform>
 
 #include "qc_applicationwindow.h"
 
@@ -43,6 +55,8 @@
 #include "qg_graphicview.h"
 #include "qg_scrollbar.h"
 
+#include "lc_trace.h"
+
 #include "rs_actionblocksedit.h"
 #include "rs_actiondefault.h"
 #include "rs_actionmodifydelete.h"
@@ -56,11 +70,14 @@
 #include "rs_debug.h"
 #include "rs_eventhandler.h"
 #include "rs_graphic.h"
+#include "rs_grid.h"
 #include "rs_insert.h"
+#include "rs_line.h"
 #include "rs_math.h"
 #include "rs_modification.h"
 #include "rs_painterqt.h"
 #include "rs_settings.h"
+#include "rs_staticgraphicview.h"
 
 #ifdef EMU_C99
 #include "emu_c99.h"
@@ -247,6 +264,186 @@ struct QG_GraphicView::AutoPanData
     const RS_Vector probedAreaOffset = {50 /* pixels */, 50 /* pixels */};
 };
 
+// The rendered drawing, cached in tiles aligned to the graph coordinates.
+// Tiles are keyed by zoom factors and tile indices, so panning only renders
+// newly exposed tiles
+struct QG_GraphicView::TileCache
+{
+    // width and height of tiles in pixels
+    static constexpr int tileSize = 256;
+    // the lower limit of cached tiles
+    static constexpr size_t minTiles = 64;
+
+    struct Key {
+        double factorX = 1.;
+        double factorY = 1.;
+        // the tile covers pixels [column*tileSize, (column+1)*tileSize) from the graph origin
+        int column = 0;
+        int row = 0;
+
+        bool operator < (const Key& other) const
+        {
+            return std::tie(factorX, factorY, column, row)
+                    < std::tie(other.factorX, other.factorY, other.column, other.row);
+        }
+
+        // the area covered in graph coordinates
+        LC_Rect area() const
+        {
+            return {{column * tileSize / factorX, - (row + 1) * tileSize / factorY},
+                {(column + 1) * tileSize / factorX, - row * tileSize / factorY}};
+        }
+    };
+
+    struct Tile {
+        QPixmap pixmap;
+        // the invalidated part of the tile, in pixels within the tile
+        QRect dirty;
+        unsigned long long lastUsed = 0;
+    };
+
+    // evict the least recently used tiles
+    void trim(size_t maxTiles)
+    {
+        if (tiles.size() <= maxTiles)
+            return;
+        std::vector<std::pair<unsigned long long, Key>> used;
+        used.reserve(tiles.size());
+        for (const auto& [key, tile]: tiles)
+            used.emplace_back(tile.lastUsed, key);
+        auto last = used.begin() + (used.size() - maxTiles);
+        std::nth_element(used.begin(), last, used.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+        std::for_each(used.begin(), last, [this](const auto& item) {
+            tiles.erase(item.second);
+        });
+    }
+
+    std::map<Key, Tile> tiles;
+    // increased for each composition of the drawing
+    unsigned long long frame = 0;
+    // while a part of a tile is rendered, the view is reduced to the part
+    QSize renderSize;
+
+    // workers for concurrent rendering of tiles, each has its own tile sized view
+    QThreadPool pool;
+    std::vector<std::unique_ptr<RS_StaticGraphicView>> views;
+
+    // zoom factors of the last fully rendered composition. While zooming, tiles of
+    // these factors are scaled, until zooming settles
+    RS_Vector composedFactor{false};
+    QTimer settleTimer;
+    // the delay in ms after the last zoom step, before tiles are rendered
+    static constexpr int settleDelay = 150;
+
+    // print preview: changing the scale, the paper or the centering renders the whole
+    // page again. The page is drafted at a reduced resolution first, and the tiles are
+    // rendered once the changes settle
+    static constexpr int draftScale = 2;
+    static constexpr double draftLodThreshold = 2.;
+    // set by the settle timer: render the tiles, instead of a draft
+    bool refine = false;
+};
+
+// The rendered meta grid and grid, with a margin around the view. View offsets are
+// whole pixels, so panning shifts the grids by whole pixels: the rendered grids are
+// drawn as a texture, offset by the pan, until the view leaves the margin, or the zoom,
+// the grid widths, the colors or the view size change
+struct QG_GraphicView::GridCache
+{
+    struct Key {
+        RS_Vector factor{false};
+        QSize size;
+        RS_Vector gridWidth{false};
+        RS_Vector metaGridWidth{false};
+        bool isometric = false;
+        RS_Color gridColor;
+        RS_Color metaGridColor;
+
+        bool operator == (const Key& other) const
+        {
+            return factor == other.factor && size == other.size && gridWidth == other.gridWidth
+                    && metaGridWidth == other.metaGridWidth && isometric == other.isometric
+                    && gridColor == other.gridColor && metaGridColor == other.metaGridColor;
+        }
+    };
+
+    Key key;
+    QPixmap pixmap;
+    // the view offsets the grids were rendered with
+    int offsetX = 0;
+    int offsetY = 0;
+    // the margin around the view in pixels, a quarter of the view
+    int margin = 0;
+};
+
+// The latest mouse move not processed yet. Actions snap and rebuild their previews on
+// each move, so moves arriving faster than the display refreshes are coalesced: a move is
+// processed at once, if the previous one was processed at least a frame ago, otherwise
+// the latest move is processed by the timer at the next frame. The previews are painted
+// by paint events, at most once per frame
+struct QG_GraphicView::Suspension {
+    // idle time of a suspended view before its buffers are released, in ms
+    static constexpr int releaseDelay = 60000;
+
+    bool suspended = false;
+    QTimer releaseTimer;
+};
+
+struct QG_GraphicView::PendingMove {
+    // the frame interval in ms, by the refresh rate of the screen
+    static int frameInterval(const RS_GraphicView& view)
+    {
+        return std::max(1, int(1000. / view.getScreenMetrics().refreshRate));
+    }
+
+    std::unique_ptr<QMouseEvent> event;
+    QTimer timer;
+    // since the previous move was processed
+    QElapsedTimer elapsed;
+};
+
+// Results posted by background work, e.g. asynchronous snaps. The first result of a
+// batch wakes the view, the batch is applied at most once per frame, with one redraw
+struct QG_GraphicView::ResultBatch {
+    QTimer timer;
+    // since the previous batch was applied
+    QElapsedTimer elapsed;
+};
+
+// Statistics of the last frame, and the times of recent frames for the graph of the
+// performance overlay
+struct QG_GraphicView::FrameHistory {
+    static constexpr size_t size = 120;
+
+    void add(double frameTime)
+    {
+        if (times.size() < size)
+            times.push_back(frameTime);
+        else
+            times[next] = frameTime;
+        next = (next + 1) % size;
+    }
+
+    FrameStatistics last;
+    // frame times in ms, a ring buffer starting at next, once it is full
+    std::vector<double> times;
+    size_t next = 0;
+    // the regenerations until the last frame
+    LC_RegenStatistics::Snapshot regenerationsTotal = LC_RegenStatistics::getSnapshot();
+    // the last frame with regenerations, usually the redraw after an edit
+    LC_RegenStatistics::Snapshot lastRegenerations;
+};
+
+namespace {
+// floor division for tile indices
+int floorDiv(int a, int b)
+{
+    return a / b - ((a % b != 0 && (a < 0) != (b < 0)) ? 1 : 0);
+}
+}
+
 
 /**
  * Constructor.
@@ -262,9 +459,39 @@ QG_GraphicView::QG_GraphicView(QWidget* parent, Qt::WindowFlags f, RS_Document*
     ,redrawMethod(RS2::RedrawAll)
     ,isSmoothScrolling(false)
     , m_panData{std::make_unique<AutoPanData>()}
+    , m_tileCache{std::make_unique<TileCache>()}
+    , m_gridCache{std::make_unique<GridCache>()}
+    , m_pendingMove{std::make_unique<PendingMove>()}
+    , m_resultBatch{std::make_unique<ResultBatch>()}
+    , m_suspension{std::make_unique<Suspension>()}
+    , m_frameHistory{std::make_unique<FrameHistory>()}
 {
     RS_DEBUG->print("QG_GraphicView::QG_GraphicView()..");
 
+    m_pendingMove->timer.setSingleShot(true);
+    connect(&m_pendingMove->timer, &QTimer::timeout, this, &QG_GraphicView::processPendingMove);
+
+    m_resultBatch->timer.setSingleShot(true);
+    connect(&m_resultBatch->timer, &QTimer::timeout, this, &QG_GraphicView::applyResultBatch);
+
+    m_tileCache->settleTimer.setSingleShot(true);
+    m_tileCache->settleTimer.setInterval(TileCache::settleDelay);
+    connect(&m_tileCache->settleTimer, &QTimer::timeout, this, [this]() {
+        m_tileCache->composedFactor = RS_Vector{false};
+        m_tileCache->refine = true;
+        redraw(RS2::RedrawView);
+    });
+
+    m_suspension->releaseTimer.setSingleShot(true);
+    m_suspension->releaseTimer.setInterval(Suspension::releaseDelay);
+    connect(&m_suspension->releaseTimer, &QTimer::timeout, this, &QG_GraphicView::releaseBuffers);
+
+    loadWheelOptions();
+    connect(RS_SETTINGS, &RS_Settings::optionChanged, this, [this](const QString& key) {
+        if (key.startsWith("/Defaults/"))
+            loadWheelOptions();
+    });
+
     if (doc != nullptr)
     {
         setContainer(doc);
@@ -285,6 +512,13 @@ QG_GraphicView::QG_GraphicView(QWidget* parent, Qt::WindowFlags f, RS_Document*
     view_rect = LC_Rect(toGraph(0, 0), toGraph(getWidth(), getHeight()));
 }
 
+void QG_GraphicView::loadWheelOptions() {
+    auto groupGuard = RS_SETTINGS->beginGroupGuard("/Defaults");
+    m_invertZoom = RS_SETTINGS->readNumEntry("/InvertZoomDirection", 0) == 1;
+    m_invertScrollH = RS_SETTINGS->readNumEntry("/WheelScrollInvertH", 0) == 1;
+    m_invertScrollV = RS_SETTINGS->readNumEntry("/WheelScrollInvertV", 0) == 1;
+}
+
 
 
 /**
@@ -301,6 +535,8 @@ QG_GraphicView::~QG_GraphicView() {
  */
 int QG_GraphicView::getWidth() const
 {
+    if (m_tileCache->renderSize.isValid())
+        return m_tileCache->renderSize.width();
     if (scrollbars)
         return width() - vScrollBar->sizeHint().width();
     else
@@ -314,6 +550,8 @@ int QG_GraphicView::getWidth() const
  */
 int QG_GraphicView::getHeight() const
 {
+    if (m_tileCache->renderSize.isValid())
+        return m_tileCache->renderSize.height();
     if (scrollbars)
         return height() - hScrollBar->sizeHint().height();
     else
@@ -326,6 +564,8 @@ int QG_GraphicView::getHeight() const
  */
 void QG_GraphicView::setBackground(const RS_Color& bg) {
     RS_GraphicView::setBackground(bg);
+    // pen colors depend on the background
+    m_tileCache->tiles.clear();
 
     QPalette palette;
     palette.setColor(backgroundRole(), bg);
@@ -429,7 +669,26 @@ void QG_GraphicView::updateGridStatusWidget(QString text)
  * Redraws the widget.
  */
 void QG_GraphicView::redraw(RS2::RedrawMethod method) {
+        if (deferRedraw(method))
+            return;
+        // the drawing may be changed anywhere
+        if (method & RS2::RedrawDrawing) {
+            m_tileCache->tiles.clear();
+            m_tileCache->composedFactor = RS_Vector{false};
+        }
         redrawMethod=(RS2::RedrawMethod ) (redrawMethod | method);
+        if (method == RS2::RedrawSnapper) {
+            // the old and the new cursor positions only
+            QRegion region = m_snapperRegion.united(getSnapperRegion());
+            if (m_performanceHud)
+                region += getHudRect();
+            if (!m_suspension->suspended)
+                update(region);
+            return;
+        }
+        // hidden views are marked dirty only, and painted when shown again
+        if (m_suspension->suspended)
+            return;
         update(); // Paint when reeady to pain
 //	repaint(); //Paint immediate
 }
@@ -442,12 +701,13 @@ void QG_GraphicView::resizeEvent(QResizeEvent* /*e*/) {
 //     updateGrid();
         // Small hack, delete the snapper during resizes
         getOverlayContainer(RS2::Snapper)->clear();
-        redraw();
+        redraw(RS2::RedrawView);
     RS_DEBUG->print("QG_GraphicView::resizeEvent end");
 }
 
 void QG_GraphicView::mousePressEvent(QMouseEvent* event)
 {
+    processPendingMove();
     // pan zoom with middle mouse button
     if (event->button()==Qt::MiddleButton)
     {
@@ -458,6 +718,7 @@ void QG_GraphicView::mousePressEvent(QMouseEvent* event)
 
 void QG_GraphicView::mouseDoubleClickEvent(QMouseEvent* e)
 {
+    processPendingMove();
     switch(e->button())
     {
         default:
@@ -484,6 +745,7 @@ void QG_GraphicView::mouseReleaseEvent(QMouseEvent* event)
 {
     RS_DEBUG->print("QG_GraphicView::mouseReleaseEvent");
 
+    processPendingMove();
     event->accept();
 
     switch (event->button())
@@ -578,6 +840,7 @@ void QG_GraphicView::addEditEntityEntry(QMouseEvent* event, QMenu& contextMenu)
 void QG_GraphicView::mouseMoveEvent(QMouseEvent* event)
 {
     if (isAutoPan(event)) {
+        processPendingMove();
         startAutoPanTimer(event);
         event->accept();
         return;
@@ -585,7 +848,50 @@ void QG_GraphicView::mouseMoveEvent(QMouseEvent* event)
     m_panData->panTimer.reset();
     // handle auto-panning
     event->accept();
-    eventHandler->mouseMoveEvent(event);
+
+    m_pendingMove->event.reset(event->clone());
+    if (m_pendingMove->timer.isActive())
+        return;
+    const int frameInterval = PendingMove::frameInterval(*this);
+    if (!m_pendingMove->elapsed.isValid() || m_pendingMove->elapsed.elapsed() >= frameInterval)
+        processPendingMove();
+    else
+        m_pendingMove->timer.start(int(frameInterval - m_pendingMove->elapsed.elapsed()));
+}
+
+/**
+ * Processes the latest mouse move not processed yet, also called before other
+ * input events, so their actions see the current cursor position.
+ */
+void QG_GraphicView::processPendingMove()
+{
+    m_pendingMove->timer.stop();
+    std::unique_ptr<QMouseEvent> event = std::move(m_pendingMove->event);
+    if (event == nullptr)
+        return;
+    m_pendingMove->elapsed.start();
+    eventHandler->mouseMoveEvent(event.get());
+}
+
+void QG_GraphicView::scheduleResults()
+{
+    // called by a worker thread, the timer is started by the GUI thread
+    QMetaObject::invokeMethod(this, [this]() {
+        const qint64 interval = PendingMove::frameInterval(*this);
+        const qint64 elapsed = m_resultBatch->elapsed.isValid()
+                ? m_resultBatch->elapsed.elapsed() : interval;
+        if (elapsed >= interval)
+            applyResultBatch();
+        else if (!m_resultBatch->timer.isActive())
+            m_resultBatch->timer.start(int(interval - elapsed));
+    }, Qt::QueuedConnection);
+}
+
+void QG_GraphicView::applyResultBatch()
+{
+    m_resultBatch->timer.stop();
+    m_resultBatch->elapsed.start();
+    applyResults();
 }
 
 bool QG_GraphicView::event(QEvent *event)
@@ -743,6 +1049,7 @@ void QG_GraphicView::tabletEvent(QTabletEvent* e) {
 }
 
 void QG_GraphicView::leaveEvent(QEvent* e) {
+    processPendingMove();
     // stop auto-panning
     m_panData->panTimer.reset();
 
@@ -771,6 +1078,7 @@ void QG_GraphicView::focusInEvent(QFocusEvent* e) {
  * shift or ctrl is pressed.
  */
 void QG_GraphicView::wheelEvent(QWheelEvent *e) {
+    processPendingMove();
     //RS_DEBUG->print("wheel: %d", e->delta());
 
     //printf("state: %d\n", e->state());
@@ -807,12 +1115,8 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
         {
             if (e->modifiers()==Qt::ControlModifier)
             {
-                RS_SETTINGS->beginGroup("/Defaults");
-                bool invZoom = (RS_SETTINGS->readNumEntry("/InvertZoomDirection", 0) == 1);
-                RS_SETTINGS->endGroup();
-
                 // Hold ctrl to zoom. 1 % per pixel
-                double v = (invZoom) ? (numPixels.y() / zoomWheelDivisor) : (-numPixels.y() / zoomWheelDivisor);
+                double v = (m_invertZoom) ? (numPixels.y() / zoomWheelDivisor) : (-numPixels.y() / zoomWheelDivisor);
                 RS2::ZoomDirection direction;
                 double factor;
 
@@ -827,13 +1131,8 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
             }
             else
             {
-                RS_SETTINGS->beginGroup("/Defaults");
-                bool inv_h = (RS_SETTINGS->readNumEntry("/WheelScrollInvertH", 0) == 1);
-                bool inv_v = (RS_SETTINGS->readNumEntry("/WheelScrollInvertV", 0) == 1);
-                RS_SETTINGS->endGroup();
-
-                int hDelta = (inv_h) ? -numPixels.x() : numPixels.x();
-                int vDelta = (inv_v) ? -numPixels.y() : numPixels.y();
+                int hDelta = (m_invertScrollH) ? -numPixels.x() : numPixels.x();
+                int vDelta = (m_invertScrollV) ? -numPixels.y() : numPixels.y();
 
                 // scroll by scrollbars: issue #479 (it has its own issues)
                 if (scrollbars)
@@ -847,7 +1146,7 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
                                                              *container, *this));
                 }
             }
-            redraw();
+            redraw(RS2::RedrawView);
         }
         e->accept();
         return;
@@ -889,21 +1188,16 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
     if (scroll && scrollbars) {
 		//scroll by scrollbars: issue #479
 
-        RS_SETTINGS->beginGroup("/Defaults");
-        bool inv_h = (RS_SETTINGS->readNumEntry("/WheelScrollInvertH", 0) == 1);
-        bool inv_v = (RS_SETTINGS->readNumEntry("/WheelScrollInvertV", 0) == 1);
-        RS_SETTINGS->endGroup();
-
         int delta = 0;
 
 		switch(direction){
 		case RS2::Left:
 		case RS2::Right:
-            delta = (inv_h) ? -e->angleDelta().x() : e->angleDelta().x();
+            delta = (m_invertScrollH) ? -e->angleDelta().x() : e->angleDelta().x();
 			hScrollBar->setValue(hScrollBar->value()+delta);
 			break;
 		default:
-            delta = (inv_v) ? -e->angleDelta().y() : e->angleDelta().y();
+            delta = (m_invertScrollV) ? -e->angleDelta().y() : e->angleDelta().y();
 			vScrollBar->setValue(vScrollBar->value()+delta);
 		}
 
@@ -913,16 +1207,13 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
 
     // zoom in / out:
     else if (e->modifiers()==0) {
-        auto groupGuard = RS_SETTINGS->beginGroupGuard("/Defaults");
-        bool invZoom = RS_SETTINGS->readNumEntry("/InvertZoomDirection", 0) == 1;
-
-        RS2::ZoomDirection zoomDirection = ((e->angleDelta().y() > 0) != invZoom) ? RS2::In : RS2::Out;
+        RS2::ZoomDirection zoomDirection = ((e->angleDelta().y() > 0) != m_invertZoom) ? RS2::In : RS2::Out;
 
         RS_Vector& zoomCenter = mouse;
 
         setCurrentAction(new RS_ActionZoomIn(*container, *this, zoomDirection, RS2::Both, &zoomCenter, zoomFactor));
     }
-    redraw();
+    redraw(RS2::RedrawView);
 
     QMouseEvent event
     {
@@ -948,6 +1239,7 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
         if (container == nullptr) {
             return;
         }
+        processPendingMove();
 
         bool scroll = false;
         RS2::Direction direction = RS2::Up;
@@ -982,6 +1274,7 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
 
     void QG_GraphicView::keyReleaseEvent(QKeyEvent * e)
     {
+        processPendingMove();
         eventHandler->keyReleaseEvent(e);
     }
 
@@ -1007,6 +1300,8 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
         int ox = getOffsetX();
         int oy = getOffsetY();
 
+        // cached by the container until the entities change
+        container->updateBorders();
         RS_Vector min = container->getMin();
         RS_Vector max = container->getMax();
 
@@ -1095,7 +1390,7 @@ void QG_GraphicView::slotHScrolled(int value) {
     }
     //if (isUpdateEnabled()) {
 //         updateGrid();
-    redraw();
+    redraw(RS2::RedrawView);
 }
 
 
@@ -1119,7 +1414,7 @@ void QG_GraphicView::slotVScrolled(int value) {
     }
     //if (isUpdateEnabled()) {
   //  updateGrid();
-    redraw();
+    redraw(RS2::RedrawView);
 }
 /**
  * @brief setOffset
@@ -1144,6 +1439,44 @@ RS_Vector QG_GraphicView::getMousePosition() const
     return toGraph(vp.x(), vp.y());
 }
 
+void QG_GraphicView::setRenderingSuspended(bool state)
+{
+    if (state == m_suspension->suspended)
+        return;
+    m_suspension->suspended = state;
+    if (state) {
+        m_suspension->releaseTimer.start();
+        return;
+    }
+    m_suspension->releaseTimer.stop();
+    // the collected redraws
+    update();
+}
+
+bool QG_GraphicView::isRenderingSuspended() const
+{
+    return m_suspension->suspended;
+}
+
+/**
+ * Releases the pixmaps of a suspended view, so memory is held by visible views only.
+ * The view is rendered from scratch when resumed
+ */
+void QG_GraphicView::releaseBuffers()
+{
+    if (!m_suspension->suspended)
+        return;
+    RS_DEBUG->print("QG_GraphicView::releaseBuffers: view is hidden");
+    PixmapLayer1.reset();
+    PixmapLayer2.reset();
+    PixmapLayer3.reset();
+    m_tileCache->tiles.clear();
+    m_tileCache->composedFactor = RS_Vector{false};
+    m_gridCache->key = {};
+    m_gridCache->pixmap = QPixmap{};
+    redrawMethod = RS2::RedrawAll;
+}
+
 void QG_GraphicView::getPixmapForView(std::unique_ptr<QPixmap>& pm)
 {
 	QSize const s0(getWidth(), getHeight());
@@ -1208,8 +1541,18 @@ void QG_GraphicView::layerActivated(RS_Layer *layer) {
  * usually that's very fast since we only paint the buffer we
  * have from the last call..
  */
-void QG_GraphicView::paintEvent(QPaintEvent *)
+void QG_GraphicView::paintEvent(QPaintEvent *event)
 {
+    LC_TRACE_ZONE("QG_GraphicView::paintEvent");
+    FrameStatistics& frame = m_frameHistory->last;
+    frame = {};
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+    QElapsedTimer layerTimer;
+
+    // painted anyway, so the view isn't hidden
+    if (m_suspension->suspended)
+        setRenderingSuspended(false);
 
     // Re-Create or get the layering pixmaps
     getPixmapForView(PixmapLayer1);
@@ -1219,33 +1562,37 @@ void QG_GraphicView::paintEvent(QPaintEvent *)
     // Draw Layer 1
     if (redrawMethod & RS2::RedrawGrid)
     {
+        LC_TRACE_ZONE("grid layer");
+        layerTimer.start();
         PixmapLayer1->fill(getBackground());
         RS_PainterQt painter1(PixmapLayer1.get());
         drawLayer1((RS_Painter*)&painter1);
-        painter1.end();
+        painter1.flushAndEnd();
+        frame.gridTime = layerTimer.nsecsElapsed() * 1e-6;
     }
 
-    if (redrawMethod & RS2::RedrawDrawing)
+    if (redrawMethod & (RS2::RedrawDrawing | RS2::RedrawCached))
     {
+        LC_TRACE_ZONE("drawing layer");
+        layerTimer.start();
+        resetDrawStatistics();
         view_rect = LC_Rect(toGraph(0, 0),
                             toGraph(getWidth(), getHeight()));
-        // DRaw layer 2
+        // DRaw layer 2, composed from cached tiles
         PixmapLayer2->fill(Qt::transparent);
         RS_PainterQt painter2(PixmapLayer2.get());
-        if (antialiasing)
-        {
-            painter2.setRenderHint(QPainter::Antialiasing);
-        }
-        painter2.setDrawingMode(drawingMode);
-        painter2.setDrawSelectedOnly(false);
-        drawLayer2((RS_Painter*)&painter2);
-        painter2.setDrawSelectedOnly(true);
-        drawLayer2((RS_Painter*)&painter2);
-        painter2.end();
+        drawTiles(painter2);
+        if (!isPrintPreview())
+            drawAbsoluteZero((RS_Painter*)&painter2);
+        painter2.flushAndEnd();
+        frame.drawing = getDrawStatistics();
+        frame.drawingTime = layerTimer.nsecsElapsed() * 1e-6;
     }
 
     if (redrawMethod & RS2::RedrawOverlay)
     {
+        LC_TRACE_ZONE("overlay layer");
+        layerTimer.start();
         PixmapLayer3->fill(Qt::transparent);
         RS_PainterQt painter3(PixmapLayer3.get());
         if (antialiasing)
@@ -1253,24 +1600,600 @@ void QG_GraphicView::paintEvent(QPaintEvent *)
             painter3.setRenderHint(QPainter::Antialiasing);
         }
         drawLayer3((RS_Painter*)&painter3);
-        painter3.end();
+        painter3.flushAndEnd();
+        frame.overlayTime = layerTimer.nsecsElapsed() * 1e-6;
     }
 
     // Finally paint the layers back on the screen, bitblk to the rescue!
+    // Only the updated region is copied, the whole view for a redraw, or the
+    // strips around the crosshair, if the cursor is moved only
     RS_PainterQt wPainter(this);
-    wPainter.drawPixmap(0,0,*PixmapLayer1);
-    wPainter.drawPixmap(0,0,*PixmapLayer2);
-    wPainter.drawPixmap(0,0,*PixmapLayer3);
-    wPainter.end();
+    for (const QRect& rect: event->region()) {
+        wPainter.drawPixmap(rect, *PixmapLayer1, rect);
+        wPainter.drawPixmap(rect, *PixmapLayer2, rect);
+        wPainter.drawPixmap(rect, *PixmapLayer3, rect);
+    }
+
+    // the snapper on top, without rendering layer 3 again
+    if (antialiasing)
+        wPainter.setRenderHint(QPainter::Antialiasing);
+    drawSnapperOverlay(&wPainter);
+    frame.frameTime = frameTimer.nsecsElapsed() * 1e-6;
+    m_frameHistory->add(frame.frameTime);
+    LC_RegenStatistics::Snapshot regenerationsTotal = LC_RegenStatistics::getSnapshot();
+    frame.regenerations = regenerationsTotal - m_frameHistory->regenerationsTotal;
+    m_frameHistory->regenerationsTotal = std::move(regenerationsTotal);
+    if (!frame.regenerations.isEmpty())
+        m_frameHistory->lastRegenerations = frame.regenerations;
+    if (m_performanceHud)
+        drawPerformanceHud(wPainter);
+    wPainter.flushAndEnd();
+    m_snapperRegion = getSnapperRegion();
 
     redrawMethod=RS2::RedrawNone;
 }
 
+const QG_GraphicView::FrameStatistics& QG_GraphicView::getFrameStatistics() const
+{
+    return m_frameHistory->last;
+}
+
+/**
+ * @brief QG_GraphicView::getHudRect the widget area of the performance overlay, in
+ * the top left corner
+ */
+QRect QG_GraphicView::getHudRect() const
+{
+    return {8, 8, int(FrameHistory::size) * 2 + 16, 160};
+}
+
+/**
+ * @brief QG_GraphicView::drawPerformanceHud draws the statistics of the last frame,
+ * the regenerations before the last frame with any, with their most frequent
+ * reasons, and a graph of recent frame times with marks at 60 and 30 frames per second
+ */
+void QG_GraphicView::drawPerformanceHud(QPainter& painter) const
+{
+    const QRect rect = getHudRect();
+    const FrameStatistics& frame = m_frameHistory->last;
+
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing, false);
+    painter.fillRect(rect, QColor(0, 0, 0, 160));
+    painter.setPen(Qt::white);
+    QFont font = painter.font();
+    font.setPointSize(8);
+    painter.setFont(font);
+
+    QStringList lines{
+        QString("frame %1 ms").arg(frame.frameTime, 0, 'f', 2),
+        QString("grid %1  drawing %2  overlay %3 ms")
+                .arg(frame.gridTime, 0, 'f', 2)
+                .arg(frame.drawingTime, 0, 'f', 2)
+                .arg(frame.overlayTime, 0, 'f', 2),
+        QString("entities %1 visited  %2 culled  %3 drawn")
+                .arg(frame.drawing.visited)
+                .arg(frame.drawing.culled)
+                .arg(frame.drawing.drawn),
+        QString("pen changes %1  painter calls %2")
+                .arg(frame.drawing.penChanges)
+                .arg(frame.drawing.painterCalls)
+    };
+
+    const LC_RegenStatistics::Snapshot& regenerations = m_frameHistory->lastRegenerations;
+    const auto formatRegenerations = [&regenerations](LC_RegenStatistics::Kind kind) {
+        const LC_RegenStatistics::Counter& counter = regenerations.kinds[kind];
+        return QString("%1 %2 %3 ms")
+                .arg(LC_RegenStatistics::getKindName(kind))
+                .arg(counter.count)
+                .arg(counter.ms, 0, 'f', 1);
+    };
+    lines << "regen " + formatRegenerations(LC_RegenStatistics::Hatch)
+             + "  " + formatRegenerations(LC_RegenStatistics::Insert);
+    lines << "regen " + formatRegenerations(LC_RegenStatistics::Text)
+             + "  " + formatRegenerations(LC_RegenStatistics::Dimension);
+    // the reasons with the most regenerations
+    std::vector<std::pair<unsigned long, QString>> reasons;
+    for (const auto& [reason, counters]: regenerations.reasons) {
+        unsigned long count = 0;
+        for (const LC_RegenStatistics::Counter& counter: counters)
+            count += counter.count;
+        reasons.emplace_back(count, reason);
+    }
+    std::sort(reasons.begin(), reasons.end(), std::greater<>{});
+    for (size_t i = 0; i < std::min<size_t>(reasons.size(), 2); ++i)
+        lines << QString("  %1: %2").arg(reasons[i].second).arg(reasons[i].first);
+    const int lineHeight = painter.fontMetrics().height();
+    int y = rect.top() + 4;
+    for (const QString& line: lines) {
+        painter.drawText(QRect{rect.left() + 8, y, rect.width() - 16, lineHeight},
+                         Qt::AlignLeft | Qt::AlignVCenter,
+                         painter.fontMetrics().elidedText(line, Qt::ElideRight, rect.width() - 16));
+        y += lineHeight;
+    }
+
+    // the graph, 50 ms high, oldest frames on the left
+    const QRect graph{rect.left() + 8, y + 4, rect.width() - 16, rect.bottom() - y - 8};
+    if (graph.height() > 0) {
+        constexpr double graphTime = 50.;
+        const double scale = graph.height() / graphTime;
+        const std::vector<double>& times = m_frameHistory->times;
+        const size_t start = times.size() < FrameHistory::size ? 0 : m_frameHistory->next;
+        for (size_t i = 0; i < times.size(); ++i) {
+            const double time = times[(start + i) % times.size()];
+            const int height = std::max(1, std::min(graph.height(), int(time * scale)));
+            const QColor color = time > 1000. / 30. ? QColor(Qt::red)
+                               : time > 1000. / 60. ? QColor(Qt::yellow) : QColor(Qt::green);
+            painter.fillRect(graph.left() + int(i) * 2, graph.bottom() - height + 1, 2, height, color);
+        }
+        painter.setPen(QColor(255, 255, 255, 128));
+        for (const double time: {1000. / 60., 1000. / 30.}) {
+            const int lineY = graph.bottom() - int(time * scale);
+            painter.drawLine(graph.left(), lineY, graph.right(), lineY);
+        }
+    }
+    painter.restore();
+}
+
+namespace {
+// the region covered by a line in the widget, as strips along the line, so
+// diagonal crosshair lines don't cover their whole bounding box
+void addLineRegion(QRegion& region, const RS_Vector& p1, const RS_Vector& p2, int margin)
+{
+    constexpr double stripLength = 32.;
+    const int strips = std::max(1, int(std::ceil(p1.distanceTo(p2) / stripLength)));
+    RS_Vector start = p1;
+    for (int i = 1; i <= strips; ++i) {
+        const RS_Vector end = p1 + (p2 - p1) * (double(i) / strips);
+        const QRect rect = QRectF{QPointF{start.x, start.y}, QPointF{end.x, end.y}}
+                .normalized().toAlignedRect();
+        region += rect.adjusted(-margin, -margin, margin, margin);
+        start = end;
+    }
+}
+}
+
+/**
+ * @brief QG_GraphicView::getSnapperRegion the region of the widget covered by the
+ * crosshair and the snap indicator
+ */
+QRegion QG_GraphicView::getSnapperRegion()
+{
+    // margin for the pen width and antialiasing
+    constexpr int margin = 4;
+    QRegion region;
+    RS_EntityContainer* snapper = getOverlayContainer(RS2::Snapper);
+    for (RS_Entity* e: snapper->getEntityList()) {
+        if (e->rtti() == RS2::EntityOverlayLine) {
+            // overlay lines are in GUI coordinates already
+            auto* line = static_cast<RS_Line*>(e);
+            addLineRegion(region, line->getStartpoint(), line->getEndpoint(), margin);
+        } else {
+            // points are drawn by the point size of the view
+            const int size = std::max(margin, getHeight() / 20);
+            const RS_Vector minV = toGui(e->getMin());
+            const RS_Vector maxV = toGui(e->getMax());
+            const QRect rect = QRectF{QPointF{minV.x, minV.y}, QPointF{maxV.x, maxV.y}}
+                    .normalized().toAlignedRect();
+            region += rect.adjusted(-size, -size, size, size);
+        }
+    }
+    return region;
+}
+
+/**
+ * Draws the meta grid and the grid from the grid cache. The grids are rendered
+ * again, once the cache doesn't cover the view anymore.
+ */
+void QG_GraphicView::drawGrids(RS_Painter *painter)
+{
+    RS_Grid* grid = getGrid();
+    if (grid == nullptr || !isGridOn())
+        return;
+
+    grid->updateGridWidth();
+    GridCache& cache = *m_gridCache;
+    const GridCache::Key key{getFactor(), {getWidth(), getHeight()}, grid->getGridWidth(),
+                             grid->getMetaGridWidth(), grid->isIsometric(),
+                             getGridColor(), getMetaGridColor()};
+    const int offsetX = getOffsetX();
+    const int offsetY = getOffsetY();
+    if (cache.pixmap.isNull() || !(cache.key == key)
+            || std::abs(offsetX - cache.offsetX) > cache.margin
+            || std::abs(offsetY - cache.offsetY) > cache.margin) {
+        cache.key = key;
+        cache.offsetX = offsetX;
+        cache.offsetY = offsetY;
+        cache.margin = std::max(key.size.width(), key.size.height()) / 4;
+        const QSize size = key.size + QSize{2 * cache.margin, 2 * cache.margin};
+        cache.pixmap = QPixmap(size);
+        cache.pixmap.fill(Qt::transparent);
+
+        // the view is extended by the margin while rendering
+        m_tileCache->renderSize = size;
+        setOffsetX(offsetX + cache.margin);
+        setOffsetY(offsetY + cache.margin);
+        RS_PainterQt gridPainter(&cache.pixmap);
+        gridPainter.setPen(painter->getPen());
+        RS_GraphicView::drawGrids(&gridPainter);
+        gridPainter.flushAndEnd();
+        setOffsetX(offsetX);
+        setOffsetY(offsetY);
+        m_tileCache->renderSize = {};
+    } else {
+        updateGridStatusWidget(grid->getInfo());
+    }
+
+    // GUI y coordinates decrease with the offset
+    QBrush texture{cache.pixmap};
+    texture.setTransform(QTransform::fromTranslate(offsetX - cache.offsetX - cache.margin,
+                                                   cache.offsetY - offsetY - cache.margin));
+    painter->fillRect(QRectF{0., 0., double(key.size.width()), double(key.size.height())}, texture);
+    // the pen drawGrid() leaves, for the draft sign
+    painter->setPen(getGridColor());
+}
+
+void QG_GraphicView::invalidateArea(const LC_Rect& area)
+{
+    constexpr int size = TileCache::tileSize;
+    const QRect tileRect{0, 0, size, size};
+    auto& tiles = m_tileCache->tiles;
+    for (auto it = tiles.begin(); it != tiles.end(); ) {
+        const TileCache::Key& key = it->first;
+        const LC_Rect tileArea = key.area();
+        if (!tileArea.intersects(area)) {
+            ++it;
+            continue;
+        }
+
+        // the invalidated pixels within the tile, rounded outwards
+        const LC_Rect part = tileArea.intersection(area);
+        const int left = int(std::floor(part.minP().x * key.factorX)) - key.column * size;
+        const int right = int(std::ceil(part.maxP().x * key.factorX)) - key.column * size;
+        const int top = int(std::floor(- part.maxP().y * key.factorY)) - key.row * size;
+        const int bottom = int(std::ceil(- part.minP().y * key.factorY)) - key.row * size;
+        TileCache::Tile& tile = it->second;
+        tile.dirty |= QRect{QPoint{left - 1, top - 1}, QPoint{right + 1, bottom + 1}}.intersected(tileRect);
+        if (tile.dirty == tileRect)
+            it = tiles.erase(it);
+        else
+            ++it;
+    }
+}
+
+/**
+ * Drops the cached tiles intersecting the areas, so they're rendered again like
+ * missing tiles, by the tile workers with parallel rendering. Each area visits the
+ * cached tiles within its range of tile indices only, for many small areas like the
+ * entities of a layer.
+ */
+void QG_GraphicView::invalidateAreas(const std::vector<LC_Rect>& areas)
+{
+    constexpr int size = TileCache::tileSize;
+    auto& tiles = m_tileCache->tiles;
+    const RS_Vector factor = getFactor();
+
+    // tiles of other zoom factors are only scaled while zooming, drop them
+    int column0 = INT_MAX;
+    int column1 = INT_MIN;
+    int row0 = INT_MAX;
+    int row1 = INT_MIN;
+    size_t current = 0;
+    for (auto it = tiles.begin(); it != tiles.end(); ) {
+        const TileCache::Key& key = it->first;
+        if (key.factorX != factor.x || key.factorY != factor.y) {
+            it = tiles.erase(it);
+            continue;
+        }
+        column0 = std::min(column0, key.column);
+        column1 = std::max(column1, key.column);
+        row0 = std::min(row0, key.row);
+        row1 = std::max(row1, key.row);
+        ++current;
+        ++it;
+    }
+
+    // tile indices of graph coordinates, clamped to the cached tiles
+    auto columnOf = [&](double x) {
+        return int(std::clamp(std::floor(x * factor.x / size), double(column0 - 1), double(column1 + 1)));
+    };
+    auto rowOf = [&](double y) {
+        return int(std::clamp(std::floor(- y * factor.y / size), double(row0 - 1), double(row1 + 1)));
+    };
+    for (const LC_Rect& area: areas) {
+        if (current == 0)
+            return;
+        const int c0 = std::max(column0, columnOf(area.minP().x));
+        const int c1 = std::min(column1, columnOf(area.maxP().x));
+        const int r0 = std::max(row0, rowOf(area.maxP().y));
+        const int r1 = std::min(row1, rowOf(area.minP().y));
+        if (c0 > c1 || r0 > r1)
+            continue;
+        if (size_t(c1 - c0 + 1) * size_t(r1 - r0 + 1) > current) {
+            // large areas test the cached tiles
+            for (auto it = tiles.begin(); it != tiles.end(); ) {
+                const TileCache::Key& key = it->first;
+                if (key.column >= c0 && key.column <= c1 && key.row >= r0 && key.row <= r1) {
+                    it = tiles.erase(it);
+                    --current;
+                } else {
+                    ++it;
+                }
+            }
+            continue;
+        }
+        for (int row = r0; row <= r1; ++row) {
+            for (int column = c0; column <= c1; ++column)
+                current -= tiles.erase({factor.x, factor.y, column, row});
+        }
+    }
+}
+
+/**
+ * Composes the drawing of the view from cached tiles. Missing tiles and
+ * invalidated parts of tiles are rendered.
+ */
+void QG_GraphicView::drawTiles(QPainter& painter)
+{
+    constexpr int size = TileCache::tileSize;
+    const RS_Vector factor = getFactor();
+    const int width = getWidth();
+    const int height = getHeight();
+    // the GUI coordinates of the graph origin
+    const int originX = getOffsetX();
+    const int originY = height - getOffsetY();
+
+    const int column0 = floorDiv(- originX, size);
+    const int column1 = floorDiv(width - 1 - originX, size);
+    const int row0 = floorDiv(- originY, size);
+    const int row1 = floorDiv(height - 1 - originY, size);
+
+    std::vector<std::pair<int, int>> missing;
+    for (int row = row0; row <= row1; ++row) {
+        for (int column = column0; column <= column1; ++column) {
+            auto it = m_tileCache->tiles.find({factor.x, factor.y, column, row});
+            if (it == m_tileCache->tiles.end() || it->second.pixmap.isNull())
+                missing.emplace_back(column, row);
+        }
+    }
+
+    // zooming: scale the tiles of the last composition, instead of rendering tiles
+    // for each zoom step
+    const RS_Vector& composed = m_tileCache->composedFactor;
+    if (!missing.empty() && composed.valid && (composed.x != factor.x || composed.y != factor.y)) {
+        drawScaledTiles(painter, composed);
+        m_tileCache->settleTimer.start();
+        return;
+    }
+
+    // print preview: draft the page, if most of it is to be rendered
+    const size_t visible = size_t(column1 - column0 + 1) * size_t(row1 - row0 + 1);
+    if (isPrintPreview() && !m_tileCache->refine && 2 * missing.size() > visible) {
+        drawDraft(painter);
+        m_tileCache->settleTimer.start();
+        return;
+    }
+    m_tileCache->refine = false;
+    m_tileCache->settleTimer.stop();
+    m_tileCache->composedFactor = factor;
+
+    if (parallelRendering && missing.size() >= 2)
+        renderTiles(missing);
+
+    const unsigned long long frame = ++m_tileCache->frame;
+    for (int row = row0; row <= row1; ++row) {
+        for (int column = column0; column <= column1; ++column) {
+            TileCache::Tile& tile = m_tileCache->tiles[{factor.x, factor.y, column, row}];
+            if (tile.pixmap.isNull())
+                renderTile(tile.pixmap, column, row, {0, 0, size, size});
+            else if (!tile.dirty.isEmpty())
+                renderTile(tile.pixmap, column, row, tile.dirty);
+            tile.dirty = {};
+            tile.lastUsed = frame;
+            painter.drawPixmap(originX + column * size, originY + row * size, tile.pixmap);
+        }
+    }
+
+    // keep tiles for panning around the view
+    m_tileCache->trim(std::max(TileCache::minTiles, 4 * visible));
+}
+
+/**
+ * Draws tiles rendered with other zoom factors, scaled to the current zoom.
+ *
+ * @param factor the zoom factors of the tiles
+ */
+void QG_GraphicView::drawScaledTiles(QPainter& painter, const RS_Vector& factor)
+{
+    painter.save();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    for (const auto& [key, tile]: m_tileCache->tiles) {
+        if (key.factorX != factor.x || key.factorY != factor.y || tile.pixmap.isNull())
+            continue;
+        const LC_Rect area = key.area();
+        if (!area.intersects(view_rect))
+            continue;
+        const RS_Vector topLeft = toGui(RS_Vector{area.minP().x, area.maxP().y});
+        const RS_Vector bottomRight = toGui(RS_Vector{area.maxP().x, area.minP().y});
+        painter.drawPixmap(QRectF{QPointF{topLeft.x, topLeft.y}, QPointF{bottomRight.x, bottomRight.y}},
+                           tile.pixmap, QRectF{tile.pixmap.rect()});
+    }
+    painter.restore();
+}
+
+/**
+ * Renders the drawing within a rectangle of a tile. While rendering, the view is
+ * reduced to the rectangle, so entities outside of the rectangle are culled.
+ *
+ * @param rect the rectangle in pixels within the tile
+ */
+void QG_GraphicView::renderTile(QPixmap& pixmap, int column, int row, const QRect& rect)
+{
+    constexpr int size = TileCache::tileSize;
+    if (pixmap.isNull()) {
+        pixmap = QPixmap(size, size);
+        pixmap.fill(Qt::transparent);
+    } else {
+        QPainter eraser(&pixmap);
+        eraser.setCompositionMode(QPainter::CompositionMode_Clear);
+        eraser.fillRect(rect, Qt::transparent);
+    }
+
+    const int offsetX = getOffsetX();
+    const int offsetY = getOffsetY();
+    const LC_Rect viewRect = view_rect;
+
+    m_tileCache->renderSize = rect.size();
+    setOffsetX(- column * size - rect.left());
+    setOffsetY(row * size + rect.top() + rect.height());
+    view_rect = LC_Rect(toGraph(0, 0), toGraph(rect.width(), rect.height()));
+
+    RS_PainterQt painter(&pixmap);
+    painter.translate(rect.left(), rect.top());
+    painter.setClipRect(0, 0, rect.width(), rect.height());
+    if (antialiasing)
+    {
+        painter.setRenderHint(QPainter::Antialiasing);
+    }
+    painter.setDrawingMode(drawingMode);
+    painter.setDrawSelectedOnly(false);
+    drawEntity((RS_Painter*)&painter, container);
+    painter.setDrawSelectedOnly(true);
+    drawEntity((RS_Painter*)&painter, container);
+    painter.flushAndEnd();
+
+    view_rect = viewRect;
+    setOffsetX(offsetX);
+    setOffsetY(offsetY);
+    m_tileCache->renderSize = {};
+}
+
+/**
+ * Renders whole tiles concurrently. Entities are prepared for drawing on the
+ * GUI thread, and each worker renders tiles into images with its own view.
+ *
+ * @param tiles columns and rows of the tiles
+ */
+void QG_GraphicView::renderTiles(const std::vector<std::pair<int, int>>& tiles)
+{
+    constexpr int size = TileCache::tileSize;
+    TileCache& cache = *m_tileCache;
+    const RS_Vector factor = getFactor();
+
+    LC_Rect area = TileCache::Key{factor.x, factor.y, tiles.front().first, tiles.front().second}.area();
+    for (const auto& [column, row]: tiles)
+        area = area.merge(TileCache::Key{factor.x, factor.y, column, row}.area());
+    prepareConcurrentDrawing(container->getEntitiesInArea(area));
+
+    const size_t workers = std::min(tiles.size(), size_t(std::max(cache.pool.maxThreadCount(), 1)));
+    while (cache.views.size() < workers)
+        cache.views.push_back(std::make_unique<RS_StaticGraphicView>(size, size, nullptr));
+
+    // images use the resolution of pixmaps, so line patterns are scaled the same way
+    const int widthMM = std::max(qRound(size * 25.4 / PixmapLayer2->logicalDpiX()), 1);
+    const int heightMM = std::max(qRound(size * 25.4 / PixmapLayer2->logicalDpiY()), 1);
+    const int dotsPerMeterX = qRound(1000. * size / widthMM);
+    const int dotsPerMeterY = qRound(1000. * size / heightMM);
+
+    std::vector<QImage> images(tiles.size());
+    std::atomic<size_t> next{0};
+    for (size_t i = 0; i < workers; ++i) {
+        RS_StaticGraphicView* view = cache.views[i].get();
+        view->copyRenderSettings(*this);
+        view->setConcurrentDrawing(true);
+        view->resetDrawStatistics();
+        cache.pool.start([&, view]() {
+            for (size_t k = next++; k < tiles.size(); k = next++) {
+                LC_TRACE_ZONE("render tile", "column", qint64(tiles[k].first));
+                QImage& image = images[k];
+                image = QImage(size, size, QImage::Format_ARGB32_Premultiplied);
+                image.setDotsPerMeterX(dotsPerMeterX);
+                image.setDotsPerMeterY(dotsPerMeterY);
+                image.fill(Qt::transparent);
+                view->setOffset(- tiles[k].first * size, (tiles[k].second + 1) * size);
+
+                RS_PainterQt painter(&image);
+                if (antialiasing)
+                {
+                    painter.setRenderHint(QPainter::Antialiasing);
+                }
+                painter.setDrawingMode(drawingMode);
+                painter.setDrawSelectedOnly(false);
+                view->drawEntity((RS_Painter*)&painter, container);
+                painter.setDrawSelectedOnly(true);
+                view->drawEntity((RS_Painter*)&painter, container);
+                painter.flushAndEnd();
+            }
+        });
+    }
+    cache.pool.waitForDone();
+    for (size_t i = 0; i < workers; ++i)
+        m_drawStatistics += cache.views[i]->getDrawStatistics();
+
+    for (size_t k = 0; k < tiles.size(); ++k) {
+        TileCache::Tile& tile = cache.tiles[{factor.x, factor.y, tiles[k].first, tiles[k].second}];
+        tile.pixmap = QPixmap::fromImage(std::move(images[k]));
+        tile.dirty = {};
+    }
+}
+
+/**
+ * Drafts the drawing of the whole view at a reduced resolution, in the draft mode
+ * and simplified by the level of detail, and draws it scaled to the view.
+ */
+void QG_GraphicView::drawDraft(QPainter& painter)
+{
+    constexpr int scale = TileCache::draftScale;
+    const int width = (getWidth() + scale - 1) / scale;
+    const int height = (getHeight() + scale - 1) / scale;
+
+    RS_StaticGraphicView view(width, height, nullptr);
+    view.copyRenderSettings(*this);
+    view.setFactorX(getFactor().x / scale);
+    view.setFactorY(getFactor().y / scale);
+    // the same GUI coordinates of the graph origin, scaled
+    view.setOffset(qRound(getOffsetX() / double(scale)),
+                   height - qRound((getHeight() - getOffsetY()) / double(scale)));
+    view.setDraftMode(true);
+    view.setLodThreshold(TileCache::draftLodThreshold);
+
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    image.setDotsPerMeterX(qRound(PixmapLayer2->logicalDpiX() / 0.0254 / scale));
+    image.setDotsPerMeterY(qRound(PixmapLayer2->logicalDpiY() / 0.0254 / scale));
+    image.fill(Qt::transparent);
+
+    RS_PainterQt draftPainter(&image);
+    draftPainter.setDrawingMode(drawingMode);
+    draftPainter.setDrawSelectedOnly(false);
+    view.drawEntity((RS_Painter*)&draftPainter, container);
+    draftPainter.flushAndEnd();
+    m_drawStatistics += view.getDrawStatistics();
+
+    painter.save();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawImage(QRectF(0, 0, width * scale, height * scale), image);
+    painter.restore();
+}
+
 void QG_GraphicView::setAntialiasing(bool state)
 {
+    if (antialiasing != state)
+        m_tileCache->tiles.clear();
 	antialiasing = state;
 }
 
+void QG_GraphicView::setParallelRendering(bool state)
+{
+    parallelRendering = state;
+}
+
+void QG_GraphicView::setPerformanceHud(bool state)
+{
+    if (m_performanceHud != state)
+        update(getHudRect());
+    m_performanceHud = state;
+}
+
 void QG_GraphicView::addScrollbars()
 {
     scrollbars = true;
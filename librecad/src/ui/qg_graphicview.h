@@ -27,8 +27,13 @@
 #ifndef QG_GRAPHICVIEW_H
 #define QG_GRAPHICVIEW_H
 
+#include <utility>
+#include <vector>
+
+#include <QRegion>
 #include <QWidget>
 
+#include "lc_regenstatistics.h"
 #include "rs_blocklistlistener.h"
 #include "rs_graphicview.h"
 #include "rs_layerlistlistener.h"
@@ -59,6 +64,8 @@ public:
 	int getWidth() const override;
 	int getHeight() const override;
 	void redraw(RS2::RedrawMethod method=RS2::RedrawAll) override;
+	void invalidateArea(const LC_Rect& area) override;
+	void invalidateAreas(const std::vector<LC_Rect>& areas) override;
 	void adjustOffsetControls() override;
 	void adjustZoomControls() override;
 	void setBackground(const RS_Color& bg) override;
@@ -74,8 +81,14 @@ public:
 	void layerRemoved(RS_Layer*) override{
         redraw(RS2::RedrawDrawing); 
     }
-	void layerToggled(RS_Layer*) override{
-        redraw(RS2::RedrawDrawing); 
+	void layerToggled(RS_Layer* layer) override{
+        if (layer != nullptr)
+            redrawLayers({layer});
+        else
+            redraw(RS2::RedrawDrawing);
+    }
+    void layersToggled(const std::vector<RS_Layer*>& layers) override{
+        redrawLayers(layers);
     }
 	void layerActivated(RS_Layer *) override;
     /**
@@ -92,7 +105,22 @@ public:
 	RS_Vector getMousePosition() const override;
 
     void setAntialiasing(bool state);
+    /**
+     * @brief setParallelRendering render missing tiles of the drawing by worker threads
+     */
+    void setParallelRendering(bool state);
+    /**
+     * @brief setPerformanceHud show frame times and drawing counters over the drawing
+     */
+    void setPerformanceHud(bool state);
     void setCursorHiding(bool state);
+    /**
+     * @brief setRenderingSuspended suspend painting of a view hidden by other windows,
+     * redraws are collected and painted on resume. The buffers of a suspended view
+     * are released after an idle timeout
+     */
+    void setRenderingSuspended(bool state);
+    bool isRenderingSuspended() const;
     void addScrollbars();
     bool hasScrollbars();
 
@@ -103,6 +131,24 @@ public:
     void destroyMenu(const QString& activator);
     void setMenu(const QString& activator, QMenu* menu);
 
+    /**
+     * @brief The FrameStatistics struct timings in milliseconds and counters of a
+     * painted frame. Layers not repainted by the frame take no time
+     */
+    struct FrameStatistics {
+        double gridTime = 0.;
+        double drawingTime = 0.;
+        double overlayTime = 0.;
+        //! the whole paint event
+        double frameTime = 0.;
+        //! counters of the drawing layer
+        DrawStatistics drawing;
+        //! regenerated entities since the previous frame, by any view
+        LC_RegenStatistics::Snapshot regenerations;
+    };
+    //! @return statistics of the last painted frame, for diagnostics and benchmarks
+    const FrameStatistics& getFrameStatistics() const;
+
 protected:
 	void mousePressEvent(QMouseEvent* e) override;
 	void mouseDoubleClickEvent(QMouseEvent* e) override;
@@ -121,6 +167,7 @@ protected:
 
 	void paintEvent(QPaintEvent *)override;
 	void resizeEvent(QResizeEvent* e) override;
+	void drawGrids(RS_Painter *painter) override;
 
     QList<QAction*> recent_actions;
     void autoPanStep();
@@ -162,6 +209,7 @@ protected:
 private:
     void addEditEntityEntry(QMouseEvent* event, QMenu& menu);
     bool antialiasing{false};
+    bool parallelRendering{false};
     bool scrollbars{false};
     bool cursor_hiding{false};
 
@@ -172,6 +220,52 @@ private:
     struct AutoPanData;
     std::unique_ptr<AutoPanData> m_panData;
 
+    // Tile cache of the rendered drawing
+    void drawTiles(QPainter& painter);
+    void drawScaledTiles(QPainter& painter, const RS_Vector& factor);
+    void renderTile(QPixmap& pixmap, int column, int row, const QRect& rect);
+    void renderTiles(const std::vector<std::pair<int, int>>& tiles);
+    void drawDraft(QPainter& painter);
+    struct TileCache;
+    std::unique_ptr<TileCache> m_tileCache;
+
+    // Rendered grids, shifted while panning
+    struct GridCache;
+    std::unique_ptr<GridCache> m_gridCache;
+
+    // Mouse moves, coalesced to the latest one per display frame
+    void processPendingMove();
+    struct PendingMove;
+    std::unique_ptr<PendingMove> m_pendingMove;
+
+    // Results of background work, applied in batches at most once per display frame
+    void scheduleResults() override;
+    void applyResultBatch();
+    struct ResultBatch;
+    std::unique_ptr<ResultBatch> m_resultBatch;
+
+    // Wheel options, kept up to date by RS_Settings::optionChanged()
+    void loadWheelOptions();
+    bool m_invertZoom{false};
+    bool m_invertScrollH{false};
+    bool m_invertScrollV{false};
+
+    // Crosshair and snap indicator, painted over the layers
+    QRegion getSnapperRegion();
+    //! the widget region covered by the last painted snapper
+    QRegion m_snapperRegion;
+
+    // Rendering of views hidden by other windows
+    void releaseBuffers();
+    struct Suspension;
+    std::unique_ptr<Suspension> m_suspension;
+
+    // Frame times and counters, painted over the drawing by the performance overlay
+    QRect getHudRect() const;
+    void drawPerformanceHud(QPainter& painter) const;
+    struct FrameHistory;
+    std::unique_ptr<FrameHistory> m_frameHistory;
+    bool m_performanceHud{false};
 
 signals:
     void xbutton1_released();
@@ -38,6 +38,7 @@
 #include <QTableView>
 #include <QToolButton>
 
+#include "lc_layernamefilter.h"
 #include "qc_applicationwindow.h"
 #include "qg_actionhandler.h"
 #include "qg_layerwidget.h"
@@ -281,7 +282,11 @@ QG_LayerWidget::QG_LayerWidget(QG_ActionHandler* ah, QWidget* parent,
     matchLayerName->setPlaceholderText(tr("Filter"));
     matchLayerName->setClearButtonEnabled(true);
     matchLayerName->setToolTip(tr("Looking for matching layer names"));
-    connect(matchLayerName, &QLineEdit::textChanged, this, &QG_LayerWidget::slotUpdateLayerList);
+    connect(matchLayerName, &QLineEdit::textChanged, this, &QG_LayerWidget::slotFilteringMaskChanged);
+
+    // typing is debounced, rows are shown once the names are matched
+    nameFilter = new LC_LayerNameFilter(LC_LayerNameFilter::Wildcard, this);
+    connect(nameFilter, &LC_LayerNameFilter::matched, this, &QG_LayerWidget::slotUpdateLayerList);
 
     lay->addWidget(matchLayerName);
     lay->addLayout(layButtons);
@@ -520,12 +525,29 @@ void QG_LayerWidget::slotSelectionChanged(
 /**
  * Called when reg-expresion matchLayerName->text changed
  */
+void QG_LayerWidget::slotFilteringMaskChanged() {
+    QStringList names;
+    if (layerList != nullptr) {
+        names.reserve(layerList->count());
+        for (RS_Layer* layer: *layerList) {
+            names << layer->getName();
+        }
+    }
+    nameFilter->setNames(names);
+    nameFilter->setPattern(matchLayerName->text());
+}
+
+/**
+ * Called when layer names are matched to matchLayerName->text
+ */
 void QG_LayerWidget::slotUpdateLayerList() {
-    QRegularExpression rx = QRegularExpression::fromWildcard(matchLayerName->text());
+    if (layerList == nullptr) {
+        return;
+    }
 
     for (unsigned i=0; i<layerList->count() ; i++) {
         QString s=layerModel->getLayer(i)->getName();
-        if (matchLayerName->text().isEmpty() || s.indexOf(rx) == 0) {
+        if (nameFilter->matches(s)) {
             layerView->showRow(i);
             layerModel->getLayer(i)->visibleInLayerList(true);
         } else {
@@ -36,6 +36,7 @@
 #include "rs_layerlistlistener.h"
 #include "rs_layerlist.h"
 
+class LC_LayerNameFilter;
 class QG_ActionHandler;
 class QTableView;
 class QLineEdit;
@@ -153,6 +154,7 @@ public slots:
     void slotSelectionChanged(
         const QItemSelection &selected,
         const QItemSelection &deselected);
+    void slotFilteringMaskChanged();
     void slotUpdateLayerList();
     void activateLayer(int row);
 
@@ -164,6 +166,7 @@ private:
     RS_LayerList* layerList = nullptr;
     bool showByBlock = false;
     QLineEdit* matchLayerName = nullptr;
+    LC_LayerNameFilter* nameFilter = nullptr;
     QTableView* layerView = nullptr;
     QG_LayerModel *layerModel = nullptr;
     RS_Layer* lastLayer = nullptr;
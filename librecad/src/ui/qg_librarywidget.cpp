@@ -25,46 +25,138 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 #include <QApplication>
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QDesktopServices>
+#include <QFile>
 #include <QImageWriter>
 #include <QListView>
 #include <QModelIndex>
 #include <QMouseEvent>
 #include <QPushButton>
+#include <QSaveFile>
 #include <QStandardItemModel>
 #include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
 #include <QTreeView>
 #include <QVBoxLayout>
 
 #include "qg_librarywidget.h"
 
+#include "lc_resultqueue.h"
 #include "qg_actionhandler.h"
 #include "rs_actionlibraryinsert.h"
 #include "rs_debug.h"
+#include "rs_graphic.h"
 #include "rs_painterqt.h"
 #include "rs_settings.h"
 #include "rs_staticgraphicview.h"
 #include "rs_system.h"
 
 namespace {
-    void writePng(const QString& pngPath, QPixmap pixmap)
+    // hashed with the content of DXF files, change it when thumbnails are rendered differently
+    const QByteArray thumbnailVersion = "LibreCAD thumbnail 1\n";
+
+    // thumbnails are shared by several instances and users, so they are written
+    // to a temporary file, which replaces the thumbnail once complete
+    bool writePng(const QString& pngPath, const QImage& image)
     {
+        QSaveFile file{pngPath};
         QImageWriter iio;
-        QImage img = pixmap.toImage();
-        img = img.scaled(64,64, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
-        // iio.setImage(img);
-        iio.setFileName(pngPath);
+        QImage img = image.scaled(64,64, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+        iio.setDevice(&file);
         iio.setFormat("PNG");
-        if (!iio.write(img)) {
+        if (!file.open(QIODevice::WriteOnly) || !iio.write(img) || !file.commit()) {
             RS_DEBUG->print(RS_Debug::D_ERROR,
-                            "QG_LibraryWidget::getPathToPixmap: Cannot write thumbnail: '%s'",
+                            "QG_LibraryWidget: Cannot write thumbnail: '%s'",
                             pngPath.toLatin1().data());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @return Path to the cached thumbnail of a DXF file, created if missing, or an
+     * empty string, if no thumbnail can be created. Thumbnails are named by the hash
+     * of the file content, so they remain valid if the file is moved or copied.
+     * Called by workers, each with its own view.
+     */
+    QString createThumbnail(const QString& dxfPath, const QString& cacheDir,
+                            RS_StaticGraphicView& gv)
+    {
+        QFile dxf{dxfPath};
+        QCryptographicHash hash{QCryptographicHash::Sha1};
+        hash.addData(thumbnailVersion);
+        if (!dxf.open(QIODevice::ReadOnly) || !hash.addData(&dxf)) {
+            RS_DEBUG->print(RS_Debug::D_ERROR,
+                            "QG_LibraryWidget: Cannot read file: '%s'",
+                            dxfPath.toLatin1().data());
+            return {};
+        }
+        dxf.close();
+
+        const QString pngPath = cacheDir + QString::fromLatin1(hash.result().toHex()) + ".png";
+        if (QFileInfo(pngPath).isFile())
+            return pngPath;
+
+        // images, unlike pixmaps, may be painted by worker threads
+        QImage buffer(128, 128, QImage::Format_ARGB32_Premultiplied);
+        RS_PainterQt painter(&buffer);
+        painter.setBackground(RS_Color(255,255,255));
+        painter.eraseRect(0,0, 128,128);
+
+        RS_Graphic graphic;
+        if (!graphic.open(dxfPath, RS2::FormatUnknown)) {
+            RS_DEBUG->print(RS_Debug::D_ERROR,
+                            "QG_LibraryWidget: Cannot open file: '%s'",
+                            dxfPath.toLatin1().data());
+            painter.flushAndEnd();
+            return {};
+        }
+
+        gv.setContainer(&graphic);
+        gv.zoomAuto(false);
+        for (RS_Entity* e=graphic.firstEntity(RS2::ResolveAll);
+                e; e=graphic.nextEntity(RS2::ResolveAll)) {
+            if (e->rtti() != RS2::EntityHatch){
+                RS_Pen pen = e->getPen();
+                pen.setColor(Qt::black);
+                e->setPen(pen);
+            }
+            gv.drawEntity(&painter, e);
         }
+        gv.setContainer(nullptr);
+        painter.flushAndEnd();
+
+        return writePng(pngPath, buffer) ? pngPath : QString{};
     }
 }
 
+struct QG_LibraryWidget::Thumbnails {
+    ~Thumbnails()
+    {
+        pool.clear();
+        pool.waitForDone();
+    }
+
+    QThreadPool pool;
+    // a view per worker, created on the GUI thread
+    std::vector<std::unique_ptr<RS_StaticGraphicView>> views;
+    std::mutex mutex;
+    std::vector<RS_StaticGraphicView*> freeViews;
+    // increased when the icon view is filled again; older thumbnails are dropped
+    unsigned generation = 0;
+    QString cacheDir;
+    // the created thumbnails, set to the items in batches
+    LC_ResultQueue results;
+};
+
 /*
  *  Constructs a QG_LibraryWidget as a child of 'parent', with the
  *  name 'name' and widget flags set to 'f'.
@@ -73,6 +165,7 @@ namespace {
  */
 QG_LibraryWidget::QG_LibraryWidget(QWidget* parent, const char* name, Qt::WindowFlags fl)
     : QWidget(parent, fl)
+    , m_thumbnails{std::make_unique<Thumbnails>()}
 {
     setObjectName(name);
 	actionHandler = nullptr;
@@ -97,6 +190,9 @@ QG_LibraryWidget::QG_LibraryWidget(QWidget* parent, const char* name, Qt::Window
     refreshButtonsLayout->addWidget(bRebuild);
     vboxLayout->addLayout(refreshButtonsLayout);
 
+    // leave a core to the GUI
+    m_thumbnails->pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+
     buildTree();
 
     connect(dirView, SIGNAL(expanded(QModelIndex)), this, SLOT(expandView(QModelIndex)));
@@ -194,6 +290,8 @@ void QG_LibraryWidget::scanTree() {
  * (Re)build dirModel and iconModel from scratch
  */
 void QG_LibraryWidget::buildTree() {
+    m_thumbnails->pool.clear();
+    ++m_thumbnails->generation;
     dirModel = std::make_unique<QStandardItemModel>();
     iconModel = std::make_unique<QStandardItemModel>();
     scanTree();
@@ -275,12 +373,24 @@ void QG_LibraryWidget::updatePreview(QModelIndex idx) {
     if (item == nullptr)
         return;
 
-    QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
-
     // dir from the point of view of the library browser (e.g. /mechanical/screws)
     QString directory = getItemDir(item); //RLZ change to do-while
     iconModel->clear();
 
+    // drop the thumbnails not created yet for the previous directory
+    m_thumbnails->pool.clear();
+    ++m_thumbnails->generation;
+
+    // the thumbnails must be created in the user's home, unless a shared location is set
+    RS_SETTINGS->beginGroup("/Paths");
+    QString cacheDir = RS_SETTINGS->readEntry("/ThumbnailCache", "");
+    RS_SETTINGS->endGroup();
+    if (cacheDir.isEmpty())
+        cacheDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                + QDir::separator() + "thumbnails";
+    RS_SYSTEM->createPaths(cacheDir);
+    m_thumbnails->cacheDir = cacheDir + QDir::separator();
+
     // List of all directories that contain part libraries:
     QStringList directoryList = RS_SYSTEM->getDirectoryList("library");
     QDir itemDir;
@@ -302,14 +412,19 @@ void QG_LibraryWidget::updatePreview(QModelIndex idx) {
     // Sort entries:
     itemPathList.sort();
 
-    // Fill items into icon view:
+    // Fill items into icon view, with placeholders for the thumbnails still to create:
+    QPixmap placeholder(64,64);
+    placeholder.fill(Qt::white);
+    const QIcon placeholderIcon{placeholder};
     for (int i = 0; i < itemPathList.size(); ++i) {
-		QString label = QFileInfo(itemPathList.at(i)).completeBaseName();
-        QIcon icon = getIcon(directory, QFileInfo(itemPathList.at(i)).fileName(), itemPathList.at(i));
-        auto newItem = new QStandardItem(icon, label);
+        const QString& dxfPath = itemPathList.at(i);
+		QString label = QFileInfo(dxfPath).completeBaseName();
+        const QString pngPath = getPathToPixmap(directory, QFileInfo(dxfPath).fileName(), dxfPath);
+        auto newItem = new QStandardItem(pngPath.isEmpty() ? placeholderIcon : QIcon(pngPath), label);
         iconModel->setItem(i, newItem);
+        if (pngPath.isEmpty())
+            requestThumbnail(i, dxfPath);
     }
-    QApplication::restoreOverrideCursor();
 }
 
  //RLZ change to do-while
@@ -355,49 +470,25 @@ QString QG_LibraryWidget::getItemPath(QStandardItem* item) {
 }
 
 /**
- * @return Pixmap that serves as icon for the given DXF File.
- * The existing PNG file is returned or created and returned..
+ * @return Path to the thumbnail of the given DXF file shipped in the library
+ * directories, if it is newer than the DXF file, or an empty string. Missing
+ * thumbnails are created by requestThumbnail().
  *
  * @param dir Library directory (e.g. "/mechanical/screws")
  * @param dxfFile File name (e.g. "screw1.dxf")
- * @param dxfPath Full path to the existing DXF file on disk 
+ * @param dxfPath Full path to the existing DXF file on disk
  *                          (e.g. /home/tux/.qcad/library/mechanical/screws/screw1.dxf)
  */
-QIcon QG_LibraryWidget::getIcon(const QString& dir, const QString& dxfFile,
-                                    const QString& dxfPath) {
-    QString pngFile = getPathToPixmap(dir, dxfFile, dxfPath);
-    QFileInfo fiPng(pngFile);
-
-    // found existing thumbnail:
-    if (fiPng.isFile()) {
-        return QIcon(pngFile);
-    }
-    // default thumbnail:
-    else {
-        return QIcon(QPixmap(64,64));
-    }
-}
-
-
-
-/**
- * @return Path to the thumbnail of the given DXF file. If no thumbnail exists, one is
- * created in the user's home. If no thumbnail can be created, an empty string is returned.
- */
 QString QG_LibraryWidget::getPathToPixmap(const QString& dir,
         const QString& dxfFile,
         const QString& dxfPath) {
 
-    // the thumbnail must be created in the user's home.
-    QString iconCacheLocation=QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator() + "iconCache" + QDir::separator();
-
     RS_DEBUG->print("QG_LibraryWidget::getPathToPixmap: "
                     "dir: '%s' dxfFile: '%s' dxfPath: '%s'",
                     dir.toLatin1().data(), dxfFile.toLatin1().data(), dxfPath.toLatin1().data());
 
     // List of all directories that contain part libraries:
     QStringList directoryList = RS_SYSTEM->getDirectoryList("library");
-    directoryList.prepend(iconCacheLocation);
 
     QFileInfo fiDxf(dxfPath);
 
@@ -425,43 +516,55 @@ QString QG_LibraryWidget::getPathToPixmap(const QString& dir,
         }
     }
 
-    // create all directories needed:
-    RS_SYSTEM->createPaths(iconCacheLocation + dir);
-
-    QString pngPath = iconCacheLocation + dir + QDir::separator() + fiDxf.baseName() + ".png";
-
-    QPixmap buffer(128,128);
-    RS_PainterQt painter(&buffer);
-    painter.setBackground(RS_Color(255,255,255));
-    painter.eraseRect(0,0, 128,128);
-
-    RS_StaticGraphicView gv(128,128, &painter);
-    RS_Graphic graphic;
-    if (graphic.open(dxfPath, RS2::FormatUnknown)) {
-        gv.setContainer(&graphic);
-        gv.zoomAuto(false);
-        // gv.drawEntity(&graphic, true);
-
-        for (RS_Entity* e=graphic.firstEntity(RS2::ResolveAll);
-                e; e=graphic.nextEntity(RS2::ResolveAll)) {
-            if (e->rtti() != RS2::EntityHatch){
-                RS_Pen pen = e->getPen();
-                pen.setColor(Qt::black);
-                e->setPen(pen);
-            }
-            gv.drawEntity(&painter, e);
-        }
+    return {};
+}
 
-        // Write to PNG
-        writePng(pngPath, std::move(buffer));
-    } else {
-        RS_DEBUG->print(RS_Debug::D_ERROR,
-                        "QG_LibraryWidget::getPathToPixmap: Cannot open file: '%s'",
-                        dxfPath.toLatin1().data());
+/**
+ * Finds or creates the cached thumbnail of a DXF file by a worker. The icon of
+ * the item in the given row is set, once the thumbnail is ready.
+ */
+void QG_LibraryWidget::requestThumbnail(int row, const QString& dxfPath)
+{
+    Thumbnails& thumbnails = *m_thumbnails;
+    if (thumbnails.views.size() < size_t(thumbnails.pool.maxThreadCount())) {
+        thumbnails.views.push_back(std::make_unique<RS_StaticGraphicView>(128, 128, nullptr));
+        std::lock_guard<std::mutex> lock{thumbnails.mutex};
+        thumbnails.freeViews.push_back(thumbnails.views.back().get());
     }
 
-    // GraphicView deletes painter
-    painter.end();
+    const unsigned generation = thumbnails.generation;
+    const QString cacheDir = thumbnails.cacheDir;
+    thumbnails.pool.start([this, &thumbnails, generation, row, dxfPath, cacheDir]() {
+        // as many views as workers
+        RS_StaticGraphicView* view = nullptr;
+        {
+            std::lock_guard<std::mutex> lock{thumbnails.mutex};
+            view = thumbnails.freeViews.back();
+            thumbnails.freeViews.pop_back();
+        }
+        const QString pngPath = createThumbnail(dxfPath, cacheDir, *view);
+        {
+            std::lock_guard<std::mutex> lock{thumbnails.mutex};
+            thumbnails.freeViews.push_back(view);
+        }
+        if (pngPath.isEmpty())
+            return;
+        const bool first = thumbnails.results.push([this, generation, row, pngPath]() {
+            setThumbnail(generation, row, pngPath);
+            return false;
+        });
+        // one event for the thumbnails created meanwhile
+        if (first)
+            QMetaObject::invokeMethod(this, [this]() { m_thumbnails->results.apply(); },
+                                      Qt::QueuedConnection);
+    });
+}
 
-    return pngPath;
+void QG_LibraryWidget::setThumbnail(unsigned generation, int row, const QString& pngPath)
+{
+    if (generation != m_thumbnails->generation)
+        return;
+    QStandardItem* item = iconModel->item(row);
+    if (item != nullptr)
+        item->setIcon(QIcon(pngPath));
 }
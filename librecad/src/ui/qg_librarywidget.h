@@ -57,8 +57,9 @@ private:
 
     virtual QString getItemDir( QStandardItem * item );
     virtual QString getItemPath( QStandardItem * item );
-    virtual QIcon getIcon( const QString & dir, const QString & dxfFile, const QString & dxfPath );
     virtual QString getPathToPixmap( const QString & dir, const QString & dxfFile, const QString & dxfPath );
+    void requestThumbnail(int row, const QString& dxfPath);
+    void setThumbnail(unsigned generation, int row, const QString& pngPath);
 
 public slots:
     virtual void setActionHandler( QG_ActionHandler * ah );
@@ -83,6 +84,10 @@ private:
     QListView *ivPreview = nullptr;
     QPushButton *bRefresh = nullptr;
     QPushButton *bRebuild = nullptr;
+
+    // Thumbnails created by workers, while the placeholders are shown
+    struct Thumbnails;
+    std::unique_ptr<Thumbnails> m_thumbnails;
 };
 
 #endif // QG_LIBRARYWIDGET_H
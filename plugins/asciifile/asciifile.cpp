@@ -10,7 +10,9 @@
 /*  along with this program.  If not, see <http://www.gnu.org/licenses/>.    */
 /*****************************************************************************/
 
+#include <algorithm>
 #include <cmath>
+#include <thread>
 
 #include <QtPlugin>
 #include <QPicture>
@@ -326,6 +328,74 @@ bool dibPunto::failGUI(QString *msg)
     return false;
 }
 
+namespace {
+//bytes read from the file at once
+constexpr qint64 readBlockSize = 8 << 20;
+//blocks smaller than this are parsed by a single thread
+constexpr qsizetype minBytesPerThread = 256 << 10;
+
+//parses the lines of the text by the threads, each one a part ending at a line end
+template<class Parse>
+void parseLines(const QByteArray& text, std::vector<PointData>& points, const Parse& parse)
+{
+    const qsizetype cores = std::max(1u, std::thread::hardware_concurrency());
+    const qsizetype threads = std::clamp<qsizetype>(text.size() / minBytesPerThread, 1, cores);
+    std::vector<qsizetype> starts{0};
+    for (qsizetype i = 1; i < threads; ++i) {
+        const qsizetype end = text.indexOf('\n', std::max(starts.back(), i * text.size() / threads));
+        if (end < 0)
+            break;
+        starts.push_back(end + 1);
+    }
+    starts.push_back(text.size());
+
+    std::vector<std::vector<PointData>> parts(starts.size() - 1);
+    auto work = [&](size_t part) {
+        qsizetype begin = starts[part];
+        while (begin < starts[part + 1]) {
+            qsizetype end = text.indexOf('\n', begin);
+            if (end < 0 || end > starts[part + 1])
+                end = starts[part + 1];
+            qsizetype length = end - begin;
+            while (length > 0 && (text[begin + length - 1] == '\r' || text[begin + length - 1] == '\n'))
+                --length;
+            if (length > 0) {
+                PointData pd;
+                if (parse(QString::fromUtf8(text.constData() + begin, length), pd))
+                    parts[part].push_back(std::move(pd));
+            }
+            begin = end + 1;
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < parts.size(); ++i)
+        workers.emplace_back(work, i);
+    work(0);
+    for (std::thread& worker: workers)
+        worker.join();
+    for (std::vector<PointData>& part: parts)
+        points.insert(points.end(), std::make_move_iterator(part.begin()),
+                      std::make_move_iterator(part.end()));
+}
+
+//reads the points of the file by blocks, parse gets a line without line end and
+//returns false if the line has no point
+template<class Parse>
+void readPoints(QFile* file, std::vector<PointData>& points, const Parse& parse)
+{
+    QByteArray block;
+    while (!file->atEnd()) {
+        block += file->read(readBlockSize);
+        // the last line of the block is parsed with the next block
+        const qsizetype end = file->atEnd() ? block.size() : block.lastIndexOf('\n') + 1;
+        if (end <= 0)
+            continue;
+        parseLines(block.left(end), points, parse);
+        block.remove(0, end);
+    }
+}
+}
+
 void dibPunto::procesFile(Document_Interface *doc)
 {
     QString sep;
@@ -372,6 +442,8 @@ void dibPunto::procesFile(Document_Interface *doc)
     else
         procesfileNormal(&infile, sep, skip);
     infile.close ();
+    // all entities of the file in one undo cycle and one redraw
+    Plug_Batch batch(currDoc);
     QString currlay = currDoc->getCurrentLayer();
 
     if (pt2d->checkOn() == true)
@@ -397,54 +469,47 @@ void dibPunto::procesFile(Document_Interface *doc)
 void dibPunto::drawLine()
 {
     QPointF prevP, nextP;
-    int i;
 
-    for (i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty()){
-            prevP.setX(pd->x.toDouble());
-            prevP.setY(pd->y.toDouble());
-            break;
-        }
-    }
-    for (; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty()){
-            nextP.setX(pd->x.toDouble());
-            nextP.setY(pd->y.toDouble());
-            currDoc->addLine(&prevP, &nextP);
-            prevP = nextP;
-        }
+    if (dataList.empty())
+        return;
+    prevP = QPointF(dataList.front().x, dataList.front().y);
+    std::vector<QLineF> lines;
+    lines.reserve(dataList.size());
+    for (size_t i = 1; i < dataList.size(); ++i) {
+        nextP = QPointF(dataList[i].x, dataList[i].y);
+        lines.emplace_back(prevP, nextP);
+        prevP = nextP;
     }
+    currDoc->addLineSegments(lines);
 }
 
 void dibPunto::draw2D()
 {
     QPointF pt;
+    std::vector<QPointF> points;
     currDoc->setLayer(pt2d->getLayer());
-    for (int i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty()){
-            pt.setX(pd->x.toDouble());
-            pt.setY(pd->y.toDouble());
-            currDoc->addPoint(&pt);
-        }
+    points.reserve(dataList.size());
+    for (const PointData& pd: dataList) {
+        pt.setX(pd.x);
+        pt.setY(pd.y);
+        points.push_back(pt);
     }
+    currDoc->addPoints(points);
 }
 void dibPunto::draw3D()
 {
     QPointF pt;
+    std::vector<QPointF> points;
     currDoc->setLayer(pt3d->getLayer());
-    for (int i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty()){
-            pt.setX(pd->x.toDouble());
-            pt.setY(pd->y.toDouble());
-/*RLZ:3d support            if (pd->z.isEmpty()) pt.setZ(0.0);
-            else  pt.setZ(pd->z.toDouble());*/
-            currDoc->addPoint(&pt);
-        }
+    points.reserve(dataList.size());
+    for (const PointData& pd: dataList) {
+        pt.setX(pd.x);
+        pt.setY(pd.y);
+/*RLZ:3d support            if (pd.z.isEmpty()) pt.setZ(0.0);
+        else  pt.setZ(pd.z.toDouble());*/
+        points.push_back(pt);
     }
+    currDoc->addPoints(points);
 }
 
 void dibPunto::calcPos(DPI::VAlign *v, DPI::HAlign *h, double sep,
@@ -512,15 +577,17 @@ void dibPunto::drawNumber()
 
     currDoc->setLayer(ptnumber->getLayer());
     QString sty = ptnumber->getStyleStr();
-    for (int i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty() && !pd->number.isEmpty()){
-            newx = pd->x.toDouble() + incx;
-            newy = pd->y.toDouble() + incy;
+    double height = ptnumber->getHeightStr().toDouble();
+    std::vector<Plug_TextData> texts;
+    for (const PointData& pd: dataList) {
+        if (!pd.number.isEmpty()){
+            newx = pd.x + incx;
+            newy = pd.y + incy;
             QPointF pt(newx,newy);
-            currDoc->addText(pd->number, sty, &pt, ptnumber->getHeightStr().toDouble(), 0.0, ha, va);
+            texts.emplace_back(pd.number, sty, pt, height, 0.0, ha, va);
         }
     }
+    currDoc->addTexts(texts);
 }
 
 void dibPunto::drawElev()
@@ -534,15 +601,17 @@ void dibPunto::drawElev()
 
     currDoc->setLayer(ptelev->getLayer());
     QString sty = ptelev->getStyleStr();
-    for (int i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty() && !pd->z.isEmpty()){
-            newx = pd->x.toDouble() + incx;
-            newy = pd->y.toDouble() + incy;
+    double height = ptelev->getHeightStr().toDouble();
+    std::vector<Plug_TextData> texts;
+    for (const PointData& pd: dataList) {
+        if (!pd.z.isEmpty()){
+            newx = pd.x + incx;
+            newy = pd.y + incy;
             QPointF pt(newx,newy);
-            currDoc->addText(pd->z, sty, &pt, ptelev->getHeightStr().toDouble(), 0.0, ha, va);
+            texts.emplace_back(pd.z, sty, pt, height, 0.0, ha, va);
         }
     }
+    currDoc->addTexts(texts);
 }
 void dibPunto::drawCode()
 {
@@ -554,44 +623,38 @@ void dibPunto::drawCode()
 
     currDoc->setLayer(ptcode->getLayer());
     QString sty = ptcode->getStyleStr();
-    for (int i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty() && !pd->code.isEmpty()){
-            newx = pd->x.toDouble() + incx;
-            newy = pd->y.toDouble() + incy;
+    double height = ptcode->getHeightStr().toDouble();
+    std::vector<Plug_TextData> texts;
+    for (const PointData& pd: dataList) {
+        if (!pd.code.isEmpty()){
+            newx = pd.x + incx;
+            newy = pd.y + incy;
             QPointF pt(newx,newy);
-            currDoc->addText(pd->code, sty, &pt, ptcode->getHeightStr().toDouble(), 0.0, ha, va);
+            texts.emplace_back(pd.code, sty, pt, height, 0.0, ha, va);
         }
     }
+    currDoc->addTexts(texts);
 }
 
 void dibPunto::procesfileODB(QFile* file, QString sep)
 {
-    QStringList data;
-    PointData *pd;
-
-    while (!file->atEnd()) {
-        QString line = file->readLine();
-        line.remove ( line.size()-2, 1);
-        data = line.split(sep);
-        pd = new PointData;
+    readPoints(file, dataList, [sep](const QString& line, PointData& pd) {
+        QStringList data = line.split(sep);
         int i = 0;
         int j = data.size();
-        if (i<j && data.at(i).compare("4")==0 ){
-            i = i+2;
-            if (i<j) pd->x = data.at(i); else pd->x = QString();
-            i++;
-            if (i<j) pd->y = data.at(i); else pd->y = QString();
-            i++;
-            if (i<j) pd->z = data.at(i); else pd->z = QString();
-            i++;
-            if (i<j) pd->number = data.at(i); else pd->number = QString();
-            i++;
-            if (i<j) pd->code = data.at(i); else pd->code = QString();
-        }
-        dataList.append(pd);
-    }
-
+        // other records than points, or points without coordinates
+        if (j < 4 || data.at(i).compare("4") != 0)
+            return false;
+        i = i+2;
+        pd.x = data.at(i++).toDouble();
+        pd.y = data.at(i++).toDouble();
+        if (i<j) pd.z = data.at(i);
+        i++;
+        if (i<j) pd.number = data.at(i);
+        i++;
+        if (i<j) pd.code = data.at(i);
+        return !data.at(2).isEmpty() && !data.at(3).isEmpty();
+    });
 }
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
@@ -600,50 +663,36 @@ void dibPunto::procesfileNormal(QFile* file, QString sep, Qt::SplitBehaviorFlags
 void dibPunto::procesfileNormal(QFile* file, QString sep, QString::SplitBehavior skip)
 #endif
 {
-    //    QString outname, sep;
-    QStringList data;
-    PointData *pd;
-    while (!file->atEnd()) {
-        QString line = file->readLine();
-		if(line.isEmpty()) continue;
-        line.remove ( line.size()-1, 1);
-        data = line.split(sep, skip);
-        pd = new PointData;
-        int i = 0;
+    readPoints(file, dataList, [sep, skip](const QString& line, PointData& pd) {
+        QStringList data = line.split(sep, skip);
         switch(data.size()){
         case 0:
         case 1:
-            delete pd;
-            continue;
+            return false;
 
             //allow reading in raw 2D ascii data in format:
             // x y
         case 2:
-            pd->x = data.at(0);
-            pd->y = data.at(1);
-            break;
+            pd.x = data.at(0).toDouble();
+            pd.y = data.at(1).toDouble();
+            return !data.at(0).isEmpty() && !data.at(1).isEmpty();
         default:
         case 5:
-            pd->code=data.at(4);
+            pd.code=data.at(4);
             // fall-through
         case 4:
-            pd->z = data.at(3);
+            pd.z = data.at(3);
             // fall-through
         case 3:
-            pd->number = data.at(i);
-            pd->x = data.at(1);
-            pd->y = data.at(2);
-            break;
+            pd.number = data.at(0);
+            pd.x = data.at(1).toDouble();
+            pd.y = data.at(2).toDouble();
+            return !data.at(1).isEmpty() && !data.at(2).isEmpty();
         }
-        dataList.append(pd);
-    }
+    });
 }
 
-dibPunto::~dibPunto()
-{
-    while (!dataList.isEmpty())
-         delete dataList.takeFirst();
-}
+dibPunto::~dibPunto() = default;
 
 void dibPunto::readSettings()
  {
@@ -89,7 +89,7 @@ private:
     QLineEdit *fileedit;
     QComboBox *formatedit;
     QCheckBox *connectPoints;
-    QList<PointData*> dataList;
+    std::vector<PointData> dataList;
 
     Document_Interface *currDoc;
 
@@ -164,11 +164,12 @@ private:
     imgLabel *img;
 };
 /***********/
+//! a point of the file, the texts are empty if not given
 struct PointData
 {
     QString number;
-    QString x;
-    QString y;
+    double x = 0.;
+    double y = 0.;
     QString z;
     QString code;
 };
@@ -4,12 +4,18 @@
 //ToDo: *set max and min value for step size?
 
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <thread>
+#include <vector>
 
 #include "document_interface.h"
 #include "plot.h"
 #include "plotdialog.h"
 #include <muParser.h>
 #include <QDebug>
+#include <QLineF>
 
 mu::string_type toMUPString(const QString &str)
 {
@@ -20,6 +26,167 @@ mu::string_type toMUPString(const QString &str)
 #endif
 }
 
+namespace {
+//halving of the step size by the adaptive sampling
+constexpr int maxRefinements = 12;
+//upper limit of the points of a plot
+constexpr size_t maxSamples = 1000000;
+//fewer parameter values are evaluated by a single thread
+constexpr size_t minValuesPerThread = 4096;
+
+void defineParser(mu::Parser& p, double* variable)
+{
+    p.DefineConst(_T("pi"),M_PI);
+    p.DefineConst(_T("e"),M_E);
+    p.DefineVar(_T("x"), variable);
+    p.DefineVar(_T("t"), variable);
+}
+
+//values of the equation for the parameter values, in the bulk mode of muParser,
+//large sets are split to cores with a parser each
+void evaluateBulk(const QString& equation, std::vector<double>& params, std::vector<double>& results)
+{
+    results.resize(params.size());
+    if (params.empty())
+        return;
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    const size_t threads = std::clamp<size_t>(params.size() / minValuesPerThread, 1, cores);
+    const size_t chunk = (params.size() + threads - 1) / threads;
+    std::vector<std::exception_ptr> errors(threads);
+    auto work = [&](size_t index) {
+        const size_t begin = index * chunk;
+        const size_t count = std::min(chunk, params.size() - begin);
+        try {
+            mu::Parser p;
+            //in the bulk mode the variable points to the array of values
+            defineParser(p, params.data() + begin);
+            p.SetExpr(toMUPString(equation));
+            p.Eval(results.data() + begin, static_cast<int>(count));
+        } catch (...) {
+            errors[index] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i)
+        workers.emplace_back(work, i);
+    work(0);
+    for (std::thread& worker: workers)
+        worker.join();
+    for (const std::exception_ptr& error: errors)
+        if (error)
+            std::rethrow_exception(error);
+}
+
+//the plotted points, y = f(x) or x = f(t), y = g(t) in the parametric form
+class Curve {
+public:
+    Curve(const QString& eq1, const QString& eq2):
+        m_equation1{eq1}
+      , m_equation2{eq2}
+    {}
+
+    std::vector<QPointF> evaluate(std::vector<double>& params) const
+    {
+        std::vector<double> values1;
+        std::vector<double> values2;
+        evaluateBulk(m_equation1, params, values1);
+        if (!m_equation2.isEmpty())
+            evaluateBulk(m_equation2, params, values2);
+        std::vector<QPointF> points;
+        points.reserve(params.size());
+        for (size_t i = 0; i < params.size(); ++i) {
+            if (m_equation2.isEmpty())
+                points.emplace_back(params[i], values1[i]);
+            else
+                points.emplace_back(values1[i], values2[i]);
+        }
+        return points;
+    }
+
+private:
+    QString m_equation1;
+    QString m_equation2;
+};
+
+struct Sample {
+    double parameter;
+    QPointF point;
+};
+
+bool isFinite(const QPointF& point)
+{
+    return std::isfinite(point.x()) && std::isfinite(point.y());
+}
+
+//distance of the curve point between the samples to their chord
+double chordDeviation(const QPointF& start, const QPointF& end, const QPointF& middle)
+{
+    if (!isFinite(start) || !isFinite(end) || !isFinite(middle))
+        return HUGE_VAL;
+    const QPointF chord = end - start;
+    const double length2 = QPointF::dotProduct(chord, chord);
+    if (length2 <= 0.)
+        return QLineF(start, middle).length();
+    const double u = std::clamp(QPointF::dotProduct(middle - start, chord) / length2, 0., 1.);
+    return QLineF(start + u * chord, middle).length();
+}
+
+//samples the curve with the step size, then halves the intervals of the
+//samples as long as the curve deviates more than the tolerance from the chords
+std::vector<Sample> sampleCurve(const Curve& curve, double start, double end,
+                                double step, double tolerance)
+{
+    std::vector<double> params;
+    for (double t = start; t <= end && params.size() < maxSamples; t += step)
+        params.push_back(t);
+    if (tolerance > 0. && (params.empty() || params.back() < end))
+        params.push_back(end);
+    std::vector<QPointF> points = curve.evaluate(params);
+    std::vector<Sample> samples;
+    samples.reserve(params.size());
+    for (size_t i = 0; i < params.size(); ++i)
+        samples.push_back({params[i], points[i]});
+    if (tolerance <= 0.)
+        return samples;
+
+    //intervals to refine, from a sample to the next one
+    std::vector<bool> refine(samples.size(), true);
+    for (int level = 0; level < maxRefinements; ++level) {
+        std::vector<double> middles;
+        for (size_t i = 0; i + 1 < samples.size(); ++i)
+            if (refine[i])
+                middles.push_back(0.5 * (samples[i].parameter + samples[i + 1].parameter));
+        if (middles.empty() || samples.size() + middles.size() > maxSamples)
+            break;
+        //all middles of the level at once
+        const std::vector<QPointF> middlePoints = curve.evaluate(middles);
+
+        std::vector<Sample> refined;
+        std::vector<bool> refineNext;
+        refined.reserve(samples.size() + middles.size());
+        size_t m = 0;
+        for (size_t i = 0; i < samples.size(); ++i) {
+            refined.push_back(samples[i]);
+            if (i + 1 == samples.size() || !refine[i]) {
+                refineNext.push_back(false);
+                continue;
+            }
+            const Sample middle{middles[m], middlePoints[m]};
+            ++m;
+            if (chordDeviation(samples[i].point, samples[i + 1].point, middle.point) > tolerance) {
+                refined.push_back(middle);
+                refineNext.push_back(true);
+                refineNext.push_back(true);
+            } else
+                refineNext.push_back(false);
+        }
+        samples.swap(refined);
+        refine.swap(refineNext);
+    }
+    return samples;
+}
+}
+
 plot::plot(QObject *parent) :
     QObject(parent)
 {
@@ -40,7 +207,6 @@ PluginCapabilities plot::getCapabilities() const
 
 void plot::execComm(Document_Interface *doc, QWidget *parent, QString cmd)
 {
-    Q_UNUSED(doc);
     Q_UNUSED(cmd);
 
     QString equation1;
@@ -49,9 +215,6 @@ void plot::execComm(Document_Interface *doc, QWidget *parent, QString cmd)
     QString endValue;
     double stepSize;
 
-    QList<double> xValues;
-    QList<double> yValues1;
-    QList<double> yValues2;
     plotDialog::EntityType lineType=plotDialog::Polyline;
 
     plotDialog plotDlg(parent);
@@ -64,63 +227,50 @@ void plot::execComm(Document_Interface *doc, QWidget *parent, QString cmd)
         plotDlg.getValues(equation1, equation2, startValue, endValue, stepSize);
         lineType=plotDlg.getEntityType();
 
+        std::vector<Sample> samples;
         try{
             mu::Parser p;
-            p.DefineConst(_T("pi"),M_PI);
-            p.DefineConst(_T("e"),M_E);
-            p.DefineVar(_T("x"), &equationVariable);
-            p.DefineVar(_T("t"), &equationVariable);
+            defineParser(p, &equationVariable);
             p.SetExpr(toMUPString(startValue));
             startVal = p.Eval();
 
             p.SetExpr(toMUPString(endValue));
             endVal = p.Eval();
 
-            p.SetExpr(toMUPString(equation1));
-
-            for(equationVariable = startVal; equationVariable <= endVal; equationVariable += stepSize)
-            {//calculate the values of the first equation
-                xValues.append(equationVariable);
-                yValues1.append(p.Eval());
-            }
-
-            if(!equation2.isEmpty())
-            {//calculate the values of the second equation
-                p.SetExpr(toMUPString(equation2));
-                for(int i = 0; i < xValues.size(); ++i)
-                {
-                    equationVariable = xValues.at(i);
-                    yValues2.append(p.Eval());
-                }
-            }
+            samples = sampleCurve(Curve{equation1, equation2}, startVal, endVal,
+                                  stepSize, plotDlg.getTolerance());
         }
         catch (mu::Parser::exception_type &e)
         {
             mu::console() << e.GetMsg() << std::endl;
         }
 
-        QList<double> const& xpoints=(equation2.isEmpty())?xValues:yValues1;
-        QList<double> const& ypoints=(equation2.isEmpty())?yValues1:yValues2;
-
-        if (lineType == plotDialog::LineSegments || lineType == plotDialog::SplinePoints){
-            std::vector<QPointF> points;
-            for(int i=0; i< xpoints.size(); ++i){
-                points.emplace_back(QPointF(xpoints[i], ypoints[i]));
-            }
-            if (lineType == plotDialog::SplinePoints){
-                //TODO add option for splinepoints: closed
-                //hardcoded to false now
-                doc->addSplinePoints(points, false);
-            } else
-                doc->addLines(points, false);
-        } else { //default plotDialog::Polyline
-            std::vector<Plug_VertexData> points;
-            for(int i=0; i< xpoints.size(); ++i){
-                points.emplace_back(Plug_VertexData(QPointF(xpoints[i], ypoints[i]), 0.0));
+        //one entity for each part of the curve between undefined values, one undo cycle for all
+        Plug_Batch batch(doc);
+        for (auto first = samples.cbegin(); first != samples.cend();) {
+            first = std::find_if(first, samples.cend(), [](const Sample& s) {return isFinite(s.point);});
+            auto last = std::find_if(first, samples.cend(), [](const Sample& s) {return !isFinite(s.point);});
+            const std::size_t count = std::distance(first, last);
+            if (count >= 2) {
+                // the coordinates in turn, added without conversions
+                std::vector<double> xy;
+                xy.reserve(2 * count);
+                for (auto it = first; it != last; ++it) {
+                    xy.push_back(it->point.x());
+                    xy.push_back(it->point.y());
+                }
+                if (lineType == plotDialog::SplinePoints){
+                    //TODO add option for splinepoints: closed
+                    //hardcoded to false now
+                    doc->addSplinePoints(xy.data(), count, false);
+                } else if (lineType == plotDialog::LineSegments) {
+                    doc->addLines(xy.data(), count, false);
+                } else { //default plotDialog::Polyline
+                    doc->addPolyline(xy.data(), nullptr, count, false);
+                }
             }
-            doc->addPolyline(points, false);
+            first = last;
         }
-
     }
 
 }
@@ -18,7 +18,8 @@ plotDialog::plotDialog(QWidget *parent) :
     description = new QLabel(tr("This plugin allows you to plot mathematical equations.\n"
                                 "If you don't want to use the parametric form, just leave out \"Equation2\".\n"
                                 "You can use pi when you need the value of pi (i.e. (3*pi)).\n"
-                                "Use t or x in your equation as a variable/parameter.\n"));
+                                "Use t or x in your equation as a variable/parameter.\n"
+                                "With a chord tolerance, the steps are refined where the curve bends.\n"));
     lblEquasion1 = new QLabel(tr("Equation 1:"));
     lblEquasion2 = new QLabel(tr("Equation 2:"));
     lnedEquasion1 = new QLineEdit(this);
@@ -29,6 +30,9 @@ plotDialog::plotDialog(QWidget *parent) :
     lnedStartValue = new QLineEdit(this);
     lnedEndValue = new QLineEdit(this);
     lnedStepSize = new QLineEdit(this);
+    lblTolerance = new QLabel(tr("chord tolerance:"));
+    lnedTolerance = new QLineEdit(this);
+    lnedTolerance->setToolTip(tr("Largest distance of the plotted segments from the curve, empty or 0 for the step size only"));
     btnAccept = new QPushButton(tr("Draw"));
     btnCancel = new QPushButton(tr("Cancel"));
     space = new QSpacerItem(0, 20);
@@ -37,6 +41,7 @@ plotDialog::plotDialog(QWidget *parent) :
     lnedStartValue->setMaximumWidth(50);
     lnedEndValue->setMaximumWidth(50);
     lnedStepSize->setMaximumWidth(50);
+    lnedTolerance->setMaximumWidth(50);
 
     mainLayout->addWidget(description, 0, 0, 1, -1);
 
@@ -55,18 +60,20 @@ plotDialog::plotDialog(QWidget *parent) :
     mainLayout->addWidget(lnedStartValue, 4, 1);
     mainLayout->addWidget(lnedEndValue, 5, 1);
     mainLayout->addWidget(lnedStepSize, 6, 1);
+    mainLayout->addWidget(lblTolerance, 7, 0);
+    mainLayout->addWidget(lnedTolerance, 7, 1);
     m_pTypeSelection = new QComboBox(this);
     m_pTypeSelection->addItem(tr("Line Segments", "Plot Equation to generate RS_Line segments"), QVariant::fromValue(LineSegments));
     m_pTypeSelection->addItem(tr("Polyline", "Plot Equation to generate RS_Polyline"), QVariant::fromValue(Polyline));
     m_pTypeSelection->addItem(tr("SplinePoints", "Plot Equation to generate 2nd spline by LC_SplinePoints"), QVariant::fromValue(SplinePoints));
     m_pTypeSelection->setCurrentIndex(1);
 
-    mainLayout->addWidget(m_pTypeSelection, 7, 0);
+    mainLayout->addWidget(m_pTypeSelection, 8, 0);
 
     buttonLayout->addWidget(btnAccept);
     buttonLayout->addWidget(btnCancel);
 
-    mainLayout->addLayout(buttonLayout, 8, 1);
+    mainLayout->addLayout(buttonLayout, 9, 1);
 
     setLayout(mainLayout);
 
@@ -81,6 +88,11 @@ plotDialog::EntityType plotDialog::getEntityType() const
     return m_pTypeSelection->itemData(m_pTypeSelection->currentIndex()).value<plotDialog::EntityType>();
 }
 
+double plotDialog::getTolerance() const
+{
+    return tolerance;
+}
+
 //get the valuew that the user entered
 void plotDialog::getValues(QString& eq1, QString& eq2, QString& start, QString& end, double& step) const
 {
@@ -104,7 +116,7 @@ void plotDialog::slotDrawButtonClicked()
     }
 }
 
-//read the input from the user (equation1, equation2, starvalue, endvalue, stepsize)
+//read the input from the user (equation1, equation2, starvalue, endvalue, stepsize, tolerance)
 bool plotDialog::readInput()
 {
     bool conv;
@@ -155,5 +167,17 @@ bool plotDialog::readInput()
         return false;
     }
 
+    //get chord tolerance
+    tolerance = 0.;
+    if (!lnedTolerance->text().isEmpty())
+    {
+        tolerance = lnedTolerance->text().toDouble(&conv);
+        if(!conv || tolerance < 0.)
+        {
+            qDebug("could not convert chord tolerance");
+            return false;
+        }
+    }
+
     return true;
 }
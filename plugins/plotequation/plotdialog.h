@@ -27,6 +27,8 @@ public:
     ~plotDialog()=default;
     void getValues(QString& eq1, QString& eq2, QString &start, QString &end, double& step) const;
     EntityType getEntityType() const;
+    //! the largest distance of the plotted segments from the curve, 0 to plot with the step size only
+    double getTolerance() const;
 
 public slots:
     void slotDrawButtonClicked();
@@ -37,6 +39,7 @@ private:
     QString startValue;
     QString endValue;
     double stepSize;
+    double tolerance = 0.;
     QGridLayout *mainLayout;
     QHBoxLayout* buttonLayout;
     QLabel* description;
@@ -50,6 +53,8 @@ private:
     QLineEdit* lnedStartValue;
     QLineEdit* lnedEndValue;
     QLineEdit* lnedStepSize;
+    QLabel* lblTolerance;
+    QLineEdit* lnedTolerance;
     QPushButton* btnAccept;
     QPushButton* btnCancel;
     QSpacerItem* space;
@@ -28,6 +28,76 @@
 
 #include "pointstocsv.h"
 
+namespace {
+//characters formatted before they are written to the file
+constexpr int bufferSize = 1 << 20;
+
+//writes the coordinates of the entities as they are visited, without wrappers
+//for the entities and with a buffer of bounded size
+class CsvWriter: public Plug_EntityVisitor
+{
+public:
+    CsvWriter(Document_Interface* doc, QTextStream& out, bool selectedOnly):
+        m_doc{doc}
+      , m_out{out}
+      , m_selectedOnly{selectedOnly}
+    {
+        m_buffer.reserve(bufferSize + 256);
+    }
+    ~CsvWriter() override
+    {
+        flush();
+    }
+
+    bool visitPoint(const Plug_EntityAttributes& attributes, const QPointF& point) override
+    {
+        if (m_selectedOnly && !attributes.selected)
+            return true;
+        writePoint(point);
+        return true;
+    }
+    bool visitLine(const Plug_EntityAttributes& attributes, const Plug_LineData& line) override
+    {
+        if (m_selectedOnly && !attributes.selected)
+            return true;
+        m_buffer.append("##########\n");
+        writePoint(line.start);
+        writePoint(line.end);
+        return true;
+    }
+    bool visitPolyline(const Plug_EntityAttributes& attributes, const Plug_PolylineData& polyline) override
+    {
+        if (m_selectedOnly && !attributes.selected)
+            return true;
+        m_buffer.append("##########\n");
+        for (const Plug_VertexData& vertex: polyline.vertices)
+            writePoint(vertex.point);
+        return true;
+    }
+
+    void flush()
+    {
+        m_out << m_buffer;
+        // keeps the capacity
+        m_buffer.truncate(0);
+    }
+
+private:
+    void writePoint(const QPointF& point)
+    {
+        m_buffer.append(m_doc->realToStr(point.x())).append(';')
+                .append(m_doc->realToStr(point.y())).append('\n');
+        if (m_buffer.size() >= bufferSize)
+            flush();
+    }
+
+    Document_Interface* m_doc;
+    QTextStream& m_out;
+    const bool m_selectedOnly;
+    QString m_buffer;
+};
+}
+
 
 QString ExpTo_Csv::name() const
 {
@@ -90,12 +160,16 @@ lc_Exptocsvdlg::lc_Exptocsvdlg(QWidget *parent, Document_Interface *doc) :  QDia
 
         QPushButton *exportButton = new QPushButton("Export", this);
         exportButton->setGeometry(300,40, 120, 30);
+
+        QPushButton *exportAllButton = new QPushButton("Export all", this);
+        exportAllButton->setToolTip(tr("Export all entities of the type in the drawing"));
+        exportAllButton->setGeometry(300,75, 120, 30);
         
         selectedEntitiesLabel = new QLabel("0 entities selected", this);
 
         selectedEntitiesLabel->setGeometry(10,40,150,30);
         
-        this->resize ( 450, 80 );
+        this->resize ( 450, 115 );
         //A signal is a message sent by the object. 
         //A slot is a function that will be called when this signal is triggered.   
 
@@ -114,9 +188,16 @@ lc_Exptocsvdlg::lc_Exptocsvdlg(QWidget *parent, Document_Interface *doc) :  QDia
             exportToFile();
         });
 
+        connect(exportAllButton, &QPushButton::clicked, [=](){
+            if(selectedType==DPI::UNKNOWN){
+                setSelectedType(comboBox->currentText());
+            }
+            exportToFile(true);
+        });
+
 }
 
-void lc_Exptocsvdlg::exportToFile()
+void lc_Exptocsvdlg::exportToFile(bool allEntities)
 {
     //edit.setText(text);
     QString fileName = QFileDialog::getSaveFileName(this, tr("Export to file"), "", tr("CSV (*.csv)"));
@@ -132,69 +213,17 @@ void lc_Exptocsvdlg::exportToFile()
             return;
         }
         QTextStream out(&file);
-        for (int i = 0; i < selectedObj.size(); ++i) {
-            out << getFormatedText(selectedObj.at(i));
+        //the selected entities stay selected in the drawing,
+        //they are written without data of their wrappers
+        if (allEntities || !selectedObj.isEmpty()) {
+            CsvWriter writer(d, out, !allEntities);
+            d->visitEntities(writer, selectedType);
         }
         file.close();
         this->close();
     }
 }
 
-QString lc_Exptocsvdlg::getFormatedText(Plug_Entity* entity){
-    QString response = "##########\n";
-    QHash<int, QVariant> data;
-    entity->getData(&data);
-    int et = data.value(DPI::ETYPE).toInt();
-    
-    if(et==DPI::ETYPE::POINT){
-        response = "";
-    
-        response.append(getPointFormatedText(data));
-    } else if(et==DPI::ETYPE::LINE){
-        response.append(getLineFormatedText(data));
-    } else if(et==DPI::ETYPE::POLYLINE){
-        response.append(getPolylineFormatedText(entity));
-    } else {
-        //Unhandled case
-        response = "INVALID";
-    }
-
-    return response;
-}
-
-QString lc_Exptocsvdlg::getPointFormatedText(QHash<int, QVariant> data){
-    QString response = "";
-    response.append(d->realToStr(data.value(DPI::STARTX).toDouble())).
-            append(";").append(d->realToStr(data.value(DPI::STARTY).toDouble())).append("\n");
-    return response;
-}
-
-QString lc_Exptocsvdlg::getLineFormatedText(QHash<int, QVariant> data){
-    QString response = "";
-    QPointF ptA, ptB;
-    ptA.setX( data.value(DPI::STARTX).toDouble());
-    ptA.setY( data.value(DPI::STARTY).toDouble());
-    ptB.setX( data.value(DPI::ENDX).toDouble());
-    ptB.setY( data.value(DPI::ENDY).toDouble());
-    response.append(d->realToStr(ptA.x())).append(";").
-            append(d->realToStr(ptA.y())).append("\n");
-    response.append(d->realToStr(ptB.x())).append(";")
-            .append(d->realToStr(ptB.y())).append("\n");
-
-    return response;
-}
-
-QString lc_Exptocsvdlg::getPolylineFormatedText(Plug_Entity* entity){
-    QString response = "";
-    QList<Plug_VertexData> vl;
-    entity->getPolylineData(&vl);
-    int iVertices = vl.size();
-    for (int i = 0; i < iVertices; ++i) {
-        response.append( d->realToStr(vl.at(i).point.x())).append(";").append(d->realToStr(vl.at(i).point.y())).append("\n");
-    }
-    return response;
-}
-
 void lc_Exptocsvdlg::setSelectedType(QString typeAsString){
     //If the selected Type is -1 then do nothing
     if(selectedType==DPI::POINT || selectedType==DPI::LINE || selectedType==DPI::POLYLINE){
@@ -56,7 +56,7 @@ class lc_Exptocsvdlg : public QDialog
         ~lc_Exptocsvdlg() override;
         void setSelectedType(QString typeAsString);
         void selectEntities(QComboBox *comboBox, Document_Interface *doc = nullptr);
-        void exportToFile();
+        void exportToFile(bool allEntities = false);
 
     private:
         QList<Plug_Entity *> selectedObj;
@@ -69,10 +69,6 @@ class lc_Exptocsvdlg : public QDialog
         void setSelectedObj(QList<Plug_Entity *> *selectedObj);
         void clearSelectedObj();
         void setSelectedLabelCounterText(int count);
-        QString getFormatedText(Plug_Entity* entity);
-        QString getPointFormatedText(QHash<int, QVariant> data);
-        QString getLineFormatedText(QHash<int, QVariant> data);
-        QString getPolylineFormatedText(Plug_Entity* entity);
         QLabel *selectedEntitiesLabel = nullptr;
 
 };
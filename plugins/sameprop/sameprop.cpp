@@ -25,7 +25,8 @@ PluginCapabilities LC_SameProp::getCapabilities() const
 {
     PluginCapabilities pluginCapabilities;
     pluginCapabilities.menuEntryPoints
-            << PluginMenuLocation("plugins_menu", tr("Same properties"));
+            << PluginMenuLocation("plugins_menu", tr("Same properties"))
+            << PluginMenuLocation("plugins_menu", tr("Select same properties"));
     return pluginCapabilities;
 }
 
@@ -33,11 +34,17 @@ void LC_SameProp::execComm(Document_Interface *doc,
                              QWidget *parent, QString cmd)
 {
     Q_UNUSED(parent);
-    Q_UNUSED(cmd);
     QHash<int, QVariant> data, moddata;
     QList<Plug_Entity *> obj;
     QVariant lay, col, ltype, lwidth;
     Plug_Entity *ent, *modent;
+    if (cmd == tr("Select same properties")) {
+        ent = doc->getEnt(tr("select entity to compare:"));
+        if (!ent) return;
+        doc->selectSimilar(ent, DPI::SAME_LAYER | DPI::SAME_COLOR | DPI::SAME_LTYPE | DPI::SAME_LWIDTH);
+        delete ent;
+        return;
+    }
     ent =  doc->getEnt(tr("select original entity:"));
     if (!ent) return;
     bool yes  = doc->getSelect(&obj, tr("select entities to change"));